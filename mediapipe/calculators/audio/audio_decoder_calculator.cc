@@ -45,6 +45,10 @@ namespace mediapipe {
 //   }
 // }
 //
+// For long files, set output_chunk_samples to output fixed-size packets
+// trimmed to [start_time, end_time] and stop decoding after end_time, and
+// seek_to_start_time to skip decoding the audio before start_time.
+//
 // TODO: support decoding multiple streams.
 class AudioDecoderCalculator : public CalculatorBase {
  public:
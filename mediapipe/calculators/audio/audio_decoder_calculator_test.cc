@@ -12,9 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cmath>
+
 #include "absl/flags/flag.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/formats/time_series_header.pb.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
@@ -147,5 +150,70 @@ TEST(AudioDecoderCalculatorTest, TestAAC) {
               std::ceil(44100.0 * 2 / 1024));
 }
 
+TEST(AudioDecoderCalculatorTest, TestWAVChunked) {
+  CalculatorGraphConfig::Node node_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+        calculator: "AudioDecoderCalculator"
+        input_side_packet: "INPUT_FILE_PATH:input_file_path"
+        output_stream: "AUDIO:audio"
+        output_stream: "AUDIO_HEADER:audio_header"
+        node_options {
+          [type.googleapis.com/mediapipe.AudioDecoderOptions]: {
+            audio_stream { stream_index: 0 }
+            output_chunk_samples: 1000
+          }
+        })pb");
+  CalculatorRunner runner(node_config);
+  runner.MutableSidePackets()->Tag("INPUT_FILE_PATH") = MakePacket<std::string>(
+      file::JoinPath(GetTestDataDir(kTestPackageRoot),
+                     "sine_wave_1k_48000_stereo_2_sec_wav.audio"));
+  MP_ASSERT_OK(runner.Run());
+  const auto& packets = runner.Outputs().Tag("AUDIO").packets;
+  ASSERT_GE(packets.size(), 96);
+  for (int i = 0; i < packets.size(); ++i) {
+    const Matrix& chunk = packets[i].Get<Matrix>();
+    EXPECT_EQ(chunk.rows(), 2);
+    if (i + 1 < packets.size()) {
+      EXPECT_EQ(chunk.cols(), 1000);
+    } else {
+      EXPECT_LE(chunk.cols(), 1000);
+    }
+    EXPECT_EQ(packets[i].Timestamp().Value(),
+              std::round(i * 1000 * 1e6 / 48000));
+  }
+}
+
+TEST(AudioDecoderCalculatorTest, TestWAVChunkedTimeWindow) {
+  CalculatorGraphConfig::Node node_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+        calculator: "AudioDecoderCalculator"
+        input_side_packet: "INPUT_FILE_PATH:input_file_path"
+        output_stream: "AUDIO:audio"
+        output_stream: "AUDIO_HEADER:audio_header"
+        node_options {
+          [type.googleapis.com/mediapipe.AudioDecoderOptions]: {
+            audio_stream { stream_index: 0 }
+            start_time: 0.5
+            end_time: 1.0
+            output_chunk_samples: 4096
+            seek_to_start_time: true
+          }
+        })pb");
+  CalculatorRunner runner(node_config);
+  runner.MutableSidePackets()->Tag("INPUT_FILE_PATH") = MakePacket<std::string>(
+      file::JoinPath(GetTestDataDir(kTestPackageRoot),
+                     "sine_wave_1k_44100_mono_2_sec_wav.audio"));
+  MP_ASSERT_OK(runner.Run());
+  const auto& packets = runner.Outputs().Tag("AUDIO").packets;
+  ASSERT_FALSE(packets.empty());
+  // Samples 22050 to 44100, both inclusive.
+  EXPECT_EQ(packets.front().Timestamp(), Timestamp(500000));
+  int num_samples = 0;
+  for (const Packet& packet : packets) {
+    num_samples += packet.Get<Matrix>().cols();
+  }
+  EXPECT_EQ(num_samples, 22051);
+}
+
 }  // namespace
 }  // namespace mediapipe
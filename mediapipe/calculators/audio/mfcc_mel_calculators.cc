@@ -19,20 +19,29 @@
 // commonly used as acoustic features in speech and other audio tasks.
 // Both calculators expect as input the SQUARED_MAGNITUDE-domain outputs
 // from the MediaPipe SpectrogramCalculator object.
+//
+// The mel filterbank is linear in the spectral magnitudes, so its weights are
+// read out of audio_dsp::MelFilterbank once, into a sparse banded matrix, and
+// each packet is transformed by matrix products over all its frames.
+#include <math.h>
+
+#include <algorithm>
 #include <memory>
 #include <vector>
 
 #include "Eigen/Core"
+#include "Eigen/SparseCore"
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
 #include "audio/dsp/mfcc/mel_filterbank.h"
-#include "audio/dsp/mfcc/mfcc.h"
 #include "mediapipe/calculators/audio/mfcc_mel_calculators.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/formats/time_series_header.pb.h"
 #include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/util/time_series_util.h"
 
@@ -54,12 +63,50 @@ std::string PortableDebugString(const TimeSeriesHeader& header) {
                           header.packet_rate(), header.audio_sample_rate());
 }
 
+// Returns the weights of the mel filterbank, which maps the square roots of
+// squared-magnitude spectra linearly to mel spectra, as a sparse matrix with
+// one row per mel channel and one column per spectral bin.
+Eigen::SparseMatrix<float> GetMelWeights(audio_dsp::MelFilterbank* filterbank,
+                                         int input_length, int channel_count) {
+  std::vector<Eigen::Triplet<float>> weights;
+  std::vector<double> input(input_length, 0.0);
+  std::vector<double> output;
+  for (int bin = 0; bin < input_length; ++bin) {
+    // The filterbank output for a unit bin is the column of that bin.
+    input[bin] = 1.0;
+    filterbank->Compute(input, &output);
+    input[bin] = 0.0;
+    for (int channel = 0; channel < output.size(); ++channel) {
+      if (output[channel] != 0.0) {
+        weights.emplace_back(channel, bin, output[channel]);
+      }
+    }
+  }
+  Eigen::SparseMatrix<float> mel_weights(channel_count, input_length);
+  mel_weights.setFromTriplets(weights.begin(), weights.end());
+  return mel_weights;
+}
+
+// Returns the DCT-II matrix of audio_dsp::Mfcc, which maps log mel spectra of
+// channel_count channels to coefficient_count cepstral coefficients.
+Matrix GetDctMatrix(int channel_count, int coefficient_count) {
+  const double scale = sqrt(2.0 / channel_count);
+  const double arg = M_PI / channel_count;
+  Matrix dct(coefficient_count, channel_count);
+  for (int i = 0; i < coefficient_count; ++i) {
+    for (int j = 0; j < channel_count; ++j) {
+      dct(i, j) = scale * cos(i * arg * (j + 0.5));
+    }
+  }
+  return dct;
+}
+
 }  // namespace
 
 // Abstract base class for Calculators that transform feature vectors on a
 // frame-by-frame basis.
 // Subclasses must override pure virtual methods ConfigureTransform and
-// TransformFrame.
+// TransformFrames.
 // Input and output MediaPipe packets are matrices with one column per frame,
 // and one row per feature dimension.  Each input packet results in an
 // output packet with the same number of columns (but differing numbers of
@@ -93,12 +140,13 @@ class FramewiseTransformCalculatorBase : public CalculatorBase {
   virtual absl::Status ConfigureTransform(const TimeSeriesHeader& header,
                                           CalculatorContext* cc) = 0;
 
-  // Takes a vector<double> corresponding to an input frame, and
-  // perform the specific transformation to produce an output frame.
-  virtual void TransformFrame(const std::vector<double>& input,
-                              std::vector<double>* output) const = 0;
+  // Takes the input frames, one per column, and performs the specific
+  // transformation to produce the output frames in the same columns of
+  // "output", which is sized to the number of output channels.
+  virtual void TransformFrames(const Matrix& input, Matrix* output) const = 0;
 
  private:
+  int num_input_channels_;
   int num_output_channels_;
 };
 
@@ -107,6 +155,7 @@ absl::Status FramewiseTransformCalculatorBase::Open(CalculatorContext* cc) {
   MP_RETURN_IF_ERROR(time_series_util::FillTimeSeriesHeaderIfValid(
       cc->Inputs().Index(0).Header(), &input_header));
 
+  num_input_channels_ = input_header.num_channels();
   absl::Status status = ConfigureTransform(input_header, cc);
 
   auto output_header = new TimeSeriesHeader(input_header);
@@ -120,29 +169,10 @@ absl::Status FramewiseTransformCalculatorBase::Open(CalculatorContext* cc) {
 
 absl::Status FramewiseTransformCalculatorBase::Process(CalculatorContext* cc) {
   const Matrix& input = cc->Inputs().Index(0).Get<Matrix>();
-  const int num_frames = input.cols();
-  std::unique_ptr<Matrix> output(new Matrix(num_output_channels_, num_frames));
-  // The main work here is converting each column of the float Matrix
-  // into a vector of doubles, which is what our target functions from
-  // dsp_core consume, and doing the reverse with their output.
-  std::vector<double> input_frame(input.rows());
-  std::vector<double> output_frame(num_output_channels_);
-
-  for (int frame = 0; frame < num_frames; ++frame) {
-    // Copy input from Eigen::Matrix column to vector<float>.
-    Eigen::Map<Eigen::MatrixXd> input_frame_map(&input_frame[0],
-                                                input_frame.size(), 1);
-    input_frame_map = input.col(frame).cast<double>();
-
-    // Perform the actual transformation.
-    TransformFrame(input_frame, &output_frame);
-
-    // Copy output from vector<float> to Eigen::Vector.
-    CHECK_EQ(output_frame.size(), num_output_channels_);
-    Eigen::Map<const Eigen::MatrixXd> output_frame_map(&output_frame[0],
-                                                       output_frame.size(), 1);
-    output->col(frame) = output_frame_map.cast<float>();
-  }
+  RET_CHECK_EQ(input.rows(), num_input_channels_)
+      << "Input frames do not match the input TimeSeriesHeader.";
+  auto output = absl::make_unique<Matrix>(num_output_channels_, input.cols());
+  TransformFrames(input, output.get());
   cc->Outputs().Index(0).Add(output.release(), cc->InputTimestamp());
 
   return absl::OkStatus();
@@ -178,17 +208,10 @@ class MfccCalculator : public FramewiseTransformCalculatorBase {
   absl::Status ConfigureTransform(const TimeSeriesHeader& header,
                                   CalculatorContext* cc) override {
     MfccCalculatorOptions mfcc_options = cc->Options<MfccCalculatorOptions>();
-    mfcc_.reset(new audio_dsp::Mfcc());
     int input_length = header.num_channels();
-    // Set up the parameters to the Mfcc object.
+    const int channel_count =
+        mfcc_options.mel_spectrum_params().channel_count();
     set_num_output_channels(mfcc_options.mfcc_count());
-    mfcc_->set_dct_coefficient_count(num_output_channels());
-    mfcc_->set_upper_frequency_limit(
-        mfcc_options.mel_spectrum_params().max_frequency_hertz());
-    mfcc_->set_lower_frequency_limit(
-        mfcc_options.mel_spectrum_params().min_frequency_hertz());
-    mfcc_->set_filterbank_channel_count(
-        mfcc_options.mel_spectrum_params().channel_count());
     // An upstream calculator (such as SpectrogramCalculator) must store
     // the sample rate of its input audio waveform in the TimeSeries Header.
     // audio_dsp::MelFilterBank needs to know this to
@@ -198,25 +221,37 @@ class MfccCalculator : public FramewiseTransformCalculatorBase {
           absl::StrCat("No audio_sample_rate in input TimeSeriesHeader ",
                        PortableDebugString(header)));
     }
-    // Now we can initialize the Mfcc object.
-    bool initialized =
-        mfcc_->Initialize(input_length, header.audio_sample_rate());
+    // Same filterbank as the one audio_dsp::Mfcc sets up.
+    audio_dsp::MelFilterbank mel_filterbank;
+    bool initialized = mel_filterbank.Initialize(
+        input_length, header.audio_sample_rate(), channel_count,
+        mfcc_options.mel_spectrum_params().min_frequency_hertz(),
+        mfcc_options.mel_spectrum_params().max_frequency_hertz());
 
     if (initialized) {
+      mel_weights_ =
+          GetMelWeights(&mel_filterbank, input_length, channel_count);
+      dct_ = GetDctMatrix(channel_count, num_output_channels());
       return absl::OkStatus();
     } else {
       return absl::Status(absl::StatusCode::kInternal,
-                          "Mfcc::Initialize returned uninitialized");
+                          "MelFilterbank::Initialize returned uninitialized");
     }
   }
 
-  void TransformFrame(const std::vector<double>& input,
-                      std::vector<double>* output) const override {
-    mfcc_->Compute(input, output);
+  void TransformFrames(const Matrix& input, Matrix* output) const override {
+    // As in audio_dsp::Mfcc, the log is taken of mel energies floored at
+    // kFilterbankFloor.
+    constexpr float kFilterbankFloor = 1e-12;
+    const Matrix magnitudes = input.cwiseSqrt();
+    Matrix log_mel = mel_weights_ * magnitudes;
+    log_mel.array() = log_mel.array().max(kFilterbankFloor).log();
+    output->noalias() = dct_ * log_mel;
   }
 
  private:
-  std::unique_ptr<audio_dsp::Mfcc> mfcc_;
+  Eigen::SparseMatrix<float> mel_weights_;
+  Matrix dct_;
 };
 REGISTER_CALCULATOR(MfccCalculator);
 
@@ -237,7 +272,7 @@ class MelSpectrumCalculator : public FramewiseTransformCalculatorBase {
                                   CalculatorContext* cc) override {
     MelSpectrumCalculatorOptions mel_spectrum_options =
         cc->Options<MelSpectrumCalculatorOptions>();
-    mel_filterbank_.reset(new audio_dsp::MelFilterbank());
+    audio_dsp::MelFilterbank mel_filterbank;
     int input_length = header.num_channels();
     set_num_output_channels(mel_spectrum_options.channel_count());
     // An upstream calculator (such as SpectrogramCalculator) must store
@@ -249,12 +284,14 @@ class MelSpectrumCalculator : public FramewiseTransformCalculatorBase {
           absl::StrCat("No audio_sample_rate in input TimeSeriesHeader ",
                        PortableDebugString(header)));
     }
-    bool initialized = mel_filterbank_->Initialize(
+    bool initialized = mel_filterbank.Initialize(
         input_length, header.audio_sample_rate(), num_output_channels(),
         mel_spectrum_options.min_frequency_hertz(),
         mel_spectrum_options.max_frequency_hertz());
 
     if (initialized) {
+      mel_weights_ =
+          GetMelWeights(&mel_filterbank, input_length, num_output_channels());
       return absl::OkStatus();
     } else {
       return absl::Status(absl::StatusCode::kInternal,
@@ -262,13 +299,13 @@ class MelSpectrumCalculator : public FramewiseTransformCalculatorBase {
     }
   }
 
-  void TransformFrame(const std::vector<double>& input,
-                      std::vector<double>* output) const override {
-    mel_filterbank_->Compute(input, output);
+  void TransformFrames(const Matrix& input, Matrix* output) const override {
+    const Matrix magnitudes = input.cwiseSqrt();
+    output->noalias() = mel_weights_ * magnitudes;
   }
 
  private:
-  std::unique_ptr<audio_dsp::MelFilterbank> mel_filterbank_;
+  Eigen::SparseMatrix<float> mel_weights_;
 };
 REGISTER_CALCULATOR(MelSpectrumCalculator);
 
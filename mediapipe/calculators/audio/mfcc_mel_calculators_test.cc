@@ -13,7 +13,14 @@
 // limitations under the License.
 #include <vector>
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
 #include "Eigen/Core"
+#include "audio/dsp/mfcc/mel_filterbank.h"
+#include "audio/dsp/mfcc/mfcc.h"
 #include "mediapipe/calculators/audio/mfcc_mel_calculators.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/matrix.h"
@@ -99,6 +106,32 @@ class FramewiseTransformCalculatorTest
     }
   }
 
+  // Checks that every output frame matches transform_frame applied to the
+  // corresponding input frame.
+  void CheckFramesMatch(
+      const std::function<void(const std::vector<double>&,
+                               std::vector<double>*)>& transform_frame) {
+    const auto& input_packets = this->input().packets;
+    const auto& output_packets = this->output().packets;
+    ASSERT_EQ(input_packets.size(), output_packets.size());
+    std::vector<double> expected;
+    for (int i = 0; i < input_packets.size(); ++i) {
+      const Matrix& input = input_packets[i].template Get<Matrix>();
+      const Matrix& output = output_packets[i].template Get<Matrix>();
+      ASSERT_EQ(input.cols(), output.cols());
+      for (int frame = 0; frame < input.cols(); ++frame) {
+        const std::vector<double> input_frame(
+            input.col(frame).data(), input.col(frame).data() + input.rows());
+        transform_frame(input_frame, &expected);
+        ASSERT_EQ(expected.size(), output.rows());
+        for (int channel = 0; channel < expected.size(); ++channel) {
+          EXPECT_NEAR(output(channel, frame), expected[channel],
+                      1e-4 * std::max(1.0, std::abs(expected[channel])));
+        }
+      }
+    }
+  }
+
   // Allows SetupRandomInputPackets() to inform CheckResults() about how
   // big the packets are supposed to be.
   int num_samples_per_packet_;
@@ -116,6 +149,27 @@ TEST_F(MfccCalculatorTest, AudioSampleRateFromInputHeader) {
 
   CheckResults(options_.mfcc_count());
 }
+TEST_F(MfccCalculatorTest, MatchesMfccOnEveryFrame) {
+  audio_sample_rate_ = kAudioSampleRate;
+  SetupGraphAndHeader();
+  SetupRandomInputPackets();
+
+  MP_ASSERT_OK(Run());
+
+  audio_dsp::Mfcc mfcc;
+  mfcc.set_dct_coefficient_count(options_.mfcc_count());
+  mfcc.set_upper_frequency_limit(
+      options_.mel_spectrum_params().max_frequency_hertz());
+  mfcc.set_lower_frequency_limit(
+      options_.mel_spectrum_params().min_frequency_hertz());
+  mfcc.set_filterbank_channel_count(
+      options_.mel_spectrum_params().channel_count());
+  ASSERT_TRUE(mfcc.Initialize(num_input_channels_, kAudioSampleRate));
+  CheckFramesMatch(
+      [&mfcc](const std::vector<double>& input, std::vector<double>* output) {
+        mfcc.Compute(input, output);
+      });
+}
 TEST_F(MfccCalculatorTest, NoAudioSampleRate) {
   // Leave audio_sample_rate_ == kUnset, so it is not present in the
   // input TimeSeriesHeader; expect failure.
@@ -138,6 +192,22 @@ TEST_F(MelSpectrumCalculatorTest, AudioSampleRateFromInputHeader) {
 
   CheckResults(options_.channel_count());
 }
+TEST_F(MelSpectrumCalculatorTest, MatchesMelFilterbankOnEveryFrame) {
+  audio_sample_rate_ = kAudioSampleRate;
+  SetupGraphAndHeader();
+  SetupRandomInputPackets();
+
+  MP_ASSERT_OK(Run());
+
+  audio_dsp::MelFilterbank mel_filterbank;
+  ASSERT_TRUE(mel_filterbank.Initialize(
+      num_input_channels_, kAudioSampleRate, options_.channel_count(),
+      options_.min_frequency_hertz(), options_.max_frequency_hertz()));
+  CheckFramesMatch([&mel_filterbank](const std::vector<double>& input,
+                                     std::vector<double>* output) {
+    mel_filterbank.Compute(input, output);
+  });
+}
 TEST_F(MelSpectrumCalculatorTest, NoAudioSampleRate) {
   // Leave audio_sample_rate_ == kUnset, so it is not present in the
   // input TimeSeriesHeader; expect failure.
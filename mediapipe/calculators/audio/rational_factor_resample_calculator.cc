@@ -16,10 +16,6 @@
 
 #include "mediapipe/calculators/audio/rational_factor_resample_calculator.h"
 
-#include "audio/dsp/resampler_q.h"
-
-using audio_dsp::Resampler;
-
 namespace mediapipe {
 absl::Status RationalFactorResampleCalculator::Process(CalculatorContext* cc) {
   return ProcessInternal(cc->Inputs().Index(0).Get<Matrix>(), false, cc);
@@ -33,26 +29,6 @@ absl::Status RationalFactorResampleCalculator::Close(CalculatorContext* cc) {
   return ProcessInternal(empty_input_frame, true, cc);
 }
 
-namespace {
-void CopyChannelToVector(const Matrix& matrix, int channel,
-                         std::vector<float>* vec) {
-  vec->resize(matrix.cols());
-  Eigen::Map<Eigen::ArrayXf>(vec->data(), vec->size()) = matrix.row(channel);
-}
-
-void CopyVectorToChannel(const std::vector<float>& vec, Matrix* matrix,
-                         int channel) {
-  if (matrix->cols() == 0) {
-    matrix->resize(matrix->rows(), vec.size());
-  } else {
-    CHECK_EQ(vec.size(), matrix->cols());
-  }
-  CHECK_LT(channel, matrix->rows());
-  matrix->row(channel) =
-      Eigen::Map<const Eigen::ArrayXf>(vec.data(), vec.size());
-}
-}  // namespace
-
 absl::Status RationalFactorResampleCalculator::Open(CalculatorContext* cc) {
   RationalFactorResampleCalculatorOptions resample_options =
       cc->Options<RationalFactorResampleCalculatorOptions>();
@@ -72,15 +48,14 @@ absl::Status RationalFactorResampleCalculator::Open(CalculatorContext* cc) {
 
   // Don't create resamplers for pass-thru (sample rates are equal).
   if (source_sample_rate_ != target_sample_rate_) {
-    resampler_.resize(num_channels_);
-    for (auto& r : resampler_) {
-      r = ResamplerFromOptions(source_sample_rate_, target_sample_rate_,
-                               resample_options);
-      if (!r) {
-        LOG(ERROR) << "Failed to initialize resampler.";
-        return absl::UnknownError("Failed to initialize resampler.");
-      }
+    auto resampler = ResamplerFromOptions(
+        source_sample_rate_, target_sample_rate_, num_channels_,
+        resample_options);
+    if (!resampler.ok()) {
+      LOG(ERROR) << "Failed to initialize resampler: " << resampler.status();
+      return absl::UnknownError("Failed to initialize resampler.");
     }
+    resampler_ = *std::move(resampler);
   }
 
   TimeSeriesHeader* output_header = new TimeSeriesHeader(input_header);
@@ -116,7 +91,7 @@ absl::Status RationalFactorResampleCalculator::ProcessInternal(
 
   cumulative_input_samples_ += input_frame.cols();
   std::unique_ptr<Matrix> output_frame(new Matrix(num_channels_, 0));
-  if (resampler_.empty()) {
+  if (!resampler_) {
     // Sample rates were same for input and output; pass-thru.
     *output_frame = input_frame;
   } else {
@@ -135,29 +110,25 @@ absl::Status RationalFactorResampleCalculator::ProcessInternal(
 bool RationalFactorResampleCalculator::Resample(const Matrix& input_frame,
                                                 Matrix* output_frame,
                                                 bool should_flush) {
-  std::vector<float> input_vector;
-  std::vector<float> output_vector;
-  for (int i = 0; i < input_frame.rows(); ++i) {
-    CopyChannelToVector(input_frame, i, &input_vector);
-    if (should_flush) {
-      resampler_[i]->Flush(&output_vector);
-    } else {
-      resampler_[i]->ProcessSamples(input_vector, &output_vector);
-    }
-    CopyVectorToChannel(output_vector, output_frame, i);
+  if (input_frame.rows() != resampler_->num_channels()) {
+    return false;
+  }
+  if (should_flush) {
+    resampler_->Flush(output_frame);
+  } else {
+    resampler_->ProcessSamples(input_frame, output_frame);
   }
   return true;
 }
 
 // static
-std::unique_ptr<Resampler<float>>
+absl::StatusOr<std::unique_ptr<PolyphaseResampler>>
 RationalFactorResampleCalculator::ResamplerFromOptions(
     const double source_sample_rate, const double target_sample_rate,
-    const RationalFactorResampleCalculatorOptions& options) {
-  std::unique_ptr<Resampler<float>> resampler;
+    int num_channels, const RationalFactorResampleCalculatorOptions& options) {
   const auto& rational_factor_options =
       options.resampler_rational_factor_options();
-  audio_dsp::QResamplerParams params;
+  PolyphaseResamplerParams params;
   if (rational_factor_options.has_radius() &&
       rational_factor_options.has_cutoff() &&
       rational_factor_options.has_kaiser_beta()) {
@@ -175,14 +146,8 @@ RationalFactorResampleCalculator::ResamplerFromOptions(
   // that any factor is represented with error less than 0.025%.
   params.max_denominator = 2000;
 
-  // NOTE: QResampler supports multichannel resampling, so the code might be
-  // simplified using a single instance rather than one per channel.
-  resampler = absl::make_unique<audio_dsp::QResampler<float>>(
-      source_sample_rate, target_sample_rate, /*num_channels=*/1, params);
-  if (resampler != nullptr && !resampler->Valid()) {
-    resampler = std::unique_ptr<Resampler<float>>();
-  }
-  return resampler;
+  return PolyphaseResampler::Create(source_sample_rate, target_sample_rate,
+                                    num_channels, params);
 }
 
 REGISTER_CALCULATOR(RationalFactorResampleCalculator);
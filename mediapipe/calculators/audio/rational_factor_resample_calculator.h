@@ -20,14 +20,15 @@
 #include <vector>
 
 #include "Eigen/Core"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
-#include "audio/dsp/resampler.h"
 #include "mediapipe/calculators/audio/rational_factor_resample_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/formats/time_series_header.pb.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/logging.h"
+#include "mediapipe/util/polyphase_resampler.h"
 #include "mediapipe/util/time_series_util.h"
 
 namespace mediapipe {
@@ -37,8 +38,10 @@ namespace mediapipe {
 // RationalFactorResampleCalculatorOptions.  The output time series may have
 // a varying number of samples per frame.
 //
-// NOTE: This calculator uses QResampler, despite the name, which supersedes
-// RationalFactorResampler.
+// NOTE: Despite the name, this calculator uses a polyphase resampler with the
+// parameters of QResampler, which supersedes RationalFactorResampler. All
+// channels are resampled together, and resamplers between the same sample
+// rates share their filters.
 class RationalFactorResampleCalculator : public CalculatorBase {
  public:
   struct TestAccess;
@@ -63,14 +66,13 @@ class RationalFactorResampleCalculator : public CalculatorBase {
   absl::Status Close(CalculatorContext* cc) override;
 
  protected:
-  typedef audio_dsp::Resampler<float> ResamplerType;
-
-  // Returns a Resampler<float> implementation specified by the
-  // RationalFactorResampleCalculatorOptions proto. Returns null if the options
+  // Returns a resampler of num_channels channels specified by the
+  // RationalFactorResampleCalculatorOptions proto, or an error if the options
   // specify an invalid resampler.
-  static std::unique_ptr<ResamplerType> ResamplerFromOptions(
-      const double source_sample_rate, const double target_sample_rate,
-      const RationalFactorResampleCalculatorOptions& options);
+  static absl::StatusOr<std::unique_ptr<PolyphaseResampler>>
+  ResamplerFromOptions(const double source_sample_rate,
+                       const double target_sample_rate, int num_channels,
+                       const RationalFactorResampleCalculatorOptions& options);
 
   // Does Timestamp bookkeeping and resampling common to Process() and
   // Close().  Returns FAIL if the resampler state becomes
@@ -78,9 +80,9 @@ class RationalFactorResampleCalculator : public CalculatorBase {
   absl::Status ProcessInternal(const Matrix& input_frame, bool should_flush,
                                CalculatorContext* cc);
 
-  // Uses the internal resampler_ objects to actually resample each
-  // row of the input TimeSeries.  Returns false if the resampler
-  // state becomes inconsistent.
+  // Uses the internal resampler_ to actually resample all the rows of
+  // the input TimeSeries.  Returns false if the resampler state becomes
+  // inconsistent.
   bool Resample(const Matrix& input_frame, Matrix* output_frame,
                 bool should_flush);
 
@@ -91,16 +93,18 @@ class RationalFactorResampleCalculator : public CalculatorBase {
   Timestamp initial_timestamp_;
   bool check_inconsistent_timestamps_;
   int num_channels_;
-  std::vector<std::unique_ptr<ResamplerType>> resampler_;
+  // Null for pass-thru.
+  std::unique_ptr<PolyphaseResampler> resampler_;
 };
 
 // Test-only access to RationalFactorResampleCalculator methods.
 struct RationalFactorResampleCalculator::TestAccess {
-  static std::unique_ptr<ResamplerType> ResamplerFromOptions(
-      const double source_sample_rate, const double target_sample_rate,
-      const RationalFactorResampleCalculatorOptions& options) {
+  static absl::StatusOr<std::unique_ptr<PolyphaseResampler>>
+  ResamplerFromOptions(const double source_sample_rate,
+                       const double target_sample_rate, int num_channels,
+                       const RationalFactorResampleCalculatorOptions& options) {
     return RationalFactorResampleCalculator::ResamplerFromOptions(
-        source_sample_rate, target_sample_rate, options);
+        source_sample_rate, target_sample_rate, num_channels, options);
   }
 };
 
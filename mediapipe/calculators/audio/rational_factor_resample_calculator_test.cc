@@ -21,7 +21,6 @@
 #include <vector>
 
 #include "Eigen/Core"
-#include "audio/dsp/signal_vector_util.h"
 #include "mediapipe/calculators/audio/rational_factor_resample_calculator.pb.h"
 #include "mediapipe/framework//tool/validate_type.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -142,21 +141,27 @@ class RationalFactorResampleCalculatorTest
   // packet-by-packet) are consistent with resampling the entire
   // signal at once.
   void CheckOutputValues(double output_sample_rate) {
-    for (int i = 0; i < num_input_channels_; ++i) {
-      auto verification_resampler =
-          RationalFactorResampleCalculator::TestAccess::ResamplerFromOptions(
-              input_sample_rate_, output_sample_rate, options_);
+    auto verification_resampler =
+        RationalFactorResampleCalculator::TestAccess::ResamplerFromOptions(
+            input_sample_rate_, output_sample_rate, num_input_channels_,
+            options_);
+    MP_ASSERT_OK(verification_resampler);
+    Matrix expected_resampled_data;
+    Matrix flushed_data;
+    (*verification_resampler)
+        ->ProcessSamples(concatenated_input_samples_,
+                         &expected_resampled_data);
+    (*verification_resampler)->Flush(&flushed_data);
+    expected_resampled_data.conservativeResize(
+        Eigen::NoChange, expected_resampled_data.cols() + flushed_data.cols());
+    expected_resampled_data.rightCols(flushed_data.cols()) = flushed_data;
 
-      std::vector<float> input_data;
-      for (int j = 0; j < num_input_samples_; ++j) {
-        input_data.push_back(concatenated_input_samples_(i, j));
-      }
-      std::vector<float> expected_resampled_data;
-      std::vector<float> temp;
-      verification_resampler->ProcessSamples(input_data, &temp);
-      audio_dsp::VectorAppend(&expected_resampled_data, temp);
-      verification_resampler->Flush(&temp);
-      audio_dsp::VectorAppend(&expected_resampled_data, temp);
+    for (int i = 0; i < num_input_channels_; ++i) {
+      std::vector<float> expected_channel_data(
+          expected_resampled_data.cols());
+      Eigen::Map<Eigen::RowVectorXf>(expected_channel_data.data(),
+                                     expected_channel_data.size()) =
+          expected_resampled_data.row(i);
       std::vector<float> actual_resampled_data;
       for (const Packet& packet : output().packets) {
         Matrix output_frame_row = packet.Get<Matrix>().row(i);
@@ -165,7 +170,7 @@ class RationalFactorResampleCalculatorTest
             &output_frame_row(0) + output_frame_row.cols());
       }
 
-      ExpectVectorMostlyFloatEq(expected_resampled_data, actual_resampled_data);
+      ExpectVectorMostlyFloatEq(expected_channel_data, actual_resampled_data);
     }
   }
 
@@ -15,11 +15,14 @@
 // Defines SpectrogramCalculator.
 #include <math.h>
 
+#include <algorithm>
 #include <complex>
 #include <deque>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
 #include "audio/dsp/spectrogram/spectrogram.h"
 #include "audio/dsp/window_functions.h"
@@ -27,8 +30,10 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status_builder.h"
 #include "mediapipe/util/time_series_util.h"
+#include "pffft.h"
 
 namespace mediapipe {
 
@@ -65,6 +70,11 @@ constexpr char kFrameOverlapTag[] = "FRAME_OVERLAP";
 // rounded to the nearest integer number of samples.  Conseqently, all output
 // frames will be based on the same number of input samples, and each
 // analysis frame will advance from its predecessor by the same time step.
+//
+// With fft_backend PFFFT, the frames are computed by pffft instead of
+// audio_dsp::Spectrogram, which suits small frequent input packets: only the
+// last frame of samples of each channel is retained, in a ring buffer, and no
+// intermediate per-frame vectors are allocated.
 class SpectrogramCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
@@ -172,6 +182,38 @@ class SpectrogramCalculator : public CalculatorBase {
       const OutputMatrixType postprocess_output_fn(const OutputMatrixType&),
       CalculatorContext* cc);
 
+  // Equivalent of ProcessVectorToOutput() for the PFFFT backend.
+  template <class OutputMatrixType>
+  absl::Status ProcessVectorWithPffft(const Matrix& input_stream,
+                                      CalculatorContext* cc);
+
+  // Emits one packet with the spectrogram matrix of every channel, each
+  // holding num_frames frames.
+  template <class OutputMatrixType>
+  void OutputSpectrogramMatrices(
+      std::unique_ptr<std::vector<OutputMatrixType>> spectrogram_matrices,
+      int num_frames, CalculatorContext* cc);
+
+  // Sets up the PFFFT backend for the given analysis window.
+  absl::Status InitializePffft(const std::vector<double>& window);
+
+  // Copies the samples of every channel into the ring buffer.
+  void AppendToRingBuffer(const Eigen::Ref<const Matrix>& samples);
+
+  // Windows the last frame of samples of the channel into fft_input_ and
+  // transforms it into fft_output_.
+  void ComputePffftFrame(int channel);
+
+  // Writes fft_output_ into the frame column of the spectrogram, as squared
+  // magnitudes or as complex values.
+  void WritePffftFrame(int frame, Matrix* spectrogram) const;
+  void WritePffftFrame(int frame, Eigen::MatrixXcf* spectrogram) const;
+
+  // Translates squared magnitudes into the output type and applies the
+  // output scale.
+  void PostprocessInPlace(Matrix* spectrogram) const;
+  void PostprocessInPlace(Eigen::MatrixXcf* spectrogram) const;
+
   // Use the MediaPipe timestamp instead of the estimated one. Useful when the
   // data is intermittent.
   bool use_local_timestamp_;
@@ -201,6 +243,24 @@ class SpectrogramCalculator : public CalculatorBase {
   // Fixed scale factor applied to output values (regardless of type).
   double output_scale_;
 
+  // State of the PFFFT backend, which is used iff pffft_setup_ is set.
+  PFFFT_Setup* pffft_setup_ = nullptr;
+  int fft_length_ = 0;
+  std::vector<float> window_;
+  // The last frame_duration_samples_ samples of every channel, one row per
+  // channel so that the samples of a channel are contiguous. The oldest
+  // sample is at ring_position_.
+  Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      ring_buffer_;
+  int ring_position_ = 0;
+  // How many more samples complete the next frame.
+  int samples_to_next_frame_ = 0;
+  // pffft requires aligned buffers. The tail of fft_input_ past the window
+  // stays zero.
+  std::vector<float, Eigen::aligned_allocator<float>> fft_input_;
+  std::vector<float, Eigen::aligned_allocator<float>> fft_output_;
+  std::vector<float, Eigen::aligned_allocator<float>> fft_workspace_;
+
   static const float kLnSquaredMagnitudeToDb;
 };
 REGISTER_CALCULATOR(SpectrogramCalculator);
@@ -282,16 +342,21 @@ absl::Status SpectrogramCalculator::Open(CalculatorContext* cc) {
       break;
   }
 
-  // Propagate settings down to the actual Spectrogram object.
   spectrogram_generators_.clear();
-  for (int i = 0; i < num_input_channels_; i++) {
-    spectrogram_generators_.push_back(
-        std::unique_ptr<audio_dsp::Spectrogram>(new audio_dsp::Spectrogram()));
-    spectrogram_generators_[i]->Initialize(window, frame_step_samples());
+  if (spectrogram_options.fft_backend() ==
+      SpectrogramCalculatorOptions::PFFFT) {
+    MP_RETURN_IF_ERROR(InitializePffft(window));
+    num_output_channels_ = fft_length_ / 2 + 1;
+  } else {
+    // Propagate settings down to the actual Spectrogram object.
+    for (int i = 0; i < num_input_channels_; i++) {
+      spectrogram_generators_.push_back(std::unique_ptr<audio_dsp::Spectrogram>(
+          new audio_dsp::Spectrogram()));
+      spectrogram_generators_[i]->Initialize(window, frame_step_samples());
+    }
+    num_output_channels_ =
+        spectrogram_generators_[0]->output_frequency_channels();
   }
-
-  num_output_channels_ =
-      spectrogram_generators_[0]->output_frequency_channels();
   std::unique_ptr<TimeSeriesHeader> output_header(
       new TimeSeriesHeader(input_header));
   // Store the actual sample rate of the input audio in the TimeSeriesHeader
@@ -319,6 +384,7 @@ absl::Status SpectrogramCalculator::Open(CalculatorContext* cc) {
     cc->Outputs().Index(0).SetHeader(
         Adopt(multichannel_output_header.release()));
   }
+  cumulative_input_samples_ = 0;
   cumulative_completed_frames_ = 0;
   last_completed_frames_ = 0;
   initial_input_timestamp_ = Timestamp::Unstarted();
@@ -403,28 +469,185 @@ absl::Status SpectrogramCalculator::ProcessVectorToOutput(
   if (!spectrogram_matrices->empty()) {
     RET_CHECK_EQ(spectrogram_matrices->size(), input_stream.rows())
         << "Inconsistent number of spectrogram channels.";
-    if (allow_multichannel_input_) {
-      cc->Outputs().Index(0).Add(spectrogram_matrices.release(),
-                                 CurrentOutputTimestamp(cc));
-    } else {
-      cc->Outputs().Index(0).Add(
-          new OutputMatrixType(spectrogram_matrices->at(0)),
-          CurrentOutputTimestamp(cc));
+    OutputSpectrogramMatrices(std::move(spectrogram_matrices),
+                              output_vectors.size(), cc);
+  }
+  return absl::OkStatus();
+}
+
+template <class OutputMatrixType>
+absl::Status SpectrogramCalculator::ProcessVectorWithPffft(
+    const Matrix& input_stream, CalculatorContext* cc) {
+  RET_CHECK_EQ(input_stream.rows(), num_input_channels_)
+      << "Inconsistent number of input channels.";
+  const int num_samples = input_stream.cols();
+  const int num_frames =
+      num_samples < samples_to_next_frame_
+          ? 0
+          : 1 + (num_samples - samples_to_next_frame_) / frame_step_samples();
+
+  auto spectrogram_matrices =
+      absl::make_unique<std::vector<OutputMatrixType>>();
+  spectrogram_matrices->reserve(num_input_channels_);
+  for (int channel = 0; channel < num_input_channels_; ++channel) {
+    spectrogram_matrices->emplace_back(num_output_channels_, num_frames);
+  }
+  int input_position = 0;
+  for (int frame = 0; frame < num_frames; ++frame) {
+    AppendToRingBuffer(
+        input_stream.middleCols(input_position, samples_to_next_frame_));
+    input_position += samples_to_next_frame_;
+    samples_to_next_frame_ = frame_step_samples();
+    for (int channel = 0; channel < num_input_channels_; ++channel) {
+      ComputePffftFrame(channel);
+      WritePffftFrame(frame, &(*spectrogram_matrices)[channel]);
     }
-    cumulative_completed_frames_ += output_vectors.size();
-    last_completed_frames_ = output_vectors.size();
-    if (!use_local_timestamp_) {
-      // In non-local timestamp mode the timestamp of the next packet will be
-      // equal to CumulativeOutputTimestamp(). Inform the framework about this
-      // fact to enable packet queueing optimizations.
-      cc->Outputs().Index(0).SetNextTimestampBound(CumulativeOutputTimestamp());
+  }
+  // Keep the samples that do not complete a frame for the next packet.
+  const int num_remaining_samples = num_samples - input_position;
+  AppendToRingBuffer(
+      input_stream.middleCols(input_position, num_remaining_samples));
+  samples_to_next_frame_ -= num_remaining_samples;
+
+  if (num_frames > 0) {
+    for (OutputMatrixType& spectrogram : *spectrogram_matrices) {
+      PostprocessInPlace(&spectrogram);
     }
+    OutputSpectrogramMatrices(std::move(spectrogram_matrices), num_frames, cc);
+  }
+  return absl::OkStatus();
+}
+
+template <class OutputMatrixType>
+void SpectrogramCalculator::OutputSpectrogramMatrices(
+    std::unique_ptr<std::vector<OutputMatrixType>> spectrogram_matrices,
+    int num_frames, CalculatorContext* cc) {
+  if (allow_multichannel_input_) {
+    cc->Outputs().Index(0).Add(spectrogram_matrices.release(),
+                               CurrentOutputTimestamp(cc));
+  } else {
+    cc->Outputs().Index(0).Add(
+        new OutputMatrixType(std::move(spectrogram_matrices->at(0))),
+        CurrentOutputTimestamp(cc));
   }
+  cumulative_completed_frames_ += num_frames;
+  last_completed_frames_ = num_frames;
+  if (!use_local_timestamp_) {
+    // In non-local timestamp mode the timestamp of the next packet will be
+    // equal to CumulativeOutputTimestamp(). Inform the framework about this
+    // fact to enable packet queueing optimizations.
+    cc->Outputs().Index(0).SetNextTimestampBound(CumulativeOutputTimestamp());
+  }
+}
+
+absl::Status SpectrogramCalculator::InitializePffft(
+    const std::vector<double>& window) {
+  // Same DFT length as audio_dsp::Spectrogram.
+  fft_length_ = 1;
+  while (fft_length_ < frame_duration_samples_) fft_length_ *= 2;
+  RET_CHECK_GE(fft_length_, 32)
+      << "The PFFFT backend requires frames of more than 16 samples.";
+  pffft_setup_ = pffft_new_setup(fft_length_, PFFFT_REAL);
+  RET_CHECK(pffft_setup_) << "Cannot set up pffft of size " << fft_length_;
+  window_.assign(window.begin(), window.end());
+  ring_buffer_.setZero(num_input_channels_, frame_duration_samples_);
+  ring_position_ = 0;
+  samples_to_next_frame_ = frame_duration_samples_;
+  fft_input_.assign(fft_length_, 0.0f);
+  fft_output_.resize(fft_length_);
+  fft_workspace_.resize(fft_length_);
   return absl::OkStatus();
 }
 
+void SpectrogramCalculator::AppendToRingBuffer(
+    const Eigen::Ref<const Matrix>& samples) {
+  // There are never more new samples than a frame.
+  const int num_samples = samples.cols();
+  const int head =
+      std::min(num_samples, frame_duration_samples_ - ring_position_);
+  ring_buffer_.middleCols(ring_position_, head) = samples.leftCols(head);
+  ring_buffer_.leftCols(num_samples - head) =
+      samples.rightCols(num_samples - head);
+  ring_position_ = (ring_position_ + num_samples) % frame_duration_samples_;
+}
+
+void SpectrogramCalculator::ComputePffftFrame(int channel) {
+  using FloatArray = Eigen::Map<Eigen::ArrayXf>;
+  using ConstFloatArray = Eigen::Map<const Eigen::ArrayXf>;
+  // The ring buffer is full, and its oldest sample starts the frame.
+  const float* samples = ring_buffer_.row(channel).data();
+  const int head = frame_duration_samples_ - ring_position_;
+  FloatArray(fft_input_.data(), head) =
+      ConstFloatArray(samples + ring_position_, head) *
+      ConstFloatArray(window_.data(), head);
+  FloatArray(fft_input_.data() + head, ring_position_) =
+      ConstFloatArray(samples, ring_position_) *
+      ConstFloatArray(window_.data() + head, ring_position_);
+  pffft_transform_ordered(pffft_setup_, fft_input_.data(), fft_output_.data(),
+                          fft_workspace_.data(), PFFFT_FORWARD);
+}
+
+void SpectrogramCalculator::WritePffftFrame(int frame,
+                                            Matrix* spectrogram) const {
+  // pffft packs the real DC and Nyquist bins first, then the real and
+  // imaginary parts of the other bins.
+  const int nyquist_bin = fft_length_ / 2;
+  using Parts = Eigen::Map<const Eigen::ArrayXf, 0, Eigen::InnerStride<2>>;
+  auto column = spectrogram->col(frame);
+  column(0) = fft_output_[0] * fft_output_[0];
+  column.segment(1, nyquist_bin - 1) =
+      (Parts(fft_output_.data() + 2, nyquist_bin - 1).square() +
+       Parts(fft_output_.data() + 3, nyquist_bin - 1).square())
+          .matrix();
+  column(nyquist_bin) = fft_output_[1] * fft_output_[1];
+}
+
+void SpectrogramCalculator::WritePffftFrame(
+    int frame, Eigen::MatrixXcf* spectrogram) const {
+  const int nyquist_bin = fft_length_ / 2;
+  auto column = spectrogram->col(frame);
+  column(0) = std::complex<float>(fft_output_[0], 0.0f);
+  // audio_dsp::Spectrogram uses the opposite sign convention for the
+  // imaginary parts.
+  for (int bin = 1; bin < nyquist_bin; ++bin) {
+    column(bin) = std::complex<float>(fft_output_[2 * bin],
+                                      -fft_output_[2 * bin + 1]);
+  }
+  column(nyquist_bin) = std::complex<float>(fft_output_[1], 0.0f);
+}
+
+void SpectrogramCalculator::PostprocessInPlace(Matrix* spectrogram) const {
+  switch (output_type_) {
+    case SpectrogramCalculatorOptions::LINEAR_MAGNITUDE:
+      spectrogram->array() = spectrogram->array().sqrt();
+      break;
+    case SpectrogramCalculatorOptions::DECIBELS:
+      spectrogram->array() =
+          kLnSquaredMagnitudeToDb * spectrogram->array().log();
+      break;
+    default:
+      break;
+  }
+  if (output_scale_ != 1.0) {
+    *spectrogram *= static_cast<float>(output_scale_);
+  }
+}
+
+void SpectrogramCalculator::PostprocessInPlace(
+    Eigen::MatrixXcf* spectrogram) const {
+  if (output_scale_ != 1.0) {
+    *spectrogram *= static_cast<float>(output_scale_);
+  }
+}
+
 absl::Status SpectrogramCalculator::ProcessVector(const Matrix& input_stream,
                                                   CalculatorContext* cc) {
+  if (pffft_setup_) {
+    if (output_type_ == SpectrogramCalculatorOptions::COMPLEX) {
+      return ProcessVectorWithPffft<Eigen::MatrixXcf>(input_stream, cc);
+    }
+    return ProcessVectorWithPffft<Matrix>(input_stream, cc);
+  }
   switch (output_type_) {
     // These blocks deliberately ignore clang-format to preserve the
     // "silhouette" of the different cases.
@@ -466,6 +689,7 @@ absl::Status SpectrogramCalculator::ProcessVector(const Matrix& input_stream,
 }
 
 absl::Status SpectrogramCalculator::Close(CalculatorContext* cc) {
+  absl::Status status = absl::OkStatus();
   if (cumulative_input_samples_ > 0 && pad_final_packet_) {
     // We can flush any remaining samples by sending frame_step_samples - 1
     // zeros to the Process method, and letting it do its thing,
@@ -477,11 +701,14 @@ absl::Status SpectrogramCalculator::Close(CalculatorContext* cc) {
       required_padding_samples =
           frame_duration_samples_ - cumulative_input_samples_;
     }
-    return ProcessVector(
+    status = ProcessVector(
         Matrix::Zero(num_input_channels_, required_padding_samples), cc);
   }
-
-  return absl::OkStatus();
+  if (pffft_setup_) {
+    pffft_destroy_setup(pffft_setup_);
+    pffft_setup_ = nullptr;
+  }
+  return status;
 }
 
 }  // namespace mediapipe
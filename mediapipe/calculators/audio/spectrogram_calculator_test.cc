@@ -285,6 +285,24 @@ class SpectrogramCalculatorTest
     EXPECT_EQ(actual_largest_bin, target_bin);
   }
 
+  // Runs the graph with each FFT backend on a sinusoid split into packets of
+  // the given sizes, and returns the output packets of each run.
+  std::vector<std::vector<Packet>> RunWithEachFftBackend(
+      const std::vector<int>& packet_sizes_samples) {
+    std::vector<std::vector<Packet>> outputs;
+    for (auto backend : {SpectrogramCalculatorOptions::AUDIO_DSP,
+                         SpectrogramCalculatorOptions::PFFFT}) {
+      options_.set_fft_backend(backend);
+      InitializeGraph();
+      FillInputHeader();
+      SetupCosineInputPackets(packet_sizes_samples, 440.0);
+      EXPECT_TRUE(Run().ok());
+      CheckOutputHeadersAndTimestamps();
+      outputs.push_back(output().packets);
+    }
+    return outputs;
+  }
+
   int frame_duration_samples_;
   int frame_step_samples_;
   // Expected DC output for a window of pure 1.0, set when window length
@@ -846,6 +864,59 @@ TEST_F(SpectrogramCalculatorTest,
   }
 }
 
+TEST_F(SpectrogramCalculatorTest, PffftBackendMatchesAudioDsp) {
+  options_.set_frame_duration_seconds(100.0 / input_sample_rate_);
+  options_.set_frame_overlap_seconds(60.0 / input_sample_rate_);
+  options_.set_output_type(SpectrogramCalculatorOptions::LINEAR_MAGNITUDE);
+  // Packets shorter than a step, than a frame, and spanning several frames.
+  const std::vector<int> input_packet_sizes = {30, 50, 260, 7, 40, 45};
+
+  const auto outputs = RunWithEachFftBackend(input_packet_sizes);
+
+  ASSERT_EQ(outputs[0].size(), outputs[1].size());
+  for (int i = 0; i < outputs[0].size(); ++i) {
+    EXPECT_EQ(outputs[0][i].Timestamp(), outputs[1][i].Timestamp());
+    const Matrix& expected = outputs[0][i].Get<Matrix>();
+    const Matrix& actual = outputs[1][i].Get<Matrix>();
+    ASSERT_EQ(expected.rows(), actual.rows());
+    ASSERT_EQ(expected.cols(), actual.cols());
+    EXPECT_TRUE(actual.isApprox(expected, 1e-4));
+  }
+}
+
+TEST_F(SpectrogramCalculatorTest, PffftBackendMatchesAudioDspForComplex) {
+  options_.set_frame_duration_seconds(100.0 / input_sample_rate_);
+  options_.set_frame_overlap_seconds(60.0 / input_sample_rate_);
+  options_.set_allow_multichannel_input(true);
+  options_.set_output_type(SpectrogramCalculatorOptions::COMPLEX);
+  num_input_channels_ = 3;
+  const std::vector<int> input_packet_sizes = {50, 50, 130};
+
+  const auto outputs = RunWithEachFftBackend(input_packet_sizes);
+
+  ASSERT_EQ(outputs[0].size(), outputs[1].size());
+  for (int i = 0; i < outputs[0].size(); ++i) {
+    const auto& expected = outputs[0][i].Get<std::vector<Eigen::MatrixXcf>>();
+    const auto& actual = outputs[1][i].Get<std::vector<Eigen::MatrixXcf>>();
+    ASSERT_EQ(expected.size(), num_input_channels_);
+    ASSERT_EQ(actual.size(), num_input_channels_);
+    for (int channel = 0; channel < num_input_channels_; ++channel) {
+      ASSERT_EQ(expected[channel].cols(), actual[channel].cols());
+      EXPECT_TRUE(actual[channel].isApprox(expected[channel], 1e-4));
+    }
+  }
+}
+
+TEST_F(SpectrogramCalculatorTest, PffftBackendRejectsShortFrames) {
+  options_.set_frame_duration_seconds(16.0 / input_sample_rate_);
+  options_.set_fft_backend(SpectrogramCalculatorOptions::PFFFT);
+  InitializeGraph();
+  FillInputHeader();
+  SetupConstantInputPackets({16});
+
+  EXPECT_FALSE(Run().ok());
+}
+
 void BM_ProcessDC(benchmark::State& state) {
   CalculatorGraphConfig::Node node_config;
   node_config.set_calculator("SpectrogramCalculator");
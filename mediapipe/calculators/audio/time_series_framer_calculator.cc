@@ -15,9 +15,10 @@
 // Defines TimeSeriesFramerCalculator.
 #include <math.h>
 
-#include <deque>
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "Eigen/Core"
 #include "audio/dsp/window_functions.h"
@@ -64,6 +65,11 @@ namespace mediapipe {
 // done by adopting the timestamp of the first sample of the packet and this
 // sample's timestamp is inferred by initial_input_timestamp_ +
 // cumulative_completed_samples / sample_rate_.
+//
+// Pending samples are kept in a contiguous buffer, so every output frame is
+// copied with a single block copy, and frames are copied straight from the
+// input packet when no earlier samples are pending, e.g. for non-overlapping
+// frames and input packets of a multiple of the frame duration.
 class TimeSeriesFramerCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
@@ -88,10 +94,16 @@ class TimeSeriesFramerCalculator : public CalculatorBase {
   absl::Status Close(CalculatorContext* cc) override;
 
  private:
-  // Adds input data to the internal buffer.
-  void EnqueueInput(CalculatorContext* cc);
-  // Constructs and emits framed output packets.
-  void FrameOutput(CalculatorContext* cc);
+  // Adds the input samples from column `begin` onwards to the internal
+  // buffer.
+  void EnqueueInput(const Matrix& input_frame, int begin,
+                    const Timestamp& input_timestamp);
+  // Constructs and emits framed output packets from the columns [begin, end)
+  // of `samples`, where sample_timestamp(i) is the timestamp of column i.
+  // Returns the first column that later frames still need.
+  template <typename SampleTimestampFn>
+  int FrameOutput(const Matrix& samples, int begin, int end,
+                  SampleTimestampFn sample_timestamp, CalculatorContext* cc);
 
   Timestamp CurrentOutputTimestamp() {
     if (use_local_timestamp_) {
@@ -144,9 +156,14 @@ class TimeSeriesFramerCalculator : public CalculatorBase {
   Timestamp current_timestamp_;
   int num_channels_;
 
-  // Each entry in this deque consists of a single sample, i.e. a
-  // single column vector, and its timestamp.
-  std::deque<std::pair<Matrix, Timestamp>> sample_buffer_;
+  // The pending samples are the num_buffered_samples_ columns of
+  // sample_buffer_ from buffer_start_ onwards, and their timestamps are the
+  // same entries of sample_timestamps_. Samples are appended after them and
+  // moved back to the front of the buffer when it is full.
+  Matrix sample_buffer_;
+  std::vector<Timestamp> sample_timestamps_;
+  int buffer_start_;
+  int num_buffered_samples_;
 
   bool use_window_;
   Matrix window_;
@@ -155,44 +172,61 @@ class TimeSeriesFramerCalculator : public CalculatorBase {
 };
 REGISTER_CALCULATOR(TimeSeriesFramerCalculator);
 
-void TimeSeriesFramerCalculator::EnqueueInput(CalculatorContext* cc) {
-  const Matrix& input_frame = cc->Inputs().Index(0).Get<Matrix>();
-
-  for (int i = 0; i < input_frame.cols(); ++i) {
-    sample_buffer_.emplace_back(std::make_pair(
-        input_frame.col(i), CurrentSampleTimestamp(cc->InputTimestamp(), i)));
+void TimeSeriesFramerCalculator::EnqueueInput(
+    const Matrix& input_frame, int begin, const Timestamp& input_timestamp) {
+  const int num_samples = input_frame.cols() - begin;
+  if (num_samples == 0) {
+    return;
   }
+  if (buffer_start_ + num_buffered_samples_ + num_samples >
+      sample_buffer_.cols()) {
+    // Moves the pending samples to the front, and grows the buffer if that
+    // is not enough.
+    std::copy_n(sample_buffer_.data() + buffer_start_ * num_channels_,
+                num_buffered_samples_ * num_channels_, sample_buffer_.data());
+    std::copy_n(sample_timestamps_.begin() + buffer_start_,
+                num_buffered_samples_, sample_timestamps_.begin());
+    buffer_start_ = 0;
+    const int num_needed = num_buffered_samples_ + num_samples;
+    if (num_needed > sample_buffer_.cols()) {
+      const int capacity =
+          std::max<int>(num_needed, 2 * sample_buffer_.cols());
+      sample_buffer_.conservativeResize(Eigen::NoChange, capacity);
+      sample_timestamps_.resize(capacity);
+    }
+  }
+  const int end = buffer_start_ + num_buffered_samples_;
+  sample_buffer_.middleCols(end, num_samples) =
+      input_frame.middleCols(begin, num_samples);
+  for (int i = 0; i < num_samples; ++i) {
+    sample_timestamps_[end + i] =
+        CurrentSampleTimestamp(input_timestamp, begin + i);
+  }
+  num_buffered_samples_ += num_samples;
 }
 
-void TimeSeriesFramerCalculator::FrameOutput(CalculatorContext* cc) {
-  while (sample_buffer_.size() >=
-         frame_duration_samples_ + samples_still_to_drop_) {
-    while (samples_still_to_drop_ > 0) {
-      sample_buffer_.pop_front();
-      --samples_still_to_drop_;
+template <typename SampleTimestampFn>
+int TimeSeriesFramerCalculator::FrameOutput(const Matrix& samples, int begin,
+                                            int end,
+                                            SampleTimestampFn sample_timestamp,
+                                            CalculatorContext* cc) {
+  while (true) {
+    const int num_dropped = std::min(samples_still_to_drop_, end - begin);
+    begin += num_dropped;
+    samples_still_to_drop_ -= num_dropped;
+    if (end - begin < frame_duration_samples_) {
+      break;
     }
     const int frame_step_samples = next_frame_step_samples();
     std::unique_ptr<Matrix> output_frame(
-        new Matrix(num_channels_, frame_duration_samples_));
-    for (int i = 0; i < std::min(frame_step_samples, frame_duration_samples_);
-         ++i) {
-      output_frame->col(i) = sample_buffer_.front().first;
-      current_timestamp_ = sample_buffer_.front().second;
-      sample_buffer_.pop_front();
-    }
-    const int frame_overlap_samples =
-        frame_duration_samples_ - frame_step_samples;
-    if (frame_overlap_samples > 0) {
-      for (int i = 0; i < frame_overlap_samples; ++i) {
-        output_frame->col(i + frame_step_samples) = sample_buffer_[i].first;
-        current_timestamp_ = sample_buffer_[i].second;
-      }
-    } else {
-      samples_still_to_drop_ = -frame_overlap_samples;
-    }
+        new Matrix(samples.middleCols(begin, frame_duration_samples_)));
+    current_timestamp_ = sample_timestamp(begin + frame_duration_samples_ - 1);
+    begin += std::min(frame_step_samples, frame_duration_samples_);
+    samples_still_to_drop_ =
+        std::max(frame_step_samples - frame_duration_samples_, 0);
 
     if (use_window_) {
-      *output_frame = (output_frame->array() * window_.array()).matrix();
+      output_frame->array() *= window_.array();
     }
 
     cc->Outputs().Index(0).Add(output_frame.release(),
@@ -200,12 +234,7 @@ void TimeSeriesFramerCalculator::FrameOutput(CalculatorContext* cc) {
     ++cumulative_output_frames_;
     cumulative_completed_samples_ += frame_step_samples;
   }
-  if (!use_local_timestamp_) {
-    // In non-local timestamp mode the timestamp of the next packet will be
-    // equal to CumulativeOutputTimestamp(). Inform the framework about this
-    // fact to enable packet queueing optimizations.
-    cc->Outputs().Index(0).SetNextTimestampBound(CumulativeOutputTimestamp());
-  }
+  return begin;
 }
 
 absl::Status TimeSeriesFramerCalculator::Process(CalculatorContext* cc) {
@@ -214,24 +243,45 @@ absl::Status TimeSeriesFramerCalculator::Process(CalculatorContext* cc) {
     current_timestamp_ = initial_input_timestamp_;
   }
 
-  EnqueueInput(cc);
-  FrameOutput(cc);
+  const Matrix& input_frame = cc->Inputs().Index(0).Get<Matrix>();
+  const Timestamp input_timestamp = cc->InputTimestamp();
+  int input_begin = 0;
+  if (num_buffered_samples_ == 0) {
+    // No earlier samples are pending, so frames are copied straight from the
+    // input packet.
+    input_begin = FrameOutput(
+        input_frame, 0, input_frame.cols(),
+        [this, &input_timestamp](int i) {
+          return CurrentSampleTimestamp(input_timestamp, i);
+        },
+        cc);
+  }
+  EnqueueInput(input_frame, input_begin, input_timestamp);
+  const int buffer_end = buffer_start_ + num_buffered_samples_;
+  buffer_start_ = FrameOutput(
+      sample_buffer_, buffer_start_, buffer_end,
+      [this](int i) { return sample_timestamps_[i]; }, cc);
+  num_buffered_samples_ = buffer_end - buffer_start_;
+
+  if (!use_local_timestamp_) {
+    // In non-local timestamp mode the timestamp of the next packet will be
+    // equal to CumulativeOutputTimestamp(). Inform the framework about this
+    // fact to enable packet queueing optimizations.
+    cc->Outputs().Index(0).SetNextTimestampBound(CumulativeOutputTimestamp());
+  }
 
   return absl::OkStatus();
 }
 
 absl::Status TimeSeriesFramerCalculator::Close(CalculatorContext* cc) {
-  while (samples_still_to_drop_ > 0 && !sample_buffer_.empty()) {
-    sample_buffer_.pop_front();
-    --samples_still_to_drop_;
-  }
-  if (!sample_buffer_.empty() && pad_final_packet_) {
+  // Samples still to drop are only left over when no sample is pending.
+  if (num_buffered_samples_ > 0 && pad_final_packet_) {
     std::unique_ptr<Matrix> output_frame(new Matrix);
     output_frame->setZero(num_channels_, frame_duration_samples_);
-    for (int i = 0; i < sample_buffer_.size(); ++i) {
-      output_frame->col(i) = sample_buffer_[i].first;
-      current_timestamp_ = sample_buffer_[i].second;
-    }
+    output_frame->leftCols(num_buffered_samples_) =
+        sample_buffer_.middleCols(buffer_start_, num_buffered_samples_);
+    current_timestamp_ =
+        sample_timestamps_[buffer_start_ + num_buffered_samples_ - 1];
 
     cc->Outputs().Index(0).Add(output_frame.release(),
                                CurrentOutputTimestamp());
@@ -293,6 +343,10 @@ absl::Status TimeSeriesFramerCalculator::Open(CalculatorContext* cc) {
   samples_still_to_drop_ = 0;
   initial_input_timestamp_ = Timestamp::Unstarted();
   current_timestamp_ = Timestamp::Unstarted();
+  sample_buffer_.resize(num_channels_, 2 * frame_duration_samples_);
+  sample_timestamps_.resize(2 * frame_duration_samples_);
+  buffer_start_ = 0;
+  num_buffered_samples_ = 0;
 
   std::vector<double> window_vector;
   use_window_ = false;
@@ -248,6 +248,16 @@ TEST_F(TimeSeriesFramerCalculatorTest,
   CheckOutput();
 }
 
+TEST_F(TimeSeriesFramerCalculatorTest,
+       IntegerSampleDurationNoOverlapWholeInputPackets) {
+  // Every input packet is a multiple of the frame duration, so no samples are
+  // left pending between packets.
+  options_.set_frame_duration_seconds(20.0 / input_sample_rate_);
+  options_.set_window_function(TimeSeriesFramerCalculatorOptions::HANN);
+  MP_ASSERT_OK(Run());
+  CheckOutput();
+}
+
 TEST_F(TimeSeriesFramerCalculatorTest, IntegerSampleDurationAndOverlap) {
   options_.set_frame_duration_seconds(100.0 / input_sample_rate_);
   options_.set_frame_overlap_seconds(40.0 / input_sample_rate_);
@@ -12,10 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "mediapipe/calculators/core/begin_loop_calculator.h"
 #include "mediapipe/calculators/core/end_loop_calculator.h"
 #include "mediapipe/framework/calculator_contract.h"
@@ -25,6 +29,7 @@
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status_matchers.h"  // NOLINT
 
 namespace mediapipe {
@@ -444,5 +449,100 @@ TEST_F(BeginEndLoopCalculatorGraphWithClonedInputsTest, MultipleVectors) {
                   PacketOfIntsEq(input_timestamp2, std::vector<int>{6, 9})));
 }
 
+// Increments the input like IncrementCalculator, but only once
+// kParallelLoopDegree invocations have run concurrently, to check that loop
+// iterations overlap. Earlier elements finish last, to check that the results
+// are still collected in order.
+constexpr int kParallelLoopDegree = 2;
+
+class ParallelIncrementCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).Set<int>();
+    cc->Outputs().Index(0).Set<int>();
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    cc->SetOffset(TimestampDiff(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    const int& input_int = cc->Inputs().Index(0).Get<int>();
+    {
+      absl::MutexLock lock(&mutex_);
+      ++num_running_;
+      max_num_running_ = std::max(max_num_running_, num_running_);
+      auto parallel = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+        return max_num_running_ >= kParallelLoopDegree;
+      };
+      RET_CHECK(mutex_.AwaitWithTimeout(absl::Condition(&parallel),
+                                        absl::Seconds(10)))
+          << "Loop iterations didn't run in parallel.";
+    }
+    absl::SleepFor(absl::Milliseconds(
+        10 * (kParallelLoopDegree - input_int % kParallelLoopDegree)));
+    {
+      absl::MutexLock lock(&mutex_);
+      --num_running_;
+    }
+    auto output_int = absl::make_unique<int>(input_int + 1);
+    cc->Outputs().Index(0).Add(output_int.release(), cc->InputTimestamp());
+    return absl::OkStatus();
+  }
+
+ private:
+  absl::Mutex mutex_;
+  int num_running_ ABSL_GUARDED_BY(mutex_) = 0;
+  int max_num_running_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+REGISTER_CALCULATOR(ParallelIncrementCalculator);
+
+TEST(BeginEndLoopCalculatorGraphParallelTest, CollectsParallelResultsInOrder) {
+  auto graph_config = ParseTextProtoOrDie<CalculatorGraphConfig>(
+      R"pb(
+        num_threads: 4
+        input_stream: "ints"
+        node {
+          calculator: "BeginLoopIntegerCalculator"
+          input_stream: "ITERABLE:ints"
+          output_stream: "ITEM:int"
+          output_stream: "BATCH_END:timestamp"
+        }
+        node {
+          calculator: "ParallelIncrementCalculator"
+          input_stream: "int"
+          output_stream: "int_plus_one"
+          max_in_flight: 2
+        }
+        node {
+          calculator: "EndLoopIntegersCalculator"
+          input_stream: "ITEM:int_plus_one"
+          input_stream: "BATCH_END:timestamp"
+          output_stream: "ITERABLE:ints_plus_one"
+        }
+      )pb");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("ints_plus_one", &graph_config, &output_packets);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(graph_config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "ints", MakePacket<std::vector<int>>(std::vector<int>{0, 1})
+                  .At(Timestamp(0))));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "ints", MakePacket<std::vector<int>>(std::vector<int>{2, 3, 4, 5})
+                  .At(Timestamp(1))));
+  MP_ASSERT_OK(graph.CloseAllPacketSources());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  EXPECT_THAT(output_packets,
+              testing::ElementsAre(
+                  PacketOfIntsEq(Timestamp(0), std::vector<int>{1, 2}),
+                  PacketOfIntsEq(Timestamp(1), std::vector<int>{3, 4, 5, 6})));
+}
+
 }  // namespace
 }  // namespace mediapipe
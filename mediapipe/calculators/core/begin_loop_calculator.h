@@ -56,6 +56,14 @@ namespace mediapipe {
 // streams at loop timestamps. This ensures that a MediaPipe graph or sub-graph
 // can run multiple times, once per element in the "ITERABLE" for each pakcet
 // clone of the packets in the "CLONE" input streams.
+//
+// All elements of a collection are emitted at once, so the loop body can
+// process several of them concurrently if its nodes are stateless: setting
+// "max_in_flight: N" on the loop body node (or on a loop body subgraph, for
+// all its nodes) lets up to N elements run in parallel on the graph executor,
+// which needs at least N threads. Outputs of parallel invocations are still
+// delivered in timestamp order, so EndLoopCalculator collects the results in
+// the order of the input collection.
 template <typename IterableT>
 class BeginLoopCalculator : public CalculatorBase {
   using ItemT = typename IterableT::value_type;
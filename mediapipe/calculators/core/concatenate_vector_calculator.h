@@ -38,6 +38,9 @@ namespace mediapipe {
 // index order. This class assumes that every input stream contains either T or
 // vector<T> type. To use this class for a particular type T, regisiter a
 // calculator using ConcatenateVectorCalculator<T>.
+// Inputs that are owned only by this calculator are moved into the output.
+// The others are copied if T is copyable, which is counted by the
+// "CopiedInputs" counter, and fail the calculator otherwise.
 template <typename T>
 class ConcatenateVectorCalculator : public api2::Node {
  public:
@@ -71,8 +74,14 @@ class ConcatenateVectorCalculator : public api2::Node {
   template <typename U>
   absl::Status ConcatenateVectors(std::true_type, CalculatorContext* cc) {
     auto output = std::vector<U>();
-    for (const auto& input : kIn(cc)) {
+    for (auto input : kIn(cc)) {
       if (input.IsEmpty()) continue;
+      // Inputs owned only by this calculator are moved, the others copied.
+      if (ConsumeAndAppend<U>(std::is_move_constructible<U>(), &input, &output)
+              .ok()) {
+        continue;
+      }
+      cc->GetCounter(kCopiedInputsCounter)->Increment();
       input.Visit([&output](const U& value) { output.push_back(value); },
                   [&output](const std::vector<U>& value) {
                     output.insert(output.end(), value.begin(), value.end());
@@ -93,14 +102,8 @@ class ConcatenateVectorCalculator : public api2::Node {
     auto output = std::vector<U>();
     for (auto input : kIn(cc)) {
       if (input.IsEmpty()) continue;
-      MP_RETURN_IF_ERROR(input.ConsumeAndVisit(
-          [&output](std::unique_ptr<U> value) {
-            output.push_back(std::move(*value));
-          },
-          [&output](std::unique_ptr<std::vector<U>> value) {
-            output.insert(output.end(), std::make_move_iterator(value->begin()),
-                          std::make_move_iterator(value->end()));
-          }));
+      MP_RETURN_IF_ERROR(
+          ConsumeAndAppend<U>(std::true_type(), &input, &output));
     }
     kOut(cc).Send(std::move(output));
     return absl::OkStatus();
@@ -113,6 +116,31 @@ class ConcatenateVectorCalculator : public api2::Node {
         "Cannot copy or move inputs to concatenate them");
   }
 
+  // Moves the elements of `input` to the end of `output`. Fails without
+  // changing either if the input packet isn't owned only by this calculator.
+  template <typename U, typename InputT>
+  static absl::Status ConsumeAndAppend(std::true_type, InputT* input,
+                                       std::vector<U>* output) {
+    return input->ConsumeAndVisit(
+        [output](std::unique_ptr<U> value) {
+          output->push_back(std::move(*value));
+        },
+        [output](std::unique_ptr<std::vector<U>> value) {
+          output->insert(output->end(),
+                         std::make_move_iterator(value->begin()),
+                         std::make_move_iterator(value->end()));
+        });
+  }
+
+  template <typename U, typename InputT>
+  static absl::Status ConsumeAndAppend(std::false_type, InputT* input,
+                                       std::vector<U>* output) {
+    return absl::FailedPreconditionError("Cannot move inputs.");
+  }
+
+  // Counts the inputs that were copied because they had other owners.
+  static constexpr char kCopiedInputsCounter[] = "CopiedInputs";
+
  private:
   bool only_emit_if_all_present_;
 };
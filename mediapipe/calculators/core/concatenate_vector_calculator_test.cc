@@ -286,6 +286,46 @@ void AddInputVectors(const std::vector<std::vector<float>>& inputs,
   }
 }
 
+TEST(TestConcatenateIntVectorCalculatorTest, CopiesOnlySharedInputs) {
+  // Note: CalculatorRunner keeps copies of input packets, so a graph is used
+  // to send packets that are owned only by the calculator.
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "in_1"
+        input_stream: "in_2"
+        node {
+          calculator: "TestConcatenateIntVectorCalculator"
+          input_stream: "in_1"
+          input_stream: "in_2"
+          output_stream: "out"
+        }
+      )pb");
+  std::vector<Packet> outputs;
+  tool::AddVectorSink("out", &graph_config, &outputs);
+
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(graph_config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "in_1",
+      MakePacket<std::vector<int>>(std::vector<int>{0, 1}).At(Timestamp(1))));
+  // This packet has another owner, so its elements must be copied.
+  Packet shared_input =
+      MakePacket<std::vector<int>>(std::vector<int>{2, 3}).At(Timestamp(1));
+  MP_ASSERT_OK(graph.AddPacketToInputStream("in_2", shared_input));
+  MP_ASSERT_OK(graph.CloseAllPacketSources());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_THAT(outputs[0].Get<std::vector<int>>(),
+              testing::ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(shared_input.Get<std::vector<int>>(), testing::ElementsAre(2, 3));
+  EXPECT_EQ(1,
+            graph.GetCounterFactory()
+                ->GetCounter("TestConcatenateIntVectorCalculator-CopiedInputs")
+                ->Get());
+}
+
 TEST(ConcatenateFloatVectorCalculatorTest, EmptyVectorInputs) {
   CalculatorRunner runner("ConcatenateFloatVectorCalculator",
                           /*options_string=*/"", /*num_inputs=*/3,
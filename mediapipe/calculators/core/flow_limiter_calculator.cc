@@ -18,6 +18,7 @@
 
 #include "mediapipe/calculators/core/flow_limiter_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/memory_budget.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/util/header_util.h"
@@ -70,6 +71,10 @@ constexpr char kOptionsTag[] = "OPTIONS";
 // input streams are treated as auxiliary input streams.  The auxiliary input
 // streams are limited to timestamps passed on the main input stream.
 //
+// If the graph provides kMemoryBudgetService, then while the budget is
+// exceeded a frame is released only when no frame is in flight, and the other
+// frames are dropped regardless of `max_in_queue`.
+//
 class FlowLimiterCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
@@ -89,6 +94,7 @@ class FlowLimiterCalculator : public CalculatorBase {
     cc->Outputs().Tag(kAllowTag).Set<bool>().Optional();
     cc->SetInputStreamHandler("ImmediateInputStreamHandler");
     cc->SetProcessTimestampBounds(true);
+    cc->UseService(kMemoryBudgetService).Optional();
     return absl::OkStatus();
   }
 
@@ -100,6 +106,8 @@ class FlowLimiterCalculator : public CalculatorBase {
           cc->InputSidePackets().Tag(kMaxInFlightTag).Get<int>());
     }
     input_queues_.resize(cc->Inputs().NumEntries(""));
+    dropped_counter_ = cc->GetCounter("Dropped");
+    memory_budget_ = cc->Service(kMemoryBudgetService);
     RET_CHECK_OK(CopyInputHeadersToOutputs(cc->Inputs(), &(cc->Outputs())));
     return absl::OkStatus();
   }
@@ -107,7 +115,14 @@ class FlowLimiterCalculator : public CalculatorBase {
   // Returns true if an additional frame can be released for processing.
   // The "ALLOW" output stream indicates this condition at each input frame.
   bool ProcessingAllowed() {
-    return frames_in_flight_.size() < options_.max_in_flight();
+    return frames_in_flight_.size() < options_.max_in_flight() &&
+           (frames_in_flight_.empty() || !OverMemoryBudget());
+  }
+
+  // Returns true if the graph memory budget is exceeded.
+  bool OverMemoryBudget() {
+    return memory_budget_.IsAvailable() &&
+           memory_budget_.GetObject().IsExceeded();
   }
 
   // Outputs a packet indicating whether a frame was sent or dropped.
@@ -204,10 +219,16 @@ class FlowLimiterCalculator : public CalculatorBase {
     // Limit the number of queued frames.
     // Note that frames can be dropped after frames are released because
     // frame-packets and FINISH-packets never arrive in the same Process call.
-    while (input_queue.size() > options_.max_in_queue()) {
+    const bool over_memory_budget = OverMemoryBudget();
+    const int max_in_queue = over_memory_budget ? 0 : options_.max_in_queue();
+    while (input_queue.size() > max_in_queue) {
       Packet packet = input_queue.front();
       input_queue.pop_front();
       SendAllow(false, packet.Timestamp(), cc);
+      dropped_counter_->Increment();
+      if (over_memory_budget) {
+        memory_budget_.GetObject().RecordDropped();
+      }
     }
 
     // Propagate the input timestamp bound.
@@ -231,6 +252,10 @@ class FlowLimiterCalculator : public CalculatorBase {
   FlowLimiterCalculatorOptions options_;
   std::vector<std::deque<Packet>> input_queues_;
   std::deque<Timestamp> frames_in_flight_;
+  // Counts the frames dropped from the main input queue.
+  Counter* dropped_counter_ = nullptr;
+  // The graph memory budget, if the graph provides one.
+  ServiceBinding<MemoryBudget> memory_budget_;
 };
 REGISTER_CALCULATOR(FlowLimiterCalculator);
 
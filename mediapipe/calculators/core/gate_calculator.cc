@@ -137,6 +137,7 @@ class GateCalculator : public CalculatorBase {
     if (cc->Outputs().HasTag(kStateChangeTag)) {
       cc->Outputs().Tag(kStateChangeTag).Set<bool>();
     }
+    cc->SetInlineable(true);
 
     return absl::OkStatus();
   }
@@ -12,7 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <vector>
+
 #include "Eigen/Core"
+#include "mediapipe/calculators/core/matrix_multiply_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/matrix.h"
@@ -23,27 +26,116 @@ namespace api2 {
 // Perform a (left) matrix multiply.  Meaning (output = A * input)
 // where A is the matrix which is provided as an input side packet.
 //
+// If the optional SUBTRAHEND side packet M is provided, the output is
+// A * (input - M), e.g. a PCA projection of mean-subtracted samples. A * M is
+// computed once in Open(), which saves a MatrixSubtractCalculator and its
+// intermediate matrix per sample.
+//
+// To amortize the cost of reading A, which dominates for large matrices such
+// as PCA projections, single-column inputs can be batched: with
+// `batch_size: N`, N consecutive samples are multiplied by A as one
+// matrix-matrix product and then sent at their own timestamps. Outputs are
+// delayed by up to N - 1 packets.
+//
 // Example config:
 // node {
 //   calculator: "MatrixMultiplyCalculator"
 //   input_stream: "samples"
 //   output_stream: "multiplied_samples"
 //   input_side_packet: "multiplication_matrix"
+//   input_side_packet: "SUBTRAHEND:mean_matrix"  # optional
+//   options {
+//     [mediapipe.MatrixMultiplyCalculatorOptions.ext] {
+//       batch_size: 16  # optional
+//     }
+//   }
 // }
 class MatrixMultiplyCalculator : public Node {
  public:
   static constexpr Input<Matrix> kIn{""};
   static constexpr Output<Matrix> kOut{""};
   static constexpr SideInput<Matrix> kSide{""};
+  static constexpr SideInput<Matrix>::Optional kSubtrahend{"SUBTRAHEND"};
 
-  MEDIAPIPE_NODE_CONTRACT(kIn, kOut, kSide);
+  MEDIAPIPE_NODE_CONTRACT(kIn, kOut, kSide, kSubtrahend);
 
+  absl::Status Open(CalculatorContext* cc) override;
   absl::Status Process(CalculatorContext* cc) override;
+  absl::Status Close(CalculatorContext* cc) override;
+
+ private:
+  // Multiplies the pending single-column inputs as one matrix and sends one
+  // output per input.
+  absl::Status Flush(CalculatorContext* cc);
+
+  int batch_size_ = 1;
+  // A * M, if SUBTRAHEND is provided.
+  Matrix offset_;
+  std::vector<Packet<Matrix>> pending_;
 };
 MEDIAPIPE_REGISTER_NODE(MatrixMultiplyCalculator);
 
+absl::Status MatrixMultiplyCalculator::Open(CalculatorContext* cc) {
+  batch_size_ = cc->Options<MatrixMultiplyCalculatorOptions>().batch_size();
+  RET_CHECK_GE(batch_size_, 1);
+  pending_.reserve(batch_size_);
+  if (kSubtrahend(cc).IsConnected()) {
+    RET_CHECK_EQ(kSide(cc)->cols(), kSubtrahend(cc)->rows())
+        << "The subtrahend must have as many rows as the matrix has columns.";
+    offset_ = *kSide(cc) * *kSubtrahend(cc);
+  }
+  return absl::OkStatus();
+}
+
 absl::Status MatrixMultiplyCalculator::Process(CalculatorContext* cc) {
-  kOut(cc).Send(*kSide(cc) * *kIn(cc));
+  const Matrix& input = *kIn(cc);
+  if (batch_size_ > 1 && input.cols() == 1) {
+    RET_CHECK_EQ(input.rows(), kSide(cc)->cols());
+    pending_.push_back(kIn(cc));
+    if (pending_.size() >= batch_size_) {
+      MP_RETURN_IF_ERROR(Flush(cc));
+    }
+    return absl::OkStatus();
+  }
+  // Outputs must be sent in timestamp order.
+  MP_RETURN_IF_ERROR(Flush(cc));
+
+  Matrix product(kSide(cc)->rows(), input.cols());
+  product.noalias() = *kSide(cc) * input;
+  if (kSubtrahend(cc).IsConnected()) {
+    if (product.cols() != offset_.cols()) {
+      return absl::InvalidArgumentError(
+          "Input and subtrahend must have the same dimensions.");
+    }
+    product -= offset_;
+  }
+  kOut(cc).Send(std::move(product));
+  return absl::OkStatus();
+}
+
+absl::Status MatrixMultiplyCalculator::Close(CalculatorContext* cc) {
+  return Flush(cc);
+}
+
+absl::Status MatrixMultiplyCalculator::Flush(CalculatorContext* cc) {
+  if (pending_.empty()) return absl::OkStatus();
+  if (kSubtrahend(cc).IsConnected() && offset_.cols() != 1) {
+    return absl::InvalidArgumentError(
+        "Input and subtrahend must have the same dimensions.");
+  }
+  Matrix samples(kSide(cc)->cols(), pending_.size());
+  for (int i = 0; i < pending_.size(); ++i) {
+    samples.col(i) = pending_[i].Get();
+  }
+  Matrix products(kSide(cc)->rows(), pending_.size());
+  products.noalias() = *kSide(cc) * samples;
+  if (kSubtrahend(cc).IsConnected()) {
+    products.colwise() -= offset_.col(0);
+  }
+  for (int i = 0; i < pending_.size(); ++i) {
+    kOut(cc).Send(Matrix(products.col(i)), pending_[i].timestamp());
+  }
+  pending_.clear();
   return absl::OkStatus();
 }
 
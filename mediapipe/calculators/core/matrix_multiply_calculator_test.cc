@@ -16,12 +16,14 @@
 #include <vector>
 
 #include "Eigen/Core"
+#include "mediapipe/calculators/core/matrix_multiply_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/status_matchers.h"
 #include "mediapipe/framework/tool/validate_type.h"
 
@@ -235,5 +237,100 @@ TEST(MatrixMultiplyCalculatorTest, Multiply) {
   EXPECT_EQ(samples.cols(), i);
 }
 
+// Send samples through the MatrixMultiplyCalculator with a SUBTRAHEND, which
+// is subtracted from every sample before the multiplication.
+TEST(MatrixMultiplyCalculatorTest, MultiplyWithSubtrahend) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "MatrixMultiplyCalculator"
+    input_stream: "samples"
+    output_stream: "multiplied_samples"
+    input_side_packet: "multiplication_matrix"
+    input_side_packet: "SUBTRAHEND:mean"
+  )pb"));
+  Matrix* matrix = new Matrix();
+  MatrixFromTextProto(kMatrixText, matrix);
+  runner.MutableSidePackets()->Index(0) = Adopt(matrix);
+  Matrix* mean = new Matrix(4, 1);
+  *mean << 1, 2, 3, 4;
+  runner.MutableSidePackets()->Tag("SUBTRAHEND") = Adopt(mean);
+
+  Matrix samples;
+  MatrixFromTextProto(kSamplesText, &samples);
+  for (int i = 0; i < samples.cols(); ++i) {
+    Eigen::MatrixXf* sample = new Eigen::MatrixXf(samples.block(0, i, 4, 1));
+    runner.MutableInputs()->Index(0).packets.push_back(
+        Adopt(sample).At(Timestamp(i)));
+  }
+
+  MP_ASSERT_OK(runner.Run());
+  ASSERT_EQ(samples.cols(), runner.Outputs().Index(0).packets.size());
+  for (int i = 0; i < samples.cols(); ++i) {
+    const Matrix& result = runner.Outputs().Index(0).packets[i].Get<Matrix>();
+    const Matrix expected =
+        runner.MutableSidePackets()->Index(0).Get<Matrix>() *
+        (samples.block(0, i, 4, 1) - *mean);
+    ASSERT_EQ(3, result.rows());
+    EXPECT_NEAR((expected - result).cwiseAbs().sum(), 0.0, 1e-2);
+  }
+}
+
+// Batched samples give the same outputs, at the same timestamps, as unbatched
+// ones, including the final partial batch which is flushed on Close().
+TEST(MatrixMultiplyCalculatorTest, MultiplyBatched) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "MatrixMultiplyCalculator"
+    input_stream: "samples"
+    output_stream: "multiplied_samples"
+    input_side_packet: "multiplication_matrix"
+    input_side_packet: "SUBTRAHEND:mean"
+    options {
+      [mediapipe.MatrixMultiplyCalculatorOptions.ext] { batch_size: 3 }
+    }
+  )pb"));
+  Matrix matrix;
+  MatrixFromTextProto(kMatrixText, &matrix);
+  runner.MutableSidePackets()->Index(0) = MakePacket<Matrix>(matrix);
+  Matrix mean(4, 1);
+  mean << 1, 2, 3, 4;
+  runner.MutableSidePackets()->Tag("SUBTRAHEND") = MakePacket<Matrix>(mean);
+
+  Matrix samples;
+  MatrixFromTextProto(kSamplesText, &samples);
+  for (int i = 0; i < samples.cols(); ++i) {
+    runner.MutableInputs()->Index(0).packets.push_back(
+        MakePacket<Matrix>(samples.block(0, i, 4, 1)).At(Timestamp(i)));
+  }
+
+  MP_ASSERT_OK(runner.Run());
+  const auto& outputs = runner.Outputs().Index(0).packets;
+  ASSERT_EQ(samples.cols(), outputs.size());
+  for (int i = 0; i < samples.cols(); ++i) {
+    EXPECT_EQ(Timestamp(i), outputs[i].Timestamp());
+    const Matrix& result = outputs[i].Get<Matrix>();
+    const Matrix expected = matrix * (samples.block(0, i, 4, 1) - mean);
+    ASSERT_EQ(3, result.rows());
+    ASSERT_EQ(1, result.cols());
+    EXPECT_NEAR((expected - result).cwiseAbs().sum(), 0.0, 1e-2);
+  }
+}
+
+// The subtrahend must match the columns of the matrix.
+TEST(MatrixMultiplyCalculatorTest, RejectsSubtrahendOfWrongSize) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "MatrixMultiplyCalculator"
+    input_stream: "samples"
+    output_stream: "multiplied_samples"
+    input_side_packet: "multiplication_matrix"
+    input_side_packet: "SUBTRAHEND:mean"
+  )pb"));
+  Matrix* matrix = new Matrix();
+  MatrixFromTextProto(kMatrixText, matrix);
+  runner.MutableSidePackets()->Index(0) = Adopt(matrix);
+  runner.MutableSidePackets()->Tag("SUBTRAHEND") =
+      MakePacket<Matrix>(Matrix::Zero(3, 1));
+
+  EXPECT_FALSE(runner.Run().ok());
+}
+
 }  // namespace
 }  // namespace mediapipe
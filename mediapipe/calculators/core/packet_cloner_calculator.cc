@@ -66,6 +66,7 @@ class PacketClonerCalculator : public CalculatorBase {
       cc->Outputs().Get(in_out.out).SetSameAs(&input);
     }
     cc->Inputs().Get(ids.tick_id).SetAny();
+    cc->SetInlineable(true);
     return absl::OkStatus();
   }
 
@@ -15,6 +15,7 @@
 #include "mediapipe/calculators/core/packet_resampler_calculator.h"
 
 #include <memory>
+#include <utility>
 
 namespace {
 // Reflect an integer against the lower and upper bound of an interval.
@@ -120,6 +121,7 @@ absl::Status PacketResamplerCalculator::Open(CalculatorContext* cc) {
   frame_time_usec_ = static_cast<int64>(1000000.0 / frame_rate_);
   jitter_usec_ = static_cast<int64>(1000000.0 * jitter_ / frame_rate_);
   RET_CHECK_LE(jitter_usec_, frame_time_usec_);
+  limits_margin_ = TimestampDiff(round_limits_ ? frame_time_usec_ / 2 : 0);
 
   video_header_.frame_rate = frame_rate_;
 
@@ -213,11 +215,10 @@ int64 PacketResamplerCalculator::TimestampToPeriodIndex(
 }
 
 void PacketResamplerCalculator::OutputWithinLimits(CalculatorContext* cc,
-                                                   const Packet& packet) const {
-  TimestampDiff margin((round_limits_) ? frame_time_usec_ / 2 : 0);
-  if (packet.Timestamp() >= start_time_ - margin &&
-      packet.Timestamp() < end_time_ + margin) {
-    cc->Outputs().Get(output_data_id_).AddPacket(packet);
+                                                   Packet packet) const {
+  if (packet.Timestamp() >= start_time_ - limits_margin_ &&
+      packet.Timestamp() < end_time_ + limits_margin_) {
+    cc->Outputs().Get(output_data_id_).AddPacket(std::move(packet));
   }
 }
 
@@ -265,8 +266,8 @@ absl::Status LegacyJitterWithReflectionStrategy::Process(
   if (packet_reservoir_->IsEnabled() &&
       (first_timestamp_ == Timestamp::Unset() ||
        (cc->InputTimestamp() - next_output_timestamp_min_).Value() >= 0)) {
-    auto curr_packet = cc->Inputs().Get(calculator_->input_data_id_).Value();
-    packet_reservoir_->AddSample(curr_packet);
+    packet_reservoir_->AddSample(
+        cc->Inputs().Get(calculator_->input_data_id_).Value());
   }
 
   if (first_timestamp_ == Timestamp::Unset()) {
@@ -288,6 +289,7 @@ absl::Status LegacyJitterWithReflectionStrategy::Process(
         << "Adding jitter is not very useful when upsampling.";
   }
 
+  bool emitted = false;
   while (true) {
     const int64 last_diff =
         (next_output_timestamp_ - calculator_->last_packet_.Timestamp())
@@ -304,16 +306,19 @@ absl::Status LegacyJitterWithReflectionStrategy::Process(
                  : cc->Inputs().Get(calculator_->input_data_id_).Value())
                 .At(next_output_timestamp_));
     UpdateNextOutputTimestampWithJitter();
+    emitted = true;
+  }
+  if (emitted) {
     // From now on every time a packet is emitted the timestamp of the next
     // packet becomes known; that timestamp is stored in next_output_timestamp_.
     // The only exception to this rule is the packet emitted from Close() which
     // can only happen when jitter_with_reflection is enabled but in this case
     // next_output_timestamp_min_ is a non-decreasing lower bound of any
-    // subsequent packet.
-    const Timestamp timestamp_bound = next_output_timestamp_min_;
+    // subsequent packet. The bound is set once for all the packets emitted
+    // above, which have increasing timestamps.
     cc->Outputs()
         .Get(calculator_->output_data_id_)
-        .SetNextTimestampBound(timestamp_bound);
+        .SetNextTimestampBound(next_output_timestamp_min_);
   }
   return absl::OkStatus();
 }
@@ -425,7 +430,7 @@ absl::Status ReproducibleJitterWithReflectionStrategy::Process(
          next_output_timestamp_ <= current_packet.Timestamp()) {
     // last_packet < next_output_timestamp_ <= current_packet,
     // so emit the closest packet.
-    Packet packet_to_emit =
+    const Packet& packet_to_emit =
         current_packet.Timestamp() - next_output_timestamp_ <
                 next_output_timestamp_ - calculator_->last_packet_.Timestamp()
             ? current_packet
@@ -535,8 +540,8 @@ absl::Status JitterWithoutReflectionStrategy::Process(CalculatorContext* cc) {
   if (packet_reservoir_->IsEnabled() &&
       (calculator_->first_timestamp_ == Timestamp::Unset() ||
        (cc->InputTimestamp() - next_output_timestamp_min_).Value() >= 0)) {
-    auto curr_packet = cc->Inputs().Get(calculator_->input_data_id_).Value();
-    packet_reservoir_->AddSample(curr_packet);
+    packet_reservoir_->AddSample(
+        cc->Inputs().Get(calculator_->input_data_id_).Value());
   }
 
   if (calculator_->first_timestamp_ == Timestamp::Unset()) {
@@ -558,6 +563,7 @@ absl::Status JitterWithoutReflectionStrategy::Process(CalculatorContext* cc) {
         << "Adding jitter is not very useful when upsampling.";
   }
 
+  bool emitted = false;
   while (true) {
     const int64 last_diff =
         (next_output_timestamp_ - calculator_->last_packet_.Timestamp())
@@ -574,6 +580,10 @@ absl::Status JitterWithoutReflectionStrategy::Process(CalculatorContext* cc) {
                  : cc->Inputs().Get(calculator_->input_data_id_).Value())
                 .At(next_output_timestamp_));
     UpdateNextOutputTimestamp();
+    emitted = true;
+  }
+  if (emitted) {
+    // Set once for all the packets emitted above.
     cc->Outputs()
         .Get(calculator_->output_data_id_)
         .SetNextTimestampBound(next_output_timestamp_);
@@ -4,6 +4,7 @@
 #include <cstdlib>
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "absl/strings/str_cat.h"
 #include "mediapipe/calculators/core/packet_resampler_calculator.pb.h"
@@ -27,7 +28,7 @@ class PacketReservoir {
   // Replace candidate with current packet with 1/count_ probability.
   void AddSample(Packet sample) {
     if (rng_->UnbiasedUniform(++count_) == 0) {
-      reservoir_ = sample;
+      reservoir_ = std::move(sample);
     }
   }
   bool IsEnabled() { return rng_ && enabled_; }
@@ -91,7 +92,11 @@ class PacketReservoir {
 //     example). In case of ties, later packets are chosen.
 //   - 'Empty' periods happen when there are no packets for a long time
 //     (greater than a period). In this case, we send a copy of the last
-//     packet received before the empty period.
+//     packet received before the empty period. When upsampling, all the
+//     periods that have become empty are filled in a single Process() call.
+//
+// Emitted packets share the payload of the input packets: only the timestamp
+// is replaced, so upsampling never copies the data.
 // The jitter feature is disabled by default. To enable it, you need to
 // implement CreateSecureRandom(const std::string&).
 //
@@ -136,8 +141,10 @@ class PacketResamplerCalculator : public CalculatorBase {
   // Can only be used if jitter_ equals zero.
   int64 TimestampToPeriodIndex(Timestamp timestamp) const;
 
-  // Outputs a packet if it is in range (start_time_, end_time_).
-  void OutputWithinLimits(CalculatorContext* cc, const Packet& packet) const;
+  // Outputs a packet if it is in range (start_time_, end_time_). Taking the
+  // packet by value lets callers move freshly re-timestamped packets into the
+  // output stream without another reference count update.
+  void OutputWithinLimits(CalculatorContext* cc, Packet packet) const;
 
  protected:
   // Returns Sampling Strategy to use.
@@ -186,6 +193,10 @@ class PacketResamplerCalculator : public CalculatorBase {
   // between start_time and end_time.
   bool round_limits_;
 
+  // Margin around start_time_ and end_time_ within which packets are output,
+  // which depends on round_limits_.
+  TimestampDiff limits_margin_;
+
   // Allow strategies access to all internal calculator state.
   //
   // The calculator and strategies are intimiately tied together so this should
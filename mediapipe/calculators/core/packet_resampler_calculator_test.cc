@@ -327,6 +327,23 @@ TEST(PacketResamplerCalculatorTest, FillPeriodsWithLatestPacket) {
   }
 }
 
+TEST(PacketResamplerCalculatorTest, UpsamplingSharesPayloads) {
+  SimpleRunner runner(
+      "[mediapipe.PacketResamplerCalculatorOptions.ext]: "
+      "{frame_rate:1000}");
+  runner.SetInput({0, 10000});
+  MP_ASSERT_OK(runner.Run());
+
+  const std::vector<Packet>& inputs = runner.MutableInputs()->Index(0).packets;
+  const std::vector<Packet>& outputs = runner.Outputs().Index(0).packets;
+  ASSERT_EQ(outputs.size(), 11);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(outputs[i].Timestamp(), Timestamp(i * 1000));
+    EXPECT_EQ(&outputs[i].Get<std::string>(), &inputs[0].Get<std::string>());
+  }
+  EXPECT_EQ(&outputs[10].Get<std::string>(), &inputs[1].Get<std::string>());
+}
+
 TEST(PacketResamplerCalculatorTest, SuperHighFrameRate) {
   // frame rate == 500000 (a packet will have to be sent every 2 ticks).
   {
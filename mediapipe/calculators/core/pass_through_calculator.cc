@@ -56,6 +56,7 @@ class PassThroughCalculator : public CalculatorBase {
             &cc->InputSidePackets().Get(id));
       }
     }
+    cc->SetInlineable(true);
     return absl::OkStatus();
   }
 
@@ -55,6 +55,10 @@ using IsNotMovable =
 // combined into one vector.
 // To use this class for a particular type T, register a calculator using
 // SplitVectorCalculator<T>.
+// If the ranges don't overlap and the input packet is owned only by this
+// calculator, the elements are moved to the outputs. Otherwise they are copied
+// if move_elements is false, which is counted by the "CopiedInputs" counter,
+// unless the "share_elements" option lets the outputs share them.
 template <typename T, bool move_elements>
 class SplitVectorCalculator : public CalculatorBase {
  public:
@@ -115,6 +119,8 @@ class SplitVectorCalculator : public CalculatorBase {
 
     element_only_ = options.element_only();
     combine_outputs_ = options.combine_outputs();
+    share_elements_ = options.share_elements();
+    ranges_overlap_ = !checkRangesDontOverlap(options).ok();
 
     for (const auto& range : options.ranges()) {
       ranges_.push_back({range.begin(), range.end()});
@@ -139,33 +145,57 @@ class SplitVectorCalculator : public CalculatorBase {
   absl::Status ProcessCopyableElements(CalculatorContext* cc) {
     // static_assert(std::is_copy_constructible<U>::value,
     //              "Cannot copy non-copyable elements");
-    const auto& input = cc->Inputs().Index(0).Get<std::vector<U>>();
+    const Packet& input_packet = cc->Inputs().Index(0).Value();
+    if (!ranges_overlap_) {
+      absl::StatusOr<std::unique_ptr<std::vector<U>>> input_status =
+          cc->Inputs().Index(0).Value().Consume<std::vector<U>>();
+      if (input_status.ok()) {
+        return MoveElements(std::move(input_status).value(), cc);
+      }
+    }
+    const auto& input = input_packet.Get<std::vector<U>>();
     RET_CHECK_GE(input.size(), max_range_end_);
+    bool copied = false;
     if (combine_outputs_) {
+      if (share_elements_ && CoversInput(0, input.size())) {
+        cc->Outputs().Index(0).AddPacket(input_packet);
+        return absl::OkStatus();
+      }
       auto output = absl::make_unique<std::vector<U>>();
       output->reserve(total_elements_);
       for (int i = 0; i < ranges_.size(); ++i) {
-        auto elements = absl::make_unique<std::vector<U>>(
-            input.begin() + ranges_[i].first,
-            input.begin() + ranges_[i].second);
-        output->insert(output->end(), elements->begin(), elements->end());
+        output->insert(output->end(), input.begin() + ranges_[i].first,
+                       input.begin() + ranges_[i].second);
       }
       cc->Outputs().Index(0).Add(output.release(), cc->InputTimestamp());
+      copied = true;
     } else {
       if (element_only_) {
         for (int i = 0; i < ranges_.size(); ++i) {
+          const U& element = input[ranges_[i].first];
           cc->Outputs().Index(i).AddPacket(
-              MakePacket<U>(input[ranges_[i].first]).At(cc->InputTimestamp()));
+              (share_elements_ ? PointToForeign(&element, input_packet)
+                               : MakePacket<U>(element))
+                  .At(cc->InputTimestamp()));
         }
+        copied = !share_elements_;
       } else {
         for (int i = 0; i < ranges_.size(); ++i) {
+          if (share_elements_ && CoversInput(i, input.size())) {
+            cc->Outputs().Index(i).AddPacket(input_packet);
+            continue;
+          }
           auto output = absl::make_unique<std::vector<T>>(
               input.begin() + ranges_[i].first,
               input.begin() + ranges_[i].second);
           cc->Outputs().Index(i).Add(output.release(), cc->InputTimestamp());
+          copied = true;
         }
       }
     }
+    if (copied) {
+      cc->GetCounter(kCopiedInputsCounter)->Increment();
+    }
 
     return absl::OkStatus();
   }
@@ -180,8 +210,20 @@ class SplitVectorCalculator : public CalculatorBase {
     absl::StatusOr<std::unique_ptr<std::vector<U>>> input_status =
         cc->Inputs().Index(0).Value().Consume<std::vector<U>>();
     if (!input_status.ok()) return input_status.status();
-    std::unique_ptr<std::vector<U>> input_vector =
-        std::move(input_status).value();
+    return MoveElements(std::move(input_status).value(), cc);
+  }
+
+  template <typename U, IsNotMovable<U> = true>
+  absl::Status ProcessMovableElements(CalculatorContext* cc) {
+    return absl::InternalError("Cannot move non-movable elements.");
+  }
+
+ private:
+  // Moves the elements of the consumed input vector to the outputs. The ranges
+  // must not overlap.
+  template <typename U>
+  absl::Status MoveElements(std::unique_ptr<std::vector<U>> input_vector,
+                            CalculatorContext* cc) {
     RET_CHECK_GE(input_vector->size(), max_range_end_);
 
     if (combine_outputs_) {
@@ -217,12 +259,12 @@ class SplitVectorCalculator : public CalculatorBase {
     return absl::OkStatus();
   }
 
-  template <typename U, IsNotMovable<U> = true>
-  absl::Status ProcessMovableElements(CalculatorContext* cc) {
-    return absl::InternalError("Cannot move non-movable elements.");
+  // Returns true if the range of output `i` is the whole input vector.
+  bool CoversInput(int i, int input_size) const {
+    return ranges_.size() == 1 && ranges_[i].first == 0 &&
+           ranges_[i].second == input_size;
   }
 
- private:
   static absl::Status checkRangesDontOverlap(
       const ::mediapipe::SplitVectorCalculatorOptions& options) {
     for (int i = 0; i < options.ranges_size() - 1; ++i) {
@@ -247,6 +289,12 @@ class SplitVectorCalculator : public CalculatorBase {
   int32 total_elements_ = 0;
   bool element_only_ = false;
   bool combine_outputs_ = false;
+  bool share_elements_ = false;
+  bool ranges_overlap_ = false;
+
+  // Counts the inputs whose elements were copied because they had other
+  // owners.
+  static constexpr char kCopiedInputsCounter[] = "CopiedInputs";
 };
 
 }  // namespace mediapipe
@@ -691,4 +691,117 @@ TEST_F(MovableSplitUniqueIntPtrCalculatorTest, SmokeTestCombiningOutputs) {
                                input_begin_indices, input_end_indices);
 }
 
+typedef SplitVectorCalculator<std::string, false>
+    TestSplitStringVectorCalculator;
+REGISTER_CALCULATOR(TestSplitStringVectorCalculator);
+
+TEST(SplitStringVectorCalculatorTest, MovesUniquelyOwnedInput) {
+  // Note: CalculatorRunner keeps copies of input packets, so a graph is used
+  // to send packets that own the data.
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input"
+        node {
+          calculator: "TestSplitStringVectorCalculator"
+          input_stream: "input"
+          output_stream: "range_0"
+          output_stream: "range_1"
+          options {
+            [mediapipe.SplitVectorCalculatorOptions.ext] {
+              ranges: { begin: 0 end: 1 }
+              ranges: { begin: 1 end: 3 }
+            }
+          }
+        }
+      )pb");
+  std::vector<Packet> range_0_packets;
+  std::vector<Packet> range_1_packets;
+  tool::AddVectorSink("range_0", &graph_config, &range_0_packets);
+  tool::AddVectorSink("range_1", &graph_config, &range_1_packets);
+
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(graph_config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "input", MakePacket<std::vector<std::string>>(
+                   std::vector<std::string>{"a", "b", "c"})
+                   .At(Timestamp(0))));
+  MP_ASSERT_OK(graph.CloseAllPacketSources());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(1, range_0_packets.size());
+  EXPECT_THAT(range_0_packets[0].Get<std::vector<std::string>>(),
+              testing::ElementsAre("a"));
+  ASSERT_EQ(1, range_1_packets.size());
+  EXPECT_THAT(range_1_packets[0].Get<std::vector<std::string>>(),
+              testing::ElementsAre("b", "c"));
+  EXPECT_EQ(0, graph.GetCounterFactory()
+                   ->GetCounter("TestSplitStringVectorCalculator-CopiedInputs")
+                   ->Get());
+}
+
+TEST(SplitStringVectorCalculatorTest, CopiesSharedInput) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "TestSplitStringVectorCalculator"
+    input_stream: "input"
+    output_stream: "range_0"
+    output_stream: "range_1"
+    options {
+      [mediapipe.SplitVectorCalculatorOptions.ext] {
+        ranges: { begin: 0 end: 1 }
+        ranges: { begin: 2 end: 3 }
+        element_only: true
+      }
+    }
+  )pb"));
+  runner.MutableInputs()->Index(0).packets.push_back(
+      MakePacket<std::vector<std::string>>(
+          std::vector<std::string>{"a", "b", "c"})
+          .At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  ASSERT_EQ(1, runner.Outputs().Index(0).packets.size());
+  EXPECT_EQ("a", runner.Outputs().Index(0).packets[0].Get<std::string>());
+  ASSERT_EQ(1, runner.Outputs().Index(1).packets.size());
+  EXPECT_EQ("c", runner.Outputs().Index(1).packets[0].Get<std::string>());
+  EXPECT_EQ(1, runner.GetCounter("TestSplitStringVectorCalculator-CopiedInputs")
+                   ->Get());
+}
+
+TEST(SplitStringVectorCalculatorTest, SharesElementsOfSharedInput) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "TestSplitStringVectorCalculator"
+    input_stream: "input"
+    output_stream: "range_0"
+    output_stream: "range_1"
+    options {
+      [mediapipe.SplitVectorCalculatorOptions.ext] {
+        ranges: { begin: 0 end: 1 }
+        ranges: { begin: 2 end: 3 }
+        element_only: true
+        share_elements: true
+      }
+    }
+  )pb"));
+  runner.MutableInputs()->Index(0).packets.push_back(
+      MakePacket<std::vector<std::string>>(
+          std::vector<std::string>{"a", "b", "c"})
+          .At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& input = runner.MutableInputs()
+                          ->Index(0)
+                          .packets[0]
+                          .Get<std::vector<std::string>>();
+  const auto& range_0_packets = runner.Outputs().Index(0).packets;
+  ASSERT_EQ(1, range_0_packets.size());
+  EXPECT_EQ(Timestamp(0), range_0_packets[0].Timestamp());
+  EXPECT_EQ(&input[0], &range_0_packets[0].Get<std::string>());
+  const auto& range_1_packets = runner.Outputs().Index(1).packets;
+  ASSERT_EQ(1, range_1_packets.size());
+  EXPECT_EQ(&input[2], &range_1_packets[0].Get<std::string>());
+  EXPECT_EQ(0, runner.GetCounter("TestSplitStringVectorCalculator-CopiedInputs")
+                   ->Get());
+}
+
 }  // namespace mediapipe
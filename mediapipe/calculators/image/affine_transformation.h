@@ -16,7 +16,9 @@
 #define MEDIAPIPE_CALCULATORS_IMAGE_AFFINE_TRANSFORMATION_H_
 
 #include <array>
+#include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 
 namespace mediapipe {
@@ -47,6 +49,26 @@ class AffineTransformation {
                                         const std::array<float, 16>& matrix,
                                         const Size& output_size,
                                         BorderMode border_mode) = 0;
+
+    // Transforms input into one output per matrix, the i-th output having size
+    // @output_sizes[i]. Runners override this to share per-input work (e.g.
+    // uploading and binding the input) across the batch.
+    virtual absl::StatusOr<std::vector<OutputT>> RunBatch(
+        const InputT& input, const std::vector<std::array<float, 16>>& matrices,
+        const std::vector<Size>& output_sizes, BorderMode border_mode) {
+      if (matrices.size() != output_sizes.size()) {
+        return absl::InvalidArgumentError(
+            "Number of matrices and output sizes must match.");
+      }
+      std::vector<OutputT> outputs;
+      outputs.reserve(matrices.size());
+      for (int i = 0; i < matrices.size(); ++i) {
+        auto output = Run(input, matrices[i], output_sizes[i], border_mode);
+        if (!output.ok()) return output.status();
+        outputs.push_back(std::move(output).value());
+      }
+      return outputs;
+    }
   };
 };
 
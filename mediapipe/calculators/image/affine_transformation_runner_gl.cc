@@ -16,6 +16,7 @@
 
 #include <memory>
 #include <optional>
+#include <vector>
 
 #include "Eigen/Core"
 #include "Eigen/Geometry"
@@ -191,35 +192,63 @@ class GlTextureWarpAffineRunner
       const GpuBuffer& input, const std::array<float, 16>& matrix,
       const AffineTransformation::Size& size,
       AffineTransformation::BorderMode border_mode) override {
-    std::unique_ptr<GpuBuffer> gpu_buffer;
-    MP_RETURN_IF_ERROR(
-        gl_helper_->RunInGlContext([this, &input, &matrix, &size, &border_mode,
-                                    &gpu_buffer]() -> absl::Status {
-          auto input_texture = gl_helper_->CreateSourceTexture(input);
-          auto output_texture = gl_helper_->CreateDestinationTexture(
-              size.width, size.height, input.format());
-
-          MP_RETURN_IF_ERROR(
-              RunInternal(input_texture, matrix, border_mode, &output_texture));
-          gpu_buffer = output_texture.GetFrame<GpuBuffer>();
-          return absl::OkStatus();
-        }));
-
-    return gpu_buffer;
+    ASSIGN_OR_RETURN(auto gpu_buffers,
+                     RunBatch(input, {matrix}, {size}, border_mode));
+    return std::move(gpu_buffers[0]);
   }
 
-  absl::Status RunInternal(const GlTexture& texture,
-                           const std::array<float, 16>& matrix,
-                           AffineTransformation::BorderMode border_mode,
-                           GlTexture* output) {
+  // Binds the input texture and the program once and renders every output
+  // with its own matrix, so a batch costs one upload and one state setup.
+  absl::StatusOr<std::vector<std::unique_ptr<GpuBuffer>>> RunBatch(
+      const GpuBuffer& input,
+      const std::vector<std::array<float, 16>>& matrices,
+      const std::vector<AffineTransformation::Size>& output_sizes,
+      AffineTransformation::BorderMode border_mode) override {
+    RET_CHECK_EQ(matrices.size(), output_sizes.size())
+        << "Number of matrices and output sizes must match.";
+    std::vector<std::unique_ptr<GpuBuffer>> gpu_buffers;
+    gpu_buffers.reserve(matrices.size());
+    MP_RETURN_IF_ERROR(gl_helper_->RunInGlContext([&]() -> absl::Status {
+      auto input_texture = gl_helper_->CreateSourceTexture(input);
+      ASSIGN_OR_RETURN(Program program, BeginDraw(input_texture, border_mode));
+      for (int i = 0; i < matrices.size(); ++i) {
+        auto output_texture = gl_helper_->CreateDestinationTexture(
+            output_sizes[i].width, output_sizes[i].height, input.format());
+        Draw(program, matrices[i], &output_texture);
+        gpu_buffers.push_back(output_texture.GetFrame<GpuBuffer>());
+      }
+      EndDraw();
+      return absl::OkStatus();
+    }));
+
+    return gpu_buffers;
+  }
+
+  ~GlTextureWarpAffineRunner() override {
+    gl_helper_->RunInGlContext([this]() {
+      // Release OpenGL resources.
+      if (framebuffer_ != 0) glDeleteFramebuffers(1, &framebuffer_);
+      if (program_.id != 0) glDeleteProgram(program_.id);
+      if (program_custom_zero_ && program_custom_zero_->id != 0) {
+        glDeleteProgram(program_custom_zero_->id);
+      }
+      if (vao_ != 0) glDeleteVertexArrays(1, &vao_);
+      glDeleteBuffers(2, vbo_);
+    });
+  }
+
+ private:
+  struct Program {
+    GLuint id;
+    GLint matrix_id;
+  };
+
+  // Binds @texture as input, sets up sampling for @border_mode and returns the
+  // program to draw with.
+  absl::StatusOr<Program> BeginDraw(
+      const GlTexture& texture, AffineTransformation::BorderMode border_mode) {
     glDisable(GL_DEPTH_TEST);
     glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
-    glViewport(0, 0, output->width(), output->height());
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, output->name());
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
-                           output->name(), 0);
 
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(texture.target(), texture.name());
@@ -229,7 +258,7 @@ class GlTextureWarpAffineRunner
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
     // b) Clamping.
-    std::optional<Program> program = program_;
+    Program program = program_;
     switch (border_mode) {
       case AffineTransformation::BorderMode::kReplicate: {
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -239,7 +268,7 @@ class GlTextureWarpAffineRunner
       case AffineTransformation::BorderMode::kZero: {
 #if GL_CLAMP_TO_BORDER_MAY_BE_SUPPORTED
         if (program_custom_zero_) {
-          program = program_custom_zero_;
+          program = *program_custom_zero_;
         } else {
           glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
           glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
@@ -249,12 +278,35 @@ class GlTextureWarpAffineRunner
 #else
         RET_CHECK(program_custom_zero_)
             << "Program must have been initialized.";
-        program = program_custom_zero_;
+        program = *program_custom_zero_;
 #endif  // GL_CLAMP_TO_BORDER_MAY_BE_SUPPORTED
         break;
       }
     }
-    glUseProgram(program->id);
+    glUseProgram(program.id);
+
+    // vao
+    glBindVertexArray(vao_);
+
+    // vbo 0
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_[0]);
+    glEnableVertexAttribArray(kAttribVertex);
+    glVertexAttribPointer(kAttribVertex, 2, GL_FLOAT, 0, 0, nullptr);
+
+    // vbo 1
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_[1]);
+    glEnableVertexAttribArray(kAttribTexturePosition);
+    glVertexAttribPointer(kAttribTexturePosition, 2, GL_FLOAT, 0, 0, nullptr);
+
+    return program;
+  }
+
+  // Renders the bound input into @output using @matrix.
+  void Draw(const Program& program, const std::array<float, 16>& matrix,
+            GlTexture* output) {
+    glViewport(0, 0, output->width(), output->height());
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           output->name(), 0);
 
     Eigen::Matrix<float, 4, 4, Eigen::RowMajor> eigen_mat(matrix.data());
     if (IsMatrixVerticalFlipNeeded(gpu_origin_)) {
@@ -273,24 +325,14 @@ class GlTextureWarpAffineRunner
     // GLboolean in glUniformMatrix4fv, or else INVALID_VALUE error is reported.
     // Hence, transposing the matrix and always passing transposed.
     eigen_mat.transposeInPlace();
-    glUniformMatrix4fv(program->matrix_id, 1, GL_FALSE, eigen_mat.data());
-
-    // vao
-    glBindVertexArray(vao_);
-
-    // vbo 0
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_[0]);
-    glEnableVertexAttribArray(kAttribVertex);
-    glVertexAttribPointer(kAttribVertex, 2, GL_FLOAT, 0, 0, nullptr);
-
-    // vbo 1
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_[1]);
-    glEnableVertexAttribArray(kAttribTexturePosition);
-    glVertexAttribPointer(kAttribTexturePosition, 2, GL_FLOAT, 0, 0, nullptr);
+    glUniformMatrix4fv(program.matrix_id, 1, GL_FALSE, eigen_mat.data());
 
     // draw
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  }
 
+  // Restores the state changed by BeginDraw.
+  void EndDraw() {
     // Resetting to MediaPipe texture param defaults.
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -306,28 +348,8 @@ class GlTextureWarpAffineRunner
     glBindTexture(GL_TEXTURE_2D, 0);
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, 0);
-
-    return absl::OkStatus();
-  }
-
-  ~GlTextureWarpAffineRunner() override {
-    gl_helper_->RunInGlContext([this]() {
-      // Release OpenGL resources.
-      if (framebuffer_ != 0) glDeleteFramebuffers(1, &framebuffer_);
-      if (program_.id != 0) glDeleteProgram(program_.id);
-      if (program_custom_zero_ && program_custom_zero_->id != 0) {
-        glDeleteProgram(program_custom_zero_->id);
-      }
-      if (vao_ != 0) glDeleteVertexArrays(1, &vao_);
-      glDeleteBuffers(2, vbo_);
-    });
   }
 
- private:
-  struct Program {
-    GLuint id;
-    GLint matrix_id;
-  };
   std::shared_ptr<GlCalculatorHelper> gl_helper_;
   GpuOrigin::Mode gpu_origin_;
   GLuint vao_ = 0;
@@ -15,6 +15,7 @@
 #include "mediapipe/calculators/image/affine_transformation_runner_opencv.h"
 
 #include <memory>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/status/statusor.h"
@@ -46,6 +47,40 @@ class OpenCvRunner
       const ImageFrame& input, const std::array<float, 16>& matrix,
       const AffineTransformation::Size& size,
       AffineTransformation::BorderMode border_mode) override {
+    ImageFrame out_image(input.Format(), size.width, size.height);
+    Warp(input, matrix, border_mode, &out_image);
+    return out_image;
+  }
+
+  // Warps are independent of each other, so they run in parallel.
+  absl::StatusOr<std::vector<ImageFrame>> RunBatch(
+      const ImageFrame& input,
+      const std::vector<std::array<float, 16>>& matrices,
+      const std::vector<AffineTransformation::Size>& output_sizes,
+      AffineTransformation::BorderMode border_mode) override {
+    RET_CHECK_EQ(matrices.size(), output_sizes.size())
+        << "Number of matrices and output sizes must match.";
+    std::vector<ImageFrame> out_images;
+    out_images.reserve(output_sizes.size());
+    for (const auto& size : output_sizes) {
+      out_images.emplace_back(input.Format(), size.width, size.height);
+    }
+    cv::parallel_for_(cv::Range(0, out_images.size()),
+                      [&](const cv::Range& range) {
+                        for (int i = range.start; i < range.end; ++i) {
+                          Warp(input, matrices[i], border_mode, &out_images[i]);
+                        }
+                      });
+    return out_images;
+  }
+
+ private:
+  // Warps @input into @out_image, whose size is the output size.
+  static void Warp(const ImageFrame& input, const std::array<float, 16>& matrix,
+                   AffineTransformation::BorderMode border_mode,
+                   ImageFrame* out_image) {
+    const AffineTransformation::Size size = {out_image->Width(),
+                                             out_image->Height()};
     // OpenCV warpAffine works in absolute coordinates, so the transfom (which
     // accepts and produces relative coordinates) should be adjusted to first
     // normalize coordinates and then scale them.
@@ -137,15 +172,12 @@ class OpenCvRunner
     cv_affine_transform.at<float>(1, 1) = transform_absolute.val[5];
     cv_affine_transform.at<float>(1, 2) = transform_absolute.val[7];
 
-    ImageFrame out_image(input.Format(), size.width, size.height);
-    cv::Mat out_mat = formats::MatView(&out_image);
+    cv::Mat out_mat = formats::MatView(out_image);
 
     cv::warpAffine(in_mat, out_mat, cv_affine_transform,
                    cv::Size(out_mat.cols, out_mat.rows),
                    /*flags=*/cv::INTER_LINEAR | cv::WARP_INVERSE_MAP,
                    GetBorderModeForOpenCv(border_mode));
-
-    return out_image;
   }
 };
 
@@ -12,8 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/strings/str_replace.h"
 #include "mediapipe/calculators/image/bilateral_filter_calculator.pb.h"
@@ -46,6 +49,61 @@ constexpr char kInputGuideTagGpu[] = "GUIDE_GPU";
 constexpr char kOutputFrameTagGpu[] = "IMAGE_GPU";
 
 enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
+
+// Largest number of taps on each side of the center used by the GPU guided
+// filter to evaluate a box mean. Larger radii spread the taps further apart
+// and shrink the grid they are evaluated on instead.
+constexpr int kMaxGuidedTapRadius = 4;
+
+// Guided filter (He et al.) of every channel of 'src' using the single channel
+// 'guide'. Both are CV_32F in [0, 1]. Every step is a box mean, so the cost per
+// pixel does not depend on 'radius'.
+void GuidedFilter(const cv::Mat& guide, const cv::Mat& src, int radius,
+                  float eps, cv::Mat& dst) {
+  const cv::Size ksize(2 * radius + 1, 2 * radius + 1);
+  auto box_mean = [&ksize](const cv::Mat& in) {
+    cv::Mat out;
+    cv::boxFilter(in, out, CV_32F, ksize, cv::Point(-1, -1),
+                  /*normalize=*/true, cv::BORDER_REFLECT);
+    return out;
+  };
+
+  const cv::Mat mean_guide = box_mean(guide);
+  const cv::Mat var_guide =
+      box_mean(guide.mul(guide)) - mean_guide.mul(mean_guide) + eps;
+
+  std::vector<cv::Mat> channels;
+  cv::split(src, channels);
+  for (auto& channel : channels) {
+    const cv::Mat mean_src = box_mean(channel);
+    const cv::Mat cov = box_mean(guide.mul(channel)) - mean_guide.mul(mean_src);
+    const cv::Mat a = cov / var_guide;
+    const cv::Mat b = mean_src - a.mul(mean_guide);
+    channel = box_mean(a).mul(guide) + box_mean(b);
+  }
+  cv::merge(channels, dst);
+}
+
+// Converts an 8-bit 1, 3 or 4 channel image to a CV_32FC1 luminance in [0, 1].
+absl::Status ToGuide(const cv::Mat& image, cv::Mat& guide) {
+  cv::Mat gray;
+  switch (image.channels()) {
+    case 1:
+      gray = image;
+      break;
+    case 3:
+      cv::cvtColor(image, gray, cv::COLOR_RGB2GRAY);
+      break;
+    case 4:
+      cv::cvtColor(image, gray, cv::COLOR_RGBA2GRAY);
+      break;
+    default:
+      return absl::InvalidArgumentError(
+          "Guide image must have 1, 3 or 4 channels.");
+  }
+  gray.convertTo(guide, CV_32F, 1.0 / 255.0);
+  return absl::OkStatus();
+}
 }  // namespace
 
 // A calculator for applying a bilateral filter to an image,
@@ -68,6 +126,9 @@ enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
 //   sigma_space: Pixel radius: use (sigma_space*2+1)x(sigma_space*2+1) window.
 //                This should be set based on output image pixel space.
 //   sigma_color: Color variance: normalized [0-1] color difference allowed.
+//   filter_mode: BRUTE_FORCE evaluates the bilateral kernel directly. GUIDED
+//                runs a guided filter of radius sigma_space and epsilon
+//                sigma_color^2, whose cost does not depend on sigma_space.
 //
 // Notes:
 //   * When GUIDE is present, the output image is same size as GUIDE image;
@@ -75,7 +136,11 @@ enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
 //   * On GPU the kernel window is subsampled by approximately sqrt(sigma_space)
 //     i.e. the step size is ~sqrt(sigma_space),
 //     prioritizing performance > quality.
-//   * TODO: Add CPU path for joint filter.
+//   * The GPU guided filter evaluates its box means on a grid downsampled to
+//     the tap spacing and stores them in half float textures, which needs
+//     color-renderable half float support (GLES 3.2 or
+//     EXT_color_buffer_half_float).
+//   * TODO: Add CPU path for joint filter in BRUTE_FORCE mode.
 //
 class BilateralFilterCalculator : public CalculatorBase {
  public:
@@ -92,6 +157,8 @@ class BilateralFilterCalculator : public CalculatorBase {
  private:
   absl::Status RenderGpu(CalculatorContext* cc);
   absl::Status RenderCpu(CalculatorContext* cc);
+  absl::Status RenderGpuGuided(CalculatorContext* cc);
+  absl::Status RenderCpuGuided(CalculatorContext* cc);
 
   absl::Status GlSetup(CalculatorContext* cc);
   void GlRender(CalculatorContext* cc);
@@ -99,12 +166,17 @@ class BilateralFilterCalculator : public CalculatorBase {
   mediapipe::BilateralFilterCalculatorOptions options_;
   float sigma_color_ = -1.f;
   float sigma_space_ = -1.f;
+  bool guided_ = false;
+  int tap_radius_ = 1;
 
   bool use_gpu_ = false;
   bool gpu_initialized_ = false;
 #if !MEDIAPIPE_DISABLE_GPU
   mediapipe::GlCalculatorHelper gpu_helper_;
   GLuint program_ = 0;
+  // Guided filter: first and second moment box means, then the output pass.
+  GLuint stats_program_[2] = {0, 0};
+  GLuint guided_program_ = 0;
   GLuint vao_;
   GLuint vbo_[2];  // vertex storage
 #endif             // !MEDIAPIPE_DISABLE_GPU
@@ -185,7 +257,11 @@ absl::Status BilateralFilterCalculator::Open(CalculatorContext* cc) {
   sigma_space_ = options_.sigma_space();
   CHECK_GE(sigma_color_, 0.0);
   CHECK_GE(sigma_space_, 0.0);
-  if (!use_gpu_) sigma_color_ *= 255.0;
+  guided_ = options_.filter_mode() ==
+            mediapipe::BilateralFilterCalculatorOptions::GUIDED;
+  tap_radius_ = std::clamp(static_cast<int>(std::ceil(sigma_space_)), 1,
+                           kMaxGuidedTapRadius);
+  if (!use_gpu_ && !guided_) sigma_color_ *= 255.0;
 
   if (use_gpu_) {
 #if !MEDIAPIPE_DISABLE_GPU
@@ -219,6 +295,12 @@ absl::Status BilateralFilterCalculator::Close(CalculatorContext* cc) {
 #if !MEDIAPIPE_DISABLE_GPU
   gpu_helper_.RunInGlContext([this] {
     if (program_) glDeleteProgram(program_);
+    for (GLuint& program : stats_program_) {
+      if (program) glDeleteProgram(program);
+      program = 0;
+    }
+    if (guided_program_) glDeleteProgram(guided_program_);
+    guided_program_ = 0;
     if (vao_) glDeleteVertexArrays(1, &vao_);
     if (vbo_[0]) glDeleteBuffers(2, vbo_);
     program_ = 0;
@@ -245,6 +327,8 @@ absl::Status BilateralFilterCalculator::RenderCpu(CalculatorContext* cc) {
         "CPU filtering supports only 1 or 3 channel input images.");
   }
 
+  if (guided_) return RenderCpuGuided(cc);
+
   auto output_frame = absl::make_unique<ImageFrame>(
       input_frame.Format(), input_mat.cols, input_mat.rows);
   const bool has_guide_image = cc->Inputs().HasTag(kInputGuideTag) &&
@@ -267,11 +351,52 @@ absl::Status BilateralFilterCalculator::RenderCpu(CalculatorContext* cc) {
   return absl::OkStatus();
 }
 
+absl::Status BilateralFilterCalculator::RenderCpuGuided(CalculatorContext* cc) {
+  const auto& input_frame = cc->Inputs().Tag(kInputFrameTag).Get<ImageFrame>();
+  auto input_mat = mediapipe::formats::MatView(&input_frame);
+  RET_CHECK_EQ(input_mat.depth(), CV_8U)
+      << "CPU guided filtering supports only 8-bit input images.";
+
+  cv::Mat src;
+  input_mat.convertTo(src, CV_32F, 1.0 / 255.0);
+  cv::Mat guide;
+  const bool has_guide_image = cc->Inputs().HasTag(kInputGuideTag) &&
+                               !cc->Inputs().Tag(kInputGuideTag).IsEmpty();
+  if (has_guide_image) {
+    const auto& guide_frame =
+        cc->Inputs().Tag(kInputGuideTag).Get<ImageFrame>();
+    MP_RETURN_IF_ERROR(
+        ToGuide(mediapipe::formats::MatView(&guide_frame), guide));
+    // As on GPU, the output takes the size of the guide.
+    if (src.size() != guide.size()) {
+      cv::resize(src, src, guide.size(), 0, 0, cv::INTER_LINEAR);
+    }
+  } else {
+    MP_RETURN_IF_ERROR(ToGuide(input_mat, guide));
+  }
+
+  cv::Mat filtered;
+  GuidedFilter(guide, src, std::max(1, static_cast<int>(sigma_space_)),
+               sigma_color_ * sigma_color_, filtered);
+
+  auto output_frame = absl::make_unique<ImageFrame>(input_frame.Format(),
+                                                    guide.cols, guide.rows);
+  auto output_mat = mediapipe::formats::MatView(output_frame.get());
+  filtered.convertTo(output_mat, output_mat.type(), 255.0);
+
+  cc->Outputs()
+      .Tag(kOutputFrameTag)
+      .Add(output_frame.release(), cc->InputTimestamp());
+  return absl::OkStatus();
+}
+
 absl::Status BilateralFilterCalculator::RenderGpu(CalculatorContext* cc) {
   if (cc->Inputs().Tag(kInputFrameTagGpu).IsEmpty()) {
     return absl::OkStatus();
   }
 #if !MEDIAPIPE_DISABLE_GPU
+  if (guided_) return RenderGpuGuided(cc);
+
   const auto& input_frame =
       cc->Inputs().Tag(kInputFrameTagGpu).Get<mediapipe::GpuBuffer>();
   auto input_texture = gpu_helper_.CreateSourceTexture(input_frame);
@@ -332,6 +457,89 @@ absl::Status BilateralFilterCalculator::RenderGpu(CalculatorContext* cc) {
   return absl::OkStatus();
 }
 
+absl::Status BilateralFilterCalculator::RenderGpuGuided(CalculatorContext* cc) {
+#if !MEDIAPIPE_DISABLE_GPU
+  const bool has_guide_image = cc->Inputs().HasTag(kInputGuideTagGpu);
+  if (has_guide_image && cc->Inputs().Tag(kInputGuideTagGpu).IsEmpty()) {
+    return absl::OkStatus();
+  }
+  const auto& input_frame =
+      cc->Inputs().Tag(kInputFrameTagGpu).Get<mediapipe::GpuBuffer>();
+  const auto& guide_frame =
+      has_guide_image
+          ? cc->Inputs().Tag(kInputGuideTagGpu).Get<mediapipe::GpuBuffer>()
+          : input_frame;
+  auto input_texture = gpu_helper_.CreateSourceTexture(input_frame);
+  mediapipe::GlTexture guide_texture;
+  if (has_guide_image) {
+    guide_texture = gpu_helper_.CreateSourceTexture(guide_frame);
+  }
+  const GLuint guide_name =
+      has_guide_image ? guide_texture.name() : input_texture.name();
+
+  // Box means are sampled with a fixed number of taps spread over the radius,
+  // and evaluated on a grid matching the tap spacing, so the total cost does
+  // not grow with sigma_space.
+  const int width = guide_frame.width();
+  const int height = guide_frame.height();
+  const float tap_spacing = sigma_space_ / tap_radius_;
+  const float grid_scale = std::max(1.f, tap_spacing);
+  const int grid_width =
+      std::max(1, static_cast<int>(std::ceil(width / grid_scale)));
+  const int grid_height =
+      std::max(1, static_cast<int>(std::ceil(height / grid_scale)));
+
+  // First and second moments of guide and input.
+  mediapipe::GlTexture stats_texture[2];
+  for (int i = 0; i < 2; ++i) {
+    stats_texture[i] = gpu_helper_.CreateDestinationTexture(
+        grid_width, grid_height, mediapipe::GpuBufferFormat::kRGBAHalf64);
+    gpu_helper_.BindFramebuffer(stats_texture[i]);
+    glUseProgram(stats_program_[i]);
+    glUniform2f(glGetUniformLocation(stats_program_[i], "tap_step"),
+                tap_spacing / width, tap_spacing / height);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, input_texture.name());
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, guide_name);
+    GlRender(cc);
+  }
+
+  // Linear coefficients from the moments, applied to the full size guide.
+  mediapipe::GlTexture output_texture = gpu_helper_.CreateDestinationTexture(
+      width, height, mediapipe::GpuBufferFormat::kBGRA32);
+  gpu_helper_.BindFramebuffer(output_texture);
+  glUseProgram(guided_program_);
+  glUniform2f(glGetUniformLocation(guided_program_, "coeff_step"),
+              0.5f * tap_radius_ / grid_width,
+              0.5f * tap_radius_ / grid_height);
+  glActiveTexture(GL_TEXTURE3);
+  glBindTexture(GL_TEXTURE_2D, stats_texture[0].name());
+  glActiveTexture(GL_TEXTURE4);
+  glBindTexture(GL_TEXTURE_2D, stats_texture[1].name());
+  GlRender(cc);
+  for (GLenum unit : {GL_TEXTURE4, GL_TEXTURE3, GL_TEXTURE2, GL_TEXTURE1}) {
+    glActiveTexture(unit);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+  glFlush();
+
+  auto output_frame = output_texture.GetFrame<mediapipe::GpuBuffer>();
+  cc->Outputs()
+      .Tag(kOutputFrameTagGpu)
+      .Add(output_frame.release(), cc->InputTimestamp());
+
+  // Cleanup
+  stats_texture[0].Release();
+  stats_texture[1].Release();
+  if (has_guide_image) guide_texture.Release();
+  input_texture.Release();
+  output_texture.Release();
+#endif  // !MEDIAPIPE_DISABLE_GPU
+
+  return absl::OkStatus();
+}
+
 void BilateralFilterCalculator::GlRender(CalculatorContext* cc) {
 #if !MEDIAPIPE_DISABLE_GPU
   // bring back vao and vbo
@@ -467,10 +675,111 @@ absl::Status BilateralFilterCalculator::GlSetup(CalculatorContext* cc) {
     }
   )";
 
-  // Only initialize the one shader to be used.
+  // Guided filter shaders. Without a GUIDE the input is bound as the guide.
+  const float eps = std::max(sigma_color_ * sigma_color_, 1.0e-6f);
+  const std::string guided_common_string =
+      absl::StrReplaceAll(R"(
+    const float tap_radius = $tap_radius;
+    const float eps = $eps;
+
+    float luminance(vec3 color) {
+      return dot(color, vec3(0.299, 0.587, 0.114));
+    }
+  )",
+                          {{"$tap_radius", std::to_string(tap_radius_) + ".0"},
+                           {"$eps", std::to_string(eps)}});
+
+  // Box mean over (2*tap_radius+1)^2 taps of either (input, guide) or
+  // (input * guide, guide * guide), depending on SECOND_MOMENTS.
+  const std::string stats_frag_src = R"(
+    DEFAULT_PRECISION(highp, float)
+
+    in vec2 sample_coordinate;
+    uniform sampler2D input_frame;
+    uniform sampler2D guide_frame;
+    uniform vec2 tap_step;
+
+    )" + guided_common_string + R"(
+
+    void main() {
+      vec4 sum = vec4(0.0);
+      for (float i = -tap_radius; i <= tap_radius; i += 1.0) {
+        for (float j = -tap_radius; j <= tap_radius; j += 1.0) {
+          vec2 uv = sample_coordinate + vec2(j, i) * tap_step;
+          vec3 val = texture2D(input_frame, uv).rgb;
+          float guide_val = luminance(texture2D(guide_frame, uv).rgb);
+#ifdef SECOND_MOMENTS
+          sum += vec4(val * guide_val, guide_val * guide_val);
+#else
+          sum += vec4(val, guide_val);
+#endif  // SECOND_MOMENTS
+        }
+      }
+      float taps = (2.0 * tap_radius + 1.0) * (2.0 * tap_radius + 1.0);
+      gl_FragColor = sum / taps;
+    }
+  )";
+
+  // Per pixel linear model 'a * guide + b', with the coefficients averaged
+  // over a fixed 3x3 footprint on the moments grid.
+  const std::string guided_frag_src =
+      std::string(mediapipe::kMediaPipeFragmentShaderPreamble) + R"(
+    DEFAULT_PRECISION(highp, float)
+
+    in vec2 sample_coordinate;
+    uniform sampler2D guide_frame;
+    uniform sampler2D mean_frame;
+    uniform sampler2D corr_frame;
+    uniform vec2 coeff_step;
+
+    )" + guided_common_string +
+      R"(
+
+    void main() {
+      vec3 sum_a = vec3(0.0);
+      vec3 sum_b = vec3(0.0);
+      for (float i = -1.0; i <= 1.0; i += 1.0) {
+        for (float j = -1.0; j <= 1.0; j += 1.0) {
+          vec2 uv = sample_coordinate + vec2(j, i) * coeff_step;
+          vec4 mean = texture2D(mean_frame, uv);
+          vec4 corr = texture2D(corr_frame, uv);
+          float var_guide = max(corr.a - mean.a * mean.a, 0.0);
+          vec3 a = (corr.rgb - mean.a * mean.rgb) / (var_guide + eps);
+          sum_a += a;
+          sum_b += mean.rgb - a * mean.a;
+        }
+      }
+      vec3 guide_color = texture2D(guide_frame, sample_coordinate).rgb;
+      float guide_val = luminance(guide_color);
+      gl_FragColor = vec4((sum_a * guide_val + sum_b) / 9.0, 1.0);
+    }
+  )";
+
+  // Only initialize the shaders to be used.
   const bool has_guide_image = cc->Inputs().HasTag(kInputGuideTagGpu);
 
-  if (has_guide_image) {
+  if (guided_) {
+    for (int i = 0; i < 2; ++i) {
+      const std::string src =
+          std::string(mediapipe::kMediaPipeFragmentShaderPreamble) +
+          (i == 0 ? "" : "#define SECOND_MOMENTS\n") + stats_frag_src;
+      mediapipe::GlhCreateProgram(
+          mediapipe::kBasicVertexShader, src.c_str(), NUM_ATTRIBUTES,
+          (const GLchar**)&attr_name[0], attr_location, &stats_program_[i]);
+      RET_CHECK(stats_program_[i]) << "Problem initializing the program.";
+      glUseProgram(stats_program_[i]);
+      glUniform1i(glGetUniformLocation(stats_program_[i], "input_frame"), 1);
+      glUniform1i(glGetUniformLocation(stats_program_[i], "guide_frame"), 2);
+    }
+    mediapipe::GlhCreateProgram(
+        mediapipe::kBasicVertexShader, guided_frag_src.c_str(), NUM_ATTRIBUTES,
+        (const GLchar**)&attr_name[0], attr_location, &guided_program_);
+    RET_CHECK(guided_program_) << "Problem initializing the program.";
+    glUseProgram(guided_program_);
+    glUniform1i(glGetUniformLocation(guided_program_, "guide_frame"), 2);
+    glUniform1i(glGetUniformLocation(guided_program_, "mean_frame"), 3);
+    glUniform1i(glGetUniformLocation(guided_program_, "corr_frame"), 4);
+  } else if (has_guide_image) {
     // Create joint shader program and set parameters.
     mediapipe::GlhCreateProgram(
         mediapipe::kBasicVertexShader, joint_frag_src.c_str(), NUM_ATTRIBUTES,
@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "libyuv/convert_argb.h"
+#include "libyuv/convert_from_argb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
@@ -36,6 +38,37 @@ void SetColorChannel(int channel, uint8 value, cv::Mat* mat) {
   }
 }
 
+// Performs the byte shuffles between 8-bit RGB, RGBA and BGRA with libyuv,
+// whose row functions have AVX2 and NEON versions and fill in the alpha
+// channel in the same pass. libyuv names formats by their order in a
+// little-endian word, e.g. its RGB24 is B, G, R in memory, but these functions
+// move bytes by position and so serve for the mirrored orders too. Returns
+// false for the conversions it does not handle.
+bool ConvertWithLibyuv(int open_cv_convert_code, const ImageFrame& input,
+                       ImageFrame* output) {
+  if (input.ByteDepth() != 1) return false;
+  const uint8* src = input.PixelData();
+  const int src_stride = input.WidthStep();
+  uint8* dst = output->MutablePixelData();
+  const int dst_stride = output->WidthStep();
+  const int width = input.Width();
+  const int height = input.Height();
+  switch (open_cv_convert_code) {
+    case cv::COLOR_RGB2RGBA:
+      return libyuv::RGB24ToARGB(src, src_stride, dst, dst_stride, width,
+                                 height) == 0;
+    case cv::COLOR_RGBA2RGB:
+      return libyuv::ARGBToRGB24(src, src_stride, dst, dst_stride, width,
+                                 height) == 0;
+    case cv::COLOR_BGRA2RGBA:
+    case cv::COLOR_RGBA2BGRA:
+      return libyuv::ARGBToABGR(src, src_stride, dst, dst_stride, width,
+                                height) == 0;
+    default:
+      return false;
+  }
+}
+
 constexpr char kRgbaInTag[] = "RGBA_IN";
 constexpr char kRgbInTag[] = "RGB_IN";
 constexpr char kBgraInTag[] = "BGRA_IN";
@@ -145,17 +178,20 @@ absl::Status ColorConvertCalculator::ConvertAndOutput(
     const std::string& input_tag, const std::string& output_tag,
     ImageFormat::Format output_format, int open_cv_convert_code,
     CalculatorContext* cc) {
-  const cv::Mat& input_mat =
-      formats::MatView(&cc->Inputs().Tag(input_tag).Get<ImageFrame>());
-  std::unique_ptr<ImageFrame> output_frame(
-      new ImageFrame(output_format, input_mat.cols, input_mat.rows));
-  cv::Mat output_mat = formats::MatView(output_frame.get());
-  cv::cvtColor(input_mat, output_mat, open_cv_convert_code);
-
-  // cv::cvtColor will leave the alpha channel set to 0, which is a bizarre
-  // design choice. Instead, let's set alpha to 255.
-  if (open_cv_convert_code == cv::COLOR_RGB2RGBA) {
-    SetColorChannel(3, 255, &output_mat);
+  const ImageFrame& input_frame = cc->Inputs().Tag(input_tag).Get<ImageFrame>();
+  std::unique_ptr<ImageFrame> output_frame(new ImageFrame(
+      output_format, input_frame.Width(), input_frame.Height()));
+  if (!ConvertWithLibyuv(open_cv_convert_code, input_frame,
+                         output_frame.get())) {
+    const cv::Mat input_mat = formats::MatView(&input_frame);
+    cv::Mat output_mat = formats::MatView(output_frame.get());
+    cv::cvtColor(input_mat, output_mat, open_cv_convert_code);
+
+    // cv::cvtColor will leave the alpha channel set to 0, which is a bizarre
+    // design choice. Instead, let's set alpha to 255.
+    if (open_cv_convert_code == cv::COLOR_RGB2RGBA) {
+      SetColorChannel(3, 255, &output_mat);
+    }
   }
   cc->Outputs()
       .Tag(output_tag)
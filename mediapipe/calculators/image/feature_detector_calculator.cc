@@ -32,6 +32,7 @@
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/threadpool.h"
 #include "mediapipe/framework/tool/options_util.h"
+#include "mediapipe/util/tracking/image_pyramid.h"
 #include "tensorflow/lite/interpreter.h"
 
 namespace mediapipe {
@@ -43,6 +44,9 @@ const int kNumThreads = 16;
 // A calculator to apply local feature detection.
 // Input stream:
 //   IMAGE: Input image frame of type ImageFrame from video stream.
+//   PYRAMID: Alternatively, ImagePyramid of the frame (see
+//            ImagePyramidCalculator), to share its luminance with other
+//            calculators instead of converting the frame again.
 // Output streams:
 //   FEATURES: The detected keypoints from input image as vector<cv::KeyPoint>.
 //   PATCHES:  Optional output the extracted patches as vector<cv::Mat>
@@ -75,6 +79,11 @@ absl::Status FeatureDetectorCalculator::GetContract(CalculatorContract* cc) {
   if (cc->Inputs().HasTag("IMAGE")) {
     cc->Inputs().Tag("IMAGE").Set<ImageFrame>();
   }
+  if (cc->Inputs().HasTag("PYRAMID")) {
+    RET_CHECK(!cc->Inputs().HasTag("IMAGE"))
+        << "Only one of IMAGE and PYRAMID can be specified.";
+    cc->Inputs().Tag("PYRAMID").Set<ImagePyramid>();
+  }
   if (cc->Outputs().HasTag("FEATURES")) {
     cc->Outputs().Tag("FEATURES").Set<std::vector<cv::KeyPoint>>();
   }
@@ -105,10 +114,14 @@ absl::Status FeatureDetectorCalculator::Process(CalculatorContext* cc) {
     // Indicator packet.
     return absl::OkStatus();
   }
-  InputStream* input_frame = &(cc->Inputs().Tag("IMAGE"));
-  cv::Mat input_view = formats::MatView(&input_frame->Get<ImageFrame>());
   cv::Mat grayscale_view;
-  cv::cvtColor(input_view, grayscale_view, cv::COLOR_RGB2GRAY);
+  if (cc->Inputs().HasTag("PYRAMID")) {
+    grayscale_view = cc->Inputs().Tag("PYRAMID").Get<ImagePyramid>().luminance;
+  } else {
+    InputStream* input_frame = &(cc->Inputs().Tag("IMAGE"));
+    cv::Mat input_view = formats::MatView(&input_frame->Get<ImageFrame>());
+    cv::cvtColor(input_view, grayscale_view, cv::COLOR_RGB2GRAY);
+  }
 
   std::vector<cv::KeyPoint> keypoints;
   feature_detector_->detect(grayscale_view, keypoints);
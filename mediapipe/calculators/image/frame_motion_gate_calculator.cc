@@ -0,0 +1,154 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "mediapipe/calculators/image/frame_motion_gate_calculator.pb.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/port.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe {
+namespace api2 {
+
+// Decides, for each frame, whether an expensive per-frame model (e.g. selfie
+// segmentation) has to run on it, based on how much the frame changed since
+// the last frame it was allowed for. Frames are disallowed while there is
+// little motion, but at most `max_skipped_frames` in a row, so the model runs
+// at a reduced rate on a static scene and at the full rate on a moving one.
+//
+// Motion is the mean absolute luma difference, sampled on a coarse grid,
+// between the frame and the last allowed frame. Comparing against the last
+// allowed frame rather than the previous one also catches slow drifts.
+//
+// Inputs:
+//   IMAGE - ImageFrame
+//     The frame to decide on. Must be in the SRGB, SRGBA or GRAY8 format.
+//
+// Outputs:
+//   ALLOW - bool
+//     Whether the model has to run on the frame. Meant to drive the ALLOW
+//     input of a GateCalculator in front of the model.
+//   MOTION - float @Optional
+//     The measured motion in the [0, 1] range, e.g. for tuning the threshold.
+//     Only output for frames the decision depends on the motion for.
+//
+// Example:
+// node {
+//   calculator: "FrameMotionGateCalculator"
+//   input_stream: "IMAGE:image"
+//   output_stream: "ALLOW:run_model"
+//   options {
+//     [mediapipe.FrameMotionGateCalculatorOptions.ext] {
+//       motion_threshold: 0.02
+//       max_skipped_frames: 2
+//     }
+//   }
+// }
+class FrameMotionGateCalculator : public Node {
+ public:
+  static constexpr Input<ImageFrame> kImageIn{"IMAGE"};
+  static constexpr Output<bool> kAllowOut{"ALLOW"};
+  static constexpr Output<float>::Optional kMotionOut{"MOTION"};
+  MEDIAPIPE_NODE_CONTRACT(kImageIn, kAllowOut, kMotionOut);
+
+  absl::Status Open(CalculatorContext* cc) override {
+    options_ = cc->Options<FrameMotionGateCalculatorOptions>();
+    RET_CHECK_GE(options_.max_skipped_frames(), 0);
+    RET_CHECK_GT(options_.sampling_grid_size(), 0);
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (kImageIn(cc).IsEmpty()) {
+      return absl::OkStatus();
+    }
+    const ImageFrame& image = *kImageIn(cc);
+    MP_RETURN_IF_ERROR(SampleLuma(image, &samples_));
+
+    bool allow = true;
+    if (samples_.size() == reference_samples_.size() &&
+        num_skipped_frames_ < options_.max_skipped_frames()) {
+      int sum_abs_diff = 0;
+      for (int i = 0; i < samples_.size(); ++i) {
+        sum_abs_diff += std::abs(samples_[i] - reference_samples_[i]);
+      }
+      const float motion =
+          static_cast<float>(sum_abs_diff) / (255.f * samples_.size());
+      allow = motion >= options_.motion_threshold();
+      if (kMotionOut(cc).IsConnected()) {
+        kMotionOut(cc).Send(motion);
+      }
+    }
+
+    if (allow) {
+      samples_.swap(reference_samples_);
+      num_skipped_frames_ = 0;
+    } else {
+      ++num_skipped_frames_;
+    }
+    kAllowOut(cc).Send(allow);
+    return absl::OkStatus();
+  }
+
+ private:
+  // Samples the luma of `image` on a `sampling_grid_size` square grid, or on
+  // every pixel along dimensions smaller than that.
+  absl::Status SampleLuma(const ImageFrame& image,
+                          std::vector<int>* samples) const {
+    const int num_channels = image.NumberOfChannels();
+    RET_CHECK(image.Format() == ImageFormat::SRGB ||
+              image.Format() == ImageFormat::SRGBA ||
+              image.Format() == ImageFormat::GRAY8)
+        << "Unsupported image format: " << image.Format();
+
+    const int grid_size = options_.sampling_grid_size();
+    const int num_cols = std::min(grid_size, image.Width());
+    const int num_rows = std::min(grid_size, image.Height());
+    samples->clear();
+    samples->reserve(num_cols * num_rows);
+    for (int r = 0; r < num_rows; ++r) {
+      const int y = (2 * r + 1) * image.Height() / (2 * num_rows);
+      const uint8_t* row = image.PixelData() + y * image.WidthStep();
+      for (int c = 0; c < num_cols; ++c) {
+        const uint8_t* pixel =
+            row + (2 * c + 1) * image.Width() / (2 * num_cols) * num_channels;
+        // Rec. 601 luma approximated as (R + 2 * G + B) / 4.
+        samples->push_back(num_channels == 1
+                               ? pixel[0]
+                               : (pixel[0] + 2 * pixel[1] + pixel[2]) / 4);
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  FrameMotionGateCalculatorOptions options_;
+  // Luma samples of the current and of the last allowed frame.
+  std::vector<int> samples_;
+  std::vector<int> reference_samples_;
+  // Number of consecutive frames disallowed since the last allowed one.
+  int num_skipped_frames_ = 0;
+};
+
+MEDIAPIPE_REGISTER_NODE(FrameMotionGateCalculator);
+
+}  // namespace api2
+}  // namespace mediapipe
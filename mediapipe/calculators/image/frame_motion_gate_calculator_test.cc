@@ -0,0 +1,114 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+constexpr int kWidth = 64;
+constexpr int kHeight = 48;
+
+Packet MakeFrame(uint8_t value, int64_t timestamp) {
+  auto frame =
+      std::make_unique<ImageFrame>(ImageFormat::SRGB, kWidth, kHeight);
+  std::fill(frame->MutablePixelData(),
+            frame->MutablePixelData() + frame->PixelDataSize(), value);
+  return Adopt(frame.release()).At(Timestamp(timestamp));
+}
+
+std::vector<bool> RunGate(CalculatorRunner& runner,
+                          const std::vector<uint8_t>& frame_values) {
+  for (int i = 0; i < frame_values.size(); ++i) {
+    runner.MutableInputs()->Tag("IMAGE").packets.push_back(
+        MakeFrame(frame_values[i], i));
+  }
+  MP_EXPECT_OK(runner.Run());
+  std::vector<bool> allowed;
+  for (const Packet& packet : runner.Outputs().Tag("ALLOW").packets) {
+    allowed.push_back(packet.Get<bool>());
+  }
+  return allowed;
+}
+
+TEST(FrameMotionGateCalculatorTest, SkipsStaticFramesUpToLimit) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "FrameMotionGateCalculator"
+    input_stream: "IMAGE:image"
+    output_stream: "ALLOW:allow"
+    options {
+      [mediapipe.FrameMotionGateCalculatorOptions.ext] {
+        max_skipped_frames: 2
+      }
+    }
+  )pb"));
+  EXPECT_THAT(RunGate(runner, {100, 100, 100, 100, 100, 100, 100}),
+              ElementsAre(true, false, false, true, false, false, true));
+}
+
+TEST(FrameMotionGateCalculatorTest, AllowsFramesWithMotion) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "FrameMotionGateCalculator"
+    input_stream: "IMAGE:image"
+    output_stream: "ALLOW:allow"
+    output_stream: "MOTION:motion"
+    options {
+      [mediapipe.FrameMotionGateCalculatorOptions.ext] {
+        motion_threshold: 0.05
+        max_skipped_frames: 10
+      }
+    }
+  )pb"));
+  // Luma changes by 20, 10, 5 and 14 levels from the last allowed frame, i.e.
+  // the slow drift over the last three frames adds up to an allowed one.
+  EXPECT_THAT(RunGate(runner, {100, 120, 130, 125, 134}),
+              ElementsAre(true, true, false, false, true));
+
+  const auto& motion_packets = runner.Outputs().Tag("MOTION").packets;
+  ASSERT_EQ(motion_packets.size(), 4);
+  EXPECT_NEAR(motion_packets[0].Get<float>(), 20.f / 255.f, 1e-6f);
+  EXPECT_NEAR(motion_packets[3].Get<float>(), 14.f / 255.f, 1e-6f);
+}
+
+TEST(FrameMotionGateCalculatorTest, AllowsEveryFrameWithoutSkipping) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "FrameMotionGateCalculator"
+    input_stream: "IMAGE:image"
+    output_stream: "ALLOW:allow"
+    options {
+      [mediapipe.FrameMotionGateCalculatorOptions.ext] {
+        max_skipped_frames: 0
+      }
+    }
+  )pb"));
+  EXPECT_THAT(RunGate(runner, {100, 100, 100}),
+              ElementsAre(true, true, true));
+}
+
+}  // namespace
+}  // namespace mediapipe
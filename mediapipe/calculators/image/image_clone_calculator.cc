@@ -17,6 +17,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/util/preprocessing_cache.h"
 
 #if !MEDIAPIPE_DISABLE_GPU
 #include "mediapipe/gpu/gl_calculator_helper.h"
@@ -50,6 +51,10 @@ using GpuBuffer = mediapipe::GpuBuffer;
 //     }
 //   }
 // }
+//
+// With use_preprocessing_cache set, a clone already made by another
+// ImageCloneCalculator of the graph for the same input packet and target
+// storage is sent instead.
 class ImageCloneCalculator : public Node {
  public:
   static constexpr Input<Image> kIn{""};
@@ -66,12 +71,20 @@ class ImageCloneCalculator : public Node {
 #else
     MP_RETURN_IF_ERROR(mediapipe::GlCalculatorHelper::UpdateContract(cc));
 #endif  // MEDIAPIPE_DISABLE_GPU
+    if (cc->Options<mediapipe::ImageCloneCalculatorOptions>()
+            .use_preprocessing_cache()) {
+      cc->UseService(kPreprocessingCacheService);
+    }
     return absl::OkStatus();
   }
 
   absl::Status Open(CalculatorContext* cc) override {
     const auto& options = cc->Options<mediapipe::ImageCloneCalculatorOptions>();
     output_on_gpu_ = options.output_on_gpu();
+    if (options.use_preprocessing_cache()) {
+      preprocessing_cache_ =
+          &cc->Service(kPreprocessingCacheService).GetObject();
+    }
 #if !MEDIAPIPE_DISABLE_GPU
     MP_RETURN_IF_ERROR(gpu_helper_.Open(cc));
 #endif  // !MEDIAPIPE_DISABLE_GPU
@@ -79,6 +92,24 @@ class ImageCloneCalculator : public Node {
   }
 
   absl::Status Process(CalculatorContext* cc) override {
+    if (preprocessing_cache_ == nullptr) {
+      ASSIGN_OR_RETURN(mediapipe::Packet output, Clone(cc));
+      kOut(cc).Send(FromOldPacket(std::move(output)).As<Image>());
+      return absl::OkStatus();
+    }
+    ASSIGN_OR_RETURN(
+        mediapipe::Packet output,
+        preprocessing_cache_->GetOrCreate(
+            kIn(cc).packet(),
+            output_on_gpu_ ? "ImageClone:gpu" : "ImageClone:cpu",
+            [this, cc]() { return Clone(cc); }));
+    kOut(cc).Send(FromOldPacket(std::move(output)).As<Image>());
+    return absl::OkStatus();
+  }
+
+ private:
+  // Returns a packet with the clone of the input image.
+  absl::StatusOr<mediapipe::Packet> Clone(CalculatorContext* cc) {
     std::unique_ptr<Image> output;
     const auto& input = *kIn(cc);
     if (input.UsesGpu()) {
@@ -108,13 +139,12 @@ class ImageCloneCalculator : public Node {
     } else {
       output->ConvertToCpu();
     }
-    kOut(cc).Send(std::move(output));
-
-    return absl::OkStatus();
+    return Adopt(output.release()).At(cc->InputTimestamp());
   }
 
- private:
   bool output_on_gpu_;
+  // Set when use_preprocessing_cache is.
+  PreprocessingCache* preprocessing_cache_ = nullptr;
 #if !MEDIAPIPE_DISABLE_GPU
   mediapipe::GlCalculatorHelper gpu_helper_;
 #endif  // !MEDIAPIPE_DISABLE_GPU
@@ -15,9 +15,11 @@
 #include "mediapipe/calculators/image/image_cropping_calculator.h"
 
 #include <cmath>
+#include <memory>
 
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/formats/image_frame_pool_service.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
@@ -64,6 +66,7 @@ absl::Status ImageCroppingCalculator::GetContract(CalculatorContract* cc) {
     RET_CHECK(cc->Outputs().HasTag(kImageTag));
     cc->Inputs().Tag(kImageTag).Set<ImageFrame>();
     cc->Outputs().Tag(kImageTag).Set<ImageFrame>();
+    cc->UseService(kImageFramePoolService).Optional();
   }
 #if !MEDIAPIPE_DISABLE_GPU
   if (cc->Inputs().HasTag(kImageGpuTag)) {
@@ -123,6 +126,8 @@ absl::Status ImageCroppingCalculator::Open(CalculatorContext* cc) {
 
   if (cc->Inputs().HasTag(kImageGpuTag)) {
     use_gpu_ = true;
+  } else if (cc->Service(kImageFramePoolService).IsAvailable()) {
+    image_frame_pool_ = &cc->Service(kImageFramePoolService).GetObject();
   }
 
   options_ = cc->Options<mediapipe::ImageCroppingCalculatorOptions>();
@@ -243,6 +248,26 @@ absl::Status ImageCroppingCalculator::RenderCpu(CalculatorContext* cc) {
   output_width *= scale;
   output_height *= scale;
 
+  if (options_.output_view() && rotation == 0.0f && scale == 1.0f) {
+    const int left = rect_center_x - target_width / 2;
+    const int top = rect_center_y - target_height / 2;
+    if (left >= 0 && top >= 0 && left + target_width <= input_img.Width() &&
+        top + target_height <= input_img.Height()) {
+      // The view shares the input pixels, so it holds on to the input packet
+      // until it is destroyed.
+      const uint8* pixel_data =
+          input_img.PixelData() + top * input_img.WidthStep() +
+          left * input_img.NumberOfChannels() * input_img.ByteDepth();
+      auto output_frame = std::make_unique<ImageFrame>(
+          input_img.Format(), target_width, target_height,
+          input_img.WidthStep(), const_cast<uint8*>(pixel_data),
+          [input_packet = cc->Inputs().Tag(kImageTag).Value()](uint8*) {});
+      cc->Outputs().Tag(kImageTag).Add(output_frame.release(),
+                                       cc->InputTimestamp());
+      return absl::OkStatus();
+    }
+  }
+
   float dst_corners[8] = {0,
                           output_height - 1,
                           0,
@@ -254,16 +279,19 @@ absl::Status ImageCroppingCalculator::RenderCpu(CalculatorContext* cc) {
   cv::Mat dst_points = cv::Mat(4, 2, CV_32F, dst_corners);
   cv::Mat projection_matrix =
       cv::getPerspectiveTransform(src_points, dst_points);
-  cv::Mat cropped_image;
-  cv::warpPerspective(input_mat, cropped_image, projection_matrix,
-                      cv::Size(output_width, output_height),
+  const cv::Size output_size(output_width, output_height);
+  std::unique_ptr<ImageFrame> output_frame =
+      image_frame_pool_
+          ? image_frame_pool_->GetImageFrame(
+                input_img.Format(), output_size.width, output_size.height)
+          : std::make_unique<ImageFrame>(input_img.Format(), output_size.width,
+                                         output_size.height);
+  // Warps straight into the output frame, which already has the right size and
+  // type, so OpenCV does not allocate an intermediate image.
+  cv::Mat output_mat = formats::MatView(output_frame.get());
+  cv::warpPerspective(input_mat, output_mat, projection_matrix, output_size,
                       /* flags = */ 0,
                       /* borderMode = */ border_mode);
-
-  std::unique_ptr<ImageFrame> output_frame(new ImageFrame(
-      input_img.Format(), cropped_image.cols, cropped_image.rows));
-  cv::Mat output_mat = formats::MatView(output_frame.get());
-  cropped_image.copyTo(output_mat);
   cc->Outputs().Tag(kImageTag).Add(output_frame.release(),
                                    cc->InputTimestamp());
   return absl::OkStatus();
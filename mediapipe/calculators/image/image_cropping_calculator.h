@@ -5,6 +5,7 @@
 
 #include "mediapipe/calculators/image/image_cropping_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame_multi_pool.h"
 
 #if !MEDIAPIPE_DISABLE_GPU
 #include "mediapipe/gpu/gl_calculator_helper.h"
@@ -32,7 +33,8 @@
 //
 // Output:
 //   One of the following two tags:
-//   IMAGE - Cropped ImageFrame
+//   IMAGE - Cropped ImageFrame. May be a view into the input ImageFrame when
+//           the output_view option is set.
 //   IMAGE_GPU - Cropped GpuBuffer.
 //
 // Note: input_stream values take precedence over options defined in the graph.
@@ -83,6 +85,8 @@ class ImageCroppingCalculator : public CalculatorBase {
   float transformed_points_[8];
   float output_max_width_ = FLT_MAX;
   float output_max_height_ = FLT_MAX;
+  // Reuses output frames when the graph provides kImageFramePoolService.
+  ImageFrameMultiPool* image_frame_pool_ = nullptr;
 #if !MEDIAPIPE_DISABLE_GPU
   bool gpu_initialized_ = false;
   mediapipe::GlCalculatorHelper gpu_helper_;
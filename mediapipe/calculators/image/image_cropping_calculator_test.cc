@@ -19,6 +19,8 @@
 
 #include "mediapipe/calculators/image/image_cropping_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
@@ -212,5 +214,38 @@ TEST(ImageCroppingCalculatorTest, RedundantSpecWithInputStream) {
             expectRect);
 }  // TEST
 
+TEST(ImageCroppingCalculatorTest, OutputViewSharesInputPixels) {
+  CalculatorRunner runner(
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+        calculator: "ImageCroppingCalculator"
+        input_stream: "IMAGE:input_frames"
+        output_stream: "IMAGE:cropped_output_frames"
+        options: {
+          [mediapipe.ImageCroppingCalculatorOptions.ext] {
+            width: 4
+            height: 2
+            output_view: true
+          }
+        }
+      )pb"));
+  auto input_frame =
+      std::make_unique<ImageFrame>(ImageFormat::SRGB, /*width=*/8,
+                                   /*height=*/6);
+  const uint8* input_pixels = input_frame->PixelData();
+  const int input_width_step = input_frame->WidthStep();
+  runner.MutableInputs()->Tag("IMAGE").packets.push_back(
+      Adopt(input_frame.release()).At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& outputs = runner.Outputs().Tag("IMAGE").packets;
+  ASSERT_EQ(outputs.size(), 1);
+  const auto& output_frame = outputs[0].Get<ImageFrame>();
+  EXPECT_EQ(output_frame.Width(), 4);
+  EXPECT_EQ(output_frame.Height(), 2);
+  EXPECT_EQ(output_frame.WidthStep(), input_width_step);
+  // The crop is centered, so it starts at row 2, column 2 of the input.
+  EXPECT_EQ(output_frame.PixelData(), input_pixels + 2 * input_width_step + 6);
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -16,7 +16,9 @@
 #include "mediapipe/calculators/image/rotation_mode.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_multi_pool.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/formats/image_frame_pool_service.h"
 #include "mediapipe/framework/formats/video_stream_header.h"
 #include "mediapipe/framework/packet.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
@@ -169,6 +171,7 @@ mediapipe::ScaleMode_Mode ParseScaleMode(
 //   rotation_mode - (optional) Rotation in multiples of 90 degrees.
 //   flip_vertically, flip_horizontally - (optional) flip about x or y axis.
 //   scale_mode - (optional) Stretch, Fit, or Fill and Crop
+//   single_pass_cpu - (optional) Transform CPU images in a single warp.
 //
 // Note: To enable horizontal or vertical flipping, specify them in the
 // calculator options. Flipping is applied after rotation.
@@ -189,6 +192,7 @@ class ImageTransformationCalculator : public CalculatorBase {
 
  private:
   absl::Status RenderCpu(CalculatorContext* cc);
+  absl::Status RenderCpuSinglePass(CalculatorContext* cc);
   absl::Status RenderGpu(CalculatorContext* cc);
   absl::Status GlSetup();
 
@@ -207,6 +211,8 @@ class ImageTransformationCalculator : public CalculatorBase {
   bool flip_vertically_ = false;
 
   bool use_gpu_ = false;
+  // Reuses output frames when the graph provides kImageFramePoolService.
+  ImageFrameMultiPool* image_frame_pool_ = nullptr;
 #if !MEDIAPIPE_DISABLE_GPU
   GlCalculatorHelper gpu_helper_;
   std::unique_ptr<QuadRenderer> rgb_renderer_;
@@ -229,6 +235,7 @@ absl::Status ImageTransformationCalculator::GetContract(
     RET_CHECK(cc->Outputs().HasTag(kImageFrameTag));
     cc->Inputs().Tag(kImageFrameTag).Set<ImageFrame>();
     cc->Outputs().Tag(kImageFrameTag).Set<ImageFrame>();
+    cc->UseService(kImageFramePoolService).Optional();
   }
 #if !MEDIAPIPE_DISABLE_GPU
   if (cc->Inputs().HasTag(kGpuBufferTag)) {
@@ -303,6 +310,8 @@ absl::Status ImageTransformationCalculator::Open(CalculatorContext* cc) {
 
   if (cc->Inputs().HasTag(kGpuBufferTag)) {
     use_gpu_ = true;
+  } else if (cc->Service(kImageFramePoolService).IsAvailable()) {
+    image_frame_pool_ = &cc->Service(kImageFramePoolService).GetObject();
   }
 
   if (cc->InputSidePackets().HasTag("OUTPUT_DIMENSIONS")) {
@@ -439,6 +448,9 @@ absl::Status ImageTransformationCalculator::Close(CalculatorContext* cc) {
 }
 
 absl::Status ImageTransformationCalculator::RenderCpu(CalculatorContext* cc) {
+  if (options_.single_pass_cpu()) {
+    return RenderCpuSinglePass(cc);
+  }
   cv::Mat input_mat;
   mediapipe::ImageFormat::Format format;
 
@@ -534,8 +546,11 @@ absl::Status ImageTransformationCalculator::RenderCpu(CalculatorContext* cc) {
     flipped_mat = rotated_mat;
   }
 
-  std::unique_ptr<ImageFrame> output_frame(
-      new ImageFrame(format, output_width, output_height));
+  std::unique_ptr<ImageFrame> output_frame =
+      image_frame_pool_
+          ? image_frame_pool_->GetImageFrame(format, output_width,
+                                             output_height)
+          : std::make_unique<ImageFrame>(format, output_width, output_height);
   cv::Mat output_mat = formats::MatView(output_frame.get());
   flipped_mat.copyTo(output_mat);
   cc->Outputs()
@@ -545,6 +560,106 @@ absl::Status ImageTransformationCalculator::RenderCpu(CalculatorContext* cc) {
   return absl::OkStatus();
 }
 
+absl::Status ImageTransformationCalculator::RenderCpuSinglePass(
+    CalculatorContext* cc) {
+  const auto& input = cc->Inputs().Tag(kImageFrameTag).Get<ImageFrame>();
+  const cv::Mat input_mat = formats::MatView(&input);
+  const int input_width = input_mat.cols;
+  const int input_height = input_mat.rows;
+  int output_width;
+  int output_height;
+  ComputeOutputDimensions(input_width, input_height, &output_width,
+                          &output_height);
+
+  // Rotation as an affine map on continuous coordinates, where the pixel at
+  // (i, j) covers [i, i + 1] x [j, j + 1].
+  cv::Matx23d rotation;
+  int rotated_width = input_width;
+  int rotated_height = input_height;
+  switch (rotation_) {
+    case mediapipe::RotationMode_Mode_UNKNOWN:
+    case mediapipe::RotationMode_Mode_ROTATION_0:
+      rotation = cv::Matx23d(1, 0, 0, 0, 1, 0);
+      break;
+    case mediapipe::RotationMode_Mode_ROTATION_90:
+      rotation = cv::Matx23d(0, 1, 0, -1, 0, input_width);
+      std::swap(rotated_width, rotated_height);
+      break;
+    case mediapipe::RotationMode_Mode_ROTATION_180:
+      rotation = cv::Matx23d(-1, 0, input_width, 0, -1, input_height);
+      break;
+    case mediapipe::RotationMode_Mode_ROTATION_270:
+      rotation = cv::Matx23d(0, -1, input_height, 1, 0, 0);
+      std::swap(rotated_width, rotated_height);
+      break;
+  }
+
+  // Scaling of the rotated image and its offset in the output.
+  double scale_x = static_cast<double>(output_width) / rotated_width;
+  double scale_y = static_cast<double>(output_height) / rotated_height;
+  double left = 0;
+  double top = 0;
+  if (scale_mode_ != mediapipe::ScaleMode_Mode_STRETCH) {
+    const double scale = std::min(scale_x, scale_y);
+    const int target_width = std::round(rotated_width * scale);
+    const int target_height = std::round(rotated_height * scale);
+    if (scale_mode_ == mediapipe::ScaleMode_Mode_FIT) {
+      left = (output_width - target_width) / 2;
+      top = (output_height - target_height) / 2;
+    } else {
+      output_width = target_width;
+      output_height = target_height;
+    }
+    scale_x = static_cast<double>(target_width) / rotated_width;
+    scale_y = static_cast<double>(target_height) / rotated_height;
+  }
+  const double flip_x = flip_horizontally_ ? -1 : 1;
+  const double flip_y = flip_vertically_ ? -1 : 1;
+  const double a = flip_x * scale_x;
+  const double d = flip_y * scale_y;
+  const double b = flip_horizontally_ ? output_width - left : left;
+  const double e = flip_vertically_ ? output_height - top : top;
+  const cv::Matx33d rotation3(rotation(0, 0), rotation(0, 1), rotation(0, 2),
+                              rotation(1, 0), rotation(1, 1), rotation(1, 2),
+                              0, 0, 1);
+  const cv::Matx33d transform =
+      cv::Matx33d(a, 0, b, 0, d, e, 0, 0, 1) * rotation3;
+  // warpAffine works on pixel centers, i.e. continuous coordinates - 0.5.
+  cv::Matx23d pixel_transform(transform(0, 0), transform(0, 1), transform(0, 2),
+                              transform(1, 0), transform(1, 1),
+                              transform(1, 2));
+  for (int row = 0; row < 2; ++row) {
+    pixel_transform(row, 2) += 0.5 * (transform(row, 0) + transform(row, 1)) -
+                               0.5;
+  }
+
+  if (cc->Outputs().HasTag("LETTERBOX_PADDING")) {
+    auto padding = absl::make_unique<std::array<float, 4>>();
+    ComputeOutputLetterboxPadding(input_width, input_height, output_width,
+                                  output_height, padding.get());
+    cc->Outputs()
+        .Tag("LETTERBOX_PADDING")
+        .Add(padding.release(), cc->InputTimestamp());
+  }
+
+  std::unique_ptr<ImageFrame> output_frame =
+      image_frame_pool_
+          ? image_frame_pool_->GetImageFrame(input.Format(), output_width,
+                                             output_height)
+          : std::make_unique<ImageFrame>(input.Format(), output_width,
+                                         output_height);
+  cv::Mat output_mat = formats::MatView(output_frame.get());
+  cv::warpAffine(input_mat, output_mat, pixel_transform, output_mat.size(),
+                 cv::INTER_LINEAR,
+                 options_.constant_padding() ? cv::BORDER_CONSTANT
+                                             : cv::BORDER_REPLICATE);
+  cc->Outputs()
+      .Tag(kImageFrameTag)
+      .Add(output_frame.release(), cc->InputTimestamp());
+
+  return absl::OkStatus();
+}
+
 absl::Status ImageTransformationCalculator::RenderGpu(CalculatorContext* cc) {
 #if !MEDIAPIPE_DISABLE_GPU
   const auto& input = cc->Inputs().Tag(kGpuBufferTag).Get<GpuBuffer>();
@@ -12,26 +12,115 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "mediapipe/calculators/image/opencv_encoded_image_to_image_frame_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/framework/port/opencv_imgcodecs_inc.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/status_builder.h"
+#include "mediapipe/framework/port/statusor.h"
 
 namespace mediapipe {
 
+namespace {
+
+constexpr char kEncodedImagesTag[] = "ENCODED_IMAGES";
+constexpr char kImagesTag[] = "IMAGES";
+
+// Reads the frame size and number of components from the SOF marker of a JPEG
+// stream. Returns false if 'contents' is not a JPEG stream.
+bool ReadJpegHeader(const std::string& contents, int* width, int* height,
+                    int* components) {
+  const auto* data = reinterpret_cast<const uint8_t*>(contents.data());
+  const size_t size = contents.size();
+  if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) return false;
+  size_t pos = 2;
+  while (pos + 4 <= size) {
+    if (data[pos] != 0xFF) return false;
+    const uint8_t marker = data[pos + 1];
+    if (marker == 0xFF) {
+      // Fill byte.
+      ++pos;
+      continue;
+    }
+    // SOF0-SOF15, except DHT (0xC4), JPG (0xC8) and DAC (0xCC).
+    if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 &&
+        marker != 0xC8 && marker != 0xCC) {
+      if (pos + 10 > size) return false;
+      *height = (data[pos + 5] << 8) | data[pos + 6];
+      *width = (data[pos + 7] << 8) | data[pos + 8];
+      *components = data[pos + 9];
+      return true;
+    }
+    pos += 2 + ((data[pos + 2] << 8) | data[pos + 3]);
+  }
+  return false;
+}
+
+// Returns the largest DCT scale denominator (1, 2, 4 or 8) at which a
+// 'width' x 'height' image still covers 'target_width' x 'target_height'.
+int ScaleDenominator(int width, int height, int target_width,
+                     int target_height) {
+  int denominator = 8;
+  while (denominator > 1 && (width / denominator < target_width ||
+                             height / denominator < target_height)) {
+    denominator /= 2;
+  }
+  return denominator;
+}
+
+int ReducedReadFlag(int denominator, bool grayscale) {
+  switch (denominator) {
+    case 2:
+      return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_2
+                       : cv::IMREAD_REDUCED_COLOR_2;
+    case 4:
+      return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_4
+                       : cv::IMREAD_REDUCED_COLOR_4;
+    case 8:
+      return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_8
+                       : cv::IMREAD_REDUCED_COLOR_8;
+    default:
+      return grayscale ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR;
+  }
+}
+
+}  // namespace
+
 // Takes in an encoded image string, decodes it by OpenCV, and converts to an
 // ImageFrame. Note that this calculator only supports grayscale and RGB images
 // for now.
 //
+// JPEG images can be decoded directly at a reduced size close to a target
+// size, and cropped to a region, see the options. Alternatively, the
+// ENCODED_IMAGES input takes a std::vector<std::string> which is decoded in
+// parallel into a std::vector<ImageFrame> on the IMAGES output.
+//
 // Example config:
 // node {
 //   calculator: "OpenCvEncodedImageToImageFrameCalculator"
 //   input_stream: "encoded_image"
 //   output_stream: "image_frame"
 // }
+//
+// node {
+//   calculator: "OpenCvEncodedImageToImageFrameCalculator"
+//   input_stream: "ENCODED_IMAGES:encoded_images"
+//   output_stream: "IMAGES:image_frames"
+//   options: {
+//     [mediapipe.OpenCvEncodedImageToImageFrameCalculatorOptions.ext] {
+//       target_width: 256
+//       target_height: 256
+//     }
+//   }
+// }
 class OpenCvEncodedImageToImageFrameCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc);
@@ -39,11 +128,20 @@ class OpenCvEncodedImageToImageFrameCalculator : public CalculatorBase {
   absl::Status Process(CalculatorContext* cc) override;
 
  private:
+  absl::StatusOr<std::unique_ptr<ImageFrame>> Decode(
+      const std::string& contents) const;
+
   mediapipe::OpenCvEncodedImageToImageFrameCalculatorOptions options_;
 };
 
 absl::Status OpenCvEncodedImageToImageFrameCalculator::GetContract(
     CalculatorContract* cc) {
+  if (cc->Inputs().HasTag(kEncodedImagesTag)) {
+    RET_CHECK(cc->Outputs().HasTag(kImagesTag));
+    cc->Inputs().Tag(kEncodedImagesTag).Set<std::vector<std::string>>();
+    cc->Outputs().Tag(kImagesTag).Set<std::vector<ImageFrame>>();
+    return absl::OkStatus();
+  }
   cc->Inputs().Index(0).Set<std::string>();
   cc->Outputs().Index(0).Set<ImageFrame>();
   return absl::OkStatus();
@@ -53,25 +151,109 @@ absl::Status OpenCvEncodedImageToImageFrameCalculator::Open(
     CalculatorContext* cc) {
   options_ =
       cc->Options<mediapipe::OpenCvEncodedImageToImageFrameCalculatorOptions>();
+  if (options_.has_crop()) {
+    RET_CHECK(options_.crop().width() > 0 && options_.crop().height() > 0)
+        << "Crop region must not be empty.";
+  }
   return absl::OkStatus();
 }
 
 absl::Status OpenCvEncodedImageToImageFrameCalculator::Process(
     CalculatorContext* cc) {
-  const std::string& contents = cc->Inputs().Index(0).Get<std::string>();
-  const std::vector<char> contents_vector(contents.begin(), contents.end());
+  if (cc->Inputs().HasTag(kEncodedImagesTag)) {
+    const auto& contents =
+        cc->Inputs().Tag(kEncodedImagesTag).Get<std::vector<std::string>>();
+    auto output_frames =
+        absl::make_unique<std::vector<ImageFrame>>(contents.size());
+    std::vector<absl::Status> statuses(contents.size());
+    cv::parallel_for_(cv::Range(0, contents.size()),
+                      [&](const cv::Range& range) {
+                        for (int i = range.start; i < range.end; ++i) {
+                          auto frame = Decode(contents[i]);
+                          if (frame.ok()) {
+                            (*output_frames)[i] = std::move(**frame);
+                          } else {
+                            statuses[i] = frame.status();
+                          }
+                        }
+                      });
+    for (const auto& status : statuses) {
+      MP_RETURN_IF_ERROR(status);
+    }
+    cc->Outputs()
+        .Tag(kImagesTag)
+        .Add(output_frames.release(), cc->InputTimestamp());
+    return absl::OkStatus();
+  }
+
+  ASSIGN_OR_RETURN(auto output_frame,
+                   Decode(cc->Inputs().Index(0).Get<std::string>()));
+  cc->Outputs().Index(0).Add(output_frame.release(), cc->InputTimestamp());
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::unique_ptr<ImageFrame>>
+OpenCvEncodedImageToImageFrameCalculator::Decode(
+    const std::string& contents) const {
+  // Wraps the encoded bytes without copying them.
+  const cv::Mat contents_mat(1, contents.size(), CV_8UC1,
+                             const_cast<char*>(contents.data()));
+
+  // With a target size, JPEG is decoded at the smallest DCT scale that still
+  // covers it. The region to cover is the crop, or the whole image.
+  int denominator = 1;
+  bool grayscale = false;
+  int width, height, components;
+  if ((options_.target_width() > 0 || options_.target_height() > 0) &&
+      ReadJpegHeader(contents, &width, &height, &components)) {
+    grayscale = components == 1;
+    int target_width = options_.target_width();
+    int target_height = options_.target_height();
+    if (options_.has_crop()) {
+      width = options_.crop().width();
+      height = options_.crop().height();
+    } else if (options_.apply_orientation_from_exif_data()) {
+      // The EXIF orientation is not known before decoding, so compare long
+      // and short sides regardless of it.
+      if (width < height) std::swap(width, height);
+      if (target_width < target_height) std::swap(target_width, target_height);
+    }
+    denominator = ScaleDenominator(width, height, target_width, target_height);
+  }
+
   cv::Mat decoded_mat;
-  if (options_.apply_orientation_from_exif_data()) {
+  if (denominator > 1) {
+    decoded_mat = cv::imdecode(
+        contents_mat,
+        ReducedReadFlag(denominator, grayscale) |
+            (options_.apply_orientation_from_exif_data()
+                 ? 0
+                 : cv::IMREAD_IGNORE_ORIENTATION));
+  } else if (options_.apply_orientation_from_exif_data()) {
     // We want to respect the orientation from the EXIF data, which
     // IMREAD_UNCHANGED ignores, but otherwise we want to be as permissive as
     // possible with our reading flags. Therefore, we use IMREAD_ANYCOLOR and
     // IMREAD_ANYDEPTH.
-    decoded_mat = cv::imdecode(contents_vector,
-                               cv::IMREAD_ANYCOLOR | cv::IMREAD_ANYDEPTH);
+    decoded_mat =
+        cv::imdecode(contents_mat, cv::IMREAD_ANYCOLOR | cv::IMREAD_ANYDEPTH);
   } else {
     // Return the loaded image as-is
-    decoded_mat = cv::imdecode(contents_vector, cv::IMREAD_UNCHANGED);
+    decoded_mat = cv::imdecode(contents_mat, cv::IMREAD_UNCHANGED);
   }
+
+  if (options_.has_crop()) {
+    // OpenCV cannot decode a region only, so the (scaled) decoded image is
+    // cropped without a copy before the color conversion below.
+    const auto& crop = options_.crop();
+    const cv::Rect region =
+        cv::Rect(crop.x() / denominator, crop.y() / denominator,
+                 (crop.width() + denominator - 1) / denominator,
+                 (crop.height() + denominator - 1) / denominator) &
+        cv::Rect(0, 0, decoded_mat.cols, decoded_mat.rows);
+    RET_CHECK(!region.empty()) << "Crop region is outside of the image.";
+    decoded_mat = decoded_mat(region);
+  }
+
   ImageFormat::Format image_format = ImageFormat::UNKNOWN;
   cv::Mat output_mat;
   switch (decoded_mat.channels()) {
@@ -95,8 +277,7 @@ absl::Status OpenCvEncodedImageToImageFrameCalculator::Process(
       image_format, decoded_mat.size().width, decoded_mat.size().height,
       ImageFrame::kGlDefaultAlignmentBoundary);
   output_mat.copyTo(formats::MatView(output_frame.get()));
-  cc->Outputs().Index(0).Add(output_frame.release(), cc->InputTimestamp());
-  return absl::OkStatus();
+  return output_frame;
 }
 
 REGISTER_CALCULATOR(OpenCvEncodedImageToImageFrameCalculator);
@@ -102,5 +102,55 @@ TEST(OpenCvEncodedImageToImageFrameCalculatorTest, TestGrayscaleJpeg) {
   EXPECT_LE(max_val, 10);
 }
 
+TEST(OpenCvEncodedImageToImageFrameCalculatorTest, TestScaledDecode) {
+  std::string contents;
+  MP_ASSERT_OK(file::GetContents(
+      file::JoinPath("./", "/mediapipe/calculators/image/testdata/dino.jpg"),
+      &contents));
+
+  CalculatorGraphConfig::Node node_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+        calculator: "OpenCvEncodedImageToImageFrameCalculator"
+        input_stream: "ENCODED_IMAGES:encoded_images"
+        output_stream: "IMAGES:image_frames"
+        options: {
+          [mediapipe.OpenCvEncodedImageToImageFrameCalculatorOptions.ext] {
+            target_width: 256
+            target_height: 256
+          }
+        }
+      )pb");
+  CalculatorRunner runner(node_config);
+  runner.MutableInputs()
+      ->Tag("ENCODED_IMAGES")
+      .packets.push_back(
+          MakePacket<std::vector<std::string>>(
+              std::vector<std::string>{contents, contents})
+              .At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+  const std::vector<Packet>& packets = runner.Outputs().Tag("IMAGES").packets;
+  ASSERT_EQ(1, packets.size());
+  const auto& output_frames = packets[0].Get<std::vector<ImageFrame>>();
+  ASSERT_EQ(2, output_frames.size());
+
+  // dino.jpg is 2876x1699, the height only allows a 1/4 scale.
+  cv::Mat input_mat = cv::imread(
+      file::JoinPath("./", "/mediapipe/calculators/image/testdata/dino.jpg"));
+  cv::Mat expected_mat;
+  cv::resize(input_mat, expected_mat, cv::Size(719, 425), 0, 0,
+             cv::INTER_AREA);
+  for (const ImageFrame& output_frame : output_frames) {
+    ASSERT_EQ(719, output_frame.Width());
+    ASSERT_EQ(425, output_frame.Height());
+    cv::Mat output_mat;
+    cv::cvtColor(formats::MatView(&output_frame), output_mat,
+                 cv::COLOR_RGB2BGR);
+    cv::Mat diff;
+    cv::absdiff(expected_mat, output_mat, diff);
+    // DCT scaling and area resampling differ slightly.
+    EXPECT_LE(cv::mean(diff)[0], 5);
+  }
+}
+
 }  // namespace
 }  // namespace mediapipe
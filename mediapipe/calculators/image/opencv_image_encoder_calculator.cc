@@ -12,6 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "absl/synchronization/notification.h"
 #include "mediapipe/calculators/image/opencv_image_encoder_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
@@ -19,52 +25,21 @@
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/status_builder.h"
+#include "mediapipe/framework/port/threadpool.h"
 
 namespace mediapipe {
 
-// Calculator to encode raw image frames. This will result in considerable space
-// savings if the frames need to be stored on disk.
-//
-// Example config:
-// node {
-//   calculator: "OpenCvImageEncoderCalculator"
-//   input_stream: "image"
-//   output_stream: "encoded_image"
-//   node_options {
-//     [type.googleapis.com/mediapipe.OpenCvImageEncoderCalculatorOptions]: {
-//       quality: 80
-//     }
-//   }
-// }
-class OpenCvImageEncoderCalculator : public CalculatorBase {
- public:
-  static absl::Status GetContract(CalculatorContract* cc);
-  absl::Status Open(CalculatorContext* cc) override;
-  absl::Status Process(CalculatorContext* cc) override;
-  absl::Status Close(CalculatorContext* cc) override;
-
- private:
-  int encoding_quality_;
-};
+namespace {
 
-absl::Status OpenCvImageEncoderCalculator::GetContract(CalculatorContract* cc) {
-  cc->Inputs().Index(0).Set<ImageFrame>();
-  cc->Outputs().Index(0).Set<OpenCvImageEncoderCalculatorResults>();
-  return absl::OkStatus();
-}
+// Quality change applied per image when adapting to target_encoded_bytes.
+constexpr int kQualityStep = 5;
+// Relative deviation from target_encoded_bytes tolerated before adapting.
+constexpr float kTargetTolerance = 0.1f;
 
-absl::Status OpenCvImageEncoderCalculator::Open(CalculatorContext* cc) {
-  auto options = cc->Options<OpenCvImageEncoderCalculatorOptions>();
-  encoding_quality_ = options.quality();
-  return absl::OkStatus();
-}
-
-absl::Status OpenCvImageEncoderCalculator::Process(CalculatorContext* cc) {
-  const ImageFrame& image_frame = cc->Inputs().Index(0).Get<ImageFrame>();
+absl::Status Encode(const ImageFrame& image_frame, int quality,
+                    OpenCvImageEncoderCalculatorResults* encoded_result) {
   CHECK_EQ(1, image_frame.ByteDepth());
 
-  std::unique_ptr<OpenCvImageEncoderCalculatorResults> encoded_result =
-      absl::make_unique<OpenCvImageEncoderCalculatorResults>();
   encoded_result->set_width(image_frame.Width());
   encoded_result->set_height(image_frame.Height());
 
@@ -92,9 +67,11 @@ absl::Status OpenCvImageEncoderCalculator::Process(CalculatorContext* cc) {
 
   std::vector<int> parameters;
   parameters.push_back(cv::IMWRITE_JPEG_QUALITY);
-  parameters.push_back(encoding_quality_);
+  parameters.push_back(quality);
 
-  std::vector<uchar> encode_buffer;
+  // Reused across images encoded on the same thread, so that its capacity
+  // settles at the largest encoded size instead of growing on every image.
+  static thread_local std::vector<uchar> encode_buffer;
   // Note that imencode() will store the data in RGB order.
   // Check its JpegEncoder::write() in "imgcodecs/src/grfmt_jpeg.cpp" for more
   // info.
@@ -103,16 +80,133 @@ absl::Status OpenCvImageEncoderCalculator::Process(CalculatorContext* cc) {
            << "Fail to encode the image to be jpeg format.";
   }
 
-  encoded_result->set_encoded_image(&encode_buffer[0], encode_buffer.size());
+  encoded_result->set_encoded_image(encode_buffer.data(),
+                                    encode_buffer.size());
+  return absl::OkStatus();
+}
+
+}  // namespace
 
-  cc->Outputs().Index(0).Add(encoded_result.release(), cc->InputTimestamp());
+// Calculator to encode raw image frames. This will result in considerable space
+// savings if the frames need to be stored on disk.
+//
+// With num_threads set, images are encoded on a worker pool; Process() only
+// blocks once max_in_flight images are pending. Results keep the input order
+// and timestamps, and the remaining ones are output in Close().
+//
+// Example config:
+// node {
+//   calculator: "OpenCvImageEncoderCalculator"
+//   input_stream: "image"
+//   output_stream: "encoded_image"
+//   node_options {
+//     [type.googleapis.com/mediapipe.OpenCvImageEncoderCalculatorOptions]: {
+//       quality: 80
+//     }
+//   }
+// }
+class OpenCvImageEncoderCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+  absl::Status Close(CalculatorContext* cc) override;
+
+ private:
+  struct PendingResult {
+    Timestamp timestamp;
+    absl::Status status;
+    std::unique_ptr<OpenCvImageEncoderCalculatorResults> result;
+    absl::Notification done;
+  };
+
+  // Outputs the completed results at the front of the queue, waiting for
+  // more until at most 'max_pending' remain.
+  absl::Status OutputCompleted(CalculatorContext* cc, int max_pending);
+  void AdaptQuality(int encoded_bytes);
+
+  OpenCvImageEncoderCalculatorOptions options_;
+  int encoding_quality_;
+  int max_in_flight_ = 0;
+  std::deque<std::shared_ptr<PendingResult>> pending_;
+  std::unique_ptr<mediapipe::ThreadPool> pool_;
+};
+
+absl::Status OpenCvImageEncoderCalculator::GetContract(CalculatorContract* cc) {
+  cc->Inputs().Index(0).Set<ImageFrame>();
+  cc->Outputs().Index(0).Set<OpenCvImageEncoderCalculatorResults>();
+  return absl::OkStatus();
+}
+
+absl::Status OpenCvImageEncoderCalculator::Open(CalculatorContext* cc) {
+  options_ = cc->Options<OpenCvImageEncoderCalculatorOptions>();
+  encoding_quality_ = options_.quality();
+  if (options_.num_threads() > 0) {
+    max_in_flight_ = options_.max_in_flight() > 0
+                         ? options_.max_in_flight()
+                         : 2 * options_.num_threads();
+    pool_ = absl::make_unique<mediapipe::ThreadPool>(
+        "OpenCvImageEncoder", options_.num_threads());
+    pool_->StartWorkers();
+  }
   return absl::OkStatus();
 }
 
+absl::Status OpenCvImageEncoderCalculator::Process(CalculatorContext* cc) {
+  if (!pool_) {
+    auto encoded_result =
+        absl::make_unique<OpenCvImageEncoderCalculatorResults>();
+    MP_RETURN_IF_ERROR(Encode(cc->Inputs().Index(0).Get<ImageFrame>(),
+                              encoding_quality_, encoded_result.get()));
+    AdaptQuality(encoded_result->encoded_image().size());
+    cc->Outputs().Index(0).Add(encoded_result.release(), cc->InputTimestamp());
+    return absl::OkStatus();
+  }
+
+  auto pending = std::make_shared<PendingResult>();
+  pending->timestamp = cc->InputTimestamp();
+  pool_->Schedule([pending, packet = cc->Inputs().Index(0).Value(),
+                   quality = encoding_quality_] {
+    pending->result = absl::make_unique<OpenCvImageEncoderCalculatorResults>();
+    pending->status =
+        Encode(packet.Get<ImageFrame>(), quality, pending->result.get());
+    pending->done.Notify();
+  });
+  pending_.push_back(std::move(pending));
+  return OutputCompleted(cc, max_in_flight_);
+}
+
 absl::Status OpenCvImageEncoderCalculator::Close(CalculatorContext* cc) {
+  return OutputCompleted(cc, /*max_pending=*/0);
+}
+
+absl::Status OpenCvImageEncoderCalculator::OutputCompleted(
+    CalculatorContext* cc, int max_pending) {
+  while (!pending_.empty() &&
+         (static_cast<int>(pending_.size()) > max_pending ||
+          pending_.front()->done.HasBeenNotified())) {
+    std::shared_ptr<PendingResult> pending = std::move(pending_.front());
+    pending_.pop_front();
+    pending->done.WaitForNotification();
+    MP_RETURN_IF_ERROR(pending->status);
+    AdaptQuality(pending->result->encoded_image().size());
+    cc->Outputs().Index(0).Add(pending->result.release(), pending->timestamp);
+  }
   return absl::OkStatus();
 }
 
+void OpenCvImageEncoderCalculator::AdaptQuality(int encoded_bytes) {
+  const int target = options_.target_encoded_bytes();
+  if (target <= 0) return;
+  if (encoded_bytes > target * (1.f + kTargetTolerance)) {
+    encoding_quality_ -= kQualityStep;
+  } else if (encoded_bytes < target * (1.f - kTargetTolerance)) {
+    encoding_quality_ += kQualityStep;
+  }
+  encoding_quality_ = std::clamp(encoding_quality_, options_.min_quality(),
+                                 options_.quality());
+}
+
 REGISTER_CALCULATOR(OpenCvImageEncoderCalculator);
 
 }  // namespace mediapipe
@@ -83,5 +83,40 @@ TEST(OpenCvImageEncoderCalculatorTest, TestJpegWithQualities) {
   }
 }
 
+TEST(OpenCvImageEncoderCalculatorTest, TestParallelEncodingKeepsOrder) {
+  constexpr int kNumFrames = 8;
+  CalculatorGraphConfig::Node node_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+        calculator: "OpenCvImageEncoderCalculator"
+        input_stream: "image_frames"
+        output_stream: "encoded_images"
+        node_options {
+          [type.googleapis.com/mediapipe.OpenCvImageEncoderCalculatorOptions]: {
+            quality: 80
+            num_threads: 3
+          }
+        }
+      )pb");
+  CalculatorRunner runner(node_config);
+  for (int i = 0; i < kNumFrames; ++i) {
+    // Frames of different widths, so that the outputs can be told apart.
+    Packet input_packet =
+        MakePacket<ImageFrame>(ImageFormat::GRAY8, 16 * (i + 1), 16);
+    formats::MatView(&(input_packet.Get<ImageFrame>())).setTo(i * 16);
+    runner.MutableInputs()->Index(0).packets.push_back(
+        input_packet.At(Timestamp(i * 10)));
+  }
+  MP_ASSERT_OK(runner.Run());
+  const std::vector<Packet>& packets = runner.Outputs().Index(0).packets;
+  ASSERT_EQ(kNumFrames, packets.size());
+  for (int i = 0; i < kNumFrames; ++i) {
+    EXPECT_EQ(Timestamp(i * 10), packets[i].Timestamp());
+    const auto& result = packets[i].Get<OpenCvImageEncoderCalculatorResults>();
+    EXPECT_EQ(16 * (i + 1), result.width());
+    EXPECT_EQ(OpenCvImageEncoderCalculatorResults::GRAYSCALE,
+              result.colorspace());
+  }
+}
+
 }  // namespace
 }  // namespace mediapipe
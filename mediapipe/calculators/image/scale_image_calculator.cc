@@ -17,6 +17,8 @@
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
@@ -26,7 +28,9 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_format.pb.h"
 #include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_multi_pool.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/formats/image_frame_pool_service.h"
 #include "mediapipe/framework/formats/video_stream_header.h"
 #include "mediapipe/framework/formats/yuv_image.h"
 #include "mediapipe/framework/port/image_resizer.h"
@@ -137,6 +141,25 @@ void CropImageFrame(const ImageFrame& original, int col_start, int row_start,
 //   }
 // }
 //
+// With "pyramid_width" set, the calculator also outputs smaller versions of
+// the scaled frames on PYRAMID:0, PYRAMID:1, ..., each downscaled from the
+// previous one.
+//
+// Example config:
+// node {
+//   calculator: "ScaleImageCalculator"
+//   input_stream: "FRAMES:frames"
+//   output_stream: "FRAMES:full_frames"
+//   output_stream: "PYRAMID:0:frames_640"
+//   output_stream: "PYRAMID:1:frames_256"
+//   node_options {
+//     [type.googleapis.com/mediapipe.ScaleImageCalculatorOptions] {
+//       pyramid_width: 640
+//       pyramid_width: 256
+//     }
+//   }
+// }
+//
 // The calculator options can be overrided with an input stream
 // "OVERRIDE_OPTIONS". If this is provided, and non-empty at PreStream, the
 // calculator options proto is merged with the proto provided in this packet
@@ -179,11 +202,23 @@ class ScaleImageCalculator : public CalculatorBase {
       cc->Outputs().Get(output_data_id).Set<YUVImage>();
     } else {
       cc->Outputs().Get(output_data_id).Set<ImageFrame>();
+      cc->UseService(kImageFramePoolService).Optional();
     }
 
     if (cc->Inputs().HasTag("OVERRIDE_OPTIONS")) {
       cc->Inputs().Tag("OVERRIDE_OPTIONS").Set<ScaleImageCalculatorOptions>();
     }
+
+    const int num_pyramid_levels = cc->Outputs().NumEntries("PYRAMID");
+    RET_CHECK_EQ(num_pyramid_levels, options.pyramid_width_size())
+        << "Each pyramid_width needs a PYRAMID output stream.";
+    if (num_pyramid_levels > 0) {
+      RET_CHECK(options.output_format() != ImageFormat::YCBCR420P)
+          << "Pyramid levels are not supported for YCbCr420P output.";
+    }
+    for (int i = 0; i < num_pyramid_levels; ++i) {
+      cc->Outputs().Get("PYRAMID", i).Set<ImageFrame>();
+    }
     return absl::OkStatus();
   }
 
@@ -213,6 +248,13 @@ class ScaleImageCalculator : public CalculatorBase {
   // on which this function is called is used to initialize.
   absl::Status ValidateYUVImage(CalculatorContext* cc,
                                 const YUVImage& yuv_image);
+  // Returns an uninitialized frame with alignment_boundary_, taken from
+  // image_frame_pool_ when the graph provides one.
+  std::unique_ptr<ImageFrame> NewImageFrame(ImageFormat::Format format,
+                                            int width, int height);
+  // Sends `packet`, holding the output frame, and the pyramid levels
+  // downscaled from it.
+  absl::Status SendFrame(CalculatorContext* cc, const Packet& packet);
 
   bool has_header_;  // True if the input stream has a header.
   int input_width_;
@@ -223,6 +265,8 @@ class ScaleImageCalculator : public CalculatorBase {
   int row_start_;
   int output_width_;
   int output_height_;
+  // Dimensions of the pyramid levels below the output frame.
+  std::vector<std::pair<int, int>> pyramid_dimensions_;
   ImageFormat::Format input_format_;
   ImageFormat::Format output_format_;
   int interpolation_algorithm_;
@@ -243,6 +287,9 @@ class ScaleImageCalculator : public CalculatorBase {
 
   // Efficient image resizer with gamma correction and optional sharpening.
   std::unique_ptr<ImageResizer> downscaler_;
+
+  // Reuses output frames when the graph provides kImageFramePoolService.
+  ImageFrameMultiPool* image_frame_pool_ = nullptr;
 };
 
 REGISTER_CALCULATOR(ScaleImageCalculator);
@@ -273,6 +320,14 @@ absl::Status ScaleImageCalculator::InitializeFrameInfo(CalculatorContext* cc) {
     output_width_ = crop_width_;
     output_height_ = crop_height_;
   }
+  RET_CHECK_EQ(options_.pyramid_width_size(),
+               cc->Outputs().NumEntries("PYRAMID"))
+      << "Each pyramid_width needs a PYRAMID output stream.";
+  MP_RETURN_IF_ERROR(scale_image::FindPyramidDimensions(
+      output_width_, output_height_,
+      std::vector<int>(options_.pyramid_width().begin(),
+                       options_.pyramid_width().end()),
+      &pyramid_dimensions_));
   VLOG(1) << "Image scaling parameters:"
           << "\ninput_width_ " << input_width_      //
           << "\ninput_height_ " << input_height_    //
@@ -316,6 +371,13 @@ absl::Status ScaleImageCalculator::Open(CalculatorContext* cc) {
 
   // The output packets are at the same timestamp as the input.
   cc->Outputs().Get(output_data_id_).SetOffset(mediapipe::TimestampDiff(0));
+  for (int i = 0; i < cc->Outputs().NumEntries("PYRAMID"); ++i) {
+    cc->Outputs().Get("PYRAMID", i).SetOffset(mediapipe::TimestampDiff(0));
+  }
+
+  if (cc->Service(kImageFramePoolService).IsAvailable()) {
+    image_frame_pool_ = &cc->Service(kImageFramePoolService).GetObject();
+  }
 
   has_header_ = false;
   input_width_ = 0;
@@ -539,6 +601,37 @@ absl::Status ScaleImageCalculator::ValidateYUVImage(CalculatorContext* cc,
   return absl::OkStatus();
 }
 
+std::unique_ptr<ImageFrame> ScaleImageCalculator::NewImageFrame(
+    ImageFormat::Format format, int width, int height) {
+  if (image_frame_pool_) {
+    return image_frame_pool_->GetImageFrame(format, width, height,
+                                            alignment_boundary_);
+  }
+  return absl::make_unique<ImageFrame>(format, width, height,
+                                       alignment_boundary_);
+}
+
+absl::Status ScaleImageCalculator::SendFrame(CalculatorContext* cc,
+                                             const Packet& packet) {
+  cc->Outputs().Get(output_data_id_).AddPacket(packet);
+  const ImageFrame* previous_level = &packet.Get<ImageFrame>();
+  for (int i = 0; i < pyramid_dimensions_.size(); ++i) {
+    std::unique_ptr<ImageFrame> level =
+        NewImageFrame(previous_level->Format(), pyramid_dimensions_[i].first,
+                      pyramid_dimensions_[i].second);
+    cv::Mat input_mat = ::mediapipe::formats::MatView(previous_level);
+    cv::Mat output_mat = ::mediapipe::formats::MatView(level.get());
+    downscaler_->Resize(input_mat, &output_mat);
+    if (options_.set_alignment_padding()) {
+      level->SetAlignmentPaddingAreas();
+    }
+    // The packet keeps the level alive for the next one to read.
+    previous_level = level.get();
+    cc->Outputs().Get("PYRAMID", i).Add(level.release(), packet.Timestamp());
+  }
+  return absl::OkStatus();
+}
+
 absl::Status ScaleImageCalculator::Process(CalculatorContext* cc) {
   if (cc->InputTimestamp() == Timestamp::PreStream()) {
     if (cc->Inputs().HasTag("OVERRIDE_OPTIONS")) {
@@ -635,8 +728,8 @@ absl::Status ScaleImageCalculator::Process(CalculatorContext* cc) {
   if (crop_width_ < input_width_ || crop_height_ < input_height_) {
     cc->GetCounter("Crops")->Increment();
     // TODO Do the crop as a range restrict inside OpenCV code below.
-    cropped_image.reset(new ImageFrame(image_frame->Format(), crop_width_,
-                                       crop_height_, alignment_boundary_));
+    cropped_image =
+        NewImageFrame(image_frame->Format(), crop_width_, crop_height_);
     if (image_frame->ByteDepth() == 1 || image_frame->ByteDepth() == 2) {
       CropImageFrame(*image_frame, col_start_, row_start_, crop_width_,
                      crop_height_, cropped_image.get());
@@ -659,9 +752,8 @@ absl::Status ScaleImageCalculator::Process(CalculatorContext* cc) {
         cropped_image->SetAlignmentPaddingAreas();
       }
       cc->GetCounter("Outputs Cropped")->Increment();
-      cc->Outputs()
-          .Get(output_data_id_)
-          .Add(cropped_image.release(), cc->InputTimestamp());
+      MP_RETURN_IF_ERROR(SendFrame(
+          cc, Adopt(cropped_image.release()).At(cc->InputTimestamp())));
     } else {
       if (options_.alignment_boundary() <= 0 &&
           (!options_.set_alignment_padding() || image_frame->IsContiguous())) {
@@ -669,9 +761,8 @@ absl::Status ScaleImageCalculator::Process(CalculatorContext* cc) {
         // alignment padding (either because the user didn't request it
         // or because the data is contiguous).
         cc->GetCounter("Outputs Inputs")->Increment();
-        cc->Outputs()
-            .Get(output_data_id_)
-            .AddPacket(cc->Inputs().Get(input_data_id_).Value());
+        MP_RETURN_IF_ERROR(
+            SendFrame(cc, cc->Inputs().Get(input_data_id_).Value()));
       } else {
         // Make a copy with the correct alignment.
         std::unique_ptr<ImageFrame> output_frame(new ImageFrame());
@@ -680,28 +771,28 @@ absl::Status ScaleImageCalculator::Process(CalculatorContext* cc) {
           output_frame->SetAlignmentPaddingAreas();
         }
         cc->GetCounter("Outputs Aligned")->Increment();
-        cc->Outputs()
-            .Get(output_data_id_)
-            .Add(output_frame.release(), cc->InputTimestamp());
+        MP_RETURN_IF_ERROR(SendFrame(
+            cc, Adopt(output_frame.release()).At(cc->InputTimestamp())));
       }
     }
     return absl::OkStatus();
   }
 
   // Rescale the image frame.
-  std::unique_ptr<ImageFrame> output_frame(new ImageFrame());
+  std::unique_ptr<ImageFrame> output_frame;
   if (image_frame->Width() >= output_width_ &&
       image_frame->Height() >= output_height_) {
     // Downscale.
     cc->GetCounter("Downscales")->Increment();
     cv::Mat input_mat = ::mediapipe::formats::MatView(image_frame);
-    output_frame->Reset(image_frame->Format(), output_width_, output_height_,
-                        alignment_boundary_);
+    output_frame =
+        NewImageFrame(image_frame->Format(), output_width_, output_height_);
     cv::Mat output_mat = ::mediapipe::formats::MatView(output_frame.get());
     downscaler_->Resize(input_mat, &output_mat);
   } else {
     // Upscale. If upscaling is disallowed, output_width_ and output_height_ are
     // the same as the input/crop width and height.
+    output_frame = absl::make_unique<ImageFrame>();
     image_frame_util::RescaleImageFrame(
         *image_frame, output_width_, output_height_, alignment_boundary_,
         interpolation_algorithm_, output_frame.get());
@@ -716,10 +807,7 @@ absl::Status ScaleImageCalculator::Process(CalculatorContext* cc) {
   }
 
   cc->GetCounter("Outputs Scaled")->Increment();
-  cc->Outputs()
-      .Get(output_data_id_)
-      .Add(output_frame.release(), cc->InputTimestamp());
-  return absl::OkStatus();
+  return SendFrame(cc, Adopt(output_frame.release()).At(cc->InputTimestamp()));
 }
 
 }  // namespace mediapipe
@@ -17,7 +17,10 @@
 #include <math.h>
 
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/ret_check.h"
@@ -185,5 +188,32 @@ absl::Status FindOutputDimensions(int input_width,             //
       preserve_aspect_ratio, scale_to_multiple_of, output_width, output_height);
 }
 
+absl::Status FindPyramidDimensions(
+    int input_width, int input_height, const std::vector<int>& level_widths,
+    std::vector<std::pair<int, int>>* level_dimensions) {
+  CHECK(level_dimensions);
+  level_dimensions->clear();
+  int previous_width = input_width;
+  for (const int level_width : level_widths) {
+    RET_CHECK_LT(level_width, previous_width)
+        << "Pyramid level widths must be strictly decreasing and smaller than "
+           "the image width.";
+    // Computed from the image rather than the previous level so that rounding
+    // doesn't accumulate.
+    int width, height;
+    MP_RETURN_IF_ERROR(FindOutputDimensions(input_width, input_height,
+                                            level_width, /*target_height=*/-1,
+                                            /*preserve_aspect_ratio=*/true,
+                                            /*scale_to_multiple_of=*/2, &width,
+                                            &height));
+    RET_CHECK(width > 0 && height > 0) << absl::StrCat(
+        "Pyramid level of width ", level_width, " is too small for a ",
+        input_width, "x", input_height, " image.");
+    level_dimensions->emplace_back(width, height);
+    previous_width = width;
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace scale_image
 }  // namespace mediapipe
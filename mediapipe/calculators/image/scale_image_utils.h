@@ -17,6 +17,8 @@
 #define MEDIAPIPE_IMAGE_SCALE_IMAGE_UTILS_H_
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "mediapipe/framework/port/status.h"
 
@@ -60,6 +62,15 @@ absl::Status FindOutputDimensions(int input_width, int input_height,  //
                                   int scale_to_multiple_of,    //
                                   int* output_width, int* output_height);
 
+// Given the dimensions of an image and the widths of the levels of an image
+// pyramid below it, determine the dimensions of each level. Every level keeps
+// the aspect ratio of the image and has even dimensions. The widths must be
+// smaller than input_width and strictly decreasing, so that each level can be
+// downscaled from the previous one.
+absl::Status FindPyramidDimensions(
+    int input_width, int input_height, const std::vector<int>& level_widths,
+    std::vector<std::pair<int, int>>* level_dimensions);
+
 }  // namespace scale_image
 }  // namespace mediapipe
 
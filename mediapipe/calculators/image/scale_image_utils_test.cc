@@ -224,6 +224,19 @@ TEST(ScaleImageUtilsTest, FindOutputDimensionsMaxArea) {
   EXPECT_EQ(100, output_height);
 }
 
+TEST(ScaleImageUtilsTest, FindPyramidDimensions) {
+  std::vector<std::pair<int, int>> dimensions;
+  MP_ASSERT_OK(FindPyramidDimensions(1920, 1080, {640, 256}, &dimensions));
+  EXPECT_THAT(dimensions, testing::ElementsAre(std::make_pair(640, 360),
+                                               std::make_pair(256, 144)));
+  // Odd dimensions are rounded down.
+  MP_ASSERT_OK(FindPyramidDimensions(1000, 1000, {333}, &dimensions));
+  EXPECT_THAT(dimensions, testing::ElementsAre(std::make_pair(332, 332)));
+  // Widths must decrease.
+  EXPECT_FALSE(FindPyramidDimensions(1920, 1080, {256, 640}, &dimensions).ok());
+  EXPECT_FALSE(FindPyramidDimensions(640, 480, {640}, &dimensions).ok());
+}
+
 }  // namespace
 }  // namespace scale_image
 }  // namespace mediapipe
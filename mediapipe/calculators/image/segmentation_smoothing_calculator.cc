@@ -37,6 +37,12 @@
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #endif  // !MEDIAPIPE_DISABLE_OPENCV
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 namespace mediapipe {
 
 namespace {
@@ -45,6 +51,109 @@ constexpr char kPreviousMaskTag[] = "MASK_PREVIOUS";
 constexpr char kOutputMaskTag[] = "MASK_SMOOTHED";
 
 enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
+
+/*
+ * Assume p := new_mask_value
+ * H(p) := 1 + (p * log(p) + (1-p) * log(1-p)) / log(2)
+ * uncertainty alpha(p) =
+ *   Clamp(1 - (1 - H(p)) * (1 - H(p)), 0, 1) [squaring the uncertainty]
+ *
+ * The following polynomial approximates uncertainty alpha as a function
+ * of (p + 0.5):
+ */
+constexpr float kC1 = 5.68842;
+constexpr float kC2 = -0.748699;
+constexpr float kC3 = -57.8051;
+constexpr float kC4 = 291.309;
+constexpr float kC5 = -624.717;
+
+// Blends one row of the previous mask into the current one, weighted by the
+// uncertainty of the current mask value.
+void BlendRow(const float* prev, const float* curr, float ratio, int size,
+              float* dst) {
+  int i = 0;
+#if defined(__AVX2__)
+  {
+    const __m256 c1 = _mm256_set1_ps(kC1), c2 = _mm256_set1_ps(kC2),
+                 c3 = _mm256_set1_ps(kC3), c4 = _mm256_set1_ps(kC4),
+                 c5 = _mm256_set1_ps(kC5);
+    const __m256 half = _mm256_set1_ps(0.5f), one = _mm256_set1_ps(1.0f);
+    const __m256 ratio_v = _mm256_set1_ps(ratio);
+    for (; i + 8 <= size; i += 8) {
+      const __m256 new_value = _mm256_loadu_ps(curr + i);
+      const __m256 prev_value = _mm256_loadu_ps(prev + i);
+      const __m256 t = _mm256_sub_ps(new_value, half);
+      const __m256 x = _mm256_mul_ps(t, t);
+      __m256 poly = _mm256_add_ps(c4, _mm256_mul_ps(x, c5));
+      poly = _mm256_add_ps(c3, _mm256_mul_ps(x, poly));
+      poly = _mm256_add_ps(c2, _mm256_mul_ps(x, poly));
+      poly = _mm256_add_ps(c1, _mm256_mul_ps(x, poly));
+      const __m256 uncertainty =
+          _mm256_sub_ps(one, _mm256_min_ps(one, _mm256_mul_ps(x, poly)));
+      _mm256_storeu_ps(
+          dst + i,
+          _mm256_add_ps(new_value,
+                        _mm256_mul_ps(_mm256_sub_ps(prev_value, new_value),
+                                      _mm256_mul_ps(uncertainty, ratio_v))));
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  {
+    const __m128 c1 = _mm_set1_ps(kC1), c2 = _mm_set1_ps(kC2),
+                 c3 = _mm_set1_ps(kC3), c4 = _mm_set1_ps(kC4),
+                 c5 = _mm_set1_ps(kC5);
+    const __m128 half = _mm_set1_ps(0.5f), one = _mm_set1_ps(1.0f);
+    const __m128 ratio_v = _mm_set1_ps(ratio);
+    for (; i + 4 <= size; i += 4) {
+      const __m128 new_value = _mm_loadu_ps(curr + i);
+      const __m128 prev_value = _mm_loadu_ps(prev + i);
+      const __m128 t = _mm_sub_ps(new_value, half);
+      const __m128 x = _mm_mul_ps(t, t);
+      __m128 poly = _mm_add_ps(c4, _mm_mul_ps(x, c5));
+      poly = _mm_add_ps(c3, _mm_mul_ps(x, poly));
+      poly = _mm_add_ps(c2, _mm_mul_ps(x, poly));
+      poly = _mm_add_ps(c1, _mm_mul_ps(x, poly));
+      const __m128 uncertainty =
+          _mm_sub_ps(one, _mm_min_ps(one, _mm_mul_ps(x, poly)));
+      _mm_storeu_ps(dst + i,
+                    _mm_add_ps(new_value,
+                               _mm_mul_ps(_mm_sub_ps(prev_value, new_value),
+                                          _mm_mul_ps(uncertainty, ratio_v))));
+    }
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  {
+    const float32x4_t half = vdupq_n_f32(0.5f), one = vdupq_n_f32(1.0f);
+    const float32x4_t ratio_v = vdupq_n_f32(ratio);
+    for (; i + 4 <= size; i += 4) {
+      const float32x4_t new_value = vld1q_f32(curr + i);
+      const float32x4_t prev_value = vld1q_f32(prev + i);
+      const float32x4_t t = vsubq_f32(new_value, half);
+      const float32x4_t x = vmulq_f32(t, t);
+      float32x4_t poly = vmlaq_n_f32(vdupq_n_f32(kC4), x, kC5);
+      poly = vmlaq_f32(vdupq_n_f32(kC3), x, poly);
+      poly = vmlaq_f32(vdupq_n_f32(kC2), x, poly);
+      poly = vmlaq_f32(vdupq_n_f32(kC1), x, poly);
+      const float32x4_t uncertainty =
+          vsubq_f32(one, vminq_f32(one, vmulq_f32(x, poly)));
+      vst1q_f32(dst + i,
+                vmlaq_f32(new_value, vsubq_f32(prev_value, new_value),
+                          vmulq_f32(uncertainty, ratio_v)));
+    }
+  }
+#endif
+  for (; i < size; ++i) {
+    const float new_mask_value = curr[i];
+    const float t = new_mask_value - 0.5f;
+    const float x = t * t;
+    const float uncertainty =
+        1.0f -
+        std::min(1.0f, x * (kC1 + x * (kC2 + x * (kC3 + x * (kC4 + x * kC5)))));
+    dst[i] = new_mask_value +
+             (prev[i] - new_mask_value) * (uncertainty * ratio);
+  }
+}
 }  // namespace
 
 // A calculator for mixing two segmentation masks together,
@@ -66,6 +175,8 @@ enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
 //
 // Options:
 //   combine_with_previous_ratio - Amount of previous to blend with current.
+//   hold_previous_mask - Output MASK_PREVIOUS when there is no MASK, so that
+//                        segmentation can be skipped on some frames.
 //
 // Example:
 //  node {
@@ -99,6 +210,7 @@ class SegmentationSmoothingCalculator : public CalculatorBase {
   void GlRender(CalculatorContext* cc);
 
   float combine_with_previous_ratio_;
+  bool hold_previous_mask_;
 
   bool gpu_initialized_ = false;
 #if !MEDIAPIPE_DISABLE_GPU
@@ -129,6 +241,7 @@ absl::Status SegmentationSmoothingCalculator::Open(CalculatorContext* cc) {
   auto options =
       cc->Options<mediapipe::SegmentationSmoothingCalculatorOptions>();
   combine_with_previous_ratio_ = options.combine_with_previous_ratio();
+  hold_previous_mask_ = options.hold_previous_mask();
 
 #if !MEDIAPIPE_DISABLE_GPU
   MP_RETURN_IF_ERROR(gpu_helper_.Open(cc));
@@ -139,6 +252,13 @@ absl::Status SegmentationSmoothingCalculator::Open(CalculatorContext* cc) {
 
 absl::Status SegmentationSmoothingCalculator::Process(CalculatorContext* cc) {
   if (cc->Inputs().Tag(kCurrentMaskTag).IsEmpty()) {
+    if (hold_previous_mask_ &&
+        !cc->Inputs().Tag(kPreviousMaskTag).IsEmpty()) {
+      cc->Outputs()
+          .Tag(kOutputMaskTag)
+          .AddPacket(cc->Inputs().Tag(kPreviousMaskTag).Value().At(
+              cc->InputTimestamp()));
+    }
     return absl::OkStatus();
   }
   if (cc->Inputs().Tag(kPreviousMaskTag).IsEmpty()) {
@@ -208,46 +328,12 @@ absl::Status SegmentationSmoothingCalculator::RenderCpu(CalculatorContext* cc) {
   auto output_frame = std::make_shared<ImageFrame>(
       current_frame.image_format(), current_mat->cols, current_mat->rows);
   cv::Mat output_mat = mediapipe::formats::MatView(output_frame.get());
-  output_mat.setTo(cv::Scalar(0));
-
-  // Blending function.
-  const auto blending_fn = [&](const float prev_mask_value,
-                               const float new_mask_value) {
-    /*
-     * Assume p := new_mask_value
-     * H(p) := 1 + (p * log(p) + (1-p) * log(1-p)) / log(2)
-     * uncertainty alpha(p) =
-     *   Clamp(1 - (1 - H(p)) * (1 - H(p)), 0, 1) [squaring the uncertainty]
-     *
-     * The following polynomial approximates uncertainty alpha as a function
-     * of (p + 0.5):
-     */
-    const float c1 = 5.68842;
-    const float c2 = -0.748699;
-    const float c3 = -57.8051;
-    const float c4 = 291.309;
-    const float c5 = -624.717;
-    const float t = new_mask_value - 0.5f;
-    const float x = t * t;
 
-    const float uncertainty =
-        1.0f -
-        std::min(1.0f, x * (c1 + x * (c2 + x * (c3 + x * (c4 + x * c5)))));
-
-    return new_mask_value + (prev_mask_value - new_mask_value) *
-                                (uncertainty * combine_with_previous_ratio_);
-  };
-
-  // Write directly to the first channel of output.
+  // Every output pixel is written, so the output is not cleared first.
   for (int i = 0; i < output_mat.rows; ++i) {
-    float* out_ptr = output_mat.ptr<float>(i);
-    const float* curr_ptr = current_mat->ptr<float>(i);
-    const float* prev_ptr = previous_mat->ptr<float>(i);
-    for (int j = 0; j < output_mat.cols; ++j) {
-      const float new_mask_value = curr_ptr[j];
-      const float prev_mask_value = prev_ptr[j];
-      out_ptr[j] = blending_fn(prev_mask_value, new_mask_value);
-    }
+    BlendRow(previous_mat->ptr<float>(i), current_mat->ptr<float>(i),
+             combine_with_previous_ratio_, output_mat.cols,
+             output_mat.ptr<float>(i));
   }
 
   cc->Outputs()
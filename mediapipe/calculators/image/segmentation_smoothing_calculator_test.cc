@@ -202,5 +202,43 @@ TEST(SegmentationSmoothingCalculatorTest, TestSmoothing) {
   }
 }
 
+TEST(SegmentationSmoothingCalculatorTest, HoldsPreviousMaskWithoutCurrentMask) {
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "curr_mask"
+        input_stream: "prev_mask"
+        output_stream: "new_mask"
+        node {
+          calculator: "SegmentationSmoothingCalculator"
+          input_stream: "MASK:curr_mask"
+          input_stream: "MASK_PREVIOUS:prev_mask"
+          output_stream: "MASK_SMOOTHED:new_mask"
+          node_options {
+            [type.googleapis.com/
+             mediapipe.SegmentationSmoothingCalculatorOptions]: {
+              combine_with_previous_ratio: 0.7
+              hold_previous_mask: true
+            }
+          }
+        }
+      )pb");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("new_mask", &graph_config, &output_packets);
+  CalculatorGraph graph(graph_config);
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  Packet prev_packet = MakePacket<Image>(
+      std::make_unique<ImageFrame>(ImageFormat::VEC32F1, 4, 4));
+  MP_ASSERT_OK(
+      graph.AddPacketToInputStream("prev_mask", prev_packet.At(Timestamp(1))));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  // The previous mask is passed through as is at the same timestamp.
+  ASSERT_EQ(1, output_packets.size());
+  EXPECT_EQ(Timestamp(1), output_packets[0].Timestamp());
+  EXPECT_EQ(&prev_packet.Get<Image>(), &output_packets[0].Get<Image>());
+}
+
 }  // namespace
 }  // namespace mediapipe
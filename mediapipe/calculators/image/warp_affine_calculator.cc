@@ -17,6 +17,8 @@
 #include <array>
 #include <cstdint>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "mediapipe/calculators/image/affine_transformation.h"
 #if !MEDIAPIPE_DISABLE_GPU
@@ -53,6 +55,16 @@ AffineTransformation::BorderMode GetBorderMode(
   }
 }
 
+// Runners produce either the image itself or a pointer to it.
+template <typename T>
+T TakeOutput(T&& output) {
+  return std::move(output);
+}
+template <typename T>
+T TakeOutput(std::unique_ptr<T>&& output) {
+  return std::move(*output);
+}
+
 template <typename ImageT>
 class WarpAffineRunnerHolder {};
 
@@ -152,6 +164,44 @@ class WarpAffineRunnerHolder<mediapipe::Image> {
       return mediapipe::Image(std::make_shared<ImageFrame>(std::move(result)));
 #else
       return absl::UnavailableError("OpenCV support is disabled");
+#endif  // !MEDIAPIPE_DISABLE_OPENCV
+    }
+    absl::StatusOr<std::vector<mediapipe::Image>> RunBatch(
+        const mediapipe::Image& input,
+        const std::vector<std::array<float, 16>>& matrices,
+        const std::vector<AffineTransformation::Size>& sizes,
+        AffineTransformation::BorderMode border_mode) override {
+      std::vector<mediapipe::Image> images;
+      if (input.UsesGpu()) {
+#if !MEDIAPIPE_DISABLE_GPU
+        ASSIGN_OR_RETURN(auto* runner, gpu_holder_.GetRunner());
+        ASSIGN_OR_RETURN(auto results,
+                         runner->RunBatch(input.GetGpuBuffer(), matrices,
+                                          sizes, border_mode));
+        images.reserve(results.size());
+        for (auto& result : results) images.emplace_back(*result);
+        return images;
+#else
+        return absl::UnavailableError("GPU support is disabled");
+#endif  // !MEDIAPIPE_DISABLE_GPU
+      }
+#if !MEDIAPIPE_DISABLE_OPENCV
+      ASSIGN_OR_RETURN(auto* runner, cpu_holder_.GetRunner());
+      const auto& frame_ptr = input.GetImageFrameSharedPtr();
+      // Wrap image into image frame.
+      const ImageFrame image_frame(frame_ptr->Format(), frame_ptr->Width(),
+                                   frame_ptr->Height(), frame_ptr->WidthStep(),
+                                   const_cast<uint8_t*>(frame_ptr->PixelData()),
+                                   [](uint8* data){});
+      ASSIGN_OR_RETURN(auto results, runner->RunBatch(image_frame, matrices,
+                                                      sizes, border_mode));
+      images.reserve(results.size());
+      for (auto& result : results) {
+        images.emplace_back(std::make_shared<ImageFrame>(std::move(result)));
+      }
+      return images;
+#else
+      return absl::UnavailableError("OpenCV support is disabled");
 #endif  // !MEDIAPIPE_DISABLE_OPENCV
     }
 
@@ -170,19 +220,33 @@ class WarpAffineRunnerHolder<mediapipe::Image> {
 template <typename InterfaceT>
 class WarpAffineCalculatorImpl : public mediapipe::api2::NodeImpl<InterfaceT> {
  public:
-#if !MEDIAPIPE_DISABLE_GPU
   static absl::Status UpdateContract(CalculatorContract* cc) {
+    const bool single = InterfaceT::kMatrix(cc).IsConnected();
+    const bool batch = InterfaceT::kMatrices(cc).IsConnected();
+    RET_CHECK(single ^ batch)
+        << "Exactly one of MATRIX and MATRICES must be connected.";
+    if (single) {
+      RET_CHECK(InterfaceT::kOutputSize(cc).IsConnected() &&
+                InterfaceT::kOutImage(cc).IsConnected())
+          << "MATRIX requires OUTPUT_SIZE and IMAGE output.";
+    } else {
+      RET_CHECK(InterfaceT::kOutputSizes(cc).IsConnected() &&
+                InterfaceT::kOutImages(cc).IsConnected())
+          << "MATRICES requires OUTPUT_SIZES and IMAGES output.";
+    }
+#if !MEDIAPIPE_DISABLE_GPU
     if constexpr (std::is_same_v<InterfaceT, WarpAffineCalculatorGpu> ||
                   std::is_same_v<InterfaceT, WarpAffineCalculator>) {
       MP_RETURN_IF_ERROR(mediapipe::GlCalculatorHelper::UpdateContract(cc));
     }
+#endif  // !MEDIAPIPE_DISABLE_GPU
     return absl::OkStatus();
   }
-#endif  // !MEDIAPIPE_DISABLE_GPU
 
   absl::Status Open(CalculatorContext* cc) override { return holder_.Open(cc); }
 
   absl::Status Process(CalculatorContext* cc) override {
+    if (InterfaceT::kMatrices(cc).IsConnected()) return ProcessBatch(cc);
     if (InterfaceT::kInImage(cc).IsEmpty() ||
         InterfaceT::kMatrix(cc).IsEmpty() ||
         InterfaceT::kOutputSize(cc).IsEmpty()) {
@@ -206,8 +270,36 @@ class WarpAffineCalculatorImpl : public mediapipe::api2::NodeImpl<InterfaceT> {
   }
 
  private:
-  WarpAffineRunnerHolder<typename decltype(InterfaceT::kInImage)::PayloadT>
-      holder_;
+  using ImageT = typename decltype(InterfaceT::kInImage)::PayloadT;
+
+  absl::Status ProcessBatch(CalculatorContext* cc) {
+    if (InterfaceT::kInImage(cc).IsEmpty() ||
+        InterfaceT::kMatrices(cc).IsEmpty() ||
+        InterfaceT::kOutputSizes(cc).IsEmpty()) {
+      return absl::OkStatus();
+    }
+    std::vector<AffineTransformation::Size> output_sizes;
+    for (const auto& [out_width, out_height] : *InterfaceT::kOutputSizes(cc)) {
+      output_sizes.push_back({out_width, out_height});
+    }
+    ASSIGN_OR_RETURN(auto* runner, holder_.GetRunner());
+    ASSIGN_OR_RETURN(
+        auto results,
+        runner->RunBatch(
+            *InterfaceT::kInImage(cc), *InterfaceT::kMatrices(cc), output_sizes,
+            GetBorderMode(cc->Options<mediapipe::WarpAffineCalculatorOptions>()
+                              .border_mode())));
+    std::vector<ImageT> images;
+    images.reserve(results.size());
+    for (auto& result : results) {
+      images.push_back(TakeOutput(std::move(result)));
+    }
+    InterfaceT::kOutImages(cc).Send(std::move(images));
+
+    return absl::OkStatus();
+  }
+
+  WarpAffineRunnerHolder<ImageT> holder_;
 };
 
 }  // namespace
@@ -15,6 +15,10 @@
 #ifndef MEDIAPIPE_CALCULATORS_IMAGE_WARP_AFFINE_CALCULATOR_H_
 #define MEDIAPIPE_CALCULATORS_IMAGE_WARP_AFFINE_CALCULATOR_H_
 
+#include <array>
+#include <utility>
+#include <vector>
+
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/formats/image.h"
@@ -40,8 +44,21 @@ namespace mediapipe {
 //   OUTPUT_SIZE - std::pair<int, int>
 //     Size of the output image.
 //
+//   MATRICES - std::vector<std::array<float, 16>>
+//     Used instead of MATRIX to produce several transformations of the same
+//     input at once, e.g. one per face. The input is bound once and all
+//     transformations are done in a single GL pass or a single parallel CPU
+//     loop.
+//
+//   OUTPUT_SIZES - std::vector<std::pair<int, int>>
+//     Sizes of the output images, one per MATRICES entry.
+//
 // Output:
 //   IMAGE - Image/ImageFrame/GpuBuffer
+//     Produced when MATRIX and OUTPUT_SIZE are used.
+//
+//   IMAGES - std::vector<Image/ImageFrame/GpuBuffer>
+//     Produced when MATRICES and OUTPUT_SIZES are used.
 //
 //   Note:
 //   - Output image type and format are the same as the input one.
@@ -63,18 +80,27 @@ template <typename ImageT>
 class WarpAffineCalculatorIntf : public mediapipe::api2::NodeIntf {
  public:
   static constexpr mediapipe::api2::Input<ImageT> kInImage{"IMAGE"};
-  static constexpr mediapipe::api2::Input<std::array<float, 16>> kMatrix{
-      "MATRIX"};
-  static constexpr mediapipe::api2::Input<std::pair<int, int>> kOutputSize{
-      "OUTPUT_SIZE"};
-  static constexpr mediapipe::api2::Output<ImageT> kOutImage{"IMAGE"};
+  static constexpr mediapipe::api2::Input<std::array<float, 16>>::Optional
+      kMatrix{"MATRIX"};
+  static constexpr mediapipe::api2::Input<std::pair<int, int>>::Optional
+      kOutputSize{"OUTPUT_SIZE"};
+  static constexpr mediapipe::api2::Input<
+      std::vector<std::array<float, 16>>>::Optional kMatrices{"MATRICES"};
+  static constexpr mediapipe::api2::Input<
+      std::vector<std::pair<int, int>>>::Optional kOutputSizes{"OUTPUT_SIZES"};
+  static constexpr typename mediapipe::api2::Output<ImageT>::Optional
+      kOutImage{"IMAGE"};
+  static constexpr
+      typename mediapipe::api2::Output<std::vector<ImageT>>::Optional
+          kOutImages{"IMAGES"};
 };
 
 #if !MEDIAPIPE_DISABLE_OPENCV
 class WarpAffineCalculatorCpu : public WarpAffineCalculatorIntf<ImageFrame> {
  public:
   MEDIAPIPE_NODE_INTERFACE(WarpAffineCalculatorCpu, kInImage, kMatrix,
-                           kOutputSize, kOutImage);
+                           kOutputSize, kMatrices, kOutputSizes, kOutImage,
+                           kOutImages);
 };
 #endif  // !MEDIAPIPE_DISABLE_OPENCV
 #if !MEDIAPIPE_DISABLE_GPU
@@ -82,13 +108,14 @@ class WarpAffineCalculatorGpu
     : public WarpAffineCalculatorIntf<mediapipe::GpuBuffer> {
  public:
   MEDIAPIPE_NODE_INTERFACE(WarpAffineCalculatorGpu, kInImage, kMatrix,
-                           kOutputSize, kOutImage);
+                           kOutputSize, kMatrices, kOutputSizes, kOutImage,
+                           kOutImages);
 };
 #endif  // !MEDIAPIPE_DISABLE_GPU
 class WarpAffineCalculator : public WarpAffineCalculatorIntf<mediapipe::Image> {
  public:
   MEDIAPIPE_NODE_INTERFACE(WarpAffineCalculator, kInImage, kMatrix, kOutputSize,
-                           kOutImage);
+                           kMatrices, kOutputSizes, kOutImage, kOutImages);
 };
 
 }  // namespace mediapipe
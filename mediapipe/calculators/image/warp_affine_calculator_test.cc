@@ -611,5 +611,76 @@ TEST(WarpAffineCalculatorTest, NoOpBorderZero) {
           out_width, out_height, border_mode);
 }
 
+TEST(WarpAffineCalculatorTest, BatchCpu) {
+  mediapipe::NormalizedRect roi;
+  roi.set_x_center(0.5f);
+  roi.set_y_center(0.5f);
+  roi.set_width(1.0f);
+  roi.set_height(1.0f);
+  roi.set_rotation(0);
+  auto input = GetRgba(
+      "/mediapipe/calculators/"
+      "tensor/testdata/image_to_tensor/input.jpg");
+  auto expected_output = GetRgba(
+      "/mediapipe/calculators/"
+      "tensor/testdata/image_to_tensor/noop_except_range.png");
+  constexpr int kOutWidth = 64;
+  constexpr int kOutHeight = 128;
+  constexpr int kNumOutputs = 3;
+  const auto matrix = GetMatrix(input, roi, /*keep_aspect_ratio=*/true,
+                                kOutWidth, kOutHeight);
+
+  auto graph_config = mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+    input_stream: "input_image"
+    input_stream: "output_sizes"
+    input_stream: "matrices"
+    node {
+      calculator: "WarpAffineCalculatorCpu"
+      input_stream: "IMAGE:input_image"
+      input_stream: "MATRICES:matrices"
+      input_stream: "OUTPUT_SIZES:output_sizes"
+      output_stream: "IMAGES:output_images"
+    }
+  )");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("output_images", &graph_config, &output_packets);
+
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(graph_config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  ImageFrame input_image(
+      input.channels() == 4 ? ImageFormat::SRGBA : ImageFormat::SRGB,
+      input.cols, input.rows, input.step, input.data, [](uint8*) {});
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "input_image",
+      MakePacket<ImageFrame>(std::move(input_image)).At(Timestamp(0))));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "matrices", MakePacket<std::vector<std::array<float, 16>>>(
+                      std::vector<std::array<float, 16>>(kNumOutputs, matrix))
+                      .At(Timestamp(0))));
+  const std::vector<std::pair<int, int>> output_sizes(
+      kNumOutputs, {kOutWidth, kOutHeight});
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "output_sizes",
+      MakePacket<std::vector<std::pair<int, int>>>(output_sizes)
+          .At(Timestamp(0))));
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  ASSERT_THAT(output_packets, testing::SizeIs(1));
+
+  const auto& out_frames = output_packets[0].Get<std::vector<ImageFrame>>();
+  ASSERT_EQ(out_frames.size(), kNumOutputs);
+  for (const ImageFrame& out_frame : out_frames) {
+    cv::Mat result = formats::MatView(&out_frame);
+    double similarity = 1.0 - cv::norm(result, expected_output,
+                                       cv::NORM_RELATIVE | cv::NORM_L2);
+    EXPECT_GE(similarity, 0.99);
+  }
+
+  MP_ASSERT_OK(graph.CloseInputStream("input_image"));
+  MP_ASSERT_OK(graph.CloseInputStream("matrices"));
+  MP_ASSERT_OK(graph.CloseInputStream("output_sizes"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -18,14 +18,17 @@
 
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
-#include "libyuv/convert_argb.h"
 #include "libyuv/video_common.h"
+#include "mediapipe/calculators/image/yuv_to_image_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/yuv_image.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/util/image_frame_util.h"
 
 namespace mediapipe {
 namespace api2 {
@@ -50,6 +53,10 @@ std::string FourCCToString(libyuv::FourCC fourcc) {
 // YV21) format (as per the `fourcc()` property). This covers the most commonly
 // used YUV image formats used on mobile devices. Other formats are not
 // supported and wil result in an `InvalidArgumentError`.
+//
+// The output is SRGB by default. YUVToImageCalculatorOptions can select SRGBA
+// or SBGRA output instead, and a smaller output size, in which case the YUV
+// planes are resized before the color conversion.
 class YUVToImageCalculator : public Node {
  public:
   static constexpr Input<YUVImage> kInput{"YUV_IMAGE"};
@@ -57,6 +64,13 @@ class YUVToImageCalculator : public Node {
 
   MEDIAPIPE_NODE_CONTRACT(kInput, kOutput);
 
+  absl::Status Open(CalculatorContext* cc) override {
+    options_ = cc->Options<YUVToImageCalculatorOptions>();
+    RET_CHECK(options_.has_output_width() == options_.has_output_height())
+        << "Both output_width and output_height must be set, or neither.";
+    return absl::OkStatus();
+  }
+
   absl::Status Process(CalculatorContext* cc) override {
     const auto& yuv_image = *kInput(cc);
     // Check that the format is supported.
@@ -68,54 +82,23 @@ class YUVToImageCalculator : public Node {
                           "YV12 and I420 (aka YV21) are supported.",
                           FourCCToString(format)));
     }
-    // Build a transient ImageFrameSharedPtr with default alignment to host
-    // conversion results.
-    ImageFrameSharedPtr image_frame = std::make_shared<ImageFrame>(
-        ImageFormat::SRGB, yuv_image.width(), yuv_image.height());
-    // Perform actual conversion.
-    switch (format) {
-      case libyuv::FOURCC_NV12:
-        // 8-bit Y plane followed by an interleaved 8-bit U/V plane with 2×2
-        // subsampling.
-        libyuv::NV12ToRAW(
-            yuv_image.data(0), yuv_image.stride(0), yuv_image.data(1),
-            yuv_image.stride(1), image_frame->MutablePixelData(),
-            image_frame->WidthStep(), yuv_image.width(), yuv_image.height());
-        break;
-      case libyuv::FOURCC_NV21:
-        // 8-bit Y plane followed by an interleaved 8-bit V/U plane with 2×2
-        // subsampling.
-        libyuv::NV21ToRAW(
-            yuv_image.data(0), yuv_image.stride(0), yuv_image.data(1),
-            yuv_image.stride(1), image_frame->MutablePixelData(),
-            image_frame->WidthStep(), yuv_image.width(), yuv_image.height());
-        break;
-      case libyuv::FOURCC_I420:
-        // Also known as YV21.
-        // 8-bit Y plane followed by 8-bit 2×2 subsampled U and V planes.
-        libyuv::I420ToRAW(
-            yuv_image.data(0), yuv_image.stride(0), yuv_image.data(1),
-            yuv_image.stride(1), yuv_image.data(2), yuv_image.stride(2),
-            image_frame->MutablePixelData(), image_frame->WidthStep(),
-            yuv_image.width(), yuv_image.height());
-        break;
-      case libyuv::FOURCC_YV12:
-        // 8-bit Y plane followed by 8-bit 2×2 subsampled V and U planes.
-        libyuv::I420ToRAW(
-            yuv_image.data(0), yuv_image.stride(0), yuv_image.data(2),
-            yuv_image.stride(2), yuv_image.data(1), yuv_image.stride(1),
-            image_frame->MutablePixelData(), image_frame->WidthStep(),
-            yuv_image.width(), yuv_image.height());
-        break;
-      default:
-        // This should never happen (caught by checks above).
-        return absl::InternalError("Unsupported YUVImage format.");
-    }
+    // Build a transient ImageFrameSharedPtr to host conversion results.
+    auto image_frame = std::make_shared<ImageFrame>();
+    MP_RETURN_IF_ERROR(image_frame_util::ConvertYUVImageToImageFrame(
+        yuv_image, options_.output_format(),
+        options_.has_output_width() ? options_.output_width()
+                                    : yuv_image.width(),
+        options_.has_output_height() ? options_.output_height()
+                                     : yuv_image.height(),
+        image_frame.get()));
     // Finally, build and send an Image object that takes ownership of the
     // transient ImageFrameSharedPtr object.
     kOutput(cc).Send(std::make_unique<Image>(std::move(image_frame)));
     return absl::OkStatus();
   }
+
+ private:
+  YUVToImageCalculatorOptions options_;
 };
 MEDIAPIPE_REGISTER_NODE(YUVToImageCalculator);
 
@@ -25,8 +25,8 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "audio/dsp/resampler_q.h"
-#include "audio/dsp/window_functions.h"
 #include "mediapipe/calculators/tensor/audio_to_tensor_calculator.pb.h"
+#include "mediapipe/calculators/tensor/audio_to_tensor_utils.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/packet.h"
 #include "mediapipe/framework/api2/port.h"
@@ -36,7 +36,6 @@
 #include "mediapipe/framework/formats/time_series_header.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/time_series_util.h"
-#include "pffft.h"
 
 namespace mediapipe {
 namespace api2 {
@@ -45,34 +44,6 @@ namespace {
 using Options = ::mediapipe::AudioToTensorCalculatorOptions;
 using FlushMode = Options::FlushMode;
 
-std::vector<float> HannWindow(int window_size, bool sqrt_hann) {
-  std::vector<float> hann_window(window_size);
-  audio_dsp::HannWindow().GetPeriodicSamples(window_size, &hann_window);
-  if (sqrt_hann) {
-    absl::c_transform(hann_window, hann_window.begin(),
-                      [](double x) { return std::sqrt(x); });
-  }
-  return hann_window;
-}
-
-// PFFFT only supports transforms for inputs of length N of the form
-// N = (2^a)*(3^b)*(5^c) where b >=0 and c >= 0 and a >= 5 for the real FFT.
-bool IsValidFftSize(int size) {
-  if (size <= 0) {
-    return false;
-  }
-  constexpr int kFactors[] = {2, 3, 5};
-  int factorization[] = {0, 0, 0};
-  int n = static_cast<int>(size);
-  for (int i = 0; i < 3; ++i) {
-    while (n % kFactors[i] == 0) {
-      n = n / kFactors[i];
-      ++factorization[i];
-    }
-  }
-  return factorization[0] >= 5 && n == 1;
-}
-
 }  // namespace
 
 // Converts audio buffers into tensors, possibly with resampling, buffering
@@ -103,7 +74,9 @@ bool IsValidFftSize(int size) {
 //     be cached in a global sample buffer. The audio data resampled from the
 //     current raw audio input will be appended to the global sample buffer.
 //     The calculator will process the global sample buffer and output as many
-//     tensors as possible.
+//     tensors as possible. Only the new samples are resampled and copied into
+//     the buffer, so the cost of an input packet doesn't grow with the number
+//     of overlapping samples.
 //   Non-streaming mode: when "stream_mode" is set to false in the calculator
 //     options, the calculators treats the packets in the input audio stream as
 //     a batch of unrelated audio buffers. In each Process() call, the input
@@ -198,32 +171,40 @@ class AudioToTensorCalculator : public Node {
   audio_dsp::QResamplerParams params_;
   // A QResampler instance to resample an audio stream.
   std::unique_ptr<audio_dsp::QResampler<float>> resampler_;
+  // The global sample buffer holds the buffered samples in columns
+  // [buffer_start_, buffer_start_ + buffer_size_), followed by spare capacity.
+  // Consumed samples are dropped by advancing `buffer_start_`, and the
+  // buffered samples are only moved back to the front once they no longer
+  // overlap with the consumed ones, so that each sample is copied a constant
+  // number of times on average.
   Matrix sample_buffer_;
+  int buffer_start_ = 0;
+  int buffer_size_ = 0;
   int processed_buffer_cols_ = 0;
 
-  // The internal state of the FFT library.
-  PFFFT_Setup* fft_state_ = nullptr;
-  int fft_size_ = 0;
-  std::vector<float> fft_window_;
-  std::vector<float, Eigen::aligned_allocator<float>> fft_input_buffer_;
-  // pffft requires memory to work with to avoid using the stack.
-  std::vector<float, Eigen::aligned_allocator<float>> fft_workplace_;
-  std::vector<float, Eigen::aligned_allocator<float>> fft_output_;
+  // Null unless the calculator outputs fft tensors.
+  std::unique_ptr<AudioFft> fft_;
 
   absl::Status ProcessStreamingData(CalculatorContext* cc, const Matrix& input);
   absl::Status ProcessNonStreamingData(CalculatorContext* cc,
                                        const Matrix& input);
 
   absl::Status SetupStreamingResampler(double input_sample_rate_);
-  void AppendToSampleBuffer(Matrix buffer_to_append);
+  // Makes room for `num_samples` more samples after the buffered samples.
+  void ReserveSampleBuffer(int num_samples);
+  void AppendToSampleBuffer(const Eigen::Ref<const Matrix>& buffer_to_append);
   void AppendZerosToSampleBuffer(int num_samples);
+  // Returns the buffered samples.
+  Eigen::Ref<const Matrix> BufferedSamples() const {
+    return sample_buffer_.middleCols(buffer_start_, buffer_size_);
+  }
 
   absl::StatusOr<std::vector<Tensor>> ConvertToTensor(
-      const Matrix& block, std::vector<int> tensor_dims);
-  absl::Status OutputTensor(const Matrix& block, Timestamp timestamp,
-                            CalculatorContext* cc);
-  absl::Status ProcessBuffer(const Matrix& buffer, bool should_flush,
-                             CalculatorContext* cc);
+      const Eigen::Ref<const Matrix>& block, std::vector<int> tensor_dims);
+  absl::Status OutputTensor(const Eigen::Ref<const Matrix>& block,
+                            Timestamp timestamp, CalculatorContext* cc);
+  absl::Status ProcessBuffer(const Eigen::Ref<const Matrix>& buffer,
+                             bool should_flush, CalculatorContext* cc);
 };
 
 absl::Status AudioToTensorCalculator::UpdateContract(CalculatorContract* cc) {
@@ -297,12 +278,7 @@ absl::Status AudioToTensorCalculator::Open(CalculatorContext* cc) {
         << options.fft_size();
     RET_CHECK_EQ(1, num_channels_)
         << "Currently only support applying FFT on mono channel.";
-    fft_size_ = options.fft_size();
-    fft_state_ = pffft_new_setup(fft_size_, PFFFT_REAL);
-    fft_window_ = HannWindow(fft_size_, /* sqrt_hann = */ false);
-    fft_input_buffer_.resize(fft_size_);
-    fft_workplace_.resize(fft_size_);
-    fft_output_.resize(fft_size_);
+    ASSIGN_OR_RETURN(fft_, AudioFft::Create(options.fft_size()));
   } else {
     RET_CHECK(!kDcAndNyquistOut(cc).IsConnected())
         << "The DC_AND_NYQUIST output stream can only be connected when the "
@@ -351,14 +327,10 @@ absl::Status AudioToTensorCalculator::Close(CalculatorContext* cc) {
   if (resampler_) {
     Matrix resampled_buffer(num_channels_, 0);
     resampler_->Flush(&resampled_buffer);
-    AppendToSampleBuffer(std::move(resampled_buffer));
+    AppendToSampleBuffer(resampled_buffer);
   }
   AppendZerosToSampleBuffer(padding_samples_after_);
-  MP_RETURN_IF_ERROR(ProcessBuffer(sample_buffer_, /*should_flush=*/true, cc));
-  if (fft_state_) {
-    pffft_destroy_setup(fft_state_);
-  }
-  return absl::OkStatus();
+  return ProcessBuffer(BufferedSamples(), /*should_flush=*/true, cc);
 }
 
 absl::Status AudioToTensorCalculator::ProcessStreamingData(
@@ -386,23 +358,16 @@ absl::Status AudioToTensorCalculator::ProcessStreamingData(
   if (resampler_) {
     Matrix resampled_buffer(num_channels_, 0);
     resampler_->ProcessSamples(input_buffer, &resampled_buffer);
-    AppendToSampleBuffer(std::move(resampled_buffer));
+    AppendToSampleBuffer(resampled_buffer);
   } else {
-    // Tries to consume the input matrix first to avoid extra data copy.
-    auto status_or_matrix = kAudioIn(cc).packet().Consume<Matrix>();
-    if (status_or_matrix.ok()) {
-      Matrix local_matrix(num_channels_, 0);
-      local_matrix.swap(*status_or_matrix.value());
-      AppendToSampleBuffer(std::move(local_matrix));
-    } else {
-      AppendToSampleBuffer(input_buffer);
-    }
+    AppendToSampleBuffer(input_buffer);
   }
 
-  MP_RETURN_IF_ERROR(ProcessBuffer(sample_buffer_, /*should_flush=*/false, cc));
+  MP_RETURN_IF_ERROR(
+      ProcessBuffer(BufferedSamples(), /*should_flush=*/false, cc));
   // Removes the processed samples from the global sample buffer.
-  sample_buffer_ = Matrix(sample_buffer_.rightCols(sample_buffer_.cols() -
-                                                   processed_buffer_cols_ - 1));
+  buffer_start_ += processed_buffer_cols_ + 1;
+  buffer_size_ -= processed_buffer_cols_ + 1;
   return absl::OkStatus();
 }
 
@@ -440,24 +405,49 @@ absl::Status AudioToTensorCalculator::SetupStreamingResampler(
   return absl::OkStatus();
 }
 
+void AudioToTensorCalculator::ReserveSampleBuffer(int num_samples) {
+  const int required_cols = buffer_size_ + num_samples;
+  if (buffer_start_ + required_cols <= sample_buffer_.cols()) {
+    return;
+  }
+  if (required_cols <= sample_buffer_.cols() &&
+      buffer_start_ >= buffer_size_) {
+    // Moves the buffered samples to the front, which doesn't overlap them.
+    sample_buffer_.leftCols(buffer_size_) =
+        sample_buffer_.middleCols(buffer_start_, buffer_size_);
+  } else {
+    Matrix new_buffer(num_channels_,
+                      std::max<Eigen::Index>(2 * sample_buffer_.cols(),
+                                             required_cols));
+    if (buffer_size_ > 0) {
+      new_buffer.leftCols(buffer_size_) = BufferedSamples();
+    }
+    sample_buffer_.swap(new_buffer);
+  }
+  buffer_start_ = 0;
+}
+
 void AudioToTensorCalculator::AppendZerosToSampleBuffer(int num_samples) {
   CHECK_GE(num_samples, 0);  // Ensured by `UpdateContract`.
   if (num_samples == 0) {
     return;
   }
-  sample_buffer_.conservativeResize(Eigen::NoChange,
-                                    sample_buffer_.cols() + num_samples);
-  sample_buffer_.rightCols(num_samples).setZero();
+  ReserveSampleBuffer(num_samples);
+  sample_buffer_.middleCols(buffer_start_ + buffer_size_, num_samples)
+      .setZero();
+  buffer_size_ += num_samples;
 }
 
-void AudioToTensorCalculator::AppendToSampleBuffer(Matrix buffer_to_append) {
-  sample_buffer_.conservativeResize(
-      Eigen::NoChange, sample_buffer_.cols() + buffer_to_append.cols());
-  sample_buffer_.rightCols(buffer_to_append.cols()).swap(buffer_to_append);
+void AudioToTensorCalculator::AppendToSampleBuffer(
+    const Eigen::Ref<const Matrix>& buffer_to_append) {
+  ReserveSampleBuffer(buffer_to_append.cols());
+  sample_buffer_.middleCols(buffer_start_ + buffer_size_,
+                            buffer_to_append.cols()) = buffer_to_append;
+  buffer_size_ += buffer_to_append.cols();
 }
 
 absl::StatusOr<std::vector<Tensor>> AudioToTensorCalculator::ConvertToTensor(
-    const Matrix& block, std::vector<int> tensor_dims) {
+    const Eigen::Ref<const Matrix>& block, std::vector<int> tensor_dims) {
   Tensor tensor(Tensor::ElementType::kFloat32, Tensor::Shape(tensor_dims));
   auto buffer_view = tensor.GetCpuWriteView();
   int total_size = 1;
@@ -474,32 +464,21 @@ absl::StatusOr<std::vector<Tensor>> AudioToTensorCalculator::ConvertToTensor(
   return tensor_vector;
 }
 
-absl::Status AudioToTensorCalculator::OutputTensor(const Matrix& block,
-                                                   Timestamp timestamp,
-                                                   CalculatorContext* cc) {
+absl::Status AudioToTensorCalculator::OutputTensor(
+    const Eigen::Ref<const Matrix>& block, Timestamp timestamp,
+    CalculatorContext* cc) {
   std::vector<Tensor> output_tensor;
-  if (fft_state_) {
-    Eigen::VectorXf time_series_data =
-        Eigen::VectorXf::Map(block.data(), block.size());
-    //  Window on input audio prior to FFT.
-    std::transform(time_series_data.begin(), time_series_data.end(),
-                   fft_window_.begin(), fft_input_buffer_.begin(),
-                   std::multiplies<float>());
-    pffft_transform_ordered(fft_state_, fft_input_buffer_.data(),
-                            fft_output_.data(), fft_workplace_.data(),
-                            PFFFT_FORWARD);
+  if (fft_) {
+    // The DFT is written straight into the tensor.
+    Tensor tensor(Tensor::ElementType::kFloat32,
+                  Tensor::Shape({2, fft_->fft_size() / 2}));
+    const std::pair<float, float> dc_and_nyquist =
+        fft_->Transform(block.data(), block.size(),
+                        tensor.GetCpuWriteView().buffer<float>());
     if (kDcAndNyquistOut(cc).IsConnected()) {
-      kDcAndNyquistOut(cc).Send(std::make_pair(fft_output_[0], fft_output_[1]),
-                                timestamp);
+      kDcAndNyquistOut(cc).Send(dc_and_nyquist, timestamp);
     }
-    Matrix fft_output_matrix =
-        Eigen::Map<const Matrix>(fft_output_.data() + 2, 1, fft_size_ - 2);
-    fft_output_matrix.conservativeResize(Eigen::NoChange, fft_size_);
-    // The last two elements are the DFT Nyquist values.
-    fft_output_matrix(fft_size_ - 2) = fft_output_[1];  // Nyquist real part
-    fft_output_matrix(fft_size_ - 1) = 0.0f;            // Nyquist imagery part
-    ASSIGN_OR_RETURN(output_tensor,
-                     ConvertToTensor(fft_output_matrix, {2, fft_size_ / 2}));
+    output_tensor.push_back(std::move(tensor));
   } else {
     ASSIGN_OR_RETURN(output_tensor,
                      ConvertToTensor(block, {num_channels_, num_samples_}));
@@ -508,9 +487,9 @@ absl::Status AudioToTensorCalculator::OutputTensor(const Matrix& block,
   return absl::OkStatus();
 }
 
-absl::Status AudioToTensorCalculator::ProcessBuffer(const Matrix& buffer,
-                                                    bool should_flush,
-                                                    CalculatorContext* cc) {
+absl::Status AudioToTensorCalculator::ProcessBuffer(
+    const Eigen::Ref<const Matrix>& buffer, bool should_flush,
+    CalculatorContext* cc) {
   const bool should_flush_at_timestamp_max =
       stream_mode_ && should_flush &&
       flush_mode_ == Options::ENTIRE_TAIL_AT_TIMESTAMP_MAX;
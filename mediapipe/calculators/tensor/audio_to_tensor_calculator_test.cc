@@ -464,6 +464,21 @@ TEST_F(AudioToTensorCalculatorStreamingModeTest, OutputOverlappingFp32Tensors) {
   CloseGraph();
 }
 
+TEST_F(AudioToTensorCalculatorStreamingModeTest,
+       OutputMostlyOverlappingTensorsFromSmallInputs) {
+  SetInputBufferNumSamplesPerChannel(3);
+  SetNumIterations(40);
+  Run(/*num_samples=*/16, /*num_overlapping_samples=*/14,
+      /*resampling_factor=*/1.0f);
+  CheckTensorsOutputPackets(
+      /*sample_offset=*/4,
+      // All the full frames, and the remaining samples at close.
+      /*num_packets=*/(GetExpectedNumOfSamples() - 16) / 2 + 2,
+      /*timestamp_interval=*/200,
+      /*output_last_at_close=*/true);
+  CloseGraph();
+}
+
 TEST_F(AudioToTensorCalculatorStreamingModeTest, Downsampling) {
   SetInputBufferNumSamplesPerChannel(1000);
   Run(/*num_samples=*/256, /*num_overlapping_samples=*/0,
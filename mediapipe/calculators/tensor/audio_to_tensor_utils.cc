@@ -0,0 +1,102 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/calculators/tensor/audio_to_tensor_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "audio/dsp/window_functions.h"
+#include "pffft.h"
+
+namespace mediapipe {
+
+std::vector<float> HannWindow(int window_size, bool sqrt_hann) {
+  std::vector<float> hann_window(window_size);
+  audio_dsp::HannWindow().GetPeriodicSamples(window_size, &hann_window);
+  if (sqrt_hann) {
+    absl::c_transform(hann_window, hann_window.begin(),
+                      [](double x) { return std::sqrt(x); });
+  }
+  return hann_window;
+}
+
+bool IsValidFftSize(int size) {
+  if (size <= 0) {
+    return false;
+  }
+  constexpr int kFactors[] = {2, 3, 5};
+  int factorization[] = {0, 0, 0};
+  int n = static_cast<int>(size);
+  for (int i = 0; i < 3; ++i) {
+    while (n % kFactors[i] == 0) {
+      n = n / kFactors[i];
+      ++factorization[i];
+    }
+  }
+  return factorization[0] >= 5 && n == 1;
+}
+
+// static
+absl::StatusOr<std::unique_ptr<AudioFft>> AudioFft::Create(int fft_size) {
+  if (!IsValidFftSize(fft_size)) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "FFT size must be of the form fft_size = (2^a)*(3^b)*(5^c) where b "
+        ">=0 and c >= 0 and a >= 5, the requested fft size is ",
+        fft_size));
+  }
+  PFFFT_Setup* fft_state = pffft_new_setup(fft_size, PFFFT_REAL);
+  if (fft_state == nullptr) {
+    return absl::InternalError("Failed to set up pffft.");
+  }
+  return std::unique_ptr<AudioFft>(new AudioFft(fft_size, fft_state));
+}
+
+AudioFft::AudioFft(int fft_size, PFFFT_Setup* fft_state)
+    : fft_size_(fft_size),
+      fft_state_(fft_state),
+      fft_window_(HannWindow(fft_size, /*sqrt_hann=*/false)),
+      fft_input_buffer_(fft_size),
+      fft_workplace_(fft_size),
+      fft_output_(fft_size) {}
+
+AudioFft::~AudioFft() { pffft_destroy_setup(fft_state_); }
+
+std::pair<float, float> AudioFft::Transform(const float* samples,
+                                            int num_samples, float* output) {
+  const int num_windowed = std::min(num_samples, fft_size_);
+  // Window on input audio prior to FFT.
+  std::transform(samples, samples + num_windowed, fft_window_.begin(),
+                 fft_input_buffer_.begin(), std::multiplies<float>());
+  std::fill(fft_input_buffer_.begin() + num_windowed, fft_input_buffer_.end(),
+            0.0f);
+  pffft_transform_ordered(fft_state_, fft_input_buffer_.data(),
+                          fft_output_.data(), fft_workplace_.data(),
+                          PFFFT_FORWARD);
+  // pffft orders the output as DC, Nyquist, then the complex bins.
+  std::copy(fft_output_.begin() + 2, fft_output_.end(), output);
+  output[fft_size_ - 2] = fft_output_[1];  // Nyquist real part
+  output[fft_size_ - 1] = 0.0f;            // Nyquist imagery part
+  return std::make_pair(fft_output_[0], fft_output_[1]);
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,69 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_AUDIO_TO_TENSOR_UTILS_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_AUDIO_TO_TENSOR_UTILS_H_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Core"
+#include "absl/status/statusor.h"
+
+struct PFFFT_Setup;
+
+namespace mediapipe {
+
+// Returns a periodic Hann window of window_size samples, or its square root.
+std::vector<float> HannWindow(int window_size, bool sqrt_hann);
+
+// Returns true if PFFFT supports real transforms of the size, i.e. if
+// size = (2^a)*(3^b)*(5^c) where b >= 0, c >= 0 and a >= 5.
+bool IsValidFftSize(int size);
+
+// Hann-windowed real FFT, in the output layout of the audio FFT tensors.
+class AudioFft {
+ public:
+  static absl::StatusOr<std::unique_ptr<AudioFft>> Create(int fft_size);
+  ~AudioFft();
+
+  AudioFft(const AudioFft&) = delete;
+  AudioFft& operator=(const AudioFft&) = delete;
+
+  int fft_size() const { return fft_size_; }
+
+  // Windows the first fft_size() of num_samples samples, zero-padded if
+  // there are fewer, and writes their DFT to the fft_size() floats of output:
+  // the interleaved real and imaginary parts of bins 1 to fft_size() / 2 - 1,
+  // followed by the real part of the Nyquist bin and a zero. Returns the DC
+  // and Nyquist components.
+  std::pair<float, float> Transform(const float* samples, int num_samples,
+                                    float* output);
+
+ private:
+  AudioFft(int fft_size, PFFFT_Setup* fft_state);
+
+  const int fft_size_;
+  PFFFT_Setup* const fft_state_;
+  const std::vector<float> fft_window_;
+  // pffft requires aligned memory to work with to avoid using the stack.
+  std::vector<float, Eigen::aligned_allocator<float>> fft_input_buffer_;
+  std::vector<float, Eigen::aligned_allocator<float>> fft_workplace_;
+  std::vector<float, Eigen::aligned_allocator<float>> fft_output_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_AUDIO_TO_TENSOR_UTILS_H_
@@ -0,0 +1,77 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/calculators/tensor/audio_to_tensor_utils.h"
+
+#include <complex>
+#include <vector>
+
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(AudioToTensorUtilsTest, IsValidFftSize) {
+  EXPECT_TRUE(IsValidFftSize(32));
+  EXPECT_TRUE(IsValidFftSize(320));
+  EXPECT_TRUE(IsValidFftSize(2 * 2 * 2 * 2 * 2 * 3 * 5 * 5));
+  EXPECT_FALSE(IsValidFftSize(0));
+  EXPECT_FALSE(IsValidFftSize(16));
+  EXPECT_FALSE(IsValidFftSize(103));
+  EXPECT_FALSE(AudioFft::Create(103).ok());
+}
+
+TEST(AudioToTensorUtilsTest, TransformsImpulse) {
+  constexpr int kFftSize = 320;
+  MP_ASSERT_OK_AND_ASSIGN(auto fft, AudioFft::Create(kFftSize));
+  // The Hann window is 1 at the center.
+  std::vector<float> impulse(kFftSize, 0.0f);
+  impulse[kFftSize / 2] = 1.0f;
+  std::vector<float> output(kFftSize);
+  const auto dc_and_nyquist =
+      fft->Transform(impulse.data(), impulse.size(), output.data());
+  EXPECT_FLOAT_EQ(dc_and_nyquist.first, 1.0f);
+  EXPECT_FLOAT_EQ(dc_and_nyquist.second, 1.0f);
+  for (int i = 0; i < kFftSize / 2; ++i) {
+    EXPECT_FLOAT_EQ(std::norm(std::complex<float>(output[2 * i],
+                                                  output[2 * i + 1])),
+                    1.0f);
+  }
+}
+
+TEST(AudioToTensorUtilsTest, ZeroPadsShortInput) {
+  constexpr int kFftSize = 64;
+  MP_ASSERT_OK_AND_ASSIGN(auto fft, AudioFft::Create(kFftSize));
+  std::vector<float> samples(kFftSize);
+  for (int i = 0; i < kFftSize; ++i) {
+    samples[i] = i < kFftSize / 2 ? 0.5f : 0.0f;
+  }
+  std::vector<float> expected(kFftSize);
+  const auto expected_dc_and_nyquist =
+      fft->Transform(samples.data(), samples.size(), expected.data());
+  // Fills the internal buffer before transforming fewer samples.
+  std::vector<float> ones(kFftSize, 1.0f);
+  std::vector<float> output(kFftSize);
+  fft->Transform(ones.data(), ones.size(), output.data());
+  const auto dc_and_nyquist =
+      fft->Transform(samples.data(), kFftSize / 2, output.data());
+  EXPECT_EQ(dc_and_nyquist, expected_dc_and_nyquist);
+  EXPECT_EQ(output, expected);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,171 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "mediapipe/calculators/tensor/audio_to_tensor_utils.h"
+#include "mediapipe/calculators/tensor/batched_audio_to_tensor_calculator.pb.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/port.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/matrix.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe {
+namespace api2 {
+
+// Converts a batch of audio windows, e.g. the current windows of many audio
+// streams, into a single batched tensor, so that one model invocation covers
+// all of them.
+//
+// The windows must already be at the sample rate of the model, e.g. framed by
+// a TimeSeriesFramerCalculator per stream. Each item of the batch has the
+// layout of the tensors of AudioToTensorCalculator: the audio samples of the
+// window, zero padded to `num_samples`, or their DFT if `fft_size` is set. The
+// FFTs of the whole batch share one pffft setup and its buffers, and write
+// straight into the output tensor.
+//
+// Inputs:
+//   AUDIO - std::vector<Matrix>
+//     The audio windows, with `num_channels` channels, or any number of
+//     channels mixed down to mono if `num_channels` is 1, and at most
+//     `num_samples` samples each.
+//
+// Outputs:
+//   TENSORS - std::vector<Tensor>
+//     Vector containing a single float Tensor of shape [batch size,
+//     num_channels, num_samples], or [batch size, 2, fft_size / 2] with fft.
+//     Nothing is output for an empty batch.
+//   DC_AND_NYQUIST - std::vector<std::pair<float, float>> @Optional
+//     The dc and nyquist components of each window. Only can be connected
+//     when the calculator performs fft.
+//
+// Example:
+// node {
+//   calculator: "BatchedAudioToTensorCalculator"
+//   input_stream: "AUDIO:audio_windows"
+//   output_stream: "TENSORS:tensors"
+//   options {
+//     [mediapipe.BatchedAudioToTensorCalculatorOptions.ext] {
+//       num_channels: 1
+//       num_samples: 15600
+//     }
+//   }
+// }
+class BatchedAudioToTensorCalculator : public Node {
+ public:
+  static constexpr Input<std::vector<Matrix>> kAudioIn{"AUDIO"};
+  static constexpr Output<std::vector<Tensor>> kTensorsOut{"TENSORS"};
+  static constexpr Output<std::vector<std::pair<float, float>>>::Optional
+      kDcAndNyquistOut{"DC_AND_NYQUIST"};
+  MEDIAPIPE_NODE_CONTRACT(kAudioIn, kTensorsOut, kDcAndNyquistOut);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+
+ private:
+  int num_channels_;
+  int num_samples_;
+  // Null unless the calculator outputs fft tensors.
+  std::unique_ptr<AudioFft> fft_;
+};
+
+absl::Status BatchedAudioToTensorCalculator::Open(CalculatorContext* cc) {
+  const auto& options =
+      cc->Options<mediapipe::BatchedAudioToTensorCalculatorOptions>();
+  RET_CHECK(options.has_num_channels() && options.has_num_samples())
+      << "BatchedAudioToTensorCalculatorOptions must specify `num_channels` "
+         "and `num_samples`.";
+  num_channels_ = options.num_channels();
+  num_samples_ = options.num_samples();
+  RET_CHECK_GT(num_channels_, 0);
+  RET_CHECK_GT(num_samples_, 0);
+  if (options.has_fft_size()) {
+    RET_CHECK_EQ(1, num_channels_)
+        << "Currently only support applying FFT on mono channel.";
+    ASSIGN_OR_RETURN(fft_, AudioFft::Create(options.fft_size()));
+  } else {
+    RET_CHECK(!kDcAndNyquistOut(cc).IsConnected())
+        << "The DC_AND_NYQUIST output stream can only be connected when the "
+           "calculator outputs fft tensors";
+  }
+  return absl::OkStatus();
+}
+
+absl::Status BatchedAudioToTensorCalculator::Process(CalculatorContext* cc) {
+  const std::vector<Matrix>& windows = kAudioIn(cc).Get();
+  if (windows.empty()) {
+    return absl::OkStatus();
+  }
+  const int batch_size = windows.size();
+  const int item_size = fft_ ? fft_->fft_size() : num_channels_ * num_samples_;
+  const std::vector<int> dims =
+      fft_ ? std::vector<int>{batch_size, 2, fft_->fft_size() / 2}
+           : std::vector<int>{batch_size, num_channels_, num_samples_};
+  Tensor tensor(Tensor::ElementType::kFloat32, Tensor::Shape(dims));
+  std::vector<std::pair<float, float>> dc_and_nyquist;
+  {
+    auto buffer_view = tensor.GetCpuWriteView();
+    float* buffer = buffer_view.buffer<float>();
+    Matrix mono_window;
+    for (int i = 0; i < batch_size; ++i) {
+      const Matrix* window = &windows[i];
+      if (window->rows() != num_channels_) {
+        if (num_channels_ != 1) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Audio window %d has %d channel(s) but the model requires %d "
+              "channel(s).",
+              i, window->rows(), num_channels_));
+        }
+        // Mono mixdown.
+        mono_window = window->colwise().mean();
+        window = &mono_window;
+      }
+      if (window->cols() > num_samples_) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Audio window %d has %d samples but the model requires at most %d "
+            "samples.",
+            i, window->cols(), num_samples_));
+      }
+      float* item = buffer + i * item_size;
+      if (fft_) {
+        dc_and_nyquist.push_back(
+            fft_->Transform(window->data(), window->size(), item));
+      } else {
+        std::memcpy(item, window->data(), window->size() * sizeof(float));
+        std::memset(item + window->size(), 0,
+                    (item_size - window->size()) * sizeof(float));
+      }
+    }
+  }
+  std::vector<Tensor> tensors;
+  tensors.push_back(std::move(tensor));
+  kTensorsOut(cc).Send(std::move(tensors));
+  if (kDcAndNyquistOut(cc).IsConnected()) {
+    kDcAndNyquistOut(cc).Send(std::move(dc_and_nyquist));
+  }
+  return absl::OkStatus();
+}
+
+MEDIAPIPE_REGISTER_NODE(BatchedAudioToTensorCalculator);
+
+}  // namespace api2
+}  // namespace mediapipe
@@ -0,0 +1,167 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <utility>
+#include <vector>
+
+#include "mediapipe/calculators/tensor/audio_to_tensor_utils.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/matrix.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+std::vector<float> TensorValues(const Tensor& tensor) {
+  auto view = tensor.GetCpuReadView();
+  const float* buffer = view.buffer<float>();
+  return std::vector<float>(buffer, buffer + tensor.shape().num_elements());
+}
+
+std::vector<float> MatrixValues(const Matrix& matrix) {
+  return std::vector<float>(matrix.data(), matrix.data() + matrix.size());
+}
+
+TEST(BatchedAudioToTensorCalculatorTest, BatchesWindows) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "BatchedAudioToTensorCalculator"
+    input_stream: "AUDIO:audio"
+    output_stream: "TENSORS:tensors"
+    options {
+      [mediapipe.BatchedAudioToTensorCalculatorOptions.ext] {
+        num_channels: 2
+        num_samples: 4
+      }
+    }
+  )pb"));
+  Matrix first(2, 4);
+  first << 1, 2, 3, 4, 5, 6, 7, 8;
+  Matrix second(2, 3);
+  second << -1, -2, -3, -4, -5, -6;
+  runner.MutableInputs()->Tag("AUDIO").packets.push_back(
+      MakePacket<std::vector<Matrix>>(std::vector<Matrix>{first, second})
+          .At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& packets = runner.Outputs().Tag("TENSORS").packets;
+  ASSERT_EQ(packets.size(), 1);
+  const auto& tensors = packets[0].Get<std::vector<Tensor>>();
+  ASSERT_EQ(tensors.size(), 1);
+  EXPECT_THAT(tensors[0].shape().dims, ElementsAreArray({2, 2, 4}));
+  std::vector<float> expected = MatrixValues(first);
+  const std::vector<float> second_values = MatrixValues(second);
+  expected.insert(expected.end(), second_values.begin(), second_values.end());
+  // The second window is zero padded.
+  expected.insert(expected.end(), {0.0f, 0.0f});
+  EXPECT_EQ(TensorValues(tensors[0]), expected);
+}
+
+TEST(BatchedAudioToTensorCalculatorTest, MixesDownToMono) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "BatchedAudioToTensorCalculator"
+    input_stream: "AUDIO:audio"
+    output_stream: "TENSORS:tensors"
+    options {
+      [mediapipe.BatchedAudioToTensorCalculatorOptions.ext] {
+        num_channels: 1
+        num_samples: 3
+      }
+    }
+  )pb"));
+  Matrix stereo(2, 3);
+  stereo << 1, 2, 3, 3, 4, 5;
+  runner.MutableInputs()->Tag("AUDIO").packets.push_back(
+      MakePacket<std::vector<Matrix>>(std::vector<Matrix>{stereo})
+          .At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& tensors =
+      runner.Outputs().Tag("TENSORS").packets[0].Get<std::vector<Tensor>>();
+  EXPECT_THAT(tensors[0].shape().dims, ElementsAreArray({1, 1, 3}));
+  EXPECT_THAT(TensorValues(tensors[0]), ElementsAreArray({2.0f, 3.0f, 4.0f}));
+}
+
+TEST(BatchedAudioToTensorCalculatorTest, MatchesSingleWindowFft) {
+  constexpr int kFftSize = 64;
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "BatchedAudioToTensorCalculator"
+    input_stream: "AUDIO:audio"
+    output_stream: "TENSORS:tensors"
+    output_stream: "DC_AND_NYQUIST:dc_and_nyquist"
+    options {
+      [mediapipe.BatchedAudioToTensorCalculatorOptions.ext] {
+        num_channels: 1
+        num_samples: 64
+        fft_size: 64
+      }
+    }
+  )pb"));
+  std::vector<Matrix> windows;
+  for (int i = 0; i < 3; ++i) {
+    windows.push_back(Matrix::Random(1, kFftSize));
+  }
+  runner.MutableInputs()->Tag("AUDIO").packets.push_back(
+      MakePacket<std::vector<Matrix>>(windows).At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& tensors =
+      runner.Outputs().Tag("TENSORS").packets[0].Get<std::vector<Tensor>>();
+  EXPECT_THAT(tensors[0].shape().dims,
+              ElementsAreArray({3, 2, kFftSize / 2}));
+  const std::vector<float> values = TensorValues(tensors[0]);
+  const auto& dc_and_nyquist = runner.Outputs()
+                                   .Tag("DC_AND_NYQUIST")
+                                   .packets[0]
+                                   .Get<std::vector<std::pair<float, float>>>();
+  ASSERT_EQ(dc_and_nyquist.size(), 3);
+
+  MP_ASSERT_OK_AND_ASSIGN(auto fft, AudioFft::Create(kFftSize));
+  for (int i = 0; i < 3; ++i) {
+    std::vector<float> expected(kFftSize);
+    EXPECT_EQ(dc_and_nyquist[i],
+              fft->Transform(windows[i].data(), kFftSize, expected.data()));
+    EXPECT_EQ(std::vector<float>(values.begin() + i * kFftSize,
+                                 values.begin() + (i + 1) * kFftSize),
+              expected);
+  }
+}
+
+TEST(BatchedAudioToTensorCalculatorTest, RejectsLongWindows) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "BatchedAudioToTensorCalculator"
+    input_stream: "AUDIO:audio"
+    output_stream: "TENSORS:tensors"
+    options {
+      [mediapipe.BatchedAudioToTensorCalculatorOptions.ext] {
+        num_channels: 1
+        num_samples: 2
+      }
+    }
+  )pb"));
+  runner.MutableInputs()->Tag("AUDIO").packets.push_back(
+      MakePacket<std::vector<Matrix>>(std::vector<Matrix>{Matrix::Ones(1, 3)})
+          .At(Timestamp(0)));
+  EXPECT_FALSE(runner.Run().ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
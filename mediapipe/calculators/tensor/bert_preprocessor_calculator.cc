@@ -14,7 +14,6 @@
 
 #include <algorithm>
 #include <cstdint>
-#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
@@ -26,6 +25,7 @@
 #include "absl/strings/ascii.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
+#include "absl/types/span.h"
 #include "mediapipe/calculators/tensor/bert_preprocessor_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/port.h"
@@ -36,6 +36,7 @@
 #include "mediapipe/tasks/cc/metadata/metadata_extractor.h"
 #include "mediapipe/tasks/cc/text/tokenizers/tokenizer.h"
 #include "mediapipe/tasks/cc/text/tokenizers/tokenizer_utils.h"
+#include "mediapipe/tasks/cc/text/utils/token_ids_cache.h"
 #include "mediapipe/tasks/metadata/metadata_schema_generated.h"
 
 namespace mediapipe {
@@ -43,6 +44,7 @@ namespace api2 {
 
 using ::mediapipe::tasks::core::FindTensorIndexByMetadataName;
 using ::mediapipe::tasks::metadata::ModelMetadataExtractor;
+using ::mediapipe::tasks::text::TokenIdsCache;
 
 constexpr int kNumInputTensorsForBert = 3;
 constexpr int kTokenizerProcessUnitIndex = 0;
@@ -72,8 +74,11 @@ constexpr absl::string_view kSeparatorToken = "[SEP]";
 // TODO: Handle preprocessing for other Text Tasks too.
 //
 // Inputs:
-//   TEXT - std::string
+//   TEXT - std::string @Optional
 //     The input text.
+//   TEXTS - std::vector<std::string> @Optional
+//     A batch of input texts, preprocessed into one batch of tensors. Exactly
+//     one of TEXT and TEXTS must be connected.
 // Side Inputs:
 //   METADATA_EXTRACTOR - ModelMetadataExtractor
 //     The metadata extractor for the BERT model. Used to determine the order of
@@ -92,7 +97,7 @@ constexpr absl::string_view kSeparatorToken = "[SEP]";
 //       (3): the input mask ids, which are 1 at each of the input token indices
 //            and 0 elsewhere.
 //     The Tensors will have size equal to the max sequence length for the BERT
-//     model.
+//     model, and an additional leading batch dimension for TEXTS.
 //
 // Example:
 // node {
@@ -103,17 +108,20 @@ constexpr absl::string_view kSeparatorToken = "[SEP]";
 //   options {
 //     [mediapipe.BertPreprocessorCalculatorOptions.ext] {
 //       bert_max_seq_len: 128
+//       cache_size: 1000
 //     }
 //   }
 // }
 class BertPreprocessorCalculator : public Node {
  public:
-  static constexpr Input<std::string> kTextIn{"TEXT"};
+  static constexpr Input<std::string>::Optional kTextIn{"TEXT"};
+  static constexpr Input<std::vector<std::string>>::Optional kTextsIn{"TEXTS"};
   static constexpr SideInput<ModelMetadataExtractor> kMetadataExtractorSideIn{
       "METADATA_EXTRACTOR"};
   static constexpr Output<std::vector<Tensor>> kTensorsOut{"TENSORS"};
 
-  MEDIAPIPE_NODE_CONTRACT(kTextIn, kMetadataExtractorSideIn, kTensorsOut);
+  MEDIAPIPE_NODE_CONTRACT(kTextIn, kTextsIn, kMetadataExtractorSideIn,
+                          kTensorsOut);
 
   static absl::Status UpdateContract(CalculatorContract* cc);
   absl::Status Open(CalculatorContext* cc) override;
@@ -128,15 +136,22 @@ class BertPreprocessorCalculator : public Node {
   int input_ids_tensor_index_ = 0;
   int segment_ids_tensor_index_ = 1;
   int input_masks_tensor_index_ = 2;
+  // The token ids of recent input texts, if enabled.
+  std::unique_ptr<TokenIdsCache> cache_;
+  // The token ids of the last input text when there is no cache.
+  std::vector<int32_t> token_ids_;
 
-  // Applies `tokenizer_` to the `input_text` to generate a vector of tokens.
-  // This util prepends "[CLS]" and appends "[SEP]" to the input tokens and
-  // clips the vector of tokens to have length at most `bert_max_seq_len_`.
-  std::vector<std::string> TokenizeInputText(absl::string_view input_text);
-  // Processes the `input_tokens` to generate the three input tensors for the
-  // BERT model.
+  // Applies `tokenizer_` to the `input_text` to generate a vector of token
+  // ids. This util prepends "[CLS]" and appends "[SEP]" to the input tokens
+  // and clips the vector of tokens to have length at most `bert_max_seq_len_`.
+  std::vector<int32_t> TokenizeInputText(absl::string_view input_text);
+  // Returns the token ids of `input_text`, from `cache_` if possible. The ids
+  // are valid until the next call.
+  const std::vector<int32_t>& GetTokenIds(const std::string& input_text);
+  // Processes the `input_texts` to generate the three input tensors for the
+  // BERT model, with shape `shape`.
   std::vector<Tensor> GenerateInputTensors(
-      const std::vector<std::string>& input_tokens);
+      absl::Span<const std::string> input_texts, const Tensor::Shape& shape);
 };
 
 absl::Status BertPreprocessorCalculator::UpdateContract(
@@ -146,6 +161,9 @@ absl::Status BertPreprocessorCalculator::UpdateContract(
   RET_CHECK(options.has_bert_max_seq_len()) << "bert_max_seq_len is required";
   RET_CHECK_GE(options.bert_max_seq_len(), 2)
       << "bert_max_seq_len must be at least 2";
+  RET_CHECK_GE(options.cache_size(), 0) << "cache_size must be non-negative";
+  RET_CHECK(kTextIn(cc).IsConnected() ^ kTextsIn(cc).IsConnected())
+      << "Exactly one of TEXT and TEXTS must be connected";
   return absl::OkStatus();
 }
 
@@ -178,16 +196,27 @@ absl::Status BertPreprocessorCalculator::Open(CalculatorContext* cc) {
   const auto& options =
       cc->Options<mediapipe::BertPreprocessorCalculatorOptions>();
   bert_max_seq_len_ = options.bert_max_seq_len();
+  if (options.cache_size() > 0) {
+    cache_ = std::make_unique<TokenIdsCache>(options.cache_size());
+  }
   return absl::OkStatus();
 }
 
 absl::Status BertPreprocessorCalculator::Process(CalculatorContext* cc) {
-  kTensorsOut(cc).Send(
-      GenerateInputTensors(TokenizeInputText(kTextIn(cc).Get())));
+  if (kTextIn(cc).IsConnected()) {
+    kTensorsOut(cc).Send(GenerateInputTensors(
+        absl::MakeConstSpan(&kTextIn(cc).Get(), 1),
+        Tensor::Shape({bert_max_seq_len_})));
+  } else {
+    const std::vector<std::string>& texts = kTextsIn(cc).Get();
+    kTensorsOut(cc).Send(GenerateInputTensors(
+        texts, Tensor::Shape({static_cast<int>(texts.size()),
+                              bert_max_seq_len_})));
+  }
   return absl::OkStatus();
 }
 
-std::vector<std::string> BertPreprocessorCalculator::TokenizeInputText(
+std::vector<int32_t> BertPreprocessorCalculator::TokenizeInputText(
     absl::string_view input_text) {
   std::string processed_input = std::string(input_text);
   absl::AsciiStrToLower(&processed_input);
@@ -199,49 +228,59 @@ std::vector<std::string> BertPreprocessorCalculator::TokenizeInputText(
   int input_tokens_size =
       std::min(bert_max_seq_len_,
                static_cast<int>(tokenizer_result.subwords.size()) + 2);
-  std::vector<std::string> input_tokens;
-  input_tokens.reserve(input_tokens_size);
-  input_tokens.push_back(std::string(kClassifierToken));
+  // Tokens missing from the vocab keep id 0.
+  std::vector<int32_t> input_ids(input_tokens_size, 0);
+  tokenizer_->LookupId(kClassifierToken, &input_ids[0]);
   for (int i = 0; i < input_tokens_size - 2; ++i) {
-    input_tokens.push_back(std::move(tokenizer_result.subwords[i]));
+    tokenizer_->LookupId(tokenizer_result.subwords[i], &input_ids[i + 1]);
   }
-  input_tokens.push_back(std::string(kSeparatorToken));
-  return input_tokens;
+  tokenizer_->LookupId(kSeparatorToken, &input_ids[input_tokens_size - 1]);
+  return input_ids;
+}
+
+const std::vector<int32_t>& BertPreprocessorCalculator::GetTokenIds(
+    const std::string& input_text) {
+  if (cache_ == nullptr) {
+    token_ids_ = TokenizeInputText(input_text);
+    return token_ids_;
+  }
+  if (const std::vector<int32_t>* input_ids = cache_->Lookup(input_text)) {
+    return *input_ids;
+  }
+  return cache_->Insert(input_text, TokenizeInputText(input_text));
 }
 
 std::vector<Tensor> BertPreprocessorCalculator::GenerateInputTensors(
-    const std::vector<std::string>& input_tokens) {
-  std::vector<int32_t> input_ids(bert_max_seq_len_, 0);
-  std::vector<int32_t> segment_ids(bert_max_seq_len_, 0);
-  std::vector<int32_t> input_masks(bert_max_seq_len_, 0);
-  // Convert tokens back into ids and set mask
-  for (int i = 0; i < input_tokens.size(); ++i) {
-    tokenizer_->LookupId(input_tokens[i], &input_ids[i]);
-    input_masks[i] = 1;
+    absl::Span<const std::string> input_texts, const Tensor::Shape& shape) {
+  std::vector<Tensor> input_tensors;
+  input_tensors.reserve(kNumInputTensorsForBert);
+  for (int i = 0; i < kNumInputTensorsForBert; ++i) {
+    input_tensors.push_back({Tensor::ElementType::kInt32, shape});
   }
+  auto input_ids_view =
+      input_tensors[input_ids_tensor_index_].GetCpuWriteView();
+  auto segment_ids_view =
+      input_tensors[segment_ids_tensor_index_].GetCpuWriteView();
+  auto input_masks_view =
+      input_tensors[input_masks_tensor_index_].GetCpuWriteView();
+  int32_t* input_ids = input_ids_view.buffer<int32_t>();
+  int32_t* segment_ids = segment_ids_view.buffer<int32_t>();
+  int32_t* input_masks = input_masks_view.buffer<int32_t>();
+  const int size = shape.num_elements();
+  std::fill(input_ids, input_ids + size, 0);
+  std::fill(segment_ids, segment_ids + size, 0);
+  std::fill(input_masks, input_masks + size, 0);
   //                           |<--------bert_max_seq_len_--------->|
   // input_ids                 [CLS] s1  s2...  sn [SEP]  0  0...  0
   // segment_ids                 0    0   0...  0    0    0  0...  0
   // input_masks                 1    1   1...  1    1    0  0...  0
-
-  std::vector<Tensor> input_tensors;
-  input_tensors.reserve(kNumInputTensorsForBert);
-  for (int i = 0; i < kNumInputTensorsForBert; ++i) {
-    input_tensors.push_back(
-        {Tensor::ElementType::kInt32, Tensor::Shape({bert_max_seq_len_})});
+  for (const std::string& input_text : input_texts) {
+    const std::vector<int32_t>& text_ids = GetTokenIds(input_text);
+    std::copy(text_ids.begin(), text_ids.end(), input_ids);
+    std::fill(input_masks, input_masks + text_ids.size(), 1);
+    input_ids += bert_max_seq_len_;
+    input_masks += bert_max_seq_len_;
   }
-  std::memcpy(input_tensors[input_ids_tensor_index_]
-                  .GetCpuWriteView()
-                  .buffer<int32_t>(),
-              input_ids.data(), input_ids.size() * sizeof(int32_t));
-  std::memcpy(input_tensors[segment_ids_tensor_index_]
-                  .GetCpuWriteView()
-                  .buffer<int32_t>(),
-              segment_ids.data(), segment_ids.size() * sizeof(int32_t));
-  std::memcpy(input_tensors[input_masks_tensor_index_]
-                  .GetCpuWriteView()
-                  .buffer<int32_t>(),
-              input_masks.data(), input_masks.size() * sizeof(int32_t));
   return input_tensors;
 }
 
@@ -0,0 +1,140 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/caching_inference_runner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+namespace {
+
+std::vector<Tensor> CopyTensors(const std::vector<Tensor>& tensors) {
+  std::vector<Tensor> copies;
+  copies.reserve(tensors.size());
+  for (const Tensor& tensor : tensors) {
+    copies.emplace_back(tensor.element_type(), tensor.shape(),
+                        tensor.quantization_parameters());
+    auto read_view = tensor.GetCpuReadView();
+    auto write_view = copies.back().GetCpuWriteView();
+    std::memcpy(write_view.buffer<void>(), read_view.buffer<void>(),
+                tensor.bytes());
+  }
+  return copies;
+}
+
+template <typename T>
+void SampleValues(const T* data, int num_elements, int stride,
+                  std::vector<float>& values) {
+  values.reserve((num_elements + stride - 1) / stride);
+  for (int i = 0; i < num_elements; i += stride) {
+    values.push_back(static_cast<float>(data[i]));
+  }
+}
+
+}  // namespace
+
+CachingInferenceRunner::CachingInferenceRunner(InferenceRunner* runner,
+                                               const Options& options)
+    : runner_(runner), options_(options) {}
+
+absl::StatusOr<std::vector<Tensor>> CachingInferenceRunner::Run(
+    const std::vector<Tensor>& inputs) {
+  std::vector<InputSample> samples;
+  const bool cacheable = SampleInputs(inputs, samples);
+  {
+    absl::MutexLock lock(&mutex_);
+    if (cacheable && has_cached_outputs_ &&
+        num_reuses_ < options_.max_reuses && MatchesCachedInputs(samples)) {
+      ++num_reuses_;
+      return CopyTensors(cached_outputs_);
+    }
+  }
+
+  ASSIGN_OR_RETURN(std::vector<Tensor> outputs, runner_->Run(inputs));
+  absl::MutexLock lock(&mutex_);
+  has_cached_outputs_ = cacheable;
+  num_reuses_ = 0;
+  if (cacheable) {
+    // Later inputs are compared to these, not to the previous input, so that
+    // a slow drift still triggers inference.
+    cached_inputs_ = std::move(samples);
+    cached_outputs_ = CopyTensors(outputs);
+  } else {
+    cached_inputs_.clear();
+    cached_outputs_.clear();
+  }
+  return outputs;
+}
+
+bool CachingInferenceRunner::SampleInputs(
+    const std::vector<Tensor>& inputs,
+    std::vector<InputSample>& samples) const {
+  const int stride = std::max(options_.sample_stride, 1);
+  samples.resize(inputs.size());
+  for (int i = 0; i < inputs.size(); ++i) {
+    const Tensor& input = inputs[i];
+    InputSample& sample = samples[i];
+    sample.element_type = input.element_type();
+    sample.dims = input.shape().dims;
+    const int num_elements = input.shape().num_elements();
+    auto view = input.GetCpuReadView();
+    switch (input.element_type()) {
+      case Tensor::ElementType::kFloat32:
+        SampleValues(view.buffer<float>(), num_elements, stride,
+                     sample.values);
+        break;
+      case Tensor::ElementType::kUInt8:
+        SampleValues(view.buffer<uint8_t>(), num_elements, stride,
+                     sample.values);
+        break;
+      case Tensor::ElementType::kInt8:
+        SampleValues(view.buffer<int8_t>(), num_elements, stride,
+                     sample.values);
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+bool CachingInferenceRunner::MatchesCachedInputs(
+    const std::vector<InputSample>& samples) const {
+  if (samples.size() != cached_inputs_.size()) return false;
+  double sum_abs_diff = 0.0;
+  int num_values = 0;
+  for (int i = 0; i < samples.size(); ++i) {
+    const InputSample& sample = samples[i];
+    const InputSample& cached = cached_inputs_[i];
+    if (sample.element_type != cached.element_type ||
+        sample.dims != cached.dims) {
+      return false;
+    }
+    for (int j = 0; j < sample.values.size(); ++j) {
+      sum_abs_diff += std::abs(sample.values[j] - cached.values[j]);
+    }
+    num_values += sample.values.size();
+  }
+  return num_values == 0 ||
+         sum_abs_diff <= options_.max_mean_abs_diff * num_values;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,85 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_CACHING_INFERENCE_RUNNER_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_CACHING_INFERENCE_RUNNER_H_
+
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/framework/formats/tensor.h"
+
+namespace mediapipe {
+
+// An InferenceRunner that skips inference while its inputs stay close to those
+// of the last actual run, and returns copies of that run's outputs instead.
+// This saves most of the compute on near-identical inputs such as the frames
+// of a static camera.
+//
+// The inputs are compared on every `sample_stride`-th element, so only a
+// fraction of each tensor is read. Float, uint8 and int8 inputs are supported;
+// any other element type always runs inference. The inputs must be readable on
+// CPU.
+class CachingInferenceRunner : public InferenceRunner {
+ public:
+  struct Options {
+    // The largest mean absolute difference, in the units of the tensor values,
+    // between the sampled inputs and those of the last run at which the
+    // cached outputs are reused.
+    float max_mean_abs_diff = 0.0f;
+    // Distance between the compared elements of each input.
+    int sample_stride = 16;
+    // Maximum number of consecutive Run() calls served from the cache, which
+    // bounds the age of the outputs and the drift they can accumulate.
+    int max_reuses = 30;
+  };
+
+  // `runner` must outlive the CachingInferenceRunner.
+  CachingInferenceRunner(InferenceRunner* runner, const Options& options);
+
+  absl::StatusOr<std::vector<Tensor>> Run(
+      const std::vector<Tensor>& inputs) override;
+
+ private:
+  // The sampled values of an input, with what identifies its layout.
+  struct InputSample {
+    Tensor::ElementType element_type;
+    std::vector<int> dims;
+    std::vector<float> values;
+  };
+
+  // Samples `inputs` into `samples`. Returns false if an input has an element
+  // type that is not supported.
+  bool SampleInputs(const std::vector<Tensor>& inputs,
+                    std::vector<InputSample>& samples) const;
+
+  // Whether `samples` are close enough to the inputs of the last run.
+  bool MatchesCachedInputs(const std::vector<InputSample>& samples) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  InferenceRunner* const runner_;
+  const Options options_;
+
+  absl::Mutex mutex_;
+  std::vector<InputSample> cached_inputs_ ABSL_GUARDED_BY(mutex_);
+  std::vector<Tensor> cached_outputs_ ABSL_GUARDED_BY(mutex_);
+  bool has_cached_outputs_ ABSL_GUARDED_BY(mutex_) = false;
+  int num_reuses_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_CACHING_INFERENCE_RUNNER_H_
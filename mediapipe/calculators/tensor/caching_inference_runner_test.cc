@@ -0,0 +1,134 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/caching_inference_runner.h"
+
+#include <vector>
+
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+// Returns the sum of its input and counts the runs.
+class CountingRunner : public InferenceRunner {
+ public:
+  absl::StatusOr<std::vector<Tensor>> Run(
+      const std::vector<Tensor>& inputs) override {
+    ++num_runs_;
+    auto view = inputs[0].GetCpuReadView();
+    float sum = 0.0f;
+    for (int i = 0; i < inputs[0].shape().num_elements(); ++i) {
+      sum += view.buffer<float>()[i];
+    }
+    std::vector<Tensor> outputs;
+    outputs.emplace_back(Tensor::ElementType::kFloat32, Tensor::Shape{1});
+    outputs[0].GetCpuWriteView().buffer<float>()[0] = sum;
+    return outputs;
+  }
+
+  int num_runs() const { return num_runs_; }
+
+ private:
+  int num_runs_ = 0;
+};
+
+std::vector<Tensor> MakeInput(float value, int size = 4) {
+  std::vector<Tensor> inputs;
+  inputs.emplace_back(Tensor::ElementType::kFloat32, Tensor::Shape{size});
+  auto view = inputs[0].GetCpuWriteView();
+  for (int i = 0; i < size; ++i) {
+    view.buffer<float>()[i] = value;
+  }
+  return inputs;
+}
+
+float OutputValue(const std::vector<Tensor>& outputs) {
+  return outputs[0].GetCpuReadView().buffer<float>()[0];
+}
+
+TEST(CachingInferenceRunnerTest, ReusesOutputsForUnchangedInputs) {
+  CountingRunner runner;
+  CachingInferenceRunner caching_runner(&runner, {.sample_stride = 1});
+
+  for (int i = 0; i < 3; ++i) {
+    const std::vector<Tensor> inputs = MakeInput(1.0f);
+    MP_ASSERT_OK_AND_ASSIGN(std::vector<Tensor> outputs,
+                            caching_runner.Run(inputs));
+    EXPECT_EQ(OutputValue(outputs), 4.0f);
+  }
+  EXPECT_EQ(runner.num_runs(), 1);
+}
+
+TEST(CachingInferenceRunnerTest, RunsWhenInputsChangeMoreThanThreshold) {
+  CountingRunner runner;
+  CachingInferenceRunner caching_runner(
+      &runner, {.max_mean_abs_diff = 0.5f, .sample_stride = 1});
+
+  MP_ASSERT_OK_AND_ASSIGN(std::vector<Tensor> outputs,
+                          caching_runner.Run(MakeInput(1.0f)));
+  EXPECT_EQ(OutputValue(outputs), 4.0f);
+  // Within the threshold: the cached outputs are returned.
+  MP_ASSERT_OK_AND_ASSIGN(outputs, caching_runner.Run(MakeInput(1.25f)));
+  EXPECT_EQ(OutputValue(outputs), 4.0f);
+  EXPECT_EQ(runner.num_runs(), 1);
+  // Compared to the last run rather than to the previous input, so a slow
+  // drift still triggers inference.
+  MP_ASSERT_OK_AND_ASSIGN(outputs, caching_runner.Run(MakeInput(1.75f)));
+  EXPECT_EQ(OutputValue(outputs), 7.0f);
+  EXPECT_EQ(runner.num_runs(), 2);
+}
+
+TEST(CachingInferenceRunnerTest, RunsWhenShapeChanges) {
+  CountingRunner runner;
+  CachingInferenceRunner caching_runner(&runner, {.sample_stride = 1});
+
+  MP_ASSERT_OK(caching_runner.Run(MakeInput(1.0f, /*size=*/4)));
+  MP_ASSERT_OK_AND_ASSIGN(std::vector<Tensor> outputs,
+                          caching_runner.Run(MakeInput(1.0f, /*size=*/2)));
+  EXPECT_EQ(OutputValue(outputs), 2.0f);
+  EXPECT_EQ(runner.num_runs(), 2);
+}
+
+TEST(CachingInferenceRunnerTest, LimitsConsecutiveReuses) {
+  CountingRunner runner;
+  CachingInferenceRunner caching_runner(&runner,
+                                        {.sample_stride = 1, .max_reuses = 2});
+
+  for (int i = 0; i < 7; ++i) {
+    MP_ASSERT_OK(caching_runner.Run(MakeInput(1.0f)));
+  }
+  // Runs on the 1st, 4th and 7th inputs.
+  EXPECT_EQ(runner.num_runs(), 3);
+}
+
+TEST(CachingInferenceRunnerTest, ComparesSampledElementsOnly) {
+  CountingRunner runner;
+  CachingInferenceRunner caching_runner(&runner, {.sample_stride = 2});
+
+  MP_ASSERT_OK(caching_runner.Run(MakeInput(1.0f)));
+  // Only elements 0 and 2 are compared.
+  std::vector<Tensor> inputs = MakeInput(1.0f);
+  inputs[0].GetCpuWriteView().buffer<float>()[1] = 5.0f;
+  MP_ASSERT_OK_AND_ASSIGN(std::vector<Tensor> outputs,
+                          caching_runner.Run(inputs));
+  EXPECT_EQ(OutputValue(outputs), 4.0f);
+  EXPECT_EQ(runner.num_runs(), 1);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,174 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/gpu_delegate_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "mediapipe/calculators/tensor/inference_delegate_selection.h"
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+#if !defined(_WIN32)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#endif  // !_WIN32
+
+namespace mediapipe {
+namespace {
+
+constexpr char kLockFileName[] = ".lock";
+constexpr char kEntrySuffix[] = ".bin";
+
+// Holds a shared or exclusive lock on a namespace while in scope.
+class ScopedNamespaceLock {
+ public:
+  ScopedNamespaceLock(const std::string& dir, bool exclusive) {
+#if !defined(_WIN32)
+    fd_ = open(file::JoinPath(dir, kLockFileName).c_str(), O_RDWR | O_CREAT,
+               0644);
+    if (fd_ >= 0 && flock(fd_, exclusive ? LOCK_EX : LOCK_SH) != 0) {
+      close(fd_);
+      fd_ = -1;
+    }
+#endif  // !_WIN32
+  }
+  ~ScopedNamespaceLock() {
+#if !defined(_WIN32)
+    if (fd_ >= 0) {
+      flock(fd_, LOCK_UN);
+      close(fd_);
+    }
+#endif  // !_WIN32
+  }
+  ScopedNamespaceLock(const ScopedNamespaceLock&) = delete;
+  ScopedNamespaceLock& operator=(const ScopedNamespaceLock&) = delete;
+
+ private:
+  int fd_ = -1;
+};
+
+}  // namespace
+
+GpuDelegateCache::GpuDelegateCache(absl::string_view dir,
+                                   absl::string_view cache_namespace,
+                                   int64_t max_size_bytes)
+    : dir_(file::JoinPath(dir, cache_namespace)),
+      max_size_bytes_(max_size_bytes) {}
+
+std::string GpuDelegateCache::MakeKey(absl::string_view kind,
+                                      absl::string_view model_data,
+                                      absl::string_view driver_version) {
+  return absl::StrCat(kind, ":", absl::Hex(StableHash64(model_data)), ":",
+                      model_data.size(), ":", driver_version);
+}
+
+std::string GpuDelegateCache::EntryPath(absl::string_view key) const {
+  return file::JoinPath(
+      dir_, absl::StrCat(absl::Hex(StableHash64(key), absl::kZeroPad16),
+                         kEntrySuffix));
+}
+
+absl::StatusOr<std::string> GpuDelegateCache::Read(
+    absl::string_view key) const {
+  const std::string path = EntryPath(key);
+  if (!file::Exists(dir_).ok()) {
+    return absl::NotFoundError(absl::StrCat("No cache entry at ", path));
+  }
+  ScopedNamespaceLock lock(dir_, /*exclusive=*/false);
+  if (!file::Exists(path).ok()) {
+    return absl::NotFoundError(absl::StrCat("No cache entry at ", path));
+  }
+  std::string contents;
+  MP_RETURN_IF_ERROR(file::GetContents(path, &contents));
+#if !defined(_WIN32)
+  // Marks the entry as recently used for eviction.
+  utime(path.c_str(), nullptr);
+#endif  // !_WIN32
+  return contents;
+}
+
+absl::Status GpuDelegateCache::Write(absl::string_view key,
+                                     absl::string_view contents) {
+  MP_RETURN_IF_ERROR(file::RecursivelyCreateDir(dir_));
+  const std::string path = EntryPath(key);
+#if !defined(_WIN32)
+  // Written aside first so that readers only ever see complete entries.
+  const std::string temp_path = absl::StrCat(path, ".tmp", getpid());
+  MP_RETURN_IF_ERROR(file::SetContents(temp_path, contents));
+  ScopedNamespaceLock lock(dir_, /*exclusive=*/true);
+  if (rename(temp_path.c_str(), path.c_str()) != 0) {
+    unlink(temp_path.c_str());
+    return absl::UnavailableError(
+        absl::StrCat("Failed to write cache entry ", path));
+  }
+  Evict(path);
+  return absl::OkStatus();
+#else
+  return file::SetContents(path, contents);
+#endif  // !_WIN32
+}
+
+void GpuDelegateCache::Evict(const std::string& keep_path) const {
+#if !defined(_WIN32)
+  if (max_size_bytes_ <= 0) return;
+  struct Entry {
+    std::string path;
+    int64_t size;
+    time_t mtime;
+  };
+  std::vector<Entry> entries;
+  int64_t total_size = 0;
+  DIR* dir = opendir(dir_.c_str());
+  if (dir == nullptr) return;
+  while (struct dirent* ent = readdir(dir)) {
+    if (!absl::EndsWith(ent->d_name, kEntrySuffix)) continue;
+    std::string path = file::JoinPath(dir_, ent->d_name);
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) continue;
+    total_size += st.st_size;
+    entries.push_back({std::move(path), st.st_size, st.st_mtime});
+  }
+  closedir(dir);
+
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) { return a.mtime < b.mtime; });
+  for (const Entry& entry : entries) {
+    if (total_size <= max_size_bytes_) break;
+    if (entry.path == keep_path) continue;
+    if (unlink(entry.path.c_str()) == 0) {
+      total_size -= entry.size;
+    } else {
+      LOG(WARNING) << "Failed to evict GPU delegate cache entry " << entry.path;
+    }
+  }
+#endif  // !_WIN32
+}
+
+}  // namespace mediapipe
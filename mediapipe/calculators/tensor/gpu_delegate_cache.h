@@ -0,0 +1,65 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_GPU_DELEGATE_CACHE_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_GPU_DELEGATE_CACHE_H_
+
+#include <cstdint>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace mediapipe {
+
+// An on-disk cache of GPU delegate artifacts, such as compiled kernels and
+// serialized models, that many processes can share.
+//
+// Entries live in `<dir>/<namespace>/` and are named after a hash of their
+// key, so keys can be arbitrary strings. Writers replace entries atomically
+// and hold an exclusive lock on the namespace, readers a shared one, so a
+// reader never sees a partially written entry. Once the entries of a
+// namespace exceed `max_size_bytes`, the least recently read or written ones
+// are removed. Locking and eviction are not supported on Windows.
+class GpuDelegateCache {
+ public:
+  GpuDelegateCache(absl::string_view dir, absl::string_view cache_namespace,
+                   int64_t max_size_bytes);
+
+  // Returns the key of the `kind` artifact, e.g. "kernels", of a model, which
+  // changes with the model contents and with the GPU driver.
+  static std::string MakeKey(absl::string_view kind,
+                             absl::string_view model_data,
+                             absl::string_view driver_version);
+
+  // Returns the contents of the entry of `key`, or a NotFound error.
+  absl::StatusOr<std::string> Read(absl::string_view key) const;
+
+  // Stores `contents` as the entry of `key` and evicts entries as needed.
+  absl::Status Write(absl::string_view key, absl::string_view contents);
+
+ private:
+  std::string EntryPath(absl::string_view key) const;
+  // Removes the least recently used entries but `keep_path` until the
+  // namespace fits in `max_size_bytes_`. Must hold the exclusive lock.
+  void Evict(const std::string& keep_path) const;
+
+  const std::string dir_;
+  const int64_t max_size_bytes_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_GPU_DELEGATE_CACHE_H_
@@ -0,0 +1,81 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/gpu_delegate_cache.h"
+
+#include <string>
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::HasSubstr;
+
+std::string CacheDir(const std::string& test_name) {
+  return file::JoinPath(::testing::TempDir(), "gpu_delegate_cache", test_name);
+}
+
+TEST(GpuDelegateCacheTest, ReadsWhatWasWritten) {
+  GpuDelegateCache cache(CacheDir("reads"), "ns", /*max_size_bytes=*/1024);
+  EXPECT_EQ(cache.Read("key").status().code(), absl::StatusCode::kNotFound);
+
+  MP_ASSERT_OK(cache.Write("key", "contents"));
+  MP_ASSERT_OK_AND_ASSIGN(std::string contents, cache.Read("key"));
+  EXPECT_EQ(contents, "contents");
+
+  MP_ASSERT_OK(cache.Write("key", "new contents"));
+  MP_ASSERT_OK_AND_ASSIGN(contents, cache.Read("key"));
+  EXPECT_EQ(contents, "new contents");
+}
+
+TEST(GpuDelegateCacheTest, SeparatesNamespaces) {
+  GpuDelegateCache cache_a(CacheDir("namespaces"), "a", 1024);
+  GpuDelegateCache cache_b(CacheDir("namespaces"), "b", 1024);
+  MP_ASSERT_OK(cache_a.Write("key", "a"));
+  EXPECT_EQ(cache_b.Read("key").status().code(), absl::StatusCode::kNotFound);
+}
+
+TEST(GpuDelegateCacheTest, EvictsBeyondMaxSize) {
+  GpuDelegateCache cache(CacheDir("evicts"), "ns", /*max_size_bytes=*/10);
+  MP_ASSERT_OK(cache.Write("first", "123456"));
+  MP_ASSERT_OK(cache.Write("second", "123456"));
+  EXPECT_EQ(cache.Read("first").status().code(), absl::StatusCode::kNotFound);
+  MP_EXPECT_OK(cache.Read("second"));
+
+  // The entry just written is kept even if it alone exceeds the size.
+  MP_ASSERT_OK(cache.Write("third", "12345678901"));
+  MP_EXPECT_OK(cache.Read("third"));
+}
+
+TEST(GpuDelegateCacheTest, KeyDependsOnModelAndDriver) {
+  const std::string key =
+      GpuDelegateCache::MakeKey("kernels", "model", "OpenGL ES 3.2 v1");
+  EXPECT_THAT(key, HasSubstr("kernels"));
+  EXPECT_EQ(key,
+            GpuDelegateCache::MakeKey("kernels", "model", "OpenGL ES 3.2 v1"));
+  EXPECT_NE(key,
+            GpuDelegateCache::MakeKey("kernels", "model2", "OpenGL ES 3.2 v1"));
+  EXPECT_NE(key,
+            GpuDelegateCache::MakeKey("kernels", "model", "OpenGL ES 3.2 v2"));
+  EXPECT_NE(key,
+            GpuDelegateCache::MakeKey("model", "model", "OpenGL ES 3.2 v1"));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -14,8 +14,10 @@
 
 #include <array>
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_calculator.pb.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_converter.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
@@ -31,6 +33,7 @@
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/statusor.h"
 #include "mediapipe/gpu/gpu_origin.pb.h"
+#include "mediapipe/util/preprocessing_cache.h"
 
 #if !MEDIAPIPE_DISABLE_OPENCV
 #include "mediapipe/calculators/tensor/image_to_tensor_converter_opencv.h"
@@ -82,9 +85,16 @@ using GpuBuffer = mediapipe::GpuBuffer;
 //     Describes region of image to extract.
 //     @Optional: rect covering the whole image is used if not specified.
 //
+//   NORM_RECTS - std::vector<NormalizedRect> @Optional
+//     Describes several regions of image to extract into a single batch
+//     tensor. Can't be used together with NORM_RECT, MATRIX or
+//     LETTERBOX_PADDING.
+//
 // Outputs:
 //   TENSORS - std::vector<Tensor>
 //     Vector containing a single Tensor populated with an extrated RGB image.
+//     With NORM_RECTS the tensor has shape [N, height, width, 3] and holds one
+//     extracted region per batch item, in the order of the input rects.
 //   MATRIX - std::array<float, 16> @Optional
 //     An std::array<float, 16> representing a 4x4 row-major-order matrix that
 //     maps a point on the input image to a point on the output tensor, and
@@ -101,6 +111,12 @@ using GpuBuffer = mediapipe::GpuBuffer;
 //     20x20 and places it in the middle of the output image with an equal
 //     padding of 10 pixels at the top and the bottom. The resulting array is
 //     therefore [0.f, 0.25f, 0.f, 0.25f] (10/40 = 0.25f).
+//   MATRICES - std::vector<std::array<float, 16>> @Optional
+//     The MATRIX of every batch item when NORM_RECTS is used.
+//
+//   With "fuse_into_model", TENSORS holds the whole image, the region matrices
+//   and the normalization instead, for the model to extract the regions
+//   itself. See the option.
 //
 // Example:
 // node {
@@ -129,13 +145,17 @@ class ImageToTensorCalculator : public Node {
   static constexpr Input<GpuBuffer>::Optional kInGpu{"IMAGE_GPU"};
   static constexpr Input<mediapipe::NormalizedRect>::Optional kInNormRect{
       "NORM_RECT"};
+  static constexpr Input<std::vector<mediapipe::NormalizedRect>>::Optional
+      kInNormRects{"NORM_RECTS"};
   static constexpr Output<std::vector<Tensor>> kOutTensors{"TENSORS"};
   static constexpr Output<std::array<float, 4>>::Optional kOutLetterboxPadding{
       "LETTERBOX_PADDING"};
   static constexpr Output<std::array<float, 16>>::Optional kOutMatrix{"MATRIX"};
+  static constexpr Output<std::vector<std::array<float, 16>>>::Optional
+      kOutMatrices{"MATRICES"};
 
-  MEDIAPIPE_NODE_CONTRACT(kIn, kInGpu, kInNormRect, kOutTensors,
-                          kOutLetterboxPadding, kOutMatrix);
+  MEDIAPIPE_NODE_CONTRACT(kIn, kInGpu, kInNormRect, kInNormRects, kOutTensors,
+                          kOutLetterboxPadding, kOutMatrix, kOutMatrices);
 
   static absl::Status UpdateContract(CalculatorContract* cc) {
     const auto& options =
@@ -172,6 +192,22 @@ class ImageToTensorCalculator : public Node {
           << "The maximum of the output int tensor range must be less than or "
              "equal to 127.";
     }
+    if (options.has_output_tensor_quantization()) {
+      RET_CHECK(options.has_output_tensor_float_range())
+          << "output_tensor_quantization requires output_tensor_float_range.";
+      RET_CHECK_GT(options.output_tensor_quantization().scale(), 0)
+          << "A positive quantization scale is required.";
+    }
+    if (options.fuse_into_model()) {
+      RET_CHECK(options.has_output_tensor_float_range() &&
+                !options.has_output_tensor_quantization())
+          << "fuse_into_model requires a float output tensor.";
+      RET_CHECK_EQ(options.border_mode(),
+                   mediapipe::ImageToTensorCalculatorOptions::BORDER_ZERO)
+          << "fuse_into_model requires BORDER_ZERO.";
+      RET_CHECK(!kInGpu(cc).IsConnected())
+          << "fuse_into_model requires a CPU image.";
+    }
     RET_CHECK_GT(options.output_tensor_width(), 0)
         << "Valid output tensor width is required.";
     RET_CHECK_GT(options.output_tensor_height(), 0)
@@ -179,6 +215,18 @@ class ImageToTensorCalculator : public Node {
 
     RET_CHECK(kIn(cc).IsConnected() ^ kInGpu(cc).IsConnected())
         << "One and only one of IMAGE and IMAGE_GPU input is expected.";
+    RET_CHECK(!(kInNormRect(cc).IsConnected() &&
+                kInNormRects(cc).IsConnected()))
+        << "At most one of NORM_RECT and NORM_RECTS input is expected.";
+    if (kInNormRects(cc).IsConnected()) {
+      RET_CHECK(!kOutMatrix(cc).IsConnected() &&
+                !kOutLetterboxPadding(cc).IsConnected())
+          << "NORM_RECTS can't be used with MATRIX or LETTERBOX_PADDING, use "
+             "MATRICES instead.";
+    } else {
+      RET_CHECK(!kOutMatrices(cc).IsConnected())
+          << "MATRICES output requires NORM_RECTS input.";
+    }
 
 #if MEDIAPIPE_DISABLE_GPU
     if (kInGpu(cc).IsConnected()) {
@@ -192,6 +240,9 @@ class ImageToTensorCalculator : public Node {
     MP_RETURN_IF_ERROR(mediapipe::GlCalculatorHelper::UpdateContract(cc));
 #endif  // MEDIAPIPE_METAL_ENABLED
 #endif  // MEDIAPIPE_DISABLE_GPU
+    if (options.use_preprocessing_cache()) {
+      cc->UseService(kPreprocessingCacheService);
+    }
 
     return absl::OkStatus();
   }
@@ -213,6 +264,24 @@ class ImageToTensorCalculator : public Node {
       range_min_ = options_.output_tensor_float_range().min();
       range_max_ = options_.output_tensor_float_range().max();
     }
+    if (options_.has_output_tensor_quantization()) {
+      // Converters map pixels straight to the quantized range.
+      const auto& quantization = options_.output_tensor_quantization();
+      is_float_output_ = false;
+      quantization_ = Tensor::QuantizationParameters(
+          quantization.scale(), quantization.zero_point());
+      range_min_ =
+          range_min_ / quantization.scale() + quantization.zero_point();
+      range_max_ =
+          range_max_ / quantization.scale() + quantization.zero_point();
+    }
+    if (options_.use_preprocessing_cache()) {
+      preprocessing_cache_ =
+          &cc->Service(kPreprocessingCacheService).GetObject();
+      // The options determine the conversion, together with the region.
+      cache_key_ =
+          absl::StrCat("ImageToTensor:", options_.SerializeAsString(), ":");
+    }
     return absl::OkStatus();
   }
 
@@ -222,6 +291,9 @@ class ImageToTensorCalculator : public Node {
       // Timestamp bound update happens automatically.
       return absl::OkStatus();
     }
+    if (kInNormRects(cc).IsConnected()) {
+      return ProcessBatch(cc);
+    }
 
     absl::optional<mediapipe::NormalizedRect> norm_rect;
     if (kInNormRect(cc).IsConnected()) {
@@ -259,13 +331,83 @@ class ImageToTensorCalculator : public Node {
       kOutMatrix(cc).Send(std::move(matrix));
     }
 
+    if (options_.fuse_into_model()) {
+      return SendFusedInputs(cc, *image, {roi});
+    }
+
     // Lazy initialization of the GPU or CPU converter.
     MP_RETURN_IF_ERROR(InitConverterIfNecessary(cc, *image.get()));
 
-    ASSIGN_OR_RETURN(Tensor tensor,
-                     (image->UsesGpu() ? gpu_converter_ : cpu_converter_)
-                         ->Convert(*image, roi, {output_width_, output_height_},
-                                   range_min_, range_max_));
+    auto convert = [&]() -> absl::StatusOr<mediapipe::Packet> {
+      ASSIGN_OR_RETURN(
+          Tensor tensor,
+          (image->UsesGpu() ? gpu_converter_ : cpu_converter_)
+              ->Convert(*image, roi, {output_width_, output_height_},
+                        range_min_, range_max_));
+      auto result = std::make_unique<std::vector<Tensor>>();
+      result->push_back(std::move(tensor));
+      return Adopt(result.release()).At(cc->InputTimestamp());
+    };
+    mediapipe::Packet result;
+    if (preprocessing_cache_) {
+      ASSIGN_OR_RETURN(
+          result, preprocessing_cache_->GetOrCreate(
+                      kIn(cc).IsConnected() ? ToOldPacket(kIn(cc).packet())
+                                            : ToOldPacket(kInGpu(cc).packet()),
+                      absl::StrCat(cache_key_, roi.center_x, ",", roi.center_y,
+                                   ",", roi.width, ",", roi.height, ",",
+                                   roi.rotation),
+                      convert));
+    } else {
+      ASSIGN_OR_RETURN(result, convert());
+    }
+    kOutTensors(cc).Send(
+        FromOldPacket(std::move(result)).As<std::vector<Tensor>>());
+
+    return absl::OkStatus();
+  }
+
+ private:
+  // Extracts all NORM_RECTS regions into one batch tensor.
+  absl::Status ProcessBatch(CalculatorContext* cc) {
+    if (kInNormRects(cc).IsEmpty() || kInNormRects(cc)->empty()) {
+      // Timestamp bound update happens automatically.
+      return absl::OkStatus();
+    }
+
+    ASSIGN_OR_RETURN(auto image, GetInputImage(cc));
+    const Size size{image->width(), image->height()};
+    std::vector<RotatedRect> rois;
+    rois.reserve(kInNormRects(cc)->size());
+    auto matrices = std::make_unique<std::vector<std::array<float, 16>>>();
+    for (const auto& norm_rect : *kInNormRects(cc)) {
+      RotatedRect roi = GetRoi(size.width, size.height, norm_rect);
+      MP_RETURN_IF_ERROR(PadRoi(options_.output_tensor_width(),
+                                options_.output_tensor_height(),
+                                options_.keep_aspect_ratio(), &roi)
+                             .status());
+      std::array<float, 16> matrix;
+      GetRotatedSubRectToRectTransformMatrix(roi, size.width, size.height,
+                                             /*flip_horizontaly=*/false,
+                                             &matrix);
+      matrices->push_back(matrix);
+      rois.push_back(roi);
+    }
+    if (kOutMatrices(cc).IsConnected()) {
+      kOutMatrices(cc).Send(std::move(matrices));
+    }
+
+    if (options_.fuse_into_model()) {
+      return SendFusedInputs(cc, *image, rois);
+    }
+
+    MP_RETURN_IF_ERROR(InitConverterIfNecessary(cc, *image.get()));
+
+    ASSIGN_OR_RETURN(
+        Tensor tensor,
+        (image->UsesGpu() ? gpu_converter_ : cpu_converter_)
+            ->ConvertBatch(*image, rois, {output_width_, output_height_},
+                           range_min_, range_max_));
 
     auto result = std::make_unique<std::vector<Tensor>>();
     result->push_back(std::move(tensor));
@@ -274,7 +416,68 @@ class ImageToTensorCalculator : public Node {
     return absl::OkStatus();
   }
 
- private:
+  // Sends the inputs of the TransformTensorBilinearNormalize op that extracts
+  // `rois` from `image` in the model.
+  absl::Status SendFusedInputs(CalculatorContext* cc, const Image& image,
+                               const std::vector<RotatedRect>& rois) {
+    RET_CHECK(!image.UsesGpu()) << "fuse_into_model requires a CPU image.";
+    auto frame = image.GetImageFrameSharedPtr();
+    RET_CHECK(frame->Format() == ImageFormat::SRGB ||
+              frame->Format() == ImageFormat::SRGBA)
+        << "Only RGBA/RGB formats are supported, passed format: "
+        << static_cast<uint32_t>(frame->Format());
+
+    auto result = std::make_unique<std::vector<Tensor>>();
+    const int width = frame->Width();
+    const int height = frame->Height();
+    const int channels = frame->NumberOfChannels();
+    result->emplace_back(Tensor::ElementType::kUInt8,
+                         Tensor::Shape{1, height, width, channels});
+    {
+      auto view = result->back().GetCpuWriteView();
+      frame->CopyToBuffer(view.buffer<uint8>(), width * height * channels);
+    }
+
+    // The op samples pixels, so the normalized matrices are scaled from output
+    // tensor pixels and to image pixels.
+    const int num_rois = static_cast<int>(rois.size());
+    result->emplace_back(Tensor::ElementType::kFloat32,
+                         Tensor::Shape{num_rois, 1, 4, 4});
+    {
+      auto view = result->back().GetCpuWriteView();
+      float* matrices = view.buffer<float>();
+      const float to_image[4] = {static_cast<float>(width),
+                                 static_cast<float>(height), 1.0f, 1.0f};
+      const float from_output[4] = {1.0f / output_width_,
+                                    1.0f / output_height_, 1.0f, 1.0f};
+      for (int i = 0; i < num_rois; ++i) {
+        std::array<float, 16> matrix;
+        GetRotatedSubRectToRectTransformMatrix(rois[i], width, height,
+                                               /*flip_horizontaly=*/false,
+                                               &matrix);
+        for (int r = 0; r < 4; ++r) {
+          for (int c = 0; c < 4; ++c) {
+            matrices[i * 16 + r * 4 + c] =
+                to_image[r] * matrix[r * 4 + c] * from_output[c];
+          }
+        }
+      }
+    }
+
+    ASSIGN_OR_RETURN(auto transform,
+                     GetValueRangeTransformation(0.0f, 255.0f, range_min_,
+                                                 range_max_));
+    result->emplace_back(Tensor::ElementType::kFloat32, Tensor::Shape{2});
+    {
+      auto view = result->back().GetCpuWriteView();
+      view.buffer<float>()[0] = transform.scale;
+      view.buffer<float>()[1] = transform.offset;
+    }
+
+    kOutTensors(cc).Send(std::move(result));
+    return absl::OkStatus();
+  }
+
   bool DoesGpuInputStartAtBottom() {
     return options_.gpu_origin() != mediapipe::GpuOrigin_Mode_TOP_LEFT;
   }
@@ -296,6 +499,11 @@ class ImageToTensorCalculator : public Node {
     if (is_float_output_) {
       return Tensor::ElementType::kFloat32;
     }
+    if (options_.has_output_tensor_quantization()) {
+      return options_.output_tensor_quantization().is_signed()
+                 ? Tensor::ElementType::kInt8
+                 : Tensor::ElementType::kUInt8;
+    }
     if (range_min_ < 0) {
       return Tensor::ElementType::kInt8;
     } else {
@@ -333,21 +541,24 @@ class ImageToTensorCalculator : public Node {
                                         const Image& image) {
     // Lazy initialization of the GPU or CPU converter.
     if (image.UsesGpu()) {
-      if (!is_float_output_) {
-        return absl::UnimplementedError(
-            "ImageToTensorConverter for the input GPU image currently doesn't "
-            "support quantization.");
-      }
       if (!gpu_converter_) {
 #if !MEDIAPIPE_DISABLE_GPU
 #if MEDIAPIPE_METAL_ENABLED
         ASSIGN_OR_RETURN(gpu_converter_,
-                         CreateMetalConverter(cc, GetBorderMode()));
+                         CreateMetalConverter(cc, GetBorderMode(),
+                                              GetOutputTensorType(),
+                                              quantization_));
 #elif MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
         ASSIGN_OR_RETURN(gpu_converter_,
                          CreateImageToGlBufferTensorConverter(
-                             cc, DoesGpuInputStartAtBottom(), GetBorderMode()));
+                             cc, DoesGpuInputStartAtBottom(), GetBorderMode(),
+                             GetOutputTensorType(), quantization_));
 #else
+        if (!is_float_output_) {
+          return absl::UnimplementedError(
+              "ImageToTensorConverter for the input GPU image requires "
+              "OpenGL ES 3.1 or Metal for quantized output.");
+        }
         if (!gpu_converter_) {
           ASSIGN_OR_RETURN(
               gpu_converter_,
@@ -366,7 +577,8 @@ class ImageToTensorCalculator : public Node {
 #if !MEDIAPIPE_DISABLE_OPENCV
         ASSIGN_OR_RETURN(
             cpu_converter_,
-            CreateOpenCvConverter(cc, GetBorderMode(), GetOutputTensorType()));
+            CreateOpenCvConverter(cc, GetBorderMode(), GetOutputTensorType(),
+                                  quantization_));
 #else
         LOG(FATAL) << "Cannot create image to tensor opencv converter since "
                       "MEDIAPIPE_DISABLE_OPENCV is defined.";
@@ -384,6 +596,10 @@ class ImageToTensorCalculator : public Node {
   bool is_float_output_ = false;
   float range_min_ = 0.0f;
   float range_max_ = 1.0f;
+  Tensor::QuantizationParameters quantization_;
+  // Set when use_preprocessing_cache is.
+  PreprocessingCache* preprocessing_cache_ = nullptr;
+  std::string cache_key_;
 };
 
 MEDIAPIPE_REGISTER_NODE(ImageToTensorCalculator);
@@ -482,5 +482,198 @@ TEST(ImageToTensorCalculatorTest, NoOpExceptRangeBorderZero) {
           BorderMode::kZero, roi);
 }
 
+// Converts a uniform image with the given quantization and checks the values
+// and the quantization parameters of the output tensor.
+void RunQuantizedTest(bool is_signed, float scale, int zero_point,
+                      Tensor::ElementType expected_type,
+                      const std::vector<int>& expected_values) {
+  auto graph_config = mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(
+      absl::Substitute(R"(
+        input_stream: "input_image"
+        node {
+          calculator: "ImageToTensorCalculator"
+          input_stream: "IMAGE:input_image"
+          output_stream: "TENSORS:tensor"
+          options {
+            [mediapipe.ImageToTensorCalculatorOptions.ext] {
+              output_tensor_width: 4
+              output_tensor_height: 4
+              output_tensor_float_range { min: -1.0 max: 1.0 }
+              output_tensor_quantization {
+                scale: $0
+                zero_point: $1
+                is_signed: $2
+              }
+            }
+          }
+        }
+        )",
+                       scale, zero_point, is_signed ? "true" : "false"));
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor", &graph_config, &output_packets);
+
+  cv::Mat input(8, 8, CV_8UC3, cv::Scalar(255, 0, 64));
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(graph_config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(graph.AddPacketToInputStream("input_image",
+                                            MakeImageFramePacket(input)));
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  ASSERT_THAT(output_packets, testing::SizeIs(1));
+
+  const Tensor& tensor = output_packets[0].Get<std::vector<Tensor>>()[0];
+  EXPECT_EQ(tensor.element_type(), expected_type);
+  EXPECT_FLOAT_EQ(tensor.quantization_parameters().scale, scale);
+  EXPECT_EQ(tensor.quantization_parameters().zero_point, zero_point);
+  auto view = tensor.GetCpuReadView();
+  for (int i = 0; i < tensor.shape().num_elements(); ++i) {
+    const int value = is_signed ? view.buffer<int8>()[i]
+                                : view.buffer<uint8>()[i];
+    EXPECT_EQ(value, expected_values[i % 3]) << "at " << i;
+  }
+
+  MP_ASSERT_OK(graph.CloseInputStream("input_image"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+TEST(ImageToTensorCalculatorTest, QuantizedUInt8Output) {
+  // Pixels map to [-1, 1] first: 255 -> 1, 0 -> -1, 64 -> -0.498.
+  RunQuantizedTest(/*is_signed=*/false, /*scale=*/1.0f / 128,
+                   /*zero_point=*/128, Tensor::ElementType::kUInt8,
+                   /*expected_values=*/{255, 0, 64});
+}
+
+TEST(ImageToTensorCalculatorTest, QuantizedInt8Output) {
+  RunQuantizedTest(/*is_signed=*/true, /*scale=*/1.0f / 128,
+                   /*zero_point=*/0, Tensor::ElementType::kInt8,
+                   /*expected_values=*/{127, -128, -64});
+}
+
+TEST(ImageToTensorCalculatorTest, BatchedNormRects) {
+  auto graph_config = mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+    input_stream: "input_image"
+    input_stream: "rois"
+    node {
+      calculator: "ImageToTensorCalculator"
+      input_stream: "IMAGE:input_image"
+      input_stream: "NORM_RECTS:rois"
+      output_stream: "TENSORS:tensor"
+      output_stream: "MATRICES:matrices"
+      options {
+        [mediapipe.ImageToTensorCalculatorOptions.ext] {
+          output_tensor_width: 2
+          output_tensor_height: 2
+          output_tensor_uint_range { min: 0 max: 255 }
+        }
+      }
+    }
+  )");
+  std::vector<Packet> tensor_packets;
+  tool::AddVectorSink("tensor", &graph_config, &tensor_packets);
+  std::vector<Packet> matrices_packets;
+  tool::AddVectorSink("matrices", &graph_config, &matrices_packets);
+
+  // The left half of the image is red and the right half is blue.
+  cv::Mat input(8, 8, CV_8UC3, cv::Scalar(255, 0, 0));
+  input(cv::Rect(4, 0, 4, 8)).setTo(cv::Scalar(0, 0, 255));
+  std::vector<mediapipe::NormalizedRect> rois(2);
+  for (int i = 0; i < rois.size(); ++i) {
+    rois[i].set_x_center(0.25f + 0.5f * i);
+    rois[i].set_y_center(0.5f);
+    rois[i].set_width(0.5f);
+    rois[i].set_height(1.0f);
+  }
+
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(graph_config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(graph.AddPacketToInputStream("input_image",
+                                            MakeImageFramePacket(input)));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "rois", MakePacket<std::vector<mediapipe::NormalizedRect>>(rois).At(
+                  Timestamp(0))));
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  ASSERT_THAT(tensor_packets, testing::SizeIs(1));
+  ASSERT_THAT(matrices_packets, testing::SizeIs(1));
+  EXPECT_THAT(matrices_packets[0].Get<std::vector<std::array<float, 16>>>(),
+              testing::SizeIs(2));
+
+  const Tensor& tensor = tensor_packets[0].Get<std::vector<Tensor>>()[0];
+  EXPECT_THAT(tensor.shape().dims, testing::ElementsAre(2, 2, 2, 3));
+  auto view = tensor.GetCpuReadView();
+  const uint8* values = view.buffer<uint8>();
+  for (int i = 0; i < 2 * 2; ++i) {
+    // First item.
+    EXPECT_EQ(values[3 * i], 255) << "at " << i;
+    EXPECT_EQ(values[3 * i + 2], 0) << "at " << i;
+    // Second item.
+    EXPECT_EQ(values[12 + 3 * i], 0) << "at " << i;
+    EXPECT_EQ(values[12 + 3 * i + 2], 255) << "at " << i;
+  }
+
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+TEST(ImageToTensorCalculatorTest, FuseIntoModel) {
+  auto graph_config = mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+    input_stream: "input_image"
+    node {
+      calculator: "ImageToTensorCalculator"
+      input_stream: "IMAGE:input_image"
+      output_stream: "TENSORS:tensors"
+      options {
+        [mediapipe.ImageToTensorCalculatorOptions.ext] {
+          output_tensor_width: 4
+          output_tensor_height: 2
+          output_tensor_float_range { min: -1.0 max: 1.0 }
+          border_mode: BORDER_ZERO
+          fuse_into_model: true
+        }
+      }
+    }
+  )");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensors", &graph_config, &output_packets);
+
+  cv::Mat input(4, 8, CV_8UC3, cv::Scalar(255, 0, 64));
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(graph_config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(graph.AddPacketToInputStream("input_image",
+                                            MakeImageFramePacket(input)));
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  ASSERT_THAT(output_packets, testing::SizeIs(1));
+  const auto& tensors = output_packets[0].Get<std::vector<Tensor>>();
+  ASSERT_THAT(tensors, testing::SizeIs(3));
+
+  // The whole image, untouched.
+  EXPECT_EQ(tensors[0].element_type(), Tensor::ElementType::kUInt8);
+  EXPECT_THAT(tensors[0].shape().dims, testing::ElementsAre(1, 4, 8, 3));
+  auto image_view = tensors[0].GetCpuReadView();
+  EXPECT_EQ(image_view.buffer<uint8>()[0], 255);
+  EXPECT_EQ(image_view.buffer<uint8>()[1], 0);
+  EXPECT_EQ(image_view.buffer<uint8>()[2], 64);
+
+  // Output tensor pixels scale by 2 to image pixels.
+  EXPECT_THAT(tensors[1].shape().dims, testing::ElementsAre(1, 1, 4, 4));
+  auto matrix_view = tensors[1].GetCpuReadView();
+  const float* matrix = matrix_view.buffer<float>();
+  EXPECT_FLOAT_EQ(matrix[0], 2.0f);
+  EXPECT_NEAR(matrix[1], 0.0f, 1e-5f);
+  EXPECT_NEAR(matrix[3], 0.0f, 1e-5f);
+  EXPECT_NEAR(matrix[4], 0.0f, 1e-5f);
+  EXPECT_FLOAT_EQ(matrix[5], 2.0f);
+  EXPECT_NEAR(matrix[7], 0.0f, 1e-5f);
+
+  // Pixels map from [0, 255] to [-1, 1].
+  auto transform_view = tensors[2].GetCpuReadView();
+  EXPECT_FLOAT_EQ(transform_view.buffer<float>()[0], 2.0f / 255.0f);
+  EXPECT_FLOAT_EQ(transform_view.buffer<float>()[1], -1.0f);
+
+  MP_ASSERT_OK(graph.CloseInputStream("input_image"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -15,6 +15,9 @@
 #ifndef MEDIAPIPE_CALCULATORS_TENSOR_IMAGE_TO_TENSOR_CONVERTER_H_
 #define MEDIAPIPE_CALCULATORS_TENSOR_IMAGE_TO_TENSOR_CONVERTER_H_
 
+#include <vector>
+
+#include "absl/status/status.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/formats/tensor.h"
@@ -49,6 +52,19 @@ class ImageToTensorConverter {
                                          const RotatedRect& roi,
                                          const Size& output_dims,
                                          float range_min, float range_max) = 0;
+
+  // Converts each region of @rois into one item of a batch tensor, whose shape
+  // is [rois.size(), output_dims.height, output_dims.width, channels], in a
+  // single pass.
+  virtual absl::StatusOr<Tensor> ConvertBatch(
+      const mediapipe::Image& input, const std::vector<RotatedRect>& rois,
+      const Size& output_dims, float range_min, float range_max) {
+    if (rois.size() == 1) {
+      return Convert(input, rois[0], output_dims, range_min, range_max);
+    }
+    return absl::UnimplementedError(
+        "Batched conversion is not supported by this converter.");
+  }
 };
 
 }  // namespace mediapipe
@@ -36,6 +36,7 @@
 #include "mediapipe/gpu/gl_calculator_helper.h"
 #include "tensorflow/lite/delegates/gpu/common/shape.h"
 #include "tensorflow/lite/delegates/gpu/common/types.h"
+#include "tensorflow/lite/delegates/gpu/common/util.h"
 #include "tensorflow/lite/delegates/gpu/gl/command_queue.h"
 #include "tensorflow/lite/delegates/gpu/gl/converters/util.h"
 #include "tensorflow/lite/delegates/gpu/gl/gl_buffer.h"
@@ -53,33 +54,38 @@ namespace {
 class SubRectExtractorGl {
  public:
   // Extracts a region defined by @sub_rect, removes A channel, transforms input
-  // pixels as alpha * x + beta and resizes result into destination.
+  // pixels as alpha * x + beta and resizes result into destination, starting
+  // at @destination_offset elements (words for quantized output).
   absl::Status ExtractSubRectToBuffer(
       const tflite::gpu::gl::GlTexture& texture,
       const tflite::gpu::HW& texture_size, const RotatedRect& sub_rect,
       bool flip_horizontaly, float alpha, float beta,
-      const tflite::gpu::HW& destination_size,
+      const tflite::gpu::HW& destination_size, int destination_offset,
       tflite::gpu::gl::CommandQueue* command_queue,
       tflite::gpu::gl::GlBuffer* destination);
 
+  // @tensor_type is kFloat32, kUInt8 or kInt8. Quantized destinations are
+  // written four bytes per word, so their size must be a multiple of four.
   static absl::StatusOr<SubRectExtractorGl> Create(
       const mediapipe::GlContext& gl_context, bool input_starts_at_bottom,
-      BorderMode border_mode);
+      BorderMode border_mode, Tensor::ElementType tensor_type);
 
  private:
   explicit SubRectExtractorGl(tflite::gpu::gl::GlProgram program,
                               tflite::gpu::uint3 workgroup_size,
                               bool use_custom_zero_border,
-                              BorderMode border_mode)
+                              BorderMode border_mode, bool quantized_output)
       : program_(std::move(program)),
         workgroup_size_(workgroup_size),
         use_custom_zero_border_(use_custom_zero_border),
-        border_mode_(border_mode) {}
+        border_mode_(border_mode),
+        quantized_output_(quantized_output) {}
 
   tflite::gpu::gl::GlProgram program_;
   tflite::gpu::uint3 workgroup_size_;
   bool use_custom_zero_border_ = false;
   BorderMode border_mode_ = BorderMode::kReplicate;
+  bool quantized_output_ = false;
 };
 
 absl::Status SetMat4x4(const tflite::gpu::gl::GlProgram& program,
@@ -91,39 +97,23 @@ absl::Status SetMat4x4(const tflite::gpu::gl::GlProgram& program,
                             1, GL_TRUE, data);
 }
 
-constexpr char kShaderCode[] = R"(
+constexpr char kCommonShaderCode[] = R"(
 layout(std430) buffer;
 
 precision highp float;
 
-// It is possible to use "vec3 elements[];" here, however due to alignment
-// requirements it works only when "packed" layout is used. "packed" layout is
-// determined by implementation and it's expected that OpenGL API is used to
-// query the layout. Favoring float array over vec3, considering performance is
-// comparable, layout is the same and no need for layout querying (even though
-// it's not quite needed here as there's only one member).
-layout(binding = 0) writeonly buffer B0 {
-  float elements[];
-} output_data;
-
 uniform ivec2 out_size;
+uniform int out_offset;
 uniform float alpha;
 uniform float beta;
 uniform mat4 transform_matrix;
 uniform mediump sampler2D input_data;
 
-void main() {
-    int out_width = out_size.x;
-    int out_height = out_size.y;
-
-    ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
-    if (gid.x >= out_width || gid.y >= out_height) {
-        return;
-    }
-
+// Returns the transformed value of the output pixel at @gid.
+vec4 GetValue(ivec2 gid) {
     // transform from image.width, image.height range to [0, 1]
-    float normal_x = (float(gid.x) + 0.5f) / float(out_width);
-    float normal_y = (float(gid.y) + 0.5f) / float(out_height);
+    float normal_x = (float(gid.x) + 0.5f) / float(out_size.x);
+    float normal_y = (float(gid.y) + 0.5f) / float(out_size.y);
     vec4 tc = vec4(normal_x, normal_y, 0.0, 1.0);
 
     // Apply transformation from roi coordinates to original image coordinates.
@@ -140,22 +130,79 @@ void main() {
       float(tc.x < 0.0 || tc.x > 1.0 || tc.y < 0.0 || tc.y > 1.0);
     src_value = mix(src_value, vec4(0.0, 0.0, 0.0, 0.0), out_of_bounds);
 #endif
+    return src_value;
+}
+)";
 
-    int linear_index = gid.y * out_width + gid.x;
+constexpr char kFloatShaderCode[] = R"(
+// It is possible to use "vec3 elements[];" here, however due to alignment
+// requirements it works only when "packed" layout is used. "packed" layout is
+// determined by implementation and it's expected that OpenGL API is used to
+// query the layout. Favoring float array over vec3, considering performance is
+// comparable, layout is the same and no need for layout querying (even though
+// it's not quite needed here as there's only one member).
+layout(binding = 0) writeonly buffer B0 {
+  float elements[];
+} output_data;
+
+void main() {
+    ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
+    if (gid.x >= out_size.x || gid.y >= out_size.y) {
+        return;
+    }
+    vec4 src_value = GetValue(gid);
+
+    int linear_index = gid.y * out_size.x + gid.x;
 
     // output_data.elements is populated as though it contains vec3 elements.
-    int first_component_index = 3 * linear_index;
+    int first_component_index = out_offset + 3 * linear_index;
     output_data.elements[first_component_index] = src_value.r;
     output_data.elements[first_component_index + 1] = src_value.g;
     output_data.elements[first_component_index + 2] = src_value.b;
 }
 )";
 
+// GLSL has no 8-bit types, so each invocation packs four consecutive bytes of
+// the RGB tensor into one word. alpha and beta map pixels to the quantized
+// range already.
+constexpr char kQuantizedShaderCode[] = R"(
+layout(binding = 0) writeonly buffer B0 {
+  uint elements[];
+} output_data;
+
+void main() {
+    int word_index = int(gl_GlobalInvocationID.x);
+    if (4 * word_index >= 3 * out_size.x * out_size.y) {
+        return;
+    }
+    uint word = 0u;
+    int sampled_index = -1;
+    vec4 src_value;
+    for (int i = 0; i < 4; ++i) {
+        int byte_index = 4 * word_index + i;
+        int linear_index = byte_index / 3;
+        if (linear_index != sampled_index) {
+            src_value = GetValue(
+                ivec2(linear_index % out_size.x, linear_index / out_size.x));
+            sampled_index = linear_index;
+        }
+        float value = round(src_value[byte_index % 3]);
+#ifdef SIGNED_OUTPUT
+        int quantized = int(clamp(value, -128.0, 127.0));
+#else
+        int quantized = int(clamp(value, 0.0, 255.0));
+#endif  // SIGNED_OUTPUT
+        word |= (uint(quantized) & 0xffu) << uint(8 * i);
+    }
+    output_data.elements[out_offset + word_index] = word;
+}
+)";
+
 absl::Status SubRectExtractorGl::ExtractSubRectToBuffer(
     const tflite::gpu::gl::GlTexture& texture,
     const tflite::gpu::HW& texture_size, const RotatedRect& texture_sub_rect,
     bool flip_horizontaly, float alpha, float beta,
-    const tflite::gpu::HW& destination_size,
+    const tflite::gpu::HW& destination_size, int destination_offset,
     tflite::gpu::gl::CommandQueue* command_queue,
     tflite::gpu::gl::GlBuffer* destination) {
   std::array<float, 16> transform_mat;
@@ -192,11 +239,20 @@ absl::Status SubRectExtractorGl::ExtractSubRectToBuffer(
       SetMat4x4(program_, "transform_matrix", transform_mat.data()));
   MP_RETURN_IF_ERROR(program_.SetParameter(
       {"out_size", tflite::gpu::int2(destination_size.w, destination_size.h)}));
+  MP_RETURN_IF_ERROR(
+      program_.SetParameter({"out_offset", destination_offset}));
   MP_RETURN_IF_ERROR(program_.SetParameter({"alpha", alpha}));
   MP_RETURN_IF_ERROR(program_.SetParameter({"beta", beta}));
-  tflite::gpu::uint3 num_workgroups = tflite::gpu::DivideRoundUp(
-      tflite::gpu::uint3{destination_size.w, destination_size.h, 1},
-      workgroup_size_);
+  tflite::gpu::uint3 num_invocations = {destination_size.w,
+                                        destination_size.h, 1};
+  if (quantized_output_) {
+    // One invocation per word of four output bytes.
+    num_invocations = {tflite::gpu::DivideRoundUp(
+                           3u * destination_size.w * destination_size.h, 4u),
+                       1, 1};
+  }
+  tflite::gpu::uint3 num_workgroups =
+      tflite::gpu::DivideRoundUp(num_invocations, workgroup_size_);
   MP_RETURN_IF_ERROR(command_queue->Dispatch(program_, num_workgroups));
 
   // Resetting to MediaPipe texture param defaults.
@@ -210,11 +266,14 @@ absl::Status SubRectExtractorGl::ExtractSubRectToBuffer(
 
 absl::StatusOr<SubRectExtractorGl> SubRectExtractorGl::Create(
     const mediapipe::GlContext& gl_context, bool input_starts_at_bottom,
-    BorderMode border_mode) {
+    BorderMode border_mode, Tensor::ElementType tensor_type) {
   bool use_custom_zero_border = border_mode == BorderMode::kZero &&
                                 !IsGlClampToBorderSupported(gl_context);
 
-  const tflite::gpu::uint3 workgroup_size = {8, 8, 1};
+  const bool quantized_output = tensor_type != Tensor::ElementType::kFloat32;
+  const tflite::gpu::uint3 workgroup_size =
+      quantized_output ? tflite::gpu::uint3{64, 1, 1}
+                       : tflite::gpu::uint3{8, 8, 1};
   std::string starts_at_bottom_def;
   if (input_starts_at_bottom) {
     starts_at_bottom_def = R"(
@@ -227,9 +286,16 @@ absl::StatusOr<SubRectExtractorGl> SubRectExtractorGl::Create(
       #define CUSTOM_ZERO_BORDER_MODE
     )";
   }
+  std::string signed_output_def;
+  if (tensor_type == Tensor::ElementType::kInt8) {
+    signed_output_def = R"(
+      #define SIGNED_OUTPUT
+    )";
+  }
   const std::string full_shader_source = absl::StrCat(
       tflite::gpu::gl::GetShaderHeader(workgroup_size), starts_at_bottom_def,
-      custom_zero_border_mode_def, kShaderCode);
+      custom_zero_border_mode_def, signed_output_def, kCommonShaderCode,
+      quantized_output ? kQuantizedShaderCode : kFloatShaderCode);
 
   tflite::gpu::gl::GlShader shader;
   MP_RETURN_IF_ERROR(tflite::gpu::gl::GlShader::CompileShader(
@@ -239,13 +305,17 @@ absl::StatusOr<SubRectExtractorGl> SubRectExtractorGl::Create(
       tflite::gpu::gl::GlProgram::CreateWithShader(shader, &program));
 
   return SubRectExtractorGl(std::move(program), workgroup_size,
-                            use_custom_zero_border, border_mode);
+                            use_custom_zero_border, border_mode,
+                            quantized_output);
 }
 
 class GlProcessor : public ImageToTensorConverter {
  public:
   absl::Status Init(CalculatorContext* cc, bool input_starts_at_bottom,
-                    BorderMode border_mode) {
+                    BorderMode border_mode, Tensor::ElementType tensor_type,
+                    const Tensor::QuantizationParameters& quantization) {
+    tensor_type_ = tensor_type;
+    quantization_ = quantization;
     MP_RETURN_IF_ERROR(gl_helper_.Open(cc));
     return gl_helper_.RunInGlContext([this, input_starts_at_bottom,
                                       border_mode]() -> absl::Status {
@@ -253,13 +323,36 @@ class GlProcessor : public ImageToTensorConverter {
       MP_RETURN_IF_ERROR(tflite::gpu::gl::RequestGpuInfo(&gpu_info));
       RET_CHECK(gpu_info.IsApiOpenGl31OrAbove())
           << "OpenGL ES 3.1 is required.";
-      command_queue_ = tflite::gpu::gl::NewCommandQueue(gpu_info);
-
       ASSIGN_OR_RETURN(
-          auto extractor,
-          SubRectExtractorGl::Create(gl_helper_.GetGlContext(),
-                                     input_starts_at_bottom, border_mode));
-      extractor_ = absl::make_unique<SubRectExtractorGl>(std::move(extractor));
+          command_queue_,
+          GetSharedGlObject<tflite::gpu::gl::CommandQueue>(
+              gl_helper_.GetGlContext(), "",
+              [&gpu_info]()
+                  -> absl::StatusOr<
+                      std::unique_ptr<tflite::gpu::gl::CommandQueue>> {
+                return tflite::gpu::gl::NewCommandQueue(gpu_info);
+              }));
+
+      // Converters with the same configuration share the compiled program.
+      const mediapipe::GlContext& gl_context = gl_helper_.GetGlContext();
+      const Tensor::ElementType tensor_type = tensor_type_;
+      ASSIGN_OR_RETURN(
+          extractor_,
+          GetSharedGlObject<SubRectExtractorGl>(
+              gl_helper_.GetGlContext(),
+              absl::StrCat(input_starts_at_bottom, ":",
+                           static_cast<int>(border_mode), ":",
+                           static_cast<int>(tensor_type)),
+              [&gl_context, input_starts_at_bottom, border_mode,
+               tensor_type]()
+                  -> absl::StatusOr<std::unique_ptr<SubRectExtractorGl>> {
+                ASSIGN_OR_RETURN(auto extractor,
+                                 SubRectExtractorGl::Create(
+                                     gl_context, input_starts_at_bottom,
+                                     border_mode, tensor_type));
+                return absl::make_unique<SubRectExtractorGl>(
+                    std::move(extractor));
+              }));
       return absl::OkStatus();
     });
   }
@@ -268,6 +361,13 @@ class GlProcessor : public ImageToTensorConverter {
                                  const RotatedRect& roi,
                                  const Size& output_dims, float range_min,
                                  float range_max) override {
+    return ConvertBatch(input, {roi}, output_dims, range_min, range_max);
+  }
+
+  absl::StatusOr<Tensor> ConvertBatch(const mediapipe::Image& input,
+                                      const std::vector<RotatedRect>& rois,
+                                      const Size& output_dims, float range_min,
+                                      float range_max) override {
     if (input.format() != mediapipe::GpuBufferFormat::kBGRA32 &&
         input.format() != mediapipe::GpuBufferFormat::kRGBAHalf64 &&
         input.format() != mediapipe::GpuBufferFormat::kRGBAFloat128) {
@@ -277,11 +377,23 @@ class GlProcessor : public ImageToTensorConverter {
     }
 
     constexpr int kNumChannels = 3;
-    Tensor tensor(Tensor::ElementType::kFloat32,
-                  {1, output_dims.height, output_dims.width, kNumChannels});
-
-    MP_RETURN_IF_ERROR(gl_helper_.RunInGlContext([this, &tensor, &input, &roi,
-                                                  &output_dims, range_min,
+    if (tensor_type_ != Tensor::ElementType::kFloat32) {
+      RET_CHECK_EQ(output_dims.width * output_dims.height % 4, 0)
+          << "Quantized OpenGL output requires the number of tensor pixels to "
+             "be a multiple of 4.";
+    }
+    Tensor tensor(tensor_type_,
+                  {static_cast<int>(rois.size()), output_dims.height,
+                   output_dims.width, kNumChannels},
+                  quantization_);
+    // Offset between batch items, in floats or in words of four quantized
+    // values.
+    int item_offset = output_dims.height * output_dims.width * kNumChannels;
+    if (tensor_type_ != Tensor::ElementType::kFloat32) item_offset /= 4;
+
+    MP_RETURN_IF_ERROR(gl_helper_.RunInGlContext([this, &tensor, &input, &rois,
+                                                  &output_dims, item_offset,
+                                                  range_min,
                                                   range_max]() -> absl::Status {
       constexpr int kRgbaNumChannels = 4;
       auto source_texture = gl_helper_.CreateSourceTexture(input);
@@ -304,12 +416,17 @@ class GlProcessor : public ImageToTensorConverter {
                                        buffer_view.name(), tensor.bytes(),
                                        /*offset=*/0,
                                        /*has_ownership=*/false);
-      MP_RETURN_IF_ERROR(extractor_->ExtractSubRectToBuffer(
-          input_texture,
-          tflite::gpu::HW(source_texture.height(), source_texture.width()), roi,
-          /*flip_horizontaly=*/false, transform.scale, transform.offset,
-          tflite::gpu::HW(output_dims.height, output_dims.width),
-          command_queue_.get(), &output));
+      // All regions are extracted into the same buffer within one context
+      // switch.
+      for (int i = 0; i < rois.size(); ++i) {
+        MP_RETURN_IF_ERROR(extractor_->ExtractSubRectToBuffer(
+            input_texture,
+            tflite::gpu::HW(source_texture.height(), source_texture.width()),
+            rois[i],
+            /*flip_horizontaly=*/false, transform.scale, transform.offset,
+            tflite::gpu::HW(output_dims.height, output_dims.width),
+            i * item_offset, command_queue_.get(), &output));
+      }
 
       return absl::OkStatus();
     }));
@@ -326,19 +443,30 @@ class GlProcessor : public ImageToTensorConverter {
   }
 
  private:
-  std::unique_ptr<tflite::gpu::gl::CommandQueue> command_queue_;
-  std::unique_ptr<SubRectExtractorGl> extractor_;
+  std::shared_ptr<tflite::gpu::gl::CommandQueue> command_queue_;
+  std::shared_ptr<SubRectExtractorGl> extractor_;
   mediapipe::GlCalculatorHelper gl_helper_;
+  Tensor::ElementType tensor_type_ = Tensor::ElementType::kFloat32;
+  Tensor::QuantizationParameters quantization_;
 };
 
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<ImageToTensorConverter>>
-CreateImageToGlBufferTensorConverter(CalculatorContext* cc,
-                                     bool input_starts_at_bottom,
-                                     BorderMode border_mode) {
+CreateImageToGlBufferTensorConverter(
+    CalculatorContext* cc, bool input_starts_at_bottom, BorderMode border_mode,
+    Tensor::ElementType tensor_type,
+    const Tensor::QuantizationParameters& quantization) {
+  if (tensor_type != Tensor::ElementType::kFloat32 &&
+      tensor_type != Tensor::ElementType::kUInt8 &&
+      tensor_type != Tensor::ElementType::kInt8) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Tensor type is currently not supported by GlProcessor, type: ",
+        tensor_type));
+  }
   auto result = absl::make_unique<GlProcessor>();
-  MP_RETURN_IF_ERROR(result->Init(cc, input_starts_at_bottom, border_mode));
+  MP_RETURN_IF_ERROR(result->Init(cc, input_starts_at_bottom, border_mode,
+                                  tensor_type, quantization));
 
   return result;
 }
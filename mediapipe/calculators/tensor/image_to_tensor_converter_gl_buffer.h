@@ -28,12 +28,16 @@
 namespace mediapipe {
 
 // Creates image to tensor (represented as OpenGL buffer) converter.
+// @tensor_type is kFloat32, kUInt8 or kInt8; @quantization is attached to
+// uint8 and int8 output tensors, whose number of pixels must be a multiple
+// of 4.
 // NOTE: mediapipe::GlCalculatorHelper::UpdateContract invocation must precede
 // converter creation.
 absl::StatusOr<std::unique_ptr<ImageToTensorConverter>>
-CreateImageToGlBufferTensorConverter(CalculatorContext* cc,
-                                     bool input_starts_at_bottom,
-                                     BorderMode border_mode);
+CreateImageToGlBufferTensorConverter(
+    CalculatorContext* cc, bool input_starts_at_bottom, BorderMode border_mode,
+    Tensor::ElementType tensor_type,
+    const Tensor::QuantizationParameters& quantization);
 
 }  // namespace mediapipe
 
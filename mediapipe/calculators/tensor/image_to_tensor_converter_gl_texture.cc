@@ -45,6 +45,141 @@ constexpr int kAttribVertex = 0;
 constexpr int kAttribTexturePosition = 1;
 constexpr int kNumAttributes = 2;
 
+// The GL objects of a GlProcessor. They are shared by the processors with the
+// same configuration on a GlContext, and deleted on its thread.
+struct GlProcessorResources {
+  ~GlProcessorResources() {
+    if (framebuffer != 0) glDeleteFramebuffers(1, &framebuffer);
+    if (program != 0) glDeleteProgram(program);
+    if (vao != 0) glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(2, vbo);
+  }
+
+  GLuint vao = 0;
+  GLuint vbo[2] = {0, 0};
+  GLuint program = 0;
+  GLuint framebuffer = 0;
+  GLint alpha_id = 0;
+  GLint beta_id = 0;
+  GLint matrix_id = 0;
+};
+
+absl::StatusOr<std::unique_ptr<GlProcessorResources>>
+CreateGlProcessorResources(bool input_starts_at_bottom,
+                           bool use_custom_zero_border) {
+  auto resources = absl::make_unique<GlProcessorResources>();
+  const GLint attr_location[kNumAttributes] = {
+      kAttribVertex,
+      kAttribTexturePosition,
+  };
+  const GLchar* attr_name[kNumAttributes] = {
+      "position",
+      "texture_coordinate",
+  };
+
+  constexpr GLchar kExtractSubRectVertexShader[] = R"(
+        in vec4 position;
+        in mediump vec4 texture_coordinate;
+        out mediump vec2 sample_coordinate;
+        uniform mat4 transform_matrix;
+
+        void main() {
+          gl_Position = position;
+          // Apply transformation from roi coordinates to original image coordinates.
+          vec4 tc = transform_matrix * texture_coordinate;
+      #ifdef INPUT_STARTS_AT_BOTTOM
+          // Opengl texture sampler has origin in lower left corner,
+          // so we invert y coordinate.
+          tc.y = 1.0 - tc.y;
+      #endif  // defined(INPUT_STARTS_AT_BOTTOM)
+          sample_coordinate = tc.xy;
+        }
+      )";
+
+  constexpr GLchar kExtractSubRectFragBody[] = R"(
+        DEFAULT_PRECISION(mediump, float)
+
+        // Provided by kExtractSubRectVertexShader.
+        in vec2 sample_coordinate;
+
+        uniform sampler2D input_texture;
+        uniform float alpha;
+        uniform float beta;
+
+        #ifdef GL_ES
+          #define fragColor gl_FragColor
+        #else
+          out vec4 fragColor;
+        #endif  // defined(GL_ES);
+
+        void main() {
+          vec4 color = texture2D(input_texture, sample_coordinate);
+        #ifdef CUSTOM_ZERO_BORDER_MODE
+          float out_of_bounds =
+              float(sample_coordinate.x < 0.0 || sample_coordinate.x > 1.0 ||
+                    sample_coordinate.y < 0.0 || sample_coordinate.y > 1.0);
+          color = mix(color, vec4(0.0, 0.0, 0.0, 0.0), out_of_bounds);
+        #endif  // defined(CUSTOM_ZERO_BORDER_MODE)
+          fragColor = alpha * color + beta;
+        }
+      )";
+
+  std::string starts_at_bottom_def;
+  if (input_starts_at_bottom) {
+    starts_at_bottom_def = R"(
+      #define INPUT_STARTS_AT_BOTTOM
+    )";
+  }
+
+  // Create program and set parameters.
+  const std::string extract_sub_rect_vertex_src =
+      absl::StrCat(mediapipe::kMediaPipeVertexShaderPreamble,
+                   starts_at_bottom_def, kExtractSubRectVertexShader);
+
+  std::string custom_zero_border_mode_def;
+  if (use_custom_zero_border) {
+    custom_zero_border_mode_def = R"(
+      #define CUSTOM_ZERO_BORDER_MODE
+    )";
+  }
+  const std::string extract_sub_rect_frag_src =
+      absl::StrCat(mediapipe::kMediaPipeFragmentShaderPreamble,
+                   custom_zero_border_mode_def, kExtractSubRectFragBody);
+  mediapipe::GlhCreateProgram(extract_sub_rect_vertex_src.c_str(),
+                              extract_sub_rect_frag_src.c_str(),
+                              kNumAttributes, &attr_name[0], attr_location,
+                              &resources->program);
+
+  RET_CHECK(resources->program)
+      << "Problem initializing image to tensor program.";
+  glUseProgram(resources->program);
+  glUniform1i(glGetUniformLocation(resources->program, "input_texture"), 1);
+  resources->alpha_id = glGetUniformLocation(resources->program, "alpha");
+  resources->beta_id = glGetUniformLocation(resources->program, "beta");
+  resources->matrix_id =
+      glGetUniformLocation(resources->program, "transform_matrix");
+
+  glGenFramebuffers(1, &resources->framebuffer);
+
+  // vertex storage
+  glGenBuffers(2, resources->vbo);
+  glGenVertexArrays(1, &resources->vao);
+
+  // vbo 0
+  glBindBuffer(GL_ARRAY_BUFFER, resources->vbo[0]);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(mediapipe::kBasicSquareVertices),
+               mediapipe::kBasicSquareVertices, GL_STATIC_DRAW);
+
+  // vbo 1
+  glBindBuffer(GL_ARRAY_BUFFER, resources->vbo[1]);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(mediapipe::kBasicTextureVertices),
+               mediapipe::kBasicTextureVertices, GL_STATIC_DRAW);
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  return resources;
+}
+
 class GlProcessor : public ImageToTensorConverter {
  public:
   absl::Status Init(CalculatorContext* cc, bool input_starts_at_bottom,
@@ -56,114 +191,16 @@ class GlProcessor : public ImageToTensorConverter {
           border_mode == BorderMode::kZero &&
           !IsGlClampToBorderSupported(gl_helper_.GetGlContext());
       border_mode_ = border_mode;
-
-      const GLint attr_location[kNumAttributes] = {
-          kAttribVertex,
-          kAttribTexturePosition,
-      };
-      const GLchar* attr_name[kNumAttributes] = {
-          "position",
-          "texture_coordinate",
-      };
-
-      constexpr GLchar kExtractSubRectVertexShader[] = R"(
-            in vec4 position;
-            in mediump vec4 texture_coordinate;
-            out mediump vec2 sample_coordinate;
-            uniform mat4 transform_matrix;
-
-            void main() {
-              gl_Position = position;
-              // Apply transformation from roi coordinates to original image coordinates.
-              vec4 tc = transform_matrix * texture_coordinate;
-          #ifdef INPUT_STARTS_AT_BOTTOM
-              // Opengl texture sampler has origin in lower left corner,
-              // so we invert y coordinate.
-              tc.y = 1.0 - tc.y;
-          #endif  // defined(INPUT_STARTS_AT_BOTTOM)
-              sample_coordinate = tc.xy;
-            }
-          )";
-
-      constexpr GLchar kExtractSubRectFragBody[] = R"(
-            DEFAULT_PRECISION(mediump, float)
-
-            // Provided by kExtractSubRectVertexShader.
-            in vec2 sample_coordinate;
-
-            uniform sampler2D input_texture;
-            uniform float alpha;
-            uniform float beta;
-
-            #ifdef GL_ES
-              #define fragColor gl_FragColor
-            #else
-              out vec4 fragColor;
-            #endif  // defined(GL_ES);
-
-            void main() {
-              vec4 color = texture2D(input_texture, sample_coordinate);
-            #ifdef CUSTOM_ZERO_BORDER_MODE
-              float out_of_bounds =
-                  float(sample_coordinate.x < 0.0 || sample_coordinate.x > 1.0 ||
-                        sample_coordinate.y < 0.0 || sample_coordinate.y > 1.0);
-              color = mix(color, vec4(0.0, 0.0, 0.0, 0.0), out_of_bounds);
-            #endif  // defined(CUSTOM_ZERO_BORDER_MODE)
-              fragColor = alpha * color + beta;
-            }
-          )";
-
-      std::string starts_at_bottom_def;
-      if (input_starts_at_bottom) {
-        starts_at_bottom_def = R"(
-          #define INPUT_STARTS_AT_BOTTOM
-        )";
-      }
-
-      // Create program and set parameters.
-      const std::string extract_sub_rect_vertex_src =
-          absl::StrCat(mediapipe::kMediaPipeVertexShaderPreamble,
-                       starts_at_bottom_def, kExtractSubRectVertexShader);
-
-      std::string custom_zero_border_mode_def;
-      if (use_custom_zero_border_) {
-        custom_zero_border_mode_def = R"(
-          #define CUSTOM_ZERO_BORDER_MODE
-        )";
-      }
-      const std::string extract_sub_rect_frag_src =
-          absl::StrCat(mediapipe::kMediaPipeFragmentShaderPreamble,
-                       custom_zero_border_mode_def, kExtractSubRectFragBody);
-      mediapipe::GlhCreateProgram(extract_sub_rect_vertex_src.c_str(),
-                                  extract_sub_rect_frag_src.c_str(),
-                                  kNumAttributes, &attr_name[0], attr_location,
-                                  &program_);
-
-      RET_CHECK(program_) << "Problem initializing image to tensor program.";
-      glUseProgram(program_);
-      glUniform1i(glGetUniformLocation(program_, "input_texture"), 1);
-      alpha_id_ = glGetUniformLocation(program_, "alpha");
-      beta_id_ = glGetUniformLocation(program_, "beta");
-      matrix_id_ = glGetUniformLocation(program_, "transform_matrix");
-
-      glGenFramebuffers(1, &framebuffer_);
-
-      // vertex storage
-      glGenBuffers(2, vbo_);
-      glGenVertexArrays(1, &vao_);
-
-      // vbo 0
-      glBindBuffer(GL_ARRAY_BUFFER, vbo_[0]);
-      glBufferData(GL_ARRAY_BUFFER, sizeof(mediapipe::kBasicSquareVertices),
-                   mediapipe::kBasicSquareVertices, GL_STATIC_DRAW);
-
-      // vbo 1
-      glBindBuffer(GL_ARRAY_BUFFER, vbo_[1]);
-      glBufferData(GL_ARRAY_BUFFER, sizeof(mediapipe::kBasicTextureVertices),
-                   mediapipe::kBasicTextureVertices, GL_STATIC_DRAW);
-
-      glBindBuffer(GL_ARRAY_BUFFER, 0);
-
+      const bool use_custom_zero_border = use_custom_zero_border_;
+      ASSIGN_OR_RETURN(
+          resources_,
+          GetSharedGlObject<GlProcessorResources>(
+              gl_helper_.GetGlContext(),
+              absl::StrCat(input_starts_at_bottom, ":", use_custom_zero_border),
+              [input_starts_at_bottom, use_custom_zero_border]() {
+                return CreateGlProcessorResources(input_starts_at_bottom,
+                                                  use_custom_zero_border);
+              }));
       return absl::OkStatus();
     });
   }
@@ -215,7 +252,7 @@ class GlProcessor : public ImageToTensorConverter {
     std::array<float, 16> transform_mat;
 
     glDisable(GL_DEPTH_TEST);
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glBindFramebuffer(GL_FRAMEBUFFER, resources_->framebuffer);
     glViewport(0, 0, output_dims.width, output_dims.height);
 
     glActiveTexture(GL_TEXTURE0);
@@ -248,9 +285,9 @@ class GlProcessor : public ImageToTensorConverter {
       }
     }
 
-    glUseProgram(program_);
-    glUniform1f(alpha_id_, alpha);
-    glUniform1f(beta_id_, beta);
+    glUseProgram(resources_->program);
+    glUniform1f(resources_->alpha_id, alpha);
+    glUniform1f(resources_->beta_id, beta);
 
     // If our context is ES2, then we must use GL_FALSE for our 'transpose'
     // GLboolean in glUniformMatrix4fv, or else we'll get an INVALID_VALUE
@@ -262,24 +299,24 @@ class GlProcessor : public ImageToTensorConverter {
       GetTransposedRotatedSubRectToRectTransformMatrix(
           sub_rect, texture.width(), texture.height(), flip_horizontaly,
           &transform_mat);
-      glUniformMatrix4fv(matrix_id_, 1, GL_FALSE, transform_mat.data());
+      glUniformMatrix4fv(resources_->matrix_id, 1, GL_FALSE, transform_mat.data());
     } else {
       GetRotatedSubRectToRectTransformMatrix(sub_rect, texture.width(),
                                              texture.height(), flip_horizontaly,
                                              &transform_mat);
-      glUniformMatrix4fv(matrix_id_, 1, GL_TRUE, transform_mat.data());
+      glUniformMatrix4fv(resources_->matrix_id, 1, GL_TRUE, transform_mat.data());
     }
 
     // vao
-    glBindVertexArray(vao_);
+    glBindVertexArray(resources_->vao);
 
     // vbo 0
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_[0]);
+    glBindBuffer(GL_ARRAY_BUFFER, resources_->vbo[0]);
     glEnableVertexAttribArray(kAttribVertex);
     glVertexAttribPointer(kAttribVertex, 2, GL_FLOAT, 0, 0, nullptr);
 
     // vbo 1
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_[1]);
+    glBindBuffer(GL_ARRAY_BUFFER, resources_->vbo[1]);
     glEnableVertexAttribArray(kAttribTexturePosition);
     glVertexAttribPointer(kAttribTexturePosition, 2, GL_FLOAT, 0, 0, nullptr);
 
@@ -308,10 +345,7 @@ class GlProcessor : public ImageToTensorConverter {
   ~GlProcessor() override {
     gl_helper_.RunInGlContext([this]() {
       // Release OpenGL resources.
-      if (framebuffer_ != 0) glDeleteFramebuffers(1, &framebuffer_);
-      if (program_ != 0) glDeleteProgram(program_);
-      if (vao_ != 0) glDeleteVertexArrays(1, &vao_);
-      glDeleteBuffers(2, vbo_);
+      resources_ = nullptr;
     });
   }
 
@@ -319,13 +353,7 @@ class GlProcessor : public ImageToTensorConverter {
   mediapipe::GlCalculatorHelper gl_helper_;
   bool use_custom_zero_border_ = false;
   BorderMode border_mode_ = BorderMode::kReplicate;
-  GLuint vao_ = 0;
-  GLuint vbo_[2] = {0, 0};
-  GLuint program_ = 0;
-  GLuint framebuffer_ = 0;
-  GLint alpha_id_ = 0;
-  GLint beta_id_ = 0;
-  GLint matrix_id_ = 0;
+  std::shared_ptr<GlProcessorResources> resources_;
 };
 
 }  // namespace
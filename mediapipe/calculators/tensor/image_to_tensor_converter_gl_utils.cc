@@ -77,6 +77,19 @@ std::unique_ptr<GlOverride> OverrideGlTexParameterfv(
 template std::unique_ptr<GlOverride> OverrideGlTexParameterfv<4>(
     GLenum name, std::array<GLfloat, 4> values);
 
+namespace internal {
+
+SharedGlObjects& GetSharedGlObjects(mediapipe::GlContext& gl_context) {
+  static const auto* kSharedGlObjects =
+      new mediapipe::GlContext::Attachment<SharedGlObjects>(
+          [](mediapipe::GlContext&) {
+            return mediapipe::GlContext::Attachment<SharedGlObjects>::MakePtr();
+          });
+  return kSharedGlObjects->Get(gl_context);
+}
+
+}  // namespace internal
+
 bool IsGlClampToBorderSupported(const mediapipe::GlContext& gl_context) {
   return gl_context.gl_major_version() > 3 ||
          (gl_context.gl_major_version() == 3 &&
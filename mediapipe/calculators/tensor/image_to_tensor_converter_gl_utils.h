@@ -6,10 +6,16 @@
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30
 
 #include <array>
+#include <functional>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/framework/port/statusor.h"
+#include "mediapipe/framework/tool/type_util.h"
 #include "mediapipe/gpu/gl_base.h"
 #include "mediapipe/gpu/gl_context.h"
 
@@ -38,6 +44,41 @@ ABSL_MUST_USE_RESULT std::unique_ptr<GlOverride> OverrideGlTexParameterfv(
 
 bool IsGlClampToBorderSupported(const mediapipe::GlContext& gl_context);
 
+namespace internal {
+
+// The objects shared on a GlContext, by type and key.
+using SharedGlObjects =
+    absl::flat_hash_map<std::pair<TypeId, std::string>, std::weak_ptr<void>>;
+
+SharedGlObjects& GetSharedGlObjects(mediapipe::GlContext& gl_context);
+
+}  // namespace internal
+
+// Returns the object of type T that the converters passing the same @key share
+// on @gl_context, and creates it with @create if none of them holds it. This
+// lets ImageToTensor nodes with the same configuration share their programs
+// and framebuffers. The object is destroyed with its last holder, which must
+// release it while @gl_context is current. Must be called while @gl_context is
+// current.
+template <typename T>
+absl::StatusOr<std::shared_ptr<T>> GetSharedGlObject(
+    mediapipe::GlContext& gl_context, const std::string& key,
+    const std::function<absl::StatusOr<std::unique_ptr<T>>()>& create) {
+  internal::SharedGlObjects& objects = internal::GetSharedGlObjects(gl_context);
+  std::weak_ptr<void>& entry = objects[{kTypeId<T>, key}];
+  if (auto object = std::static_pointer_cast<T>(entry.lock())) {
+    return object;
+  }
+  ASSIGN_OR_RETURN(std::unique_ptr<T> created, create());
+  std::shared_ptr<T> object = std::move(created);
+  entry = object;
+  // Forgets the objects whose holders are all gone.
+  absl::erase_if(objects, [](const auto& key_and_object) {
+    return key_and_object.second.expired();
+  });
+  return object;
+}
+
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30
@@ -3,6 +3,9 @@
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30
 
 #include "mediapipe/calculators/tensor/image_to_tensor_converter_gl_utils.h"
+
+#include <memory>
+
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/status_matchers.h"
 #include "mediapipe/gpu/gl_base.h"
@@ -43,6 +46,35 @@ TEST(ImageToTensorConverterGlUtilsTest, GlTexParameteriOverrider) {
               testing::ElementsAre(GL_NEAREST, GL_LINEAR, GL_NEAREST));
 }
 
+TEST(ImageToTensorConverterGlUtilsTest, GetSharedGlObject) {
+  auto status_or_context = mediapipe::GlContext::Create(nullptr, false);
+  MP_ASSERT_OK(status_or_context);
+  auto context = status_or_context.value();
+
+  int num_created = 0;
+  auto create = [&num_created]() -> absl::StatusOr<std::unique_ptr<int>> {
+    return std::make_unique<int>(++num_created);
+  };
+  MP_ASSERT_OK(context->Run([&]() -> absl::Status {
+    ASSIGN_OR_RETURN(auto first,
+                     GetSharedGlObject<int>(*context, "a", create));
+    ASSIGN_OR_RETURN(auto same,
+                     GetSharedGlObject<int>(*context, "a", create));
+    ASSIGN_OR_RETURN(auto other,
+                     GetSharedGlObject<int>(*context, "b", create));
+    EXPECT_EQ(first, same);
+    EXPECT_EQ(*other, 2);
+
+    // Released objects are created again.
+    first = nullptr;
+    same = nullptr;
+    ASSIGN_OR_RETURN(auto recreated,
+                     GetSharedGlObject<int>(*context, "a", create));
+    EXPECT_EQ(*recreated, 3);
+    return absl::OkStatus();
+  }));
+}
+
 }  // namespace
 }  // namespace mediapipe
 
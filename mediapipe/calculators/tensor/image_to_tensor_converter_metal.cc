@@ -98,6 +98,22 @@ constexpr char kFragmentShader[] = R"(
   #define Type float
   #endif  // OUTPUT_F32C4
 
+  // Quantized outputs sample the texture as floats and round the transformed
+  // values, which alpha and beta map to the quantized range, into the type.
+  #ifdef OUTPUT_U8C4
+  #define Type4 uint4
+  #define Type float
+  #define QUANTIZED_MIN 0.0
+  #define QUANTIZED_MAX 255.0
+  #endif  // OUTPUT_U8C4
+
+  #ifdef OUTPUT_I8C4
+  #define Type4 int4
+  #define Type float
+  #define QUANTIZED_MIN -128.0
+  #define QUANTIZED_MAX 127.0
+  #endif  // OUTPUT_I8C4
+
   fragment Type4 fragmentShader(TextureVertex vertex_output [[stage_in]],
                                   texture2d<Type> texture [[texture(0)]],
                                   constant float* parameters [[buffer(1)]])
@@ -115,12 +131,19 @@ constexpr char kFragmentShader[] = R"(
       mag_filter::linear);
     #endif  // CLAMP_TO_EDGE
 
+    #ifdef QUANTIZED_MIN
+    float4 texture_pixel = texture.sample(linear_sampler, vertex_output.uv);
+    float3 value = clamp(round(alpha * texture_pixel.rgb + beta),
+                         QUANTIZED_MIN, QUANTIZED_MAX);
+    return Type4(float4(value, 0));
+    #else
     Type4 texture_pixel = texture.sample(linear_sampler, vertex_output.uv);
     return Type4(alpha * texture_pixel.rgb + beta, 0);
+    #endif  // QUANTIZED_MIN
   }
 )";
 
-enum class OutputFormat { kF16C4, kF32C4 };
+enum class OutputFormat { kF16C4, kF32C4, kU8C4, kI8C4 };
 
 MTLPixelFormat GetPixelFormat(OutputFormat output_format) {
   switch (output_format) {
@@ -128,6 +151,10 @@ MTLPixelFormat GetPixelFormat(OutputFormat output_format) {
       return MTLPixelFormatRGBA16Float;
     case OutputFormat::kF32C4:
       return MTLPixelFormatRGBA32Float;
+    case OutputFormat::kU8C4:
+      return MTLPixelFormatRGBA8Uint;
+    case OutputFormat::kI8C4:
+      return MTLPixelFormatRGBA8Sint;
   }
 }
 int GetBytesPerRaw(OutputFormat output_format, const tflite::gpu::HW& size) {
@@ -139,6 +166,10 @@ int GetBytesPerRaw(OutputFormat output_format, const tflite::gpu::HW& size) {
     case OutputFormat::kF32C4:
       type_size = sizeof(float);
       break;
+    case OutputFormat::kU8C4:
+    case OutputFormat::kI8C4:
+      type_size = sizeof(uint8_t);
+      break;
   }
   constexpr int kNumChannels = 4;
   return size.w * kNumChannels * type_size;
@@ -274,6 +305,16 @@ class SubRectExtractorMetal {
           #define OUTPUT_F32C4
         )";
         break;
+      case OutputFormat::kU8C4:
+        output_type_def = R"(
+          #define OUTPUT_U8C4
+        )";
+        break;
+      case OutputFormat::kI8C4:
+        output_type_def = R"(
+          #define OUTPUT_I8C4
+        )";
+        break;
     }
 
     std::string clamp_def;
@@ -339,12 +380,32 @@ class SubRectExtractorMetal {
 
 class MetalProcessor : public ImageToTensorConverter {
  public:
-  absl::Status Init(CalculatorContext* cc, BorderMode border_mode) {
+  absl::Status Init(CalculatorContext* cc, BorderMode border_mode,
+                    Tensor::ElementType tensor_type,
+                    const Tensor::QuantizationParameters& quantization) {
+    tensor_type_ = tensor_type;
+    quantization_ = quantization;
+    OutputFormat output_format;
+    switch (tensor_type) {
+      case Tensor::ElementType::kFloat32:
+        output_format = OutputFormat::kF32C4;
+        break;
+      case Tensor::ElementType::kUInt8:
+        output_format = OutputFormat::kU8C4;
+        break;
+      case Tensor::ElementType::kInt8:
+        output_format = OutputFormat::kI8C4;
+        break;
+      default:
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Tensor type is currently not supported by MetalProcessor, type: ",
+            tensor_type));
+    }
     metal_helper_ = [[MPPMetalHelper alloc] initWithCalculatorContext:cc];
     RET_CHECK(metal_helper_);
     ASSIGN_OR_RETURN(extractor_, SubRectExtractorMetal::Make(
-                                     metal_helper_.mtlDevice,
-                                     OutputFormat::kF32C4, border_mode));
+                                     metal_helper_.mtlDevice, output_format,
+                                     border_mode));
     return absl::OkStatus();
   }
 
@@ -365,9 +426,10 @@ class MetalProcessor : public ImageToTensorConverter {
           [metal_helper_ metalTextureWithGpuBuffer:input.GetGpuBuffer()];
 
       constexpr int kNumChannels = 4;
-      Tensor tensor(Tensor::ElementType::kFloat32,
+      Tensor tensor(tensor_type_,
                     Tensor::Shape{1, output_dims.height, output_dims.width,
-                                  kNumChannels});
+                                  kNumChannels},
+                    quantization_);
 
       constexpr float kInputImageRangeMin = 0.0f;
       constexpr float kInputImageRangeMax = 1.0f;
@@ -391,14 +453,18 @@ class MetalProcessor : public ImageToTensorConverter {
  private:
   MPPMetalHelper* metal_helper_ = nil;
   std::unique_ptr<SubRectExtractorMetal> extractor_;
+  Tensor::ElementType tensor_type_ = Tensor::ElementType::kFloat32;
+  Tensor::QuantizationParameters quantization_;
 };
 
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<ImageToTensorConverter>> CreateMetalConverter(
-    CalculatorContext* cc, BorderMode border_mode) {
+    CalculatorContext* cc, BorderMode border_mode,
+    Tensor::ElementType tensor_type,
+    const Tensor::QuantizationParameters& quantization) {
   auto result = absl::make_unique<MetalProcessor>();
-  MP_RETURN_IF_ERROR(result->Init(cc, border_mode));
+  MP_RETURN_IF_ERROR(result->Init(cc, border_mode, tensor_type, quantization));
 
   return result;
 }
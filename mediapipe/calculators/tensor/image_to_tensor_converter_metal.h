@@ -28,10 +28,14 @@
 namespace mediapipe {
 
 // Creates Metal image-to-tensor converter.
+// @tensor_type is kFloat32, kUInt8 or kInt8; @quantization is attached to
+// uint8 and int8 output tensors.
 // NOTE: [MPPMetalHelper updateContract:...] invocation must precede
 // converter creation.
 absl::StatusOr<std::unique_ptr<ImageToTensorConverter>> CreateMetalConverter(
-    CalculatorContext* cc, BorderMode border_mode);
+    CalculatorContext* cc, BorderMode border_mode,
+    Tensor::ElementType tensor_type,
+    const Tensor::QuantizationParameters& quantization);
 
 }  // namespace mediapipe
 
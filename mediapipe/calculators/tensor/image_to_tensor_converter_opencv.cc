@@ -16,6 +16,7 @@
 
 #include <cmath>
 #include <memory>
+#include <vector>
 
 #include "mediapipe/calculators/tensor/image_to_tensor_converter.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
@@ -35,8 +36,9 @@ namespace {
 
 class OpenCvProcessor : public ImageToTensorConverter {
  public:
-  OpenCvProcessor(BorderMode border_mode, Tensor::ElementType tensor_type)
-      : tensor_type_(tensor_type) {
+  OpenCvProcessor(BorderMode border_mode, Tensor::ElementType tensor_type,
+                  const Tensor::QuantizationParameters& quantization)
+      : tensor_type_(tensor_type), quantization_(quantization) {
     switch (border_mode) {
       case BorderMode::kReplicate:
         border_mode_ = cv::BORDER_REPLICATE;
@@ -64,6 +66,13 @@ class OpenCvProcessor : public ImageToTensorConverter {
                                  const RotatedRect& roi,
                                  const Size& output_dims, float range_min,
                                  float range_max) override {
+    return ConvertBatch(input, {roi}, output_dims, range_min, range_max);
+  }
+
+  absl::StatusOr<Tensor> ConvertBatch(const mediapipe::Image& input,
+                                      const std::vector<RotatedRect>& rois,
+                                      const Size& output_dims, float range_min,
+                                      float range_max) override {
     if (input.image_format() != mediapipe::ImageFormat::SRGB &&
         input.image_format() != mediapipe::ImageFormat::SRGBA) {
       return InvalidArgumentError(
@@ -73,28 +82,52 @@ class OpenCvProcessor : public ImageToTensorConverter {
     auto src = mediapipe::formats::MatView(&input);
 
     constexpr int kNumChannels = 3;
-    Tensor tensor(tensor_type_, Tensor::Shape{1, output_dims.height,
-                                              output_dims.width, kNumChannels});
+    Tensor tensor(tensor_type_,
+                  Tensor::Shape{static_cast<int>(rois.size()),
+                                output_dims.height, output_dims.width,
+                                kNumChannels},
+                  quantization_);
     auto buffer_view = tensor.GetCpuWriteView();
-    cv::Mat dst;
-    switch (tensor_type_) {
-      case Tensor::ElementType::kInt8:
-        dst = cv::Mat(output_dims.height, output_dims.width, mat_type_,
-                      buffer_view.buffer<int8>());
-        break;
-      case Tensor::ElementType::kFloat32:
-        dst = cv::Mat(output_dims.height, output_dims.width, mat_type_,
-                      buffer_view.buffer<float>());
-        break;
-      case Tensor::ElementType::kUInt8:
-        dst = cv::Mat(output_dims.height, output_dims.width, mat_type_,
-                      buffer_view.buffer<uint8>());
-        break;
-      default:
-        return InvalidArgumentError(
-            absl::StrCat("Unsupported tensor type: ", tensor_type_));
+    const int item_size = output_dims.height * output_dims.width * kNumChannels;
+
+    constexpr float kInputImageRangeMin = 0.0f;
+    constexpr float kInputImageRangeMax = 255.0f;
+    ASSIGN_OR_RETURN(
+        auto transform,
+        GetValueRangeTransformation(kInputImageRangeMin, kInputImageRangeMax,
+                                    range_min, range_max));
+
+    for (int i = 0; i < rois.size(); ++i) {
+      // Each region is written straight into its item of the batch.
+      cv::Mat dst;
+      switch (tensor_type_) {
+        case Tensor::ElementType::kInt8:
+          dst = cv::Mat(output_dims.height, output_dims.width, mat_type_,
+                        buffer_view.buffer<int8>() + i * item_size);
+          break;
+        case Tensor::ElementType::kFloat32:
+          dst = cv::Mat(output_dims.height, output_dims.width, mat_type_,
+                        buffer_view.buffer<float>() + i * item_size);
+          break;
+        case Tensor::ElementType::kUInt8:
+          dst = cv::Mat(output_dims.height, output_dims.width, mat_type_,
+                        buffer_view.buffer<uint8>() + i * item_size);
+          break;
+        default:
+          return InvalidArgumentError(
+              absl::StrCat("Unsupported tensor type: ", tensor_type_));
+      }
+      ExtractRoi(*src, rois[i], output_dims, transform, dst);
     }
+    return tensor;
+  }
 
+ private:
+  // Warps @roi of @src into @dst, transforming the values into the output
+  // range.
+  void ExtractRoi(const cv::Mat& src, const RotatedRect& roi,
+                  const Size& output_dims,
+                  const ValueTransformation& transform, cv::Mat& dst) {
     const cv::RotatedRect rotated_rect(cv::Point2f(roi.center_x, roi.center_y),
                                        cv::Size2f(roi.width, roi.height),
                                        roi.rotation * 180.f / M_PI);
@@ -114,30 +147,23 @@ class OpenCvProcessor : public ImageToTensorConverter {
     cv::Mat projection_matrix =
         cv::getPerspectiveTransform(src_points, dst_points);
     cv::Mat transformed;
-    cv::warpPerspective(*src, transformed, projection_matrix,
+    cv::warpPerspective(src, transformed, projection_matrix,
                         cv::Size(dst_width, dst_height),
                         /*flags=*/cv::INTER_LINEAR,
                         /*borderMode=*/border_mode_);
 
-    if (transformed.channels() > kNumChannels) {
+    if (transformed.channels() > dst.channels()) {
       cv::Mat proper_channels_mat;
       cv::cvtColor(transformed, proper_channels_mat, cv::COLOR_RGBA2RGB);
       transformed = proper_channels_mat;
     }
 
-    constexpr float kInputImageRangeMin = 0.0f;
-    constexpr float kInputImageRangeMax = 255.0f;
-    ASSIGN_OR_RETURN(
-        auto transform,
-        GetValueRangeTransformation(kInputImageRangeMin, kInputImageRangeMax,
-                                    range_min, range_max));
     transformed.convertTo(dst, mat_type_, transform.scale, transform.offset);
-    return tensor;
   }
 
- private:
   enum cv::BorderTypes border_mode_;
   Tensor::ElementType tensor_type_;
+  Tensor::QuantizationParameters quantization_;
   int mat_type_;
 };
 
@@ -145,7 +171,8 @@ class OpenCvProcessor : public ImageToTensorConverter {
 
 absl::StatusOr<std::unique_ptr<ImageToTensorConverter>> CreateOpenCvConverter(
     CalculatorContext* cc, BorderMode border_mode,
-    Tensor::ElementType tensor_type) {
+    Tensor::ElementType tensor_type,
+    const Tensor::QuantizationParameters& quantization) {
   if (tensor_type != Tensor::ElementType::kInt8 &&
       tensor_type != Tensor::ElementType::kFloat32 &&
       tensor_type != Tensor::ElementType::kUInt8) {
@@ -153,7 +180,8 @@ absl::StatusOr<std::unique_ptr<ImageToTensorConverter>> CreateOpenCvConverter(
         "Tensor type is currently not supported by OpenCvProcessor, type: ",
         tensor_type));
   }
-  return absl::make_unique<OpenCvProcessor>(border_mode, tensor_type);
+  return absl::make_unique<OpenCvProcessor>(border_mode, tensor_type,
+                                            quantization);
 }
 
 }  // namespace mediapipe
@@ -24,9 +24,11 @@
 namespace mediapipe {
 
 // Creates OpenCV image-to-tensor converter.
+// @quantization is attached to uint8 and int8 output tensors.
 absl::StatusOr<std::unique_ptr<ImageToTensorConverter>> CreateOpenCvConverter(
     CalculatorContext* cc, BorderMode border_mode,
-    Tensor::ElementType tensor_type);
+    Tensor::ElementType tensor_type,
+    const Tensor::QuantizationParameters& quantization);
 
 }  // namespace mediapipe
 
@@ -0,0 +1,202 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/inference_batcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+
+namespace {
+
+// The process-wide registry of shared batchers, keyed by name.
+class InferenceBatcherRegistry {
+ public:
+  static InferenceBatcherRegistry& Get() {
+    static auto* registry = new InferenceBatcherRegistry();
+    return *registry;
+  }
+
+  absl::Mutex mutex;
+  absl::flat_hash_map<std::string, std::weak_ptr<InferenceBatcher>> batchers
+      ABSL_GUARDED_BY(mutex);
+};
+
+// Concatenates the inputs of `requests` along their first dimension.
+absl::StatusOr<std::vector<Tensor>> ConcatenateInputs(
+    const std::vector<const std::vector<Tensor>*>& requests) {
+  const std::vector<Tensor>& first = *requests[0];
+  RET_CHECK(!first.empty());
+  std::vector<Tensor> batched;
+  batched.reserve(first.size());
+  for (int i = 0; i < first.size(); ++i) {
+    std::vector<int> dims = first[i].shape().dims;
+    RET_CHECK(!dims.empty()) << "Batched input " << i << " has no dimensions.";
+    dims[0] = 0;
+    for (const std::vector<Tensor>* inputs : requests) {
+      RET_CHECK_EQ(inputs->size(), first.size());
+      const Tensor& input = (*inputs)[i];
+      const std::vector<int>& input_dims = input.shape().dims;
+      RET_CHECK(input.element_type() == first[i].element_type());
+      RET_CHECK(input_dims.size() == dims.size() &&
+                std::equal(input_dims.begin() + 1, input_dims.end(),
+                           dims.begin() + 1))
+          << "Batched inputs " << i << " differ in shape.";
+      dims[0] += input_dims[0];
+    }
+    batched.emplace_back(first[i].element_type(), Tensor::Shape(dims),
+                         first[i].quantization_parameters());
+    auto batched_view = batched.back().GetCpuWriteView();
+    char* dst = batched_view.buffer<char>();
+    for (const std::vector<Tensor>* inputs : requests) {
+      const Tensor& input = (*inputs)[i];
+      std::memcpy(dst, input.GetCpuReadView().buffer<char>(), input.bytes());
+      dst += input.bytes();
+    }
+  }
+  return batched;
+}
+
+// Splits `batched` along its first dimension into parts of `batch_sizes`.
+absl::StatusOr<std::vector<std::vector<Tensor>>> SplitOutputs(
+    const std::vector<Tensor>& batched, const std::vector<int>& batch_sizes) {
+  int total_batch_size = 0;
+  for (int batch_size : batch_sizes) total_batch_size += batch_size;
+  std::vector<std::vector<Tensor>> outputs(batch_sizes.size());
+  for (int i = 0; i < batched.size(); ++i) {
+    std::vector<int> dims = batched[i].shape().dims;
+    RET_CHECK(!dims.empty() && dims[0] == total_batch_size)
+        << "Output " << i << " does not have the batch size as its first "
+        << "dimension.";
+    const int item_bytes = batched[i].bytes() / total_batch_size;
+    auto batched_view = batched[i].GetCpuReadView();
+    const char* src = batched_view.buffer<char>();
+    for (int r = 0; r < batch_sizes.size(); ++r) {
+      dims[0] = batch_sizes[r];
+      outputs[r].emplace_back(batched[i].element_type(), Tensor::Shape(dims),
+                              batched[i].quantization_parameters());
+      const int bytes = item_bytes * batch_sizes[r];
+      std::memcpy(outputs[r].back().GetCpuWriteView().buffer<char>(), src,
+                  bytes);
+      src += bytes;
+    }
+  }
+  return outputs;
+}
+
+}  // namespace
+
+InferenceBatcher::InferenceBatcher(std::unique_ptr<InferenceRunner> runner,
+                                   const Options& options)
+    : runner_(std::move(runner)), options_(options) {}
+
+// static
+absl::StatusOr<std::shared_ptr<InferenceBatcher>> InferenceBatcher::GetOrCreate(
+    const std::string& name, const Options& options,
+    const std::function<absl::StatusOr<std::unique_ptr<InferenceRunner>>()>&
+        create_runner) {
+  RET_CHECK_GT(options.max_batch_size, 0);
+  InferenceBatcherRegistry& registry = InferenceBatcherRegistry::Get();
+  absl::MutexLock lock(&registry.mutex);
+  std::shared_ptr<InferenceBatcher> batcher = registry.batchers[name].lock();
+  if (batcher) {
+    return batcher;
+  }
+  ASSIGN_OR_RETURN(std::unique_ptr<InferenceRunner> runner, create_runner());
+  batcher = std::make_shared<InferenceBatcher>(std::move(runner), options);
+  registry.batchers[name] = batcher;
+  return batcher;
+}
+
+absl::StatusOr<std::vector<Tensor>> InferenceBatcher::Run(
+    const std::vector<Tensor>& inputs) {
+  Request request;
+  request.inputs = &inputs;
+  request.deadline = absl::Now() + options_.max_wait;
+
+  mutex_.Lock();
+  pending_.push_back(&request);
+  cond_var_.SignalAll();
+  while (!request.done) {
+    const bool batch_ready =
+        !pending_.empty() &&
+        (pending_.size() >= options_.max_batch_size ||
+         absl::Now() >= pending_.front()->deadline);
+    if (!running_ && batch_ready) {
+      // This thread runs the oldest pending requests, which need not include
+      // its own.
+      std::vector<Request*> batch;
+      while (!pending_.empty() && batch.size() < options_.max_batch_size) {
+        batch.push_back(pending_.front());
+        pending_.pop_front();
+      }
+      running_ = true;
+      mutex_.Unlock();
+      RunBatch(batch);
+      mutex_.Lock();
+      running_ = false;
+      for (Request* batch_request : batch) {
+        batch_request->done = true;
+      }
+      cond_var_.SignalAll();
+    } else if (running_ || pending_.empty()) {
+      cond_var_.Wait(&mutex_);
+    } else {
+      cond_var_.WaitWithDeadline(&mutex_, pending_.front()->deadline);
+    }
+  }
+  mutex_.Unlock();
+  return std::move(request.outputs);
+}
+
+void InferenceBatcher::RunBatch(const std::vector<Request*>& batch) {
+  if (batch.size() == 1) {
+    batch[0]->outputs = runner_->Run(*batch[0]->inputs);
+    return;
+  }
+  std::vector<const std::vector<Tensor>*> inputs;
+  for (Request* request : batch) {
+    inputs.push_back(request->inputs);
+  }
+  absl::StatusOr<std::vector<std::vector<Tensor>>> outputs =
+      [&]() -> absl::StatusOr<std::vector<std::vector<Tensor>>> {
+    ASSIGN_OR_RETURN(std::vector<Tensor> batched_inputs,
+                     ConcatenateInputs(inputs));
+    // The inputs are known to be non-empty and of matching ranks here.
+    std::vector<int> batch_sizes;
+    for (const std::vector<Tensor>* request_inputs : inputs) {
+      batch_sizes.push_back(request_inputs->front().shape().dims[0]);
+    }
+    ASSIGN_OR_RETURN(std::vector<Tensor> batched_outputs,
+                     runner_->Run(batched_inputs));
+    return SplitOutputs(batched_outputs, batch_sizes);
+  }();
+  for (int i = 0; i < batch.size(); ++i) {
+    if (outputs.ok()) {
+      batch[i]->outputs = std::move((*outputs)[i]);
+    } else {
+      batch[i]->outputs = outputs.status();
+    }
+  }
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,89 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_BATCHER_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_BATCHER_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/framework/formats/tensor.h"
+
+namespace mediapipe {
+
+// An InferenceRunner that collects concurrent Run() calls into batches.
+//
+// Callers block in Run() until their request has been run. Pending requests
+// are run together once `max_batch_size` of them are pending, or once the
+// oldest of them has waited for `max_wait`. The requests of a batch are
+// concatenated along the first dimension of each input tensor and run through
+// the wrapped runner in a single call; its outputs are split along their first
+// dimension and handed back to the callers. Batches run one at a time, on the
+// thread of one of their callers, so the wrapped runner needs no locking.
+//
+// All requests of a batch must have the same number of inputs, with the same
+// element types and the same shapes apart from the first dimension. Every
+// output of the wrapped runner must have a first dimension equal to the
+// batch size, i.e. the sum of the first input dimensions of the requests.
+class InferenceBatcher : public InferenceRunner {
+ public:
+  struct Options {
+    int max_batch_size = 8;
+    absl::Duration max_wait = absl::Milliseconds(1);
+  };
+
+  InferenceBatcher(std::unique_ptr<InferenceRunner> runner,
+                   const Options& options);
+
+  // Returns the batcher shared under `name` in this process, creating it with
+  // `create_runner` and `options` if there is none. The batcher is destroyed
+  // together with its last user.
+  static absl::StatusOr<std::shared_ptr<InferenceBatcher>> GetOrCreate(
+      const std::string& name, const Options& options,
+      const std::function<absl::StatusOr<std::unique_ptr<InferenceRunner>>()>&
+          create_runner);
+
+  absl::StatusOr<std::vector<Tensor>> Run(
+      const std::vector<Tensor>& inputs) override;
+
+ private:
+  struct Request {
+    const std::vector<Tensor>* inputs;
+    absl::Time deadline;
+    absl::StatusOr<std::vector<Tensor>> outputs;
+    bool done = false;
+  };
+
+  // Runs `batch` through `runner_` and fills in the outputs of its requests.
+  void RunBatch(const std::vector<Request*>& batch);
+
+  const std::unique_ptr<InferenceRunner> runner_;
+  const Options options_;
+
+  absl::Mutex mutex_;
+  absl::CondVar cond_var_;
+  std::deque<Request*> pending_ ABSL_GUARDED_BY(mutex_);
+  bool running_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_BATCHER_H_
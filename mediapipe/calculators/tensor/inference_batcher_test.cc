@@ -0,0 +1,165 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/inference_batcher.h"
+
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Doubles its single float input and records the batch sizes it ran.
+class DoublingRunner : public InferenceRunner {
+ public:
+  explicit DoublingRunner(std::vector<int>* batch_sizes)
+      : batch_sizes_(batch_sizes) {}
+
+  absl::StatusOr<std::vector<Tensor>> Run(
+      const std::vector<Tensor>& inputs) override {
+    const Tensor& input = inputs[0];
+    batch_sizes_->push_back(input.shape().dims[0]);
+    std::vector<Tensor> outputs;
+    outputs.emplace_back(Tensor::ElementType::kFloat32, input.shape());
+    auto input_view = input.GetCpuReadView();
+    auto output_view = outputs[0].GetCpuWriteView();
+    for (int i = 0; i < input.shape().num_elements(); ++i) {
+      output_view.buffer<float>()[i] = 2.0f * input_view.buffer<float>()[i];
+    }
+    return outputs;
+  }
+
+ private:
+  std::vector<int>* batch_sizes_;
+};
+
+std::vector<Tensor> MakeInput(int batch_size, float value) {
+  std::vector<Tensor> inputs;
+  inputs.emplace_back(Tensor::ElementType::kFloat32,
+                      Tensor::Shape{batch_size, 2});
+  auto view = inputs[0].GetCpuWriteView();
+  for (int i = 0; i < batch_size * 2; ++i) {
+    view.buffer<float>()[i] = value + i;
+  }
+  return inputs;
+}
+
+std::vector<float> GetValues(const Tensor& tensor) {
+  auto view = tensor.GetCpuReadView();
+  const float* buffer = view.buffer<float>();
+  return std::vector<float>(buffer, buffer + tensor.shape().num_elements());
+}
+
+TEST(InferenceBatcherTest, RunsSingleRequest) {
+  std::vector<int> batch_sizes;
+  InferenceBatcher batcher(std::make_unique<DoublingRunner>(&batch_sizes),
+                           {/*max_batch_size=*/4, absl::ZeroDuration()});
+
+  MP_ASSERT_OK_AND_ASSIGN(std::vector<Tensor> outputs,
+                          batcher.Run(MakeInput(1, 1.0f)));
+
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_THAT(outputs[0].shape().dims, ElementsAre(1, 2));
+  EXPECT_THAT(GetValues(outputs[0]), ElementsAre(2.0f, 4.0f));
+  EXPECT_THAT(batch_sizes, ElementsAre(1));
+}
+
+TEST(InferenceBatcherTest, BatchesConcurrentRequests) {
+  constexpr int kNumRequests = 4;
+  std::vector<int> batch_sizes;
+  // A full batch is run long before the wait expires.
+  InferenceBatcher batcher(std::make_unique<DoublingRunner>(&batch_sizes),
+                           {kNumRequests, absl::Seconds(60)});
+
+  std::vector<std::vector<Tensor>> outputs(kNumRequests);
+  std::vector<std::thread> threads;
+  for (int r = 0; r < kNumRequests; ++r) {
+    threads.emplace_back([&batcher, &outputs, r]() {
+      // Request r has batch size r + 1.
+      auto result = batcher.Run(MakeInput(r + 1, 10.0f * r));
+      MP_ASSERT_OK(result);
+      outputs[r] = std::move(*result);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_THAT(batch_sizes, ElementsAre(1 + 2 + 3 + 4));
+  for (int r = 0; r < kNumRequests; ++r) {
+    ASSERT_EQ(outputs[r].size(), 1);
+    EXPECT_THAT(outputs[r][0].shape().dims, ElementsAre(r + 1, 2));
+    const std::vector<float> values = GetValues(outputs[r][0]);
+    for (int i = 0; i < values.size(); ++i) {
+      EXPECT_EQ(values[i], 2.0f * (10.0f * r + i));
+    }
+  }
+}
+
+TEST(InferenceBatcherTest, FailsBatchWithMismatchedShapes) {
+  std::vector<int> batch_sizes;
+  InferenceBatcher batcher(std::make_unique<DoublingRunner>(&batch_sizes),
+                           {/*max_batch_size=*/2, absl::Seconds(60)});
+
+  absl::Status first_status;
+  std::thread thread([&batcher, &first_status]() {
+    first_status = batcher.Run(MakeInput(1, 0.0f)).status();
+  });
+  std::vector<Tensor> mismatched;
+  mismatched.emplace_back(Tensor::ElementType::kFloat32, Tensor::Shape{1, 3});
+  const absl::Status second_status = batcher.Run(mismatched).status();
+  thread.join();
+
+  EXPECT_FALSE(first_status.ok());
+  EXPECT_FALSE(second_status.ok());
+  EXPECT_TRUE(batch_sizes.empty());
+}
+
+TEST(InferenceBatcherTest, SharesBatcherByName) {
+  std::vector<int> batch_sizes;
+  int num_created = 0;
+  auto create_runner =
+      [&]() -> absl::StatusOr<std::unique_ptr<InferenceRunner>> {
+    ++num_created;
+    return std::make_unique<DoublingRunner>(&batch_sizes);
+  };
+
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto first, InferenceBatcher::GetOrCreate("model", {}, create_runner));
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto second, InferenceBatcher::GetOrCreate("model", {}, create_runner));
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto other, InferenceBatcher::GetOrCreate("other", {}, create_runner));
+  EXPECT_EQ(first, second);
+  EXPECT_NE(first, other);
+  EXPECT_EQ(num_created, 2);
+
+  // The batcher is recreated once all its users released it.
+  first.reset();
+  second.reset();
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto third, InferenceBatcher::GetOrCreate("model", {}, create_runner));
+  EXPECT_EQ(num_created, 3);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,343 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A command line utility to benchmark a TFLite model with every inference
+// delegate that MediaPipe supports, through the InferenceCalculator that
+// graphs use. Unlike the standard TFLite benchmark tool, it resolves the
+// MediaPipe custom ops. For each delegate it reports the initialization time,
+// the first and steady-state invocation latencies, the peak resident set size
+// and, for the CPU delegates, a per-op profile. For example:
+//
+//   bazel run -c opt //mediapipe/calculators/tensor:inference_benchmark --
+//     --model_path=face_detection_short_range.tflite
+//     --delegates=tflite,xnnpack,gl --xnnpack_num_threads=1,2,4
+//
+// Inputs are deterministic pseudo-random tensors shaped like the model
+// inputs. The peak resident set size is the high-water mark of the process,
+// so benchmark a single delegate per run to compare the memory use of
+// delegates.
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/calculators/tensor/inference_calculator.pb.h"
+#include "mediapipe/calculators/tensor/inference_delegate_selection.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/statusor.h"
+#include "mediapipe/util/tflite/cpu_op_resolver.h"
+#include "mediapipe/util/tflite/tflite_model_loader.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/profiling/buffered_profiler.h"
+#include "tensorflow/lite/profiling/profile_summarizer.h"
+
+#if !MEDIAPIPE_DISABLE_GPU
+#include "mediapipe/gpu/gpu_shared_data_internal.h"
+#endif  // !MEDIAPIPE_DISABLE_GPU
+
+ABSL_FLAG(std::string, model_path, "", "Path to the .tflite model.");
+ABSL_FLAG(std::string, delegates, "tflite,xnnpack",
+          "Comma-separated list of the delegates to benchmark, each one of "
+          "tflite, xnnpack, nnapi (Android only), gl or opencl.");
+ABSL_FLAG(std::string, xnnpack_num_threads, "-1",
+          "Comma-separated list of the thread counts that the xnnpack "
+          "delegate is benchmarked with. -1 lets the calculator choose.");
+ABSL_FLAG(int, num_runs, 100, "The number of timed invocations.");
+ABSL_FLAG(int, warmup_runs, 10,
+          "The number of invocations after the first one and before the timed "
+          "ones.");
+ABSL_FLAG(bool, profile_ops, true,
+          "Whether to print a per-op profile for the tflite and xnnpack "
+          "delegates.");
+
+namespace mediapipe {
+namespace {
+
+using Delegate = InferenceCalculatorOptions::Delegate;
+
+// A delegate configuration to benchmark.
+struct BenchmarkConfig {
+  std::string name;
+  Delegate delegate;
+};
+
+struct BenchmarkResult {
+  absl::Duration init_time;
+  absl::Duration first_run;
+  std::vector<absl::Duration> runs;
+  double peak_rss_mb = 0;
+};
+
+absl::StatusOr<std::vector<BenchmarkConfig>> ParseConfigs() {
+  std::vector<int> xnnpack_num_threads;
+  for (absl::string_view value :
+       absl::StrSplit(absl::GetFlag(FLAGS_xnnpack_num_threads), ',')) {
+    int num_threads;
+    RET_CHECK(absl::SimpleAtoi(value, &num_threads))
+        << "Invalid --xnnpack_num_threads value: " << value;
+    xnnpack_num_threads.push_back(num_threads);
+  }
+  std::vector<BenchmarkConfig> configs;
+  for (absl::string_view name :
+       absl::StrSplit(absl::GetFlag(FLAGS_delegates), ',')) {
+    BenchmarkConfig config;
+    config.name = std::string(name);
+    if (name == "tflite") {
+      config.delegate.mutable_tflite();
+    } else if (name == "xnnpack") {
+      for (int num_threads : xnnpack_num_threads) {
+        config.name = absl::StrCat("xnnpack/", num_threads, "t");
+        config.delegate.mutable_xnnpack()->set_num_threads(num_threads);
+        configs.push_back(config);
+      }
+      continue;
+    } else if (name == "nnapi") {
+      config.delegate.mutable_nnapi();
+    } else if (name == "gl" || name == "opencl") {
+      Delegate::Gpu* gpu = config.delegate.mutable_gpu();
+      gpu->set_use_advanced_gpu_api(true);
+      gpu->set_api(name == "gl" ? Delegate::Gpu::OPENGL
+                                : Delegate::Gpu::OPENCL);
+    } else {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unknown delegate: ", name));
+    }
+    configs.push_back(config);
+  }
+  return configs;
+}
+
+// Returns the peak resident set size of this process in MiB.
+double PeakRssMb() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+  return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+  return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+// Returns the nearest-rank percentile of sorted durations in milliseconds.
+double PercentileMs(const std::vector<absl::Duration>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  int rank = static_cast<int>(std::ceil(p / 100 * sorted.size()));
+  rank = std::min<int>(std::max(rank, 1), sorted.size());
+  return absl::ToDoubleMilliseconds(sorted[rank - 1]);
+}
+
+std::vector<Tensor> CopyTensors(const std::vector<Tensor>& tensors) {
+  std::vector<Tensor> copies;
+  for (const Tensor& tensor : tensors) {
+    copies.emplace_back(tensor.element_type(), tensor.shape(),
+                        tensor.quantization_parameters());
+    auto read_view = tensor.GetCpuReadView();
+    auto write_view = copies.back().GetCpuWriteView();
+    std::memcpy(write_view.buffer<void>(), read_view.buffer<void>(),
+                tensor.bytes());
+  }
+  return copies;
+}
+
+// Runs the model through a graph of a single InferenceCalculator that uses
+// the delegate of `config`.
+absl::StatusOr<BenchmarkResult> RunBenchmark(
+    const BenchmarkConfig& config, const std::vector<Tensor>& inputs) {
+  CalculatorGraphConfig graph_config;
+  graph_config.add_input_stream("tensors");
+  graph_config.add_output_stream("output");
+  CalculatorGraphConfig::Node* node = graph_config.add_node();
+  node->set_calculator("InferenceCalculator");
+  node->add_input_stream("TENSORS:tensors");
+  node->add_output_stream("TENSORS:output");
+  node->add_input_side_packet("OP_RESOLVER:op_resolver");
+  auto* options = node->mutable_options()->MutableExtension(
+      InferenceCalculatorOptions::ext);
+  options->set_model_path(absl::GetFlag(FLAGS_model_path));
+  *options->mutable_delegate() = config.delegate;
+
+  CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(graph_config));
+#if !MEDIAPIPE_DISABLE_GPU
+  if (config.delegate.has_gpu()) {
+    ASSIGN_OR_RETURN(auto gpu_resources, GpuResources::Create());
+    MP_RETURN_IF_ERROR(graph.SetGpuResources(std::move(gpu_resources)));
+  }
+#endif  // !MEDIAPIPE_DISABLE_GPU
+  ASSIGN_OR_RETURN(OutputStreamPoller poller,
+                   graph.AddOutputStreamPoller("output"));
+
+  BenchmarkResult result;
+  std::unique_ptr<tflite::OpResolver> op_resolver =
+      std::make_unique<CpuOpResolver>();
+  absl::Time start = absl::Now();
+  MP_RETURN_IF_ERROR(
+      graph.StartRun({{"op_resolver", Adopt(op_resolver.release())}}));
+  // The calculator is opened, and the model loaded, once the graph is idle.
+  MP_RETURN_IF_ERROR(graph.WaitUntilIdle());
+  result.init_time = absl::Now() - start;
+
+  const int warmup_runs = absl::GetFlag(FLAGS_warmup_runs);
+  const int num_runs = absl::GetFlag(FLAGS_num_runs);
+  for (int i = 0; i < 1 + warmup_runs + num_runs; ++i) {
+    Packet input =
+        MakePacket<std::vector<Tensor>>(CopyTensors(inputs)).At(Timestamp(i));
+    start = absl::Now();
+    MP_RETURN_IF_ERROR(graph.AddPacketToInputStream("tensors", input));
+    Packet output;
+    RET_CHECK(poller.Next(&output)) << "The graph stopped before run " << i;
+    const absl::Duration latency = absl::Now() - start;
+    if (i == 0) {
+      result.first_run = latency;
+    } else if (i > warmup_runs) {
+      result.runs.push_back(latency);
+    }
+  }
+  MP_RETURN_IF_ERROR(graph.CloseAllInputStreams());
+  MP_RETURN_IF_ERROR(graph.WaitUntilDone());
+  result.peak_rss_mb = PeakRssMb();
+  return result;
+}
+
+// Prints the per-op profile of `num_runs` invocations of a plain interpreter,
+// with the XNNPACK delegate if `config` uses it. Delegated ops show up as
+// the delegate kernels that replace them.
+absl::Status PrintOpProfile(const BenchmarkConfig& config,
+                            const tflite::FlatBufferModel& model,
+                            const std::vector<Tensor>& inputs) {
+  CpuOpResolver op_resolver;
+  std::unique_ptr<tflite::Interpreter> interpreter;
+  RET_CHECK_EQ(tflite::InterpreterBuilder(model, op_resolver)(&interpreter),
+               kTfLiteOk);
+  std::unique_ptr<TfLiteDelegate, void (*)(TfLiteDelegate*)> delegate(
+      nullptr, &TfLiteXNNPackDelegateDelete);
+  if (config.delegate.has_xnnpack()) {
+    TfLiteXNNPackDelegateOptions xnnpack_options =
+        TfLiteXNNPackDelegateOptionsDefault();
+    if (config.delegate.xnnpack().num_threads() > 0) {
+      xnnpack_options.num_threads = config.delegate.xnnpack().num_threads();
+    }
+    delegate.reset(TfLiteXNNPackDelegateCreate(&xnnpack_options));
+    RET_CHECK_EQ(interpreter->ModifyGraphWithDelegate(delegate.get()),
+                 kTfLiteOk);
+  }
+  RET_CHECK_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  for (int i = 0; i < inputs.size(); ++i) {
+    TfLiteTensor* tensor = interpreter->input_tensor(i);
+    auto view = inputs[i].GetCpuReadView();
+    RET_CHECK_EQ(tensor->bytes, inputs[i].bytes());
+    std::memcpy(tensor->data.raw, view.buffer<void>(), tensor->bytes);
+  }
+  // The first invocation is excluded, as it initializes the kernels.
+  RET_CHECK_EQ(interpreter->Invoke(), kTfLiteOk);
+
+  const int num_runs = absl::GetFlag(FLAGS_num_runs);
+  tflite::profiling::BufferedProfiler profiler(
+      /*max_num_initial_entries=*/1024, /*allow_dynamic_buffer_increase=*/true);
+  interpreter->SetProfiler(&profiler);
+  tflite::profiling::ProfileSummarizer summarizer;
+  for (int i = 0; i < num_runs; ++i) {
+    profiler.Reset();
+    profiler.StartProfiling();
+    RET_CHECK_EQ(interpreter->Invoke(), kTfLiteOk);
+    profiler.StopProfiling();
+    summarizer.ProcessProfiles(profiler.GetProfileEvents(), *interpreter);
+  }
+  interpreter->SetProfiler(nullptr);
+  std::cout << "Per-op profile of " << config.name << ":\n"
+            << summarizer.GetOutputString() << "\n";
+  return absl::OkStatus();
+}
+
+void PrintResult(const BenchmarkConfig& config, BenchmarkResult& result) {
+  std::sort(result.runs.begin(), result.runs.end());
+  absl::Duration total;
+  for (absl::Duration run : result.runs) total += run;
+  std::cout << absl::StrFormat(
+      "%-14s init %9.2f ms | first %9.2f ms | mean %8.3f ms | p50 %8.3f ms "
+      "| p90 %8.3f ms | p99 %8.3f ms | peak RSS %7.1f MiB\n",
+      config.name, absl::ToDoubleMilliseconds(result.init_time),
+      absl::ToDoubleMilliseconds(result.first_run),
+      result.runs.empty()
+          ? 0
+          : absl::ToDoubleMilliseconds(total) / result.runs.size(),
+      PercentileMs(result.runs, 50), PercentileMs(result.runs, 90),
+      PercentileMs(result.runs, 99), result.peak_rss_mb);
+}
+
+absl::Status RunInferenceBenchmark() {
+  RET_CHECK(!absl::GetFlag(FLAGS_model_path).empty())
+      << "--model_path is required.";
+  RET_CHECK_GT(absl::GetFlag(FLAGS_num_runs), 0);
+  ASSIGN_OR_RETURN(std::vector<BenchmarkConfig> configs, ParseConfigs());
+  ASSIGN_OR_RETURN(api2::Packet<TfLiteModelPtr> model,
+                   TfLiteModelLoader::LoadFromPath(
+                       absl::GetFlag(FLAGS_model_path)));
+  CpuOpResolver op_resolver;
+  ASSIGN_OR_RETURN(std::vector<Tensor> inputs,
+                   CreateBenchmarkInputs(*model.Get(), op_resolver));
+
+  for (const BenchmarkConfig& config : configs) {
+    absl::StatusOr<BenchmarkResult> result = RunBenchmark(config, inputs);
+    if (!result.ok()) {
+      std::cout << absl::StrFormat("%-14s failed: %s\n", config.name,
+                                   result.status().ToString());
+      continue;
+    }
+    PrintResult(config, *result);
+  }
+  if (absl::GetFlag(FLAGS_profile_ops)) {
+    for (const BenchmarkConfig& config : configs) {
+      if (!config.delegate.has_tflite() && !config.delegate.has_xnnpack()) {
+        continue;
+      }
+      MP_RETURN_IF_ERROR(PrintOpProfile(config, *model.Get(), inputs));
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace mediapipe
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status status = mediapipe::RunInferenceBenchmark();
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to run the benchmark: " << status.message();
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
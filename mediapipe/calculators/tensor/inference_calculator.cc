@@ -14,15 +14,19 @@
 
 #include "mediapipe/calculators/tensor/inference_calculator.h"
 
+#include <cstdint>
 #include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "mediapipe/calculators/tensor/inference_calculator.pb.h"
+#include "mediapipe/calculators/tensor/inference_delegate_selection.h"
 #include "mediapipe/framework/api2/packet.h"
+#include "mediapipe/framework/mediapipe_profiling.h"
 #include "mediapipe/framework/tool/subgraph_expansion.h"
 #include "tensorflow/lite/core/api/op_resolver.h"
 
@@ -94,5 +98,47 @@ InferenceCalculator::GetOpResolverAsPacket(CalculatorContext* cc) {
           tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates>());
 }
 
+std::string InferenceCalculator::GetModelKey(CalculatorContext* cc) {
+  const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
+  if (!options.model_path().empty()) {
+    return options.model_path();
+  }
+  return absl::StrCat("model@", absl::Hex(reinterpret_cast<uintptr_t>(
+                                    kSideInModel(cc).Get().get())));
+}
+
+std::string InferenceCalculator::GetBatcherName(
+    CalculatorContext* cc, absl::string_view calculator_name) {
+  const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
+  if (!options.batching().shared_name().empty()) {
+    return absl::StrCat(calculator_name, ":",
+                        options.batching().shared_name());
+  }
+  return absl::StrCat(calculator_name, ":", GetModelKey(cc));
+}
+
+absl::Status InferenceCalculator::WarmUp(
+    CalculatorContext* cc,
+    const std::function<absl::StatusOr<std::vector<Tensor>>(
+        const std::vector<Tensor>&)>& run) {
+  const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
+  if (options.warmup_runs() <= 0) {
+    return absl::OkStatus();
+  }
+  ASSIGN_OR_RETURN(auto model_packet, GetModelAsPacket(cc));
+  ASSIGN_OR_RETURN(auto op_resolver_packet, GetOpResolverAsPacket(cc));
+  ASSIGN_OR_RETURN(
+      std::vector<Tensor> inputs,
+      CreateBenchmarkInputs(*model_packet.Get(), op_resolver_packet.Get()));
+  MEDIAPIPE_PROFILING(WARMUP, cc);
+  for (int i = 0; i < options.warmup_runs(); ++i) {
+    ASSIGN_OR_RETURN(std::vector<Tensor> outputs, run(inputs));
+    for (const Tensor& output : outputs) {
+      output.GetCpuReadView();
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace api2
 }  // namespace mediapipe
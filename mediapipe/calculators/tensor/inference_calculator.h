@@ -16,10 +16,14 @@
 #define MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_CALCULATOR_H_
 
 #include <cstring>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "mediapipe/calculators/tensor/inference_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -119,6 +123,24 @@ class InferenceCalculator : public NodeIntf {
 
   static absl::StatusOr<Packet<tflite::OpResolver>> GetOpResolverAsPacket(
       CalculatorContext* cc);
+
+  // Returns a key that identifies the model in the process: the model path,
+  // or else the address of the model side packet.
+  static std::string GetModelKey(CalculatorContext* cc);
+
+  // Returns the name of the InferenceBatcher to share when batching is
+  // configured: the batching shared_name or else the model key, prefixed with
+  // `calculator_name`.
+  static std::string GetBatcherName(CalculatorContext* cc,
+                                    absl::string_view calculator_name);
+
+  // Runs the model `warmup_runs` times, as set in the options, through `run`
+  // on synthetic inputs. The outputs are read back on the CPU, so that the
+  // time includes the work queued on a device. Called from Open().
+  static absl::Status WarmUp(
+      CalculatorContext* cc,
+      const std::function<absl::StatusOr<std::vector<Tensor>>(
+          const std::vector<Tensor>&)>& run);
 };
 
 struct InferenceCalculatorSelector : public InferenceCalculator {
@@ -15,15 +15,28 @@
 #include <cstdint>
 #include <cstring>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "mediapipe/calculators/tensor/caching_inference_runner.h"
+#include "mediapipe/calculators/tensor/inference_batcher.h"
 #include "mediapipe/calculators/tensor/inference_calculator.h"
 #include "mediapipe/calculators/tensor/inference_calculator_utils.h"
+#include "mediapipe/calculators/tensor/inference_delegate_selection.h"
 #include "mediapipe/calculators/tensor/inference_interpreter_delegate_runner.h"
 #include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/calculators/tensor/inference_runner_pool.h"
+#include "mediapipe/calculators/tensor/pipelined_inference_runner.h"
+#include "mediapipe/calculators/tensor/xnnpack_weights_cache.h"
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/logging.h"
 #include "tensorflow/lite/interpreter.h"
 #if defined(MEDIAPIPE_ANDROID)
 #include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
@@ -34,20 +47,44 @@ namespace mediapipe {
 namespace api2 {
 
 class InferenceCalculatorCpuImpl
-    : public NodeImpl<InferenceCalculatorCpu, InferenceCalculatorCpuImpl> {
+    : public AsyncNodeImpl<InferenceCalculatorCpu, InferenceCalculatorCpuImpl> {
  public:
   static absl::Status UpdateContract(CalculatorContract* cc);
 
   absl::Status Open(CalculatorContext* cc) override;
-  absl::Status Process(CalculatorContext* cc) override;
+  void ProcessAsync(CalculatorContext* cc, ProcessDone done) override;
   absl::Status Close(CalculatorContext* cc) override;
 
  private:
-  absl::StatusOr<std::unique_ptr<InferenceRunner>> CreateInferenceRunner(
+  absl::StatusOr<std::shared_ptr<InferenceRunner>> CreateInferenceRunner(
       CalculatorContext* cc);
   absl::StatusOr<TfLiteDelegatePtr> MaybeCreateDelegate(CalculatorContext* cc);
+  // Creates the delegate configured by `opts_delegate`, which is not
+  // auto_select.
+  absl::StatusOr<TfLiteDelegatePtr> CreateDelegate(
+      CalculatorContext* cc, bool opts_has_delegate,
+      const mediapipe::InferenceCalculatorOptions::Delegate& opts_delegate);
+  // Benchmarks the candidates of `auto_select`, or reads the cached result,
+  // and returns the delegate to use.
+  absl::StatusOr<mediapipe::InferenceCalculatorOptions::Delegate>
+  SelectDelegate(
+      CalculatorContext* cc,
+      const mediapipe::InferenceCalculatorOptions::Delegate::AutoSelect&
+          auto_select);
 
-  std::unique_ptr<InferenceRunner> inference_runner_;
+  // Shared with other calculators when batching is configured.
+  std::shared_ptr<InferenceRunner> inference_runner_;
+  // Set when the XNNPACK delegate shares its weights cache.
+  std::shared_ptr<XnnpackWeightsCache> weights_cache_;
+  // Reuses the outputs of `inference_runner_` when cache is set.
+  std::unique_ptr<CachingInferenceRunner> caching_runner_;
+  // Runs the runner above on its own thread when run_async is set.
+  std::unique_ptr<PipelinedInferenceRunner> pipelined_runner_;
+  // The outermost of the runners above, which Process() runs.
+  InferenceRunner* runner_ = nullptr;
+  // The delegate picked by auto_select.
+  std::optional<mediapipe::InferenceCalculatorOptions::Delegate>
+      selected_delegate_;
 };
 
 absl::Status InferenceCalculatorCpuImpl::UpdateContract(
@@ -60,38 +97,96 @@ absl::Status InferenceCalculatorCpuImpl::UpdateContract(
 }
 
 absl::Status InferenceCalculatorCpuImpl::Open(CalculatorContext* cc) {
+  const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
   ASSIGN_OR_RETURN(inference_runner_, CreateInferenceRunner(cc));
+  // Below the cache, which would otherwise hold the synthetic outputs.
+  MP_RETURN_IF_ERROR(WarmUp(cc, [this](const std::vector<Tensor>& inputs) {
+    return inference_runner_->Run(inputs);
+  }));
+  runner_ = inference_runner_.get();
+  if (options.has_cache()) {
+    // Below the pipelined runner, so that cache hits keep the input order.
+    caching_runner_ = std::make_unique<CachingInferenceRunner>(
+        runner_, CachingInferenceRunner::Options{
+                     .max_mean_abs_diff = options.cache().max_mean_abs_diff(),
+                     .sample_stride = options.cache().sample_stride(),
+                     .max_reuses = options.cache().max_reuses()});
+    runner_ = caching_runner_.get();
+  }
+  if (options.run_async()) {
+    pipelined_runner_ = std::make_unique<PipelinedInferenceRunner>(runner_);
+    runner_ = pipelined_runner_.get();
+  }
   return absl::OkStatus();
 }
 
-absl::Status InferenceCalculatorCpuImpl::Process(CalculatorContext* cc) {
+void InferenceCalculatorCpuImpl::ProcessAsync(CalculatorContext* cc,
+                                              ProcessDone done) {
   if (kInTensors(cc).IsEmpty()) {
-    return absl::OkStatus();
+    done(absl::OkStatus());
+    return;
   }
   const auto& input_tensors = *kInTensors(cc);
-  RET_CHECK(!input_tensors.empty());
+  if (input_tensors.empty()) {
+    done(absl::InvalidArgumentError("Empty input tensors."));
+    return;
+  }
 
-  ASSIGN_OR_RETURN(std::vector<Tensor> output_tensors,
-                   inference_runner_->Run(input_tensors));
-  kOutTensors(cc).Send(std::move(output_tensors));
-  return absl::OkStatus();
+  // The input packets of `cc` stay alive until `done` is called.
+  runner_->RunAsync(
+      input_tensors,
+      [cc, done = std::move(done)](
+          absl::StatusOr<std::vector<Tensor>> output_tensors) {
+        if (!output_tensors.ok()) {
+          done(output_tensors.status());
+          return;
+        }
+        kOutTensors(cc).Send(std::move(*output_tensors));
+        done(absl::OkStatus());
+      });
 }
 
 absl::Status InferenceCalculatorCpuImpl::Close(CalculatorContext* cc) {
+  // Waits for the pending runs before the runner goes away.
+  runner_ = nullptr;
+  pipelined_runner_ = nullptr;
+  caching_runner_ = nullptr;
   inference_runner_ = nullptr;
+  weights_cache_ = nullptr;
   return absl::OkStatus();
 }
 
-absl::StatusOr<std::unique_ptr<InferenceRunner>>
+absl::StatusOr<std::shared_ptr<InferenceRunner>>
 InferenceCalculatorCpuImpl::CreateInferenceRunner(CalculatorContext* cc) {
-  ASSIGN_OR_RETURN(auto model_packet, GetModelAsPacket(cc));
-  ASSIGN_OR_RETURN(auto op_resolver_packet, GetOpResolverAsPacket(cc));
-  const int interpreter_num_threads =
-      cc->Options<mediapipe::InferenceCalculatorOptions>().cpu_num_thread();
-  ASSIGN_OR_RETURN(TfLiteDelegatePtr delegate, MaybeCreateDelegate(cc));
-  return CreateInferenceInterpreterDelegateRunner(
-      std::move(model_packet), std::move(op_resolver_packet),
-      std::move(delegate), interpreter_num_threads);
+  const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
+  auto create_runner = [this, cc, &options]()
+      -> absl::StatusOr<std::unique_ptr<InferenceRunner>> {
+    // The interpreters of a pool share the model and the op resolver.
+    ASSIGN_OR_RETURN(auto model_packet, GetModelAsPacket(cc));
+    ASSIGN_OR_RETURN(auto op_resolver_packet, GetOpResolverAsPacket(cc));
+    return InferenceRunnerPool::Create(
+        options.has_batching() ? 1 : options.num_interpreters(),
+        [&]() -> absl::StatusOr<std::unique_ptr<InferenceRunner>> {
+          ASSIGN_OR_RETURN(TfLiteDelegatePtr delegate,
+                           MaybeCreateDelegate(cc));
+          auto build_runner = [&]() {
+            return CreateInferenceInterpreterDelegateRunner(
+                model_packet, op_resolver_packet, std::move(delegate),
+                options.cpu_num_thread());
+          };
+          return weights_cache_ ? weights_cache_->Build(build_runner)
+                                : build_runner();
+        });
+  };
+  if (!options.has_batching()) {
+    return create_runner();
+  }
+  InferenceBatcher::Options batcher_options;
+  batcher_options.max_batch_size = options.batching().max_batch_size();
+  batcher_options.max_wait =
+      absl::Microseconds(options.batching().max_wait_us());
+  return InferenceBatcher::GetOrCreate(
+      GetBatcherName(cc, kCalculatorName), batcher_options, create_runner);
 }
 
 absl::StatusOr<TfLiteDelegatePtr>
@@ -106,14 +201,30 @@ InferenceCalculatorCpuImpl::MaybeCreateDelegate(CalculatorContext* cc) {
         input_side_packet_delegate.has_tflite() ||
         input_side_packet_delegate.has_xnnpack() ||
         input_side_packet_delegate.has_nnapi() ||
+        input_side_packet_delegate.has_auto_select() ||
         input_side_packet_delegate.delegate_case() ==
             mediapipe::InferenceCalculatorOptions::Delegate::DELEGATE_NOT_SET)
         << "inference_calculator_cpu only supports delegate input side packet "
-        << "for TFLite, XNNPack and Nnapi";
+        << "for TFLite, XNNPack, Nnapi and AutoSelect";
     opts_delegate.MergeFrom(input_side_packet_delegate);
   }
   const bool opts_has_delegate =
       calculator_opts.has_delegate() || !kDelegate(cc).IsEmpty();
+  if (opts_has_delegate && opts_delegate.has_auto_select()) {
+    if (!selected_delegate_.has_value()) {
+      ASSIGN_OR_RETURN(selected_delegate_,
+                       SelectDelegate(cc, opts_delegate.auto_select()));
+    }
+    return CreateDelegate(cc, /*opts_has_delegate=*/true, *selected_delegate_);
+  }
+  return CreateDelegate(cc, opts_has_delegate, opts_delegate);
+}
+
+absl::StatusOr<TfLiteDelegatePtr> InferenceCalculatorCpuImpl::CreateDelegate(
+    CalculatorContext* cc, bool opts_has_delegate,
+    const mediapipe::InferenceCalculatorOptions::Delegate& opts_delegate) {
+  const auto& calculator_opts =
+      cc->Options<mediapipe::InferenceCalculatorOptions>();
   if (opts_has_delegate && opts_delegate.has_tflite()) {
     // Default tflite inference requeqsted - no need to modify graph.
     return nullptr;
@@ -151,6 +262,17 @@ InferenceCalculatorCpuImpl::MaybeCreateDelegate(CalculatorContext* cc) {
     auto xnnpack_opts = TfLiteXNNPackDelegateOptionsDefault();
     xnnpack_opts.num_threads =
         GetXnnpackNumThreads(opts_has_delegate, opts_delegate);
+    if (opts_delegate.xnnpack().share_weights_cache()) {
+      ASSIGN_OR_RETURN(weights_cache_,
+                       XnnpackWeightsCache::GetOrCreate(GetModelKey(cc)));
+      xnnpack_opts.weights_cache = weights_cache_->get();
+      // The delegate keeps the cache alive.
+      return TfLiteDelegatePtr(
+          TfLiteXNNPackDelegateCreate(&xnnpack_opts),
+          [weights_cache = weights_cache_](TfLiteDelegate* delegate) {
+            TfLiteXNNPackDelegateDelete(delegate);
+          });
+    }
     return TfLiteDelegatePtr(TfLiteXNNPackDelegateCreate(&xnnpack_opts),
                              &TfLiteXNNPackDelegateDelete);
   }
@@ -158,5 +280,95 @@ InferenceCalculatorCpuImpl::MaybeCreateDelegate(CalculatorContext* cc) {
   return nullptr;
 }
 
+absl::StatusOr<mediapipe::InferenceCalculatorOptions::Delegate>
+InferenceCalculatorCpuImpl::SelectDelegate(
+    CalculatorContext* cc,
+    const mediapipe::InferenceCalculatorOptions::Delegate::AutoSelect&
+        auto_select) {
+  using Delegate = mediapipe::InferenceCalculatorOptions::Delegate;
+  std::vector<Delegate> candidates(auto_select.candidates().begin(),
+                                   auto_select.candidates().end());
+  if (candidates.empty()) {
+    candidates.resize(2);
+    candidates[0].mutable_tflite();
+    candidates[1].mutable_xnnpack();
+#if defined(MEDIAPIPE_ANDROID)
+    candidates.emplace_back().mutable_nnapi();
+#endif  // MEDIAPIPE_ANDROID
+  }
+  for (const Delegate& candidate : candidates) {
+    RET_CHECK(candidate.has_tflite() || candidate.has_xnnpack() ||
+              candidate.has_nnapi())
+        << "auto_select only supports TFLite, XNNPack and Nnapi candidates";
+  }
+
+  ASSIGN_OR_RETURN(auto model_packet, GetModelAsPacket(cc));
+  ASSIGN_OR_RETURN(auto op_resolver_packet, GetOpResolverAsPacket(cc));
+  std::string cache_path;
+  if (!auto_select.cache_dir().empty()) {
+    const tflite::Allocation* model_data = model_packet.Get()->allocation();
+    RET_CHECK(model_data);
+    std::string key;
+    for (const Delegate& candidate : candidates) {
+      absl::StrAppend(&key, candidate.SerializeAsString());
+    }
+    absl::StrAppend(
+        &key, GetDeviceFingerprint(),
+        absl::string_view(static_cast<const char*>(model_data->base()),
+                          model_data->bytes()));
+    cache_path = file::JoinPath(
+        auto_select.cache_dir(),
+        absl::StrCat("delegate_", absl::Hex(StableHash64(key)), ".binarypb"));
+    std::string cached;
+    Delegate selected;
+    if (file::GetContents(cache_path, &cached).ok() &&
+        selected.ParseFromString(cached)) {
+      LOG(INFO) << "Using cached delegate selection for " << GetModelKey(cc)
+                << ": " << selected.ShortDebugString();
+      return selected;
+    }
+  }
+
+  ASSIGN_OR_RETURN(std::vector<Tensor> inputs,
+                   CreateBenchmarkInputs(*model_packet.Get(),
+                                         op_resolver_packet.Get()));
+  std::vector<InferenceRunnerFactory> factories;
+  for (const Delegate& candidate : candidates) {
+    factories.push_back(
+        [&, candidate]() -> absl::StatusOr<std::unique_ptr<InferenceRunner>> {
+          ASSIGN_OR_RETURN(TfLiteDelegatePtr delegate,
+                           CreateDelegate(cc, /*opts_has_delegate=*/true,
+                                          candidate));
+          auto build_runner = [&]() {
+            return CreateInferenceInterpreterDelegateRunner(
+                model_packet, op_resolver_packet, std::move(delegate),
+                cc->Options<mediapipe::InferenceCalculatorOptions>()
+                    .cpu_num_thread());
+          };
+          return weights_cache_ ? weights_cache_->Build(build_runner)
+                                : build_runner();
+        });
+  }
+  InferenceBenchmarkOptions benchmark_options;
+  benchmark_options.num_warmup_runs = auto_select.num_warmup_runs();
+  benchmark_options.num_timed_runs = auto_select.num_timed_runs();
+  benchmark_options.max_abs_error = auto_select.max_abs_error();
+  ASSIGN_OR_RETURN(
+      const int selected,
+      SelectFastestInferenceRunner(factories, inputs, benchmark_options));
+  // The runners are recreated for the selected delegate.
+  weights_cache_ = nullptr;
+  LOG(INFO) << "Selected delegate for " << GetModelKey(cc) << ": "
+            << candidates[selected].ShortDebugString();
+
+  if (!cache_path.empty()) {
+    const absl::Status status = file::SetContents(
+        cache_path, candidates[selected].SerializeAsString());
+    LOG_IF(WARNING, !status.ok())
+        << "Failed to cache the delegate selection: " << status;
+  }
+  return candidates[selected];
+}
+
 }  // namespace api2
 }  // namespace mediapipe
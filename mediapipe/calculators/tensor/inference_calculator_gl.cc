@@ -194,6 +194,11 @@ absl::Status InferenceCalculatorGlImpl::GpuInferenceRunner::Process(
       [this, &input_tensors, &output_tensors]() -> absl::Status {
         // Explicitly copy input.
         for (int i = 0; i < input_tensors.size(); ++i) {
+          // The delegate only binds SSBOs, which can't be filled from a
+          // texture.
+          RET_CHECK(input_tensors[i].ready_as_opengl_buffer() ||
+                    input_tensors[i].ready_on_cpu())
+              << "Texture inputs require use_advanced_gpu_api.";
           glBindBuffer(GL_COPY_READ_BUFFER,
                        input_tensors[i].GetOpenGlBufferReadView().name());
           glBindBuffer(GL_COPY_WRITE_BUFFER,
@@ -247,7 +252,15 @@ absl::Status InferenceCalculatorGlImpl::Open(CalculatorContext* cc) {
   }
 
   gpu_inference_runner_ = std::make_unique<GpuInferenceRunner>();
-  return gpu_inference_runner_->Init(cc, delegate);
+  MP_RETURN_IF_ERROR(gpu_inference_runner_->Init(cc, delegate));
+  return WarmUp(cc,
+                [this, cc](const std::vector<Tensor>& input_tensors)
+                    -> absl::StatusOr<std::vector<Tensor>> {
+                  std::vector<Tensor> output_tensors;
+                  MP_RETURN_IF_ERROR(gpu_inference_runner_->Process(
+                      cc, input_tensors, output_tensors));
+                  return output_tensors;
+                });
 }
 
 absl::Status InferenceCalculatorGlImpl::Process(CalculatorContext* cc) {
@@ -21,8 +21,17 @@
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "mediapipe/calculators/tensor/gpu_delegate_cache.h"
 #include "mediapipe/calculators/tensor/inference_calculator.h"
+#include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/calculators/tensor/pipelined_inference_runner.h"
+#include "mediapipe/framework/legacy_calculator_support.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/gpu/gl_base.h"
 #include "mediapipe/gpu/gl_calculator_helper.h"
+#include "mediapipe/gpu/gl_context.h"
 #include "mediapipe/util/tflite/tflite_gpu_runner.h"
 
 #if defined(MEDIAPIPE_ANDROID)
@@ -48,13 +57,13 @@ namespace api2 {
 //     }
 //   }
 class InferenceCalculatorGlAdvancedImpl
-    : public NodeImpl<InferenceCalculatorGlAdvanced,
-                      InferenceCalculatorGlAdvancedImpl> {
+    : public AsyncNodeImpl<InferenceCalculatorGlAdvanced,
+                           InferenceCalculatorGlAdvancedImpl> {
  public:
   static absl::Status UpdateContract(CalculatorContract* cc);
 
   absl::Status Open(CalculatorContext* cc) override;
-  absl::Status Process(CalculatorContext* cc) override;
+  void ProcessAsync(CalculatorContext* cc, ProcessDone done) override;
   absl::Status Close(CalculatorContext* cc) override;
 
  private:
@@ -65,6 +74,12 @@ class InferenceCalculatorGlAdvancedImpl
         const mediapipe::InferenceCalculatorOptions& options,
         const mediapipe::InferenceCalculatorOptions::Delegate::Gpu&
             gpu_delegate_options);
+    // Sets up the cache in "cache_dir", if any, for `model`. Must be called in
+    // the GL context, which identifies the GPU driver.
+    absl::Status InitSharedCache(
+        const mediapipe::InferenceCalculatorOptions::Delegate::Gpu&
+            gpu_delegate_options,
+        const tflite::FlatBufferModel& model);
     absl::Status ReadGpuCaches(tflite::gpu::TFLiteGPURunner* gpu_runner) const;
     absl::Status SaveGpuCaches(tflite::gpu::TFLiteGPURunner* gpu_runner) const;
 
@@ -73,17 +88,20 @@ class InferenceCalculatorGlAdvancedImpl
     std::string cached_kernel_filename_;
     bool use_serialized_model_ = false;
     std::string serialized_model_path_;
+    std::unique_ptr<GpuDelegateCache> shared_cache_;
+    std::string shared_kernel_key_;
+    std::string shared_serialized_model_key_;
   };
 
   // Helper class that wraps everything related to GPU inference acceleration.
-  class GpuInferenceRunner {
+  class GpuInferenceRunner : public InferenceRunner {
    public:
     absl::Status Init(
         CalculatorContext* cc,
         const mediapipe::InferenceCalculatorOptions::Delegate& delegate);
 
-    absl::StatusOr<std::vector<Tensor>> Process(
-        const std::vector<Tensor>& input_tensors);
+    absl::StatusOr<std::vector<Tensor>> Run(
+        const std::vector<Tensor>& input_tensors) override;
 
     absl::Status Close();
 
@@ -91,25 +109,37 @@ class InferenceCalculatorGlAdvancedImpl
     absl::Status InitTFLiteGPURunner(
         CalculatorContext* cc,
         const mediapipe::InferenceCalculatorOptions::Delegate& delegate);
+    // Builds the runner with each input bound as the GPU object that
+    // `input_tensors` hold it in: textures, e.g. from TensorConverterCalculator
+    // with GPU_OUTPUT_TEXTURE, are bound directly instead of being converted.
+    absl::Status BuildTFLiteGPURunner(const std::vector<Tensor>& input_tensors);
 
     // TfLite requires us to keep the model alive as long as the interpreter is.
     Packet<TfLiteModelPtr> model_packet_;
 
     mediapipe::GlCalculatorHelper gpu_helper_;
     std::unique_ptr<tflite::gpu::TFLiteGPURunner> tflite_gpu_runner_;
+    // Attributes the GPU time of Run() to this node in the profiler.
+    int node_id_ = -1;
 
     std::vector<Tensor::Shape> output_shapes_;
+    // The runner is built on the first Run(), once the input objects are known.
+    bool runner_built_ = false;
+    std::vector<bool> input_is_texture_;
 
     OnDiskCacheHelper on_disk_cache_helper_;
   };
 
   std::unique_ptr<GpuInferenceRunner> gpu_inference_runner_;
+  // Runs `gpu_inference_runner_` on its own thread when run_async is set.
+  std::unique_ptr<PipelinedInferenceRunner> pipelined_runner_;
 };
 
 absl::Status InferenceCalculatorGlAdvancedImpl::GpuInferenceRunner::Init(
     CalculatorContext* cc,
     const mediapipe::InferenceCalculatorOptions::Delegate& delegate) {
   MP_RETURN_IF_ERROR(gpu_helper_.Open(cc));
+  node_id_ = cc->NodeId();
 
   const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
   MP_RETURN_IF_ERROR(on_disk_cache_helper_.Init(options, delegate.gpu()));
@@ -120,15 +150,33 @@ absl::Status InferenceCalculatorGlAdvancedImpl::GpuInferenceRunner::Init(
 }
 
 absl::StatusOr<std::vector<Tensor>>
-InferenceCalculatorGlAdvancedImpl::GpuInferenceRunner::Process(
+InferenceCalculatorGlAdvancedImpl::GpuInferenceRunner::Run(
     const std::vector<Tensor>& input_tensors) {
   std::vector<Tensor> output_tensors;
 
-  MP_RETURN_IF_ERROR(gpu_helper_.RunInGlContext(
+  // There is no current CalculatorContext on the pipelined runner thread, so
+  // the node is passed explicitly to keep each model's GPU time separate.
+  CalculatorContext* calculator_context =
+      LegacyCalculatorSupport::Scoped<CalculatorContext>::current();
+  const Timestamp input_timestamp = calculator_context
+                                        ? calculator_context->InputTimestamp()
+                                        : Timestamp::Unset();
+  MP_RETURN_IF_ERROR(gpu_helper_.GetGlContext().Run(
       [this, &input_tensors, &output_tensors]() -> absl::Status {
+        if (!runner_built_) {
+          MP_RETURN_IF_ERROR(BuildTFLiteGPURunner(input_tensors));
+        }
+        RET_CHECK_EQ(input_tensors.size(), input_is_texture_.size());
         for (int i = 0; i < input_tensors.size(); ++i) {
-          MP_RETURN_IF_ERROR(tflite_gpu_runner_->BindSSBOToInputTensor(
-              input_tensors[i].GetOpenGlBufferReadView().name(), i));
+          if (input_is_texture_[i]) {
+            RET_CHECK(input_tensors[i].ready_as_opengl_texture_2d())
+                << "Input " << i << " is no longer a texture.";
+            MP_RETURN_IF_ERROR(tflite_gpu_runner_->BindTextureToInputTensor(
+                input_tensors[i].GetOpenGlTexture2dReadView().name(), i));
+          } else {
+            MP_RETURN_IF_ERROR(tflite_gpu_runner_->BindSSBOToInputTensor(
+                input_tensors[i].GetOpenGlBufferReadView().name(), i));
+          }
         }
         output_tensors.reserve(output_shapes_.size());
         for (int i = 0; i < output_shapes_.size(); ++i) {
@@ -139,14 +187,17 @@ InferenceCalculatorGlAdvancedImpl::GpuInferenceRunner::Process(
         }
         // Run inference.
         return tflite_gpu_runner_->Invoke();
-      }));
+      },
+      node_id_, input_timestamp));
 
   return output_tensors;
 }
 
 absl::Status InferenceCalculatorGlAdvancedImpl::GpuInferenceRunner::Close() {
-  MP_RETURN_IF_ERROR(
-      on_disk_cache_helper_.SaveGpuCaches(tflite_gpu_runner_.get()));
+  if (runner_built_) {
+    MP_RETURN_IF_ERROR(
+        on_disk_cache_helper_.SaveGpuCaches(tflite_gpu_runner_.get()));
+  }
   return gpu_helper_.RunInGlContext([this]() -> absl::Status {
     tflite_gpu_runner_.reset();
     return absl::OkStatus();
@@ -222,8 +273,26 @@ InferenceCalculatorGlAdvancedImpl::GpuInferenceRunner::InitTFLiteGPURunner(
   }
 
   MP_RETURN_IF_ERROR(
-      on_disk_cache_helper_.ReadGpuCaches(tflite_gpu_runner_.get()));
-  return tflite_gpu_runner_->Build();
+      on_disk_cache_helper_.InitSharedCache(delegate.gpu(), model));
+  return on_disk_cache_helper_.ReadGpuCaches(tflite_gpu_runner_.get());
+}
+
+absl::Status
+InferenceCalculatorGlAdvancedImpl::GpuInferenceRunner::BuildTFLiteGPURunner(
+    const std::vector<Tensor>& input_tensors) {
+  RET_CHECK_EQ(static_cast<int>(input_tensors.size()),
+               tflite_gpu_runner_->inputs_size());
+  input_is_texture_.assign(input_tensors.size(), false);
+  for (int i = 0; i < input_tensors.size(); ++i) {
+    if (input_tensors[i].ready_as_opengl_texture_2d() &&
+        !input_tensors[i].ready_as_opengl_buffer()) {
+      MP_RETURN_IF_ERROR(tflite_gpu_runner_->UseTextureForInput(i));
+      input_is_texture_[i] = true;
+    }
+  }
+  MP_RETURN_IF_ERROR(tflite_gpu_runner_->Build());
+  runner_built_ = true;
+  return absl::OkStatus();
 }
 
 #if defined(MEDIAPIPE_ANDROID)
@@ -248,9 +317,65 @@ absl::Status InferenceCalculatorGlAdvancedImpl::OnDiskCacheHelper::Init(
   return absl::OkStatus();
 }
 
+absl::Status InferenceCalculatorGlAdvancedImpl::OnDiskCacheHelper::
+    InitSharedCache(const mediapipe::InferenceCalculatorOptions::Delegate::Gpu&
+                        gpu_delegate_options,
+                    const tflite::FlatBufferModel& model) {
+  if (!gpu_delegate_options.has_cache_dir()) {
+    return absl::OkStatus();
+  }
+  const tflite::Allocation* allocation = model.allocation();
+  RET_CHECK(allocation != nullptr) << "The model has no allocation to hash.";
+  const absl::string_view model_data(
+      static_cast<const char*>(allocation->base()), allocation->bytes());
+
+  auto gl_string = [](GLenum name) -> absl::string_view {
+    const GLubyte* value = glGetString(name);
+    return value ? reinterpret_cast<const char*>(value) : "";
+  };
+  const std::string driver_version =
+      absl::StrCat(gl_string(GL_RENDERER), " ", gl_string(GL_VERSION));
+  // The compiled programs also depend on the options they were built for.
+  const std::string options_key = absl::StrCat(
+      gpu_delegate_options.api(), ":",
+      gpu_delegate_options.allow_precision_loss(), ":",
+      gpu_delegate_options.usage());
+
+  shared_cache_ = std::make_unique<GpuDelegateCache>(
+      gpu_delegate_options.cache_dir(), gpu_delegate_options.cache_namespace(),
+      gpu_delegate_options.max_cache_size_bytes());
+  shared_kernel_key_ = GpuDelegateCache::MakeKey(
+      absl::StrCat("kernels:", options_key), model_data, driver_version);
+  shared_serialized_model_key_ = GpuDelegateCache::MakeKey(
+      absl::StrCat("model:", options_key), model_data, driver_version);
+  return absl::OkStatus();
+}
+
 absl::Status
 InferenceCalculatorGlAdvancedImpl::OnDiskCacheHelper::SaveGpuCaches(
     tflite::gpu::TFLiteGPURunner* gpu_runner) const {
+  if (shared_cache_) {
+    // Failing to update the shared cache only slows down the next start.
+    std::vector<uint8_t> kernel_cache = gpu_runner->GetSerializedBinaryCache();
+    absl::Status status = shared_cache_->Write(
+        shared_kernel_key_,
+        absl::string_view(reinterpret_cast<const char*>(kernel_cache.data()),
+                          kernel_cache.size()));
+    if (status.ok()) {
+      absl::StatusOr<std::vector<uint8_t>> serialized_model =
+          gpu_runner->GetSerializedModel();
+      status = serialized_model.status();
+      if (serialized_model.ok()) {
+        status = shared_cache_->Write(
+            shared_serialized_model_key_,
+            absl::string_view(
+                reinterpret_cast<const char*>(serialized_model->data()),
+                serialized_model->size()));
+      }
+    }
+    LOG_IF(WARNING, !status.ok())
+        << "Failed to update the GPU delegate cache: " << status;
+  }
   if (use_kernel_caching_) {
     // Save kernel file.
     auto kernel_cache = absl::make_unique<std::vector<uint8_t>>(
@@ -292,6 +417,20 @@ InferenceCalculatorGlAdvancedImpl::OnDiskCacheHelper::ReadGpuCaches(
                                               serialized_model_str.end());
     gpu_runner->SetSerializedModel(std::move(serialized_model_vec));
   }
+  if (shared_cache_) {
+    absl::StatusOr<std::string> kernel_cache =
+        shared_cache_->Read(shared_kernel_key_);
+    if (kernel_cache.ok()) {
+      gpu_runner->SetSerializedBinaryCache(
+          std::vector<uint8_t>(kernel_cache->begin(), kernel_cache->end()));
+    }
+    absl::StatusOr<std::string> serialized_model =
+        shared_cache_->Read(shared_serialized_model_key_);
+    if (serialized_model.ok()) {
+      gpu_runner->SetSerializedModel(std::vector<uint8_t>(
+          serialized_model->begin(), serialized_model->end()));
+    }
+  }
   return absl::OkStatus();
 }
 #else
@@ -302,6 +441,13 @@ absl::Status InferenceCalculatorGlAdvancedImpl::OnDiskCacheHelper::Init(
   return absl::OkStatus();
 }
 
+absl::Status InferenceCalculatorGlAdvancedImpl::OnDiskCacheHelper::
+    InitSharedCache(const mediapipe::InferenceCalculatorOptions::Delegate::Gpu&
+                        gpu_delegate_options,
+                    const tflite::FlatBufferModel& model) {
+  return absl::OkStatus();
+}
+
 absl::Status
 InferenceCalculatorGlAdvancedImpl::OnDiskCacheHelper::ReadGpuCaches(
     tflite::gpu::TFLiteGPURunner* gpu_runner) const {
@@ -341,26 +487,49 @@ absl::Status InferenceCalculatorGlAdvancedImpl::Open(CalculatorContext* cc) {
   }
 
   gpu_inference_runner_ = std::make_unique<GpuInferenceRunner>();
-  return gpu_inference_runner_->Init(cc, delegate);
+  MP_RETURN_IF_ERROR(gpu_inference_runner_->Init(cc, delegate));
+  if (options.run_async()) {
+    pipelined_runner_ = std::make_unique<PipelinedInferenceRunner>(
+        gpu_inference_runner_.get());
+  }
+  return absl::OkStatus();
 }
 
-absl::Status InferenceCalculatorGlAdvancedImpl::Process(CalculatorContext* cc) {
+void InferenceCalculatorGlAdvancedImpl::ProcessAsync(CalculatorContext* cc,
+                                                     ProcessDone done) {
   if (kInTensors(cc).IsEmpty()) {
-    return absl::OkStatus();
+    done(absl::OkStatus());
+    return;
   }
 
   const auto& input_tensors = *kInTensors(cc);
-  RET_CHECK(!input_tensors.empty());
-  auto output_tensors = absl::make_unique<std::vector<Tensor>>();
-
-  ASSIGN_OR_RETURN(*output_tensors,
-                   gpu_inference_runner_->Process(input_tensors));
+  if (input_tensors.empty()) {
+    done(absl::InvalidArgumentError("Empty input tensors."));
+    return;
+  }
 
-  kOutTensors(cc).Send(std::move(output_tensors));
-  return absl::OkStatus();
+  // The input packets of `cc` stay alive until `done` is called.
+  InferenceRunner* runner = pipelined_runner_
+                                ? static_cast<InferenceRunner*>(
+                                      pipelined_runner_.get())
+                                : gpu_inference_runner_.get();
+  runner->RunAsync(
+      input_tensors,
+      [cc, done = std::move(done)](
+          absl::StatusOr<std::vector<Tensor>> output_tensors) {
+        if (!output_tensors.ok()) {
+          done(output_tensors.status());
+          return;
+        }
+        kOutTensors(cc).Send(std::make_unique<std::vector<Tensor>>(
+            std::move(*output_tensors)));
+        done(absl::OkStatus());
+      });
 }
 
 absl::Status InferenceCalculatorGlAdvancedImpl::Close(CalculatorContext* cc) {
+  // Waits for the pending runs before the runner is closed.
+  pipelined_runner_ = nullptr;
   return gpu_inference_runner_->Close();
 }
 
@@ -91,6 +91,8 @@ class InferenceCalculatorMetalImpl
 
  private:
   absl::Status InitInterpreter(CalculatorContext* cc);
+  absl::StatusOr<std::vector<Tensor>> RunInference(
+      const std::vector<Tensor>& input_tensors);
   void AddDelegate(CalculatorContext* cc,
                    tflite::InterpreterBuilder* interpreter_builder);
   absl::Status CreateConverters(CalculatorContext* cc);
@@ -132,7 +134,10 @@ absl::Status InferenceCalculatorMetalImpl::Open(CalculatorContext* cc) {
 
   gpu_helper_ = [[MPPMetalHelper alloc] initWithCalculatorContext:cc];
   RET_CHECK(gpu_helper_);
-  return InitInterpreter(cc);
+  MP_RETURN_IF_ERROR(InitInterpreter(cc));
+  return WarmUp(cc, [this](const std::vector<Tensor>& input_tensors) {
+    return RunInference(input_tensors);
+  });
 }
 
 absl::Status InferenceCalculatorMetalImpl::Process(CalculatorContext* cc) {
@@ -141,8 +146,15 @@ absl::Status InferenceCalculatorMetalImpl::Process(CalculatorContext* cc) {
   }
   const auto& input_tensors = *kInTensors(cc);
   RET_CHECK(!input_tensors.empty());
-  auto output_tensors = absl::make_unique<std::vector<Tensor>>();
+  ASSIGN_OR_RETURN(std::vector<Tensor> output_tensors,
+                   RunInference(input_tensors));
+  kOutTensors(cc).Send(std::move(output_tensors));
+  return absl::OkStatus();
+}
 
+absl::StatusOr<std::vector<Tensor>> InferenceCalculatorMetalImpl::RunInference(
+    const std::vector<Tensor>& input_tensors) {
+  std::vector<Tensor> output_tensors;
   id<MTLCommandBuffer> command_buffer;
 
   command_buffer = [gpu_helper_ commandBuffer];
@@ -167,15 +179,15 @@ absl::Status InferenceCalculatorMetalImpl::Process(CalculatorContext* cc) {
   RET_CHECK(TFLGpuDelegateSetCommandBuffer(delegate_.get(), command_buffer));
   RET_CHECK_EQ(interpreter_->Invoke(), kTfLiteOk);
 
-  output_tensors->reserve(output_shapes_.size());
+  output_tensors.reserve(output_shapes_.size());
   for (int i = 0; i < output_shapes_.size(); ++i) {
-    output_tensors->emplace_back(Tensor::ElementType::kFloat32,
-                                 output_shapes_[i]);
+    output_tensors.emplace_back(Tensor::ElementType::kFloat32,
+                                output_shapes_[i]);
     // Reshape tensor.
     tflite::gpu::BHWC shape = BhwcFromTensorShape(output_shapes_[i]);
     auto read_view = gpu_buffers_out_[i]->GetMtlBufferReadView(command_buffer);
     auto write_view =
-        output_tensors->at(i).GetMtlBufferWriteView(command_buffer);
+        output_tensors.at(i).GetMtlBufferWriteView(command_buffer);
     id<MTLComputeCommandEncoder> output_encoder =
         [command_buffer computeCommandEncoder];
     [converter_from_BPHWC4_ convertWithEncoder:output_encoder
@@ -185,9 +197,7 @@ absl::Status InferenceCalculatorMetalImpl::Process(CalculatorContext* cc) {
     [output_encoder endEncoding];
   }
   [command_buffer commit];
-
-  kOutTensors(cc).Send(std::move(output_tensors));
-  return absl::OkStatus();
+  return output_tensors;
 }
 
 absl::Status InferenceCalculatorMetalImpl::Close(CalculatorContext* cc) {
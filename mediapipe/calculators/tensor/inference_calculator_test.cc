@@ -180,6 +180,16 @@ TEST(InferenceCalculatorTest, ModelAsInputSidePacketSmokeTest) {
   DoSmokeTest(kGraphWithModelAsInputSidePacket);
 }
 
+// Tests that warm-up runs in Open() leave the outputs unchanged.
+TEST(InferenceCalculatorTest, WarmupRunsSmokeTest) {
+  DoSmokeTest(absl::StrReplaceAll(
+      kGraphWithModelPathInOption,
+      {{"$delegate", "delegate { tflite {} } warmup_runs: 2"}}));
+  DoSmokeTest(absl::StrReplaceAll(
+      kGraphWithModelPathInOption,
+      {{"$delegate", "delegate { xnnpack {} } warmup_runs: 2"}}));
+}
+
 void BM_InitializeCalculator(benchmark::State& state) {
   mediapipe::InferenceCalculatorOptions::Delegate delegate;
   delegate.mutable_tflite();
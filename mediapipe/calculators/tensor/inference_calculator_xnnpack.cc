@@ -20,10 +20,15 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "mediapipe/calculators/tensor/caching_inference_runner.h"
+#include "mediapipe/calculators/tensor/inference_batcher.h"
 #include "mediapipe/calculators/tensor/inference_calculator.h"
 #include "mediapipe/calculators/tensor/inference_calculator_utils.h"
 #include "mediapipe/calculators/tensor/inference_interpreter_delegate_runner.h"
 #include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/calculators/tensor/inference_runner_pool.h"
+#include "mediapipe/calculators/tensor/xnnpack_weights_cache.h"
 #include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
 #include "tensorflow/lite/interpreter.h"
 
@@ -41,11 +46,16 @@ class InferenceCalculatorXnnpackImpl
   absl::Status Close(CalculatorContext* cc) override;
 
  private:
-  absl::StatusOr<std::unique_ptr<InferenceRunner>> CreateInferenceRunner(
+  absl::StatusOr<std::shared_ptr<InferenceRunner>> CreateInferenceRunner(
       CalculatorContext* cc);
   absl::StatusOr<TfLiteDelegatePtr> CreateDelegate(CalculatorContext* cc);
 
-  std::unique_ptr<InferenceRunner> inference_runner_;
+  // Shared with other calculators when batching is configured.
+  std::shared_ptr<InferenceRunner> inference_runner_;
+  // Reuses the outputs of `inference_runner_` when cache is set.
+  std::unique_ptr<CachingInferenceRunner> caching_runner_;
+  // Set when the XNNPACK delegate shares its weights cache.
+  std::shared_ptr<XnnpackWeightsCache> weights_cache_;
 };
 
 absl::Status InferenceCalculatorXnnpackImpl::UpdateContract(
@@ -58,7 +68,20 @@ absl::Status InferenceCalculatorXnnpackImpl::UpdateContract(
 }
 
 absl::Status InferenceCalculatorXnnpackImpl::Open(CalculatorContext* cc) {
+  const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
   ASSIGN_OR_RETURN(inference_runner_, CreateInferenceRunner(cc));
+  // Below the cache, which would otherwise hold the synthetic outputs.
+  MP_RETURN_IF_ERROR(WarmUp(cc, [this](const std::vector<Tensor>& inputs) {
+    return inference_runner_->Run(inputs);
+  }));
+  if (options.has_cache()) {
+    caching_runner_ = std::make_unique<CachingInferenceRunner>(
+        inference_runner_.get(),
+        CachingInferenceRunner::Options{
+            .max_mean_abs_diff = options.cache().max_mean_abs_diff(),
+            .sample_stride = options.cache().sample_stride(),
+            .max_reuses = options.cache().max_reuses()});
+  }
   return absl::OkStatus();
 }
 
@@ -69,27 +92,53 @@ absl::Status InferenceCalculatorXnnpackImpl::Process(CalculatorContext* cc) {
   const auto& input_tensors = *kInTensors(cc);
   RET_CHECK(!input_tensors.empty());
 
+  InferenceRunner* runner = caching_runner_
+                                ? static_cast<InferenceRunner*>(
+                                      caching_runner_.get())
+                                : inference_runner_.get();
   ASSIGN_OR_RETURN(std::vector<Tensor> output_tensors,
-                   inference_runner_->Run(input_tensors));
+                   runner->Run(input_tensors));
   kOutTensors(cc).Send(std::move(output_tensors));
   return absl::OkStatus();
 }
 
 absl::Status InferenceCalculatorXnnpackImpl::Close(CalculatorContext* cc) {
+  caching_runner_ = nullptr;
   inference_runner_ = nullptr;
+  weights_cache_ = nullptr;
   return absl::OkStatus();
 }
 
-absl::StatusOr<std::unique_ptr<InferenceRunner>>
+absl::StatusOr<std::shared_ptr<InferenceRunner>>
 InferenceCalculatorXnnpackImpl::CreateInferenceRunner(CalculatorContext* cc) {
-  ASSIGN_OR_RETURN(auto model_packet, GetModelAsPacket(cc));
-  ASSIGN_OR_RETURN(auto op_resolver_packet, GetOpResolverAsPacket(cc));
-  const int interpreter_num_threads =
-      cc->Options<mediapipe::InferenceCalculatorOptions>().cpu_num_thread();
-  ASSIGN_OR_RETURN(TfLiteDelegatePtr delegate, CreateDelegate(cc));
-  return CreateInferenceInterpreterDelegateRunner(
-      std::move(model_packet), std::move(op_resolver_packet),
-      std::move(delegate), interpreter_num_threads);
+  const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
+  auto create_runner = [this, cc, &options]()
+      -> absl::StatusOr<std::unique_ptr<InferenceRunner>> {
+    // The interpreters of a pool share the model and the op resolver.
+    ASSIGN_OR_RETURN(auto model_packet, GetModelAsPacket(cc));
+    ASSIGN_OR_RETURN(auto op_resolver_packet, GetOpResolverAsPacket(cc));
+    return InferenceRunnerPool::Create(
+        options.has_batching() ? 1 : options.num_interpreters(),
+        [&]() -> absl::StatusOr<std::unique_ptr<InferenceRunner>> {
+          ASSIGN_OR_RETURN(TfLiteDelegatePtr delegate, CreateDelegate(cc));
+          auto build_runner = [&]() {
+            return CreateInferenceInterpreterDelegateRunner(
+                model_packet, op_resolver_packet, std::move(delegate),
+                options.cpu_num_thread());
+          };
+          return weights_cache_ ? weights_cache_->Build(build_runner)
+                                : build_runner();
+        });
+  };
+  if (!options.has_batching()) {
+    return create_runner();
+  }
+  InferenceBatcher::Options batcher_options;
+  batcher_options.max_batch_size = options.batching().max_batch_size();
+  batcher_options.max_wait =
+      absl::Microseconds(options.batching().max_wait_us());
+  return InferenceBatcher::GetOrCreate(
+      GetBatcherName(cc, kCalculatorName), batcher_options, create_runner);
 }
 
 absl::StatusOr<TfLiteDelegatePtr>
@@ -114,6 +163,17 @@ InferenceCalculatorXnnpackImpl::CreateDelegate(CalculatorContext* cc) {
   auto xnnpack_opts = TfLiteXNNPackDelegateOptionsDefault();
   xnnpack_opts.num_threads =
       GetXnnpackNumThreads(opts_has_delegate, opts_delegate);
+  if (opts_delegate.xnnpack().share_weights_cache()) {
+    ASSIGN_OR_RETURN(weights_cache_,
+                     XnnpackWeightsCache::GetOrCreate(GetModelKey(cc)));
+    xnnpack_opts.weights_cache = weights_cache_->get();
+    // The delegate keeps the cache alive.
+    return TfLiteDelegatePtr(
+        TfLiteXNNPackDelegateCreate(&xnnpack_opts),
+        [weights_cache = weights_cache_](TfLiteDelegate* delegate) {
+          TfLiteXNNPackDelegateDelete(delegate);
+        });
+  }
   return TfLiteDelegatePtr(TfLiteXNNPackDelegateCreate(&xnnpack_opts),
                            &TfLiteXNNPackDelegateDelete);
 }
@@ -0,0 +1,247 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/inference_delegate_selection.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <utility>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/formats/tensor_element_conversion.h"
+#include "mediapipe/framework/port.h"  // NOLINT: provides MEDIAPIPE_ANDROID/IOS
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+#include "mediapipe/util/cpu_util.h"
+#endif  // !__EMSCRIPTEN__ || __EMSCRIPTEN_PTHREADS__
+
+namespace mediapipe {
+
+namespace {
+
+struct BenchmarkResult {
+  absl::Duration median_latency;
+  // The outputs of the last run, as float.
+  std::vector<std::vector<float>> outputs;
+};
+
+absl::StatusOr<std::vector<float>> ToFloats(const Tensor& tensor) {
+  std::vector<float> values(tensor.shape().num_elements());
+  switch (tensor.element_type()) {
+    case Tensor::ElementType::kInt32: {
+      auto view = tensor.GetCpuReadView();
+      const int32_t* src = view.buffer<int32_t>();
+      std::copy(src, src + values.size(), values.begin());
+      return values;
+    }
+    case Tensor::ElementType::kBool: {
+      auto view = tensor.GetCpuReadView();
+      const bool* src = view.buffer<bool>();
+      std::copy(src, src + values.size(), values.begin());
+      return values;
+    }
+    default:
+      MP_RETURN_IF_ERROR(CopyTensorToFloat32(tensor, values.data()));
+      return values;
+  }
+}
+
+absl::StatusOr<BenchmarkResult> Benchmark(
+    const InferenceRunnerFactory& create_runner,
+    const std::vector<Tensor>& inputs,
+    const InferenceBenchmarkOptions& options) {
+  ASSIGN_OR_RETURN(std::unique_ptr<InferenceRunner> runner, create_runner());
+  for (int i = 0; i < options.num_warmup_runs; ++i) {
+    MP_RETURN_IF_ERROR(runner->Run(inputs).status());
+  }
+  std::vector<absl::Duration> latencies;
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < options.num_timed_runs; ++i) {
+    const absl::Time start = absl::Now();
+    ASSIGN_OR_RETURN(outputs, runner->Run(inputs));
+    latencies.push_back(absl::Now() - start);
+  }
+  std::nth_element(latencies.begin(),
+                   latencies.begin() + latencies.size() / 2, latencies.end());
+
+  BenchmarkResult result;
+  result.median_latency = latencies[latencies.size() / 2];
+  for (const Tensor& output : outputs) {
+    ASSIGN_OR_RETURN(std::vector<float> values, ToFloats(output));
+    result.outputs.push_back(std::move(values));
+  }
+  return result;
+}
+
+bool OutputsMatch(const std::vector<std::vector<float>>& expected,
+                  const std::vector<std::vector<float>>& actual,
+                  float max_abs_error) {
+  if (expected.size() != actual.size()) return false;
+  for (int i = 0; i < expected.size(); ++i) {
+    if (expected[i].size() != actual[i].size()) return false;
+    for (int j = 0; j < expected[i].size(); ++j) {
+      if (!(std::abs(expected[i][j] - actual[i][j]) <= max_abs_error)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+std::string GetCpuModel() {
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    if (absl::StartsWith(line, "model name") ||
+        absl::StartsWith(line, "Hardware")) {
+      return line.substr(line.find(':') + 1);
+    }
+  }
+  return "unknown";
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<Tensor>> CreateBenchmarkInputs(
+    const tflite::FlatBufferModel& model,
+    const tflite::OpResolver& op_resolver) {
+  std::unique_ptr<tflite::Interpreter> interpreter;
+  RET_CHECK_EQ(tflite::InterpreterBuilder(model, op_resolver)(&interpreter),
+               kTfLiteOk);
+  RET_CHECK_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  std::vector<Tensor> inputs;
+  uint32_t state = 1;
+  auto next_random = [&state]() {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+  };
+  for (int i = 0; i < interpreter->inputs().size(); ++i) {
+    const TfLiteTensor* tensor = interpreter->input_tensor(i);
+    const Tensor::Shape shape{std::vector<int>(
+        tensor->dims->data, tensor->dims->data + tensor->dims->size)};
+    const Tensor::QuantizationParameters quantization{
+        tensor->params.scale, tensor->params.zero_point};
+    switch (tensor->type) {
+      case kTfLiteFloat16:
+      case kTfLiteFloat32: {
+        inputs.emplace_back(Tensor::ElementType::kFloat32, shape);
+        auto view = inputs.back().GetCpuWriteView();
+        float* buffer = view.buffer<float>();
+        for (int j = 0; j < shape.num_elements(); ++j) {
+          buffer[j] = (next_random() & 0xffff) / 65536.0f;
+        }
+        break;
+      }
+      case kTfLiteUInt8:
+      case kTfLiteInt8: {
+        inputs.emplace_back(tensor->type == kTfLiteUInt8
+                                ? Tensor::ElementType::kUInt8
+                                : Tensor::ElementType::kInt8,
+                            shape, quantization);
+        auto view = inputs.back().GetCpuWriteView();
+        uint8_t* buffer = view.buffer<uint8_t>();
+        for (int j = 0; j < shape.num_elements(); ++j) {
+          buffer[j] = next_random() & 0xff;
+        }
+        break;
+      }
+      case kTfLiteInt32: {
+        inputs.emplace_back(Tensor::ElementType::kInt32, shape);
+        auto view = inputs.back().GetCpuWriteView();
+        std::fill_n(view.buffer<int32_t>(), shape.num_elements(), 0);
+        break;
+      }
+      default:
+        return absl::InvalidArgumentError(
+            absl::StrCat("Unsupported input tensor type for delegate "
+                         "selection: ",
+                         TfLiteTypeGetName(tensor->type)));
+    }
+  }
+  return inputs;
+}
+
+
+absl::StatusOr<int> SelectFastestInferenceRunner(
+    const std::vector<InferenceRunnerFactory>& candidates,
+    const std::vector<Tensor>& inputs,
+    const InferenceBenchmarkOptions& options) {
+  RET_CHECK(!candidates.empty());
+  RET_CHECK_GT(options.num_timed_runs, 0);
+  ASSIGN_OR_RETURN(BenchmarkResult reference,
+                   Benchmark(candidates[0], inputs, options));
+  int selected = 0;
+  absl::Duration selected_latency = reference.median_latency;
+  for (int i = 1; i < candidates.size(); ++i) {
+    absl::StatusOr<BenchmarkResult> result =
+        Benchmark(candidates[i], inputs, options);
+    if (!result.ok()) {
+      VLOG(1) << "Skipping delegate candidate " << i << ": "
+              << result.status();
+      continue;
+    }
+    if (!OutputsMatch(reference.outputs, result->outputs,
+                      options.max_abs_error)) {
+      VLOG(1) << "Skipping delegate candidate " << i
+              << ": outputs differ from the reference.";
+      continue;
+    }
+    VLOG(1) << "Delegate candidate " << i << " median latency: "
+            << result->median_latency;
+    if (result->median_latency < selected_latency) {
+      selected = i;
+      selected_latency = result->median_latency;
+    }
+  }
+  return selected;
+}
+
+std::string GetDeviceFingerprint() {
+#if defined(MEDIAPIPE_ANDROID)
+  constexpr char kPlatform[] = "android";
+#elif defined(MEDIAPIPE_IOS)
+  constexpr char kPlatform[] = "ios";
+#elif defined(__EMSCRIPTEN__)
+  constexpr char kPlatform[] = "web";
+#else
+  constexpr char kPlatform[] = "desktop";
+#endif  // MEDIAPIPE_ANDROID
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+  const int num_cores = NumCPUCores();
+#else
+  const int num_cores = 1;
+#endif  // !__EMSCRIPTEN__ || __EMSCRIPTEN_PTHREADS__
+  return absl::StrCat(kPlatform, ";", GetCpuModel(), ";", num_cores);
+}
+
+uint64_t StableHash64(absl::string_view data) {
+  // 64-bit FNV-1a.
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (const char c : data) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+}  // namespace mediapipe
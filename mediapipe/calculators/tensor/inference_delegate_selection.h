@@ -0,0 +1,75 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_DELEGATE_SELECTION_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_DELEGATE_SELECTION_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace mediapipe {
+
+// Creates the runner of a candidate delegate. Returns an error if the
+// delegate is not available on the device.
+using InferenceRunnerFactory =
+    std::function<absl::StatusOr<std::unique_ptr<InferenceRunner>>()>;
+
+struct InferenceBenchmarkOptions {
+  // Untimed runs before the timed runs.
+  int num_warmup_runs = 2;
+  // Runs whose median latency is compared.
+  int num_timed_runs = 5;
+  // The largest absolute difference from the outputs of the reference
+  // candidate that an accepted candidate may have.
+  float max_abs_error = 1e-2f;
+};
+
+// Returns inputs for the input tensors of `model` to benchmark runners with:
+// deterministic pseudo-random values in [0, 1) for floats, over the whole
+// range for quantized types, and zeros for int32 indices.
+absl::StatusOr<std::vector<Tensor>> CreateBenchmarkInputs(
+    const tflite::FlatBufferModel& model,
+    const tflite::OpResolver& op_resolver);
+
+// Runs `inputs` through a runner of each of `candidates` and returns the index
+// of the candidate with the lowest median latency among those whose outputs
+// match the outputs of the first candidate, the reference, within
+// `max_abs_error`. Candidates that cannot be created or fail to run are
+// skipped; only a failing reference is an error.
+absl::StatusOr<int> SelectFastestInferenceRunner(
+    const std::vector<InferenceRunnerFactory>& candidates,
+    const std::vector<Tensor>& inputs,
+    const InferenceBenchmarkOptions& options);
+
+// Returns a description of the device that tells apart devices on which
+// delegates may perform differently: the platform, the CPU model and the
+// number of CPU cores.
+std::string GetDeviceFingerprint();
+
+// Returns a hash of `data` that is stable across processes and builds, for
+// on-disk cache keys.
+uint64_t StableHash64(absl::string_view data);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_DELEGATE_SELECTION_H_
@@ -0,0 +1,123 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/inference_delegate_selection.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+// Outputs `value` after sleeping for `latency`.
+class FakeRunner : public InferenceRunner {
+ public:
+  FakeRunner(float value, absl::Duration latency)
+      : value_(value), latency_(latency) {}
+
+  absl::StatusOr<std::vector<Tensor>> Run(
+      const std::vector<Tensor>& inputs) override {
+    absl::SleepFor(latency_);
+    std::vector<Tensor> outputs;
+    outputs.emplace_back(Tensor::ElementType::kFloat32, Tensor::Shape{1});
+    outputs[0].GetCpuWriteView().buffer<float>()[0] = value_;
+    return outputs;
+  }
+
+ private:
+  const float value_;
+  const absl::Duration latency_;
+};
+
+InferenceRunnerFactory MakeFactory(float value, absl::Duration latency) {
+  return [value,
+          latency]() -> absl::StatusOr<std::unique_ptr<InferenceRunner>> {
+    return std::make_unique<FakeRunner>(value, latency);
+  };
+}
+
+std::vector<Tensor> MakeInputs() {
+  std::vector<Tensor> inputs;
+  inputs.emplace_back(Tensor::ElementType::kFloat32, Tensor::Shape{1});
+  inputs[0].GetCpuWriteView().buffer<float>()[0] = 0.0f;
+  return inputs;
+}
+
+InferenceBenchmarkOptions FastOptions() {
+  InferenceBenchmarkOptions options;
+  options.num_warmup_runs = 1;
+  options.num_timed_runs = 3;
+  return options;
+}
+
+TEST(InferenceDelegateSelectionTest, SelectsFastestCandidate) {
+  MP_ASSERT_OK_AND_ASSIGN(
+      const int selected,
+      SelectFastestInferenceRunner({MakeFactory(1.0f, absl::Milliseconds(20)),
+                                    MakeFactory(1.0f, absl::Milliseconds(1)),
+                                    MakeFactory(1.0f, absl::Milliseconds(10))},
+                                   MakeInputs(), FastOptions()));
+  EXPECT_EQ(selected, 1);
+}
+
+TEST(InferenceDelegateSelectionTest, SkipsInaccurateCandidate) {
+  MP_ASSERT_OK_AND_ASSIGN(
+      const int selected,
+      SelectFastestInferenceRunner({MakeFactory(1.0f, absl::Milliseconds(20)),
+                                    MakeFactory(1.5f, absl::Milliseconds(1)),
+                                    MakeFactory(1.001f, absl::Milliseconds(5))},
+                                   MakeInputs(), FastOptions()));
+  EXPECT_EQ(selected, 2);
+}
+
+TEST(InferenceDelegateSelectionTest, SkipsUnavailableCandidate) {
+  InferenceRunnerFactory unavailable =
+      []() -> absl::StatusOr<std::unique_ptr<InferenceRunner>> {
+    return absl::UnavailableError("No such delegate.");
+  };
+  MP_ASSERT_OK_AND_ASSIGN(
+      const int selected,
+      SelectFastestInferenceRunner(
+          {MakeFactory(1.0f, absl::Milliseconds(1)), unavailable},
+          MakeInputs(), FastOptions()));
+  EXPECT_EQ(selected, 0);
+}
+
+TEST(InferenceDelegateSelectionTest, FailsIfReferenceFails) {
+  InferenceRunnerFactory unavailable =
+      []() -> absl::StatusOr<std::unique_ptr<InferenceRunner>> {
+    return absl::UnavailableError("No such delegate.");
+  };
+  EXPECT_FALSE(SelectFastestInferenceRunner(
+                   {unavailable, MakeFactory(1.0f, absl::Milliseconds(1))},
+                   MakeInputs(), FastOptions())
+                   .ok());
+}
+
+TEST(InferenceDelegateSelectionTest, StableHash64IsStable) {
+  EXPECT_EQ(StableHash64(""), 0xcbf29ce484222325ull);
+  EXPECT_EQ(StableHash64("a"), 0xaf63dc4c8601ec8cull);
+  EXPECT_NE(StableHash64("model_a"), StableHash64("model_b"));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -24,6 +24,7 @@
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/interpreter.h"
 #include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/string_util.h"
 
 namespace mediapipe {
@@ -89,8 +90,27 @@ class InferenceInterpreterDelegateRunner : public InferenceRunner {
 
 absl::StatusOr<std::vector<Tensor>> InferenceInterpreterDelegateRunner::Run(
     const std::vector<Tensor>& input_tensors) {
-  // Read CPU input into tensors.
   RET_CHECK_EQ(interpreter_->inputs().size(), input_tensors.size());
+  // Resize the interpreter inputs whose size changed, e.g. with the batch
+  // size of batched inference.
+  bool inputs_resized = false;
+  for (int i = 0; i < input_tensors.size(); ++i) {
+    const TfLiteTensor* tensor = interpreter_->input_tensor(i);
+    if (tensor->type == TfLiteType::kTfLiteString ||
+        tflite::NumElements(tensor) ==
+            input_tensors[i].shape().num_elements()) {
+      continue;
+    }
+    RET_CHECK_EQ(interpreter_->ResizeInputTensor(interpreter_->inputs()[i],
+                                                 input_tensors[i].shape().dims),
+                 kTfLiteOk);
+    inputs_resized = true;
+  }
+  if (inputs_resized) {
+    RET_CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  }
+
+  // Read CPU input into tensors.
   for (int i = 0; i < input_tensors.size(); ++i) {
     const TfLiteType input_tensor_type =
         interpreter_->tensor(interpreter_->inputs()[i])->type;
@@ -1,6 +1,9 @@
 #ifndef MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_RUNNER_H_
 #define MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_RUNNER_H_
 
+#include <functional>
+#include <vector>
+
 #include "absl/status/statusor.h"
 #include "mediapipe/framework/formats/tensor.h"
 
@@ -9,9 +12,20 @@ namespace mediapipe {
 // Common interface to implement inference runners in MediaPipe.
 class InferenceRunner {
  public:
+  // Receives the outputs of RunAsync(), or its error.
+  using RunDone = std::function<void(absl::StatusOr<std::vector<Tensor>>)>;
+
   virtual ~InferenceRunner() = default;
   virtual absl::StatusOr<std::vector<Tensor>> Run(
       const std::vector<Tensor>& inputs) = 0;
+
+  // Runs inference like Run(), and calls `done` with the result, possibly on
+  // another thread after RunAsync() returned. `inputs` must stay alive until
+  // `done` is called. The default implementation calls Run() and `done` on
+  // the calling thread.
+  virtual void RunAsync(const std::vector<Tensor>& inputs, RunDone done) {
+    done(Run(inputs));
+  }
 };
 
 }  // namespace mediapipe
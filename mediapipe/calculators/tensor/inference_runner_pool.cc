@@ -0,0 +1,69 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/inference_runner_pool.h"
+
+#include <utility>
+
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+
+// static
+absl::StatusOr<std::unique_ptr<InferenceRunner>> InferenceRunnerPool::Create(
+    int size,
+    const std::function<absl::StatusOr<std::unique_ptr<InferenceRunner>>()>&
+        create_runner) {
+  RET_CHECK_GT(size, 0);
+  if (size == 1) {
+    return create_runner();
+  }
+  std::vector<std::unique_ptr<InferenceRunner>> runners;
+  runners.reserve(size);
+  for (int i = 0; i < size; ++i) {
+    ASSIGN_OR_RETURN(std::unique_ptr<InferenceRunner> runner, create_runner());
+    runners.push_back(std::move(runner));
+  }
+  return std::make_unique<InferenceRunnerPool>(std::move(runners));
+}
+
+InferenceRunnerPool::InferenceRunnerPool(
+    std::vector<std::unique_ptr<InferenceRunner>> runners)
+    : runners_(std::move(runners)) {
+  for (const auto& runner : runners_) {
+    idle_runners_.push_back(runner.get());
+  }
+}
+
+absl::StatusOr<std::vector<Tensor>> InferenceRunnerPool::Run(
+    const std::vector<Tensor>& inputs) {
+  InferenceRunner* runner;
+  {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(
+        +[](std::vector<InferenceRunner*>* idle_runners) {
+          return !idle_runners->empty();
+        },
+        &idle_runners_));
+    runner = idle_runners_.back();
+    idle_runners_.pop_back();
+  }
+  absl::StatusOr<std::vector<Tensor>> outputs = runner->Run(inputs);
+  absl::MutexLock lock(&mutex_);
+  idle_runners_.push_back(runner);
+  return outputs;
+}
+
+}  // namespace mediapipe
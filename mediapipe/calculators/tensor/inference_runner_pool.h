@@ -0,0 +1,60 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_RUNNER_POOL_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_RUNNER_POOL_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/framework/formats/tensor.h"
+
+namespace mediapipe {
+
+// An InferenceRunner that lets concurrent Run() calls proceed in parallel on
+// a fixed pool of runners, e.g. interpreters that share one model. Each call
+// runs on an idle runner of the pool, and waits for one if they are all busy.
+//
+// This makes inference calculators safe to run with max_in_flight > 1; the
+// framework already emits the outputs of parallel invocations in timestamp
+// order.
+class InferenceRunnerPool : public InferenceRunner {
+ public:
+  // Creates `size` runners with `create_runner`. Returns the single runner
+  // itself when `size` is 1.
+  static absl::StatusOr<std::unique_ptr<InferenceRunner>> Create(
+      int size,
+      const std::function<absl::StatusOr<std::unique_ptr<InferenceRunner>>()>&
+          create_runner);
+
+  explicit InferenceRunnerPool(
+      std::vector<std::unique_ptr<InferenceRunner>> runners);
+
+  absl::StatusOr<std::vector<Tensor>> Run(
+      const std::vector<Tensor>& inputs) override;
+
+ private:
+  const std::vector<std::unique_ptr<InferenceRunner>> runners_;
+
+  absl::Mutex mutex_;
+  std::vector<InferenceRunner*> idle_runners_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_RUNNER_POOL_H_
@@ -0,0 +1,108 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/inference_runner_pool.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+// Counts the concurrent Run() calls and waits in each until `release` is
+// notified.
+class BlockingRunner : public InferenceRunner {
+ public:
+  BlockingRunner(std::atomic<int>* in_flight, std::atomic<int>* max_in_flight,
+                 absl::Notification* release)
+      : in_flight_(in_flight),
+        max_in_flight_(max_in_flight),
+        release_(release) {}
+
+  absl::StatusOr<std::vector<Tensor>> Run(
+      const std::vector<Tensor>& inputs) override {
+    const int in_flight = ++*in_flight_;
+    int max_in_flight = max_in_flight_->load();
+    while (in_flight > max_in_flight &&
+           !max_in_flight_->compare_exchange_weak(max_in_flight, in_flight)) {
+    }
+    release_->WaitForNotificationWithTimeout(absl::Seconds(10));
+    --*in_flight_;
+    return std::vector<Tensor>();
+  }
+
+ private:
+  std::atomic<int>* in_flight_;
+  std::atomic<int>* max_in_flight_;
+  absl::Notification* release_;
+};
+
+TEST(InferenceRunnerPoolTest, CreatesSingleRunnerWithoutPool) {
+  int num_created = 0;
+  absl::Notification release;
+  std::atomic<int> in_flight{0};
+  std::atomic<int> max_in_flight{0};
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto runner,
+      InferenceRunnerPool::Create(
+          1, [&]() -> absl::StatusOr<std::unique_ptr<InferenceRunner>> {
+            ++num_created;
+            return std::make_unique<BlockingRunner>(&in_flight,
+                                                    &max_in_flight, &release);
+          }));
+
+  EXPECT_EQ(num_created, 1);
+  EXPECT_NE(dynamic_cast<BlockingRunner*>(runner.get()), nullptr);
+}
+
+TEST(InferenceRunnerPoolTest, RunsConcurrentlyUpToPoolSize) {
+  constexpr int kPoolSize = 3;
+  absl::Notification release;
+  std::atomic<int> in_flight{0};
+  std::atomic<int> max_in_flight{0};
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto pool,
+      InferenceRunnerPool::Create(
+          kPoolSize, [&]() -> absl::StatusOr<std::unique_ptr<InferenceRunner>> {
+            return std::make_unique<BlockingRunner>(&in_flight,
+                                                    &max_in_flight, &release);
+          }));
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kPoolSize + 2; ++i) {
+    threads.emplace_back([&pool]() { MP_EXPECT_OK(pool->Run({})); });
+  }
+  // Wait for the pool to be busy before letting the runs finish.
+  while (in_flight.load() < kPoolSize) {
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+  absl::SleepFor(absl::Milliseconds(20));
+  release.Notify();
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_EQ(max_in_flight.load(), kPoolSize);
+  EXPECT_EQ(in_flight.load(), 0);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,62 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/pipelined_inference_runner.h"
+
+#include <utility>
+
+#include "absl/synchronization/notification.h"
+
+namespace mediapipe {
+
+PipelinedInferenceRunner::PipelinedInferenceRunner(InferenceRunner* runner,
+                                                   int max_pending)
+    : runner_(runner),
+      max_pending_(max_pending),
+      thread_("mediapipe_inference", /*num_threads=*/1) {
+  thread_.StartWorkers();
+}
+
+absl::StatusOr<std::vector<Tensor>> PipelinedInferenceRunner::Run(
+    const std::vector<Tensor>& inputs) {
+  absl::StatusOr<std::vector<Tensor>> outputs;
+  absl::Notification done;
+  RunAsync(inputs,
+           [&outputs, &done](absl::StatusOr<std::vector<Tensor>> result) {
+             outputs = std::move(result);
+             done.Notify();
+           });
+  done.WaitForNotification();
+  return outputs;
+}
+
+void PipelinedInferenceRunner::RunAsync(const std::vector<Tensor>& inputs,
+                                        RunDone done) {
+  {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(this, &PipelinedInferenceRunner::CanQueue));
+    ++num_pending_;
+  }
+  thread_.Schedule([this, &inputs, done = std::move(done)]() {
+    absl::StatusOr<std::vector<Tensor>> outputs = runner_->Run(inputs);
+    {
+      // Released before `done`, which may queue the next run.
+      absl::MutexLock lock(&mutex_);
+      --num_pending_;
+    }
+    done(std::move(outputs));
+  });
+}
+
+}  // namespace mediapipe
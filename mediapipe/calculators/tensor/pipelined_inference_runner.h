@@ -0,0 +1,68 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_PIPELINED_INFERENCE_RUNNER_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_PIPELINED_INFERENCE_RUNNER_H_
+
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+
+// An InferenceRunner whose RunAsync() runs inference on a dedicated thread,
+// in the order of the calls, and returns right away. The calling thread can
+// then prepare the inputs of the next run, e.g. upload the next frame, while
+// inference runs on the current one.
+//
+// At most `max_pending` runs are queued or running at a time; RunAsync()
+// blocks while that many are pending. The default of 2 double-buffers the
+// runs: one runs while the inputs of the next one are made ready.
+class PipelinedInferenceRunner : public InferenceRunner {
+ public:
+  // `runner` must outlive the PipelinedInferenceRunner.
+  explicit PipelinedInferenceRunner(InferenceRunner* runner,
+                                    int max_pending = 2);
+
+  // Waits for the pending runs to complete.
+  ~PipelinedInferenceRunner() override = default;
+
+  // Waits for the pending runs, then runs inference on `inputs`.
+  absl::StatusOr<std::vector<Tensor>> Run(
+      const std::vector<Tensor>& inputs) override;
+
+  void RunAsync(const std::vector<Tensor>& inputs, RunDone done) override;
+
+ private:
+  bool CanQueue() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return num_pending_ < max_pending_;
+  }
+
+  InferenceRunner* const runner_;
+  const int max_pending_;
+
+  absl::Mutex mutex_;
+  int num_pending_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  // Destroyed first, which waits for the pending runs.
+  ThreadPool thread_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_PIPELINED_INFERENCE_RUNNER_H_
@@ -0,0 +1,116 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/pipelined_inference_runner.h"
+
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Echoes its input and records the first value of each run, on the thread
+// that the runs are made on.
+class RecordingRunner : public InferenceRunner {
+ public:
+  absl::StatusOr<std::vector<Tensor>> Run(
+      const std::vector<Tensor>& inputs) override {
+    const float value = inputs[0].GetCpuReadView().buffer<float>()[0];
+    {
+      absl::MutexLock lock(&mutex_);
+      values_.push_back(value);
+      thread_ids_.push_back(std::this_thread::get_id());
+    }
+    std::vector<Tensor> outputs;
+    outputs.emplace_back(Tensor::ElementType::kFloat32, Tensor::Shape{1});
+    outputs[0].GetCpuWriteView().buffer<float>()[0] = value;
+    return outputs;
+  }
+
+  std::vector<float> values() {
+    absl::MutexLock lock(&mutex_);
+    return values_;
+  }
+  std::vector<std::thread::id> thread_ids() {
+    absl::MutexLock lock(&mutex_);
+    return thread_ids_;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<float> values_;
+  std::vector<std::thread::id> thread_ids_;
+};
+
+std::vector<Tensor> MakeInput(float value) {
+  std::vector<Tensor> inputs;
+  inputs.emplace_back(Tensor::ElementType::kFloat32, Tensor::Shape{1});
+  inputs[0].GetCpuWriteView().buffer<float>()[0] = value;
+  return inputs;
+}
+
+TEST(PipelinedInferenceRunnerTest, RunsInOrderOnOwnThread) {
+  constexpr int kNumRuns = 5;
+  RecordingRunner runner;
+  std::vector<std::vector<Tensor>> inputs;
+  for (int i = 0; i < kNumRuns; ++i) {
+    inputs.push_back(MakeInput(i));
+  }
+
+  std::vector<float> results;
+  absl::Mutex results_mutex;
+  {
+    PipelinedInferenceRunner pipelined_runner(&runner);
+    for (int i = 0; i < kNumRuns; ++i) {
+      pipelined_runner.RunAsync(
+          inputs[i], [&](absl::StatusOr<std::vector<Tensor>> outputs) {
+            MP_ASSERT_OK(outputs);
+            absl::MutexLock lock(&results_mutex);
+            results.push_back(
+                (*outputs)[0].GetCpuReadView().buffer<float>()[0]);
+          });
+    }
+    // Destroying the runner waits for the pending runs.
+  }
+
+  EXPECT_THAT(runner.values(), ElementsAre(0, 1, 2, 3, 4));
+  EXPECT_THAT(results, ElementsAre(0, 1, 2, 3, 4));
+  for (const std::thread::id& thread_id : runner.thread_ids()) {
+    EXPECT_NE(thread_id, std::this_thread::get_id());
+  }
+}
+
+TEST(PipelinedInferenceRunnerTest, RunWaitsForResult) {
+  RecordingRunner runner;
+  PipelinedInferenceRunner pipelined_runner(&runner);
+
+  MP_ASSERT_OK_AND_ASSIGN(std::vector<Tensor> outputs,
+                          pipelined_runner.Run(MakeInput(7.0f)));
+
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_EQ(outputs[0].GetCpuReadView().buffer<float>()[0], 7.0f);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -12,8 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cstdint>
-#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
@@ -21,6 +21,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "mediapipe/calculators/tensor/regex_preprocessor_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/port.h"
@@ -30,19 +31,24 @@
 #include "mediapipe/tasks/cc/metadata/metadata_extractor.h"
 #include "mediapipe/tasks/cc/text/tokenizers/regex_tokenizer.h"
 #include "mediapipe/tasks/cc/text/tokenizers/tokenizer_utils.h"
+#include "mediapipe/tasks/cc/text/utils/token_ids_cache.h"
 #include "mediapipe/tasks/metadata/metadata_schema_generated.h"
 
 namespace mediapipe {
 namespace api2 {
 
 using ::mediapipe::tasks::metadata::ModelMetadataExtractor;
+using ::mediapipe::tasks::text::TokenIdsCache;
 
 // Preprocesses input text into one int32 input tensor for a text model using
 // a RegexTokenizer.
 //
 // Inputs:
-//   TEXT - std::string
+//   TEXT - std::string @Optional
 //     The input text.
+//   TEXTS - std::vector<std::string> @Optional
+//     A batch of input texts, preprocessed into one batch tensor. Exactly one
+//     of TEXT and TEXTS must be connected.
 // Side Inputs:
 //   METADATA_EXTRACTOR - ModelMetadataExtractor
 //     The metadata extractor for the text model. Used to extract the metadata
@@ -56,7 +62,7 @@ using ::mediapipe::tasks::metadata::ModelMetadataExtractor;
 //     be the ids of the tokens of the input text. Any out-of-vocab tokens will
 //     have the id of the <UNKNOWN> token. The tensor will be padded with the
 //     <PAD> token id to have size equal to the max sequence length for the text
-//     model.
+//     model. For TEXTS, the tensor has an additional leading batch dimension.
 //
 // Example:
 // node {
@@ -67,17 +73,20 @@ using ::mediapipe::tasks::metadata::ModelMetadataExtractor;
 //   options {
 //     [mediapipe.RegexPreprocessorCalculatorOptions.ext] {
 //       max_seq_len: 256
+//       cache_size: 1000
 //     }
 //   }
 // }
 class RegexPreprocessorCalculator : public Node {
  public:
-  static constexpr Input<std::string> kTextIn{"TEXT"};
+  static constexpr Input<std::string>::Optional kTextIn{"TEXT"};
+  static constexpr Input<std::vector<std::string>>::Optional kTextsIn{"TEXTS"};
   static constexpr SideInput<ModelMetadataExtractor> kMetadataExtractorSideIn{
       "METADATA_EXTRACTOR"};
   static constexpr Output<std::vector<Tensor>> kTensorsOut{"TENSORS"};
 
-  MEDIAPIPE_NODE_CONTRACT(kTextIn, kMetadataExtractorSideIn, kTensorsOut);
+  MEDIAPIPE_NODE_CONTRACT(kTextIn, kTextsIn, kMetadataExtractorSideIn,
+                          kTensorsOut);
 
   static absl::Status UpdateContract(CalculatorContract* cc);
   absl::Status Open(CalculatorContext* cc) override;
@@ -87,6 +96,23 @@ class RegexPreprocessorCalculator : public Node {
   std::unique_ptr<tasks::text::tokenizers::RegexTokenizer> tokenizer_;
   // The max sequence length accepted by the text model.
   int max_seq_len_ = 0;
+  int unknown_token_id_ = 0;
+  int pad_token_id_ = 0;
+  // The token ids of recent input texts, if enabled.
+  std::unique_ptr<TokenIdsCache> cache_;
+  // The token ids of the last input text when there is no cache.
+  std::vector<int32_t> token_ids_;
+
+  // Applies `tokenizer_` to the `input_text` to generate at most
+  // `max_seq_len_` token ids, starting with the <START> token id if any.
+  std::vector<int32_t> TokenizeInputText(const std::string& input_text);
+  // Returns the token ids of `input_text`, from `cache_` if possible. The ids
+  // are valid until the next call.
+  const std::vector<int32_t>& GetTokenIds(const std::string& input_text);
+  // Processes the `input_texts` to generate the input tensor of the text
+  // model, with shape `shape`.
+  std::vector<Tensor> GenerateInputTensors(
+      absl::Span<const std::string> input_texts, const Tensor::Shape& shape);
 };
 
 absl::Status RegexPreprocessorCalculator::UpdateContract(
@@ -95,6 +121,9 @@ absl::Status RegexPreprocessorCalculator::UpdateContract(
       cc->Options<mediapipe::RegexPreprocessorCalculatorOptions>();
   RET_CHECK(options.has_max_seq_len()) << "max_seq_len is required";
   RET_CHECK_GT(options.max_seq_len(), 0) << "max_seq_len must be positive";
+  RET_CHECK_GE(options.cache_size(), 0) << "cache_size must be non-negative";
+  RET_CHECK(kTextIn(cc).IsConnected() ^ kTextsIn(cc).IsConnected())
+      << "Exactly one of TEXT and TEXTS must be connected";
   return absl::OkStatus();
 }
 
@@ -123,49 +152,84 @@ absl::Status RegexPreprocessorCalculator::Open(CalculatorContext* cc) {
   const auto& options =
       cc->Options<mediapipe::RegexPreprocessorCalculatorOptions>();
   max_seq_len_ = options.max_seq_len();
+  tokenizer_->GetUnknownToken(&unknown_token_id_);
+  tokenizer_->GetPadToken(&pad_token_id_);
+  if (options.cache_size() > 0) {
+    cache_ = std::make_unique<TokenIdsCache>(options.cache_size());
+  }
   return absl::OkStatus();
 }
 
 absl::Status RegexPreprocessorCalculator::Process(CalculatorContext* cc) {
-  tasks::text::tokenizers::TokenizerResult tokenizer_result =
-      tokenizer_->Tokenize(kTextIn(cc).Get());
+  if (kTextIn(cc).IsConnected()) {
+    kTensorsOut(cc).Send(
+        GenerateInputTensors(absl::MakeConstSpan(&kTextIn(cc).Get(), 1),
+                             Tensor::Shape({max_seq_len_})));
+  } else {
+    const std::vector<std::string>& texts = kTextsIn(cc).Get();
+    kTensorsOut(cc).Send(GenerateInputTensors(
+        texts,
+        Tensor::Shape({static_cast<int>(texts.size()), max_seq_len_})));
+  }
+  return absl::OkStatus();
+}
 
-  int unknown_token_id = 0;
-  tokenizer_->GetUnknownToken(&unknown_token_id);
-  int pad_token_id = 0;
-  tokenizer_->GetPadToken(&pad_token_id);
+std::vector<int32_t> RegexPreprocessorCalculator::TokenizeInputText(
+    const std::string& input_text) {
+  tasks::text::tokenizers::TokenizerResult tokenizer_result =
+      tokenizer_->Tokenize(input_text);
 
-  std::vector<int> input_tokens(max_seq_len_, pad_token_id);
+  std::vector<int32_t> input_tokens;
+  input_tokens.reserve(std::min<int>(
+      max_seq_len_, tokenizer_result.subwords.size() + 1));
   int start_token_id = 0;
-  int input_token_index = 0;
   if (tokenizer_->GetStartToken(&start_token_id)) {
-    input_tokens[0] = start_token_id;
-    input_token_index = 1;
+    input_tokens.push_back(start_token_id);
   }
 
   for (int i = 0; (i < tokenizer_result.subwords.size()) &&
-                  (input_token_index < max_seq_len_);
-       ++i, ++input_token_index) {
+                  (input_tokens.size() < max_seq_len_);
+       ++i) {
     const std::string& token = tokenizer_result.subwords[i];
     int token_id = 0;
     if (tokenizer_->LookupId(token, &token_id)) {
-      input_tokens[input_token_index] = token_id;
+      input_tokens.push_back(token_id);
     } else {
-      input_tokens[input_token_index] = unknown_token_id;
+      input_tokens.push_back(unknown_token_id_);
     }
   }
+  return input_tokens;
+}
 
+const std::vector<int32_t>& RegexPreprocessorCalculator::GetTokenIds(
+    const std::string& input_text) {
+  if (cache_ == nullptr) {
+    token_ids_ = TokenizeInputText(input_text);
+    return token_ids_;
+  }
+  if (const std::vector<int32_t>* input_tokens = cache_->Lookup(input_text)) {
+    return *input_tokens;
+  }
+  return cache_->Insert(input_text, TokenizeInputText(input_text));
+}
+
+std::vector<Tensor> RegexPreprocessorCalculator::GenerateInputTensors(
+    absl::Span<const std::string> input_texts, const Tensor::Shape& shape) {
   //                              |<-------sentence_length-------->|
   // input_tensor                 <START>, t1, t2... <PAD>, <PAD>...
   // <START> is optional, t1, t2... will be replaced by <UNKNOWN> if it's
   // not found in the tokenizer vocab.
   std::vector<Tensor> result;
-  result.push_back(
-      {Tensor::ElementType::kInt32, Tensor::Shape({max_seq_len_})});
-  std::memcpy(result[0].GetCpuWriteView().buffer<int32_t>(),
-              input_tokens.data(), input_tokens.size() * sizeof(int32_t));
-  kTensorsOut(cc).Send(std::move(result));
-  return absl::OkStatus();
+  result.push_back({Tensor::ElementType::kInt32, shape});
+  auto view = result[0].GetCpuWriteView();
+  int32_t* input_tokens = view.buffer<int32_t>();
+  std::fill(input_tokens, input_tokens + shape.num_elements(), pad_token_id_);
+  for (const std::string& input_text : input_texts) {
+    const std::vector<int32_t>& text_tokens = GetTokenIds(input_text);
+    std::copy(text_tokens.begin(), text_tokens.end(), input_tokens);
+    input_tokens += max_seq_len_;
+  }
+  return result;
 }
 
 MEDIAPIPE_REGISTER_NODE(RegexPreprocessorCalculator);
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -20,6 +21,9 @@
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/tensor_element_conversion.h"
+#include "mediapipe/framework/formats/tensor_pool.h"
+#include "mediapipe/framework/memory_budget.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/resource_util.h"
@@ -34,10 +38,8 @@
 #import "mediapipe/gpu/MPPMetalHelper.h"
 #elif MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30
 #include "mediapipe/gpu/gl_calculator_helper.h"
-#if MEDIAPIPE_OPENGL_ES_VERSION < MEDIAPIPE_OPENGL_ES_31
 #include "mediapipe/gpu/gl_simple_shaders.h"
 #include "mediapipe/gpu/shader_util.h"
-#endif  // MEDIAPIPE_OPENGL_ES_VERSION < MEDIAPIPE_OPENGL_ES_31
 #endif  // MEDIAPIPE_METAL_ENABLED
 #endif  // !MEDIAPIPE_DISABLE_GPU
 
@@ -78,10 +80,13 @@ namespace mediapipe {
 //
 // Output:
 //  One of the following tags:
-//  TENSORS - Vector of Tensors of type kFloat32. The resource type used:
+//  TENSORS - Vector of Tensors of type kFloat32, or kFloat16 on CPU when
+//          use_float16_tensors is set. The resource type used:
 //          - MTLBuffer if Metal API is available
 //          - SSBO if Metal is unavailable and OpenGL ES 3.1 is available
 //          - Texture2D if Metal and GLES 3.1 are not available and GLES 3.0 is.
+//          - Texture2D if gpu_output is GPU_OUTPUT_TEXTURE and GLES 3.0 is
+//            available.
 //
 // Example use:
 // node {
@@ -114,6 +119,11 @@ class TensorConverterCalculator : public CalculatorBase {
                               bool flip_vertically, float* tensor_ptr);
   absl::Status CopyMatrixToTensor(const Matrix& matrix, float* tensor_ptr);
   absl::Status ProcessCPU(CalculatorContext* cc);
+  // Returns the buffer to write the float32 values of "tensor" into. For a
+  // kFloat16 tensor this is a staging buffer, which FinishFloatBuffer() then
+  // converts into the tensor.
+  float* GetFloatBuffer(const Tensor& tensor, Tensor::CpuWriteView& view);
+  void FinishFloatBuffer(const Tensor& tensor, Tensor::CpuWriteView& view);
   absl::Status ProcessGPU(CalculatorContext* cc);
 
 #if MEDIAPIPE_METAL_ENABLED
@@ -122,20 +132,28 @@ class TensorConverterCalculator : public CalculatorBase {
 #elif MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30
   mediapipe::GlCalculatorHelper gpu_helper_;
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
-  GLuint to_buffer_program_;
-#else
-  enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
-  GLuint to_tex2d_program_;
-  GLuint framebuffer_;
+  GLuint to_buffer_program_ = 0;
 #endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+  enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
+  GLuint to_tex2d_program_ = 0;
+  GLuint framebuffer_ = 0;
 #endif  // MEDIAPIPE_METAL_ENABLED
 
   bool initialized_ = false;
   bool use_gpu_ = false;
+  // Whether IMAGE_GPU inputs are converted into a texture rather than an SSBO.
+  bool use_texture_output_ = false;
+  TensorConverterCalculatorOptions::GpuOutput gpu_output_ =
+      TensorConverterCalculatorOptions::GPU_OUTPUT_DEFAULT;
   absl::optional<std::pair<float, float>> output_range_;
   bool flip_vertically_ = false;
   bool row_major_matrix_ = false;
   int max_num_channels_ = 3;
+  bool use_float16_tensors_ = false;
+  // Holds the float32 values of a kFloat16 output tensor before conversion.
+  std::vector<float> float16_staging_;
+  // Reuses the buffers of the output tensors across frames.
+  std::shared_ptr<TensorPool> tensor_pool_ = TensorPool::Create();
 };
 REGISTER_CALCULATOR(TensorConverterCalculator);
 
@@ -166,6 +184,7 @@ absl::Status TensorConverterCalculator::GetContract(CalculatorContract* cc) {
 
   RET_CHECK(cc->Outputs().HasTag(kTensorsTag));
   cc->Outputs().Tag(kTensorsTag).Set<std::vector<Tensor>>();
+  cc->UseService(kMemoryBudgetService).Optional();
   return absl::OkStatus();
 }
 
@@ -173,6 +192,10 @@ absl::Status TensorConverterCalculator::Open(CalculatorContext* cc) {
   cc->SetOffset(TimestampDiff(0));
 
   MP_RETURN_IF_ERROR(LoadOptions(cc));
+  if (cc->Service(kMemoryBudgetService).IsAvailable()) {
+    tensor_pool_->SetMemoryBudget(
+        cc->Service(kMemoryBudgetService).GetObject().shared_from_this());
+  }
 
 #if !MEDIAPIPE_DISABLE_GPU
   if (cc->Inputs().HasTag(kGpuBufferTag)) {
@@ -180,8 +203,20 @@ absl::Status TensorConverterCalculator::Open(CalculatorContext* cc) {
 #if MEDIAPIPE_METAL_ENABLED
     gpu_helper_ = [[MPPMetalHelper alloc] initWithCalculatorContext:cc];
     RET_CHECK(gpu_helper_);
+    RET_CHECK_NE(gpu_output_,
+                 TensorConverterCalculatorOptions::GPU_OUTPUT_TEXTURE)
+        << "Texture output is not supported with Metal.";
 #elif MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30
     MP_RETURN_IF_ERROR(gpu_helper_.Open(cc));
+#if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+    use_texture_output_ =
+        gpu_output_ == TensorConverterCalculatorOptions::GPU_OUTPUT_TEXTURE;
+#else
+    RET_CHECK_NE(gpu_output_,
+                 TensorConverterCalculatorOptions::GPU_OUTPUT_BUFFER)
+        << "SSBO output requires OpenGL ES 3.1.";
+    use_texture_output_ = true;
+#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
 #endif  // MEDIAPIPE_METAL_ENABLED
   }
 #endif  // !MEDIAPIPE_DISABLE_GPU
@@ -212,10 +247,9 @@ absl::Status TensorConverterCalculator::Close(CalculatorContext* cc) {
     gpu_helper_.RunInGlContext([this] {
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
       glDeleteProgram(to_buffer_program_);
-#else
+#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
       glDeleteFramebuffers(1, &framebuffer_);
       glDeleteProgram(to_tex2d_program_);
-#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
     });
 #endif  // MEDIAPIPE_METAL_ENABLED
   }
@@ -243,22 +277,26 @@ absl::Status TensorConverterCalculator::ProcessCPU(CalculatorContext* cc) {
           format == mediapipe::ImageFormat::VEC32F1))
       RET_CHECK_FAIL() << "Unsupported CPU input format.";
 
-    output_tensors->emplace_back(
-        Tensor::ElementType::kFloat32,
-        Tensor::Shape{1, height, width, channels_preserved});
-    auto cpu_view = output_tensors->back().GetCpuWriteView();
+    output_tensors->push_back(tensor_pool_->GetTensor(
+        use_float16_tensors_ ? Tensor::ElementType::kFloat16
+                             : Tensor::ElementType::kFloat32,
+        Tensor::Shape{1, height, width, channels_preserved}));
+    const Tensor& tensor = output_tensors->back();
+    auto cpu_view = tensor.GetCpuWriteView();
+    float* tensor_ptr = GetFloatBuffer(tensor, cpu_view);
 
     // Copy image data into tensor.
     if (image_frame.ByteDepth() == 1) {
-      MP_RETURN_IF_ERROR(NormalizeImage<uint8>(image_frame, flip_vertically_,
-                                               cpu_view.buffer<float>()));
+      MP_RETURN_IF_ERROR(
+          NormalizeImage<uint8>(image_frame, flip_vertically_, tensor_ptr));
     } else if (image_frame.ByteDepth() == 4) {
-      MP_RETURN_IF_ERROR(NormalizeImage<float>(image_frame, flip_vertically_,
-                                               cpu_view.buffer<float>()));
+      MP_RETURN_IF_ERROR(
+          NormalizeImage<float>(image_frame, flip_vertically_, tensor_ptr));
     } else {
       return absl::InternalError(
           "Only byte-based (8 bit) and float (32 bit) images supported.");
     }
+    FinishFloatBuffer(tensor, cpu_view);
   } else if (cc->Inputs().HasTag(kMatrixTag)) {
     if (cc->Inputs().Tag(kMatrixTag).IsEmpty()) {
       return absl::OkStatus();
@@ -267,10 +305,15 @@ absl::Status TensorConverterCalculator::ProcessCPU(CalculatorContext* cc) {
     const int height = matrix.rows();
     const int width = matrix.cols();
     const int channels = 1;
-    output_tensors->emplace_back(Tensor::ElementType::kFloat32,
-                                 Tensor::Shape{1, height, width, channels});
-    MP_RETURN_IF_ERROR(CopyMatrixToTensor(
-        matrix, output_tensors->back().GetCpuWriteView().buffer<float>()));
+    output_tensors->push_back(tensor_pool_->GetTensor(
+        use_float16_tensors_ ? Tensor::ElementType::kFloat16
+                             : Tensor::ElementType::kFloat32,
+        Tensor::Shape{1, height, width, channels}));
+    const Tensor& tensor = output_tensors->back();
+    auto cpu_view = tensor.GetCpuWriteView();
+    MP_RETURN_IF_ERROR(
+        CopyMatrixToTensor(matrix, GetFloatBuffer(tensor, cpu_view)));
+    FinishFloatBuffer(tensor, cpu_view);
   } else {
     return absl::OkStatus();
   }
@@ -281,6 +324,23 @@ absl::Status TensorConverterCalculator::ProcessCPU(CalculatorContext* cc) {
   return absl::OkStatus();
 }
 
+float* TensorConverterCalculator::GetFloatBuffer(const Tensor& tensor,
+                                                 Tensor::CpuWriteView& view) {
+  if (tensor.element_type() != Tensor::ElementType::kFloat16) {
+    return view.buffer<float>();
+  }
+  float16_staging_.resize(tensor.shape().num_elements());
+  return float16_staging_.data();
+}
+
+void TensorConverterCalculator::FinishFloatBuffer(const Tensor& tensor,
+                                                  Tensor::CpuWriteView& view) {
+  if (tensor.element_type() == Tensor::ElementType::kFloat16) {
+    Float32ToFloat16(float16_staging_.data(), tensor.shape().num_elements(),
+                     view.buffer<uint16_t>());
+  }
+}
+
 absl::Status TensorConverterCalculator::ProcessGPU(CalculatorContext* cc) {
 #if !MEDIAPIPE_DISABLE_GPU
   if (!initialized_) {
@@ -293,8 +353,9 @@ absl::Status TensorConverterCalculator::ProcessGPU(CalculatorContext* cc) {
   int height = input.height();
   int channels = max_num_channels_;
   auto output_tensors = absl::make_unique<std::vector<Tensor>>();
-  output_tensors->emplace_back(Tensor::ElementType::kFloat32,
-                               Tensor::Shape{1, height, width, channels});
+  output_tensors->push_back(
+      tensor_pool_->GetTensor(Tensor::ElementType::kFloat32,
+                              Tensor::Shape{1, height, width, channels}));
 #if MEDIAPIPE_METAL_ENABLED
   id<MTLDevice> device = gpu_helper_.mtlDevice;
   id<MTLCommandBuffer> command_buffer = [gpu_helper_ commandBuffer];
@@ -320,18 +381,22 @@ absl::Status TensorConverterCalculator::ProcessGPU(CalculatorContext* cc) {
       [this, &output_tensors, &input]() -> absl::Status {
         auto src = gpu_helper_.CreateSourceTexture(input);
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
-        // Convert GL texture into SSBO.
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, src.name());
-        auto output_view = output_tensors->back().GetOpenGlBufferWriteView();
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, output_view.name());
-        glUseProgram(to_buffer_program_);
-        glDispatchCompute(NumGroups(input.width(), kWorkgroupSize),
-                          NumGroups(input.height(), kWorkgroupSize), 1);
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
-        glBindTexture(GL_TEXTURE_2D, 0);
-#else
-        // Texture2D -> Texture2D with OpenGL ES 3.0.
+        if (!use_texture_output_) {
+          // Convert GL texture into SSBO.
+          glActiveTexture(GL_TEXTURE0);
+          glBindTexture(GL_TEXTURE_2D, src.name());
+          auto output_view = output_tensors->back().GetOpenGlBufferWriteView();
+          glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, output_view.name());
+          glUseProgram(to_buffer_program_);
+          glDispatchCompute(NumGroups(input.width(), kWorkgroupSize),
+                            NumGroups(input.height(), kWorkgroupSize), 1);
+          glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+          glBindTexture(GL_TEXTURE_2D, 0);
+          src.Release();
+          return absl::OkStatus();
+        }
+#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+        // Texture2D -> Texture2D.
         glUseProgram(to_tex2d_program_);
         glDisable(GL_DEPTH_TEST);
         glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
@@ -358,7 +423,6 @@ absl::Status TensorConverterCalculator::ProcessGPU(CalculatorContext* cc) {
         glBindTexture(GL_TEXTURE_2D, 0);
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, 0);
-#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
         src.Release();
         return absl::OkStatus();
       }));
@@ -442,60 +506,70 @@ absl::Status TensorConverterCalculator::InitGpu(CalculatorContext* cc) {
   RET_CHECK(to_buffer_program_ != nil) << "Couldn't create pipeline state " <<
       [[error localizedDescription] UTF8String];
 #elif MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30
-  MP_RETURN_IF_ERROR(gpu_helper_.RunInGlContext([this, &include_alpha,
-#if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
-                                                 &input,
-#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+  MP_RETURN_IF_ERROR(gpu_helper_.RunInGlContext([this, &include_alpha, &input,
                                                  &single_channel]()
                                                     -> absl::Status {
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
-    // Shader to convert GL Texture to Shader Storage Buffer Object (SSBO),
-    // with normalization to either: [0,1] or [-1,1].
-    const std::string shader_source = absl::Substitute(
-        R"( #version 310 es
-          layout(local_size_x = $0, local_size_y = $0) in;
-          layout(binding = 0) uniform sampler2D input_texture;
+    if (!use_texture_output_) {
+      // Shader to convert GL Texture to Shader Storage Buffer Object (SSBO),
+      // with normalization to either: [0,1] or [-1,1].
+      const std::string shader_source = absl::Substitute(
+          R"( #version 310 es
+            layout(local_size_x = $0, local_size_y = $0) in;
+            layout(binding = 0) uniform sampler2D input_texture;
           layout(std430, binding = 1) buffer Output {float elements[];} output_data;
-          ivec2 width_height = ivec2($1, $2);
-          void main() {
-            ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
-            if (gid.x >= width_height.x || gid.y >= width_height.y) return;
-            vec4 pixel = texelFetch(input_texture, gid, 0);
-            $3  // normalize [-1,1]
-            int linear_index = $7 * ($4 * width_height.x + gid.x);
-            output_data.elements[linear_index + 0] = pixel.x;  // r channel
-            $5  // g & b channels
-            $6  // alpha channel
-          })",
-        /*$0=*/kWorkgroupSize, /*$1=*/input.width(), /*$2=*/input.height(),
-        /*$3=*/
-        output_range_.has_value()
-            ? absl::Substitute("pixel = pixel * float($0) + float($1);",
-                               (output_range_->second - output_range_->first),
-                               output_range_->first)
-            : "",
-        /*$4=*/flip_vertically_ ? "(width_height.y - 1 - gid.y)" : "gid.y",
-        /*$5=*/
-        single_channel ? ""
-                       : R"(output_data.elements[linear_index + 1] = pixel.y;
+            ivec2 width_height = ivec2($1, $2);
+            void main() {
+              ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
+              if (gid.x >= width_height.x || gid.y >= width_height.y) return;
+              vec4 pixel = texelFetch(input_texture, gid, 0);
+              $3  // normalize [-1,1]
+              int linear_index = $7 * ($4 * width_height.x + gid.x);
+              output_data.elements[linear_index + 0] = pixel.x;  // r channel
+              $5  // g & b channels
+              $6  // alpha channel
+            })",
+          /*$0=*/kWorkgroupSize, /*$1=*/input.width(), /*$2=*/input.height(),
+          /*$3=*/
+          output_range_.has_value()
+              ? absl::Substitute("pixel = pixel * float($0) + float($1);",
+                                 (output_range_->second - output_range_->first),
+                                 output_range_->first)
+              : "",
+          /*$4=*/flip_vertically_ ? "(width_height.y - 1 - gid.y)" : "gid.y",
+          /*$5=*/
+          single_channel ? ""
+                         : R"(output_data.elements[linear_index + 1] = pixel.y;
                             output_data.elements[linear_index + 2] = pixel.z;)",
-        /*$6=*/
-        include_alpha ? "output_data.elements[linear_index + 3] = pixel.w;"
-                      : "",
-        /*$7=*/max_num_channels_);
-    GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
-    const GLchar* sources[] = {shader_source.c_str()};
-    glShaderSource(shader, 1, sources, NULL);
-    glCompileShader(shader);
-    GLint compiled = GL_FALSE;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
-    RET_CHECK(compiled == GL_TRUE);
-    to_buffer_program_ = glCreateProgram();
-    glAttachShader(to_buffer_program_, shader);
-    glDeleteShader(shader);
-    glLinkProgram(to_buffer_program_);
-#else
-    // OpenGL ES 3.0 fragment shader Texture2d -> Texture2d conversion.
+          /*$6=*/
+          include_alpha ? "output_data.elements[linear_index + 3] = pixel.w;"
+                        : "",
+          /*$7=*/max_num_channels_);
+      GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+      const GLchar* sources[] = {shader_source.c_str()};
+      glShaderSource(shader, 1, sources, NULL);
+      glCompileShader(shader);
+      GLint compiled = GL_FALSE;
+      glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+      RET_CHECK(compiled == GL_TRUE);
+      to_buffer_program_ = glCreateProgram();
+      glAttachShader(to_buffer_program_, shader);
+      glDeleteShader(shader);
+      glLinkProgram(to_buffer_program_);
+      return absl::OkStatus();
+    }
+#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+    // The fragment shader below draws one pixel per tensor element, which
+    // matches the texture only in its aligned layout.
+    int texture_width;
+    int texture_height;
+    RET_CHECK(Tensor::OpenGlTexture2dView::GetLayoutDimensions(
+                  Tensor::Shape{1, input.height(), input.width(),
+                                max_num_channels_},
+                  &texture_width, &texture_height) ==
+              Tensor::OpenGlTexture2dView::Layout::kAligned)
+        << "The input is too large for texture output.";
+    // Fragment shader Texture2d -> Texture2d conversion.
     const std::string shader_source = absl::Substitute(
         R"(
         #if __VERSION__ < 130
@@ -556,8 +630,6 @@ absl::Status TensorConverterCalculator::InitGpu(CalculatorContext* cc) {
     glUseProgram(to_tex2d_program_);
     glUniform1i(glGetUniformLocation(to_tex2d_program_, "frame"), 1);
     glGenFramebuffers(1, &framebuffer_);
-
-#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
     return absl::OkStatus();
   }));
 #endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30
@@ -598,6 +670,12 @@ absl::Status TensorConverterCalculator::LoadOptions(CalculatorContext* cc) {
   // Get row_major_matrix mode.
   row_major_matrix_ = options.row_major_matrix();
 
+  // Get half-precision output mode.
+  use_float16_tensors_ = options.use_float16_tensors();
+
+  // Get the GPU object to write IMAGE_GPU inputs to.
+  gpu_output_ = options.gpu_output();
+
   // Get desired way to handle input channels.
   max_num_channels_ = options.max_num_channels();
   CHECK_GE(max_num_channels_, 1);
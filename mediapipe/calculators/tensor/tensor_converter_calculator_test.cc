@@ -24,6 +24,7 @@
 #include "mediapipe/framework/formats/image_frame_opencv.h"
 #include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/tensor_element_conversion.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
@@ -252,6 +253,58 @@ TEST_F(TensorConverterCalculatorTest, CustomDivAndSub) {
   MP_ASSERT_OK(graph.WaitUntilDone());
 }
 
+TEST_F(TensorConverterCalculatorTest, Float16Output) {
+  CalculatorGraph graph;
+  CalculatorGraphConfig graph_config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input_image"
+        node {
+          calculator: "TensorConverterCalculator"
+          input_stream: "IMAGE:input_image"
+          output_stream: "TENSORS:tensor"
+          options {
+            [mediapipe.TensorConverterCalculatorOptions.ext] {
+              use_custom_normalization: true
+              custom_div: 2.0
+              custom_sub: 33.0
+              use_float16_tensors: true
+            }
+          }
+        }
+      )pb");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor", &graph_config, &output_packets);
+
+  // Run the graph.
+  MP_ASSERT_OK(graph.Initialize(graph_config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  auto input_image = absl::make_unique<ImageFrame>(ImageFormat::GRAY8, 1, 1);
+  cv::Mat mat = mediapipe::formats::MatView(input_image.get());
+  mat.at<uint8>(0, 0) = 200;
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "input_image", Adopt(input_image.release()).At(Timestamp(0))));
+
+  // Wait until the calculator done processing.
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+
+  // Get and process results.
+  const std::vector<Tensor>& tensor_vec =
+      output_packets[0].Get<std::vector<Tensor>>();
+  EXPECT_EQ(1, tensor_vec.size());
+
+  const Tensor* tensor = &tensor_vec[0];
+  EXPECT_EQ(Tensor::ElementType::kFloat16, tensor->element_type());
+  auto view = tensor->GetCpuReadView();
+  float value;
+  Float16ToFloat32(view.buffer<uint16_t>(), 1, &value);
+  EXPECT_FLOAT_EQ(67.0f, value);
+
+  // Fully close graph at end, otherwise calculator+tensors are destroyed
+  // after calling WaitUntilDone().
+  MP_ASSERT_OK(graph.CloseInputStream("input_image"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
 TEST_F(TensorConverterCalculatorTest, SetOutputRange) {
   std::vector<std::pair<float, float>> range_values = {
       std::make_pair(0.0, 1.0), std::make_pair(-1.0, 1.0),
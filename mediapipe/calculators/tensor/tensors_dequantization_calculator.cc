@@ -17,24 +17,25 @@
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "mediapipe/calculators/tensor/tensors_dequantization_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/tensor_element_conversion.h"
 #include "mediapipe/framework/port/ret_check.h"
 
 namespace mediapipe {
 namespace api2 {
 namespace {
 
-template <typename T>
-void Dequantize(const Tensor& input, Tensor* output) {
+void DequantizeBool(const Tensor& input, int begin, Tensor* output) {
   auto input_view = input.GetCpuReadView();
-  auto input_buffer = input_view.buffer<T>();
+  auto input_buffer = input_view.buffer<bool>() + begin;
   auto output_view = output->GetCpuWriteView();
   auto output_buffer = output_view.buffer<float>();
-  for (int i = 0; i < input.shape().num_elements(); ++i) {
+  for (int i = 0; i < output->shape().num_elements(); ++i) {
     output_buffer[i] = input.quantization_parameters().scale *
                        (static_cast<int>(input_buffer[i]) -
                         input.quantization_parameters().zero_point);
@@ -49,8 +50,16 @@ void Dequantize(const Tensor& input, Tensor* output) {
 //   output = quantization_parameters.scale *
 //     (input - quantization_parameters.zero_point)
 //
+// Float16 input tensors are widened to float32. UInt8 and Int8 tensors are
+// dequantized with AVX2, SSE2 or NEON instructions when available.
+//
+// To avoid dequantizing values nobody reads, the options can select the input
+// tensors to output and a slice of their elements. Note that most tensor
+// decoding calculators also accept quantized tensors directly and only
+// dequantize what they use.
+//
 // Input:
-//  TENSORS - Vector of quantized Tensors of type kUint8 or kInt8.
+//  TENSORS - Vector of Tensors of type kUint8, kInt8, kBool or kFloat16.
 // Output:
 //  TENSORS - Vector of dequantized Tensors of type kFloat32.
 //
@@ -59,6 +68,11 @@ void Dequantize(const Tensor& input, Tensor* output) {
 //   calculator: "TensorsDequantizationCalculator"
 //   input_stream: "TENSORS:quantized_tensors"
 //   output_stream: "TENSORS:dequantized_tensors"
+//   options {
+//     [mediapipe.TensorsDequantizationCalculatorOptions.ext] {
+//       tensor_indices: 0
+//     }
+//   }
 // }
 class TensorsDequantizationCalculator : public Node {
  public:
@@ -66,29 +80,58 @@ class TensorsDequantizationCalculator : public Node {
   static constexpr Output<std::vector<Tensor>> kOutTensors{"TENSORS"};
   MEDIAPIPE_NODE_CONTRACT(kInTensors, kOutTensors);
 
+  absl::Status Open(CalculatorContext* cc) override;
   absl::Status Process(CalculatorContext* cc) override;
+
+ private:
+  ::mediapipe::TensorsDequantizationCalculatorOptions options_;
 };
 
+absl::Status TensorsDequantizationCalculator::Open(CalculatorContext* cc) {
+  options_ = cc->Options<::mediapipe::TensorsDequantizationCalculatorOptions>();
+  RET_CHECK_GE(options_.slice_begin(), 0);
+  return absl::OkStatus();
+}
+
 absl::Status TensorsDequantizationCalculator::Process(CalculatorContext* cc) {
   if (kInTensors(cc).IsEmpty()) {
     return absl::OkStatus();
   }
   const auto& input_tensors = *kInTensors(cc);
   RET_CHECK(!input_tensors.empty());
+  std::vector<int> tensor_indices(options_.tensor_indices().begin(),
+                                  options_.tensor_indices().end());
+  if (tensor_indices.empty()) {
+    for (int i = 0; i < input_tensors.size(); ++i) tensor_indices.push_back(i);
+  }
+  const bool is_sliced =
+      options_.slice_begin() > 0 || options_.slice_size() >= 0;
   auto output_tensors = std::make_unique<std::vector<Tensor>>();
-  output_tensors->reserve(input_tensors.size());
-  for (const auto& input_tensor : input_tensors) {
-    output_tensors->emplace_back(Tensor::ElementType::kFloat32,
-                                 input_tensor.shape());
+  output_tensors->reserve(tensor_indices.size());
+  for (const int index : tensor_indices) {
+    RET_CHECK(index >= 0 && index < input_tensors.size())
+        << "Tensor index " << index << " is out of range.";
+    const Tensor& input_tensor = input_tensors[index];
+    const int begin = options_.slice_begin();
+    const int size = options_.slice_size() >= 0
+                         ? options_.slice_size()
+                         : input_tensor.shape().num_elements() - begin;
+    RET_CHECK_LE(begin + size, input_tensor.shape().num_elements())
+        << "Slice is out of the tensor.";
+    output_tensors->emplace_back(
+        Tensor::ElementType::kFloat32,
+        is_sliced ? Tensor::Shape{size} : input_tensor.shape());
     switch (input_tensor.element_type()) {
       case Tensor::ElementType::kUInt8:
-        Dequantize<uint8>(input_tensor, &output_tensors->back());
-        break;
       case Tensor::ElementType::kInt8:
-        Dequantize<int8>(input_tensor, &output_tensors->back());
+      case Tensor::ElementType::kFloat16: {
+        auto output_view = output_tensors->back().GetCpuWriteView();
+        MP_RETURN_IF_ERROR(CopyTensorToFloat32(input_tensor, begin, size,
+                                               output_view.buffer<float>()));
         break;
+      }
       case Tensor::ElementType::kBool:
-        Dequantize<bool>(input_tensor, &output_tensors->back());
+        DequantizeBool(input_tensor, begin, &output_tensors->back());
         break;
       default:
         return absl::InvalidArgumentError(absl::StrCat(
@@ -134,5 +134,48 @@ TEST_F(TensorsDequantizationCalculatorTest, SucceedsWithBoolTensors) {
   ValidateResult(GetOutput(), {1, 0, 1});
 }
 
+TEST_F(TensorsDequantizationCalculatorTest, SucceedsWithFloat16Tensors) {
+  // The half-precision bits of 1, -2.5 and 0.5.
+  std::vector<uint16_t> tensor = {0x3c00, 0xc100, 0x3800};
+  PushTensor(Tensor::ElementType::kFloat16, tensor);
+
+  MP_ASSERT_OK(runner_.Run());
+
+  ValidateResult(GetOutput(), {1, -2.5, 0.5});
+}
+
+TEST(TensorsDequantizationCalculatorOptionsTest, OutputsSelectedSlices) {
+  CalculatorRunner runner(ParseTextProtoOrDie<Node>(R"pb(
+    calculator: "TensorsDequantizationCalculator"
+    input_stream: "TENSORS:input"
+    output_stream: "TENSORS:output"
+    options {
+      [mediapipe.TensorsDequantizationCalculatorOptions.ext] {
+        tensor_indices: 1
+        slice_begin: 1
+        slice_size: 2
+      }
+    }
+  )pb"));
+  auto tensors = std::make_unique<std::vector<Tensor>>();
+  for (int i = 0; i < 2; ++i) {
+    tensors->emplace_back(Tensor::ElementType::kUInt8, Tensor::Shape{1, 4},
+                          Tensor::QuantizationParameters{0.5f, i});
+    auto view = tensors->back().GetCpuWriteView();
+    uint8_t* buffer = view.buffer<uint8_t>();
+    for (int k = 0; k < 4; ++k) buffer[k] = k * 2;
+  }
+  runner.MutableInputs()->Tag("TENSORS").packets.push_back(
+      Adopt(tensors.release()).At(Timestamp(0)));
+
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& outputs =
+      runner.Outputs().Get("TENSORS", 0).packets[0].Get<std::vector<Tensor>>();
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_EQ(outputs[0].shape().dims, std::vector<int>({2}));
+  ValidateResult(outputs[0], {0.5f, 1.5f});
+}
+
 }  // namespace
 }  // namespace mediapipe
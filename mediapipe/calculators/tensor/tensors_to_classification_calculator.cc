@@ -57,6 +57,10 @@ void SetClassificationLabel(const LabelMapItem label_map_item,
 //  CLASSIFICATIONS - Result MediaPipe ClassificationList. The score and index
 //                    fields of each classification are set, while the label
 //                    field is only set if label_map_path is provided.
+//  MULTI_CLASSIFICATIONS - Result ClassificationList of every item of a batch
+//                          tensor, whose first dimension is the batch size.
+//                          One and only one of CLASSIFICATIONS and
+//                          MULTI_CLASSIFICATIONS must be connected.
 //
 // Usage example:
 // node {
@@ -73,10 +77,14 @@ void SetClassificationLabel(const LabelMapItem label_map_item,
 class TensorsToClassificationCalculator : public Node {
  public:
   static constexpr Input<std::vector<Tensor>> kInTensors{"TENSORS"};
-  static constexpr Output<ClassificationList> kOutClassificationList{
+  static constexpr Output<ClassificationList>::Optional kOutClassificationList{
       "CLASSIFICATIONS"};
-  MEDIAPIPE_NODE_CONTRACT(kInTensors, kOutClassificationList);
+  static constexpr Output<std::vector<ClassificationList>>::Optional
+      kOutMultiClassificationList{"MULTI_CLASSIFICATIONS"};
+  MEDIAPIPE_NODE_CONTRACT(kInTensors, kOutClassificationList,
+                          kOutMultiClassificationList);
 
+  static absl::Status UpdateContract(CalculatorContract* cc);
   absl::Status Open(CalculatorContext* cc) override;
   absl::Status Process(CalculatorContext* cc) override;
   absl::Status Close(CalculatorContext* cc) override;
@@ -97,11 +105,27 @@ class TensorsToClassificationCalculator : public Node {
   // Allowed or ignored class indices based on provided options.
   // These are used to filter out the output classification results.
   ClassIndexSet class_index_set_;
+  // The indices of the classes selected for output, reused across inputs.
+  std::vector<int> selected_classes_;
   bool IsClassIndexAllowed(int class_index);
   const proto_ns::Map<int64, LabelMapItem>& GetLabelMap(CalculatorContext* cc);
+  // Converts the scores of one item into a filtered and sorted
+  // ClassificationList.
+  ClassificationList ToClassificationList(CalculatorContext* cc,
+                                          const float* raw_scores,
+                                          int num_classes);
 };
 MEDIAPIPE_REGISTER_NODE(TensorsToClassificationCalculator);
 
+absl::Status TensorsToClassificationCalculator::UpdateContract(
+    CalculatorContract* cc) {
+  RET_CHECK(kOutClassificationList(cc).IsConnected() ^
+            kOutMultiClassificationList(cc).IsConnected())
+      << "One and only one of CLASSIFICATIONS and MULTI_CLASSIFICATIONS "
+         "output is expected.";
+  return absl::OkStatus();
+}
+
 absl::Status TensorsToClassificationCalculator::Open(CalculatorContext* cc) {
   const auto& options = cc->Options<TensorsToClassificationCalculatorOptions>();
 
@@ -167,7 +191,12 @@ absl::Status TensorsToClassificationCalculator::Process(CalculatorContext* cc) {
   RET_CHECK_EQ(input_tensors.size(), 1);
   RET_CHECK(input_tensors[0].element_type() == Tensor::ElementType::kFloat32);
 
-  int num_classes = input_tensors[0].shape().num_elements();
+  const bool is_batch = kOutMultiClassificationList(cc).IsConnected();
+  const int batch_size = is_batch ? input_tensors[0].shape().dims[0] : 1;
+  RET_CHECK_GT(batch_size, 0);
+  int num_classes = input_tensors[0].shape().num_elements() / batch_size;
+  // Number of scores of each batch item.
+  const int item_size = num_classes;
 
   if (is_binary_classification_) {
     RET_CHECK_EQ(num_classes, 1);
@@ -180,61 +209,75 @@ absl::Status TensorsToClassificationCalculator::Process(CalculatorContext* cc) {
   auto view = input_tensors[0].GetCpuReadView();
   auto raw_scores = view.buffer<float>();
 
-  auto classification_list = absl::make_unique<ClassificationList>();
-  if (is_binary_classification_) {
-    Classification* class_first = classification_list->add_classification();
-    Classification* class_second = classification_list->add_classification();
-    class_first->set_index(0);
-    class_second->set_index(1);
-    class_first->set_score(raw_scores[0]);
-    class_second->set_score(1. - raw_scores[0]);
-
-    if (label_map_loaded_) {
-      SetClassificationLabel(GetLabelMap(cc).at(0), class_first);
-      SetClassificationLabel(GetLabelMap(cc).at(1), class_second);
+  if (is_batch) {
+    std::vector<ClassificationList> classification_lists;
+    classification_lists.reserve(batch_size);
+    for (int i = 0; i < batch_size; ++i) {
+      classification_lists.push_back(ToClassificationList(
+          cc, raw_scores + i * item_size, num_classes));
     }
+    kOutMultiClassificationList(cc).Send(std::move(classification_lists));
+    return absl::OkStatus();
+  }
+
+  kOutClassificationList(cc).Send(
+      ToClassificationList(cc, raw_scores, num_classes));
+  return absl::OkStatus();
+}
+
+ClassificationList TensorsToClassificationCalculator::ToClassificationList(
+    CalculatorContext* cc, const float* raw_scores, int num_classes) {
+  // Selects the class indices first, and then creates Classifications only
+  // for the selected classes, so that the top_k_ of many classes are found
+  // without building and sorting a Classification for every class.
+  float binary_scores[2];
+  selected_classes_.clear();
+  if (is_binary_classification_) {
+    binary_scores[0] = raw_scores[0];
+    binary_scores[1] = 1. - raw_scores[0];
+    raw_scores = binary_scores;
+    selected_classes_ = {0, 1};
   } else {
     for (int i = 0; i < num_classes; ++i) {
-      if (!IsClassIndexAllowed(i)) {
-        continue;
-      }
       if (raw_scores[i] < min_score_threshold_) {
         continue;
       }
-      Classification* classification =
-          classification_list->add_classification();
-      classification->set_index(i);
-      classification->set_score(raw_scores[i]);
-      if (label_map_loaded_) {
-        SetClassificationLabel(GetLabelMap(cc).at(i), classification);
+      if (!IsClassIndexAllowed(i)) {
+        continue;
       }
+      selected_classes_.push_back(i);
     }
   }
 
-  auto raw_classification_list = classification_list->mutable_classification();
+  // Orders by descending score, and by class index among equal scores.
+  auto by_descending_score = [raw_scores](int a, int b) {
+    return raw_scores[a] > raw_scores[b] ||
+           (raw_scores[a] == raw_scores[b] && a < b);
+  };
   if (top_k_ > 0) {
-    int desired_size =
-        std::min(classification_list->classification_size(), top_k_);
-    std::partial_sort(raw_classification_list->begin(),
-                      raw_classification_list->begin() + desired_size,
-                      raw_classification_list->end(),
-                      [](const Classification a, const Classification b) {
-                        return a.score() > b.score();
-                      });
+    const int desired_size =
+        std::min(static_cast<int>(selected_classes_.size()), top_k_);
+    std::partial_sort(selected_classes_.begin(),
+                      selected_classes_.begin() + desired_size,
+                      selected_classes_.end(), by_descending_score);
+    selected_classes_.resize(desired_size);
+  } else if (sort_by_descending_score_) {
+    std::sort(selected_classes_.begin(), selected_classes_.end(),
+              by_descending_score);
+  }
 
-    if (desired_size >= top_k_) {
-      // Resizes the underlying list to have only top_k_ classifications.
-      raw_classification_list->DeleteSubrange(
-          top_k_, raw_classification_list->size() - top_k_);
+  ClassificationList classification_list;
+  classification_list.mutable_classification()->Reserve(
+      selected_classes_.size());
+  for (int i : selected_classes_) {
+    Classification* classification = classification_list.add_classification();
+    classification->set_index(i);
+    classification->set_score(raw_scores[i]);
+    if (label_map_loaded_) {
+      SetClassificationLabel(GetLabelMap(cc).at(i), classification);
     }
-  } else if (sort_by_descending_score_) {
-    std::sort(raw_classification_list->begin(), raw_classification_list->end(),
-              [](const Classification a, const Classification b) {
-                return a.score() > b.score();
-              });
   }
-  kOutClassificationList(cc).Send(std::move(classification_list));
-  return absl::OkStatus();
+  return classification_list;
 }
 
 absl::Status TensorsToClassificationCalculator::Close(CalculatorContext* cc) {
@@ -208,6 +208,47 @@ TEST_F(TensorsToClassificationCalculatorTest, CorrectOutputWithTopK) {
   }
 }
 
+TEST_F(TensorsToClassificationCalculatorTest,
+       CorrectOutputWithTopKOfManyClasses) {
+  mediapipe::CalculatorRunner runner(ParseTextProtoOrDie<Node>(R"pb(
+    calculator: "TensorsToClassificationCalculator"
+    input_stream: "TENSORS:tensors"
+    output_stream: "CLASSIFICATIONS:classifications"
+    options {
+      [mediapipe.TensorsToClassificationCalculatorOptions.ext] {
+        top_k: 3
+        min_score_threshold: 0.1
+        ignore_classes: 500
+      }
+    }
+  )pb"));
+
+  // Class i has score i / 1000, except that classes 700 and 300 tie at 0.9,
+  // and the ignored class 500 has the highest score.
+  std::vector<float> scores(1000);
+  for (int i = 0; i < scores.size(); ++i) {
+    scores[i] = i / 1000.0f;
+  }
+  scores[700] = 0.9f;
+  scores[300] = 0.9f;
+  scores[500] = 2.0f;
+  BuildGraph(&runner, scores);
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& output_packets_ = runner.Outputs().Tag("CLASSIFICATIONS").packets;
+  ASSERT_EQ(1, output_packets_.size());
+  const auto& classification_list =
+      output_packets_[0].Get<ClassificationList>();
+
+  // Verify that the top3 classes are in descending score order, with tied
+  // scores in class index order.
+  ASSERT_EQ(3, classification_list.classification_size());
+  EXPECT_EQ(999, classification_list.classification(0).index());
+  EXPECT_EQ(300, classification_list.classification(1).index());
+  EXPECT_EQ(700, classification_list.classification(2).index());
+  EXPECT_FLOAT_EQ(0.9f, classification_list.classification(2).score());
+}
+
 TEST_F(TensorsToClassificationCalculatorTest,
        CorrectOutputWithSortByDescendingScore) {
   mediapipe::CalculatorRunner runner(ParseTextProtoOrDie<Node>(R"pb(
@@ -323,4 +364,40 @@ TEST_F(TensorsToClassificationCalculatorTest,
   ASSERT_TRUE(classification_list.classification(1).has_label());
 }
 
+TEST_F(TensorsToClassificationCalculatorTest, CorrectBatchOutput) {
+  mediapipe::CalculatorRunner runner(ParseTextProtoOrDie<Node>(R"pb(
+    calculator: "TensorsToClassificationCalculator"
+    input_stream: "TENSORS:tensors"
+    output_stream: "MULTI_CLASSIFICATIONS:classifications"
+    options {
+      [mediapipe.TensorsToClassificationCalculatorOptions.ext] { top_k: 1 }
+    }
+  )pb"));
+
+  auto tensors = absl::make_unique<std::vector<Tensor>>();
+  tensors->emplace_back(Tensor::ElementType::kFloat32, Tensor::Shape{2, 3});
+  {
+    auto view = tensors->back().GetCpuWriteView();
+    const std::vector<float> scores = {0, 0.5, 1, 0.75, 0.25, 0};
+    std::copy(scores.begin(), scores.end(), view.buffer<float>());
+  }
+  runner.MutableInputs()->Tag("TENSORS").packets.push_back(
+      mediapipe::Adopt(tensors.release()).At(mediapipe::Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& output_packets_ =
+      runner.Outputs().Tag("MULTI_CLASSIFICATIONS").packets;
+  ASSERT_EQ(1, output_packets_.size());
+
+  const auto& classification_lists =
+      output_packets_[0].Get<std::vector<ClassificationList>>();
+  ASSERT_EQ(2, classification_lists.size());
+  ASSERT_EQ(1, classification_lists[0].classification_size());
+  EXPECT_EQ(2, classification_lists[0].classification(0).index());
+  EXPECT_EQ(1, classification_lists[0].classification(0).score());
+  ASSERT_EQ(1, classification_lists[1].classification_size());
+  EXPECT_EQ(0, classification_lists[1].classification(0).index());
+  EXPECT_EQ(0.75, classification_lists[1].classification(0).score());
+}
+
 }  // namespace mediapipe
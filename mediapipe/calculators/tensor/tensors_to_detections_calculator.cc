@@ -12,16 +12,23 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
 #include <unordered_map>
 #include <vector>
 
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "mediapipe/calculators/tensor/tensors_to_detections_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/deps/file_path.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/flat_anchors.h"
+#include "mediapipe/framework/formats/flat_detections.h"
 #include "mediapipe/framework/formats/location.h"
 #include "mediapipe/framework/formats/object_detection/anchor.pb.h"
 #include "mediapipe/framework/formats/tensor.h"
@@ -45,9 +52,19 @@
 #include "mediapipe/gpu/MPPMetalUtil.h"
 #endif  // MEDIAPIPE_METAL_ENABLED
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 namespace {
 constexpr int kNumInputTensorsWithAnchors = 3;
 constexpr int kNumCoordsPerBox = 4;
+// The GPU suppression runs in a single workgroup and sorts at most this many
+// candidates in shared memory. Must be a power of two.
+constexpr int kMaxGpuSuppressionCandidates = 1024;
+constexpr int kGpuSuppressionWorkgroupSize = 128;
 
 bool CanUseGpu() {
 #if !defined(MEDIAPIPE_DISABLE_GL_COMPUTE) || MEDIAPIPE_METAL_ENABLED
@@ -65,32 +82,86 @@ namespace api2 {
 
 namespace {
 
-void ConvertRawValuesToAnchors(const float* raw_anchors, int num_boxes,
-                               std::vector<Anchor>* anchors) {
-  anchors->clear();
+FlatAnchors ConvertRawValuesToAnchors(const float* raw_anchors,
+                                      int num_boxes) {
+  FlatAnchors anchors;
+  anchors.reserve(num_boxes);
   for (int i = 0; i < num_boxes; ++i) {
-    Anchor new_anchor;
-    new_anchor.set_y_center(raw_anchors[i * kNumCoordsPerBox + 0]);
-    new_anchor.set_x_center(raw_anchors[i * kNumCoordsPerBox + 1]);
-    new_anchor.set_h(raw_anchors[i * kNumCoordsPerBox + 2]);
-    new_anchor.set_w(raw_anchors[i * kNumCoordsPerBox + 3]);
-    anchors->push_back(new_anchor);
+    anchors.Add(/*x_center=*/raw_anchors[i * kNumCoordsPerBox + 1],
+                /*y_center=*/raw_anchors[i * kNumCoordsPerBox + 0],
+                /*h=*/raw_anchors[i * kNumCoordsPerBox + 2],
+                /*w=*/raw_anchors[i * kNumCoordsPerBox + 3]);
   }
+  return anchors;
 }
 
-void ConvertAnchorsToRawValues(const std::vector<Anchor>& anchors,
-                               int num_boxes, float* raw_anchors) {
+void ConvertAnchorsToRawValues(const FlatAnchors& anchors, int num_boxes,
+                               float* raw_anchors) {
   CHECK_EQ(anchors.size(), num_boxes);
-  int box = 0;
-  for (const auto& anchor : anchors) {
-    raw_anchors[box * kNumCoordsPerBox + 0] = anchor.y_center();
-    raw_anchors[box * kNumCoordsPerBox + 1] = anchor.x_center();
-    raw_anchors[box * kNumCoordsPerBox + 2] = anchor.h();
-    raw_anchors[box * kNumCoordsPerBox + 3] = anchor.w();
-    ++box;
+  for (int box = 0; box < anchors.size(); ++box) {
+    raw_anchors[box * kNumCoordsPerBox + 0] = anchors.y_center(box);
+    raw_anchors[box * kNumCoordsPerBox + 1] = anchors.x_center(box);
+    raw_anchors[box * kNumCoordsPerBox + 2] = anchors.h(box);
+    raw_anchors[box * kNumCoordsPerBox + 3] = anchors.w(box);
   }
 }
 
+// Appends the indices of @values that are greater than or equal to
+// @threshold to @indices. Most anchors are usually rejected, so blocks of
+// values below the threshold are skipped with a single comparison.
+void SelectIndicesAboveThreshold(const float* values, int size,
+                                 float threshold, std::vector<int>* indices) {
+  int i = 0;
+#if defined(__SSE2__)
+  const __m128 threshold_v = _mm_set1_ps(threshold);
+  for (; i + 4 <= size; i += 4) {
+    int mask = _mm_movemask_ps(
+        _mm_cmpge_ps(_mm_loadu_ps(values + i), threshold_v));
+    while (mask != 0) {
+      const int lane = __builtin_ctz(mask);
+      indices->push_back(i + lane);
+      mask &= mask - 1;
+    }
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const float32x4_t threshold_v = vdupq_n_f32(threshold);
+  for (; i + 4 <= size; i += 4) {
+    const uint32x4_t mask = vcgeq_f32(vld1q_f32(values + i), threshold_v);
+    const uint32x2_t any =
+        vorr_u32(vget_low_u32(mask), vget_high_u32(mask));
+    if (vget_lane_u32(vpmax_u32(any, any), 0) == 0) {
+      continue;
+    }
+    for (int lane = 0; lane < 4; ++lane) {
+      if (values[i + lane] >= threshold) {
+        indices->push_back(i + lane);
+      }
+    }
+  }
+#endif
+  for (; i < size; ++i) {
+    if (values[i] >= threshold) {
+      indices->push_back(i);
+    }
+  }
+}
+
+// Returns the 2D affine part {m0, m1, m3, m4, m5, m7} of the row-major 4x4
+// @projection applied after removing the letterbox @padding, i.e. the
+// transform that maps x, y to x * m0 + y * m1 + m3, x * m4 + y * m5 + m7.
+std::array<float, 6> GetImageTransform(const std::array<float, 16>& projection,
+                                       const std::array<float, 4>& padding) {
+  // Letterbox removal as in DetectionLetterboxRemovalCalculator.
+  const float scale_x = 1.0f / (1.0f - padding[0] - padding[2]);
+  const float scale_y = 1.0f / (1.0f - padding[1] - padding[3]);
+  const float offset_x = -padding[0] * scale_x;
+  const float offset_y = -padding[1] * scale_y;
+  return {projection[0] * scale_x, projection[1] * scale_y,
+          projection[0] * offset_x + projection[1] * offset_y + projection[3],
+          projection[4] * scale_x, projection[5] * scale_y,
+          projection[4] * offset_x + projection[5] * offset_y + projection[7]};
+}
+
 absl::Status CheckCustomTensorMapping(
     const TensorsToDetectionsCalculatorOptions::TensorMapping& tensor_mapping) {
   RET_CHECK(tensor_mapping.has_detections_tensor_index() &&
@@ -144,12 +215,37 @@ absl::Status CheckCustomTensorMapping(
 //  ANCHORS (optional) - The anchors used for decoding the bounding boxes, as a
 //      vector of `Anchor` protos. Not required if post-processing is built-in
 //      the model.
+//  FLAT_ANCHORS (optional) - The same as ANCHORS, as FlatAnchors. These are
+//      decoded from as given, so graph instances sharing the anchors of
+//      SsdAnchorsCalculator don't each keep a converted copy. Takes
+//      precedence over ANCHORS.
 //  IGNORE_CLASSES (optional) - The list of class ids that should be ignored, as
 //      a vector of integers. It overrides the corresponding field in the
 //      calculator options.
 //
+// Input (optional), to output detections on the original image instead of the
+// model input:
+//  LETTERBOX_PADDING - std::array<float, 4> with the [left, top, right,
+//      bottom] padding of the model input, as output by
+//      ImageToTensorCalculator. Removed from the detections, like
+//      DetectionLetterboxRemovalCalculator does.
+//  PROJECTION_MATRIX - std::array<float, 16> projecting the detections back
+//      onto the image, like DetectionProjectionCalculator does. Applied after
+//      letterbox removal. The MATRIX of ImageToTensorCalculator already
+//      accounts for the padding, so it doesn't need LETTERBOX_PADDING. No
+//      detections are output for timestamps without a matrix.
+// Both are applied to every detection as it is converted, after suppression.
+//
 // Output:
-//  DETECTIONS - Result MediaPipe detections.
+//  DETECTIONS (optional) - Result MediaPipe detections.
+//  FLAT_DETECTIONS (optional) - The same detections as FlatDetections, which
+//      avoids allocating a Detection proto per box. At least one of
+//      DETECTIONS and FLAT_DETECTIONS must be connected.
+//
+// With the `suppression` option, the detections also go through non-maximum
+// suppression. For GPU input tensors this runs on the device together with the
+// decoding, and at most kMaxGpuSuppressionCandidates boxes above
+// `min_score_thresh` are considered.
 //
 // Usage example:
 // node {
@@ -173,13 +269,24 @@ absl::Status CheckCustomTensorMapping(
 class TensorsToDetectionsCalculator : public Node {
  public:
   static constexpr Input<std::vector<Tensor>> kInTensors{"TENSORS"};
+  static constexpr Input<std::array<float, 4>>::Optional kInLetterboxPadding{
+      "LETTERBOX_PADDING"};
+  static constexpr Input<std::array<float, 16>>::Optional kInProjectionMatrix{
+      "PROJECTION_MATRIX"};
   static constexpr SideInput<std::vector<Anchor>>::Optional kInAnchors{
       "ANCHORS"};
+  static constexpr SideInput<FlatAnchors>::Optional kInFlatAnchors{
+      "FLAT_ANCHORS"};
   static constexpr SideInput<std::vector<int>>::Optional kSideInIgnoreClasses{
       "IGNORE_CLASSES"};
-  static constexpr Output<std::vector<Detection>> kOutDetections{"DETECTIONS"};
-  MEDIAPIPE_NODE_CONTRACT(kInTensors, kInAnchors, kSideInIgnoreClasses,
-                          kOutDetections);
+  static constexpr Output<std::vector<Detection>>::Optional kOutDetections{
+      "DETECTIONS"};
+  static constexpr Output<FlatDetections>::Optional kOutFlatDetections{
+      "FLAT_DETECTIONS"};
+  MEDIAPIPE_NODE_CONTRACT(kInTensors, kInLetterboxPadding,
+                          kInProjectionMatrix, kInAnchors, kInFlatAnchors,
+                          kSideInIgnoreClasses, kOutDetections,
+                          kOutFlatDetections);
   static absl::Status UpdateContract(CalculatorContract* cc);
 
   absl::Status Open(CalculatorContext* cc) override;
@@ -188,23 +295,38 @@ class TensorsToDetectionsCalculator : public Node {
 
  private:
   absl::Status ProcessCPU(CalculatorContext* cc,
-                          std::vector<Detection>* output_detections);
+                          FlatDetections* output_detections);
   absl::Status ProcessGPU(CalculatorContext* cc,
-                          std::vector<Detection>* output_detections);
+                          FlatDetections* output_detections);
 
   absl::Status LoadOptions(CalculatorContext* cc);
+  // Sets anchors_ from the FLAT_ANCHORS or ANCHORS side packet.
+  absl::Status LoadSideInputAnchors(CalculatorContext* cc);
   absl::Status GpuInit(CalculatorContext* cc);
-  absl::Status DecodeBoxes(const float* raw_boxes,
-                           const std::vector<Anchor>& anchors,
+  // Decodes the boxes of @box_indices into consecutive entries of @boxes.
+  absl::Status DecodeBoxes(const float* raw_boxes, const FlatAnchors& anchors,
+                           const std::vector<int>& box_indices,
                            std::vector<float>* boxes);
   absl::Status ConvertToDetections(const float* detection_boxes,
                                    const float* detection_scores,
                                    const int* detection_classes,
-                                   std::vector<Detection>* output_detections);
-  Detection ConvertToDetection(float box_ymin, float box_xmin, float box_ymax,
-                               float box_xmax, float score, int class_id,
-                               bool flip_vertically);
+                                   int num_detections,
+                                   FlatDetections* output_detections);
   bool IsClassIndexAllowed(int class_index);
+  // Returns the raw score below which an anchor can't pass min_score_thresh,
+  // so that the sigmoid is only computed for the surviving anchors.
+  float GetRawScoreThreshold() const;
+  // Applies the optional clipping and sigmoid to a raw score.
+  float ActivateScore(float raw_score) const;
+  // Applies the suppression options to the decoded detections in @boxes,
+  // @scores and @classes, keeping the survivors in descending score order.
+  void SuppressDetections(std::vector<float>* boxes,
+                          std::vector<float>* scores,
+                          std::vector<int>* classes) const;
+  // Converts the detections read back from suppressed_detections_buffer_.
+  absl::Status ConvertSuppressedDetections(FlatDetections* output_detections);
+  // Intersection over union of two decoded boxes.
+  float GetIntersectionOverUnion(const float* box_a, const float* box_b) const;
 
   int num_classes_ = 0;
   int num_boxes_ = 0;
@@ -225,20 +347,38 @@ class TensorsToDetectionsCalculator : public Node {
   TensorsToDetectionsCalculatorOptions::TensorMapping tensor_mapping_;
   std::vector<int> box_indices_ = {0, 1, 2, 3};
   bool has_custom_box_indices_ = false;
-  std::vector<Anchor> anchors_;
+  // Shares the FLAT_ANCHORS payload when given.
+  Packet<FlatAnchors> anchors_;
+  // Scratch (x, y) pairs for the keypoints of one detection.
+  std::vector<float> keypoints_;
+  // Whether ConvertToDetections maps the detections onto the image with
+  // image_transform_, as returned by GetImageTransform().
+  bool has_image_transform_ = false;
+  std::array<float, 6> image_transform_;
+  // Class indices taken into account when looking for the top score.
+  std::vector<int> allowed_class_indices_;
+  // Scratch buffers of the CPU decoding, reused across frames.
+  std::vector<float> max_raw_scores_;
+  std::vector<int> max_classes_;
+  std::vector<int> candidate_indices_;
 
 #ifndef MEDIAPIPE_DISABLE_GL_COMPUTE
   mediapipe::GlCalculatorHelper gpu_helper_;
   GLuint decode_program_;
   GLuint score_program_;
+  GLuint suppress_program_ = 0;
 #elif MEDIAPIPE_METAL_ENABLED
   MPPMetalHelper* gpu_helper_ = nullptr;
   id<MTLComputePipelineState> decode_program_;
   id<MTLComputePipelineState> score_program_;
+  id<MTLComputePipelineState> suppress_program_ = nil;
 #endif  // !defined(MEDIAPIPE_DISABLE_GL_COMPUTE)
   std::unique_ptr<Tensor> raw_anchors_buffer_;
   std::unique_ptr<Tensor> decoded_boxes_buffer_;
   std::unique_ptr<Tensor> scored_boxes_buffer_;
+  // Count followed by [score, class, num_coords_ coordinates] of every
+  // detection kept by the GPU suppression.
+  std::unique_ptr<Tensor> suppressed_detections_buffer_;
 
   bool gpu_inited_ = false;
   bool gpu_input_ = false;
@@ -248,6 +388,9 @@ MEDIAPIPE_REGISTER_NODE(TensorsToDetectionsCalculator);
 
 absl::Status TensorsToDetectionsCalculator::UpdateContract(
     CalculatorContract* cc) {
+  RET_CHECK(kOutDetections(cc).IsConnected() ||
+            kOutFlatDetections(cc).IsConnected())
+      << "At least one of DETECTIONS and FLAT_DETECTIONS must be connected.";
   if (CanUseGpu()) {
 #ifndef MEDIAPIPE_DISABLE_GL_COMPUTE
     MP_RETURN_IF_ERROR(mediapipe::GlCalculatorHelper::UpdateContract(cc));
@@ -275,7 +418,23 @@ absl::Status TensorsToDetectionsCalculator::Open(CalculatorContext* cc) {
 }
 
 absl::Status TensorsToDetectionsCalculator::Process(CalculatorContext* cc) {
-  auto output_detections = absl::make_unique<std::vector<Detection>>();
+  if (kInProjectionMatrix(cc).IsConnected() &&
+      kInProjectionMatrix(cc).IsEmpty()) {
+    return absl::OkStatus();
+  }
+  const bool has_padding = kInLetterboxPadding(cc).IsConnected() &&
+                           !kInLetterboxPadding(cc).IsEmpty();
+  has_image_transform_ = has_padding || kInProjectionMatrix(cc).IsConnected();
+  if (has_image_transform_) {
+    constexpr std::array<float, 16> kIdentity = {1, 0, 0, 0, 0, 1, 0, 0,
+                                                 0, 0, 1, 0, 0, 0, 0, 1};
+    image_transform_ = GetImageTransform(
+        kInProjectionMatrix(cc).IsConnected() ? *kInProjectionMatrix(cc)
+                                              : kIdentity,
+        has_padding ? *kInLetterboxPadding(cc) : std::array<float, 4>{});
+  }
+  auto output_detections =
+      absl::make_unique<FlatDetections>(options_.num_keypoints());
   bool gpu_processing = false;
   if (CanUseGpu()) {
     // Use GPU processing only if at least one input tensor is already on GPU
@@ -317,12 +476,17 @@ absl::Status TensorsToDetectionsCalculator::Process(CalculatorContext* cc) {
     MP_RETURN_IF_ERROR(ProcessCPU(cc, output_detections.get()));
   }
 
-  kOutDetections(cc).Send(std::move(output_detections));
+  if (kOutDetections(cc).IsConnected()) {
+    kOutDetections(cc).Send(ToDetections(*output_detections));
+  }
+  if (kOutFlatDetections(cc).IsConnected()) {
+    kOutFlatDetections(cc).Send(std::move(output_detections));
+  }
   return absl::OkStatus();
 }
 
 absl::Status TensorsToDetectionsCalculator::ProcessCPU(
-    CalculatorContext* cc, std::vector<Detection>* output_detections) {
+    CalculatorContext* cc, FlatDetections* output_detections) {
   const auto& input_tensors = *kInTensors(cc);
 
   if (input_tensors.size() == 2 ||
@@ -358,52 +522,68 @@ absl::Status TensorsToDetectionsCalculator::ProcessCPU(
         RET_CHECK_EQ(anchor_tensor->shape().dims[1], kNumCoordsPerBox);
         auto anchor_view = anchor_tensor->GetCpuReadView();
         auto raw_anchors = anchor_view.buffer<float>();
-        ConvertRawValuesToAnchors(raw_anchors, num_boxes_, &anchors_);
-      } else if (!kInAnchors(cc).IsEmpty()) {
-        anchors_ = *kInAnchors(cc);
+        anchors_ = api2::MakePacket<FlatAnchors>(
+            ConvertRawValuesToAnchors(raw_anchors, num_boxes_));
       } else {
-        return absl::UnavailableError("No anchor data available.");
+        MP_RETURN_IF_ERROR(LoadSideInputAnchors(cc));
       }
       anchors_init_ = true;
     }
-    std::vector<float> boxes(num_boxes_ * num_coords_);
-    MP_RETURN_IF_ERROR(DecodeBoxes(raw_boxes, anchors_, &boxes));
-
-    std::vector<float> detection_scores(num_boxes_);
-    std::vector<int> detection_classes(num_boxes_);
-
-    // Filter classes by scores.
+    // The clipping and sigmoid are monotonic, so the top class of every
+    // anchor is found on the raw scores.
+    max_raw_scores_.resize(num_boxes_);
+    max_classes_.resize(num_boxes_);
     for (int i = 0; i < num_boxes_; ++i) {
+      const float* box_scores = raw_scores + i * num_classes_;
       int class_id = -1;
       float max_score = -std::numeric_limits<float>::max();
-      // Find the top score for box i.
-      for (int score_idx = 0; score_idx < num_classes_; ++score_idx) {
-        if (IsClassIndexAllowed(score_idx)) {
-          auto score = raw_scores[i * num_classes_ + score_idx];
-          if (options_.sigmoid_score()) {
-            if (options_.has_score_clipping_thresh()) {
-              score = score < -options_.score_clipping_thresh()
-                          ? -options_.score_clipping_thresh()
-                          : score;
-              score = score > options_.score_clipping_thresh()
-                          ? options_.score_clipping_thresh()
-                          : score;
-            }
-            score = 1.0f / (1.0f + std::exp(-score));
-          }
-          if (max_score < score) {
-            max_score = score;
-            class_id = score_idx;
-          }
+      for (int score_idx : allowed_class_indices_) {
+        if (max_score < box_scores[score_idx]) {
+          max_score = box_scores[score_idx];
+          class_id = score_idx;
         }
       }
-      detection_scores[i] = max_score;
-      detection_classes[i] = class_id;
+      max_raw_scores_[i] = max_score;
+      max_classes_[i] = class_id;
+    }
+
+    // Only anchors that can pass min_score_thresh are decoded.
+    candidate_indices_.clear();
+    SelectIndicesAboveThreshold(max_raw_scores_.data(), num_boxes_,
+                                GetRawScoreThreshold(), &candidate_indices_);
+    if (options_.max_candidates() > 0 &&
+        static_cast<int>(candidate_indices_.size()) >
+            options_.max_candidates()) {
+      auto by_descending_score = [this](int a, int b) {
+        return max_raw_scores_[a] > max_raw_scores_[b];
+      };
+      std::nth_element(candidate_indices_.begin(),
+                       candidate_indices_.begin() + options_.max_candidates(),
+                       candidate_indices_.end(), by_descending_score);
+      candidate_indices_.resize(options_.max_candidates());
+      // Keeps the anchor order, which max_results relies on.
+      std::sort(candidate_indices_.begin(), candidate_indices_.end());
     }
 
+    const int num_candidates = candidate_indices_.size();
+    std::vector<float> boxes(num_candidates * num_coords_);
     MP_RETURN_IF_ERROR(
-        ConvertToDetections(boxes.data(), detection_scores.data(),
-                            detection_classes.data(), output_detections));
+        DecodeBoxes(raw_boxes, *anchors_, candidate_indices_, &boxes));
+
+    std::vector<float> detection_scores(num_candidates);
+    std::vector<int> detection_classes(num_candidates);
+    for (int i = 0; i < num_candidates; ++i) {
+      const int box = candidate_indices_[i];
+      detection_scores[i] = ActivateScore(max_raw_scores_[box]);
+      detection_classes[i] = max_classes_[box];
+    }
+    if (options_.has_suppression()) {
+      SuppressDetections(&boxes, &detection_scores, &detection_classes);
+    }
+
+    MP_RETURN_IF_ERROR(ConvertToDetections(
+        boxes.data(), detection_scores.data(), detection_classes.data(),
+        detection_scores.size(), output_detections));
   } else {
     // Postprocessing on CPU with postprocessing op (e.g. anchor decoding and
     // non-maximum suppression) within the model.
@@ -450,13 +630,13 @@ absl::Status TensorsToDetectionsCalculator::ProcessCPU(
     }
     MP_RETURN_IF_ERROR(ConvertToDetections(detection_boxes, detection_scores,
                                            detection_classes.data(),
-                                           output_detections));
+                                           num_boxes_, output_detections));
   }
   return absl::OkStatus();
 }
 
 absl::Status TensorsToDetectionsCalculator::ProcessGPU(
-    CalculatorContext* cc, std::vector<Detection>* output_detections) {
+    CalculatorContext* cc, FlatDetections* output_detections) {
   const auto& input_tensors = *kInTensors(cc);
   RET_CHECK_GE(input_tensors.size(), 2);
   RET_CHECK_GT(num_boxes_, 0) << "Please set num_boxes in calculator options";
@@ -475,13 +655,11 @@ absl::Status TensorsToDetectionsCalculator::ProcessGPU(
         glCopyBufferSubData(
             GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
             input_tensors[tensor_mapping_.anchors_tensor_index()].bytes());
-      } else if (!kInAnchors(cc).IsEmpty()) {
-        const auto& anchors = *kInAnchors(cc);
+      } else {
+        MP_RETURN_IF_ERROR(LoadSideInputAnchors(cc));
         auto anchors_view = raw_anchors_buffer_->GetCpuWriteView();
         auto raw_anchors = anchors_view.buffer<float>();
-        ConvertAnchorsToRawValues(anchors, num_boxes_, raw_anchors);
-      } else {
-        return absl::UnavailableError("No anchor data available.");
+        ConvertAnchorsToRawValues(*anchors_, num_boxes_, raw_anchors);
       }
       anchors_init_ = true;
     }
@@ -510,9 +688,28 @@ absl::Status TensorsToDetectionsCalculator::ProcessGPU(
       glUseProgram(score_program_);
       glDispatchCompute(num_boxes_, 1, 1);
     }
+    if (suppress_program_ != 0) {
+      // Filter, compact and suppress the boxes on the device.
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+      // Views are requested in the same order as above.
+      auto scored_boxes_view = scored_boxes_buffer_->GetOpenGlBufferReadView();
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, scored_boxes_view.name());
+      auto decoded_boxes_view =
+          decoded_boxes_buffer_->GetOpenGlBufferReadView();
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, decoded_boxes_view.name());
+      auto detections_view =
+          suppressed_detections_buffer_->GetOpenGlBufferWriteView();
+      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, detections_view.name());
+      glUseProgram(suppress_program_);
+      glDispatchCompute(1, 1, 1);
+    }
     return absl::OkStatus();
   }));
 
+  if (suppressed_detections_buffer_) {
+    return ConvertSuppressedDetections(output_detections);
+  }
+
   // TODO: b/138851969. Is it possible to output a float vector
   // for score and an int vector for class so that we can avoid copying twice?
   std::vector<float> detection_scores(num_boxes_);
@@ -529,7 +726,7 @@ absl::Status TensorsToDetectionsCalculator::ProcessGPU(
   auto decoded_boxes_view = decoded_boxes_buffer_->GetCpuReadView();
   auto boxes = decoded_boxes_view.buffer<float>();
   MP_RETURN_IF_ERROR(ConvertToDetections(boxes, detection_scores.data(),
-                                         detection_classes.data(),
+                                         detection_classes.data(), num_boxes_,
                                          output_detections));
 #elif MEDIAPIPE_METAL_ENABLED
   id<MTLDevice> device = gpu_helper_.mtlDevice;
@@ -552,13 +749,11 @@ absl::Status TensorsToDetectionsCalculator::ProcessGPU(
                                        .bytes()];
       [blit_command endEncoding];
       [command_buffer commit];
-    } else if (!kInAnchors(cc).IsEmpty()) {
-      const auto& anchors = *kInAnchors(cc);
+    } else {
+      MP_RETURN_IF_ERROR(LoadSideInputAnchors(cc));
       auto raw_anchors_view = raw_anchors_buffer_->GetCpuWriteView();
-      ConvertAnchorsToRawValues(anchors, num_boxes_,
+      ConvertAnchorsToRawValues(*anchors_, num_boxes_,
                                 raw_anchors_view.buffer<float>());
-    } else {
-      return absl::UnavailableError("No anchor data available.");
     }
     anchors_init_ = true;
   }
@@ -596,10 +791,31 @@ absl::Status TensorsToDetectionsCalculator::ProcessGPU(
     MTLSize score_threadgroups = MTLSizeMake(num_boxes_, 1, 1);
     [command_encoder dispatchThreadgroups:score_threadgroups
                     threadsPerThreadgroup:score_threads_per_group];
+
+    if (suppress_program_ != nil) {
+      // Filter, compact and suppress the boxes on the device. Dispatches of
+      // the encoder run in order, so the decoded and scored boxes are ready.
+      auto detections_view =
+          suppressed_detections_buffer_->GetMtlBufferWriteView(command_buffer);
+      [command_encoder setComputePipelineState:suppress_program_];
+      [command_encoder setBuffer:detections_view.buffer() offset:0 atIndex:0];
+      [command_encoder setBuffer:decoded_boxes_view.buffer()
+                          offset:0
+                         atIndex:1];
+      [command_encoder setBuffer:scored_boxes_view.buffer() offset:0 atIndex:2];
+      [command_encoder
+           dispatchThreadgroups:MTLSizeMake(1, 1, 1)
+          threadsPerThreadgroup:MTLSizeMake(kGpuSuppressionWorkgroupSize, 1,
+                                            1)];
+    }
     [command_encoder endEncoding];
     [command_buffer commit];
   }
 
+  if (suppressed_detections_buffer_) {
+    return ConvertSuppressedDetections(output_detections);
+  }
+
   // Output detections.
   // TODO Adjust shader to avoid copying shader output twice.
   std::vector<float> detection_scores(num_boxes_);
@@ -615,7 +831,7 @@ absl::Status TensorsToDetectionsCalculator::ProcessGPU(
   auto decoded_boxes_view = decoded_boxes_buffer_->GetCpuReadView();
   auto boxes = decoded_boxes_view.buffer<float>();
   MP_RETURN_IF_ERROR(ConvertToDetections(boxes, detection_scores.data(),
-                                         detection_classes.data(),
+                                         detection_classes.data(), num_boxes_,
                                          output_detections));
 
 #else
@@ -630,15 +846,21 @@ absl::Status TensorsToDetectionsCalculator::Close(CalculatorContext* cc) {
     decoded_boxes_buffer_ = nullptr;
     scored_boxes_buffer_ = nullptr;
     raw_anchors_buffer_ = nullptr;
+    suppressed_detections_buffer_ = nullptr;
     glDeleteProgram(decode_program_);
     glDeleteProgram(score_program_);
+    if (suppress_program_ != 0) {
+      glDeleteProgram(suppress_program_);
+    }
   });
 #elif MEDIAPIPE_METAL_ENABLED
   decoded_boxes_buffer_ = nullptr;
   scored_boxes_buffer_ = nullptr;
   raw_anchors_buffer_ = nullptr;
+  suppressed_detections_buffer_ = nullptr;
   decode_program_ = nil;
   score_program_ = nil;
+  suppress_program_ = nil;
 #endif  // !defined(MEDIAPIPE_DISABLE_GL_COMPUTE)
 
   return absl::OkStatus();
@@ -665,6 +887,10 @@ absl::Status TensorsToDetectionsCalculator::LoadOptions(CalculatorContext* cc) {
   CHECK_EQ(options_.num_keypoints() * options_.num_values_per_keypoint() +
                kNumCoordsPerBox,
            num_coords_);
+  keypoints_.resize(options_.num_keypoints() * 2);
+  if (options_.has_suppression()) {
+    RET_CHECK_GT(options_.suppression().max_num_detections(), 0);
+  }
 
   if (kSideInIgnoreClasses(cc).IsConnected()) {
     RET_CHECK(!kSideInIgnoreClasses(cc).IsEmpty());
@@ -686,6 +912,13 @@ absl::Status TensorsToDetectionsCalculator::LoadOptions(CalculatorContext* cc) {
     }
   }
 
+  allowed_class_indices_.clear();
+  for (int i = 0; i < num_classes_; ++i) {
+    if (IsClassIndexAllowed(i)) {
+      allowed_class_indices_.push_back(i);
+    }
+  }
+
   if (options_.has_tensor_mapping()) {
     RET_CHECK_OK(CheckCustomTensorMapping(options_.tensor_mapping()));
     tensor_mapping_ = options_.tensor_mapping();
@@ -720,10 +953,27 @@ absl::Status TensorsToDetectionsCalculator::LoadOptions(CalculatorContext* cc) {
   return absl::OkStatus();
 }
 
+absl::Status TensorsToDetectionsCalculator::LoadSideInputAnchors(
+    CalculatorContext* cc) {
+  if (!kInFlatAnchors(cc).IsEmpty()) {
+    anchors_ = kInFlatAnchors(cc);
+  } else if (!kInAnchors(cc).IsEmpty()) {
+    anchors_ = api2::MakePacket<FlatAnchors>(FromAnchors(*kInAnchors(cc)));
+  } else {
+    return absl::UnavailableError("No anchor data available.");
+  }
+  return absl::OkStatus();
+}
+
 absl::Status TensorsToDetectionsCalculator::DecodeBoxes(
-    const float* raw_boxes, const std::vector<Anchor>& anchors,
-    std::vector<float>* boxes) {
-  for (int i = 0; i < num_boxes_; ++i) {
+    const float* raw_boxes, const FlatAnchors& anchors,
+    const std::vector<int>& box_indices, std::vector<float>* boxes) {
+  const float* anchor_x_center = anchors.x_centers();
+  const float* anchor_y_center = anchors.y_centers();
+  const float* anchor_h = anchors.heights();
+  const float* anchor_w = anchors.widths();
+  for (int j = 0; j < box_indices.size(); ++j) {
+    const int i = box_indices[j];
     const int box_offset = i * num_coords_ + options_.box_coord_offset();
 
     float y_center = raw_boxes[box_offset];
@@ -738,16 +988,16 @@ absl::Status TensorsToDetectionsCalculator::DecodeBoxes(
     }
 
     x_center =
-        x_center / options_.x_scale() * anchors[i].w() + anchors[i].x_center();
+        x_center / options_.x_scale() * anchor_w[i] + anchor_x_center[i];
     y_center =
-        y_center / options_.y_scale() * anchors[i].h() + anchors[i].y_center();
+        y_center / options_.y_scale() * anchor_h[i] + anchor_y_center[i];
 
     if (options_.apply_exponential_on_box_size()) {
-      h = std::exp(h / options_.h_scale()) * anchors[i].h();
-      w = std::exp(w / options_.w_scale()) * anchors[i].w();
+      h = std::exp(h / options_.h_scale()) * anchor_h[i];
+      w = std::exp(w / options_.w_scale()) * anchor_w[i];
     } else {
-      h = h / options_.h_scale() * anchors[i].h();
-      w = w / options_.w_scale() * anchors[i].w();
+      h = h / options_.h_scale() * anchor_h[i];
+      w = w / options_.w_scale() * anchor_w[i];
     }
 
     const float ymin = y_center - h / 2.f;
@@ -755,15 +1005,16 @@ absl::Status TensorsToDetectionsCalculator::DecodeBoxes(
     const float ymax = y_center + h / 2.f;
     const float xmax = x_center + w / 2.f;
 
-    (*boxes)[i * num_coords_ + 0] = ymin;
-    (*boxes)[i * num_coords_ + 1] = xmin;
-    (*boxes)[i * num_coords_ + 2] = ymax;
-    (*boxes)[i * num_coords_ + 3] = xmax;
+    (*boxes)[j * num_coords_ + 0] = ymin;
+    (*boxes)[j * num_coords_ + 1] = xmin;
+    (*boxes)[j * num_coords_ + 2] = ymax;
+    (*boxes)[j * num_coords_ + 3] = xmax;
 
     if (options_.num_keypoints()) {
       for (int k = 0; k < options_.num_keypoints(); ++k) {
-        const int offset = i * num_coords_ + options_.keypoint_coord_offset() +
-                           k * options_.num_values_per_keypoint();
+        const int keypoint_offset = options_.keypoint_coord_offset() +
+                                    k * options_.num_values_per_keypoint();
+        const int offset = i * num_coords_ + keypoint_offset;
 
         float keypoint_y = raw_boxes[offset];
         float keypoint_x = raw_boxes[offset + 1];
@@ -772,11 +1023,11 @@ absl::Status TensorsToDetectionsCalculator::DecodeBoxes(
           keypoint_y = raw_boxes[offset + 1];
         }
 
-        (*boxes)[offset] = keypoint_x / options_.x_scale() * anchors[i].w() +
-                           anchors[i].x_center();
-        (*boxes)[offset + 1] =
-            keypoint_y / options_.y_scale() * anchors[i].h() +
-            anchors[i].y_center();
+        const int dst_offset = j * num_coords_ + keypoint_offset;
+        (*boxes)[dst_offset] =
+            keypoint_x / options_.x_scale() * anchor_w[i] + anchor_x_center[i];
+        (*boxes)[dst_offset + 1] =
+            keypoint_y / options_.y_scale() * anchor_h[i] + anchor_y_center[i];
       }
     }
   }
@@ -786,8 +1037,9 @@ absl::Status TensorsToDetectionsCalculator::DecodeBoxes(
 
 absl::Status TensorsToDetectionsCalculator::ConvertToDetections(
     const float* detection_boxes, const float* detection_scores,
-    const int* detection_classes, std::vector<Detection>* output_detections) {
-  for (int i = 0; i < num_boxes_; ++i) {
+    const int* detection_classes, int num_detections,
+    FlatDetections* output_detections) {
+  for (int i = 0; i < num_detections; ++i) {
     if (max_results_ > 0 && output_detections->size() == max_results_) {
       break;
     }
@@ -799,60 +1051,64 @@ absl::Status TensorsToDetectionsCalculator::ConvertToDetections(
       continue;
     }
     const int box_offset = i * num_coords_;
-    Detection detection = ConvertToDetection(
-        /*box_ymin=*/detection_boxes[box_offset + box_indices_[0]],
-        /*box_xmin=*/detection_boxes[box_offset + box_indices_[1]],
-        /*box_ymax=*/detection_boxes[box_offset + box_indices_[2]],
-        /*box_xmax=*/detection_boxes[box_offset + box_indices_[3]],
-        detection_scores[i], detection_classes[i], options_.flip_vertically());
-    const auto& bbox = detection.location_data().relative_bounding_box();
-    if (bbox.width() < 0 || bbox.height() < 0 || std::isnan(bbox.width()) ||
-        std::isnan(bbox.height())) {
+    const float box_ymin = detection_boxes[box_offset + box_indices_[0]];
+    const float box_xmin = detection_boxes[box_offset + box_indices_[1]];
+    const float box_ymax = detection_boxes[box_offset + box_indices_[2]];
+    const float box_xmax = detection_boxes[box_offset + box_indices_[3]];
+    const float width = box_xmax - box_xmin;
+    const float height = box_ymax - box_ymin;
+    if (width < 0 || height < 0 || std::isnan(width) || std::isnan(height)) {
       // Decoded detection boxes could have negative values for width/height due
       // to model prediction. Filter out those boxes since some downstream
       // calculators may assume non-negative values. (b/171391719)
       continue;
     }
-    // Add keypoints.
-    if (options_.num_keypoints() > 0) {
-      auto* location_data = detection.mutable_location_data();
-      for (int kp_id = 0; kp_id < options_.num_keypoints() *
-                                      options_.num_values_per_keypoint();
-           kp_id += options_.num_values_per_keypoint()) {
-        auto keypoint = location_data->add_relative_keypoints();
-        const int keypoint_index =
-            box_offset + options_.keypoint_coord_offset() + kp_id;
-        keypoint->set_x(detection_boxes[keypoint_index + 0]);
-        keypoint->set_y(options_.flip_vertically()
-                            ? 1.f - detection_boxes[keypoint_index + 1]
-                            : detection_boxes[keypoint_index + 1]);
-      }
+    // Gather keypoints.
+    for (int k = 0; k < options_.num_keypoints(); ++k) {
+      const int keypoint_index = box_offset + options_.keypoint_coord_offset() +
+                                 k * options_.num_values_per_keypoint();
+      keypoints_[k * 2] = detection_boxes[keypoint_index + 0];
+      keypoints_[k * 2 + 1] = options_.flip_vertically()
+                                  ? 1.f - detection_boxes[keypoint_index + 1]
+                                  : detection_boxes[keypoint_index + 1];
     }
-    output_detections->emplace_back(detection);
+    const float ymin = options_.flip_vertically() ? 1.f - box_ymax : box_ymin;
+    if (!has_image_transform_) {
+      output_detections->Add(box_xmin, ymin, width, height,
+                             detection_scores[i], detection_classes[i],
+                             keypoints_.data());
+      continue;
+    }
+    // Map the keypoints and box corners onto the image, and output the box
+    // encompassing the mapped corners.
+    const auto& m = image_transform_;
+    for (int k = 0; k < options_.num_keypoints(); ++k) {
+      const float x = keypoints_[k * 2];
+      const float y = keypoints_[k * 2 + 1];
+      keypoints_[k * 2] = x * m[0] + y * m[1] + m[2];
+      keypoints_[k * 2 + 1] = x * m[3] + y * m[4] + m[5];
+    }
+    const float xmax = box_xmin + width;
+    const float ymax = ymin + height;
+    const float x0 = box_xmin * m[0] + ymin * m[1] + m[2];
+    const float y0 = box_xmin * m[3] + ymin * m[4] + m[5];
+    const float x1 = xmax * m[0] + ymin * m[1] + m[2];
+    const float y1 = xmax * m[3] + ymin * m[4] + m[5];
+    const float x2 = xmax * m[0] + ymax * m[1] + m[2];
+    const float y2 = xmax * m[3] + ymax * m[4] + m[5];
+    const float x3 = box_xmin * m[0] + ymax * m[1] + m[2];
+    const float y3 = box_xmin * m[3] + ymax * m[4] + m[5];
+    const float left = std::min(std::min(x0, x1), std::min(x2, x3));
+    const float top = std::min(std::min(y0, y1), std::min(y2, y3));
+    const float right = std::max(std::max(x0, x1), std::max(x2, x3));
+    const float bottom = std::max(std::max(y0, y1), std::max(y2, y3));
+    output_detections->Add(left, top, right - left, bottom - top,
+                           detection_scores[i], detection_classes[i],
+                           keypoints_.data());
   }
   return absl::OkStatus();
 }
 
-Detection TensorsToDetectionsCalculator::ConvertToDetection(
-    float box_ymin, float box_xmin, float box_ymax, float box_xmax, float score,
-    int class_id, bool flip_vertically) {
-  Detection detection;
-  detection.add_score(score);
-  detection.add_label_id(class_id);
-
-  LocationData* location_data = detection.mutable_location_data();
-  location_data->set_format(LocationData::RELATIVE_BOUNDING_BOX);
-
-  LocationData::RelativeBoundingBox* relative_bbox =
-      location_data->mutable_relative_bounding_box();
-
-  relative_bbox->set_xmin(box_xmin);
-  relative_bbox->set_ymin(flip_vertically ? 1.f - box_ymax : box_ymin);
-  relative_bbox->set_width(box_xmax - box_xmin);
-  relative_bbox->set_height(box_ymax - box_ymin);
-  return detection;
-}
-
 absl::Status TensorsToDetectionsCalculator::GpuInit(CalculatorContext* cc) {
 #ifndef MEDIAPIPE_DISABLE_GL_COMPUTE
   MP_RETURN_IF_ERROR(gpu_helper_.RunInGlContext([this]() -> absl::Status {
@@ -1082,6 +1338,176 @@ void main() {
     scored_boxes_buffer_ = absl::make_unique<Tensor>(
         Tensor::ElementType::kFloat32, Tensor::Shape{1, num_boxes_ * 2});
 
+    if (!options_.has_suppression()) {
+      return absl::OkStatus();
+    }
+    // A shader to filter, compact and suppress the scored boxes in a single
+    // workgroup.
+    const std::string suppress_src = absl::Substitute(
+        R"( #version 310 es
+
+layout(local_size_x = $0, local_size_y = 1, local_size_z = 1) in;
+
+#define FLT_MAX 1.0e+37
+#define MAX_CANDIDATES $1u
+
+layout(std430, binding = 0) writeonly buffer Output {
+  float data[];
+} detections;
+
+layout(std430, binding = 1) readonly buffer Input0 {
+  float data[];
+} boxes;
+
+layout(std430, binding = 2) readonly buffer Input1 {
+  float data[];
+} scored_boxes;
+
+uint workgroup_size = uint($0);
+uint num_boxes = uint($2);
+uint num_coords = uint($3);
+float min_score = float($4);
+float iou_threshold = float($5);
+uint max_detections = uint($6);
+ivec4 box_indices = ivec4($7);
+
+shared uint num_candidates;
+shared uint candidate_index[MAX_CANDIDATES];
+shared float candidate_score[MAX_CANDIDATES];
+shared uint keep[MAX_CANDIDATES];
+
+// Returns the box as (ymin, xmin, ymax, xmax).
+vec4 GetBox(uint i) {
+  uint offset = i * num_coords;
+  return vec4(boxes.data[offset + uint(box_indices.x)],
+              boxes.data[offset + uint(box_indices.y)],
+              boxes.data[offset + uint(box_indices.z)],
+              boxes.data[offset + uint(box_indices.w)]);
+}
+
+float IntersectionOverUnion(vec4 a, vec4 b) {
+  vec2 lo = max(a.xy, b.xy);
+  vec2 hi = min(a.zw, b.zw);
+  if (hi.x <= lo.x || hi.y <= lo.y) return 0.0;
+  float intersection = (hi.x - lo.x) * (hi.y - lo.y);
+  float area_a = (a.z - a.x) * (a.w - a.y);
+  float area_b = (b.z - b.x) * (b.w - b.y);
+  return intersection / (area_a + area_b - intersection);
+}
+
+void main() {
+  uint tid = gl_LocalInvocationID.x;
+  if (tid == 0u) num_candidates = 0u;
+  memoryBarrierShared();
+  barrier();
+
+  // Compacts the boxes passing the score threshold.
+  for (uint i = tid; i < num_boxes; i += workgroup_size) {
+    float score = scored_boxes.data[i * 2u];
+    if (score < min_score) continue;
+    vec4 box = GetBox(i);
+    if (!(box.z >= box.x && box.w >= box.y)) continue;
+    uint slot = atomicAdd(num_candidates, 1u);
+    if (slot < MAX_CANDIDATES) {
+      candidate_index[slot] = i;
+      candidate_score[slot] = score;
+    }
+  }
+  memoryBarrierShared();
+  barrier();
+  uint n = min(num_candidates, MAX_CANDIDATES);
+  for (uint i = n + tid; i < MAX_CANDIDATES; i += workgroup_size) {
+    candidate_index[i] = 0u;
+    candidate_score[i] = -FLT_MAX;
+  }
+  memoryBarrierShared();
+  barrier();
+
+  // Bitonic sort by descending score.
+  for (uint k = 2u; k <= MAX_CANDIDATES; k <<= 1u) {
+    for (uint j = k >> 1u; j > 0u; j >>= 1u) {
+      for (uint i = tid; i < MAX_CANDIDATES; i += workgroup_size) {
+        uint partner = i ^ j;
+        if (partner <= i) continue;
+        bool descending = (i & k) == 0u;
+        float a = candidate_score[i];
+        float b = candidate_score[partner];
+        if ((a < b) == descending) {
+          candidate_score[i] = b;
+          candidate_score[partner] = a;
+          uint index = candidate_index[i];
+          candidate_index[i] = candidate_index[partner];
+          candidate_index[partner] = index;
+        }
+      }
+      memoryBarrierShared();
+      barrier();
+    }
+  }
+
+  // Greedy suppression, each kept box clears the boxes it overlaps in
+  // parallel.
+  for (uint i = tid; i < n; i += workgroup_size) keep[i] = 1u;
+  memoryBarrierShared();
+  barrier();
+  uint num_kept = 0u;
+  for (uint i = 0u; i < n && num_kept < max_detections; ++i) {
+    if (keep[i] != 0u) {
+      ++num_kept;
+      vec4 kept_box = GetBox(candidate_index[i]);
+      for (uint j = i + 1u + tid; j < n; j += workgroup_size) {
+        if (keep[j] != 0u &&
+            IntersectionOverUnion(kept_box, GetBox(candidate_index[j])) >
+                iou_threshold) {
+          keep[j] = 0u;
+        }
+      }
+    }
+    memoryBarrierShared();
+    barrier();
+  }
+
+  if (tid == 0u) {
+    uint count = 0u;
+    for (uint i = 0u; i < n && count < max_detections; ++i) {
+      if (keep[i] == 0u) continue;
+      uint src = candidate_index[i];
+      uint dst = 1u + count * (num_coords + 2u);
+      detections.data[dst] = candidate_score[i];
+      detections.data[dst + 1u] = scored_boxes.data[src * 2u + 1u];
+      for (uint c = 0u; c < num_coords; ++c) {
+        detections.data[dst + 2u + c] = boxes.data[src * num_coords + c];
+      }
+      ++count;
+    }
+    detections.data[0] = float(count);
+  }
+})",
+        kGpuSuppressionWorkgroupSize, kMaxGpuSuppressionCandidates,
+        num_boxes_, num_coords_,
+        options_.has_min_score_thresh() ? options_.min_score_thresh()
+                                        : -std::numeric_limits<float>::max(),
+        options_.suppression().min_suppression_threshold(),
+        options_.suppression().max_num_detections(),
+        absl::StrJoin(box_indices_, ", "));
+    {
+      GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+      const GLchar* sources[] = {suppress_src.c_str()};
+      glShaderSource(shader, 1, sources, NULL);
+      glCompileShader(shader);
+      GLint compiled = GL_FALSE;
+      glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+      RET_CHECK(compiled == GL_TRUE);
+      suppress_program_ = glCreateProgram();
+      glAttachShader(suppress_program_, shader);
+      glDeleteShader(shader);
+      glLinkProgram(suppress_program_);
+    }
+    suppressed_detections_buffer_ = absl::make_unique<Tensor>(
+        Tensor::ElementType::kFloat32,
+        Tensor::Shape{1, 1 + options_.suppression().max_num_detections() *
+                                 (num_coords_ + 2)});
+
     return absl::OkStatus();
   }));
 
@@ -1305,11 +1731,300 @@ kernel void scoreKernel(
     CHECK_LT(num_classes_, max_wg_size) << "# classes must be <" << max_wg_size;
   }
 
+  if (options_.has_suppression()) {
+    // A shader to filter, compact and suppress the scored boxes in a single
+    // threadgroup.
+    const std::string suppress_src = absl::Substitute(
+        R"(
+#include <metal_stdlib>
+
+using namespace metal;
+
+#define MAX_CANDIDATES $1u
+
+// Returns the box as (ymin, xmin, ymax, xmax).
+float4 GetBox(device float* boxes, uint i) {
+  uint num_coords = uint($3);
+  int4 box_indices = int4($7);
+  uint offset = i * num_coords;
+  return float4(boxes[offset + uint(box_indices.x)],
+                boxes[offset + uint(box_indices.y)],
+                boxes[offset + uint(box_indices.z)],
+                boxes[offset + uint(box_indices.w)]);
+}
+
+float IntersectionOverUnion(float4 a, float4 b) {
+  float2 lo = max(a.xy, b.xy);
+  float2 hi = min(a.zw, b.zw);
+  if (hi.x <= lo.x || hi.y <= lo.y) return 0.0;
+  float intersection = (hi.x - lo.x) * (hi.y - lo.y);
+  float area_a = (a.z - a.x) * (a.w - a.y);
+  float area_b = (b.z - b.x) * (b.w - b.y);
+  return intersection / (area_a + area_b - intersection);
+}
+
+kernel void suppressKernel(
+    device float*             detections   [[ buffer(0) ]],
+    device float*             boxes        [[ buffer(1) ]],
+    device float*             scored_boxes [[ buffer(2) ]],
+    uint                      tid          [[ thread_index_in_threadgroup ]]) {
+  uint workgroup_size = uint($0);
+  uint num_boxes = uint($2);
+  uint num_coords = uint($3);
+  float min_score = float($4);
+  float iou_threshold = float($5);
+  uint max_detections = uint($6);
+
+  threadgroup atomic_uint num_candidates;
+  threadgroup uint candidate_index[MAX_CANDIDATES];
+  threadgroup float candidate_score[MAX_CANDIDATES];
+  threadgroup uint keep[MAX_CANDIDATES];
+
+  if (tid == 0u) {
+    atomic_store_explicit(&num_candidates, 0u, memory_order_relaxed);
+  }
+  threadgroup_barrier(mem_flags::mem_threadgroup);
+
+  // Compacts the boxes passing the score threshold.
+  for (uint i = tid; i < num_boxes; i += workgroup_size) {
+    float score = scored_boxes[i * 2u];
+    if (score < min_score) continue;
+    float4 box = GetBox(boxes, i);
+    if (!(box.z >= box.x && box.w >= box.y)) continue;
+    uint slot = atomic_fetch_add_explicit(&num_candidates, 1u,
+                                          memory_order_relaxed);
+    if (slot < MAX_CANDIDATES) {
+      candidate_index[slot] = i;
+      candidate_score[slot] = score;
+    }
+  }
+  threadgroup_barrier(mem_flags::mem_threadgroup);
+  uint n = min(atomic_load_explicit(&num_candidates, memory_order_relaxed),
+               MAX_CANDIDATES);
+  for (uint i = n + tid; i < MAX_CANDIDATES; i += workgroup_size) {
+    candidate_index[i] = 0u;
+    candidate_score[i] = -FLT_MAX;
+  }
+  threadgroup_barrier(mem_flags::mem_threadgroup);
+
+  // Bitonic sort by descending score.
+  for (uint k = 2u; k <= MAX_CANDIDATES; k <<= 1u) {
+    for (uint j = k >> 1u; j > 0u; j >>= 1u) {
+      for (uint i = tid; i < MAX_CANDIDATES; i += workgroup_size) {
+        uint partner = i ^ j;
+        if (partner <= i) continue;
+        bool descending = (i & k) == 0u;
+        float a = candidate_score[i];
+        float b = candidate_score[partner];
+        if ((a < b) == descending) {
+          candidate_score[i] = b;
+          candidate_score[partner] = a;
+          uint index = candidate_index[i];
+          candidate_index[i] = candidate_index[partner];
+          candidate_index[partner] = index;
+        }
+      }
+      threadgroup_barrier(mem_flags::mem_threadgroup);
+    }
+  }
+
+  // Greedy suppression, each kept box clears the boxes it overlaps in
+  // parallel.
+  for (uint i = tid; i < n; i += workgroup_size) keep[i] = 1u;
+  threadgroup_barrier(mem_flags::mem_threadgroup);
+  uint num_kept = 0u;
+  for (uint i = 0u; i < n && num_kept < max_detections; ++i) {
+    if (keep[i] != 0u) {
+      ++num_kept;
+      float4 kept_box = GetBox(boxes, candidate_index[i]);
+      for (uint j = i + 1u + tid; j < n; j += workgroup_size) {
+        if (keep[j] != 0u &&
+            IntersectionOverUnion(kept_box, GetBox(boxes, candidate_index[j])) >
+                iou_threshold) {
+          keep[j] = 0u;
+        }
+      }
+    }
+    threadgroup_barrier(mem_flags::mem_threadgroup);
+  }
+
+  if (tid == 0u) {
+    uint count = 0u;
+    for (uint i = 0u; i < n && count < max_detections; ++i) {
+      if (keep[i] == 0u) continue;
+      uint src = candidate_index[i];
+      uint dst = 1u + count * (num_coords + 2u);
+      detections[dst] = candidate_score[i];
+      detections[dst + 1u] = scored_boxes[src * 2u + 1u];
+      for (uint c = 0u; c < num_coords; ++c) {
+        detections[dst + 2u + c] = boxes[src * num_coords + c];
+      }
+      ++count;
+    }
+    detections[0] = float(count);
+  }
+})",
+        kGpuSuppressionWorkgroupSize, kMaxGpuSuppressionCandidates,
+        num_boxes_, num_coords_,
+        options_.has_min_score_thresh() ? options_.min_score_thresh()
+                                        : -std::numeric_limits<float>::max(),
+        options_.suppression().min_suppression_threshold(),
+        options_.suppression().max_num_detections(),
+        absl::StrJoin(box_indices_, ", "));
+
+    NSString* library_source =
+        [NSString stringWithUTF8String:suppress_src.c_str()];
+    NSError* error = nil;
+    id<MTLLibrary> library = [device newLibraryWithSource:library_source
+                                                  options:nullptr
+                                                    error:&error];
+    RET_CHECK(library != nil) << "Couldn't create shader library "
+                              << [[error localizedDescription] UTF8String];
+    id<MTLFunction> kernel_func = nil;
+    kernel_func = [library newFunctionWithName:@"suppressKernel"];
+    RET_CHECK(kernel_func != nil) << "Couldn't create kernel function.";
+    suppress_program_ =
+        [device newComputePipelineStateWithFunction:kernel_func error:&error];
+    RET_CHECK(suppress_program_ != nil) << "Couldn't create pipeline state " <<
+        [[error localizedDescription] UTF8String];
+    suppressed_detections_buffer_ = absl::make_unique<Tensor>(
+        Tensor::ElementType::kFloat32,
+        Tensor::Shape{1, 1 + options_.suppression().max_num_detections() *
+                                 (num_coords_ + 2)});
+  }
+
 #endif  // !defined(MEDIAPIPE_DISABLE_GL_COMPUTE)
 
   return absl::OkStatus();
 }
 
+float TensorsToDetectionsCalculator::GetRawScoreThreshold() const {
+  constexpr float kNoThreshold = -std::numeric_limits<float>::infinity();
+  if (!options_.has_min_score_thresh()) {
+    return kNoThreshold;
+  }
+  const float min_score = options_.min_score_thresh();
+  if (!options_.sigmoid_score()) {
+    return min_score;
+  }
+  if (min_score <= 0.0f || min_score >= 1.0f) {
+    // The sigmoid saturates, so the inverse can't be relied on.
+    return kNoThreshold;
+  }
+  // Inverts the sigmoid, with a margin for its rounding. Anchors that only
+  // pass the margin are dropped by ConvertToDetections.
+  const float threshold = std::log(min_score / (1.0f - min_score)) - 1e-4f;
+  if (options_.has_score_clipping_thresh() &&
+      threshold <= -options_.score_clipping_thresh()) {
+    // Every clipped score passes.
+    return kNoThreshold;
+  }
+  return threshold;
+}
+
+float TensorsToDetectionsCalculator::ActivateScore(float raw_score) const {
+  if (!options_.sigmoid_score()) {
+    return raw_score;
+  }
+  if (options_.has_score_clipping_thresh()) {
+    raw_score = std::clamp(raw_score, -options_.score_clipping_thresh(),
+                           options_.score_clipping_thresh());
+  }
+  return 1.0f / (1.0f + std::exp(-raw_score));
+}
+
+absl::Status TensorsToDetectionsCalculator::ConvertSuppressedDetections(
+    FlatDetections* output_detections) {
+  auto view = suppressed_detections_buffer_->GetCpuReadView();
+  const float* data = view.buffer<float>();
+  const int num_detections = static_cast<int>(data[0]);
+  const int stride = num_coords_ + 2;
+  std::vector<float> boxes(num_detections * num_coords_);
+  std::vector<float> detection_scores(num_detections);
+  std::vector<int> detection_classes(num_detections);
+  for (int i = 0; i < num_detections; ++i) {
+    const float* detection = data + 1 + i * stride;
+    detection_scores[i] = detection[0];
+    detection_classes[i] = static_cast<int>(detection[1]);
+    std::copy_n(detection + 2, num_coords_, boxes.data() + i * num_coords_);
+  }
+  return ConvertToDetections(boxes.data(), detection_scores.data(),
+                             detection_classes.data(), num_detections,
+                             output_detections);
+}
+
+float TensorsToDetectionsCalculator::GetIntersectionOverUnion(
+    const float* box_a, const float* box_b) const {
+  const float ymin = std::max(box_a[box_indices_[0]], box_b[box_indices_[0]]);
+  const float xmin = std::max(box_a[box_indices_[1]], box_b[box_indices_[1]]);
+  const float ymax = std::min(box_a[box_indices_[2]], box_b[box_indices_[2]]);
+  const float xmax = std::min(box_a[box_indices_[3]], box_b[box_indices_[3]]);
+  if (ymax <= ymin || xmax <= xmin) {
+    return 0.0f;
+  }
+  const float intersection = (ymax - ymin) * (xmax - xmin);
+  const float area_a = (box_a[box_indices_[2]] - box_a[box_indices_[0]]) *
+                       (box_a[box_indices_[3]] - box_a[box_indices_[1]]);
+  const float area_b = (box_b[box_indices_[2]] - box_b[box_indices_[0]]) *
+                       (box_b[box_indices_[3]] - box_b[box_indices_[1]]);
+  return intersection / (area_a + area_b - intersection);
+}
+
+void TensorsToDetectionsCalculator::SuppressDetections(
+    std::vector<float>* boxes, std::vector<float>* scores,
+    std::vector<int>* classes) const {
+  const auto& suppression = options_.suppression();
+  // Only detections that ConvertToDetections would keep take part.
+  std::vector<int> order;
+  order.reserve(scores->size());
+  for (int i = 0; i < scores->size(); ++i) {
+    const float* box = boxes->data() + i * num_coords_;
+    const float width = box[box_indices_[3]] - box[box_indices_[1]];
+    const float height = box[box_indices_[2]] - box[box_indices_[0]];
+    if ((options_.has_min_score_thresh() &&
+         (*scores)[i] < options_.min_score_thresh()) ||
+        !(width >= 0 && height >= 0)) {
+      continue;
+    }
+    order.push_back(i);
+  }
+  std::stable_sort(order.begin(), order.end(), [scores](int a, int b) {
+    return (*scores)[a] > (*scores)[b];
+  });
+
+  std::vector<int> kept;
+  for (int i : order) {
+    if (static_cast<int>(kept.size()) == suppression.max_num_detections()) {
+      break;
+    }
+    const float* box = boxes->data() + i * num_coords_;
+    bool suppressed = false;
+    for (int k : kept) {
+      if (GetIntersectionOverUnion(boxes->data() + k * num_coords_, box) >
+          suppression.min_suppression_threshold()) {
+        suppressed = true;
+        break;
+      }
+    }
+    if (!suppressed) {
+      kept.push_back(i);
+    }
+  }
+
+  std::vector<float> kept_boxes(kept.size() * num_coords_);
+  std::vector<float> kept_scores(kept.size());
+  std::vector<int> kept_classes(kept.size());
+  for (int j = 0; j < kept.size(); ++j) {
+    std::copy_n(boxes->data() + kept[j] * num_coords_, num_coords_,
+                kept_boxes.data() + j * num_coords_);
+    kept_scores[j] = (*scores)[kept[j]];
+    kept_classes[j] = (*classes)[kept[j]];
+  }
+  *boxes = std::move(kept_boxes);
+  *scores = std::move(kept_scores);
+  *classes = std::move(kept_classes);
+}
+
 bool TensorsToDetectionsCalculator::IsClassIndexAllowed(int class_index) {
   if (class_index_set_.values.empty()) {
     return true;
@@ -16,6 +16,7 @@
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/tensor_element_conversion.h"
 #include "mediapipe/framework/port/ret_check.h"
 
 namespace mediapipe {
@@ -29,8 +30,9 @@ inline float Sigmoid(float value) { return 1.0f / (1.0f + std::exp(-value)); }
 // A calculator for converting Tensors to to a float or a float vector.
 //
 // Input:
-//  TENSORS - Vector of Tensors of type kFloat32. Only the first
-//            tensor will be used.
+//  TENSORS - Vector of Tensors of type kFloat32, kFloat16, kUInt8 or kInt8.
+//            Only the first tensor will be used. kUInt8 and kInt8 tensors are
+//            dequantized with their quantization parameters.
 // Output:
 //  FLOAT(optional) - Converted single float number.
 //  FLOATS(optional) - Converted float vector.
@@ -76,13 +78,11 @@ absl::Status TensorsToFloatsCalculator::Open(CalculatorContext* cc) {
 absl::Status TensorsToFloatsCalculator::Process(CalculatorContext* cc) {
   const auto& input_tensors = *kInTensors(cc);
   RET_CHECK(!input_tensors.empty());
-  RET_CHECK(input_tensors[0].element_type() == Tensor::ElementType::kFloat32);
   // TODO: Add option to specify which tensor to take from.
-  auto view = input_tensors[0].GetCpuReadView();
-  auto raw_floats = view.buffer<float>();
   int num_values = input_tensors[0].shape().num_elements();
-  auto output_floats = absl::make_unique<std::vector<float>>(
-      raw_floats, raw_floats + num_values);
+  auto output_floats = absl::make_unique<std::vector<float>>(num_values);
+  MP_RETURN_IF_ERROR(
+      CopyTensorToFloat32(input_tensors[0], output_floats->data()));
 
   switch (options_.activation()) {
     case TensorsToFloatsCalculatorOptions::SIGMOID:
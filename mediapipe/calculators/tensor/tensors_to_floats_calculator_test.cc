@@ -141,4 +141,32 @@ TEST_F(TensorsToFloatsCalculatorTest, FloatVectorWithSigmoid) {
   }
 }
 
+TEST_F(TensorsToFloatsCalculatorTest, QuantizedVector) {
+  mediapipe::CalculatorRunner runner(ParseTextProtoOrDie<Node>(R"pb(
+    calculator: "TensorsToFloatsCalculator"
+    input_stream: "TENSORS:tensors"
+    output_stream: "FLOATS:floats"
+  )pb"));
+
+  auto tensors = absl::make_unique<std::vector<Tensor>>();
+  tensors->emplace_back(Tensor::ElementType::kUInt8, Tensor::Shape{1, 3},
+                        Tensor::QuantizationParameters(0.5f, 2));
+  {
+    auto view = tensors->back().GetCpuWriteView();
+    uint8* buffer = view.buffer<uint8>();
+    buffer[0] = 0;
+    buffer[1] = 2;
+    buffer[2] = 4;
+  }
+  runner.MutableInputs()->Tag("TENSORS").packets.push_back(
+      mediapipe::Adopt(tensors.release()).At(mediapipe::Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& output_packets_ = runner.Outputs().Tag("FLOATS").packets;
+  EXPECT_EQ(1, output_packets_.size());
+
+  const auto& values = output_packets_[0].Get<std::vector<float>>();
+  EXPECT_EQ(std::vector<float>({-1.f, 0.f, 1.f}), values);
+}
+
 }  // namespace mediapipe
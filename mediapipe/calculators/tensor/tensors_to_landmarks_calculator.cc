@@ -12,11 +12,18 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
 #include "mediapipe/calculators/tensor/tensors_to_landmarks_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/packed_landmarks.h"
 #include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/tensor_element_conversion.h"
 #include "mediapipe/framework/port/ret_check.h"
 
 namespace mediapipe {
@@ -38,6 +45,29 @@ float ApplyActivation(
   }
 }
 
+typedef std::array<float, 16> Matrix;
+
+// Returns the row-major product @a x @b, i.e. the transform applying @b first.
+Matrix MultiplyMatrices(const Matrix& a, const Matrix& b) {
+  Matrix result;
+  for (int row = 0; row < 4; ++row) {
+    for (int col = 0; col < 4; ++col) {
+      float value = 0.0f;
+      for (int k = 0; k < 4; ++k) {
+        value += a[row * 4 + k] * b[k * 4 + col];
+      }
+      result[row * 4 + col] = value;
+    }
+  }
+  return result;
+}
+
+// The Z scale of a projection matrix, as in LandmarkProjectionCalculator: the
+// length of the projected unit X vector.
+float ProjectionZScale(const Matrix& matrix) {
+  return std::sqrt(matrix[0] * matrix[0] + matrix[4] * matrix[4]);
+}
+
 }  // namespace
 
 // A calculator for converting Tensors from regression models into landmarks.
@@ -47,8 +77,10 @@ float ApplyActivation(
 // the model.
 //
 // Input:
-//  TENSORS - Vector of Tensors of type kFloat32. Only the first tensor will be
-//  used. The size of the values must be (num_dimension x num_landmarks).
+//  TENSORS - Vector of Tensors of type kFloat32, kFloat16, kUInt8 or kInt8.
+//  Only the first tensor will be used. The size of the values must be
+//  (num_dimension x num_landmarks). kUInt8 and kInt8 tensors are dequantized
+//  with their quantization parameters.
 //
 //  FLIP_HORIZONTALLY (optional): Whether to flip landmarks horizontally or
 //  not. Overrides corresponding side packet and/or field in the calculator
@@ -57,6 +89,21 @@ float ApplyActivation(
 //  FLIP_VERTICALLY (optional): Whether to flip landmarks vertically or not.
 //  Overrides corresponding side packet and/or field in the calculator options.
 //
+//  LETTERBOX_PADDING (optional): std::array<float, 4> with the [left, top,
+//  right, bottom] padding of the model input, as output by
+//  ImageToTensorCalculator. Removed from the normalized landmarks, like
+//  LandmarkLetterboxRemovalCalculator does.
+//
+//  PROJECTION_MATRIX (optional): std::array<float, 16> projecting the
+//  normalized landmarks back onto the image, like the PROJECTION_MATRIX of
+//  LandmarkProjectionCalculator. Applied after letterbox removal. The MATRIX
+//  of ImageToTensorCalculator already accounts for the padding, so it doesn't
+//  need LETTERBOX_PADDING.
+//
+//  PROJECTION_MATRICES (optional): std::vector<std::array<float, 16>> with a
+//  projection matrix per batch item, e.g. the MATRICES of a batched
+//  ImageToTensorCalculator. Only for the MULTI_ outputs.
+//
 // Input side packet:
 //   FLIP_HORIZONTALLY (optional): Whether to flip landmarks horizontally or
 //   not. Overrides the corresponding field in the calculator options.
@@ -67,11 +114,25 @@ float ApplyActivation(
 // Output:
 //  LANDMARKS(optional) - Result MediaPipe landmarks.
 //  NORM_LANDMARKS(optional) - Result MediaPipe normalized landmarks.
+//  PACKED_NORM_LANDMARKS(optional) - The normalized landmarks as
+//    PackedLandmarks, for calculators that can operate on them directly.
+//  MULTI_LANDMARKS(optional) - Result landmarks of every item of a batch
+//    tensor, i.e. the first dimension of the tensor is the batch size.
+//  MULTI_NORM_LANDMARKS(optional) - Result normalized landmarks of every item
+//    of a batch tensor.
+//  MULTI_PACKED_NORM_LANDMARKS(optional) - The normalized landmarks of every
+//    item of a batch tensor as PackedLandmarks.
+//
+//  The MULTI_ outputs can't be used together with the single-item outputs.
 //
 // Notes:
 //   To output normalized landmarks, user must provide the original input image
 //   size to the model using calculator option input_image_width and
 //   input_image_height.
+//
+//   The activations are applied while unpacking the tensor, and flipping,
+//   normalization, letterbox removal and projection are folded into a single
+//   transform of each list.
 // Usage example:
 // node {
 //   calculator: "TensorsToLandmarksCalculator"
@@ -94,31 +155,79 @@ class TensorsToLandmarksCalculator : public Node {
       "FLIP_HORIZONTALLY"};
   static constexpr Input<bool>::SideFallback::Optional kFlipVertically{
       "FLIP_VERTICALLY"};
+  static constexpr Input<std::array<float, 4>>::Optional kInLetterboxPadding{
+      "LETTERBOX_PADDING"};
+  static constexpr Input<std::array<float, 16>>::Optional kInProjectionMatrix{
+      "PROJECTION_MATRIX"};
+  static constexpr Input<std::vector<std::array<float, 16>>>::Optional
+      kInProjectionMatrices{"PROJECTION_MATRICES"};
   static constexpr Output<LandmarkList>::Optional kOutLandmarkList{"LANDMARKS"};
   static constexpr Output<NormalizedLandmarkList>::Optional
       kOutNormalizedLandmarkList{"NORM_LANDMARKS"};
+  static constexpr Output<PackedLandmarks>::Optional kOutPackedLandmarks{
+      "PACKED_NORM_LANDMARKS"};
+  static constexpr Output<std::vector<LandmarkList>>::Optional
+      kOutMultiLandmarkList{"MULTI_LANDMARKS"};
+  static constexpr Output<std::vector<NormalizedLandmarkList>>::Optional
+      kOutMultiNormalizedLandmarkList{"MULTI_NORM_LANDMARKS"};
+  static constexpr Output<std::vector<PackedLandmarks>>::Optional
+      kOutMultiPackedLandmarks{"MULTI_PACKED_NORM_LANDMARKS"};
   MEDIAPIPE_NODE_CONTRACT(kInTensors, kFlipHorizontally, kFlipVertically,
-                          kOutLandmarkList, kOutNormalizedLandmarkList);
+                          kInLetterboxPadding, kInProjectionMatrix,
+                          kInProjectionMatrices, kOutLandmarkList,
+                          kOutNormalizedLandmarkList, kOutPackedLandmarks,
+                          kOutMultiLandmarkList,
+                          kOutMultiNormalizedLandmarkList,
+                          kOutMultiPackedLandmarks);
 
   absl::Status Open(CalculatorContext* cc) override;
   absl::Status Process(CalculatorContext* cc) override;
 
  private:
   absl::Status LoadOptions(CalculatorContext* cc);
+  // Converts the values of one item into landmarks in model input
+  // coordinates, applying the activations.
+  PackedLandmarks DecodeLandmarks(const float* raw_landmarks,
+                                  int num_dimensions);
+  // Returns the transform flipping landmarks in absolute coordinates.
+  Matrix GetFlipMatrix(bool flip_horizontally, bool flip_vertically);
+  // Returns the transform from absolute coordinates to normalized ones with
+  // the letterbox padding removed, and its Z scale.
+  Matrix GetNormalizationMatrix(CalculatorContext* cc, float* z_scale);
   int num_landmarks_ = 0;
   ::mediapipe::TensorsToLandmarksCalculatorOptions options_;
+  // Holds the values of non-float32 input tensors, converted to float32.
+  std::vector<float> converted_landmarks_;
 };
 MEDIAPIPE_REGISTER_NODE(TensorsToLandmarksCalculator);
 
 absl::Status TensorsToLandmarksCalculator::Open(CalculatorContext* cc) {
   MP_RETURN_IF_ERROR(LoadOptions(cc));
 
-  if (kOutNormalizedLandmarkList(cc).IsConnected()) {
+  const bool has_single_output = kOutLandmarkList(cc).IsConnected() ||
+                                 kOutNormalizedLandmarkList(cc).IsConnected() ||
+                                 kOutPackedLandmarks(cc).IsConnected();
+  const bool has_multi_output =
+      kOutMultiLandmarkList(cc).IsConnected() ||
+      kOutMultiNormalizedLandmarkList(cc).IsConnected() ||
+      kOutMultiPackedLandmarks(cc).IsConnected();
+  RET_CHECK(!(has_single_output && has_multi_output))
+      << "MULTI_ outputs can't be used together with single-item outputs.";
+  RET_CHECK(!kInProjectionMatrix(cc).IsConnected() || !has_multi_output)
+      << "Use PROJECTION_MATRICES with the MULTI_ outputs.";
+  RET_CHECK(!kInProjectionMatrices(cc).IsConnected() || has_multi_output)
+      << "PROJECTION_MATRICES requires the MULTI_ outputs.";
+
+  if (kOutNormalizedLandmarkList(cc).IsConnected() ||
+      kOutPackedLandmarks(cc).IsConnected() ||
+      kOutMultiNormalizedLandmarkList(cc).IsConnected() ||
+      kOutMultiPackedLandmarks(cc).IsConnected()) {
     RET_CHECK(options_.has_input_image_height() &&
               options_.has_input_image_width())
         << "Must provide input width/height for getting normalized landmarks.";
   }
-  if (kOutLandmarkList(cc).IsConnected() &&
+  if ((kOutLandmarkList(cc).IsConnected() ||
+       kOutMultiLandmarkList(cc).IsConnected()) &&
       (options_.flip_horizontally() || options_.flip_vertically() ||
        kFlipHorizontally(cc).IsConnected() ||
        kFlipVertically(cc).IsConnected())) {
@@ -139,73 +248,192 @@ absl::Status TensorsToLandmarksCalculator::Process(CalculatorContext* cc) {
   bool flip_vertically = kFlipVertically(cc).GetOr(options_.flip_vertically());
 
   const auto& input_tensors = *kInTensors(cc);
-  RET_CHECK(input_tensors[0].element_type() == Tensor::ElementType::kFloat32);
-  int num_values = input_tensors[0].shape().num_elements();
-  const int num_dimensions = num_values / num_landmarks_;
+  const Tensor& input_tensor = input_tensors[0];
+  int num_values = input_tensor.shape().num_elements();
+  const bool is_batch = kOutMultiLandmarkList(cc).IsConnected() ||
+                        kOutMultiNormalizedLandmarkList(cc).IsConnected() ||
+                        kOutMultiPackedLandmarks(cc).IsConnected();
+  const int batch_size = is_batch ? input_tensor.shape().dims[0] : 1;
+  RET_CHECK_GT(batch_size, 0);
+  const int num_dimensions = num_values / batch_size / num_landmarks_;
   CHECK_GT(num_dimensions, 0);
 
-  auto view = input_tensors[0].GetCpuReadView();
-  auto raw_landmarks = view.buffer<float>();
+  const bool is_float32 =
+      input_tensor.element_type() == Tensor::ElementType::kFloat32;
+  if (!is_float32) {
+    converted_landmarks_.resize(num_values);
+    MP_RETURN_IF_ERROR(
+        CopyTensorToFloat32(input_tensor, converted_landmarks_.data()));
+  }
+  auto view = input_tensor.GetCpuReadView();
+  const float* raw_landmarks =
+      is_float32 ? view.buffer<float>() : converted_landmarks_.data();
 
-  LandmarkList output_landmarks;
+  const Matrix flip_matrix = GetFlipMatrix(flip_horizontally, flip_vertically);
+  const bool flip = flip_horizontally || flip_vertically;
+  float z_scale = 1.0f;
+  const Matrix normalization_matrix =
+      MultiplyMatrices(GetNormalizationMatrix(cc, &z_scale), flip_matrix);
 
-  for (int ld = 0; ld < num_landmarks_; ++ld) {
-    const int offset = ld * num_dimensions;
-    Landmark* landmark = output_landmarks.add_landmark();
-
-    if (flip_horizontally) {
-      landmark->set_x(options_.input_image_width() - raw_landmarks[offset]);
-    } else {
-      landmark->set_x(raw_landmarks[offset]);
+  if (is_batch) {
+    const std::vector<Matrix>* projection_matrices = nullptr;
+    if (kInProjectionMatrices(cc).IsConnected()) {
+      if (kInProjectionMatrices(cc).IsEmpty()) {
+        return absl::OkStatus();
+      }
+      projection_matrices = &*kInProjectionMatrices(cc);
+      RET_CHECK_EQ(projection_matrices->size(), batch_size)
+          << "Expected a projection matrix per batch item.";
     }
-    if (num_dimensions > 1) {
-      if (flip_vertically) {
-        landmark->set_y(options_.input_image_height() -
-                        raw_landmarks[offset + 1]);
+    const bool normalize = kOutMultiNormalizedLandmarkList(cc).IsConnected() ||
+                           kOutMultiPackedLandmarks(cc).IsConnected();
+    const int item_size = num_landmarks_ * num_dimensions;
+    std::vector<LandmarkList> multi_landmarks;
+    std::vector<NormalizedLandmarkList> multi_norm_landmarks;
+    std::vector<PackedLandmarks> multi_packed_landmarks;
+    for (int i = 0; i < batch_size; ++i) {
+      PackedLandmarks landmarks =
+          DecodeLandmarks(raw_landmarks + i * item_size, num_dimensions);
+      if (kOutMultiLandmarkList(cc).IsConnected()) {
+        if (flip) {
+          PackedLandmarks flipped = landmarks;
+          flipped.Transform(flip_matrix, /*z_scale=*/1.0f);
+          multi_landmarks.push_back(ToLandmarkList(flipped));
+        } else {
+          multi_landmarks.push_back(ToLandmarkList(landmarks));
+        }
+      }
+      if (!normalize) continue;
+      if (projection_matrices != nullptr) {
+        const Matrix& projection_matrix = (*projection_matrices)[i];
+        landmarks.Transform(
+            MultiplyMatrices(projection_matrix, normalization_matrix),
+            z_scale * ProjectionZScale(projection_matrix));
       } else {
-        landmark->set_y(raw_landmarks[offset + 1]);
+        landmarks.Transform(normalization_matrix, z_scale);
+      }
+      if (kOutMultiNormalizedLandmarkList(cc).IsConnected()) {
+        multi_norm_landmarks.push_back(ToNormalizedLandmarkList(landmarks));
+      }
+      if (kOutMultiPackedLandmarks(cc).IsConnected()) {
+        multi_packed_landmarks.push_back(std::move(landmarks));
       }
     }
-    if (num_dimensions > 2) {
-      landmark->set_z(raw_landmarks[offset + 2]);
+    if (kOutMultiLandmarkList(cc).IsConnected()) {
+      kOutMultiLandmarkList(cc).Send(std::move(multi_landmarks));
     }
-    if (num_dimensions > 3) {
-      landmark->set_visibility(ApplyActivation(options_.visibility_activation(),
-                                               raw_landmarks[offset + 3]));
+    if (kOutMultiNormalizedLandmarkList(cc).IsConnected()) {
+      kOutMultiNormalizedLandmarkList(cc).Send(std::move(multi_norm_landmarks));
     }
-    if (num_dimensions > 4) {
-      landmark->set_presence(ApplyActivation(options_.presence_activation(),
-                                             raw_landmarks[offset + 4]));
+    if (kOutMultiPackedLandmarks(cc).IsConnected()) {
+      kOutMultiPackedLandmarks(cc).Send(std::move(multi_packed_landmarks));
+    }
+    return absl::OkStatus();
+  }
+
+  PackedLandmarks landmarks = DecodeLandmarks(raw_landmarks, num_dimensions);
+
+  // Output absolute landmarks.
+  if (kOutLandmarkList(cc).IsConnected()) {
+    if (flip) {
+      PackedLandmarks flipped = landmarks;
+      flipped.Transform(flip_matrix, /*z_scale=*/1.0f);
+      kOutLandmarkList(cc).Send(ToLandmarkList(flipped));
+    } else {
+      kOutLandmarkList(cc).Send(ToLandmarkList(landmarks));
     }
   }
 
   // Output normalized landmarks if required.
-  if (kOutNormalizedLandmarkList(cc).IsConnected()) {
-    NormalizedLandmarkList output_norm_landmarks;
-    for (int i = 0; i < output_landmarks.landmark_size(); ++i) {
-      const Landmark& landmark = output_landmarks.landmark(i);
-      NormalizedLandmark* norm_landmark = output_norm_landmarks.add_landmark();
-      norm_landmark->set_x(landmark.x() / options_.input_image_width());
-      norm_landmark->set_y(landmark.y() / options_.input_image_height());
-      // Scale Z coordinate as X + allow additional uniform normalization.
-      norm_landmark->set_z(landmark.z() / options_.input_image_width() /
-                           options_.normalize_z());
-      if (landmark.has_visibility()) {  // Set only if supported in the model.
-        norm_landmark->set_visibility(landmark.visibility());
-      }
-      if (landmark.has_presence()) {  // Set only if supported in the model.
-        norm_landmark->set_presence(landmark.presence());
+  if (kOutNormalizedLandmarkList(cc).IsConnected() ||
+      kOutPackedLandmarks(cc).IsConnected()) {
+    if (kInProjectionMatrix(cc).IsConnected()) {
+      if (kInProjectionMatrix(cc).IsEmpty()) {
+        return absl::OkStatus();
       }
+      const Matrix& projection_matrix = *kInProjectionMatrix(cc);
+      landmarks.Transform(
+          MultiplyMatrices(projection_matrix, normalization_matrix),
+          z_scale * ProjectionZScale(projection_matrix));
+    } else {
+      landmarks.Transform(normalization_matrix, z_scale);
+    }
+    if (kOutNormalizedLandmarkList(cc).IsConnected()) {
+      kOutNormalizedLandmarkList(cc).Send(ToNormalizedLandmarkList(landmarks));
+    }
+    if (kOutPackedLandmarks(cc).IsConnected()) {
+      kOutPackedLandmarks(cc).Send(std::move(landmarks));
     }
-    kOutNormalizedLandmarkList(cc).Send(std::move(output_norm_landmarks));
   }
 
-  // Output absolute landmarks.
-  if (kOutLandmarkList(cc).IsConnected()) {
-    kOutLandmarkList(cc).Send(std::move(output_landmarks));
+  return absl::OkStatus();
+}
+
+PackedLandmarks TensorsToLandmarksCalculator::DecodeLandmarks(
+    const float* raw_landmarks, int num_dimensions) {
+  // Gathers each attribute into its own plane.
+  PackedLandmarks landmarks(num_landmarks_);
+  landmarks.set_has_visibility(num_dimensions > 3);
+  landmarks.set_has_presence(num_dimensions > 4);
+  float* x = landmarks.x();
+  float* y = landmarks.y();
+  float* z = landmarks.z();
+  float* visibility = landmarks.visibility();
+  float* presence = landmarks.presence();
+  const auto visibility_activation = options_.visibility_activation();
+  const auto presence_activation = options_.presence_activation();
+  for (int ld = 0; ld < num_landmarks_; ++ld) {
+    const float* raw_landmark = raw_landmarks + ld * num_dimensions;
+    x[ld] = raw_landmark[0];
+    if (num_dimensions > 1) y[ld] = raw_landmark[1];
+    if (num_dimensions > 2) z[ld] = raw_landmark[2];
+    if (num_dimensions > 3) {
+      visibility[ld] = ApplyActivation(visibility_activation, raw_landmark[3]);
+    }
+    if (num_dimensions > 4) {
+      presence[ld] = ApplyActivation(presence_activation, raw_landmark[4]);
+    }
   }
+  return landmarks;
+}
 
-  return absl::OkStatus();
+Matrix TensorsToLandmarksCalculator::GetFlipMatrix(bool flip_horizontally,
+                                                   bool flip_vertically) {
+  const float width = options_.input_image_width();
+  const float height = options_.input_image_height();
+  return {flip_horizontally ? -1.0f : 1.0f, 0, 0,
+          flip_horizontally ? width : 0.0f,
+          0, flip_vertically ? -1.0f : 1.0f, 0,
+          flip_vertically ? height : 0.0f,
+          0, 0, 1, 0, 0, 0, 0, 1};
+}
+
+Matrix TensorsToLandmarksCalculator::GetNormalizationMatrix(
+    CalculatorContext* cc, float* z_scale) {
+  const float width = options_.input_image_width();
+  const float height = options_.input_image_height();
+  // Scale Z coordinate as X + allow additional uniform normalization.
+  *z_scale = 1.0f / width / options_.normalize_z();
+  Matrix normalization = {1.0f / width, 0, 0, 0, 0, 1.0f / height, 0, 0,
+                          0, 0, 1, 0, 0, 0, 0, 1};
+  if (!kInLetterboxPadding(cc).IsConnected() ||
+      kInLetterboxPadding(cc).IsEmpty()) {
+    return normalization;
+  }
+  const auto& padding = *kInLetterboxPadding(cc);
+  const float left = padding[0];
+  const float top = padding[1];
+  const float left_and_right = padding[0] + padding[2];
+  const float top_and_bottom = padding[1] + padding[3];
+  // Scale Z coordinate as X.
+  *z_scale /= 1.0f - left_and_right;
+  const Matrix letterbox_removal = {
+      1.0f / (1.0f - left_and_right), 0, 0,
+      -left / (1.0f - left_and_right),
+      0, 1.0f / (1.0f - top_and_bottom), 0,
+      -top / (1.0f - top_and_bottom),
+      0, 0, 1, 0, 0, 0, 0, 1};
+  return MultiplyMatrices(letterbox_removal, normalization);
 }
 
 absl::Status TensorsToLandmarksCalculator::LoadOptions(CalculatorContext* cc) {
@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include "absl/strings/str_format.h"
@@ -20,6 +22,8 @@
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/ret_check.h"
@@ -35,11 +39,6 @@
 #include "mediapipe/gpu/shader_util.h"
 #endif  // !MEDIAPIPE_DISABLE_GPU
 
-#if !MEDIAPIPE_DISABLE_OPENCV
-#include "mediapipe/framework/formats/image_opencv.h"
-#include "mediapipe/framework/port/opencv_imgproc_inc.h"
-#endif  // !MEDIAPIPE_DISABLE_OPENCV
-
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
 #include "tensorflow/lite/delegates/gpu/gl/converters/util.h"
 #include "tensorflow/lite/delegates/gpu/gl/gl_program.h"
@@ -57,6 +56,12 @@
 #include "mediapipe/gpu/MPPMetalUtil.h"
 #endif  // MEDIAPIPE_METAL_ENABLED
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 namespace {
 constexpr int kWorkgroupSize = 8;  // Block size for GPU shader.
 enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
@@ -79,6 +84,7 @@ bool CanUseGpu() {
 constexpr char kTensorsTag[] = "TENSORS";
 constexpr char kOutputSizeTag[] = "OUTPUT_SIZE";
 constexpr char kMaskTag[] = "MASK";
+constexpr char kRoiTag[] = "ROI";
 
 absl::StatusOr<std::tuple<int, int, int>> GetHwcFromDims(
     const std::vector<int>& dims) {
@@ -101,6 +107,167 @@ using ::tflite::gpu::gl::GlProgram;
 using ::tflite::gpu::gl::GlShader;
 #endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
 
+namespace {
+
+typedef TensorsToSegmentationCalculatorOptions Options;
+
+// The two source samples an output sample interpolates between, and the
+// weight of the second one.
+struct LinearTap {
+  int index0;
+  int index1;
+  float weight;
+};
+
+// Computes the taps of outputs [first, last) when linearly resizing
+// @src_size samples to @dst_size, with the pixel centers aligned as in
+// cv::resize().
+std::vector<LinearTap> ComputeLinearTaps(int src_size, int dst_size,
+                                         int first, int last) {
+  const float scale = static_cast<float>(src_size) / dst_size;
+  std::vector<LinearTap> taps(last - first);
+  for (int i = first; i < last; ++i) {
+    const float position = (i + 0.5f) * scale - 0.5f;
+    int index0 = static_cast<int>(std::floor(position));
+    float weight = position - index0;
+    if (index0 < 0) {
+      index0 = 0;
+      weight = 0.0f;
+    } else if (index0 >= src_size - 1) {
+      index0 = src_size - 1;
+      weight = 0.0f;
+    }
+    taps[i - first] = {index0, std::min(index0 + 1, src_size - 1), weight};
+  }
+  return taps;
+}
+
+// Applies @activation to a [height, width, channels] tensor.
+std::vector<float> ActivateMask(const float* tensor, int num_pixels,
+                                int channels, Options::Activation activation,
+                                int output_layer_index) {
+  std::vector<float> mask(num_pixels);
+  switch (activation) {
+    case Options::NONE:
+      for (int i = 0; i < num_pixels; ++i) {
+        mask[i] = tensor[i * channels];
+      }
+      break;
+    case Options::SIGMOID:
+      for (int i = 0; i < num_pixels; ++i) {
+        mask[i] = 1.0f / (std::exp(-tensor[i * channels]) + 1.0f);
+      }
+      break;
+    case Options::SOFTMAX:
+      for (int i = 0; i < num_pixels; ++i) {
+        const float pixel0 = tensor[i * 2];
+        const float pixel1 = tensor[i * 2 + 1];
+        const float max_pixel = std::max(pixel0, pixel1);
+        const float min_pixel = std::min(pixel0, pixel1);
+        const float softmax_denom =
+            /*exp(max_pixel - max_pixel)=*/1.0f +
+            std::exp(min_pixel - max_pixel);
+        mask[i] =
+            std::exp(tensor[i * 2 + output_layer_index] - max_pixel) /
+            softmax_denom;
+      }
+      break;
+  }
+  return mask;
+}
+
+// Horizontally resamples one row of the small mask.
+void ResampleRow(const float* src, const std::vector<LinearTap>& taps,
+                 float* dst) {
+  for (int i = 0; i < taps.size(); ++i) {
+    const float value0 = src[taps[i].index0];
+    const float value1 = src[taps[i].index1];
+    dst[i] = value0 + taps[i].weight * (value1 - value0);
+  }
+}
+
+// Writes the vertical interpolation of two resampled rows.
+void BlendRows(const float* row0, const float* row1, float weight, int size,
+               float* dst) {
+  for (int i = 0; i < size; ++i) {
+    dst[i] = row0[i] + weight * (row1[i] - row0[i]);
+  }
+}
+
+// Writes 255 where the vertical interpolation of two resampled rows is above
+// @threshold and 0 elsewhere, without storing the interpolated values.
+void BlendAndThresholdRows(const float* row0, const float* row1, float weight,
+                           float threshold, int size, uint8* dst) {
+  int i = 0;
+#if defined(__SSE2__)
+  const __m128 weight_v = _mm_set1_ps(weight);
+  const __m128 threshold_v = _mm_set1_ps(threshold);
+  const auto blend_and_compare = [&](int offset) {
+    const __m128 value0 = _mm_loadu_ps(row0 + offset);
+    const __m128 value1 = _mm_loadu_ps(row1 + offset);
+    const __m128 value = _mm_add_ps(
+        value0, _mm_mul_ps(weight_v, _mm_sub_ps(value1, value0)));
+    return _mm_castps_si128(_mm_cmpgt_ps(value, threshold_v));
+  };
+  for (; i + 16 <= size; i += 16) {
+    // All-ones comparison masks saturate to 0xff when packed.
+    const __m128i low =
+        _mm_packs_epi32(blend_and_compare(i), blend_and_compare(i + 4));
+    const __m128i high =
+        _mm_packs_epi32(blend_and_compare(i + 8), blend_and_compare(i + 12));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_packs_epi16(low, high));
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const float32x4_t weight_v = vdupq_n_f32(weight);
+  const float32x4_t threshold_v = vdupq_n_f32(threshold);
+  const auto blend_and_compare = [&](int offset) {
+    const float32x4_t value0 = vld1q_f32(row0 + offset);
+    const float32x4_t value1 = vld1q_f32(row1 + offset);
+    const float32x4_t value =
+        vaddq_f32(value0, vmulq_f32(weight_v, vsubq_f32(value1, value0)));
+    return vmovn_u32(vcgtq_f32(value, threshold_v));
+  };
+  for (; i + 16 <= size; i += 16) {
+    const uint16x8_t low =
+        vcombine_u16(blend_and_compare(i), blend_and_compare(i + 4));
+    const uint16x8_t high =
+        vcombine_u16(blend_and_compare(i + 8), blend_and_compare(i + 12));
+    vst1q_u8(dst + i, vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+  }
+#endif
+  for (; i < size; ++i) {
+    const float value = row0[i] + weight * (row1[i] - row0[i]);
+    dst[i] = value > threshold ? 255 : 0;
+  }
+}
+
+// Returns the pixel bounds [left, right) x [top, bottom) of the bounding box
+// of @roi in an image of the given size.
+void GetRoiBounds(const NormalizedRect& roi, int width, int height, int* left,
+                  int* top, int* right, int* bottom) {
+  const float roi_width = roi.width() * width;
+  const float roi_height = roi.height() * height;
+  const float cos_rotation = std::abs(std::cos(roi.rotation()));
+  const float sin_rotation = std::abs(std::sin(roi.rotation()));
+  const float half_width =
+      (roi_width * cos_rotation + roi_height * sin_rotation) / 2;
+  const float half_height =
+      (roi_width * sin_rotation + roi_height * cos_rotation) / 2;
+  const float center_x = roi.x_center() * width;
+  const float center_y = roi.y_center() * height;
+  *left = std::clamp(static_cast<int>(std::floor(center_x - half_width)), 0,
+                     width);
+  *right = std::clamp(static_cast<int>(std::ceil(center_x + half_width)),
+                      *left, width);
+  *top = std::clamp(static_cast<int>(std::floor(center_y - half_height)), 0,
+                    height);
+  *bottom = std::clamp(static_cast<int>(std::ceil(center_y + half_height)),
+                       *top, height);
+}
+
+}  // namespace
+
 // Converts Tensors from a tflite segmentation model to an image mask.
 //
 // Performs optional upscale to OUTPUT_SIZE dimensions if provided,
@@ -111,7 +278,12 @@ using ::tflite::gpu::gl::GlShader;
 // mask are both on CPU.
 //
 // On GPU, the mask is an RGBA image, in both the R & A channels, scaled 0-1.
-// On CPU, the mask is a ImageFormat::VEC32F1 image, with values scaled 0-1.
+// On CPU, the mask is a ImageFormat::VEC32F1 image, with values scaled 0-1,
+// or with mask_format CATEGORY an ImageFormat::GRAY8 image that is 255 where
+// the value is above category_threshold and 0 elsewhere. The CPU path applies
+// the activation at tensor resolution, then resizes and thresholds each
+// output row in one pass, so no full resolution float mask is allocated for
+// category masks.
 //
 //
 // Inputs:
@@ -121,9 +293,12 @@ using ::tflite::gpu::gl::GlShader;
 //            options.
 //   OUTPUT_SIZE(optional): std::pair<int, int>,
 //                          If provided, the size to upscale mask to.
+//   ROI(optional): NormalizedRect, CPU only. If provided, the mask is only
+//                  computed inside the bounding box of the rect and is 0
+//                  elsewhere.
 //
 // Output:
-//   MASK: An Image output mask, RGBA(GPU) / VEC32F1(CPU).
+//   MASK: An Image output mask, RGBA(GPU) / VEC32F1 or GRAY8(CPU).
 //
 // Options:
 //   See tensors_to_segmentation_calculator.proto
@@ -163,10 +338,6 @@ class TensorsToSegmentationCalculator : public CalculatorBase {
     return options_.gpu_origin() != mediapipe::GpuOrigin_Mode_TOP_LEFT;
   }
 
-#if !MEDIAPIPE_DISABLE_OPENCV
-  template <class T>
-  absl::Status ApplyActivation(cv::Mat& tensor_mat, cv::Mat* small_mask_mat);
-#endif  // !MEDIAPIPE_DISABLE_OPENCV
   ::mediapipe::TensorsToSegmentationCalculatorOptions options_;
 
 #if !MEDIAPIPE_DISABLE_GPU
@@ -196,6 +367,9 @@ absl::Status TensorsToSegmentationCalculator::GetContract(
   if (cc->Inputs().HasTag(kOutputSizeTag)) {
     cc->Inputs().Tag(kOutputSizeTag).Set<std::pair<int, int>>();
   }
+  if (cc->Inputs().HasTag(kRoiTag)) {
+    cc->Inputs().Tag(kRoiTag).Set<NormalizedRect>();
+  }
 
   // Outputs.
   cc->Outputs().Tag(kMaskTag).Set<Image>();
@@ -281,6 +455,10 @@ absl::Status TensorsToSegmentationCalculator::Process(CalculatorContext* cc) {
 
   if (use_gpu) {
 #if !MEDIAPIPE_DISABLE_GPU
+    RET_CHECK(options_.mask_format() == Options::CONFIDENCE)
+        << "Category masks are only supported on CPU.";
+    RET_CHECK(!cc->Inputs().HasTag(kRoiTag))
+        << "ROI is only supported on CPU.";
     MP_RETURN_IF_ERROR(gpu_helper_.RunInGlContext([this, cc]() -> absl::Status {
       MP_RETURN_IF_ERROR(ProcessGpu(cc));
       return absl::OkStatus();
@@ -289,11 +467,7 @@ absl::Status TensorsToSegmentationCalculator::Process(CalculatorContext* cc) {
     RET_CHECK_FAIL() << "GPU processing disabled.";
 #endif  // !MEDIAPIPE_DISABLE_GPU
   } else {
-#if !MEDIAPIPE_DISABLE_OPENCV
     MP_RETURN_IF_ERROR(ProcessCpu(cc));
-#else
-    RET_CHECK_FAIL() << "OpenCV processing disabled.";
-#endif  // !MEDIAPIPE_DISABLE_OPENCV
   }
 
   return absl::OkStatus();
@@ -321,7 +495,6 @@ absl::Status TensorsToSegmentationCalculator::Close(CalculatorContext* cc) {
 
 absl::Status TensorsToSegmentationCalculator::ProcessCpu(
     CalculatorContext* cc) {
-#if !MEDIAPIPE_DISABLE_OPENCV
   // Get input streams, and dimensions.
   const auto& input_tensors =
       cc->Inputs().Tag(kTensorsTag).Get<std::vector<Tensor>>();
@@ -334,97 +507,72 @@ absl::Status TensorsToSegmentationCalculator::ProcessCpu(
     output_width = size.first;
     output_height = size.second;
   }
-
-  // Create initial working mask.
-  cv::Mat small_mask_mat(cv::Size(tensor_width, tensor_height), CV_32FC1);
-
-  // Wrap input tensor.
-  auto raw_input_tensor = &input_tensors[0];
-  auto raw_input_view = raw_input_tensor->GetCpuReadView();
-  const float* raw_input_data = raw_input_view.buffer<float>();
-  cv::Mat tensor_mat(cv::Size(tensor_width, tensor_height),
-                     CV_MAKETYPE(CV_32F, tensor_channels),
-                     const_cast<float*>(raw_input_data));
-
-  // Process mask tensor and apply activation function.
-  if (tensor_channels == 2) {
-    MP_RETURN_IF_ERROR(ApplyActivation<cv::Vec2f>(tensor_mat, &small_mask_mat));
-  } else if (tensor_channels == 1) {
-    RET_CHECK(mediapipe::TensorsToSegmentationCalculatorOptions::SOFTMAX !=
-              options_.activation());  // Requires 2 channels.
-    if (mediapipe::TensorsToSegmentationCalculatorOptions::NONE ==
-        options_.activation())  // Pass-through optimization.
-      tensor_mat.copyTo(small_mask_mat);
-    else
-      MP_RETURN_IF_ERROR(ApplyActivation<float>(tensor_mat, &small_mask_mat));
-  } else {
-    RET_CHECK_FAIL() << "Unsupported number of tensor channels "
-                     << tensor_channels;
+  int left = 0, top = 0, right = output_width, bottom = output_height;
+  if (cc->Inputs().HasTag(kRoiTag) && !cc->Inputs().Tag(kRoiTag).IsEmpty()) {
+    GetRoiBounds(cc->Inputs().Tag(kRoiTag).Get<NormalizedRect>(),
+                 output_width, output_height, &left, &top, &right, &bottom);
   }
 
-  // Send out image as CPU packet.
-  std::shared_ptr<ImageFrame> mask_frame = std::make_shared<ImageFrame>(
-      ImageFormat::VEC32F1, output_width, output_height);
-  std::unique_ptr<Image> output_mask = absl::make_unique<Image>(mask_frame);
-  auto output_mat = formats::MatView(output_mask.get());
-  // Upsample small mask into output.
-  cv::resize(small_mask_mat, *output_mat,
-             cv::Size(output_width, output_height));
-  cc->Outputs().Tag(kMaskTag).Add(output_mask.release(), cc->InputTimestamp());
-#endif  // !MEDIAPIPE_DISABLE_OPENCV
+  // Process mask tensor and apply activation function at tensor resolution.
+  auto raw_input_view = input_tensors[0].GetCpuReadView();
+  const float* small_mask = raw_input_view.buffer<float>();
+  std::vector<float> activated_mask;
+  if (options_.activation() != Options::NONE || tensor_channels != 1) {
+    activated_mask =
+        ActivateMask(small_mask, tensor_width * tensor_height, tensor_channels,
+                     options_.activation(), options_.output_layer_index());
+    small_mask = activated_mask.data();
+  }
 
-  return absl::OkStatus();
-}
+  const bool category_mask = options_.mask_format() == Options::CATEGORY;
+  auto mask_frame = std::make_shared<ImageFrame>(
+      category_mask ? ImageFormat::GRAY8 : ImageFormat::VEC32F1, output_width,
+      output_height);
+  if (left > 0 || top > 0 || right < output_width || bottom < output_height) {
+    mask_frame->SetToZero();
+  }
 
-#if !MEDIAPIPE_DISABLE_OPENCV
-template <class T>
-absl::Status TensorsToSegmentationCalculator::ApplyActivation(
-    cv::Mat& tensor_mat, cv::Mat* small_mask_mat) {
-  // Configure activation function.
-  const int output_layer_index = options_.output_layer_index();
-  typedef mediapipe::TensorsToSegmentationCalculatorOptions Options;
-  const auto activation_fn = [&](const cv::Vec2f& mask_value) {
-    float new_mask_value = 0;
-    // TODO consider moving switch out of the loop,
-    // and also avoid float/Vec2f casting.
-    switch (options_.activation()) {
-      case Options::NONE: {
-        new_mask_value = mask_value[0];
-        break;
-      }
-      case Options::SIGMOID: {
-        const float pixel0 = mask_value[0];
-        new_mask_value = 1.0 / (std::exp(-pixel0) + 1.0);
-        break;
-      }
-      case Options::SOFTMAX: {
-        const float pixel0 = mask_value[0];
-        const float pixel1 = mask_value[1];
-        const float max_pixel = std::max(pixel0, pixel1);
-        const float min_pixel = std::min(pixel0, pixel1);
-        const float softmax_denom =
-            /*exp(max_pixel - max_pixel)=*/1.0f +
-            std::exp(min_pixel - max_pixel);
-        new_mask_value = std::exp(mask_value[output_layer_index] - max_pixel) /
-                         softmax_denom;
-        break;
-      }
+  // Upsample small mask into output. Each source row is resampled
+  // horizontally once into the slot of its parity, as consecutive output
+  // rows interpolate between the same pair of source rows.
+  const std::vector<LinearTap> x_taps =
+      ComputeLinearTaps(tensor_width, output_width, left, right);
+  const std::vector<LinearTap> y_taps =
+      ComputeLinearTaps(tensor_height, output_height, top, bottom);
+  const int roi_width = right - left;
+  std::vector<float> resampled_rows[2] = {std::vector<float>(roi_width),
+                                          std::vector<float>(roi_width)};
+  int resampled_row_indices[2] = {-1, -1};
+  const auto resampled_row = [&](int index) {
+    const int slot = index % 2;
+    if (resampled_row_indices[slot] != index) {
+      ResampleRow(small_mask + index * tensor_width, x_taps,
+                  resampled_rows[slot].data());
+      resampled_row_indices[slot] = index;
     }
-    return new_mask_value;
+    return resampled_rows[slot].data();
   };
-
-  // Process mask tensor.
-  for (int i = 0; i < tensor_mat.rows; ++i) {
-    for (int j = 0; j < tensor_mat.cols; ++j) {
-      const T& input_pix = tensor_mat.at<T>(i, j);
-      const float mask_value = activation_fn(input_pix);
-      small_mask_mat->at<float>(i, j) = mask_value;
+  for (int y = top; y < bottom; ++y) {
+    const LinearTap& tap = y_taps[y - top];
+    const float* row0 = resampled_row(tap.index0);
+    const float* row1 = resampled_row(tap.index1);
+    uint8* output_row =
+        mask_frame->MutablePixelData() + y * mask_frame->WidthStep();
+    if (category_mask) {
+      BlendAndThresholdRows(row0, row1, tap.weight,
+                            options_.category_threshold(), roi_width,
+                            output_row + left);
+    } else {
+      BlendRows(row0, row1, tap.weight, roi_width,
+                reinterpret_cast<float*>(output_row) + left);
     }
   }
 
+  // Send out image as CPU packet.
+  cc->Outputs().Tag(kMaskTag).Add(new Image(std::move(mask_frame)),
+                                  cc->InputTimestamp());
   return absl::OkStatus();
 }
-#endif  // !MEDIAPIPE_DISABLE_OPENCV
 
 // Steps:
 // 1. receive tensor
@@ -0,0 +1,80 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/xnnpack_weights_cache.h"
+
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+
+namespace {
+
+// The process-wide registry of shared weights caches, keyed by name.
+class XnnpackWeightsCacheRegistry {
+ public:
+  static XnnpackWeightsCacheRegistry& Get() {
+    static auto* registry = new XnnpackWeightsCacheRegistry();
+    return *registry;
+  }
+
+  absl::Mutex mutex;
+  absl::flat_hash_map<std::string, std::weak_ptr<XnnpackWeightsCache>> caches
+      ABSL_GUARDED_BY(mutex);
+};
+
+}  // namespace
+
+// static
+absl::StatusOr<std::shared_ptr<XnnpackWeightsCache>>
+XnnpackWeightsCache::GetOrCreate(const std::string& name) {
+  XnnpackWeightsCacheRegistry& registry = XnnpackWeightsCacheRegistry::Get();
+  absl::MutexLock lock(&registry.mutex);
+  std::shared_ptr<XnnpackWeightsCache> cache = registry.caches[name].lock();
+  if (cache) {
+    return cache;
+  }
+  TfLiteXNNPackDelegateWeightsCache* weights_cache =
+      TfLiteXNNPackDelegateWeightsCacheCreate();
+  RET_CHECK(weights_cache) << "Failed to create an XNNPACK weights cache.";
+  cache = std::make_shared<XnnpackWeightsCache>(weights_cache);
+  registry.caches[name] = cache;
+  return cache;
+}
+
+XnnpackWeightsCache::XnnpackWeightsCache(
+    TfLiteXNNPackDelegateWeightsCache* cache)
+    : cache_(cache) {}
+
+XnnpackWeightsCache::~XnnpackWeightsCache() {
+  TfLiteXNNPackDelegateWeightsCacheDelete(cache_);
+}
+
+absl::StatusOr<std::unique_ptr<InferenceRunner>> XnnpackWeightsCache::Build(
+    const std::function<absl::StatusOr<std::unique_ptr<InferenceRunner>>()>&
+        build_runner) {
+  absl::MutexLock lock(&build_mutex_);
+  ASSIGN_OR_RETURN(std::unique_ptr<InferenceRunner> runner, build_runner());
+  // Soft finalization lets the later interpreters of the model look their
+  // packed weights up in the cache.
+  RET_CHECK(TfLiteXNNPackDelegateWeightsCacheFinalizeSoft(cache_))
+      << "Failed to finalize the XNNPACK weights cache.";
+  return runner;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,62 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_XNNPACK_WEIGHTS_CACHE_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_XNNPACK_WEIGHTS_CACHE_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/calculators/tensor/inference_runner.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+
+namespace mediapipe {
+
+// A cache of the weights that the XNNPACK delegate packs for a model, shared
+// by all the interpreters of the process that run that model.
+//
+// The first interpreter built with the cache packs the weights into it, and
+// the following interpreters find them there. Set it as `weights_cache` in the
+// TfLiteXNNPackDelegateOptions of each interpreter, and build the interpreters
+// through Build(), which finalizes the cache so that they can run.
+class XnnpackWeightsCache {
+ public:
+  // Returns the cache shared under `name` in this process, creating it if
+  // there is none. The cache is destroyed together with its last user; the
+  // delegates that use it should hold a reference to it.
+  static absl::StatusOr<std::shared_ptr<XnnpackWeightsCache>> GetOrCreate(
+      const std::string& name);
+
+  explicit XnnpackWeightsCache(TfLiteXNNPackDelegateWeightsCache* cache);
+  ~XnnpackWeightsCache();
+
+  TfLiteXNNPackDelegateWeightsCache* get() const { return cache_; }
+
+  // Runs `build_runner`, which builds an interpreter whose delegate uses this
+  // cache, and finalizes the cache afterwards. Builds are serialized, as only
+  // one interpreter at a time may add weights to the cache.
+  absl::StatusOr<std::unique_ptr<InferenceRunner>> Build(
+      const std::function<absl::StatusOr<std::unique_ptr<InferenceRunner>>()>&
+          build_runner);
+
+ private:
+  TfLiteXNNPackDelegateWeightsCache* const cache_;
+  absl::Mutex build_mutex_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_XNNPACK_WEIGHTS_CACHE_H_
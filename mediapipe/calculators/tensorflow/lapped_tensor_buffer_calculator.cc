@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cstring>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -81,6 +83,11 @@ namespace tf = tensorflow;
 //     }
 //   }
 // }
+//
+// With use_contiguous_ring, each input tensor is written twice into a ring of
+// 2 * buffer_size tensors, at slots i and i + buffer_size. The last buffer_size
+// tensors are then always contiguous in the ring, and each output is a single
+// copy of them.
 
 class LappedTensorBufferCalculator : public CalculatorBase {
  public:
@@ -94,6 +101,10 @@ class LappedTensorBufferCalculator : public CalculatorBase {
   // Adds a batch dimension to the input tensor if specified in the
   // calculator options.
   absl::Status AddBatchDimension(tf::Tensor* input_tensor);
+  // Adds the tensor to the buffer, or copies it into the contiguous ring.
+  absl::Status PushTensor(const tf::Tensor& tensor);
+  // Returns the i-th tensor of the contiguous ring, starting from the oldest.
+  tf::Tensor GetRingTensor(int i) const;
   // Sends the current buffer downstream.
   absl::Status ProcessBuffer(CalculatorContext* cc);
 
@@ -105,6 +116,10 @@ class LappedTensorBufferCalculator : public CalculatorBase {
 
   std::unique_ptr<CircularBuffer<Timestamp>> timestamp_buffer_;
   std::unique_ptr<CircularBuffer<tf::Tensor>> buffer_;
+  // Only used with use_contiguous_ring.
+  tf::Tensor ring_;
+  tf::TensorShape ring_tensor_shape_;
+  int64 num_ring_tensors_ = 0;
   LappedTensorBufferCalculatorOptions options_;
 };
 
@@ -172,7 +187,9 @@ absl::Status LappedTensorBufferCalculator::Open(CalculatorContext* cc) {
       << "padding option must be smaller than buffer size.";
   timestamp_buffer_ =
       absl::make_unique<CircularBuffer<Timestamp>>(buffer_size_);
-  buffer_ = absl::make_unique<CircularBuffer<tf::Tensor>>(buffer_size_);
+  if (!options_.use_contiguous_ring()) {
+    buffer_ = absl::make_unique<CircularBuffer<tf::Tensor>>(buffer_size_);
+  }
   steps_until_output_ = buffer_size_ - options_.padding();
   initialized_ = false;
   return absl::OkStatus();
@@ -188,12 +205,12 @@ absl::Status LappedTensorBufferCalculator::Process(CalculatorContext* cc) {
   // Pad frames at the beginning with the first frame.
   if (!initialized_) {
     for (int i = 0; i < options_.padding(); ++i) {
-      buffer_->push_back(input_tensor);
+      MP_RETURN_IF_ERROR(PushTensor(input_tensor));
       timestamp_buffer_->push_back(cc->InputTimestamp());
     }
     initialized_ = true;
   }
-  buffer_->push_back(input_tensor);
+  MP_RETURN_IF_ERROR(PushTensor(input_tensor));
   timestamp_buffer_->push_back(cc->InputTimestamp());
   --steps_until_output_;
   if (steps_until_output_ <= 0) {
@@ -208,9 +225,13 @@ absl::Status LappedTensorBufferCalculator::Close(CalculatorContext* cc) {
     return absl::OkStatus();
   }
   int last_frame = buffer_size_ - steps_until_output_ - 1;
-  const auto& pad_frame = buffer_->Get(last_frame);
+  // The ring slots of the pad frame may be overwritten while padding.
+  const tf::Tensor pad_frame =
+      options_.use_contiguous_ring()
+          ? tf::tensor::DeepCopy(GetRingTensor(last_frame))
+          : buffer_->Get(last_frame);
   for (int i = 0; i < steps_until_output_ + options_.padding(); ++i) {
-    buffer_->push_back(pad_frame);
+    MP_RETURN_IF_ERROR(PushTensor(pad_frame));
     timestamp_buffer_->push_back(cc->InputTimestamp());
   }
   MP_RETURN_IF_ERROR(ProcessBuffer(cc));
@@ -232,14 +253,65 @@ absl::Status LappedTensorBufferCalculator::AddBatchDimension(
   return absl::OkStatus();
 }
 
+absl::Status LappedTensorBufferCalculator::PushTensor(
+    const tf::Tensor& tensor) {
+  if (!options_.use_contiguous_ring()) {
+    buffer_->push_back(tensor);
+    return absl::OkStatus();
+  }
+  if (!ring_.IsInitialized()) {
+    RET_CHECK(tf::DataTypeCanUseMemcpy(tensor.dtype()))
+        << "use_contiguous_ring requires tensors of a fixed size type.";
+    RET_CHECK_GE(tensor.dims(), 1)
+        << "Tensors without any dimension can't be concatenated.";
+    ring_tensor_shape_ = tensor.shape();
+    tf::TensorShape ring_shape(ring_tensor_shape_);
+    ring_shape.set_dim(0, 2 * buffer_size_ * ring_tensor_shape_.dim_size(0));
+    ring_ = tf::Tensor(tensor.dtype(), ring_shape);
+  }
+  RET_CHECK(tensor.dtype() == ring_.dtype() &&
+            tensor.shape() == ring_tensor_shape_)
+      << "use_contiguous_ring requires tensors of the same type and shape. "
+      << "Expected " << ring_tensor_shape_.DebugString() << ", got "
+      << tensor.shape().DebugString();
+  const size_t num_bytes = tensor.TotalBytes();
+  char* ring_data = const_cast<char*>(ring_.tensor_data().data());
+  const int slot = num_ring_tensors_ % buffer_size_;
+  std::memcpy(ring_data + slot * num_bytes, tensor.tensor_data().data(),
+              num_bytes);
+  std::memcpy(ring_data + (slot + buffer_size_) * num_bytes,
+              tensor.tensor_data().data(), num_bytes);
+  ++num_ring_tensors_;
+  return absl::OkStatus();
+}
+
+tf::Tensor LappedTensorBufferCalculator::GetRingTensor(int i) const {
+  const int64 oldest = std::max<int64>(num_ring_tensors_ - buffer_size_, 0);
+  const int64 slot = (oldest + i) % buffer_size_;
+  const int64 rows = ring_tensor_shape_.dim_size(0);
+  return ring_.Slice(slot * rows, (slot + 1) * rows);
+}
+
 // Process buffer
 absl::Status LappedTensorBufferCalculator::ProcessBuffer(
     CalculatorContext* cc) {
   auto concatenated = ::absl::make_unique<tf::Tensor>();
-  const tf::Status concat_status = tf::tensor::Concat(
-      std::vector<tf::Tensor>(buffer_->begin(), buffer_->end()),
-      concatenated.get());
-  RET_CHECK(concat_status.ok()) << concat_status.ToString();
+  if (options_.use_contiguous_ring()) {
+    // The last buffer_size tensors start at the slot of the oldest one.
+    tf::TensorShape output_shape(ring_tensor_shape_);
+    output_shape.set_dim(0, buffer_size_ * ring_tensor_shape_.dim_size(0));
+    *concatenated = tf::Tensor(ring_.dtype(), output_shape);
+    const size_t num_bytes = concatenated->TotalBytes();
+    const int slot = num_ring_tensors_ % buffer_size_;
+    std::memcpy(const_cast<char*>(concatenated->tensor_data().data()),
+                ring_.tensor_data().data() + slot * (num_bytes / buffer_size_),
+                num_bytes);
+  } else {
+    const tf::Status concat_status = tf::tensor::Concat(
+        std::vector<tf::Tensor>(buffer_->begin(), buffer_->end()),
+        concatenated.get());
+    RET_CHECK(concat_status.ok()) << concat_status.ToString();
+  }
   // Output cancatenated tensor.
   cc->Outputs().Index(0).Add(concatenated.release(),
                              timestamp_buffer_->Get(timestamp_offset_));
@@ -32,7 +32,8 @@ class LappedTensorBufferCalculatorTest : public ::testing::Test {
  protected:
   void SetUpCalculator(int buffer_size, int overlap, bool add_dim,
                        int timestamp_offset, int padding,
-                       bool timestamp_output) {
+                       bool timestamp_output,
+                       bool use_contiguous_ring = false) {
     CalculatorGraphConfig::Node config;
     config.set_calculator("LappedTensorBufferCalculator");
     config.add_input_stream("input_tensor");
@@ -49,6 +50,7 @@ class LappedTensorBufferCalculatorTest : public ::testing::Test {
     }
     options->set_timestamp_offset(timestamp_offset);
     options->set_padding(padding);
+    options->set_use_contiguous_ring(use_contiguous_ring);
     runner_ = ::absl::make_unique<CalculatorRunner>(config);
   }
   std::unique_ptr<CalculatorRunner> runner_;
@@ -302,5 +304,54 @@ TEST_F(LappedTensorBufferCalculatorTest,
   ASSERT_EQ(output_size, output_timestamps.size());
 }
 
+TEST_F(LappedTensorBufferCalculatorTest, ContiguousRingMatchesConcatenation) {
+  const int buffer_size = 10;
+  const int overlap = 9;
+  const int padding = 3;
+  const int num_timesteps = 25;
+  std::vector<std::vector<Packet>> outputs;
+  for (bool use_contiguous_ring : {false, true}) {
+    SetUpCalculator(buffer_size, overlap, /*add_dim=*/true,
+                    /*timestamp_offset=*/0, padding, false,
+                    use_contiguous_ring);
+    for (int i = 0; i < num_timesteps; ++i) {
+      auto input = ::absl::make_unique<tensorflow::Tensor>(
+          tensorflow::DT_FLOAT, tensorflow::TensorShape({2}));
+      input->tensor<float, 1>()(0) = i;
+      input->tensor<float, 1>()(1) = -i;
+      runner_->MutableInputs()->Index(0).packets.push_back(
+          Adopt(input.release()).At(Timestamp(i)));
+    }
+    ASSERT_TRUE(runner_->Run().ok());
+    outputs.push_back(runner_->Outputs().Index(0).packets);
+  }
+
+  // One output per input once the buffer is full, plus the padded last one.
+  ASSERT_EQ(num_timesteps - (buffer_size - padding) + 2, outputs[0].size());
+  ASSERT_EQ(outputs[0].size(), outputs[1].size());
+  for (int i = 0; i < outputs[0].size(); ++i) {
+    EXPECT_EQ(outputs[0][i].Timestamp(), outputs[1][i].Timestamp());
+    const auto expected = outputs[0][i].Get<tf::Tensor>().tensor<float, 2>();
+    const auto actual = outputs[1][i].Get<tf::Tensor>().tensor<float, 2>();
+    ASSERT_EQ(buffer_size, actual.dimension(0));
+    ASSERT_EQ(2, actual.dimension(1));
+    for (int j = 0; j < buffer_size; ++j) {
+      EXPECT_EQ(expected(j, 0), actual(j, 0));
+      EXPECT_EQ(expected(j, 1), actual(j, 1));
+    }
+  }
+}
+
+TEST_F(LappedTensorBufferCalculatorTest, ContiguousRingRequiresSameShape) {
+  SetUpCalculator(2, 1, false, 0, 0, false, /*use_contiguous_ring=*/true);
+  for (int i = 0; i < 2; ++i) {
+    auto input = ::absl::make_unique<tensorflow::Tensor>(
+        tensorflow::DT_FLOAT, tensorflow::TensorShape({i + 1}));
+    runner_->MutableInputs()->Index(0).packets.push_back(
+        Adopt(input.release()).At(Timestamp(i)));
+  }
+  ASSERT_FALSE(runner_->Run().ok());
+}
+
 }  // namespace
 }  // namespace mediapipe
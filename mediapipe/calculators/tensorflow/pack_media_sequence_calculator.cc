@@ -66,6 +66,11 @@ namespace mpms = mediapipe::mediasequence;
 // each stream, which allows for multiple image streams to be included. However,
 // the default names are suppored by more tools.
 //
+// With "sub_sequence_duration_usec" set, the streams are split into
+// consecutive SequenceExamples of that duration, each output on the
+// SEQUENCE_EXAMPLE output stream as soon as it is complete, so that memory
+// use doesn't grow with the length of the video.
+//
 // Example config:
 // node {
 //   calculator: "PackMediaSequenceCalculator"
@@ -265,6 +270,20 @@ class PackMediaSequenceCalculator : public CalculatorBase {
       }
     }
 
+    sub_sequence_duration_usec_ =
+        cc->Options<PackMediaSequenceCalculatorOptions>()
+            .sub_sequence_duration_usec();
+    RET_CHECK_GE(sub_sequence_duration_usec_, 0);
+    if (sub_sequence_duration_usec_ > 0) {
+      RET_CHECK(cc->Outputs().HasTag(kSequenceExampleTag) &&
+                !cc->OutputSidePackets().HasTag(kSequenceExampleTag))
+          << "Sub-sequences can only be output on the SEQUENCE_EXAMPLE output "
+             "stream.";
+      // Each sub-sequence starts from the sequence as it is after Open().
+      initial_sequence_ = absl::make_unique<tf::SequenceExample>(*sequence_);
+      initial_replace_keypoints_ = replace_keypoints_;
+    }
+
     return absl::OkStatus();
   }
 
@@ -295,8 +314,68 @@ class PackMediaSequenceCalculator : public CalculatorBase {
     return absl::OkStatus();
   }
 
+  absl::Status VerifyAllPresent(CalculatorContext* cc) {
+    absl::Status status = VerifySequence();
+    if (!status.ok()) {
+      cc->GetCounter(status.ToString())->Increment();
+    }
+    return status;
+  }
+
+  // Outputs the current sub-sequence at the timestamp it starts at.
+  absl::Status OutputSubSequence(CalculatorContext* cc) {
+    auto& options = cc->Options<PackMediaSequenceCalculatorOptions>();
+    mpms::SetClipStartTimestamp(sub_sequence_start_.Value(), sequence_.get());
+    mpms::SetClipEndTimestamp(
+        sub_sequence_start_.Value() + sub_sequence_duration_usec_,
+        sequence_.get());
+    if (options.reconcile_metadata()) {
+      RET_CHECK_OK(mpms::ReconcileMetadata(
+          options.reconcile_bbox_annotations(),
+          options.reconcile_region_annotations(), sequence_.get()));
+    }
+    if (options.skip_large_sequences()) {
+      RET_CHECK_OK(VerifySize());
+    }
+    cc->Outputs()
+        .Tag(kSequenceExampleTag)
+        .Add(sequence_.release(), sub_sequence_start_);
+    return absl::OkStatus();
+  }
+
+  // Outputs the current sub-sequence and starts a new one if |timestamp| is
+  // past its end.
+  absl::Status MaybeStartSubSequence(CalculatorContext* cc,
+                                     Timestamp timestamp) {
+    if (sub_sequence_start_ == Timestamp::Unset()) {
+      sub_sequence_start_ = timestamp;
+      return absl::OkStatus();
+    }
+    const int64 elapsed_usec = timestamp.Value() - sub_sequence_start_.Value();
+    if (elapsed_usec < sub_sequence_duration_usec_) {
+      return absl::OkStatus();
+    }
+    MP_RETURN_IF_ERROR(OutputSubSequence(cc));
+    // Sub-sequences without any input packet are skipped.
+    sub_sequence_start_ = Timestamp(
+        sub_sequence_start_.Value() + elapsed_usec -
+        elapsed_usec % sub_sequence_duration_usec_);
+    sequence_ = absl::make_unique<tf::SequenceExample>(*initial_sequence_);
+    replace_keypoints_ = initial_replace_keypoints_;
+    return absl::OkStatus();
+  }
+
   absl::Status Close(CalculatorContext* cc) override {
     auto& options = cc->Options<PackMediaSequenceCalculatorOptions>();
+    if (sub_sequence_start_ != Timestamp::Unset()) {
+      if (options.output_only_if_all_present()) {
+        MP_RETURN_IF_ERROR(VerifyAllPresent(cc));
+      }
+      MP_RETURN_IF_ERROR(OutputSubSequence(cc));
+      initial_sequence_.reset();
+      return absl::OkStatus();
+    }
+
     if (options.reconcile_metadata()) {
       RET_CHECK_OK(mpms::ReconcileMetadata(
           options.reconcile_bbox_annotations(),
@@ -307,11 +386,7 @@ class PackMediaSequenceCalculator : public CalculatorBase {
       RET_CHECK_OK(VerifySize());
     }
     if (options.output_only_if_all_present()) {
-      absl::Status status = VerifySequence();
-      if (!status.ok()) {
-        cc->GetCounter(status.ToString())->Increment();
-        return status;
-      }
+      MP_RETURN_IF_ERROR(VerifyAllPresent(cc));
     }
 
     if (cc->OutputSidePackets().HasTag(kSequenceExampleTag)) {
@@ -332,6 +407,11 @@ class PackMediaSequenceCalculator : public CalculatorBase {
   }
 
   absl::Status Process(CalculatorContext* cc) override {
+    // Context features sent at PostStream go to the last sub-sequence.
+    if (sub_sequence_duration_usec_ > 0 &&
+        cc->InputTimestamp() != Timestamp::PostStream()) {
+      MP_RETURN_IF_ERROR(MaybeStartSubSequence(cc, cc->InputTimestamp()));
+    }
     int image_height = -1;
     int image_width = -1;
     // Because the tag order may vary, we need to loop through tags to get
@@ -554,6 +634,12 @@ class PackMediaSequenceCalculator : public CalculatorBase {
   std::unique_ptr<tf::SequenceExample> sequence_;
   std::map<std::string, bool> features_present_;
   bool replace_keypoints_;
+
+  // Only used with sub_sequence_duration_usec.
+  int64 sub_sequence_duration_usec_ = 0;
+  std::unique_ptr<tf::SequenceExample> initial_sequence_;
+  bool initial_replace_keypoints_ = false;
+  Timestamp sub_sequence_start_ = Timestamp::Unset();
 };
 REGISTER_CALCULATOR(PackMediaSequenceCalculator);
 
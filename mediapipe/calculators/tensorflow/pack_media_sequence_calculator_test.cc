@@ -335,6 +335,55 @@ TEST_F(PackMediaSequenceCalculatorTest, OutputAsZeroTimestamp) {
   EXPECT_EQ(output_packets[0].Timestamp().Value(), 0ll);
 }
 
+TEST_F(PackMediaSequenceCalculatorTest, OutputsSubSequences) {
+  CalculatorGraphConfig::Node config;
+  config.set_calculator("PackMediaSequenceCalculator");
+  config.add_input_side_packet("SEQUENCE_EXAMPLE:input_sequence");
+  config.add_output_stream("SEQUENCE_EXAMPLE:output_sequence");
+  config.add_input_stream("FLOAT_FEATURE_TEST:test");
+  config.mutable_options()
+      ->MutableExtension(PackMediaSequenceCalculatorOptions::ext)
+      ->set_sub_sequence_duration_usec(20);
+  runner_ = ::absl::make_unique<CalculatorRunner>(config);
+
+  // The sub-sequence [40, 60) is skipped.
+  const std::vector<int> timestamps = {0, 10, 20, 30, 60, 70};
+  for (int i = 0; i < timestamps.size(); ++i) {
+    auto vf_ptr = ::absl::make_unique<std::vector<float>>(2, i);
+    runner_->MutableInputs()
+        ->Tag(kFloatFeatureTestTag)
+        .packets.push_back(
+            Adopt(vf_ptr.release()).At(Timestamp(timestamps[i])));
+  }
+  runner_->MutableSidePackets()->Tag(kSequenceExampleTag) =
+      Adopt(new tf::SequenceExample());
+
+  MP_ASSERT_OK(runner_->Run());
+
+  const std::vector<Packet>& output_packets =
+      runner_->Outputs().Tag(kSequenceExampleTag).packets;
+  ASSERT_EQ(3, output_packets.size());
+  const std::vector<int64> expected_starts = {0, 20, 60};
+  for (int i = 0; i < output_packets.size(); ++i) {
+    EXPECT_EQ(expected_starts[i], output_packets[i].Timestamp().Value());
+    const tf::SequenceExample& output_sequence =
+        output_packets[i].Get<tf::SequenceExample>();
+    EXPECT_EQ(expected_starts[i],
+              mpms::GetClipStartTimestamp(output_sequence));
+    EXPECT_EQ(expected_starts[i] + 20,
+              mpms::GetClipEndTimestamp(output_sequence));
+    ASSERT_EQ(2, mpms::GetFeatureTimestampSize("TEST", output_sequence));
+    ASSERT_EQ(2, mpms::GetFeatureFloatsSize("TEST", output_sequence));
+    for (int j = 0; j < 2; ++j) {
+      EXPECT_EQ(timestamps[2 * i + j],
+                mpms::GetFeatureTimestampAt("TEST", output_sequence, j));
+      EXPECT_THAT(mpms::GetFeatureFloatsAt("TEST", output_sequence, j),
+                  ::testing::ElementsAreArray(
+                      std::vector<float>(2, 2 * i + j)));
+    }
+  }
+}
+
 TEST_F(PackMediaSequenceCalculatorTest, PacksTwoContextFloatLists) {
   SetUpCalculator(
       {"FLOAT_CONTEXT_FEATURE_TEST:test", "FLOAT_CONTEXT_FEATURE_OTHER:test2"},
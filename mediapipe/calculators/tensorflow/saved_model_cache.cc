@@ -0,0 +1,152 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensorflow/saved_model_cache.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+
+namespace mediapipe {
+
+namespace tf = ::tensorflow;
+
+namespace {
+
+absl::Status ToAbslStatus(const tf::Status& status) {
+  return absl::Status(static_cast<absl::StatusCode>(status.code()),
+                      status.ToString());
+}
+
+std::string CacheKey(const std::string& path,
+                     const std::unordered_set<std::string>& tags,
+                     const tf::SessionOptions& session_options) {
+  std::vector<std::string> sorted_tags(tags.begin(), tags.end());
+  std::sort(sorted_tags.begin(), sorted_tags.end());
+  // Equal configs serializing differently only cause a cache miss.
+  return absl::StrCat(path, "\n", absl::StrJoin(sorted_tags, ","), "\n",
+                      session_options.target, "\n",
+                      session_options.config.SerializeAsString());
+}
+
+// A model is loaded at most once while it is referenced, without holding the
+// cache lock during the load.
+struct CacheEntry {
+  absl::Mutex mutex;
+  std::weak_ptr<tf::SavedModelBundle> bundle ABSL_GUARDED_BY(mutex);
+};
+
+class SavedModelCache {
+ public:
+  std::shared_ptr<CacheEntry> GetEntry(const std::string& key) {
+    absl::MutexLock lock(&mutex_);
+    std::shared_ptr<CacheEntry>& entry = entries_[key];
+    if (!entry) {
+      entry = std::make_shared<CacheEntry>();
+    }
+    return entry;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::shared_ptr<CacheEntry>> entries_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+SavedModelCache& GetSavedModelCache() {
+  static SavedModelCache* cache = new SavedModelCache();
+  return *cache;
+}
+
+}  // namespace
+
+absl::StatusOr<std::shared_ptr<tf::SavedModelBundle>>
+GetOrLoadSharedSavedModel(const std::string& path,
+                          const std::unordered_set<std::string>& tags,
+                          const tf::SessionOptions& session_options,
+                          const std::string& warmup_signature_name,
+                          int num_warmup_runs) {
+  std::shared_ptr<CacheEntry> entry =
+      GetSavedModelCache().GetEntry(CacheKey(path, tags, session_options));
+  absl::MutexLock lock(&entry->mutex);
+  if (std::shared_ptr<tf::SavedModelBundle> bundle = entry->bundle.lock()) {
+    return bundle;
+  }
+  auto bundle = std::make_shared<tf::SavedModelBundle>();
+  tf::RunOptions run_options;
+  const tf::Status status = tf::LoadSavedModel(session_options, run_options,
+                                               path, tags, bundle.get());
+  if (!status.ok()) {
+    return ToAbslStatus(status);
+  }
+  if (num_warmup_runs > 0) {
+    const absl::Status warmup_status =
+        WarmUpSavedModel(*bundle, warmup_signature_name, num_warmup_runs);
+    LOG_IF(WARNING, !warmup_status.ok())
+        << "Warm-up of " << path << " failed: " << warmup_status;
+  }
+  entry->bundle = bundle;
+  return bundle;
+}
+
+absl::Status WarmUpSavedModel(const tf::SavedModelBundle& bundle,
+                              const std::string& signature_name,
+                              int num_runs) {
+  const auto& signature_def_map = bundle.meta_graph_def.signature_def();
+  const auto signature_it = signature_def_map.find(signature_name);
+  RET_CHECK(signature_it != signature_def_map.end())
+      << "Unknown signature: " << signature_name;
+  const tf::SignatureDef& signature_def = signature_it->second;
+
+  std::vector<std::pair<std::string, tf::Tensor>> inputs;
+  for (const auto& input : signature_def.inputs()) {
+    const tf::TensorShapeProto& shape_proto = input.second.tensor_shape();
+    RET_CHECK(!shape_proto.unknown_rank())
+        << "Input " << input.first << " has an unknown rank.";
+    tf::TensorShape shape;
+    for (const auto& dim : shape_proto.dim()) {
+      shape.AddDim(dim.size() < 0 ? 1 : dim.size());
+    }
+    tf::Tensor tensor(input.second.dtype(), shape);
+    if (tf::DataTypeCanUseMemcpy(tensor.dtype())) {
+      std::fill_n(const_cast<char*>(tensor.tensor_data().data()),
+                  tensor.TotalBytes(), 0);
+    }
+    inputs.emplace_back(input.second.name(), std::move(tensor));
+  }
+  std::vector<std::string> output_names;
+  for (const auto& output : signature_def.outputs()) {
+    output_names.push_back(output.second.name());
+  }
+  for (int i = 0; i < num_runs; ++i) {
+    std::vector<tf::Tensor> outputs;
+    const tf::Status status =
+        bundle.session->Run(inputs, output_names, {}, &outputs);
+    if (!status.ok()) {
+      return ToAbslStatus(status);
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,50 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSORFLOW_SAVED_MODEL_CACHE_H_
+#define MEDIAPIPE_CALCULATORS_TENSORFLOW_SAVED_MODEL_CACHE_H_
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+#include "absl/status/statusor.h"
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace mediapipe {
+
+// Returns the SavedModel at |path| loaded with |tags| and |session_options|.
+// The model is only loaded once per process while it is in use: all callers
+// passing the same arguments share the returned bundle, and so its session and
+// weights, until they have all released it. Sessions are thread-safe for Run().
+//
+// If |num_warmup_runs| is positive and the model is loaded by this call, the
+// signature |warmup_signature_name| is run that many times on zero-filled
+// inputs, with unknown dimensions set to 1, so that the first inference
+// doesn't pay for lazy initializations. Warm-up failures are only logged.
+absl::StatusOr<std::shared_ptr<tensorflow::SavedModelBundle>>
+GetOrLoadSharedSavedModel(const std::string& path,
+                          const std::unordered_set<std::string>& tags,
+                          const tensorflow::SessionOptions& session_options,
+                          const std::string& warmup_signature_name = "",
+                          int num_warmup_runs = 0);
+
+// Runs |signature_name| of |bundle| |num_runs| times on zero-filled inputs.
+absl::Status WarmUpSavedModel(const tensorflow::SavedModelBundle& bundle,
+                              const std::string& signature_name, int num_runs);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSORFLOW_SAVED_MODEL_CACHE_H_
@@ -0,0 +1,312 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/calculators/tensorflow/sharded_tfrecord_reader_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/threadpool.h"
+#include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr char kTFRecordPathTag[] = "TFRECORD_PATH";
+constexpr char kTFRecordPathsTag[] = "TFRECORD_PATHS";
+constexpr char kExampleTag[] = "EXAMPLE";
+constexpr char kSequenceExampleTag[] = "SEQUENCE_EXAMPLE";
+
+template <typename T>
+absl::StatusOr<Packet> ParseRecord(const tensorflow::tstring& record) {
+  T proto;
+  RET_CHECK(proto.ParseFromArray(record.data(), record.size()))
+      << "Failed to parse a " << proto.GetTypeName() << " record.";
+  return MakePacket<T>(std::move(proto));
+}
+
+}  // namespace
+
+// Streams the tensorflow examples/sequence examples of a set of tfrecord
+// shards, one per output packet, at consecutive timestamps starting from 0.
+//
+// The shards are read, decompressed and parsed on "num_threads" threads, each
+// reading one shard at a time, while up to "prefetch_size" parsed records are
+// buffered ahead of the output. With more than one thread, records of
+// different shards are interleaved in no particular order. With
+// "shuffle_buffer_size" set, records are output in a random order drawn from
+// a buffer of that many records.
+//
+// The shards are given by either the "TFRECORD_PATH" input side packet, a
+// comma separated list of file paths or glob patterns, or the
+// "TFRECORD_PATHS" input side packet, a vector of them.
+//
+// Example config:
+// node {
+//   calculator: "ShardedTFRecordReaderCalculator"
+//   input_side_packet: "TFRECORD_PATH:tfrecord_pattern"
+//   output_stream: "SEQUENCE_EXAMPLE:sequence_example"
+//   options {
+//     [mediapipe.ShardedTFRecordReaderCalculatorOptions.ext] {
+//       num_threads: 8
+//       compression_type: "GZIP"
+//       shuffle_buffer_size: 1024
+//     }
+//   }
+// }
+class ShardedTFRecordReaderCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+  absl::Status Close(CalculatorContext* cc) override;
+
+ private:
+  // Reads shards until none is left or the calculator is closed.
+  void ReadShards();
+  absl::Status ReadShard(const std::string& path);
+  // Blocks until there is room in the prefetch queue and adds |packet| to it.
+  // Returns false if reading should stop.
+  bool Enqueue(Packet packet);
+  // Blocks until a record is available and returns it, or returns an empty
+  // packet once all shards are read.
+  absl::StatusOr<Packet> Dequeue();
+
+  bool CanEnqueue() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return queue_.size() < prefetch_size_ || closed_ || !read_status_.ok();
+  }
+  bool CanDequeue() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !queue_.empty() || num_active_readers_ == 0 || !read_status_.ok();
+  }
+
+  ShardedTFRecordReaderCalculatorOptions options_;
+  std::string output_tag_;
+  tensorflow::io::RecordReaderOptions reader_options_;
+  std::vector<std::string> shards_;
+  size_t prefetch_size_ = 0;
+
+  absl::Mutex mutex_;
+  size_t next_shard_ ABSL_GUARDED_BY(mutex_) = 0;
+  int num_active_readers_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool closed_ ABSL_GUARDED_BY(mutex_) = false;
+  std::deque<Packet> queue_ ABSL_GUARDED_BY(mutex_);
+  // First error of the reader threads, returned by the next Process() call.
+  absl::Status read_status_ ABSL_GUARDED_BY(mutex_);
+  std::unique_ptr<ThreadPool> readers_;
+
+  // Only accessed by Process().
+  std::vector<Packet> shuffle_buffer_;
+  std::mt19937_64 rng_;
+  int64 num_output_records_ = 0;
+};
+
+absl::Status ShardedTFRecordReaderCalculator::GetContract(
+    CalculatorContract* cc) {
+  RET_CHECK(cc->InputSidePackets().HasTag(kTFRecordPathTag) ^
+            cc->InputSidePackets().HasTag(kTFRecordPathsTag))
+      << "Exactly one of TFRECORD_PATH and TFRECORD_PATHS must be specified.";
+  if (cc->InputSidePackets().HasTag(kTFRecordPathTag)) {
+    cc->InputSidePackets().Tag(kTFRecordPathTag).Set<std::string>();
+  } else {
+    cc->InputSidePackets()
+        .Tag(kTFRecordPathsTag)
+        .Set<std::vector<std::string>>();
+  }
+
+  RET_CHECK(cc->Outputs().HasTag(kExampleTag) ^
+            cc->Outputs().HasTag(kSequenceExampleTag))
+      << "ShardedTFRecordReaderCalculator must output either Tensorflow "
+         "examples or sequence examples.";
+  if (cc->Outputs().HasTag(kExampleTag)) {
+    cc->Outputs().Tag(kExampleTag).Set<tensorflow::Example>();
+  } else {
+    cc->Outputs().Tag(kSequenceExampleTag).Set<tensorflow::SequenceExample>();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ShardedTFRecordReaderCalculator::Open(CalculatorContext* cc) {
+  options_ = cc->Options<ShardedTFRecordReaderCalculatorOptions>();
+  RET_CHECK_GT(options_.num_threads(), 0);
+  RET_CHECK_GT(options_.prefetch_size(), 0);
+  prefetch_size_ = options_.prefetch_size();
+  output_tag_ = cc->Outputs().HasTag(kExampleTag) ? kExampleTag
+                                                  : kSequenceExampleTag;
+
+  std::vector<std::string> patterns;
+  if (cc->InputSidePackets().HasTag(kTFRecordPathTag)) {
+    patterns = absl::StrSplit(
+        cc->InputSidePackets().Tag(kTFRecordPathTag).Get<std::string>(), ',',
+        absl::SkipEmpty());
+  } else {
+    patterns = cc->InputSidePackets()
+                   .Tag(kTFRecordPathsTag)
+                   .Get<std::vector<std::string>>();
+  }
+  for (const std::string& pattern : patterns) {
+    std::vector<std::string> paths;
+    auto tf_status =
+        tensorflow::Env::Default()->GetMatchingPaths(pattern, &paths);
+    RET_CHECK(tf_status.ok())
+        << "Failed to list tfrecord files: " << tf_status.ToString();
+    RET_CHECK(!paths.empty()) << "No tfrecord file matches " << pattern;
+    std::sort(paths.begin(), paths.end());
+    shards_.insert(shards_.end(), paths.begin(), paths.end());
+  }
+  RET_CHECK(!shards_.empty()) << "No tfrecord file specified.";
+
+  rng_.seed(options_.shuffle_seed() != 0 ? options_.shuffle_seed()
+                                         : std::random_device()());
+  if (options_.shuffle_buffer_size() > 1) {
+    std::shuffle(shards_.begin(), shards_.end(), rng_);
+    shuffle_buffer_.reserve(options_.shuffle_buffer_size());
+  }
+
+  reader_options_ =
+      tensorflow::io::RecordReaderOptions::CreateRecordReaderOptions(
+          options_.compression_type());
+  reader_options_.buffer_size = options_.read_buffer_size_bytes();
+
+  const int num_threads =
+      std::min<int>(options_.num_threads(), shards_.size());
+  num_active_readers_ = num_threads;
+  readers_ = absl::make_unique<ThreadPool>("TFRecordReader", num_threads);
+  readers_->StartWorkers();
+  for (int i = 0; i < num_threads; ++i) {
+    readers_->Schedule([this] { ReadShards(); });
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ShardedTFRecordReaderCalculator::Process(CalculatorContext* cc) {
+  const size_t buffer_size = std::max(options_.shuffle_buffer_size(), 1);
+  while (shuffle_buffer_.size() < buffer_size) {
+    ASSIGN_OR_RETURN(Packet packet, Dequeue());
+    if (packet.IsEmpty()) break;
+    shuffle_buffer_.push_back(std::move(packet));
+  }
+  if (shuffle_buffer_.empty()) {
+    return tool::StatusStop();
+  }
+
+  // Without shuffling, the buffer holds a single record.
+  std::uniform_int_distribution<size_t> index(0, shuffle_buffer_.size() - 1);
+  std::swap(shuffle_buffer_[index(rng_)], shuffle_buffer_.back());
+  cc->Outputs()
+      .Tag(output_tag_)
+      .AddPacket(shuffle_buffer_.back().At(Timestamp(num_output_records_++)));
+  shuffle_buffer_.pop_back();
+  return absl::OkStatus();
+}
+
+absl::Status ShardedTFRecordReaderCalculator::Close(CalculatorContext* cc) {
+  {
+    absl::MutexLock lock(&mutex_);
+    closed_ = true;
+  }
+  // Waits for the reader threads to exit.
+  readers_.reset();
+  shuffle_buffer_.clear();
+  return absl::OkStatus();
+}
+
+void ShardedTFRecordReaderCalculator::ReadShards() {
+  while (true) {
+    std::string shard;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (closed_ || !read_status_.ok() || next_shard_ == shards_.size()) {
+        --num_active_readers_;
+        return;
+      }
+      shard = shards_[next_shard_++];
+    }
+    absl::Status status = ReadShard(shard);
+    if (!status.ok()) {
+      absl::MutexLock lock(&mutex_);
+      if (read_status_.ok()) read_status_ = std::move(status);
+    }
+  }
+}
+
+absl::Status ShardedTFRecordReaderCalculator::ReadShard(
+    const std::string& path) {
+  std::unique_ptr<tensorflow::RandomAccessFile> file;
+  auto tf_status = tensorflow::Env::Default()->NewRandomAccessFile(path, &file);
+  RET_CHECK(tf_status.ok())
+      << "Failed to open tfrecord file: " << tf_status.ToString();
+  tensorflow::io::RecordReader reader(file.get(), reader_options_);
+  tensorflow::uint64 offset = 0;
+  tensorflow::tstring record;
+  while (true) {
+    tf_status = reader.ReadRecord(&offset, &record);
+    if (tensorflow::errors::IsOutOfRange(tf_status)) {
+      return absl::OkStatus();
+    }
+    RET_CHECK(tf_status.ok()) << "Failed to read tfrecord " << path << ": "
+                              << tf_status.ToString();
+    absl::StatusOr<Packet> packet =
+        output_tag_ == kExampleTag
+            ? ParseRecord<tensorflow::Example>(record)
+            : ParseRecord<tensorflow::SequenceExample>(record);
+    MP_RETURN_IF_ERROR(packet.status()) << " In " << path;
+    if (!Enqueue(*std::move(packet))) {
+      return absl::OkStatus();
+    }
+  }
+}
+
+bool ShardedTFRecordReaderCalculator::Enqueue(Packet packet) {
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(
+      absl::Condition(this, &ShardedTFRecordReaderCalculator::CanEnqueue));
+  if (closed_ || !read_status_.ok()) return false;
+  queue_.push_back(std::move(packet));
+  return true;
+}
+
+absl::StatusOr<Packet> ShardedTFRecordReaderCalculator::Dequeue() {
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(
+      absl::Condition(this, &ShardedTFRecordReaderCalculator::CanDequeue));
+  MP_RETURN_IF_ERROR(read_status_);
+  if (queue_.empty()) return Packet();
+  Packet packet = std::move(queue_.front());
+  queue_.pop_front();
+  return packet;
+}
+
+REGISTER_CALCULATOR(ShardedTFRecordReaderCalculator);
+
+}  // namespace mediapipe
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <deque>
 #include <map>
 #include <memory>
 #include <string>
@@ -23,6 +24,7 @@
 #include "absl/memory/memory.h"
 #include "absl/strings/str_split.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
 #include "mediapipe/calculators/tensorflow/tensorflow_inference_calculator.pb.h"
 #include "mediapipe/calculators/tensorflow/tensorflow_session.h"
 #include "mediapipe/framework/calculator_context.h"
@@ -34,6 +36,7 @@
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/framework/port/threadpool.h"
 #include "mediapipe/framework/timestamp.h"
 #include "mediapipe/framework/tool/status_util.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -99,6 +102,19 @@ class InferenceState {
   std::vector<Timestamp> batch_timestamps_;
 };
 
+// A batch on its way through Session::Run. When session runs overlap, the
+// fetched tensors are filled in by a worker thread and picked up in input
+// order by Process() or Close().
+struct SessionRun {
+  std::unique_ptr<InferenceState> inference_state;
+  // Time at which the batch was handed over, for the TotalTimeUsecs counter.
+  int64 start_time = 0;
+  int64 run_time_usecs = 0;
+  std::vector<tf::Tensor> outputs;
+  absl::Status status;
+  absl::Notification done;
+};
+
 }  // namespace
 
 // This calculator performs inference on a trained TensorFlow model.
@@ -134,6 +150,12 @@ class InferenceState {
 // recurrent tensors. Initializing the recurrent state can be handled by the
 // GraphTensorsPacketGenerator.
 //
+// Setting max_in_flight_session_runs above 1 lets up to that many batches run
+// through the session at once on worker threads owned by the node, while the
+// outputs are still sent in timestamp order. Setting batch_timeout_us runs a
+// partial batch once its inputs have waited that long, which bounds latency
+// when inputs arrive too slowly to fill a batch.
+//
 // The calculator updates two Counters to report timing information:
 //   --<name>-TotalTimeUsecs = Total time spent running inference (in usecs),
 //   --<name>-TotalProcessedTimestamps = # of instances processed
@@ -300,6 +322,10 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
     RET_CHECK(options_.batch_size() == 1 ||
               options_.recurrent_tag_pair().empty())
         << "To use recurrent_tag_pairs, batch_size must be 1.";
+    RET_CHECK_GE(options_.max_in_flight_session_runs(), 1);
+    RET_CHECK(options_.max_in_flight_session_runs() == 1 ||
+              options_.recurrent_tag_pair().empty())
+        << "To use recurrent_tag_pairs, max_in_flight_session_runs must be 1.";
 
     // Helper for StrJoin. Prints key (tag) of map<string, string>.
     auto TagFormatter =
@@ -338,12 +364,34 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
           << absl::StrJoin(tag_to_tensor_map_, ", ", TagFormatter);
     }
 
+    for (const std::string& tag : cc->Outputs().GetTags()) {
+      output_tensor_names_.emplace_back(tag_to_tensor_map_[tag]);
+      output_name_in_signature_.emplace_back(tag);
+    }
+    for (const auto& tag_pair : recurrent_fetch_tags_to_feed_tags_) {
+      // Ensure that we always fetch the recurrent state tensors.
+      if (std::find(output_name_in_signature_.begin(),
+                    output_name_in_signature_.end(),
+                    tag_pair.first) == output_name_in_signature_.end()) {
+        output_tensor_names_.emplace_back(tag_to_tensor_map_[tag_pair.first]);
+        output_name_in_signature_.emplace_back(tag_pair.first);
+      }
+    }
+    node_name_ = cc->NodeName();
+
     {
       absl::WriterMutexLock l(&mutex_);
       inference_state_ = std::unique_ptr<InferenceState>();
+      last_input_time_ = absl::ToUnixMicros(clock_->TimeNow());
     }
 
-    if (options_.batch_size() == 1 || options_.batched_input()) {
+    if (options_.max_in_flight_session_runs() > 1) {
+      session_run_pool_ = absl::make_unique<ThreadPool>(
+          "tf_inference", options_.max_in_flight_session_runs());
+      session_run_pool_->StartWorkers();
+    } else if (options_.batch_size() == 1 || options_.batched_input()) {
+      // Outputs of overlapping runs are sent after Process() returns, so the
+      // offset can only be promised for synchronous runs.
       cc->SetOffset(0);
     }
 
@@ -397,11 +445,16 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
 
   absl::Status Process(CalculatorContext* cc) override {
     std::unique_ptr<InferenceState> inference_state_to_process;
+    bool timed_out = false;
     {
       absl::WriterMutexLock l(&mutex_);
       if (inference_state_ == nullptr) {
         inference_state_ = CreateInferenceState(cc);
       }
+      const int64 now = absl::ToUnixMicros(clock_->TimeNow());
+      if (inference_state_->batch_timestamps_.empty()) {
+        batch_start_time_ = now;
+      }
       std::map<Timestamp, std::map<std::string, tf::Tensor>>
           input_tensors_by_tag_by_timestamp;
       for (const std::string& tag_as_node_name : cc->Inputs().GetTags()) {
@@ -446,8 +499,15 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
               .emplace_back(input_tensor_and_tag.second);
         }
       }
+      if (options_.batch_timeout_us() > 0) {
+        // A long gap since the previous input means the batch is unlikely to
+        // fill up soon, so it is not worth holding the new input back either.
+        timed_out = now - batch_start_time_ >= options_.batch_timeout_us() ||
+                    now - last_input_time_ >= options_.batch_timeout_us();
+        last_input_time_ = now;
+      }
       if (inference_state_->batch_timestamps_.size() == options_.batch_size() ||
-          options_.batched_input()) {
+          options_.batched_input() || timed_out) {
         inference_state_to_process = std::move(inference_state_);
         inference_state_ = std::unique_ptr<InferenceState>();
       }
@@ -457,6 +517,12 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
       MP_RETURN_IF_ERROR(
           OutputBatch(cc, std::move(inference_state_to_process)));
     }
+    if (session_run_pool_ != nullptr) {
+      // After a timeout nothing may arrive to pick up the pending runs, so
+      // wait for all of them.
+      MP_RETURN_IF_ERROR(EmitCompletedRuns(
+          cc, timed_out ? 0 : options_.max_in_flight_session_runs()));
+    }
 
     return absl::OkStatus();
   }
@@ -475,6 +541,9 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
       MP_RETURN_IF_ERROR(
           OutputBatch(cc, std::move(inference_state_to_process)));
     }
+    if (session_run_pool_ != nullptr && cc->GraphStatus().ok()) {
+      MP_RETURN_IF_ERROR(EmitCompletedRuns(cc, 0));
+    }
     return absl::OkStatus();
   }
 
@@ -485,17 +554,53 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
   // that copying a tensor shares the same reference-counted, heap allocated
   // memory buffer. Therefore, copies are cheap and should not cause the memory
   // buffer to fall out of scope. In contrast, concat is only used where
-  // necessary.
+  // necessary. With overlapping session runs, the batch is only scheduled here
+  // and its outputs are sent by EmitCompletedRuns().
   absl::Status OutputBatch(CalculatorContext* cc,
                            std::unique_ptr<InferenceState> inference_state) {
-    const int64 start_time = absl::ToUnixMicros(clock_->TimeNow());
+    auto run = absl::make_unique<SessionRun>();
+    run->start_time = absl::ToUnixMicros(clock_->TimeNow());
+    run->inference_state = std::move(inference_state);
+    if (session_run_pool_ == nullptr) {
+      MP_RETURN_IF_ERROR(RunSession(run.get()));
+      return EmitBatch(cc, run.get());
+    }
+    SessionRun* scheduled_run = run.get();
+    pending_runs_.push_back(std::move(run));
+    session_run_pool_->Schedule([this, scheduled_run] {
+      scheduled_run->status = RunSession(scheduled_run);
+      scheduled_run->done.Notify();
+    });
+    return absl::OkStatus();
+  }
+
+  // Sends the outputs of finished runs in the order their batches were
+  // scheduled, first blocking until at most `max_pending` runs are left.
+  absl::Status EmitCompletedRuns(CalculatorContext* cc, int max_pending) {
+    while (!pending_runs_.empty() &&
+           (pending_runs_.size() > max_pending ||
+            pending_runs_.front()->done.HasBeenNotified())) {
+      std::unique_ptr<SessionRun> run = std::move(pending_runs_.front());
+      pending_runs_.pop_front();
+      run->done.WaitForNotification();
+      MP_RETURN_IF_ERROR(run->status);
+      MP_RETURN_IF_ERROR(EmitBatch(cc, run.get()));
+    }
+    return absl::OkStatus();
+  }
+
+  // Concatenates the batch and runs the session on it. The fetched tensors are
+  // stored in `run`; the CalculatorContext is not touched, so this may run on
+  // a session run worker.
+  absl::Status RunSession(SessionRun* run) {
+    InferenceState* inference_state = run->inference_state.get();
     std::vector<std::pair<mediapipe::ProtoString, tf::Tensor>> input_tensors;
 
     for (auto& keyed_tensors : inference_state->input_tensor_batches_) {
       if (options_.batch_size() == 1) {
         // Short circuit to avoid the cost of deep copying tensors in concat.
         if (!keyed_tensors.second.empty()) {
-          input_tensors.emplace_back(tag_to_tensor_map_[keyed_tensors.first],
+          input_tensors.emplace_back(tag_to_tensor_map_.at(keyed_tensors.first),
                                      keyed_tensors.second[0]);
         } else {
           // The input buffer can be empty for recurrent tensors.
@@ -516,27 +621,11 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
         const tf::Status concat_status =
             tf::tensor::Concat(keyed_tensors.second, &concated);
         CHECK(concat_status.ok()) << concat_status.ToString();
-        input_tensors.emplace_back(tag_to_tensor_map_[keyed_tensors.first],
+        input_tensors.emplace_back(tag_to_tensor_map_.at(keyed_tensors.first),
                                    concated);
       }
     }
     inference_state->input_tensor_batches_.clear();
-    std::vector<mediapipe::ProtoString> output_tensor_names;
-    std::vector<std::string> output_name_in_signature;
-    for (const std::string& tag : cc->Outputs().GetTags()) {
-      output_tensor_names.emplace_back(tag_to_tensor_map_[tag]);
-      output_name_in_signature.emplace_back(tag);
-    }
-    for (const auto& tag_pair : recurrent_fetch_tags_to_feed_tags_) {
-      // Ensure that we always fetch the recurrent state tensors.
-      if (std::find(output_name_in_signature.begin(),
-                    output_name_in_signature.end(),
-                    tag_pair.first) == output_name_in_signature.end()) {
-        output_tensor_names.emplace_back(tag_to_tensor_map_[tag_pair.first]);
-        output_name_in_signature.emplace_back(tag_pair.first);
-      }
-    }
-    std::vector<tf::Tensor> outputs;
 
     SimpleSemaphore* session_run_throttle = nullptr;
     if (options_.max_concurrent_session_runs() > 0) {
@@ -548,10 +637,10 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
     tf::Status tf_status;
     {
 #if !defined(MEDIAPIPE_MOBILE) && !defined(__APPLE__)
-      tensorflow::profiler::TraceMe trace(absl::string_view(cc->NodeName()));
+      tensorflow::profiler::TraceMe trace(absl::string_view(node_name_));
 #endif
-      tf_status = session_->Run(input_tensors, output_tensor_names,
-                                {} /* target_node_names */, &outputs);
+      tf_status = session_->Run(input_tensors, output_tensor_names_,
+                                {} /* target_node_names */, &run->outputs);
     }
 
     if (session_run_throttle != nullptr) {
@@ -562,19 +651,28 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
     // informative error message.
     RET_CHECK(tf_status.ok()) << "Run failed: " << tf_status.ToString();
 
-    const int64 run_end_time = absl::ToUnixMicros(clock_->TimeNow());
-    cc->GetCounter(kTotalSessionRunsTimeUsecsCounterSuffix)
-        ->IncrementBy(run_end_time - run_start_time);
-    cc->GetCounter(kTotalNumSessionRunsCounterSuffix)->Increment();
+    run->run_time_usecs =
+        absl::ToUnixMicros(clock_->TimeNow()) - run_start_time;
 
     // Feed back the recurrent state.
     for (const auto& tag_pair : recurrent_fetch_tags_to_feed_tags_) {
-      int pos = std::find(output_name_in_signature.begin(),
-                          output_name_in_signature.end(), tag_pair.first) -
-                output_name_in_signature.begin();
+      int pos = std::find(output_name_in_signature_.begin(),
+                          output_name_in_signature_.end(), tag_pair.first) -
+                output_name_in_signature_.begin();
       inference_state->input_tensor_batches_[tag_pair.second].emplace_back(
-          outputs[pos]);
+          run->outputs[pos]);
     }
+    return absl::OkStatus();
+  }
+
+  // Splits the fetched tensors of a finished run and sends them at the
+  // timestamps of the batch elements.
+  absl::Status EmitBatch(CalculatorContext* cc, SessionRun* run) {
+    std::unique_ptr<InferenceState>& inference_state = run->inference_state;
+    const std::vector<tf::Tensor>& outputs = run->outputs;
+    cc->GetCounter(kTotalSessionRunsTimeUsecsCounterSuffix)
+        ->IncrementBy(run->run_time_usecs);
+    cc->GetCounter(kTotalNumSessionRunsCounterSuffix)->Increment();
 
     absl::WriterMutexLock l(&mutex_);
     // Set that we want to split on each index of the 0th dimension.
@@ -583,13 +681,13 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
             ? options_.batch_size()
             : inference_state->batch_timestamps_.size(),
         1);
-    for (int i = 0; i < output_tensor_names.size(); ++i) {
+    for (int i = 0; i < output_tensor_names_.size(); ++i) {
       if (options_.batch_size() == 1) {
-        if (cc->Outputs().HasTag(output_name_in_signature[i])) {
+        if (cc->Outputs().HasTag(output_name_in_signature_[i])) {
           tf::Tensor output_tensor(outputs[i]);
           RET_CHECK_OK(RemoveBatchDimension(&output_tensor));
           cc->Outputs()
-              .Tag(output_name_in_signature[i])
+              .Tag(output_name_in_signature_[i])
               .Add(new tf::Tensor(output_tensor),
                    inference_state->batch_timestamps_[0]);
         }
@@ -603,7 +701,7 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
           tf::Tensor output_tensor(split_tensors[j]);
           RET_CHECK_OK(RemoveBatchDimension(&output_tensor));
           cc->Outputs()
-              .Tag(output_name_in_signature[i])
+              .Tag(output_name_in_signature_[i])
               .Add(new tf::Tensor(output_tensor),
                    inference_state->batch_timestamps_[j]);
         }
@@ -613,7 +711,7 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
     // Get end time and report.
     const int64 end_time = absl::ToUnixMicros(clock_->TimeNow());
     cc->GetCounter(kTotalUsecsCounterSuffix)
-        ->IncrementBy(end_time - start_time);
+        ->IncrementBy(end_time - run->start_time);
     cc->GetCounter(kTotalProcessedTimestampsCounterSuffix)
         ->IncrementBy(inference_state->batch_timestamps_.size());
 
@@ -648,6 +746,24 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
   // Clock used to measure the computation time in OutputBatch().
   std::unique_ptr<mediapipe::Clock> clock_;
 
+  // The fetched tensor names and the tags they are bound to in the signature.
+  std::vector<mediapipe::ProtoString> output_tensor_names_;
+  std::vector<std::string> output_name_in_signature_;
+  std::string node_name_;
+
+  // Arrival times of the first input of the current batch and of the latest
+  // input, used for batch_timeout_us.
+  int64 batch_start_time_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64 last_input_time_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  // Batches scheduled on session_run_pool_ whose outputs have not been sent
+  // yet, oldest first. Only used from Process() and Close().
+  std::deque<std::unique_ptr<SessionRun>> pending_runs_;
+  // Workers for overlapping session runs, if max_in_flight_session_runs > 1.
+  // Declared last so that it is joined before the state its workers use goes
+  // away.
+  std::unique_ptr<ThreadPool> session_run_pool_;
+
   // The static singleton semaphore to throttle concurrent session runs.
   static SimpleSemaphore* get_session_run_throttle(
       int32 max_concurrent_session_runs) {
@@ -558,6 +558,112 @@ TEST_F(TensorflowInferenceCalculatorTest, GetBatchComputed_MaxInFlight) {
                    ->Get());
 }
 
+TEST_F(TensorflowInferenceCalculatorTest, GetBatchComputed_OverlappingRuns) {
+  CalculatorGraphConfig::Node config;
+  config.set_calculator("TensorFlowInferenceCalculator");
+  config.add_input_stream("A:tensor_a");
+  config.add_input_stream("B:tensor_b");
+  config.add_output_stream("MULTIPLIED:tensor_o1");
+  config.add_input_side_packet("SESSION:session");
+  CalculatorOptions options;
+  options.MutableExtension(TensorFlowInferenceCalculatorOptions::ext)
+      ->set_batch_size(2);
+  options.MutableExtension(TensorFlowInferenceCalculatorOptions::ext)
+      ->set_add_batch_dim_to_tensors(true);
+  options.MutableExtension(TensorFlowInferenceCalculatorOptions::ext)
+      ->set_max_in_flight_session_runs(2);
+  *config.mutable_options() = options;
+
+  runner_ = absl::make_unique<CalculatorRunner>(config);
+  AddSessionInputSidePacket();
+  for (int i = 0; i < 7; ++i) {
+    AddVectorToInputsAsTensor({i, i, i}, "A", i);
+    AddVectorToInputsAsTensor({3, 4, 5}, "B", i);
+  }
+  MP_ASSERT_OK(runner_->Run());
+
+  const std::vector<Packet>& output_packets_mult =
+      runner_->Outputs().Tag(kMultipliedTag).packets;
+  ASSERT_EQ(7, output_packets_mult.size());
+  for (int i = 0; i < 7; ++i) {
+    EXPECT_EQ(Timestamp(i), output_packets_mult[i].Timestamp());
+    auto expected_tensor = tf::test::AsTensor<int32>({3 * i, 4 * i, 5 * i});
+    tf::test::ExpectTensorEqual<int32>(
+        output_packets_mult[i].Get<tf::Tensor>(), expected_tensor);
+  }
+
+  EXPECT_EQ(4, runner_->GetCounter(
+                      "TensorFlowInferenceCalculator-TotalNumSessionRuns")
+                   ->Get());
+  EXPECT_EQ(7, runner_
+                   ->GetCounter(
+                       "TensorFlowInferenceCalculator-TotalProcessedTimestamps")
+                   ->Get());
+}
+
+TEST_F(TensorflowInferenceCalculatorTest, GetPartialBatchesOnTimeout) {
+  CalculatorGraphConfig::Node config;
+  config.set_calculator("TensorFlowInferenceCalculator");
+  config.add_input_stream("A:tensor_a");
+  config.add_input_stream("B:tensor_b");
+  config.add_output_stream("MULTIPLIED:tensor_o1");
+  config.add_input_side_packet("SESSION:session");
+  CalculatorOptions options;
+  options.MutableExtension(TensorFlowInferenceCalculatorOptions::ext)
+      ->set_batch_size(3);
+  options.MutableExtension(TensorFlowInferenceCalculatorOptions::ext)
+      ->set_add_batch_dim_to_tensors(true);
+  // Inputs are at least a session run apart, so none of them waits for the
+  // batch to fill.
+  options.MutableExtension(TensorFlowInferenceCalculatorOptions::ext)
+      ->set_batch_timeout_us(1);
+  *config.mutable_options() = options;
+
+  runner_ = absl::make_unique<CalculatorRunner>(config);
+  AddSessionInputSidePacket();
+  AddVectorToInputsAsTensor({2, 2, 2}, "A", 0);
+  AddVectorToInputsAsTensor({3, 4, 5}, "B", 0);
+  AddVectorToInputsAsTensor({3, 3, 3}, "A", 1);
+  AddVectorToInputsAsTensor({3, 4, 5}, "B", 1);
+  MP_ASSERT_OK(runner_->Run());
+
+  const std::vector<Packet>& output_packets_mult =
+      runner_->Outputs().Tag(kMultipliedTag).packets;
+  ASSERT_EQ(2, output_packets_mult.size());
+  tf::test::ExpectTensorEqual<int32>(output_packets_mult[0].Get<tf::Tensor>(),
+                                     tf::test::AsTensor<int32>({6, 8, 10}));
+  tf::test::ExpectTensorEqual<int32>(output_packets_mult[1].Get<tf::Tensor>(),
+                                     tf::test::AsTensor<int32>({9, 12, 15}));
+
+  EXPECT_EQ(2, runner_->GetCounter(
+                      "TensorFlowInferenceCalculator-TotalNumSessionRuns")
+                   ->Get());
+}
+
+TEST_F(TensorflowInferenceCalculatorTest,
+       OverlappingRunsRequireNoRecurrentState) {
+  CalculatorGraphConfig::Node config;
+  config.set_calculator("TensorFlowInferenceCalculator");
+  config.add_input_stream("A:tensor_a");
+  config.add_input_stream("B:tensor_b");
+  config.add_output_stream("MULTIPLIED:tensor_o1");
+  config.add_input_side_packet("SESSION:session");
+  CalculatorOptions options;
+  options.MutableExtension(TensorFlowInferenceCalculatorOptions::ext)
+      ->set_batch_size(1);
+  options.MutableExtension(TensorFlowInferenceCalculatorOptions::ext)
+      ->add_recurrent_tag_pair("A:MULTIPLIED");
+  options.MutableExtension(TensorFlowInferenceCalculatorOptions::ext)
+      ->set_max_in_flight_session_runs(2);
+  *config.mutable_options() = options;
+
+  runner_ = absl::make_unique<CalculatorRunner>(config);
+  AddSessionInputSidePacket();
+  AddVectorToInputsAsTensor({3, 4, 5}, "B", 0);
+  EXPECT_THAT(runner_->Run().message(),
+              HasSubstr("max_in_flight_session_runs must be 1"));
+}
+
 TEST_F(TensorflowInferenceCalculatorTest, TestRecurrentStates) {
   CalculatorGraphConfig::Node config;
   config.set_calculator("TensorFlowInferenceCalculator");
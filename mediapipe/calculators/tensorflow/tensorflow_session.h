@@ -21,8 +21,9 @@
 
 namespace mediapipe {
 struct TensorFlowSession {
-  // TensorFlow session wrapper to get around the RTTI issue.
-  std::unique_ptr<tensorflow::Session> session;
+  // TensorFlow session wrapper to get around the RTTI issue. May be shared
+  // with the TensorFlowSessions of other graphs, see saved_model_cache.h.
+  std::shared_ptr<tensorflow::Session> session;
 
   // Store an optional mapping to the between MediaPipe tags and TensorFlow
   // tensor names. Creating this mapping when the session is loaded allows more
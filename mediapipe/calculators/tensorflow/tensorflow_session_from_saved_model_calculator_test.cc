@@ -131,6 +131,53 @@ TEST_F(TensorFlowSessionFromSavedModelCalculatorTest,
   ASSERT_NE(session.session, nullptr);
 }
 
+TEST_F(TensorFlowSessionFromSavedModelCalculatorTest, SharesSessions) {
+  options_->set_share_session(true);
+  options_->set_num_warmup_runs(1);
+  const std::string config = absl::Substitute(R"(
+        calculator: "TensorFlowSessionFromSavedModelCalculator"
+        output_side_packet: "SESSION:tf_model"
+        options {
+          [mediapipe.TensorFlowSessionFromSavedModelCalculatorOptions.ext]: {
+            $0
+          }
+        })",
+                                              options_->DebugString());
+  CalculatorRunner first_runner(config);
+  MP_ASSERT_OK(first_runner.Run());
+  CalculatorRunner second_runner(config);
+  MP_ASSERT_OK(second_runner.Run());
+  const TensorFlowSession& first_session =
+      first_runner.OutputSidePackets()
+          .Tag(kSessionTag)
+          .Get<TensorFlowSession>();
+  const TensorFlowSession& second_session =
+      second_runner.OutputSidePackets()
+          .Tag(kSessionTag)
+          .Get<TensorFlowSession>();
+  ASSERT_NE(first_session.session, nullptr);
+  EXPECT_EQ(first_session.session, second_session.session);
+  EXPECT_EQ(first_session.tag_to_tensor_map, second_session.tag_to_tensor_map);
+
+  // Sessions aren't shared unless requested.
+  options_->set_share_session(false);
+  CalculatorRunner unshared_runner(absl::Substitute(R"(
+        calculator: "TensorFlowSessionFromSavedModelCalculator"
+        output_side_packet: "SESSION:tf_model"
+        options {
+          [mediapipe.TensorFlowSessionFromSavedModelCalculatorOptions.ext]: {
+            $0
+          }
+        })",
+                                                    options_->DebugString()));
+  MP_ASSERT_OK(unshared_runner.Run());
+  EXPECT_NE(unshared_runner.OutputSidePackets()
+                .Tag(kSessionTag)
+                .Get<TensorFlowSession>()
+                .session,
+            first_session.session);
+}
+
 // Integration test. Verifies that TensorFlowInferenceCalculator correctly
 // consumes the Packet emitted by this factory.
 TEST_F(TensorFlowSessionFromSavedModelCalculatorTest,
@@ -18,6 +18,7 @@
 #include "mediapipe/framework/port/file_helpers.h"
 #endif
 #include "absl/strings/str_replace.h"
+#include "mediapipe/calculators/tensorflow/saved_model_cache.h"
 #include "mediapipe/calculators/tensorflow/tensorflow_session.h"
 #include "mediapipe/calculators/tensorflow/tensorflow_session_from_saved_model_generator.pb.h"
 #include "mediapipe/framework/deps/file_path.h"
@@ -25,6 +26,7 @@
 #include "mediapipe/framework/packet_type.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/framework/tool/status_util.h"
 #include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/cc/saved_model/loader.h"
@@ -133,18 +135,35 @@ class TensorFlowSessionFromSavedModelGenerator : public PacketGenerator {
       tags_set.insert(tensorflow::kSavedModelTagServe);
     }
 
-    tensorflow::RunOptions run_options;
     tensorflow::SessionOptions session_options;
     session_options.config = options.session_config();
-    auto saved_model = absl::make_unique<tensorflow::SavedModelBundle>();
-    ::tensorflow::Status status = tensorflow::LoadSavedModel(
-        session_options, run_options, path, tags_set, saved_model.get());
-    if (!status.ok()) {
-      return absl::Status(static_cast<absl::StatusCode>(status.code()),
-                          status.ToString());
-    }
     auto session = absl::make_unique<TensorFlowSession>();
-    session->session = std::move(saved_model->session);
+    std::shared_ptr<tensorflow::SavedModelBundle> saved_model;
+    if (options.share_session()) {
+      ASSIGN_OR_RETURN(saved_model, GetOrLoadSharedSavedModel(
+                                        path, tags_set, session_options,
+                                        options.signature_name(),
+                                        options.num_warmup_runs()));
+      // The session keeps the shared bundle alive.
+      session->session = std::shared_ptr<tensorflow::Session>(
+          saved_model, saved_model->session.get());
+    } else {
+      tensorflow::RunOptions run_options;
+      saved_model = std::make_shared<tensorflow::SavedModelBundle>();
+      ::tensorflow::Status status = tensorflow::LoadSavedModel(
+          session_options, run_options, path, tags_set, saved_model.get());
+      if (!status.ok()) {
+        return absl::Status(static_cast<absl::StatusCode>(status.code()),
+                            status.ToString());
+      }
+      if (options.num_warmup_runs() > 0) {
+        const absl::Status warmup_status = WarmUpSavedModel(
+            *saved_model, options.signature_name(), options.num_warmup_runs());
+        LOG_IF(WARNING, !warmup_status.ok())
+            << "Warm-up of " << path << " failed: " << warmup_status;
+      }
+      session->session = std::move(saved_model->session);
+    }
 
     RET_CHECK(!options.signature_name().empty());
     const auto& signature_def_map = saved_model->meta_graph_def.signature_def();
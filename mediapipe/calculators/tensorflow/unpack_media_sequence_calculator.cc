@@ -14,6 +14,8 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
 #include "mediapipe/calculators/core/packet_resampler_calculator.pb.h"
 #include "mediapipe/calculators/tensorflow/unpack_media_sequence_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -108,6 +110,10 @@ namespace mpms = mediapipe::mediasequence;
 //   FLOAT_FEATURE_${NAME}: the feature named ${NAME} as vector<float>.
 //   BBOX: bounding boxes as vector<Location>s. (BBOX_${NAME} is supported.)
 //
+// Only the feature lists of the connected output streams are read. With
+// output_encoded_images_by_reference, the encoded images are output without
+// being copied out of the SequenceExample.
+//
 // Example config:
 // node {
 //   calculator: "UnpackMediaSequenceCalculator"
@@ -186,21 +192,77 @@ class UnpackMediaSequenceCalculator : public CalculatorBase {
     return absl::OkStatus();
   }
 
+  // Returns the output stream tags of the images, bounding boxes and float
+  // features timestamped by the feature list |key|. They may not be connected.
+  static std::string ImageTag(const std::string& key) {
+    std::vector<std::string> pieces = absl::StrSplit(key, '/');
+    if (pieces[0] == "image") return kImageTag;
+    return absl::StrCat(kImageTag, "_", pieces[0]);
+  }
+  static std::string BBoxTag(const std::string& key) {
+    std::vector<std::string> pieces = absl::StrSplit(key, '/');
+    if (pieces[0] == "region") return kBBoxTag;
+    return absl::StrCat(kBBoxTag, "_", pieces[0]);
+  }
+  static std::string FloatFeatureTag(const std::string& key) {
+    std::vector<std::string> pieces = absl::StrSplit(key, '/');
+    return kFloatFeaturePrefixTag + pieces[0];
+  }
+
+  // Whether any output stream is unpacked from the data timestamped by the
+  // feature list |key|.
+  static bool IsTimestampKeyConnected(CalculatorContext* cc,
+                                      const std::string& key) {
+    if (absl::StrContains(key, mpms::GetImageTimestampKey()) &&
+        cc->Outputs().HasTag(ImageTag(key))) {
+      return true;
+    }
+    if (key == mpms::GetForwardFlowTimestampKey() &&
+        cc->Outputs().HasTag(kForwardFlowImageTag)) {
+      return true;
+    }
+    if (absl::StrContains(key, mpms::GetBBoxTimestampKey()) &&
+        cc->Outputs().HasTag(BBoxTag(key))) {
+      return true;
+    }
+    return absl::StrContains(key, "feature") &&
+           cc->Outputs().HasTag(FloatFeatureTag(key));
+  }
+
+  // Outputs the encoded image at |index| of |feature_list| on |tag|.
+  void AddEncodedImage(CalculatorContext* cc, const std::string& tag,
+                       const tf::FeatureList& feature_list, int index,
+                       Timestamp timestamp) {
+    const std::string& encoded =
+        feature_list.feature(index).bytes_list().value(0);
+    if (output_encoded_images_by_reference_) {
+      cc->Outputs().Tag(tag).AddPacket(
+          PointToForeign(&encoded).At(timestamp));
+    } else {
+      cc->Outputs().Tag(tag).Add(new std::string(encoded), timestamp);
+    }
+  }
+
   absl::Status Open(CalculatorContext* cc) override {
     // Copy the packet to copy the otherwise inaccessible shared ptr.
     example_packet_holder_ = cc->InputSidePackets().Tag(kSequenceExampleTag);
     sequence_ = &example_packet_holder_.Get<tf::SequenceExample>();
     const auto& options = cc->Options<UnpackMediaSequenceCalculatorOptions>();
+    output_encoded_images_by_reference_ =
+        options.output_encoded_images_by_reference();
 
     // Collect the timestamps for all streams keyed by the timestamp feature's
     // key. While creating this data structure we also identify the last
     // timestamp and the associated feature. This information is used in process
-    // to output batches of packets in order.
+    // to output batches of packets in order. Feature lists that no output
+    // stream is unpacked from are skipped.
     timestamps_.clear();
+    next_timestamp_index_.clear();
     int64 last_timestamp_seen = Timestamp::PreStream().Value();
     first_timestamp_seen_ = Timestamp::OneOverPostStream().Value();
     for (const auto& map_kv : sequence_->feature_lists().feature_list()) {
-      if (absl::StrContains(map_kv.first, "/timestamp")) {
+      if (absl::StrContains(map_kv.first, "/timestamp") &&
+          IsTimestampKeyConnected(cc, map_kv.first)) {
         LOG(INFO) << "Found feature timestamps: " << map_kv.first
                   << " with size: " << map_kv.second.feature_size();
         int64 recent_timestamp = Timestamp::PreStream().Value();
@@ -219,6 +281,7 @@ class UnpackMediaSequenceCalculator : public CalculatorBase {
             next_timestamp = Timestamp::PreStream().Value();
           }
           timestamps_[map_kv.first].push_back(next_timestamp);
+          next_timestamp_index_[map_kv.first] = 0;
           recent_timestamp = next_timestamp;
           if (recent_timestamp < first_timestamp_seen_) {
             first_timestamp_seen_ = recent_timestamp;
@@ -382,10 +445,13 @@ class UnpackMediaSequenceCalculator : public CalculatorBase {
       }
     }
 
+    // The timestamps of each feature list are sequential, so each call only
+    // needs to continue from where the previous one stopped.
     for (const auto& map_kv : timestamps_) {
-      for (int i = 0; i < map_kv.second.size(); ++i) {
-        if (map_kv.second[i] >= start_timestamp &&
-            map_kv.second[i] < end_timestamp) {
+      int& i = next_timestamp_index_[map_kv.first];
+      for (; i < map_kv.second.size() && map_kv.second[i] < end_timestamp;
+           ++i) {
+        if (map_kv.second[i] >= start_timestamp) {
           Timestamp current_timestamp;
           if (map_kv.second[i] == Timestamp::PostStream().Value()) {
             current_timestamp = Timestamp::PostStream();
@@ -398,36 +464,34 @@ class UnpackMediaSequenceCalculator : public CalculatorBase {
           if (absl::StrContains(map_kv.first, mpms::GetImageTimestampKey())) {
             std::vector<std::string> pieces = absl::StrSplit(map_kv.first, '/');
             std::string feature_key = "";
-            std::string possible_tag = kImageTag;
             if (pieces[0] != "image") {
               feature_key = pieces[0];
-              possible_tag = absl::StrCat(kImageTag, "_", feature_key);
             }
+            const std::string possible_tag = ImageTag(map_kv.first);
             if (cc->Outputs().HasTag(possible_tag)) {
-              cc->Outputs()
-                  .Tag(possible_tag)
-                  .Add(new std::string(
-                           mpms::GetImageEncodedAt(feature_key, *sequence_, i)),
-                       current_timestamp);
+              AddEncodedImage(
+                  cc, possible_tag,
+                  mpms::GetFeatureList(*sequence_,
+                                       mpms::GetImageEncodedKey(feature_key)),
+                  i, current_timestamp);
             }
           }
 
           if (cc->Outputs().HasTag(kForwardFlowImageTag) &&
               map_kv.first == mpms::GetForwardFlowTimestampKey()) {
-            cc->Outputs()
-                .Tag(kForwardFlowImageTag)
-                .Add(new std::string(
-                         mpms::GetForwardFlowEncodedAt(*sequence_, i)),
-                     current_timestamp);
+            AddEncodedImage(
+                cc, kForwardFlowImageTag,
+                mpms::GetFeatureList(*sequence_,
+                                     mpms::GetForwardFlowEncodedKey()),
+                i, current_timestamp);
           }
           if (absl::StrContains(map_kv.first, mpms::GetBBoxTimestampKey())) {
             std::vector<std::string> pieces = absl::StrSplit(map_kv.first, '/');
             std::string feature_key = "";
-            std::string possible_tag = kBBoxTag;
             if (pieces[0] != "region") {
               feature_key = pieces[0];
-              possible_tag = absl::StrCat(kBBoxTag, "_", feature_key);
             }
+            const std::string possible_tag = BBoxTag(map_kv.first);
             if (cc->Outputs().HasTag(possible_tag)) {
               const auto& bboxes = mpms::GetBBoxAt(feature_key, *sequence_, i);
               cc->Outputs()
@@ -443,7 +507,7 @@ class UnpackMediaSequenceCalculator : public CalculatorBase {
                 << "Failed to parse the feature substring before / from key "
                 << map_kv.first;
             std::string feature_key = pieces[0];
-            std::string possible_tag = kFloatFeaturePrefixTag + feature_key;
+            const std::string possible_tag = FloatFeatureTag(map_kv.first);
             if (cc->Outputs().HasTag(possible_tag)) {
               const auto& float_list =
                   mpms::GetFeatureFloatsAt(feature_key, *sequence_, i);
@@ -482,6 +546,8 @@ class UnpackMediaSequenceCalculator : public CalculatorBase {
   // key. This allows us to identify which packets to output for each stream
   // for timestamps within a given time window.
   std::map<std::string, std::vector<int64>> timestamps_;
+  // Store the index of the next timestamp to output for each key.
+  absl::flat_hash_map<std::string, int> next_timestamp_index_;
   // Store the stream with the latest timestamp in the SequenceExample.
   std::string last_timestamp_key_;
   // Store the index of the current timestamp. Will be less than
@@ -494,6 +560,7 @@ class UnpackMediaSequenceCalculator : public CalculatorBase {
   // Default keypoint location when missing.
   float default_keypoint_location_;
   bool process_poststream_;
+  bool output_encoded_images_by_reference_ = false;
 };
 REGISTER_CALCULATOR(UnpackMediaSequenceCalculator);
 }  // namespace mediapipe
@@ -166,6 +166,39 @@ TEST_F(UnpackMediaSequenceCalculatorTest, UnpacksTwoImages) {
   }
 }
 
+TEST_F(UnpackMediaSequenceCalculatorTest, UnpacksImagesByReference) {
+  CalculatorOptions options;
+  options.MutableExtension(UnpackMediaSequenceCalculatorOptions::ext)
+      ->set_output_encoded_images_by_reference(true);
+  SetUpCalculator({"IMAGE:images"}, {}, {}, &options);
+  auto input_sequence = absl::make_unique<tf::SequenceExample>();
+  std::string test_image_string = "test_image_string";
+  int num_images = 2;
+  for (int i = 0; i < num_images; ++i) {
+    mpms::AddImageTimestamp(i, input_sequence.get());
+    mpms::AddImageEncoded(test_image_string, input_sequence.get());
+  }
+  // Feature lists of unconnected streams aren't read.
+  mpms::AddFeatureTimestamp("OTHER", 1, input_sequence.get());
+  mpms::AddFeatureTimestamp("OTHER", 0, input_sequence.get());
+  const tf::SequenceExample* sequence = input_sequence.get();
+
+  runner_->MutableSidePackets()->Tag(kSequenceExampleTag) =
+      Adopt(input_sequence.release());
+
+  MP_ASSERT_OK(runner_->Run());
+
+  const std::vector<Packet>& output_packets =
+      runner_->Outputs().Tag(kImageTag).packets;
+  ASSERT_EQ(num_images, output_packets.size());
+
+  for (int i = 0; i < num_images; ++i) {
+    const std::string& output_image = output_packets[i].Get<std::string>();
+    ASSERT_EQ(output_image, test_image_string);
+    EXPECT_EQ(&output_image, &mpms::GetImageEncodedAt(*sequence, i));
+  }
+}
+
 TEST_F(UnpackMediaSequenceCalculatorTest, UnpacksTwoPrefixedImages) {
   std::string prefix = "PREFIX";
   SetUpCalculator({"IMAGE_PREFIX:images"}, {});
@@ -13,11 +13,16 @@
 // limitations under the License.
 
 #include <cmath>
+#include <map>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/calculators/tflite/ssd_anchors_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/flat_anchors.h"
 #include "mediapipe/framework/formats/object_detection/anchor.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 
@@ -25,6 +30,8 @@ namespace mediapipe {
 
 namespace {
 
+constexpr char kFlatAnchorsTag[] = "FLAT_ANCHORS";
+
 struct MultiScaleAnchorInfo {
   int32 level;
   std::vector<float> aspect_ratios;
@@ -113,12 +120,60 @@ Anchor CalculateAnchorBox(const int y_center, const int x_center,
   return result;
 }
 
+// The anchors generated for one SsdAnchorsCalculatorOptions, in both layouts.
+struct AnchorPackets {
+  Packet anchors;
+  Packet flat_anchors;
+};
+
+// Memoizes the generated anchors for the process. Anchors depend on nothing
+// but the options, so every graph instance of a model shares one immutable
+// copy instead of generating and holding its own.
+class AnchorCache {
+ public:
+  static AnchorCache& Get() {
+    static AnchorCache* cache = new AnchorCache;
+    return *cache;
+  }
+
+  bool Lookup(const std::string& key, AnchorPackets* packets)
+      ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return false;
+    *packets = it->second;
+    return true;
+  }
+
+  // Returns the anchors cached for `key`, which are `packets` unless another
+  // calculator got there first.
+  AnchorPackets Insert(const std::string& key, AnchorPackets packets)
+      ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
+    // A process runs a handful of detection models, so rather than tracking
+    // recency, start over in the unlikely case the cache fills up. Graphs
+    // keep their anchor packets alive regardless.
+    if (entries_.size() >= kMaxEntries) entries_.clear();
+    return entries_.emplace(key, std::move(packets)).first->second;
+  }
+
+ private:
+  static constexpr int kMaxEntries = 16;
+
+  absl::Mutex mutex_;
+  std::map<std::string, AnchorPackets> entries_ ABSL_GUARDED_BY(mutex_);
+};
+
 }  // namespace
 
 // Generate anchors for SSD object detection model.
+// Anchors are memoized per options for the process, so creating many graphs
+// for one model generates them once and shares them.
 // Output:
 //   ANCHORS: A list of anchors. Model generates predictions based on the
-//   offsets of these anchors.
+//   offsets of these anchors. This is the untagged output side packet.
+//   FLAT_ANCHORS (optional): The same anchors as FlatAnchors, which
+//   TensorsToDetectionsCalculator decodes from without conversion.
 //
 // Usage example:
 // node {
@@ -151,7 +206,14 @@ Anchor CalculateAnchorBox(const int y_center, const int x_center,
 class SsdAnchorsCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
-    cc->OutputSidePackets().Index(0).Set<std::vector<Anchor>>();
+    if (cc->OutputSidePackets().HasTag(kFlatAnchorsTag)) {
+      cc->OutputSidePackets().Tag(kFlatAnchorsTag).Set<FlatAnchors>();
+    }
+    if (cc->OutputSidePackets().NumEntries("") > 0) {
+      cc->OutputSidePackets().Index(0).Set<std::vector<Anchor>>();
+    }
+    RET_CHECK_GT(cc->OutputSidePackets().NumEntries(), 0)
+        << "SsdAnchorsCalculator needs an output side packet.";
     return absl::OkStatus();
   }
 
@@ -161,9 +223,22 @@ class SsdAnchorsCalculator : public CalculatorBase {
     const SsdAnchorsCalculatorOptions& options =
         cc->Options<SsdAnchorsCalculatorOptions>();
 
-    auto anchors = absl::make_unique<std::vector<Anchor>>();
-    MP_RETURN_IF_ERROR(GenerateAnchors(anchors.get(), options));
-    cc->OutputSidePackets().Index(0).Set(Adopt(anchors.release()));
+    const std::string key = options.SerializeAsString();
+    AnchorPackets packets;
+    if (!AnchorCache::Get().Lookup(key, &packets)) {
+      std::vector<Anchor> anchors;
+      MP_RETURN_IF_ERROR(GenerateAnchors(&anchors, options));
+      packets.flat_anchors = MakePacket<FlatAnchors>(FromAnchors(anchors));
+      packets.anchors = MakePacket<std::vector<Anchor>>(std::move(anchors));
+      packets = AnchorCache::Get().Insert(key, std::move(packets));
+    }
+
+    if (cc->OutputSidePackets().HasTag(kFlatAnchorsTag)) {
+      cc->OutputSidePackets().Tag(kFlatAnchorsTag).Set(packets.flat_anchors);
+    }
+    if (cc->OutputSidePackets().NumEntries("") > 0) {
+      cc->OutputSidePackets().Index(0).Set(packets.anchors);
+    }
     return absl::OkStatus();
   }
 
@@ -16,6 +16,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/formats/flat_anchors.h"
 #include "mediapipe/framework/formats/object_detection/anchor.pb.h"
 #include "mediapipe/framework/port/file_helpers.h"
 #include "mediapipe/framework/port/gmock.h"
@@ -183,4 +184,43 @@ TEST(SsdAnchorCalculatorTest, RetinaNetSSDConfig) {
   CompareAnchors(anchors, anchors_golden);
 }
 
+TEST(SsdAnchorCalculatorTest, SharesAnchorsAcrossInstances) {
+  const auto node = ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "SsdAnchorsCalculator"
+    output_side_packet: "anchors"
+    output_side_packet: "FLAT_ANCHORS:flat_anchors"
+    options {
+      [mediapipe.SsdAnchorsCalculatorOptions.ext] {
+        num_layers: 1
+        min_scale: 0.2
+        max_scale: 0.95
+        input_size_height: 32
+        input_size_width: 32
+        anchor_offset_x: 0.5
+        anchor_offset_y: 0.5
+        strides: 8
+        aspect_ratios: 1.0
+        aspect_ratios: 2.0
+      }
+    }
+  )pb");
+  CalculatorRunner runner_1(node);
+  CalculatorRunner runner_2(node);
+  MP_ASSERT_OK(runner_1.Run());
+  MP_ASSERT_OK(runner_2.Run());
+
+  const auto& anchors =
+      runner_1.OutputSidePackets().Index(0).Get<std::vector<Anchor>>();
+  ASSERT_EQ(anchors.size(), 4 * 4 * 2);
+  EXPECT_EQ(&anchors,
+            &runner_2.OutputSidePackets().Index(0).Get<std::vector<Anchor>>());
+
+  const auto& flat_anchors =
+      runner_1.OutputSidePackets().Tag("FLAT_ANCHORS").Get<FlatAnchors>();
+  EXPECT_EQ(
+      &flat_anchors,
+      &runner_2.OutputSidePackets().Tag("FLAT_ANCHORS").Get<FlatAnchors>());
+  CompareAnchors(ToAnchors(flat_anchors), anchors);
+}
+
 }  // namespace mediapipe
@@ -12,7 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "mediapipe/calculators/util/annotation_overlay_calculator.pb.h"
@@ -33,9 +35,11 @@
 
 #if !MEDIAPIPE_DISABLE_GPU
 #include "mediapipe/gpu/gl_calculator_helper.h"
+#include "mediapipe/gpu/gl_quad_renderer.h"
 #include "mediapipe/gpu/gl_simple_shaders.h"
 #include "mediapipe/gpu/gpu_buffer.h"
 #include "mediapipe/gpu/shader_util.h"
+#include "mediapipe/util/annotation_renderer_gl.h"
 #endif  // !MEDIAPIPE_DISABLE_GPU
 
 namespace mediapipe {
@@ -85,7 +89,7 @@ inline bool HasImageTag(mediapipe::CalculatorContext* cc) { return false; }
 // For GPU input frames, only 4-channel images are supported.
 //
 // Note: When using GPU, drawing with color kAnnotationBackgroundColor (defined
-// above) is not supported.
+// above) is not supported, unless gpu_native_rendering is enabled.
 //
 // Example config (CPU):
 // node {
@@ -144,6 +148,11 @@ class AnnotationOverlayCalculator : public CalculatorBase {
                            const ImageFormat::Format& target_format,
                            uchar* data_image);
 
+  // Draws @render_data with AnnotationRendererGl straight into a copy of the
+  // GPU input. Must be called in the GL context.
+  absl::Status RenderNativeGpu(
+      CalculatorContext* cc, const std::vector<const RenderData*>& render_data);
+
   absl::Status GlRender(CalculatorContext* cc);
   template <typename Type, const char* Tag>
   absl::Status GlSetup(CalculatorContext* cc);
@@ -167,6 +176,9 @@ class AnnotationOverlayCalculator : public CalculatorBase {
   int height_ = 0;
   int width_canvas_ = 0;  // Size of overlay drawing texture canvas.
   int height_canvas_ = 0;
+  // Used with gpu_native_rendering.
+  std::unique_ptr<AnnotationRendererGl> gl_renderer_;
+  std::unique_ptr<mediapipe::QuadRenderer> copy_renderer_;
 #endif  // MEDIAPIPE_DISABLE_GPU
 };
 REGISTER_CALCULATOR(AnnotationOverlayCalculator);
@@ -281,6 +293,30 @@ absl::Status AnnotationOverlayCalculator::Process(CalculatorContext* cc) {
     return absl::OkStatus();
   }
 
+  // Collect the streams to render, in order.
+  std::vector<const RenderData*> render_data;
+  for (CollectionItemId id = cc->Inputs().BeginId(); id < cc->Inputs().EndId();
+       ++id) {
+    auto tag_and_index = cc->Inputs().TagAndIndexFromId(id);
+    std::string tag = tag_and_index.first;
+    if (!tag.empty() && tag != kVectorTag) {
+      continue;
+    }
+    if (cc->Inputs().Get(id).IsEmpty()) {
+      continue;
+    }
+    if (tag.empty()) {
+      // Empty tag defaults to accepting a single object of RenderData type.
+      render_data.push_back(&cc->Inputs().Get(id).Get<RenderData>());
+    } else {
+      RET_CHECK_EQ(kVectorTag, tag);
+      for (const RenderData& item :
+           cc->Inputs().Get(id).Get<std::vector<RenderData>>()) {
+        render_data.push_back(&item);
+      }
+    }
+  }
+
   // Initialize render target, drawn with OpenCV.
   std::unique_ptr<cv::Mat> image_mat;
   ImageFormat::Format target_format;
@@ -293,6 +329,17 @@ absl::Status AnnotationOverlayCalculator::Process(CalculatorContext* cc) {
           }));
       gpu_initialized_ = true;
     }
+    if (options_.gpu_native_rendering() &&
+        cc->Inputs().HasTag(kGpuBufferTag) &&
+        std::all_of(render_data.begin(), render_data.end(),
+                    [](const RenderData* data) {
+                      return AnnotationRendererGl::CanRender(*data);
+                    })) {
+      return gpu_helper_.RunInGlContext(
+          [this, cc, &render_data]() -> absl::Status {
+            return RenderNativeGpu(cc, render_data);
+          });
+    }
     if (cc->Inputs().HasTag(kGpuBufferTag)) {
       MP_RETURN_IF_ERROR(
           (CreateRenderTargetGpu<mediapipe::GpuBuffer, kGpuBufferTag>(
@@ -309,28 +356,8 @@ absl::Status AnnotationOverlayCalculator::Process(CalculatorContext* cc) {
   renderer_->AdoptImage(image_mat.get());
 
   // Render streams onto render target.
-  for (CollectionItemId id = cc->Inputs().BeginId(); id < cc->Inputs().EndId();
-       ++id) {
-    auto tag_and_index = cc->Inputs().TagAndIndexFromId(id);
-    std::string tag = tag_and_index.first;
-    if (!tag.empty() && tag != kVectorTag) {
-      continue;
-    }
-    if (cc->Inputs().Get(id).IsEmpty()) {
-      continue;
-    }
-    if (tag.empty()) {
-      // Empty tag defaults to accepting a single object of RenderData type.
-      const RenderData& render_data = cc->Inputs().Get(id).Get<RenderData>();
-      renderer_->RenderDataOnImage(render_data);
-    } else {
-      RET_CHECK_EQ(kVectorTag, tag);
-      const std::vector<RenderData>& render_data_vec =
-          cc->Inputs().Get(id).Get<std::vector<RenderData>>();
-      for (const RenderData& render_data : render_data_vec) {
-        renderer_->RenderDataOnImage(render_data);
-      }
-    }
+  for (const RenderData* data : render_data) {
+    renderer_->RenderDataOnImage(*data);
   }
 
   if (use_gpu_) {
@@ -359,6 +386,10 @@ absl::Status AnnotationOverlayCalculator::Close(CalculatorContext* cc) {
     program_ = 0;
     if (image_mat_tex_) glDeleteTextures(1, &image_mat_tex_);
     image_mat_tex_ = 0;
+    if (gl_renderer_) gl_renderer_->GlTeardown();
+    gl_renderer_.reset();
+    if (copy_renderer_) copy_renderer_->GlTeardown();
+    copy_renderer_.reset();
   });
 #endif  // !MEDIAPIPE_DISABLE_GPU
 
@@ -439,6 +470,50 @@ absl::Status AnnotationOverlayCalculator::RenderToGpu(CalculatorContext* cc,
   return absl::OkStatus();
 }
 
+absl::Status AnnotationOverlayCalculator::RenderNativeGpu(
+    CalculatorContext* cc, const std::vector<const RenderData*>& render_data) {
+#if !MEDIAPIPE_DISABLE_GPU
+  if (!gl_renderer_) {
+    gl_renderer_ = absl::make_unique<AnnotationRendererGl>();
+    MP_RETURN_IF_ERROR(gl_renderer_->GlSetup());
+    gl_renderer_->SetFlipVertically(!options_.gpu_uses_top_left_origin());
+    copy_renderer_ = absl::make_unique<mediapipe::QuadRenderer>();
+    MP_RETURN_IF_ERROR(copy_renderer_->GlSetup());
+  }
+
+  const auto& input_frame =
+      cc->Inputs().Tag(kGpuBufferTag).Get<mediapipe::GpuBuffer>();
+  auto input_texture = gpu_helper_.CreateSourceTexture(input_frame);
+  auto output_texture = gpu_helper_.CreateDestinationTexture(
+      width_, height_, mediapipe::GpuBufferFormat::kBGRA32);
+  gpu_helper_.BindFramebuffer(output_texture);
+
+  // Copy the input, then draw all annotations on top of it.
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(input_texture.target(), input_texture.name());
+  MP_RETURN_IF_ERROR(copy_renderer_->GlRender(
+      input_texture.width(), input_texture.height(), width_, height_,
+      mediapipe::FrameScaleMode::kStretch, mediapipe::FrameRotation::kNone,
+      /*flip_horizontal=*/false, /*flip_vertical=*/false,
+      /*flip_texture=*/false));
+  glBindTexture(input_texture.target(), 0);
+
+  gl_renderer_->Reset(width_, height_);
+  for (const RenderData* data : render_data) {
+    gl_renderer_->AddRenderData(*data);
+  }
+  gl_renderer_->GlRender();
+  glFlush();
+
+  auto output_frame = output_texture.GetFrame<mediapipe::GpuBuffer>();
+  cc->Outputs()
+      .Tag(kGpuBufferTag)
+      .Add(output_frame.release(), cc->InputTimestamp());
+#endif  // !MEDIAPIPE_DISABLE_GPU
+
+  return absl::OkStatus();
+}
+
 absl::Status AnnotationOverlayCalculator::CreateRenderTargetCpu(
     CalculatorContext* cc, std::unique_ptr<cv::Mat>& image_mat,
     ImageFormat::Format* target_format) {
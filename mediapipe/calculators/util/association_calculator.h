@@ -15,9 +15,13 @@
 #ifndef MEDIAPIPE_CALCULATORS_UTIL_ASSOCIATION_CALCULATOR_H_
 #define MEDIAPIPE_CALCULATORS_UTIL_ASSOCIATION_CALCULATOR_H_
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "mediapipe/calculators/util/association_calculator.pb.h"
 #include "mediapipe/framework/calculator_context.h"
@@ -78,11 +82,8 @@ class AssociationCalculator : public CalculatorBase {
   }
 
   absl::Status Process(CalculatorContext* cc) override {
-    auto get_non_overlapping_elements = GetNonOverlappingElements(cc);
-    if (!get_non_overlapping_elements.ok()) {
-      return get_non_overlapping_elements.status();
-    }
-    std::list<T> result = get_non_overlapping_elements.value();
+    std::vector<Entry> entries;
+    MP_RETURN_IF_ERROR(GetNonOverlappingElements(cc, &entries));
 
     if (has_prev_input_stream_ &&
         !cc->Inputs().Get(prev_input_stream_id_).IsEmpty()) {
@@ -95,12 +96,14 @@ class AssociationCalculator : public CalculatorBase {
               .template Get<std::vector<T>>();
 
       MP_RETURN_IF_ERROR(
-          PropagateIdsFromPreviousToCurrent(prev_input_vec, &result));
+          PropagateIdsFromPreviousToCurrent(prev_input_vec, &entries));
     }
 
     auto output = absl::make_unique<std::vector<T>>();
-    for (auto it = result.begin(); it != result.end(); ++it) {
-      output->push_back(*it);
+    for (Entry& entry : entries) {
+      if (!entry.removed) {
+        output->push_back(std::move(entry.element));
+      }
     }
     cc->Outputs().Index(0).Add(output.release(), cc->InputTimestamp());
 
@@ -122,107 +125,196 @@ class AssociationCalculator : public CalculatorBase {
   virtual void SetId(T* input, int id) {}
 
  private:
-  // Get a list of non-overlapping elements from all input streams, with
-  // increasing order of priority based on input stream index.
-  absl::StatusOr<std::list<T>> GetNonOverlappingElements(
-      CalculatorContext* cc) {
-    std::list<T> result;
-
-    // Initialize result with the first non-empty input vector.
-    CollectionItemId non_empty_id = cc->Inputs().BeginId();
-    for (CollectionItemId id = cc->Inputs().BeginId();
-         id < cc->Inputs().EndId(); ++id) {
-      if (id == prev_input_stream_id_ || cc->Inputs().Get(id).IsEmpty()) {
-        continue;
+  // An element of the result, in insertion order. Elements that are replaced
+  // by a later overlapping element are only marked as removed, so that the
+  // surviving elements keep the order they would have in a list where
+  // replaced elements are erased and new ones appended.
+  struct Entry {
+    T element;
+    Rectangle_f rect;
+    bool removed = false;
+  };
+
+  // Uniform grid over rectangles. Since min_similarity_threshold is
+  // non-negative, two rectangles can only be associated if their
+  // intersection has a positive area, and hence if they share a grid cell.
+  // This keeps the association close to linear in the number of elements
+  // instead of comparing every pair.
+  class SpatialIndex {
+   public:
+    // Rectangles spanning more cells than this are kept in a separate list
+    // that every query visits, so that a few large rectangles don't blow up
+    // the grid.
+    static constexpr float kMaxCellsPerRect = 16.0f;
+
+    explicit SpatialIndex(float cell_size) : cell_size_(cell_size) {}
+
+    void Insert(const Rectangle_f& rect, int index) {
+      int x0, y0, x1, y1;
+      if (!GetCellRange(rect, &x0, &y0, &x1, &y1)) {
+        oversized_.push_back(index);
+        return;
       }
-      const std::vector<T>& input_vec =
-          cc->Inputs().Get(id).Get<std::vector<T>>();
-      if (!input_vec.empty()) {
-        non_empty_id = id;
-        result.push_back(input_vec[0]);
-        for (int j = 1; j < input_vec.size(); ++j) {
-          MP_RETURN_IF_ERROR(AddElementToList(input_vec[j], &result));
+      for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+          cells_[std::make_pair(x, y)].push_back(index);
         }
-        break;
       }
     }
 
-    // Compare remaining input vectors with the non-empty result vector,
-    // remove lower-priority overlapping elements from the result vector and
-    // had corresponding higher-priority elements as necessary.
-    for (CollectionItemId id = non_empty_id + 1; id < cc->Inputs().EndId();
-         ++id) {
-      if (id == prev_input_stream_id_ || cc->Inputs().Get(id).IsEmpty()) {
-        continue;
+    // Returns the indices of all inserted rectangles that may intersect
+    // `rect`, in increasing order and without duplicates.
+    const std::vector<int>& Query(const Rectangle_f& rect) {
+      candidates_.clear();
+      int x0, y0, x1, y1;
+      if (!GetCellRange(rect, &x0, &y0, &x1, &y1)) {
+        for (const auto& cell : cells_) {
+          candidates_.insert(candidates_.end(), cell.second.begin(),
+                             cell.second.end());
+        }
+      } else {
+        for (int y = y0; y <= y1; ++y) {
+          for (int x = x0; x <= x1; ++x) {
+            auto it = cells_.find(std::make_pair(x, y));
+            if (it != cells_.end()) {
+              candidates_.insert(candidates_.end(), it->second.begin(),
+                                 it->second.end());
+            }
+          }
+        }
       }
-      const std::vector<T>& input_vec =
-          cc->Inputs().Get(id).Get<std::vector<T>>();
+      candidates_.insert(candidates_.end(), oversized_.begin(),
+                         oversized_.end());
+      std::sort(candidates_.begin(), candidates_.end());
+      candidates_.erase(std::unique(candidates_.begin(), candidates_.end()),
+                        candidates_.end());
+      return candidates_;
+    }
 
-      for (int vi = 0; vi < input_vec.size(); ++vi) {
-        MP_RETURN_IF_ERROR(AddElementToList(input_vec[vi], &result));
+   private:
+    bool GetCellRange(const Rectangle_f& rect, int* x0, int* y0, int* x1,
+                      int* y1) const {
+      const float fx0 = std::floor(rect.xmin() / cell_size_);
+      const float fy0 = std::floor(rect.ymin() / cell_size_);
+      const float fx1 = std::floor(rect.xmax() / cell_size_);
+      const float fy1 = std::floor(rect.ymax() / cell_size_);
+      // Also rejects NaNs and coordinates too far out to be cast to int.
+      if (!((fx1 - fx0 + 1.0f) * (fy1 - fy0 + 1.0f) <= kMaxCellsPerRect) ||
+          !(std::abs(fx0) < 1e6f && std::abs(fy0) < 1e6f)) {
+        return false;
       }
+      *x0 = static_cast<int>(fx0);
+      *y0 = static_cast<int>(fy0);
+      *x1 = static_cast<int>(fx1);
+      *y1 = static_cast<int>(fy1);
+      return true;
     }
 
-    return result;
+    const float cell_size_;
+    absl::flat_hash_map<std::pair<int, int>, std::vector<int>> cells_;
+    std::vector<int> oversized_;
+    std::vector<int> candidates_;
+  };
+
+  // Picks the grid cell size from the mean extent of the given rectangles,
+  // so that a typical rectangle covers about four cells.
+  static float GetCellSize(const std::vector<Entry>& entries) {
+    double extent_sum = 0.0;
+    int count = 0;
+    for (const Entry& entry : entries) {
+      const float extent =
+          std::max(entry.rect.Width(), entry.rect.Height());
+      if (std::isfinite(extent)) {
+        extent_sum += extent;
+        ++count;
+      }
+    }
+    const float mean_extent = count > 0 ? extent_sum / count : 0.0f;
+    return mean_extent > 1e-6f ? mean_extent : 1.0f;
   }
 
-  absl::Status AddElementToList(T element, std::list<T>* current) {
+  // Get a list of non-overlapping elements from all input streams, with
+  // increasing order of priority based on input stream index.
+  absl::Status GetNonOverlappingElements(CalculatorContext* cc,
+                                         std::vector<Entry>* result) {
+    std::vector<Entry> inputs;
+    for (CollectionItemId id = cc->Inputs().BeginId();
+         id < cc->Inputs().EndId(); ++id) {
+      if (has_prev_input_stream_ && id == prev_input_stream_id_) continue;
+      if (cc->Inputs().Get(id).IsEmpty()) continue;
+      const std::vector<T>& input_vec =
+          cc->Inputs().Get(id).template Get<std::vector<T>>();
+      for (const T& element : input_vec) {
+        ASSIGN_OR_RETURN(Rectangle_f rect, GetRectangle(element));
+        inputs.push_back({element, rect});
+      }
+    }
+
+    // Add the elements in increasing order of priority. Each element
+    // replaces the overlapping elements added before it.
+    SpatialIndex index(GetCellSize(inputs));
+    result->reserve(inputs.size());
+    for (Entry& input : inputs) {
+      AddElementToList(std::move(input), &index, result);
+    }
+    return absl::OkStatus();
+  }
+
+  void AddElementToList(Entry entry, SpatialIndex* index,
+                        std::vector<Entry>* current) {
     // Compare this element with elements of the input collection. If this
     // element has high overlap with elements of the collection, remove
     // those elements from the collection and add this element.
-    ASSIGN_OR_RETURN(auto cur_rect, GetRectangle(element));
-
     bool change_id = false;
     int new_elem_id = -1;
 
-    for (auto uit = current->begin(); uit != current->end();) {
-      ASSIGN_OR_RETURN(auto prev_rect, GetRectangle(*uit));
-      if (CalculateIou(cur_rect, prev_rect) >
+    for (int ci : index->Query(entry.rect)) {
+      Entry& prev = (*current)[ci];
+      if (prev.removed) continue;
+      if (CalculateIou(entry.rect, prev.rect) >
           options_.min_similarity_threshold()) {
-        std::pair<bool, int> prev_id = GetId(*uit);
+        std::pair<bool, int> prev_id = GetId(prev.element);
         // If prev_id.first is false when some element doesn't have an ID,
         // change_id and new_elem_id will not be updated.
         if (prev_id.first) {
           change_id = prev_id.first;
           new_elem_id = prev_id.second;
         }
-        uit = current->erase(uit);
-      } else {
-        ++uit;
+        prev.removed = true;
       }
     }
 
     if (change_id) {
-      SetId(&element, new_elem_id);
+      SetId(&entry.element, new_elem_id);
     }
-    current->push_back(element);
-
-    return absl::OkStatus();
+    index->Insert(entry.rect, current->size());
+    current->push_back(std::move(entry));
   }
 
   // Compare elements of the current list with elements in from the collection
   // of elements from the previous input stream, and propagate IDs from the
   // previous input stream as appropriate.
   absl::Status PropagateIdsFromPreviousToCurrent(
-      const std::vector<T>& prev_input_vec, std::list<T>* current) {
-    for (auto vit = current->begin(); vit != current->end(); ++vit) {
-      auto get_cur_rectangle = GetRectangle(*vit);
-      if (!get_cur_rectangle.ok()) {
-        return get_cur_rectangle.status();
-      }
-      const Rectangle_f& cur_rect = get_cur_rectangle.value();
+      const std::vector<T>& prev_input_vec, std::vector<Entry>* current) {
+    // Elements of the previous timestamp are expected to have about the same
+    // size as the current ones, so the grid of the current ones is reused.
+    SpatialIndex index(GetCellSize(*current));
+    std::vector<Rectangle_f> prev_rects;
+    prev_rects.reserve(prev_input_vec.size());
+    for (int ui = 0; ui < prev_input_vec.size(); ++ui) {
+      ASSIGN_OR_RETURN(Rectangle_f rect, GetRectangle(prev_input_vec[ui]));
+      index.Insert(rect, ui);
+      prev_rects.push_back(rect);
+    }
+
+    for (Entry& entry : *current) {
+      if (entry.removed) continue;
 
       bool change_id = false;
       int id_for_vi = -1;
 
-      for (int ui = 0; ui < prev_input_vec.size(); ++ui) {
-        auto get_prev_rectangle = GetRectangle(prev_input_vec[ui]);
-        if (!get_prev_rectangle.ok()) {
-          return get_prev_rectangle.status();
-        }
-        const Rectangle_f& prev_rect = get_prev_rectangle.value();
-
-        if (CalculateIou(cur_rect, prev_rect) >
+      for (int ui : index.Query(entry.rect)) {
+        if (CalculateIou(entry.rect, prev_rects[ui]) >
             options_.min_similarity_threshold()) {
           std::pair<bool, int> prev_id = GetId(prev_input_vec[ui]);
           // If prev_id.first is false when some element doesn't have an ID,
@@ -235,9 +327,7 @@ class AssociationCalculator : public CalculatorBase {
       }
 
       if (change_id) {
-        T element = *vit;
-        SetId(&element, id_for_vi);
-        *vit = element;
+        SetId(&entry.element, id_for_vi);
       }
     }
     return absl::OkStatus();
@@ -12,6 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <list>
+#include <random>
+#include <vector>
+
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
@@ -23,7 +27,9 @@
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/rectangle.h"
 #include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/util/rectangle_util.h"
 
 namespace mediapipe {
 
@@ -274,6 +280,105 @@ TEST_F(AssociationDetectionCalculatorTest, DetectionAssocTestReverse) {
   EXPECT_THAT(assoc_rects[2], EqualsProto(det_2));
 }
 
+namespace {
+
+// Reference implementation comparing every pair of detections.
+std::vector<::mediapipe::Detection> AssociateDetectionsBruteForce(
+    const std::vector<std::vector<::mediapipe::Detection>>& inputs,
+    const std::vector<::mediapipe::Detection>& prev, float threshold) {
+  auto get_rect = [](const ::mediapipe::Detection& detection) {
+    const auto& box = detection.location_data().relative_bounding_box();
+    return Rectangle_f(box.xmin(), box.ymin(), box.width(), box.height());
+  };
+  std::list<::mediapipe::Detection> result;
+  for (const auto& input : inputs) {
+    for (::mediapipe::Detection detection : input) {
+      for (auto it = result.begin(); it != result.end();) {
+        if (CalculateIou(get_rect(detection), get_rect(*it)) > threshold) {
+          if (it->has_detection_id()) {
+            detection.set_detection_id(it->detection_id());
+          }
+          it = result.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      result.push_back(detection);
+    }
+  }
+  for (auto& detection : result) {
+    for (const auto& prev_detection : prev) {
+      if (CalculateIou(get_rect(detection), get_rect(prev_detection)) >
+              threshold &&
+          prev_detection.has_detection_id()) {
+        detection.set_detection_id(prev_detection.detection_id());
+      }
+    }
+  }
+  return {result.begin(), result.end()};
+}
+
+}  // namespace
+
+TEST_F(AssociationDetectionCalculatorTest, MatchesBruteForceAssociation) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "AssociationDetectionCalculator"
+    input_stream: "PREV:prev_vec"
+    input_stream: "input_vec_0"
+    input_stream: "input_vec_1"
+    input_stream: "input_vec_2"
+    output_stream: "output_vec"
+    options {
+      [mediapipe.AssociationCalculatorOptions.ext] {
+        min_similarity_threshold: 0.1
+      }
+    }
+  )pb"));
+
+  std::mt19937 rng(/*seed=*/7);
+  std::uniform_real_distribution<float> position(-0.2f, 1.0f);
+  std::uniform_real_distribution<float> size(0.01f, 0.2f);
+  int next_id = 0;
+  auto random_detections = [&](int count) {
+    std::vector<::mediapipe::Detection> detections;
+    for (int i = 0; i < count; ++i) {
+      // Every tenth detection is large, every third has no ID.
+      const float scale = i % 10 == 0 ? 5.0f : 1.0f;
+      detections.push_back(DetectionWithRelativeLocationData(
+          position(rng), position(rng), scale * size(rng),
+          scale * size(rng)));
+      if (i % 3 != 0) detections.back().set_detection_id(next_id++);
+    }
+    return detections;
+  };
+
+  const std::vector<::mediapipe::Detection> prev = random_detections(100);
+  std::vector<std::vector<::mediapipe::Detection>> inputs;
+  for (int i = 0; i < 3; ++i) inputs.push_back(random_detections(200));
+
+  runner.MutableInputs()
+      ->Get("PREV", 0)
+      .packets.push_back(MakePacket<std::vector<::mediapipe::Detection>>(prev)
+                             .At(Timestamp(1)));
+  for (int i = 0; i < inputs.size(); ++i) {
+    runner.MutableInputs()->Get("", i).packets.push_back(
+        MakePacket<std::vector<::mediapipe::Detection>>(inputs[i])
+            .At(Timestamp(1)));
+  }
+
+  MP_ASSERT_OK(runner.Run()) << "Calculator execution failed.";
+  const std::vector<Packet>& output = runner.Outputs().Index(0).packets;
+  ASSERT_EQ(1, output.size());
+  const auto& assoc_detections =
+      output[0].Get<std::vector<::mediapipe::Detection>>();
+  const std::vector<::mediapipe::Detection> expected =
+      AssociateDetectionsBruteForce(inputs, prev, /*threshold=*/0.1f);
+  ASSERT_EQ(expected.size(), assoc_detections.size());
+  for (int i = 0; i < expected.size(); ++i) {
+    EXPECT_THAT(assoc_detections[i], EqualsProto(expected[i]));
+  }
+}
+
 class AssociationNormRectCalculatorTest : public ::testing::Test {
  protected:
   AssociationNormRectCalculatorTest() {
@@ -31,6 +31,7 @@
 
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/flat_detections.h"
 #include "mediapipe/framework/formats/location.h"
 #include "mediapipe/framework/port/ret_check.h"
 
@@ -39,6 +40,7 @@ namespace mediapipe {
 namespace {
 
 constexpr char kDetectionsTag[] = "DETECTIONS";
+constexpr char kFlatDetectionsTag[] = "FLAT_DETECTIONS";
 constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 
 }  // namespace
@@ -53,6 +55,9 @@ constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 //   DETECTIONS: An std::vector<Detection> representing detections on an
 //   letterboxed image.
 //
+//   FLAT_DETECTIONS: FlatDetections on a letterboxed image. Use instead of
+//   DETECTIONS.
+//
 //   LETTERBOX_PADDING: An std::array<float, 4> representing the letterbox
 //   padding from the 4 sides ([left, top, right, bottom]) of the letterboxed
 //   image, normalized to [0.f, 1.f] by the letterboxed image dimensions.
@@ -61,6 +66,9 @@ constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 //   DETECTIONS: An std::vector<Detection> representing detections with their
 //   locations adjusted to the letterbox-removed (non-padded) image.
 //
+//   FLAT_DETECTIONS: FlatDetections with their locations adjusted to the
+//   letterbox-removed image. Produced when the input is FLAT_DETECTIONS.
+//
 // Usage example:
 // node {
 //   calculator: "DetectionLetterboxRemovalCalculator"
@@ -71,15 +79,20 @@ constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 class DetectionLetterboxRemovalCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
-    RET_CHECK(cc->Inputs().HasTag(kDetectionsTag) &&
+    RET_CHECK((cc->Inputs().HasTag(kDetectionsTag) ^
+               cc->Inputs().HasTag(kFlatDetectionsTag)) &&
               cc->Inputs().HasTag(kLetterboxPaddingTag))
         << "Missing one or more input streams.";
 
-    cc->Inputs().Tag(kDetectionsTag).Set<std::vector<Detection>>();
+    if (cc->Inputs().HasTag(kDetectionsTag)) {
+      cc->Inputs().Tag(kDetectionsTag).Set<std::vector<Detection>>();
+      cc->Outputs().Tag(kDetectionsTag).Set<std::vector<Detection>>();
+    } else {
+      cc->Inputs().Tag(kFlatDetectionsTag).Set<FlatDetections>();
+      cc->Outputs().Tag(kFlatDetectionsTag).Set<FlatDetections>();
+    }
     cc->Inputs().Tag(kLetterboxPaddingTag).Set<std::array<float, 4>>();
 
-    cc->Outputs().Tag(kDetectionsTag).Set<std::vector<Detection>>();
-
     return absl::OkStatus();
   }
 
@@ -90,6 +103,9 @@ class DetectionLetterboxRemovalCalculator : public CalculatorBase {
   }
 
   absl::Status Process(CalculatorContext* cc) override {
+    if (cc->Inputs().HasTag(kFlatDetectionsTag)) {
+      return ProcessFlat(cc);
+    }
     // Only process if there's input detections.
     if (cc->Inputs().Tag(kDetectionsTag).IsEmpty()) {
       return absl::OkStatus();
@@ -148,6 +164,41 @@ class DetectionLetterboxRemovalCalculator : public CalculatorBase {
         .Add(output_detections.release(), cc->InputTimestamp());
     return absl::OkStatus();
   }
+
+ private:
+  absl::Status ProcessFlat(CalculatorContext* cc) {
+    if (cc->Inputs().Tag(kFlatDetectionsTag).IsEmpty()) {
+      return absl::OkStatus();
+    }
+    const auto& letterbox_padding =
+        cc->Inputs().Tag(kLetterboxPaddingTag).Get<std::array<float, 4>>();
+    const float left = letterbox_padding[0];
+    const float top = letterbox_padding[1];
+    const float x_scale =
+        1.0f / (1.0f - letterbox_padding[0] - letterbox_padding[2]);
+    const float y_scale =
+        1.0f / (1.0f - letterbox_padding[1] - letterbox_padding[3]);
+
+    auto output_detections = absl::make_unique<FlatDetections>(
+        cc->Inputs().Tag(kFlatDetectionsTag).Get<FlatDetections>());
+    for (int i = 0; i < output_detections->size(); ++i) {
+      float* box = output_detections->mutable_box(i);
+      box[0] = (box[0] - left) * x_scale;
+      box[1] = (box[1] - top) * y_scale;
+      box[2] *= x_scale;
+      box[3] *= y_scale;
+      float* keypoints = output_detections->mutable_keypoints(i);
+      for (int k = 0; k < output_detections->num_keypoints(); ++k) {
+        keypoints[k * 2] = (keypoints[k * 2] - left) * x_scale;
+        keypoints[k * 2 + 1] = (keypoints[k * 2 + 1] - top) * y_scale;
+      }
+    }
+
+    cc->Outputs()
+        .Tag(kFlatDetectionsTag)
+        .Add(output_detections.release(), cc->InputTimestamp());
+    return absl::OkStatus();
+  }
 };
 REGISTER_CALCULATOR(DetectionLetterboxRemovalCalculator);
 
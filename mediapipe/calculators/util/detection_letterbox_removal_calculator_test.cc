@@ -15,6 +15,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/flat_detections.h"
 #include "mediapipe/framework/formats/location.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
@@ -27,6 +28,7 @@ namespace mediapipe {
 
 constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 constexpr char kDetectionsTag[] = "DETECTIONS";
+constexpr char kFlatDetectionsTag[] = "FLAT_DETECTIONS";
 
 LocationData CreateRelativeLocationData(double xmin, double ymin, double width,
                                         double height) {
@@ -158,4 +160,45 @@ TEST(DetectionLetterboxRemovalCalculatorTest, PaddingTopBottom) {
               testing::FloatNear(0.5f, 1e-5));
 }
 
+TEST(DetectionLetterboxRemovalCalculatorTest, FlatDetections) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "DetectionLetterboxRemovalCalculator"
+    input_stream: "FLAT_DETECTIONS:detections"
+    input_stream: "LETTERBOX_PADDING:letterbox_padding"
+    output_stream: "FLAT_DETECTIONS:adjusted_detections"
+  )pb"));
+
+  auto detections = absl::make_unique<FlatDetections>(/*num_keypoints=*/1);
+  const float keypoint[] = {0.5f, 0.5f};
+  detections->Add(0.25f, 0.25f, 0.25f, 0.25f, 0.3f, 2, keypoint);
+  runner.MutableInputs()
+      ->Tag(kFlatDetectionsTag)
+      .packets.push_back(
+          Adopt(detections.release()).At(Timestamp::PostStream()));
+
+  auto padding = absl::make_unique<std::array<float, 4>>(
+      std::array<float, 4>{0.2f, 0.f, 0.3f, 0.f});
+  runner.MutableInputs()
+      ->Tag(kLetterboxPaddingTag)
+      .packets.push_back(Adopt(padding.release()).At(Timestamp::PostStream()));
+
+  MP_ASSERT_OK(runner.Run()) << "Calculator execution failed.";
+  const std::vector<Packet>& output =
+      runner.Outputs().Tag(kFlatDetectionsTag).packets;
+  ASSERT_EQ(1, output.size());
+  const auto& output_detections = output[0].Get<FlatDetections>();
+
+  ASSERT_EQ(output_detections.size(), 1);
+  EXPECT_EQ(output_detections.class_id(0), 2);
+  EXPECT_EQ(output_detections.score(0), 0.3f);
+  EXPECT_THAT(output_detections.xmin(0), testing::FloatNear(0.1f, 1e-5));
+  EXPECT_THAT(output_detections.ymin(0), testing::FloatNear(0.25f, 1e-5));
+  EXPECT_THAT(output_detections.width(0), testing::FloatNear(0.5f, 1e-5));
+  EXPECT_THAT(output_detections.height(0), testing::FloatNear(0.25f, 1e-5));
+  EXPECT_THAT(output_detections.keypoints(0)[0],
+              testing::FloatNear(0.6f, 1e-5));
+  EXPECT_THAT(output_detections.keypoints(0)[1],
+              testing::FloatNear(0.5f, 1e-5));
+}
+
 }  // namespace mediapipe
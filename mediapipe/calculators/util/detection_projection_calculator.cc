@@ -18,8 +18,10 @@
 #include <limits>
 #include <vector>
 
+#include "absl/memory/memory.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/flat_detections.h"
 #include "mediapipe/framework/formats/location.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/point2.h"
@@ -34,6 +36,9 @@ namespace mediapipe {
 // Input:
 //   DETECTIONS - std::vector<Detection>
 //     Detections to project using the provided projection matrix.
+//   FLAT_DETECTIONS - FlatDetections
+//     Detections to project, instead of or in addition to DETECTIONS. All their
+//     boxes and keypoints are projected in a single pass over their arrays.
 //   PROJECTION_MATRIX - std::array<float, 16>
 //     A 4x4 row-major-order matrix that maps data from one coordinate system to
 //     another.
@@ -41,6 +46,8 @@ namespace mediapipe {
 // Output:
 //   DETECTIONS - std::vector<Detection>
 //     Projected detections.
+//   FLAT_DETECTIONS - FlatDetections
+//     Projected detections. One for every FLAT_DETECTIONS input.
 //
 // Example:
 //   node {
@@ -60,6 +67,7 @@ REGISTER_CALCULATOR(DetectionProjectionCalculator);
 namespace {
 
 constexpr char kDetections[] = "DETECTIONS";
+constexpr char kFlatDetections[] = "FLAT_DETECTIONS";
 constexpr char kProjectionMatrix[] = "PROJECTION_MATRIX";
 
 absl::Status ProjectDetection(
@@ -110,28 +118,91 @@ absl::Status ProjectDetection(
   return absl::OkStatus();
 }
 
+// Same as ProjectDetection for all |detections|, but on their contiguous box
+// and keypoint arrays, in loops the compiler can vectorize.
+void ProjectFlatDetections(const std::array<float, 16>& project_mat,
+                           FlatDetections* detections) {
+  if (detections->empty()) {
+    return;
+  }
+  const float m0 = project_mat[0];
+  const float m1 = project_mat[1];
+  const float m3 = project_mat[3];
+  const float m4 = project_mat[4];
+  const float m5 = project_mat[5];
+  const float m7 = project_mat[7];
+
+  // Project keypoints.
+  float* keypoints = detections->mutable_keypoints(0);
+  const int num_keypoints = detections->size() * detections->num_keypoints();
+  for (int i = 0; i < num_keypoints; ++i) {
+    const float x = keypoints[2 * i];
+    const float y = keypoints[2 * i + 1];
+    keypoints[2 * i] = x * m0 + y * m1 + m3;
+    keypoints[2 * i + 1] = x * m4 + y * m5 + m7;
+  }
+
+  // Project bounding boxes to the boxes encompassing their projected corners.
+  float* boxes = detections->mutable_box(0);
+  for (int i = 0; i < detections->size(); ++i) {
+    float* box = boxes + i * FlatDetections::kBoxSize;
+    const float xmin = box[0];
+    const float ymin = box[1];
+    const float xmax = xmin + box[2];
+    const float ymax = ymin + box[3];
+    const float x0 = xmin * m0 + ymin * m1 + m3;
+    const float y0 = xmin * m4 + ymin * m5 + m7;
+    const float x1 = xmax * m0 + ymin * m1 + m3;
+    const float y1 = xmax * m4 + ymin * m5 + m7;
+    const float x2 = xmax * m0 + ymax * m1 + m3;
+    const float y2 = xmax * m4 + ymax * m5 + m7;
+    const float x3 = xmin * m0 + ymax * m1 + m3;
+    const float y3 = xmin * m4 + ymax * m5 + m7;
+    const float left = std::min(std::min(x0, x1), std::min(x2, x3));
+    const float top = std::min(std::min(y0, y1), std::min(y2, y3));
+    const float right = std::max(std::max(x0, x1), std::max(x2, x3));
+    const float bottom = std::max(std::max(y0, y1), std::max(y2, y3));
+    box[0] = left;
+    box[1] = top;
+    box[2] = right - left;
+    box[3] = bottom - top;
+  }
+}
+
 }  // namespace
 
 absl::Status DetectionProjectionCalculator::GetContract(
     CalculatorContract* cc) {
-  RET_CHECK(cc->Inputs().HasTag(kDetections) &&
+  RET_CHECK((cc->Inputs().HasTag(kDetections) ||
+             cc->Inputs().HasTag(kFlatDetections)) &&
             cc->Inputs().HasTag(kProjectionMatrix))
       << "Missing one or more input streams.";
 
   RET_CHECK_EQ(cc->Inputs().NumEntries(kDetections),
                cc->Outputs().NumEntries(kDetections))
       << "Same number of DETECTIONS input and output is required.";
+  RET_CHECK_EQ(cc->Inputs().NumEntries(kFlatDetections),
+               cc->Outputs().NumEntries(kFlatDetections))
+      << "Same number of FLAT_DETECTIONS input and output is required.";
 
   for (CollectionItemId id = cc->Inputs().BeginId(kDetections);
        id != cc->Inputs().EndId(kDetections); ++id) {
     cc->Inputs().Get(id).Set<std::vector<Detection>>();
   }
+  for (CollectionItemId id = cc->Inputs().BeginId(kFlatDetections);
+       id != cc->Inputs().EndId(kFlatDetections); ++id) {
+    cc->Inputs().Get(id).Set<FlatDetections>();
+  }
   cc->Inputs().Tag(kProjectionMatrix).Set<std::array<float, 16>>();
 
   for (CollectionItemId id = cc->Outputs().BeginId(kDetections);
        id != cc->Outputs().EndId(kDetections); ++id) {
     cc->Outputs().Get(id).Set<std::vector<Detection>>();
   }
+  for (CollectionItemId id = cc->Outputs().BeginId(kFlatDetections);
+       id != cc->Outputs().EndId(kFlatDetections); ++id) {
+    cc->Outputs().Get(id).Set<FlatDetections>();
+  }
 
   return absl::OkStatus();
 }
@@ -172,6 +243,21 @@ absl::Status DetectionProjectionCalculator::Process(CalculatorContext* cc) {
         MakePacket<std::vector<Detection>>(std::move(output_detections))
             .At(cc->InputTimestamp()));
   }
+
+  input_id = cc->Inputs().BeginId(kFlatDetections);
+  output_id = cc->Outputs().BeginId(kFlatDetections);
+  for (; input_id != cc->Inputs().EndId(kFlatDetections);
+       ++input_id, ++output_id) {
+    const auto& input_packet = cc->Inputs().Get(input_id);
+    if (input_packet.IsEmpty()) {
+      continue;
+    }
+    auto output_detections =
+        absl::make_unique<FlatDetections>(input_packet.Get<FlatDetections>());
+    ProjectFlatDetections(project_mat, output_detections.get());
+    cc->Outputs().Get(output_id).Add(output_detections.release(),
+                                     cc->InputTimestamp());
+  }
   return absl::OkStatus();
 }
 
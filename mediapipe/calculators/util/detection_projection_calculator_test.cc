@@ -20,6 +20,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/flat_detections.h"
 #include "mediapipe/framework/formats/location.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/gmock.h"
@@ -33,6 +34,7 @@ namespace {
 
 constexpr char kProjectionMatrixTag[] = "PROJECTION_MATRIX";
 constexpr char kDetectionsTag[] = "DETECTIONS";
+constexpr char kFlatDetectionsTag[] = "FLAT_DETECTIONS";
 
 using ::testing::ElementsAre;
 using ::testing::FloatNear;
@@ -308,5 +310,75 @@ TEST(DetectionProjectionCalculatorTest, ProjectionSmallerRoi30Rotation) {
                           PointEq(kExpectedPoint3X, kExpectedPoint3Y)));
 }
 
+TEST(DetectionProjectionCalculatorTest, ProjectsFlatDetectionsAsDetections) {
+  std::vector<Detection> detections(2);
+  for (int i = 0; i < detections.size(); ++i) {
+    auto* location_data = detections[i].mutable_location_data();
+    location_data->set_format(LocationData::RELATIVE_BOUNDING_BOX);
+    auto* box = location_data->mutable_relative_bounding_box();
+    box->set_xmin(0.1f * i);
+    box->set_ymin(0.2f);
+    box->set_width(0.5f);
+    box->set_height(0.3f + 0.1f * i);
+    auto* kp = location_data->add_relative_keypoints();
+    kp->set_x(0.25f);
+    kp->set_y(0.5f * i);
+    detections[i].add_score(0.5f);
+    detections[i].add_label_id(i);
+  }
+  MP_ASSERT_OK_AND_ASSIGN(FlatDetections flat_detections,
+                          FromDetections(detections));
+
+  RotatedRect rect;
+  rect.center_x = 65;
+  rect.center_y = 85;
+  rect.width = 50;
+  rect.height = 30;
+  rect.rotation = 30 * M_PI / 180.0f;
+  std::array<float, 16> projection_matrix;
+  GetRotatedSubRectToRectTransformMatrix(rect, /*rect_width=*/80,
+                                         /*rect_height=*/120,
+                                         /*flip_horizontaly=*/false,
+                                         &projection_matrix);
+
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "DetectionProjectionCalculator"
+    input_stream: "DETECTIONS:detections"
+    input_stream: "FLAT_DETECTIONS:flat_detections"
+    input_stream: "PROJECTION_MATRIX:matrix"
+    output_stream: "DETECTIONS:projected_detections"
+    output_stream: "FLAT_DETECTIONS:projected_flat_detections"
+  )pb"));
+  runner.MutableInputs()->Tag(kDetectionsTag).packets.push_back(
+      MakePacket<std::vector<Detection>>(detections).At(Timestamp(0)));
+  runner.MutableInputs()->Tag(kFlatDetectionsTag).packets.push_back(
+      MakePacket<FlatDetections>(flat_detections).At(Timestamp(0)));
+  runner.MutableInputs()->Tag(kProjectionMatrixTag).packets.push_back(
+      MakePacket<std::array<float, 16>>(projection_matrix).At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& expected = runner.Outputs()
+                             .Tag(kDetectionsTag)
+                             .packets[0]
+                             .Get<std::vector<Detection>>();
+  const auto& actual = runner.Outputs()
+                           .Tag(kFlatDetectionsTag)
+                           .packets[0]
+                           .Get<FlatDetections>();
+  ASSERT_EQ(actual.size(), expected.size());
+  for (int i = 0; i < actual.size(); ++i) {
+    const auto& location_data = expected[i].location_data();
+    const auto& box = location_data.relative_bounding_box();
+    EXPECT_FLOAT_EQ(actual.xmin(i), box.xmin());
+    EXPECT_FLOAT_EQ(actual.ymin(i), box.ymin());
+    EXPECT_FLOAT_EQ(actual.width(i), box.width());
+    EXPECT_FLOAT_EQ(actual.height(i), box.height());
+    EXPECT_FLOAT_EQ(actual.keypoints(i)[0],
+                    location_data.relative_keypoints(0).x());
+    EXPECT_FLOAT_EQ(actual.keypoints(i)[1],
+                    location_data.relative_keypoints(0).y());
+  }
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -20,6 +20,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_options.pb.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/flat_detections.h"
 #include "mediapipe/framework/formats/location_data.pb.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
@@ -31,6 +32,7 @@ namespace {
 
 constexpr char kDetectionTag[] = "DETECTION";
 constexpr char kDetectionsTag[] = "DETECTIONS";
+constexpr char kFlatDetectionsTag[] = "FLAT_DETECTIONS";
 constexpr char kImageSizeTag[] = "IMAGE_SIZE";
 constexpr char kRectTag[] = "RECT";
 constexpr char kNormRectTag[] = "NORM_RECT";
@@ -62,6 +64,28 @@ absl::Status NormRectFromKeyPoints(const LocationData& location_data,
   return absl::OkStatus();
 }
 
+absl::Status NormRectFromKeyPoints(const FlatDetections& detections, int index,
+                                   NormalizedRect* rect) {
+  RET_CHECK_GT(detections.num_keypoints(), 1)
+      << "2 or more key points required to calculate a rect.";
+  const float* keypoints = detections.keypoints(index);
+  float xmin = kMaxFloat;
+  float ymin = kMaxFloat;
+  float xmax = kMinFloat;
+  float ymax = kMinFloat;
+  for (int i = 0; i < detections.num_keypoints(); ++i) {
+    xmin = std::min(xmin, keypoints[i * 2]);
+    ymin = std::min(ymin, keypoints[i * 2 + 1]);
+    xmax = std::max(xmax, keypoints[i * 2]);
+    ymax = std::max(ymax, keypoints[i * 2 + 1]);
+  }
+  rect->set_x_center((xmin + xmax) / 2);
+  rect->set_y_center((ymin + ymax) / 2);
+  rect->set_width(xmax - xmin);
+  rect->set_height(ymax - ymin);
+  return absl::OkStatus();
+}
+
 template <class B, class R>
 void RectFromBox(B box, R* rect) {
   rect->set_x_center(box.xmin() + box.width() / 2);
@@ -127,11 +151,47 @@ absl::Status DetectionsToRectsCalculator::DetectionToNormalizedRect(
   return absl::OkStatus();
 }
 
+absl::Status DetectionsToRectsCalculator::FlatDetectionToRect(
+    const FlatDetections& detections, int index,
+    const DetectionSpec& detection_spec, Rect* rect) {
+  RET_CHECK(options_.conversion_mode() ==
+            DetectionsToRectsCalculatorOptions::USE_KEYPOINTS)
+      << "FlatDetections hold relative boxes and can only be converted to "
+         "Rect with USE_KEYPOINTS";
+  RET_CHECK(detection_spec.image_size.has_value())
+      << "Rect with absolute coordinates calculation requires image size.";
+  const int width = detection_spec.image_size->first;
+  const int height = detection_spec.image_size->second;
+  NormalizedRect norm_rect;
+  MP_RETURN_IF_ERROR(NormRectFromKeyPoints(detections, index, &norm_rect));
+  rect->set_x_center(std::round(norm_rect.x_center() * width));
+  rect->set_y_center(std::round(norm_rect.y_center() * height));
+  rect->set_width(std::round(norm_rect.width() * width));
+  rect->set_height(std::round(norm_rect.height() * height));
+  return absl::OkStatus();
+}
+
+absl::Status DetectionsToRectsCalculator::FlatDetectionToNormalizedRect(
+    const FlatDetections& detections, int index,
+    const DetectionSpec& detection_spec, NormalizedRect* rect) {
+  if (options_.conversion_mode() ==
+      DetectionsToRectsCalculatorOptions::USE_KEYPOINTS) {
+    return NormRectFromKeyPoints(detections, index, rect);
+  }
+  rect->set_x_center(detections.xmin(index) + detections.width(index) / 2);
+  rect->set_y_center(detections.ymin(index) + detections.height(index) / 2);
+  rect->set_width(detections.width(index));
+  rect->set_height(detections.height(index));
+  return absl::OkStatus();
+}
+
 absl::Status DetectionsToRectsCalculator::GetContract(CalculatorContract* cc) {
-  RET_CHECK(cc->Inputs().HasTag(kDetectionTag) ^
-            cc->Inputs().HasTag(kDetectionsTag))
-      << "Exactly one of DETECTION or DETECTIONS input stream should be "
-         "provided.";
+  RET_CHECK_EQ((cc->Inputs().HasTag(kDetectionTag) ? 1 : 0) +
+                   (cc->Inputs().HasTag(kDetectionsTag) ? 1 : 0) +
+                   (cc->Inputs().HasTag(kFlatDetectionsTag) ? 1 : 0),
+               1)
+      << "Exactly one of DETECTION, DETECTIONS or FLAT_DETECTIONS input stream "
+         "should be provided.";
   RET_CHECK_EQ((cc->Outputs().HasTag(kNormRectTag) ? 1 : 0) +
                    (cc->Outputs().HasTag(kRectTag) ? 1 : 0) +
                    (cc->Outputs().HasTag(kNormRectsTag) ? 1 : 0) +
@@ -146,6 +206,9 @@ absl::Status DetectionsToRectsCalculator::GetContract(CalculatorContract* cc) {
   if (cc->Inputs().HasTag(kDetectionsTag)) {
     cc->Inputs().Tag(kDetectionsTag).Set<std::vector<Detection>>();
   }
+  if (cc->Inputs().HasTag(kFlatDetectionsTag)) {
+    cc->Inputs().Tag(kFlatDetectionsTag).Set<FlatDetections>();
+  }
   if (cc->Inputs().HasTag(kImageSizeTag)) {
     cc->Inputs().Tag(kImageSizeTag).Set<std::pair<int, int>>();
   }
@@ -195,6 +258,9 @@ absl::Status DetectionsToRectsCalculator::Open(CalculatorContext* cc) {
 }
 
 absl::Status DetectionsToRectsCalculator::Process(CalculatorContext* cc) {
+  if (cc->Inputs().HasTag(kFlatDetectionsTag)) {
+    return ProcessFlatDetections(cc);
+  }
   if (cc->Inputs().HasTag(kDetectionTag) &&
       cc->Inputs().Tag(kDetectionTag).IsEmpty()) {
     return absl::OkStatus();
@@ -323,6 +389,113 @@ absl::Status DetectionsToRectsCalculator::ComputeRotation(
   return absl::OkStatus();
 }
 
+absl::Status DetectionsToRectsCalculator::ProcessFlatDetections(
+    CalculatorContext* cc) {
+  if (cc->Inputs().Tag(kFlatDetectionsTag).IsEmpty()) {
+    return absl::OkStatus();
+  }
+  if (rotate_ && !HasTagValue(cc, kImageSizeTag)) {
+    return absl::OkStatus();
+  }
+
+  const auto& detections =
+      cc->Inputs().Tag(kFlatDetectionsTag).Get<FlatDetections>();
+  if (detections.empty()) {
+    if (output_zero_rect_for_empty_detections_) {
+      if (cc->Outputs().HasTag(kRectTag)) {
+        cc->Outputs().Tag(kRectTag).AddPacket(
+            MakePacket<Rect>().At(cc->InputTimestamp()));
+      }
+      if (cc->Outputs().HasTag(kNormRectTag)) {
+        cc->Outputs()
+            .Tag(kNormRectTag)
+            .AddPacket(MakePacket<NormalizedRect>().At(cc->InputTimestamp()));
+      }
+      if (cc->Outputs().HasTag(kNormRectsTag)) {
+        auto rect_vector = absl::make_unique<std::vector<NormalizedRect>>();
+        rect_vector->emplace_back(NormalizedRect());
+        cc->Outputs()
+            .Tag(kNormRectsTag)
+            .Add(rect_vector.release(), cc->InputTimestamp());
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  const DetectionSpec detection_spec = GetDetectionSpec(cc);
+  // Only the first detection is converted for single rect outputs.
+  const bool single = cc->Outputs().HasTag(kRectTag) ||
+                      cc->Outputs().HasTag(kNormRectTag);
+  const int num_rects = single ? 1 : detections.size();
+
+  if (cc->Outputs().HasTag(kRectTag) || cc->Outputs().HasTag(kRectsTag)) {
+    auto output_rects = absl::make_unique<std::vector<Rect>>(num_rects);
+    for (int i = 0; i < num_rects; ++i) {
+      MP_RETURN_IF_ERROR(FlatDetectionToRect(detections, i, detection_spec,
+                                             &(output_rects->at(i))));
+      if (rotate_) {
+        float rotation;
+        MP_RETURN_IF_ERROR(ComputeFlatDetectionRotation(
+            detections, i, detection_spec, &rotation));
+        output_rects->at(i).set_rotation(rotation);
+      }
+    }
+    if (single) {
+      cc->Outputs().Tag(kRectTag).AddPacket(
+          MakePacket<Rect>(std::move(output_rects->at(0)))
+              .At(cc->InputTimestamp()));
+    } else {
+      cc->Outputs().Tag(kRectsTag).Add(output_rects.release(),
+                                       cc->InputTimestamp());
+    }
+  } else {
+    auto output_rects =
+        absl::make_unique<std::vector<NormalizedRect>>(num_rects);
+    for (int i = 0; i < num_rects; ++i) {
+      MP_RETURN_IF_ERROR(FlatDetectionToNormalizedRect(
+          detections, i, detection_spec, &(output_rects->at(i))));
+      if (rotate_) {
+        float rotation;
+        MP_RETURN_IF_ERROR(ComputeFlatDetectionRotation(
+            detections, i, detection_spec, &rotation));
+        output_rects->at(i).set_rotation(rotation);
+      }
+    }
+    if (single) {
+      cc->Outputs().Tag(kNormRectTag).AddPacket(
+          MakePacket<NormalizedRect>(std::move(output_rects->at(0)))
+              .At(cc->InputTimestamp()));
+    } else {
+      cc->Outputs()
+          .Tag(kNormRectsTag)
+          .Add(output_rects.release(), cc->InputTimestamp());
+    }
+  }
+
+  return absl::OkStatus();
+}
+
+absl::Status DetectionsToRectsCalculator::ComputeFlatDetectionRotation(
+    const FlatDetections& detections, int index,
+    const DetectionSpec& detection_spec, float* rotation) {
+  const auto& image_size = detection_spec.image_size;
+  RET_CHECK(image_size) << "Image size is required to calculate rotation";
+  RET_CHECK_LT(std::max(start_keypoint_index_, end_keypoint_index_),
+               detections.num_keypoints());
+
+  const float* keypoints = detections.keypoints(index);
+  const float* start = keypoints + start_keypoint_index_ * 2;
+  const float* end = keypoints + end_keypoint_index_ * 2;
+  const float x0 = start[0] * image_size->first;
+  const float y0 = start[1] * image_size->second;
+  const float x1 = end[0] * image_size->first;
+  const float y1 = end[1] * image_size->second;
+
+  *rotation = NormalizeRadians(target_angle_ - std::atan2(-(y1 - y0), x1 - x0));
+
+  return absl::OkStatus();
+}
+
 DetectionSpec DetectionsToRectsCalculator::GetDetectionSpec(
     const CalculatorContext* cc) {
   absl::optional<std::pair<int, int>> image_size;
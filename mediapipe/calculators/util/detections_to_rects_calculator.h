@@ -21,6 +21,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_options.pb.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/flat_detections.h"
 #include "mediapipe/framework/formats/location_data.pb.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
@@ -54,6 +55,10 @@ struct DetectionSpec {
 // One of the following:
 // DETECTION: A Detection proto.
 // DETECTIONS: An std::vector<Detection>.
+// FLAT_DETECTIONS: A FlatDetections, converted like DETECTIONS. Since flat
+//   boxes are relative, RECT and RECTS outputs require the USE_KEYPOINTS
+//   conversion mode. Subclasses that override the Detection conversions below
+//   only support DETECTION and DETECTIONS.
 //
 // IMAGE_SIZE (optional): A std::pair<int, int> represention image width and
 //   height. This is required only when rotation needs to be computed (see
@@ -100,6 +105,17 @@ class DetectionsToRectsCalculator : public CalculatorBase {
                                        float* rotation);
   virtual DetectionSpec GetDetectionSpec(const CalculatorContext* cc);
 
+  absl::Status FlatDetectionToRect(const FlatDetections& detections, int index,
+                                   const DetectionSpec& detection_spec,
+                                   ::mediapipe::Rect* rect);
+  absl::Status FlatDetectionToNormalizedRect(
+      const FlatDetections& detections, int index,
+      const DetectionSpec& detection_spec, ::mediapipe::NormalizedRect* rect);
+  absl::Status ComputeFlatDetectionRotation(const FlatDetections& detections,
+                                            int index,
+                                            const DetectionSpec& detection_spec,
+                                            float* rotation);
+
   static inline float NormalizeRadians(float angle) {
     return angle - 2 * M_PI * std::floor((angle - (-M_PI)) / (2 * M_PI));
   }
@@ -110,6 +126,9 @@ class DetectionsToRectsCalculator : public CalculatorBase {
   float target_angle_ = 0.0f;  // In radians.
   bool rotate_;
   bool output_zero_rect_for_empty_detections_;
+
+ private:
+  absl::Status ProcessFlatDetections(CalculatorContext* cc);
 };
 
 }  // namespace mediapipe
@@ -20,6 +20,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/flat_detections.h"
 #include "mediapipe/framework/formats/location_data.pb.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/packet.h"
@@ -38,6 +39,7 @@ constexpr char kNormRectTag[] = "NORM_RECT";
 constexpr char kImageSizeTag[] = "IMAGE_SIZE";
 constexpr char kRectTag[] = "RECT";
 constexpr char kDetectionTag[] = "DETECTION";
+constexpr char kFlatDetectionsTag[] = "FLAT_DETECTIONS";
 
 MATCHER_P4(RectEq, x_center, y_center, width, height, "") {
   return testing::Value(arg.x_center(), testing::Eq(x_center)) &&
@@ -343,6 +345,62 @@ TEST(DetectionsToRectsCalculatorTest, DetectionsToNormalizedRects) {
   EXPECT_THAT(rects[1], NormRectEq(0.4f, 0.55f, 0.4f, 0.5f));
 }
 
+TEST(DetectionsToRectsCalculatorTest, FlatDetectionsToNormalizedRects) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "DetectionsToRectsCalculator"
+    input_stream: "FLAT_DETECTIONS:detections"
+    output_stream: "NORM_RECTS:rect"
+  )pb"));
+
+  auto detections = absl::make_unique<FlatDetections>();
+  detections->Add(0.1f, 0.2f, 0.3f, 0.4f, /*score=*/0.9f, /*class_id=*/0);
+  detections->Add(0.2f, 0.3f, 0.4f, 0.5f, /*score=*/0.8f, /*class_id=*/0);
+
+  runner.MutableInputs()
+      ->Tag(kFlatDetectionsTag)
+      .packets.push_back(
+          Adopt(detections.release()).At(Timestamp::PostStream()));
+
+  MP_ASSERT_OK(runner.Run()) << "Calculator execution failed.";
+  const std::vector<Packet>& output =
+      runner.Outputs().Tag(kNormRectsTag).packets;
+  ASSERT_EQ(1, output.size());
+  const auto& rects = output[0].Get<std::vector<NormalizedRect>>();
+  ASSERT_EQ(rects.size(), 2);
+  EXPECT_THAT(rects[0], NormRectEq(0.25f, 0.4f, 0.3f, 0.4f));
+  EXPECT_THAT(rects[1], NormRectEq(0.4f, 0.55f, 0.4f, 0.5f));
+}
+
+TEST(DetectionsToRectsCalculatorTest, FlatDetectionKeyPointsToNormalizedRect) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "DetectionsToRectsCalculator"
+    input_stream: "FLAT_DETECTIONS:detections"
+    output_stream: "NORM_RECT:rect"
+    options: {
+      [mediapipe.DetectionsToRectsCalculatorOptions.ext] {
+        conversion_mode: USE_KEYPOINTS
+      }
+    }
+  )pb"));
+
+  auto detections = absl::make_unique<FlatDetections>(/*num_keypoints=*/2);
+  const float keypoints[] = {0.0f, 0.0f, 0.5f, 0.5f};
+  detections->Add(0.1f, 0.2f, 0.3f, 0.4f, /*score=*/0.9f, /*class_id=*/0,
+                  keypoints);
+
+  runner.MutableInputs()
+      ->Tag(kFlatDetectionsTag)
+      .packets.push_back(
+          Adopt(detections.release()).At(Timestamp::PostStream()));
+
+  MP_ASSERT_OK(runner.Run()) << "Calculator execution failed.";
+  const std::vector<Packet>& output =
+      runner.Outputs().Tag(kNormRectTag).packets;
+  ASSERT_EQ(1, output.size());
+  EXPECT_THAT(output[0].Get<NormalizedRect>(),
+              NormRectEq(0.25f, 0.25f, 0.5f, 0.5f));
+}
+
 TEST(DetectionsToRectsCalculatorTest, DetectionToRects) {
   CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
     calculator: "DetectionsToRectsCalculator"
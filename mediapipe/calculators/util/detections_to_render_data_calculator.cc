@@ -23,6 +23,7 @@
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/color.pb.h"
 #include "mediapipe/util/render_data.pb.h"
+#include "mediapipe/util/render_data_pool.h"
 namespace mediapipe {
 
 namespace {
@@ -119,6 +120,8 @@ class DetectionsToRenderDataCalculator : public CalculatorBase {
       const Detection& detection,
       const DetectionsToRenderDataCalculatorOptions& options,
       RenderData* render_data);
+
+  RenderDataPool render_data_pool_;
 };
 REGISTER_CALCULATOR(DetectionsToRenderDataCalculator);
 
@@ -168,27 +171,27 @@ absl::Status DetectionsToRenderDataCalculator::Process(CalculatorContext* cc) {
 
   // TODO: Add score threshold to
   // DetectionsToRenderDataCalculatorOptions.
-  auto render_data = absl::make_unique<RenderData>();
+  RenderData* render_data = render_data_pool_.NewRenderData();
   render_data->set_scene_class(options.scene_class());
   if (has_detection_from_list) {
     for (const auto& detection :
          cc->Inputs().Tag(kDetectionListTag).Get<DetectionList>().detection()) {
-      AddDetectionToRenderData(detection, options, render_data.get());
+      AddDetectionToRenderData(detection, options, render_data);
     }
   }
   if (has_detection_from_vector) {
     for (const auto& detection :
          cc->Inputs().Tag(kDetectionsTag).Get<std::vector<Detection>>()) {
-      AddDetectionToRenderData(detection, options, render_data.get());
+      AddDetectionToRenderData(detection, options, render_data);
     }
   }
   if (has_single_detection) {
     AddDetectionToRenderData(cc->Inputs().Tag(kDetectionTag).Get<Detection>(),
-                             options, render_data.get());
+                             options, render_data);
   }
   cc->Outputs()
       .Tag(kRenderDataTag)
-      .Add(render_data.release(), cc->InputTimestamp());
+      .AddPacket(render_data_pool_.MakePacket().At(cc->InputTimestamp()));
   return absl::OkStatus();
 }
 
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <array>
 #include <cmath>
 #include <functional>
 #include <vector>
@@ -19,6 +20,7 @@
 #include "mediapipe/calculators/util/landmark_projection_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/packed_landmarks.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 
@@ -27,6 +29,7 @@ namespace mediapipe {
 namespace {
 
 constexpr char kLandmarksTag[] = "NORM_LANDMARKS";
+constexpr char kPackedLandmarksTag[] = "PACKED_NORM_LANDMARKS";
 constexpr char kRectTag[] = "NORM_RECT";
 constexpr char kProjectionMatrix[] = "PROJECTION_MATRIX";
 
@@ -39,6 +42,9 @@ constexpr char kProjectionMatrix[] = "PROJECTION_MATRIX";
 //     or landmarks that should be projected using PROJECTION_MATRIX if
 //     specified. (Prefer using PROJECTION_MATRIX as it eliminates need of
 //     letterbox removal step.)
+//   PACKED_NORM_LANDMARKS - PackedLandmarks
+//     Same as NORM_LANDMARKS, projected in place on a copy of the packed
+//     buffer. Can be used instead of, or together with, NORM_LANDMARKS.
 //   NORM_RECT - NormalizedRect
 //     Represents a normalized rectangle in image coordinates and results in
 //     landmarks with their locations adjusted to the image.
@@ -54,6 +60,8 @@ constexpr char kProjectionMatrix[] = "PROJECTION_MATRIX";
 // Output:
 //   NORM_LANDMARKS - NormalizedLandmarkList
 //     Landmarks with their locations adjusted according to the inputs.
+//   PACKED_NORM_LANDMARKS - PackedLandmarks
+//     One for every PACKED_NORM_LANDMARKS input.
 //
 // Usage example:
 // node {
@@ -90,17 +98,25 @@ constexpr char kProjectionMatrix[] = "PROJECTION_MATRIX";
 class LandmarkProjectionCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
-    RET_CHECK(cc->Inputs().HasTag(kLandmarksTag))
+    RET_CHECK(cc->Inputs().HasTag(kLandmarksTag) ||
+              cc->Inputs().HasTag(kPackedLandmarksTag))
         << "Missing NORM_LANDMARKS input.";
 
     RET_CHECK_EQ(cc->Inputs().NumEntries(kLandmarksTag),
                  cc->Outputs().NumEntries(kLandmarksTag))
         << "Same number of input and output landmarks is required.";
+    RET_CHECK_EQ(cc->Inputs().NumEntries(kPackedLandmarksTag),
+                 cc->Outputs().NumEntries(kPackedLandmarksTag))
+        << "Same number of input and output packed landmarks is required.";
 
     for (CollectionItemId id = cc->Inputs().BeginId(kLandmarksTag);
          id != cc->Inputs().EndId(kLandmarksTag); ++id) {
       cc->Inputs().Get(id).Set<NormalizedLandmarkList>();
     }
+    for (CollectionItemId id = cc->Inputs().BeginId(kPackedLandmarksTag);
+         id != cc->Inputs().EndId(kPackedLandmarksTag); ++id) {
+      cc->Inputs().Get(id).Set<PackedLandmarks>();
+    }
     RET_CHECK(cc->Inputs().HasTag(kRectTag) ^
               cc->Inputs().HasTag(kProjectionMatrix))
         << "Either NORM_RECT or PROJECTION_MATRIX must be specified.";
@@ -114,6 +130,10 @@ class LandmarkProjectionCalculator : public CalculatorBase {
          id != cc->Outputs().EndId(kLandmarksTag); ++id) {
       cc->Outputs().Get(id).Set<NormalizedLandmarkList>();
     }
+    for (CollectionItemId id = cc->Outputs().BeginId(kPackedLandmarksTag);
+         id != cc->Outputs().EndId(kPackedLandmarksTag); ++id) {
+      cc->Outputs().Get(id).Set<PackedLandmarks>();
+    }
 
     return absl::OkStatus();
   }
@@ -157,6 +177,9 @@ class LandmarkProjectionCalculator : public CalculatorBase {
   absl::Status Process(CalculatorContext* cc) override {
     std::function<void(const NormalizedLandmark&, NormalizedLandmark*)>
         project_fn;
+    // The same projection as a matrix, for packed landmarks.
+    std::array<float, 16> packed_matrix;
+    float packed_z_scale;
     if (cc->Inputs().HasTag(kRectTag)) {
       if (cc->Inputs().Tag(kRectTag).IsEmpty()) {
         return absl::OkStatus();
@@ -185,6 +208,28 @@ class LandmarkProjectionCalculator : public CalculatorBase {
         new_landmark->set_y(new_y);
         new_landmark->set_z(new_z);
       };
+      const float angle = options.ignore_rotation() ? 0 : input_rect.rotation();
+      const float cos_a = std::cos(angle);
+      const float sin_a = std::sin(angle);
+      const float w = input_rect.width();
+      const float h = input_rect.height();
+      packed_matrix = {w * cos_a,
+                       -w * sin_a,
+                       0.0f,
+                       input_rect.x_center() - 0.5f * w * (cos_a - sin_a),
+                       h * sin_a,
+                       h * cos_a,
+                       0.0f,
+                       input_rect.y_center() - 0.5f * h * (sin_a + cos_a),
+                       0.0f,
+                       0.0f,
+                       1.0f,
+                       0.0f,
+                       0.0f,
+                       0.0f,
+                       0.0f,
+                       1.0f};
+      packed_z_scale = w;
     } else if (cc->Inputs().HasTag(kProjectionMatrix)) {
       if (cc->Inputs().Tag(kProjectionMatrix).IsEmpty()) {
         return absl::OkStatus();
@@ -198,6 +243,8 @@ class LandmarkProjectionCalculator : public CalculatorBase {
         ProjectXY(lm, project_mat, new_landmark);
         new_landmark->set_z(z_scale * lm.z());
       };
+      packed_matrix = project_mat;
+      packed_z_scale = z_scale;
     } else {
       return absl::InternalError("Either rect or matrix must be specified.");
     }
@@ -224,6 +271,21 @@ class LandmarkProjectionCalculator : public CalculatorBase {
           MakePacket<NormalizedLandmarkList>(std::move(output_landmarks))
               .At(cc->InputTimestamp()));
     }
+
+    input_id = cc->Inputs().BeginId(kPackedLandmarksTag);
+    output_id = cc->Outputs().BeginId(kPackedLandmarksTag);
+    for (; input_id != cc->Inputs().EndId(kPackedLandmarksTag);
+         ++input_id, ++output_id) {
+      const auto& input_packet = cc->Inputs().Get(input_id);
+      if (input_packet.IsEmpty()) {
+        continue;
+      }
+      auto output_landmarks = absl::make_unique<PackedLandmarks>(
+          input_packet.Get<PackedLandmarks>());
+      output_landmarks->Transform(packed_matrix, packed_z_scale);
+      cc->Outputs().Get(output_id).Add(output_landmarks.release(),
+                                       cc->InputTimestamp());
+    }
     return absl::OkStatus();
   }
 };
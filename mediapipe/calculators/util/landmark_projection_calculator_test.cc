@@ -7,6 +7,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/packed_landmarks.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
@@ -19,6 +20,7 @@ namespace {
 constexpr char kProjectionMatrixTag[] = "PROJECTION_MATRIX";
 constexpr char kNormRectTag[] = "NORM_RECT";
 constexpr char kNormLandmarksTag[] = "NORM_LANDMARKS";
+constexpr char kPackedNormLandmarksTag[] = "PACKED_NORM_LANDMARKS";
 
 absl::StatusOr<mediapipe::NormalizedLandmarkList> RunCalculator(
     mediapipe::NormalizedLandmarkList input, mediapipe::NormalizedRect rect) {
@@ -240,5 +242,63 @@ TEST(LandmarkProjectionCalculatorTest, ProjectingWithRotationMatrix) {
       )pb")));
 }
 
+TEST(LandmarkProjectionCalculatorTest, ProjectsPackedLandmarksLikeProtos) {
+  mediapipe::CalculatorRunner runner(
+      ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig::Node>(R"pb(
+        calculator: "LandmarkProjectionCalculator"
+        input_stream: "NORM_LANDMARKS:landmarks"
+        input_stream: "PACKED_NORM_LANDMARKS:packed_landmarks"
+        input_stream: "NORM_RECT:rect"
+        output_stream: "NORM_LANDMARKS:projected_landmarks"
+        output_stream: "PACKED_NORM_LANDMARKS:projected_packed_landmarks"
+      )pb"));
+  const auto landmarks =
+      ParseTextProtoOrDie<mediapipe::NormalizedLandmarkList>(R"pb(
+        landmark { x: 0.1, y: 0.2, z: -0.5, visibility: 0.7 }
+        landmark { x: 0.3, y: 0.9, z: 0.25, visibility: 0.8 }
+        landmark { x: 0.5, y: 0.5, z: 0.0, visibility: 0.9 }
+        landmark { x: 0.8, y: 0.4, z: 1.0, visibility: 0.1 }
+        landmark { x: 1.0, y: 0.0, z: -1.0, visibility: 0.2 }
+      )pb");
+  runner.MutableInputs()
+      ->Tag(kNormLandmarksTag)
+      .packets.push_back(
+          MakePacket<mediapipe::NormalizedLandmarkList>(landmarks).At(
+              Timestamp(1)));
+  runner.MutableInputs()
+      ->Tag(kPackedNormLandmarksTag)
+      .packets.push_back(
+          MakePacket<PackedLandmarks>(PackLandmarks(landmarks))
+              .At(Timestamp(1)));
+  runner.MutableInputs()
+      ->Tag(kNormRectTag)
+      .packets.push_back(
+          MakePacket<mediapipe::NormalizedRect>(
+              ParseTextProtoOrDie<mediapipe::NormalizedRect>(R"pb(
+                x_center: 0.4, y_center: 0.6, width: 0.5, height: 0.3,
+                rotation: 0.7
+              )pb"))
+              .At(Timestamp(1)));
+
+  MP_ASSERT_OK(runner.Run());
+  const auto& expected = runner.Outputs()
+                             .Tag(kNormLandmarksTag)
+                             .packets[0]
+                             .Get<mediapipe::NormalizedLandmarkList>();
+  const auto& packed_packets =
+      runner.Outputs().Tag(kPackedNormLandmarksTag).packets;
+  ASSERT_EQ(packed_packets.size(), 1);
+  const mediapipe::NormalizedLandmarkList actual =
+      ToNormalizedLandmarkList(packed_packets[0].Get<PackedLandmarks>());
+  ASSERT_EQ(actual.landmark_size(), expected.landmark_size());
+  for (int i = 0; i < actual.landmark_size(); ++i) {
+    EXPECT_NEAR(actual.landmark(i).x(), expected.landmark(i).x(), 1e-6);
+    EXPECT_NEAR(actual.landmark(i).y(), expected.landmark(i).y(), 1e-6);
+    EXPECT_NEAR(actual.landmark(i).z(), expected.landmark(i).z(), 1e-6);
+    EXPECT_EQ(actual.landmark(i).visibility(),
+              expected.landmark(i).visibility());
+  }
+}
+
 }  // namespace
 }  // namespace mediapipe
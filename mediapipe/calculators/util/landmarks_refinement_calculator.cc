@@ -17,12 +17,13 @@
 #include <algorithm>
 #include <set>
 #include <utility>
+#include <vector>
 
-#include "absl/memory/memory.h"
 #include "mediapipe/calculators/util/landmarks_refinement_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/packed_landmarks.h"
 #include "mediapipe/framework/port/proto_ns.h"
 #include "mediapipe/framework/port/ret_check.h"
 
@@ -61,22 +62,22 @@ absl::StatusOr<int> GetNumberOfRefinedLandmarks(
 }
 
 void RefineXY(const proto_ns::RepeatedField<int>& indexes_mapping,
-              const NormalizedLandmarkList& landmarks,
-              NormalizedLandmarkList* refined_landmarks) {
-  for (int i = 0; i < landmarks.landmark_size(); ++i) {
-    const auto& landmark = landmarks.landmark(i);
-    auto* refined_landmark =
-        refined_landmarks->mutable_landmark(indexes_mapping.Get(i));
-    refined_landmark->set_x(landmark.x());
-    refined_landmark->set_y(landmark.y());
+              const PackedLandmarks& landmarks,
+              PackedLandmarks* refined_landmarks) {
+  float* refined_x = refined_landmarks->x();
+  float* refined_y = refined_landmarks->y();
+  for (int i = 0; i < landmarks.size(); ++i) {
+    const int refined_index = indexes_mapping.Get(i);
+    refined_x[refined_index] = landmarks.x()[i];
+    refined_y[refined_index] = landmarks.y()[i];
   }
 }
 
-float GetZAverage(const NormalizedLandmarkList& landmarks,
+float GetZAverage(const PackedLandmarks& landmarks,
                   const proto_ns::RepeatedField<int>& indexes) {
   double z_sum = 0;
   for (int i = 0; i < indexes.size(); ++i) {
-    z_sum += landmarks.landmark(indexes.Get(i)).z();
+    z_sum += landmarks.z()[indexes.Get(i)];
   }
   return z_sum / indexes.size();
 }
@@ -84,22 +85,20 @@ float GetZAverage(const NormalizedLandmarkList& landmarks,
 void RefineZ(
     const proto_ns::RepeatedField<int>& indexes_mapping,
     const LandmarksRefinementCalculatorOptions::ZRefinement& z_refinement,
-    const NormalizedLandmarkList& landmarks,
-    NormalizedLandmarkList* refined_landmarks) {
+    const PackedLandmarks& landmarks, PackedLandmarks* refined_landmarks) {
+  float* refined_z = refined_landmarks->z();
   if (z_refinement.has_none()) {
     // Do nothing and keep Z that is already in refined landmarks.
   } else if (z_refinement.has_copy()) {
-    for (int i = 0; i < landmarks.landmark_size(); ++i) {
-      refined_landmarks->mutable_landmark(indexes_mapping.Get(i))
-          ->set_z(landmarks.landmark(i).z());
+    for (int i = 0; i < landmarks.size(); ++i) {
+      refined_z[indexes_mapping.Get(i)] = landmarks.z()[i];
     }
   } else if (z_refinement.has_assign_average()) {
     const float z_average =
         GetZAverage(*refined_landmarks,
                     z_refinement.assign_average().indexes_for_average());
     for (int i = 0; i < indexes_mapping.size(); ++i) {
-      refined_landmarks->mutable_landmark(indexes_mapping.Get(i))
-          ->set_z(z_average);
+      refined_z[indexes_mapping.Get(i)] = z_average;
     }
   } else {
     CHECK(false) << "Z refinement is either not specified or not supported";
@@ -139,9 +138,26 @@ class LandmarksRefinementCalculatorImpl
                      GetNumberOfRefinedLandmarks(options_.refinement()));
 
     // Validate that number of refinements and landmark streams is the same.
-    RET_CHECK_EQ(kLandmarks(cc).Count(), options_.refinement_size())
+    const int num_input_kinds = (kLandmarks(cc).Count() > 0) +
+                                (kPackedLandmarks(cc).Count() > 0) +
+                                (kMultiPackedLandmarks(cc).Count() > 0);
+    RET_CHECK_LE(num_input_kinds, 1)
+        << "Only one of LANDMARKS, PACKED_LANDMARKS and MULTI_PACKED_LANDMARKS "
+           "should be used";
+    const int num_streams = kLandmarks(cc).Count() +
+                            kPackedLandmarks(cc).Count() +
+                            kMultiPackedLandmarks(cc).Count();
+    RET_CHECK_EQ(num_streams, options_.refinement_size())
         << "There are " << options_.refinement_size() << " refinements while "
-        << kLandmarks(cc).Count() << " landmark streams";
+        << num_streams << " landmark streams";
+    if (kMultiPackedLandmarks(cc).Count() > 0) {
+      RET_CHECK(!kRefinedLandmarks(cc).IsConnected() &&
+                !kPackedRefinedLandmarks(cc).IsConnected())
+          << "MULTI_PACKED_LANDMARKS only supports MULTI_REFINED_LANDMARKS";
+    } else {
+      RET_CHECK(!kMultiRefinedLandmarks(cc).IsConnected())
+          << "MULTI_REFINED_LANDMARKS requires MULTI_PACKED_LANDMARKS";
+    }
 
     return absl::OkStatus();
   }
@@ -153,40 +169,89 @@ class LandmarksRefinementCalculatorImpl
         return absl::OkStatus();
       }
     }
+    for (const auto& landmarks_stream : kPackedLandmarks(cc)) {
+      if (landmarks_stream.IsEmpty()) {
+        return absl::OkStatus();
+      }
+    }
+    for (const auto& landmarks_stream : kMultiPackedLandmarks(cc)) {
+      if (landmarks_stream.IsEmpty()) {
+        return absl::OkStatus();
+      }
+    }
+
+    std::vector<const PackedLandmarks*> inputs(options_.refinement_size());
+    if (kMultiPackedLandmarks(cc).Count() > 0) {
+      const int batch_size = kMultiPackedLandmarks(cc)[0].Get().size();
+      for (const auto& landmarks_stream : kMultiPackedLandmarks(cc)) {
+        RET_CHECK_EQ(landmarks_stream.Get().size(), batch_size)
+            << "All MULTI_PACKED_LANDMARKS should have the same size";
+      }
+      std::vector<NormalizedLandmarkList> multi_refined_landmarks;
+      multi_refined_landmarks.reserve(batch_size);
+      for (int b = 0; b < batch_size; ++b) {
+        for (int i = 0; i < options_.refinement_size(); ++i) {
+          inputs[i] = &kMultiPackedLandmarks(cc)[i].Get()[b];
+        }
+        ASSIGN_OR_RETURN(PackedLandmarks refined_landmarks, Refine(inputs));
+        multi_refined_landmarks.push_back(
+            ToNormalizedLandmarkList(refined_landmarks));
+      }
+      kMultiRefinedLandmarks(cc).Send(std::move(multi_refined_landmarks));
+      return absl::OkStatus();
+    }
 
-    // Initialize refined landmarks list.
-    auto refined_landmarks = absl::make_unique<NormalizedLandmarkList>();
-    for (int i = 0; i < n_refined_landmarks_; ++i) {
-      refined_landmarks->add_landmark();
+    const bool is_packed = kPackedLandmarks(cc).Count() > 0;
+    std::vector<PackedLandmarks> packed_inputs;
+    if (!is_packed) {
+      packed_inputs.reserve(options_.refinement_size());
+      for (int i = 0; i < options_.refinement_size(); ++i) {
+        packed_inputs.push_back(PackLandmarks(kLandmarks(cc)[i].Get()));
+      }
+    }
+    for (int i = 0; i < options_.refinement_size(); ++i) {
+      inputs[i] =
+          is_packed ? &kPackedLandmarks(cc)[i].Get() : &packed_inputs[i];
     }
+    ASSIGN_OR_RETURN(PackedLandmarks refined_landmarks, Refine(inputs));
 
-    // Apply input landmarks to outpu refined landmarks in provided order.
-    for (int i = 0; i < kLandmarks(cc).Count(); ++i) {
-      const auto& landmarks = kLandmarks(cc)[i].Get();
+    if (kRefinedLandmarks(cc).IsConnected()) {
+      kRefinedLandmarks(cc).Send(ToNormalizedLandmarkList(refined_landmarks));
+    }
+    if (kPackedRefinedLandmarks(cc).IsConnected()) {
+      kPackedRefinedLandmarks(cc).Send(std::move(refined_landmarks));
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  // Applies the |inputs|, one per refinement, to new refined landmarks in the
+  // provided order.
+  absl::StatusOr<PackedLandmarks> Refine(
+      const std::vector<const PackedLandmarks*>& inputs) const {
+    PackedLandmarks refined_landmarks(n_refined_landmarks_);
+    for (int i = 0; i < options_.refinement_size(); ++i) {
+      const PackedLandmarks& landmarks = *inputs[i];
       const auto& refinement = options_.refinement(i);
 
       // Check number of landmarks in mapping and stream are the same.
-      RET_CHECK_EQ(landmarks.landmark_size(), refinement.indexes_mapping_size())
-          << "There are " << landmarks.landmark_size()
+      RET_CHECK_EQ(landmarks.size(), refinement.indexes_mapping_size())
+          << "There are " << landmarks.size()
           << " refinement landmarks while mapping has "
           << refinement.indexes_mapping_size();
 
       // Refine X and Y.
-      RefineXY(refinement.indexes_mapping(), landmarks,
-               refined_landmarks.get());
+      RefineXY(refinement.indexes_mapping(), landmarks, &refined_landmarks);
 
       // Refine Z.
       RefineZ(refinement.indexes_mapping(), refinement.z_refinement(),
-              landmarks, refined_landmarks.get());
+              landmarks, &refined_landmarks);
 
-      // Visibility and presence are not currently refined and are left as `0`.
+      // Visibility and presence are not currently refined and are left unset.
     }
-
-    kRefinedLandmarks(cc).Send(std::move(refined_landmarks));
-    return absl::OkStatus();
+    return refined_landmarks;
   }
 
- private:
   LandmarksRefinementCalculatorOptions options_;
   int n_refined_landmarks_ = 0;
 };
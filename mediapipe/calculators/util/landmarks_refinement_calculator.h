@@ -15,9 +15,12 @@
 #ifndef MEDIAPIPE_CALCULATORS_UTIL_LANDMARKS_REFINEMENT_CALCULATOR_H_
 #define MEDIAPIPE_CALCULATORS_UTIL_LANDMARKS_REFINEMENT_CALCULATOR_H_
 
+#include <vector>
+
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/packed_landmarks.h"
 
 namespace mediapipe {
 
@@ -31,12 +34,24 @@ namespace api2 {
 //     the provided order. Each list should be non empty and contain the same
 //     amount of landmarks as indexes in mapping. Number of lists should be the
 //     same as number of refinements in options.
+//   PACKED_LANDMARKS: Multiple PackedLandmarks, used the same way as LANDMARKS
+//     and instead of them.
+//   MULTI_PACKED_LANDMARKS: Multiple std::vector<PackedLandmarks>, used instead
+//     of LANDMARKS to refine a batch of landmarks at once, e.g. the
+//     MULTI_PACKED_NORM_LANDMARKS of TensorsToLandmarksCalculator. All vectors
+//     should have the same size, and item i of every vector refines item i of
+//     the output.
 //
 // Outputs:
-//   REFINED_LANDMARKS: A NormalizedLandmarkList with refined landmarks. Number
-//     of produced landmarks is equal to to the maximum index mapping number in
-//     calculator options (calculator verifies that there are no gaps in the
-//     mapping).
+//   REFINED_LANDMARKS (optional): A NormalizedLandmarkList with refined
+//     landmarks. Number of produced landmarks is equal to to the maximum index
+//     mapping number in calculator options (calculator verifies that there are
+//     no gaps in the mapping).
+//   PACKED_REFINED_LANDMARKS (optional): The refined landmarks as
+//     PackedLandmarks.
+//   MULTI_REFINED_LANDMARKS (optional): A std::vector<NormalizedLandmarkList>
+//     with the refined landmarks of every batch item. Requires
+//     MULTI_PACKED_LANDMARKS, which can't be used with the other outputs.
 //
 // Examples config:
 //   node {
@@ -72,11 +87,22 @@ class LandmarksRefinementCalculator : public NodeIntf {
  public:
   static constexpr Input<::mediapipe::NormalizedLandmarkList>::Multiple
       kLandmarks{"LANDMARKS"};
-  static constexpr Output<::mediapipe::NormalizedLandmarkList>
+  static constexpr Input<::mediapipe::PackedLandmarks>::Multiple
+      kPackedLandmarks{"PACKED_LANDMARKS"};
+  static constexpr Input<std::vector<::mediapipe::PackedLandmarks>>::Multiple
+      kMultiPackedLandmarks{"MULTI_PACKED_LANDMARKS"};
+  static constexpr Output<::mediapipe::NormalizedLandmarkList>::Optional
       kRefinedLandmarks{"REFINED_LANDMARKS"};
+  static constexpr Output<::mediapipe::PackedLandmarks>::Optional
+      kPackedRefinedLandmarks{"PACKED_REFINED_LANDMARKS"};
+  static constexpr Output<
+      std::vector<::mediapipe::NormalizedLandmarkList>>::Optional
+      kMultiRefinedLandmarks{"MULTI_REFINED_LANDMARKS"};
 
   MEDIAPIPE_NODE_INTERFACE(LandmarksRefinementCalculator, kLandmarks,
-                           kRefinedLandmarks);
+                           kPackedLandmarks, kMultiPackedLandmarks,
+                           kRefinedLandmarks, kPackedRefinedLandmarks,
+                           kMultiRefinedLandmarks);
 };
 
 }  // namespace api2
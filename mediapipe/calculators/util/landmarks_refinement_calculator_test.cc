@@ -0,0 +1,137 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/packed_landmarks.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr char kLandmarksTag[] = "LANDMARKS";
+constexpr char kRefinedLandmarksTag[] = "REFINED_LANDMARKS";
+constexpr char kMultiPackedLandmarksTag[] = "MULTI_PACKED_LANDMARKS";
+constexpr char kMultiRefinedLandmarksTag[] = "MULTI_REFINED_LANDMARKS";
+
+constexpr char kRefinementOptions[] = R"pb(
+  [mediapipe.LandmarksRefinementCalculatorOptions.ext] {
+    refinement: {
+      indexes_mapping: [ 0, 1, 2 ]
+      z_refinement: { copy {} }
+    }
+    refinement: {
+      indexes_mapping: [ 2 ]
+      z_refinement: { assign_average: { indexes_for_average: [ 0, 1 ] } }
+    }
+  }
+)pb";
+
+NormalizedLandmarkList MakeLandmarks(const std::vector<float>& values) {
+  NormalizedLandmarkList landmarks;
+  for (float value : values) {
+    auto* landmark = landmarks.add_landmark();
+    landmark->set_x(value);
+    landmark->set_y(value + 1);
+    landmark->set_z(value + 2);
+  }
+  return landmarks;
+}
+
+absl::StatusOr<NormalizedLandmarkList> RunSingle(
+    const NormalizedLandmarkList& mesh, const NormalizedLandmarkList& refine) {
+  CalculatorRunner runner(absl::StrCat(R"pb(
+    calculator: "LandmarksRefinementCalculator"
+    input_stream: "LANDMARKS:0:mesh"
+    input_stream: "LANDMARKS:1:refine"
+    output_stream: "REFINED_LANDMARKS:refined"
+    options {)pb",
+                                       kRefinementOptions, "}"));
+  runner.MutableInputs()->Get(kLandmarksTag, 0).packets.push_back(
+      MakePacket<NormalizedLandmarkList>(mesh).At(Timestamp(0)));
+  runner.MutableInputs()->Get(kLandmarksTag, 1).packets.push_back(
+      MakePacket<NormalizedLandmarkList>(refine).At(Timestamp(0)));
+  MP_RETURN_IF_ERROR(runner.Run());
+  const auto& packets = runner.Outputs().Tag(kRefinedLandmarksTag).packets;
+  RET_CHECK_EQ(packets.size(), 1);
+  return packets[0].Get<NormalizedLandmarkList>();
+}
+
+TEST(LandmarksRefinementCalculatorTest, MultiMatchesSingle) {
+  const std::vector<NormalizedLandmarkList> meshes = {
+      MakeLandmarks({0.1f, 0.2f, 0.3f}), MakeLandmarks({0.4f, 0.5f, 0.6f})};
+  const std::vector<NormalizedLandmarkList> refines = {MakeLandmarks({0.7f}),
+                                                       MakeLandmarks({0.8f})};
+
+  CalculatorRunner runner(absl::StrCat(R"pb(
+    calculator: "LandmarksRefinementCalculator"
+    input_stream: "MULTI_PACKED_LANDMARKS:0:meshes"
+    input_stream: "MULTI_PACKED_LANDMARKS:1:refines"
+    output_stream: "MULTI_REFINED_LANDMARKS:refined"
+    options {)pb",
+                                       kRefinementOptions, "}"));
+  std::vector<PackedLandmarks> packed_meshes;
+  std::vector<PackedLandmarks> packed_refines;
+  for (int i = 0; i < meshes.size(); ++i) {
+    packed_meshes.push_back(PackLandmarks(meshes[i]));
+    packed_refines.push_back(PackLandmarks(refines[i]));
+  }
+  runner.MutableInputs()->Get(kMultiPackedLandmarksTag, 0).packets.push_back(
+      MakePacket<std::vector<PackedLandmarks>>(std::move(packed_meshes))
+          .At(Timestamp(0)));
+  runner.MutableInputs()->Get(kMultiPackedLandmarksTag, 1).packets.push_back(
+      MakePacket<std::vector<PackedLandmarks>>(std::move(packed_refines))
+          .At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& packets = runner.Outputs().Tag(kMultiRefinedLandmarksTag).packets;
+  ASSERT_EQ(packets.size(), 1);
+  const auto& refined = packets[0].Get<std::vector<NormalizedLandmarkList>>();
+  ASSERT_EQ(refined.size(), meshes.size());
+  for (int i = 0; i < meshes.size(); ++i) {
+    MP_ASSERT_OK_AND_ASSIGN(NormalizedLandmarkList expected,
+                            RunSingle(meshes[i], refines[i]));
+    EXPECT_THAT(refined[i], EqualsProto(expected));
+  }
+}
+
+TEST(LandmarksRefinementCalculatorTest, MultiFailsOnBatchSizeMismatch) {
+  CalculatorRunner runner(absl::StrCat(R"pb(
+    calculator: "LandmarksRefinementCalculator"
+    input_stream: "MULTI_PACKED_LANDMARKS:0:meshes"
+    input_stream: "MULTI_PACKED_LANDMARKS:1:refines"
+    output_stream: "MULTI_REFINED_LANDMARKS:refined"
+    options {)pb",
+                                       kRefinementOptions, "}"));
+  runner.MutableInputs()->Get(kMultiPackedLandmarksTag, 0).packets.push_back(
+      MakePacket<std::vector<PackedLandmarks>>(
+          std::vector<PackedLandmarks>{PackLandmarks(MakeLandmarks(
+              {0.1f, 0.2f, 0.3f}))})
+          .At(Timestamp(0)));
+  runner.MutableInputs()->Get(kMultiPackedLandmarksTag, 1).packets.push_back(
+      MakePacket<std::vector<PackedLandmarks>>(std::vector<PackedLandmarks>())
+          .At(Timestamp(0)));
+  EXPECT_FALSE(runner.Run().ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -12,16 +12,17 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <memory>
 
-#include "absl/algorithm/container.h"
 #include "mediapipe/calculators/util/landmarks_smoothing_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/packed_landmarks.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/timestamp.h"
-#include "mediapipe/util/filtering/one_euro_filter.h"
+#include "mediapipe/util/filtering/one_euro_filter_bank.h"
 #include "mediapipe/util/filtering/relative_velocity_filter.h"
 
 namespace mediapipe {
@@ -34,41 +35,19 @@ constexpr char kImageSizeTag[] = "IMAGE_SIZE";
 constexpr char kObjectScaleRoiTag[] = "OBJECT_SCALE_ROI";
 constexpr char kNormalizedFilteredLandmarksTag[] = "NORM_FILTERED_LANDMARKS";
 constexpr char kFilteredLandmarksTag[] = "FILTERED_LANDMARKS";
+constexpr char kPackedNormalizedLandmarksTag[] = "PACKED_NORM_LANDMARKS";
+constexpr char kPackedNormalizedFilteredLandmarksTag[] =
+    "PACKED_NORM_FILTERED_LANDMARKS";
 
-using mediapipe::OneEuroFilter;
+using mediapipe::OneEuroFilterBank;
 using mediapipe::RelativeVelocityFilter;
 
-void NormalizedLandmarksToLandmarks(
-    const NormalizedLandmarkList& norm_landmarks, const int image_width,
-    const int image_height, LandmarkList* landmarks) {
-  for (int i = 0; i < norm_landmarks.landmark_size(); ++i) {
-    const auto& norm_landmark = norm_landmarks.landmark(i);
-
-    auto* landmark = landmarks->add_landmark();
-    landmark->set_x(norm_landmark.x() * image_width);
-    landmark->set_y(norm_landmark.y() * image_height);
-    // Scale Z the same way as X (using image width).
-    landmark->set_z(norm_landmark.z() * image_width);
-    landmark->set_visibility(norm_landmark.visibility());
-    landmark->set_presence(norm_landmark.presence());
-  }
-}
-
-void LandmarksToNormalizedLandmarks(const LandmarkList& landmarks,
-                                    const int image_width,
-                                    const int image_height,
-                                    NormalizedLandmarkList* norm_landmarks) {
-  for (int i = 0; i < landmarks.landmark_size(); ++i) {
-    const auto& landmark = landmarks.landmark(i);
-
-    auto* norm_landmark = norm_landmarks->add_landmark();
-    norm_landmark->set_x(landmark.x() / image_width);
-    norm_landmark->set_y(landmark.y() / image_height);
-    // Scale Z the same way as X (using image width).
-    norm_landmark->set_z(landmark.z() / image_width);
-    norm_landmark->set_visibility(landmark.visibility());
-    norm_landmark->set_presence(landmark.presence());
-  }
+// Scales normalized landmarks to absolute coordinates in place, or back with
+// the inverse scale.
+void ScaleLandmarks(float x_scale, float y_scale, PackedLandmarks* landmarks) {
+  // Scale Z the same way as X (using image width).
+  landmarks->Transform(
+      {x_scale, 0, 0, 0, 0, y_scale, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1}, x_scale);
 }
 
 // Estimate object scale to use its inverse value as velocity scale for
@@ -77,18 +56,16 @@ void LandmarksToNormalizedLandmarks(const LandmarkList& landmarks,
 // landmarks will be returned as is.
 // Object scale is calculated as average between bounding box width and height
 // with sides parallel to axis.
-float GetObjectScale(const LandmarkList& landmarks) {
-  const auto& lm_minmax_x = absl::c_minmax_element(
-      landmarks.landmark(),
-      [](const auto& a, const auto& b) { return a.x() < b.x(); });
-  const float x_min = lm_minmax_x.first->x();
-  const float x_max = lm_minmax_x.second->x();
-
-  const auto& lm_minmax_y = absl::c_minmax_element(
-      landmarks.landmark(),
-      [](const auto& a, const auto& b) { return a.y() < b.y(); });
-  const float y_min = lm_minmax_y.first->y();
-  const float y_max = lm_minmax_y.second->y();
+float GetObjectScale(const PackedLandmarks& landmarks) {
+  const auto lm_minmax_x =
+      std::minmax_element(landmarks.x(), landmarks.x() + landmarks.size());
+  const float x_min = *lm_minmax_x.first;
+  const float x_max = *lm_minmax_x.second;
+
+  const auto lm_minmax_y =
+      std::minmax_element(landmarks.y(), landmarks.y() + landmarks.size());
+  const float y_min = *lm_minmax_y.first;
+  const float y_max = *lm_minmax_y.second;
 
   const float object_width = x_max - x_min;
   const float object_height = y_max - y_min;
@@ -108,27 +85,25 @@ float GetObjectScale(const Rect& roi) {
   return (roi.width() + roi.height()) / 2.0f;
 }
 
-// Abstract class for various landmarks filters.
+// Abstract class for various landmarks filters. Filters smooth absolute
+// landmarks in place.
 class LandmarksFilter {
  public:
   virtual ~LandmarksFilter() = default;
 
   virtual absl::Status Reset() { return absl::OkStatus(); }
 
-  virtual absl::Status Apply(const LandmarkList& in_landmarks,
-                             const absl::Duration& timestamp,
+  virtual absl::Status Apply(const absl::Duration& timestamp,
                              const absl::optional<float> object_scale_opt,
-                             LandmarkList* out_landmarks) = 0;
+                             PackedLandmarks* landmarks) = 0;
 };
 
 // Returns landmarks as is without smoothing.
 class NoFilter : public LandmarksFilter {
  public:
-  absl::Status Apply(const LandmarkList& in_landmarks,
-                     const absl::Duration& timestamp,
+  absl::Status Apply(const absl::Duration& timestamp,
                      const absl::optional<float> object_scale_opt,
-                     LandmarkList* out_landmarks) override {
-    *out_landmarks = in_landmarks;
+                     PackedLandmarks* landmarks) override {
     return absl::OkStatus();
   }
 };
@@ -150,39 +125,33 @@ class VelocityFilter : public LandmarksFilter {
     return absl::OkStatus();
   }
 
-  absl::Status Apply(const LandmarkList& in_landmarks,
-                     const absl::Duration& timestamp,
+  absl::Status Apply(const absl::Duration& timestamp,
                      const absl::optional<float> object_scale_opt,
-                     LandmarkList* out_landmarks) override {
+                     PackedLandmarks* landmarks) override {
     // Get value scale as inverse value of the object scale.
     // If value is too small smoothing will be disabled and landmarks will be
     // returned as is.
     float value_scale = 1.0f;
     if (!disable_value_scaling_) {
       const float object_scale =
-          object_scale_opt ? *object_scale_opt : GetObjectScale(in_landmarks);
+          object_scale_opt ? *object_scale_opt : GetObjectScale(*landmarks);
       if (object_scale < min_allowed_object_scale_) {
-        *out_landmarks = in_landmarks;
         return absl::OkStatus();
       }
       value_scale = 1.0f / object_scale;
     }
 
     // Initialize filters once.
-    MP_RETURN_IF_ERROR(InitializeFiltersIfEmpty(in_landmarks.landmark_size()));
+    MP_RETURN_IF_ERROR(InitializeFiltersIfEmpty(landmarks->size()));
 
     // Filter landmarks. Every axis of every landmark is filtered separately.
-    for (int i = 0; i < in_landmarks.landmark_size(); ++i) {
-      const auto& in_landmark = in_landmarks.landmark(i);
-
-      auto* out_landmark = out_landmarks->add_landmark();
-      *out_landmark = in_landmark;
-      out_landmark->set_x(
-          x_filters_[i].Apply(timestamp, value_scale, in_landmark.x()));
-      out_landmark->set_y(
-          y_filters_[i].Apply(timestamp, value_scale, in_landmark.y()));
-      out_landmark->set_z(
-          z_filters_[i].Apply(timestamp, value_scale, in_landmark.z()));
+    float* x = landmarks->x();
+    float* y = landmarks->y();
+    float* z = landmarks->z();
+    for (int i = 0; i < landmarks->size(); ++i) {
+      x[i] = x_filters_[i].Apply(timestamp, value_scale, x[i]);
+      y[i] = y_filters_[i].Apply(timestamp, value_scale, y[i]);
+      z[i] = z_filters_[i].Apply(timestamp, value_scale, z[i]);
     }
 
     return absl::OkStatus();
@@ -219,7 +188,8 @@ class VelocityFilter : public LandmarksFilter {
   std::vector<RelativeVelocityFilter> z_filters_;
 };
 
-// Please check OneEuroFilter documentation for details.
+// Please check OneEuroFilter documentation for details. Every axis of every
+// landmark is filtered separately, by one OneEuroFilterBank per axis.
 class OneEuroFilterImpl : public LandmarksFilter {
  public:
   OneEuroFilterImpl(double frequency, double min_cutoff, double beta,
@@ -233,18 +203,17 @@ class OneEuroFilterImpl : public LandmarksFilter {
         disable_value_scaling_(disable_value_scaling) {}
 
   absl::Status Reset() override {
-    x_filters_.clear();
-    y_filters_.clear();
-    z_filters_.clear();
+    x_filters_.reset();
+    y_filters_.reset();
+    z_filters_.reset();
     return absl::OkStatus();
   }
 
-  absl::Status Apply(const LandmarkList& in_landmarks,
-                     const absl::Duration& timestamp,
+  absl::Status Apply(const absl::Duration& timestamp,
                      const absl::optional<float> object_scale_opt,
-                     LandmarkList* out_landmarks) override {
+                     PackedLandmarks* landmarks) override {
     // Initialize filters once.
-    MP_RETURN_IF_ERROR(InitializeFiltersIfEmpty(in_landmarks.landmark_size()));
+    MP_RETURN_IF_ERROR(InitializeFiltersIfEmpty(landmarks->size()));
 
     // Get value scale as inverse value of the object scale.
     // If value is too small smoothing will be disabled and landmarks will be
@@ -252,27 +221,17 @@ class OneEuroFilterImpl : public LandmarksFilter {
     float value_scale = 1.0f;
     if (!disable_value_scaling_) {
       const float object_scale =
-          object_scale_opt ? *object_scale_opt : GetObjectScale(in_landmarks);
+          object_scale_opt ? *object_scale_opt : GetObjectScale(*landmarks);
       if (object_scale < min_allowed_object_scale_) {
-        *out_landmarks = in_landmarks;
         return absl::OkStatus();
       }
       value_scale = 1.0f / object_scale;
     }
 
-    // Filter landmarks. Every axis of every landmark is filtered separately.
-    for (int i = 0; i < in_landmarks.landmark_size(); ++i) {
-      const auto& in_landmark = in_landmarks.landmark(i);
-
-      auto* out_landmark = out_landmarks->add_landmark();
-      *out_landmark = in_landmark;
-      out_landmark->set_x(
-          x_filters_[i].Apply(timestamp, value_scale, in_landmark.x()));
-      out_landmark->set_y(
-          y_filters_[i].Apply(timestamp, value_scale, in_landmark.y()));
-      out_landmark->set_z(
-          z_filters_[i].Apply(timestamp, value_scale, in_landmark.z()));
-    }
+    // Filter landmarks.
+    x_filters_->Apply(timestamp, value_scale, landmarks->x());
+    y_filters_->Apply(timestamp, value_scale, landmarks->y());
+    z_filters_->Apply(timestamp, value_scale, landmarks->z());
 
     return absl::OkStatus();
   }
@@ -281,21 +240,19 @@ class OneEuroFilterImpl : public LandmarksFilter {
   // Initializes filters for the first time or after Reset. If initialized then
   // check the size.
   absl::Status InitializeFiltersIfEmpty(const int n_landmarks) {
-    if (!x_filters_.empty()) {
-      RET_CHECK_EQ(x_filters_.size(), n_landmarks);
-      RET_CHECK_EQ(y_filters_.size(), n_landmarks);
-      RET_CHECK_EQ(z_filters_.size(), n_landmarks);
+    if (x_filters_ != nullptr) {
+      RET_CHECK_EQ(x_filters_->size(), n_landmarks);
+      RET_CHECK_EQ(y_filters_->size(), n_landmarks);
+      RET_CHECK_EQ(z_filters_->size(), n_landmarks);
       return absl::OkStatus();
     }
 
-    for (int i = 0; i < n_landmarks; ++i) {
-      x_filters_.push_back(
-          OneEuroFilter(frequency_, min_cutoff_, beta_, derivate_cutoff_));
-      y_filters_.push_back(
-          OneEuroFilter(frequency_, min_cutoff_, beta_, derivate_cutoff_));
-      z_filters_.push_back(
-          OneEuroFilter(frequency_, min_cutoff_, beta_, derivate_cutoff_));
-    }
+    x_filters_ = absl::make_unique<OneEuroFilterBank>(
+        n_landmarks, frequency_, min_cutoff_, beta_, derivate_cutoff_);
+    y_filters_ = absl::make_unique<OneEuroFilterBank>(
+        n_landmarks, frequency_, min_cutoff_, beta_, derivate_cutoff_);
+    z_filters_ = absl::make_unique<OneEuroFilterBank>(
+        n_landmarks, frequency_, min_cutoff_, beta_, derivate_cutoff_);
 
     return absl::OkStatus();
   }
@@ -307,9 +264,9 @@ class OneEuroFilterImpl : public LandmarksFilter {
   double min_allowed_object_scale_;
   bool disable_value_scaling_;
 
-  std::vector<OneEuroFilter> x_filters_;
-  std::vector<OneEuroFilter> y_filters_;
-  std::vector<OneEuroFilter> z_filters_;
+  std::unique_ptr<OneEuroFilterBank> x_filters_;
+  std::unique_ptr<OneEuroFilterBank> y_filters_;
+  std::unique_ptr<OneEuroFilterBank> z_filters_;
 };
 
 }  // namespace
@@ -326,8 +283,14 @@ class OneEuroFilterImpl : public LandmarksFilter {
 //     filters. If not provided - object scale will be calculated from
 //     landmarks.
 //
+//   PACKED_NORM_LANDMARKS: PackedLandmarks to smooth, instead of
+//     NORM_LANDMARKS. Smoothing then happens on a single copy of the packed
+//     buffer without going through protos.
+//
 // Outputs:
 //   NORM_FILTERED_LANDMARKS: A NormalizedLandmarkList of smoothed landmarks.
+//   PACKED_NORM_FILTERED_LANDMARKS: PackedLandmarks of smoothed landmarks, for
+//     PACKED_NORM_LANDMARKS input.
 //
 // Example config:
 //   node {
@@ -358,7 +321,17 @@ class LandmarksSmoothingCalculator : public CalculatorBase {
 REGISTER_CALCULATOR(LandmarksSmoothingCalculator);
 
 absl::Status LandmarksSmoothingCalculator::GetContract(CalculatorContract* cc) {
-  if (cc->Inputs().HasTag(kNormalizedLandmarksTag)) {
+  if (cc->Inputs().HasTag(kPackedNormalizedLandmarksTag)) {
+    cc->Inputs().Tag(kPackedNormalizedLandmarksTag).Set<PackedLandmarks>();
+    cc->Inputs().Tag(kImageSizeTag).Set<std::pair<int, int>>();
+    cc->Outputs()
+        .Tag(kPackedNormalizedFilteredLandmarksTag)
+        .Set<PackedLandmarks>();
+
+    if (cc->Inputs().HasTag(kObjectScaleRoiTag)) {
+      cc->Inputs().Tag(kObjectScaleRoiTag).Set<NormalizedRect>();
+    }
+  } else if (cc->Inputs().HasTag(kNormalizedLandmarksTag)) {
     cc->Inputs().Tag(kNormalizedLandmarksTag).Set<NormalizedLandmarkList>();
     cc->Inputs().Tag(kImageSizeTag).Set<std::pair<int, int>>();
     cc->Outputs()
@@ -414,6 +387,8 @@ absl::Status LandmarksSmoothingCalculator::Process(CalculatorContext* cc) {
   // Don't emit an empty packet for this timestamp.
   if ((cc->Inputs().HasTag(kNormalizedLandmarksTag) &&
        cc->Inputs().Tag(kNormalizedLandmarksTag).IsEmpty()) ||
+      (cc->Inputs().HasTag(kPackedNormalizedLandmarksTag) &&
+       cc->Inputs().Tag(kPackedNormalizedLandmarksTag).IsEmpty()) ||
       (cc->Inputs().HasTag(kLandmarksTag) &&
        cc->Inputs().Tag(kLandmarksTag).IsEmpty())) {
     MP_RETURN_IF_ERROR(landmarks_filter_->Reset());
@@ -423,10 +398,8 @@ absl::Status LandmarksSmoothingCalculator::Process(CalculatorContext* cc) {
   const auto& timestamp =
       absl::Microseconds(cc->InputTimestamp().Microseconds());
 
-  if (cc->Inputs().HasTag(kNormalizedLandmarksTag)) {
-    const auto& in_norm_landmarks =
-        cc->Inputs().Tag(kNormalizedLandmarksTag).Get<NormalizedLandmarkList>();
-
+  if (cc->Inputs().HasTag(kNormalizedLandmarksTag) ||
+      cc->Inputs().HasTag(kPackedNormalizedLandmarksTag)) {
     int image_width;
     int image_height;
     std::tie(image_width, image_height) =
@@ -439,21 +412,37 @@ absl::Status LandmarksSmoothingCalculator::Process(CalculatorContext* cc) {
       object_scale = GetObjectScale(roi, image_width, image_height);
     }
 
-    auto in_landmarks = absl::make_unique<LandmarkList>();
-    NormalizedLandmarksToLandmarks(in_norm_landmarks, image_width, image_height,
-                                   in_landmarks.get());
-
-    auto out_landmarks = absl::make_unique<LandmarkList>();
-    MP_RETURN_IF_ERROR(landmarks_filter_->Apply(
-        *in_landmarks, timestamp, object_scale, out_landmarks.get()));
-
-    auto out_norm_landmarks = absl::make_unique<NormalizedLandmarkList>();
-    LandmarksToNormalizedLandmarks(*out_landmarks, image_width, image_height,
-                                   out_norm_landmarks.get());
-
-    cc->Outputs()
-        .Tag(kNormalizedFilteredLandmarksTag)
-        .Add(out_norm_landmarks.release(), cc->InputTimestamp());
+    const bool is_packed = cc->Inputs().HasTag(kPackedNormalizedLandmarksTag);
+    auto landmarks =
+        is_packed ? absl::make_unique<PackedLandmarks>(
+                        cc->Inputs()
+                            .Tag(kPackedNormalizedLandmarksTag)
+                            .Get<PackedLandmarks>())
+                  : absl::make_unique<PackedLandmarks>(
+                        PackLandmarks(cc->Inputs()
+                                          .Tag(kNormalizedLandmarksTag)
+                                          .Get<NormalizedLandmarkList>()));
+
+    // Perform all computations in absolute coordinates.
+    ScaleLandmarks(image_width, image_height, landmarks.get());
+    MP_RETURN_IF_ERROR(
+        landmarks_filter_->Apply(timestamp, object_scale, landmarks.get()));
+    ScaleLandmarks(1.0f / image_width, 1.0f / image_height, landmarks.get());
+
+    if (is_packed) {
+      cc->Outputs()
+          .Tag(kPackedNormalizedFilteredLandmarksTag)
+          .Add(landmarks.release(), cc->InputTimestamp());
+    } else {
+      // Filtered protos always carry visibility and presence.
+      landmarks->set_has_visibility(true);
+      landmarks->set_has_presence(true);
+      cc->Outputs()
+          .Tag(kNormalizedFilteredLandmarksTag)
+          .AddPacket(MakePacket<NormalizedLandmarkList>(
+                         ToNormalizedLandmarkList(*landmarks))
+                         .At(cc->InputTimestamp()));
+    }
   } else {
     const auto& in_landmarks =
         cc->Inputs().Tag(kLandmarksTag).Get<LandmarkList>();
@@ -465,13 +454,14 @@ absl::Status LandmarksSmoothingCalculator::Process(CalculatorContext* cc) {
       object_scale = GetObjectScale(roi);
     }
 
-    auto out_landmarks = absl::make_unique<LandmarkList>();
-    MP_RETURN_IF_ERROR(landmarks_filter_->Apply(
-        in_landmarks, timestamp, object_scale, out_landmarks.get()));
+    PackedLandmarks landmarks = PackLandmarks(in_landmarks);
+    MP_RETURN_IF_ERROR(
+        landmarks_filter_->Apply(timestamp, object_scale, &landmarks));
 
     cc->Outputs()
         .Tag(kFilteredLandmarksTag)
-        .Add(out_landmarks.release(), cc->InputTimestamp());
+        .AddPacket(MakePacket<LandmarkList>(ToLandmarkList(landmarks))
+                       .At(cc->InputTimestamp()));
   }
 
   return absl::OkStatus();
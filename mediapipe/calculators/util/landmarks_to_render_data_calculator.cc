@@ -280,7 +280,7 @@ absl::Status LandmarksToRenderDataCalculator::Process(CalculatorContext* cc) {
     return absl::OkStatus();
   }
 
-  auto render_data = absl::make_unique<RenderData>();
+  RenderData* render_data = render_data_pool_.NewRenderData();
   bool visualize_depth = options_.visualize_landmark_depth();
   float z_min = 0.f;
   float z_max = 0.f;
@@ -314,13 +314,13 @@ absl::Status LandmarksToRenderDataCalculator::Process(CalculatorContext* cc) {
           landmarks, landmark_connections_, options_.utilize_visibility(),
           options_.visibility_threshold(), options_.utilize_presence(),
           options_.presence_threshold(), thickness, /*normalized=*/false, z_min,
-          z_max, min_depth_line_color, max_depth_line_color, render_data.get());
+          z_max, min_depth_line_color, max_depth_line_color, render_data);
     } else {
       AddConnections<LandmarkList, Landmark>(
           landmarks, landmark_connections_, options_.utilize_visibility(),
           options_.visibility_threshold(), options_.utilize_presence(),
           options_.presence_threshold(), options_.connection_color(), thickness,
-          /*normalized=*/false, render_data.get());
+          /*normalized=*/false, render_data);
     }
     for (int i = 0; i < landmarks.landmark_size(); ++i) {
       const Landmark& landmark = landmarks.landmark(i);
@@ -333,7 +333,7 @@ absl::Status LandmarksToRenderDataCalculator::Process(CalculatorContext* cc) {
       }
 
       auto* landmark_data_render = AddPointRenderData(
-          options_.landmark_color(), thickness, render_data.get());
+          options_.landmark_color(), thickness, render_data);
       if (visualize_depth) {
         SetColorSizeValueFromZ(landmark.z(), z_min, z_max, landmark_data_render,
                                options_.min_depth_circle_thickness(),
@@ -360,13 +360,13 @@ absl::Status LandmarksToRenderDataCalculator::Process(CalculatorContext* cc) {
           landmarks, landmark_connections_, options_.utilize_visibility(),
           options_.visibility_threshold(), options_.utilize_presence(),
           options_.presence_threshold(), thickness, /*normalized=*/true, z_min,
-          z_max, min_depth_line_color, max_depth_line_color, render_data.get());
+          z_max, min_depth_line_color, max_depth_line_color, render_data);
     } else {
       AddConnections<NormalizedLandmarkList, NormalizedLandmark>(
           landmarks, landmark_connections_, options_.utilize_visibility(),
           options_.visibility_threshold(), options_.utilize_presence(),
           options_.presence_threshold(), options_.connection_color(), thickness,
-          /*normalized=*/true, render_data.get());
+          /*normalized=*/true, render_data);
     }
     for (int i = 0; i < landmarks.landmark_size(); ++i) {
       const NormalizedLandmark& landmark = landmarks.landmark(i);
@@ -379,7 +379,7 @@ absl::Status LandmarksToRenderDataCalculator::Process(CalculatorContext* cc) {
       }
 
       auto* landmark_data_render = AddPointRenderData(
-          options_.landmark_color(), thickness, render_data.get());
+          options_.landmark_color(), thickness, render_data);
       if (visualize_depth) {
         SetColorSizeValueFromZ(landmark.z(), z_min, z_max, landmark_data_render,
                                options_.min_depth_circle_thickness(),
@@ -394,7 +394,7 @@ absl::Status LandmarksToRenderDataCalculator::Process(CalculatorContext* cc) {
 
   cc->Outputs()
       .Tag(kRenderDataTag)
-      .Add(render_data.release(), cc->InputTimestamp());
+      .AddPacket(render_data_pool_.MakePacket().At(cc->InputTimestamp()));
   return absl::OkStatus();
 }
 
@@ -25,6 +25,7 @@
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/color.pb.h"
 #include "mediapipe/util/render_data.pb.h"
+#include "mediapipe/util/render_data_pool.h"
 namespace mediapipe {
 
 // A calculator that converts Landmark proto to RenderData proto for
@@ -63,6 +64,7 @@ class LandmarksToRenderDataCalculator : public CalculatorBase {
  protected:
   ::mediapipe::LandmarksToRenderDataCalculatorOptions options_;
   std::vector<int> landmark_connections_;
+  RenderDataPool render_data_pool_;
 };
 
 }  // namespace mediapipe
@@ -18,6 +18,7 @@
 #include "mediapipe/calculators/util/local_file_contents_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/util/mapped_file.h"
 #include "mediapipe/util/resource_util.h"
 
 namespace mediapipe {
@@ -26,6 +27,7 @@ namespace {
 
 constexpr char kFilePathTag[] = "FILE_PATH";
 constexpr char kContentsTag[] = "CONTENTS";
+constexpr char kMappedContentsTag[] = "MAPPED_CONTENTS";
 
 }  // namespace
 
@@ -35,6 +37,10 @@ constexpr char kContentsTag[] = "CONTENTS";
 // NOTE: file loading can be batched by providing multiple input/output side
 // packets.
 //
+// Large files, such as models and label maps, can be memory-mapped instead of
+// being copied onto the heap by outputting MAPPED_CONTENTS, a read-only
+// MappedFile, in place of CONTENTS. text_mode is not supported in that case.
+//
 // Example config:
 // node {
 //   calculator: "LocalFileContentsCalculator"
@@ -51,16 +57,26 @@ constexpr char kContentsTag[] = "CONTENTS";
 //   output_side_packet: "CONTENTS:1:contents2"
 //   ...
 // }
+//
+// node {
+//   calculator: "LocalFileContentsCalculator"
+//   input_side_packet: "FILE_PATH:model_path"
+//   output_side_packet: "MAPPED_CONTENTS:model_contents"
+// }
 class LocalFileContentsCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
     RET_CHECK(cc->InputSidePackets().HasTag(kFilePathTag))
         << "Missing PATH input side packet(s)";
-    RET_CHECK(cc->OutputSidePackets().HasTag(kContentsTag))
-        << "Missing CONTENTS output side packet(s)";
+    RET_CHECK(cc->OutputSidePackets().HasTag(kContentsTag) ^
+              cc->OutputSidePackets().HasTag(kMappedContentsTag))
+        << "Exactly one of CONTENTS and MAPPED_CONTENTS output side packet(s) "
+           "is required";
+    const bool mapped = cc->OutputSidePackets().HasTag(kMappedContentsTag);
+    const char* contents_tag = mapped ? kMappedContentsTag : kContentsTag;
 
     RET_CHECK_EQ(cc->InputSidePackets().NumEntries(kFilePathTag),
-                 cc->OutputSidePackets().NumEntries(kContentsTag))
+                 cc->OutputSidePackets().NumEntries(contents_tag))
         << "Same number of input streams and output streams is required.";
 
     for (CollectionItemId id = cc->InputSidePackets().BeginId(kFilePathTag);
@@ -68,9 +84,13 @@ class LocalFileContentsCalculator : public CalculatorBase {
       cc->InputSidePackets().Get(id).Set<std::string>();
     }
 
-    for (CollectionItemId id = cc->OutputSidePackets().BeginId(kContentsTag);
-         id != cc->OutputSidePackets().EndId(kContentsTag); ++id) {
-      cc->OutputSidePackets().Get(id).Set<std::string>();
+    for (CollectionItemId id = cc->OutputSidePackets().BeginId(contents_tag);
+         id != cc->OutputSidePackets().EndId(contents_tag); ++id) {
+      if (mapped) {
+        cc->OutputSidePackets().Get(id).Set<MappedFile>();
+      } else {
+        cc->OutputSidePackets().Get(id).Set<std::string>();
+      }
     }
 
     return absl::OkStatus();
@@ -78,8 +98,12 @@ class LocalFileContentsCalculator : public CalculatorBase {
 
   absl::Status Open(CalculatorContext* cc) override {
     CollectionItemId input_id = cc->InputSidePackets().BeginId(kFilePathTag);
-    CollectionItemId output_id = cc->OutputSidePackets().BeginId(kContentsTag);
+    const bool mapped = cc->OutputSidePackets().HasTag(kMappedContentsTag);
+    CollectionItemId output_id = cc->OutputSidePackets().BeginId(
+        mapped ? kMappedContentsTag : kContentsTag);
     auto options = cc->Options<mediapipe::LocalFileContentsCalculatorOptions>();
+    RET_CHECK(!mapped || !options.text_mode())
+        << "text_mode is not supported with MAPPED_CONTENTS";
 
     // Number of inputs and outpus is the same according to the contract.
     for (; input_id != cc->InputSidePackets().EndId(kFilePathTag);
@@ -88,6 +112,12 @@ class LocalFileContentsCalculator : public CalculatorBase {
           cc->InputSidePackets().Get(input_id).Get<std::string>();
       ASSIGN_OR_RETURN(file_path, PathToResourceAsFile(file_path));
 
+      if (mapped) {
+        ASSIGN_OR_RETURN(std::unique_ptr<MappedFile> file,
+                         MappedFile::Open(file_path));
+        cc->OutputSidePackets().Get(output_id).Set(Adopt(file.release()));
+        continue;
+      }
       std::string contents;
       MP_RETURN_IF_ERROR(GetResourceContents(
           file_path, &contents, /*read_as_binary=*/!options.text_mode()));
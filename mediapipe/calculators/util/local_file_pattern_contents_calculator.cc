@@ -12,16 +12,26 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <deque>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "absl/status/statusor.h"
+#include "absl/synchronization/notification.h"
+#include "mediapipe/calculators/util/local_file_pattern_contents_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/threadpool.h"
+#include "mediapipe/util/mapped_file.h"
 
 namespace mediapipe {
 
 constexpr char kContentsTag[] = "CONTENTS";
+constexpr char kMappedContentsTag[] = "MAPPED_CONTENTS";
 constexpr char kFileSuffixTag[] = "FILE_SUFFIX";
 constexpr char kFileDirectoryTag[] = "FILE_DIRECTORY";
 
@@ -30,19 +40,36 @@ constexpr char kFileDirectoryTag[] = "FILE_DIRECTORY";
 // match the pattern. Those matched files will be sent sequentially through the
 // output stream with incremental timestamp difference by 1.
 //
+// The contents are output either as std::string on CONTENTS or, without
+// copying them onto the heap, as a memory-mapped MappedFile on
+// MAPPED_CONTENTS. If prefetch_count is set, the next files are loaded in the
+// background so that Process() does not wait for I/O.
+//
 // Example config:
 // node {
 //   calculator: "LocalFilePatternContentsCalculator"
 //   input_side_packet: "FILE_DIRECTORY:file_directory"
 //   input_side_packet: "FILE_SUFFIX:file_suffix"
 //   output_stream: "CONTENTS:contents"
+//   options {
+//     [mediapipe.LocalFilePatternContentsCalculatorOptions.ext] {
+//       prefetch_count: 2
+//     }
+//   }
 // }
 class LocalFilePatternContentsCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
     cc->InputSidePackets().Tag(kFileDirectoryTag).Set<std::string>();
     cc->InputSidePackets().Tag(kFileSuffixTag).Set<std::string>();
-    cc->Outputs().Tag(kContentsTag).Set<std::string>();
+    RET_CHECK(cc->Outputs().HasTag(kContentsTag) ^
+              cc->Outputs().HasTag(kMappedContentsTag))
+        << "Exactly one of CONTENTS and MAPPED_CONTENTS must be connected.";
+    if (cc->Outputs().HasTag(kContentsTag)) {
+      cc->Outputs().Tag(kContentsTag).Set<std::string>();
+    } else {
+      cc->Outputs().Tag(kMappedContentsTag).Set<MappedFile>();
+    }
     return absl::OkStatus();
   }
 
@@ -52,28 +79,83 @@ class LocalFilePatternContentsCalculator : public CalculatorBase {
         cc->InputSidePackets().Tag(kFileSuffixTag).Get<std::string>(),
         &filenames_));
     std::sort(filenames_.begin(), filenames_.end());
+    mapped_ = cc->Outputs().HasTag(kMappedContentsTag);
+    const auto& options =
+        cc->Options<LocalFilePatternContentsCalculatorOptions>();
+    RET_CHECK_GE(options.prefetch_count(), 0);
+    prefetch_count_ = options.prefetch_count();
+    if (prefetch_count_ > 0) {
+      pool_ = absl::make_unique<mediapipe::ThreadPool>(
+          "LocalFilePatternContents", /*num_threads=*/1);
+      pool_->StartWorkers();
+    }
     return absl::OkStatus();
   }
 
   absl::Status Process(CalculatorContext* cc) override {
-    if (current_output_ < filenames_.size()) {
-      auto contents = absl::make_unique<std::string>();
-      LOG(INFO) << filenames_[current_output_];
-      MP_RETURN_IF_ERROR(mediapipe::file::GetContents(
-          filenames_[current_output_], contents.get()));
-      ++current_output_;
-      cc->Outputs()
-          .Tag(kContentsTag)
-          .Add(contents.release(), Timestamp(current_output_));
-    } else {
+    if (current_output_ >= filenames_.size()) {
       return tool::StatusStop();
     }
+    LOG(INFO) << filenames_[current_output_];
+    Packet contents;
+    if (pool_) {
+      ScheduleLoads();
+      std::shared_ptr<PendingFile> pending = std::move(pending_.front());
+      pending_.pop_front();
+      pending->done.WaitForNotification();
+      ASSIGN_OR_RETURN(contents, std::move(pending->contents));
+    } else {
+      ASSIGN_OR_RETURN(contents,
+                       LoadFile(filenames_[current_output_], mapped_));
+    }
+    ++current_output_;
+    cc->Outputs()
+        .Tag(mapped_ ? kMappedContentsTag : kContentsTag)
+        .AddPacket(std::move(contents).At(Timestamp(current_output_)));
     return absl::OkStatus();
   }
 
  private:
+  struct PendingFile {
+    absl::StatusOr<Packet> contents;
+    absl::Notification done;
+  };
+
+  // Reads or maps the file at `path` into a packet without a timestamp.
+  static absl::StatusOr<Packet> LoadFile(const std::string& path, bool mapped) {
+    if (mapped) {
+      ASSIGN_OR_RETURN(std::unique_ptr<MappedFile> file,
+                       MappedFile::Open(path));
+      file->Prefetch();
+      return Adopt(file.release());
+    }
+    auto contents = absl::make_unique<std::string>();
+    MP_RETURN_IF_ERROR(mediapipe::file::GetContents(path, contents.get()));
+    return Adopt(contents.release());
+  }
+
+  // Schedules the loading of the current file and of up to prefetch_count_
+  // files after it.
+  void ScheduleLoads() {
+    const int end = std::min<int>(current_output_ + prefetch_count_ + 1,
+                                  filenames_.size());
+    for (int i = current_output_ + pending_.size(); i < end; ++i) {
+      auto pending = std::make_shared<PendingFile>();
+      pool_->Schedule([pending, path = filenames_[i], mapped = mapped_] {
+        pending->contents = LoadFile(path, mapped);
+        pending->done.Notify();
+      });
+      pending_.push_back(std::move(pending));
+    }
+  }
+
   std::vector<std::string> filenames_;
   int current_output_ = 0;
+  bool mapped_ = false;
+  int prefetch_count_ = 0;
+  // Files being loaded in the background, starting with the current one.
+  std::deque<std::shared_ptr<PendingFile>> pending_;
+  std::unique_ptr<mediapipe::ThreadPool> pool_;
 };
 
 REGISTER_CALCULATOR(LocalFilePatternContentsCalculator);
@@ -0,0 +1,99 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/substitute.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/tool/sink.h"
+#include "mediapipe/util/mapped_file.h"
+
+namespace mediapipe {
+namespace {
+
+// Writes "contents <i>" to <directory>/file_<i>.txt for i in [0, num_files).
+std::string WriteFiles(const std::string& name, int num_files) {
+  const std::string directory = file::JoinPath(::testing::TempDir(), name);
+  MP_EXPECT_OK(file::RecursivelyCreateDir(directory));
+  for (int i = 0; i < num_files; ++i) {
+    MP_EXPECT_OK(file::SetContents(
+        file::JoinPath(directory, absl::StrCat("file_", i, ".txt")),
+        absl::StrCat("contents ", i)));
+  }
+  return directory;
+}
+
+// Runs the calculator over `directory` and returns its output packets.
+std::vector<Packet> RunCalculator(const std::string& directory,
+                                  const std::string& output_tag,
+                                  int prefetch_count) {
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(absl::Substitute(
+      R"pb(
+        node {
+          calculator: "LocalFilePatternContentsCalculator"
+          input_side_packet: "FILE_DIRECTORY:file_directory"
+          input_side_packet: "FILE_SUFFIX:file_suffix"
+          output_stream: "$0:contents"
+          options {
+            [mediapipe.LocalFilePatternContentsCalculatorOptions.ext] {
+              prefetch_count: $1
+            }
+          }
+        }
+      )pb",
+      output_tag, prefetch_count));
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("contents", &config, &output_packets);
+  CalculatorGraph graph;
+  MP_EXPECT_OK(graph.Initialize(config));
+  MP_EXPECT_OK(
+      graph.Run({{"file_directory", MakePacket<std::string>(directory)},
+                 {"file_suffix", MakePacket<std::string>(".txt")}}));
+  return output_packets;
+}
+
+TEST(LocalFilePatternContentsCalculatorTest, OutputsContents) {
+  const std::string directory = WriteFiles("pattern_contents", 3);
+  std::vector<Packet> output_packets =
+      RunCalculator(directory, "CONTENTS", /*prefetch_count=*/0);
+  ASSERT_EQ(output_packets.size(), 3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(output_packets[i].Get<std::string>(),
+              absl::StrCat("contents ", i));
+    EXPECT_EQ(output_packets[i].Timestamp(), Timestamp(i + 1));
+  }
+}
+
+TEST(LocalFilePatternContentsCalculatorTest, OutputsPrefetchedMappedContents) {
+  const std::string directory = WriteFiles("pattern_mapped_contents", 5);
+  std::vector<Packet> output_packets =
+      RunCalculator(directory, "MAPPED_CONTENTS", /*prefetch_count=*/2);
+  ASSERT_EQ(output_packets.size(), 5);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(output_packets[i].Get<MappedFile>().contents(),
+              absl::StrCat("contents ", i));
+    EXPECT_EQ(output_packets[i].Timestamp(), Timestamp(i + 1));
+  }
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,282 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/util/non_max_suppression.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "mediapipe/calculators/util/non_max_suppression_calculator.pb.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+namespace {
+
+using OverlapType = NonMaxSuppressionCalculatorOptions::OverlapType;
+
+// Branch-free overlap similarity between each box of @rects1 and one box, so
+// that the loop auto-vectorizes. Returns 0 for empty or disjoint boxes, like
+// Rectangle_f::Intersects() does.
+template <OverlapType kOverlapType>
+void OverlapSimilarities(const NmsBoxes& rects1, float xmin2, float ymin2,
+                         float xmax2, float ymax2, float* similarities) {
+  const float* xmin1 = rects1.xmin();
+  const float* ymin1 = rects1.ymin();
+  const float* xmax1 = rects1.xmax();
+  const float* ymax1 = rects1.ymax();
+  const float area2 = (xmax2 - xmin2) * (ymax2 - ymin2);
+  const bool empty2 = xmin2 > xmax2 || ymin2 > ymax2;
+  const int size = rects1.size();
+  for (int i = 0; i < size; ++i) {
+    const float width1 = xmax1[i] - xmin1[i];
+    const float height1 = ymax1[i] - ymin1[i];
+    const float intersection_width =
+        std::min(xmax1[i], xmax2) - std::max(xmin1[i], xmin2);
+    const float intersection_height =
+        std::min(ymax1[i], ymax2) - std::max(ymin1[i], ymin2);
+    const bool intersects = !empty2 && width1 >= 0.0f && height1 >= 0.0f &&
+                            intersection_width >= 0.0f &&
+                            intersection_height >= 0.0f;
+    const float intersection_area = intersection_width * intersection_height;
+    float normalization;
+    switch (kOverlapType) {
+      case NonMaxSuppressionCalculatorOptions::JACCARD:
+        normalization =
+            (std::max(xmax1[i], xmax2) - std::min(xmin1[i], xmin2)) *
+            (std::max(ymax1[i], ymax2) - std::min(ymin1[i], ymin2));
+        break;
+      case NonMaxSuppressionCalculatorOptions::MODIFIED_JACCARD:
+        normalization = area2;
+        break;
+      default:
+        normalization = width1 * height1 + area2 - intersection_area;
+        break;
+    }
+    similarities[i] = intersects && normalization > 0.0f
+                          ? intersection_area / normalization
+                          : 0.0f;
+  }
+}
+
+// Maps the relative span [min, max] to the inclusive range of grid cells it
+// covers. Coordinates outside of [0, 1] fall into the border cells.
+void CellRange(float min, float max, int grid_size, int* first, int* last) {
+  const float top = grid_size - 1;
+  *first = static_cast<int>(std::min(std::max(0.0f, min * grid_size), top));
+  *last = static_cast<int>(std::min(std::max(0.0f, max * grid_size), top));
+}
+
+// Grid cells over the relative image. Without a grid, every box goes into a
+// single cell regardless of its extent.
+class NmsGrid {
+ public:
+  explicit NmsGrid(const NonMaxSuppressionCalculatorOptions& options)
+      // A negative threshold suppresses even disjoint boxes, which the grid
+      // would never compare.
+      : grid_size_(options.grid_size() > 0 &&
+                           options.min_suppression_threshold() >= 0.0f
+                       ? options.grid_size()
+                       : 0),
+        cells_(std::max(grid_size_ * grid_size_, 1)) {}
+
+  // Calls @fn with the index of every cell covered by box @index of @boxes.
+  template <typename Fn>
+  void ForEachCell(const NmsBoxes& boxes, int index, Fn fn) const {
+    if (grid_size_ == 0) {
+      fn(0);
+      return;
+    }
+    int first_x, last_x, first_y, last_y;
+    CellRange(boxes.xmin()[index], boxes.xmax()[index], grid_size_, &first_x,
+              &last_x);
+    CellRange(boxes.ymin()[index], boxes.ymax()[index], grid_size_, &first_y,
+              &last_y);
+    for (int y = first_y; y <= last_y; ++y) {
+      for (int x = first_x; x <= last_x; ++x) {
+        fn(y * grid_size_ + x);
+      }
+    }
+  }
+
+  int num_cells() const { return cells_.size(); }
+  NmsBoxes& cell(int index) { return cells_[index]; }
+
+ private:
+  int grid_size_;
+  std::vector<NmsBoxes> cells_;
+};
+
+}  // namespace
+
+void NmsBoxes::reserve(int size) {
+  xmin_.reserve(size);
+  ymin_.reserve(size);
+  xmax_.reserve(size);
+  ymax_.reserve(size);
+  labels_.reserve(size);
+}
+
+void NmsBoxes::Add(float xmin, float ymin, float xmax, float ymax, int label) {
+  xmin_.push_back(xmin);
+  ymin_.push_back(ymin);
+  xmax_.push_back(xmax);
+  ymax_.push_back(ymax);
+  labels_.push_back(label);
+}
+
+void ComputeOverlapSimilarities(OverlapType overlap_type,
+                                const NmsBoxes& rects1, const NmsBoxes& rects2,
+                                int index2, float* similarities) {
+  const float xmin2 = rects2.xmin()[index2];
+  const float ymin2 = rects2.ymin()[index2];
+  const float xmax2 = rects2.xmax()[index2];
+  const float ymax2 = rects2.ymax()[index2];
+  switch (overlap_type) {
+    case NonMaxSuppressionCalculatorOptions::JACCARD:
+      OverlapSimilarities<NonMaxSuppressionCalculatorOptions::JACCARD>(
+          rects1, xmin2, ymin2, xmax2, ymax2, similarities);
+      break;
+    case NonMaxSuppressionCalculatorOptions::MODIFIED_JACCARD:
+      OverlapSimilarities<NonMaxSuppressionCalculatorOptions::MODIFIED_JACCARD>(
+          rects1, xmin2, ymin2, xmax2, ymax2, similarities);
+      break;
+    case NonMaxSuppressionCalculatorOptions::INTERSECTION_OVER_UNION:
+      OverlapSimilarities<
+          NonMaxSuppressionCalculatorOptions::INTERSECTION_OVER_UNION>(
+          rects1, xmin2, ymin2, xmax2, ymax2, similarities);
+      break;
+    default:
+      LOG(FATAL) << "Unrecognized overlap type: " << overlap_type;
+  }
+}
+
+std::vector<int> NonMaxSuppression(
+    const NmsBoxes& boxes, const IndexedScores& indexed_scores,
+    const NonMaxSuppressionCalculatorOptions& options, int max_num_detections) {
+  std::vector<int> retained;
+  retained.reserve(std::min<int>(max_num_detections, indexed_scores.size()));
+  NmsGrid grid(options);
+  std::vector<float> similarities;
+  for (const auto& indexed_score : indexed_scores) {
+    if (options.min_score_threshold() > 0 &&
+        indexed_score.second < options.min_score_threshold()) {
+      break;
+    }
+    const int index = indexed_score.first;
+    const int label = boxes.labels()[index];
+    // The current box is suppressed iff a retained box overlaps it by more
+    // than the threshold.
+    bool suppressed = false;
+    grid.ForEachCell(boxes, index, [&](int cell_index) {
+      if (suppressed) return;
+      const NmsBoxes& cell = grid.cell(cell_index);
+      similarities.resize(cell.size());
+      ComputeOverlapSimilarities(options.overlap_type(), cell, boxes, index,
+                                 similarities.data());
+      for (int i = 0; i < cell.size(); ++i) {
+        if (similarities[i] > options.min_suppression_threshold() &&
+            (!options.per_label() || cell.labels()[i] == label)) {
+          suppressed = true;
+          break;
+        }
+      }
+    });
+    if (!suppressed) {
+      retained.push_back(index);
+      grid.ForEachCell(boxes, index, [&](int cell_index) {
+        grid.cell(cell_index).Add(boxes.xmin()[index], boxes.ymin()[index],
+                                  boxes.xmax()[index], boxes.ymax()[index],
+                                  label);
+      });
+    }
+    if (retained.size() >= max_num_detections) {
+      break;
+    }
+  }
+  return retained;
+}
+
+std::vector<WeightedNmsCluster> WeightedNonMaxSuppression(
+    const NmsBoxes& boxes, const IndexedScores& indexed_scores,
+    const NonMaxSuppressionCalculatorOptions& options) {
+  // Buckets every box up front, recording its rank in @indexed_scores.
+  NmsGrid grid(options);
+  std::vector<std::vector<int>> cell_ranks(grid.num_cells());
+  for (int rank = 0; rank < indexed_scores.size(); ++rank) {
+    const int index = indexed_scores[rank].first;
+    grid.ForEachCell(boxes, index, [&](int cell_index) {
+      grid.cell(cell_index).Add(boxes.xmin()[index], boxes.ymin()[index],
+                                boxes.xmax()[index], boxes.ymax()[index],
+                                boxes.labels()[index]);
+      cell_ranks[cell_index].push_back(rank);
+    });
+  }
+
+  std::vector<WeightedNmsCluster> clusters;
+  // Ranks taken into a cluster, and the last cluster that compared each rank
+  // so that boxes spanning several cells are only considered once.
+  std::vector<bool> clustered(indexed_scores.size(), false);
+  std::vector<int> visited(indexed_scores.size(), -1);
+  std::vector<int> member_ranks;
+  std::vector<float> similarities;
+  int top_rank = 0;
+  while (top_rank < indexed_scores.size()) {
+    const int index = indexed_scores[top_rank].first;
+    if (options.min_score_threshold() > 0 &&
+        indexed_scores[top_rank].second < options.min_score_threshold()) {
+      break;
+    }
+    const int label = boxes.labels()[index];
+    const int cluster_id = clusters.size();
+    member_ranks.clear();
+    // This includes the top box.
+    grid.ForEachCell(boxes, index, [&](int cell_index) {
+      const NmsBoxes& cell = grid.cell(cell_index);
+      const std::vector<int>& ranks = cell_ranks[cell_index];
+      similarities.resize(cell.size());
+      ComputeOverlapSimilarities(options.overlap_type(), cell, boxes, index,
+                                 similarities.data());
+      for (int i = 0; i < cell.size(); ++i) {
+        const int rank = ranks[i];
+        if (clustered[rank] || visited[rank] == cluster_id) continue;
+        visited[rank] = cluster_id;
+        if (similarities[i] > options.min_suppression_threshold() &&
+            (!options.per_label() || cell.labels()[i] == label)) {
+          member_ranks.push_back(rank);
+        }
+      }
+    });
+
+    WeightedNmsCluster cluster;
+    cluster.top_index = index;
+    std::sort(member_ranks.begin(), member_ranks.end());
+    cluster.members.reserve(member_ranks.size());
+    for (const int rank : member_ranks) {
+      clustered[rank] = true;
+      cluster.members.push_back(indexed_scores[rank]);
+    }
+    clusters.push_back(std::move(cluster));
+    // Stops once an iteration takes no box out of the remaining ones.
+    if (member_ranks.empty()) {
+      break;
+    }
+    while (top_rank < indexed_scores.size() && clustered[top_rank]) {
+      ++top_rank;
+    }
+  }
+  return clusters;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,94 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_UTIL_NON_MAX_SUPPRESSION_H_
+#define MEDIAPIPE_CALCULATORS_UTIL_NON_MAX_SUPPRESSION_H_
+
+#include <utility>
+#include <vector>
+
+#include "mediapipe/calculators/util/non_max_suppression_calculator.pb.h"
+#include "mediapipe/framework/port/rectangle.h"
+
+namespace mediapipe {
+
+// Pairs of detection index and score, sorted by descending score.
+typedef std::vector<std::pair<int, float>> IndexedScores;
+
+// Relative boxes of the detections to suppress, stored as a struct of arrays
+// so that the overlap of one box with many others is computed in a single
+// vectorizable loop.
+class NmsBoxes {
+ public:
+  void reserve(int size);
+  int size() const { return xmin_.size(); }
+
+  // Adds a box with the given label. Empty boxes never overlap anything.
+  void Add(const Rectangle_f& box, int label = 0) {
+    Add(box.xmin(), box.ymin(), box.xmax(), box.ymax(), label);
+  }
+  void Add(float xmin, float ymin, float xmax, float ymax, int label);
+
+  const float* xmin() const { return xmin_.data(); }
+  const float* ymin() const { return ymin_.data(); }
+  const float* xmax() const { return xmax_.data(); }
+  const float* ymax() const { return ymax_.data(); }
+  const int* labels() const { return labels_.data(); }
+
+ private:
+  std::vector<float> xmin_;
+  std::vector<float> ymin_;
+  std::vector<float> xmax_;
+  std::vector<float> ymax_;
+  std::vector<int> labels_;
+};
+
+// Computes the overlap similarity of each box of @rects1 with box @index2 of
+// @rects2 into @similarities. Matches Rectangle_f based overlap similarity, so
+// MODIFIED_JACCARD is normalized by the area of box @index2.
+void ComputeOverlapSimilarities(
+    NonMaxSuppressionCalculatorOptions::OverlapType overlap_type,
+    const NmsBoxes& rects1, const NmsBoxes& rects2, int index2,
+    float* similarities);
+
+// Greedy non-maximum suppression. Returns the indices of the retained boxes in
+// descending score order. The candidates are visited in the order of
+// @indexed_scores, which must be sorted by descending score. Retained boxes
+// are bucketed into a options.grid_size() x options.grid_size() grid over the
+// relative image, so each candidate is only compared against the retained
+// boxes around it. With options.per_label(), only boxes with the same label
+// suppress each other.
+std::vector<int> NonMaxSuppression(
+    const NmsBoxes& boxes, const IndexedScores& indexed_scores,
+    const NonMaxSuppressionCalculatorOptions& options, int max_num_detections);
+
+// A group of boxes merged by weighted non-maximum suppression.
+struct WeightedNmsCluster {
+  // The highest-scored box of the cluster.
+  int top_index;
+  // The boxes averaged into the cluster, in descending score order. Empty if
+  // the top box doesn't overlap itself by more than the threshold.
+  IndexedScores members;
+};
+
+// Weighted non-maximum suppression. Every remaining highest-scored box takes
+// all remaining boxes overlapping it into its cluster. Uses the same grid as
+// NonMaxSuppression() to find the overlapping boxes.
+std::vector<WeightedNmsCluster> WeightedNonMaxSuppression(
+    const NmsBoxes& boxes, const IndexedScores& indexed_scores,
+    const NonMaxSuppressionCalculatorOptions& options);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_UTIL_NON_MAX_SUPPRESSION_H_
@@ -0,0 +1,118 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares brute force suppression with the grid used by
+// NonMaxSuppressionCalculator, and per-label suppression, on 100 to 10000
+// random candidates spread over the image like anchor based detections.
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "mediapipe/calculators/util/non_max_suppression.h"
+#include "mediapipe/calculators/util/non_max_suppression_calculator.pb.h"
+#include "mediapipe/framework/port/benchmark.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumLabels = 80;
+
+// Makes small random boxes with random scores, sorted by descending score.
+void MakeCandidates(int num_candidates, NmsBoxes* boxes,
+                    IndexedScores* indexed_scores) {
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> position(0.0f, 1.0f);
+  std::uniform_real_distribution<float> size(0.02f, 0.2f);
+  std::uniform_int_distribution<int> label(0, kNumLabels - 1);
+  for (int i = 0; i < num_candidates; ++i) {
+    const float xmin = position(rng);
+    const float ymin = position(rng);
+    boxes->Add(xmin, ymin, xmin + size(rng), ymin + size(rng), label(rng));
+    indexed_scores->emplace_back(i, position(rng));
+  }
+  std::sort(indexed_scores->begin(), indexed_scores->end(),
+            [](const auto& a, const auto& b) { return a.second > b.second; });
+}
+
+NonMaxSuppressionCalculatorOptions MakeOptions(int grid_size, bool per_label) {
+  NonMaxSuppressionCalculatorOptions options;
+  options.set_min_suppression_threshold(0.3f);
+  options.set_overlap_type(
+      NonMaxSuppressionCalculatorOptions::INTERSECTION_OVER_UNION);
+  options.set_grid_size(grid_size);
+  options.set_per_label(per_label);
+  return options;
+}
+
+void RunNonMaxSuppression(benchmark::State& state,
+                          const NonMaxSuppressionCalculatorOptions& options) {
+  NmsBoxes boxes;
+  IndexedScores indexed_scores;
+  MakeCandidates(state.range(0), &boxes, &indexed_scores);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(NonMaxSuppression(
+        boxes, indexed_scores, options, indexed_scores.size()));
+  }
+}
+
+void RunWeightedNonMaxSuppression(
+    benchmark::State& state,
+    const NonMaxSuppressionCalculatorOptions& options) {
+  NmsBoxes boxes;
+  IndexedScores indexed_scores;
+  MakeCandidates(state.range(0), &boxes, &indexed_scores);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        WeightedNonMaxSuppression(boxes, indexed_scores, options));
+  }
+}
+
+void BM_BruteForce(benchmark::State& state) {
+  RunNonMaxSuppression(state, MakeOptions(/*grid_size=*/0, false));
+}
+
+void BM_Grid(benchmark::State& state) {
+  RunNonMaxSuppression(state, MakeOptions(/*grid_size=*/16, false));
+}
+
+void BM_BruteForcePerLabel(benchmark::State& state) {
+  RunNonMaxSuppression(state, MakeOptions(/*grid_size=*/0, true));
+}
+
+void BM_GridPerLabel(benchmark::State& state) {
+  RunNonMaxSuppression(state, MakeOptions(/*grid_size=*/16, true));
+}
+
+void BM_WeightedBruteForce(benchmark::State& state) {
+  RunWeightedNonMaxSuppression(state, MakeOptions(/*grid_size=*/0, false));
+}
+
+void BM_WeightedGrid(benchmark::State& state) {
+  RunWeightedNonMaxSuppression(state, MakeOptions(/*grid_size=*/16, false));
+}
+
+void NumCandidates(benchmark::internal::Benchmark* benchmark) {
+  benchmark->Arg(100)->Arg(1000)->Arg(3000)->Arg(10000);
+}
+
+BENCHMARK(BM_BruteForce)->Apply(NumCandidates);
+BENCHMARK(BM_Grid)->Apply(NumCandidates);
+BENCHMARK(BM_BruteForcePerLabel)->Apply(NumCandidates);
+BENCHMARK(BM_GridPerLabel)->Apply(NumCandidates);
+BENCHMARK(BM_WeightedBruteForce)->Apply(NumCandidates);
+BENCHMARK(BM_WeightedGrid)->Apply(NumCandidates);
+
+}  // namespace
+}  // namespace mediapipe
@@ -18,23 +18,28 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "mediapipe/calculators/util/non_max_suppression.h"
 #include "mediapipe/calculators/util/non_max_suppression_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/flat_detections.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/location.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/rectangle.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_macros.h"
 
 namespace mediapipe {
 
 typedef std::vector<Detection> Detections;
-typedef std::vector<std::pair<int, float>> IndexedScores;
 
 namespace {
 
 constexpr char kImageTag[] = "IMAGE";
+constexpr char kFlatDetectionsTag[] = "FLAT_DETECTIONS";
 
 bool SortBySecond(const std::pair<int, float>& indexed_score_0,
                   const std::pair<int, float>& indexed_score_1) {
@@ -73,51 +78,42 @@ bool RetainMaxScoringLabelOnly(Detection* detection) {
   return true;
 }
 
-// Computes an overlap similarity between two rectangles. Similarity measure is
-// defined by overlap_type parameter.
-float OverlapSimilarity(
-    const NonMaxSuppressionCalculatorOptions::OverlapType overlap_type,
-    const Rectangle_f& rect1, const Rectangle_f& rect2) {
-  if (!rect1.Intersects(rect2)) return 0.0f;
-  const float intersection_area = Rectangle_f(rect1).Intersect(rect2).Area();
-  float normalization;
-  switch (overlap_type) {
-    case NonMaxSuppressionCalculatorOptions::JACCARD:
-      normalization = Rectangle_f(rect1).Union(rect2).Area();
-      break;
-    case NonMaxSuppressionCalculatorOptions::MODIFIED_JACCARD:
-      normalization = rect2.Area();
-      break;
-    case NonMaxSuppressionCalculatorOptions::INTERSECTION_OVER_UNION:
-      normalization = rect1.Area() + rect2.Area() - intersection_area;
-      break;
-    default:
-      LOG(FATAL) << "Unrecognized overlap type: " << overlap_type;
+// Returns the label of a detection that retains only its max scoring label.
+int LabelOf(const Detection& detection,
+            absl::flat_hash_map<std::string, int>* label_ids) {
+  if (detection.label_id_size() > 0) {
+    return detection.label_id(0);
   }
-  return normalization > 0.0f ? intersection_area / normalization : 0.0f;
+  return label_ids->emplace(detection.label(0), label_ids->size())
+      .first->second;
 }
 
-// Computes an overlap similarity between two locations by first extracting the
-// relative box (dimension normalized by frame width/height) from the location.
-float OverlapSimilarity(
-    const int frame_width, const int frame_height,
-    const NonMaxSuppressionCalculatorOptions::OverlapType overlap_type,
-    const Location& location1, const Location& location2) {
-  const auto rect1 = location1.ConvertToRelativeBBox(frame_width, frame_height);
-  const auto rect2 = location2.ConvertToRelativeBBox(frame_width, frame_height);
-  return OverlapSimilarity(overlap_type, rect1, rect2);
+NmsBoxes ToNmsBoxes(const FlatDetections& detections) {
+  NmsBoxes boxes;
+  boxes.reserve(detections.size());
+  for (int i = 0; i < detections.size(); ++i) {
+    const float* box = detections.box(i);
+    boxes.Add(Rectangle_f(box[0], box[1], box[2], box[3]),
+              detections.class_id(i));
+  }
+  return boxes;
 }
 
-// Computes an overlap similarity between two locations by first extracting the
-// relative box from the location. It assumes that a relative-box representation
-// is already available in the location, and therefore frame width and height
-// are not needed for further normalization.
-float OverlapSimilarity(
-    const NonMaxSuppressionCalculatorOptions::OverlapType overlap_type,
-    const Location& location1, const Location& location2) {
-  const auto rect1 = location1.GetRelativeBBox();
-  const auto rect2 = location2.GetRelativeBBox();
-  return OverlapSimilarity(overlap_type, rect1, rect2);
+// Extracts the relative boxes (dimensions normalized by frame width/height) of
+// the detections. Without a frame size, a relative-box representation must
+// already be available in the locations.
+NmsBoxes ToNmsBoxes(const Detections& detections, const ImageFrame* frame) {
+  NmsBoxes boxes;
+  boxes.reserve(detections.size());
+  absl::flat_hash_map<std::string, int> label_ids;
+  for (const auto& detection : detections) {
+    const Location location(detection.location_data());
+    boxes.Add(frame != nullptr ? location.ConvertToRelativeBBox(frame->Width(),
+                                                               frame->Height())
+                               : location.GetRelativeBBox(),
+              LabelOf(detection, &label_ids));
+  }
+  return boxes;
 }
 
 }  // namespace
@@ -127,12 +123,22 @@ float OverlapSimilarity(
 //   1. IMAGE (optional): A stream of ImageFrame used to obtain the frame size.
 //      No image data is used. Not needed if the detection bounding boxes are
 //      already represented in normalized dimensions (0.0~1.0).
-//   2. A variable number of input streams of type std::vector<Detection>. The
-//      exact number of such streams should be set via num_detection_streams
-//      field in the calculator options.
+//   2. A variable number of input streams of type std::vector<Detection> or
+//      FlatDetections. The exact number of such streams should be set via
+//      num_detection_streams field in the calculator options.
+//
+// Outputs:
+//   1. (optional) A single stream of type std::vector<Detection> containing a
+//      subset of the input detections after non-maximum suppression.
+//   2. FLAT_DETECTIONS (optional): The same subset as FlatDetections.
 //
-// Outputs: a single stream of type std::vector<Detection> containing a subset
-//   of the input detections after non-maximum suppression.
+// Retained detections are bucketed into a spatial grid (see grid_size in the
+// options), so each detection is only compared against nearby ones. With
+// per_label, detections of different labels never suppress each other.
+//
+// When every input packet is FlatDetections, suppression runs directly on the
+// flat arrays without materializing Detection protos, and IMAGE is ignored
+// since flat boxes are always relative.
 //
 // Example config:
 // node {
@@ -161,9 +167,17 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
       cc->Inputs().Tag(kImageTag).Set<ImageFrame>();
     }
     for (int k = 0; k < options.num_detection_streams(); ++k) {
-      cc->Inputs().Index(k).Set<Detections>();
+      cc->Inputs().Index(k).SetOneOf<Detections, FlatDetections>();
+    }
+    if (cc->Outputs().NumEntries("") > 0) {
+      cc->Outputs().Index(0).Set<Detections>();
+    }
+    if (cc->Outputs().HasTag(kFlatDetectionsTag)) {
+      cc->Outputs().Tag(kFlatDetectionsTag).Set<FlatDetections>();
     }
-    cc->Outputs().Index(0).Set<Detections>();
+    RET_CHECK(cc->Outputs().NumEntries("") > 0 ||
+              cc->Outputs().HasTag(kFlatDetectionsTag))
+        << "At least one output stream must be specified.";
     return absl::OkStatus();
   }
 
@@ -181,6 +195,19 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
   }
 
   absl::Status Process(CalculatorContext* cc) override {
+    bool all_flat = true;
+    for (int i = 0; i < options_.num_detection_streams(); ++i) {
+      const auto& detections_packet = cc->Inputs().Index(i).Value();
+      if (!detections_packet.IsEmpty() &&
+          !detections_packet.ValidateAsType<FlatDetections>().ok()) {
+        all_flat = false;
+        break;
+      }
+    }
+    if (all_flat) {
+      return ProcessFlat(cc);
+    }
+
     // Add all input detections to the same vector.
     Detections input_detections;
     for (int i = 0; i < options_.num_detection_streams(); ++i) {
@@ -189,6 +216,13 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
       if (detections_packet.IsEmpty()) {
         continue;
       }
+      if (detections_packet.ValidateAsType<FlatDetections>().ok()) {
+        const Detections detections =
+            ToDetections(detections_packet.Get<FlatDetections>());
+        input_detections.insert(input_detections.end(), detections.begin(),
+                                detections.end());
+        continue;
+      }
       const auto& detections = detections_packet.Get<Detections>();
 
       input_detections.insert(input_detections.end(), detections.begin(),
@@ -198,7 +232,7 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
     // Check if there are any detections at all.
     if (input_detections.empty()) {
       if (options_.return_empty_detections()) {
-        cc->Outputs().Index(0).Add(new Detections(), cc->InputTimestamp());
+        return AddOutput(absl::make_unique<Detections>(), cc);
       }
       return absl::OkStatus();
     }
@@ -232,63 +266,200 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
             : static_cast<int>(indexed_scores.size());
     // A set of detections and locations, wrapping the location data from each
     // detection, which are retained after the non-maximum suppression.
-    auto* retained_detections = new Detections();
+    auto retained_detections = absl::make_unique<Detections>();
     retained_detections->reserve(max_num_detections);
 
     if (options_.algorithm() == NonMaxSuppressionCalculatorOptions::WEIGHTED) {
       WeightedNonMaxSuppression(indexed_scores, pruned_detections,
-                                max_num_detections, cc, retained_detections);
+                                max_num_detections, cc,
+                                retained_detections.get());
     } else {
       NonMaxSuppression(indexed_scores, pruned_detections, max_num_detections,
-                        cc, retained_detections);
+                        cc, retained_detections.get());
     }
 
-    cc->Outputs().Index(0).Add(retained_detections, cc->InputTimestamp());
+    return AddOutput(std::move(retained_detections), cc);
+  }
 
+ private:
+  absl::Status AddOutput(std::unique_ptr<Detections> detections,
+                         CalculatorContext* cc) {
+    if (cc->Outputs().HasTag(kFlatDetectionsTag)) {
+      ASSIGN_OR_RETURN(FlatDetections flat_detections,
+                       FromDetections(*detections));
+      cc->Outputs()
+          .Tag(kFlatDetectionsTag)
+          .AddPacket(MakePacket<FlatDetections>(std::move(flat_detections))
+                         .At(cc->InputTimestamp()));
+    }
+    if (cc->Outputs().NumEntries("") > 0) {
+      cc->Outputs().Index(0).Add(detections.release(), cc->InputTimestamp());
+    }
     return absl::OkStatus();
   }
 
- private:
-  void NonMaxSuppression(const IndexedScores& indexed_scores,
-                         const Detections& detections, int max_num_detections,
-                         CalculatorContext* cc, Detections* output_detections) {
-    std::vector<Location> retained_locations;
-    retained_locations.reserve(max_num_detections);
-    // We traverse the detections by decreasing score.
-    for (const auto& indexed_score : indexed_scores) {
-      const auto& detection = detections[indexed_score.first];
-      if (options_.min_score_threshold() > 0 &&
-          detection.score(0) < options_.min_score_threshold()) {
-        break;
+  absl::Status AddOutput(std::unique_ptr<FlatDetections> detections,
+                         CalculatorContext* cc) {
+    if (cc->Outputs().NumEntries("") > 0) {
+      cc->Outputs().Index(0).AddPacket(
+          MakePacket<Detections>(ToDetections(*detections))
+              .At(cc->InputTimestamp()));
+    }
+    if (cc->Outputs().HasTag(kFlatDetectionsTag)) {
+      cc->Outputs()
+          .Tag(kFlatDetectionsTag)
+          .Add(detections.release(), cc->InputTimestamp());
+    }
+    return absl::OkStatus();
+  }
+
+  // Runs suppression directly on FlatDetections inputs. Flat detections carry
+  // a single score and class id each, so no label pruning is needed.
+  absl::Status ProcessFlat(CalculatorContext* cc) {
+    const FlatDetections* single_input = nullptr;
+    int num_inputs = 0;
+    int num_detections = 0;
+    for (int i = 0; i < options_.num_detection_streams(); ++i) {
+      const auto& detections_packet = cc->Inputs().Index(i).Value();
+      if (detections_packet.IsEmpty()) {
+        continue;
+      }
+      single_input = &detections_packet.Get<FlatDetections>();
+      num_detections += single_input->size();
+      ++num_inputs;
+    }
+
+    if (num_detections == 0) {
+      if (options_.return_empty_detections()) {
+        const int num_keypoints =
+            single_input != nullptr ? single_input->num_keypoints() : 0;
+        return AddOutput(absl::make_unique<FlatDetections>(num_keypoints), cc);
       }
-      const Location location(detection.location_data());
-      bool suppressed = false;
-      // The current detection is suppressed iff there exists a retained
-      // detection, whose location overlaps more than the specified
-      // threshold with the location of the current detection.
-      for (const auto& retained_location : retained_locations) {
-        float similarity;
-        if (cc->Inputs().HasTag(kImageTag)) {
-          const auto& frame = cc->Inputs().Tag(kImageTag).Get<ImageFrame>();
-          similarity = OverlapSimilarity(frame.Width(), frame.Height(),
-                                         options_.overlap_type(),
-                                         retained_location, location);
-        } else {
-          similarity = OverlapSimilarity(options_.overlap_type(),
-                                         retained_location, location);
+      return absl::OkStatus();
+    }
+
+    // Concatenates the inputs only when there is more than one of them.
+    FlatDetections merged_detections;
+    const FlatDetections* input_detections = single_input;
+    if (num_inputs > 1) {
+      merged_detections = FlatDetections(single_input->num_keypoints());
+      merged_detections.reserve(num_detections);
+      for (int i = 0; i < options_.num_detection_streams(); ++i) {
+        const auto& detections_packet = cc->Inputs().Index(i).Value();
+        if (detections_packet.IsEmpty()) {
+          continue;
         }
-        if (similarity > options_.min_suppression_threshold()) {
-          suppressed = true;
-          break;
+        const auto& detections = detections_packet.Get<FlatDetections>();
+        RET_CHECK_EQ(detections.num_keypoints(),
+                     merged_detections.num_keypoints());
+        for (int k = 0; k < detections.size(); ++k) {
+          const float* box = detections.box(k);
+          merged_detections.Add(box[0], box[1], box[2], box[3],
+                                detections.score(k), detections.class_id(k),
+                                detections.keypoints(k));
         }
       }
-      if (!suppressed) {
-        output_detections->push_back(detection);
-        retained_locations.push_back(location);
+      input_detections = &merged_detections;
+    }
+
+    IndexedScores indexed_scores;
+    indexed_scores.reserve(input_detections->size());
+    for (int index = 0; index < input_detections->size(); ++index) {
+      indexed_scores.push_back(
+          std::make_pair(index, input_detections->score(index)));
+    }
+    std::sort(indexed_scores.begin(), indexed_scores.end(), SortBySecond);
+
+    const int max_num_detections =
+        (options_.max_num_detections() > -1)
+            ? options_.max_num_detections()
+            : static_cast<int>(indexed_scores.size());
+    auto retained_detections =
+        absl::make_unique<FlatDetections>(input_detections->num_keypoints());
+    retained_detections->reserve(
+        std::min<int>(max_num_detections, indexed_scores.size()));
+
+    if (options_.algorithm() == NonMaxSuppressionCalculatorOptions::WEIGHTED) {
+      WeightedNonMaxSuppression(indexed_scores, *input_detections,
+                                retained_detections.get());
+    } else {
+      NonMaxSuppression(indexed_scores, *input_detections, max_num_detections,
+                        retained_detections.get());
+    }
+
+    return AddOutput(std::move(retained_detections), cc);
+  }
+
+  void NonMaxSuppression(const IndexedScores& indexed_scores,
+                         const FlatDetections& detections,
+                         int max_num_detections,
+                         FlatDetections* output_detections) {
+    for (const int index :
+         mediapipe::NonMaxSuppression(ToNmsBoxes(detections), indexed_scores,
+                                      options_, max_num_detections)) {
+      const float* b = detections.box(index);
+      output_detections->Add(b[0], b[1], b[2], b[3], detections.score(index),
+                             detections.class_id(index),
+                             detections.keypoints(index));
+    }
+  }
+
+  void WeightedNonMaxSuppression(const IndexedScores& indexed_scores,
+                                 const FlatDetections& detections,
+                                 FlatDetections* output_detections) {
+    const int num_keypoints = detections.num_keypoints();
+    std::vector<float> keypoints(num_keypoints * 2);
+    for (const auto& cluster : mediapipe::WeightedNonMaxSuppression(
+             ToNmsBoxes(detections), indexed_scores, options_)) {
+      const int index = cluster.top_index;
+      if (cluster.members.empty()) {
+        const float* b = detections.box(index);
+        output_detections->Add(b[0], b[1], b[2], b[3], detections.score(index),
+                               detections.class_id(index),
+                               detections.keypoints(index));
+        continue;
       }
-      if (output_detections->size() >= max_num_detections) {
-        break;
+      std::fill(keypoints.begin(), keypoints.end(), 0.0f);
+      float w_xmin = 0.0f;
+      float w_ymin = 0.0f;
+      float w_xmax = 0.0f;
+      float w_ymax = 0.0f;
+      float total_score = 0.0f;
+      for (const auto& candidate : cluster.members) {
+        total_score += candidate.second;
+        const float* b = detections.box(candidate.first);
+        w_xmin += b[0] * candidate.second;
+        w_ymin += b[1] * candidate.second;
+        w_xmax += (b[0] + b[2]) * candidate.second;
+        w_ymax += (b[1] + b[3]) * candidate.second;
+        const float* candidate_keypoints =
+            detections.keypoints(candidate.first);
+        for (int i = 0; i < num_keypoints * 2; ++i) {
+          keypoints[i] += candidate_keypoints[i] * candidate.second;
+        }
       }
+      for (float& value : keypoints) value /= total_score;
+      const float xmin = w_xmin / total_score;
+      const float ymin = w_ymin / total_score;
+      output_detections->Add(xmin, ymin, w_xmax / total_score - xmin,
+                             w_ymax / total_score - ymin,
+                             detections.score(index),
+                             detections.class_id(index), keypoints.data());
+    }
+  }
+
+  void NonMaxSuppression(const IndexedScores& indexed_scores,
+                         const Detections& detections, int max_num_detections,
+                         CalculatorContext* cc, Detections* output_detections) {
+    const ImageFrame* frame =
+        cc->Inputs().HasTag(kImageTag)
+            ? &cc->Inputs().Tag(kImageTag).Get<ImageFrame>()
+            : nullptr;
+    // We traverse the detections by decreasing score.
+    for (const int index : mediapipe::NonMaxSuppression(
+             ToNmsBoxes(detections, frame), indexed_scores, options_,
+             max_num_detections)) {
+      output_detections->push_back(detections[index]);
     }
   }
 
@@ -296,36 +467,13 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
                                  const Detections& detections,
                                  int max_num_detections, CalculatorContext* cc,
                                  Detections* output_detections) {
-    IndexedScores remained_indexed_scores;
-    remained_indexed_scores.assign(indexed_scores.begin(),
-                                   indexed_scores.end());
-
-    IndexedScores remained;
-    IndexedScores candidates;
     output_detections->clear();
-    while (!remained_indexed_scores.empty()) {
-      const int original_indexed_scores_size = remained_indexed_scores.size();
-      const auto& detection = detections[remained_indexed_scores[0].first];
-      if (options_.min_score_threshold() > 0 &&
-          detection.score(0) < options_.min_score_threshold()) {
-        break;
-      }
-      remained.clear();
-      candidates.clear();
-      const Location location(detection.location_data());
-      // This includes the first box.
-      for (const auto& indexed_score : remained_indexed_scores) {
-        Location rest_location(detections[indexed_score.first].location_data());
-        float similarity =
-            OverlapSimilarity(options_.overlap_type(), rest_location, location);
-        if (similarity > options_.min_suppression_threshold()) {
-          candidates.push_back(indexed_score);
-        } else {
-          remained.push_back(indexed_score);
-        }
-      }
+    for (const auto& cluster : mediapipe::WeightedNonMaxSuppression(
+             ToNmsBoxes(detections, /*frame=*/nullptr), indexed_scores,
+             options_)) {
+      const auto& detection = detections[cluster.top_index];
       auto weighted_detection = detection;
-      if (!candidates.empty()) {
+      if (!cluster.members.empty()) {
         const int num_keypoints =
             detection.location_data().relative_keypoints_size();
         std::vector<float> keypoints(num_keypoints * 2);
@@ -334,7 +482,7 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
         float w_xmax = 0.0f;
         float w_ymax = 0.0f;
         float total_score = 0.0f;
-        for (const auto& candidate : candidates) {
+        for (const auto& candidate : cluster.members) {
           total_score += candidate.second;
           const auto& location_data =
               detections[candidate.first].location_data();
@@ -366,15 +514,7 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
           keypoint->set_y(keypoints[i * 2 + 1] / total_score);
         }
       }
-
       output_detections->push_back(weighted_detection);
-      // Breaks the loop if the size of indexed scores doesn't change after an
-      // iteration.
-      if (original_indexed_scores_size == remained.size()) {
-        break;
-      } else {
-        remained_indexed_scores = std::move(remained);
-      }
     }
   }
 
@@ -24,6 +24,7 @@
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/timestamp.h"
+#include "mediapipe/util/hdr_histogram.h"
 
 namespace mediapipe {
 
@@ -43,7 +44,9 @@ constexpr char kReferenceSignalTag[] = "REFERENCE_SIGNAL";
 // between arrival times of the two. A latency of X microseconds implies that
 // the packet arrived X microseconds after its corresponding reference packet.
 // For each packet stream, the calculator outputs the current latency, average,
-// and a histogram of observed latencies so far.
+// and a histogram of observed latencies so far. If hdr_precision_bits is set,
+// it also outputs periodic snapshots of the p50/p90/p99/p99.9 latencies and of
+// the high-dynamic-range histogram they are computed from.
 //
 // NOTE:
 // 1) This calculator is meant to be used ONLY with an
@@ -91,6 +94,7 @@ constexpr char kReferenceSignalTag[] = "REFERENCE_SIGNAL";
 //     [soapbox.PacketLatencyCalculatorOptions.ext] {
 //       num_intervals: 10
 //       interval_size_usec: 10000
+//       hdr_precision_bits: 7
 //     }
 //   }
 //   input_stream_handler {
@@ -111,6 +115,10 @@ class PacketLatencyCalculator : public CalculatorBase {
   // zero.
   void ResetStatistics();
 
+  // Copies the percentiles and the high-dynamic-range histogram of stream i to
+  // its latency output.
+  void SnapshotHdrHistogram(int64 i);
+
   // Calculator options.
   PacketLatencyCalculatorOptions options_;
 
@@ -136,6 +144,11 @@ class PacketLatencyCalculator : public CalculatorBase {
 
   // Clock time when last reset was done for histogram and running average.
   int64 last_reset_time_usec_ = -1;
+
+  // High-dynamic-range histograms of latencies for each packet stream, if
+  // enabled, and the clock time of the next snapshot of each.
+  std::vector<HdrHistogram> hdr_histograms_;
+  std::vector<int64> next_snapshot_time_usec_;
 };
 REGISTER_CALCULATOR(PacketLatencyCalculator);
 
@@ -175,6 +188,19 @@ void PacketLatencyCalculator::ResetStatistics() {
     sum_latencies_usec_[i] = 0;
     num_latencies_[i] = 0;
   }
+  for (auto& hdr_histogram : hdr_histograms_) {
+    hdr_histogram.Reset();
+  }
+}
+
+void PacketLatencyCalculator::SnapshotHdrHistogram(int64 i) {
+  const HdrHistogram& hdr_histogram = hdr_histograms_[i];
+  PacketLatency& packet_latency = packet_latencies_[i];
+  packet_latency.set_p50_latency_usec(hdr_histogram.ValueAtPercentile(50));
+  packet_latency.set_p90_latency_usec(hdr_histogram.ValueAtPercentile(90));
+  packet_latency.set_p99_latency_usec(hdr_histogram.ValueAtPercentile(99));
+  packet_latency.set_p999_latency_usec(hdr_histogram.ValueAtPercentile(99.9));
+  hdr_histogram.ToProto(packet_latency.mutable_hdr_histogram());
 }
 
 absl::Status PacketLatencyCalculator::Open(CalculatorContext* cc) {
@@ -191,6 +217,13 @@ absl::Status PacketLatencyCalculator::Open(CalculatorContext* cc) {
   // Check that histogram params are valid.
   RET_CHECK_GT(options_.num_intervals(), 0);
   RET_CHECK_GT(options_.interval_size_usec(), 0);
+  if (options_.hdr_precision_bits() > 0) {
+    RET_CHECK_LE(options_.hdr_precision_bits(), 14);
+    RET_CHECK_GE(options_.snapshot_interval_usec(), 0);
+    hdr_histograms_.assign(num_packet_streams_,
+                           HdrHistogram(options_.hdr_precision_bits()));
+    next_snapshot_time_usec_.assign(num_packet_streams_, 0);
+  }
 
   // Initialize latency outputs for all streams.
   packet_latencies_.resize(num_packet_streams_);
@@ -284,6 +317,15 @@ absl::Status PacketLatencyCalculator::Process(CalculatorContext* cc) {
 
       packet_latencies_[i].set_sum_latency_usec(sum_latencies_usec_[i]);
 
+      if (!hdr_histograms_.empty()) {
+        hdr_histograms_[i].Record(packet_latency_usec);
+        if (current_clock_time_usec >= next_snapshot_time_usec_[i]) {
+          SnapshotHdrHistogram(i);
+          next_snapshot_time_usec_[i] =
+              current_clock_time_usec + options_.snapshot_interval_usec();
+        }
+      }
+
       // Push the latency packet to output.
       auto packet_latency =
           absl::make_unique<PacketLatency>(packet_latencies_[i]);
@@ -77,6 +77,48 @@ class PacketLatencyCalculatorTest : public ::testing::Test {
     MP_ASSERT_OK(graph_.WaitUntilIdle());
   }
 
+  void InitializeSingleStreamGraphWithHdrHistogram() {
+    graph_config_ = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+      input_stream: "delayed_packet_0"
+      input_stream: "camera_frames"
+      node {
+        calculator: "PacketLatencyCalculator"
+        input_side_packet: "CLOCK:clock"
+        input_stream: "delayed_packet_0"
+        input_stream: "REFERENCE_SIGNAL:camera_frames"
+        output_stream: "packet_latency_0"
+        options {
+          [mediapipe.PacketLatencyCalculatorOptions.ext] {
+            num_intervals: 3
+            interval_size_usec: 4
+            packet_labels: "dummy input 0"
+            hdr_precision_bits: 7
+            snapshot_interval_usec: 0
+          }
+        }
+        input_stream_handler {
+          input_stream_handler: "ImmediateInputStreamHandler"
+        }
+      }
+    )pb");
+
+    mediapipe::tool::AddVectorSink("packet_latency_0", &graph_config_,
+                                   &out_0_packets_);
+
+    // Create the simulation clock side packet.
+    SetupSimulationClock();
+    std::map<std::string, ::mediapipe::Packet> side_packet;
+    side_packet["clock"] =
+        ::mediapipe::MakePacket<std::shared_ptr<::mediapipe::Clock>>(
+            simulation_clock_);
+
+    // Start graph run.
+    MP_ASSERT_OK(graph_.Initialize(graph_config_, {}));
+    MP_ASSERT_OK(graph_.StartRun(side_packet));
+    // Let Calculator::Open() calls finish before continuing.
+    MP_ASSERT_OK(graph_.WaitUntilIdle());
+  }
+
   void InitializeMultipleStreamGraph() {
     graph_config_ = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
       input_stream: "delayed_packet_0"
@@ -262,6 +304,49 @@ TEST_F(PacketLatencyCalculatorTest, OutputsCorrectLatencyForSingleStream) {
           /*counts=*/{0, 1, 1}, /*avg_latency_usec=*/7, "dummy input 0")));
 }
 
+// Calculator must output latency percentiles when hdr_precision_bits is set.
+TEST_F(PacketLatencyCalculatorTest, OutputsLatencyPercentiles) {
+  InitializeSingleStreamGraphWithHdrHistogram();
+  dynamic_cast<SimulationClock*>(&*simulation_clock_)->ThreadStart();
+
+  // Send a reference packet with timestamp 10 usec at time 12 usec.
+  simulation_clock_->Sleep(absl::Microseconds(12));
+  MP_ASSERT_OK(graph_.AddPacketToInputStream(
+      "camera_frames", Adopt(new double()).At(Timestamp(10))));
+
+  // Add two delayed packets with latencies 10 and 4 usec resp.
+  simulation_clock_->Sleep(absl::Microseconds(1));
+  MP_ASSERT_OK(graph_.AddPacketToInputStream(
+      "delayed_packet_0", Adopt(new double()).At(Timestamp(1))));
+  simulation_clock_->Sleep(absl::Microseconds(1));
+  MP_ASSERT_OK(graph_.AddPacketToInputStream(
+      "delayed_packet_0", Adopt(new double()).At(Timestamp(8))));
+
+  dynamic_cast<SimulationClock*>(&*simulation_clock_)->ThreadFinish();
+  MP_ASSERT_OK(graph_.CloseAllInputStreams());
+  MP_ASSERT_OK(graph_.WaitUntilDone());
+
+  ASSERT_EQ(out_0_packets_.size(), 2);
+  const PacketLatency& first = out_0_packets_[0].Get<PacketLatency>();
+  EXPECT_EQ(first.p50_latency_usec(), 10);
+  EXPECT_EQ(first.p99_latency_usec(), 10);
+
+  // Small latencies fall into exact buckets.
+  const PacketLatency& second = out_0_packets_[1].Get<PacketLatency>();
+  EXPECT_EQ(second.p50_latency_usec(), 4);
+  EXPECT_EQ(second.p90_latency_usec(), 10);
+  EXPECT_EQ(second.p99_latency_usec(), 10);
+  EXPECT_EQ(second.p999_latency_usec(), 10);
+  EXPECT_EQ(second.hdr_histogram().precision_bits(), 7);
+  EXPECT_THAT(second.hdr_histogram().bucket_indices(),
+              testing::ElementsAre(4, 10));
+  EXPECT_THAT(second.hdr_histogram().bucket_counts(),
+              testing::ElementsAre(1, 1));
+  EXPECT_EQ(second.hdr_histogram().sum(), 14);
+  EXPECT_EQ(second.hdr_histogram().min(), 4);
+  EXPECT_EQ(second.hdr_histogram().max(), 10);
+}
+
 // Calculator must not output latency until reference signal is received.
 TEST_F(PacketLatencyCalculatorTest, DoesNotOutputUntilReferencePacketReceived) {
   // Initialize graph_.
@@ -0,0 +1,87 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+
+#include "mediapipe/calculators/util/packet_log_recorder_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/util/packet_log.h"
+
+namespace mediapipe {
+
+// Records the packets of all its input streams to a packet log (see
+// mediapipe/util/packet_log.h), so that the real inputs of a graph can be
+// replayed later with PacketLogReplayCalculator.
+//
+// Inputs:
+//   Any number of streams of ImageFrame, Tensor, protos or types registered
+//   with serialization functions. The stream names are stored in the log, in
+//   the order of the input streams.
+//
+// Example config:
+// node {
+//   calculator: "PacketLogRecorderCalculator"
+//   input_stream: "input_video"
+//   input_stream: "input_tensors"
+//   options {
+//     [mediapipe.PacketLogRecorderCalculatorOptions.ext] {
+//       file_path: "/tmp/graph_inputs.log"
+//     }
+//   }
+// }
+class PacketLogRecorderCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    RET_CHECK_GT(cc->Inputs().NumEntries(), 0);
+    for (CollectionItemId id = cc->Inputs().BeginId();
+         id < cc->Inputs().EndId(); ++id) {
+      cc->Inputs().Get(id).SetAny();
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    const auto& options =
+        cc->Options<::mediapipe::PacketLogRecorderCalculatorOptions>();
+    RET_CHECK(!options.file_path().empty()) << "file_path is required";
+    ASSIGN_OR_RETURN(writer_,
+                     PacketLogWriter::Create(options.file_path(),
+                                             cc->Inputs().TagMap()->Names()));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    for (CollectionItemId id = cc->Inputs().BeginId();
+         id < cc->Inputs().EndId(); ++id) {
+      const Packet& packet = cc->Inputs().Get(id).Value();
+      if (packet.IsEmpty()) continue;
+      MP_RETURN_IF_ERROR(writer_->Append(id.value(), packet));
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Close(CalculatorContext* cc) override {
+    if (writer_ == nullptr) return absl::OkStatus();
+    return writer_->Close();
+  }
+
+ private:
+  std::unique_ptr<PacketLogWriter> writer_;
+};
+REGISTER_CALCULATOR(PacketLogRecorderCalculator);
+
+}  // namespace mediapipe
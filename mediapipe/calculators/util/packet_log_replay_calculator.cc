@@ -0,0 +1,135 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+
+#include "absl/time/time.h"
+#include "mediapipe/calculators/util/packet_log_replay_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/deps/clock.h"
+#include "mediapipe/framework/deps/monotonic_clock.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/timestamp.h"
+#include "mediapipe/framework/tool/status_util.h"
+#include "mediapipe/util/packet_log.h"
+
+namespace mediapipe {
+namespace {
+// Tag name for clock side packet.
+constexpr char kClockTag[] = "CLOCK";
+}  // namespace
+
+// Replays a packet log written by PacketLogRecorderCalculator, outputting the
+// packets of the n-th recorded stream on the n-th output stream.
+//
+// The log is memory-mapped and ImageFrame payloads are not copied, so replay
+// costs next to nothing compared with decoding the original input. Replayed
+// ImageFrames are read-only and must not be consumed and modified in place.
+//
+// By default packets are output as fast as the graph takes them, which suits
+// throughput benchmarks. With `realtime` they are paced by their timestamps,
+// as a camera or a video decoder would deliver them.
+//
+// InputSidePacket (Optional):
+// CLOCK: A clock to pace realtime replay with.
+//
+// Example config:
+// node {
+//   calculator: "PacketLogReplayCalculator"
+//   output_stream: "input_video"
+//   output_stream: "input_tensors"
+//   options {
+//     [mediapipe.PacketLogReplayCalculatorOptions.ext] {
+//       file_path: "/tmp/graph_inputs.log"
+//       realtime: true
+//     }
+//   }
+// }
+class PacketLogReplayCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    RET_CHECK_GT(cc->Outputs().NumEntries(), 0);
+    for (CollectionItemId id = cc->Outputs().BeginId();
+         id < cc->Outputs().EndId(); ++id) {
+      cc->Outputs().Get(id).SetAny();
+    }
+    if (cc->InputSidePackets().HasTag(kClockTag)) {
+      cc->InputSidePackets()
+          .Tag(kClockTag)
+          .Set<std::shared_ptr<::mediapipe::Clock>>();
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    options_ = cc->Options<::mediapipe::PacketLogReplayCalculatorOptions>();
+    RET_CHECK(!options_.file_path().empty()) << "file_path is required";
+    ASSIGN_OR_RETURN(reader_, PacketLogReader::Open(options_.file_path()));
+    RET_CHECK_EQ(reader_->stream_names().size(), cc->Outputs().NumEntries())
+        << "The packet log has a different number of streams: "
+        << options_.file_path();
+    reader_->Prefetch();
+
+    if (cc->InputSidePackets().HasTag(kClockTag)) {
+      clock_ = cc->InputSidePackets()
+                   .Tag(kClockTag)
+                   .Get<std::shared_ptr<::mediapipe::Clock>>();
+    } else if (options_.realtime()) {
+      clock_.reset(
+          ::mediapipe::MonotonicClock::CreateSynchronizedMonotonicClock());
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    const auto& records = reader_->records();
+    if (next_record_ >= records.size()) {
+      return tool::StatusStop();
+    }
+    const Timestamp timestamp = records[next_record_].timestamp;
+    if (options_.realtime()) {
+      if (next_record_ == 0) {
+        start_time_ = clock_->TimeNow();
+        start_timestamp_ = timestamp;
+      } else {
+        clock_->SleepUntil(
+            start_time_ +
+            absl::Microseconds((timestamp - start_timestamp_).Value()));
+      }
+    }
+    // Outputs all packets recorded at this timestamp in one go.
+    for (; next_record_ < records.size() &&
+           records[next_record_].timestamp == timestamp;
+         ++next_record_) {
+      ASSIGN_OR_RETURN(Packet packet, reader_->ReadPacket(next_record_));
+      cc->Outputs()
+          .Get(cc->Outputs().BeginId() + records[next_record_].stream_index)
+          .AddPacket(std::move(packet));
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  ::mediapipe::PacketLogReplayCalculatorOptions options_;
+  std::unique_ptr<PacketLogReader> reader_;
+  std::shared_ptr<::mediapipe::Clock> clock_;
+  size_t next_record_ = 0;
+  absl::Time start_time_;
+  Timestamp start_timestamp_;
+};
+REGISTER_CALCULATOR(PacketLogReplayCalculator);
+
+}  // namespace mediapipe
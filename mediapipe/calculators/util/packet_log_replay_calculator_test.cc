@@ -0,0 +1,134 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/substitute.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/tool/sink.h"
+#include "mediapipe/util/packet_log.h"
+
+namespace mediapipe {
+namespace {
+
+// Records frames at timestamps 0, 10, 20 and a detection at timestamp 10.
+void RecordLog(const std::string& path) {
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(absl::Substitute(
+      R"pb(
+        input_stream: "video"
+        input_stream: "detections"
+        node {
+          calculator: "PacketLogRecorderCalculator"
+          input_stream: "video"
+          input_stream: "detections"
+          options {
+            [mediapipe.PacketLogRecorderCalculatorOptions.ext] {
+              file_path: "$0"
+            }
+          }
+        }
+      )pb",
+      path));
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < 3; ++i) {
+    auto frame = absl::make_unique<ImageFrame>(ImageFormat::GRAY8, 4, 2);
+    frame->SetToZero();
+    frame->MutablePixelData()[0] = i;
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "video", Adopt(frame.release()).At(Timestamp(i * 10))));
+  }
+  Detection detection;
+  detection.add_label("cat");
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "detections", MakePacket<Detection>(detection).At(Timestamp(10))));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+TEST(PacketLogReplayCalculatorTest, ReplaysRecordedInputs) {
+  const std::string path =
+      file::JoinPath(::testing::TempDir(), "packet_log_replay.log");
+  RecordLog(path);
+
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(absl::Substitute(
+      R"pb(
+        node {
+          calculator: "PacketLogReplayCalculator"
+          output_stream: "video"
+          output_stream: "detections"
+          options {
+            [mediapipe.PacketLogReplayCalculatorOptions.ext] {
+              file_path: "$0"
+              realtime: true
+            }
+          }
+        }
+      )pb",
+      path));
+  std::vector<Packet> video_packets;
+  std::vector<Packet> detection_packets;
+  tool::AddVectorSink("video", &config, &video_packets);
+  tool::AddVectorSink("detections", &config, &detection_packets);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.Run());
+
+  ASSERT_EQ(video_packets.size(), 3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(video_packets[i].Timestamp(), Timestamp(i * 10));
+    const auto& frame = video_packets[i].Get<ImageFrame>();
+    EXPECT_EQ(frame.Width(), 4);
+    EXPECT_EQ(frame.PixelData()[0], i);
+  }
+  ASSERT_EQ(detection_packets.size(), 1);
+  EXPECT_EQ(detection_packets[0].Timestamp(), Timestamp(10));
+  EXPECT_EQ(detection_packets[0].Get<Detection>().label(0), "cat");
+}
+
+TEST(PacketLogReplayCalculatorTest, FailsOnStreamCountMismatch) {
+  const std::string path =
+      file::JoinPath(::testing::TempDir(), "packet_log_mismatch.log");
+  RecordLog(path);
+
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(absl::Substitute(
+      R"pb(
+        node {
+          calculator: "PacketLogReplayCalculator"
+          output_stream: "video"
+          options {
+            [mediapipe.PacketLogReplayCalculatorOptions.ext] {
+              file_path: "$0"
+            }
+          }
+        }
+      )pb",
+      path));
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  EXPECT_FALSE(graph.Run().ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -18,6 +18,7 @@
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/color.pb.h"
 #include "mediapipe/util/render_data.pb.h"
+#include "mediapipe/util/render_data_pool.h"
 
 namespace mediapipe {
 
@@ -109,6 +110,7 @@ class RectToRenderDataCalculator : public CalculatorBase {
 
  private:
   RectToRenderDataCalculatorOptions options_;
+  RenderDataPool render_data_pool_;
 };
 REGISTER_CALCULATOR(RectToRenderDataCalculator);
 
@@ -153,19 +155,19 @@ absl::Status RectToRenderDataCalculator::Open(CalculatorContext* cc) {
 }
 
 absl::Status RectToRenderDataCalculator::Process(CalculatorContext* cc) {
-  auto render_data = absl::make_unique<RenderData>();
+  RenderData* render_data = render_data_pool_.NewRenderData();
 
   if (cc->Inputs().HasTag(kNormRectTag) &&
       !cc->Inputs().Tag(kNormRectTag).IsEmpty()) {
     const auto& rect = cc->Inputs().Tag(kNormRectTag).Get<NormalizedRect>();
-    auto* rectangle = NewRect(options_, render_data.get());
+    auto* rectangle = NewRect(options_, render_data);
     SetRect(/*normalized=*/true, rect.x_center() - rect.width() / 2.f,
             rect.y_center() - rect.height() / 2.f, rect.width(), rect.height(),
             rect.rotation(), rectangle);
   }
   if (cc->Inputs().HasTag(kRectTag) && !cc->Inputs().Tag(kRectTag).IsEmpty()) {
     const auto& rect = cc->Inputs().Tag(kRectTag).Get<Rect>();
-    auto* rectangle = NewRect(options_, render_data.get());
+    auto* rectangle = NewRect(options_, render_data);
     SetRect(/*normalized=*/false, rect.x_center() - rect.width() / 2.f,
             rect.y_center() - rect.height() / 2.f, rect.width(), rect.height(),
             rect.rotation(), rectangle);
@@ -175,7 +177,7 @@ absl::Status RectToRenderDataCalculator::Process(CalculatorContext* cc) {
     const auto& rects =
         cc->Inputs().Tag(kNormRectsTag).Get<std::vector<NormalizedRect>>();
     for (auto& rect : rects) {
-      auto* rectangle = NewRect(options_, render_data.get());
+      auto* rectangle = NewRect(options_, render_data);
       SetRect(/*normalized=*/true, rect.x_center() - rect.width() / 2.f,
               rect.y_center() - rect.height() / 2.f, rect.width(),
               rect.height(), rect.rotation(), rectangle);
@@ -185,7 +187,7 @@ absl::Status RectToRenderDataCalculator::Process(CalculatorContext* cc) {
       !cc->Inputs().Tag(kRectsTag).IsEmpty()) {
     const auto& rects = cc->Inputs().Tag(kRectsTag).Get<std::vector<Rect>>();
     for (auto& rect : rects) {
-      auto* rectangle = NewRect(options_, render_data.get());
+      auto* rectangle = NewRect(options_, render_data);
       SetRect(/*normalized=*/false, rect.x_center() - rect.width() / 2.f,
               rect.y_center() - rect.height() / 2.f, rect.width(),
               rect.height(), rect.rotation(), rectangle);
@@ -194,7 +196,7 @@ absl::Status RectToRenderDataCalculator::Process(CalculatorContext* cc) {
 
   cc->Outputs()
       .Tag(kRenderDataTag)
-      .Add(render_data.release(), cc->InputTimestamp());
+      .AddPacket(render_data_pool_.MakePacket().At(cc->InputTimestamp()));
 
   return absl::OkStatus();
 }
@@ -121,12 +121,11 @@ absl::Status RectTransformationCalculator::Process(CalculatorContext* cc) {
   }
   if (cc->Inputs().HasTag(kRectsTag) &&
       !cc->Inputs().Tag(kRectsTag).IsEmpty()) {
-    auto rects = cc->Inputs().Tag(kRectsTag).Get<std::vector<Rect>>();
-    auto output_rects = absl::make_unique<std::vector<Rect>>(rects.size());
-    for (int i = 0; i < rects.size(); ++i) {
-      output_rects->at(i) = rects[i];
-      auto it = output_rects->begin() + i;
-      TransformRect(&(*it));
+    // Transforms a single copy of the input rects in place.
+    auto output_rects = absl::make_unique<std::vector<Rect>>(
+        cc->Inputs().Tag(kRectsTag).Get<std::vector<Rect>>());
+    for (Rect& rect : *output_rects) {
+      TransformRect(&rect);
     }
     cc->Outputs().Index(0).Add(output_rects.release(), cc->InputTimestamp());
   }
@@ -141,16 +140,12 @@ absl::Status RectTransformationCalculator::Process(CalculatorContext* cc) {
   }
   if (HasTagValue(cc->Inputs(), kNormRectsTag) &&
       HasTagValue(cc->Inputs(), kImageSizeTag)) {
-    auto rects =
-        cc->Inputs().Tag(kNormRectsTag).Get<std::vector<NormalizedRect>>();
     const auto& image_size =
         cc->Inputs().Tag(kImageSizeTag).Get<std::pair<int, int>>();
-    auto output_rects =
-        absl::make_unique<std::vector<NormalizedRect>>(rects.size());
-    for (int i = 0; i < rects.size(); ++i) {
-      output_rects->at(i) = rects[i];
-      auto it = output_rects->begin() + i;
-      TransformNormalizedRect(&(*it), image_size.first, image_size.second);
+    auto output_rects = absl::make_unique<std::vector<NormalizedRect>>(
+        cc->Inputs().Tag(kNormRectsTag).Get<std::vector<NormalizedRect>>());
+    for (NormalizedRect& rect : *output_rects) {
+      TransformNormalizedRect(&rect, image_size.first, image_size.second);
     }
     cc->Outputs().Index(0).Add(output_rects.release(), cc->InputTimestamp());
   }
@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
+#include <vector>
+
 #include "mediapipe/calculators/util/thresholding_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 
@@ -22,6 +25,8 @@ constexpr char kRejectTag[] = "REJECT";
 constexpr char kAcceptTag[] = "ACCEPT";
 constexpr char kFlagTag[] = "FLAG";
 constexpr char kFloatTag[] = "FLOAT";
+constexpr char kFlagsTag[] = "FLAGS";
+constexpr char kFloatsTag[] = "FLOATS";
 
 // Applies a threshold on a stream of numeric values and outputs a flag and/or
 // accept/reject stream. The threshold can be specified by one of the following:
@@ -32,6 +37,9 @@ constexpr char kFloatTag[] = "FLOAT";
 // Input:
 //  FLOAT: A float, which will be cast to double to be compared with a
 //         threshold of double type.
+//  FLOATS: A std::vector<float>, each element of which is compared with the
+//          threshold as FLOAT is. Exclusive with FLOAT, and only FLAGS can be
+//          output from it.
 //  THRESHOLD(optional): A double specifying the threshold at current timestamp.
 //
 // Output:
@@ -41,6 +49,7 @@ constexpr char kFloatTag[] = "FLOAT";
 //                     threshold.
 //   REJECT(optional): A packet will be sent if the value is no larger than the
 //                     threshold.
+//   FLAGS(optional): A std::vector<bool> with one flag per FLOATS element.
 //
 // Usage example:
 // node {
@@ -67,8 +76,21 @@ class ThresholdingCalculator : public CalculatorBase {
 REGISTER_CALCULATOR(ThresholdingCalculator);
 
 absl::Status ThresholdingCalculator::GetContract(CalculatorContract* cc) {
-  RET_CHECK(cc->Inputs().HasTag(kFloatTag));
-  cc->Inputs().Tag(kFloatTag).Set<float>();
+  RET_CHECK(cc->Inputs().HasTag(kFloatTag) ^ cc->Inputs().HasTag(kFloatsTag))
+      << "Exactly one of FLOAT and FLOATS must be connected.";
+  if (cc->Inputs().HasTag(kFloatsTag)) {
+    cc->Inputs().Tag(kFloatsTag).Set<std::vector<float>>();
+    RET_CHECK(cc->Outputs().HasTag(kFlagsTag));
+    RET_CHECK(!cc->Outputs().HasTag(kFlagTag) &&
+              !cc->Outputs().HasTag(kAcceptTag) &&
+              !cc->Outputs().HasTag(kRejectTag))
+        << "FLOATS only supports the FLAGS output.";
+    cc->Outputs().Tag(kFlagsTag).Set<std::vector<bool>>();
+  } else {
+    cc->Inputs().Tag(kFloatTag).Set<float>();
+    RET_CHECK(!cc->Outputs().HasTag(kFlagsTag))
+        << "FLAGS requires the FLOATS input.";
+  }
 
   if (cc->Outputs().HasTag(kFlagTag)) {
     cc->Outputs().Tag(kFlagTag).Set<bool>();
@@ -118,6 +140,18 @@ absl::Status ThresholdingCalculator::Process(CalculatorContext* cc) {
     threshold_ = cc->Inputs().Tag(kThresholdTag).Get<double>();
   }
 
+  if (cc->Inputs().HasTag(kFloatsTag)) {
+    RET_CHECK(!cc->Inputs().Tag(kFloatsTag).IsEmpty());
+    const auto& values = cc->Inputs().Tag(kFloatsTag).Get<std::vector<float>>();
+    auto flags = std::make_unique<std::vector<bool>>();
+    flags->reserve(values.size());
+    for (float value : values) {
+      flags->push_back(static_cast<double>(value) > threshold_);
+    }
+    cc->Outputs().Tag(kFlagsTag).Add(flags.release(), cc->InputTimestamp());
+    return absl::OkStatus();
+  }
+
   bool accept = false;
   RET_CHECK(!cc->Inputs().Tag(kFloatTag).IsEmpty());
   accept = static_cast<double>(cc->Inputs().Tag(kFloatTag).Get<float>()) >
@@ -0,0 +1,422 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstdint>  // required by avutil.h
+#include <memory>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/calculators/video/ffmpeg_video_decoder_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/video_stream_header.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/tool/status_util.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+#include "libavutil/hwcontext.h"
+#include "libavutil/pixdesc.h"
+#include "libswscale/swscale.h"
+}
+
+namespace mediapipe {
+
+namespace {
+
+constexpr char kVideoPrestreamTag[] = "VIDEO_PRESTREAM";
+constexpr char kVideoTag[] = "VIDEO";
+constexpr char kInputFilePathTag[] = "INPUT_FILE_PATH";
+
+constexpr AVRational kMicrosecondTimeBase = {1, 1000000};
+
+std::string AvErrorToString(int error) {
+  char buffer[AV_ERROR_MAX_STRING_SIZE] = {0};
+  av_strerror(error, buffer, sizeof(buffer));
+  return buffer;
+}
+
+// get_format callback of the codec context. Picks the hardware pixel format
+// stored in 'opaque', or the first software format if the decoder does not
+// offer it for this stream.
+AVPixelFormat GetHwFormat(AVCodecContext* codec_context,
+                          const AVPixelFormat* formats) {
+  const auto hw_format = static_cast<AVPixelFormat>(
+      reinterpret_cast<intptr_t>(codec_context->opaque));
+  for (const AVPixelFormat* format = formats; *format != AV_PIX_FMT_NONE;
+       ++format) {
+    if (*format == hw_format) return *format;
+  }
+  for (const AVPixelFormat* format = formats; *format != AV_PIX_FMT_NONE;
+       ++format) {
+    if (!(av_pix_fmt_desc_get(*format)->flags & AV_PIX_FMT_FLAG_HWACCEL)) {
+      LOG(WARNING) << "Hardware decoding is not available for this stream.";
+      return *format;
+    }
+  }
+  return AV_PIX_FMT_NONE;
+}
+
+}  // namespace
+
+// Decodes a video file with FFmpeg, optionally with a hardware decoder, and
+// outputs RGB ImageFrames. Compared to OpenCvVideoDecoderCalculator it can
+// decode on the GPU, scale in the same pass as the color conversion, seek to
+// an exact frame and only decode keyframes.
+//
+// Hardware decoded frames are copied back to memory before the conversion, as
+// the output is an ImageFrame.
+//
+// Output Streams:
+//   VIDEO: Output video frames (ImageFrame, SRGB).
+//   VIDEO_PRESTREAM:
+//       Optional video header information output at
+//       Timestamp::PreStream() for the corresponding stream.
+// Input Side Packets:
+//   INPUT_FILE_PATH: The input file path.
+//
+// Example config:
+// node {
+//   calculator: "FfmpegVideoDecoderCalculator"
+//   input_side_packet: "INPUT_FILE_PATH:input_file_path"
+//   output_stream: "VIDEO:video_frames"
+//   output_stream: "VIDEO_PRESTREAM:video_header"
+//   options: {
+//     [mediapipe.FfmpegVideoDecoderCalculatorOptions.ext] {
+//       hw_device_type: "vaapi"
+//       output_width: 960
+//     }
+//   }
+// }
+class FfmpegVideoDecoderCalculator : public CalculatorBase {
+ public:
+  ~FfmpegVideoDecoderCalculator() override { Release(); }
+
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->InputSidePackets().Tag(kInputFilePathTag).Set<std::string>();
+    cc->Outputs().Tag(kVideoTag).Set<ImageFrame>();
+    if (cc->Outputs().HasTag(kVideoPrestreamTag)) {
+      cc->Outputs().Tag(kVideoPrestreamTag).Set<VideoHeader>();
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+  absl::Status Close(CalculatorContext* cc) override;
+
+ private:
+  absl::Status OpenDecoder(const std::string& input_file_path);
+  void SetUpHwDecoding(const AVCodec* codec);
+  // Sends the next packet of the video stream to the decoder, or flushes the
+  // decoder at the end of the file.
+  absl::Status SendNextPacket();
+  absl::Status OutputFrame(CalculatorContext* cc, const AVFrame* frame,
+                           Timestamp timestamp);
+  // Converts a stream timestamp to microseconds from the start of the video.
+  int64_t ToMicroseconds(int64_t pts) const;
+  void Release();
+
+  FfmpegVideoDecoderCalculatorOptions options_;
+  AVFormatContext* format_context_ = nullptr;
+  AVCodecContext* codec_context_ = nullptr;
+  AVBufferRef* hw_device_context_ = nullptr;
+  SwsContext* sws_context_ = nullptr;
+  AVPacket* packet_ = nullptr;
+  AVFrame* frame_ = nullptr;
+  AVFrame* sw_frame_ = nullptr;
+  AVPixelFormat hw_format_ = AV_PIX_FMT_NONE;
+  AVStream* stream_ = nullptr;
+  int output_width_ = 0;
+  int output_height_ = 0;
+  bool flushed_ = false;
+  int decoded_frames_ = 0;
+  Timestamp prev_timestamp_ = Timestamp::Unset();
+};
+REGISTER_CALCULATOR(FfmpegVideoDecoderCalculator);
+
+absl::Status FfmpegVideoDecoderCalculator::Open(CalculatorContext* cc) {
+  options_ = cc->Options<FfmpegVideoDecoderCalculatorOptions>();
+  const std::string& input_file_path =
+      cc->InputSidePackets().Tag(kInputFilePathTag).Get<std::string>();
+  MP_RETURN_IF_ERROR(OpenDecoder(input_file_path));
+
+  const int width = codec_context_->width;
+  const int height = codec_context_->height;
+  RET_CHECK(width > 0 && height > 0)
+      << "Invalid video size in " << input_file_path;
+  output_width_ = options_.output_width();
+  output_height_ = options_.output_height();
+  if (output_width_ <= 0 && output_height_ <= 0) {
+    output_width_ = width;
+    output_height_ = height;
+  } else if (output_width_ <= 0) {
+    output_width_ = std::max(1, output_height_ * width / height);
+  } else if (output_height_ <= 0) {
+    output_height_ = std::max(1, output_width_ * height / width);
+  }
+
+  if (options_.start_time_us() > 0) {
+    int64_t target = av_rescale_q(options_.start_time_us(),
+                                  kMicrosecondTimeBase, stream_->time_base);
+    if (stream_->start_time != AV_NOPTS_VALUE) target += stream_->start_time;
+    const int ret = av_seek_frame(format_context_, stream_->index, target,
+                                  AVSEEK_FLAG_BACKWARD);
+    if (ret < 0) {
+      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+             << "Fail to seek to " << options_.start_time_us() << "us in "
+             << input_file_path << ": " << AvErrorToString(ret);
+    }
+  }
+
+  if (cc->Outputs().HasTag(kVideoPrestreamTag)) {
+    auto header = absl::make_unique<VideoHeader>();
+    header->format = ImageFormat::SRGB;
+    header->width = output_width_;
+    header->height = output_height_;
+    header->frame_rate = av_q2d(stream_->avg_frame_rate);
+    if (stream_->duration != AV_NOPTS_VALUE) {
+      header->duration = stream_->duration * av_q2d(stream_->time_base);
+    } else if (format_context_->duration != AV_NOPTS_VALUE) {
+      header->duration =
+          static_cast<double>(format_context_->duration) / AV_TIME_BASE;
+    }
+    cc->Outputs()
+        .Tag(kVideoPrestreamTag)
+        .Add(header.release(), Timestamp::PreStream());
+    cc->Outputs().Tag(kVideoPrestreamTag).Close();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status FfmpegVideoDecoderCalculator::OpenDecoder(
+    const std::string& input_file_path) {
+  int ret = avformat_open_input(&format_context_, input_file_path.c_str(),
+                                nullptr, nullptr);
+  if (ret < 0) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Fail to open video file at " << input_file_path << ": "
+           << AvErrorToString(ret);
+  }
+  ret = avformat_find_stream_info(format_context_, nullptr);
+  if (ret < 0) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Fail to read the streams of " << input_file_path << ": "
+           << AvErrorToString(ret);
+  }
+  ret = av_find_best_stream(format_context_, AVMEDIA_TYPE_VIDEO, -1, -1,
+                            nullptr, 0);
+  if (ret < 0) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "No video stream in " << input_file_path << ": "
+           << AvErrorToString(ret);
+  }
+  stream_ = format_context_->streams[ret];
+  const AVCodec* codec = avcodec_find_decoder(stream_->codecpar->codec_id);
+  if (!codec) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "No decoder for the video stream of " << input_file_path;
+  }
+
+  codec_context_ = avcodec_alloc_context3(codec);
+  RET_CHECK(codec_context_);
+  ret = avcodec_parameters_to_context(codec_context_, stream_->codecpar);
+  RET_CHECK_GE(ret, 0) << AvErrorToString(ret);
+  codec_context_->thread_count = options_.num_threads();
+  if (options_.keyframes_only()) {
+    codec_context_->skip_frame = AVDISCARD_NONKEY;
+  }
+  if (!options_.hw_device_type().empty()) SetUpHwDecoding(codec);
+  ret = avcodec_open2(codec_context_, codec, nullptr);
+  if (ret < 0) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Fail to open the " << codec->name << " decoder: "
+           << AvErrorToString(ret);
+  }
+
+  packet_ = av_packet_alloc();
+  frame_ = av_frame_alloc();
+  sw_frame_ = av_frame_alloc();
+  RET_CHECK(packet_ && frame_ && sw_frame_);
+  return absl::OkStatus();
+}
+
+void FfmpegVideoDecoderCalculator::SetUpHwDecoding(const AVCodec* codec) {
+  const std::string& device_name = options_.hw_device_type();
+  const AVHWDeviceType device_type =
+      av_hwdevice_find_type_by_name(device_name.c_str());
+  if (device_type == AV_HWDEVICE_TYPE_NONE) {
+    LOG(WARNING) << "Unknown hardware device type " << device_name
+                 << ", decoding in software.";
+    return;
+  }
+  for (int i = 0;; ++i) {
+    const AVCodecHWConfig* config = avcodec_get_hw_config(codec, i);
+    if (!config) {
+      LOG(WARNING) << codec->name << " does not support " << device_name
+                   << ", decoding in software.";
+      return;
+    }
+    if ((config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX) &&
+        config->device_type == device_type) {
+      hw_format_ = config->pix_fmt;
+      break;
+    }
+  }
+  const int ret = av_hwdevice_ctx_create(&hw_device_context_, device_type,
+                                         nullptr, nullptr, 0);
+  if (ret < 0) {
+    LOG(WARNING) << "Fail to create a " << device_name
+                 << " device, decoding in software: " << AvErrorToString(ret);
+    hw_format_ = AV_PIX_FMT_NONE;
+    return;
+  }
+  codec_context_->hw_device_ctx = av_buffer_ref(hw_device_context_);
+  codec_context_->opaque =
+      reinterpret_cast<void*>(static_cast<intptr_t>(hw_format_));
+  codec_context_->get_format = GetHwFormat;
+}
+
+absl::Status FfmpegVideoDecoderCalculator::Process(CalculatorContext* cc) {
+  while (true) {
+    const int ret = avcodec_receive_frame(codec_context_, frame_);
+    if (ret == AVERROR_EOF) return tool::StatusStop();
+    if (ret == AVERROR(EAGAIN)) {
+      MP_RETURN_IF_ERROR(SendNextPacket());
+      continue;
+    }
+    if (ret < 0) {
+      return mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+             << "Fail to decode a frame: " << AvErrorToString(ret);
+    }
+
+    const int64_t pts = frame_->best_effort_timestamp;
+    if (pts == AV_NOPTS_VALUE) {
+      av_frame_unref(frame_);
+      continue;
+    }
+    const int64_t time_us = ToMicroseconds(pts);
+    if (options_.end_time_us() > 0 && time_us > options_.end_time_us()) {
+      av_frame_unref(frame_);
+      return tool::StatusStop();
+    }
+    // Frames before the start time are only decoded to reach it.
+    const Timestamp timestamp(time_us);
+    if (time_us < options_.start_time_us() || timestamp <= prev_timestamp_) {
+      av_frame_unref(frame_);
+      continue;
+    }
+    const absl::Status status = OutputFrame(cc, frame_, timestamp);
+    av_frame_unref(frame_);
+    return status;
+  }
+}
+
+absl::Status FfmpegVideoDecoderCalculator::SendNextPacket() {
+  RET_CHECK(!flushed_) << "The decoder did not drain after the flush.";
+  while (true) {
+    int ret = av_read_frame(format_context_, packet_);
+    if (ret == AVERROR_EOF) {
+      flushed_ = true;
+      ret = avcodec_send_packet(codec_context_, nullptr);
+      RET_CHECK_GE(ret, 0) << AvErrorToString(ret);
+      return absl::OkStatus();
+    }
+    if (ret < 0) {
+      return mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+             << "Fail to read a packet: " << AvErrorToString(ret);
+    }
+    if (packet_->stream_index != stream_->index ||
+        (options_.keyframes_only() && !(packet_->flags & AV_PKT_FLAG_KEY))) {
+      av_packet_unref(packet_);
+      continue;
+    }
+    ret = avcodec_send_packet(codec_context_, packet_);
+    av_packet_unref(packet_);
+    if (ret < 0 && ret != AVERROR_INVALIDDATA) {
+      return mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+             << "Fail to send a packet to the decoder: "
+             << AvErrorToString(ret);
+    }
+    return absl::OkStatus();
+  }
+}
+
+absl::Status FfmpegVideoDecoderCalculator::OutputFrame(CalculatorContext* cc,
+                                                       const AVFrame* frame,
+                                                       Timestamp timestamp) {
+  const AVFrame* src = frame;
+  if (hw_format_ != AV_PIX_FMT_NONE && frame->format == hw_format_) {
+    const int ret = av_hwframe_transfer_data(sw_frame_, frame, 0);
+    if (ret < 0) {
+      return mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+             << "Fail to transfer a frame from the "
+             << options_.hw_device_type() << " device: "
+             << AvErrorToString(ret);
+    }
+    src = sw_frame_;
+  }
+
+  // Scaling and conversion to RGB are a single pass.
+  sws_context_ = sws_getCachedContext(
+      sws_context_, src->width, src->height,
+      static_cast<AVPixelFormat>(src->format), output_width_, output_height_,
+      AV_PIX_FMT_RGB24, SWS_BILINEAR, nullptr, nullptr, nullptr);
+  RET_CHECK(sws_context_) << "Unsupported pixel format "
+                          << av_get_pix_fmt_name(
+                                 static_cast<AVPixelFormat>(src->format));
+  auto image_frame = absl::make_unique<ImageFrame>(
+      ImageFormat::SRGB, output_width_, output_height_,
+      ImageFrame::kDefaultAlignmentBoundary);
+  uint8_t* const dst_data[1] = {image_frame->MutablePixelData()};
+  const int dst_linesize[1] = {image_frame->WidthStep()};
+  sws_scale(sws_context_, src->data, src->linesize, 0, src->height, dst_data,
+            dst_linesize);
+  if (src == sw_frame_) av_frame_unref(sw_frame_);
+
+  cc->Outputs().Tag(kVideoTag).Add(image_frame.release(), timestamp);
+  prev_timestamp_ = timestamp;
+  ++decoded_frames_;
+  return absl::OkStatus();
+}
+
+int64_t FfmpegVideoDecoderCalculator::ToMicroseconds(int64_t pts) const {
+  if (stream_->start_time != AV_NOPTS_VALUE) pts -= stream_->start_time;
+  return av_rescale_q(pts, stream_->time_base, kMicrosecondTimeBase);
+}
+
+absl::Status FfmpegVideoDecoderCalculator::Close(CalculatorContext* cc) {
+  VLOG(1) << "Decoded " << decoded_frames_ << " frames.";
+  Release();
+  return absl::OkStatus();
+}
+
+void FfmpegVideoDecoderCalculator::Release() {
+  sws_freeContext(sws_context_);
+  sws_context_ = nullptr;
+  av_frame_free(&sw_frame_);
+  av_frame_free(&frame_);
+  av_packet_free(&packet_);
+  avcodec_free_context(&codec_context_);
+  av_buffer_unref(&hw_device_context_);
+  avformat_close_input(&format_context_);
+  stream_ = nullptr;
+}
+
+}  // namespace mediapipe
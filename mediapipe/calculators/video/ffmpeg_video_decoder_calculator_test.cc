@@ -0,0 +1,123 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/calculators/video/ffmpeg_video_decoder_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/video_stream_header.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/tool/test_util.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr char kVideoTag[] = "VIDEO";
+constexpr char kVideoPrestreamTag[] = "VIDEO_PRESTREAM";
+constexpr char kInputFilePathTag[] = "INPUT_FILE_PATH";
+constexpr char kTestPackageRoot[] = "mediapipe/calculators/video";
+
+CalculatorGraphConfig::Node MakeNodeConfig(const std::string& options) {
+  return ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::StrCat(
+      R"pb(
+        calculator: "FfmpegVideoDecoderCalculator"
+        input_side_packet: "INPUT_FILE_PATH:input_file_path"
+        output_stream: "VIDEO:video"
+        output_stream: "VIDEO_PRESTREAM:video_prestream"
+        options: {
+          [mediapipe.FfmpegVideoDecoderCalculatorOptions.ext] {)pb",
+      options, "}}"));
+}
+
+void SetInputFile(CalculatorRunner* runner) {
+  runner->MutableSidePackets()->Tag(kInputFilePathTag) =
+      MakePacket<std::string>(file::JoinPath(GetTestDataDir(kTestPackageRoot),
+                                             "format_MP4_AVC720P_AAC.video"));
+}
+
+TEST(FfmpegVideoDecoderCalculatorTest, TestMp4Avc720pVideo) {
+  CalculatorRunner runner(MakeNodeConfig(""));
+  SetInputFile(&runner);
+  MP_ASSERT_OK(runner.Run());
+
+  ASSERT_EQ(runner.Outputs().Tag(kVideoPrestreamTag).packets.size(), 1);
+  const VideoHeader& header =
+      runner.Outputs().Tag(kVideoPrestreamTag).packets[0].Get<VideoHeader>();
+  EXPECT_EQ(ImageFormat::SRGB, header.format);
+  EXPECT_EQ(1280, header.width);
+  EXPECT_EQ(640, header.height);
+  EXPECT_NEAR(6.0f, header.duration, 0.1f);
+  EXPECT_FLOAT_EQ(30.0f, header.frame_rate);
+
+  const auto& packets = runner.Outputs().Tag(kVideoTag).packets;
+  EXPECT_EQ(180, packets.size());
+  for (int i = 0; i < packets.size(); ++i) {
+    const ImageFrame& frame = packets[i].Get<ImageFrame>();
+    EXPECT_EQ(1280, frame.Width());
+    EXPECT_EQ(640, frame.Height());
+    if (i > 0) EXPECT_LT(packets[i - 1].Timestamp(), packets[i].Timestamp());
+  }
+}
+
+TEST(FfmpegVideoDecoderCalculatorTest, ScalesWhileConverting) {
+  CalculatorRunner runner(MakeNodeConfig("output_width: 320"));
+  SetInputFile(&runner);
+  MP_ASSERT_OK(runner.Run());
+
+  const VideoHeader& header =
+      runner.Outputs().Tag(kVideoPrestreamTag).packets[0].Get<VideoHeader>();
+  EXPECT_EQ(320, header.width);
+  EXPECT_EQ(160, header.height);
+  const auto& packets = runner.Outputs().Tag(kVideoTag).packets;
+  ASSERT_FALSE(packets.empty());
+  EXPECT_EQ(320, packets[0].Get<ImageFrame>().Width());
+  EXPECT_EQ(160, packets[0].Get<ImageFrame>().Height());
+}
+
+TEST(FfmpegVideoDecoderCalculatorTest, SeeksToExactFrame) {
+  // 30 fps: frames at 2s and up to 3s.
+  CalculatorRunner runner(
+      MakeNodeConfig("start_time_us: 2000000 end_time_us: 3000000"));
+  SetInputFile(&runner);
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& packets = runner.Outputs().Tag(kVideoTag).packets;
+  ASSERT_FALSE(packets.empty());
+  EXPECT_GE(packets.front().Timestamp(), Timestamp(2000000));
+  EXPECT_LT(packets.front().Timestamp(), Timestamp(2000000 + 1000000 / 30));
+  EXPECT_LE(packets.back().Timestamp(), Timestamp(3000000));
+  EXPECT_NEAR(31, packets.size(), 1);
+}
+
+TEST(FfmpegVideoDecoderCalculatorTest, DecodesKeyframesOnly) {
+  CalculatorRunner runner(MakeNodeConfig("keyframes_only: true"));
+  SetInputFile(&runner);
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& packets = runner.Outputs().Tag(kVideoTag).packets;
+  EXPECT_GE(packets.size(), 1);
+  EXPECT_LT(packets.size(), 180);
+  EXPECT_EQ(Timestamp(0), packets.front().Timestamp());
+}
+
+}  // namespace
+}  // namespace mediapipe
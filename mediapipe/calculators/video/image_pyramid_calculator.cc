@@ -0,0 +1,91 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/calculators/video/image_pyramid_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/util/tracking/image_pyramid.h"
+
+namespace mediapipe {
+
+constexpr char kVideoTag[] = "VIDEO";
+constexpr char kPyramidTag[] = "PYRAMID";
+
+// Computes the luminance and Lucas-Kanade tracking pyramid of each frame once,
+// so that the calculators analyzing the same video can share them instead of
+// converting and downsampling the frame themselves.
+//
+// Input streams:
+//   VIDEO:   ImageFrame (SRGB, SRGBA or GRAY8).
+// Output streams:
+//   PYRAMID: ImagePyramid of the frame.
+//
+// Example config:
+// node {
+//   calculator: "ImagePyramidCalculator"
+//   input_stream: "VIDEO:input_video"
+//   output_stream: "PYRAMID:input_pyramid"
+// }
+// node {
+//   calculator: "MotionAnalysisCalculator"
+//   input_stream: "VIDEO:input_video"
+//   input_stream: "PYRAMID:input_pyramid"
+//   ...
+// }
+class ImagePyramidCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Tag(kVideoTag).Set<ImageFrame>();
+    cc->Outputs().Tag(kPyramidTag).Set<ImagePyramid>();
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    cc->SetOffset(TimestampDiff(0));
+    options_ = cc->Options<ImagePyramidCalculatorOptions>();
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    const cv::Mat frame =
+        formats::MatView(&cc->Inputs().Tag(kVideoTag).Get<ImageFrame>());
+    cv::Mat luminance;
+    RET_CHECK(ComputeLuminance(frame, &luminance))
+        << "Unsupported number of channels: " << frame.channels();
+
+    const int max_level =
+        options_.max_level() < 0
+            ? MaxTrackingPyramidLevel(luminance.cols, luminance.rows)
+            : options_.max_level();
+    auto pyramid = absl::make_unique<ImagePyramid>();
+    BuildImagePyramid(luminance, max_level, options_.tracking_window_size(),
+                      options_.compute_derivative(), pyramid.get());
+    cc->Outputs().Tag(kPyramidTag).Add(pyramid.release(), cc->InputTimestamp());
+    return absl::OkStatus();
+  }
+
+ private:
+  ImagePyramidCalculatorOptions options_;
+};
+
+REGISTER_CALCULATOR(ImagePyramidCalculator);
+
+}  // namespace mediapipe
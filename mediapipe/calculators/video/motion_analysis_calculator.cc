@@ -32,6 +32,7 @@
 #include "mediapipe/util/tracking/camera_motion.h"
 #include "mediapipe/util/tracking/camera_motion.pb.h"
 #include "mediapipe/util/tracking/frame_selection.pb.h"
+#include "mediapipe/util/tracking/image_pyramid.h"
 #include "mediapipe/util/tracking/motion_analysis.h"
 #include "mediapipe/util/tracking/motion_estimation.h"
 #include "mediapipe/util/tracking/motion_models.h"
@@ -50,6 +51,7 @@ constexpr char kCameraTag[] = "CAMERA";
 constexpr char kFlowTag[] = "FLOW";
 constexpr char kSelectionTag[] = "SELECTION";
 constexpr char kVideoTag[] = "VIDEO";
+constexpr char kPyramidTag[] = "PYRAMID";
 
 using mediapipe::AffineAdapter;
 using mediapipe::CameraMotion;
@@ -75,6 +77,9 @@ const char kOptionsTag[] = "OPTIONS";
 //   SELECTION: Optional input stream to perform analysis only on selected
 //              frames. If present needs to contain camera motion
 //              and features.
+//   PYRAMID:   Optional ImagePyramid of VIDEO (see ImagePyramidCalculator),
+//              reused for tracking instead of computing it again if it
+//              matches the flow options. Requires VIDEO to be present.
 //
 // Input side packets:
 //   CSV_FILE:  Read motion models as homographies from CSV file. Expected
@@ -165,6 +170,7 @@ class MotionAnalysisCalculator : public CalculatorBase {
   // Input indicators for each stream.
   bool selection_input_ = false;
   bool video_input_ = false;
+  bool pyramid_input_ = false;
 
   // Output indicators for each stream.
   bool region_flow_feature_output_ = false;
@@ -216,6 +222,12 @@ absl::Status MotionAnalysisCalculator::GetContract(CalculatorContract* cc) {
             cc->Inputs().HasTag(kSelectionTag))
       << "Either VIDEO, SELECTION must be specified.";
 
+  if (cc->Inputs().HasTag(kPyramidTag)) {
+    RET_CHECK(cc->Inputs().HasTag(kVideoTag))
+        << "PYRAMID requires VIDEO to be present.";
+    cc->Inputs().Tag(kPyramidTag).Set<ImagePyramid>();
+  }
+
   if (cc->Outputs().HasTag(kFlowTag)) {
     cc->Outputs().Tag(kFlowTag).Set<RegionFlowFeatureList>();
   }
@@ -269,6 +281,7 @@ absl::Status MotionAnalysisCalculator::Open(CalculatorContext* cc) {
 
   video_input_ = cc->Inputs().HasTag(kVideoTag);
   selection_input_ = cc->Inputs().HasTag(kSelectionTag);
+  pyramid_input_ = cc->Inputs().HasTag(kPyramidTag);
   region_flow_feature_output_ = cc->Outputs().HasTag(kFlowTag);
   camera_motion_output_ = cc->Outputs().HasTag(kCameraTag);
   saliency_output_ = cc->Outputs().HasTag(kSaliencyTag);
@@ -514,6 +527,10 @@ absl::Status MotionAnalysisCalculator::Process(CalculatorContext* cc) {
   }
 
   if (use_frame) {
+    const ImagePyramid* pyramid = nullptr;
+    if (pyramid_input_ && !cc->Inputs().Tag(kPyramidTag).IsEmpty()) {
+      pyramid = &cc->Inputs().Tag(kPyramidTag).Get<ImagePyramid>();
+    }
     if (!selection_input_) {
       const cv::Mat input_view =
           formats::MatView(&video_stream->Get<ImageFrame>());
@@ -530,10 +547,12 @@ absl::Status MotionAnalysisCalculator::Process(CalculatorContext* cc) {
         // Keep original features before modification around.
         motion_analysis_->AddFrameGeneric(
             input_view, timestamp.Value(), initial_transform, nullptr, nullptr,
-            &subtract_helper, &meta_features_[hybrid_meta_offset_]);
+            &subtract_helper, &meta_features_[hybrid_meta_offset_], pyramid);
         ++hybrid_meta_offset_;
       } else {
-        motion_analysis_->AddFrame(input_view, timestamp.Value());
+        motion_analysis_->AddFrameGeneric(input_view, timestamp.Value(),
+                                          Homography(), nullptr, nullptr,
+                                          nullptr, nullptr, pyramid);
       }
     } else {
       selected_motions_.push_back(frame_selection_result->camera_motion());
@@ -549,7 +568,9 @@ absl::Status MotionAnalysisCalculator::Process(CalculatorContext* cc) {
         case MotionAnalysisCalculatorOptions::ANALYSIS_RECOMPUTE: {
           const cv::Mat input_view =
               formats::MatView(&video_stream->Get<ImageFrame>());
-          motion_analysis_->AddFrame(input_view, timestamp.Value());
+          motion_analysis_->AddFrameGeneric(input_view, timestamp.Value(),
+                                            Homography(), nullptr, nullptr,
+                                            nullptr, nullptr, pyramid);
           break;
         }
 
@@ -560,7 +581,8 @@ absl::Status MotionAnalysisCalculator::Process(CalculatorContext* cc) {
           const cv::Mat input_view =
               formats::MatView(&video_stream->Get<ImageFrame>());
           motion_analysis_->AddFrameGeneric(input_view, timestamp.Value(),
-                                            homography, &homography);
+                                            homography, &homography, nullptr,
+                                            nullptr, nullptr, pyramid);
           break;
         }
       }
@@ -18,7 +18,9 @@
 #include <string>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/calculators/video/opencv_video_encoder_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
@@ -32,6 +34,7 @@
 #include "mediapipe/framework/port/source_location.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/status_builder.h"
+#include "mediapipe/framework/port/threadpool.h"
 #include "mediapipe/framework/tool/status_util.h"
 
 namespace mediapipe {
@@ -60,6 +63,9 @@ constexpr char kVideoTag[] = "VIDEO";
 //   }
 // }
 //
+// With encode_queue_size set, frames are converted and written on a dedicated
+// thread, and Process() only blocks once that many frames are queued.
+//
 // OpenCV's VideoWriter doesn't encode audio. If an input side packet with tag
 // "AUDIO_FILE_PATH" is specified, the calculator will call FFmpeg binary to
 // attach the audio file to the video as the last step in Close().
@@ -88,10 +94,27 @@ class OpenCvVideoEncoderCalculator : public CalculatorBase {
 
  private:
   absl::Status SetUpVideoWriter(float frame_rate, int width, int height);
+  absl::Status WriteFrame(const ImageFrame& image_frame, Timestamp timestamp);
+
+  bool CanQueue() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return num_queued_ < encode_queue_size_;
+  }
+  bool IsDrained() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return num_queued_ == 0;
+  }
 
   std::string output_file_path_;
   int four_cc_;
+  bool hw_acceleration_ = false;
   std::unique_ptr<cv::VideoWriter> writer_;
+
+  int encode_queue_size_ = 0;
+  absl::Mutex mutex_;
+  int num_queued_ ABSL_GUARDED_BY(mutex_) = 0;
+  // First error of the encode thread, returned by the next Process() call.
+  absl::Status encode_status_ ABSL_GUARDED_BY(mutex_);
+  // Single thread, so that frames are written in order.
+  std::unique_ptr<mediapipe::ThreadPool> encode_thread_;
 };
 
 absl::Status OpenCvVideoEncoderCalculator::GetContract(CalculatorContract* cc) {
@@ -120,6 +143,13 @@ absl::Status OpenCvVideoEncoderCalculator::Open(CalculatorContext* cc) {
   RET_CHECK(!options.video_format().empty())
       << "Video format must be specified in "
          "OpenCvVideoEncoderCalculatorOptions";
+  hw_acceleration_ = options.hw_acceleration();
+  encode_queue_size_ = options.encode_queue_size();
+  if (encode_queue_size_ > 0) {
+    encode_thread_ =
+        absl::make_unique<mediapipe::ThreadPool>("VideoEncoder", 1);
+    encode_thread_->StartWorkers();
+  }
   output_file_path_ =
       cc->InputSidePackets().Tag(kOutputFilePathTag).Get<std::string>();
   std::vector<std::string> splited_file_path =
@@ -145,24 +175,44 @@ absl::Status OpenCvVideoEncoderCalculator::Process(CalculatorContext* cc) {
                             video_header.height);
   }
 
-  const ImageFrame& image_frame =
-      cc->Inputs().Tag(kVideoTag).Value().Get<ImageFrame>();
+  if (!encode_thread_) {
+    return WriteFrame(cc->Inputs().Tag(kVideoTag).Get<ImageFrame>(),
+                      cc->InputTimestamp());
+  }
+
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(this,
+                               &OpenCvVideoEncoderCalculator::CanQueue));
+  MP_RETURN_IF_ERROR(encode_status_);
+  ++num_queued_;
+  // The packet keeps the frame alive until it is written.
+  encode_thread_->Schedule(
+      [this, packet = cc->Inputs().Tag(kVideoTag).Value()] {
+        absl::Status status =
+            WriteFrame(packet.Get<ImageFrame>(), packet.Timestamp());
+        absl::MutexLock lock(&mutex_);
+        if (encode_status_.ok()) encode_status_ = std::move(status);
+        --num_queued_;
+      });
+  return absl::OkStatus();
+}
+
+absl::Status OpenCvVideoEncoderCalculator::WriteFrame(
+    const ImageFrame& image_frame, Timestamp timestamp) {
   ImageFormat::Format format = image_frame.Format();
   cv::Mat frame;
   if (format == ImageFormat::GRAY8) {
     frame = formats::MatView(&image_frame);
     if (frame.empty()) {
       return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-             << "Receive empty frame at timestamp "
-             << cc->Inputs().Tag(kVideoTag).Value().Timestamp()
+             << "Receive empty frame at timestamp " << timestamp
              << " in OpenCvVideoEncoderCalculator::Process()";
     }
   } else {
     cv::Mat tmp_frame = formats::MatView(&image_frame);
     if (tmp_frame.empty()) {
       return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-             << "Receive empty frame at timestamp "
-             << cc->Inputs().Tag(kVideoTag).Value().Timestamp()
+             << "Receive empty frame at timestamp " << timestamp
              << " in OpenCvVideoEncoderCalculator::Process()";
     }
     if (format == ImageFormat::SRGB) {
@@ -179,6 +229,12 @@ absl::Status OpenCvVideoEncoderCalculator::Process(CalculatorContext* cc) {
 }
 
 absl::Status OpenCvVideoEncoderCalculator::Close(CalculatorContext* cc) {
+  if (encode_thread_) {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(
+        absl::Condition(this, &OpenCvVideoEncoderCalculator::IsDrained));
+    MP_RETURN_IF_ERROR(encode_status_);
+  }
   if (writer_ && writer_->isOpened()) {
     writer_->release();
   }
@@ -218,8 +274,24 @@ absl::Status OpenCvVideoEncoderCalculator::SetUpVideoWriter(float frame_rate,
   RET_CHECK(frame_rate > 0 && width > 0 && height > 0)
       << "Invalid video metadata: frame_rate=" << frame_rate
       << ", width=" << width << ", height=" << height;
-  writer_ = absl::make_unique<cv::VideoWriter>(
-      output_file_path_, four_cc_, frame_rate, cv::Size(width, height));
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR > 5) || \
+    (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR == 5 && CV_VERSION_REVISION >= 2)
+  if (hw_acceleration_) {
+    writer_ = absl::make_unique<cv::VideoWriter>(
+        output_file_path_, cv::CAP_FFMPEG, four_cc_, frame_rate,
+        cv::Size(width, height),
+        std::vector<int>{cv::VIDEOWRITER_PROP_HW_ACCELERATION,
+                         cv::VIDEO_ACCELERATION_ANY});
+  }
+#else
+  if (hw_acceleration_) {
+    LOG(WARNING) << "Hardware accelerated encoding needs OpenCV 4.5.2+.";
+  }
+#endif
+  if (!writer_) {
+    writer_ = absl::make_unique<cv::VideoWriter>(
+        output_file_path_, four_cc_, frame_rate, cv::Size(width, height));
+  }
   if (!writer_->isOpened()) {
     return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
            << "Fail to open file at " << output_file_path_;
@@ -161,6 +161,58 @@ TEST(OpenCvVideoEncoderCalculatorTest, TestFlvH264Video) {
   //                            cap.get(cv::CAP_PROP_FPS)));
 }
 
+TEST(OpenCvVideoEncoderCalculatorTest, TestEncodeQueueWritesAllFrames) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        node {
+          calculator: "OpenCvVideoDecoderCalculator"
+          input_side_packet: "INPUT_FILE_PATH:input_file_path"
+          output_stream: "VIDEO:video"
+          output_stream: "VIDEO_PRESTREAM:video_prestream"
+        }
+        node {
+          calculator: "OpenCvVideoEncoderCalculator"
+          input_stream: "VIDEO:video"
+          input_stream: "VIDEO_PRESTREAM:video_prestream"
+          input_side_packet: "OUTPUT_FILE_PATH:output_file_path"
+          node_options {
+            [type.googleapis.com/
+             mediapipe.OpenCvVideoEncoderCalculatorOptions]: {
+              codec: "MJPG"
+              video_format: "avi"
+              encode_queue_size: 4
+            }
+          }
+        }
+      )pb");
+  std::map<std::string, Packet> input_side_packets;
+  input_side_packets["input_file_path"] =
+      MakePacket<std::string>(file::JoinPath(GetTestDataDir(kTestPackageRoot),
+                                             "format_FLV_H264_AAC.video"));
+  const std::string output_file_path = "/tmp/tmp_video_queued.avi";
+  DeletingFile deleting_file(output_file_path, true);
+  input_side_packets["output_file_path"] =
+      MakePacket<std::string>(output_file_path);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config, input_side_packets));
+  StatusOrPoller status_or_poller = graph.AddOutputStreamPoller("video");
+  ASSERT_TRUE(status_or_poller.ok());
+  OutputStreamPoller poller = std::move(status_or_poller.value());
+
+  MP_ASSERT_OK(graph.StartRun({}));
+  Packet packet;
+  int num_frames = 0;
+  while (poller.Next(&packet)) {
+    ++num_frames;
+  }
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  // Close() waits for the queue, so every frame is in the file.
+  cv::VideoCapture cap(output_file_path);
+  ASSERT_TRUE(cap.isOpened());
+  EXPECT_EQ(num_frames, static_cast<int>(cap.get(cv::CAP_PROP_FRAME_COUNT)));
+}
+
 TEST(OpenCvVideoEncoderCalculatorTest, TestMkvVp8Video) {
   CalculatorGraphConfig config =
       ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
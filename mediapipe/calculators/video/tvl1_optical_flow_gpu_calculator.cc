@@ -0,0 +1,633 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/macros.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/substitute.h"
+#include "mediapipe/calculators/video/tvl1_optical_flow_gpu_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/motion/optical_flow_field.h"
+#include "mediapipe/framework/port.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+
+#if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+#include "mediapipe/gpu/gl_calculator_helper.h"
+#include "mediapipe/gpu/gpu_buffer.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr char kBackwardFlowTag[] = "BACKWARD_FLOW";
+constexpr char kForwardFlowTag[] = "FORWARD_FLOW";
+constexpr char kSecondFrameTag[] = "SECOND_FRAME";
+constexpr char kFirstFrameTag[] = "FIRST_FRAME";
+
+constexpr int kWorkgroupSize = 8;
+// Pyramid levels smaller than this, in either dimension, are not used.
+constexpr int kMinLevelSize = 16;
+
+int NumGroups(const int size, const int group_size) {  // NOLINT
+  return (size + group_size - 1) / group_size;
+}
+
+std::string ShaderHeader() {
+  return absl::Substitute(R"(#version 310 es
+precision highp float;
+precision highp int;
+precision highp image2D;
+layout(local_size_x = $0, local_size_y = $0) in;
+)",
+                          kWorkgroupSize);
+}
+
+// Defines a function |$0|(vec2 pos) that bilinearly interpolates the readonly
+// image |$1| at the pixel position |pos|, clamping it to the image borders.
+constexpr char kBilinearFunction[] = R"(
+vec4 $0(vec2 pos) {
+  ivec2 size = imageSize($1);
+  pos = clamp(pos, vec2(0.0), vec2(size - 1));
+  ivec2 p0 = ivec2(floor(pos));
+  ivec2 p1 = min(p0 + 1, size - 1);
+  vec2 f = pos - vec2(p0);
+  vec4 top = mix(imageLoad($1, p0), imageLoad($1, ivec2(p1.x, p0.y)), f.x);
+  vec4 bottom = mix(imageLoad($1, ivec2(p0.x, p1.y)), imageLoad($1, p1), f.x);
+  return mix(top, bottom, f.y);
+}
+)";
+
+// Converts an RGB frame into the grayscale base level of a pyramid, in the
+// [0, 255] range used by the solver parameters.
+constexpr char kGrayscaleShader[] = R"(
+layout(binding = 0) uniform highp sampler2D frame;
+layout(r32f, binding = 0) writeonly uniform highp image2D gray;
+
+void main() {
+  ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
+  if (any(greaterThanEqual(gid, imageSize(gray)))) return;
+  vec3 rgb = texelFetch(frame, gid, 0).rgb;
+  imageStore(gray, gid, vec4(dot(rgb, vec3(0.299, 0.587, 0.114)) * 255.0));
+}
+)";
+
+// Resizes the previous pyramid level into the next one.
+constexpr char kDownsampleShader[] = R"(
+layout(r32f, binding = 0) readonly uniform highp image2D src;
+layout(r32f, binding = 1) writeonly uniform highp image2D dst;
+$0
+void main() {
+  ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
+  ivec2 dst_size = imageSize(dst);
+  if (any(greaterThanEqual(gid, dst_size))) return;
+  vec2 scale = vec2(imageSize(src)) / vec2(dst_size);
+  imageStore(dst, gid, SampleSrc((vec2(gid) + 0.5) * scale - 0.5));
+}
+)";
+
+// Initializes the flow and dual variables of the coarsest level.
+constexpr char kClearShader[] = R"(
+layout(rgba32f, binding = 0) writeonly uniform highp image2D flow;
+layout(rgba32f, binding = 1) writeonly uniform highp image2D dual;
+
+void main() {
+  ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
+  if (any(greaterThanEqual(gid, imageSize(flow)))) return;
+  imageStore(flow, gid, vec4(0.0));
+  imageStore(dual, gid, vec4(0.0));
+}
+)";
+
+// Initializes the flow and dual variables of a level from the coarser one.
+constexpr char kUpsampleShader[] = R"(
+layout(rgba32f, binding = 0) readonly uniform highp image2D src_flow;
+layout(rgba32f, binding = 1) readonly uniform highp image2D src_dual;
+layout(rgba32f, binding = 2) writeonly uniform highp image2D dst_flow;
+layout(rgba32f, binding = 3) writeonly uniform highp image2D dst_dual;
+$0
+$1
+void main() {
+  ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
+  ivec2 dst_size = imageSize(dst_flow);
+  if (any(greaterThanEqual(gid, dst_size))) return;
+  vec2 scale = vec2(imageSize(src_flow)) / vec2(dst_size);
+  vec2 pos = (vec2(gid) + 0.5) * scale - 0.5;
+  vec4 flow = SampleFlow(pos);
+  flow.xy /= scale;
+  imageStore(dst_flow, gid, flow);
+  imageStore(dst_dual, gid, SampleDual(pos));
+}
+)";
+
+// Warps the second frame by the current flow and linearizes the brightness
+// constancy around it: stores (I1x, I1y, |grad I1|^2, rho_c), with
+// rho(u) = rho_c + grad I1 . u.
+constexpr char kWarpShader[] = R"(
+layout(r32f, binding = 0) readonly uniform highp image2D first;
+layout(r32f, binding = 1) readonly uniform highp image2D second;
+layout(rgba32f, binding = 2) readonly uniform highp image2D flow;
+layout(rgba32f, binding = 3) writeonly uniform highp image2D warp;
+$0
+void main() {
+  ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
+  if (any(greaterThanEqual(gid, imageSize(warp)))) return;
+  vec2 u = imageLoad(flow, gid).xy;
+  vec2 pos = vec2(gid) + u;
+  float i1w = SampleSecond(pos).x;
+  float i1x = 0.5 * (SampleSecond(pos + vec2(1.0, 0.0)).x -
+                     SampleSecond(pos - vec2(1.0, 0.0)).x);
+  float i1y = 0.5 * (SampleSecond(pos + vec2(0.0, 1.0)).x -
+                     SampleSecond(pos - vec2(0.0, 1.0)).x);
+  float rho_c = i1w - i1x * u.x - i1y * u.y - imageLoad(first, gid).x;
+  imageStore(warp, gid, vec4(i1x, i1y, i1x * i1x + i1y * i1y, rho_c));
+}
+)";
+
+// Thresholding step on the data term followed by the primal update:
+// u = v + theta * div(p).
+constexpr char kPrimalShader[] = R"(
+layout(rgba32f, binding = 0) readonly uniform highp image2D warp;
+layout(rgba32f, binding = 1) readonly uniform highp image2D dual;
+layout(rgba32f, binding = 2) readonly uniform highp image2D src_flow;
+layout(rgba32f, binding = 3) writeonly uniform highp image2D dst_flow;
+layout(location = 0) uniform float lambda_theta;
+layout(location = 1) uniform float theta;
+
+void main() {
+  ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
+  if (any(greaterThanEqual(gid, imageSize(dst_flow)))) return;
+  vec4 w = imageLoad(warp, gid);
+  vec2 u = imageLoad(src_flow, gid).xy;
+  float rho = w.w + dot(w.xy, u);
+  vec2 v = u;
+  if (rho < -lambda_theta * w.z) {
+    v += lambda_theta * w.xy;
+  } else if (rho > lambda_theta * w.z) {
+    v -= lambda_theta * w.xy;
+  } else if (w.z > 1e-10) {
+    v -= rho / w.z * w.xy;
+  }
+  // Divergence with backward differences; the dual variables vanish outside
+  // of the image.
+  vec4 p = imageLoad(dual, gid);
+  vec4 p_left = gid.x > 0 ? imageLoad(dual, gid - ivec2(1, 0)) : vec4(0.0);
+  vec4 p_up = gid.y > 0 ? imageLoad(dual, gid - ivec2(0, 1)) : vec4(0.0);
+  vec2 div = vec2(p.x - p_left.x + p.y - p_up.y, p.z - p_left.z + p.w - p_up.w);
+  imageStore(dst_flow, gid, vec4(v + theta * div, 0.0, 0.0));
+}
+)";
+
+// Dual update: p = (p + tau / theta * grad(u)) / (1 + tau / theta * |grad(u)|)
+// for each flow component.
+constexpr char kDualShader[] = R"(
+layout(rgba32f, binding = 0) readonly uniform highp image2D flow;
+layout(rgba32f, binding = 1) readonly uniform highp image2D src_dual;
+layout(rgba32f, binding = 2) writeonly uniform highp image2D dst_dual;
+layout(location = 0) uniform float tau_theta;
+
+void main() {
+  ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
+  ivec2 size = imageSize(dst_dual);
+  if (any(greaterThanEqual(gid, size))) return;
+  // Gradient with forward differences, zero on the right and bottom borders.
+  vec2 u = imageLoad(flow, gid).xy;
+  vec2 u_x = gid.x + 1 < size.x
+                 ? imageLoad(flow, gid + ivec2(1, 0)).xy - u : vec2(0.0);
+  vec2 u_y = gid.y + 1 < size.y
+                 ? imageLoad(flow, gid + ivec2(0, 1)).xy - u : vec2(0.0);
+  vec4 grad = vec4(u_x.x, u_y.x, u_x.y, u_y.y);
+  vec4 p = imageLoad(src_dual, gid) + tau_theta * grad;
+  imageStore(dst_dual, gid,
+             vec4(p.xy / (1.0 + tau_theta * length(grad.xy)),
+                  p.zw / (1.0 + tau_theta * length(grad.zw))));
+}
+)";
+
+// Copies the flow of the finest level into a buffer for readback.
+constexpr char kReadbackShader[] = R"(
+layout(rgba32f, binding = 0) readonly uniform highp image2D flow;
+layout(std430, binding = 1) writeonly buffer Output {
+  vec2 elements[];
+} output_data;
+
+void main() {
+  ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
+  ivec2 size = imageSize(flow);
+  if (any(greaterThanEqual(gid, size))) return;
+  output_data.elements[gid.y * size.x + gid.x] = imageLoad(flow, gid).xy;
+}
+)";
+
+absl::Status CreateComputeProgram(const std::string& source,
+                                  GLuint* program) {
+  const std::string full_source = absl::StrCat(ShaderHeader(), source);
+  GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+  const GLchar* sources[] = {full_source.c_str()};
+  glShaderSource(shader, 1, sources, nullptr);
+  glCompileShader(shader);
+  GLint compiled = GL_FALSE;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+  if (compiled != GL_TRUE) {
+    GLint log_length = 0;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &log_length);
+    std::string log(log_length, '\0');
+    glGetShaderInfoLog(shader, log_length, nullptr, &log[0]);
+    glDeleteShader(shader);
+    return absl::InternalError(
+        absl::StrCat("Failed to compile compute shader: ", log));
+  }
+  *program = glCreateProgram();
+  glAttachShader(*program, shader);
+  glDeleteShader(shader);
+  glLinkProgram(*program);
+  GLint linked = GL_FALSE;
+  glGetProgramiv(*program, GL_LINK_STATUS, &linked);
+  RET_CHECK(linked == GL_TRUE) << "Failed to link compute shader.";
+  return absl::OkStatus();
+}
+
+GLuint CreateImageTexture(GLenum format, int width, int height) {
+  GLuint texture;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexStorage2D(GL_TEXTURE_2D, 1, format, width, height);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  return texture;
+}
+
+void BindImage(GLuint unit, GLuint texture, GLenum access, GLenum format) {
+  glBindImageTexture(unit, texture, /*level=*/0, /*layered=*/GL_FALSE,
+                     /*layer=*/0, access, format);
+}
+
+// Runs |program| over a width x height grid and makes its image writes
+// visible to the next dispatch.
+void Dispatch(GLuint program, int width, int height) {
+  glUseProgram(program);
+  glDispatchCompute(NumGroups(width, kWorkgroupSize),
+                    NumGroups(height, kWorkgroupSize), 1);
+  glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+}
+
+}  // namespace
+
+// GPU version of Tvl1OpticalFlowCalculator, computing the TV-L1 optical flow
+// (Zach et al., "A Duality Based Approach for Realtime TV-L1 Optical Flow")
+// between a pair of GpuBuffer frames with OpenGL ES 3.1 compute shaders.
+//
+// The flow is estimated coarse-to-fine on an image pyramid of up to
+// |num_scales| levels. On each level, the second frame is warped |num_warps|
+// times by the current estimate, each warp being followed by
+// |num_iterations| primal-dual iterations. Unlike OpenCV's DualTVL1, a fixed
+// number of iterations is always run and the flow is not median filtered.
+//
+// Both pyramids are built once per frame pair, so requesting both the
+// forward and the backward flow costs less than twice a single direction.
+// The flow is read back to the CPU to match the output type of
+// Tvl1OpticalFlowCalculator.
+//
+// Inputs:
+//   FIRST_FRAME: A GpuBuffer with an RGB(A) frame.
+//   SECOND_FRAME: A GpuBuffer with an RGB(A) frame of the same size.
+// Outputs:
+//   FORWARD_FLOW: The OpticalFlowField from the first frame to the second
+//                 frame, output at the input timestamp.
+//   BACKWARD_FLOW: The OpticalFlowField from the second frame to the first
+//                  frame, output at the input timestamp.
+// Example config:
+//   node {
+//     calculator: "Tvl1OpticalFlowGpuCalculator"
+//     input_stream: "FIRST_FRAME:first_frames_gpu"
+//     input_stream: "SECOND_FRAME:second_frames_gpu"
+//     output_stream: "FORWARD_FLOW:forward_flow"
+//     options {
+//       [mediapipe.Tvl1OpticalFlowGpuCalculatorOptions.ext] {
+//         num_scales: 4
+//         num_iterations: 50
+//       }
+//     }
+//   }
+class Tvl1OpticalFlowGpuCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+  absl::Status Close(CalculatorContext* cc) override;
+
+ private:
+  // Textures of one pyramid level. The flow (u1, u2, -, -) and the dual
+  // variables (p11, p12, p21, p22) are ping-ponged between two textures each,
+  // as OpenGL ES only allows in-place access to single channel images.
+  struct PyramidLevel {
+    int width = 0;
+    int height = 0;
+    GLuint first = 0;
+    GLuint second = 0;
+    GLuint warp = 0;
+    GLuint flow[2] = {0, 0};
+    GLuint dual[2] = {0, 0};
+  };
+
+  absl::Status InitGpu();
+  // (Re)allocates the pyramid textures for frames of the given size.
+  void AllocatePyramid(int width, int height);
+  void ReleasePyramid();
+  // Fills the |frame_image| textures of all pyramid levels from |frame|.
+  void BuildPyramid(const GlTexture& frame, GLuint PyramidLevel::*frame_image);
+  void CalculateOpticalFlow(bool forward, OpticalFlowField* flow);
+
+  Tvl1OpticalFlowGpuCalculatorOptions options_;
+  bool forward_requested_ = false;
+  bool backward_requested_ = false;
+
+  GlCalculatorHelper gpu_helper_;
+  bool gpu_initialized_ = false;
+  GLuint grayscale_program_ = 0;
+  GLuint downsample_program_ = 0;
+  GLuint clear_program_ = 0;
+  GLuint upsample_program_ = 0;
+  GLuint warp_program_ = 0;
+  GLuint primal_program_ = 0;
+  GLuint dual_program_ = 0;
+  GLuint readback_program_ = 0;
+  GLuint readback_buffer_ = 0;
+
+  // Finest level first.
+  std::vector<PyramidLevel> pyramid_;
+};
+
+absl::Status Tvl1OpticalFlowGpuCalculator::GetContract(
+    CalculatorContract* cc) {
+  if (!cc->Inputs().HasTag(kFirstFrameTag) ||
+      !cc->Inputs().HasTag(kSecondFrameTag)) {
+    return absl::InvalidArgumentError(
+        "Missing required input streams. Both FIRST_FRAME and SECOND_FRAME "
+        "must be specified.");
+  }
+  cc->Inputs().Tag(kFirstFrameTag).Set<GpuBuffer>();
+  cc->Inputs().Tag(kSecondFrameTag).Set<GpuBuffer>();
+  if (cc->Outputs().HasTag(kForwardFlowTag)) {
+    cc->Outputs().Tag(kForwardFlowTag).Set<OpticalFlowField>();
+  }
+  if (cc->Outputs().HasTag(kBackwardFlowTag)) {
+    cc->Outputs().Tag(kBackwardFlowTag).Set<OpticalFlowField>();
+  }
+  return GlCalculatorHelper::UpdateContract(cc);
+}
+
+absl::Status Tvl1OpticalFlowGpuCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+  options_ = cc->Options<Tvl1OpticalFlowGpuCalculatorOptions>();
+  RET_CHECK_GT(options_.num_scales(), 0);
+  RET_CHECK(options_.scale_step() > 0.0f && options_.scale_step() < 1.0f)
+      << "scale_step must be in (0, 1).";
+  RET_CHECK_GT(options_.num_warps(), 0);
+  RET_CHECK_GT(options_.num_iterations(), 0);
+  RET_CHECK_GT(options_.theta(), 0.0f);
+  forward_requested_ = cc->Outputs().HasTag(kForwardFlowTag);
+  backward_requested_ = cc->Outputs().HasTag(kBackwardFlowTag);
+  return gpu_helper_.Open(cc);
+}
+
+absl::Status Tvl1OpticalFlowGpuCalculator::Process(CalculatorContext* cc) {
+  const auto& first_frame = cc->Inputs().Tag(kFirstFrameTag).Get<GpuBuffer>();
+  const auto& second_frame =
+      cc->Inputs().Tag(kSecondFrameTag).Get<GpuBuffer>();
+  if (first_frame.width() != second_frame.width() ||
+      first_frame.height() != second_frame.height()) {
+    return absl::InvalidArgumentError("Images are different sizes.");
+  }
+  return gpu_helper_.RunInGlContext([&]() -> absl::Status {
+    if (!gpu_initialized_) {
+      MP_RETURN_IF_ERROR(InitGpu());
+      gpu_initialized_ = true;
+    }
+    AllocatePyramid(first_frame.width(), first_frame.height());
+    auto first_texture = gpu_helper_.CreateSourceTexture(first_frame);
+    BuildPyramid(first_texture, &PyramidLevel::first);
+    first_texture.Release();
+    auto second_texture = gpu_helper_.CreateSourceTexture(second_frame);
+    BuildPyramid(second_texture, &PyramidLevel::second);
+    second_texture.Release();
+
+    if (forward_requested_) {
+      auto flow = absl::make_unique<OpticalFlowField>();
+      CalculateOpticalFlow(/*forward=*/true, flow.get());
+      cc->Outputs()
+          .Tag(kForwardFlowTag)
+          .Add(flow.release(), cc->InputTimestamp());
+    }
+    if (backward_requested_) {
+      auto flow = absl::make_unique<OpticalFlowField>();
+      CalculateOpticalFlow(/*forward=*/false, flow.get());
+      cc->Outputs()
+          .Tag(kBackwardFlowTag)
+          .Add(flow.release(), cc->InputTimestamp());
+    }
+    return absl::OkStatus();
+  });
+}
+
+absl::Status Tvl1OpticalFlowGpuCalculator::Close(CalculatorContext* cc) {
+  gpu_helper_.RunInGlContext([this] {
+    ReleasePyramid();
+    for (GLuint* program :
+         {&grayscale_program_, &downsample_program_, &clear_program_,
+          &upsample_program_, &warp_program_, &primal_program_,
+          &dual_program_, &readback_program_}) {
+      if (*program) glDeleteProgram(*program);
+      *program = 0;
+    }
+    if (readback_buffer_) glDeleteBuffers(1, &readback_buffer_);
+    readback_buffer_ = 0;
+  });
+  gpu_initialized_ = false;
+  return absl::OkStatus();
+}
+
+absl::Status Tvl1OpticalFlowGpuCalculator::InitGpu() {
+  const GlContext& gl_context = gpu_helper_.GetGlContext();
+  RET_CHECK(gl_context.gl_major_version() > 3 ||
+            (gl_context.gl_major_version() == 3 &&
+             gl_context.gl_minor_version() >= 1))
+      << "Tvl1OpticalFlowGpuCalculator requires OpenGL ES 3.1.";
+  MP_RETURN_IF_ERROR(
+      CreateComputeProgram(kGrayscaleShader, &grayscale_program_));
+  MP_RETURN_IF_ERROR(CreateComputeProgram(
+      absl::Substitute(kDownsampleShader,
+                       absl::Substitute(kBilinearFunction, "SampleSrc", "src")),
+      &downsample_program_));
+  MP_RETURN_IF_ERROR(CreateComputeProgram(kClearShader, &clear_program_));
+  MP_RETURN_IF_ERROR(CreateComputeProgram(
+      absl::Substitute(
+          kUpsampleShader,
+          absl::Substitute(kBilinearFunction, "SampleFlow", "src_flow"),
+          absl::Substitute(kBilinearFunction, "SampleDual", "src_dual")),
+      &upsample_program_));
+  MP_RETURN_IF_ERROR(CreateComputeProgram(
+      absl::Substitute(kWarpShader, absl::Substitute(kBilinearFunction,
+                                                     "SampleSecond", "second")),
+      &warp_program_));
+  MP_RETURN_IF_ERROR(CreateComputeProgram(kPrimalShader, &primal_program_));
+  MP_RETURN_IF_ERROR(CreateComputeProgram(kDualShader, &dual_program_));
+  MP_RETURN_IF_ERROR(
+      CreateComputeProgram(kReadbackShader, &readback_program_));
+  glGenBuffers(1, &readback_buffer_);
+  return absl::OkStatus();
+}
+
+void Tvl1OpticalFlowGpuCalculator::AllocatePyramid(int width, int height) {
+  if (!pyramid_.empty() && pyramid_[0].width == width &&
+      pyramid_[0].height == height) {
+    return;
+  }
+  ReleasePyramid();
+  float scale = 1.0f;
+  for (int i = 0; i < options_.num_scales(); ++i) {
+    PyramidLevel level;
+    level.width = static_cast<int>(width * scale + 0.5f);
+    level.height = static_cast<int>(height * scale + 0.5f);
+    if (i > 0 &&
+        (level.width < kMinLevelSize || level.height < kMinLevelSize)) {
+      break;
+    }
+    level.first = CreateImageTexture(GL_R32F, level.width, level.height);
+    level.second = CreateImageTexture(GL_R32F, level.width, level.height);
+    level.warp = CreateImageTexture(GL_RGBA32F, level.width, level.height);
+    for (int k = 0; k < 2; ++k) {
+      level.flow[k] = CreateImageTexture(GL_RGBA32F, level.width, level.height);
+      level.dual[k] = CreateImageTexture(GL_RGBA32F, level.width, level.height);
+    }
+    pyramid_.push_back(level);
+    scale *= options_.scale_step();
+  }
+
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, readback_buffer_);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(float) * 2 * width * height,
+               nullptr, GL_STREAM_READ);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void Tvl1OpticalFlowGpuCalculator::ReleasePyramid() {
+  for (PyramidLevel& level : pyramid_) {
+    const GLuint textures[] = {level.first,   level.second,  level.warp,
+                               level.flow[0], level.flow[1], level.dual[0],
+                               level.dual[1]};
+    glDeleteTextures(ABSL_ARRAYSIZE(textures), textures);
+  }
+  pyramid_.clear();
+}
+
+void Tvl1OpticalFlowGpuCalculator::BuildPyramid(
+    const GlTexture& frame, GLuint PyramidLevel::*frame_image) {
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(frame.target(), frame.name());
+  BindImage(0, pyramid_[0].*frame_image, GL_WRITE_ONLY, GL_R32F);
+  Dispatch(grayscale_program_, pyramid_[0].width, pyramid_[0].height);
+  glBindTexture(frame.target(), 0);
+
+  const int num_levels = pyramid_.size();
+  for (int i = 1; i < num_levels; ++i) {
+    BindImage(0, pyramid_[i - 1].*frame_image, GL_READ_ONLY, GL_R32F);
+    BindImage(1, pyramid_[i].*frame_image, GL_WRITE_ONLY, GL_R32F);
+    Dispatch(downsample_program_, pyramid_[i].width, pyramid_[i].height);
+  }
+}
+
+void Tvl1OpticalFlowGpuCalculator::CalculateOpticalFlow(
+    bool forward, OpticalFlowField* flow) {
+  const float lambda_theta = options_.lambda() * options_.theta();
+  const float tau_theta = options_.tau() / options_.theta();
+  // Index of the flow and dual textures holding the latest estimate.
+  int current = 0;
+  const int num_levels = pyramid_.size();
+  for (int i = num_levels - 1; i >= 0; --i) {
+    const PyramidLevel& level = pyramid_[i];
+    if (i == num_levels - 1) {
+      BindImage(0, level.flow[0], GL_WRITE_ONLY, GL_RGBA32F);
+      BindImage(1, level.dual[0], GL_WRITE_ONLY, GL_RGBA32F);
+      Dispatch(clear_program_, level.width, level.height);
+    } else {
+      const PyramidLevel& coarser = pyramid_[i + 1];
+      BindImage(0, coarser.flow[current], GL_READ_ONLY, GL_RGBA32F);
+      BindImage(1, coarser.dual[current], GL_READ_ONLY, GL_RGBA32F);
+      BindImage(2, level.flow[0], GL_WRITE_ONLY, GL_RGBA32F);
+      BindImage(3, level.dual[0], GL_WRITE_ONLY, GL_RGBA32F);
+      Dispatch(upsample_program_, level.width, level.height);
+    }
+    current = 0;
+
+    const GLuint first = forward ? level.first : level.second;
+    const GLuint second = forward ? level.second : level.first;
+    for (int warp = 0; warp < options_.num_warps(); ++warp) {
+      BindImage(0, first, GL_READ_ONLY, GL_R32F);
+      BindImage(1, second, GL_READ_ONLY, GL_R32F);
+      BindImage(2, level.flow[current], GL_READ_ONLY, GL_RGBA32F);
+      BindImage(3, level.warp, GL_WRITE_ONLY, GL_RGBA32F);
+      Dispatch(warp_program_, level.width, level.height);
+
+      for (int iteration = 0; iteration < options_.num_iterations();
+           ++iteration) {
+        const int next = 1 - current;
+        glUseProgram(primal_program_);
+        glUniform1f(0, lambda_theta);
+        glUniform1f(1, options_.theta());
+        BindImage(0, level.warp, GL_READ_ONLY, GL_RGBA32F);
+        BindImage(1, level.dual[current], GL_READ_ONLY, GL_RGBA32F);
+        BindImage(2, level.flow[current], GL_READ_ONLY, GL_RGBA32F);
+        BindImage(3, level.flow[next], GL_WRITE_ONLY, GL_RGBA32F);
+        Dispatch(primal_program_, level.width, level.height);
+
+        glUseProgram(dual_program_);
+        glUniform1f(0, tau_theta);
+        BindImage(0, level.flow[next], GL_READ_ONLY, GL_RGBA32F);
+        BindImage(1, level.dual[current], GL_READ_ONLY, GL_RGBA32F);
+        BindImage(2, level.dual[next], GL_WRITE_ONLY, GL_RGBA32F);
+        Dispatch(dual_program_, level.width, level.height);
+        current = next;
+      }
+    }
+  }
+
+  const PyramidLevel& finest = pyramid_[0];
+  BindImage(0, finest.flow[current], GL_READ_ONLY, GL_RGBA32F);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, readback_buffer_);
+  glUseProgram(readback_program_);
+  glDispatchCompute(NumGroups(finest.width, kWorkgroupSize),
+                    NumGroups(finest.height, kWorkgroupSize), 1);
+  glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+  flow->Allocate(finest.width, finest.height);
+  cv::Mat& flow_data = flow->mutable_flow_data();
+  const size_t num_bytes = sizeof(float) * 2 * finest.width * finest.height;
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, readback_buffer_);
+  const void* data = glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, num_bytes,
+                                      GL_MAP_READ_BIT);
+  std::memcpy(flow_data.data, data, num_bytes);
+  glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+REGISTER_CALCULATOR(Tvl1OpticalFlowGpuCalculator);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
@@ -14,10 +14,12 @@
 
 #include "mediapipe/examples/desktop/autoflip/calculators/scene_cropping_calculator.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "absl/memory/memory.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/blocking_counter.h"
 #include "mediapipe/examples/desktop/autoflip/autoflip_messages.pb.h"
 #include "mediapipe/examples/desktop/autoflip/quality/scene_cropping_viz.h"
 #include "mediapipe/examples/desktop/autoflip/quality/utils.h"
@@ -30,6 +32,7 @@
 #include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/framework/timestamp.h"
 
 namespace mediapipe {
@@ -173,6 +176,19 @@ absl::Status SceneCroppingCalculator::Open(CalculatorContext* cc) {
         absl::make_unique<std::vector<ExternalRenderFrame>>();
   }
   should_perform_frame_cropping_ = cc->Outputs().HasTag(kOutputCroppedFrames);
+  if (options_.spill_scene_frames()) {
+    RET_CHECK_GT(options_.spill_read_batch_size(), 0)
+        << "Spill read batch size is non-positive.";
+    RET_CHECK(!cc->Outputs().HasTag(kOutputKeyFrameCropViz) &&
+              !cc->Outputs().HasTag(kOutputFocusPointFrameViz) &&
+              !cc->Outputs().HasTag(kOutputFramingAndDetections))
+        << "Visualization outputs cannot be used with spill_scene_frames.";
+  }
+  if (options_.num_threads() > 1) {
+    thread_pool_ = absl::make_unique<ThreadPool>("SceneCropping",
+                                                 options_.num_threads());
+    thread_pool_->StartWorkers();
+  }
   scene_camera_motion_analyzer_ = absl::make_unique<SceneCameraMotionAnalyzer>(
       options_.scene_camera_motion_analyzer_options());
   return absl::OkStatus();
@@ -381,9 +397,19 @@ absl::Status SceneCroppingCalculator::Process(
     if (should_perform_frame_cropping_) {
       const auto& frame = cc->Inputs().Tag(kInputVideoFrames).Get<ImageFrame>();
       const cv::Mat frame_mat = formats::MatView(&frame);
-      cv::Mat copy_mat;
-      frame_mat.copyTo(copy_mat);
-      scene_frames_or_empty_.push_back(copy_mat);
+      if (options_.spill_scene_frames()) {
+        if (!frame_spill_buffer_) {
+          ASSIGN_OR_RETURN(frame_spill_buffer_,
+                           FrameSpillBuffer::Create(
+                               frame_mat.cols, frame_mat.rows, frame_mat.type(),
+                               options_.spill_directory()));
+        }
+        MP_RETURN_IF_ERROR(frame_spill_buffer_->Append(frame_mat));
+      } else {
+        cv::Mat copy_mat;
+        frame_mat.copyTo(copy_mat);
+        scene_frames_or_empty_.push_back(copy_mat);
+      }
     }
     scene_frame_timestamps_.push_back(cc->InputTimestamp().Value());
     is_key_frames_.push_back(
@@ -551,10 +577,11 @@ absl::Status SceneCroppingCalculator::ProcessScene(const bool is_end_of_scene,
   MP_RETURN_IF_ERROR(InitializeFrameCropRegionComputer());
   const int num_key_frames = key_frame_infos_.size();
   std::vector<KeyFrameCropResult> key_frame_crop_results(num_key_frames);
-  for (int i = 0; i < num_key_frames; ++i) {
-    MP_RETURN_IF_ERROR(frame_crop_region_computer_->ComputeFrameCropRegion(
-        key_frame_infos_[i], &key_frame_crop_results[i]));
-  }
+  const auto compute_crop_region = [this, &key_frame_crop_results](int i) {
+    return frame_crop_region_computer_->ComputeFrameCropRegion(
+        key_frame_infos_[i], &key_frame_crop_results[i]);
+  };
+  MP_RETURN_IF_ERROR(ForEachFrame(num_key_frames, compute_crop_region));
 
   SceneKeyFrameCropSummary scene_summary;
   std::vector<FocusPointFrame> focus_point_frames;
@@ -570,13 +597,20 @@ absl::Status SceneCroppingCalculator::ProcessScene(const bool is_end_of_scene,
   std::vector<cv::Mat> cropped_frames;
   std::vector<cv::Rect> crop_from_locations;
 
+  // Spilled frames are cropped in batches by FormatAndOutputCroppedFrames().
   auto* cropped_frames_ptr =
-      should_perform_frame_cropping_ ? &cropped_frames : nullptr;
-
+      should_perform_frame_cropping_ && !options_.spill_scene_frames()
+          ? &cropped_frames
+          : nullptr;
+
+  // The static border sizes are measured on the key frames, while the crop
+  // windows are located on the input frames.
+  const int bottom_border_distance =
+      frame_height_ - top_border_distance_ - effective_frame_height_;
   MP_RETURN_IF_ERROR(scene_cropper_->CropFrames(
       scene_summary, scene_frame_timestamps_, is_key_frames_,
       scene_frames_or_empty_, focus_point_frames, prior_focus_point_frames_,
-      top_static_border_size, bottom_static_border_size, continue_last_scene_,
+      top_border_distance_, bottom_border_distance, continue_last_scene_,
       &crop_from_locations, cropped_frames_ptr));
 
   // Formats and outputs cropped frames.
@@ -649,6 +683,9 @@ absl::Status SceneCroppingCalculator::ProcessScene(const bool is_end_of_scene,
   scene_frames_or_empty_.clear();
   scene_frame_timestamps_.clear();
   is_key_frames_.clear();
+  if (frame_spill_buffer_) {
+    frame_spill_buffer_->Clear();
+  }
   static_features_.clear();
   static_features_timestamps_.clear();
   return absl::OkStatus();
@@ -726,49 +763,141 @@ absl::Status SceneCroppingCalculator::FormatAndOutputCroppedFrames(
     }
     padding_colors->push_back(padding_color_to_add);
   }
+
+  // cubic is better quality for upscaling and area is good for downscaling
+  const int interpolation_method =
+      scaling > 1 ? cv::INTER_CUBIC : cv::INTER_AREA;
+  if (should_perform_frame_cropping_ && frame_spill_buffer_) {
+    return CropAndOutputSpilledFrames(scaled_width, scaled_height,
+                                      interpolation_method, *apply_padding,
+                                      *padding_colors, cc);
+  }
   if (!cropped_frames_ptr) {
     return absl::OkStatus();
   }
 
   // Resizes cropped frames, pads frames, and output frames.
-  for (int i = 0; i < num_frames; ++i) {
-    const int64 time_ms = scene_frame_timestamps_[i];
-    const Timestamp timestamp(time_ms);
-    auto scaled_frame = absl::make_unique<ImageFrame>(
-        frame_format_, scaled_width, scaled_height);
-    auto destination = formats::MatView(scaled_frame.get());
-    if (scaled_width == crop_width && scaled_height == crop_height) {
-      cropped_frames_ptr->at(i).copyTo(destination);
-    } else {
-      // cubic is better quality for upscaling and area is good for
-      // downscaling
-      const int interpolation_method =
-          scaling > 1 ? cv::INTER_CUBIC : cv::INTER_AREA;
-      cv::resize(cropped_frames_ptr->at(i), destination, destination.size(), 0,
-                 0, interpolation_method);
+  return OutputCroppedFrames(0, *cropped_frames_ptr, scaled_width,
+                             scaled_height, interpolation_method,
+                             *apply_padding, *padding_colors, cc);
+}
+
+absl::Status SceneCroppingCalculator::CropAndOutputSpilledFrames(
+    int scaled_width, int scaled_height, int interpolation_method,
+    bool apply_padding, const std::vector<cv::Scalar>& padding_colors,
+    CalculatorContext* cc) {
+  const int num_frames = scene_frame_timestamps_.size();
+  RET_CHECK_EQ(frame_spill_buffer_->size(), num_frames)
+      << "Number of spilled frames does not match the scene size.";
+  // Removes static borders as RemoveStaticBorders() does for frames buffered
+  // in memory.
+  const cv::Rect roi(0, top_border_distance_, frame_width_,
+                     effective_frame_height_);
+  const int batch_size = options_.spill_read_batch_size();
+  cv::Mat spilled_frame;
+  std::vector<cv::Mat> frames;
+  std::vector<cv::Mat> cropped_frames;
+  for (int start = 0; start < num_frames; start += batch_size) {
+    const int end = std::min(num_frames, start + batch_size);
+    frames.resize(end - start);
+    for (int i = start; i < end; ++i) {
+      MP_RETURN_IF_ERROR(frame_spill_buffer_->Read(i, &spilled_frame));
+      spilled_frame(roi).copyTo(frames[i - start]);
     }
-    if (*apply_padding) {
-      cv::Scalar* background_color = nullptr;
-      if (has_solid_background_) {
-        background_color = &padding_colors->at(i);
-      }
-      auto padded_frame = absl::make_unique<ImageFrame>();
-      MP_RETURN_IF_ERROR(padder_->Process(
-          *scaled_frame, background_contrast_,
-          std::min({blur_cv_size_, scaled_width, scaled_height}),
-          overlay_opacity_, padded_frame.get(), background_color));
-      RET_CHECK_EQ(padded_frame->Width(), target_width_)
-          << "Padded frame width is off.";
-      RET_CHECK_EQ(padded_frame->Height(), target_height_)
-          << "Padded frame height is off.";
-      cc->Outputs()
-          .Tag(kOutputCroppedFrames)
-          .Add(padded_frame.release(), timestamp);
-    } else {
+    MP_RETURN_IF_ERROR(
+        scene_cropper_->CropFrameRange(start, frames, &cropped_frames));
+    MP_RETURN_IF_ERROR(OutputCroppedFrames(
+        start, cropped_frames, scaled_width, scaled_height,
+        interpolation_method, apply_padding, padding_colors, cc));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SceneCroppingCalculator::OutputCroppedFrames(
+    int first_frame_index, const std::vector<cv::Mat>& cropped_frames,
+    int scaled_width, int scaled_height, int interpolation_method,
+    bool apply_padding, const std::vector<cv::Scalar>& padding_colors,
+    CalculatorContext* cc) {
+  // Formats a few frames per thread at a time to bound the number of formatted
+  // frames waiting to be output.
+  const int num_frames = cropped_frames.size();
+  const int chunk_size = thread_pool_ ? 2 * thread_pool_->num_threads() : 1;
+  std::vector<std::unique_ptr<ImageFrame>> output_frames(chunk_size);
+  for (int start = 0; start < num_frames; start += chunk_size) {
+    const int end = std::min(num_frames, start + chunk_size);
+    MP_RETURN_IF_ERROR(ForEachFrame(end - start, [&](int i) {
+      return FormatCroppedFrame(cropped_frames[start + i],
+                                first_frame_index + start + i, scaled_width,
+                                scaled_height, interpolation_method,
+                                apply_padding, padding_colors,
+                                &output_frames[i]);
+    }));
+    for (int i = start; i < end; ++i) {
+      const Timestamp timestamp(
+          scene_frame_timestamps_[first_frame_index + i]);
       cc->Outputs()
           .Tag(kOutputCroppedFrames)
-          .Add(scaled_frame.release(), timestamp);
+          .Add(output_frames[i - start].release(), timestamp);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SceneCroppingCalculator::FormatCroppedFrame(
+    const cv::Mat& cropped_frame, int frame_index, int scaled_width,
+    int scaled_height, int interpolation_method, bool apply_padding,
+    const std::vector<cv::Scalar>& padding_colors,
+    std::unique_ptr<ImageFrame>* output_frame) const {
+  auto scaled_frame = absl::make_unique<ImageFrame>(frame_format_, scaled_width,
+                                                    scaled_height);
+  auto destination = formats::MatView(scaled_frame.get());
+  if (scaled_width == cropped_frame.cols &&
+      scaled_height == cropped_frame.rows) {
+    cropped_frame.copyTo(destination);
+  } else {
+    cv::resize(cropped_frame, destination, destination.size(), 0, 0,
+               interpolation_method);
+  }
+  if (!apply_padding) {
+    *output_frame = std::move(scaled_frame);
+    return absl::OkStatus();
+  }
+  const cv::Scalar* background_color = nullptr;
+  if (has_solid_background_) {
+    background_color = &padding_colors[frame_index];
+  }
+  auto padded_frame = absl::make_unique<ImageFrame>();
+  MP_RETURN_IF_ERROR(padder_->Process(
+      *scaled_frame, background_contrast_,
+      std::min({blur_cv_size_, scaled_width, scaled_height}), overlay_opacity_,
+      padded_frame.get(), background_color));
+  RET_CHECK_EQ(padded_frame->Width(), target_width_)
+      << "Padded frame width is off.";
+  RET_CHECK_EQ(padded_frame->Height(), target_height_)
+      << "Padded frame height is off.";
+  *output_frame = std::move(padded_frame);
+  return absl::OkStatus();
+}
+
+absl::Status SceneCroppingCalculator::ForEachFrame(
+    int num_frames, const std::function<absl::Status(int)>& fn) {
+  if (!thread_pool_ || num_frames < 2) {
+    for (int i = 0; i < num_frames; ++i) {
+      MP_RETURN_IF_ERROR(fn(i));
     }
+    return absl::OkStatus();
+  }
+  std::vector<absl::Status> statuses(num_frames);
+  absl::BlockingCounter counter(num_frames);
+  for (int i = 0; i < num_frames; ++i) {
+    thread_pool_->Schedule([&fn, &statuses, &counter, i] {
+      statuses[i] = fn(i);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  for (const auto& status : statuses) {
+    MP_RETURN_IF_ERROR(status);
   }
   return absl::OkStatus();
 }
@@ -15,6 +15,7 @@
 #ifndef MEDIAPIPE_EXAMPLES_DESKTOP_AUTOFLIP_CALCULATORS_SCENE_CROPPING_CALCULATOR_H_
 #define MEDIAPIPE_EXAMPLES_DESKTOP_AUTOFLIP_CALCULATORS_SCENE_CROPPING_CALCULATOR_H_
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -23,6 +24,7 @@
 #include "mediapipe/examples/desktop/autoflip/quality/cropping.pb.h"
 #include "mediapipe/examples/desktop/autoflip/quality/focus_point.pb.h"
 #include "mediapipe/examples/desktop/autoflip/quality/frame_crop_region_computer.h"
+#include "mediapipe/examples/desktop/autoflip/quality/frame_spill_buffer.h"
 #include "mediapipe/examples/desktop/autoflip/quality/padding_effect_generator.h"
 #include "mediapipe/examples/desktop/autoflip/quality/piecewise_linear_function.h"
 #include "mediapipe/examples/desktop/autoflip/quality/polynomial_regression_path_solver.h"
@@ -33,6 +35,7 @@
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/threadpool.h"
 
 namespace mediapipe {
 namespace autoflip {
@@ -123,6 +126,11 @@ namespace autoflip {
 // }
 // Note that only the target size is required in the options, and all other
 // fields are optional with default settings.
+//
+// By default, all frames of a scene are buffered in memory until the scene is
+// cropped. For long shots, set spill_scene_frames to buffer them in a
+// temporary file instead; together with max_scene_size, which forces the
+// camera path to be solved incrementally, this bounds the memory use.
 class SceneCroppingCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc);
@@ -181,6 +189,36 @@ class SceneCroppingCalculator : public CalculatorBase {
       std::vector<cv::Scalar>* padding_colors, float* vertical_fill_percent,
       const std::vector<cv::Mat>* cropped_frames_ptr, CalculatorContext* cc);
 
+  // Reads the frames of the scene back from |frame_spill_buffer_|, crops them
+  // in batches and passes them to OutputCroppedFrames().
+  absl::Status CropAndOutputSpilledFrames(
+      int scaled_width, int scaled_height, int interpolation_method,
+      bool apply_padding, const std::vector<cv::Scalar>& padding_colors,
+      CalculatorContext* cc);
+
+  // Formats |cropped_frames|, the cropped scene frames starting at
+  // |first_frame_index|, with FormatCroppedFrame() in parallel and outputs them
+  // in order.
+  absl::Status OutputCroppedFrames(
+      int first_frame_index, const std::vector<cv::Mat>& cropped_frames,
+      int scaled_width, int scaled_height, int interpolation_method,
+      bool apply_padding, const std::vector<cv::Scalar>& padding_colors,
+      CalculatorContext* cc);
+
+  // Scales |cropped_frame| of the scene frame at |frame_index| to the scaled
+  // size and pads it to the target size if |apply_padding| is true. Can be
+  // called concurrently.
+  absl::Status FormatCroppedFrame(
+      const cv::Mat& cropped_frame, int frame_index, int scaled_width,
+      int scaled_height, int interpolation_method, bool apply_padding,
+      const std::vector<cv::Scalar>& padding_colors,
+      std::unique_ptr<ImageFrame>* output_frame) const;
+
+  // Runs |fn| for each index in [0, |num_frames|), on |thread_pool_| if it is
+  // set, and returns the first error.
+  absl::Status ForEachFrame(int num_frames,
+                            const std::function<absl::Status(int)>& fn);
+
   // Draws and outputs visualization frames if those streams are present.
   absl::Status OutputVizFrames(
       const std::vector<KeyFrameCropResult>& key_frame_crop_results,
@@ -227,6 +265,10 @@ class SceneCroppingCalculator : public CalculatorBase {
   std::vector<int64> scene_frame_timestamps_;
   std::vector<bool> is_key_frames_;
 
+  // Buffered frames of the current scene if spill_scene_frames is set, in
+  // which case scene_frames_or_empty_ stays empty. Created on the first frame.
+  std::unique_ptr<FrameSpillBuffer> frame_spill_buffer_;
+
   // Static border information for the scene.
   int top_border_distance_ = -1;
   int effective_frame_height_ = -1;
@@ -273,6 +315,9 @@ class SceneCroppingCalculator : public CalculatorBase {
   // Object for padding an image to a target aspect ratio.
   std::unique_ptr<PaddingEffectGenerator> padder_ = nullptr;
 
+  // Pool for the per-frame work of a scene if num_threads is at least 2.
+  std::unique_ptr<ThreadPool> thread_pool_;
+
   // Optional diagnostic summary output emitted in Close().
   std::unique_ptr<VideoCroppingSummary> summary_ = nullptr;
 
@@ -397,6 +397,105 @@ TEST(SceneCroppingCalculatorTest, HandlesLongScene) {
   CheckCroppedFrames(*runner, 2 * kMaxSceneSize, kTargetWidth, kTargetHeight);
 }
 
+// Checks that spilling scene frames to a file produces the same cropped frames
+// as buffering them in memory, including across forced flushes.
+TEST(SceneCroppingCalculatorTest, SpillsSceneFrames) {
+  const CalculatorGraphConfig::Node config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::Substitute(
+          kConfig, kTargetWidth, kTargetHeight, kTargetSizeType, kMaxSceneSize,
+          kPriorFrameBufferSize));
+  CalculatorGraphConfig::Node spill_config = config;
+  auto* spill_options = spill_config.mutable_options()->MutableExtension(
+      SceneCroppingCalculatorOptions::ext);
+  spill_options->set_spill_scene_frames(true);
+  spill_options->set_spill_read_batch_size(3);
+
+  auto runner = absl::make_unique<CalculatorRunner>(config);
+  AddScene(0, 2 * kMaxSceneSize + 1, kInputFrameWidth, kInputFrameHeight,
+           kKeyFrameWidth, kKeyFrameHeight, kDownSampleRate,
+           runner->MutableInputs());
+  AddScene(2 * kMaxSceneSize + 1, kSceneSize, kInputFrameWidth,
+           kInputFrameHeight, kKeyFrameWidth, kKeyFrameHeight, kDownSampleRate,
+           runner->MutableInputs());
+  auto spill_runner = absl::make_unique<CalculatorRunner>(spill_config);
+  for (const char* tag : {kVideoFramesTag, kKeyFramesTag, kDetectionFeaturesTag,
+                          kStaticFeaturesTag, kShotBoundariesTag}) {
+    spill_runner->MutableInputs()->Tag(tag).packets =
+        runner->MutableInputs()->Tag(tag).packets;
+  }
+  MP_ASSERT_OK(runner->Run());
+  MP_ASSERT_OK(spill_runner->Run());
+
+  const int num_frames = 2 * kMaxSceneSize + 1 + kSceneSize;
+  CheckCroppedFrames(*spill_runner, num_frames, kTargetWidth, kTargetHeight);
+  const auto& packets = runner->Outputs().Tag(kCroppedFramesTag).packets;
+  const auto& spilled_packets =
+      spill_runner->Outputs().Tag(kCroppedFramesTag).packets;
+  ASSERT_EQ(spilled_packets.size(), packets.size());
+  for (int i = 0; i < packets.size(); ++i) {
+    EXPECT_EQ(spilled_packets[i].Timestamp(), packets[i].Timestamp());
+    const auto mat = formats::MatView(&packets[i].Get<ImageFrame>());
+    const auto spilled_mat =
+        formats::MatView(&spilled_packets[i].Get<ImageFrame>());
+    EXPECT_EQ(cv::norm(mat, spilled_mat, cv::NORM_INF), 0);
+  }
+}
+
+// Checks that processing scenes on a thread pool produces the same cropped
+// frames as processing them on the calculator thread.
+TEST(SceneCroppingCalculatorTest, ProcessesScenesInParallel) {
+  const CalculatorGraphConfig::Node config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::Substitute(
+          kConfig, kTargetWidth, kTargetHeight, kTargetSizeType, kMaxSceneSize,
+          kPriorFrameBufferSize));
+  CalculatorGraphConfig::Node parallel_config = config;
+  parallel_config.mutable_options()
+      ->MutableExtension(SceneCroppingCalculatorOptions::ext)
+      ->set_num_threads(4);
+
+  auto runner = absl::make_unique<CalculatorRunner>(config);
+  for (int i = 0; i < kNumScenes; ++i) {
+    AddScene(i * kSceneSize, kSceneSize, kInputFrameWidth, kInputFrameHeight,
+             kKeyFrameWidth, kKeyFrameHeight, kDownSampleRate,
+             runner->MutableInputs());
+  }
+  auto parallel_runner = absl::make_unique<CalculatorRunner>(parallel_config);
+  for (const char* tag : {kVideoFramesTag, kKeyFramesTag, kDetectionFeaturesTag,
+                          kStaticFeaturesTag, kShotBoundariesTag}) {
+    parallel_runner->MutableInputs()->Tag(tag).packets =
+        runner->MutableInputs()->Tag(tag).packets;
+  }
+  MP_ASSERT_OK(runner->Run());
+  MP_ASSERT_OK(parallel_runner->Run());
+
+  const auto& packets = runner->Outputs().Tag(kCroppedFramesTag).packets;
+  const auto& parallel_packets =
+      parallel_runner->Outputs().Tag(kCroppedFramesTag).packets;
+  ASSERT_EQ(parallel_packets.size(), kNumScenes * kSceneSize);
+  ASSERT_EQ(parallel_packets.size(), packets.size());
+  for (int i = 0; i < packets.size(); ++i) {
+    EXPECT_EQ(parallel_packets[i].Timestamp(), packets[i].Timestamp());
+    const auto mat = formats::MatView(&packets[i].Get<ImageFrame>());
+    const auto parallel_mat =
+        formats::MatView(&parallel_packets[i].Get<ImageFrame>());
+    EXPECT_EQ(cv::norm(mat, parallel_mat, cv::NORM_INF), 0);
+  }
+}
+
+// Checks that the calculator rejects debug streams when spilling frames.
+TEST(SceneCroppingCalculatorTest, ChecksSpillWithDebugStreams) {
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig::Node>(
+      absl::Substitute(kDebugConfig, kTargetWidth, kTargetHeight));
+  config.mutable_options()
+      ->MutableExtension(SceneCroppingCalculatorOptions::ext)
+      ->set_spill_scene_frames(true);
+  auto runner = absl::make_unique<CalculatorRunner>(config);
+  const auto status = runner->Run();
+  EXPECT_FALSE(status.ok());
+  EXPECT_THAT(status.ToString(),
+              HasSubstr("cannot be used with spill_scene_frames"));
+}
+
 // Checks that the calculator can optionally output debug streams.
 TEST(SceneCroppingCalculatorTest, OutputsDebugStreams) {
   const CalculatorGraphConfig::Node config =
@@ -779,6 +878,45 @@ TEST(SceneCroppingCalculatorTest, RemovesStaticBorders) {
   }
 }
 
+// Checks that static borders detected at key frame resolution are mapped back
+// to the input frame resolution in the external render messages.
+TEST(SceneCroppingCalculatorTest, MapsKeyFrameBordersToInputFrame) {
+  const int key_frame_border_size = 36;
+  const int frame_border_size =
+      key_frame_border_size * kInputFrameHeight / kKeyFrameHeight;
+  const auto config = ParseTextProtoOrDie<CalculatorGraphConfig::Node>(
+      absl::Substitute(kExternalRenderConfigNoVideo, kTargetWidth,
+                       kTargetHeight, kKeyFrameWidth, kKeyFrameHeight));
+  auto runner = absl::make_unique<CalculatorRunner>(config);
+  auto* inputs = runner->MutableInputs();
+  const auto timestamp = Timestamp(0);
+  inputs->Tag(kVideoSizeTag)
+      .packets.push_back(Adopt(new std::pair<int, int>(kInputFrameWidth,
+                                                       kInputFrameHeight))
+                             .At(timestamp));
+  auto static_features = absl::make_unique<StaticFeatures>();
+  auto* top_part = static_features->add_border();
+  top_part->set_relative_position(Border::TOP);
+  top_part->mutable_border_position()->set_height(key_frame_border_size);
+  auto* bottom_part = static_features->add_border();
+  bottom_part->set_relative_position(Border::BOTTOM);
+  bottom_part->mutable_border_position()->set_height(key_frame_border_size);
+  inputs->Tag(kStaticFeaturesTag)
+      .packets.push_back(Adopt(static_features.release()).At(timestamp));
+  inputs->Tag(kDetectionFeaturesTag)
+      .packets.push_back(Adopt(new DetectionSet()).At(timestamp));
+
+  MP_ASSERT_OK(runner->Run());
+  const auto& ext_render_per_frame =
+      runner->Outputs().Tag(kExternalRenderingPerFrameTag).packets;
+  ASSERT_EQ(ext_render_per_frame.size(), 1);
+  const auto& crop_from_location =
+      ext_render_per_frame[0].Get<ExternalRenderFrame>().crop_from_location();
+  EXPECT_EQ(crop_from_location.y(), frame_border_size);
+  EXPECT_EQ(crop_from_location.height(),
+            kInputFrameHeight - 2 * frame_border_size);
+}
+
 // Checks external render message with default poly path solver.
 TEST(SceneCroppingCalculatorTest, OutputsCropMessagePolyPath) {
   const CalculatorGraphConfig::Node config =
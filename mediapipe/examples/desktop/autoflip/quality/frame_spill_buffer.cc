@@ -0,0 +1,97 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/examples/desktop/autoflip/quality/frame_spill_buffer.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe {
+namespace autoflip {
+
+absl::StatusOr<std::unique_ptr<FrameSpillBuffer>> FrameSpillBuffer::Create(
+    int width, int height, int type, const std::string& directory) {
+  RET_CHECK_GT(width, 0) << "Frame width is non-positive.";
+  RET_CHECK_GT(height, 0) << "Frame height is non-positive.";
+  std::FILE* file = nullptr;
+  if (directory.empty()) {
+    file = std::tmpfile();
+  } else {
+    std::string path =
+        file::JoinPath(directory, "autoflip_frame_spill_XXXXXX");
+    std::vector<char> path_buffer(path.begin(), path.end());
+    path_buffer.push_back('\0');
+    const int fd = mkstemp(path_buffer.data());
+    if (fd >= 0) {
+      // The file stays accessible through |fd| and is deleted once closed.
+      unlink(path_buffer.data());
+      file = fdopen(fd, "w+b");
+      if (file == nullptr) close(fd);
+    }
+  }
+  RET_CHECK(file != nullptr)
+      << "Unable to create a frame spill file in '" << directory << "'.";
+  return absl::WrapUnique(new FrameSpillBuffer(file, width, height, type));
+}
+
+FrameSpillBuffer::FrameSpillBuffer(std::FILE* file, int width, int height,
+                                   int type)
+    : file_(file),
+      width_(width),
+      height_(height),
+      type_(type),
+      row_size_(static_cast<size_t>(width) * CV_ELEM_SIZE(type)) {}
+
+FrameSpillBuffer::~FrameSpillBuffer() { std::fclose(file_); }
+
+absl::Status FrameSpillBuffer::Append(const cv::Mat& frame) {
+  RET_CHECK(frame.cols == width_ && frame.rows == height_)
+      << "Frame size " << frame.cols << "x" << frame.rows
+      << " does not match the spill buffer size " << width_ << "x" << height_
+      << ".";
+  RET_CHECK_EQ(frame.type(), type_) << "Frame type does not match.";
+  const off_t offset =
+      static_cast<off_t>(num_frames_) * height_ * static_cast<off_t>(row_size_);
+  RET_CHECK_EQ(fseeko(file_, offset, SEEK_SET), 0) << "Unable to seek.";
+  for (int row = 0; row < height_; ++row) {
+    RET_CHECK_EQ(std::fwrite(frame.ptr(row), 1, row_size_, file_), row_size_)
+        << "Unable to write a spilled frame.";
+  }
+  ++num_frames_;
+  return absl::OkStatus();
+}
+
+absl::Status FrameSpillBuffer::Read(int index, cv::Mat* frame) const {
+  RET_CHECK(index >= 0 && index < num_frames_)
+      << "Frame index " << index << " is out of range.";
+  RET_CHECK_EQ(std::fflush(file_), 0) << "Unable to flush the spill file.";
+  const off_t offset =
+      static_cast<off_t>(index) * height_ * static_cast<off_t>(row_size_);
+  RET_CHECK_EQ(fseeko(file_, offset, SEEK_SET), 0) << "Unable to seek.";
+  frame->create(height_, width_, type_);
+  for (int row = 0; row < height_; ++row) {
+    RET_CHECK_EQ(std::fread(frame->ptr(row), 1, row_size_, file_), row_size_)
+        << "Unable to read a spilled frame.";
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace autoflip
+}  // namespace mediapipe
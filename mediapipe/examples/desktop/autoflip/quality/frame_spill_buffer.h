@@ -0,0 +1,79 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_EXAMPLES_DESKTOP_AUTOFLIP_QUALITY_FRAME_SPILL_BUFFER_H_
+#define MEDIAPIPE_EXAMPLES_DESKTOP_AUTOFLIP_QUALITY_FRAME_SPILL_BUFFER_H_
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+
+namespace mediapipe {
+namespace autoflip {
+
+// Buffers a sequence of equally sized frames in a temporary file instead of in
+// memory, so that frames of arbitrarily long scenes can be buffered and read
+// back by index. The file is removed when the buffer is destroyed (or, for an
+// explicit directory, as soon as it is created).
+//
+// Example usage:
+//   ASSIGN_OR_RETURN(auto buffer,
+//                    FrameSpillBuffer::Create(width, height, CV_8UC3, ""));
+//   MP_RETURN_IF_ERROR(buffer->Append(frame));
+//   cv::Mat frame_copy;
+//   MP_RETURN_IF_ERROR(buffer->Read(0, &frame_copy));
+//   buffer->Clear();
+class FrameSpillBuffer {
+ public:
+  // Creates a buffer for frames of the given size and OpenCV type. The backing
+  // file is created in |directory|, or in the system temporary directory if
+  // |directory| is empty.
+  static absl::StatusOr<std::unique_ptr<FrameSpillBuffer>> Create(
+      int width, int height, int type, const std::string& directory);
+
+  ~FrameSpillBuffer();
+  FrameSpillBuffer(const FrameSpillBuffer&) = delete;
+  FrameSpillBuffer& operator=(const FrameSpillBuffer&) = delete;
+
+  // Appends a copy of |frame|, which must match the buffer size and type.
+  absl::Status Append(const cv::Mat& frame);
+
+  // Reads the frame at |index| into |frame|, reallocating it if needed.
+  absl::Status Read(int index, cv::Mat* frame) const;
+
+  // Drops all buffered frames. The file space is reused by later appends.
+  void Clear() { num_frames_ = 0; }
+
+  int size() const { return num_frames_; }
+
+ private:
+  FrameSpillBuffer(std::FILE* file, int width, int height, int type);
+
+  std::FILE* file_;
+  const int width_;
+  const int height_;
+  const int type_;
+  // Number of bytes of one frame row in the file.
+  const size_t row_size_;
+  int num_frames_ = 0;
+};
+
+}  // namespace autoflip
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_EXAMPLES_DESKTOP_AUTOFLIP_QUALITY_FRAME_SPILL_BUFFER_H_
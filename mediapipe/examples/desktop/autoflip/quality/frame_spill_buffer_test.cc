@@ -0,0 +1,115 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/examples/desktop/autoflip/quality/frame_spill_buffer.h"
+
+#include <cstdlib>
+#include <memory>
+
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace autoflip {
+namespace {
+
+constexpr int kWidth = 31;
+constexpr int kHeight = 17;
+
+// Makes a frame with distinct pixel values derived from |seed|.
+cv::Mat MakeFrame(int seed) {
+  cv::Mat frame(kHeight, kWidth, CV_8UC3);
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      frame.at<cv::Vec3b>(y, x) =
+          cv::Vec3b(seed + x, seed + y, seed * 7 + x + y);
+    }
+  }
+  return frame;
+}
+
+void ExpectSameFrame(const cv::Mat& expected, const cv::Mat& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  ASSERT_EQ(expected.type(), actual.type());
+  EXPECT_EQ(cv::norm(expected, actual, cv::NORM_INF), 0);
+}
+
+TEST(FrameSpillBufferTest, ReadsBackAppendedFrames) {
+  MP_ASSERT_OK_AND_ASSIGN(auto buffer,
+                          FrameSpillBuffer::Create(kWidth, kHeight, CV_8UC3,
+                                                   /*directory=*/""));
+  for (int i = 0; i < 5; ++i) {
+    MP_ASSERT_OK(buffer->Append(MakeFrame(i)));
+  }
+  EXPECT_EQ(buffer->size(), 5);
+  cv::Mat frame;
+  for (int i = 4; i >= 0; --i) {
+    MP_ASSERT_OK(buffer->Read(i, &frame));
+    ExpectSameFrame(MakeFrame(i), frame);
+  }
+}
+
+TEST(FrameSpillBufferTest, AppendsNonContinuousFrames) {
+  MP_ASSERT_OK_AND_ASSIGN(auto buffer,
+                          FrameSpillBuffer::Create(kWidth, kHeight, CV_8UC3,
+                                                   /*directory=*/""));
+  const cv::Mat expected_frame = MakeFrame(3);
+  cv::Mat padded_frame(kHeight + 2, kWidth + 4, CV_8UC3, cv::Scalar(0));
+  expected_frame.copyTo(padded_frame(cv::Rect(2, 1, kWidth, kHeight)));
+  MP_ASSERT_OK(buffer->Append(padded_frame(cv::Rect(2, 1, kWidth, kHeight))));
+  cv::Mat frame;
+  MP_ASSERT_OK(buffer->Read(0, &frame));
+  ExpectSameFrame(expected_frame, frame);
+}
+
+TEST(FrameSpillBufferTest, ReusesFileAfterClear) {
+  MP_ASSERT_OK_AND_ASSIGN(auto buffer,
+                          FrameSpillBuffer::Create(kWidth, kHeight, CV_8UC3,
+                                                   /*directory=*/""));
+  MP_ASSERT_OK(buffer->Append(MakeFrame(1)));
+  MP_ASSERT_OK(buffer->Append(MakeFrame(2)));
+  buffer->Clear();
+  EXPECT_EQ(buffer->size(), 0);
+  cv::Mat frame;
+  EXPECT_FALSE(buffer->Read(0, &frame).ok());
+  MP_ASSERT_OK(buffer->Append(MakeFrame(9)));
+  MP_ASSERT_OK(buffer->Read(0, &frame));
+  ExpectSameFrame(MakeFrame(9), frame);
+}
+
+TEST(FrameSpillBufferTest, SpillsToDirectory) {
+  const char* test_tmpdir = std::getenv("TEST_TMPDIR");
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto buffer,
+      FrameSpillBuffer::Create(kWidth, kHeight, CV_8UC3,
+                               test_tmpdir ? test_tmpdir : "/tmp"));
+  MP_ASSERT_OK(buffer->Append(MakeFrame(4)));
+  cv::Mat frame;
+  MP_ASSERT_OK(buffer->Read(0, &frame));
+  ExpectSameFrame(MakeFrame(4), frame);
+}
+
+TEST(FrameSpillBufferTest, RejectsMismatchedFrames) {
+  MP_ASSERT_OK_AND_ASSIGN(auto buffer,
+                          FrameSpillBuffer::Create(kWidth, kHeight, CV_8UC3,
+                                                   /*directory=*/""));
+  EXPECT_FALSE(buffer->Append(cv::Mat(kHeight, kWidth + 1, CV_8UC3)).ok());
+  EXPECT_FALSE(buffer->Append(cv::Mat(kHeight, kWidth, CV_8UC1)).ok());
+  EXPECT_EQ(buffer->size(), 0);
+}
+
+}  // namespace
+}  // namespace autoflip
+}  // namespace mediapipe
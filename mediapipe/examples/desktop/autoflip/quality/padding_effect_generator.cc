@@ -48,7 +48,7 @@ PaddingEffectGenerator::PaddingEffectGenerator(const int input_width,
 absl::Status PaddingEffectGenerator::Process(
     const ImageFrame& input_frame, const float background_contrast,
     const int blur_cv_size, const float overlay_opacity,
-    ImageFrame* output_frame, const cv::Scalar* background_color_in_rgb) {
+    ImageFrame* output_frame, const cv::Scalar* background_color_in_rgb) const {
   RET_CHECK_EQ(input_frame.Width(), input_width_);
   RET_CHECK_EQ(input_frame.Height(), input_height_);
   RET_CHECK(output_frame);
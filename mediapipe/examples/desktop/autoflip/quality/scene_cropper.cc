@@ -111,7 +111,8 @@ absl::Status SceneCropper::CropFrames(
 
   // Computes transforms.
 
-  std::vector<cv::Mat> scene_frame_xforms;
+  scene_frame_xforms_.clear();
+  crop_size_ = cv::Size(crop_width, crop_height);
   int num_prior = 0;
   if (camera_motion_options_.has_polynomial_path_solver()) {
     num_prior = prior_focus_point_frames.size();
@@ -121,11 +122,11 @@ absl::Status SceneCropper::CropFrames(
         focus_point_frames, prior_focus_point_frames, frame_width, frame_height,
         crop_width, crop_height, &all_xforms));
 
-    scene_frame_xforms =
+    scene_frame_xforms_ =
         std::vector<cv::Mat>(all_xforms.begin() + num_prior, all_xforms.end());
 
     // Convert the matrix from center-aligned to upper-left aligned.
-    for (cv::Mat& xform : scene_frame_xforms) {
+    for (cv::Mat& xform : scene_frame_xforms_) {
       cv::Mat affine_opencv = cv::Mat::eye(2, 3, CV_32FC1);
       affine_opencv.at<float>(0, 2) =
           -(xform.at<float>(0, 2) + frame_width / 2 - crop_width / 2);
@@ -137,15 +138,15 @@ absl::Status SceneCropper::CropFrames(
     num_prior = 0;
     MP_RETURN_IF_ERROR(ProcessKinematicPathSolver(
         scene_summary, scene_timestamps, is_key_frames, focus_point_frames,
-        continue_last_scene, &scene_frame_xforms));
+        continue_last_scene, &scene_frame_xforms_));
   }
 
   // Store the "crop from" location on the input frame for use with an external
   // renderer.
   for (int i = 0; i < num_scene_frames; i++) {
-    const int left = -(scene_frame_xforms[i].at<float>(0, 2));
+    const int left = -(scene_frame_xforms_[i].at<float>(0, 2));
     const int top =
-        top_static_border_size - (scene_frame_xforms[i].at<float>(1, 2));
+        top_static_border_size - (scene_frame_xforms_[i].at<float>(1, 2));
     crop_from_location->push_back(cv::Rect(left, top, crop_width, crop_height));
   }
 
@@ -156,15 +157,28 @@ absl::Status SceneCropper::CropFrames(
   RET_CHECK(!scene_frames_or_empty.empty())
       << "If |cropped_frames| != nullptr, scene_frames_or_empty must not be "
          "empty.";
+  RET_CHECK_EQ(scene_frames_or_empty.size(), num_scene_frames)
+      << "Wrong number of scene frames.";
+  return CropFrameRange(0, scene_frames_or_empty, cropped_frames);
+}
+
+absl::Status SceneCropper::CropFrameRange(
+    int first_frame_index, const std::vector<cv::Mat>& scene_frames,
+    std::vector<cv::Mat>* cropped_frames) const {
+  const int num_frames = scene_frames.size();
+  RET_CHECK(first_frame_index >= 0 &&
+            first_frame_index + num_frames <= scene_frame_xforms_.size())
+      << "Frame range is out of the cropped scene.";
   // Prepares cropped frames.
-  cropped_frames->resize(num_scene_frames);
-  for (int i = 0; i < num_scene_frames; ++i) {
-    (*cropped_frames)[i] = cv::Mat::zeros(crop_height, crop_width,
-                                          scene_frames_or_empty[i].type());
+  cropped_frames->resize(num_frames);
+  for (int i = 0; i < num_frames; ++i) {
+    (*cropped_frames)[i] = cv::Mat::zeros(crop_size_.height, crop_size_.width,
+                                          scene_frames[i].type());
   }
-  return AffineRetarget(cv::Size(crop_width, crop_height),
-                        scene_frames_or_empty, scene_frame_xforms,
-                        cropped_frames);
+  const std::vector<cv::Mat> xforms(
+      scene_frame_xforms_.begin() + first_frame_index,
+      scene_frame_xforms_.begin() + first_frame_index + num_frames);
+  return AffineRetarget(crop_size_, scene_frames, xforms, cropped_frames);
 }
 
 }  // namespace autoflip
@@ -71,6 +71,13 @@ class SceneCropper {
       const bool continue_last_scene, std::vector<cv::Rect>* crop_from_location,
       std::vector<cv::Mat>* cropped_frames);
 
+  // Crops |scene_frames|, the scene frames starting at |first_frame_index|,
+  // with the transforms computed by the last call to CropFrames(). This lets
+  // callers that do not hold all scene frames in memory crop them in batches.
+  absl::Status CropFrameRange(int first_frame_index,
+                              const std::vector<cv::Mat>& scene_frames,
+                              std::vector<cv::Mat>* cropped_frames) const;
+
   absl::Status ProcessKinematicPathSolver(
       const SceneKeyFrameCropSummary& scene_summary,
       const std::vector<int64>& scene_timestamps,
@@ -84,6 +91,9 @@ class SceneCropper {
   CameraMotionOptions camera_motion_options_;
   int frame_width_;
   int frame_height_;
+  // Transforms and crop window size from the last call to CropFrames().
+  std::vector<cv::Mat> scene_frame_xforms_;
+  cv::Size crop_size_;
 };
 
 }  // namespace autoflip
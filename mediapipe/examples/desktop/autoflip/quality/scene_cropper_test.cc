@@ -225,5 +225,39 @@ TEST(SceneCropperTest, CropFromLocation) {
   }
 }
 
+// Checks that CropFrameRange crops frame batches like CropFrames.
+TEST(SceneCropperTest, CropFrameRangeMatchesCropFrames) {
+  CameraMotionOptions options;
+  options.mutable_polynomial_path_solver()->set_prior_frame_buffer_size(30);
+  SceneCropper scene_cropper(options, kSceneWidth, kSceneHeight);
+  std::vector<cv::Mat> cropped_frames;
+  std::vector<cv::Rect> crop_from_locations;
+  const auto& scene_frames = GetDefaultSceneFrames();
+  MP_ASSERT_OK(scene_cropper.CropFrames(
+      GetDefaultSceneKeyFrameCropSummary(), GetTimestamps(scene_frames.size()),
+      GetIsKeyframe(scene_frames.size()), scene_frames,
+      GetDefaultFocusPointFrames(), GetFocusPointFrames(3), 0, 0, false,
+      &crop_from_locations, &cropped_frames));
+
+  const int first_frame_index = 10;
+  const std::vector<cv::Mat> batch(scene_frames.begin() + first_frame_index,
+                                   scene_frames.begin() + 20);
+  std::vector<cv::Mat> cropped_batch;
+  MP_ASSERT_OK(scene_cropper.CropFrameRange(first_frame_index, batch,
+                                            &cropped_batch));
+  ASSERT_EQ(cropped_batch.size(), batch.size());
+  for (int i = 0; i < batch.size(); ++i) {
+    EXPECT_EQ(cv::norm(cropped_batch[i], cropped_frames[first_frame_index + i],
+                       cv::NORM_INF),
+              0);
+  }
+
+  const auto status =
+      scene_cropper.CropFrameRange(kNumSceneFrames - 5, batch, &cropped_batch);
+  EXPECT_FALSE(status.ok());
+  EXPECT_THAT(status.ToString(),
+              HasSubstr("Frame range is out of the cropped scene."));
+}
+
 }  // namespace autoflip
 }  // namespace mediapipe
@@ -0,0 +1,507 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A main function to benchmark a MediaPipe graph. It sends synthetic or
+// recorded packets into every graph input stream, either at a target rate or
+// as fast as the graph accepts them, and reports the throughput, the
+// end-to-end latency percentiles, the startup time, the per-node Process()
+// runtimes and the peak resident set size. For example:
+//
+//   bazel run -c opt //mediapipe/examples/desktop:mediapipe_graph_benchmark --
+//     --calculator_graph_config_file=graph.pbtxt
+//     --input_streams=input_video=image:640x480 --target_fps=30
+//
+// A timestamp is complete when every observed output stream has settled it,
+// either by emitting a packet or by advancing its timestamp bound.
+//
+// With --output_json, the results are also written as a JSON object in a
+// stable schema, which perf_regression_suite compares against a baseline.
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/map_util.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/opencv_video_inc.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/statusor.h"
+
+ABSL_FLAG(std::string, calculator_graph_config_file, "",
+          "Name of file containing text format CalculatorGraphConfig proto.");
+ABSL_FLAG(std::string, input_side_packets, "",
+          "Comma-separated list of key=value pairs specifying side packets "
+          "for the CalculatorGraph. All values will be treated as the "
+          "string type even if they represent doubles, floats, etc.");
+ABSL_FLAG(std::string, input_streams, "",
+          "Comma-separated list of stream=source pairs, one for every graph "
+          "input stream. A source is one of image:<width>x<height> (a "
+          "random SRGB ImageFrame), string:<length>, int, float, or "
+          "video:<path> (the frames of a recorded video, repeated as needed).");
+ABSL_FLAG(std::string, output_streams, "",
+          "Comma-separated list of the output streams that complete a "
+          "timestamp. Defaults to all graph output streams.");
+ABSL_FLAG(int, num_packets, 1000,
+          "The number of packets sent into each input stream, not counting "
+          "the warm-up packets.");
+ABSL_FLAG(int, warmup_packets, 50,
+          "The number of packets sent before measuring starts.");
+ABSL_FLAG(double, target_fps, 0,
+          "The rate at which packets are sent. If 0, packets are sent as fast "
+          "as --max_in_flight allows.");
+ABSL_FLAG(int, max_in_flight, 1,
+          "The maximum number of timestamps in the graph at once. If 0, "
+          "packets are sent without waiting for the graph.");
+ABSL_FLAG(std::string, gpu_input_streams, "",
+          "Comma-separated list of graph input streams that take GpuBuffers. "
+          "Their ImageFrame packets are uploaded by an "
+          "ImageFrameToGpuBufferCalculator added to the graph.");
+ABSL_FLAG(std::string, output_json, "",
+          "If set, the file the results are written to as JSON.");
+ABSL_FLAG(std::string, benchmark_name, "",
+          "The name of the benchmark in the JSON results. Defaults to the "
+          "graph config file.");
+
+namespace {
+
+// Recorded videos are decoded up front and repeated, which bounds the memory
+// used for the decoded frames.
+constexpr int kMaxVideoFrames = 100;
+
+// Version of the --output_json schema. Increment it when the meaning of a
+// field changes, so that results are not compared against stale baselines.
+constexpr int kJsonSchemaVersion = 1;
+
+// The packets sent into one graph input stream, cycled through in order.
+struct InputSource {
+  std::string stream_name;
+  std::vector<mediapipe::Packet> packets;
+};
+
+// Returns a random SRGB ImageFrame, so that no calculator sees constant data.
+mediapipe::Packet MakeImagePacket(int width, int height) {
+  auto frame = absl::make_unique<mediapipe::ImageFrame>(
+      mediapipe::ImageFormat::SRGB, width, height,
+      mediapipe::ImageFrame::kDefaultAlignmentBoundary);
+  cv::Mat mat = mediapipe::formats::MatView(frame.get());
+  cv::randu(mat, cv::Scalar::all(0), cv::Scalar::all(255));
+  return mediapipe::Adopt(frame.release());
+}
+
+// Reads up to "max_frames" frames of a video file as SRGB ImageFrames.
+absl::StatusOr<std::vector<mediapipe::Packet>> ReadVideoPackets(
+    const std::string& path, int max_frames) {
+  cv::VideoCapture capture(path);
+  RET_CHECK(capture.isOpened()) << "Cannot open video: " << path;
+  std::vector<mediapipe::Packet> packets;
+  while (packets.size() < max_frames) {
+    cv::Mat frame_bgr;
+    capture >> frame_bgr;
+    if (frame_bgr.empty()) break;
+    auto frame = absl::make_unique<mediapipe::ImageFrame>(
+        mediapipe::ImageFormat::SRGB, frame_bgr.cols, frame_bgr.rows,
+        mediapipe::ImageFrame::kDefaultAlignmentBoundary);
+    cv::Mat frame_mat = mediapipe::formats::MatView(frame.get());
+    cv::cvtColor(frame_bgr, frame_mat, cv::COLOR_BGR2RGB);
+    packets.push_back(mediapipe::Adopt(frame.release()));
+  }
+  RET_CHECK(!packets.empty()) << "No frames in video: " << path;
+  return packets;
+}
+
+// Creates the packets for one --input_streams source.
+absl::StatusOr<std::vector<mediapipe::Packet>> MakeSourcePackets(
+    absl::string_view source, int max_packets) {
+  std::vector<std::string> kind_and_arg =
+      absl::StrSplit(source, absl::MaxSplits(':', 1));
+  const std::string& kind = kind_and_arg[0];
+  const std::string arg = kind_and_arg.size() > 1 ? kind_and_arg[1] : "";
+  if (kind == "image") {
+    std::vector<std::string> size = absl::StrSplit(arg, 'x');
+    int width, height;
+    RET_CHECK(size.size() == 2 && absl::SimpleAtoi(size[0], &width) &&
+              absl::SimpleAtoi(size[1], &height) && width > 0 && height > 0)
+        << "Expected image:<width>x<height>, got: " << source;
+    return std::vector<mediapipe::Packet>{MakeImagePacket(width, height)};
+  }
+  if (kind == "string") {
+    int length;
+    RET_CHECK(absl::SimpleAtoi(arg, &length) && length >= 0)
+        << "Expected string:<length>, got: " << source;
+    return std::vector<mediapipe::Packet>{
+        mediapipe::MakePacket<std::string>(length, 'x')};
+  }
+  if (kind == "int") {
+    return std::vector<mediapipe::Packet>{mediapipe::MakePacket<int>(0)};
+  }
+  if (kind == "float") {
+    return std::vector<mediapipe::Packet>{mediapipe::MakePacket<float>(0)};
+  }
+  if (kind == "video") {
+    return ReadVideoPackets(arg, std::min(max_packets, kMaxVideoFrames));
+  }
+  return absl::InvalidArgumentError(
+      absl::StrCat("Unknown input source: ", source));
+}
+
+// Records the send time of every timestamp and its latency once all observed
+// output streams have settled it.
+class LatencyTracker {
+ public:
+  explicit LatencyTracker(int num_streams) : settled_(num_streams) {}
+
+  void Sent(mediapipe::Timestamp timestamp, bool measured) {
+    absl::MutexLock lock(&mutex_);
+    in_flight_[timestamp] = {absl::Now(), measured};
+  }
+
+  // Called for every packet or timestamp bound of output stream "index".
+  void Settled(int index, mediapipe::Timestamp timestamp) {
+    absl::MutexLock lock(&mutex_);
+    settled_[index] = std::max(settled_[index], timestamp);
+    const mediapipe::Timestamp min_settled =
+        *std::min_element(settled_.begin(), settled_.end());
+    const absl::Time now = absl::Now();
+    while (!in_flight_.empty() && in_flight_.begin()->first <= min_settled) {
+      first_complete_time_ = std::min(first_complete_time_, now);
+      const SendInfo& info = in_flight_.begin()->second;
+      if (info.measured) {
+        latencies_.push_back(now - info.send_time);
+        first_send_time_ = std::min(first_send_time_, info.send_time);
+        last_done_time_ = now;
+      }
+      in_flight_.erase(in_flight_.begin());
+    }
+  }
+
+  // Waits until at most "max_in_flight" timestamps are incomplete.
+  void WaitForInFlight(int max_in_flight) {
+    absl::MutexLock lock(&mutex_);
+    auto below_limit = [this, max_in_flight]() {
+      mutex_.AssertHeld();
+      return in_flight_.size() < max_in_flight;
+    };
+    mutex_.Await(absl::Condition(&below_limit));
+  }
+
+  std::vector<absl::Duration> Latencies() {
+    absl::MutexLock lock(&mutex_);
+    return latencies_;
+  }
+
+  absl::Duration MeasuredTime() {
+    absl::MutexLock lock(&mutex_);
+    return last_done_time_ - first_send_time_;
+  }
+
+  // Returns when the first timestamp was completed.
+  absl::Time FirstCompleteTime() {
+    absl::MutexLock lock(&mutex_);
+    return first_complete_time_;
+  }
+
+ private:
+  struct SendInfo {
+    absl::Time send_time;
+    bool measured;
+  };
+
+  absl::Mutex mutex_;
+  std::vector<mediapipe::Timestamp> settled_;
+  std::map<mediapipe::Timestamp, SendInfo> in_flight_;
+  std::vector<absl::Duration> latencies_;
+  absl::Time first_send_time_ = absl::InfiniteFuture();
+  absl::Time last_done_time_ = absl::InfinitePast();
+  absl::Time first_complete_time_ = absl::InfiniteFuture();
+};
+
+// Returns the nearest-rank percentile of sorted durations in milliseconds.
+double PercentileMs(const std::vector<absl::Duration>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  int rank = static_cast<int>(std::ceil(p / 100 * sorted.size()));
+  rank = std::min<int>(std::max(rank, 1), sorted.size());
+  return absl::ToDoubleMilliseconds(sorted[rank - 1]);
+}
+
+// Returns the peak resident set size of this process in MiB.
+double PeakRssMb() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+  return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+  return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+// The results of a benchmark run.
+struct Summary {
+  int completed_timestamps = 0;
+  double throughput_fps = 0;
+  double p50_ms = 0;
+  double p90_ms = 0;
+  double p99_ms = 0;
+  // From graph initialization until the first timestamp is complete.
+  double startup_ms = 0;
+  double peak_rss_mb = 0;
+};
+
+Summary Summarize(LatencyTracker& tracker, absl::Time init_time) {
+  std::vector<absl::Duration> latencies = tracker.Latencies();
+  std::sort(latencies.begin(), latencies.end());
+  const double seconds = absl::ToDoubleSeconds(tracker.MeasuredTime());
+  Summary summary;
+  summary.completed_timestamps = latencies.size();
+  summary.throughput_fps = seconds > 0 ? latencies.size() / seconds : 0;
+  summary.p50_ms = PercentileMs(latencies, 50);
+  summary.p90_ms = PercentileMs(latencies, 90);
+  summary.p99_ms = PercentileMs(latencies, 99);
+  const absl::Time first_complete_time = tracker.FirstCompleteTime();
+  if (first_complete_time != absl::InfiniteFuture()) {
+    summary.startup_ms =
+        absl::ToDoubleMilliseconds(first_complete_time - init_time);
+  }
+  summary.peak_rss_mb = PeakRssMb();
+  return summary;
+}
+
+// Writes the summary as JSON. Fields are only ever added to this schema.
+absl::Status WriteJson(const std::string& path, const std::string& name,
+                       const Summary& summary) {
+  std::ofstream file(path);
+  RET_CHECK(file.is_open()) << "Cannot open " << path;
+  file << absl::StrFormat(
+      "{\n"
+      "  \"schema_version\": %d,\n"
+      "  \"name\": \"%s\",\n"
+      "  \"completed_timestamps\": %d,\n"
+      "  \"throughput_fps\": %.3f,\n"
+      "  \"latency_ms\": {\"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f},\n"
+      "  \"startup_ms\": %.3f,\n"
+      "  \"peak_rss_mb\": %.1f\n"
+      "}\n",
+      kJsonSchemaVersion, absl::CEscape(name), summary.completed_timestamps,
+      summary.throughput_fps, summary.p50_ms, summary.p90_ms, summary.p99_ms,
+      summary.startup_ms, summary.peak_rss_mb);
+  file.close();
+  RET_CHECK(!file.fail()) << "Cannot write " << path;
+  return absl::OkStatus();
+}
+
+void PrintReport(const Summary& summary,
+                 const std::vector<mediapipe::CalculatorProfile>& profiles) {
+  std::cout << absl::StrFormat("Completed timestamps: %d\n",
+                               summary.completed_timestamps);
+  std::cout << absl::StrFormat("Throughput: %.2f fps\n",
+                               summary.throughput_fps);
+  std::cout << absl::StrFormat(
+      "Latency: p50 %.3f ms, p90 %.3f ms, p99 %.3f ms\n", summary.p50_ms,
+      summary.p90_ms, summary.p99_ms);
+  std::cout << absl::StrFormat("Startup: %.1f ms\n", summary.startup_ms);
+  std::cout << absl::StrFormat("Peak RSS: %.1f MiB\n", summary.peak_rss_mb);
+
+  int64 total_usec = 0;
+  for (const auto& profile : profiles) {
+    total_usec += profile.process_runtime().total();
+  }
+  std::cout << absl::StrFormat("%-40s %10s %12s %8s\n", "Node", "Calls",
+                               "Mean (us)", "Share");
+  for (const auto& profile : profiles) {
+    const mediapipe::TimeHistogram& runtime = profile.process_runtime();
+    int64 calls = 0;
+    for (int64 count : runtime.count()) calls += count;
+    std::cout << absl::StrFormat(
+        "%-40s %10d %12.1f %7.1f%%\n", profile.name(), calls,
+        calls > 0 ? static_cast<double>(runtime.total()) / calls : 0,
+        total_usec > 0 ? 100.0 * runtime.total() / total_usec : 0);
+  }
+}
+
+absl::Status RunMPPGraph() {
+  std::string calculator_graph_config_contents;
+  MP_RETURN_IF_ERROR(mediapipe::file::GetContents(
+      absl::GetFlag(FLAGS_calculator_graph_config_file),
+      &calculator_graph_config_contents));
+  mediapipe::CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(
+          calculator_graph_config_contents);
+  config.mutable_profiler_config()->set_enable_profiler(true);
+
+  std::map<std::string, mediapipe::Packet> input_side_packets;
+  if (!absl::GetFlag(FLAGS_input_side_packets).empty()) {
+    std::vector<std::string> kv_pairs =
+        absl::StrSplit(absl::GetFlag(FLAGS_input_side_packets), ',');
+    for (const std::string& kv_pair : kv_pairs) {
+      std::vector<std::string> name_and_value = absl::StrSplit(kv_pair, '=');
+      RET_CHECK(name_and_value.size() == 2);
+      RET_CHECK(!mediapipe::ContainsKey(input_side_packets, name_and_value[0]));
+      input_side_packets[name_and_value[0]] =
+          mediapipe::MakePacket<std::string>(name_and_value[1]);
+    }
+  }
+
+  const int num_packets = absl::GetFlag(FLAGS_num_packets);
+  const int warmup_packets = absl::GetFlag(FLAGS_warmup_packets);
+  std::map<std::string, std::string> sources;
+  if (!absl::GetFlag(FLAGS_input_streams).empty()) {
+    std::vector<std::string> kv_pairs =
+        absl::StrSplit(absl::GetFlag(FLAGS_input_streams), ',');
+    for (const std::string& kv_pair : kv_pairs) {
+      std::vector<std::string> name_and_source =
+          absl::StrSplit(kv_pair, absl::MaxSplits('=', 1));
+      RET_CHECK(name_and_source.size() == 2);
+      sources[name_and_source[0]] = name_and_source[1];
+    }
+  }
+  // Uploads the GPU inputs inside the graph, like the GPU demos do before
+  // sending frames.
+  if (!absl::GetFlag(FLAGS_gpu_input_streams).empty()) {
+    for (absl::string_view name :
+         absl::StrSplit(absl::GetFlag(FLAGS_gpu_input_streams), ',')) {
+      auto it = std::find(config.input_stream().begin(),
+                          config.input_stream().end(), name);
+      RET_CHECK(it != config.input_stream().end())
+          << "Not a graph input stream: " << name;
+      RET_CHECK(mediapipe::ContainsKey(sources, std::string(name)))
+          << "Missing --input_streams source for graph input stream: "
+          << name;
+      const std::string cpu_name = absl::StrCat(name, "_cpu");
+      *config.mutable_input_stream(it - config.input_stream().begin()) =
+          cpu_name;
+      mediapipe::CalculatorGraphConfig::Node* node = config.add_node();
+      node->set_calculator("ImageFrameToGpuBufferCalculator");
+      node->add_input_stream(cpu_name);
+      node->add_output_stream(std::string(name));
+      sources[cpu_name] = sources[std::string(name)];
+    }
+  }
+  std::vector<InputSource> inputs;
+  for (const std::string& input_stream : config.input_stream()) {
+    std::string name = input_stream.substr(input_stream.rfind(':') + 1);
+    RET_CHECK(mediapipe::ContainsKey(sources, name))
+        << "Missing --input_streams source for graph input stream: " << name;
+    ASSIGN_OR_RETURN(auto packets, MakeSourcePackets(sources[name],
+                                                     num_packets +
+                                                         warmup_packets));
+    inputs.push_back({name, std::move(packets)});
+  }
+
+  std::vector<std::string> output_streams;
+  if (!absl::GetFlag(FLAGS_output_streams).empty()) {
+    output_streams = absl::StrSplit(absl::GetFlag(FLAGS_output_streams), ',');
+  } else {
+    for (const std::string& output_stream : config.output_stream()) {
+      output_streams.push_back(
+          output_stream.substr(output_stream.rfind(':') + 1));
+    }
+  }
+  RET_CHECK(!output_streams.empty())
+      << "The graph has no output streams, specify --output_streams.";
+
+  LOG(INFO) << "Initialize the calculator graph.";
+  const absl::Time init_time = absl::Now();
+  mediapipe::CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(config, input_side_packets));
+  LatencyTracker tracker(output_streams.size());
+  for (int i = 0; i < output_streams.size(); ++i) {
+    MP_RETURN_IF_ERROR(graph.ObserveOutputStream(
+        output_streams[i],
+        [&tracker, i](const mediapipe::Packet& packet) {
+          tracker.Settled(i, packet.Timestamp());
+          return absl::OkStatus();
+        },
+        /*observe_timestamp_bounds=*/true));
+  }
+
+  LOG(INFO) << "Start running the calculator graph.";
+  MP_RETURN_IF_ERROR(graph.StartRun({}));
+  const double target_fps = absl::GetFlag(FLAGS_target_fps);
+  const int max_in_flight = absl::GetFlag(FLAGS_max_in_flight);
+  // Calculators such as FlowLimiterCalculator expect realistic timestamps.
+  const absl::Duration interval =
+      absl::Seconds(1) / (target_fps > 0 ? target_fps : 30);
+  const absl::Time start_time = absl::Now();
+  for (int i = 0; i < warmup_packets + num_packets; ++i) {
+    if (target_fps > 0) {
+      absl::SleepFor(start_time + i * interval - absl::Now());
+    }
+    if (max_in_flight > 0) {
+      tracker.WaitForInFlight(max_in_flight);
+    }
+    const mediapipe::Timestamp timestamp(
+        absl::ToInt64Microseconds(i * interval));
+    tracker.Sent(timestamp, /*measured=*/i >= warmup_packets);
+    for (const InputSource& input : inputs) {
+      MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+          input.stream_name,
+          input.packets[i % input.packets.size()].At(timestamp)));
+    }
+  }
+  MP_RETURN_IF_ERROR(graph.CloseAllInputStreams());
+  MP_RETURN_IF_ERROR(graph.WaitUntilDone());
+
+  std::vector<mediapipe::CalculatorProfile> profiles;
+  MP_RETURN_IF_ERROR(graph.profiler()->GetCalculatorProfiles(&profiles));
+  const Summary summary = Summarize(tracker, init_time);
+  PrintReport(summary, profiles);
+  if (!absl::GetFlag(FLAGS_output_json).empty()) {
+    std::string name = absl::GetFlag(FLAGS_benchmark_name);
+    if (name.empty()) {
+      name = absl::GetFlag(FLAGS_calculator_graph_config_file);
+    }
+    MP_RETURN_IF_ERROR(
+        WriteJson(absl::GetFlag(FLAGS_output_json), name, summary));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status run_status = RunMPPGraph();
+  if (!run_status.ok()) {
+    LOG(ERROR) << "Failed to run the graph: " << run_status.message();
+    return EXIT_FAILURE;
+  } else {
+    LOG(INFO) << "Success!";
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,257 @@
+# Copyright 2023 The MediaPipe Authors.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+r"""Tracks the performance of the MediaPipe reference graphs.
+
+Each reference graph in mediapipe/graphs is run on CPU and GPU through
+graph_benchmark_main with the same recorded video. The latency percentiles,
+throughput, startup time and peak memory of each run are collected into a
+single JSON file and compared against the checked in baseline.json. The suite
+exits with a non-zero status if any metric regressed by more than its
+tolerance.
+
+Run from the workspace root after building the suite:
+
+  bazel-bin/mediapipe/examples/desktop/perf_regression/perf_regression_suite \
+    --output=/tmp/perf_regression.json
+
+To record a new baseline on the reference machine, pass --update_baseline
+together with a --baseline path in the source tree.
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+from absl import app
+from absl import flags
+from absl import logging
+
+FLAGS = flags.FLAGS
+
+SCHEMA_VERSION = 1
+
+_PACKAGE = "mediapipe/examples/desktop/perf_regression"
+_GRAPHS = "mediapipe/graphs"
+_INPUT_STREAM = "input_video"
+
+# (graph name, device, graph config relative to mediapipe/graphs).
+CASES = (
+    ("face_detection", "cpu",
+     "face_detection/face_detection_desktop_live.pbtxt"),
+    ("face_detection", "gpu", "face_detection/face_detection_mobile_gpu.pbtxt"),
+    ("face_mesh", "cpu", "face_mesh/face_mesh_desktop_live.pbtxt"),
+    ("face_mesh", "gpu", "face_mesh/face_mesh_desktop_live_gpu.pbtxt"),
+    ("hand_tracking", "cpu", "hand_tracking/hand_tracking_desktop_live.pbtxt"),
+    ("hand_tracking", "gpu",
+     "hand_tracking/hand_tracking_desktop_live_gpu.pbtxt"),
+    ("holistic_tracking", "cpu",
+     "holistic_tracking/holistic_tracking_cpu.pbtxt"),
+    ("holistic_tracking", "gpu",
+     "holistic_tracking/holistic_tracking_gpu.pbtxt"),
+    ("object_detection", "cpu",
+     "object_detection/object_detection_desktop_live.pbtxt"),
+    ("object_detection", "gpu",
+     "object_detection/object_detection_mobile_gpu.pbtxt"),
+    ("pose_tracking", "cpu", "pose_tracking/pose_tracking_cpu.pbtxt"),
+    ("pose_tracking", "gpu", "pose_tracking/pose_tracking_gpu.pbtxt"),
+    ("selfie_segmentation", "cpu",
+     "selfie_segmentation/selfie_segmentation_cpu.pbtxt"),
+    ("selfie_segmentation", "gpu",
+     "selfie_segmentation/selfie_segmentation_gpu.pbtxt"),
+)
+
+# (metric name, path in the graph_benchmark_main JSON, higher is better).
+METRICS = (
+    ("latency_p50_ms", ("latency_ms", "p50"), False),
+    ("latency_p90_ms", ("latency_ms", "p90"), False),
+    ("latency_p99_ms", ("latency_ms", "p99"), False),
+    ("throughput_fps", ("throughput_fps",), True),
+    ("startup_ms", ("startup_ms",), False),
+    ("peak_rss_mb", ("peak_rss_mb",), False),
+)
+
+# Relative tolerance used for metrics missing from the baseline tolerances.
+DEFAULT_TOLERANCE = 0.1
+
+
+def case_name(graph, device):
+  return "%s/%s" % (graph, device)
+
+
+def flatten_metrics(benchmark_json):
+  """Extracts METRICS from the JSON written by graph_benchmark_main."""
+  if benchmark_json.get("schema_version") != SCHEMA_VERSION:
+    raise ValueError("Unsupported benchmark schema version: %s" %
+                     benchmark_json.get("schema_version"))
+  metrics = {}
+  for name, path, _ in METRICS:
+    value = benchmark_json
+    for key in path:
+      value = value[key]
+    metrics[name] = float(value)
+  return metrics
+
+
+def _tolerance(tolerances, metric):
+  # Latency percentiles share a single "latency_ms" tolerance.
+  if metric in tolerances:
+    return tolerances[metric]
+  if metric.startswith("latency_"):
+    return tolerances.get("latency_ms", DEFAULT_TOLERANCE)
+  return DEFAULT_TOLERANCE
+
+
+def compare(results, baseline):
+  """Compares results against baseline.
+
+  Args:
+    results: dict from case name to the metrics returned by flatten_metrics.
+    baseline: the parsed baseline.json.
+
+  Returns:
+    A (regressions, unbaselined) tuple. regressions is a list of
+    (case, metric, baseline value, new value) for every metric that is worse
+    than the baseline by more than its tolerance. unbaselined lists the cases
+    that have no baseline yet.
+  """
+  if baseline.get("schema_version") != SCHEMA_VERSION:
+    raise ValueError("Unsupported baseline schema version: %s" %
+                     baseline.get("schema_version"))
+  tolerances = baseline.get("tolerances", {})
+  baseline_results = baseline.get("results", {})
+  regressions = []
+  unbaselined = []
+  for case in sorted(results):
+    base = baseline_results.get(case)
+    if base is None:
+      unbaselined.append(case)
+      continue
+    for metric, _, higher_is_better in METRICS:
+      if metric not in base or metric not in results[case]:
+        continue
+      value = results[case][metric]
+      base_value = base[metric]
+      tolerance = _tolerance(tolerances, metric)
+      if higher_is_better:
+        regressed = value < base_value * (1.0 - tolerance)
+      else:
+        regressed = value > base_value * (1.0 + tolerance)
+      if regressed:
+        regressions.append((case, metric, base_value, value))
+  return regressions, unbaselined
+
+
+def _run_case(graph, device, graph_config):
+  """Runs one reference graph and returns its flattened metrics."""
+  binary = FLAGS.cpu_benchmark if device == "cpu" else FLAGS.gpu_benchmark
+  with tempfile.TemporaryDirectory() as tmp_dir:
+    output_json = os.path.join(tmp_dir, "benchmark.json")
+    cmd = [
+        binary,
+        "--calculator_graph_config_file=%s" %
+        os.path.join(_GRAPHS, graph_config),
+        "--input_streams=%s=video:%s" % (_INPUT_STREAM, FLAGS.input_video),
+        "--num_packets=%d" % FLAGS.num_packets,
+        "--warmup_packets=%d" % FLAGS.warmup_packets,
+        "--benchmark_name=%s" % case_name(graph, device),
+        "--output_json=%s" % output_json,
+    ]
+    if device == "gpu":
+      cmd.append("--gpu_input_streams=%s" % _INPUT_STREAM)
+    logging.info("Running %s", " ".join(cmd))
+    subprocess.check_call(cmd)
+    with open(output_json) as f:
+      return flatten_metrics(json.load(f))
+
+
+def _print_results(results, baseline_results):
+  print("%-28s %-16s %12s %12s" % ("case", "metric", "baseline", "current"))
+  for case in sorted(results):
+    for metric, _, _ in METRICS:
+      base = baseline_results.get(case, {}).get(metric)
+      print("%-28s %-16s %12s %12.2f" %
+            (case, metric, "-" if base is None else "%.2f" % base,
+             results[case][metric]))
+
+
+def main(argv):
+  if len(argv) > 1:
+    raise app.UsageError("Too many command-line arguments.")
+  devices = FLAGS.devices.split(",")
+  graphs = FLAGS.graphs.split(",") if FLAGS.graphs else None
+
+  results = {}
+  for graph, device, graph_config in CASES:
+    if device not in devices or (graphs and graph not in graphs):
+      continue
+    results[case_name(graph, device)] = _run_case(graph, device, graph_config)
+
+  if FLAGS.output:
+    with open(FLAGS.output, "w") as f:
+      json.dump({"schema_version": SCHEMA_VERSION, "results": results},
+                f, indent=2, sort_keys=True)
+
+  with open(FLAGS.baseline) as f:
+    baseline = json.load(f)
+  _print_results(results, baseline.get("results", {}))
+
+  if FLAGS.update_baseline:
+    baseline.setdefault("results", {}).update(results)
+    with open(FLAGS.baseline, "w") as f:
+      json.dump(baseline, f, indent=2, sort_keys=True)
+      f.write("\n")
+    print("Updated %d cases in %s" % (len(results), FLAGS.baseline))
+    return
+
+  regressions, unbaselined = compare(results, baseline)
+  for case in unbaselined:
+    print("No baseline for %s, skipping comparison." % case)
+  for case, metric, base_value, value in regressions:
+    print("REGRESSION %s %s: %.2f -> %.2f" % (case, metric, base_value, value))
+  if regressions:
+    sys.exit(1)
+
+
+if __name__ == "__main__":
+  flags.DEFINE_string("devices", "cpu,gpu",
+                      "Comma-separated devices to benchmark (cpu, gpu).")
+  flags.DEFINE_string("graphs", "",
+                      "Comma-separated graph names to benchmark. All if empty.")
+  flags.DEFINE_string("cpu_benchmark",
+                      "bazel-bin/%s/perf_regression_benchmark_cpu" % _PACKAGE,
+                      "Path to the CPU benchmark binary.")
+  flags.DEFINE_string("gpu_benchmark",
+                      "bazel-bin/%s/perf_regression_benchmark_gpu" % _PACKAGE,
+                      "Path to the GPU benchmark binary.")
+  flags.DEFINE_string(
+      "input_video", "mediapipe/examples/desktop/object_detection/"
+      "test_video.mp4", "Recorded video fed to every graph.")
+  flags.DEFINE_integer("num_packets", 300,
+                       "Number of timestamps to measure per graph.")
+  flags.DEFINE_integer("warmup_packets", 30,
+                       "Number of timestamps to run before measuring.")
+  flags.DEFINE_string("baseline", "%s/baseline.json" % _PACKAGE,
+                      "Baseline to compare against.")
+  flags.DEFINE_string("output", "", "If set, results are written here as JSON.")
+  flags.DEFINE_boolean("update_baseline", False,
+                       "Merge the results into --baseline instead of "
+                       "comparing against it.")
+  app.run(main)
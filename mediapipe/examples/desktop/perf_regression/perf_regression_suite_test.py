@@ -0,0 +1,120 @@
+# Copyright 2023 The MediaPipe Authors.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Tests for perf_regression_suite."""
+
+from absl.testing import absltest
+
+from mediapipe.examples.desktop.perf_regression import perf_regression_suite
+
+_BENCHMARK_JSON = {
+    "schema_version": 1,
+    "name": "face_detection/cpu",
+    "completed_timestamps": 300,
+    "throughput_fps": 100.0,
+    "latency_ms": {"p50": 10.0, "p90": 12.0, "p99": 20.0},
+    "startup_ms": 500.0,
+    "peak_rss_mb": 200.0,
+}
+
+
+def _baseline(results):
+  return {
+      "schema_version": 1,
+      "tolerances": {"latency_ms": 0.15, "throughput_fps": 0.1},
+      "results": results,
+  }
+
+
+class PerfRegressionSuiteTest(absltest.TestCase):
+
+  def test_flatten_metrics(self):
+    metrics = perf_regression_suite.flatten_metrics(_BENCHMARK_JSON)
+    self.assertEqual(
+        metrics, {
+            "latency_p50_ms": 10.0,
+            "latency_p90_ms": 12.0,
+            "latency_p99_ms": 20.0,
+            "throughput_fps": 100.0,
+            "startup_ms": 500.0,
+            "peak_rss_mb": 200.0,
+        })
+
+  def test_flatten_metrics_rejects_unknown_schema(self):
+    with self.assertRaisesRegex(ValueError, "schema version"):
+      perf_regression_suite.flatten_metrics(
+          dict(_BENCHMARK_JSON, schema_version=2))
+
+  def test_compare_within_tolerance(self):
+    base = perf_regression_suite.flatten_metrics(_BENCHMARK_JSON)
+    current = dict(base, latency_p50_ms=11.0, throughput_fps=95.0)
+    regressions, unbaselined = perf_regression_suite.compare(
+        {"face_detection/cpu": current},
+        _baseline({"face_detection/cpu": base}))
+    self.assertEmpty(regressions)
+    self.assertEmpty(unbaselined)
+
+  def test_compare_reports_slower_latency(self):
+    base = perf_regression_suite.flatten_metrics(_BENCHMARK_JSON)
+    current = dict(base, latency_p99_ms=24.0)
+    regressions, _ = perf_regression_suite.compare(
+        {"face_detection/cpu": current},
+        _baseline({"face_detection/cpu": base}))
+    self.assertEqual(regressions,
+                     [("face_detection/cpu", "latency_p99_ms", 20.0, 24.0)])
+
+  def test_compare_reports_lower_throughput(self):
+    base = perf_regression_suite.flatten_metrics(_BENCHMARK_JSON)
+    current = dict(base, throughput_fps=80.0)
+    regressions, _ = perf_regression_suite.compare(
+        {"face_detection/cpu": current},
+        _baseline({"face_detection/cpu": base}))
+    self.assertEqual(regressions,
+                     [("face_detection/cpu", "throughput_fps", 100.0, 80.0)])
+
+  def test_compare_ignores_improvements(self):
+    base = perf_regression_suite.flatten_metrics(_BENCHMARK_JSON)
+    current = dict(
+        base, latency_p50_ms=5.0, throughput_fps=200.0, peak_rss_mb=100.0)
+    regressions, _ = perf_regression_suite.compare(
+        {"face_detection/cpu": current},
+        _baseline({"face_detection/cpu": base}))
+    self.assertEmpty(regressions)
+
+  def test_compare_uses_default_tolerance(self):
+    base = perf_regression_suite.flatten_metrics(_BENCHMARK_JSON)
+    current = dict(base, peak_rss_mb=230.0)
+    regressions, _ = perf_regression_suite.compare(
+        {"face_detection/cpu": current},
+        _baseline({"face_detection/cpu": base}))
+    self.assertEqual(regressions,
+                     [("face_detection/cpu", "peak_rss_mb", 200.0, 230.0)])
+
+  def test_compare_reports_unbaselined_cases(self):
+    metrics = perf_regression_suite.flatten_metrics(_BENCHMARK_JSON)
+    regressions, unbaselined = perf_regression_suite.compare(
+        {"face_mesh/gpu": metrics}, _baseline({}))
+    self.assertEmpty(regressions)
+    self.assertEqual(unbaselined, ["face_mesh/gpu"])
+
+  def test_cases_cover_cpu_and_gpu(self):
+    graphs = {}
+    for graph, device, _ in perf_regression_suite.CASES:
+      graphs.setdefault(graph, set()).add(device)
+    for graph, devices in graphs.items():
+      self.assertEqual(devices, {"cpu", "gpu"}, graph)
+
+
+if __name__ == "__main__":
+  absltest.main()
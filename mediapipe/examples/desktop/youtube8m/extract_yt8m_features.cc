@@ -15,11 +15,24 @@
 // A simple main function to run a MediaPipe graph. Input side packets are read
 // from files provided via the command line and output side packets are written
 // to disk.
+//
+// With --video_list_file, many videos are processed in one invocation. Each of
+// --num_parallel_videos workers initializes its own graph once, which loads the
+// models, and then runs it once per video it takes from the list. The PCA
+// matrices are loaded once and shared by all workers.
+#include <algorithm>
 #include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/flags/parse.h"
 #include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/port/file_helpers.h"
@@ -38,69 +51,183 @@ ABSL_FLAG(std::string, output_side_packets, "",
           "Comma-separated list of key=value pairs specifying the output "
           "side packets and paths to write to disk for the "
           "CalculatorGraph.");
+ABSL_FLAG(std::string, video_list_file, "",
+          "If set, name of a file listing one video per line as "
+          "\"<input_sequence_example_path> <output_sequence_example_path>\". "
+          "Each video is run through the graph and --output_side_packets is "
+          "ignored.");
+ABSL_FLAG(int, num_parallel_videos, 1,
+          "Number of videos from --video_list_file processed concurrently, "
+          "each by its own graph.");
 
-absl::Status RunMPPGraph() {
-  std::string calculator_graph_config_contents;
-  MP_RETURN_IF_ERROR(mediapipe::file::GetContents(
-      absl::GetFlag(FLAGS_calculator_graph_config_file),
-      &calculator_graph_config_contents));
-  LOG(INFO) << "Get calculator graph config contents: "
-            << calculator_graph_config_contents;
-  mediapipe::CalculatorGraphConfig config =
-      mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(
-          calculator_graph_config_contents);
-  std::map<std::string, mediapipe::Packet> input_side_packets;
+namespace {
+
+constexpr char kInputSequenceExample[] = "input_sequence_example";
+constexpr char kOutputSequenceExample[] = "output_sequence_example";
+
+absl::Status AddMatrixSidePacket(
+    const std::string& path, const std::string& name,
+    std::map<std::string, mediapipe::Packet>* side_packets) {
+  std::string content;
+  MP_RETURN_IF_ERROR(mediapipe::file::GetContents(path, &content));
+  mediapipe::MatrixData matrix_data;
+  RET_CHECK(matrix_data.ParseFromString(content))
+      << "Failed to parse " << path;
+  mediapipe::Matrix matrix;
+  mediapipe::MatrixFromMatrixDataProto(matrix_data, &matrix);
+  (*side_packets)[name] =
+      mediapipe::MakePacket<mediapipe::Matrix>(std::move(matrix));
+  return absl::OkStatus();
+}
+
+absl::Status LoadSharedSidePackets(
+    std::map<std::string, mediapipe::Packet>* side_packets) {
   std::vector<std::string> kv_pairs =
-      absl::StrSplit(absl::GetFlag(FLAGS_input_side_packets), ',');
+      absl::StrSplit(absl::GetFlag(FLAGS_input_side_packets), ',',
+                     absl::SkipEmpty());
   for (const std::string& kv_pair : kv_pairs) {
     std::vector<std::string> name_and_value = absl::StrSplit(kv_pair, '=');
     RET_CHECK(name_and_value.size() == 2);
-    RET_CHECK(!mediapipe::ContainsKey(input_side_packets, name_and_value[0]));
+    RET_CHECK(!mediapipe::ContainsKey(*side_packets, name_and_value[0]));
     std::string input_side_packet_contents;
     MP_RETURN_IF_ERROR(mediapipe::file::GetContents(
         name_and_value[1], &input_side_packet_contents));
-    input_side_packets[name_and_value[0]] =
+    (*side_packets)[name_and_value[0]] =
         mediapipe::MakePacket<std::string>(input_side_packet_contents);
   }
 
-  mediapipe::MatrixData inc3_pca_mean_matrix_data,
-      inc3_pca_projection_matrix_data, vggish_pca_mean_matrix_data,
-      vggish_pca_projection_matrix_data;
-  mediapipe::Matrix inc3_pca_mean_matrix, inc3_pca_projection_matrix,
-      vggish_pca_mean_matrix, vggish_pca_projection_matrix;
+  MP_RETURN_IF_ERROR(AddMatrixSidePacket(
+      "/tmp/mediapipe/inception3_mean_matrix_data.pb",
+      "inception3_pca_mean_matrix", side_packets));
+  MP_RETURN_IF_ERROR(AddMatrixSidePacket(
+      "/tmp/mediapipe/inception3_projection_matrix_data.pb",
+      "inception3_pca_projection_matrix", side_packets));
+  MP_RETURN_IF_ERROR(
+      AddMatrixSidePacket("/tmp/mediapipe/vggish_mean_matrix_data.pb",
+                          "vggish_pca_mean_matrix", side_packets));
+  MP_RETURN_IF_ERROR(
+      AddMatrixSidePacket("/tmp/mediapipe/vggish_projection_matrix_data.pb",
+                          "vggish_pca_projection_matrix", side_packets));
+  return absl::OkStatus();
+}
 
-  std::string content;
-  MP_RETURN_IF_ERROR(mediapipe::file::GetContents(
-      "/tmp/mediapipe/inception3_mean_matrix_data.pb", &content));
-  inc3_pca_mean_matrix_data.ParseFromString(content);
-  mediapipe::MatrixFromMatrixDataProto(inc3_pca_mean_matrix_data,
-                                       &inc3_pca_mean_matrix);
-  input_side_packets["inception3_pca_mean_matrix"] =
-      mediapipe::MakePacket<mediapipe::Matrix>(inc3_pca_mean_matrix);
+// Hands out the videos of --video_list_file to the worker threads.
+class VideoQueue {
+ public:
+  struct Video {
+    std::string input_path;
+    std::string output_path;
+  };
 
-  MP_RETURN_IF_ERROR(mediapipe::file::GetContents(
-      "/tmp/mediapipe/inception3_projection_matrix_data.pb", &content));
-  inc3_pca_projection_matrix_data.ParseFromString(content);
-  mediapipe::MatrixFromMatrixDataProto(inc3_pca_projection_matrix_data,
-                                       &inc3_pca_projection_matrix);
-  input_side_packets["inception3_pca_projection_matrix"] =
-      mediapipe::MakePacket<mediapipe::Matrix>(inc3_pca_projection_matrix);
+  explicit VideoQueue(std::vector<Video> videos)
+      : videos_(std::move(videos)) {}
+
+  // Returns false once all videos have been handed out.
+  bool Next(Video* video) {
+    absl::MutexLock lock(&mutex_);
+    if (next_ >= videos_.size()) return false;
+    *video = videos_[next_++];
+    return true;
+  }
+
+  void RecordFailure(const Video& video, const absl::Status& status) {
+    LOG(ERROR) << "Failed to extract features from " << video.input_path
+               << ": " << status.message();
+    absl::MutexLock lock(&mutex_);
+    ++num_failures_;
+  }
 
+  int num_failures() {
+    absl::MutexLock lock(&mutex_);
+    return num_failures_;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  const std::vector<Video> videos_;
+  size_t next_ ABSL_GUARDED_BY(mutex_) = 0;
+  int num_failures_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+absl::Status RunVideo(const VideoQueue::Video& video,
+                      mediapipe::CalculatorGraph* graph) {
+  std::string input_sequence_example;
+  MP_RETURN_IF_ERROR(
+      mediapipe::file::GetContents(video.input_path, &input_sequence_example));
+  MP_RETURN_IF_ERROR(graph->StartRun(
+      {{kInputSequenceExample,
+        mediapipe::MakePacket<std::string>(input_sequence_example)}}));
+  MP_RETURN_IF_ERROR(graph->WaitUntilDone());
+  absl::StatusOr<mediapipe::Packet> output_packet =
+      graph->GetOutputSidePacket(kOutputSequenceExample);
+  RET_CHECK(output_packet.ok())
+      << "Packet " << kOutputSequenceExample << " was not available.";
+  return mediapipe::file::SetContents(video.output_path,
+                                      output_packet.value().Get<std::string>());
+}
+
+absl::Status RunVideoList(
+    const mediapipe::CalculatorGraphConfig& config,
+    const std::map<std::string, mediapipe::Packet>& side_packets) {
+  std::string video_list;
   MP_RETURN_IF_ERROR(mediapipe::file::GetContents(
-      "/tmp/mediapipe/vggish_mean_matrix_data.pb", &content));
-  vggish_pca_mean_matrix_data.ParseFromString(content);
-  mediapipe::MatrixFromMatrixDataProto(vggish_pca_mean_matrix_data,
-                                       &vggish_pca_mean_matrix);
-  input_side_packets["vggish_pca_mean_matrix"] =
-      mediapipe::MakePacket<mediapipe::Matrix>(vggish_pca_mean_matrix);
+      absl::GetFlag(FLAGS_video_list_file), &video_list));
+  std::vector<VideoQueue::Video> videos;
+  for (absl::string_view line :
+       absl::StrSplit(video_list, '\n', absl::SkipWhitespace())) {
+    std::vector<std::string> paths =
+        absl::StrSplit(line, ' ', absl::SkipEmpty());
+    RET_CHECK_EQ(paths.size(), 2) << "Malformed video list line: " << line;
+    videos.push_back({paths[0], paths[1]});
+  }
+  const int num_workers = std::min<int>(
+      std::max(absl::GetFlag(FLAGS_num_parallel_videos), 1), videos.size());
+  LOG(INFO) << "Extracting features from " << videos.size() << " videos with "
+            << num_workers << " parallel graphs.";
+
+  // Initializing a graph loads the TensorFlow sessions, so every worker does it
+  // once and then reuses its graph for all the videos it processes.
+  std::vector<std::unique_ptr<mediapipe::CalculatorGraph>> graphs;
+  for (int i = 0; i < num_workers; ++i) {
+    graphs.push_back(std::make_unique<mediapipe::CalculatorGraph>());
+    MP_RETURN_IF_ERROR(graphs.back()->Initialize(config, side_packets));
+  }
+
+  VideoQueue queue(std::move(videos));
+  std::vector<std::thread> workers;
+  for (int i = 0; i < num_workers; ++i) {
+    workers.emplace_back([&queue, graph = graphs[i].get()]() {
+      VideoQueue::Video video;
+      while (queue.Next(&video)) {
+        absl::Status status = RunVideo(video, graph);
+        if (!status.ok()) queue.RecordFailure(video, status);
+      }
+    });
+  }
+  for (std::thread& worker : workers) worker.join();
+  RET_CHECK_EQ(queue.num_failures(), 0)
+      << queue.num_failures() << " videos failed.";
+  return absl::OkStatus();
+}
+
+}  // namespace
 
+absl::Status RunMPPGraph() {
+  std::string calculator_graph_config_contents;
   MP_RETURN_IF_ERROR(mediapipe::file::GetContents(
-      "/tmp/mediapipe/vggish_projection_matrix_data.pb", &content));
-  vggish_pca_projection_matrix_data.ParseFromString(content);
-  mediapipe::MatrixFromMatrixDataProto(vggish_pca_projection_matrix_data,
-                                       &vggish_pca_projection_matrix);
-  input_side_packets["vggish_pca_projection_matrix"] =
-      mediapipe::MakePacket<mediapipe::Matrix>(vggish_pca_projection_matrix);
+      absl::GetFlag(FLAGS_calculator_graph_config_file),
+      &calculator_graph_config_contents));
+  LOG(INFO) << "Get calculator graph config contents: "
+            << calculator_graph_config_contents;
+  mediapipe::CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(
+          calculator_graph_config_contents);
+  std::map<std::string, mediapipe::Packet> input_side_packets;
+  MP_RETURN_IF_ERROR(LoadSharedSidePackets(&input_side_packets));
+
+  if (!absl::GetFlag(FLAGS_video_list_file).empty()) {
+    return RunVideoList(config, input_side_packets);
+  }
 
   LOG(INFO) << "Initialize the calculator graph.";
   mediapipe::CalculatorGraph graph;
@@ -108,7 +235,8 @@ absl::Status RunMPPGraph() {
   LOG(INFO) << "Start running the calculator graph.";
   MP_RETURN_IF_ERROR(graph.Run());
   LOG(INFO) << "Gathering output side packets.";
-  kv_pairs = absl::StrSplit(absl::GetFlag(FLAGS_output_side_packets), ',');
+  std::vector<std::string> kv_pairs =
+      absl::StrSplit(absl::GetFlag(FLAGS_output_side_packets), ',');
   for (const std::string& kv_pair : kv_pairs) {
     std::vector<std::string> name_and_value = absl::StrSplit(kv_pair, '=');
     RET_CHECK(name_and_value.size() == 2);
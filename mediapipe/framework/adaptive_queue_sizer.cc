@@ -0,0 +1,147 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/adaptive_queue_sizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace mediapipe {
+namespace internal {
+
+namespace {
+
+// The queue limit used when the graph disables throttling.
+constexpr int kDefaultQueueSize = 100;
+
+// Rates are only measured over intervals of at least this length, so that
+// reports that follow each other closely do not produce noisy rates.
+constexpr absl::Duration kMinRateInterval = absl::Milliseconds(1);
+
+// The weight of a new rate measurement in the smoothed rate.
+constexpr double kRateSmoothing = 0.5;
+
+double SmoothRate(double rate, double measured_rate) {
+  return rate < 0 ? measured_rate
+                  : rate + kRateSmoothing * (measured_rate - rate);
+}
+
+}  // namespace
+
+AdaptiveQueueSizer::AdaptiveQueueSizer(const AdaptiveQueueConfig& config,
+                                       std::vector<std::string> stream_names,
+                                       int initial_queue_size)
+    : config_(config),
+      initial_queue_size_([&] {
+        const int min_size = std::max(1, config.min_queue_size());
+        int64 size = initial_queue_size > 0 ? initial_queue_size
+                                            : kDefaultQueueSize;
+        if (config.max_queue_size() > 0) {
+          size = std::min<int64>(size, config.max_queue_size());
+        }
+        if (config.max_total_queue_size() > 0 && !stream_names.empty()) {
+          size = std::min<int64>(
+              size, config.max_total_queue_size() / stream_names.size());
+        }
+        return static_cast<int>(std::max<int64>(size, min_size));
+      }()) {
+  queues_.resize(stream_names.size());
+  for (int i = 0; i < queues_.size(); ++i) {
+    queues_[i].name = std::move(stream_names[i]);
+  }
+  Reset();
+}
+
+void AdaptiveQueueSizer::Reset() {
+  absl::MutexLock lock(&mutex_);
+  for (QueueState& queue : queues_) {
+    std::string name = std::move(queue.name);
+    queue = QueueState();
+    queue.name = std::move(name);
+    queue.max_queue_size = initial_queue_size_;
+  }
+  total_queue_size_ = static_cast<int64>(initial_queue_size_) * queues_.size();
+}
+
+int AdaptiveQueueSizer::RateBound(const QueueState& queue) const {
+  if (config_.max_queue_delay_usec() <= 0 || queue.drain_rate < 0) {
+    return std::numeric_limits<int>::max();
+  }
+  const double bound = std::ceil(queue.drain_rate *
+                                 config_.max_queue_delay_usec() / 1000000.0);
+  return bound >= std::numeric_limits<int>::max()
+             ? std::numeric_limits<int>::max()
+             : static_cast<int>(bound);
+}
+
+int AdaptiveQueueSizer::UpdateQueueSize(int id, bool is_full,
+                                        int max_queue_size, int64 num_added,
+                                        int queue_size, absl::Time now) {
+  absl::MutexLock lock(&mutex_);
+  QueueState& queue = queues_[id];
+  // The limit may have been changed by the graph, e.g. to resolve a deadlock.
+  total_queue_size_ += max_queue_size - queue.max_queue_size;
+  queue.max_queue_size = max_queue_size;
+
+  const int64 num_removed = num_added - queue_size;
+  if (queue.time == absl::InfinitePast()) {
+    queue.num_added = num_added;
+    queue.num_removed = num_removed;
+    queue.time = now;
+  } else if (now - queue.time >= kMinRateInterval) {
+    const double seconds = absl::ToDoubleSeconds(now - queue.time);
+    queue.arrival_rate = SmoothRate(queue.arrival_rate,
+                                    (num_added - queue.num_added) / seconds);
+    queue.drain_rate = SmoothRate(queue.drain_rate,
+                                  (num_removed - queue.num_removed) / seconds);
+    queue.num_added = num_added;
+    queue.num_removed = num_removed;
+    queue.time = now;
+  }
+
+  int64 new_size = max_queue_size;
+  if (is_full) {
+    ++queue.num_throttle_events;
+    new_size *= 2;
+  }
+  new_size = std::min<int64>(new_size, RateBound(queue));
+  if (config_.max_queue_size() > 0) {
+    new_size = std::min<int64>(new_size, config_.max_queue_size());
+  }
+  if (config_.max_total_queue_size() > 0) {
+    new_size = std::min(new_size, config_.max_total_queue_size() -
+                                      (total_queue_size_ - max_queue_size));
+  }
+  new_size = std::max<int64>(new_size, std::max(1, config_.min_queue_size()));
+  total_queue_size_ += new_size - max_queue_size;
+  queue.max_queue_size = static_cast<int>(new_size);
+  return queue.max_queue_size;
+}
+
+void AdaptiveQueueSizer::GetProfiles(GraphProfile* profile) const {
+  absl::MutexLock lock(&mutex_);
+  for (const QueueState& queue : queues_) {
+    InputQueueProfile* queue_profile = profile->add_input_queue_profiles();
+    queue_profile->set_name(queue.name);
+    queue_profile->set_max_queue_size(queue.max_queue_size);
+    queue_profile->set_num_throttle_events(queue.num_throttle_events);
+    queue_profile->set_arrival_rate(std::max(queue.arrival_rate, 0.0));
+    queue_profile->set_drain_rate(std::max(queue.drain_rate, 0.0));
+  }
+}
+
+}  // namespace internal
+}  // namespace mediapipe
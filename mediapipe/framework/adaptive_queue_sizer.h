@@ -0,0 +1,90 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_ADAPTIVE_QUEUE_SIZER_H_
+#define MEDIAPIPE_FRAMEWORK_ADAPTIVE_QUEUE_SIZER_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+namespace internal {
+
+// Chooses the limits of the input stream queues of a graph, following an
+// AdaptiveQueueConfig. The graph reports each time a queue becomes full or
+// stops being full, and applies the limit returned for it. The arrival and
+// drain rates of a queue are measured between these reports, so the sizer
+// adds no work while packets flow without throttling.
+// This class is thread-safe.
+class AdaptiveQueueSizer {
+ public:
+  // "initial_queue_size" is the graph's max_queue_size, or -1 if throttling
+  // is disabled.
+  AdaptiveQueueSizer(const AdaptiveQueueConfig& config,
+                     std::vector<std::string> stream_names,
+                     int initial_queue_size);
+
+  // The limit of every queue at the start of a graph run.
+  int InitialQueueSize() const { return initial_queue_size_; }
+
+  // Forgets the limits and rates of the previous graph run.
+  void Reset() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Reports that the queue of stream "id" became full, or stopped being full
+  // if "is_full" is false. "max_queue_size" is its current limit,
+  // "num_added" the number of packets ever added to it, and "queue_size" the
+  // number of packets in it. Returns the new limit of the queue.
+  int UpdateQueueSize(int id, bool is_full, int max_queue_size,
+                      int64 num_added, int queue_size, absl::Time now)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Appends the state of every queue to "profile".
+  void GetProfiles(GraphProfile* profile) const ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct QueueState {
+    std::string name;
+    int max_queue_size = 0;
+    int64 num_throttle_events = 0;
+    // The counts at the previous report.
+    int64 num_added = 0;
+    int64 num_removed = 0;
+    absl::Time time = absl::InfinitePast();
+    // Smoothed rates in packets per second, or -1 if not yet measured.
+    double arrival_rate = -1;
+    double drain_rate = -1;
+  };
+
+  // Returns the largest limit allowed by the drain rate of "queue".
+  int RateBound(const QueueState& queue) const;
+
+  const AdaptiveQueueConfig config_;
+  const int initial_queue_size_;
+  mutable absl::Mutex mutex_;
+  std::vector<QueueState> queues_ ABSL_GUARDED_BY(mutex_);
+  // The sum of the limits of all queues.
+  int64 total_queue_size_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace internal
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_ADAPTIVE_QUEUE_SIZER_H_
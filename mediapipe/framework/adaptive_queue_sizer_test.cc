@@ -0,0 +1,85 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/adaptive_queue_sizer.h"
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+
+namespace mediapipe {
+namespace internal {
+namespace {
+
+const absl::Time kStart = absl::FromUnixSeconds(1000);
+
+TEST(AdaptiveQueueSizerTest, ClampsInitialQueueSize) {
+  AdaptiveQueueSizer sizer(ParseTextProtoOrDie<AdaptiveQueueConfig>(
+                               "min_queue_size: 2 max_total_queue_size: 30"),
+                           {"a", "b", "c"}, 100);
+  EXPECT_EQ(sizer.InitialQueueSize(), 10);
+
+  AdaptiveQueueSizer unthrottled(
+      ParseTextProtoOrDie<AdaptiveQueueConfig>("max_queue_size: 8"), {"a"},
+      -1);
+  EXPECT_EQ(unthrottled.InitialQueueSize(), 8);
+}
+
+TEST(AdaptiveQueueSizerTest, GrowsFullQueuesWithinBounds) {
+  AdaptiveQueueSizer sizer(
+      ParseTextProtoOrDie<AdaptiveQueueConfig>(
+          "max_queue_size: 12 max_total_queue_size: 20"),
+      {"a", "b"}, 4);
+  EXPECT_EQ(sizer.UpdateQueueSize(0, true, 4, 4, 4, kStart), 8);
+  EXPECT_EQ(sizer.UpdateQueueSize(0, true, 8, 8, 8, kStart), 12);
+  // Stream "b" only gets what is left of the total.
+  EXPECT_EQ(sizer.UpdateQueueSize(1, true, 4, 4, 4, kStart), 8);
+  EXPECT_EQ(sizer.UpdateQueueSize(1, true, 8, 8, 8, kStart), 8);
+  // A queue that stops being full keeps its limit.
+  EXPECT_EQ(sizer.UpdateQueueSize(0, false, 12, 12, 11, kStart), 12);
+
+  GraphProfile profile;
+  sizer.GetProfiles(&profile);
+  ASSERT_EQ(profile.input_queue_profiles_size(), 2);
+  EXPECT_EQ(profile.input_queue_profiles(0).name(), "a");
+  EXPECT_EQ(profile.input_queue_profiles(0).max_queue_size(), 12);
+  EXPECT_EQ(profile.input_queue_profiles(0).num_throttle_events(), 2);
+  EXPECT_EQ(profile.input_queue_profiles(1).max_queue_size(), 8);
+
+  sizer.Reset();
+  EXPECT_EQ(sizer.UpdateQueueSize(1, true, 4, 4, 4, kStart), 8);
+}
+
+TEST(AdaptiveQueueSizerTest, ShrinksQueueWhenConsumerSlowsDown) {
+  AdaptiveQueueSizer sizer(ParseTextProtoOrDie<AdaptiveQueueConfig>(
+                               "max_queue_delay_usec: 100000"),
+                           {"a"}, 50);
+  // The consumer removes 100 packets per second, i.e. 10 per 100 ms.
+  EXPECT_EQ(sizer.UpdateQueueSize(0, true, 50, 50, 50, kStart), 100);
+  EXPECT_EQ(sizer.UpdateQueueSize(0, false, 100, 150, 49,
+                                  kStart + absl::Seconds(1)),
+            11);
+
+  GraphProfile profile;
+  sizer.GetProfiles(&profile);
+  ASSERT_EQ(profile.input_queue_profiles_size(), 1);
+  EXPECT_DOUBLE_EQ(profile.input_queue_profiles(0).arrival_rate(), 100);
+  EXPECT_DOUBLE_EQ(profile.input_queue_profiles(0).drain_rate(), 101);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace mediapipe
@@ -1,9 +1,24 @@
 #include "mediapipe/framework/api2/node.h"
 
+#include <utility>
+
+#include "absl/synchronization/notification.h"
+
 namespace mediapipe {
 namespace api2 {
 
 Node::~Node() {}
 
+absl::Status AsyncNode::Process(CalculatorContext* cc) {
+  absl::Notification done;
+  absl::Status result;
+  ProcessAsync(cc, [&done, &result](absl::Status status) {
+    result = std::move(status);
+    done.Notify();
+  });
+  done.WaitForNotification();
+  return result;
+}
+
 }  // namespace api2
 }  // namespace mediapipe
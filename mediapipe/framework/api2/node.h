@@ -24,6 +24,37 @@ class Node : public CalculatorBase {
   virtual ~Node();
 };
 
+// A node whose processing of an input set can complete after Process returns,
+// e.g. because it waits for a GPU fence, an accelerator or a remote call.
+// The framework calls ProcessAsync() instead of Process(), and the executor
+// thread is free to run other nodes until the node calls "done".
+//
+// Implementations usually derive from AsyncNodeImpl:
+//   class RemoteInferenceNodeImpl
+//       : public AsyncNodeImpl<RemoteInferenceNode, RemoteInferenceNodeImpl> {
+//    public:
+//     void ProcessAsync(CalculatorContext* cc, ProcessDone done) override {
+//       client_->Infer(*kIn(cc), [cc, done](Result result) {
+//         kOut(cc).Send(std::move(result));
+//         done(absl::OkStatus());
+//       });
+//     }
+//   };
+class AsyncNode : public Node {
+ public:
+  // Completes an invocation of ProcessAsync() with the status that Process()
+  // would have returned. Must be called exactly once per invocation.
+  using ProcessDone = std::function<void(absl::Status)>;
+
+  // See CalculatorBase::ProcessAsync.
+  void ProcessAsync(CalculatorContext* cc, ProcessDone done) override = 0;
+
+  // Calls ProcessAsync() and waits for its completion. The framework only
+  // calls this for inputs that ProcessAsync() does not handle, such as input
+  // sets that span several timestamps.
+  absl::Status Process(CalculatorContext* cc) final;
+};
+
 }  // namespace api2
 
 namespace internal {
@@ -39,6 +70,9 @@ class CalculatorBaseFactoryFor<
     if (status.ok()) {
       status = UpdateContract<T>(cc);
     }
+    if (std::is_base_of<mediapipe::api2::AsyncNode, T>{}) {
+      cc->SetProcessAsync(true);
+    }
     return status;
   }
 
@@ -123,11 +157,12 @@ NoDestructor<mediapipe::RegistrationToken>
 // For backward compatibility, Impl can be omitted; use
 // MEDIAPIPE_NODE_IMPLEMENTATION with this.
 // TODO: migrate and remove.
-template <class Impl = void>
+// Base is the node base class, i.e. Node or AsyncNode.
+template <class Impl = void, class Base = Node>
 class RegisteredNode;
 
-template <class Impl>
-class RegisteredNode : public Node {
+template <class Impl, class Base>
+class RegisteredNode : public Base {
  private:
   // The member below triggers instantiation of the registration static.
   // Note that the constructor of calculator subclasses is only invoked through
@@ -137,8 +172,8 @@ class RegisteredNode : public Node {
 };
 
 // No-op version for backwards compatibility.
-template <>
-class RegisteredNode<void> : public Node {};
+template <class Base>
+class RegisteredNode<void, Base> : public Base {};
 
 template <class Impl>
 struct FunctionNode : public RegisteredNode<Impl> {
@@ -147,8 +182,8 @@ struct FunctionNode : public RegisteredNode<Impl> {
   }
 };
 
-template <class Intf, class Impl = void>
-class NodeImpl : public RegisteredNode<Impl>, public Intf {
+template <class Intf, class Impl = void, class Base = Node>
+class NodeImpl : public RegisteredNode<Impl, Base>, public Intf {
  protected:
   // These methods allow accessing a node's ports by tag. This can be useful in
   // a few cases, e.g. if the port is not available as a named constant.
@@ -192,6 +227,10 @@ class NodeImpl : public RegisteredNode<Impl>, public Intf {
   }
 };
 
+// Same as NodeImpl, for nodes that implement AsyncNode::ProcessAsync().
+template <class Intf, class Impl = void>
+using AsyncNodeImpl = NodeImpl<Intf, Impl, AsyncNode>;
+
 // This macro is used to define the contract, without also giving the
 // node a type name. It can be used directly in pure interfaces.
 #define MEDIAPIPE_NODE_CONTRACT(...)                                          \
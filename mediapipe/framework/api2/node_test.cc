@@ -1,8 +1,12 @@
 #include "mediapipe/framework/api2/node.h"
 
+#include <deque>
+#include <functional>
+#include <thread>  // NOLINT(build/c++11)
 #include <tuple>
 #include <utility>
 
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/api2/packet.h"
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/api2/test_contracts.h"
@@ -565,6 +569,137 @@ TEST(NodeTest, ConsumeInputs) {
   MP_EXPECT_OK(graph.WaitUntilDone());
 }
 
+// Holds the invocations of AsyncDoubler until the test completes them.
+class PendingCalls {
+ public:
+  void Add(std::function<void()> call) {
+    absl::MutexLock lock(&mutex_);
+    calls_.push_back(std::move(call));
+  }
+
+  // Waits for a pending call and removes it.
+  std::function<void()> Take() {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(
+        +[](std::deque<std::function<void()>>* calls) {
+          return !calls->empty();
+        },
+        &calls_));
+    std::function<void()> call = std::move(calls_.front());
+    calls_.pop_front();
+    return call;
+  }
+
+  int size() {
+    absl::MutexLock lock(&mutex_);
+    return calls_.size();
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::deque<std::function<void()>> calls_ ABSL_GUARDED_BY(mutex_);
+};
+
+PendingCalls* GetPendingCalls() {
+  static auto* calls = new PendingCalls();
+  return calls;
+}
+
+struct AsyncDoubler : public NodeIntf {
+  static constexpr Input<int> kIn{"IN"};
+  static constexpr Output<int> kOut{"OUT"};
+
+  MEDIAPIPE_NODE_INTERFACE(AsyncDoubler, kIn, kOut);
+};
+
+class AsyncDoublerImpl
+    : public AsyncNodeImpl<AsyncDoubler, AsyncDoublerImpl> {
+ public:
+  void ProcessAsync(CalculatorContext* cc, ProcessDone done) override {
+    GetPendingCalls()->Add([cc, done] {
+      kOut(cc).Send(*kIn(cc) * 2);
+      done(absl::OkStatus());
+    });
+  }
+};
+
+TEST(NodeTest, AsyncNodeReleasesExecutorThread) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        num_threads: 1
+        input_stream: "in"
+        input_stream: "other"
+        node {
+          calculator: "AsyncDoubler"
+          input_stream: "IN:in"
+          output_stream: "OUT:out"
+        }
+        node {
+          calculator: "IntForwarder"
+          input_stream: "IN:other"
+          output_stream: "OUT:other_out"
+        }
+      )pb");
+  std::vector<mediapipe::Packet> out_packets;
+  tool::AddVectorSink("out", &config, &out_packets);
+  mediapipe::CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config, {}));
+  MP_ASSERT_OK_AND_ASSIGN(OutputStreamPoller poller,
+                          graph.AddOutputStreamPoller("other_out"));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "in", mediapipe::MakePacket<int>(1).At(Timestamp(1))));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "in", mediapipe::MakePacket<int>(2).At(Timestamp(2))));
+  std::function<void()> first_call = GetPendingCalls()->Take();
+
+  // The only executor thread still runs the other node.
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "other", mediapipe::MakePacket<int>(3).At(Timestamp(1))));
+  mediapipe::Packet packet;
+  ASSERT_TRUE(poller.Next(&packet));
+  EXPECT_EQ(packet.Get<int>(), 3);
+  // The next input set waits for the first invocation to complete.
+  EXPECT_EQ(GetPendingCalls()->size(), 0);
+  EXPECT_TRUE(out_packets.empty());
+
+  std::thread completion_thread(first_call);
+  completion_thread.join();
+  GetPendingCalls()->Take()();
+  MP_ASSERT_OK(graph.CloseAllPacketSources());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  EXPECT_THAT(PacketValues<int>(out_packets), ElementsAre(2, 4));
+  ASSERT_EQ(out_packets.size(), 2);
+  EXPECT_EQ(out_packets[0].Timestamp(), Timestamp(1));
+  EXPECT_EQ(out_packets[1].Timestamp(), Timestamp(2));
+}
+
+struct AsyncFailure : public AsyncNode {
+  static constexpr Input<int> kIn{"IN"};
+
+  MEDIAPIPE_NODE_CONTRACT(kIn);
+
+  void ProcessAsync(CalculatorContext* cc, ProcessDone done) override {
+    done(absl::InternalError("async failure"));
+  }
+};
+MEDIAPIPE_REGISTER_NODE(AsyncFailure);
+
+TEST(NodeTest, AsyncNodeReportsErrors) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "in"
+        node { calculator: "AsyncFailure" input_stream: "IN:in" }
+      )pb");
+  mediapipe::CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config, {}));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "in", mediapipe::MakePacket<int>(1).At(Timestamp(1))));
+  absl::Status status = graph.WaitUntilDone();
+  EXPECT_THAT(status.message(), testing::HasSubstr("async failure"));
+}
+
 // Just to test that single-port contracts work.
 struct LogSinkNode : public Node {
   static constexpr Input<int> kIn{"IN"};
@@ -210,11 +210,14 @@ class Packet : public Packet<internal::Generic> {
   Packet<T> At(Timestamp timestamp) const&;
   Packet<T> At(Timestamp timestamp) &&;
 
+  // A Packet<T> can only be created holding a T: by MakePacket, by
+  // PacketAdopting, or by As<T>(), which checks the type. So only emptiness is
+  // checked here, and the type is not checked again on every access.
   const T& Get() const {
     CHECK(payload_);
-    packet_internal::Holder<T>* typed_payload = payload_->As<T>();
-    CHECK(typed_payload);
-    return typed_payload->data();
+    DCHECK(payload_->As<T>());
+    return static_cast<const packet_internal::Holder<T>*>(payload_.get())
+        ->data();
   }
   const T& operator*() const { return Get(); }
   const T* operator->() const { return &Get(); }
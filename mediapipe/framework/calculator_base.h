@@ -17,6 +17,7 @@
 #ifndef MEDIAPIPE_FRAMEWORK_CALCULATOR_BASE_H_
 #define MEDIAPIPE_FRAMEWORK_CALCULATOR_BASE_H_
 
+#include <functional>
 #include <type_traits>
 
 #include "absl/memory/memory.h"
@@ -143,6 +144,20 @@ class CalculatorBase {
   // status indicates an error has occurred.
   virtual absl::Status Process(CalculatorContext* cc) = 0;
 
+  // Starts processing the incoming inputs of a calculator that calls
+  // CalculatorContract::SetProcessAsync(true). The calculator must call
+  // "done" exactly once with the status that Process() would have returned,
+  // possibly from another thread after ProcessAsync() has returned. The
+  // inputs stay available and outputs can be added to cc until then. The
+  // framework applies the usual ordering, timestamp bound and max_in_flight
+  // rules to the invocation as a whole: with max_in_flight 1, the next input
+  // set is not processed until "done" is called. The default implementation
+  // calls Process().
+  virtual void ProcessAsync(CalculatorContext* cc,
+                            std::function<void(absl::Status)> done) {
+    done(Process(cc));
+  }
+
   // Is called if Open() was called and succeeded.  Is called either
   // immediately after processing is complete or after a graph run has ended
   // (if an error occurred in the graph).  Must return absl::OkStatus()
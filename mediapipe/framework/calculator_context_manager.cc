@@ -82,11 +82,13 @@ CalculatorContext* CalculatorContextManager::PrepareCalculatorContext(
     calculator_context = new_context.get();
     active_contexts_.emplace(input_timestamp, std::move(new_context));
   } else {
-    // Retrieves an inactive calculator context from idle_contexts_.
-    calculator_context = idle_contexts_.front().get();
-    active_contexts_.emplace(input_timestamp,
-                             std::move(idle_contexts_.front()));
-    idle_contexts_.pop_front();
+    // Retrieves an inactive calculator context from idle_contexts_, together
+    // with its map node.
+    ContextMap::node_type node = std::move(idle_contexts_.back());
+    idle_contexts_.pop_back();
+    node.key() = input_timestamp;
+    calculator_context = node.mapped().get();
+    active_contexts_.insert(std::move(node));
   }
   return calculator_context;
 }
@@ -94,9 +96,7 @@ CalculatorContext* CalculatorContextManager::PrepareCalculatorContext(
 void CalculatorContextManager::RecycleCalculatorContext() {
   absl::MutexLock lock(&contexts_mutex_);
   // The first element in active_contexts_ will be recycled.
-  auto iter = active_contexts_.begin();
-  idle_contexts_.push_back(std::move(iter->second));
-  active_contexts_.erase(iter);
+  idle_contexts_.push_back(active_contexts_.extract(active_contexts_.begin()));
 }
 
 bool CalculatorContextManager::HasActiveContexts() {
@@ -15,10 +15,10 @@
 #ifndef MEDIAPIPE_FRAMEWORK_CALCULATOR_CONTEXT_MANAGER_H_
 #define MEDIAPIPE_FRAMEWORK_CALCULATOR_CONTEXT_MANAGER_H_
 
-#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
@@ -132,11 +132,13 @@ class CalculatorContextManager {
   // The mutex for synchronizing the operations on active_contexts_ and
   // idle_contexts_ during parallel execution.
   absl::Mutex contexts_mutex_;
+  using ContextMap = std::map<Timestamp, std::unique_ptr<CalculatorContext>>;
   // A map from input timestamps to calculator contexts.
-  std::map<Timestamp, std::unique_ptr<CalculatorContext>> active_contexts_
-      ABSL_GUARDED_BY(contexts_mutex_);
-  // Idle calculator contexts that are ready for reuse.
-  std::deque<std::unique_ptr<CalculatorContext>> idle_contexts_
+  ContextMap active_contexts_ ABSL_GUARDED_BY(contexts_mutex_);
+  // Idle calculator contexts that are ready for reuse, still in the map nodes
+  // that held them in active_contexts_ so that reactivating a context does not
+  // allocate. The most recently used context is reused first.
+  std::vector<ContextMap::node_type> idle_contexts_
       ABSL_GUARDED_BY(contexts_mutex_);
 };
 
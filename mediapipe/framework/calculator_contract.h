@@ -133,6 +133,26 @@ class CalculatorContract {
   void SetTimestampOffset(TimestampDiff offset) { timestamp_offset_ = offset; }
   TimestampDiff GetTimestampOffset() const { return timestamp_offset_; }
 
+  // When true, the calculator declares that its Process is cheap enough to be
+  // run synchronously on the thread that delivered its input, instead of
+  // being queued on its SchedulerQueue and handed to the executor. This is
+  // meant for glue calculators that only forward or repackage packets.
+  // The framework ignores the flag for nodes that have max_in_flight > 1 or
+  // an input stream handler that fills the input set late (e.g.
+  // FixedSizeInputStreamHandler), and it only runs a node inline when the
+  // delivering thread is already running a node on the same executor.
+  void SetInlineable(bool inlineable) { inlineable_ = inlineable; }
+  bool GetInlineable() const { return inlineable_; }
+
+  // When true, the framework calls CalculatorBase::ProcessAsync() instead of
+  // Process() for the input sets of the calculator, and releases the executor
+  // thread while the calculator waits for its completion callback. This is
+  // meant for calculators that wait on an accelerator or a remote call.
+  // Source nodes, and input stream handlers that deliver several timestamps
+  // in one input set, still use Process().
+  void SetProcessAsync(bool process_async) { process_async_ = process_async; }
+  bool GetProcessAsync() const { return process_async_; }
+
   class GraphServiceRequest {
    public:
     // APIs that should be used by calculators.
@@ -187,6 +207,8 @@ class CalculatorContract {
   std::string node_name_;
   ServiceReqMap service_requests_;
   bool process_timestamps_ = false;
+  bool inlineable_ = false;
+  bool process_async_ = false;
   TimestampDiff timestamp_offset_ = TimestampDiff::Unset();
 
   friend class CalculatorNode;
@@ -20,10 +20,12 @@
 #include <map>
 #include <memory>
 #include <queue>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/container/fixed_array.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
@@ -33,15 +35,20 @@
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_base.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
 #include "mediapipe/framework/counter_factory.h"
 #include "mediapipe/framework/delegating_executor.h"
+#include "mediapipe/framework/deps/slab_allocator.h"
 #include "mediapipe/framework/graph_service_manager.h"
+#include "mediapipe/framework/input_stream_handler.h"
 #include "mediapipe/framework/input_stream_manager.h"
 #include "mediapipe/framework/mediapipe_profiling.h"
 #include "mediapipe/framework/packet_generator.h"
 #include "mediapipe/framework/packet_generator.pb.h"
+#include "mediapipe/framework/packet_payload_size.h"
 #include "mediapipe/framework/packet_set.h"
 #include "mediapipe/framework/packet_type.h"
 #include "mediapipe/framework/port.h"
@@ -52,11 +59,13 @@
 #include "mediapipe/framework/port/source_location.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/status_builder.h"
+#include "mediapipe/framework/shared_executor.h"
 #include "mediapipe/framework/status_handler.h"
 #include "mediapipe/framework/status_handler.pb.h"
 #include "mediapipe/framework/thread_pool_executor.h"
 #include "mediapipe/framework/thread_pool_executor.pb.h"
 #include "mediapipe/framework/tool/fill_packet_set.h"
+#include "mediapipe/framework/tool/name_util.h"
 #include "mediapipe/framework/tool/status_util.h"
 #include "mediapipe/framework/tool/tag_map.h"
 #include "mediapipe/framework/tool/validate.h"
@@ -130,6 +139,9 @@ CalculatorGraph::CalculatorGraph(CalculatorGraphConfig config)
 // they only need to be fully visible here, where their destructor is
 // instantiated.
 CalculatorGraph::~CalculatorGraph() {
+  if (memory_budget_) {
+    memory_budget_->RemoveObserver(memory_budget_observer_);
+  }
   // Stop periodic profiler output to ublock Executor destructors.
   absl::Status status = profiler()->Stop();
   if (!status.ok()) {
@@ -177,6 +189,14 @@ absl::Status CalculatorGraph::InitializeStreams() {
     const EdgeInfo& edge_info = validated_graph_->InputStreamInfos()[index];
     MP_RETURN_IF_ERROR(input_stream_managers_[index].Initialize(
         edge_info.name, edge_info.packet_type, edge_info.back_edge));
+    // A stream produced by a calculator that runs one invocation at a time
+    // has a single producer thread at any point in time.
+    const NodeTypeInfo::NodeRef& producer =
+        validated_graph_->OutputStreamInfos()[edge_info.upstream].parent_node;
+    if (producer.type == NodeTypeInfo::NodeType::CALCULATOR &&
+        validated_graph_->Config().node(producer.index).max_in_flight() <= 1) {
+      input_stream_managers_[index].EnableSingleProducerMode();
+    }
   }
 
   // Create and initialize the output streams.
@@ -270,6 +290,26 @@ absl::Status CalculatorGraph::InitializeCalculatorNodes() {
         "CalculatorGraph::InitializeCalculatorNodes failed: ", errors);
   }
 
+  if (validated_graph_->Config().has_adaptive_queue()) {
+    std::vector<std::string> stream_names;
+    for (int index = 0; index < validated_graph_->InputStreamInfos().size();
+         ++index) {
+      stream_names.push_back(input_stream_managers_[index].Name());
+    }
+    adaptive_queue_sizer_ = std::make_shared<internal::AdaptiveQueueSizer>(
+        validated_graph_->Config().adaptive_queue(), std::move(stream_names),
+        max_queue_size_);
+    max_queue_size_ = adaptive_queue_sizer_->InitialQueueSize();
+    profiler_->AddInputQueueProfileCallback(
+        [weak_sizer = std::weak_ptr<internal::AdaptiveQueueSizer>(
+             adaptive_queue_sizer_)](GraphProfile* profile) {
+          if (auto sizer = weak_sizer.lock()) {
+            sizer->GetProfiles(profile);
+          }
+        });
+  }
+  AddQueuedBytesProfileCallback();
+
   VLOG(2) << "Maximum input stream queue size based on graph config: "
           << max_queue_size_;
   return absl::OkStatus();
@@ -329,6 +369,16 @@ absl::Status CalculatorGraph::InitializeExecutors() {
                << "\" has a \"type\" field but is also provided to the graph "
                   "with a CalculatorGraph::SetExecutor() call.";
       }
+      if (!executor_config.shared_name().empty()) {
+        return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+               << "ExecutorConfig for \"" << executor_config.name()
+               << "\" has a \"shared_name\" field but is also provided to the "
+                  "graph with a CalculatorGraph::SetExecutor() call.";
+      }
+      continue;
+    }
+    if (!executor_config.shared_name().empty()) {
+      MP_RETURN_IF_ERROR(AttachSharedExecutor(executor_config));
       continue;
     }
     if (executor_config.name().empty()) {
@@ -373,6 +423,48 @@ absl::Status CalculatorGraph::InitializeExecutors() {
   return absl::OkStatus();
 }
 
+absl::Status CalculatorGraph::AttachSharedExecutor(
+    const ExecutorConfig& executor_config) {
+  if (executor_config.type() == kApplicationThreadExecutorType) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "ExecutorConfig for \"" << executor_config.name()
+           << "\" cannot share the application thread.";
+  }
+  std::string type = executor_config.type();
+  MediaPipeOptions options = executor_config.options();
+  if (type.empty()) {
+    // A shared thread pool serves many graphs, so its size is not derived
+    // from the size of this graph.
+    type = "ThreadPoolExecutor";
+    ThreadPoolExecutorOptions* thread_pool_options =
+        options.MutableExtension(ThreadPoolExecutorOptions::ext);
+    if (thread_pool_options->num_threads() <= 0) {
+      thread_pool_options->set_num_threads(mediapipe::NumCPUCores());
+    }
+  }
+  ASSIGN_OR_RETURN(
+      std::shared_ptr<SharedExecutor> shared_executor,
+      SharedExecutor::GetOrCreate(executor_config.shared_name(),
+                                  validated_graph_->Package(), type, options));
+  std::shared_ptr<SharedExecutor::Client> client =
+      shared_executor->AddClient();
+  profiler_->AddExecutorProfileCallback(
+      [name = executor_config.name(),
+       shared_name = executor_config.shared_name(),
+       weak_client = std::weak_ptr<SharedExecutor::Client>(client)](
+          ExecutorProfile* profile) {
+        profile->set_name(name);
+        profile->set_shared_name(shared_name);
+        if (auto client = weak_client.lock()) {
+          profile->set_num_tasks_run(client->NumTasksRun());
+          profile->set_busy_time_usec(client->BusyTimeUsec());
+          profile->set_total_busy_time_usec(
+              client->shared_executor()->BusyTimeUsec());
+        }
+      });
+  return SetExecutorInternal(executor_config.name(), std::move(client));
+}
+
 absl::Status CalculatorGraph::InitializeDefaultExecutor(
     const ThreadPoolExecutorOptions* default_executor_options,
     bool use_application_thread) {
@@ -454,6 +546,14 @@ absl::Status CalculatorGraph::Initialize(
   return Initialize(std::move(validated_graph), side_packets);
 }
 
+absl::Status CalculatorGraph::Initialize(
+    const ExpandedGraphConfig& expanded_config,
+    const std::map<std::string, Packet>& side_packets) {
+  auto validated_graph = absl::make_unique<ValidatedGraphConfig>();
+  MP_RETURN_IF_ERROR(validated_graph->Initialize(expanded_config));
+  return Initialize(std::move(validated_graph), side_packets);
+}
+
 absl::Status CalculatorGraph::ObserveOutputStream(
     const std::string& stream_name,
     std::function<absl::Status(const Packet&)> packet_callback,
@@ -476,6 +576,26 @@ absl::Status CalculatorGraph::ObserveOutputStream(
   return absl::OkStatus();
 }
 
+absl::Status CalculatorGraph::ObserveOutputStreamBatches(
+    const std::string& stream_name,
+    std::function<absl::Status(const std::vector<Packet>&)> packets_callback,
+    bool observe_timestamp_bounds) {
+  RET_CHECK(initialized_).SetNoLogging()
+      << "CalculatorGraph is not initialized.";
+  int output_stream_index = validated_graph_->OutputStreamIndex(stream_name);
+  if (output_stream_index < 0) {
+    return mediapipe::NotFoundErrorBuilder(MEDIAPIPE_LOC)
+           << "Unable to attach observer to output stream \"" << stream_name
+           << "\" because it doesn't exist.";
+  }
+  auto observer = absl::make_unique<internal::OutputStreamObserver>();
+  MP_RETURN_IF_ERROR(observer->Initialize(
+      stream_name, &any_packet_type_, std::move(packets_callback),
+      &output_stream_managers_[output_stream_index], observe_timestamp_bounds));
+  graph_output_streams_.push_back(std::move(observer));
+  return absl::OkStatus();
+}
+
 absl::StatusOr<OutputStreamPoller> CalculatorGraph::AddOutputStreamPoller(
     const std::string& stream_name, bool observe_timestamp_bounds) {
   RET_CHECK(initialized_).SetNoLogging()
@@ -592,6 +712,28 @@ absl::Status CalculatorGraph::MaybeSetUpGpuServiceFromLegacySidePacket(
   return service_manager_.SetServiceObject(kGpuService, gpu_resources);
 }
 
+static bool UsesGpu(const CalculatorNode& node) {
+  return node.Contract().ServiceRequests().contains(kGpuService.key);
+}
+
+absl::Status CalculatorGraph::MaybeSetUpGpuServiceForDevice(
+    const std::map<std::string, Packet>& side_packets) {
+  auto device_sp_iter = side_packets.find(kGpuDeviceSidePacketName);
+  if (device_sp_iter == side_packets.end()) return absl::OkStatus();
+  if (service_manager_.GetServiceObject(kGpuService)) return absl::OkStatus();
+  if (std::none_of(nodes_.begin(), nodes_.end(),
+                   [](const auto& node) { return UsesGpu(*node); })) {
+    return absl::OkStatus();
+  }
+  MP_RETURN_IF_ERROR(device_sp_iter->second.ValidateAsType<int>())
+      << "\"" << kGpuDeviceSidePacketName << "\" side packet";
+  GpuResourcesOptions options;
+  options.gpu_device = device_sp_iter->second.Get<int>();
+  ASSIGN_OR_RETURN(auto gpu_resources, GpuResources::Create(options));
+  return service_manager_.SetServiceObject(kGpuService,
+                                           std::move(gpu_resources));
+}
+
 std::map<std::string, Packet> CalculatorGraph::MaybeCreateLegacyGpuSidePacket(
     Packet legacy_sp) {
   std::map<std::string, Packet> additional_side_packets;
@@ -608,9 +750,6 @@ std::map<std::string, Packet> CalculatorGraph::MaybeCreateLegacyGpuSidePacket(
   return additional_side_packets;
 }
 
-static bool UsesGpu(const CalculatorNode& node) {
-  return node.Contract().ServiceRequests().contains(kGpuService.key);
-}
 
 absl::Status CalculatorGraph::PrepareGpu() {
   auto gpu_resources = service_manager_.GetServiceObject(kGpuService);
@@ -625,6 +764,10 @@ absl::Status CalculatorGraph::PrepareGpu() {
     MP_RETURN_IF_ERROR(
         SetExecutorInternal(name_executor.first, name_executor.second));
   }
+  if (auto memory_budget =
+          service_manager_.GetServiceObject(kMemoryBudgetService)) {
+    gpu_resources->gpu_buffer_pool().SetMemoryBudget(std::move(memory_budget));
+  }
   return absl::OkStatus();
 }
 #endif  // !MEDIAPIPE_DISABLE_GPU
@@ -651,6 +794,88 @@ absl::Status CalculatorGraph::PrepareServices() {
   return absl::OkStatus();
 }
 
+void CalculatorGraph::PrepareMemoryBudget() {
+  std::shared_ptr<MemoryBudget> memory_budget =
+      service_manager_.GetServiceObject(kMemoryBudgetService);
+  if (memory_budget == memory_budget_) {
+    UpdateMemoryThrottle();
+    return;
+  }
+  if (memory_budget_) {
+    memory_budget_->RemoveObserver(memory_budget_observer_);
+    memory_budget_observer_ = -1;
+  }
+  memory_budget_ = std::move(memory_budget);
+  for (int index = 0; index < validated_graph_->InputStreamInfos().size();
+       ++index) {
+    input_stream_managers_[index].SetMemoryBudget(memory_budget_);
+  }
+  if (memory_budget_ && !graph_input_streams_.empty()) {
+    memory_budget_observer_ =
+        memory_budget_->AddObserver([this]() { UpdateMemoryThrottle(); });
+    UpdateMemoryThrottle();
+  }
+}
+
+void CalculatorGraph::UpdateMemoryThrottle() {
+  if (memory_budget_observer_ < 0) {
+    return;
+  }
+  absl::MutexLock lock(&memory_budget_mutex_);
+  const bool exceeded = memory_budget_->IsExceeded();
+  if (exceeded == memory_throttled_) {
+    return;
+  }
+  memory_throttled_ = exceeded;
+  if (exceeded) {
+    scheduler_.ThrottledGraphInputStream();
+  } else {
+    memory_budget_bypass_ = false;
+    scheduler_.UnthrottledGraphInputStream();
+  }
+}
+
+bool CalculatorGraph::IsMemoryThrottled() const {
+  return memory_budget_observer_ >= 0 && memory_budget_->IsExceeded() &&
+         !memory_budget_bypass_;
+}
+
+absl::Status CalculatorGraph::UpdateSchedulingPriorities() {
+  const CalculatorGraphConfig& config = validated_graph_->Config();
+  if (config.scheduling_policy() != CalculatorGraphConfig::CRITICAL_PATH ||
+      !config.profiler_config().enable_profiler()) {
+    return absl::OkStatus();
+  }
+  std::vector<CalculatorProfile> profiles;
+  MP_RETURN_IF_ERROR(profiler_->GetCalculatorProfiles(&profiles));
+  std::map<std::string, const CalculatorProfile*> profiles_by_name;
+  for (const CalculatorProfile& profile : profiles) {
+    profiles_by_name[profile.name()] = &profile;
+  }
+  const int num_calculators = validated_graph_->CalculatorInfos().size();
+  // Nodes that have not run yet count as one microsecond.
+  std::vector<int64> node_costs(num_calculators, 1);
+  for (int node_id = 0; node_id < num_calculators; ++node_id) {
+    auto iter =
+        profiles_by_name.find(tool::CanonicalNodeName(config, node_id));
+    if (iter == profiles_by_name.end()) continue;
+    const TimeHistogram& runtime = iter->second->process_runtime();
+    int64 num_calls = 0;
+    for (int64 count : runtime.count()) {
+      num_calls += count;
+    }
+    if (num_calls > 0) {
+      node_costs[node_id] = std::max<int64>(1, runtime.total() / num_calls);
+    }
+  }
+  ASSIGN_OR_RETURN(std::vector<int64> lengths,
+                   validated_graph_->ComputeCriticalPathLengths(node_costs));
+  for (int node_id = 0; node_id < num_calculators; ++node_id) {
+    nodes_[node_id]->SetSchedulingPriority(lengths[node_id]);
+  }
+  return absl::OkStatus();
+}
+
 absl::Status CalculatorGraph::PrepareForRun(
     const std::map<std::string, Packet>& extra_side_packets,
     const std::map<std::string, Packet>& stream_headers) {
@@ -671,6 +896,7 @@ absl::Status CalculatorGraph::PrepareForRun(
 #if !MEDIAPIPE_DISABLE_GPU
   auto legacy_sp = GetLegacyGpuSharedSidePacket(extra_side_packets);
   MP_RETURN_IF_ERROR(MaybeSetUpGpuServiceFromLegacySidePacket(legacy_sp));
+  MP_RETURN_IF_ERROR(MaybeSetUpGpuServiceForDevice(extra_side_packets));
 #endif  // !MEDIAPIPE_DISABLE_GPU
   MP_RETURN_IF_ERROR(PrepareServices());
 #if !MEDIAPIPE_DISABLE_GPU
@@ -723,9 +949,18 @@ absl::Status CalculatorGraph::PrepareForRun(
     default_executor = executors_[""].get();
     RET_CHECK(default_executor);
   }
-  scheduler_.Reset();
+  {
+    // The scheduler counts the memory budget as a throttled graph input
+    // stream, see UpdateMemoryThrottle.
+    absl::MutexLock lock(&memory_budget_mutex_);
+    scheduler_.Reset();
+    memory_throttled_ = false;
+  }
+  memory_budget_bypass_ = false;
+  frame_deadlines_.Clear();
 
   MP_RETURN_IF_ERROR(InitializePacketGeneratorNodes(non_scheduled_generators));
+  MP_RETURN_IF_ERROR(UpdateSchedulingPriorities());
 
   {
     absl::MutexLock lock(&full_input_streams_mutex_);
@@ -738,6 +973,7 @@ absl::Status CalculatorGraph::PrepareForRun(
     full_input_streams_.resize(validated_graph_->CalculatorInfos().size() +
                                graph_input_streams_.size());
   }
+  PrepareMemoryBudget();
 
   for (auto& item : graph_input_streams_) {
     item.second->PrepareForRun(
@@ -748,12 +984,18 @@ absl::Status CalculatorGraph::PrepareForRun(
     output_side_packets_[index].PrepareForRun(
         std::bind(&CalculatorGraph::RecordError, this, std::placeholders::_1));
   }
+  if (adaptive_queue_sizer_) {
+    adaptive_queue_sizer_->Reset();
+  }
   for (auto& node : nodes_) {
     InputStreamManager::QueueSizeCallback queue_size_callback =
-        std::bind(&CalculatorGraph::UpdateThrottledNodes, this,
-                  std::placeholders::_1, std::placeholders::_2);
+        std::bind(adaptive_queue_sizer_
+                      ? &CalculatorGraph::UpdateAdaptiveQueueSize
+                      : &CalculatorGraph::UpdateThrottledNodes,
+                  this, std::placeholders::_1, std::placeholders::_2);
     node->SetQueueSizeCallbacks(queue_size_callback, queue_size_callback);
     scheduler_.AssignNodeToSchedulerQueue(node.get());
+    node->SetFrameDeadlines(&frame_deadlines_);
     // TODO: update calculator node to use GraphServiceManager
     // instead of service packets?
     const absl::Status result = node->PrepareForRun(
@@ -868,6 +1110,16 @@ absl::Status CalculatorGraph::AddPacketToInputStream(
   return AddPacketToInputStreamInternal(stream_name, std::move(packet));
 }
 
+absl::Status CalculatorGraph::AddPacketToInputStream(
+    const std::string& stream_name, Packet packet, absl::Time deadline) {
+  // The deadline is set first, so that it is in place when the packet reaches
+  // the nodes.
+  if (packet.Timestamp().IsAllowedInStream()) {
+    frame_deadlines_.Set(packet.Timestamp(), deadline);
+  }
+  return AddPacketToInputStreamInternal(stream_name, std::move(packet));
+}
+
 // We avoid having two copies of this code for AddPacketToInputStream(
 // const Packet&) and AddPacketToInputStream(Packet &&) by having this
 // internal-only templated version.  T&& is a forwarding reference here, so
@@ -883,43 +1135,7 @@ absl::Status CalculatorGraph::AddPacketToInputStreamInternal(
       stream_name);
   int node_id = mediapipe::FindOrDie(graph_input_stream_node_ids_, stream_name);
   CHECK_GE(node_id, validated_graph_->CalculatorInfos().size());
-  {
-    absl::MutexLock lock(&full_input_streams_mutex_);
-    if (full_input_streams_.empty()) {
-      return mediapipe::FailedPreconditionErrorBuilder(MEDIAPIPE_LOC)
-             << "CalculatorGraph::AddPacketToInputStream() is called before "
-                "StartRun()";
-    }
-    if (graph_input_stream_add_mode_ ==
-        GraphInputStreamAddMode::ADD_IF_NOT_FULL) {
-      if (has_error_) {
-        absl::Status error_status;
-        GetCombinedErrors("Graph has errors: ", &error_status);
-        return error_status;
-      }
-      // Return with StatusUnavailable if this stream is being throttled.
-      if (!full_input_streams_[node_id].empty()) {
-        return mediapipe::UnavailableErrorBuilder(MEDIAPIPE_LOC)
-               << "Graph is throttled.";
-      }
-    } else if (graph_input_stream_add_mode_ ==
-               GraphInputStreamAddMode::WAIT_TILL_NOT_FULL) {
-      // Wait until this stream is not being throttled.
-      // TODO: instead of checking has_error_, we could just check
-      // if the graph is done. That could also be indicated by returning an
-      // error from WaitUntilGraphInputStreamUnthrottled.
-      while (!has_error_ && !full_input_streams_[node_id].empty()) {
-        // TODO: allow waiting for a specific stream?
-        scheduler_.WaitUntilGraphInputStreamUnthrottled(
-            &full_input_streams_mutex_);
-      }
-      if (has_error_) {
-        absl::Status error_status;
-        GetCombinedErrors("Graph has errors: ", &error_status);
-        return error_status;
-      }
-    }
-  }
+  MP_RETURN_IF_ERROR(WaitUntilGraphInputStreamsAccept({node_id}));
 
   // Adding profiling info for a new packet entering the graph.
   const std::string* stream_id = &(*stream)->GetManager()->Name();
@@ -951,6 +1167,155 @@ absl::Status CalculatorGraph::AddPacketToInputStreamInternal(
   return absl::OkStatus();
 }
 
+absl::Status CalculatorGraph::WaitUntilGraphInputStreamsAccept(
+    absl::Span<const int> node_ids) {
+  absl::MutexLock lock(&full_input_streams_mutex_);
+  if (full_input_streams_.empty()) {
+    return mediapipe::FailedPreconditionErrorBuilder(MEDIAPIPE_LOC)
+           << "CalculatorGraph::AddPacketToInputStream() is called before "
+              "StartRun()";
+  }
+  auto any_stream_throttled = [this, node_ids]() {
+    full_input_streams_mutex_.AssertHeld();
+    if (IsMemoryThrottled()) return true;
+    for (int node_id : node_ids) {
+      if (!full_input_streams_[node_id].empty()) return true;
+    }
+    return false;
+  };
+  if (IsMemoryThrottled()) {
+    memory_budget_->RecordThrottled();
+    // Lets a packet in if the graph is already idle, see UnthrottleSources.
+    full_input_streams_mutex_.Unlock();
+    scheduler_.AddedPacketToGraphInputStream();
+    full_input_streams_mutex_.Lock();
+  }
+  if (graph_input_stream_add_mode_ ==
+      GraphInputStreamAddMode::ADD_IF_NOT_FULL) {
+    if (has_error_) {
+      absl::Status error_status;
+      GetCombinedErrors("Graph has errors: ", &error_status);
+      return error_status;
+    }
+    // Return with StatusUnavailable if a stream is being throttled.
+    if (any_stream_throttled()) {
+      return mediapipe::UnavailableErrorBuilder(MEDIAPIPE_LOC)
+             << "Graph is throttled.";
+    }
+  } else if (graph_input_stream_add_mode_ ==
+             GraphInputStreamAddMode::WAIT_TILL_NOT_FULL) {
+    // Wait until no stream is being throttled.
+    // TODO: instead of checking has_error_, we could just check
+    // if the graph is done. That could also be indicated by returning an
+    // error from WaitUntilGraphInputStreamUnthrottled.
+    while (!has_error_ && any_stream_throttled()) {
+      // TODO: allow waiting for a specific stream?
+      scheduler_.WaitUntilGraphInputStreamUnthrottled(
+          &full_input_streams_mutex_);
+    }
+    if (has_error_) {
+      absl::Status error_status;
+      GetCombinedErrors("Graph has errors: ", &error_status);
+      return error_status;
+    }
+  }
+  // A packet let in over the memory budget uses up the bypass.
+  memory_budget_bypass_ = false;
+  return absl::OkStatus();
+}
+
+absl::Status CalculatorGraph::AddPacketsToInputStreams(
+    absl::Span<const std::pair<std::string, Packet>> packets) {
+  std::vector<GraphInputStreamBatch> batches;
+  for (const auto& stream_and_packet : packets) {
+    ASSIGN_OR_RETURN(
+        GraphInputStreamBatch * batch,
+        FindOrAddInputStreamBatch(stream_and_packet.first, &batches));
+    batch->packets.push_back(&stream_and_packet.second);
+  }
+  return AddPacketBatchesToInputStreams(batches);
+}
+
+absl::Status CalculatorGraph::AddPacketsToInputStream(
+    const std::string& stream_name, absl::Span<const Packet> packets) {
+  std::vector<GraphInputStreamBatch> batches;
+  ASSIGN_OR_RETURN(GraphInputStreamBatch * batch,
+                   FindOrAddInputStreamBatch(stream_name, &batches));
+  batch->packets.reserve(packets.size());
+  for (const Packet& packet : packets) {
+    batch->packets.push_back(&packet);
+  }
+  return AddPacketBatchesToInputStreams(batches);
+}
+
+absl::StatusOr<CalculatorGraph::GraphInputStreamBatch*>
+CalculatorGraph::FindOrAddInputStreamBatch(
+    const std::string& stream_name,
+    std::vector<GraphInputStreamBatch>* batches) {
+  std::unique_ptr<GraphInputStream>* stream =
+      mediapipe::FindOrNull(graph_input_streams_, stream_name);
+  RET_CHECK(stream).SetNoLogging() << absl::Substitute(
+      "AddPacketsToInputStreams called on input stream \"$0\" which is not a "
+      "graph input stream.",
+      stream_name);
+  // Batches usually cover a handful of streams, so a linear search is
+  // cheaper than a map.
+  for (GraphInputStreamBatch& batch : *batches) {
+    if (batch.stream == stream->get()) return &batch;
+  }
+  int node_id = mediapipe::FindOrDie(graph_input_stream_node_ids_, stream_name);
+  CHECK_GE(node_id, validated_graph_->CalculatorInfos().size());
+  batches->emplace_back();
+  batches->back().stream = stream->get();
+  batches->back().node_id = node_id;
+  return &batches->back();
+}
+
+absl::Status CalculatorGraph::AddPacketBatchesToInputStreams(
+    const std::vector<GraphInputStreamBatch>& batches) {
+  std::vector<int> node_ids;
+  node_ids.reserve(batches.size());
+  for (const GraphInputStreamBatch& batch : batches) {
+    node_ids.push_back(batch.node_id);
+  }
+  MP_RETURN_IF_ERROR(WaitUntilGraphInputStreamsAccept(node_ids));
+
+  for (const GraphInputStreamBatch& batch : batches) {
+    const std::string* stream_id = &batch.stream->GetManager()->Name();
+    for (const Packet* packet : batch.packets) {
+      // Adding profiling info for a new packet entering the graph.
+      profiler_->LogEvent(TraceEvent(TraceEvent::PROCESS)
+                              .set_is_finish(true)
+                              .set_input_ts(packet->Timestamp())
+                              .set_stream_id(stream_id)
+                              .set_packet_ts(packet->Timestamp())
+                              .set_packet_data_id(packet));
+      // See AddPacketToInputStreamInternal about thread safety.
+      batch.stream->AddPacket(*packet);
+    }
+  }
+  if (has_error_) {
+    absl::Status error_status;
+    GetCombinedErrors("Graph has errors: ", &error_status);
+    return error_status;
+  }
+  // Each consumer receives the packets of a stream in one update, and is
+  // notified once for all the streams.
+  {
+    InputStreamHandler::BatchedNotifications batched_notifications;
+    for (const GraphInputStreamBatch& batch : batches) {
+      if (!batch.packets.empty()) {
+        batch.stream->PropagateUpdatesToMirrors();
+      }
+    }
+  }
+
+  VLOG(2) << "Packet batch added directly to " << batches.size()
+          << " graph input streams.";
+  scheduler_.AddedPacketToGraphInputStream();
+  return absl::OkStatus();
+}
+
 absl::Status CalculatorGraph::SetInputStreamMaxQueueSize(
     const std::string& stream_name, int max_queue_size) {
   // graph_input_streams_ has not been filled in yet, so we'll check this when
@@ -1171,6 +1536,83 @@ void CalculatorGraph::UpdateThrottledNodes(InputStreamManager* stream,
   }
 }
 
+void CalculatorGraph::UpdateAdaptiveQueueSize(InputStreamManager* stream,
+                                              bool* stream_was_full) {
+  // Node input streams are elements of input_stream_managers_.
+  const int index = stream - input_stream_managers_.get();
+  const int max_queue_size = stream->MaxQueueSize();
+  const int new_max_queue_size = adaptive_queue_sizer_->UpdateQueueSize(
+      index, stream->IsFull(), max_queue_size, stream->NumPacketsAdded(),
+      stream->QueueSize(), absl::Now());
+  if (new_max_queue_size != max_queue_size) {
+    VLOG(2) << "Changing max_queue_size of input stream \"" << stream->Name()
+            << "\" to " << new_max_queue_size;
+    // Calls this method again if the stream becomes full or non-full.
+    stream->SetMaxQueueSize(new_max_queue_size);
+  }
+  UpdateThrottledNodes(stream, stream_was_full);
+}
+
+void CalculatorGraph::AddQueuedBytesProfileCallback() {
+  using NamedCounter =
+      std::pair<std::string, std::weak_ptr<const QueuedBytesCounter>>;
+  std::vector<NamedCounter> stream_counters;
+  for (int index = 0; index < validated_graph_->InputStreamInfos().size();
+       ++index) {
+    if (auto counter = input_stream_managers_[index].QueuedBytes()) {
+      stream_counters.emplace_back(input_stream_managers_[index].Name(),
+                                   counter);
+    }
+  }
+  std::vector<NamedCounter> node_counters;
+  for (int node_id = 0; node_id < nodes_.size(); ++node_id) {
+    if (auto counter = nodes_[node_id]->QueuedBytes()) {
+      node_counters.emplace_back(
+          tool::CanonicalNodeName(validated_graph_->Config(), node_id),
+          counter);
+    }
+  }
+  if (stream_counters.empty() && node_counters.empty()) {
+    return;
+  }
+  // Fills in the InputQueueProfiles added by the adaptive queue sizer, if any,
+  // and the CalculatorProfiles included in the profile.
+  profiler_->AddInputQueueProfileCallback(
+      [stream_counters = std::move(stream_counters),
+       node_counters = std::move(node_counters)](GraphProfile* profile) {
+        absl::flat_hash_map<std::string, InputQueueProfile*> queue_profiles;
+        for (auto& queue_profile : *profile->mutable_input_queue_profiles()) {
+          queue_profiles[queue_profile.name()] = &queue_profile;
+        }
+        for (const auto& [name, weak_counter] : stream_counters) {
+          auto counter = weak_counter.lock();
+          if (!counter) continue;
+          InputQueueProfile*& queue_profile = queue_profiles[name];
+          if (!queue_profile) {
+            queue_profile = profile->add_input_queue_profiles();
+            queue_profile->set_name(name);
+          }
+          queue_profile->set_queued_bytes(counter->Bytes());
+          queue_profile->set_peak_queued_bytes(counter->PeakBytes());
+        }
+        absl::flat_hash_map<std::string,
+                            std::shared_ptr<const QueuedBytesCounter>>
+            node_bytes;
+        for (const auto& [name, weak_counter] : node_counters) {
+          if (auto counter = weak_counter.lock()) {
+            node_bytes[name] = std::move(counter);
+          }
+        }
+        for (auto& calculator_profile :
+             *profile->mutable_calculator_profiles()) {
+          auto it = node_bytes.find(calculator_profile.name());
+          if (it == node_bytes.end()) continue;
+          calculator_profile.set_queued_bytes(it->second->Bytes());
+          calculator_profile.set_peak_queued_bytes(it->second->PeakBytes());
+        }
+      });
+}
+
 bool CalculatorGraph::IsNodeThrottled(int node_id) {
   absl::MutexLock lock(&full_input_streams_mutex_);
   return max_queue_size_ != -1 && !full_input_streams_[node_id].empty();
@@ -1196,6 +1638,12 @@ bool CalculatorGraph::UnthrottleSources() {
   // This is a sufficient because succesfully growing at least one full input
   // stream during each call to UnthrottleSources will eventually resolve
   // each deadlock.
+  if (IsMemoryThrottled() && !memory_budget_bypass_.exchange(true)) {
+    VLOG(2) << "Letting a packet in over the memory budget of "
+            << memory_budget_->limit_bytes() << " bytes.";
+    scheduler_.NotifyGraphInputStreamWaiters();
+    return true;
+  }
   absl::flat_hash_set<InputStreamManager*> full_streams;
   {
     absl::MutexLock lock(&full_input_streams_mutex_);
@@ -1380,4 +1828,83 @@ absl::Status CalculatorGraph::GetCalculatorProfiles(
   return profiler_->GetCalculatorProfiles(profiles);
 }
 
+absl::Status CalculatorGraph::ExportMetrics(MetricsSink* sink) {
+  RET_CHECK(initialized_)
+      << "CalculatorGraph::ExportMetrics() called before Initialize().";
+  for (const auto& [name, value] :
+       counter_factory_->GetCounterSet()->GetCountersValues()) {
+    sink->AddCounter("mediapipe_counter_total",
+                     "The value of a counter of a calculator.",
+                     {{"counter", name}}, value);
+  }
+
+  std::vector<CalculatorProfile> profiles;
+  MP_RETURN_IF_ERROR(profiler_->GetCalculatorProfiles(&profiles));
+  for (const CalculatorProfile& profile : profiles) {
+    const TimeHistogram& runtime = profile.process_runtime();
+    if (runtime.count().empty()) continue;
+    // The last interval of a TimeHistogram extends to infinity.
+    std::vector<double> upper_bounds;
+    std::vector<int64> bucket_counts;
+    int64 count = 0;
+    for (int i = 0; i < runtime.count_size(); ++i) {
+      count += runtime.count(i);
+      bucket_counts.push_back(count);
+      if (i + 1 < runtime.count_size()) {
+        upper_bounds.push_back((i + 1) * runtime.interval_size_usec() / 1e6);
+      }
+    }
+    sink->AddHistogram("mediapipe_node_process_seconds",
+                       "The runtime of the Process() calls of a node.",
+                       {{"node", profile.name()}}, upper_bounds,
+                       bucket_counts, runtime.total() / 1e6);
+  }
+
+  for (int index = 0; index < validated_graph_->InputStreamInfos().size();
+       ++index) {
+    const InputStreamManager& stream = input_stream_managers_[index];
+    const std::string node_name = tool::CanonicalNodeName(
+        validated_graph_->Config(),
+        validated_graph_->InputStreamInfos()[index].parent_node.index);
+    const MetricsSink::Labels labels = {{"node", node_name},
+                                        {"stream", stream.Name()}};
+    sink->AddGauge("mediapipe_input_queue_size",
+                   "The number of packets queued in an input stream.", labels,
+                   stream.QueueSize());
+    sink->AddGauge("mediapipe_input_queue_max_size",
+                   "The queue limit of an input stream, or -1 if unlimited.",
+                   labels, stream.MaxQueueSize());
+  }
+
+  if (memory_budget_) {
+    const MemoryBudget::Stats budget = memory_budget_->GetStats();
+    sink->AddGauge("mediapipe_memory_budget_bytes",
+                   "The bytes counted against the memory budget.", {},
+                   budget.bytes);
+    sink->AddGauge("mediapipe_memory_budget_peak_bytes",
+                   "The peak of the bytes counted against the memory budget.",
+                   {}, budget.peak_bytes);
+    sink->AddGauge("mediapipe_memory_budget_limit_bytes",
+                   "The limit of the memory budget.", {}, budget.limit_bytes);
+    sink->AddCounter("mediapipe_memory_budget_exceeded_total",
+                     "The times the memory budget went over its limit.", {},
+                     budget.exceeded_count);
+    sink->AddCounter("mediapipe_memory_budget_throttled_total",
+                     "The graph inputs throttled over the memory budget.", {},
+                     budget.throttled_count);
+    sink->AddCounter("mediapipe_memory_budget_dropped_total",
+                     "The packets dropped over the memory budget.", {},
+                     budget.dropped_count);
+  }
+
+  const SlabAllocatorStats slab_stats = GetSlabAllocatorStats();
+  sink->AddCounter("mediapipe_packet_pool_blocks_total",
+                   "The memory blocks handed out for pooled packets.",
+                   {{"source", "reused"}}, slab_stats.num_reused);
+  sink->AddCounter("mediapipe_packet_pool_blocks_total",
+                   "The memory blocks handed out for pooled packets.",
+                   {{"source", "allocated"}}, slab_stats.num_allocated);
+  return absl::OkStatus();
+}
+
 }  // namespace mediapipe
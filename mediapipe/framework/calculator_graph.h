@@ -31,15 +31,21 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "mediapipe/framework/adaptive_queue_sizer.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_base.h"
 #include "mediapipe/framework/calculator_node.h"
 #include "mediapipe/framework/counter_factory.h"
 #include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/frame_deadlines.h"
 #include "mediapipe/framework/graph_output_stream.h"
 #include "mediapipe/framework/graph_service.h"
 #include "mediapipe/framework/graph_service_manager.h"
 #include "mediapipe/framework/mediapipe_profiling.h"
+#include "mediapipe/framework/memory_budget.h"
+#include "mediapipe/framework/metrics_sink.h"
 #include "mediapipe/framework/output_side_packet_impl.h"
 #include "mediapipe/framework/output_stream.h"
 #include "mediapipe/framework/output_stream_manager.h"
@@ -144,6 +150,14 @@ class CalculatorGraph {
       const std::string& graph_type = "",
       const Subgraph::SubgraphOptions* options = nullptr);
 
+  // Initializes the CalculatorGraph from a config that was expanded and
+  // validated ahead of time, see ValidatedGraphConfig::ToExpandedConfig().
+  // This skips subgraph and template expansion, which makes it faster than
+  // Initialize(CalculatorGraphConfig) for large graphs.
+  absl::Status Initialize(
+      const ExpandedGraphConfig& expanded_config,
+      const std::map<std::string, Packet>& side_packets = {});
+
   // Returns the canonicalized CalculatorGraphConfig for this graph.
   const CalculatorGraphConfig& Config() const {
     return validated_graph_->Config();
@@ -158,6 +172,16 @@ class CalculatorGraph {
       std::function<absl::Status(const Packet&)> packet_callback,
       bool observe_timestamp_bounds = false);
 
+  // Like ObserveOutputStream(), but packets_callback receives all the packets
+  // that are available when the stream is notified in a single call, in
+  // timestamp order, instead of one call per packet. Timestamp bound updates
+  // are delivered as single empty packets. Can only be called before Run() or
+  // StartRun().
+  absl::Status ObserveOutputStreamBatches(
+      const std::string& stream_name,
+      std::function<absl::Status(const std::vector<Packet>&)> packets_callback,
+      bool observe_timestamp_bounds = false);
+
   // Adds an OutputStreamPoller for a stream. This provides a synchronous,
   // polling API for accessing a stream's output. Should only be called before
   // Run() or StartRun(). For asynchronous output, use ObserveOutputStream. See
@@ -257,6 +281,31 @@ class CalculatorGraph {
   absl::Status AddPacketToInputStream(const std::string& stream_name,
                                       Packet&& packet);
 
+  // Same as AddPacketToInputStream, and also sets the deadline of the packet
+  // timestamp. Once the deadline has passed, the nodes that set
+  // drop_expired_input in their config skip their input sets at that
+  // timestamp instead of calling Process(). The deadline applies to the
+  // packets of all the streams at that timestamp, and the earliest deadline
+  // set for a timestamp is used.
+  absl::Status AddPacketToInputStream(const std::string& stream_name,
+                                      Packet packet, absl::Time deadline);
+
+  // Adds a batch of packets to one or more graph input streams. The
+  // throttling check of the graph input stream add mode is done once for all
+  // the affected streams, the packets of each stream are delivered to its
+  // consumers together, and the scheduler is notified once for the whole
+  // batch. The packets of each stream must be in increasing timestamp order,
+  // and the queue sizes may exceed max_queue_size by up to the batch size.
+  // If an affected stream is throttled (with ADD_IF_NOT_FULL) or a stream is
+  // not a graph input stream, an error is returned and nothing is added.
+  absl::Status AddPacketsToInputStreams(
+      absl::Span<const std::pair<std::string, Packet>> packets);
+
+  // Same as AddPacketsToInputStreams, for packets of a single graph input
+  // stream.
+  absl::Status AddPacketsToInputStream(const std::string& stream_name,
+                                       absl::Span<const Packet> packets);
+
   // Sets the queue size of a graph input stream, overriding the graph default.
   absl::Status SetInputStreamMaxQueueSize(const std::string& stream_name,
                                           int max_queue_size);
@@ -298,6 +347,15 @@ class CalculatorGraph {
   }
   CounterFactory* GetCounterFactory() { return counter_factory_.get(); }
 
+  // Reports the counters of the graph, the Process() runtime histogram of
+  // each node, the size of each input stream queue, the reuse of pooled
+  // packet memory, and the usage of the MemoryBudget, if any, to "sink". The
+  // runtime histograms cover the time since the profile was last captured,
+  // see GraphProfiler::CaptureProfile, and are reported only if the profiler
+  // is enabled. May be called at any time after the graph has been
+  // initialized.
+  absl::Status ExportMetrics(MetricsSink* sink);
+
   // Callback when an error is encountered.
   // Adds the error to the vector of errors.
   void RecordError(const absl::Status& error) ABSL_LOCKS_EXCLUDED(error_mutex_);
@@ -449,6 +507,31 @@ class CalculatorGraph {
   absl::Status AddPacketToInputStreamInternal(const std::string& stream_name,
                                               T&& packet);
 
+  // The packets of a batch that go to one graph input stream.
+  struct GraphInputStreamBatch {
+    GraphInputStream* stream = nullptr;
+    int node_id = -1;
+    std::vector<const Packet*> packets;
+  };
+
+  // Looks up the graph input stream |stream_name| for AddPacketsToInputStreams
+  // and returns its entry in |batches|, adding one if needed.
+  absl::StatusOr<GraphInputStreamBatch*> FindOrAddInputStreamBatch(
+      const std::string& stream_name,
+      std::vector<GraphInputStreamBatch>* batches);
+
+  // Adds the packets of |batches| to their graph input streams. Implements
+  // AddPacketsToInputStreams and AddPacketsToInputStream.
+  absl::Status AddPacketBatchesToInputStreams(
+      const std::vector<GraphInputStreamBatch>& batches);
+
+  // Returns an error if the packets for the graph input streams of the virtual
+  // nodes |node_ids| cannot be added, based on the graph input stream add
+  // mode. In the WAIT_TILL_NOT_FULL mode, blocks until none of the streams is
+  // throttled.
+  absl::Status WaitUntilGraphInputStreamsAccept(absl::Span<const int> node_ids)
+      ABSL_LOCKS_EXCLUDED(full_input_streams_mutex_);
+
   // Sets the executor that will run the nodes assigned to the executor
   // named |name|.  If |name| is empty, this sets the default executor.
   // Does not check that the graph is uninitialized and |name| is not a
@@ -471,6 +554,13 @@ class CalculatorGraph {
       const ThreadPoolExecutorOptions* default_executor_options,
       int num_threads);
 
+  // Attaches the executor described by executor_config to the process-wide
+  // shared executor named executor_config.shared_name(), creating it if
+  // needed, and reports its usage through the profiler.
+  //
+  // Only called by InitializeExecutors().
+  absl::Status AttachSharedExecutor(const ExecutorConfig& executor_config);
+
   // Returns true if |name| is a reserved executor name.
   static bool IsReservedExecutorName(const std::string& name);
 
@@ -494,8 +584,31 @@ class CalculatorGraph {
 
   absl::Status PrepareServices();
 
+  // Counts the queued packets against the MemoryBudget of
+  // kMemoryBudgetService, if any, and throttles the graph input streams while
+  // the budget is exceeded.
+  void PrepareMemoryBudget();
+
+  // Counts the memory budget as a throttled graph input stream in the
+  // scheduler while it is exceeded. Called when it goes over or under its
+  // limit.
+  void UpdateMemoryThrottle() ABSL_LOCKS_EXCLUDED(memory_budget_mutex_);
+
+  // Returns true if the graph input streams are throttled by the memory
+  // budget.
+  bool IsMemoryThrottled() const;
+
+  // With the CRITICAL_PATH scheduling policy and the profiler enabled,
+  // recomputes the scheduling priorities of the calculator nodes using the
+  // mean Process() times measured so far.
+  absl::Status UpdateSchedulingPriorities();
+
 #if !MEDIAPIPE_DISABLE_GPU
   absl::Status MaybeSetUpGpuServiceFromLegacySidePacket(Packet legacy_sp);
+  // If the "gpu_device" side packet is given and the graph needs GPU resources
+  // but has none yet, creates them on the requested device.
+  absl::Status MaybeSetUpGpuServiceForDevice(
+      const std::map<std::string, Packet>& side_packets);
   // Helper for PrepareForRun. If it returns a non-empty map, those packets
   // must be added to the existing side packets, replacing existing values
   // that have the same key.
@@ -535,6 +648,16 @@ class CalculatorGraph {
   // status before taking any action.
   void UpdateThrottledNodes(InputStreamManager* stream, bool* stream_was_full);
 
+  // Adjusts the limit of a node input stream that became full or non-full,
+  // when the queues are sized adaptively, and then calls
+  // UpdateThrottledNodes().
+  void UpdateAdaptiveQueueSize(InputStreamManager* stream,
+                               bool* stream_was_full);
+
+  // Reports the bytes queued in the input streams and nodes to the profiler,
+  // if they are counted. See ProfilerConfig::enable_queued_bytes.
+  void AddQueuedBytesProfileCallback();
+
 #if !MEDIAPIPE_DISABLE_GPU
   // Owns the legacy GpuSharedData if we need to create one for backwards
   // compatibility.
@@ -576,6 +699,10 @@ class CalculatorGraph {
   // restrict memory usage.
   int max_queue_size_ = -1;
 
+  // Sizes the node input stream queues if the graph config sets
+  // adaptive_queue. Shared with the profiler, which reports its state.
+  std::shared_ptr<internal::AdaptiveQueueSizer> adaptive_queue_sizer_;
+
   // Mode for adding packets to a graph input stream. Set to block until all
   // affected input streams are not full by default.
   GraphInputStreamAddMode graph_input_stream_add_mode_
@@ -634,6 +761,18 @@ class CalculatorGraph {
   // Mutex for full_input_streams_.
   mutable absl::Mutex full_input_streams_mutex_;
 
+  // The MemoryBudget of kMemoryBudgetService, and the id of the observer
+  // calling UpdateMemoryThrottle(), or -1 if the graph has no input streams.
+  std::shared_ptr<MemoryBudget> memory_budget_;
+  int memory_budget_observer_ = -1;
+  // Serializes the updates of the throttled graph input stream count of the
+  // scheduler for the memory budget.
+  absl::Mutex memory_budget_mutex_;
+  bool memory_throttled_ ABSL_GUARDED_BY(memory_budget_mutex_) = false;
+  // Set when the graph is idle over the memory budget, to let one packet into
+  // the graph input streams. Nothing else in an idle graph can free memory.
+  std::atomic<bool> memory_budget_bypass_{false};
+
   // Number of closed graph input streams. This is a separate variable because
   // it is not safe to hold a lock on the scheduler while calling Close() on an
   // input stream. Hence, we decouple the closing of the stream and checking its
@@ -641,6 +780,11 @@ class CalculatorGraph {
   // TODO: update this comment.
   std::atomic<unsigned int> num_closed_graph_input_streams_;
 
+  // The deadlines set by AddPacketToInputStream, checked by the nodes that
+  // drop expired input. It is declared before the Scheduler so that it
+  // remains available while the nodes run.
+  internal::FrameDeadlines frame_deadlines_;
+
   // The graph tracing and profiling interface.  It is owned by the
   // CalculatorGraph using a shared_ptr in order to allow threadsafe access
   // to the ProfilingContext from clients that may outlive the CalculatorGraph
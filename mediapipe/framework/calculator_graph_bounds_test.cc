@@ -1585,5 +1585,92 @@ TEST(CalculatorGraphBoundsTest, EmptyPacketOutput) {
   MP_ASSERT_OK(graph.WaitUntilDone());
 }
 
+// Sends each input packet on all of its output streams.
+class FanOutCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).Set<int>();
+    for (int i = 0; i < cc->Outputs().NumEntries(); ++i) {
+      cc->Outputs().Index(i).SetSameAs(&cc->Inputs().Index(0));
+    }
+    return absl::OkStatus();
+  }
+  absl::Status Process(CalculatorContext* cc) final {
+    for (int i = 0; i < cc->Outputs().NumEntries(); ++i) {
+      cc->Outputs().Index(i).AddPacket(cc->Inputs().Index(0).Value());
+    }
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(FanOutCalculator);
+
+// Outputs the number of non-empty input packets of each invocation.
+class CountInputsCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    for (int i = 0; i < cc->Inputs().NumEntries(); ++i) {
+      cc->Inputs().Index(i).SetAny();
+    }
+    cc->Outputs().Index(0).Set<int>();
+    return absl::OkStatus();
+  }
+  absl::Status Process(CalculatorContext* cc) final {
+    int count = 0;
+    for (int i = 0; i < cc->Inputs().NumEntries(); ++i) {
+      count += !cc->Inputs().Index(i).IsEmpty();
+    }
+    cc->Outputs().Index(0).AddPacket(
+        MakePacket<int>(count).At(cc->InputTimestamp()));
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(CountInputsCalculator);
+
+// Shows that a node is notified once for all the outputs of an upstream
+// invocation: with the ImmediateInputStreamHandler, which runs a node as soon
+// as any input changes, the node sees the packets of all three streams at once.
+TEST(CalculatorGraphBoundsTest, OneNotificationPerUpstreamInvocation) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input"
+        node {
+          calculator: "FanOutCalculator"
+          input_stream: "input"
+          output_stream: "a"
+          output_stream: "b"
+          output_stream: "c"
+        }
+        node {
+          calculator: "CountInputsCalculator"
+          input_stream: "a"
+          input_stream: "b"
+          input_stream: "c"
+          output_stream: "count"
+          input_stream_handler {
+            input_stream_handler: "ImmediateInputStreamHandler"
+          }
+        }
+      )pb");
+  CalculatorGraph graph;
+  std::vector<Packet> count_packets;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.ObserveOutputStream("count", [&](const Packet& p) {
+    count_packets.push_back(p);
+    return absl::OkStatus();
+  }));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < 10; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "input", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllPacketSources());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(count_packets.size(), 10);
+  for (const Packet& packet : count_packets) {
+    EXPECT_EQ(packet.Get<int>(), 3) << packet.Timestamp();
+  }
+}
+
 }  // namespace
 }  // namespace mediapipe
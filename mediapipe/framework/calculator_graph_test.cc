@@ -40,6 +40,7 @@
 #include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/input_stream_handler.h"
 #include "mediapipe/framework/lifetime_tracker.h"
+#include "mediapipe/framework/memory_budget.h"
 #include "mediapipe/framework/mediapipe_options.pb.h"
 #include "mediapipe/framework/output_stream_poller.h"
 #include "mediapipe/framework/packet_set.h"
@@ -948,6 +949,38 @@ class SemaphoreCalculator : public CalculatorBase {
 };
 REGISTER_CALCULATOR(SemaphoreCalculator);
 
+// This calculator counts its Open() call in a counter shared with other nodes,
+// and waits in Open() until the counter reaches the number of nodes that are
+// expected to be opened at the same time.
+class RendezvousOpenCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Index(0));
+    cc->InputSidePackets().Index(0).Set<std::atomic<int>*>();
+    cc->InputSidePackets().Index(1).Set<int>();
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    auto* counter = cc->InputSidePackets().Index(0).Get<std::atomic<int>*>();
+    const int expected = cc->InputSidePackets().Index(1).Get<int>();
+    ++*counter;
+    absl::Time deadline = absl::Now() + absl::Seconds(10);
+    while (counter->load() < expected) {
+      RET_CHECK(absl::Now() < deadline) << "Open() calls did not overlap.";
+      absl::SleepFor(absl::Milliseconds(1));
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(RendezvousOpenCalculator);
+
 // A calculator that has no input streams and output streams, runs only once,
 // and takes 20 milliseconds to run.
 class OneShot20MsCalculator : public CalculatorBase {
@@ -1573,6 +1606,340 @@ TEST(CalculatorGraph, RunsCorrectlyWithMultipleExecutors) {
   RunComprehensiveTest(&graph, proto, /*define_node_5=*/true);
 }
 
+TEST(CalculatorGraph, RunsCorrectlyWithWorkStealingExecutors) {
+  CalculatorGraph graph;
+  // The default executor uses work stealing through its options, and the
+  // executor "second" is created by its registered type.
+  CalculatorGraphConfig proto = GetConfig();
+  ExecutorConfig* executor = proto.add_executor();
+  MediaPipeOptions* options = executor->mutable_options();
+  ThreadPoolExecutorOptions* extension =
+      options->MutableExtension(ThreadPoolExecutorOptions::ext);
+  extension->set_use_work_stealing(true);
+  executor = proto.add_executor();
+  executor->set_name("second");
+  executor->set_type("WorkStealingExecutor");
+  options = executor->mutable_options();
+  extension = options->MutableExtension(ThreadPoolExecutorOptions::ext);
+  extension->set_num_threads(2);
+  for (int i = 0; i < proto.node_size(); ++i) {
+    if (i % 2 == 1) {
+      proto.mutable_node(i)->set_executor("second");
+    }
+  }
+  RunComprehensiveTest(&graph, proto, /*define_node_5=*/true);
+}
+
+// Runs a graph in which "a" feeds a long branch (b1, b2, out) and a short
+// branch (log) on a single thread, and returns the order in which the first
+// nodes of the two branches ran.
+std::vector<std::string> RunBranchingGraph(
+    CalculatorGraphConfig::SchedulingPolicy policy) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in'
+        num_threads: 1
+        node {
+          calculator: 'SquareIntCalculator'
+          input_stream: 'in'
+          output_stream: 'a'
+        }
+        node {
+          calculator: 'SquareIntCalculator'
+          input_stream: 'a'
+          output_stream: 'b1'
+        }
+        node {
+          calculator: 'SquareIntCalculator'
+          input_stream: 'b1'
+          output_stream: 'b2'
+        }
+        node {
+          calculator: 'SquareIntCalculator'
+          input_stream: 'b2'
+          output_stream: 'out'
+        }
+        node {
+          calculator: 'SquareIntCalculator'
+          input_stream: 'a'
+          output_stream: 'log'
+        }
+      )pb");
+  config.set_scheduling_policy(policy);
+  CalculatorGraph graph;
+  MP_EXPECT_OK(graph.Initialize(config));
+  absl::Mutex mutex;
+  std::vector<std::string> order;
+  for (const std::string& stream : {"b1", "log"}) {
+    MP_EXPECT_OK(graph.ObserveOutputStream(
+        stream, [&mutex, &order, stream](const Packet& packet) {
+          absl::MutexLock lock(&mutex);
+          order.push_back(stream);
+          return absl::OkStatus();
+        }));
+  }
+  MP_EXPECT_OK(graph.StartRun({}));
+  MP_EXPECT_OK(
+      graph.AddPacketToInputStream("in", MakePacket<int>(1).At(Timestamp(0))));
+  MP_EXPECT_OK(graph.CloseAllInputStreams());
+  MP_EXPECT_OK(graph.WaitUntilDone());
+  return order;
+}
+
+TEST(CalculatorGraph, DefaultSchedulingRunsLaterNodesFirst) {
+  EXPECT_THAT(RunBranchingGraph(CalculatorGraphConfig::DEFAULT_SCHEDULING),
+              testing::ElementsAre("log", "b1"));
+}
+
+TEST(CalculatorGraph, CriticalPathSchedulingRunsLongerBranchFirst) {
+  EXPECT_THAT(RunBranchingGraph(CalculatorGraphConfig::CRITICAL_PATH),
+              testing::ElementsAre("b1", "log"));
+}
+
+// Outputs the pthread id of the thread that runs Process.
+class PthreadSelfCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->Outputs().Index(0).Set<pthread_t>();
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    cc->Outputs().Index(0).AddPacket(
+        MakePacket<pthread_t>(pthread_self()).At(cc->InputTimestamp()));
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(PthreadSelfCalculator);
+
+// A PthreadSelfCalculator that can run inline.
+class InlinePthreadSelfCalculator : public PthreadSelfCalculator {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    MP_RETURN_IF_ERROR(PthreadSelfCalculator::GetContract(cc));
+    cc->SetInlineable(true);
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(InlinePthreadSelfCalculator);
+
+// Runs a graph in which "InlinePthreadSelfCalculator" consumes the output of
+// "PthreadSelfCalculator", and returns true if both nodes ran on the same
+// thread for every input packet.
+bool RunsOnUpstreamThread(CalculatorGraphConfig config) {
+  std::vector<Packet> upstream_threads;
+  std::vector<Packet> inline_threads;
+  tool::AddVectorSink("upstream_thread", &config, &upstream_threads);
+  tool::AddVectorSink("inline_thread", &config, &inline_threads);
+  CalculatorGraph graph;
+  MP_EXPECT_OK(graph.Initialize(config));
+  MP_EXPECT_OK(graph.StartRun({}));
+  for (int i = 0; i < 20; ++i) {
+    MP_EXPECT_OK(graph.AddPacketToInputStream(
+        "in", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_EXPECT_OK(graph.CloseAllInputStreams());
+  MP_EXPECT_OK(graph.WaitUntilDone());
+  EXPECT_EQ(upstream_threads.size(), 20);
+  EXPECT_EQ(inline_threads.size(), 20);
+  for (int i = 0; i < upstream_threads.size() && i < inline_threads.size();
+       ++i) {
+    if (!pthread_equal(upstream_threads[i].Get<pthread_t>(),
+                       inline_threads[i].Get<pthread_t>())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Runs a graph in which "a" feeds "b" (a PassThroughCalculator, which is
+// inlineable) and "c" on a single thread, and returns the order in which "b"
+// and "c" produced their outputs.
+std::vector<std::string> RunInlineOrderGraph(int pass_through_max_in_flight) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in'
+        num_threads: 1
+        node {
+          calculator: 'SquareIntCalculator'
+          input_stream: 'in'
+          output_stream: 'a'
+        }
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'a'
+          output_stream: 'b'
+        }
+        node {
+          calculator: 'SquareIntCalculator'
+          input_stream: 'a'
+          output_stream: 'c'
+        }
+      )pb");
+  config.mutable_node(1)->set_max_in_flight(pass_through_max_in_flight);
+  CalculatorGraph graph;
+  MP_EXPECT_OK(graph.Initialize(config));
+  absl::Mutex mutex;
+  std::vector<std::string> order;
+  for (const std::string& stream : {"b", "c"}) {
+    MP_EXPECT_OK(graph.ObserveOutputStream(
+        stream, [&mutex, &order, stream](const Packet& packet) {
+          absl::MutexLock lock(&mutex);
+          order.push_back(stream);
+          return absl::OkStatus();
+        }));
+  }
+  MP_EXPECT_OK(graph.StartRun({}));
+  MP_EXPECT_OK(
+      graph.AddPacketToInputStream("in", MakePacket<int>(2).At(Timestamp(0))));
+  MP_EXPECT_OK(graph.CloseAllInputStreams());
+  MP_EXPECT_OK(graph.WaitUntilDone());
+  return order;
+}
+
+// "b" runs inline while "a" delivers its output, before "c" is even queued.
+TEST(CalculatorGraph, InlineableNodeRunsOnDeliveringThread) {
+  EXPECT_THAT(RunInlineOrderGraph(1), testing::ElementsAre("b", "c"));
+}
+
+// With max_in_flight > 1, "b" is queued, and "c", with the higher node id,
+// runs first.
+TEST(CalculatorGraph, InlineableNodeWithMaxInFlightIsQueued) {
+  EXPECT_THAT(RunInlineOrderGraph(2), testing::ElementsAre("c", "b"));
+}
+
+TEST(CalculatorGraph, InlineableNodeStaysOnItsExecutor) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in'
+        executor {
+          name: 'other'
+          type: 'ThreadPoolExecutor'
+          options {
+            [mediapipe.ThreadPoolExecutorOptions.ext] { num_threads: 1 }
+          }
+        }
+        node {
+          calculator: 'PthreadSelfCalculator'
+          input_stream: 'in'
+          output_stream: 'upstream_thread'
+        }
+        node {
+          calculator: 'InlinePthreadSelfCalculator'
+          input_stream: 'upstream_thread'
+          output_stream: 'inline_thread'
+          executor: 'other'
+        }
+      )pb");
+  EXPECT_FALSE(RunsOnUpstreamThread(config));
+}
+
+// A chain of inlineable nodes longer than the inline nesting limit delivers
+// every packet in order.
+TEST(CalculatorGraph, LongInlineChainDeliversAllPackets) {
+  CalculatorGraphConfig config;
+  config.add_input_stream("in");
+  std::string input = "in";
+  for (int i = 0; i < 40; ++i) {
+    CalculatorGraphConfig::Node* node = config.add_node();
+    node->set_calculator("PassThroughCalculator");
+    node->add_input_stream(input);
+    input = absl::StrCat("stream_", i);
+    node->add_output_stream(input);
+  }
+  std::vector<Packet> outputs;
+  tool::AddVectorSink(input, &config, &outputs);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < 20; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "in", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  ASSERT_EQ(outputs.size(), 20);
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_EQ(outputs[i].Get<int>(), i);
+    EXPECT_EQ(outputs[i].Timestamp(), Timestamp(i));
+  }
+}
+
+// Passes its input through and appends its node name to a global log.
+class LogProcessCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Index(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    {
+      absl::MutexLock lock(&mutex_);
+      log_->push_back(cc->NodeName());
+    }
+    cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
+    return absl::OkStatus();
+  }
+
+  static absl::Mutex mutex_;
+  static std::vector<std::string>* log_;
+};
+absl::Mutex LogProcessCalculator::mutex_;
+std::vector<std::string>* LogProcessCalculator::log_ = nullptr;
+REGISTER_CALCULATOR(LogProcessCalculator);
+
+// Runs the chain "a" -> "b" on a single thread with the critical-path policy,
+// which prefers "a" over "b" when both are queued, and returns the order of
+// their Process calls.
+std::vector<std::string> RunChain(bool fuse_calculator_chains) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        num_threads: 1
+        scheduling_policy: CRITICAL_PATH
+        node {
+          calculator: 'OutputAllSourceCalculator'
+          output_stream: 'src'
+        }
+        node {
+          name: 'a'
+          calculator: 'LogProcessCalculator'
+          input_stream: 'src'
+          output_stream: 'a'
+        }
+        node {
+          name: 'b'
+          calculator: 'LogProcessCalculator'
+          input_stream: 'a'
+          output_stream: 'b'
+        }
+      )pb");
+  config.set_fuse_calculator_chains(fuse_calculator_chains);
+  std::vector<std::string> log;
+  LogProcessCalculator::log_ = &log;
+  CalculatorGraph graph;
+  MP_EXPECT_OK(graph.Initialize(config));
+  MP_EXPECT_OK(graph.Run());
+  LogProcessCalculator::log_ = nullptr;
+  return log;
+}
+
+TEST(CalculatorGraph, UnfusedChainRunsByPriority) {
+  std::vector<std::string> log = RunChain(false);
+  ASSERT_EQ(log.size(), 2 * OutputAllSourceCalculator::kNumOutputPackets);
+  EXPECT_THAT(std::vector<std::string>(log.begin(), log.begin() + 4),
+              testing::ElementsAre("a", "a", "a", "a"));
+}
+
+TEST(CalculatorGraph, FusedChainRunsBackToBack) {
+  std::vector<std::string> log = RunChain(true);
+  ASSERT_EQ(log.size(), 2 * OutputAllSourceCalculator::kNumOutputPackets);
+  EXPECT_THAT(std::vector<std::string>(log.begin(), log.begin() + 4),
+              testing::ElementsAre("a", "b", "a", "b"));
+}
+
 // Packet generator for an arbitrary unit64 packet.
 class Uint64PacketGenerator : public PacketGenerator {
  public:
@@ -3430,6 +3797,275 @@ TEST(CalculatorGraph, AddPacketNoBusyLoop) {
   }
 }
 
+TEST(CalculatorGraph, AddPacketsToInputStreams) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in_a'
+        input_stream: 'in_b'
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'in_a'
+          input_stream: 'in_b'
+          output_stream: 'out_a'
+          output_stream: 'out_b'
+        }
+      )pb");
+  std::vector<Packet> out_a;
+  std::vector<Packet> out_b;
+  tool::AddVectorSink("out_a", &config, &out_a);
+  tool::AddVectorSink("out_b", &config, &out_b);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  const std::vector<std::pair<std::string, Packet>> batch = {
+      {"in_a", MakePacket<int>(0).At(Timestamp(0))},
+      {"in_b", MakePacket<int>(10).At(Timestamp(0))},
+      {"in_a", MakePacket<int>(1).At(Timestamp(1))},
+      {"in_a", MakePacket<int>(2).At(Timestamp(2))},
+  };
+  MP_EXPECT_OK(graph.AddPacketsToInputStreams(batch));
+  MP_EXPECT_OK(graph.AddPacketsToInputStream(
+      "in_b", {MakePacket<int>(11).At(Timestamp(1)),
+               MakePacket<int>(12).At(Timestamp(2))}));
+  MP_EXPECT_OK(graph.AddPacketsToInputStream("in_b", {}));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  ASSERT_EQ(out_a.size(), 3);
+  ASSERT_EQ(out_b.size(), 3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(out_a[i].Get<int>(), i);
+    EXPECT_EQ(out_b[i].Get<int>(), 10 + i);
+    EXPECT_EQ(out_a[i].Timestamp(), Timestamp(i));
+    EXPECT_EQ(out_b[i].Timestamp(), Timestamp(i));
+  }
+}
+
+TEST(CalculatorGraph, AddPacketsToInputStreamsAddsNothingOnError) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in'
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'in'
+          output_stream: 'out'
+        }
+      )pb");
+  std::vector<Packet> out;
+  tool::AddVectorSink("out", &config, &out);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  EXPECT_FALSE(graph
+                   .AddPacketsToInputStream(
+                       "in", {MakePacket<int>(0).At(Timestamp(0))})
+                   .ok());
+  MP_ASSERT_OK(graph.StartRun({}));
+  const std::vector<std::pair<std::string, Packet>> batch = {
+      {"in", MakePacket<int>(0).At(Timestamp(0))},
+      {"unknown", MakePacket<int>(1).At(Timestamp(0))},
+  };
+  EXPECT_FALSE(graph.AddPacketsToInputStreams(batch).ok());
+  // The packet for "in" was not added, so timestamp 0 can still be used.
+  MP_EXPECT_OK(
+      graph.AddPacketToInputStream("in", MakePacket<int>(2).At(Timestamp(0))));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  ASSERT_EQ(out.size(), 1);
+  EXPECT_EQ(out[0].Get<int>(), 2);
+}
+
+TEST(CalculatorGraph, AddPacketsToInputStreamsWhenThrottled) {
+  using Semaphore = SemaphoreCalculator::Semaphore;
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in'
+        input_stream: 'other'
+        max_queue_size: 1
+        node {
+          calculator: 'SemaphoreCalculator'
+          input_stream: 'in'
+          output_stream: 'out'
+          input_side_packet: 'POST_SEM:post_sem'
+          input_side_packet: 'WAIT_SEM:wait_sem'
+        }
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'other'
+          output_stream: 'other_out'
+        }
+      )pb");
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  graph.SetGraphInputStreamAddMode(
+      CalculatorGraph::GraphInputStreamAddMode::ADD_IF_NOT_FULL);
+  Semaphore calc_entered_process(0);
+  Semaphore calc_can_exit_process(0);
+  MP_ASSERT_OK(graph.StartRun({
+      {"post_sem", MakePacket<Semaphore*>(&calc_entered_process)},
+      {"wait_sem", MakePacket<Semaphore*>(&calc_can_exit_process)},
+  }));
+  // While the calculator is stuck processing the first packet, the second one
+  // fills up "in" and the graph cannot resolve the throttling as a deadlock.
+  MP_EXPECT_OK(graph.AddPacketsToInputStream(
+      "in", {MakePacket<int>(0).At(Timestamp(0))}));
+  calc_entered_process.Acquire(1);
+  MP_EXPECT_OK(graph.AddPacketsToInputStream(
+      "in", {MakePacket<int>(1).At(Timestamp(1))}));
+  const std::vector<std::pair<std::string, Packet>> batch = {
+      {"other", MakePacket<int>(0).At(Timestamp(0))},
+      {"in", MakePacket<int>(2).At(Timestamp(2))},
+  };
+  EXPECT_EQ(graph.AddPacketsToInputStreams(batch).code(),
+            absl::StatusCode::kUnavailable);
+  // A batch that only touches the unthrottled stream is accepted.
+  MP_EXPECT_OK(graph.AddPacketsToInputStream(
+      "other", {MakePacket<int>(0).At(Timestamp(0))}));
+  calc_can_exit_process.Release(2);
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+// Over the memory budget, the graph input streams are throttled, except for one
+// packet at a time while the graph is idle.
+TEST(CalculatorGraph, ThrottlesGraphInputStreamsOverMemoryBudget) {
+  using Semaphore = SemaphoreCalculator::Semaphore;
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in'
+        node {
+          calculator: 'SemaphoreCalculator'
+          input_stream: 'in'
+          output_stream: 'out'
+          input_side_packet: 'POST_SEM:post_sem'
+          input_side_packet: 'WAIT_SEM:wait_sem'
+        }
+      )pb");
+  std::vector<Packet> out;
+  tool::AddVectorSink("out", &config, &out);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  graph.SetGraphInputStreamAddMode(
+      CalculatorGraph::GraphInputStreamAddMode::ADD_IF_NOT_FULL);
+  auto budget = std::make_shared<MemoryBudget>(100);
+  MP_ASSERT_OK(graph.SetServiceObject(kMemoryBudgetService, budget));
+  budget->Add(200);
+  Semaphore calc_entered_process(0);
+  Semaphore calc_can_exit_process(0);
+  MP_ASSERT_OK(graph.StartRun({
+      {"post_sem", MakePacket<Semaphore*>(&calc_entered_process)},
+      {"wait_sem", MakePacket<Semaphore*>(&calc_can_exit_process)},
+  }));
+  // The idle graph lets the first packet in.
+  MP_EXPECT_OK(
+      graph.AddPacketToInputStream("in", MakePacket<int>(0).At(Timestamp(0))));
+  calc_entered_process.Acquire(1);
+  EXPECT_EQ(
+      graph.AddPacketToInputStream("in", MakePacket<int>(1).At(Timestamp(1)))
+          .code(),
+      absl::StatusCode::kUnavailable);
+  calc_can_exit_process.Release(1);
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  MP_EXPECT_OK(
+      graph.AddPacketToInputStream("in", MakePacket<int>(2).At(Timestamp(2))));
+  calc_entered_process.Acquire(1);
+  budget->Add(-200);
+  MP_EXPECT_OK(
+      graph.AddPacketToInputStream("in", MakePacket<int>(3).At(Timestamp(3))));
+  calc_can_exit_process.Release(2);
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  EXPECT_EQ(out.size(), 3);
+  // Only the second packet found the graph throttled.
+  EXPECT_EQ(budget->GetStats().throttled_count, 1);
+}
+
+// Nodes that set drop_expired_input skip the timestamps whose deadline has
+// passed, and settle them for their downstream nodes.
+TEST(CalculatorGraph, DropsExpiredInputSets) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in'
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'in'
+          output_stream: 'mid'
+          drop_expired_input: true
+        }
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'in'
+          input_stream: 'mid'
+          output_stream: 'in_out'
+          output_stream: 'mid_out'
+        }
+      )pb");
+  std::vector<Packet> in_out;
+  std::vector<Packet> mid_out;
+  tool::AddVectorSink("in_out", &config, &in_out);
+  tool::AddVectorSink("mid_out", &config, &mid_out);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "in", MakePacket<int>(0).At(Timestamp(0)), absl::InfinitePast()));
+  // The second node does not wait for a later packet on "mid" to process
+  // timestamp 0, and it does not drop expired input itself.
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  ASSERT_EQ(in_out.size(), 1);
+  EXPECT_TRUE(mid_out.empty());
+
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "in", MakePacket<int>(1).At(Timestamp(1)), absl::InfiniteFuture()));
+  MP_ASSERT_OK(
+      graph.AddPacketToInputStream("in", MakePacket<int>(2).At(Timestamp(2))));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  ASSERT_EQ(in_out.size(), 3);
+  ASSERT_EQ(mid_out.size(), 2);
+  EXPECT_EQ(mid_out[0].Timestamp(), Timestamp(1));
+  EXPECT_EQ(mid_out[1].Timestamp(), Timestamp(2));
+}
+
+// With parallel_open, a node is opened without waiting for the Open() of the
+// node that feeds its input stream.
+TEST(CalculatorGraph, ParallelOpen) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        num_threads: 2
+        parallel_open: true
+        input_stream: 'in'
+        input_side_packet: 'counter'
+        input_side_packet: 'num_nodes'
+        node {
+          calculator: 'RendezvousOpenCalculator'
+          input_stream: 'in'
+          output_stream: 'mid'
+          input_side_packet: 'counter'
+          input_side_packet: 'num_nodes'
+        }
+        node {
+          calculator: 'RendezvousOpenCalculator'
+          input_stream: 'mid'
+          output_stream: 'out'
+          input_side_packet: 'counter'
+          input_side_packet: 'num_nodes'
+        }
+      )pb");
+  std::vector<Packet> out;
+  tool::AddVectorSink("out", &config, &out);
+  std::atomic<int> counter(0);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({{"counter", MakePacket<std::atomic<int>*>(
+                                               &counter)},
+                               {"num_nodes", MakePacket<int>(2)}}));
+  MP_ASSERT_OK(
+      graph.AddPacketToInputStream("in", MakePacket<int>(1).At(Timestamp(1))));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  ASSERT_EQ(out.size(), 1);
+  EXPECT_EQ(out[0].Get<int>(), 1);
+}
+
 namespace nested_ns {
 
 typedef std::function<absl::Status(const InputStreamShardSet&,
@@ -4474,6 +5110,111 @@ TEST(CalculatorGraph, TestOutputStreamPollerDesiredQueueSize) {
   }
 }
 
+TEST(CalculatorGraph, TestPollPacketBatches) {
+  CalculatorGraphConfig config;
+  CalculatorGraphConfig::Node* node = config.add_node();
+  node->set_calculator("CountingSourceCalculator");
+  node->add_output_stream("output");
+  node->add_input_side_packet("MAX_COUNT:max_count");
+
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK_AND_ASSIGN(OutputStreamPoller poller,
+                          graph.AddOutputStreamPoller("output"));
+  MP_ASSERT_OK(
+      graph.StartRun({{"max_count", MakePacket<int>(kDefaultMaxCount)}}));
+  std::vector<Packet> packets;
+  int num_packets = 0;
+  while (poller.NextBatch(&packets, 64)) {
+    ASSERT_FALSE(packets.empty());
+    ASSERT_LE(packets.size(), 64);
+    for (const Packet& packet : packets) {
+      EXPECT_EQ(num_packets, packet.Get<int>());
+      ++num_packets;
+    }
+    packets.clear();
+  }
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  EXPECT_FALSE(poller.NextBatch(&packets, 64));
+  EXPECT_TRUE(packets.empty());
+  EXPECT_EQ(kDefaultMaxCount, num_packets);
+}
+
+TEST(CalculatorGraph, TestTryPollPacketBatches) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in'
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'in'
+          output_stream: 'out'
+        }
+      )pb");
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK_AND_ASSIGN(OutputStreamPoller poller,
+                          graph.AddOutputStreamPoller("out"));
+  MP_ASSERT_OK(graph.StartRun({}));
+  std::vector<Packet> packets;
+  EXPECT_TRUE(poller.TryNextBatch(&packets, 10));
+  EXPECT_TRUE(packets.empty());
+
+  for (int i = 0; i < 3; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "in", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  EXPECT_TRUE(poller.TryNextBatch(&packets, 2));
+  ASSERT_EQ(packets.size(), 2);
+  EXPECT_TRUE(poller.TryNextBatch(&packets, 10));
+  ASSERT_EQ(packets.size(), 3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(packets[i].Get<int>(), i);
+    EXPECT_EQ(packets[i].Timestamp(), Timestamp(i));
+  }
+
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  EXPECT_FALSE(poller.TryNextBatch(&packets, 10));
+  EXPECT_EQ(packets.size(), 3);
+}
+
+// Packets that are emitted together are observed in a single callback.
+TEST(CalculatorGraph, ObserveOutputStreamBatches) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_side_packet: 'max_count'
+        input_side_packet: 'batch_size'
+        node {
+          calculator: 'CountingSourceCalculator'
+          output_stream: 'output'
+          input_side_packet: 'MAX_COUNT:max_count'
+          input_side_packet: 'BATCH_SIZE:batch_size'
+        }
+      )pb");
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  std::vector<int> batch_sizes;
+  std::vector<int> values;
+  MP_ASSERT_OK(graph.ObserveOutputStreamBatches(
+      "output", [&](const std::vector<Packet>& packets) {
+        batch_sizes.push_back(packets.size());
+        for (const Packet& packet : packets) {
+          values.push_back(packet.Get<int>());
+        }
+        return absl::OkStatus();
+      }));
+  MP_ASSERT_OK(graph.Run({{"max_count", MakePacket<int>(10)},
+                          {"batch_size", MakePacket<int>(5)}}));
+  ASSERT_EQ(values.size(), 50);
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_EQ(values[i], i);
+  }
+  for (int batch_size : batch_sizes) {
+    EXPECT_EQ(batch_size % 5, 0);
+  }
+}
+
 TEST(CalculatorGraph, TestPollPacketsFromMultipleStreams) {
   CalculatorGraphConfig config;
   CalculatorGraphConfig::Node* node1 = config.add_node();
@@ -26,6 +26,7 @@
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_base.h"
 #include "mediapipe/framework/counter_factory.h"
@@ -147,10 +148,17 @@ absl::Status CalculatorNode::Initialize(
 
   max_in_flight_ = node_config->max_in_flight();
   max_in_flight_ = max_in_flight_ ? max_in_flight_ : 1;
+  drop_expired_input_ = node_config->drop_expired_input();
+  open_without_headers_ = validated_graph_->Config().parallel_open();
   if (!node_config->executor().empty()) {
     executor_ = node_config->executor();
   }
   source_layer_ = node_config->source_layer();
+  if (node_ref.type == NodeTypeInfo::NodeType::CALCULATOR &&
+      validated_graph_->Config().scheduling_policy() ==
+          CalculatorGraphConfig::CRITICAL_PATH) {
+    scheduling_priority_ = node_type_info_->CriticalPathLength();
+  }
 
   const CalculatorContract& contract = node_type_info_->Contract();
 
@@ -208,6 +216,15 @@ absl::Status CalculatorNode::Initialize(
   }
   input_stream_handler_->SetProcessTimestampBounds(
       contract.GetProcessTimestampBounds());
+  // Every node of a fused chain but the first runs inline.
+  const bool fused_with_upstream =
+      node_ref.type == NodeTypeInfo::NodeType::CALCULATOR &&
+      node_type_info_->FusedChainHead() >= 0 &&
+      node_type_info_->FusedChainHead() != node_ref.index;
+  runs_inline_ = (contract.GetInlineable() || fused_with_upstream) &&
+                 max_in_flight_ == 1 && !IsSource() &&
+                 !input_stream_handler_->LatePreparation();
+  process_async_ = contract.GetProcessAsync() && !IsSource();
 
   return InitializeInputStreams(input_stream_managers, output_stream_managers);
 }
@@ -273,6 +290,15 @@ absl::Status CalculatorNode::InitializeInputStreams(
       &input_stream_managers[node_type_info_->InputStreamBaseIndex()];
   MP_RETURN_IF_ERROR(input_stream_handler_->InitializeInputStreamManagers(
       current_input_stream_managers));
+  const ProfilerConfig& profiler_config =
+      validated_graph_->Config().profiler_config();
+  if (profiler_config.enable_profiler() &&
+      profiler_config.enable_queued_bytes()) {
+    queued_bytes_ = std::make_shared<QueuedBytesCounter>();
+    for (int i = 0; i < node_type_info_->InputStreamTypes().NumEntries(); ++i) {
+      current_input_stream_managers[i].EnableQueuedBytes(queued_bytes_);
+    }
+  }
 
   // Set all the mirrors.
   for (CollectionItemId id = node_type_info_->InputStreamTypes().BeginId();
@@ -389,6 +415,10 @@ absl::Status CalculatorNode::PrepareForRun(
       [this]() { CalculatorNode::InputStreamHeadersReady(); },
       [this]() { CalculatorNode::CheckIfBecameReady(); },
       std::move(schedule_callback), error_callback);
+  if (queued_bytes_) {
+    // The input streams are empty again.
+    queued_bytes_->ResetPeak();
+  }
   output_stream_handler_->PrepareForRun(error_callback);
 
   const auto& contract = Contract();
@@ -435,6 +465,7 @@ absl::Status CalculatorNode::PrepareForRun(
     input_stream_headers_ready_called_ = false;
     input_side_packets_ready_called_ = false;
     input_stream_headers_ready_ =
+        open_without_headers_ ||
         (input_stream_handler_->UnsetHeaderCount() == 0);
     input_side_packets_ready_ =
         (input_side_packet_handler_.MissingInputSidePacketCount() == 0);
@@ -474,6 +505,61 @@ bool CalculatorNode::OutputsAreConstant(CalculatorContext* cc) {
   return true;
 }
 
+void CalculatorNode::ProcessNodeAsync(CalculatorContext* calculator_context,
+                                      std::function<void(absl::Status)> done) {
+  const Timestamp input_timestamp = calculator_context->InputTimestamp();
+  if (!input_timestamp.IsAllowedInStream() ||
+      calculator_context_manager_.NumberOfContextTimestamps(
+          *calculator_context) != 1 ||
+      OutputsAreConstant(calculator_context) ||
+      InputSetHasExpired(input_timestamp)) {
+    done(ProcessNode(calculator_context));
+    return;
+  }
+  input_stream_handler_->FinalizeInputSet(input_timestamp,
+                                          &calculator_context->Inputs());
+  output_stream_handler_->PrepareOutputs(input_timestamp,
+                                         &calculator_context->Outputs());
+  VLOG(2) << "Calling Calculator::ProcessAsync() for node: " << DebugName()
+          << " timestamp: " << input_timestamp;
+  MEDIAPIPE_PROFILING(PROCESS, calculator_context);
+  LegacyCalculatorSupport::Scoped<CalculatorContext> s(calculator_context);
+  calculator_->ProcessAsync(
+      calculator_context, [this, calculator_context, input_timestamp,
+                           done = std::move(done)](absl::Status result) {
+        VLOG(2) << "Completed Calculator::ProcessAsync() for node: "
+                << DebugName() << " timestamp: " << input_timestamp;
+        done(FinishProcess(calculator_context, input_timestamp,
+                           std::move(result)));
+      });
+}
+
+absl::Status CalculatorNode::FinishProcess(
+    CalculatorContext* calculator_context, Timestamp input_timestamp,
+    absl::Status result) {
+  // Removes one packet from each shard and progresses to the next input
+  // timestamp.
+  input_stream_handler_->ClearCurrentInputs(calculator_context);
+
+  // Nodes are allowed to return StatusStop() to cause the termination of the
+  // graph. This is different from an error in that it will ensure that all
+  // sources will be closed and that packets in input streams will be processed
+  // before the graph is terminated.
+  if (!result.ok() && result != tool::StatusStop()) {
+    return mediapipe::StatusBuilder(result, MEDIAPIPE_LOC).SetPrepend()
+           << absl::Substitute(
+                  "Calculator::Process() for node \"$0\" failed: ",
+                  DebugName());
+  }
+  output_stream_handler_->PostProcess(input_timestamp);
+  return result;
+}
+
+bool CalculatorNode::InputSetHasExpired(Timestamp input_timestamp) const {
+  return drop_expired_input_ && frame_deadlines_ &&
+         frame_deadlines_->HasExpired(input_timestamp, absl::Now());
+}
+
 absl::Status CalculatorNode::OpenNode() {
   VLOG(2) << "CalculatorNode::OpenNode() for " << DebugName();
 
@@ -694,6 +780,11 @@ void CalculatorNode::InputStreamHeadersReady() {
   bool ready_for_open = false;
   {
     absl::MutexLock lock(&status_mutex_);
+    if (open_without_headers_) {
+      // The node was made ready for OpenNode() without its headers, and may
+      // already be open.
+      return;
+    }
     CHECK_EQ(status_, kStatePrepared) << DebugName();
     CHECK(!input_stream_headers_ready_called_);
     input_stream_headers_ready_called_ = true;
@@ -860,6 +951,20 @@ absl::Status CalculatorNode::ProcessNode(
         if (OutputsAreConstant(calculator_context)) {
           // Do nothing.
           result = absl::OkStatus();
+        } else if (InputSetHasExpired(input_timestamp)) {
+          VLOG(2) << "Dropping expired input set for node: " << DebugName()
+                  << " timestamp: " << input_timestamp;
+          // Settles the input timestamp for the downstream nodes, as
+          // Process() would have done by outputting packets.
+          for (CollectionItemId id = outputs->BeginId();
+               id != outputs->EndId(); ++id) {
+            outputs->Get(id).SetNextTimestampBound(
+                input_timestamp.NextAllowedInStream());
+          }
+          if (profiling_context_) {
+            profiling_context_->AddDroppedInputSet(*calculator_context);
+          }
+          result = absl::OkStatus();
         } else {
           MEDIAPIPE_PROFILING(PROCESS, calculator_context);
           LegacyCalculatorSupport::Scoped<CalculatorContext> s(
@@ -870,22 +975,9 @@ absl::Status CalculatorNode::ProcessNode(
         VLOG(2) << "Called Calculator::Process() for node: " << DebugName()
                 << " timestamp: " << input_timestamp;
 
-        // Removes one packet from each shard and progresses to the next input
-        // timestamp.
-        input_stream_handler_->ClearCurrentInputs(calculator_context);
-
-        // Nodes are allowed to return StatusStop() to cause the termination
-        // of the graph. This is different from an error in that it will
-        // ensure that all sources will be closed and that packets in input
-        // streams will be processed before the graph is terminated.
-        if (!result.ok() && result != tool::StatusStop()) {
-          return mediapipe::StatusBuilder(result, MEDIAPIPE_LOC).SetPrepend()
-                 << absl::Substitute(
-                        "Calculator::Process() for node \"$0\" failed: ",
-                        DebugName());
-        }
-        output_stream_handler_->PostProcess(input_timestamp);
-        if (result == tool::StatusStop()) {
+        result = FinishProcess(calculator_context, input_timestamp,
+                               std::move(result));
+        if (!result.ok()) {
           return result;
         }
       } else if (input_timestamp == Timestamp::Done()) {
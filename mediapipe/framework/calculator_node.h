@@ -34,12 +34,14 @@
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/calculator_context_manager.h"
 #include "mediapipe/framework/calculator_state.h"
+#include "mediapipe/framework/frame_deadlines.h"
 #include "mediapipe/framework/input_side_packet_handler.h"
 #include "mediapipe/framework/input_stream_handler.h"
 #include "mediapipe/framework/legacy_calculator_support.h"
 #include "mediapipe/framework/output_side_packet_impl.h"
 #include "mediapipe/framework/output_stream_handler.h"
 #include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/packet_payload_size.h"
 #include "mediapipe/framework/packet_set.h"
 #include "mediapipe/framework/packet_type.h"
 #include "mediapipe/framework/port.h"
@@ -98,6 +100,14 @@ class CalculatorNode {
   // Calls Process() on the Calculator corresponding to this node.
   absl::Status ProcessNode(CalculatorContext* calculator_context);
 
+  // Calls ProcessAsync() on the Calculator corresponding to this node, for
+  // nodes where ProcessesAsync() is true. "done" is called with the result of
+  // the invocation once the calculator has completed it, possibly on another
+  // thread. Closing the node and input sets that ProcessAsync() cannot handle
+  // go through ProcessNode(), and call "done" before returning.
+  void ProcessNodeAsync(CalculatorContext* calculator_context,
+                        std::function<void(absl::Status)> done);
+
   // Initializes the node.  The buffer_size_hint argument is
   // set to the value specified in the graph proto for this field.
   // input_stream_managers/output_stream_managers is expected to point to
@@ -162,6 +172,35 @@ class CalculatorNode {
 
   int source_layer() const { return source_layer_; }
 
+  // Returns the priority of the node among the ready non-source nodes of its
+  // SchedulerQueue. Nodes with higher priorities run first. All nodes have
+  // priority 0 unless the graph uses the CRITICAL_PATH scheduling policy, in
+  // which case the priority is the node's critical path length.
+  int64 scheduling_priority() const { return scheduling_priority_; }
+  // Must not be called while the graph is running.
+  void SetSchedulingPriority(int64 priority) {
+    scheduling_priority_ = priority;
+  }
+
+  // Returns true if the scheduler may run the node's Process synchronously on
+  // the thread that delivered its input. Set for non-source nodes whose
+  // calculator calls CalculatorContract::SetInlineable(true) or that follow
+  // another node in a fused chain (see NodeTypeInfo::FusedChainHead), that
+  // run at most one invocation at a time and whose input stream handler
+  // prepares the input set at scheduling time.
+  bool RunsInline() const { return runs_inline_; }
+
+  // Returns true if the scheduler should run the node through
+  // ProcessNodeAsync(). Set for non-source nodes whose calculator calls
+  // CalculatorContract::SetProcessAsync(true).
+  bool ProcessesAsync() const { return process_async_; }
+
+  // Returns the payload bytes queued in the input streams of the node, or
+  // nullptr unless ProfilerConfig::enable_queued_bytes is set.
+  std::shared_ptr<const QueuedBytesCounter> QueuedBytes() const {
+    return queued_bytes_;
+  }
+
   // Checks if the node can be scheduled; if so, increases current_in_flight_
   // and returns true; otherwise, returns false.
   // If true is returned, the scheduler must commit to executing the node, and
@@ -204,6 +243,12 @@ class CalculatorNode {
     scheduler_queue_ = queue;
   }
 
+  // Sets the deadlines that are checked before Process() when the node sets
+  // drop_expired_input. The deadlines must outlive the node.
+  void SetFrameDeadlines(const internal::FrameDeadlines* frame_deadlines) {
+    frame_deadlines_ = frame_deadlines;
+  }
+
   // Sets callbacks in the scheduler that should be invoked when an input queue
   // becomes full/non-full.
   void SetQueueSizeCallbacks(
@@ -286,6 +331,17 @@ class CalculatorNode {
   // Returns true if all outputs will be identical to the previous graph run.
   bool OutputsAreConstant(CalculatorContext* cc);
 
+  // Completes the invocation of Process() or ProcessAsync() for the input set
+  // at "input_timestamp", which returned "result": releases the inputs and
+  // propagates the outputs. Returns "result" with the node name prepended on
+  // errors.
+  absl::Status FinishProcess(CalculatorContext* calculator_context,
+                             Timestamp input_timestamp, absl::Status result);
+
+  // Returns true if the node skips the input set at "input_timestamp",
+  // because its deadline has passed.
+  bool InputSetHasExpired(Timestamp input_timestamp) const;
+
   // The calculator.
   std::unique_ptr<CalculatorBase> calculator_;
   // Keeps data which a Calculator subclass needs access to.
@@ -297,6 +353,8 @@ class CalculatorNode {
   std::string executor_;
   // The layer a source calculator operates on.
   int source_layer_ = 0;
+  // See scheduling_priority().
+  int64 scheduling_priority_ = 0;
   // The status of the current Calculator that this CalculatorNode
   // is wrapping.  kStateActive is currently used only for source nodes.
   enum NodeStatus {
@@ -310,6 +368,18 @@ class CalculatorNode {
 
   // The max number of invocations that can be scheduled in parallel.
   int max_in_flight_ = 1;
+  // See RunsInline().
+  bool runs_inline_ = false;
+  // See ProcessesAsync().
+  bool process_async_ = false;
+  // True if the node skips the input sets whose deadline has passed.
+  bool drop_expired_input_ = false;
+  // True if the node is ready for OpenNode() before its input stream headers
+  // are set, see CalculatorGraphConfig::parallel_open.
+  bool open_without_headers_ = false;
+  // The payload bytes queued in the input streams, if they are counted.
+  std::shared_ptr<QueuedBytesCounter> queued_bytes_;
+  const internal::FrameDeadlines* frame_deadlines_ = nullptr;
   // The following two variables are used for the concurrency control of node
   // scheduling.
   //
@@ -34,7 +34,7 @@ CalculatorState::CalculatorState(
       node_config_(node_config),
       profiling_context_(profiling_context),
       counter_factory_(nullptr) {
-  options_.Initialize(node_config);
+  options_.Initialize(node_config_);
   ResetBetweenRuns();
 }
 
@@ -16,6 +16,7 @@
 #define MEDIAPIPE_DEPS_REGISTRATION_H_
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <tuple>
@@ -169,6 +170,7 @@ class FunctionRegistry {
     }
     if (functions_.insert(std::make_pair(normalized_name, std::move(func)))
             .second) {
+      ++generation_;
       return RegistrationToken(
           [this, normalized_name]() { Unregister(normalized_name); });
     }
@@ -241,6 +243,14 @@ class FunctionRegistry {
     return names;
   }
 
+  // Returns a number that changes whenever a function is registered or
+  // unregistered, so that results derived from the registered functions can
+  // be invalidated.
+  int64_t generation() const ABSL_LOCKS_EXCLUDED(lock_) {
+    absl::ReaderMutexLock lock(&lock_);
+    return generation_;
+  }
+
   // Normalizes a C++ qualified name.  Validates the name qualification.
   // The name must be either unqualified or fully qualified with a leading "::".
   // The leading "::" in a fully qualified name is stripped.
@@ -288,6 +298,7 @@ class FunctionRegistry {
  private:
   mutable absl::Mutex lock_;
   std::unordered_map<std::string, Function> functions_ ABSL_GUARDED_BY(lock_);
+  int64_t generation_ ABSL_GUARDED_BY(lock_) = 0;
 
   // For names included in NamespaceAllowlist, strips the namespace.
   std::string GetAdjustedName(const std::string& name) {
@@ -309,6 +320,7 @@ class FunctionRegistry {
       functions_.erase(adjusted_name);
     }
     functions_.erase(name);
+    ++generation_;
   }
 };
 
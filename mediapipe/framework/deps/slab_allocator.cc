@@ -0,0 +1,204 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/deps/slab_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "absl/base/attributes.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/no_destructor.h"
+
+namespace mediapipe {
+namespace slab_internal {
+
+namespace {
+
+// Block sizes are rounded up to a multiple of kGranularity bytes.
+constexpr size_t kGranularity = alignof(std::max_align_t);
+constexpr int kNumSizeClasses = kMaxCachedSize / kGranularity;
+// Maximum number of free blocks a thread keeps per size class.
+constexpr int kMaxFreeBlocksPerClass = 256;
+
+// A free block. The link is stored in the block itself.
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+struct FreeList {
+  FreeBlock* head = nullptr;
+  int size = 0;
+};
+
+class ThreadCache;
+
+// The ThreadCaches of the running threads, and the counts of the blocks
+// handed out by the threads that have exited.
+struct CacheRegistry {
+  absl::Mutex mutex;
+  std::vector<const ThreadCache*> caches ABSL_GUARDED_BY(mutex);
+  SlabAllocatorStats exited_stats ABSL_GUARDED_BY(mutex);
+};
+
+CacheRegistry& GetCacheRegistry() {
+  static NoDestructor<CacheRegistry> registry;
+  return *registry;
+}
+
+class ThreadCache {
+ public:
+  ThreadCache();
+  ~ThreadCache();
+
+  void* Allocate(int size_class, size_t block_size) {
+    FreeList& list = free_lists_[size_class];
+    if (list.head == nullptr) {
+      Increment(num_allocated_);
+      return ::operator new(block_size);
+    }
+    Increment(num_reused_);
+    FreeBlock* block = list.head;
+    list.head = block->next;
+    --list.size;
+    return block;
+  }
+
+  void Deallocate(void* ptr, int size_class) {
+    FreeList& list = free_lists_[size_class];
+    if (list.size >= kMaxFreeBlocksPerClass) {
+      ::operator delete(ptr);
+      return;
+    }
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = list.head;
+    list.head = block;
+    ++list.size;
+  }
+
+  // Returns the counts of this thread. May be called from any thread.
+  SlabAllocatorStats GetStats() const {
+    SlabAllocatorStats stats;
+    stats.num_reused = num_reused_.load(std::memory_order_relaxed);
+    stats.num_allocated = num_allocated_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+ private:
+  // Only the owning thread writes the counts, so they need no atomic
+  // read-modify-write.
+  static void Increment(std::atomic<int64_t>& count) {
+    count.store(count.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+  }
+
+  FreeList free_lists_[kNumSizeClasses];
+  std::atomic<int64_t> num_reused_{0};
+  std::atomic<int64_t> num_allocated_{0};
+};
+
+// Set once the calling thread's cache has been destroyed, so that blocks
+// released by later thread-local destructors go back to the global heap.
+ABSL_CONST_INIT thread_local bool thread_cache_destroyed = false;
+
+ThreadCache::ThreadCache() {
+  CacheRegistry& registry = GetCacheRegistry();
+  absl::MutexLock lock(&registry.mutex);
+  registry.caches.push_back(this);
+}
+
+ThreadCache::~ThreadCache() {
+  thread_cache_destroyed = true;
+  {
+    CacheRegistry& registry = GetCacheRegistry();
+    absl::MutexLock lock(&registry.mutex);
+    registry.caches.erase(
+        std::find(registry.caches.begin(), registry.caches.end(), this));
+    const SlabAllocatorStats stats = GetStats();
+    registry.exited_stats.num_reused += stats.num_reused;
+    registry.exited_stats.num_allocated += stats.num_allocated;
+  }
+  for (FreeList& list : free_lists_) {
+    while (list.head != nullptr) {
+      FreeBlock* block = list.head;
+      list.head = block->next;
+      ::operator delete(block);
+    }
+    list.size = 0;
+  }
+}
+
+ThreadCache* GetThreadCache() {
+  if (thread_cache_destroyed) return nullptr;
+  static thread_local ThreadCache cache;
+  return &cache;
+}
+
+// Returns the size class for "size", or -1 if blocks of that size are not
+// cached.
+inline int SizeClass(size_t size) {
+  if (size == 0 || size > kMaxCachedSize) return -1;
+  return static_cast<int>((size - 1) / kGranularity);
+}
+
+inline size_t BlockSize(int size_class) {
+  return (size_class + 1) * kGranularity;
+}
+
+}  // namespace
+
+void* Allocate(size_t size) {
+  const int size_class = SizeClass(size);
+  if (size_class < 0) {
+    return ::operator new(size);
+  }
+  // Blocks are always allocated with the full size of their class, so that
+  // any thread can later hand them out for any request in that class.
+  ThreadCache* cache = GetThreadCache();
+  if (cache == nullptr) {
+    return ::operator new(BlockSize(size_class));
+  }
+  return cache->Allocate(size_class, BlockSize(size_class));
+}
+
+void Deallocate(void* ptr, size_t size) {
+  if (ptr == nullptr) return;
+  const int size_class = SizeClass(size);
+  ThreadCache* cache = size_class < 0 ? nullptr : GetThreadCache();
+  if (cache == nullptr) {
+    ::operator delete(ptr);
+    return;
+  }
+  cache->Deallocate(ptr, size_class);
+}
+
+}  // namespace slab_internal
+
+SlabAllocatorStats GetSlabAllocatorStats() {
+  slab_internal::CacheRegistry& registry = slab_internal::GetCacheRegistry();
+  absl::MutexLock lock(&registry.mutex);
+  SlabAllocatorStats result = registry.exited_stats;
+  for (const slab_internal::ThreadCache* cache : registry.caches) {
+    const SlabAllocatorStats stats = cache->GetStats();
+    result.num_reused += stats.num_reused;
+    result.num_allocated += stats.num_allocated;
+  }
+  return result;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,101 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_DEPS_SLAB_ALLOCATOR_H_
+#define MEDIAPIPE_DEPS_SLAB_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include <new>
+
+namespace mediapipe {
+
+namespace slab_internal {
+
+// Returns a block of at least "size" bytes, aligned for any fundamental type.
+// Small blocks are taken from the calling thread's free list for their size
+// class, and only fall back to ::operator new when that list is empty.
+void* Allocate(size_t size);
+
+// Returns a block obtained from Allocate(size) with the same "size". The
+// block may be released by a different thread than the one that allocated
+// it; it is then cached by the releasing thread.
+void Deallocate(void* ptr, size_t size);
+
+// Largest block size served from the free lists. Larger blocks go straight
+// to ::operator new and ::operator delete.
+constexpr size_t kMaxCachedSize = 512;
+
+}  // namespace slab_internal
+
+// The number of small blocks handed out by the slab allocator since the
+// process started, across all threads.
+struct SlabAllocatorStats {
+  // Blocks reused from a free list.
+  int64_t num_reused = 0;
+  // Blocks that had to be allocated with ::operator new.
+  int64_t num_allocated = 0;
+};
+
+// Returns the current SlabAllocatorStats. Each thread counts its own blocks
+// without synchronization, so the result may miss the latest allocations of
+// running threads.
+SlabAllocatorStats GetSlabAllocatorStats();
+
+// A standard allocator that recycles small blocks through thread-local free
+// lists. It is stateless, so all instances compare equal and memory allocated
+// through one instance can be released through any other.
+//
+// This is meant for objects that are created and destroyed at a high rate
+// and have a fixed size, such as the combined Holder and control block
+// created by std::allocate_shared in MakePooledPacket. In steady state such
+// allocations do not touch the global heap at all.
+//
+// Each thread caches a bounded number of free blocks per size class; the
+// cache is released when the thread exits. A block released by a thread is
+// cached by that thread, so the reuse rate is highest when objects are
+// created and destroyed on the same set of threads, e.g. on the worker
+// threads of a graph executor.
+template <typename T>
+class SlabAllocator {
+ public:
+  using value_type = T;
+
+  SlabAllocator() = default;
+  template <typename U>
+  SlabAllocator(const SlabAllocator<U>&) {}  // NOLINT(runtime/explicit)
+
+  T* allocate(size_t n) {
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "SlabAllocator does not support over-aligned types.");
+    return static_cast<T*>(slab_internal::Allocate(n * sizeof(T)));
+  }
+  void deallocate(T* ptr, size_t n) {
+    slab_internal::Deallocate(ptr, n * sizeof(T));
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const SlabAllocator<T>&, const SlabAllocator<U>&) {
+  return true;
+}
+template <typename T, typename U>
+bool operator!=(const SlabAllocator<T>&, const SlabAllocator<U>&) {
+  return false;
+}
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_DEPS_SLAB_ALLOCATOR_H_
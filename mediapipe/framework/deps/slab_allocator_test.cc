@@ -0,0 +1,100 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/deps/slab_allocator.h"
+
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+struct Payload {
+  int values[6];
+};
+
+TEST(SlabAllocatorTest, ReusesReleasedBlocks) {
+  SlabAllocator<Payload> allocator;
+  Payload* first = allocator.allocate(1);
+  allocator.deallocate(first, 1);
+  Payload* second = allocator.allocate(1);
+  EXPECT_EQ(first, second);
+  allocator.deallocate(second, 1);
+}
+
+TEST(SlabAllocatorTest, SharesBlocksBetweenTypesOfTheSameSize) {
+  SlabAllocator<Payload> payload_allocator;
+  SlabAllocator<char> char_allocator(payload_allocator);
+  EXPECT_TRUE(payload_allocator == char_allocator);
+  char* chars = char_allocator.allocate(sizeof(Payload));
+  char_allocator.deallocate(chars, sizeof(Payload));
+  Payload* payload = payload_allocator.allocate(1);
+  EXPECT_EQ(static_cast<void*>(payload), static_cast<void*>(chars));
+  payload_allocator.deallocate(payload, 1);
+}
+
+TEST(SlabAllocatorTest, AllocatesLargeBlocks) {
+  SlabAllocator<char> allocator;
+  const size_t size = slab_internal::kMaxCachedSize * 4;
+  char* block = allocator.allocate(size);
+  block[0] = 'a';
+  block[size - 1] = 'z';
+  allocator.deallocate(block, size);
+}
+
+TEST(SlabAllocatorTest, WorksWithAllocateShared) {
+  std::vector<std::shared_ptr<std::string>> strings;
+  for (int i = 0; i < 1000; ++i) {
+    strings.push_back(std::allocate_shared<std::string>(
+        SlabAllocator<std::string>(), std::to_string(i)));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(*strings[i], std::to_string(i));
+  }
+}
+
+TEST(SlabAllocatorTest, ReleasesBlocksFromOtherThreads) {
+  SlabAllocator<Payload> allocator;
+  std::vector<Payload*> blocks;
+  for (int i = 0; i < 1000; ++i) {
+    blocks.push_back(allocator.allocate(1));
+  }
+  std::thread thread([&allocator, &blocks] {
+    for (Payload* block : blocks) {
+      allocator.deallocate(block, 1);
+    }
+  });
+  thread.join();
+}
+
+TEST(SlabAllocatorTest, CountsReusedBlocks) {
+  SlabAllocator<Payload> allocator;
+  const SlabAllocatorStats before = GetSlabAllocatorStats();
+  std::thread thread([&allocator] {
+    for (int i = 0; i < 10; ++i) {
+      allocator.deallocate(allocator.allocate(1), 1);
+    }
+  });
+  thread.join();
+  const SlabAllocatorStats after = GetSlabAllocatorStats();
+  EXPECT_EQ(after.num_allocated - before.num_allocated, 1);
+  EXPECT_EQ(after.num_reused - before.num_reused, 9);
+}
+
+}  // namespace
+}  // namespace mediapipe
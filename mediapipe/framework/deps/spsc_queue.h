@@ -0,0 +1,124 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_DEPS_SPSC_QUEUE_H_
+#define MEDIAPIPE_DEPS_SPSC_QUEUE_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace mediapipe {
+
+// A bounded, lock-free, single-producer single-consumer FIFO queue backed by a
+// ring buffer.
+//
+// At any time at most one thread may call the producer methods (TryPush) and
+// at most one thread may call the consumer methods (TryPop, Front). Either
+// role may move between threads, as long as the hand-over is synchronized
+// externally (e.g. by a mutex that is held while using the role).
+//
+// Sample usage:
+//
+//   SpscQueue<int> queue(16);
+//   // Producer thread:
+//   if (!queue.TryPush(42)) { /* The queue is full. */ }
+//   // Consumer thread:
+//   int value;
+//   while (queue.TryPop(&value)) { Use(value); }
+template <typename T>
+class SpscQueue {
+ public:
+  // Creates a queue that holds at least "capacity" elements. The capacity is
+  // rounded up to a power of two.
+  explicit SpscQueue(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+    mask_ = size - 1;
+    slots_ = std::make_unique<T[]>(size);
+  }
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  // Returns the maximum number of elements the queue can hold.
+  size_t capacity() const { return mask_ + 1; }
+
+  // Producer: appends "value" and returns true, or returns false, leaving
+  // "value" untouched, if the queue is full.
+  bool TryPush(T&& value) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) > mask_) {
+      return false;
+    }
+    slots_[tail & mask_] = std::move(value);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+  bool TryPush(const T& value) {
+    T copy = value;
+    return TryPush(std::move(copy));
+  }
+
+  // Consumer: returns the oldest element, or nullptr if the queue is empty.
+  // The element stays valid until the next TryPop.
+  T* Front() {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    return &slots_[head & mask_];
+  }
+
+  // Consumer: moves the oldest element into "value" and returns true, or
+  // returns false if the queue is empty.
+  bool TryPop(T* value) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    *value = std::move(slots_[head & mask_]);
+    // Release the resources of the moved-from element in the consumer.
+    slots_[head & mask_] = T();
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Returns true if the queue looked empty at some point during the call.
+  bool Empty() const {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_acquire);
+  }
+
+  // Removes all elements. Must not be called concurrently with any other
+  // method.
+  void Clear() {
+    T value;
+    while (TryPop(&value)) {
+    }
+  }
+
+ private:
+  std::unique_ptr<T[]> slots_;
+  size_t mask_ = 0;
+  // The consumer and producer positions are kept on separate cache lines so
+  // that the two threads do not invalidate each other's line on every access.
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_DEPS_SPSC_QUEUE_H_
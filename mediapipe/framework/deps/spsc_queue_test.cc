@@ -0,0 +1,82 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/deps/spsc_queue.h"
+
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(SpscQueueTest, RoundsUpCapacity) {
+  SpscQueue<int> queue(5);
+  EXPECT_EQ(queue.capacity(), 8);
+}
+
+TEST(SpscQueueTest, PushAndPopInOrder) {
+  SpscQueue<int> queue(4);
+  EXPECT_TRUE(queue.Empty());
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.TryPush(i));
+  }
+  EXPECT_FALSE(queue.TryPush(4));
+  ASSERT_NE(queue.Front(), nullptr);
+  EXPECT_EQ(*queue.Front(), 0);
+  int value;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.TryPop(&value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(queue.TryPop(&value));
+  EXPECT_EQ(queue.Front(), nullptr);
+  EXPECT_TRUE(queue.Empty());
+}
+
+TEST(SpscQueueTest, PopReleasesElement) {
+  SpscQueue<std::shared_ptr<int>> queue(2);
+  auto element = std::make_shared<int>(1);
+  EXPECT_TRUE(queue.TryPush(element));
+  EXPECT_EQ(element.use_count(), 2);
+  std::shared_ptr<int> popped;
+  ASSERT_TRUE(queue.TryPop(&popped));
+  popped.reset();
+  EXPECT_EQ(element.use_count(), 1);
+}
+
+TEST(SpscQueueTest, ConcurrentProducerAndConsumer) {
+  constexpr int kNumElements = 100000;
+  SpscQueue<int> queue(16);
+  std::thread producer([&queue] {
+    for (int i = 0; i < kNumElements; ++i) {
+      while (!queue.TryPush(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+  int value;
+  for (int i = 0; i < kNumElements; ++i) {
+    while (!queue.TryPop(&value)) {
+      std::this_thread::yield();
+    }
+    ASSERT_EQ(value, i);
+  }
+  producer.join();
+  EXPECT_TRUE(queue.Empty());
+}
+
+}  // namespace
+}  // namespace mediapipe
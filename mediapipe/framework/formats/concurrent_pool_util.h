@@ -0,0 +1,161 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Helpers for buffer pools that are used from many threads at once.
+// Consider this file an implementation detail. None of this is part of the
+// public API.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_CONCURRENT_POOL_UTIL_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_CONCURRENT_POOL_UTIL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+
+namespace mediapipe {
+
+// Remembers, for each thread, the simple pools it recently obtained from a
+// multi-size pool, so that repeated requests for the same size do not take
+// the multi-pool's lock. Requests served this way are reported back to the
+// multi-pool in batches, so that its eviction policy still sees them.
+//
+// Pool must be a std::shared_ptr. Only weak references are kept, so a pool
+// evicted by the multi-pool is not kept alive by the cache.
+template <typename Spec, typename Pool>
+class PoolThreadCache {
+ public:
+  // Looks up the pool for a spec in the multi-pool, counting request_count
+  // requests. May return an unset Pool.
+  using LookupFunction =
+      absl::FunctionRef<Pool(const Spec& spec, int request_count)>;
+
+  PoolThreadCache() : id_(next_id_++) {}
+
+  // Returns the pool for spec, calling lookup on a miss and otherwise every
+  // kFlushInterval requests.
+  Pool Get(const Spec& spec, LookupFunction lookup) {
+    std::vector<Entry>& entries = ThreadEntries();
+    auto it = std::find_if(entries.begin(), entries.end(),
+                           [&spec](const Entry& e) { return e.spec == spec; });
+    if (it != entries.end()) {
+      ++it->pending_requests;
+      Pool pool = it->pool.lock();
+      if (pool && it->pending_requests < kFlushInterval) return pool;
+      pool = lookup(spec, it->pending_requests);
+      it->pool = pool;
+      it->pending_requests = 0;
+      return pool;
+    }
+    Pool pool = lookup(spec, 1);
+    if (pool) {
+      if (entries.size() >= kMaxEntries) entries.erase(entries.begin());
+      entries.push_back({spec, pool, 0});
+    }
+    return pool;
+  }
+
+ private:
+  // Number of sizes remembered per thread.
+  static constexpr int kMaxEntries = 4;
+  // Requests served from the cache before they are reported to the
+  // multi-pool.
+  static constexpr int kFlushInterval = 8;
+
+  struct Entry {
+    Spec spec;
+    std::weak_ptr<typename Pool::element_type> pool;
+    int pending_requests;
+  };
+
+  std::vector<Entry>& ThreadEntries() {
+    // The entries of the calling thread, by cache id. Entries of destroyed
+    // caches only hold expired references, and are dropped when a new cache
+    // is used on the thread.
+    thread_local absl::flat_hash_map<uint64_t, std::vector<Entry>>
+        thread_entries;
+    auto it = thread_entries.find(id_);
+    if (it != thread_entries.end()) return it->second;
+    for (auto iter = thread_entries.begin(); iter != thread_entries.end();) {
+      const std::vector<Entry>& entries = iter->second;
+      if (std::all_of(entries.begin(), entries.end(),
+                      [](const Entry& e) { return e.pool.expired(); })) {
+        thread_entries.erase(iter++);
+      } else {
+        ++iter;
+      }
+    }
+    return thread_entries[id_];
+  }
+
+  static inline std::atomic<uint64_t> next_id_{0};
+  const uint64_t id_;
+};
+
+// A lock-free list of buffers returned to a pool. Threads releasing buffers
+// push them here without taking the pool's lock; the pool takes them all at
+// once, under its lock, when it next needs them or when enough have piled up.
+template <typename T>
+class PoolReturnList {
+ public:
+  PoolReturnList() = default;
+  PoolReturnList(const PoolReturnList&) = delete;
+  PoolReturnList& operator=(const PoolReturnList&) = delete;
+  ~PoolReturnList() {
+    std::vector<std::unique_ptr<T>> items;
+    TakeAll(&items);
+  }
+
+  // Adds an item and returns the number of items now in the list.
+  int Push(std::unique_ptr<T> item) {
+    Node* node =
+        new Node{std::move(item), head_.load(std::memory_order_relaxed)};
+    while (!head_.compare_exchange_weak(node->next, node,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+    }
+    return size_.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+
+  // Moves all items to the end of out and returns how many were moved.
+  int TakeAll(std::vector<std::unique_ptr<T>>* out) {
+    Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+    int count = 0;
+    while (node != nullptr) {
+      out->push_back(std::move(node->item));
+      Node* next = node->next;
+      delete node;
+      node = next;
+      ++count;
+    }
+    size_.fetch_sub(count, std::memory_order_relaxed);
+    return count;
+  }
+
+ private:
+  struct Node {
+    std::unique_ptr<T> item;
+    Node* next;
+  };
+
+  std::atomic<Node*> head_{nullptr};
+  std::atomic<int> size_{0};
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_CONCURRENT_POOL_UTIL_H_
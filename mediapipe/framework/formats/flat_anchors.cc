@@ -0,0 +1,53 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/flat_anchors.h"
+
+namespace mediapipe {
+
+void FlatAnchors::reserve(int size) {
+  x_center_.reserve(size);
+  y_center_.reserve(size);
+  h_.reserve(size);
+  w_.reserve(size);
+}
+
+void FlatAnchors::Add(float x_center, float y_center, float h, float w) {
+  x_center_.push_back(x_center);
+  y_center_.push_back(y_center);
+  h_.push_back(h);
+  w_.push_back(w);
+}
+
+FlatAnchors FromAnchors(const std::vector<Anchor>& anchors) {
+  FlatAnchors result;
+  result.reserve(anchors.size());
+  for (const Anchor& anchor : anchors) {
+    result.Add(anchor.x_center(), anchor.y_center(), anchor.h(), anchor.w());
+  }
+  return result;
+}
+
+std::vector<Anchor> ToAnchors(const FlatAnchors& anchors) {
+  std::vector<Anchor> result(anchors.size());
+  for (int i = 0; i < anchors.size(); ++i) {
+    result[i].set_x_center(anchors.x_center(i));
+    result[i].set_y_center(anchors.y_center(i));
+    result[i].set_h(anchors.h(i));
+    result[i].set_w(anchors.w(i));
+  }
+  return result;
+}
+
+}  // namespace mediapipe
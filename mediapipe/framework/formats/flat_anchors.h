@@ -0,0 +1,65 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_FLAT_ANCHORS_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_FLAT_ANCHORS_H_
+
+#include <vector>
+
+#include "mediapipe/framework/formats/object_detection/anchor.pb.h"
+
+namespace mediapipe {
+
+// A list of anchors stored as a struct of arrays: the centers and sizes of all
+// anchors each live in a single contiguous vector.
+//
+// Box decoding reads one coordinate of many anchors at a time, which this
+// layout serves with unit stride, and it takes a fraction of the memory of
+// one Anchor proto per anchor.
+class FlatAnchors {
+ public:
+  FlatAnchors() = default;
+
+  int size() const { return x_center_.size(); }
+  bool empty() const { return x_center_.empty(); }
+
+  void reserve(int size);
+
+  void Add(float x_center, float y_center, float h, float w);
+
+  float x_center(int i) const { return x_center_[i]; }
+  float y_center(int i) const { return y_center_[i]; }
+  float h(int i) const { return h_[i]; }
+  float w(int i) const { return w_[i]; }
+
+  // Each returns size() values, one per anchor.
+  const float* x_centers() const { return x_center_.data(); }
+  const float* y_centers() const { return y_center_.data(); }
+  const float* heights() const { return h_.data(); }
+  const float* widths() const { return w_.data(); }
+
+ private:
+  std::vector<float> x_center_;
+  std::vector<float> y_center_;
+  std::vector<float> h_;
+  std::vector<float> w_;
+};
+
+// Converts between Anchor protos and FlatAnchors, keeping the anchor order.
+FlatAnchors FromAnchors(const std::vector<Anchor>& anchors);
+std::vector<Anchor> ToAnchors(const FlatAnchors& anchors);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_FLAT_ANCHORS_H_
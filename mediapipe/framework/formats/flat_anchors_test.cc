@@ -0,0 +1,65 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/flat_anchors.h"
+
+#include <vector>
+
+#include "mediapipe/framework/formats/object_detection/anchor.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(FlatAnchorsTest, StoresEachCoordinateContiguously) {
+  FlatAnchors anchors;
+  anchors.Add(/*x_center=*/0.1f, /*y_center=*/0.2f, /*h=*/0.3f, /*w=*/0.4f);
+  anchors.Add(/*x_center=*/0.5f, /*y_center=*/0.6f, /*h=*/0.7f, /*w=*/0.8f);
+  ASSERT_EQ(anchors.size(), 2);
+  EXPECT_THAT(std::vector<float>(anchors.x_centers(), anchors.x_centers() + 2),
+              ElementsAre(0.1f, 0.5f));
+  EXPECT_THAT(std::vector<float>(anchors.widths(), anchors.widths() + 2),
+              ElementsAre(0.4f, 0.8f));
+  EXPECT_FLOAT_EQ(anchors.y_center(1), 0.6f);
+  EXPECT_FLOAT_EQ(anchors.h(0), 0.3f);
+}
+
+TEST(FlatAnchorsTest, RoundTripsThroughAnchorProtos) {
+  std::vector<Anchor> protos(2);
+  protos[0].set_x_center(0.1f);
+  protos[0].set_y_center(0.2f);
+  protos[0].set_h(0.3f);
+  protos[0].set_w(0.4f);
+  protos[1].set_x_center(0.5f);
+  protos[1].set_y_center(0.6f);
+  protos[1].set_h(0.7f);
+  protos[1].set_w(0.8f);
+
+  const FlatAnchors anchors = FromAnchors(protos);
+  ASSERT_EQ(anchors.size(), 2);
+  EXPECT_FLOAT_EQ(anchors.x_center(1), 0.5f);
+  EXPECT_FLOAT_EQ(anchors.w(0), 0.4f);
+
+  const std::vector<Anchor> round_trip = ToAnchors(anchors);
+  ASSERT_EQ(round_trip.size(), 2);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(round_trip[i].SerializeAsString(), protos[i].SerializeAsString());
+  }
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,124 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/flat_detections.h"
+
+#include <algorithm>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/formats/location_data.pb.h"
+
+namespace mediapipe {
+
+void FlatDetections::reserve(int size) {
+  boxes_.reserve(size * kBoxSize);
+  scores_.reserve(size);
+  class_ids_.reserve(size);
+  keypoints_.reserve(size * num_keypoints_ * 2);
+}
+
+void FlatDetections::clear() {
+  boxes_.clear();
+  scores_.clear();
+  class_ids_.clear();
+  keypoints_.clear();
+}
+
+void FlatDetections::Add(float xmin, float ymin, float width, float height,
+                         float score, int class_id, const float* keypoints) {
+  boxes_.insert(boxes_.end(), {xmin, ymin, width, height});
+  scores_.push_back(score);
+  class_ids_.push_back(class_id);
+  if (num_keypoints_ > 0) {
+    keypoints_.insert(keypoints_.end(), keypoints,
+                      keypoints + num_keypoints_ * 2);
+  }
+}
+
+FlatDetections FlatDetections::Select(const std::vector<int>& indices) const {
+  FlatDetections selected(num_keypoints_);
+  selected.reserve(indices.size());
+  for (int i : indices) {
+    const float* b = box(i);
+    selected.Add(b[0], b[1], b[2], b[3], scores_[i], class_ids_[i],
+                 keypoints(i));
+  }
+  return selected;
+}
+
+std::vector<Detection> ToDetections(const FlatDetections& detections) {
+  std::vector<Detection> output(detections.size());
+  for (int i = 0; i < detections.size(); ++i) {
+    Detection& detection = output[i];
+    detection.add_score(detections.score(i));
+    detection.add_label_id(detections.class_id(i));
+    LocationData* location_data = detection.mutable_location_data();
+    location_data->set_format(LocationData::RELATIVE_BOUNDING_BOX);
+    LocationData::RelativeBoundingBox* box =
+        location_data->mutable_relative_bounding_box();
+    box->set_xmin(detections.xmin(i));
+    box->set_ymin(detections.ymin(i));
+    box->set_width(detections.width(i));
+    box->set_height(detections.height(i));
+    const float* keypoints = detections.keypoints(i);
+    for (int k = 0; k < detections.num_keypoints(); ++k) {
+      LocationData::RelativeKeypoint* keypoint =
+          location_data->add_relative_keypoints();
+      keypoint->set_x(keypoints[k * 2]);
+      keypoint->set_y(keypoints[k * 2 + 1]);
+    }
+  }
+  return output;
+}
+
+absl::StatusOr<FlatDetections> FromDetections(
+    const std::vector<Detection>& detections) {
+  const int num_keypoints =
+      detections.empty()
+          ? 0
+          : detections[0].location_data().relative_keypoints_size();
+  FlatDetections output(num_keypoints);
+  output.reserve(detections.size());
+  std::vector<float> keypoints(num_keypoints * 2);
+  for (const Detection& detection : detections) {
+    if (detection.label_id_size() == 0) {
+      return absl::InvalidArgumentError("Detection has no label id.");
+    }
+    const LocationData& location_data = detection.location_data();
+    if (location_data.relative_keypoints_size() != num_keypoints) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Expected ", num_keypoints, " keypoints per detection, got ",
+          location_data.relative_keypoints_size()));
+    }
+    for (int k = 0; k < num_keypoints; ++k) {
+      keypoints[k * 2] = location_data.relative_keypoints(k).x();
+      keypoints[k * 2 + 1] = location_data.relative_keypoints(k).y();
+    }
+    const LocationData::RelativeBoundingBox& box =
+        location_data.relative_bounding_box();
+    const auto top_score =
+        std::max_element(detection.score().begin(), detection.score().end());
+    const int top = top_score == detection.score().end()
+                        ? 0
+                        : top_score - detection.score().begin();
+    output.Add(box.xmin(), box.ymin(), box.width(), box.height(),
+               detection.score_size() > 0 ? detection.score(top) : 0.0f,
+               detection.label_id(std::min(top, detection.label_id_size() - 1)),
+               keypoints.data());
+  }
+  return output;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,104 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_FLAT_DETECTIONS_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_FLAT_DETECTIONS_H_
+
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+
+namespace mediapipe {
+
+// A list of detections stored as a struct of arrays: relative bounding boxes,
+// scores, class ids and keypoints each live in a single contiguous vector.
+//
+// Producing and filtering thousands of candidate detections as Detection
+// protos allocates location data, labels and keypoints for every one of them.
+// FlatDetections keeps those candidates in a handful of buffers instead, and
+// is meant to travel between detection post-processing calculators. Use
+// ToDetections() and FromDetections() to cross into proto-based parts of a
+// graph.
+//
+// Every detection has the same number of keypoints. Boxes are stored as
+// (xmin, ymin, width, height) and keypoints as (x, y) pairs, all in
+// coordinates relative to the image size.
+class FlatDetections {
+ public:
+  static constexpr int kBoxSize = 4;
+
+  FlatDetections() = default;
+  explicit FlatDetections(int num_keypoints) : num_keypoints_(num_keypoints) {}
+
+  int num_keypoints() const { return num_keypoints_; }
+  int size() const { return scores_.size(); }
+  bool empty() const { return scores_.empty(); }
+
+  void reserve(int size);
+  void clear();
+
+  // Appends a detection. |keypoints| holds num_keypoints() (x, y) pairs and
+  // may be null when num_keypoints() is 0.
+  void Add(float xmin, float ymin, float width, float height, float score,
+           int class_id, const float* keypoints = nullptr);
+
+  // Returns the (xmin, ymin, width, height) box of detection |i|.
+  const float* box(int i) const { return &boxes_[i * kBoxSize]; }
+  float* mutable_box(int i) { return &boxes_[i * kBoxSize]; }
+  float xmin(int i) const { return boxes_[i * kBoxSize]; }
+  float ymin(int i) const { return boxes_[i * kBoxSize + 1]; }
+  float width(int i) const { return boxes_[i * kBoxSize + 2]; }
+  float height(int i) const { return boxes_[i * kBoxSize + 3]; }
+
+  float score(int i) const { return scores_[i]; }
+  void set_score(int i, float score) { scores_[i] = score; }
+  int class_id(int i) const { return class_ids_[i]; }
+
+  // Returns the num_keypoints() (x, y) pairs of detection |i|.
+  const float* keypoints(int i) const {
+    return keypoints_.data() + i * num_keypoints_ * 2;
+  }
+  float* mutable_keypoints(int i) {
+    return keypoints_.data() + i * num_keypoints_ * 2;
+  }
+
+  const std::vector<float>& boxes() const { return boxes_; }
+  const std::vector<float>& scores() const { return scores_; }
+  const std::vector<int>& class_ids() const { return class_ids_; }
+
+  // Returns the detections at |indices|, in that order.
+  FlatDetections Select(const std::vector<int>& indices) const;
+
+ private:
+  int num_keypoints_ = 0;
+  std::vector<float> boxes_;
+  std::vector<float> scores_;
+  std::vector<int> class_ids_;
+  std::vector<float> keypoints_;
+};
+
+// Converts to Detection protos with RELATIVE_BOUNDING_BOX location data, one
+// score and label id per detection.
+std::vector<Detection> ToDetections(const FlatDetections& detections);
+
+// Converts Detection protos with relative bounding boxes, keeping only the top
+// score of each detection and its label id. Fails if a detection has no label
+// id, or if detections disagree on the number of keypoints.
+absl::StatusOr<FlatDetections> FromDetections(
+    const std::vector<Detection>& detections);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_FLAT_DETECTIONS_H_
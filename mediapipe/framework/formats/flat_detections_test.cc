@@ -0,0 +1,104 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/flat_detections.h"
+
+#include <vector>
+
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+FlatDetections MakeDetections() {
+  FlatDetections detections(/*num_keypoints=*/2);
+  const float keypoints0[] = {0.1f, 0.2f, 0.3f, 0.4f};
+  const float keypoints1[] = {0.5f, 0.6f, 0.7f, 0.8f};
+  detections.Add(0.1f, 0.2f, 0.3f, 0.4f, 0.9f, 1, keypoints0);
+  detections.Add(0.5f, 0.5f, 0.2f, 0.1f, 0.6f, 3, keypoints1);
+  return detections;
+}
+
+TEST(FlatDetectionsTest, StoresDetectionsContiguously) {
+  FlatDetections detections = MakeDetections();
+  ASSERT_EQ(detections.size(), 2);
+  EXPECT_THAT(detections.boxes(),
+              ElementsAre(0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.5f, 0.2f, 0.1f));
+  EXPECT_THAT(detections.scores(), ElementsAre(0.9f, 0.6f));
+  EXPECT_THAT(detections.class_ids(), ElementsAre(1, 3));
+  EXPECT_FLOAT_EQ(detections.keypoints(1)[3], 0.8f);
+}
+
+TEST(FlatDetectionsTest, SelectsDetectionsInOrder) {
+  FlatDetections selected = MakeDetections().Select({1, 0, 1});
+  ASSERT_EQ(selected.size(), 3);
+  EXPECT_EQ(selected.num_keypoints(), 2);
+  EXPECT_THAT(selected.class_ids(), ElementsAre(3, 1, 3));
+  EXPECT_FLOAT_EQ(selected.xmin(1), 0.1f);
+  EXPECT_FLOAT_EQ(selected.keypoints(2)[0], 0.5f);
+}
+
+TEST(FlatDetectionsTest, RoundTripsThroughDetectionProtos) {
+  const FlatDetections detections = MakeDetections();
+  std::vector<Detection> protos = ToDetections(detections);
+  ASSERT_EQ(protos.size(), 2);
+  EXPECT_EQ(protos[1].label_id(0), 3);
+  EXPECT_EQ(protos[1].location_data().format(),
+            LocationData::RELATIVE_BOUNDING_BOX);
+  EXPECT_FLOAT_EQ(protos[1].location_data().relative_bounding_box().width(),
+                  0.2f);
+  EXPECT_FLOAT_EQ(protos[1].location_data().relative_keypoints(1).y(), 0.8f);
+
+  MP_ASSERT_OK_AND_ASSIGN(FlatDetections round_trip, FromDetections(protos));
+  EXPECT_EQ(round_trip.num_keypoints(), 2);
+  EXPECT_EQ(round_trip.boxes(), detections.boxes());
+  EXPECT_EQ(round_trip.scores(), detections.scores());
+  EXPECT_EQ(round_trip.class_ids(), detections.class_ids());
+  EXPECT_FLOAT_EQ(round_trip.keypoints(0)[2], 0.3f);
+}
+
+TEST(FlatDetectionsTest, KeepsTopScoreWhenConvertingProtos) {
+  const Detection detection = ParseTextProtoOrDie<Detection>(R"pb(
+    score: 0.2
+    score: 0.7
+    label_id: 4
+    label_id: 5
+    location_data {
+      format: RELATIVE_BOUNDING_BOX
+      relative_bounding_box { xmin: 0.1 ymin: 0.1 width: 0.5 height: 0.5 }
+    }
+  )pb");
+  MP_ASSERT_OK_AND_ASSIGN(FlatDetections detections,
+                          FromDetections({detection}));
+  ASSERT_EQ(detections.size(), 1);
+  EXPECT_FLOAT_EQ(detections.score(0), 0.7f);
+  EXPECT_EQ(detections.class_id(0), 5);
+}
+
+TEST(FlatDetectionsTest, FailsOnDetectionsWithoutLabelIds) {
+  const Detection detection = ParseTextProtoOrDie<Detection>(R"pb(
+    score: 0.2
+    label: "face"
+  )pb");
+  EXPECT_FALSE(FromDetections({detection}).ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -14,6 +14,7 @@
 
 #include "mediapipe/framework/formats/image.h"
 
+#include "mediapipe/framework/packet_payload_size.h"
 #include "mediapipe/framework/type_map.h"
 
 #if !MEDIAPIPE_DISABLE_GPU
@@ -45,4 +46,28 @@ MEDIAPIPE_REGISTER_TYPE(mediapipe::Image, "::mediapipe::Image", nullptr,
 MEDIAPIPE_REGISTER_TYPE(std::vector<mediapipe::Image>,
                         "::std::vector<::mediapipe::Image>", nullptr, nullptr);
 
+namespace {
+
+// Estimates the pixel data size from the format, without converting the
+// image to the CPU.
+size_t ImagePayloadSize(const Image& image) {
+  const ImageFormat::Format format = image.image_format();
+  if (format == ImageFormat::UNKNOWN) {
+    return 0;
+  }
+  return static_cast<size_t>(image.width()) * image.height() *
+         ImageFrame::NumberOfChannelsForFormat(format) *
+         ImageFrame::ByteDepthForFormat(format);
+}
+
+}  // namespace
+
+MEDIAPIPE_REGISTER_PAYLOAD_SIZE(Image, ImagePayloadSize);
+MEDIAPIPE_REGISTER_PAYLOAD_SIZE(
+    std::vector<Image>, [](const std::vector<Image>& images) -> size_t {
+      size_t bytes = 0;
+      for (const Image& image : images) bytes += ImagePayloadSize(image);
+      return bytes;
+    });
+
 }  // namespace mediapipe
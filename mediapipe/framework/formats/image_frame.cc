@@ -25,6 +25,7 @@
 
 #include "absl/strings/str_cat.h"
 #include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/packet_payload_size.h"
 #include "mediapipe/framework/port/aligned_malloc_and_free.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/proto_ns.h"
@@ -418,4 +419,10 @@ void ImageFrame::CopyToBuffer(float* buffer, int buffer_size) const {
                          reinterpret_cast<char*>(buffer));
   }
 }
+
+MEDIAPIPE_REGISTER_PAYLOAD_SIZE(ImageFrame,
+                                [](const ImageFrame& frame) -> size_t {
+                                  return frame.PixelDataSize();
+                                });
+
 }  // namespace mediapipe
@@ -0,0 +1,129 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/framework/formats/image_frame_multi_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+
+namespace mediapipe {
+
+std::unique_ptr<ImageFrame> ImageFrameMultiPool::GetImageFrame(
+    ImageFormat::Format format, int width, int height,
+    uint32 alignment_boundary) {
+  const BufferSpec spec{format, width, height, alignment_boundary};
+  Buffer buffer;
+  // The trimmed buffers are released after the lock.
+  std::vector<Buffer> trimmed;
+  {
+    absl::MutexLock lock(&mutex_);
+    ++request_count_;
+    ++stats_.in_use_count;
+    // Prefers the most recently returned buffer, whose memory is most likely
+    // still cached.
+    auto it = std::find_if(
+        available_.rbegin(), available_.rend(),
+        [&spec](const Buffer& available) { return available.spec == spec; });
+    if (it != available_.rend()) {
+      ++stats_.hits;
+      buffer = std::move(*it);
+      available_.erase(std::next(it).base());
+      --stats_.available_count;
+      AddAvailableBytes(-buffer.size());
+    } else {
+      ++stats_.misses;
+    }
+    TrimAvailable(&trimmed);
+  }
+
+  if (!buffer.pixel_data) {
+    ImageFrame frame(format, width, height, alignment_boundary);
+    buffer.spec = spec;
+    buffer.width_step = frame.WidthStep();
+    buffer.pixel_data = frame.Release();
+  }
+
+  // The frame's deleter hands the pixel buffer back to the pool.
+  std::weak_ptr<ImageFrameMultiPool> weak_pool(shared_from_this());
+  ImageFrame::Deleter deleter = buffer.pixel_data.get_deleter();
+  const int width_step = buffer.width_step;
+  return std::make_unique<ImageFrame>(
+      format, width, height, width_step, buffer.pixel_data.release(),
+      [weak_pool, spec, width_step, deleter](uint8* pixel_data) {
+        auto pool = weak_pool.lock();
+        if (pool) {
+          pool->Return(
+              {spec, width_step,
+               std::unique_ptr<uint8[], ImageFrame::Deleter>(pixel_data,
+                                                             deleter),
+               0});
+        } else {
+          deleter(pixel_data);
+        }
+      });
+}
+
+void ImageFrameMultiPool::SetMemoryBudget(
+    std::shared_ptr<MemoryBudget> memory_budget) {
+  absl::MutexLock lock(&mutex_);
+  memory_budget_ = std::move(memory_budget);
+}
+
+ImageFrameMultiPool::~ImageFrameMultiPool() {
+  if (memory_budget_) {
+    memory_budget_->Add(-stats_.available_bytes);
+  }
+}
+
+ImageFrameMultiPool::Stats ImageFrameMultiPool::GetStats() {
+  absl::MutexLock lock(&mutex_);
+  return stats_;
+}
+
+void ImageFrameMultiPool::Return(Buffer buffer) {
+  // The trimmed buffers are released after the lock.
+  std::vector<Buffer> trimmed;
+  absl::MutexLock lock(&mutex_);
+  --stats_.in_use_count;
+  buffer.returned_at = request_count_;
+  ++stats_.available_count;
+  AddAvailableBytes(buffer.size());
+  available_.push_back(std::move(buffer));
+  TrimAvailable(&trimmed);
+}
+
+void ImageFrameMultiPool::TrimAvailable(std::vector<Buffer>* trimmed) {
+  while (!available_.empty() &&
+         (stats_.available_bytes > max_available_bytes_ ||
+          request_count_ - available_.front().returned_at >
+              max_idle_requests_ ||
+          (memory_budget_ && memory_budget_->IsExceeded()))) {
+    --stats_.available_count;
+    AddAvailableBytes(-available_.front().size());
+    trimmed->push_back(std::move(available_.front()));
+    available_.pop_front();
+  }
+}
+
+void ImageFrameMultiPool::AddAvailableBytes(int64 bytes) {
+  stats_.available_bytes += bytes;
+  if (memory_budget_) {
+    memory_budget_->Add(bytes);
+  }
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,146 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_MULTI_POOL_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_MULTI_POOL_H_
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/memory_budget.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// Lets calculators reuse the pixel buffers of the ImageFrames they output,
+// for any mix of sizes, formats and alignments. A frame obtained from the pool
+// hands its pixel buffer back when it is destroyed, e.g. when the last packet
+// holding it goes away, and the pool reuses the buffer for the next frame with
+// the same width, height, format and alignment boundary. The contents of a
+// reused frame are undefined, as with a new frame.
+//
+// Unlike ImageFramePool, which serves a single size, this pool suits streams
+// whose frame sizes change often, e.g. crops of a moving region of interest.
+// The unused buffers are bounded by a memory budget: the least recently
+// returned ones are released first, as are those that have gone unused for
+// a while.
+//
+// Calculators can share a pool through kImageFramePoolService. Its unused
+// buffers count against the MemoryBudget of a graph once SetMemoryBudget() is
+// called.
+//
+// This class is thread-safe.
+class ImageFrameMultiPool
+    : public std::enable_shared_from_this<ImageFrameMultiPool> {
+ public:
+  // Counters describing how well the pool serves its requests.
+  struct Stats {
+    // Requests served by an unused buffer, and requests that needed a new one.
+    int64 hits = 0;
+    int64 misses = 0;
+    int in_use_count = 0;
+    int available_count = 0;
+    int64 available_bytes = 0;
+
+    double HitRate() const {
+      return hits + misses > 0 ? static_cast<double>(hits) / (hits + misses)
+                               : 0.0;
+    }
+  };
+
+  // Creates a pool that keeps at most "max_available_bytes" of unused pixel
+  // buffers, and releases the unused buffers that have not been reused during
+  // the last "max_idle_requests" calls to GetImageFrame(). We enforce creation
+  // as a shared_ptr so that we can use a weak reference in the frames'
+  // deleters.
+  static std::shared_ptr<ImageFrameMultiPool> Create(
+      int64 max_available_bytes = 64 << 20, int max_idle_requests = 100) {
+    return std::shared_ptr<ImageFrameMultiPool>(
+        new ImageFrameMultiPool(max_available_bytes, max_idle_requests));
+  }
+
+  // Obtains a frame. Its pixel buffer may either be reused or created anew.
+  std::unique_ptr<ImageFrame> GetImageFrame(
+      ImageFormat::Format format, int width, int height,
+      uint32 alignment_boundary = ImageFrame::kDefaultAlignmentBoundary);
+
+  Stats GetStats();
+
+  // Counts the bytes of the unused buffers against "memory_budget", and
+  // releases the unused buffers while it is exceeded. Must be called before
+  // the first GetImageFrame().
+  void SetMemoryBudget(std::shared_ptr<MemoryBudget> memory_budget)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  ~ImageFrameMultiPool();
+
+ private:
+  struct BufferSpec {
+    ImageFormat::Format format;
+    int width;
+    int height;
+    uint32 alignment_boundary;
+
+    bool operator==(const BufferSpec& other) const {
+      return format == other.format && width == other.width &&
+             height == other.height &&
+             alignment_boundary == other.alignment_boundary;
+    }
+  };
+
+  // A pixel buffer, with the request count at which it was returned.
+  struct Buffer {
+    BufferSpec spec;
+    int width_step;
+    std::unique_ptr<uint8[], ImageFrame::Deleter> pixel_data;
+    int64 returned_at;
+
+    int64 size() const { return static_cast<int64>(width_step) * spec.height; }
+  };
+
+  ImageFrameMultiPool(int64 max_available_bytes, int max_idle_requests)
+      : max_available_bytes_(max_available_bytes),
+        max_idle_requests_(max_idle_requests) {}
+
+  // Returns a pixel buffer to the pool.
+  void Return(Buffer buffer);
+
+  // Removes the least recently returned buffers until the unused buffers fit
+  // in max_available_bytes_ and the memory budget is not exceeded, and those
+  // that have been idle for more than max_idle_requests_.
+  void TrimAvailable(std::vector<Buffer>* trimmed)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Adds "bytes" to the available bytes and to the memory budget, if any.
+  void AddAvailableBytes(int64 bytes) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const int64 max_available_bytes_;
+  const int max_idle_requests_;
+
+  absl::Mutex mutex_;
+  int64 request_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  Stats stats_ ABSL_GUARDED_BY(mutex_);
+  // Ordered from the least to the most recently returned.
+  std::deque<Buffer> available_ ABSL_GUARDED_BY(mutex_);
+  std::shared_ptr<MemoryBudget> memory_budget_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_MULTI_POOL_H_
@@ -0,0 +1,113 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/framework/formats/image_frame_multi_pool.h"
+
+#include <memory>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kWidth = 32;
+constexpr int kHeight = 16;
+constexpr int kSrgbBytes = kWidth * 3 * kHeight;
+
+TEST(ImageFrameMultiPoolTest, ReusesBuffers) {
+  auto pool = ImageFrameMultiPool::Create();
+  const uint8* pixel_data;
+  {
+    auto frame = pool->GetImageFrame(ImageFormat::SRGB, kWidth, kHeight);
+    EXPECT_EQ(pool->GetStats().in_use_count, 1);
+    pixel_data = frame->PixelData();
+  }
+  ImageFrameMultiPool::Stats stats = pool->GetStats();
+  EXPECT_EQ(stats.in_use_count, 0);
+  EXPECT_EQ(stats.available_count, 1);
+  EXPECT_EQ(stats.available_bytes, kSrgbBytes);
+
+  auto frame = pool->GetImageFrame(ImageFormat::SRGB, kWidth, kHeight);
+  EXPECT_EQ(frame->PixelData(), pixel_data);
+  EXPECT_EQ(frame->Format(), ImageFormat::SRGB);
+  EXPECT_EQ(frame->Width(), kWidth);
+  EXPECT_EQ(frame->Height(), kHeight);
+  stats = pool->GetStats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.HitRate(), 0.5);
+  EXPECT_EQ(stats.available_count, 0);
+  EXPECT_EQ(stats.available_bytes, 0);
+}
+
+TEST(ImageFrameMultiPoolTest, MatchesSizeFormatAndAlignment) {
+  auto pool = ImageFrameMultiPool::Create();
+  { auto frame = pool->GetImageFrame(ImageFormat::SRGB, kWidth, kHeight); }
+  auto other_format = pool->GetImageFrame(ImageFormat::SRGBA, kWidth, kHeight);
+  auto other_size = pool->GetImageFrame(ImageFormat::SRGB, kWidth, kWidth);
+  auto other_alignment = pool->GetImageFrame(
+      ImageFormat::SRGB, kWidth, kHeight,
+      ImageFrame::kGlDefaultAlignmentBoundary);
+  ImageFrameMultiPool::Stats stats = pool->GetStats();
+  EXPECT_EQ(stats.hits, 0);
+  EXPECT_EQ(stats.misses, 4);
+  EXPECT_EQ(stats.in_use_count, 3);
+  EXPECT_EQ(stats.available_count, 1);
+  EXPECT_EQ(other_format->Format(), ImageFormat::SRGBA);
+  EXPECT_EQ(other_size->Height(), kWidth);
+}
+
+TEST(ImageFrameMultiPoolTest, StaysWithinByteBudget) {
+  auto pool = ImageFrameMultiPool::Create(
+      /*max_available_bytes=*/2 * kSrgbBytes);
+  std::vector<uint8*> pixel_data;
+  {
+    std::vector<std::unique_ptr<ImageFrame>> frames;
+    for (int i = 0; i < 3; ++i) {
+      frames.push_back(pool->GetImageFrame(ImageFormat::SRGB, kWidth, kHeight));
+      pixel_data.push_back(frames.back()->MutablePixelData());
+    }
+  }
+  ImageFrameMultiPool::Stats stats = pool->GetStats();
+  EXPECT_EQ(stats.available_count, 2);
+  EXPECT_EQ(stats.available_bytes, 2 * kSrgbBytes);
+
+  // The least recently returned buffer was released.
+  auto frame = pool->GetImageFrame(ImageFormat::SRGB, kWidth, kHeight);
+  EXPECT_EQ(frame->PixelData(), pixel_data[2]);
+}
+
+TEST(ImageFrameMultiPoolTest, TrimsIdleBuffers) {
+  auto pool = ImageFrameMultiPool::Create(/*max_available_bytes=*/1 << 20,
+                                          /*max_idle_requests=*/2);
+  { auto frame = pool->GetImageFrame(ImageFormat::SRGB, kWidth, kHeight); }
+  EXPECT_EQ(pool->GetStats().available_count, 1);
+  auto a = pool->GetImageFrame(ImageFormat::GRAY8, kWidth, kHeight);
+  auto b = pool->GetImageFrame(ImageFormat::GRAY8, kWidth, kHeight);
+  EXPECT_EQ(pool->GetStats().available_count, 1);
+  auto c = pool->GetImageFrame(ImageFormat::GRAY8, kWidth, kHeight);
+  EXPECT_EQ(pool->GetStats().available_count, 0);
+}
+
+TEST(ImageFrameMultiPoolTest, FrameOutlivesPool) {
+  auto pool = ImageFrameMultiPool::Create();
+  auto frame = pool->GetImageFrame(ImageFormat::SRGB, kWidth, kHeight);
+  frame->SetToZero();
+  pool = nullptr;
+}
+
+}  // namespace
+}  // namespace mediapipe
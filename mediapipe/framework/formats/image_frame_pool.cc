@@ -14,10 +14,15 @@
 
 #include "mediapipe/framework/formats/image_frame_pool.h"
 
+#include "absl/memory/memory.h"
 #include "absl/synchronization/mutex.h"
 
 namespace mediapipe {
 
+// Returned buffers are merged into the available list once this many have
+// piled up, or earlier when a buffer is requested.
+static constexpr int kReturnBatchSize = 4;
+
 ImageFramePool::ImageFramePool(int width, int height,
                                ImageFormat::Format format, int keep_count)
     : width_(width),
@@ -27,9 +32,11 @@ ImageFramePool::ImageFramePool(int width, int height,
 
 ImageFrameSharedPtr ImageFramePool::GetBuffer() {
   std::unique_ptr<ImageFrame> buffer;
+  std::vector<std::unique_ptr<ImageFrame>> trimmed;
 
   {
     absl::MutexLock lock(&mutex_);
+    MergeReturned(&trimmed);
     if (available_.empty()) {
       // Fix alignment at 4 for best compatability with OpenGL.
       buffer = std::make_unique<ImageFrame>(
@@ -58,21 +65,28 @@ ImageFrameSharedPtr ImageFramePool::GetBuffer() {
 }
 
 std::pair<int, int> ImageFramePool::GetInUseAndAvailableCounts() {
+  std::vector<std::unique_ptr<ImageFrame>> trimmed;
   absl::MutexLock lock(&mutex_);
+  MergeReturned(&trimmed);
   return {in_use_count_, available_.size()};
 }
 
 void ImageFramePool::Return(ImageFrame* buf) {
+  if (returned_.Push(absl::WrapUnique(buf)) < kReturnBatchSize) return;
   std::vector<std::unique_ptr<ImageFrame>> trimmed;
   {
     absl::MutexLock lock(&mutex_);
-    --in_use_count_;
-    available_.emplace_back(buf);
-    TrimAvailable(&trimmed);
+    MergeReturned(&trimmed);
   }
   // The trimmed buffers will be released without holding the lock.
 }
 
+void ImageFramePool::MergeReturned(
+    std::vector<std::unique_ptr<ImageFrame>>* trimmed) {
+  in_use_count_ -= returned_.TakeAll(&available_);
+  TrimAvailable(trimmed);
+}
+
 void ImageFramePool::TrimAvailable(
     std::vector<std::unique_ptr<ImageFrame>>* trimmed) {
   int keep = std::max(keep_count_ - in_use_count_, 0);
@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/formats/concurrent_pool_util.h"
 #include "mediapipe/framework/formats/image_frame.h"
 
 namespace mediapipe {
@@ -55,9 +56,14 @@ class ImageFramePool : public std::enable_shared_from_this<ImageFramePool> {
   ImageFramePool(int width, int height, ImageFormat::Format format,
                  int keep_count);
 
-  // Return a buffer to the pool.
+  // Return a buffer to the pool. This does not take the lock unless enough
+  // buffers have been returned to merge them into available_.
   void Return(ImageFrame* buf);
 
+  // Moves the returned buffers to available_, then trims it.
+  void MergeReturned(std::vector<std::unique_ptr<ImageFrame>>* trimmed)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   // If the total number of buffers is greater than keep_count, destroys any
   // surplus buffers that are no longer in use.
   void TrimAvailable(std::vector<std::unique_ptr<ImageFrame>>* trimmed)
@@ -71,6 +77,7 @@ class ImageFramePool : public std::enable_shared_from_this<ImageFramePool> {
   absl::Mutex mutex_;
   int in_use_count_ ABSL_GUARDED_BY(mutex_) = 0;
   std::vector<std::unique_ptr<ImageFrame>> available_ ABSL_GUARDED_BY(mutex_);
+  PoolReturnList<ImageFrame> returned_;
 };
 
 }  // namespace mediapipe
@@ -0,0 +1,37 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_POOL_SERVICE_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_POOL_SERVICE_H_
+
+#include "mediapipe/framework/formats/image_frame_multi_pool.h"
+#include "mediapipe/framework/graph_service.h"
+
+namespace mediapipe {
+
+// Lets the calculators of a graph allocate their CPU output frames from a
+// shared ImageFrameMultiPool. The service is optional and has no default; to
+// enable it, set it before starting the graph:
+//
+//   MP_RETURN_IF_ERROR(graph.SetServiceObject(
+//       kImageFramePoolService, ImageFrameMultiPool::Create()));
+//
+// The calculators that support it request it as an optional service and
+// allocate new frames without it.
+extern const GraphService<ImageFrameMultiPool> kImageFramePoolService;
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_POOL_SERVICE_H_
@@ -14,6 +14,7 @@
 
 #include "mediapipe/framework/formats/image_multi_pool.h"
 
+#include <algorithm>
 #include <tuple>
 
 #include "absl/memory/memory.h"
@@ -121,67 +122,82 @@ Image ImageMultiPool::GetBufferFromSimplePool(
   return Image(pool->GetBuffer());
 }
 
+namespace {
+
+// Returns the pool for key from an LRU cache of at most kMaxPoolCount pools,
+// creating it if needed. specs holds the keys of pools, least recently used
+// first.
+template <typename Pool, typename MakePool>
+Pool LookupLruPool(
+    const ImageMultiPool::IBufferSpec& key,
+    std::unordered_map<ImageMultiPool::IBufferSpec, Pool,
+                       ImageMultiPool::IBufferSpecHash>& pools,
+    std::deque<ImageMultiPool::IBufferSpec>& specs, MakePool make_pool) {
+  auto pool_it = pools.find(key);
+  if (pool_it == pools.end()) {
+    // Discard the least recently used pool in LRU cache.
+    if (pools.size() >= kMaxPoolCount) {
+      auto old_spec = specs.front();  // Front has LRU.
+      specs.pop_front();
+      pools.erase(old_spec);
+    }
+    specs.push_back(key);  // Push new spec to back.
+    std::tie(pool_it, std::ignore) = pools.emplace(key, make_pool(key));
+  } else {
+    // Find and move current 'key' spec to back, keeping others in same order.
+    auto specs_it = std::find(specs.begin(), specs.end(), key);
+    if (specs_it != specs.end()) specs.erase(specs_it);
+    specs.push_back(key);
+  }
+  return pool_it->second;
+}
+
+}  // namespace
+
+#if !MEDIAPIPE_DISABLE_GPU
+ImageMultiPool::SimplePoolGpu ImageMultiPool::LookupPoolGpu(
+    const IBufferSpec& spec) {
+  absl::MutexLock lock(&mutex_gpu_);
+  return LookupLruPool(spec, pools_gpu_, buffer_specs_gpu_,
+                       [this](const IBufferSpec& spec) {
+                         return MakeSimplePoolGpu(spec);
+                       });
+}
+#endif  // !MEDIAPIPE_DISABLE_GPU
+
+ImageMultiPool::SimplePoolCpu ImageMultiPool::LookupPoolCpu(
+    const IBufferSpec& spec) {
+  absl::MutexLock lock(&mutex_cpu_);
+  return LookupLruPool(spec, pools_cpu_, buffer_specs_cpu_,
+                       [this](const IBufferSpec& spec) {
+                         return MakeSimplePoolCpu(spec);
+                       });
+}
+
 Image ImageMultiPool::GetBuffer(int width, int height, bool use_gpu,
                                 ImageFormat::Format format) {
+  IBufferSpec key(width, height, format);
+  // Buffers are taken from the pool outside of the multi-pool's lock; the
+  // simple pools are thread-safe.
 #if !MEDIAPIPE_DISABLE_GPU
   if (use_gpu) {
-    absl::MutexLock lock(&mutex_gpu_);
-    IBufferSpec key(width, height, format);
-    auto pool_it = pools_gpu_.find(key);
-    if (pool_it == pools_gpu_.end()) {
-      // Discard the least recently used pool in LRU cache.
-      if (pools_gpu_.size() >= kMaxPoolCount) {
-        auto old_spec = buffer_specs_gpu_.front();  // Front has LRU.
-        buffer_specs_gpu_.pop_front();
-        pools_gpu_.erase(old_spec);
-      }
-      buffer_specs_gpu_.push_back(key);  // Push new spec to back.
-      std::tie(pool_it, std::ignore) = pools_gpu_.emplace(
-          std::piecewise_construct, std::forward_as_tuple(key),
-          std::forward_as_tuple(MakeSimplePoolGpu(key)));
-    } else {
-      // Find and move current 'key' spec to back, keeping others in same order.
-      auto specs_it = buffer_specs_gpu_.begin();
-      while (specs_it != buffer_specs_gpu_.end()) {
-        if (*specs_it == key) {
-          buffer_specs_gpu_.erase(specs_it);
-          break;
-        }
-        ++specs_it;
-      }
-      buffer_specs_gpu_.push_back(key);
-    }
-    return GetBufferFromSimplePool(pool_it->first, pool_it->second);
+#if MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
+    SimplePoolGpu pool = LookupPoolGpu(key);
+#else
+    SimplePoolGpu pool = thread_cache_gpu_.Get(
+        key, [this](const IBufferSpec& spec, int /*request_count*/) {
+          return LookupPoolGpu(spec);
+        });
+#endif  // MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
+    return GetBufferFromSimplePool(key, pool);
   } else  // NOLINT(readability/braces)
 #endif    // !MEDIAPIPE_DISABLE_GPU
   {
-    absl::MutexLock lock(&mutex_cpu_);
-    IBufferSpec key(width, height, format);
-    auto pool_it = pools_cpu_.find(key);
-    if (pool_it == pools_cpu_.end()) {
-      // Discard the least recently used pool in LRU cache.
-      if (pools_cpu_.size() >= kMaxPoolCount) {
-        auto old_spec = buffer_specs_cpu_.front();  // Front has LRU.
-        buffer_specs_cpu_.pop_front();
-        pools_cpu_.erase(old_spec);
-      }
-      buffer_specs_cpu_.push_back(key);  // Push new spec to back.
-      std::tie(pool_it, std::ignore) = pools_cpu_.emplace(
-          std::piecewise_construct, std::forward_as_tuple(key),
-          std::forward_as_tuple(MakeSimplePoolCpu(key)));
-    } else {
-      // Find and move current 'key' spec to back, keeping others in same order.
-      auto specs_it = buffer_specs_cpu_.begin();
-      while (specs_it != buffer_specs_cpu_.end()) {
-        if (*specs_it == key) {
-          buffer_specs_cpu_.erase(specs_it);
-          break;
-        }
-        ++specs_it;
-      }
-      buffer_specs_cpu_.push_back(key);
-    }
-    return GetBufferFromSimplePool(pool_it->first, pool_it->second);
+    SimplePoolCpu pool = thread_cache_cpu_.Get(
+        key, [this](const IBufferSpec& spec, int /*request_count*/) {
+          return LookupPoolCpu(spec);
+        });
+    return GetBufferFromSimplePool(key, pool);
   }
 }
 
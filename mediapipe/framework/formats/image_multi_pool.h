@@ -27,6 +27,7 @@
 #include <unordered_map>
 
 #include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/formats/concurrent_pool_util.h"
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/formats/image_frame_pool.h"
 
@@ -109,6 +110,7 @@ class ImageMultiPool {
 #endif  // MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
   SimplePoolGpu MakeSimplePoolGpu(IBufferSpec spec);
   Image GetBufferFromSimplePool(IBufferSpec spec, const SimplePoolGpu& pool);
+  SimplePoolGpu LookupPoolGpu(const IBufferSpec& spec);
 
   absl::Mutex mutex_gpu_;
   std::unordered_map<IBufferSpec, SimplePoolGpu, IBufferSpecHash> pools_gpu_
@@ -116,11 +118,15 @@ class ImageMultiPool {
   // A queue of IBufferSpecs to keep track of the age of each IBufferSpec added
   // to the pool.
   std::deque<IBufferSpec> buffer_specs_gpu_;
+#if !MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
+  PoolThreadCache<IBufferSpec, SimplePoolGpu> thread_cache_gpu_;
+#endif  // !MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
 #endif  // !MEDIAPIPE_DISABLE_GPU
 
   typedef std::shared_ptr<ImageFramePool> SimplePoolCpu;
   SimplePoolCpu MakeSimplePoolCpu(IBufferSpec spec);
   Image GetBufferFromSimplePool(IBufferSpec spec, const SimplePoolCpu& pool);
+  SimplePoolCpu LookupPoolCpu(const IBufferSpec& spec);
 
   absl::Mutex mutex_cpu_;
   std::unordered_map<IBufferSpec, SimplePoolCpu, IBufferSpecHash> pools_cpu_
@@ -128,6 +134,8 @@ class ImageMultiPool {
   // A queue of IBufferSpecs to keep track of the age of each IBufferSpec added
   // to the pool.
   std::deque<IBufferSpec> buffer_specs_cpu_;
+  // Lets threads that keep requesting the same sizes skip mutex_cpu_.
+  PoolThreadCache<IBufferSpec, SimplePoolCpu> thread_cache_cpu_;
 
 #if !MEDIAPIPE_DISABLE_GPU
 #ifdef __APPLE__
@@ -0,0 +1,78 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures buffer pools when several threads allocate and release buffers at
+// the same time, as calculators on different executor threads do. Each thread
+// holds a few buffers at once, like a calculator with frames in flight.
+
+#include <memory>
+#include <vector>
+
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame_pool.h"
+#include "mediapipe/framework/formats/image_multi_pool.h"
+#include "mediapipe/framework/port/benchmark.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kWidth = 640;
+constexpr int kHeight = 480;
+constexpr int kBuffersInFlight = 3;
+
+// All threads share one size, so they all contend on one simple pool.
+void BM_ImageFramePoolGetBuffer(benchmark::State& state) {
+  static auto* pool = new std::shared_ptr<ImageFramePool>(
+      ImageFramePool::Create(kWidth, kHeight, ImageFormat::SRGBA,
+                             /*keep_count=*/kBuffersInFlight * 8));
+  std::vector<ImageFrameSharedPtr> in_flight(kBuffersInFlight);
+  int i = 0;
+  for (auto _ : state) {
+    in_flight[i++ % kBuffersInFlight] = (*pool)->GetBuffer();
+  }
+}
+
+// All threads request the same size from a shared multi-pool.
+void BM_ImageMultiPoolGetBuffer(benchmark::State& state) {
+  static ImageMultiPool* pool = new ImageMultiPool();
+  std::vector<Image> in_flight(kBuffersInFlight);
+  int i = 0;
+  for (auto _ : state) {
+    in_flight[i++ % kBuffersInFlight] =
+        pool->GetBuffer(kWidth, kHeight, /*use_gpu=*/false, ImageFormat::SRGBA);
+  }
+}
+
+// Each thread requests its own size from a shared multi-pool, so only the
+// multi-pool's lookup is shared.
+void BM_ImageMultiPoolGetBufferPerThreadSize(benchmark::State& state) {
+  static ImageMultiPool* pool = new ImageMultiPool();
+  const int width = kWidth + state.thread_index() * 16;
+  std::vector<Image> in_flight(kBuffersInFlight);
+  int i = 0;
+  for (auto _ : state) {
+    in_flight[i++ % kBuffersInFlight] =
+        pool->GetBuffer(width, kHeight, /*use_gpu=*/false, ImageFormat::SRGBA);
+  }
+}
+
+BENCHMARK(BM_ImageFramePoolGetBuffer)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_ImageMultiPoolGetBuffer)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_ImageMultiPoolGetBufferPerThreadSize)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,152 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/packed_landmarks.h"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace mediapipe {
+
+namespace {
+
+template <typename LandmarkListT>
+PackedLandmarks Pack(const LandmarkListT& landmarks) {
+  PackedLandmarks packed(landmarks.landmark_size());
+  if (packed.empty()) return packed;
+  packed.set_has_visibility(landmarks.landmark(0).has_visibility());
+  packed.set_has_presence(landmarks.landmark(0).has_presence());
+  for (int i = 0; i < packed.size(); ++i) {
+    const auto& landmark = landmarks.landmark(i);
+    packed.x()[i] = landmark.x();
+    packed.y()[i] = landmark.y();
+    packed.z()[i] = landmark.z();
+    packed.visibility()[i] = landmark.visibility();
+    packed.presence()[i] = landmark.presence();
+  }
+  return packed;
+}
+
+template <typename LandmarkListT>
+LandmarkListT Unpack(const PackedLandmarks& packed) {
+  LandmarkListT landmarks;
+  landmarks.mutable_landmark()->Reserve(packed.size());
+  for (int i = 0; i < packed.size(); ++i) {
+    auto* landmark = landmarks.add_landmark();
+    landmark->set_x(packed.x()[i]);
+    landmark->set_y(packed.y()[i]);
+    landmark->set_z(packed.z()[i]);
+    if (packed.has_visibility()) {
+      landmark->set_visibility(packed.visibility()[i]);
+    }
+    if (packed.has_presence()) {
+      landmark->set_presence(packed.presence()[i]);
+    }
+  }
+  return landmarks;
+}
+
+}  // namespace
+
+void PackedLandmarks::Transform(const std::array<float, 16>& matrix,
+                                float z_scale) {
+  float* xs = x();
+  float* ys = y();
+  float* zs = z();
+  int i = 0;
+#if defined(__SSE2__)
+  const __m128 m0 = _mm_set1_ps(matrix[0]);
+  const __m128 m1 = _mm_set1_ps(matrix[1]);
+  const __m128 m2 = _mm_set1_ps(matrix[2]);
+  const __m128 m3 = _mm_set1_ps(matrix[3]);
+  const __m128 m4 = _mm_set1_ps(matrix[4]);
+  const __m128 m5 = _mm_set1_ps(matrix[5]);
+  const __m128 m6 = _mm_set1_ps(matrix[6]);
+  const __m128 m7 = _mm_set1_ps(matrix[7]);
+  const __m128 z_scale_v = _mm_set1_ps(z_scale);
+  for (; i + 4 <= size_; i += 4) {
+    const __m128 px = _mm_loadu_ps(xs + i);
+    const __m128 py = _mm_loadu_ps(ys + i);
+    const __m128 pz = _mm_loadu_ps(zs + i);
+    const __m128 new_x = _mm_add_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, m0), _mm_mul_ps(py, m1)),
+                   _mm_mul_ps(pz, m2)),
+        m3);
+    const __m128 new_y = _mm_add_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, m4), _mm_mul_ps(py, m5)),
+                   _mm_mul_ps(pz, m6)),
+        m7);
+    _mm_storeu_ps(xs + i, new_x);
+    _mm_storeu_ps(ys + i, new_y);
+    _mm_storeu_ps(zs + i, _mm_mul_ps(pz, z_scale_v));
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const float32x4_t m0 = vdupq_n_f32(matrix[0]);
+  const float32x4_t m1 = vdupq_n_f32(matrix[1]);
+  const float32x4_t m2 = vdupq_n_f32(matrix[2]);
+  const float32x4_t m3 = vdupq_n_f32(matrix[3]);
+  const float32x4_t m4 = vdupq_n_f32(matrix[4]);
+  const float32x4_t m5 = vdupq_n_f32(matrix[5]);
+  const float32x4_t m6 = vdupq_n_f32(matrix[6]);
+  const float32x4_t m7 = vdupq_n_f32(matrix[7]);
+  const float32x4_t z_scale_v = vdupq_n_f32(z_scale);
+  for (; i + 4 <= size_; i += 4) {
+    const float32x4_t px = vld1q_f32(xs + i);
+    const float32x4_t py = vld1q_f32(ys + i);
+    const float32x4_t pz = vld1q_f32(zs + i);
+    const float32x4_t new_x = vaddq_f32(
+        vaddq_f32(vaddq_f32(vmulq_f32(px, m0), vmulq_f32(py, m1)),
+                  vmulq_f32(pz, m2)),
+        m3);
+    const float32x4_t new_y = vaddq_f32(
+        vaddq_f32(vaddq_f32(vmulq_f32(px, m4), vmulq_f32(py, m5)),
+                  vmulq_f32(pz, m6)),
+        m7);
+    vst1q_f32(xs + i, new_x);
+    vst1q_f32(ys + i, new_y);
+    vst1q_f32(zs + i, vmulq_f32(pz, z_scale_v));
+  }
+#endif
+  for (; i < size_; ++i) {
+    const float px = xs[i];
+    const float py = ys[i];
+    const float pz = zs[i];
+    xs[i] = px * matrix[0] + py * matrix[1] + pz * matrix[2] + matrix[3];
+    ys[i] = px * matrix[4] + py * matrix[5] + pz * matrix[6] + matrix[7];
+    zs[i] = pz * z_scale;
+  }
+}
+
+PackedLandmarks PackLandmarks(const LandmarkList& landmarks) {
+  return Pack(landmarks);
+}
+
+PackedLandmarks PackLandmarks(const NormalizedLandmarkList& landmarks) {
+  return Pack(landmarks);
+}
+
+LandmarkList ToLandmarkList(const PackedLandmarks& landmarks) {
+  return Unpack<LandmarkList>(landmarks);
+}
+
+NormalizedLandmarkList ToNormalizedLandmarkList(
+    const PackedLandmarks& landmarks) {
+  return Unpack<NormalizedLandmarkList>(landmarks);
+}
+
+}  // namespace mediapipe
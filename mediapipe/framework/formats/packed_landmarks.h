@@ -0,0 +1,85 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_PACKED_LANDMARKS_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_PACKED_LANDMARKS_H_
+
+#include <array>
+#include <vector>
+
+#include "mediapipe/framework/formats/landmark.pb.h"
+
+namespace mediapipe {
+
+// A list of landmarks packed into a single float buffer.
+//
+// The buffer holds five planes of size() floats each: x, y, z, visibility and
+// presence. Keeping every attribute contiguous lets calculators transform all
+// landmarks of a list in place with vector instructions, instead of copying
+// LandmarkList or NormalizedLandmarkList protos field by field. Whether the
+// coordinates are normalized is up to the stream carrying the packet, as with
+// the protos.
+//
+// Visibility and presence are tracked per list: a model either provides them
+// for every landmark or for none.
+class PackedLandmarks {
+ public:
+  PackedLandmarks() = default;
+  // Creates |size| landmarks with all attributes set to zero.
+  explicit PackedLandmarks(int size) : size_(size), data_(size * 5, 0.0f) {}
+
+  int size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  float* x() { return data_.data(); }
+  float* y() { return data_.data() + size_; }
+  float* z() { return data_.data() + size_ * 2; }
+  float* visibility() { return data_.data() + size_ * 3; }
+  float* presence() { return data_.data() + size_ * 4; }
+  const float* x() const { return data_.data(); }
+  const float* y() const { return data_.data() + size_; }
+  const float* z() const { return data_.data() + size_ * 2; }
+  const float* visibility() const { return data_.data() + size_ * 3; }
+  const float* presence() const { return data_.data() + size_ * 4; }
+
+  bool has_visibility() const { return has_visibility_; }
+  void set_has_visibility(bool value) { has_visibility_ = value; }
+  bool has_presence() const { return has_presence_; }
+  void set_has_presence(bool value) { has_presence_ = value; }
+
+  // Applies the first two rows of the row-major 4x4 |matrix| to (x, y, z, 1)
+  // of every landmark to get the new x and y, and multiplies z by |z_scale|.
+  void Transform(const std::array<float, 16>& matrix, float z_scale);
+
+ private:
+  int size_ = 0;
+  std::vector<float> data_;
+  bool has_visibility_ = false;
+  bool has_presence_ = false;
+};
+
+// Packs landmark protos. Visibility and presence are considered present if the
+// first landmark has them.
+PackedLandmarks PackLandmarks(const LandmarkList& landmarks);
+PackedLandmarks PackLandmarks(const NormalizedLandmarkList& landmarks);
+
+// Unpacks to landmark protos. Visibility and presence are only set if the
+// packed landmarks have them.
+LandmarkList ToLandmarkList(const PackedLandmarks& landmarks);
+NormalizedLandmarkList ToNormalizedLandmarkList(
+    const PackedLandmarks& landmarks);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_PACKED_LANDMARKS_H_
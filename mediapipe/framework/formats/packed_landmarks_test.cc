@@ -0,0 +1,95 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/packed_landmarks.h"
+
+#include <array>
+#include <vector>
+
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::FloatEq;
+
+TEST(PackedLandmarksTest, RoundTripsNormalizedLandmarks) {
+  const NormalizedLandmarkList landmarks =
+      ParseTextProtoOrDie<NormalizedLandmarkList>(R"pb(
+        landmark { x: 0.1 y: 0.2 z: 0.3 visibility: 0.4 presence: 0.5 }
+        landmark { x: 0.6 y: 0.7 z: 0.8 visibility: 0.9 presence: 1.0 }
+      )pb");
+  const PackedLandmarks packed = PackLandmarks(landmarks);
+  ASSERT_EQ(packed.size(), 2);
+  EXPECT_TRUE(packed.has_visibility());
+  EXPECT_TRUE(packed.has_presence());
+  EXPECT_FLOAT_EQ(packed.y()[1], 0.7f);
+  EXPECT_FLOAT_EQ(packed.visibility()[0], 0.4f);
+
+  const NormalizedLandmarkList unpacked = ToNormalizedLandmarkList(packed);
+  ASSERT_EQ(unpacked.landmark_size(), 2);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(unpacked.landmark(i).SerializeAsString(),
+              landmarks.landmark(i).SerializeAsString());
+  }
+}
+
+TEST(PackedLandmarksTest, LeavesMissingVisibilityAndPresenceUnset) {
+  const LandmarkList landmarks = ParseTextProtoOrDie<LandmarkList>(R"pb(
+    landmark { x: 1 y: 2 z: 3 }
+  )pb");
+  const PackedLandmarks packed = PackLandmarks(landmarks);
+  EXPECT_FALSE(packed.has_visibility());
+  EXPECT_FALSE(packed.has_presence());
+
+  const LandmarkList unpacked = ToLandmarkList(packed);
+  ASSERT_EQ(unpacked.landmark_size(), 1);
+  EXPECT_FALSE(unpacked.landmark(0).has_visibility());
+  EXPECT_FALSE(unpacked.landmark(0).has_presence());
+  EXPECT_FLOAT_EQ(unpacked.landmark(0).z(), 3.0f);
+}
+
+TEST(PackedLandmarksTest, TransformsAllLandmarks) {
+  // Enough landmarks to cover both the vectorized loop and its tail.
+  PackedLandmarks packed(7);
+  for (int i = 0; i < packed.size(); ++i) {
+    packed.x()[i] = i;
+    packed.y()[i] = 2 * i;
+    packed.z()[i] = 1.0f;
+  }
+  // x' = 2x + y + 1, y' = -y + z, z' = 3z.
+  const std::array<float, 16> matrix = {2, 1, 0, 1, 0, -1, 1, 0,
+                                        0, 0, 1, 0, 0, 0,  0, 1};
+  packed.Transform(matrix, 3.0f);
+  for (int i = 0; i < packed.size(); ++i) {
+    EXPECT_FLOAT_EQ(packed.x()[i], 4 * i + 1) << i;
+    EXPECT_FLOAT_EQ(packed.y()[i], 1 - 2 * i) << i;
+    EXPECT_FLOAT_EQ(packed.z()[i], 3.0f) << i;
+  }
+}
+
+TEST(PackedLandmarksTest, CreatesZeroedLandmarks) {
+  const PackedLandmarks packed(2);
+  EXPECT_THAT(std::vector<float>(packed.x(), packed.x() + 2),
+              ElementsAre(FloatEq(0), FloatEq(0)));
+  EXPECT_THAT(std::vector<float>(packed.presence(), packed.presence() + 2),
+              ElementsAre(FloatEq(0), FloatEq(0)));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -18,6 +18,7 @@
 #include <utility>
 
 #include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/packet_payload_size.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/logging.h"
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30
@@ -378,6 +379,8 @@ Tensor& Tensor::operator=(Tensor&& src) {
 }
 
 void Tensor::Move(Tensor* src) {
+  recycler_ = std::move(src->recycler_);
+  src->recycler_ = nullptr;
   valid_ = src->valid_;
   src->valid_ = kValidNone;
   shape_ = src->shape();
@@ -417,6 +420,26 @@ Tensor::Tensor(ElementType element_type, const Shape& shape,
       shape_(shape),
       quantization_parameters_(quantization_parameters) {}
 
+Tensor::~Tensor() {
+  if (recycler_) {
+    // The recycler takes over the buffers, which leaves nothing to release.
+    auto recycler = std::move(recycler_);
+    recycler_ = nullptr;
+    recycler(std::move(*this));
+  }
+  Invalidate();
+}
+
+bool Tensor::CanRecycle() const {
+#ifdef MEDIAPIPE_TENSOR_USE_AHWB
+  // An AHardwareBuffer is released only after its fences are signaled, see
+  // ReleaseAhwbStuff().
+  return ahwb_ == nullptr;
+#else
+  return true;
+#endif  // MEDIAPIPE_TENSOR_USE_AHWB
+}
+
 #if MEDIAPIPE_METAL_ENABLED
 void Tensor::Invalidate() {
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30
@@ -504,6 +527,19 @@ void Tensor::Invalidate() {
 #endif  // MEDIAPIPE_METAL_ENABLED
 
 Tensor::CpuReadView Tensor::GetCpuReadView() const {
+  {
+    // Once the CPU buffer is valid, readers only need to exclude writers.
+    auto reader_lock = absl::make_unique<absl::ReaderMutexLock>(&view_mutex_);
+    bool cpu_buffer_valid = (valid_ & kValidCpu) && cpu_buffer_;
+#ifdef MEDIAPIPE_TENSOR_USE_AHWB
+    // A mapped AHardwareBuffer takes the place of the CPU buffer.
+    cpu_buffer_valid = cpu_buffer_valid && !ahwb_;
+#endif  // MEDIAPIPE_TENSOR_USE_AHWB
+    if (cpu_buffer_valid) {
+      return {cpu_buffer_, std::move(reader_lock)};
+    }
+  }
+  // The CPU buffer has to be allocated or synchronized from another storage.
   auto lock = absl::make_unique<absl::MutexLock>(&view_mutex_);
   LOG_IF(FATAL, valid_ == kValidNone)
       << "Tensor must be written prior to read from.";
@@ -635,4 +671,14 @@ Tensor::StorageType Tensor::GetPreferredStorageType() {
 #endif  // MEDIAPIPE_TENSOR_USE_AHWB
 }
 
+MEDIAPIPE_REGISTER_PAYLOAD_SIZE(Tensor, [](const Tensor& tensor) -> size_t {
+  return tensor.bytes();
+});
+MEDIAPIPE_REGISTER_PAYLOAD_SIZE(
+    std::vector<Tensor>, [](const std::vector<Tensor>& tensors) -> size_t {
+      size_t bytes = 0;
+      for (const Tensor& tensor : tensors) bytes += tensor.bytes();
+      return bytes;
+    });
+
 }  // namespace mediapipe
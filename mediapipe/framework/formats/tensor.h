@@ -74,6 +74,12 @@ namespace mediapipe {
 // auto view = tensor.GetCpuReadView();
 // float* pointer = view.buffer<float>();
 // ...reading the cpu memory...
+//
+// Once the CPU memory is up to date, any number of CPU read views can be held
+// at the same time, e.g. by calculators that read the same tensor in parallel.
+// All other views are exclusive.
+
+class TensorPool;
 
 class Tensor {
   class View {
@@ -85,7 +91,11 @@ class Tensor {
 
    protected:
     View(std::unique_ptr<absl::MutexLock>&& lock) : lock_(std::move(lock)) {}
+    // Views that only read an up-to-date storage share the view mutex.
+    View(std::unique_ptr<absl::ReaderMutexLock>&& lock)
+        : reader_lock_(std::move(lock)) {}
     std::unique_ptr<absl::MutexLock> lock_;
+    std::unique_ptr<absl::ReaderMutexLock> reader_lock_;
   };
 
  public:
@@ -130,7 +140,7 @@ class Tensor {
   // Move-only.
   Tensor(Tensor&& src) { Move(&src); }
   Tensor& operator=(Tensor&&);
-  ~Tensor() { Invalidate(); }
+  ~Tensor();
 
   template <typename T>
   class CpuView : public View {
@@ -156,6 +166,8 @@ class Tensor {
         : View(std::move(lock)),
           buffer_(buffer),
           release_callback_(release_callback) {}
+    CpuView(T* buffer, std::unique_ptr<absl::ReaderMutexLock>&& lock)
+        : View(std::move(lock)), buffer_(buffer) {}
     T* buffer_;
     std::function<void()> release_callback_;
   };
@@ -359,8 +371,13 @@ class Tensor {
   static StorageType GetPreferredStorageType();
 
  private:
+  friend class TensorPool;
+
   void Move(Tensor*);
   void Invalidate();
+  // Returns false if the buffers of this tensor can't be handed to another
+  // tensor, see TensorPool.
+  bool CanRecycle() const;
 
   ElementType element_type_;
   Shape shape_;
@@ -378,8 +395,11 @@ class Tensor {
   // A list of resource which are currently allocated and synchronized between
   // each-other: valid_ = kValidCpu | kValidMetalBuffer;
   mutable int valid_ = 0;
-  // The mutex is locked by Get*View and is kept by all Views.
+  // The mutex is locked by Get*View and is kept by all Views. CPU read views
+  // of an up-to-date CPU buffer hold it in shared mode.
   mutable absl::Mutex view_mutex_;
+  // If set, receives this tensor with its buffers when it is destroyed.
+  std::function<void(Tensor&&)> recycler_;
 
   mutable void* cpu_buffer_ = nullptr;
   void AllocateCpuBuffer() const;
@@ -242,8 +242,9 @@ void Tensor::CreateEglSyncAndFd() const {
         }
       }
     }
-    // Can't use Sync object.
-    if (fence_sync_ == EGL_NO_SYNC_KHR) glFinish();
+    // Can't export a native fence. Wait on the context's own sync token, which
+    // avoids glFinish when the context supports GL or EGL fences.
+    if (fence_sync_ == EGL_NO_SYNC_KHR) gl_context_->CreateSyncToken()->Wait();
   });
 }
 
@@ -370,8 +371,7 @@ void* Tensor::MapAhwbToCpuRead() const {
       if (!(valid_ & kValidCpu)) {
         if ((valid_ & kValidOpenGlBuffer) && ssbo_written_ == -1) {
           // EGLSync is failed. Use another synchronization method.
-          // TODO: Use tflite::gpu::GlBufferSync and GlActiveSync.
-          gl_context_->Run([]() { glFinish(); });
+          gl_context_->CreateSyncToken()->Wait();
         } else if (valid_ & kValidAHardwareBuffer) {
           CHECK(ahwb_written_) << "Ahwb-to-Cpu synchronization requires the "
                                   "completion function to be set";
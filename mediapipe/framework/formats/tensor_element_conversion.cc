@@ -0,0 +1,273 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/tensor_element_conversion.h"
+
+#include <cstring>
+
+#include "absl/strings/str_cat.h"
+
+#if defined(__F16C__) || defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace mediapipe {
+
+namespace {
+
+float HalfToFloat(uint16_t half) {
+  const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+  uint32_t exponent = (half >> 10) & 0x1f;
+  uint32_t mantissa = half & 0x3ff;
+  uint32_t bits;
+  if (exponent == 0) {
+    if (mantissa == 0) {
+      bits = sign;
+    } else {
+      // A subnormal half is a normal float.
+      exponent = 127 - 15 + 1;
+      while (!(mantissa & 0x400)) {
+        mantissa <<= 1;
+        --exponent;
+      }
+      bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+    }
+  } else if (exponent == 0x1f) {
+    bits = sign | 0x7f800000 | (mantissa << 13);
+  } else {
+    bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+  }
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+uint16_t FloatToHalf(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const uint16_t sign = (bits >> 16) & 0x8000;
+  const uint32_t abs = bits & 0x7fffffff;
+  if (abs >= 0x7f800000) {
+    // Infinity, or a quiet NaN.
+    return sign | 0x7c00 | (abs > 0x7f800000 ? 0x200 : 0);
+  }
+  if (abs >= 0x477ff000) {
+    // Rounds to a value above the largest half, 65504.
+    return sign | 0x7c00;
+  }
+  if (abs < 0x38800000) {
+    // Below the smallest normal half, 2^-14.
+    if (abs < 0x33000000) return sign;
+    const uint32_t mantissa = (abs & 0x7fffff) | 0x800000;
+    const int shift = 126 - static_cast<int>(abs >> 23);
+    uint32_t result = mantissa >> shift;
+    const uint32_t remainder = mantissa & ((1u << shift) - 1);
+    const uint32_t halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (result & 1))) {
+      ++result;
+    }
+    return sign | result;
+  }
+  // Rebiases the exponent. A carry from rounding increments the exponent.
+  uint32_t result = (abs >> 13) - ((127 - 15) << 10);
+  const uint32_t remainder = abs & 0x1fff;
+  if (remainder > 0x1000 || (remainder == 0x1000 && (result & 1))) {
+    ++result;
+  }
+  return sign | result;
+}
+
+template <typename T>
+void DequantizeScalar(const T* src, int size, float scale, int zero_point,
+                      float* dst) {
+  for (int i = 0; i < size; ++i) {
+    dst[i] = scale * (static_cast<int>(src[i]) - zero_point);
+  }
+}
+
+}  // namespace
+
+void Float16ToFloat32(const uint16_t* src, int size, float* dst) {
+  int i = 0;
+#if defined(__F16C__)
+  for (; i + 8 <= size; i += 8) {
+    const __m128i half =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(half));
+  }
+#elif defined(__aarch64__)
+  for (; i + 4 <= size; i += 4) {
+    vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i))));
+  }
+#endif
+  for (; i < size; ++i) {
+    dst[i] = HalfToFloat(src[i]);
+  }
+}
+
+void Float32ToFloat16(const float* src, int size, uint16_t* dst) {
+  int i = 0;
+#if defined(__F16C__)
+  for (; i + 8 <= size; i += 8) {
+    const __m128i half =
+        _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), half);
+  }
+#elif defined(__aarch64__)
+  for (; i + 4 <= size; i += 4) {
+    vst1_u16(dst + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src + i))));
+  }
+#endif
+  for (; i < size; ++i) {
+    dst[i] = FloatToHalf(src[i]);
+  }
+}
+
+void DequantizeToFloat32(const uint8_t* src, int size, float scale,
+                         int zero_point, float* dst) {
+  int i = 0;
+#if defined(__AVX2__)
+  const __m256 scale_v8 = _mm256_set1_ps(scale);
+  const __m256 zero_point_v8 = _mm256_set1_ps(zero_point);
+  for (; i + 16 <= size; i += 16) {
+    const __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m256 low = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+    const __m256 high =
+        _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)));
+    _mm256_storeu_ps(
+        dst + i, _mm256_mul_ps(_mm256_sub_ps(low, zero_point_v8), scale_v8));
+    _mm256_storeu_ps(
+        dst + i + 8,
+        _mm256_mul_ps(_mm256_sub_ps(high, zero_point_v8), scale_v8));
+  }
+#endif
+#if defined(__SSE2__)
+  const __m128 scale_v = _mm_set1_ps(scale);
+  const __m128 zero_point_v = _mm_set1_ps(zero_point);
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 8 <= size; i += 8) {
+    const __m128i bytes =
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i words = _mm_unpacklo_epi8(bytes, zero);
+    const __m128 low = _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero));
+    const __m128 high = _mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero));
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_sub_ps(low, zero_point_v), scale_v));
+    _mm_storeu_ps(dst + i + 4,
+                  _mm_mul_ps(_mm_sub_ps(high, zero_point_v), scale_v));
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const float32x4_t scale_v = vdupq_n_f32(scale);
+  const float32x4_t zero_point_v = vdupq_n_f32(zero_point);
+  for (; i + 8 <= size; i += 8) {
+    const uint16x8_t words = vmovl_u8(vld1_u8(src + i));
+    const float32x4_t low = vcvtq_f32_u32(vmovl_u16(vget_low_u16(words)));
+    const float32x4_t high = vcvtq_f32_u32(vmovl_u16(vget_high_u16(words)));
+    vst1q_f32(dst + i, vmulq_f32(vsubq_f32(low, zero_point_v), scale_v));
+    vst1q_f32(dst + i + 4, vmulq_f32(vsubq_f32(high, zero_point_v), scale_v));
+  }
+#endif
+  DequantizeScalar(src + i, size - i, scale, zero_point, dst + i);
+}
+
+void DequantizeToFloat32(const int8_t* src, int size, float scale,
+                         int zero_point, float* dst) {
+  int i = 0;
+#if defined(__AVX2__)
+  const __m256 scale_v8 = _mm256_set1_ps(scale);
+  const __m256 zero_point_v8 = _mm256_set1_ps(zero_point);
+  for (; i + 16 <= size; i += 16) {
+    const __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m256 low = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(bytes));
+    const __m256 high =
+        _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(bytes, 8)));
+    _mm256_storeu_ps(
+        dst + i, _mm256_mul_ps(_mm256_sub_ps(low, zero_point_v8), scale_v8));
+    _mm256_storeu_ps(
+        dst + i + 8,
+        _mm256_mul_ps(_mm256_sub_ps(high, zero_point_v8), scale_v8));
+  }
+#endif
+#if defined(__SSE2__)
+  const __m128 scale_v = _mm_set1_ps(scale);
+  const __m128 zero_point_v = _mm_set1_ps(zero_point);
+  for (; i + 8 <= size; i += 8) {
+    const __m128i bytes =
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+    // Sign-extends by moving each value to the top and shifting it back.
+    const __m128i words = _mm_srai_epi16(_mm_unpacklo_epi8(bytes, bytes), 8);
+    const __m128 low =
+        _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16));
+    const __m128 high =
+        _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(words, words), 16));
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_sub_ps(low, zero_point_v), scale_v));
+    _mm_storeu_ps(dst + i + 4,
+                  _mm_mul_ps(_mm_sub_ps(high, zero_point_v), scale_v));
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const float32x4_t scale_v = vdupq_n_f32(scale);
+  const float32x4_t zero_point_v = vdupq_n_f32(zero_point);
+  for (; i + 8 <= size; i += 8) {
+    const int16x8_t words = vmovl_s8(vld1_s8(src + i));
+    const float32x4_t low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(words)));
+    const float32x4_t high = vcvtq_f32_s32(vmovl_s16(vget_high_s16(words)));
+    vst1q_f32(dst + i, vmulq_f32(vsubq_f32(low, zero_point_v), scale_v));
+    vst1q_f32(dst + i + 4, vmulq_f32(vsubq_f32(high, zero_point_v), scale_v));
+  }
+#endif
+  DequantizeScalar(src + i, size - i, scale, zero_point, dst + i);
+}
+
+absl::Status CopyTensorToFloat32(const Tensor& tensor, float* dst) {
+  return CopyTensorToFloat32(tensor, 0, tensor.shape().num_elements(), dst);
+}
+
+absl::Status CopyTensorToFloat32(const Tensor& tensor, int begin, int size,
+                                 float* dst) {
+  if (begin < 0 || size < 0 || begin + size > tensor.shape().num_elements()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Elements [", begin, ", ", begin + size,
+                     ") are out of the tensor of ",
+                     tensor.shape().num_elements(), " elements"));
+  }
+  const Tensor::QuantizationParameters& quantization =
+      tensor.quantization_parameters();
+  auto view = tensor.GetCpuReadView();
+  switch (tensor.element_type()) {
+    case Tensor::ElementType::kFloat32:
+      std::memcpy(dst, view.buffer<float>() + begin, size * sizeof(float));
+      return absl::OkStatus();
+    case Tensor::ElementType::kFloat16:
+      Float16ToFloat32(view.buffer<uint16_t>() + begin, size, dst);
+      return absl::OkStatus();
+    case Tensor::ElementType::kUInt8:
+      DequantizeToFloat32(view.buffer<uint8_t>() + begin, size,
+                          quantization.scale, quantization.zero_point, dst);
+      return absl::OkStatus();
+    case Tensor::ElementType::kInt8:
+      DequantizeToFloat32(view.buffer<int8_t>() + begin, size,
+                          quantization.scale, quantization.zero_point, dst);
+      return absl::OkStatus();
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unsupported tensor element type: ",
+                       static_cast<int>(tensor.element_type())));
+  }
+}
+
+}  // namespace mediapipe
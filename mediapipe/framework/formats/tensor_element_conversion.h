@@ -0,0 +1,54 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Conversions between the Tensor element types and float32. The conversions
+// use F16C, AVX2, SSE2 or NEON instructions when the target supports them.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_ELEMENT_CONVERSION_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_ELEMENT_CONVERSION_H_
+
+#include <cstdint>
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/formats/tensor.h"
+
+namespace mediapipe {
+
+// Converts "size" IEEE 754 half-precision values, given as their bits, to
+// float32.
+void Float16ToFloat32(const uint16_t* src, int size, float* dst);
+
+// Converts "size" float32 values to IEEE 754 half-precision bits, rounding to
+// the nearest even value. Values that are too large become infinities.
+void Float32ToFloat16(const float* src, int size, uint16_t* dst);
+
+// Computes dst[i] = scale * (src[i] - zero_point) for "size" values.
+void DequantizeToFloat32(const uint8_t* src, int size, float scale,
+                         int zero_point, float* dst);
+void DequantizeToFloat32(const int8_t* src, int size, float scale,
+                         int zero_point, float* dst);
+
+// Copies the elements of a kFloat32, kFloat16, kUInt8 or kInt8 tensor to
+// "dst" as float32, which must have room for shape().num_elements() values.
+// kUInt8 and kInt8 tensors are dequantized with their quantization parameters.
+absl::Status CopyTensorToFloat32(const Tensor& tensor, float* dst);
+
+// Same as above for the "size" elements starting at "begin" only, so that
+// consumers of a large quantized tensor can dequantize just what they read.
+absl::Status CopyTensorToFloat32(const Tensor& tensor, int begin, int size,
+                                 float* dst);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_ELEMENT_CONVERSION_H_
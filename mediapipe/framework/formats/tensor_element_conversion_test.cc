@@ -0,0 +1,149 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/tensor_element_conversion.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+TEST(TensorElementConversionTest, RoundTripsAllHalfValues) {
+  std::vector<uint16_t> halves(1 << 16);
+  for (int i = 0; i < halves.size(); ++i) halves[i] = i;
+  std::vector<float> floats(halves.size());
+  Float16ToFloat32(halves.data(), halves.size(), floats.data());
+  std::vector<uint16_t> round_trip(halves.size());
+  Float32ToFloat16(floats.data(), floats.size(), round_trip.data());
+  for (int i = 0; i < halves.size(); ++i) {
+    if (std::isnan(floats[i])) {
+      EXPECT_EQ(round_trip[i] & 0x7c00, 0x7c00) << i;
+      EXPECT_NE(round_trip[i] & 0x3ff, 0) << i;
+    } else {
+      EXPECT_EQ(round_trip[i], halves[i]) << i;
+    }
+  }
+}
+
+TEST(TensorElementConversionTest, ConvertsSpecialValuesToHalf) {
+  // 19 values, so that both the vector loop and the scalar tail run.
+  const std::vector<float> floats = {
+      0.0f,
+      -0.0f,
+      1.0f,
+      -2.5f,
+      65504.0f,
+      65520.0f,
+      -1e10f,
+      std::numeric_limits<float>::infinity(),
+      std::pow(2.0f, -14.0f),
+      std::pow(2.0f, -24.0f),
+      std::pow(2.0f, -26.0f),
+      1.0f + std::pow(2.0f, -11.0f),
+      1.0f + 3 * std::pow(2.0f, -11.0f),
+      1.0f + std::pow(2.0f, -11.0f) + std::pow(2.0f, -20.0f),
+      0.1f,
+      -65504.0f,
+      2048.0f,
+      3.0f * std::pow(2.0f, -25.0f),
+      1e-10f};
+  const std::vector<uint16_t> expected = {
+      0x0000, 0x8000, 0x3c00, 0xc100, 0x7bff, 0x7c00, 0xfc00,
+      0x7c00, 0x0400, 0x0001, 0x0000,
+      // Ties round to the nearest even value.
+      0x3c00, 0x3c02, 0x3c01, 0x2e66, 0xfbff, 0x6800, 0x0002, 0x0000};
+  std::vector<uint16_t> halves(floats.size());
+  Float32ToFloat16(floats.data(), floats.size(), halves.data());
+  EXPECT_THAT(halves, ElementsAreArray(expected));
+
+  std::vector<float> nan = {std::numeric_limits<float>::quiet_NaN()};
+  uint16_t nan_half;
+  Float32ToFloat16(nan.data(), 1, &nan_half);
+  EXPECT_EQ(nan_half & 0x7c00, 0x7c00);
+  EXPECT_NE(nan_half & 0x3ff, 0);
+}
+
+TEST(TensorElementConversionTest, DequantizesUInt8) {
+  // Covers the 16 and 8 wide loops and the scalar tail.
+  std::vector<uint8_t> values(43);
+  for (int i = 0; i < values.size(); ++i) values[i] = i * 13;
+  std::vector<float> floats(values.size());
+  DequantizeToFloat32(values.data(), values.size(), 0.5f, 3, floats.data());
+  for (int i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(floats[i], 0.5f * (values[i] - 3)) << i;
+  }
+}
+
+TEST(TensorElementConversionTest, DequantizesInt8) {
+  std::vector<int8_t> values(43);
+  for (int i = 0; i < values.size(); ++i) values[i] = i * 5 - 110;
+  std::vector<float> floats(values.size());
+  DequantizeToFloat32(values.data(), values.size(), 0.25f, -4, floats.data());
+  for (int i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(floats[i], 0.25f * (values[i] + 4)) << i;
+  }
+}
+
+TEST(TensorElementConversionTest, CopiesTensorsToFloat32) {
+  Tensor half_tensor(Tensor::ElementType::kFloat16, Tensor::Shape{1, 3});
+  {
+    auto view = half_tensor.GetCpuWriteView();
+    const float values[] = {1.0f, -2.5f, 0.5f};
+    Float32ToFloat16(values, 3, view.buffer<uint16_t>());
+  }
+  std::vector<float> floats(3);
+  MP_ASSERT_OK(CopyTensorToFloat32(half_tensor, floats.data()));
+  EXPECT_THAT(floats, ElementsAreArray({1.0f, -2.5f, 0.5f}));
+
+  Tensor quantized_tensor(Tensor::ElementType::kInt8, Tensor::Shape{1, 3},
+                          Tensor::QuantizationParameters(0.5f, 2));
+  {
+    auto view = quantized_tensor.GetCpuWriteView();
+    int8_t* buffer = view.buffer<int8_t>();
+    buffer[0] = -2;
+    buffer[1] = 2;
+    buffer[2] = 10;
+  }
+  MP_ASSERT_OK(CopyTensorToFloat32(quantized_tensor, floats.data()));
+  EXPECT_THAT(floats, ElementsAreArray({-2.0f, 0.0f, 4.0f}));
+
+  Tensor bool_tensor(Tensor::ElementType::kBool, Tensor::Shape{1, 3});
+  EXPECT_FALSE(CopyTensorToFloat32(bool_tensor, floats.data()).ok());
+}
+
+TEST(TensorElementConversionTest, CopiesTensorSlicesToFloat32) {
+  Tensor tensor(Tensor::ElementType::kUInt8, Tensor::Shape{1, 5},
+                Tensor::QuantizationParameters(0.5f, 1));
+  {
+    auto view = tensor.GetCpuWriteView();
+    uint8_t* buffer = view.buffer<uint8_t>();
+    for (int i = 0; i < 5; ++i) buffer[i] = i * 2;
+  }
+  std::vector<float> floats(2);
+  MP_ASSERT_OK(CopyTensorToFloat32(tensor, 2, 2, floats.data()));
+  EXPECT_THAT(floats, ElementsAreArray({1.5f, 2.5f}));
+  EXPECT_FALSE(CopyTensorToFloat32(tensor, 4, 2, floats.data()).ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
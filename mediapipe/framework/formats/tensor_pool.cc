@@ -0,0 +1,109 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/tensor_pool.h"
+
+#include <algorithm>
+
+#include "absl/synchronization/mutex.h"
+
+namespace mediapipe {
+
+Tensor TensorPool::GetTensor(
+    Tensor::ElementType element_type, const Tensor::Shape& shape,
+    const Tensor::QuantizationParameters& quantization_parameters) {
+  Tensor tensor(element_type, shape, quantization_parameters);
+  // The trimmed tensors are released after the lock.
+  std::vector<Tensor> trimmed;
+  {
+    absl::MutexLock lock(&mutex_);
+    ++request_count_;
+    ++in_use_count_;
+    // Prefers the most recently returned tensor, whose memory is most likely
+    // still cached.
+    auto it = std::find_if(available_.rbegin(), available_.rend(),
+                           [&](const Available& available) {
+                             return available.tensor.element_type() ==
+                                        element_type &&
+                                    available.tensor.shape().dims == shape.dims;
+                           });
+    if (it != available_.rend()) {
+      AddAvailableBytes(-it->tensor.bytes());
+      tensor = std::move(it->tensor);
+      available_.erase(std::next(it).base());
+    }
+    TrimAvailable(&trimmed);
+  }
+  // Move() does not transfer the quantization parameters.
+  tensor.quantization_parameters_ = quantization_parameters;
+  tensor.valid_ = Tensor::kValidNone;
+  std::weak_ptr<TensorPool> weak_pool(shared_from_this());
+  tensor.recycler_ = [weak_pool](Tensor&& returned) {
+    auto pool = weak_pool.lock();
+    if (pool) {
+      pool->Return(std::move(returned));
+    }
+  };
+  return tensor;
+}
+
+void TensorPool::SetMemoryBudget(std::shared_ptr<MemoryBudget> memory_budget) {
+  absl::MutexLock lock(&mutex_);
+  memory_budget_ = std::move(memory_budget);
+}
+
+TensorPool::~TensorPool() {
+  if (memory_budget_) {
+    memory_budget_->Add(-available_bytes_);
+  }
+}
+
+std::pair<int, int> TensorPool::GetInUseAndAvailableCounts() {
+  absl::MutexLock lock(&mutex_);
+  return {in_use_count_, available_.size()};
+}
+
+void TensorPool::Return(Tensor&& returned) {
+  // The tensors are released after the lock.
+  Tensor tensor(std::move(returned));
+  std::vector<Tensor> trimmed;
+  absl::MutexLock lock(&mutex_);
+  --in_use_count_;
+  if (tensor.CanRecycle()) {
+    AddAvailableBytes(tensor.bytes());
+    available_.push_back({std::move(tensor), request_count_});
+    TrimAvailable(&trimmed);
+  }
+}
+
+void TensorPool::TrimAvailable(std::vector<Tensor>* trimmed) {
+  while (!available_.empty() &&
+         (static_cast<int>(available_.size()) > max_available_ ||
+          request_count_ - available_.front().returned_at >
+              max_idle_requests_ ||
+          (memory_budget_ && memory_budget_->IsExceeded()))) {
+    AddAvailableBytes(-available_.front().tensor.bytes());
+    trimmed->push_back(std::move(available_.front().tensor));
+    available_.pop_front();
+  }
+}
+
+void TensorPool::AddAvailableBytes(int64 bytes) {
+  available_bytes_ += bytes;
+  if (memory_budget_) {
+    memory_budget_->Add(bytes);
+  }
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,109 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_POOL_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_POOL_H_
+
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/memory_budget.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// Lets a calculator reuse the buffers of the tensors it outputs on every frame.
+// A tensor obtained from the pool keeps its CPU, OpenGL and Metal buffers when
+// it is destroyed, e.g. when the last packet holding it goes away, and the pool
+// hands these buffers out again for the next tensor with the same element type
+// and shape. The contents of a reused tensor are undefined, so the caller
+// writes it before reading it, as with a new tensor. Tensors backed by an
+// AHardwareBuffer are released as usual.
+//
+//   // In Open():
+//   tensor_pool_ = TensorPool::Create();
+//   // In Process():
+//   output_tensors->push_back(tensor_pool_->GetTensor(
+//       Tensor::ElementType::kFloat32, Tensor::Shape{1, height, width, 3}));
+//
+// This class is thread-safe.
+class TensorPool : public std::enable_shared_from_this<TensorPool> {
+ public:
+  // Creates a pool that keeps at most "max_available" unused tensors, and
+  // releases the unused tensors that have not been reused during the last
+  // "max_idle_requests" calls to GetTensor(). We enforce creation as a
+  // shared_ptr so that we can use a weak reference in the tensors' recyclers.
+  static std::shared_ptr<TensorPool> Create(int max_available = 8,
+                                            int max_idle_requests = 100) {
+    return std::shared_ptr<TensorPool>(
+        new TensorPool(max_available, max_idle_requests));
+  }
+
+  // Obtains a tensor. Its buffers may either be reused or created anew.
+  Tensor GetTensor(Tensor::ElementType element_type, const Tensor::Shape& shape,
+                   const Tensor::QuantizationParameters&
+                       quantization_parameters = {});
+
+  // Counts the bytes of the unused tensors against "memory_budget", and
+  // releases the unused tensors while it is exceeded. Must be called before
+  // the first GetTensor().
+  void SetMemoryBudget(std::shared_ptr<MemoryBudget> memory_budget)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // This method is meant for testing.
+  std::pair<int, int> GetInUseAndAvailableCounts();
+
+  ~TensorPool();
+
+ private:
+  // An unused tensor, with the request count at which it was returned.
+  struct Available {
+    Tensor tensor;
+    int64 returned_at;
+  };
+
+  TensorPool(int max_available, int max_idle_requests)
+      : max_available_(max_available), max_idle_requests_(max_idle_requests) {}
+
+  // Returns a tensor to the pool.
+  void Return(Tensor&& tensor);
+
+  // Removes the unused tensors beyond max_available_, those that have been
+  // idle for more than max_idle_requests_, and all of them while the memory
+  // budget is exceeded.
+  void TrimAvailable(std::vector<Tensor>* trimmed)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Adds "bytes" to available_bytes_ and to the memory budget, if any.
+  void AddAvailableBytes(int64 bytes) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const int max_available_;
+  const int max_idle_requests_;
+
+  absl::Mutex mutex_;
+  int64 request_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int in_use_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Ordered from the least to the most recently returned.
+  std::deque<Available> available_ ABSL_GUARDED_BY(mutex_);
+  int64 available_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::shared_ptr<MemoryBudget> memory_budget_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_POOL_H_
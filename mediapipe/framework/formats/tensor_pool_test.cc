@@ -0,0 +1,142 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/tensor_pool.h"
+
+#include <memory>
+#include <vector>
+
+#include "mediapipe/framework/memory_budget.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+using Pair = std::pair<int, int>;
+
+const Tensor::Shape kShape{1, 4, 4, 3};
+
+const void* CpuBuffer(const Tensor& tensor) {
+  return tensor.GetCpuWriteView().buffer<float>();
+}
+
+TEST(TensorPoolTest, ReusesBuffers) {
+  auto pool = TensorPool::Create();
+  const void* buffer;
+  {
+    Tensor tensor = pool->GetTensor(Tensor::ElementType::kFloat32, kShape);
+    EXPECT_EQ(Pair(1, 0), pool->GetInUseAndAvailableCounts());
+    buffer = CpuBuffer(tensor);
+  }
+  EXPECT_EQ(Pair(0, 1), pool->GetInUseAndAvailableCounts());
+
+  Tensor tensor = pool->GetTensor(Tensor::ElementType::kFloat32, kShape,
+                                  Tensor::QuantizationParameters(0.5f, 3));
+  EXPECT_EQ(Pair(1, 0), pool->GetInUseAndAvailableCounts());
+  EXPECT_EQ(tensor.element_type(), Tensor::ElementType::kFloat32);
+  EXPECT_EQ(tensor.shape().dims, kShape.dims);
+  EXPECT_EQ(tensor.quantization_parameters().scale, 0.5f);
+  EXPECT_EQ(tensor.quantization_parameters().zero_point, 3);
+  EXPECT_FALSE(tensor.ready_on_cpu());
+  EXPECT_EQ(CpuBuffer(tensor), buffer);
+}
+
+TEST(TensorPoolTest, ReturnsMovedTensors) {
+  auto pool = TensorPool::Create();
+  auto tensors = std::make_unique<std::vector<Tensor>>();
+  tensors->push_back(pool->GetTensor(Tensor::ElementType::kFloat32, kShape));
+  tensors->push_back(pool->GetTensor(Tensor::ElementType::kFloat32, kShape));
+  EXPECT_EQ(Pair(2, 0), pool->GetInUseAndAvailableCounts());
+  tensors = nullptr;
+  EXPECT_EQ(Pair(0, 2), pool->GetInUseAndAvailableCounts());
+}
+
+TEST(TensorPoolTest, MatchesElementTypeAndShape) {
+  auto pool = TensorPool::Create();
+  {
+    Tensor tensor = pool->GetTensor(Tensor::ElementType::kFloat32, kShape);
+  }
+  Tensor other_type = pool->GetTensor(Tensor::ElementType::kUInt8, kShape);
+  EXPECT_EQ(Pair(1, 1), pool->GetInUseAndAvailableCounts());
+  Tensor other_shape =
+      pool->GetTensor(Tensor::ElementType::kFloat32, Tensor::Shape{1, 4, 4, 4});
+  EXPECT_EQ(Pair(2, 1), pool->GetInUseAndAvailableCounts());
+  EXPECT_EQ(other_type.element_type(), Tensor::ElementType::kUInt8);
+  EXPECT_EQ(other_shape.shape().dims, std::vector<int>({1, 4, 4, 4}));
+}
+
+TEST(TensorPoolTest, CapsAvailableTensors) {
+  auto pool = TensorPool::Create(/*max_available=*/2);
+  {
+    std::vector<Tensor> tensors;
+    for (int i = 0; i < 3; ++i) {
+      tensors.push_back(pool->GetTensor(Tensor::ElementType::kFloat32, kShape));
+    }
+    EXPECT_EQ(Pair(3, 0), pool->GetInUseAndAvailableCounts());
+  }
+  EXPECT_EQ(Pair(0, 2), pool->GetInUseAndAvailableCounts());
+}
+
+TEST(TensorPoolTest, TrimsIdleTensors) {
+  auto pool = TensorPool::Create(/*max_available=*/8, /*max_idle_requests=*/2);
+  {
+    Tensor tensor = pool->GetTensor(Tensor::ElementType::kFloat32, kShape);
+  }
+  EXPECT_EQ(Pair(0, 1), pool->GetInUseAndAvailableCounts());
+  Tensor a = pool->GetTensor(Tensor::ElementType::kUInt8, kShape);
+  Tensor b = pool->GetTensor(Tensor::ElementType::kUInt8, kShape);
+  EXPECT_EQ(Pair(2, 1), pool->GetInUseAndAvailableCounts());
+  Tensor c = pool->GetTensor(Tensor::ElementType::kUInt8, kShape);
+  EXPECT_EQ(Pair(3, 0), pool->GetInUseAndAvailableCounts());
+}
+
+TEST(TensorPoolTest, CountsAvailableTensorsAgainstMemoryBudget) {
+  const int64 kBytes = kShape.num_elements() * sizeof(float);
+  auto budget = std::make_shared<MemoryBudget>(2 * kBytes);
+  auto pool = TensorPool::Create();
+  pool->SetMemoryBudget(budget);
+  {
+    std::vector<Tensor> tensors;
+    for (int i = 0; i < 2; ++i) {
+      tensors.push_back(pool->GetTensor(Tensor::ElementType::kFloat32, kShape));
+    }
+    EXPECT_EQ(budget->Bytes(), 0);
+  }
+  EXPECT_EQ(Pair(0, 2), pool->GetInUseAndAvailableCounts());
+  EXPECT_EQ(budget->Bytes(), 2 * kBytes);
+
+  // Other memory goes over the budget, so the unused tensors are released.
+  budget->Add(kBytes + 1);
+  {
+    Tensor tensor = pool->GetTensor(Tensor::ElementType::kUInt8, kShape);
+    EXPECT_EQ(Pair(1, 0), pool->GetInUseAndAvailableCounts());
+    EXPECT_EQ(budget->Bytes(), kBytes + 1);
+  }
+  EXPECT_EQ(Pair(0, 1), pool->GetInUseAndAvailableCounts());
+  EXPECT_EQ(budget->Bytes(), kBytes + 1 + kShape.num_elements());
+
+  pool = nullptr;
+  EXPECT_EQ(budget->Bytes(), kBytes + 1);
+}
+
+TEST(TensorPoolTest, TensorOutlivesPool) {
+  auto pool = TensorPool::Create();
+  Tensor tensor = pool->GetTensor(Tensor::ElementType::kFloat32, kShape);
+  CpuBuffer(tensor);
+  pool = nullptr;
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -2,7 +2,9 @@
 
 #include <cstring>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 
+#include "absl/synchronization/notification.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #if !MEDIAPIPE_DISABLE_GPU
@@ -63,6 +65,23 @@ TEST(Cpu, TestViewMove) {
   EXPECT_EQ(v1.buffer<float>(), nullptr);  // NOLINT
 }
 
+TEST(Cpu, TestConcurrentReadViews) {
+  Tensor t(Tensor::ElementType::kFloat32, Tensor::Shape{4, 3, 2, 3});
+  t.GetCpuWriteView().buffer<float>()[0] = 1.0f;
+  absl::Notification reading;
+  absl::Notification done;
+  std::thread reader([&t, &reading, &done]() {
+    auto view = t.GetCpuReadView();
+    reading.Notify();
+    done.WaitForNotification();
+  });
+  reading.WaitForNotification();
+  // A second read view doesn't wait for the first one to be released.
+  EXPECT_EQ(t.GetCpuReadView().buffer<float>()[0], 1.0f);
+  done.Notify();
+  reader.join();
+}
+
 }  // namespace mediapipe
 
 int main(int argc, char** argv) {
@@ -0,0 +1,52 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/frame_deadlines.h"
+
+#include <algorithm>
+
+namespace mediapipe {
+namespace internal {
+
+void FrameDeadlines::Set(Timestamp timestamp, absl::Time deadline) {
+  absl::MutexLock lock(&mutex_);
+  auto result = deadlines_.emplace(timestamp, deadline);
+  if (!result.second) {
+    result.first->second = std::min(result.first->second, deadline);
+  }
+  // Timestamps increase over a run, so the oldest entries belong to frames
+  // that have already left the graph.
+  while (deadlines_.size() > kMaxTimestamps) {
+    deadlines_.erase(deadlines_.begin());
+  }
+  has_deadlines_ = true;
+}
+
+bool FrameDeadlines::HasExpired(Timestamp timestamp, absl::Time now) const {
+  if (!has_deadlines_) {
+    return false;
+  }
+  absl::MutexLock lock(&mutex_);
+  auto it = deadlines_.find(timestamp);
+  return it != deadlines_.end() && it->second < now;
+}
+
+void FrameDeadlines::Clear() {
+  absl::MutexLock lock(&mutex_);
+  deadlines_.clear();
+  has_deadlines_ = false;
+}
+
+}  // namespace internal
+}  // namespace mediapipe
@@ -0,0 +1,61 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FRAME_DEADLINES_H_
+#define MEDIAPIPE_FRAMEWORK_FRAME_DEADLINES_H_
+
+#include <atomic>
+#include <map>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+namespace internal {
+
+// The deadlines of the timestamps that are being processed by a graph. The
+// deadline of a timestamp is the time after which the graph output for that
+// timestamp is no longer useful, so nodes that set
+// CalculatorGraphConfig::Node::drop_expired_input can skip its input sets.
+// This class is thread-safe.
+class FrameDeadlines {
+ public:
+  // The number of most recent timestamps whose deadlines are kept.
+  static constexpr int kMaxTimestamps = 1024;
+
+  // Sets the deadline of "timestamp". If the timestamp already has a
+  // deadline, the earlier of the two is kept.
+  void Set(Timestamp timestamp, absl::Time deadline)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns true if "timestamp" has a deadline that is before "now".
+  bool HasExpired(Timestamp timestamp, absl::Time now) const
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Removes all the deadlines.
+  void Clear() ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  // Allows HasExpired() to skip the mutex in graphs that use no deadlines.
+  std::atomic<bool> has_deadlines_{false};
+  mutable absl::Mutex mutex_;
+  std::map<Timestamp, absl::Time> deadlines_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace internal
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FRAME_DEADLINES_H_
@@ -0,0 +1,316 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the costs of the framework itself, independent of any calculator:
+// packets, input stream queues, scheduling a node, input stream handlers,
+// timestamp bound propagation and tensor views. The graph benchmarks send one
+// timestamp at a time and wait for it to reach the graph output, so they
+// measure latency rather than throughput.
+
+#include <list>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/input_stream_manager.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/packet_type.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+namespace {
+
+// Produces no packets but propagates the input timestamp bound.
+class DropPacketsCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Index(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) final {
+    cc->SetOffset(TimestampDiff(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) final {
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(DropPacketsCalculator);
+
+// Sends one timestamp per iteration into every graph input stream and waits
+// until the output stream "out" has settled it, by a packet or by a timestamp
+// bound.
+void RunTimestamps(benchmark::State& state,
+                   const CalculatorGraphConfig& config) {
+  CalculatorGraph graph;
+  CHECK_OK(graph.Initialize(config));
+  absl::Mutex mutex;
+  Timestamp settled = Timestamp::Unset();
+  CHECK_OK(graph.ObserveOutputStream(
+      "out",
+      [&mutex, &settled](const Packet& packet) {
+        absl::MutexLock lock(&mutex);
+        settled = packet.Timestamp();
+        return absl::OkStatus();
+      },
+      /*observe_timestamp_bounds=*/true));
+  CHECK_OK(graph.StartRun({}));
+  const Packet packet = MakePacket<int>(0);
+  int64 next_timestamp = 0;
+  for (auto _ : state) {
+    const Timestamp timestamp(next_timestamp++);
+    for (const std::string& stream : config.input_stream()) {
+      CHECK_OK(graph.AddPacketToInputStream(stream, packet.At(timestamp)));
+    }
+    auto done = [&mutex, &settled, timestamp]() {
+      mutex.AssertHeld();
+      return settled >= timestamp;
+    };
+    absl::MutexLock lock(&mutex);
+    mutex.Await(absl::Condition(&done));
+  }
+  CHECK_OK(graph.CloseAllInputStreams());
+  CHECK_OK(graph.WaitUntilDone());
+}
+
+// Returns a chain of "depth" calculators from "in" to "out".
+CalculatorGraphConfig MakeChain(const std::string& first_calculator,
+                                int depth) {
+  CalculatorGraphConfig config;
+  config.add_input_stream("in");
+  for (int i = 0; i < depth; ++i) {
+    CalculatorGraphConfig::Node* node = config.add_node();
+    node->set_calculator(i == 0 ? first_calculator : "PassThroughCalculator");
+    node->add_input_stream(i == 0 ? "in" : absl::StrCat("s", i));
+    node->add_output_stream(i + 1 == depth ? "out" : absl::StrCat("s", i + 1));
+  }
+  return config;
+}
+
+void BM_MakePacketAndGet(benchmark::State& state) {
+  int sum = 0;
+  for (auto _ : state) {
+    Packet packet = MakePacket<int>(1).At(Timestamp(0));
+    sum += packet.Get<int>();
+  }
+  benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(BM_MakePacketAndGet);
+
+void BM_PacketGet(benchmark::State& state) {
+  const Packet packet = MakePacket<int>(1);
+  int sum = 0;
+  for (auto _ : state) {
+    sum += packet.Get<int>();
+  }
+  benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(BM_PacketGet);
+
+// Adds and pops one packet. The argument selects the single producer mode.
+void BM_InputStreamManagerPushPop(benchmark::State& state) {
+  PacketType packet_type;
+  packet_type.Set<int>();
+  InputStreamManager stream;
+  CHECK_OK(stream.Initialize("in", &packet_type, /*back_edge=*/false));
+  if (state.range(0)) {
+    stream.EnableSingleProducerMode();
+  }
+  stream.PrepareForRun();
+  const Packet packet = MakePacket<int>(0);
+  std::list<Packet> packets(1);
+  int64 next_timestamp = 0;
+  for (auto _ : state) {
+    const Timestamp timestamp(next_timestamp++);
+    packets.front() = packet.At(timestamp);
+    bool notify = false;
+    CHECK_OK(stream.AddPackets(packets, &notify));
+    int num_packets_dropped = 0;
+    bool stream_is_done = false;
+    benchmark::DoNotOptimize(stream.PopPacketAtTimestamp(
+        timestamp, &num_packets_dropped, &stream_is_done));
+  }
+}
+BENCHMARK(BM_InputStreamManagerPushPop)->Arg(0)->Arg(1);
+
+// Passes a packet through a chain of nodes. Items are node hops.
+void BM_SchedulerHops(benchmark::State& state) {
+  const int depth = state.range(0);
+  RunTimestamps(state, MakeChain("PassThroughCalculator", depth));
+  state.SetItemsProcessed(state.iterations() * depth);
+}
+BENCHMARK(BM_SchedulerHops)->Arg(1)->Arg(8)->Arg(32)->UseRealTime();
+
+// Propagates a timestamp bound, without packets, through a chain of nodes.
+// Items are node hops.
+void BM_TimestampBoundPropagation(benchmark::State& state) {
+  const int depth = state.range(0);
+  RunTimestamps(state, MakeChain("DropPacketsCalculator", depth + 1));
+  state.SetItemsProcessed(state.iterations() * depth);
+}
+BENCHMARK(BM_TimestampBoundPropagation)->Arg(1)->Arg(8)->Arg(32)->UseRealTime();
+
+// Passes one packet per stream through a chain of "depth" nodes connected by
+// "width" streams each. Every node invocation updates all the streams into the
+// next node, which is notified once for them. Items are node hops.
+void BM_WideChainHops(benchmark::State& state) {
+  const int depth = state.range(0);
+  const int width = state.range(1);
+  CalculatorGraphConfig config;
+  for (int j = 0; j < width; ++j) {
+    config.add_input_stream(absl::StrCat("s0_", j));
+  }
+  for (int i = 0; i < depth; ++i) {
+    CalculatorGraphConfig::Node* node = config.add_node();
+    node->set_calculator("PassThroughCalculator");
+    for (int j = 0; j < width; ++j) {
+      node->add_input_stream(absl::StrCat("s", i, "_", j));
+      node->add_output_stream(i + 1 == depth && j == 0
+                                  ? "out"
+                                  : absl::StrCat("s", i + 1, "_", j));
+    }
+  }
+  RunTimestamps(state, config);
+  state.SetItemsProcessed(state.iterations() * depth);
+}
+BENCHMARK(BM_WideChainHops)
+    ->Args({8, 4})
+    ->Args({32, 4})
+    ->Args({32, 16})
+    ->UseRealTime();
+
+// Passes two packets through one node. "handler" is merged into the node.
+void RunInputStreamHandler(benchmark::State& state,
+                           const std::string& handler) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "a"
+        input_stream: "b"
+        node {
+          calculator: "PassThroughCalculator"
+          input_stream: "a"
+          input_stream: "b"
+          output_stream: "out"
+          output_stream: "out_b"
+        }
+      )pb");
+  config.mutable_node(0)->MergeFrom(
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(handler));
+  RunTimestamps(state, config);
+}
+
+void BM_DefaultInputStreamHandler(benchmark::State& state) {
+  RunInputStreamHandler(state, "");
+}
+BENCHMARK(BM_DefaultInputStreamHandler)->UseRealTime();
+
+void BM_ImmediateInputStreamHandler(benchmark::State& state) {
+  RunInputStreamHandler(state, R"pb(
+    input_stream_handler { input_stream_handler: "ImmediateInputStreamHandler" }
+  )pb");
+}
+BENCHMARK(BM_ImmediateInputStreamHandler)->UseRealTime();
+
+void BM_SyncSetInputStreamHandler(benchmark::State& state) {
+  RunInputStreamHandler(state, R"pb(
+    input_stream_handler {
+      input_stream_handler: "SyncSetInputStreamHandler"
+      options {
+        [mediapipe.SyncSetInputStreamHandlerOptions.ext] {
+          sync_set { tag_index: ":0" }
+          sync_set { tag_index: ":1" }
+        }
+      }
+    }
+  )pb");
+}
+BENCHMARK(BM_SyncSetInputStreamHandler)->UseRealTime();
+
+// Passes one packet per input stream through a node with "num_inputs" input
+// streams, so the node's readiness is evaluated once per arriving packet.
+// Items are input packets.
+void RunWideNode(benchmark::State& state, const std::string& handler) {
+  const int num_inputs = state.range(0);
+  CalculatorGraphConfig config;
+  CalculatorGraphConfig::Node* node = config.add_node();
+  node->set_calculator("PassThroughCalculator");
+  for (int i = 0; i < num_inputs; ++i) {
+    config.add_input_stream(absl::StrCat("in", i));
+    node->add_input_stream(absl::StrCat("in", i));
+    node->add_output_stream(i == 0 ? "out" : absl::StrCat("out", i));
+  }
+  node->MergeFrom(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(handler));
+  RunTimestamps(state, config);
+  state.SetItemsProcessed(state.iterations() * num_inputs);
+}
+
+void BM_DefaultInputStreamHandlerWide(benchmark::State& state) {
+  RunWideNode(state, "");
+}
+BENCHMARK(BM_DefaultInputStreamHandlerWide)
+    ->Arg(2)
+    ->Arg(8)
+    ->Arg(32)
+    ->Arg(64)
+    ->UseRealTime();
+
+// Splits the inputs into two sync sets.
+void BM_SyncSetInputStreamHandlerWide(benchmark::State& state) {
+  std::string sync_set;
+  for (int i = 0; i < state.range(0) / 2; ++i) {
+    absl::StrAppend(&sync_set, " tag_index: \":", i, "\"");
+  }
+  RunWideNode(state,
+              absl::StrCat("input_stream_handler { input_stream_handler: "
+                           "\"SyncSetInputStreamHandler\" options { "
+                           "[mediapipe.SyncSetInputStreamHandlerOptions.ext] "
+                           "{ sync_set {",
+                           sync_set, " } } } }"));
+}
+BENCHMARK(BM_SyncSetInputStreamHandlerWide)
+    ->Arg(2)
+    ->Arg(8)
+    ->Arg(32)
+    ->Arg(64)
+    ->UseRealTime();
+
+void BM_TensorCpuReadView(benchmark::State& state) {
+  Tensor tensor(Tensor::ElementType::kFloat32, Tensor::Shape{1, 224, 224, 3});
+  { auto view = tensor.GetCpuWriteView(); }
+  for (auto _ : state) {
+    auto view = tensor.GetCpuReadView();
+    benchmark::DoNotOptimize(view.buffer<float>());
+  }
+}
+BENCHMARK(BM_TensorCpuReadView);
+
+void BM_TensorCpuWriteView(benchmark::State& state) {
+  Tensor tensor(Tensor::ElementType::kFloat32, Tensor::Shape{1, 224, 224, 3});
+  for (auto _ : state) {
+    auto view = tensor.GetCpuWriteView();
+    benchmark::DoNotOptimize(view.buffer<float>());
+  }
+}
+BENCHMARK(BM_TensorCpuWriteView);
+
+}  // namespace
+}  // namespace mediapipe
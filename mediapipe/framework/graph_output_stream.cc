@@ -14,6 +14,9 @@
 
 #include "mediapipe/framework/graph_output_stream.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/port/status.h"
 
@@ -66,6 +69,26 @@ absl::Status OutputStreamObserver::Initialize(
                                        observe_timestamp_bounds);
 }
 
+absl::Status OutputStreamObserver::Initialize(
+    const std::string& stream_name, const PacketType* packet_type,
+    std::function<absl::Status(const std::vector<Packet>&)> packets_callback,
+    OutputStreamManager* output_stream_manager, bool observe_timestamp_bounds) {
+  RET_CHECK(output_stream_manager);
+
+  packets_callback_ = std::move(packets_callback);
+  observe_timestamp_bounds_ = observe_timestamp_bounds;
+  return GraphOutputStream::Initialize(stream_name, packet_type,
+                                       output_stream_manager,
+                                       observe_timestamp_bounds);
+}
+
+absl::Status OutputStreamObserver::InvokeCallback(const Packet& packet) {
+  if (packets_callback_) {
+    return packets_callback_({packet});
+  }
+  return packet_callback_(packet);
+}
+
 absl::Status OutputStreamObserver::Notify() {
   // Lets one thread perform packets notification as much as possible.
   // Other threads should quit if a thread is already performing notification.
@@ -88,7 +111,7 @@ absl::Status OutputStreamObserver::Notify() {
                                  ? Timestamp::PostStream()
                                  : min_timestamp.PreviousAllowedInStream());
         if (last_processed_ts_ < settled) {
-          MP_RETURN_IF_ERROR(packet_callback_(Packet().At(settled)));
+          MP_RETURN_IF_ERROR(InvokeCallback(Packet().At(settled)));
           last_processed_ts_ = settled;
         }
       }
@@ -109,6 +132,17 @@ absl::Status OutputStreamObserver::Notify() {
         }
       }
     }
+    if (packets_callback_) {
+      // Delivers everything queued so far in one callback.
+      std::vector<Packet> packets;
+      bool stream_is_done = false;
+      input_stream_->PopPackets(std::numeric_limits<int>::max(), &packets,
+                                &stream_is_done);
+      RET_CHECK(!packets.empty());
+      MP_RETURN_IF_ERROR(packets_callback_(packets));
+      last_processed_ts_ = packets.back().Timestamp();
+      continue;
+    }
     int num_packets_dropped = 0;
     bool stream_is_done = false;
     Packet packet = input_stream_->PopPacketAtTimestamp(
@@ -221,5 +255,70 @@ bool OutputStreamPollerImpl::Next(Packet* packet) {
   return true;
 }
 
+bool OutputStreamPollerImpl::NextBatch(std::vector<Packet>* packets,
+                                       size_t max_packets) {
+  return NextBatchInternal(packets, max_packets, /*block=*/true);
+}
+
+bool OutputStreamPollerImpl::TryNextBatch(std::vector<Packet>* packets,
+                                          size_t max_packets) {
+  return NextBatchInternal(packets, max_packets, /*block=*/false);
+}
+
+bool OutputStreamPollerImpl::NextBatchInternal(std::vector<Packet>* packets,
+                                               size_t max_packets,
+                                               bool block) {
+  CHECK(packets);
+  bool empty_queue = true;
+  bool timestamp_bound_changed = false;
+  Timestamp min_timestamp = Timestamp::Unset();
+  mutex_.Lock();
+  while (true) {
+    min_timestamp = input_stream_->MinTimestampOrBound(&empty_queue);
+    if (empty_queue) {
+      timestamp_bound_changed =
+          input_stream_handler_->ProcessTimestampBounds() &&
+          output_timestamp_ < min_timestamp.PreviousAllowedInStream();
+    }
+    if (!block || graph_has_error_ || !empty_queue ||
+        timestamp_bound_changed || min_timestamp == Timestamp::Done()) {
+      break;
+    } else {
+      handler_condvar_.Wait(&mutex_);
+    }
+  }
+  if ((graph_has_error_ && empty_queue) ||
+      min_timestamp == Timestamp::Done()) {
+    mutex_.Unlock();
+    return false;
+  }
+  if (max_packets == 0) {
+    mutex_.Unlock();
+    return true;
+  }
+  if (empty_queue) {
+    if (timestamp_bound_changed) {
+      output_timestamp_ = min_timestamp.PreviousAllowedInStream();
+      packets->push_back(Packet().At(output_timestamp_));
+    }
+    mutex_.Unlock();
+    return true;
+  }
+  mutex_.Unlock();
+  // As in Next(), packets are popped without holding mutex_, since popping may
+  // invoke the queue size callbacks.
+  bool stream_is_done = false;
+  const int num_popped = input_stream_->PopPackets(
+      static_cast<int>(
+          std::min<size_t>(max_packets, std::numeric_limits<int>::max())),
+      packets, &stream_is_done);
+  if (num_popped > 0) {
+    mutex_.Lock();
+    output_timestamp_ = packets->back().Timestamp();
+    mutex_.Unlock();
+  }
+  return true;
+}
+
 }  // namespace internal
 }  // namespace mediapipe
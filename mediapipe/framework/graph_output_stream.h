@@ -120,6 +120,14 @@ class OutputStreamObserver : public GraphOutputStream {
       OutputStreamManager* output_stream_manager,
       bool observe_timestamp_bounds = false);
 
+  // Initializes an OutputStreamObserver that passes all the packets available
+  // on each notification to packets_callback in a single call.
+  absl::Status Initialize(
+      const std::string& stream_name, const PacketType* packet_type,
+      std::function<absl::Status(const std::vector<Packet>&)> packets_callback,
+      OutputStreamManager* output_stream_manager,
+      bool observe_timestamp_bounds = false);
+
   // Notifies the observer of new packets emitted by the observed
   // output stream.
   absl::Status Notify() override;
@@ -128,8 +136,14 @@ class OutputStreamObserver : public GraphOutputStream {
   void NotifyError() override {}
 
  private:
+  // Passes a single packet to whichever callback is installed.
+  absl::Status InvokeCallback(const Packet& packet);
+
   // Invoked on every packet emitted by the observed output stream.
   std::function<absl::Status(const Packet&)> packet_callback_;
+  // If set, invoked instead of packet_callback_ on every batch of packets
+  // emitted by the observed output stream.
+  std::function<absl::Status(const std::vector<Packet>&)> packets_callback_;
 };
 
 // OutputStreamPollerImpl that returns packets to the caller via
@@ -167,7 +181,22 @@ class OutputStreamPollerImpl : public GraphOutputStream {
   // done).  Returns true if successful.
   ABSL_MUST_USE_RESULT bool Next(Packet* packet);
 
+  // Appends up to max_packets available packets to packets, blocking until
+  // at least one is available or the stream is done.  Returns true if
+  // successful.
+  ABSL_MUST_USE_RESULT bool NextBatch(std::vector<Packet>* packets,
+                                      size_t max_packets);
+
+  // Like NextBatch(), but returns immediately, possibly without appending any
+  // packet.  Returns false once the stream is done or the graph has failed.
+  ABSL_MUST_USE_RESULT bool TryNextBatch(std::vector<Packet>* packets,
+                                         size_t max_packets);
+
  private:
+  // Implements NextBatch() and TryNextBatch().
+  bool NextBatchInternal(std::vector<Packet>* packets, size_t max_packets,
+                         bool block);
+
   absl::Mutex mutex_;
   absl::CondVar handler_condvar_ ABSL_GUARDED_BY(mutex_);
   bool graph_has_error_ ABSL_GUARDED_BY(mutex_);
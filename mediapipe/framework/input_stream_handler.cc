@@ -14,14 +14,187 @@
 
 #include "mediapipe/framework/input_stream_handler.h"
 
+#include <algorithm>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/substitute.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/collection_item_id.h"
 #include "mediapipe/framework/mediapipe_profiling.h"
 #include "mediapipe/framework/port/ret_check.h"
 
 namespace mediapipe {
 using SyncSet = InputStreamHandler::SyncSet;
+using ReadinessTracker = InputStreamHandler::ReadinessTracker;
+
+namespace {
+
+// A binary min-heap of timestamps keyed by stream index, which allows the
+// timestamp of any stream to be updated or removed in O(log n).
+class TimestampHeap {
+ public:
+  explicit TimestampHeap(int num_streams)
+      : positions_(num_streams, -1), timestamps_(num_streams) {}
+
+  // Returns the earliest timestamp, or Timestamp::Done() if empty.
+  Timestamp Min() const {
+    return heap_.empty() ? Timestamp::Done() : timestamps_[heap_.front()];
+  }
+
+  // Inserts or updates the timestamp of a stream.
+  void Set(int index, Timestamp timestamp) {
+    int pos = positions_[index];
+    if (pos < 0) {
+      pos = heap_.size();
+      heap_.push_back(index);
+      positions_[index] = pos;
+    } else if (timestamp == timestamps_[index]) {
+      return;
+    }
+    timestamps_[index] = timestamp;
+    SiftDown(SiftUp(pos));
+  }
+
+  // Removes the timestamp of a stream, if present.
+  void Remove(int index) {
+    int pos = positions_[index];
+    if (pos < 0) {
+      return;
+    }
+    positions_[index] = -1;
+    int last = heap_.back();
+    heap_.pop_back();
+    if (pos < heap_.size()) {
+      heap_[pos] = last;
+      positions_[last] = pos;
+      SiftDown(SiftUp(pos));
+    }
+  }
+
+  void Clear() {
+    heap_.clear();
+    std::fill(positions_.begin(), positions_.end(), -1);
+  }
+
+ private:
+  bool Less(int a, int b) const {
+    return timestamps_[heap_[a]] < timestamps_[heap_[b]];
+  }
+
+  void Swap(int a, int b) {
+    std::swap(heap_[a], heap_[b]);
+    positions_[heap_[a]] = a;
+    positions_[heap_[b]] = b;
+  }
+
+  int SiftUp(int pos) {
+    while (pos > 0 && Less(pos, (pos - 1) / 2)) {
+      Swap(pos, (pos - 1) / 2);
+      pos = (pos - 1) / 2;
+    }
+    return pos;
+  }
+
+  void SiftDown(int pos) {
+    while (true) {
+      int least = pos;
+      for (int child = 2 * pos + 1; child <= 2 * pos + 2; ++child) {
+        if (child < heap_.size() && Less(child, least)) {
+          least = child;
+        }
+      }
+      if (least == pos) {
+        return;
+      }
+      Swap(pos, least);
+      pos = least;
+    }
+  }
+
+  // The stream indexes, in heap order.
+  std::vector<int> heap_;
+  // The position in heap_ of each stream, or -1.
+  std::vector<int> positions_;
+  std::vector<Timestamp> timestamps_;
+};
+
+// Whether a BatchedNotifications is alive on this thread.
+thread_local bool batching_notifications = false;
+// The input stream handlers with deferred notifications on this thread, in
+// the order of their first update.
+thread_local std::vector<InputStreamHandler*> pending_notifications;
+
+}  // namespace
+
+// Streams are marked changed by the threads delivering packets and bounds,
+// and re-read by GetReadiness(). A stream is marked changed after its update
+// and before the node is notified, so a concurrent GetReadiness() that misses
+// the mark is always followed by another one.
+class InputStreamHandler::ReadinessTracker {
+ public:
+  explicit ReadinessTracker(int num_streams)
+      : is_changed_(num_streams, false),
+        packets_(num_streams),
+        bounds_(num_streams) {
+    MarkAllChanged();
+  }
+
+  void MarkChanged(int index) ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
+    if (!is_changed_[index]) {
+      is_changed_[index] = true;
+      changed_.push_back(index);
+    }
+  }
+
+  // Discards all tracked timestamps and marks every stream as changed.
+  void MarkAllChanged() ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
+    packets_.Clear();
+    bounds_.Clear();
+    changed_.clear();
+    for (int i = 0; i < is_changed_.size(); ++i) {
+      is_changed_[i] = true;
+      changed_.push_back(i);
+    }
+  }
+
+  // Re-reads the changed streams and returns the earliest packet timestamp
+  // and the earliest bound among the empty streams.
+  void Update(const InputStreamHandler::InputStreamManagerSet& streams,
+              const std::vector<CollectionItemId>& stream_ids,
+              Timestamp* min_packet, Timestamp* min_bound)
+      ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
+    for (int index : changed_) {
+      is_changed_[index] = false;
+      bool empty;
+      Timestamp stream_timestamp =
+          streams.Get(stream_ids[index])->MinTimestampOrBound(&empty);
+      if (empty) {
+        packets_.Remove(index);
+        bounds_.Set(index, stream_timestamp);
+      } else {
+        bounds_.Remove(index);
+        packets_.Set(index, stream_timestamp);
+      }
+    }
+    changed_.clear();
+    *min_packet = packets_.Min();
+    *min_bound = bounds_.Min();
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<bool> is_changed_ ABSL_GUARDED_BY(mutex_);
+  std::vector<int> changed_ ABSL_GUARDED_BY(mutex_);
+  // The queue head timestamps of the non-empty streams.
+  TimestampHeap packets_ ABSL_GUARDED_BY(mutex_);
+  // The timestamp bounds of the empty streams.
+  TimestampHeap bounds_ ABSL_GUARDED_BY(mutex_);
+};
 
 absl::Status InputStreamHandler::InitializeInputStreamManagers(
     InputStreamManager* flat_input_stream_managers) {
@@ -257,6 +430,39 @@ void LogQueuedPackets(CalculatorContext* context, InputStreamManager* stream,
   }
 }
 
+InputStreamHandler::BatchedNotifications::BatchedNotifications()
+    : outermost_(!batching_notifications) {
+  batching_notifications = true;
+}
+
+InputStreamHandler::BatchedNotifications::~BatchedNotifications() {
+  if (!outermost_) return;
+  batching_notifications = false;
+  // The notifications may run downstream nodes inline on this thread, which
+  // batch their own notifications, so the pending list is detached first.
+  std::vector<InputStreamHandler*> handlers;
+  handlers.swap(pending_notifications);
+  for (InputStreamHandler* handler : handlers) {
+    handler->notification_();
+  }
+  // Keeps the allocation for the next batch.
+  if (pending_notifications.empty()) {
+    handlers.clear();
+    handlers.swap(pending_notifications);
+  }
+}
+
+void InputStreamHandler::Notify() {
+  if (!batching_notifications) {
+    notification_();
+    return;
+  }
+  if (std::find(pending_notifications.begin(), pending_notifications.end(),
+                this) == pending_notifications.end()) {
+    pending_notifications.push_back(this);
+  }
+}
+
 void InputStreamHandler::AddPackets(CollectionItemId id,
                                     const std::list<Packet>& packets) {
   LogQueuedPackets(GetCalculatorContext(calculator_context_manager_),
@@ -267,8 +473,9 @@ void InputStreamHandler::AddPackets(CollectionItemId id,
   if (!result.ok()) {
     error_callback_(result);
   }
+  MarkStreamChanged(id);
   if (notify) {
-    notification_();
+    Notify();
   }
 }
 
@@ -282,8 +489,9 @@ void InputStreamHandler::MovePackets(CollectionItemId id,
   if (!result.ok()) {
     error_callback_(result);
   }
+  MarkStreamChanged(id);
   if (notify) {
-    notification_();
+    Notify();
   }
 }
 
@@ -295,8 +503,9 @@ void InputStreamHandler::SetNextTimestampBound(CollectionItemId id,
   if (!result.ok()) {
     error_callback_(result);
   }
+  MarkStreamChanged(id);
   if (notify) {
-    notification_();
+    Notify();
   }
 }
 
@@ -311,8 +520,19 @@ void InputStreamHandler::ClearCurrentInputs(
 }
 
 void InputStreamHandler::Close() {
-  for (auto& stream : input_stream_managers_) {
-    stream->Close();
+  for (CollectionItemId id = input_stream_managers_.BeginId();
+       id < input_stream_managers_.EndId(); ++id) {
+    input_stream_managers_.Get(id)->Close();
+    MarkStreamChanged(id);
+  }
+}
+
+void InputStreamHandler::MarkStreamChanged(CollectionItemId id) {
+  if (id.value() < readiness_trackers_.size()) {
+    const auto& entry = readiness_trackers_[id.value()];
+    if (entry.first) {
+      entry.first->MarkChanged(entry.second);
+    }
   }
 }
 
@@ -336,23 +556,26 @@ void InputStreamHandler::SetLatePreparation(bool late_preparation) {
 SyncSet::SyncSet(InputStreamHandler* input_stream_handler,
                  std::vector<CollectionItemId> stream_ids)
     : input_stream_handler_(input_stream_handler),
-      stream_ids_(std::move(stream_ids)) {}
+      stream_ids_(std::move(stream_ids)),
+      tracker_(std::make_shared<ReadinessTracker>(stream_ids_.size())) {
+  auto& trackers = input_stream_handler_->readiness_trackers_;
+  trackers.resize(
+      input_stream_handler_->input_stream_managers_.EndId().value());
+  for (int i = 0; i < stream_ids_.size(); ++i) {
+    trackers[stream_ids_[i].value()] = {tracker_, i};
+  }
+}
 
-void SyncSet::PrepareForRun() { last_processed_ts_ = Timestamp::Unset(); }
+void SyncSet::PrepareForRun() {
+  last_processed_ts_ = Timestamp::Unset();
+  tracker_->MarkAllChanged();
+}
 
 NodeReadiness SyncSet::GetReadiness(Timestamp* min_stream_timestamp) {
-  Timestamp min_bound = Timestamp::Done();
-  Timestamp min_packet = Timestamp::Done();
-  for (CollectionItemId id : stream_ids_) {
-    const auto& stream = input_stream_handler_->input_stream_managers_.Get(id);
-    bool empty;
-    Timestamp stream_timestamp = stream->MinTimestampOrBound(&empty);
-    if (empty) {
-      min_bound = std::min(min_bound, stream_timestamp);
-    } else {
-      min_packet = std::min(min_packet, stream_timestamp);
-    }
-  }
+  Timestamp min_bound;
+  Timestamp min_packet;
+  tracker_->Update(input_stream_handler_->input_stream_managers_, stream_ids_,
+                   &min_packet, &min_bound);
   *min_stream_timestamp = std::min(min_packet, min_bound);
   if (*min_stream_timestamp == Timestamp::Done()) {
     last_processed_ts_ = Timestamp::Done().PreviousAllowedInStream();
@@ -413,6 +636,9 @@ void SyncSet::FillInputSet(Timestamp input_timestamp,
     CHECK_EQ(num_packets_dropped, 0)
         << absl::Substitute("Dropped $0 packet(s) on input stream \"$1\".",
                             num_packets_dropped, stream->Name());
+    if (!current_packet.IsEmpty()) {
+      input_stream_handler_->MarkStreamChanged(id);
+    }
     input_stream_handler_->AddPacketToShard(
         &input_set->Get(id), std::move(current_packet), stream_is_done);
   }
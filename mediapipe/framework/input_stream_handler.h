@@ -141,6 +141,24 @@ class InputStreamHandler {
   // Sets next timestamp bound in a particular stream.
   void SetNextTimestampBound(CollectionItemId id, Timestamp bound);
 
+  // While a BatchedNotifications object is alive on a thread, the
+  // notifications that AddPackets(), MovePackets() and SetNextTimestampBound()
+  // would send on that thread are deferred. When the outermost object is
+  // destroyed, every input stream handler that was updated is notified once.
+  // OutputStreamHandler holds one while propagating the outputs of a node
+  // invocation, so that a downstream node fed by several of those outputs
+  // checks its readiness once rather than once per stream.
+  class BatchedNotifications {
+   public:
+    BatchedNotifications();
+    ~BatchedNotifications();
+    BatchedNotifications(const BatchedNotifications&) = delete;
+    BatchedNotifications& operator=(const BatchedNotifications&) = delete;
+
+   private:
+    const bool outermost_;
+  };
+
   // Clears the current packet of every stream shard and removes the current
   // timestamp from the calculator context.
   void ClearCurrentInputs(CalculatorContext* calculator_context);
@@ -184,9 +202,17 @@ class InputStreamHandler {
   // When true, Calculator::Process is called for every input timestamp bound.
   bool ProcessTimestampBounds() { return process_timestamps_; }
 
+  // Returns true if the input sets are filled in ProcessNode() rather than
+  // when the invocation is scheduled. See late_preparation_.
+  bool LatePreparation() const { return late_preparation_; }
+
   // Returns the number of sync-sets populated by this input stream handler.
   virtual int SyncSetCount() { return 1; }
 
+  // Keeps the earliest packet timestamp and the earliest bound of the input
+  // streams of a SyncSet, updated for the streams marked as changed.
+  class ReadinessTracker;
+
   // A helper class to build input packet sets for a certain set of streams.
   //
   // ReadyForProcess requires all of the streams to be fully determined
@@ -197,6 +223,10 @@ class InputStreamHandler {
   //
   // If ProcessTimestampBounds() is set, then a fully determined input timestamp
   // with only empty input packets will qualify as ReadyForProcess.
+  //
+  // Readiness is tracked incrementally: each packet or timestamp bound update
+  // marks its input stream as changed, and GetReadiness() re-reads only the
+  // changed streams, so its cost does not grow with the number of inputs.
   class SyncSet {
    public:
     // Creates a SyncSet for a certain set of streams, |stream_ids|.
@@ -226,6 +256,8 @@ class InputStreamHandler {
     InputStreamHandler* input_stream_handler_;
     std::vector<CollectionItemId> stream_ids_;
     Timestamp last_processed_ts_ = Timestamp::Unset();
+    // The earliest packet and bound of the streams, updated incrementally.
+    std::shared_ptr<ReadinessTracker> tracker_;
   };
 
  protected:
@@ -250,6 +282,11 @@ class InputStreamHandler {
     shard->AddPacket(std::move(value), is_done);
   }
 
+  // Indicates that the queue head or the timestamp bound of a stream may have
+  // changed. Subclasses that modify input_stream_managers_ directly, rather
+  // than through SyncSet, must call this before the next GetNodeReadiness().
+  void MarkStreamChanged(CollectionItemId id);
+
   // Returns the operation the calculator node is ready for.
   // Specifically:
   // - NodeReadiness::kNotReady if the node's Process() or Close() cannot be
@@ -296,6 +333,9 @@ class InputStreamHandler {
   // be filled in ProcessNode().
   bool late_preparation_ = false;
 
+  // Invokes notification_, or defers it if a BatchedNotifications is alive.
+  void Notify();
+
   // Determines how many sets of input packets are collected before a
   // CalculatorNode is scheduled.
   int batch_size_ = 1;
@@ -308,6 +348,11 @@ class InputStreamHandler {
   std::function<void()> headers_ready_callback_;
 
   std::atomic<int> unset_header_count_{0};
+
+  // The ReadinessTracker of the SyncSet containing each input stream, and the
+  // index of the stream within the SyncSet, indexed by CollectionItemId.
+  std::vector<std::pair<std::shared_ptr<ReadinessTracker>, int>>
+      readiness_trackers_;
 };
 
 using InputStreamHandlerRegistry = GlobalFactoryRegistry<
@@ -14,19 +14,30 @@
 
 #include "mediapipe/framework/input_stream_manager.h"
 
+#include <algorithm>
 #include <type_traits>
 #include <utility>
 
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/packet.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/source_location.h"
 #include "mediapipe/framework/port/status_builder.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/framework/tool/status_util.h"
 
 namespace mediapipe {
 
+namespace {
+
+// The number of packets the producer can hand over in single producer mode
+// before it has to lock the stream.
+constexpr size_t kProducerQueueCapacity = 32;
+
+}  // namespace
+
 absl::Status InputStreamManager::Initialize(const std::string& name,
                                             const PacketType* packet_type,
                                             bool back_edge) {
@@ -46,24 +57,157 @@ void InputStreamManager::SetQueueSizeCallbacks(
   becomes_not_full_callback_ = becomes_not_full_callback;
 }
 
+void InputStreamManager::EnableSingleProducerMode() {
+  absl::MutexLock stream_lock(&stream_mutex_);
+  if (!producer_queue_) {
+    producer_queue_ =
+        absl::make_unique<SpscQueue<Packet>>(kProducerQueueCapacity);
+  }
+  num_queued_packets_ = static_cast<int>(queue_.size());
+  producer_bound_ = next_timestamp_bound_;
+  published_bound_ = next_timestamp_bound_.Value();
+  consumer_bound_ = next_timestamp_bound_.Value();
+}
+
+void InputStreamManager::EnableQueuedBytes(
+    std::shared_ptr<QueuedBytesCounter> node_queued_bytes) {
+  absl::MutexLock stream_lock(&stream_mutex_);
+  queued_bytes_ = std::make_shared<QueuedBytesCounter>();
+  node_queued_bytes_ = std::move(node_queued_bytes);
+  for (const Packet& packet : queue_) {
+    CountQueuedBytes(packet, true);
+  }
+}
+
+InputStreamManager::~InputStreamManager() {
+  if (memory_budget_) {
+    memory_budget_->Add(-budget_bytes_);
+  }
+}
+
+void InputStreamManager::SetMemoryBudget(
+    std::shared_ptr<MemoryBudget> memory_budget) {
+  absl::MutexLock stream_lock(&stream_mutex_);
+  if (memory_budget_) {
+    memory_budget_->Add(-budget_bytes_);
+  }
+  budget_bytes_ = 0;
+  memory_budget_ = std::move(memory_budget);
+  if (!memory_budget_) {
+    return;
+  }
+  for (const Packet& packet : queue_) {
+    budget_bytes_ += static_cast<int64>(PacketPayloadSize(packet));
+  }
+  memory_budget_->Add(budget_bytes_);
+}
+
+void InputStreamManager::CountQueuedBytes(const Packet& packet,
+                                          bool added) const {
+  if (!queued_bytes_ && !memory_budget_) {
+    return;
+  }
+  const int64 bytes = static_cast<int64>(PacketPayloadSize(packet));
+  if (bytes == 0) {
+    return;
+  }
+  const int64 delta = added ? bytes : -bytes;
+  if (queued_bytes_) {
+    queued_bytes_->Add(delta);
+    node_queued_bytes_->Add(delta);
+  }
+  if (memory_budget_) {
+    budget_bytes_ += delta;
+    memory_budget_->Add(delta);
+  }
+}
+
 void InputStreamManager::PrepareForRun() {
   absl::MutexLock stream_lock(&stream_mutex_);
   queue_.clear();
+  if (queued_bytes_) {
+    node_queued_bytes_->Add(-queued_bytes_->Bytes());
+    queued_bytes_->Add(-queued_bytes_->Bytes());
+    queued_bytes_->ResetPeak();
+  }
+  if (memory_budget_) {
+    memory_budget_->Add(-budget_bytes_);
+    budget_bytes_ = 0;
+  }
   last_reported_stream_full_ = false;
   num_packets_added_ = 0;
   next_timestamp_bound_ = Timestamp::PreStream();
   last_select_timestamp_ = Timestamp::Unstarted();
   closed_ = false;
   header_ = Packet();
+  if (producer_queue_) {
+    producer_queue_->Clear();
+    num_queued_packets_ = 0;
+    producer_bound_ = next_timestamp_bound_;
+    published_bound_ = next_timestamp_bound_.Value();
+    consumer_bound_ = next_timestamp_bound_.Value();
+  }
+}
+
+void InputStreamManager::DrainProducerQueue() const {
+  if (!producer_queue_) {
+    return;
+  }
+  // Load the bound before popping, so that every packet below it is visible.
+  const Timestamp bound =
+      Timestamp::CreateNoErrorChecking(published_bound_.load());
+  Packet packet;
+  while (producer_queue_->TryPop(&packet)) {
+    // The consumer may have advanced next_timestamp_bound_ past a packet that
+    // the producer pushed concurrently; such a packet has been skipped over.
+    // Packets pushed after the stream was closed are ignored.
+    if (closed_ ||
+        (enable_timestamps_ && packet.Timestamp() < next_timestamp_bound_)) {
+      VLOG(3) << "Input stream " << name_ << " dropped packet at "
+              << packet.Timestamp() << " below the timestamp bound "
+              << next_timestamp_bound_;
+      --num_queued_packets_;
+      continue;
+    }
+    CountQueuedBytes(packet, true);
+    queue_.emplace_back(std::move(packet));
+  }
+  if (bound > next_timestamp_bound_) {
+    next_timestamp_bound_ = bound;
+  }
+}
+
+int InputStreamManager::QueueSizeInternal() const {
+  if (producer_queue_) {
+    return std::max(num_queued_packets_.load(), 0);
+  }
+  return static_cast<int>(queue_.size());
+}
+
+bool InputStreamManager::RecordPacketsRemoved(int num_removed) {
+  const int max_queue_size = max_queue_size_;
+  if (max_queue_size == -1) {
+    if (producer_queue_) num_queued_packets_ -= num_removed;
+    return false;
+  }
+  int new_size;
+  if (producer_queue_) {
+    new_size = (num_queued_packets_ -= num_removed);
+  } else {
+    new_size = static_cast<int>(queue_.size());
+  }
+  return new_size + num_removed >= max_queue_size && new_size < max_queue_size;
 }
 
 bool InputStreamManager::IsEmpty() const {
   absl::MutexLock stream_lock(&stream_mutex_);
+  DrainProducerQueue();
   return queue_.empty();
 }
 
 Packet InputStreamManager::QueueHead() const {
   absl::MutexLock stream_lock(&stream_mutex_);
+  DrainProducerQueue();
   if (queue_.empty()) {
     return Packet();
   }
@@ -90,9 +234,57 @@ absl::Status InputStreamManager::MovePackets(std::list<Packet>* container,
   return AddOrMovePacketsInternal<std::list<Packet>&>(*container, notify);
 }
 
+absl::Status InputStreamManager::ValidatePacket(
+    const Packet& packet, Timestamp next_timestamp_bound) const {
+  absl::Status result = packet_type_->Validate(packet);
+  if (!result.ok()) {
+    return tool::AddStatusPrefix(
+        absl::StrCat(
+            "Packet type mismatch on a calculator receiving from stream \"",
+            name_, "\": "),
+        result);
+  }
+
+  const Timestamp timestamp = packet.Timestamp();
+  if (!timestamp.IsAllowedInStream()) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "In stream \"" << name_
+           << "\", timestamp not specified or set to illegal value: "
+           << timestamp.DebugString();
+  }
+  if (enable_timestamps_) {
+    // Check that PostStream(), if used, is the only timestamp used.  This
+    // is also true for PreStream() but doesn't need to be checked because
+    // Timestamp::PreStream().NextAllowedInStream() is
+    // Timestamp::OneOverPostStream().
+    if (timestamp == Timestamp::PostStream() && num_packets_added_ > 0) {
+      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+             << "In stream \"" << name_
+             << "\", a packet at Timestamp::PostStream() must be the only "
+                "Packet in an InputStream.";
+    }
+    if (timestamp < next_timestamp_bound) {
+      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+             << "Packet timestamp mismatch on a calculator receiving from "
+                "stream \""
+             << name_ << "\". Current minimum expected timestamp is "
+             << next_timestamp_bound.DebugString() << " but received "
+             << timestamp.DebugString()
+             << ". Are you using a custom InputStreamHandler? Note that "
+                "some InputStreamHandlers allow timestamps that are not "
+                "strictly monotonically increasing. See for example the "
+                "ImmediateInputStreamHandler class comment.";
+    }
+  }
+  return absl::OkStatus();
+}
+
 template <typename Container>
 absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
                                                           bool* notify) {
+  if (producer_queue_) {
+    return AddOrMovePacketsSingleProducer<Container>(container, notify);
+  }
   *notify = false;
   bool queue_became_non_empty = false;
   bool queue_became_full = false;
@@ -102,59 +294,22 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
     if (closed_) {
       return absl::OkStatus();
     }
+    const int max_queue_size = max_queue_size_;
     // Check if the queue was full before packets came in.
     bool was_queue_full =
-        (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+        (max_queue_size != -1 && queue_.size() >= max_queue_size);
     // Check if the queue becomes non-empty.
     queue_became_non_empty = queue_.empty() && !container.empty();
     for (auto& packet : container) {
-      absl::Status result = packet_type_->Validate(packet);
-      if (!result.ok()) {
-        return tool::AddStatusPrefix(
-            absl::StrCat(
-                "Packet type mismatch on a calculator receiving from stream \"",
-                name_, "\": "),
-            result);
-      }
-
-      const Timestamp timestamp = packet.Timestamp();
-      if (!timestamp.IsAllowedInStream()) {
-        return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-               << "In stream \"" << name_
-               << "\", timestamp not specified or set to illegal value: "
-               << timestamp.DebugString();
-      }
-      if (enable_timestamps_) {
-        // Check that PostStream(), if used, is the only timestamp used.  This
-        // is also true for PreStream() but doesn't need to be checked because
-        // Timestamp::PreStream().NextAllowedInStream() is
-        // Timestamp::OneOverPostStream().
-        if (timestamp == Timestamp::PostStream() && num_packets_added_ > 0) {
-          return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-                 << "In stream \"" << name_
-                 << "\", a packet at Timestamp::PostStream() must be the only "
-                    "Packet in an InputStream.";
-        }
-        if (timestamp < next_timestamp_bound_) {
-          return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-                 << "Packet timestamp mismatch on a calculator receiving from "
-                    "stream \""
-                 << name_ << "\". Current minimum expected timestamp is "
-                 << next_timestamp_bound_.DebugString() << " but received "
-                 << timestamp.DebugString()
-                 << ". Are you using a custom InputStreamHandler? Note that "
-                    "some InputStreamHandlers allow timestamps that are not "
-                    "strictly monotonically increasing. See for example the "
-                    "ImmediateInputStreamHandler class comment.";
-        }
-      }
-      next_timestamp_bound_ = timestamp.NextAllowedInStream();
+      MP_RETURN_IF_ERROR(ValidatePacket(packet, next_timestamp_bound_));
+      next_timestamp_bound_ = packet.Timestamp().NextAllowedInStream();
 
       // If the caller is MovePackets(), packet's underlying holder should be
       // transferred into queue_. Otherwise, queue_ keeps a copy of the packet.
       ++num_packets_added_;
       VLOG(3) << "Input stream:" << name_
               << " has added packet at time: " << packet.Timestamp();
+      CountQueuedBytes(packet, true);
       if (std::is_const<
               typename std::remove_reference<Container>::type>::value) {
         queue_.emplace_back(packet);
@@ -162,8 +317,8 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
         queue_.emplace_back(std::move(packet));
       }
     }
-    queue_became_full = (!was_queue_full && max_queue_size_ != -1 &&
-                         queue_.size() >= max_queue_size_);
+    queue_became_full = (!was_queue_full && max_queue_size != -1 &&
+                         queue_.size() >= max_queue_size);
     if (queue_.size() > 1) {
       VLOG(3) << "Queue size greater than 1: stream name: " << name_
               << " queue_size: " << queue_.size();
@@ -180,8 +335,62 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
   return absl::OkStatus();
 }
 
+template <typename Container>
+absl::Status InputStreamManager::AddOrMovePacketsSingleProducer(
+    Container container, bool* notify) {
+  *notify = false;
+  if (closed_) {
+    return absl::OkStatus();
+  }
+  const int max_queue_size = max_queue_size_;
+  bool queue_became_non_empty = false;
+  bool queue_became_full = false;
+  for (auto& packet : container) {
+    const Timestamp consumer_bound =
+        Timestamp::CreateNoErrorChecking(consumer_bound_.load());
+    MP_RETURN_IF_ERROR(
+        ValidatePacket(packet, std::max(producer_bound_, consumer_bound)));
+    producer_bound_ = packet.Timestamp().NextAllowedInStream();
+    ++num_packets_added_;
+    VLOG(3) << "Input stream:" << name_
+            << " has added packet at time: " << packet.Timestamp();
+
+    // Count the packet before pushing it, so that the consumer never sees a
+    // negative queue size.
+    const int old_size = num_queued_packets_.fetch_add(1);
+    queue_became_non_empty |= (old_size == 0);
+    queue_became_full |= (max_queue_size != -1 && old_size < max_queue_size &&
+                          old_size + 1 >= max_queue_size);
+    Packet item;
+    if (std::is_const<
+            typename std::remove_reference<Container>::type>::value) {
+      item = packet;
+    } else {
+      item = std::move(packet);
+    }
+    if (!producer_queue_->TryPush(std::move(item))) {
+      // The ring buffer is full: take over the consumer role and move its
+      // contents into queue_, followed by this packet.
+      absl::MutexLock stream_lock(&stream_mutex_);
+      DrainProducerQueue();
+      CountQueuedBytes(item, true);
+      queue_.emplace_back(std::move(item));
+    }
+    published_bound_ = producer_bound_.Value();
+  }
+  if (queue_became_full) {
+    VLOG(3) << "Queue became full: " << Name();
+    becomes_full_callback_(this, &last_reported_stream_full_);
+  }
+  *notify = queue_became_non_empty;
+  return absl::OkStatus();
+}
+
 absl::Status InputStreamManager::SetNextTimestampBound(const Timestamp bound,
                                                        bool* notify) {
+  if (producer_queue_) {
+    return SetNextTimestampBoundSingleProducer(bound, notify);
+  }
   *notify = false;
   {
     // Scope to prevent locking the stream when notification is called.
@@ -216,6 +425,37 @@ absl::Status InputStreamManager::SetNextTimestampBound(const Timestamp bound,
   return absl::OkStatus();
 }
 
+absl::Status InputStreamManager::SetNextTimestampBoundSingleProducer(
+    const Timestamp bound, bool* notify) {
+  *notify = false;
+  if (closed_) {
+    return absl::OkStatus();
+  }
+  const Timestamp current_bound = std::max(
+      producer_bound_,
+      Timestamp::CreateNoErrorChecking(consumer_bound_.load()));
+  if (enable_timestamps_ && bound < current_bound) {
+    return mediapipe::UnknownErrorBuilder(MEDIAPIPE_LOC)
+           << "SetNextTimestampBound must be called with a timestamp greater "
+              "than or equal to the current bound. In stream \""
+           << name_ << "\". Current minimum expected timestamp is "
+           << current_bound.DebugString() << " but received "
+           << bound.DebugString();
+  }
+  if (bound > current_bound) {
+    producer_bound_ = bound;
+    VLOG(3) << "Next timestamp bound for input " << name_ << " is " << bound;
+    // Both operations are sequentially consistent: either the consumer sees
+    // the new bound when it next checks the stream, or the queue is seen as
+    // empty here and the consumer is notified.
+    published_bound_.store(bound.Value());
+    if (num_queued_packets_.load() == 0) {
+      *notify = true;
+    }
+  }
+  return absl::OkStatus();
+}
+
 void InputStreamManager::DisableTimestamps() { enable_timestamps_ = false; }
 
 void InputStreamManager::Close() {
@@ -226,10 +466,16 @@ void InputStreamManager::Close() {
   next_timestamp_bound_ = Timestamp::Done();
   last_select_timestamp_ = Timestamp::Done();
   closed_ = true;
+  if (producer_queue_) {
+    consumer_bound_ = Timestamp::Done().Value();
+    // Drop the packets that have not been drained yet.
+    DrainProducerQueue();
+  }
 }
 
 Timestamp InputStreamManager::MinTimestampOrBound(bool* is_empty) const {
   absl::MutexLock stream_lock(&stream_mutex_);
+  DrainProducerQueue();
   if (is_empty) {
     *is_empty = queue_.empty();
   }
@@ -251,6 +497,7 @@ Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
   Packet packet;
   {
     absl::MutexLock stream_lock(&stream_mutex_);
+    DrainProducerQueue();
     // Make sure timestamp didn't decrease from last time.
     CHECK_LE(last_select_timestamp_, timestamp);
     last_select_timestamp_ = timestamp;
@@ -259,6 +506,9 @@ Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
     // timestamps we have already passed.
     if (next_timestamp_bound_ <= timestamp) {
       next_timestamp_bound_ = timestamp.NextAllowedInStream();
+      if (producer_queue_) {
+        consumer_bound_ = next_timestamp_bound_.Value();
+      }
     }
 
     VLOG(3) << "Input stream " << name_
@@ -268,15 +518,14 @@ Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
     // Advances time to timestamp.
     Timestamp current_timestamp = Timestamp::Unset();
 
-    // Checks if queue is full.
-    bool was_queue_full =
-        (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
-
+    int num_removed = 0;
     while (!queue_.empty() && queue_.front().Timestamp() <= timestamp) {
+      CountQueuedBytes(queue_.front(), false);
       packet = std::move(queue_.front());
       queue_.pop_front();
       current_timestamp = packet.Timestamp();
       ++(*num_packets_dropped);
+      ++num_removed;
     }
     // Clear value_ if it doesn't have exactly the right timestamp.
     if (current_timestamp != timestamp) {
@@ -288,7 +537,7 @@ Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
 
     VLOG(3) << "Input stream removed packets:" << name_
             << " Size:" << queue_.size();
-    queue_became_non_full = (was_queue_full && queue_.size() < max_queue_size_);
+    queue_became_non_full = RecordPacketsRemoved(num_removed);
     *stream_is_done = IsDone();
   }
   if (queue_became_non_full) {
@@ -305,23 +554,23 @@ Packet InputStreamManager::PopQueueHead(bool* stream_is_done) {
   Packet packet;
   {
     absl::MutexLock stream_lock(&stream_mutex_);
+    DrainProducerQueue();
 
     VLOG(3) << "Input stream " << name_ << " selecting at queue head";
 
-    // Check if queue is full.
-    bool was_queue_full =
-        (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
-
+    int num_removed = 0;
     if (!queue_.empty()) {
+      CountQueuedBytes(queue_.front(), false);
       packet = std::move(queue_.front());
       queue_.pop_front();
+      num_removed = 1;
     } else {
       packet = Packet();
     }
 
     VLOG(3) << "Input stream removed a packet:" << name_
             << " Size:" << queue_.size();
-    queue_became_non_full = (was_queue_full && queue_.size() < max_queue_size_);
+    queue_became_non_full = RecordPacketsRemoved(num_removed);
     *stream_is_done = IsDone();
   }
   if (queue_became_non_full) {
@@ -331,14 +580,53 @@ Packet InputStreamManager::PopQueueHead(bool* stream_is_done) {
   return packet;
 }
 
+int InputStreamManager::PopPackets(int max_packets,
+                                   std::vector<Packet>* packets,
+                                   bool* stream_is_done) {
+  CHECK(enable_timestamps_);
+  *stream_is_done = false;
+  bool queue_became_non_full = false;
+  int num_removed = 0;
+  {
+    absl::MutexLock stream_lock(&stream_mutex_);
+    DrainProducerQueue();
+    while (!queue_.empty() && num_removed < max_packets) {
+      CountQueuedBytes(queue_.front(), false);
+      packets->push_back(std::move(queue_.front()));
+      queue_.pop_front();
+      ++num_removed;
+    }
+    if (num_removed > 0) {
+      const Timestamp timestamp = packets->back().Timestamp();
+      CHECK_LE(last_select_timestamp_, timestamp);
+      last_select_timestamp_ = timestamp;
+      if (next_timestamp_bound_ <= timestamp) {
+        next_timestamp_bound_ = timestamp.NextAllowedInStream();
+        if (producer_queue_) {
+          consumer_bound_ = next_timestamp_bound_.Value();
+        }
+      }
+    }
+
+    VLOG(3) << "Input stream removed " << num_removed << " packets:" << name_
+            << " Size:" << queue_.size();
+    queue_became_non_full = RecordPacketsRemoved(num_removed);
+    *stream_is_done = IsDone();
+  }
+  if (queue_became_non_full) {
+    VLOG(3) << "Queue became non-full: " << Name();
+    becomes_not_full_callback_(this, &last_reported_stream_full_);
+  }
+  return num_removed;
+}
+
 int InputStreamManager::NumPacketsAdded() const {
-  absl::MutexLock lock(&stream_mutex_);
-  return num_packets_added_;
+  return static_cast<int>(num_packets_added_);
 }
 
 int InputStreamManager::QueueSize() const {
   absl::MutexLock lock(&stream_mutex_);
-  return static_cast<int>(queue_.size());
+  return QueueSizeInternal();
 }
 
 int InputStreamManager::MaxQueueSize() const {
@@ -351,9 +639,10 @@ void InputStreamManager::SetMaxQueueSize(int max_queue_size) {
   bool is_full;
   {
     absl::MutexLock lock(&stream_mutex_);
-    was_full = (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+    const int queue_size = QueueSizeInternal();
+    was_full = (max_queue_size_ != -1 && queue_size >= max_queue_size_);
     max_queue_size_ = max_queue_size;
-    is_full = (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+    is_full = (max_queue_size_ != -1 && queue_size >= max_queue_size_);
   }
 
   // QueueSizeCallback is called with no mutexes held.
@@ -368,37 +657,41 @@ void InputStreamManager::SetMaxQueueSize(int max_queue_size) {
 
 bool InputStreamManager::IsFull() const {
   absl::MutexLock lock(&stream_mutex_);
-  return max_queue_size_ != -1 && queue_.size() >= max_queue_size_;
+  const int max_queue_size = max_queue_size_;
+  return max_queue_size != -1 && QueueSizeInternal() >= max_queue_size;
 }
 
 Timestamp InputStreamManager::GetMinTimestampAmongNLatest(int n) const {
   absl::MutexLock lock(&stream_mutex_);
+  DrainProducerQueue();
   if (queue_.empty()) {
     return Timestamp::Unset();
   }
   return (queue_.cend() - std::min((size_t)n, queue_.size()))->Timestamp();
 }
 
-void InputStreamManager::ErasePacketsEarlierThan(Timestamp timestamp) {
+int InputStreamManager::ErasePacketsEarlierThan(Timestamp timestamp) {
   bool queue_became_non_full = false;
+  int num_removed = 0;
   {
     absl::MutexLock lock(&stream_mutex_);
-    // Checks if queue is full.
-    bool was_queue_full =
-        (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+    DrainProducerQueue();
 
     while (!queue_.empty() && queue_.front().Timestamp() < timestamp) {
+      CountQueuedBytes(queue_.front(), false);
       queue_.pop_front();
+      ++num_removed;
     }
 
     VLOG(3) << "Input stream removed packets:" << name_
             << " Size:" << queue_.size();
-    queue_became_non_full = (was_queue_full && queue_.size() < max_queue_size_);
+    queue_became_non_full = RecordPacketsRemoved(num_removed);
   }
   if (queue_became_non_full) {
     VLOG(3) << "Queue became non-full: " << Name();
     becomes_not_full_callback_(this, &last_reported_stream_full_);
   }
+  return num_removed;
 }
 
 bool InputStreamManager::IsDone() const {
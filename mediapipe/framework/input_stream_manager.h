@@ -15,14 +15,20 @@
 #ifndef MEDIAPIPE_FRAMEWORK_INPUT_STREAM_MANAGER_H_
 #define MEDIAPIPE_FRAMEWORK_INPUT_STREAM_MANAGER_H_
 
+#include <atomic>
 #include <deque>
 #include <functional>
 #include <list>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/spsc_queue.h"
+#include "mediapipe/framework/memory_budget.h"
 #include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/packet_payload_size.h"
 #include "mediapipe/framework/packet_type.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -43,6 +49,11 @@ namespace mediapipe {
 // An input stream is written to by exactly one output stream and is read by a
 // single node. None of its methods should hold a lock when they invoke a
 // callback in the scheduler.
+//
+// If the producer calls (AddPackets, MovePackets and SetNextTimestampBound)
+// are known to never run concurrently, EnableSingleProducerMode() lets them
+// skip stream_mutex_: packets are handed over through a lock-free ring buffer,
+// which the consumer drains into the packet queue under stream_mutex_.
 class InputStreamManager {
  public:
   // Function type for becomes_full_callback and becomes_not_full_callback.
@@ -55,6 +66,7 @@ class InputStreamManager {
   InputStreamManager& operator=(const InputStreamManager&) = delete;
 
   InputStreamManager() = default;
+  ~InputStreamManager();
 
   // Initializes the InputStreamManager.
   absl::Status Initialize(const std::string& name,
@@ -117,6 +129,40 @@ class InputStreamManager {
   // Turns off the use of packet timestamps.
   void DisableTimestamps();
 
+  // Lets the producer add packets and timestamp bounds without locking
+  // stream_mutex_. The caller guarantees that AddPackets, MovePackets and
+  // SetNextTimestampBound are never called concurrently with each other.
+  // Must be called before the first graph run.
+  //
+  // Timestamp checks and max queue size handling are unchanged. The only
+  // observable difference is for a packet that races with a
+  // PopPacketAtTimestamp() call at a later timestamp: it is dropped as if it
+  // had been added before that call, instead of being reported as a timestamp
+  // mismatch.
+  void EnableSingleProducerMode();
+
+  // Returns true if EnableSingleProducerMode() has been called.
+  bool IsSingleProducerMode() const { return producer_queue_ != nullptr; }
+
+  // Counts the payload bytes of the queued packets, as reported by the hooks
+  // in packet_payload_size.h. The bytes are also added to "node_queued_bytes",
+  // which is shared by the input streams of a node. In single producer mode,
+  // packets are counted once the consumer moves them into the queue.
+  // Must be called before the first graph run.
+  void EnableQueuedBytes(std::shared_ptr<QueuedBytesCounter> node_queued_bytes);
+
+  // Returns the queued bytes of this stream, or nullptr if EnableQueuedBytes()
+  // has not been called.
+  std::shared_ptr<const QueuedBytesCounter> QueuedBytes() const {
+    return queued_bytes_;
+  }
+
+  // Adds the payload bytes of the queued packets, as counted for
+  // EnableQueuedBytes(), to "memory_budget". The bytes counted for an earlier
+  // budget are released. A null "memory_budget" stops the counting.
+  void SetMemoryBudget(std::shared_ptr<MemoryBudget> memory_budget)
+      ABSL_LOCKS_EXCLUDED(stream_mutex_);
+
   // Returns true iff the queue is empty.
   bool IsEmpty() const ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
@@ -142,6 +188,15 @@ class InputStreamManager {
   // Timestamp::Done() after the pop.
   Packet PopQueueHead(bool* stream_is_done) ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
+  // Pops up to "max_packets" packets from the head of the queue and appends
+  // them to "packets", in timestamp order. This is equivalent to calling
+  // PopPacketAtTimestamp() with the timestamp of the queue head for each of
+  // those packets, but takes the stream mutex only once. Returns the number of
+  // packets popped. Sets "stream_is_done" if the next timestamp bound reaches
+  // Timestamp::Done() after the pop.
+  int PopPackets(int max_packets, std::vector<Packet>* packets,
+                 bool* stream_is_done) ABSL_LOCKS_EXCLUDED(stream_mutex_);
+
   // Returns the number of packets in the queue.
   int NumPacketsAdded() const ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
@@ -167,9 +222,10 @@ class InputStreamManager {
   Timestamp GetMinTimestampAmongNLatest(int n) const
       ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
-  // pop_front()s packets that are earlier than the given timestamp.
+  // pop_front()s packets that are earlier than the given timestamp, and
+  // returns the number of packets removed.
   // NOTE: This is a public API intended for FixedSizeInputStreamHandler only.
-  void ErasePacketsEarlierThan(Timestamp timestamp)
+  int ErasePacketsEarlierThan(Timestamp timestamp)
       ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
   // If a maximum queue size is specified (!= -1), these callbacks that are
@@ -189,6 +245,40 @@ class InputStreamManager {
   absl::Status AddOrMovePacketsInternal(Container container, bool* notify)
       ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
+  // Implements AddOrMovePacketsInternal and SetNextTimestampBound in single
+  // producer mode.
+  template <typename Container>
+  absl::Status AddOrMovePacketsSingleProducer(Container container,
+                                              bool* notify)
+      ABSL_LOCKS_EXCLUDED(stream_mutex_);
+  absl::Status SetNextTimestampBoundSingleProducer(Timestamp bound,
+                                                   bool* notify)
+      ABSL_LOCKS_EXCLUDED(stream_mutex_);
+
+  // Checks that a packet can be added to the stream, given the next timestamp
+  // bound expected by the stream.
+  absl::Status ValidatePacket(const Packet& packet,
+                              Timestamp next_timestamp_bound) const;
+
+  // In single producer mode, moves the packets handed over by the producer
+  // into queue_ and merges the producer's timestamp bound into
+  // next_timestamp_bound_. Does nothing otherwise.
+  void DrainProducerQueue() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(stream_mutex_);
+
+  // Returns the number of queued packets, including the packets that have
+  // not been drained from producer_queue_ yet.
+  int QueueSizeInternal() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(stream_mutex_);
+
+  // Accounts for "num_removed" packets removed from queue_. Returns true if
+  // the queue became non-full.
+  bool RecordPacketsRemoved(int num_removed)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(stream_mutex_);
+
+  // Adds the payload bytes of "packet" to the queued bytes if "added" is true,
+  // or subtracts them otherwise. Does nothing unless EnableQueuedBytes() has
+  // been called or a MemoryBudget is set.
+  void CountQueuedBytes(const Packet& packet, bool added) const;
+
   // Returns true if the next timestamp bound reaches Timestamp::Done().
   bool IsDone() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(stream_mutex_);
 
@@ -196,15 +286,19 @@ class InputStreamManager {
   Timestamp MinTimestampOrBoundHelper() const;
 
   mutable absl::Mutex stream_mutex_;
-  std::deque<Packet> queue_ ABSL_GUARDED_BY(stream_mutex_);
+  // Mutable so that the const accessors can drain producer_queue_.
+  mutable std::deque<Packet> queue_ ABSL_GUARDED_BY(stream_mutex_);
   // The number of packets added to queue_.  Used to verify a packet at
-  // Timestamp::PostStream() is the only Packet in the stream.
-  int64 num_packets_added_ ABSL_GUARDED_BY(stream_mutex_);
-  Timestamp next_timestamp_bound_ ABSL_GUARDED_BY(stream_mutex_);
+  // Timestamp::PostStream() is the only Packet in the stream. Only written by
+  // the producer.
+  std::atomic<int64> num_packets_added_{0};
+  mutable Timestamp next_timestamp_bound_ ABSL_GUARDED_BY(stream_mutex_);
   // The |timestamp| argument passed to the last SelectAtTimestamp() call.
   // Ignored if enable_timestamps_ is false.
   Timestamp last_select_timestamp_ ABSL_GUARDED_BY(stream_mutex_);
-  bool closed_ ABSL_GUARDED_BY(stream_mutex_);
+  // Written under stream_mutex_, read without it by the producer in single
+  // producer mode.
+  std::atomic<bool> closed_{false};
   // True if packet timestamps are used.
   bool enable_timestamps_ = true;
   std::string name_;
@@ -213,8 +307,32 @@ class InputStreamManager {
   // The header packet of the input stream.
   Packet header_;
 
-  // The maximum queue size for this stream if set.
-  int max_queue_size_ ABSL_GUARDED_BY(stream_mutex_) = -1;
+  // The maximum queue size for this stream if set. Written under
+  // stream_mutex_, read without it by the producer in single producer mode.
+  std::atomic<int> max_queue_size_{-1};
+
+  // Single producer mode state. producer_queue_ is null unless
+  // EnableSingleProducerMode() has been called.
+  std::unique_ptr<SpscQueue<Packet>> producer_queue_;
+  // The next timestamp bound as known by the producer. Only accessed by the
+  // producer.
+  Timestamp producer_bound_;
+  // producer_bound_ published to the consumer. Stored after the packets below
+  // the bound have been pushed to producer_queue_.
+  std::atomic<int64> published_bound_{0};
+  // next_timestamp_bound_ published to the producer, for the timestamp checks.
+  std::atomic<int64> consumer_bound_{0};
+  // The number of packets in queue_ and producer_queue_. Incremented by the
+  // producer before a push and decremented by the consumer after a pop.
+  mutable std::atomic<int> num_queued_packets_{0};
+
+  // The payload bytes in queue_, and in the queues of the node. Null unless
+  // EnableQueuedBytes() has been called.
+  std::shared_ptr<QueuedBytesCounter> queued_bytes_;
+  std::shared_ptr<QueuedBytesCounter> node_queued_bytes_;
+  // The budget to which the queued bytes are added, and the bytes added.
+  std::shared_ptr<MemoryBudget> memory_budget_;
+  mutable int64 budget_bytes_ ABSL_GUARDED_BY(stream_mutex_) = 0;
 
   // Callback to notify the framework that we have hit the maximum queue size.
   QueueSizeCallback becomes_full_callback_;
@@ -15,18 +15,22 @@
 #include "mediapipe/framework/input_stream_manager.h"
 
 #include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "mediapipe/framework/input_stream_shard.h"
 #include "mediapipe/framework/lifetime_tracker.h"
 #include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/packet_payload_size.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/status_matchers.h"
 
 namespace mediapipe {
 namespace {
-class InputStreamManagerTest : public ::testing::Test {
+// The test parameter selects the single producer mode of InputStreamManager.
+class InputStreamManagerTest : public ::testing::TestWithParam<bool> {
  protected:
   InputStreamManagerTest() {}
 
@@ -44,6 +48,9 @@ class InputStreamManagerTest : public ::testing::Test {
     input_stream_manager_ = absl::make_unique<InputStreamManager>();
     MP_ASSERT_OK(input_stream_manager_->Initialize("a_test", &packet_type_,
                                                    /*back_edge=*/false));
+    if (GetParam()) {
+      input_stream_manager_->EnableSingleProducerMode();
+    }
 
     queue_full_callback_ =
         std::bind(&InputStreamManagerTest::ReportQueueBecomesFull, this,
@@ -89,9 +96,12 @@ class InputStreamManagerTest : public ::testing::Test {
   int queue_becomes_not_full_count_;
 };
 
-TEST_F(InputStreamManagerTest, Init) {}
+INSTANTIATE_TEST_SUITE_P(SingleProducerMode, InputStreamManagerTest,
+                         ::testing::Values(false, true));
 
-TEST_F(InputStreamManagerTest, AddPackets) {
+TEST_P(InputStreamManagerTest, Init) {}
+
+TEST_P(InputStreamManagerTest, AddPackets) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
@@ -108,7 +118,7 @@ TEST_F(InputStreamManagerTest, AddPackets) {
   }
 }
 
-TEST_F(InputStreamManagerTest, MovePackets) {
+TEST_P(InputStreamManagerTest, MovePackets) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
@@ -128,7 +138,7 @@ TEST_F(InputStreamManagerTest, MovePackets) {
 // InputStreamManager should reject the four timestamps that are not allowed in
 // a stream: Timestamp::Unset(), Timestamp::Unstarted(),
 // Timestamp::OneOverPostStream(), and Timestamp::Done().
-TEST_F(InputStreamManagerTest, AddPacketUnset) {
+TEST_P(InputStreamManagerTest, AddPacketUnset) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp::Unset()));
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
@@ -139,7 +149,7 @@ TEST_F(InputStreamManagerTest, AddPacketUnset) {
   EXPECT_FALSE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, AddPacketUnstarted) {
+TEST_P(InputStreamManagerTest, AddPacketUnstarted) {
   std::list<Packet> packets;
   packets.push_back(
       MakePacket<std::string>("packet 1").At(Timestamp::Unstarted()));
@@ -151,7 +161,7 @@ TEST_F(InputStreamManagerTest, AddPacketUnstarted) {
   EXPECT_FALSE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, AddPacketOneOverPostStream) {
+TEST_P(InputStreamManagerTest, AddPacketOneOverPostStream) {
   std::list<Packet> packets;
   packets.push_back(
       MakePacket<std::string>("packet 1").At(Timestamp::OneOverPostStream()));
@@ -164,7 +174,7 @@ TEST_F(InputStreamManagerTest, AddPacketOneOverPostStream) {
   EXPECT_FALSE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, AddPacketDone) {
+TEST_P(InputStreamManagerTest, AddPacketDone) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp::Done()));
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
@@ -175,7 +185,7 @@ TEST_F(InputStreamManagerTest, AddPacketDone) {
   EXPECT_FALSE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, AddPacketsOnlyPreStream) {
+TEST_P(InputStreamManagerTest, AddPacketsOnlyPreStream) {
   std::list<Packet> packets;
   packets.push_back(
       MakePacket<std::string>("packet 1").At(Timestamp::PreStream()));
@@ -189,7 +199,7 @@ TEST_F(InputStreamManagerTest, AddPacketsOnlyPreStream) {
 
 // An attempt to add a packet after Timestamp::PreStream() should be rejected
 // because the next timestamp bound is Timestamp::OneOverPostStream().
-TEST_F(InputStreamManagerTest, AddPacketsAfterPreStream) {
+TEST_P(InputStreamManagerTest, AddPacketsAfterPreStream) {
   std::list<Packet> packets;
   packets.push_back(
       MakePacket<std::string>("packet 1").At(Timestamp::PreStream()));
@@ -203,7 +213,7 @@ TEST_F(InputStreamManagerTest, AddPacketsAfterPreStream) {
   EXPECT_FALSE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, AddPacketsOnlyPostStream) {
+TEST_P(InputStreamManagerTest, AddPacketsOnlyPostStream) {
   std::list<Packet> packets;
   packets.push_back(
       MakePacket<std::string>("packet 1").At(Timestamp::PostStream()));
@@ -217,7 +227,7 @@ TEST_F(InputStreamManagerTest, AddPacketsOnlyPostStream) {
 
 // A packet at Timestamp::PostStream() must be the only Packet in an input
 // stream.
-TEST_F(InputStreamManagerTest, AddPacketsBeforePostStream) {
+TEST_P(InputStreamManagerTest, AddPacketsBeforePostStream) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(
@@ -230,7 +240,7 @@ TEST_F(InputStreamManagerTest, AddPacketsBeforePostStream) {
   EXPECT_FALSE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, AddPacketsReverseTimestamps) {
+TEST_P(InputStreamManagerTest, AddPacketsReverseTimestamps) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(20)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(10)));
@@ -245,7 +255,7 @@ TEST_F(InputStreamManagerTest, AddPacketsReverseTimestamps) {
   EXPECT_FALSE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, PopPacketAtTimestamp) {
+TEST_P(InputStreamManagerTest, PopPacketAtTimestamp) {
   std::string expected_value_at_10("packet 1");
   std::string expected_value_at_20("packet 2");
   std::string expected_value_at_30("packet 3");
@@ -329,7 +339,37 @@ TEST_F(InputStreamManagerTest, PopPacketAtTimestamp) {
   EXPECT_TRUE(stream_is_done_);
 }
 
-TEST_F(InputStreamManagerTest, PopQueueHead) {
+TEST_P(InputStreamManagerTest, PopPackets) {
+  std::list<Packet> packets;
+  packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
+  packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
+  packets.push_back(MakePacket<std::string>("packet 3").At(Timestamp(30)));
+  MP_ASSERT_OK(input_stream_manager_->AddPackets(packets, &notify_));
+  EXPECT_TRUE(notify_);
+
+  std::vector<Packet> popped_packets;
+  EXPECT_EQ(2, input_stream_manager_->PopPackets(2, &popped_packets,
+                                                 &stream_is_done_));
+  EXPECT_FALSE(stream_is_done_);
+  ASSERT_EQ(2, popped_packets.size());
+  EXPECT_EQ(Timestamp(10), popped_packets[0].Timestamp());
+  EXPECT_EQ(Timestamp(20), popped_packets[1].Timestamp());
+  EXPECT_EQ(Timestamp(30), input_stream_manager_->QueueHead().Timestamp());
+
+  MP_ASSERT_OK(input_stream_manager_->SetNextTimestampBound(Timestamp::Done(),
+                                                            &notify_));
+  EXPECT_EQ(1, input_stream_manager_->PopPackets(10, &popped_packets,
+                                                 &stream_is_done_));
+  ASSERT_EQ(3, popped_packets.size());
+  EXPECT_EQ("packet 3", popped_packets[2].Get<std::string>());
+  EXPECT_TRUE(stream_is_done_);
+  EXPECT_TRUE(input_stream_manager_->IsEmpty());
+  EXPECT_EQ(0, input_stream_manager_->PopPackets(10, &popped_packets,
+                                                 &stream_is_done_));
+  EXPECT_EQ(3, popped_packets.size());
+}
+
+TEST_P(InputStreamManagerTest, PopQueueHead) {
   input_stream_manager_->DisableTimestamps();
   std::string expected_value_at_10("packet 1");
   std::string expected_value_at_20("packet 2");
@@ -393,7 +433,7 @@ TEST_F(InputStreamManagerTest, PopQueueHead) {
   EXPECT_TRUE(stream_is_done_);
 }
 
-TEST_F(InputStreamManagerTest, BadPacketType) {
+TEST_P(InputStreamManagerTest, BadPacketType) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<int>(10).At(Timestamp(10)));
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
@@ -404,7 +444,7 @@ TEST_F(InputStreamManagerTest, BadPacketType) {
   EXPECT_FALSE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, Close) {
+TEST_P(InputStreamManagerTest, Close) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
@@ -427,7 +467,7 @@ TEST_F(InputStreamManagerTest, Close) {
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
 }
 
-TEST_F(InputStreamManagerTest, ReuseInputStreamManager) {
+TEST_P(InputStreamManagerTest, ReuseInputStreamManager) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
@@ -480,7 +520,7 @@ TEST_F(InputStreamManagerTest, ReuseInputStreamManager) {
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
 }
 
-TEST_F(InputStreamManagerTest, MultipleNotifications) {
+TEST_P(InputStreamManagerTest, MultipleNotifications) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
@@ -516,7 +556,7 @@ TEST_F(InputStreamManagerTest, MultipleNotifications) {
   EXPECT_TRUE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, SetHeader) {
+TEST_P(InputStreamManagerTest, SetHeader) {
   Packet header = MakePacket<std::string>("blah");
   MP_ASSERT_OK(input_stream_manager_->SetHeader(header));
 
@@ -525,7 +565,7 @@ TEST_F(InputStreamManagerTest, SetHeader) {
   EXPECT_EQ(header.Timestamp(), input_stream_manager_->Header().Timestamp());
 }
 
-TEST_F(InputStreamManagerTest, BackwardsInTime) {
+TEST_P(InputStreamManagerTest, BackwardsInTime) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
@@ -592,7 +632,7 @@ TEST_F(InputStreamManagerTest, BackwardsInTime) {
   EXPECT_FALSE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, SelectBackwardsInTime) {
+TEST_P(InputStreamManagerTest, SelectBackwardsInTime) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
@@ -636,7 +676,7 @@ TEST_F(InputStreamManagerTest, SelectBackwardsInTime) {
                "");
 }
 
-TEST_F(InputStreamManagerTest, TimestampBound) {
+TEST_P(InputStreamManagerTest, TimestampBound) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
@@ -746,7 +786,7 @@ TEST_F(InputStreamManagerTest, TimestampBound) {
             input_stream_manager_->MinTimestampOrBound(&is_empty));
 }
 
-TEST_F(InputStreamManagerTest, QueueSizeTest) {
+TEST_P(InputStreamManagerTest, QueueSizeTest) {
   std::list<Packet> packets;
   int max_queue_size = 2;
   input_stream_manager_->SetMaxQueueSize(max_queue_size);
@@ -783,11 +823,14 @@ TEST_F(InputStreamManagerTest, QueueSizeTest) {
   expected_queue_becomes_not_full_count_ = 1;
 }
 
-TEST_F(InputStreamManagerTest, InputReleaseTest) {
+TEST_P(InputStreamManagerTest, InputReleaseTest) {
   packet_type_.Set<LifetimeTracker::Object>();
   input_stream_manager_ = absl::make_unique<InputStreamManager>();
   MP_ASSERT_OK(input_stream_manager_->Initialize("a_test", &packet_type_,
                                                  /*back_edge=*/false));
+  if (GetParam()) {
+    input_stream_manager_->EnableSingleProducerMode();
+  }
   input_stream_manager_->PrepareForRun();
   input_stream_manager_->SetQueueSizeCallbacks(queue_full_callback_,
                                                queue_not_full_callback_);
@@ -833,7 +876,7 @@ TEST_F(InputStreamManagerTest, InputReleaseTest) {
 
 // An attempt to add a packet after Timestamp::PreStream() should be allowed
 // if packet timestamps don't need to be increasing.
-TEST_F(InputStreamManagerTest, AddPacketsAfterPreStreamUntimed) {
+TEST_P(InputStreamManagerTest, AddPacketsAfterPreStreamUntimed) {
   input_stream_manager_->DisableTimestamps();
   std::list<Packet> packets;
   packets.push_back(
@@ -849,7 +892,7 @@ TEST_F(InputStreamManagerTest, AddPacketsAfterPreStreamUntimed) {
 
 // A packet at Timestamp::PostStream() doesn't need to be the only Packet in
 // an input stream if packet timestamps don't need to be increasing.
-TEST_F(InputStreamManagerTest, AddPacketsBeforePostStreamUntimed) {
+TEST_P(InputStreamManagerTest, AddPacketsBeforePostStreamUntimed) {
   input_stream_manager_->DisableTimestamps();
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
@@ -863,7 +906,7 @@ TEST_F(InputStreamManagerTest, AddPacketsBeforePostStreamUntimed) {
   EXPECT_TRUE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, BackwardsInTimeUntimed) {
+TEST_P(InputStreamManagerTest, BackwardsInTimeUntimed) {
   input_stream_manager_->DisableTimestamps();
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
@@ -924,5 +967,116 @@ TEST_F(InputStreamManagerTest, BackwardsInTimeUntimed) {
   EXPECT_TRUE(notify_);
 }
 
+// Adds more packets than the single producer hand-over buffer holds before any
+// of them is consumed.
+TEST_P(InputStreamManagerTest, AddManyPacketsBeforePop) {
+  input_stream_manager_->SetMaxQueueSize(100);
+  for (int i = 1; i <= 100; ++i) {
+    std::list<Packet> packets;
+    packets.push_back(MakePacket<std::string>("packet").At(Timestamp(i)));
+    notify_ = false;
+    MP_ASSERT_OK(input_stream_manager_->AddPackets(packets, &notify_));
+    EXPECT_EQ(notify_, i == 1);
+  }
+  EXPECT_EQ(100, input_stream_manager_->QueueSize());
+  EXPECT_TRUE(input_stream_manager_->IsFull());
+  for (int i = 1; i <= 100; ++i) {
+    bool is_empty;
+    EXPECT_EQ(Timestamp(i),
+              input_stream_manager_->MinTimestampOrBound(&is_empty));
+    popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
+        Timestamp(i), &num_packets_dropped_, &stream_is_done_);
+    EXPECT_EQ(Timestamp(i), popped_packet_.Timestamp());
+    EXPECT_EQ(0, num_packets_dropped_);
+  }
+  EXPECT_TRUE(input_stream_manager_->IsEmpty());
+  EXPECT_EQ(Timestamp(101),
+            input_stream_manager_->MinTimestampOrBound(nullptr));
+
+  expected_queue_becomes_full_count_ = 1;
+  expected_queue_becomes_not_full_count_ = 1;
+}
+
+// Runs the producer and the consumer on separate threads.
+TEST_P(InputStreamManagerTest, ConcurrentProducerAndConsumer) {
+  constexpr int kNumPackets = 2000;
+  absl::Status producer_status;
+  std::thread producer([this, &producer_status] {
+    for (int i = 0; i < kNumPackets; ++i) {
+      std::list<Packet> packets;
+      packets.push_back(MakePacket<std::string>("packet").At(Timestamp(i)));
+      bool notify;
+      producer_status.Update(
+          input_stream_manager_->MovePackets(&packets, &notify));
+      if (i % 7 == 0) {
+        producer_status.Update(input_stream_manager_->SetNextTimestampBound(
+            Timestamp(i + 1), &notify));
+      }
+    }
+    bool notify;
+    producer_status.Update(input_stream_manager_->SetNextTimestampBound(
+        Timestamp::Done(), &notify));
+  });
+  int next_timestamp = 0;
+  while (!stream_is_done_) {
+    bool is_empty;
+    Timestamp min_timestamp =
+        input_stream_manager_->MinTimestampOrBound(&is_empty);
+    if (is_empty) {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_EQ(Timestamp(next_timestamp), min_timestamp);
+    popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
+        min_timestamp, &num_packets_dropped_, &stream_is_done_);
+    ASSERT_EQ(Timestamp(next_timestamp), popped_packet_.Timestamp());
+    ASSERT_EQ(0, num_packets_dropped_);
+    ++next_timestamp;
+    if (next_timestamp == kNumPackets) {
+      // Wait for Timestamp::Done().
+      while (input_stream_manager_->MinTimestampOrBound(nullptr) !=
+             Timestamp::Done()) {
+        std::this_thread::yield();
+      }
+      popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
+          Timestamp::Max(), &num_packets_dropped_, &stream_is_done_);
+    }
+  }
+  producer.join();
+  MP_EXPECT_OK(producer_status);
+  EXPECT_EQ(kNumPackets, next_timestamp);
+  EXPECT_EQ(kNumPackets, input_stream_manager_->NumPacketsAdded());
+}
+
+TEST_P(InputStreamManagerTest, QueuedBytes) {
+  auto node_queued_bytes = std::make_shared<QueuedBytesCounter>();
+  input_stream_manager_->EnableQueuedBytes(node_queued_bytes);
+  std::shared_ptr<const QueuedBytesCounter> queued_bytes =
+      input_stream_manager_->QueuedBytes();
+  ASSERT_NE(queued_bytes, nullptr);
+
+  std::list<Packet> packets;
+  packets.push_back(MakePacket<std::string>("1234").At(Timestamp(10)));
+  packets.push_back(MakePacket<std::string>("123456").At(Timestamp(20)));
+  MP_ASSERT_OK(input_stream_manager_->AddPackets(packets, &notify_));
+  // Packets are counted once they reach the queue.
+  EXPECT_EQ(2, input_stream_manager_->QueueSize());
+  EXPECT_FALSE(input_stream_manager_->IsEmpty());
+  EXPECT_EQ(10, queued_bytes->Bytes());
+  EXPECT_EQ(10, node_queued_bytes->Bytes());
+
+  popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
+      Timestamp(10), &num_packets_dropped_, &stream_is_done_);
+  EXPECT_EQ(6, queued_bytes->Bytes());
+  EXPECT_EQ(10, queued_bytes->PeakBytes());
+  EXPECT_EQ(6, node_queued_bytes->Bytes());
+
+  input_stream_manager_->PrepareForRun();
+  EXPECT_EQ(0, queued_bytes->Bytes());
+  EXPECT_EQ(0, queued_bytes->PeakBytes());
+  EXPECT_EQ(0, node_queued_bytes->Bytes());
+  EXPECT_EQ(10, node_queued_bytes->PeakBytes());
+}
+
 }  // namespace
 }  // namespace mediapipe
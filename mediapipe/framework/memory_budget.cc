@@ -0,0 +1,61 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/memory_budget.h"
+
+#include <utility>
+
+namespace mediapipe {
+
+const GraphService<MemoryBudget> kMemoryBudgetService("kMemoryBudgetService");
+
+void MemoryBudget::Add(int64 bytes) {
+  const int64 total = bytes_.fetch_add(bytes) + bytes;
+  int64 peak = peak_bytes_.load(std::memory_order_relaxed);
+  while (total > peak && !peak_bytes_.compare_exchange_weak(peak, total)) {
+  }
+  const bool was_exceeded = total - bytes > limit_bytes_;
+  const bool is_exceeded = total > limit_bytes_;
+  if (was_exceeded == is_exceeded) return;
+  if (is_exceeded) ++exceeded_count_;
+  absl::MutexLock lock(&observers_mutex_);
+  for (const auto& id_and_observer : observers_) {
+    id_and_observer.second();
+  }
+}
+
+MemoryBudget::Stats MemoryBudget::GetStats() const {
+  Stats stats;
+  stats.limit_bytes = limit_bytes_;
+  stats.bytes = bytes_;
+  stats.peak_bytes = peak_bytes_;
+  stats.exceeded_count = exceeded_count_;
+  stats.throttled_count = throttled_count_;
+  stats.dropped_count = dropped_count_;
+  return stats;
+}
+
+int MemoryBudget::AddObserver(std::function<void()> observer) {
+  absl::MutexLock lock(&observers_mutex_);
+  const int id = next_observer_id_++;
+  observers_.emplace(id, std::move(observer));
+  return id;
+}
+
+void MemoryBudget::RemoveObserver(int id) {
+  absl::MutexLock lock(&observers_mutex_);
+  observers_.erase(id);
+}
+
+}  // namespace mediapipe
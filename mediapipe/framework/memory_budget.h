@@ -0,0 +1,114 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_MEMORY_BUDGET_H_
+#define MEDIAPIPE_FRAMEWORK_MEMORY_BUDGET_H_
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/graph_service.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// A limit on the memory held by the queues and buffer pools of one or more
+// graphs, e.g. to stay within the memory of a small device when a stage of the
+// pipeline stalls.
+//
+// The graph counts the payload bytes of the packets queued at calculator
+// inputs, as reported by the hooks in packet_payload_size.h. Buffer pools
+// given the budget count their unused buffers. Buffers held by calculators or
+// outside of a graph are not counted.
+//
+// While the budget is exceeded:
+//  - CalculatorGraph throttles its graph input streams, like a full input
+//    stream does: AddPacketToInputStream waits or returns Unavailable,
+//    depending on the GraphInputStreamAddMode. When the graph is idle, one
+//    packet at a time is let in, since nothing in the graph can free memory.
+//  - FlowLimiterCalculator holds frames back until those in flight finish,
+//    and drops them once its queue is full.
+//  - Buffer pools release their unused buffers instead of keeping them.
+//
+// Use it through kMemoryBudgetService:
+//
+//   auto budget = std::make_shared<MemoryBudget>(256 << 20);
+//   MP_RETURN_IF_ERROR(graph.SetServiceObject(kMemoryBudgetService, budget));
+//   image_frame_pool->SetMemoryBudget(budget);
+//
+// This class is thread-safe. It is owned by a shared_ptr, so that calculators
+// can share it with their pools through shared_from_this().
+class MemoryBudget : public std::enable_shared_from_this<MemoryBudget> {
+ public:
+  // Counters describing the usage of the budget.
+  struct Stats {
+    int64 limit_bytes = 0;
+    int64 bytes = 0;
+    int64 peak_bytes = 0;
+    // Number of times the bytes went over the limit.
+    int64 exceeded_count = 0;
+    // Number of times a graph input stream was throttled, and number of
+    // packets dropped by FlowLimiterCalculator, while over the limit.
+    int64 throttled_count = 0;
+    int64 dropped_count = 0;
+  };
+
+  explicit MemoryBudget(int64 limit_bytes) : limit_bytes_(limit_bytes) {}
+
+  // Adds "bytes", which is negative for memory released.
+  void Add(int64 bytes) ABSL_LOCKS_EXCLUDED(observers_mutex_);
+
+  int64 limit_bytes() const { return limit_bytes_; }
+  int64 Bytes() const { return bytes_.load(std::memory_order_relaxed); }
+  bool IsExceeded() const { return Bytes() > limit_bytes_; }
+
+  void RecordThrottled() { ++throttled_count_; }
+  void RecordDropped() { ++dropped_count_; }
+
+  Stats GetStats() const;
+
+  // Registers "observer" to be called whenever the budget goes over or back
+  // under the limit. It runs on the thread that crossed the limit, possibly
+  // while holding the lock of a queue, so it must be fast, must not call
+  // Add(), and must check IsExceeded() for the current state. Returns an id
+  // for RemoveObserver(), which waits for running calls of the observer.
+  int AddObserver(std::function<void()> observer)
+      ABSL_LOCKS_EXCLUDED(observers_mutex_);
+  void RemoveObserver(int id) ABSL_LOCKS_EXCLUDED(observers_mutex_);
+
+ private:
+  const int64 limit_bytes_;
+  std::atomic<int64> bytes_{0};
+  std::atomic<int64> peak_bytes_{0};
+  std::atomic<int64> exceeded_count_{0};
+  std::atomic<int64> throttled_count_{0};
+  std::atomic<int64> dropped_count_{0};
+
+  absl::Mutex observers_mutex_;
+  int next_observer_id_ ABSL_GUARDED_BY(observers_mutex_) = 0;
+  std::map<int, std::function<void()>> observers_
+      ABSL_GUARDED_BY(observers_mutex_);
+};
+
+// Applies a MemoryBudget to a graph, see MemoryBudget. The service is optional
+// and has no default.
+extern const GraphService<MemoryBudget> kMemoryBudgetService;
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_MEMORY_BUDGET_H_
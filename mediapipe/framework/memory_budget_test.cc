@@ -0,0 +1,76 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/memory_budget.h"
+
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(MemoryBudgetTest, TracksBytesAndPeak) {
+  MemoryBudget budget(100);
+  budget.Add(60);
+  budget.Add(30);
+  budget.Add(-50);
+  EXPECT_EQ(budget.Bytes(), 40);
+  EXPECT_FALSE(budget.IsExceeded());
+  budget.Add(70);
+  EXPECT_TRUE(budget.IsExceeded());
+  budget.Add(-110);
+
+  const MemoryBudget::Stats stats = budget.GetStats();
+  EXPECT_EQ(stats.limit_bytes, 100);
+  EXPECT_EQ(stats.bytes, 0);
+  EXPECT_EQ(stats.peak_bytes, 110);
+  EXPECT_EQ(stats.exceeded_count, 1);
+}
+
+TEST(MemoryBudgetTest, NotifiesObserversWhenCrossingTheLimit) {
+  MemoryBudget budget(100);
+  int num_calls = 0;
+  bool last_exceeded = false;
+  const int id = budget.AddObserver([&]() {
+    ++num_calls;
+    last_exceeded = budget.IsExceeded();
+  });
+
+  budget.Add(100);
+  EXPECT_EQ(num_calls, 0);
+  budget.Add(1);
+  EXPECT_EQ(num_calls, 1);
+  EXPECT_TRUE(last_exceeded);
+  budget.Add(50);
+  EXPECT_EQ(num_calls, 1);
+  budget.Add(-51);
+  EXPECT_EQ(num_calls, 2);
+  EXPECT_FALSE(last_exceeded);
+
+  budget.RemoveObserver(id);
+  budget.Add(200);
+  EXPECT_EQ(num_calls, 2);
+}
+
+TEST(MemoryBudgetTest, RecordsThrottledAndDropped) {
+  MemoryBudget budget(100);
+  budget.RecordThrottled();
+  budget.RecordDropped();
+  budget.RecordDropped();
+  const MemoryBudget::Stats stats = budget.GetStats();
+  EXPECT_EQ(stats.throttled_count, 1);
+  EXPECT_EQ(stats.dropped_count, 2);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,58 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_METRICS_SINK_H_
+#define MEDIAPIPE_FRAMEWORK_METRICS_SINK_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// Receives a snapshot of the metrics of a CalculatorGraph, see
+// CalculatorGraph::ExportMetrics. Implementations forward the metrics to a
+// monitoring system. A metric is identified by its name and labels, and the
+// same name is always reported with the same kind and help text.
+class MetricsSink {
+ public:
+  // Label names and values, such as {{"node", "my_calculator"}}.
+  using Labels = std::vector<std::pair<std::string, std::string>>;
+
+  virtual ~MetricsSink() = default;
+
+  // Reports a value that only grows while the process runs.
+  virtual void AddCounter(const std::string& name, const std::string& help,
+                          const Labels& labels, double value) = 0;
+
+  // Reports a value that can go up and down.
+  virtual void AddGauge(const std::string& name, const std::string& help,
+                        const Labels& labels, double value) = 0;
+
+  // Reports a distribution of samples. "bucket_counts[i]" is the number of
+  // samples that are at most "upper_bounds[i]", and the last element of
+  // "bucket_counts" is the total number of samples, so it has one more
+  // element than "upper_bounds". "sum" is the sum of all samples.
+  virtual void AddHistogram(const std::string& name, const std::string& help,
+                            const Labels& labels,
+                            const std::vector<double>& upper_bounds,
+                            const std::vector<int64>& bucket_counts,
+                            double sum) = 0;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_METRICS_SINK_H_
@@ -17,6 +17,7 @@
 #include <memory>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "mediapipe/framework/input_stream_handler.h"
 #include "mediapipe/framework/input_stream_manager.h"
 #include "mediapipe/framework/output_stream_shard.h"
@@ -352,6 +353,37 @@ TEST_F(OutputStreamManagerTest, AddPacket) {
   EXPECT_TRUE(errors_.empty());
 }
 
+// Packets added after a propagation reuse the queue entries of the propagated
+// packets and are propagated intact.
+TEST_F(OutputStreamManagerTest, AddPacketsAfterPropagation) {
+  output_stream_shard_.AddPacket(
+      MakePacket<std::string>("packet 1").At(Timestamp(10)));
+  output_stream_shard_.AddPacket(
+      MakePacket<std::string>("packet 2").At(Timestamp(20)));
+  EXPECT_EQ(Timestamp(21), ComputeBoundAndPropagateUpdates(Timestamp(0)));
+  EXPECT_TRUE(output_stream_shard_.IsEmpty());
+
+  output_stream_shard_.AddPacket(
+      MakePacket<std::string>("packet 3").At(Timestamp(30)));
+  const Packet packet_4 = MakePacket<std::string>("packet 4").At(Timestamp(40));
+  output_stream_shard_.AddPacket(packet_4);
+  output_stream_shard_.AddPacket(
+      MakePacket<std::string>("packet 5").At(Timestamp(50)));
+  EXPECT_EQ(Timestamp(50), output_stream_shard_.LastAddedPacketTimestamp());
+  EXPECT_EQ(Timestamp(51), ComputeBoundAndPropagateUpdates(Timestamp(0)));
+  EXPECT_TRUE(output_stream_shard_.IsEmpty());
+
+  ASSERT_EQ(5, input_stream_manager_.QueueSize());
+  for (int i = 1; i <= 5; ++i) {
+    bool stream_is_done = false;
+    Packet packet = input_stream_manager_.PopQueueHead(&stream_is_done);
+    EXPECT_EQ(Timestamp(i * 10), packet.Timestamp());
+    EXPECT_EQ(absl::StrCat("packet ", i), packet.Get<std::string>());
+  }
+  EXPECT_EQ("packet 4", packet_4.Get<std::string>());
+  EXPECT_TRUE(errors_.empty());
+}
+
 // The stream should reject the four timestamps that are not allowed in a
 // stream: Timestamp::Unset(), Timestamp::Unstarted(),
 // Timestamp::OneOverPostStream(), and Timestamp::Done().
@@ -16,6 +16,7 @@
 #define MEDIAPIPE_FRAMEWORK_OUTPUT_STREAM_POLLER_H_
 
 #include <memory>
+#include <vector>
 
 #include "mediapipe/framework/graph_output_stream.h"
 
@@ -48,6 +49,31 @@ class OutputStreamPoller {
     return poller->Next(packet);
   }
 
+  // Appends up to max_packets packets to packets (blocks until at least one
+  // is available or the stream is done).  This drains a backlog at a much
+  // lower cost per packet than repeated calls to Next().  Returns true if
+  // successful.
+  ABSL_MUST_USE_RESULT bool NextBatch(std::vector<Packet>* packets,
+                                      size_t max_packets) {
+    auto poller = internal_poller_impl_.lock();
+    if (!poller) {
+      return false;
+    }
+    return poller->NextBatch(packets, max_packets);
+  }
+
+  // Appends up to max_packets packets that are already available to packets,
+  // without blocking.  Returns true, possibly without appending any packet,
+  // until the stream is done.
+  ABSL_MUST_USE_RESULT bool TryNextBatch(std::vector<Packet>* packets,
+                                         size_t max_packets) {
+    auto poller = internal_poller_impl_.lock();
+    if (!poller) {
+      return false;
+    }
+    return poller->TryNextBatch(packets, max_packets);
+  }
+
   void SetMaxQueueSize(int queue_size) {
     auto poller = internal_poller_impl_.lock();
     CHECK(poller) << "OutputStreamPollerImpl is already destroyed.";
@@ -108,13 +108,22 @@ class OutputStreamShard : public OutputStream {
   std::list<Packet>* OutputQueue() { return &output_queue_; }
   const std::list<Packet>* OutputQueue() const { return &output_queue_; }
 
+  // Empties the output queue, keeping its list nodes for reuse.
+  void ClearOutputQueue();
+
   // Resets data members.
   void Reset(Timestamp next_timestamp_bound, bool close);
 
+  // The maximum number of list nodes kept in spare_nodes_.
+  static constexpr int kMaxSpareNodes = 8;
+
   // A pointer to the output stream spec object, which is owned by the output
   // stream manager.
   OutputStreamSpec* output_stream_spec_;
   std::list<Packet> output_queue_;
+  // Empty list nodes of propagated packets. They are spliced back into
+  // output_queue_ by AddPacket(), which saves an allocation per packet.
+  std::list<Packet> spare_nodes_;
   bool closed_;
   Timestamp next_timestamp_bound_;
   // Equal to next_timestamp_bound_ only if the bound has been explicitly set
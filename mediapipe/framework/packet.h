@@ -28,6 +28,7 @@
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/deps/no_destructor.h"
 #include "mediapipe/framework/deps/registration.h"
+#include "mediapipe/framework/deps/slab_allocator.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/logging.h"
@@ -245,6 +246,13 @@ Packet Adopt(const T* ptr);
 template <typename T>
 Packet PointToForeign(const T* ptr);
 
+// Returns a Packet that points to data owned by the payload of `owner`, such
+// as an element of a vector held by `owner`, without copying it. The payload
+// of `owner` is kept alive as long as the returned Packet or any of its copies
+// exists. Like with PointToForeign above, the data can't be consumed.
+template <typename T>
+Packet PointToForeign(const T* ptr, const Packet& owner);
+
 // Adopts the data but places it in a std::unique_ptr inside the
 // resulting Packet, leaving the timestamp unset. This allows the
 // adopted data to be mutated, with the mutable data accessible as
@@ -324,6 +332,23 @@ Packet MakePacket(Args&&... args) {  // NOLINT(build/c++11)
       new T{std::forward<typename std::remove_extent<T>::type>(args)...}));
 }
 
+// Create a packet containing an object of type T initialized with the
+// provided arguments, like MakePacket, but with pooled storage: the payload,
+// its holder and the shared_ptr control block are placed in a single block
+// that is recycled through thread-local free lists (see SlabAllocator).
+//
+// MakePacket needs three heap allocations per packet (the payload, the holder
+// and the control block); MakePooledPacket needs none in steady state for
+// small payloads such as Detection or NormalizedRect. Memory owned by the
+// payload itself (e.g. the buffer of a std::vector) is still allocated as
+// usual.
+//
+// The returned packet behaves like one returned by MakePacket, except that
+// Consume() moves the payload into a newly allocated object instead of
+// releasing it, and fails if T is not move-constructible.
+template <typename T, typename... Args>
+Packet MakePooledPacket(Args&&... args);  // NOLINT(build/c++11)
+
 // Returns a mutable pointer to the data in a unique_ptr in a packet. This
 // is useful in combination with AdoptAsUniquePtr.  The caller must
 // exercise caution when mutating the retrieved data, since the data
@@ -358,7 +383,7 @@ class ForeignHolder;
 
 class HolderBase {
  public:
-  HolderBase() {}
+  explicit HolderBase(TypeId type_id) : type_id_(type_id) {}
   HolderBase(const HolderBase&) = delete;
   HolderBase& operator=(const HolderBase&) = delete;
   virtual ~HolderBase();
@@ -371,8 +396,10 @@ class HolderBase {
   // Returns the registered type name if it's available, otherwise the
   // empty string.
   virtual const std::string RegisteredTypeName() const = 0;
-  // Get the type id of the underlying data type.
-  virtual TypeId GetTypeId() const = 0;
+  // Get the type id of the underlying data type. It is stored rather than
+  // returned by a virtual function, so that the type check in every
+  // Packet::Get() is a single inline comparison.
+  TypeId GetTypeId() const { return type_id_; }
   // Downcasts this to Holder<T>.  Returns nullptr if deserialization
   // failed or if the requested type is not what is stored.
   template <typename T>
@@ -393,6 +420,13 @@ class HolderBase {
   GetVectorOfProtoMessageLite() const = 0;
 
   virtual bool HasForeignOwner() const { return false; }
+
+  // Returns true if the payload is stored inline in the holder, as done by
+  // MakePooledPacket, rather than in its own heap allocation.
+  virtual bool HasInlinePayload() const { return false; }
+
+ private:
+  const TypeId type_id_;
 };
 
 // Two helper functions to get the proto base pointers.
@@ -497,7 +531,7 @@ struct HolderSupport<T,
 template <typename T>
 class Holder : public HolderBase {
  public:
-  explicit Holder(const T* ptr) : ptr_(ptr) {
+  explicit Holder(const T* ptr) : HolderBase(kTypeId<T>), ptr_(ptr) {
     HolderSupport<T>::EnsureStaticInit();
   }
   ~Holder() override { delete_helper(); }
@@ -505,7 +539,6 @@ class Holder : public HolderBase {
     HolderSupport<T>::EnsureStaticInit();
     return *ptr_;
   }
-  TypeId GetTypeId() const final { return kTypeId<T>; }
   // Releases the underlying data pointer and transfers the ownership to a
   // unique pointer.
   // This method is dangerous and is only used by Packet::Consume() if the
@@ -518,6 +551,9 @@ class Holder : public HolderBase {
       return InternalError(
           "Foreign holder can't release data ptr without ownership.");
     }
+    if (HasInlinePayload()) {
+      return MoveInlinePayload();
+    }
     // Casts away constness to make the data mutable after the release.
     std::unique_ptr<T> data_ptr(const_cast<T*>(ptr_));
     ptr_ = nullptr;
@@ -563,6 +599,17 @@ class Holder : public HolderBase {
   }
 
  private:
+  // An inline payload cannot be released, so it is moved into a new object.
+  absl::StatusOr<std::unique_ptr<T>> MoveInlinePayload() {
+    if constexpr (std::is_move_constructible<T>::value &&
+                  !std::is_array<T>::value) {
+      return std::make_unique<T>(std::move(*const_cast<T*>(ptr_)));
+    } else {
+      return absl::InternalError(
+          "Can't consume a pooled packet of a non-movable type.");
+    }
+  }
+
   // Call delete[] if T is an array, delete otherwise.
   template <typename U = T>
   inline void delete_helper(
@@ -584,6 +631,8 @@ template <typename T>
 class ForeignHolder : public Holder<T> {
  public:
   using Holder<T>::Holder;
+  ForeignHolder(const T* ptr, std::shared_ptr<HolderBase> owner)
+      : Holder<T>(ptr), owner_(std::move(owner)) {}
   ~ForeignHolder() override {
     // Null out ptr_ so it doesn't get deleted by ~Holder.
     // Note that ~Holder cannot call HasForeignOwner because the subclass's
@@ -591,6 +640,30 @@ class ForeignHolder : public Holder<T> {
     this->ptr_ = nullptr;
   }
   bool HasForeignOwner() const final { return true; }
+
+ private:
+  // The holder of the data pointed to, if any.
+  std::shared_ptr<HolderBase> owner_;
+};
+
+// Like Holder, but stores its data inline. Created by MakePooledPacket.
+template <typename T>
+class InlineHolder : public Holder<T> {
+ public:
+  template <typename... Args>
+  explicit InlineHolder(Args&&... args)
+      : Holder<T>(nullptr), data_(std::forward<Args>(args)...) {
+    this->ptr_ = &data_;
+  }
+  ~InlineHolder() override {
+    // data_ is destroyed with this object, so it must not be deleted by
+    // ~Holder.
+    this->ptr_ = nullptr;
+  }
+  bool HasInlinePayload() const final { return true; }
+
+ private:
+  T data_;
 };
 
 template <typename T>
@@ -765,12 +838,30 @@ Packet Adopt(const T* ptr) {
   return packet_internal::Create(new packet_internal::Holder<T>(ptr));
 }
 
+template <typename T, typename... Args>
+Packet MakePooledPacket(Args&&... args) {  // NOLINT(build/c++11)
+  static_assert(!std::is_array<T>::value,
+                "MakePooledPacket does not support arrays.");
+  return packet_internal::Create(
+      std::allocate_shared<packet_internal::InlineHolder<T>>(
+          SlabAllocator<packet_internal::InlineHolder<T>>(),
+          std::forward<Args>(args)...),
+      Timestamp::Unset());
+}
+
 template <typename T>
 Packet PointToForeign(const T* ptr) {
   CHECK(ptr != nullptr);
   return packet_internal::Create(new packet_internal::ForeignHolder<T>(ptr));
 }
 
+template <typename T>
+Packet PointToForeign(const T* ptr, const Packet& owner) {
+  CHECK(ptr != nullptr);
+  return packet_internal::Create(new packet_internal::ForeignHolder<T>(
+      ptr, packet_internal::GetHolderShared(owner)));
+}
+
 // Equal Packets refer to the same memory contents, like equal pointers.
 inline bool operator==(const Packet& p1, const Packet& p2) {
   return packet_internal::GetHolder(p1) == packet_internal::GetHolder(p2);
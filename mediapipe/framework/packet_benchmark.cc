@@ -0,0 +1,135 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the cost of creating and destroying packets through MakePacket and
+// through MakePooledPacket. Besides the time per packet, every benchmark
+// reports the number of global heap allocations per packet. Also measures the
+// packet access hot path: Get() and type validation through the legacy and the
+// api2 packet interfaces.
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "mediapipe/framework/api2/packet.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/benchmark.h"
+
+namespace {
+
+std::atomic<long> num_allocations{0};  // NOLINT(runtime/int)
+
+}  // namespace
+
+void* operator new(size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace mediapipe {
+namespace {
+
+// The number of packets that are alive at the same time, like the packets of
+// one frame queued in the input streams of a graph.
+constexpr int kPacketsPerFrame = 100;
+
+template <typename T>
+struct MakeHeapPacket {
+  static Packet Make() { return MakePacket<T>(); }
+};
+
+template <typename T>
+struct MakePoolPacket {
+  static Packet Make() { return MakePooledPacket<T>(); }
+};
+
+template <typename Factory>
+void BM_CreatePackets(benchmark::State& state) {
+  std::vector<Packet> packets(kPacketsPerFrame);
+  const long start = num_allocations.load();  // NOLINT(runtime/int)
+  for (auto _ : state) {
+    for (Packet& packet : packets) {
+      packet = Factory::Make();
+    }
+    benchmark::DoNotOptimize(packets.data());
+    for (Packet& packet : packets) {
+      packet = Packet();
+    }
+  }
+  const double num_packets =
+      static_cast<double>(state.iterations()) * kPacketsPerFrame;
+  state.SetItemsProcessed(state.iterations() * kPacketsPerFrame);
+  state.counters["allocs_per_packet"] =
+      (num_allocations.load() - start) / num_packets;
+}
+
+BENCHMARK_TEMPLATE(BM_CreatePackets, MakeHeapPacket<int>);
+BENCHMARK_TEMPLATE(BM_CreatePackets, MakePoolPacket<int>);
+BENCHMARK_TEMPLATE(BM_CreatePackets, MakeHeapPacket<NormalizedRect>);
+BENCHMARK_TEMPLATE(BM_CreatePackets, MakePoolPacket<NormalizedRect>);
+BENCHMARK_TEMPLATE(BM_CreatePackets, MakeHeapPacket<Detection>);
+BENCHMARK_TEMPLATE(BM_CreatePackets, MakePoolPacket<Detection>);
+BENCHMARK_TEMPLATE(BM_CreatePackets, MakeHeapPacket<std::vector<float>>);
+BENCHMARK_TEMPLATE(BM_CreatePackets, MakePoolPacket<std::vector<float>>);
+
+// Reads the payloads of a frame's worth of packets. Items are packet reads.
+void BM_LegacyPacketGet(benchmark::State& state) {
+  std::vector<Packet> packets(kPacketsPerFrame, MakePacket<int>(1));
+  int sum = 0;
+  for (auto _ : state) {
+    for (const Packet& packet : packets) {
+      sum += packet.Get<int>();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kPacketsPerFrame);
+}
+BENCHMARK(BM_LegacyPacketGet);
+
+void BM_Api2PacketGet(benchmark::State& state) {
+  std::vector<api2::Packet<int>> packets(kPacketsPerFrame,
+                                         api2::MakePacket<int>(1));
+  int sum = 0;
+  for (auto _ : state) {
+    for (const api2::Packet<int>& packet : packets) {
+      sum += packet.Get();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kPacketsPerFrame);
+}
+BENCHMARK(BM_Api2PacketGet);
+
+// Validates packets as done for every packet sent to a typed stream.
+void BM_ValidateAsType(benchmark::State& state) {
+  std::vector<Packet> packets(kPacketsPerFrame, MakePacket<int>(1));
+  for (auto _ : state) {
+    for (const Packet& packet : packets) {
+      benchmark::DoNotOptimize(packet.ValidateAsType<int>().ok());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kPacketsPerFrame);
+}
+BENCHMARK(BM_ValidateAsType);
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,92 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/packet_payload_size.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/no_destructor.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+namespace {
+
+class PayloadSizeRegistry {
+ public:
+  static PayloadSizeRegistry& Get() {
+    static NoDestructor<PayloadSizeRegistry> registry;
+    return *registry;
+  }
+
+  void Register(TypeId type_id,
+                std::function<size_t(const Packet&)> payload_size) {
+    absl::WriterMutexLock lock(&mutex_);
+    hooks_[type_id] = std::move(payload_size);
+  }
+
+  size_t PayloadSize(const Packet& packet) const {
+    absl::ReaderMutexLock lock(&mutex_);
+    auto it = hooks_.find(packet.GetTypeId());
+    return it == hooks_.end() ? 0 : it->second(packet);
+  }
+
+ private:
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<TypeId, std::function<size_t(const Packet&)>> hooks_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+// Hooks for the vectors of plain values that calculators commonly output.
+#define REGISTER_VECTOR_PAYLOAD_SIZE(type)                       \
+  MEDIAPIPE_REGISTER_PAYLOAD_SIZE(                               \
+      std::vector<type>, [](const std::vector<type>& v) {        \
+        return v.size() * sizeof(type);                          \
+      })
+
+REGISTER_VECTOR_PAYLOAD_SIZE(float);
+REGISTER_VECTOR_PAYLOAD_SIZE(double);
+REGISTER_VECTOR_PAYLOAD_SIZE(int);
+REGISTER_VECTOR_PAYLOAD_SIZE(int64);
+REGISTER_VECTOR_PAYLOAD_SIZE(uint8);
+#undef REGISTER_VECTOR_PAYLOAD_SIZE
+
+MEDIAPIPE_REGISTER_PAYLOAD_SIZE(std::string, [](const std::string& s) {
+  return s.size();
+});
+
+}  // namespace
+
+size_t PacketPayloadSize(const Packet& packet) {
+  if (packet.IsEmpty()) {
+    return 0;
+  }
+  return PayloadSizeRegistry::Get().PayloadSize(packet);
+}
+
+namespace packet_internal {
+
+bool RegisterPayloadSize(TypeId type_id,
+                         std::function<size_t(const Packet&)> payload_size) {
+  PayloadSizeRegistry::Get().Register(type_id, std::move(payload_size));
+  return true;
+}
+
+}  // namespace packet_internal
+
+}  // namespace mediapipe
@@ -0,0 +1,102 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Payload-size hooks report the memory held by the payload of a packet, so
+// that the framework can account for the bytes sitting in input stream
+// queues. A hook is registered once per packet type, next to the type:
+//
+//   MEDIAPIPE_REGISTER_PAYLOAD_SIZE(
+//       ImageFrame, [](const ImageFrame& frame) -> size_t {
+//         return frame.PixelDataSize();
+//       });
+//
+// Packets of types without a hook count as zero bytes.
+//
+// QueuedBytesCounter tracks the queued bytes of an input stream or of all the
+// input streams of a node, see ProfilerConfig::enable_queued_bytes.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PACKET_PAYLOAD_SIZE_H_
+#define MEDIAPIPE_FRAMEWORK_PACKET_PAYLOAD_SIZE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/tool/type_util.h"
+#include "mediapipe/framework/type_map.h"
+
+namespace mediapipe {
+
+// Returns the number of bytes held by the payload of "packet", as reported by
+// the hook registered for its type. Returns 0 for an empty packet or a type
+// without a hook.
+size_t PacketPayloadSize(const Packet& packet);
+
+// Counts the bytes of the packets in one or more queues, and the peak of that
+// count. This class is thread-safe.
+class QueuedBytesCounter {
+ public:
+  // Adds "bytes", which is negative for packets leaving a queue.
+  void Add(int64 bytes) {
+    const int64 total = bytes_.fetch_add(bytes) + bytes;
+    int64 peak = peak_bytes_.load(std::memory_order_relaxed);
+    while (total > peak && !peak_bytes_.compare_exchange_weak(peak, total)) {
+    }
+  }
+
+  // Sets the peak to the current count.
+  void ResetPeak() { peak_bytes_ = bytes_.load(); }
+
+  int64 Bytes() const { return bytes_; }
+  int64 PeakBytes() const { return peak_bytes_; }
+
+ private:
+  std::atomic<int64> bytes_{0};
+  std::atomic<int64> peak_bytes_{0};
+};
+
+namespace packet_internal {
+
+// Registers "payload_size" as the hook for packets of type "type_id".
+// Replaces an earlier hook for the same type.
+bool RegisterPayloadSize(TypeId type_id,
+                         std::function<size_t(const Packet&)> payload_size);
+
+}  // namespace packet_internal
+
+// Registers "payload_size", a function of "const T&" returning size_t, as the
+// payload-size hook for packets of type T. Returns true so that it can be used
+// to initialize a static variable.
+template <typename T, typename F>
+bool RegisterPayloadSize(F payload_size) {
+  return packet_internal::RegisterPayloadSize(
+      kTypeId<T>, [payload_size](const Packet& packet) -> size_t {
+        return payload_size(packet.Get<T>());
+      });
+}
+
+// Registers the payload-size hook of a type at static initialization time.
+// Like MEDIAPIPE_REGISTER_TYPE, a type or function that contains commas should
+// be given through an additional macro or variable.
+#define MEDIAPIPE_REGISTER_PAYLOAD_SIZE(type, payload_size_fn)           \
+  static const bool TYPE_MAP_TEMP_OBJECT_NAME =                          \
+      ::mediapipe::RegisterPayloadSize<                                  \
+          ::mediapipe::type_map_internal::ReflectType<void(type*)>::Type>( \
+          payload_size_fn)
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PACKET_PAYLOAD_SIZE_H_
@@ -0,0 +1,57 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/packet_payload_size.h"
+
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+struct Blob {
+  int num_bytes;
+};
+
+MEDIAPIPE_REGISTER_PAYLOAD_SIZE(Blob, [](const Blob& blob) -> size_t {
+  return blob.num_bytes;
+});
+
+struct Unsized {};
+
+TEST(PacketPayloadSizeTest, UsesRegisteredHooks) {
+  EXPECT_EQ(PacketPayloadSize(MakePacket<Blob>(Blob{42})), 42);
+  EXPECT_EQ(PacketPayloadSize(MakePacket<std::vector<float>>(3)),
+            3 * sizeof(float));
+  EXPECT_EQ(PacketPayloadSize(MakePacket<std::string>("abc")), 3);
+  EXPECT_EQ(PacketPayloadSize(MakePacket<Unsized>()), 0);
+  EXPECT_EQ(PacketPayloadSize(Packet()), 0);
+}
+
+TEST(PacketPayloadSizeTest, QueuedBytesCounterTracksPeak) {
+  QueuedBytesCounter counter;
+  counter.Add(10);
+  counter.Add(20);
+  counter.Add(-25);
+  EXPECT_EQ(counter.Bytes(), 5);
+  EXPECT_EQ(counter.PeakBytes(), 30);
+  counter.ResetPeak();
+  EXPECT_EQ(counter.PeakBytes(), 5);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -412,6 +412,18 @@ TEST(PacketTest, TestForeignHolderConsumeOrCopy) {
   EXPECT_EQ(33, *result2.value());
 }
 
+TEST(PacketTest, TestForeignHolderKeepsOwnerAlive) {
+  Packet element;
+  {
+    Packet owner = MakePacket<std::vector<int>>(std::vector<int>{1, 2, 3});
+    element = PointToForeign(&owner.Get<std::vector<int>>()[1], owner);
+  }
+  ASSERT_FALSE(element.IsEmpty());
+  EXPECT_EQ(2, element.Get<int>());
+  absl::StatusOr<std::unique_ptr<int>> result = element.Consume<int>();
+  EXPECT_EQ(result.status().code(), absl::StatusCode::kFailedPrecondition);
+}
+
 TEST(PacketTest, TestConsumeBoundedArray) {
   Packet packet1 = MakePacket<int[3]>(10, 20, 30);
   Packet packet_copy = packet1;
@@ -517,5 +529,44 @@ TEST(PacketTest, SharedPtrWithPacketOwnership) {
   EXPECT_EQ(exist, false);
 }
 
+TEST(PacketTest, PooledPacketOwnership) {
+  bool exist;
+  Packet packet = MakePooledPacket<MyClass>(&exist);
+  ASSERT_EQ(exist, true);
+  EXPECT_EQ(packet.Get<MyClass>().value(), 0);
+  Packet copy = packet;
+  packet = {};
+  // The copy should still be retaining the object.
+  EXPECT_EQ(exist, true);
+  copy = {};
+  EXPECT_EQ(exist, false);
+}
+
+TEST(PacketTest, PooledPacketTypeAndTimestamp) {
+  Packet packet = MakePooledPacket<std::vector<float>>(3, 1.5f)
+                      .At(Timestamp(10));
+  MP_EXPECT_OK(packet.ValidateAsType<std::vector<float>>());
+  EXPECT_FALSE(packet.ValidateAsType<int>().ok());
+  EXPECT_EQ(packet.Timestamp(), Timestamp(10));
+  EXPECT_THAT(packet.Get<std::vector<float>>(),
+              testing::ElementsAre(1.5f, 1.5f, 1.5f));
+}
+
+TEST(PacketTest, ConsumePooledPacket) {
+  Packet packet = MakePooledPacket<std::string>("pooled");
+  MP_ASSERT_OK_AND_ASSIGN(std::unique_ptr<std::string> data,
+                          packet.Consume<std::string>());
+  EXPECT_EQ(*data, "pooled");
+  EXPECT_TRUE(packet.IsEmpty());
+}
+
+TEST(PacketTest, ConsumePooledPacketOfNonMovableType) {
+  bool exist;
+  Packet packet = MakePooledPacket<MyClass>(&exist);
+  EXPECT_FALSE(packet.Consume<MyClass>().ok());
+  EXPECT_FALSE(packet.IsEmpty());
+  EXPECT_EQ(exist, true);
+}
+
 }  // namespace
 }  // namespace mediapipe
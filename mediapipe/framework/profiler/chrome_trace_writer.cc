@@ -0,0 +1,151 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/chrome_trace_writer.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe {
+
+namespace {
+
+// The trace "processes" that hold the tracks of the nodes.
+constexpr int kCalculatorPid = 1;
+constexpr int kGpuPid = 2;
+
+// Returns "value" as a quoted JSON string.
+std::string JsonString(const std::string& value) {
+  std::string result = "\"";
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+      result += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      absl::StrAppend(&result, "\\u00", absl::Hex(c, absl::kZeroPad2));
+    } else {
+      result += c;
+    }
+  }
+  result += '"';
+  return result;
+}
+
+bool IsGpuEvent(GraphTrace::EventType event_type) {
+  return event_type == GraphTrace::GPU_TASK ||
+         event_type == GraphTrace::GPU_CALIBRATION ||
+         event_type == GraphTrace::GPU_QUEUED;
+}
+
+void AppendThreadName(int pid, int tid, const std::string& name,
+                      std::string* json) {
+  absl::StrAppend(json, R"({"name":"thread_name","ph":"M","pid":)", pid,
+                  R"(,"tid":)", tid, R"(,"args":{"name":)", JsonString(name),
+                  "}},\n");
+}
+
+void AppendProcessName(int pid, const std::string& name, std::string* json) {
+  absl::StrAppend(json, R"({"name":"process_name","ph":"M","pid":)", pid,
+                  R"(,"args":{"name":)", JsonString(name), "}},\n");
+}
+
+}  // namespace
+
+ChromeTraceWriter::ChromeTraceWriter(std::string path_prefix,
+                                     std::vector<std::string> node_names,
+                                     int max_file_count, int64 max_file_bytes,
+                                     int intervals_per_file)
+    : path_prefix_(std::move(path_prefix)),
+      node_names_(std::move(node_names)),
+      max_file_count_(std::max(max_file_count, 1)),
+      max_file_bytes_(max_file_bytes),
+      intervals_per_file_(std::max(intervals_per_file, 1)) {}
+
+void ChromeTraceWriter::AppendMetadataEvents(
+    const std::vector<std::string>& node_names, std::string* json) {
+  AppendProcessName(kCalculatorPid, "Calculators", json);
+  AppendProcessName(kGpuPid, "GPU", json);
+  for (int node_id = 0; node_id < node_names.size(); ++node_id) {
+    AppendThreadName(kCalculatorPid, node_id, node_names[node_id], json);
+    AppendThreadName(kGpuPid, node_id, node_names[node_id], json);
+  }
+}
+
+void ChromeTraceWriter::AppendTraceEvents(const GraphTrace& trace,
+                                          std::string* json) {
+  for (const GraphTrace::CalculatorTrace& event : trace.calculator_trace()) {
+    // A complete event has both times, an instant event has only one.
+    const bool is_complete = event.has_start_time() && event.has_finish_time();
+    const int64 time =
+        event.has_start_time() ? event.start_time() : event.finish_time();
+    absl::StrAppend(
+        json, R"({"name":")", GraphTrace::EventType_Name(event.event_type()),
+        R"(","cat":"mediapipe","ph":")", is_complete ? "X" : "i",
+        R"(","ts":)", trace.base_time() + time);
+    if (is_complete) {
+      absl::StrAppend(json, R"(,"dur":)",
+                      std::max<int64>(event.finish_time() - time, 0));
+    } else {
+      absl::StrAppend(json, R"(,"s":"t")");
+    }
+    absl::StrAppend(json, R"(,"pid":)",
+                    IsGpuEvent(event.event_type()) ? kGpuPid : kCalculatorPid,
+                    R"(,"tid":)", event.node_id(), R"(,"args":{"thread_id":)",
+                    event.thread_id());
+    if (event.has_input_timestamp()) {
+      absl::StrAppend(json, R"(,"input_timestamp":)",
+                      trace.base_timestamp() + event.input_timestamp());
+    }
+    absl::StrAppend(json, "}},\n");
+  }
+}
+
+absl::Status ChromeTraceWriter::StartNextFile() {
+  if (file_.is_open()) {
+    file_.close();
+  }
+  file_index_ = (file_index_ + 1) % max_file_count_;
+  const std::string path = absl::StrCat(path_prefix_, file_index_, ".json");
+  file_.open(path, std::ofstream::out | std::ofstream::trunc);
+  RET_CHECK(file_.is_open()) << "Could not open trace log file: " << path;
+  std::string json = "[\n";
+  AppendMetadataEvents(node_names_, &json);
+  file_ << json;
+  file_bytes_ = json.size();
+  file_intervals_ = 0;
+  return absl::OkStatus();
+}
+
+absl::Status ChromeTraceWriter::Write(const GraphTrace& trace) {
+  const bool is_full = max_file_bytes_ > 0
+                           ? file_bytes_ >= max_file_bytes_
+                           : file_intervals_ >= intervals_per_file_;
+  if (!file_.is_open() || is_full) {
+    MP_RETURN_IF_ERROR(StartNextFile());
+  }
+  std::string json;
+  AppendTraceEvents(trace, &json);
+  file_ << json;
+  file_.flush();
+  RET_CHECK(file_.good()) << "Could not write trace log file: "
+                          << absl::StrCat(path_prefix_, file_index_, ".json");
+  file_bytes_ += json.size();
+  ++file_intervals_;
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
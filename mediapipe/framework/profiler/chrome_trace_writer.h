@@ -0,0 +1,81 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_CHROME_TRACE_WRITER_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_CHROME_TRACE_WRITER_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+
+// Streams GraphTraces to rotating files in the Chrome trace event JSON
+// format, see ProfilerConfig::CHROME_JSON.
+//
+// Each file is a JSON array that is left open, so that chrome://tracing and
+// ui.perfetto.dev can load a file while events are still appended to it.
+// Every calculator node has a track in the "Calculators" process, and
+// GPU_QUEUED, GPU_TASK and GPU_CALIBRATION events, which are timed by the
+// GPU, have a separate track in the "GPU" process.
+//
+// Files are named StrCat(path_prefix, index, ".json"), and the index wraps
+// around after max_file_count files, so at most max_file_count files are
+// kept on disk.
+class ChromeTraceWriter {
+ public:
+  // A file is finished once it holds "max_file_bytes", or if
+  // "max_file_bytes" is 0, once it holds "intervals_per_file" GraphTraces.
+  ChromeTraceWriter(std::string path_prefix,
+                    std::vector<std::string> node_names, int max_file_count,
+                    int64 max_file_bytes, int intervals_per_file);
+
+  ChromeTraceWriter(const ChromeTraceWriter&) = delete;
+  ChromeTraceWriter& operator=(const ChromeTraceWriter&) = delete;
+
+  // Appends the events of "trace" to the current file, and flushes them.
+  absl::Status Write(const GraphTrace& trace);
+
+  // Appends the events of "trace" to "json", each followed by ",\n".
+  static void AppendTraceEvents(const GraphTrace& trace, std::string* json);
+
+  // Appends the events naming the processes and the track of each node to
+  // "json", each followed by ",\n".
+  static void AppendMetadataEvents(const std::vector<std::string>& node_names,
+                                   std::string* json);
+
+ private:
+  // Finishes the current file, and starts the next one.
+  absl::Status StartNextFile();
+
+  const std::string path_prefix_;
+  const std::vector<std::string> node_names_;
+  const int max_file_count_;
+  const int64 max_file_bytes_;
+  const int intervals_per_file_;
+
+  std::ofstream file_;
+  // The index of the current file, or -1 before the first file.
+  int file_index_ = -1;
+  int64 file_bytes_ = 0;
+  int file_intervals_ = 0;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_CHROME_TRACE_WRITER_H_
@@ -0,0 +1,120 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/chrome_trace_writer.h"
+
+#include <stdlib.h>
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+GraphTrace MakeTrace(int64 base_time) {
+  GraphTrace trace = ParseTextProtoOrDie<GraphTrace>(R"pb(
+    base_timestamp: 1000
+    calculator_trace {
+      node_id: 0
+      input_timestamp: 5
+      event_type: PROCESS
+      start_time: 10
+      finish_time: 25
+      thread_id: 3
+    }
+    calculator_trace {
+      node_id: 1
+      event_type: GPU_TASK
+      start_time: 12
+      finish_time: 20
+    }
+    calculator_trace { node_id: 1 event_type: READY_FOR_PROCESS start_time: 8 }
+  )pb");
+  trace.set_base_time(base_time);
+  return trace;
+}
+
+TEST(ChromeTraceWriterTest, AppendsTraceEvents) {
+  std::string json;
+  ChromeTraceWriter::AppendTraceEvents(MakeTrace(100), &json);
+  EXPECT_EQ(
+      json,
+      R"({"name":"PROCESS","cat":"mediapipe","ph":"X","ts":110,"dur":15,)"
+      R"("pid":1,"tid":0,"args":{"thread_id":3,"input_timestamp":1005}},)"
+      "\n"
+      R"({"name":"GPU_TASK","cat":"mediapipe","ph":"X","ts":112,"dur":8,)"
+      R"("pid":2,"tid":1,"args":{"thread_id":0}},)"
+      "\n"
+      R"({"name":"READY_FOR_PROCESS","cat":"mediapipe","ph":"i","ts":108,)"
+      R"("s":"t","pid":1,"tid":1,"args":{"thread_id":0}},)"
+      "\n");
+}
+
+TEST(ChromeTraceWriterTest, RotatesFiles) {
+  const std::string prefix =
+      absl::StrCat(getenv("TEST_TMPDIR"), "/chrome_trace_");
+  ChromeTraceWriter writer(prefix, {"a", "b"}, /*max_file_count=*/2,
+                           /*max_file_bytes=*/0, /*intervals_per_file=*/2);
+  MP_ASSERT_OK(writer.Write(MakeTrace(100)));
+  MP_ASSERT_OK(writer.Write(MakeTrace(200)));
+  MP_ASSERT_OK(writer.Write(MakeTrace(300)));
+
+  std::string file_0;
+  MP_ASSERT_OK(file::GetContents(absl::StrCat(prefix, 0, ".json"), &file_0));
+  EXPECT_EQ(file_0.substr(0, 2), "[\n");
+  EXPECT_THAT(file_0, HasSubstr(R"("tid":1,"args":{"name":"b"})"));
+  EXPECT_THAT(file_0, HasSubstr(R"("ts":110)"));
+  EXPECT_THAT(file_0, HasSubstr(R"("ts":210)"));
+  EXPECT_THAT(file_0, Not(HasSubstr(R"("ts":310)")));
+
+  std::string file_1;
+  MP_ASSERT_OK(file::GetContents(absl::StrCat(prefix, 1, ".json"), &file_1));
+  EXPECT_THAT(file_1, HasSubstr(R"("tid":0,"args":{"name":"a"})"));
+  EXPECT_THAT(file_1, HasSubstr(R"("ts":310)"));
+
+  // The third file replaces the first.
+  MP_ASSERT_OK(writer.Write(MakeTrace(400)));
+  MP_ASSERT_OK(writer.Write(MakeTrace(500)));
+  MP_ASSERT_OK(file::GetContents(absl::StrCat(prefix, 0, ".json"), &file_0));
+  EXPECT_THAT(file_0, HasSubstr(R"("ts":510)"));
+  EXPECT_THAT(file_0, Not(HasSubstr(R"("ts":110)")));
+}
+
+TEST(ChromeTraceWriterTest, RotatesFilesBySize) {
+  const std::string prefix =
+      absl::StrCat(getenv("TEST_TMPDIR"), "/chrome_trace_bytes_");
+  ChromeTraceWriter writer(prefix, {"a", "b"}, /*max_file_count=*/3,
+                           /*max_file_bytes=*/1, /*intervals_per_file=*/10);
+  MP_ASSERT_OK(writer.Write(MakeTrace(100)));
+  MP_ASSERT_OK(writer.Write(MakeTrace(200)));
+
+  std::string file_1;
+  MP_ASSERT_OK(file::GetContents(absl::StrCat(prefix, 1, ".json"), &file_1));
+  EXPECT_THAT(file_1, HasSubstr(R"("ts":210)"));
+  EXPECT_THAT(file_1, Not(HasSubstr(R"("ts":110)")));
+}
+
+}  // namespace
+}  // namespace mediapipe
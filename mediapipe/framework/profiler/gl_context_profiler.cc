@@ -12,12 +12,258 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+
+#include <algorithm>
+#include <deque>
 #include <memory>
+#include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/match.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "mediapipe/framework/profiler/graph_profiler.h"
+#include "mediapipe/gpu/gl_base.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Query enums, which have the same values in the EXT and the core versions.
+constexpr GLenum kTimestamp = 0x8E28;              // GL_TIMESTAMP
+constexpr GLenum kQueryResult = 0x8866;            // GL_QUERY_RESULT
+constexpr GLenum kQueryResultAvailable = 0x8867;   // GL_QUERY_RESULT_AVAILABLE
+constexpr GLenum kGpuDisjoint = 0x8FBB;            // GL_GPU_DISJOINT_EXT
+
+// The GPU clock is calibrated against the profiler clock this often.
+constexpr absl::Duration kCalibrationInterval = absl::Seconds(5);
+
+// Pending tasks beyond this are dropped, oldest first.
+constexpr int kMaxPendingTasks = 256;
+
+// The timer query entry points, which are extensions on OpenGL ES.
+struct TimerQueryFunctions {
+  void (*gen_queries)(GLsizei n, GLuint* ids);
+  void (*delete_queries)(GLsizei n, const GLuint* ids);
+  void (*query_counter)(GLuint id, GLenum target);
+  void (*get_query_objectuiv)(GLuint id, GLenum pname, GLuint* params);
+  void (*get_query_objectui64v)(GLuint id, GLenum pname, GLuint64* params);
+  void (*get_integer64v)(GLenum pname, GLint64* data);
+  // True if the GPU can report disjoint timer operations.
+  bool has_disjoint;
+};
+
+absl::optional<TimerQueryFunctions> LoadTimerQueryFunctions() {
+#if HAS_EGL
+  const char* extensions =
+      reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+  if (extensions == nullptr ||
+      !absl::StrContains(extensions, "GL_EXT_disjoint_timer_query")) {
+    return absl::nullopt;
+  }
+  TimerQueryFunctions functions;
+  functions.gen_queries = reinterpret_cast<decltype(functions.gen_queries)>(
+      eglGetProcAddress("glGenQueriesEXT"));
+  functions.delete_queries =
+      reinterpret_cast<decltype(functions.delete_queries)>(
+          eglGetProcAddress("glDeleteQueriesEXT"));
+  functions.query_counter = reinterpret_cast<decltype(functions.query_counter)>(
+      eglGetProcAddress("glQueryCounterEXT"));
+  functions.get_query_objectuiv =
+      reinterpret_cast<decltype(functions.get_query_objectuiv)>(
+          eglGetProcAddress("glGetQueryObjectuivEXT"));
+  functions.get_query_objectui64v =
+      reinterpret_cast<decltype(functions.get_query_objectui64v)>(
+          eglGetProcAddress("glGetQueryObjectui64vEXT"));
+  functions.get_integer64v =
+      reinterpret_cast<decltype(functions.get_integer64v)>(
+          eglGetProcAddress("glGetInteger64vEXT"));
+  functions.has_disjoint = true;
+  if (!functions.gen_queries || !functions.delete_queries ||
+      !functions.query_counter || !functions.get_query_objectuiv ||
+      !functions.get_query_objectui64v || !functions.get_integer64v) {
+    return absl::nullopt;
+  }
+  return functions;
+#elif HAS_NSGL && CGL_VERSION_1_3
+  return TimerQueryFunctions{&glGenQueries,          &glDeleteQueries,
+                             &glQueryCounter,        &glGetQueryObjectuiv,
+                             &glGetQueryObjectui64v, &glGetInteger64v,
+                             /*has_disjoint=*/false};
+#else
+  // OpenGL ES on iOS has no timer queries.
+  return absl::nullopt;
+#endif  // HAS_EGL
+}
+
+}  // namespace
+
+class GlContextProfiler::Impl {
+ public:
+  explicit Impl(std::shared_ptr<ProfilingContext> profiling_context)
+      : profiling_context_(std::move(profiling_context)) {}
+
+  void MarkTimestamp(int node_id, Timestamp input_timestamp, bool is_finish) {
+    if (node_id < 0) return;
+    if (!is_finish) {
+      if (depth_++ > 0 || !Initialize()) return;
+      CalibrateTimer();
+      open_task_ = PendingTask{node_id, input_timestamp, TimeNow(),
+                               TakeQuery(), TakeQuery()};
+      functions_->query_counter(open_task_->start_query, kTimestamp);
+      return;
+    }
+    if (depth_ == 0 || --depth_ > 0 || !open_task_) return;
+    functions_->query_counter(open_task_->end_query, kTimestamp);
+    pending_tasks_.push_back(*open_task_);
+    open_task_.reset();
+    if (pending_tasks_.size() > kMaxPendingTasks) {
+      ReleaseQueries(pending_tasks_.front());
+      pending_tasks_.pop_front();
+    }
+    RetireReadyTasks(/*wait=*/false);
+  }
+
+  void LogAllTimestamps() {
+    if (!functions_) return;
+    if (open_task_) {
+      ReleaseQueries(*open_task_);
+      open_task_.reset();
+    }
+    depth_ = 0;
+    RetireReadyTasks(/*wait=*/true);
+    if (!free_queries_.empty()) {
+      functions_->delete_queries(free_queries_.size(), free_queries_.data());
+      free_queries_.clear();
+    }
+    // The context may be used again after this, e.g. by a new graph run.
+    functions_.reset();
+    checked_timing_supported_ = false;
+  }
+
+ private:
+  // GL work that is being timed.
+  struct PendingTask {
+    int node_id;
+    Timestamp input_timestamp;
+    // The profiler clock time at which the work started to be submitted.
+    absl::Time submit_time;
+    GLuint start_query;
+    GLuint end_query;
+  };
+
+  // Loads the timer query functions, on first use. Returns false if the
+  // context cannot be timed.
+  bool Initialize() {
+    if (!checked_timing_supported_) {
+      checked_timing_supported_ = true;
+      functions_ = LoadTimerQueryFunctions();
+      next_calibration_time_ = absl::InfinitePast();
+    }
+    return functions_.has_value();
+  }
+
+  absl::Time TimeNow() { return profiling_context_->GetClock()->TimeNow(); }
+
+  // Maps the GPU clock to the profiler clock, if it is time to do so.
+  void CalibrateTimer() {
+    absl::Time start_time = TimeNow();
+    if (start_time < next_calibration_time_) return;
+    TraceEvent event = TraceEvent(TraceEvent::GPU_CALIBRATION);
+    GLint64 gpu_time_ns = 0;
+    functions_->get_integer64v(kTimestamp, &gpu_time_ns);
+    absl::Time end_time = TimeNow();
+    // Assume the GPU clock was read halfway through the call.
+    gpu_epoch_ = start_time + (end_time - start_time) / 2 -
+                 absl::Nanoseconds(gpu_time_ns);
+    next_calibration_time_ = end_time + kCalibrationInterval;
+    profiling_context_->LogEvent(TraceEvent(event).set_event_time(start_time));
+    profiling_context_->LogEvent(
+        TraceEvent(event).set_event_time(end_time).set_is_finish(true));
+  }
+
+  // Reports the tasks whose queries have completed, in order. If wait is
+  // true, waits for all pending tasks.
+  void RetireReadyTasks(bool wait) {
+    if (functions_->has_disjoint) {
+      // A disjoint operation, such as a frequency change, invalidates the
+      // results of all pending queries.
+      GLint disjoint = 0;
+      glGetIntegerv(kGpuDisjoint, &disjoint);
+      if (disjoint) {
+        discard_pending_ = true;
+        next_calibration_time_ = absl::InfinitePast();
+      }
+    }
+    while (!pending_tasks_.empty()) {
+      PendingTask& task = pending_tasks_.front();
+      if (!wait) {
+        GLuint available = 0;
+        functions_->get_query_objectuiv(task.end_query, kQueryResultAvailable,
+                                        &available);
+        if (!available) break;
+      }
+      if (!discard_pending_) {
+        GLuint64 start_ns = 0;
+        GLuint64 end_ns = 0;
+        functions_->get_query_objectui64v(task.start_query, kQueryResult,
+                                          &start_ns);
+        functions_->get_query_objectui64v(task.end_query, kQueryResult,
+                                          &end_ns);
+        profiling_context_->AddGpuTaskSample(
+            task.node_id, task.input_timestamp, task.submit_time,
+            gpu_epoch_ + absl::Nanoseconds(start_ns),
+            gpu_epoch_ + absl::Nanoseconds(end_ns));
+      }
+      ReleaseQueries(task);
+      pending_tasks_.pop_front();
+    }
+    if (pending_tasks_.empty()) discard_pending_ = false;
+  }
+
+  GLuint TakeQuery() {
+    if (free_queries_.empty()) {
+      constexpr int kBatchSize = 8;
+      free_queries_.resize(kBatchSize);
+      functions_->gen_queries(kBatchSize, free_queries_.data());
+    }
+    GLuint query = free_queries_.back();
+    free_queries_.pop_back();
+    return query;
+  }
+
+  void ReleaseQueries(const PendingTask& task) {
+    free_queries_.push_back(task.start_query);
+    free_queries_.push_back(task.end_query);
+  }
+
+  std::shared_ptr<ProfilingContext> profiling_context_;
+  bool checked_timing_supported_ = false;
+  absl::optional<TimerQueryFunctions> functions_;
+  // The profiler clock time at which the GPU clock read zero.
+  absl::Time gpu_epoch_;
+  absl::Time next_calibration_time_;
+  // The depth of nested MarkTimestamp calls.
+  int depth_ = 0;
+  absl::optional<PendingTask> open_task_;
+  std::deque<PendingTask> pending_tasks_;
+  // True if the results of the pending tasks should be dropped.
+  bool discard_pending_ = false;
+  std::vector<GLuint> free_queries_;
+};
+
+GlContextProfiler::GlContextProfiler(
+    std::shared_ptr<ProfilingContext> profiling_context)
+    : impl_(absl::make_unique<Impl>(std::move(profiling_context))) {}
+
+GlContextProfiler::~GlContextProfiler() = default;
+
+void GlContextProfiler::MarkTimestamp(int node_id, Timestamp input_timestamp,
+                                      bool is_finish) {
+  impl_->MarkTimestamp(node_id, input_timestamp, is_finish);
+}
+
+void GlContextProfiler::LogAllTimestamps() { impl_->LogAllTimestamps(); }
 
-namespace mediapipe {}  // namespace mediapipe
+}  // namespace mediapipe
@@ -14,6 +14,7 @@
 
 #include "mediapipe/framework/profiler/graph_profiler.h"
 
+#include <algorithm>
 #include <fstream>
 #include <list>
 
@@ -165,13 +166,28 @@ void GraphProfiler::Initialize(
   interval_size_usec = interval_size_usec ? interval_size_usec : 1000000;
   int64 num_intervals = profiler_config_.num_histogram_intervals();
   num_intervals = num_intervals ? num_intervals : 1;
+  interval_size_usec_ = interval_size_usec;
+  num_intervals_ = num_intervals;
   if (IsTracerEnabled(profiler_config_)) {
     packet_tracer_ = absl::make_unique<GraphTracer>(profiler_config_);
   }
+  if (IsProfilerEnabled(profiler_config_) &&
+      profiler_config_.process_sample_rate() > 0) {
+    std::vector<std::string> node_names;
+    for (int node_id = 0;
+         node_id < validated_graph_config.CalculatorInfos().size(); ++node_id) {
+      node_names.push_back(
+          tool::CanonicalNodeName(validated_graph_config.Config(), node_id));
+    }
+    process_sampler_ = absl::make_unique<ProcessSampler>(
+        std::move(node_names), profiler_config_.process_sample_rate(),
+        profiler_config_.sample_publish_interval_usec());
+  }
   for (int node_id = 0;
        node_id < validated_graph_config.CalculatorInfos().size(); ++node_id) {
     std::string node_name =
         tool::CanonicalNodeName(validated_graph_config.Config(), node_id);
+    node_names_.push_back(node_name);
     CalculatorProfile profile;
     profile.set_name(node_name);
     InitializeTimeHistogram(interval_size_usec, num_intervals,
@@ -230,6 +246,10 @@ void GraphProfiler::Reset() {
     ResetTimeHistogram(calculator_profile->mutable_process_runtime());
     ResetTimeHistogram(calculator_profile->mutable_process_input_latency());
     ResetTimeHistogram(calculator_profile->mutable_process_output_latency());
+    if (calculator_profile->has_gpu_runtime()) {
+      ResetTimeHistogram(calculator_profile->mutable_gpu_queue_time());
+      ResetTimeHistogram(calculator_profile->mutable_gpu_runtime());
+    }
     for (auto& input_stream_profile :
          *(calculator_profile->mutable_input_stream_profiles())) {
       ResetTimeHistogram(input_stream_profile.mutable_latency());
@@ -239,6 +259,10 @@ void GraphProfiler::Reset() {
 
 // Begins profiling for a single graph run.
 absl::Status GraphProfiler::Start(mediapipe::Executor* executor) {
+  run_start_time_usec_ = TimeNowUsec();
+  if (process_sampler_) {
+    process_sampler_->Reset(run_start_time_usec_);
+  }
   // If specified, start periodic profile output while the graph runs.
   Resume();
   if (is_tracing_ && IsTraceIntervalEnabled(profiler_config_, tracer()) &&
@@ -275,6 +299,10 @@ absl::Status GraphProfiler::Start(mediapipe::Executor* executor) {
 absl::Status GraphProfiler::Stop() {
   is_running_ = false;
   Pause();
+  if (process_sampler_) {
+    // Publish the samples of the last, partial interval.
+    process_sampler_->Publish(TimeNowUsec());
+  }
   // If specified, write a final profile.
   if (IsTraceLogEnabled(profiler_config_)) {
     MP_RETURN_IF_ERROR(WriteProfile());
@@ -336,6 +364,9 @@ absl::Status GraphProfiler::GetCalculatorProfiles(
       << "GetCalculatorProfiles can only be called after Initialize()";
   for (auto& entry : calculator_profiles_) {
     profiles->push_back(entry.second);
+    if (process_sampler_) {
+      process_sampler_->GetPublished(&profiles->back());
+    }
   }
   return absl::OkStatus();
 }
@@ -449,6 +480,8 @@ void GraphProfiler::SetOpenRuntime(const CalculatorContext& calculator_context,
       calculator_context.NodeName());
   CalculatorProfile* calculator_profile = &profile_iter->second;
   calculator_profile->set_open_runtime(time_usec);
+  calculator_profile->set_open_start_time(start_time_usec -
+                                          run_start_time_usec_);
 
   if (profiler_config_.enable_stream_latency()) {
     AddStreamLatencies(calculator_context, start_time_usec, end_time_usec,
@@ -478,6 +511,61 @@ void GraphProfiler::SetCloseRuntime(const CalculatorContext& calculator_context,
   }
 }
 
+void GraphProfiler::SetWarmupRuntime(
+    const CalculatorContext& calculator_context, int64 start_time_usec,
+    int64 end_time_usec) {
+  absl::ReaderMutexLock lock(&profiler_mutex_);
+  if (!is_profiling_) {
+    return;
+  }
+  const std::string& node_name = calculator_context.NodeName();
+  auto profile_iter = calculator_profiles_.find(node_name);
+  CHECK(profile_iter != calculator_profiles_.end()) << absl::Substitute(
+      "Calculator \"$0\" has not been added during initialization.",
+      calculator_context.NodeName());
+  CalculatorProfile* calculator_profile = &profile_iter->second;
+  calculator_profile->set_warmup_runtime(end_time_usec - start_time_usec);
+}
+
+void GraphProfiler::AddDroppedInputSet(
+    const CalculatorContext& calculator_context) {
+  absl::ReaderMutexLock lock(&profiler_mutex_);
+  if (!is_profiling_) {
+    return;
+  }
+  const std::string& node_name = calculator_context.NodeName();
+  auto profile_iter = calculator_profiles_.find(node_name);
+  CHECK(profile_iter != calculator_profiles_.end()) << absl::Substitute(
+      "Calculator \"$0\" has not been added during initialization.",
+      calculator_context.NodeName());
+  CalculatorProfile* calculator_profile = &profile_iter->second;
+  calculator_profile->set_num_dropped_input_sets(
+      calculator_profile->num_dropped_input_sets() + 1);
+}
+
+void GraphProfiler::AddDroppedPackets(
+    const CalculatorContext& calculator_context, int stream_index,
+    int64 num_packets) {
+  absl::ReaderMutexLock lock(&profiler_mutex_);
+  if (!is_profiling_) {
+    return;
+  }
+  const std::string& node_name = calculator_context.NodeName();
+  auto profile_iter = calculator_profiles_.find(node_name);
+  CHECK(profile_iter != calculator_profiles_.end()) << absl::Substitute(
+      "Calculator \"$0\" has not been added during initialization.",
+      calculator_context.NodeName());
+  CalculatorProfile* calculator_profile = &profile_iter->second;
+  if (stream_index < 0 ||
+      stream_index >= calculator_profile->input_stream_profiles_size()) {
+    return;
+  }
+  StreamProfile* stream_profile =
+      calculator_profile->mutable_input_stream_profiles(stream_index);
+  stream_profile->set_num_dropped_packets(
+      stream_profile->num_dropped_packets() + num_packets);
+}
+
 void GraphProfiler::AddTimeSample(int64 start_time_usec, int64 end_time_usec,
                                   TimeHistogram* histogram) {
   if (end_time_usec < start_time_usec) {
@@ -565,12 +653,54 @@ void GraphProfiler::AddProcessSample(
 }
 
 std::unique_ptr<GlProfilingHelper> GraphProfiler::CreateGlProfilingHelper() {
-  if (!IsTracerEnabled(profiler_config_)) {
+  if (!IsTracerEnabled(profiler_config_) &&
+      !IsProfilerEnabled(profiler_config_)) {
     return nullptr;
   }
   return absl::make_unique<mediapipe::GlProfilingHelper>(shared_from_this());
 }
 
+void GraphProfiler::AddGpuTaskSample(int node_id, Timestamp input_timestamp,
+                                     absl::Time submit_time,
+                                     absl::Time start_time,
+                                     absl::Time end_time) {
+  if (is_tracing_) {
+    TraceEvent event = TraceEvent(GraphTrace::GPU_QUEUED)
+                           .set_node_id(node_id)
+                           .set_input_ts(input_timestamp);
+    packet_tracer_->LogEvent(TraceEvent(event).set_event_time(submit_time));
+    packet_tracer_->LogEvent(
+        TraceEvent(event).set_event_time(start_time).set_is_finish(true));
+    event.set_event_type(GraphTrace::GPU_TASK);
+    packet_tracer_->LogEvent(TraceEvent(event).set_event_time(start_time));
+    packet_tracer_->LogEvent(
+        TraceEvent(event).set_event_time(end_time).set_is_finish(true));
+  }
+
+  absl::ReaderMutexLock lock(&profiler_mutex_);
+  if (!is_profiling_ || node_id < 0 || node_id >= node_names_.size()) {
+    return;
+  }
+  auto profile_iter = calculator_profiles_.find(node_names_[node_id]);
+  if (profile_iter == calculator_profiles_.end()) {
+    return;
+  }
+  CalculatorProfile* calculator_profile = &profile_iter->second;
+  // Only nodes with GPU work get these histograms.
+  if (!calculator_profile->has_gpu_runtime()) {
+    InitializeTimeHistogram(interval_size_usec_, num_intervals_,
+                            calculator_profile->mutable_gpu_queue_time());
+    InitializeTimeHistogram(interval_size_usec_, num_intervals_,
+                            calculator_profile->mutable_gpu_runtime());
+  }
+  // The device may start the work before the submitting call returns.
+  AddTimeSample(ToUnixMicros(submit_time),
+                ToUnixMicros(std::max(submit_time, start_time)),
+                calculator_profile->mutable_gpu_queue_time());
+  AddTimeSample(ToUnixMicros(start_time), ToUnixMicros(end_time),
+                calculator_profile->mutable_gpu_runtime());
+}
+
 // A simple ZeroCopyOutputStream that writes to a std::ostream.
 class OstreamStream : public proto_ns::io::ZeroCopyOutputStream {
  public:
@@ -662,6 +792,16 @@ absl::StatusOr<std::string> GraphProfiler::GetTraceLogPath() {
   }
 }
 
+void GraphProfiler::AddExecutorProfileCallback(
+    std::function<void(ExecutorProfile*)> callback) {
+  executor_profile_callbacks_.push_back(std::move(callback));
+}
+
+void GraphProfiler::AddInputQueueProfileCallback(
+    std::function<void(GraphProfile*)> callback) {
+  input_queue_profile_callbacks_.push_back(std::move(callback));
+}
+
 absl::Status GraphProfiler::CaptureProfile(
     GraphProfile* result, PopulateGraphConfig populate_config) {
   // Record the GraphTrace events since the previous WriteProfile.
@@ -691,6 +831,12 @@ absl::Status GraphProfiler::CaptureProfile(
   }
   this->Reset();
   CleanCalculatorProfiles(result);
+  for (const auto& callback : executor_profile_callbacks_) {
+    callback(result->add_executor_profiles());
+  }
+  for (const auto& callback : input_queue_profile_callbacks_) {
+    callback(result);
+  }
   if (populate_config == PopulateGraphConfig::kFull) {
     *result->mutable_config() = validated_graph_->Config();
     AssignNodeNames(result);
@@ -715,6 +861,22 @@ absl::Status GraphProfiler::WriteProfile() {
     return absl::OkStatus();
   }
 
+  if (profiler_config_.trace_log_format() == ProfilerConfig::CHROME_JSON) {
+    absl::MutexLock lock(&trace_writer_mutex_);
+    if (!trace_writer_) {
+      std::vector<std::string> node_names;
+      for (int node_id = 0;
+           node_id < validated_graph_->CalculatorInfos().size(); ++node_id) {
+        node_names.push_back(
+            tool::CanonicalNodeName(validated_graph_->Config(), node_id));
+      }
+      trace_writer_ = absl::make_unique<ChromeTraceWriter>(
+          trace_log_path, std::move(node_names), log_file_count,
+          profiler_config_.trace_log_max_file_bytes(), log_interval_count);
+    }
+    return trace_writer_->Write(trace);
+  }
+
   // Record the CalculatorGraphConfig, once per log file.
   ++previous_log_index_;
   bool is_new_file = (previous_log_index_ % log_interval_count == 0);
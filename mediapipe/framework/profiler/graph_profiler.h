@@ -17,6 +17,7 @@
 
 #include <atomic>
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <set>
 #include <string>
@@ -29,8 +30,11 @@
 #include "mediapipe/framework/deps/clock.h"
 #include "mediapipe/framework/deps/monotonic_clock.h"
 #include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/profiler/chrome_trace_writer.h"
 #include "mediapipe/framework/profiler/graph_tracer.h"
+#include "mediapipe/framework/profiler/process_sampler.h"
 #include "mediapipe/framework/profiler/sharded_map.h"
 #include "mediapipe/framework/validated_graph_config.h"
 
@@ -91,6 +95,10 @@ enum class PopulateGraphConfig { kNo, kFull };
 //     enable_profiler: true
 //   }
 //
+// In the sampling mode, set by ProfilerConfig::process_sample_rate, only a
+// fraction of the Process() calls are timed, and their runtimes are reported
+// as percentiles.
+//
 // Because the graph definition affects the stream profiling and the profiler is
 // singleton, the profiler can not be used with more than one graph. Thus the
 // profiler disables itself and returns an empty stub if Initialize() is called
@@ -146,6 +154,27 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   absl::Status GetCalculatorProfiles(std::vector<CalculatorProfile>*) const
       ABSL_LOCKS_EXCLUDED(profiler_mutex_);
 
+  // Adds a callback that fills in one ExecutorProfile of the GraphProfile
+  // returned by CaptureProfile(). Should be called before the graph starts.
+  void AddExecutorProfileCallback(
+      std::function<void(ExecutorProfile*)> callback);
+
+  // Adds a callback that appends the GraphProfile::input_queue_profiles
+  // returned by CaptureProfile(). Should be called before the graph starts.
+  void AddInputQueueProfileCallback(
+      std::function<void(GraphProfile*)> callback);
+
+  // Counts an input set that the calculator of "calculator_context" skipped
+  // without calling Process(), because its deadline had passed.
+  void AddDroppedInputSet(const CalculatorContext& calculator_context)
+      ABSL_LOCKS_EXCLUDED(profiler_mutex_);
+
+  // Counts packets that the input stream handler of "calculator_context"
+  // discarded from the input stream with index "stream_index".
+  void AddDroppedPackets(const CalculatorContext& calculator_context,
+                         int stream_index, int64 num_packets)
+      ABSL_LOCKS_EXCLUDED(profiler_mutex_);
+
   // Records recent profiling and tracing data.  Includes events since the
   // previous call to CaptureProfile.
   //
@@ -167,6 +196,15 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // Creates and returns a GlProfilingHelper interface for a single GLContext.
   std::unique_ptr<GlProfilingHelper> CreateGlProfilingHelper();
 
+  // Records GPU work of a node, timed by the GPU and converted to the
+  // profiler clock: the work was submitted at "submit_time", and ran on the
+  // device from "start_time" to "end_time". Updates the gpu_queue_time and
+  // gpu_runtime of the node, and logs GPU_QUEUED and GPU_TASK events.
+  void AddGpuTaskSample(int node_id, Timestamp input_timestamp,
+                        absl::Time submit_time, absl::Time start_time,
+                        absl::Time end_time)
+      ABSL_LOCKS_EXCLUDED(profiler_mutex_);
+
   // Convenience temporary object to record scoped entry and exit.
   // Gets start_time_usec_ on construction and records process runtime on
   // destruction. The |calculator_context| and |profiler| must not be null.
@@ -182,6 +220,16 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
         : calculator_method_(event_type),
           calculator_context_(*calculator_context),
           profiler_(profiler) {
+      if (calculator_method_ == GraphTrace::PROCESS &&
+          profiler_->process_sampler_) {
+        // In the sampling mode, unsampled calls are not timed.
+        timed_ = profiler_->is_profiling_ &&
+                 profiler_->process_sampler_->ShouldSample(
+                     calculator_context_.NodeId());
+        if (!timed_ && !profiler_->is_tracing_) {
+          return;
+        }
+      }
       start_time_usec_ = profiler_->TimeNowUsec();
       if (profiler_->is_tracing_) {
         absl::Time time_now = absl::FromUnixMicros(start_time_usec_);
@@ -191,11 +239,14 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
     }
 
     inline ~Scope() {
+      if (!timed_ && !profiler_->is_tracing_) {
+        return;
+      }
       int64 end_time_usec;
       if (profiler_->is_profiling_ || profiler_->is_tracing_) {
         end_time_usec = profiler_->TimeNowUsec();
       }
-      if (profiler_->is_profiling_) {
+      if (profiler_->is_profiling_ && timed_) {
         int64 end_time_usec = profiler_->TimeNowUsec();
         switch (calculator_method_) {
           case GraphTrace::OPEN:
@@ -204,22 +255,45 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
             break;
 
           case GraphTrace::PROCESS:
-            profiler_->AddProcessSample(calculator_context_, start_time_usec_,
-                                        end_time_usec);
+            if (profiler_->process_sampler_) {
+              profiler_->process_sampler_->AddSample(
+                  calculator_context_.NodeId(),
+                  end_time_usec - start_time_usec_, end_time_usec);
+            } else {
+              profiler_->AddProcessSample(calculator_context_,
+                                          start_time_usec_, end_time_usec);
+            }
             break;
 
           case GraphTrace::CLOSE:
             profiler_->SetCloseRuntime(calculator_context_, start_time_usec_,
                                        end_time_usec);
             break;
+
+          case GraphTrace::WARMUP:
+            profiler_->SetWarmupRuntime(calculator_context_, start_time_usec_,
+                                        end_time_usec);
+            break;
           default:
             break;
         }
       }
       if (profiler_->is_tracing_) {
         absl::Time time_now = absl::FromUnixMicros(end_time_usec);
-        profiler_->packet_tracer_->LogOutputEvents(
-            calculator_method_, &calculator_context_, time_now);
+        if (calculator_method_ == GraphTrace::WARMUP) {
+          // Warm-up runs consume and produce no packets, so the node itself
+          // is traced.
+          TraceEvent event = TraceEvent(GraphTrace::WARMUP)
+                                 .set_node_id(calculator_context_.NodeId())
+                                 .set_input_ts(Timestamp::Unstarted());
+          profiler_->packet_tracer_->LogEvent(TraceEvent(event).set_event_time(
+              absl::FromUnixMicros(start_time_usec_)));
+          profiler_->packet_tracer_->LogEvent(
+              TraceEvent(event).set_event_time(time_now).set_is_finish(true));
+        } else {
+          profiler_->packet_tracer_->LogOutputEvents(
+              calculator_method_, &calculator_context_, time_now);
+        }
       }
     }
 
@@ -227,7 +301,9 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
     const GraphTrace::EventType calculator_method_;
     const CalculatorContext& calculator_context_;
     GraphProfiler* profiler_;
-    int64 start_time_usec_;
+    int64 start_time_usec_ = 0;
+    // False for the Process() calls left out by the sampling mode.
+    bool timed_ = true;
   };
 
   const ProfilerConfig& profiler_config() { return profiler_config_; }
@@ -283,6 +359,9 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   void SetCloseRuntime(const CalculatorContext& calculator_context,
                        int64 start_time_usec, int64 end_time_usec)
       ABSL_LOCKS_EXCLUDED(profiler_mutex_);
+  void SetWarmupRuntime(const CalculatorContext& calculator_context,
+                        int64 start_time_usec, int64 end_time_usec)
+      ABSL_LOCKS_EXCLUDED(profiler_mutex_);
 
   // Updates the input streams profiles for the calculator and returns the
   // minimum |source_process_start_usec| of all input packets, excluding empty
@@ -322,6 +401,11 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // Stores all the calculator profiles with the calculator name as the key.
   using CalculatorProfileMap = ShardedMap<std::string, CalculatorProfile>;
   CalculatorProfileMap calculator_profiles_;
+  // The calculator names, by node id.
+  std::vector<std::string> node_names_;
+  // The histogram settings for the calculator profiles.
+  int64 interval_size_usec_ = 0;
+  int64 num_intervals_ = 0;
   // Stores the production time of a packet, based on profiler's clock.
   using PacketInfoMap =
       ShardedMap<std::string, std::list<std::pair<int64, PacketInfo>>>;
@@ -339,6 +423,9 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // Inidicates that profiling has started and not yet stopped.
   std::atomic_bool is_running_;
 
+  // The start time of the current graph run, based on profiler's clock.
+  std::atomic<int64> run_start_time_usec_{0};
+
   // The end time of the previous output log.
   absl::Time previous_log_end_time_;
 
@@ -352,6 +439,22 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   class GraphProfileBuilder;
   std::unique_ptr<GraphProfileBuilder> profile_builder_;
 
+  // Callbacks that report the usage of the shared executors.
+  std::vector<std::function<void(ExecutorProfile*)>>
+      executor_profile_callbacks_;
+
+  // Records the sampled Process() runtimes in the sampling mode, or null.
+  std::unique_ptr<ProcessSampler> process_sampler_;
+
+  // Callbacks that report the state of the input stream queues.
+  std::vector<std::function<void(GraphProfile*)>>
+      input_queue_profile_callbacks_;
+
+  // Streams the trace logs in the CHROME_JSON format, once the first trace
+  // log is written.
+  absl::Mutex trace_writer_mutex_;
+  std::unique_ptr<ChromeTraceWriter> trace_writer_;
+
   // For testing.
   friend GraphProfilerTestPeer;
 };
@@ -364,77 +467,44 @@ class ProfilingContext : public GraphProfiler {
   using GraphProfiler::GraphProfiler;
 };
 
-// For now, OSS always uses GlContextProfilerStub.
-// TODO: Switch to GlContextProfiler when GlContext is moved to OSS.
+// GlContextProfiler needs GPU support.
+#if MEDIAPIPE_DISABLE_GPU
 #define MEDIAPIPE_DISABLE_GPU_PROFILER 1
-
-// GlContextProfiler keeps track of all timestamp queries within a specific
-// GlContext object. When created, the GlContextProfiler must be initialized
-// before marking timestamps. Finally, when GlContext is no longer interested
-// in marking timestamps or is about to be destroyed, Finish() must be called
-// to complete all pending time queries and detach the timer from the GlContext.
-// Note that the GlContextProfiler must be created and initialized within a
-// valid GlContext object.
+#endif  // MEDIAPIPE_DISABLE_GPU
+
+// GlContextProfiler times the GL work that calculators run on one GlContext,
+// using GL timestamp queries, and reports it to the ProfilingContext through
+// GraphProfiler::AddGpuTaskSample. Query results are read back once the GPU
+// has produced them, so timing does not stall the GL pipeline. The GPU clock
+// is periodically calibrated against the profiler clock, and the calibrations
+// are logged as GPU_CALIBRATION events.
+//
+// All methods must be called with the GlContext current. Finally, when the
+// GlContext is about to be destroyed, LogAllTimestamps() must be called to
+// complete all pending queries and release them. Contexts without timestamp
+// queries (GL_EXT_disjoint_timer_query, or OpenGL 3.3) are not timed.
 #if !MEDIAPIPE_DISABLE_GPU_PROFILER
 class GlContextProfiler {
  public:
   explicit GlContextProfiler(
-      std::shared_ptr<ProfilingContext> profiling_context)
-      : profiling_context_(profiling_context) {}
+      std::shared_ptr<ProfilingContext> profiling_context);
+  ~GlContextProfiler();
 
   // Not copyable or movable.
   GlContextProfiler(const GlContextProfiler&) = delete;
   GlContextProfiler& operator=(const GlContextProfiler&) = delete;
 
-  // Add a GlTimingInfo object to the collection of pending timestamp queries
-  // associated with a specific graph node_id, packet input_timestamp and mark
-  // if it is a start or stop event. When a stop event is marked, this function
-  // blocks on the corresponding start event to complete.
+  // Marks the start or the end of the GL work of a graph node for an input
+  // timestamp. Work that is not run for a node (node_id < 0) is not timed,
+  // and nested marks are timed as part of the outermost ones.
   void MarkTimestamp(int node_id, Timestamp input_timestamp, bool is_finish);
 
-  // Complete all pending timing queries and detach the timer from the
-  // GlContext.
+  // Complete all pending timing queries and release them.
   void LogAllTimestamps();
 
  private:
-  // Store GlTimeQuery and the corresponding TraceEvent object that should be
-  // populated when the query completes together.
-  struct GlTimingInfo {
-    GlTimeQuery time_query;
-    TraceEvent trace_event;
-  };
-
-  // Setup the timer for marking GPU timestamps. If successful in setup, return
-  // true otherwise return false to indicate that timing measurment is not
-  // supported.
-  bool Initialize();
-
-  absl::Time TimeNow();
-
-  // Calibrate the GPU timer w.r.t. the CPU clock. If calibration is fails,
-  // timing_measurement_supported_ is set to false.
-  void CalibrateTimer(bool recalibrate);
-
-  // Log a TraceEvent object to represent if the GPU calibration period has
-  // started or just ended.
-  void LogCalibrationEvent(bool started, absl::Time time);
-
-  // Log TraceEvent objects for completed time queries. If the parameter wait is
-  // set to true, wait for all time queries to complete before returning.
-  void RetireReadyGlTimings(bool wait = false);
-
-  // Get the TraceEvent object containing the timestamp recorded by the GPU if
-  // the provided query was fulfilled. If it is still pending and wait is false,
-  // return absl::nullopt.
-  absl::optional<TraceEvent> GetTimeFromQuery(
-      std::unique_ptr<GlTimingInfo>& query, bool wait);
-
-  std::shared_ptr<ProfilingContext> profiling_context_;
-  GlSimpleTimer gl_timer_;
-  bool checked_timing_supported_ = false;
-  bool timing_measurement_supported_ = false;
-  std::deque<std::unique_ptr<GlTimingInfo>> pending_gl_times_;
-  std::unique_ptr<GlTimingInfo> gl_start_query_;
+  class Impl;
+  std::unique_ptr<Impl> impl_;
 };
 
 // The API class used to access the preferred GlContext profiler, such as
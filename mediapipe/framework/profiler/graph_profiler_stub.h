@@ -15,20 +15,26 @@
 #ifndef MEDIAPIPE_FRAMEWORK_PROFILER_MEDIAPIPE_PROFILER_STUB_H_
 #define MEDIAPIPE_FRAMEWORK_PROFILER_MEDIAPIPE_PROFILER_STUB_H_
 
+#include <functional>
+
+#include "absl/time/time.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/timestamp.h"
 
 namespace mediapipe {
 class CalculatorProfile;
+class ExecutorProfile;
 class GraphTrace;
 class GraphProfile;
 }  // namespace mediapipe
 
 namespace mediapipe {
 using mediapipe::CalculatorProfile;
+using mediapipe::ExecutorProfile;
 using mediapipe::GraphProfile;
 using mediapipe::GraphTrace;
 
+class CalculatorContext;
 class ValidatedGraphConfig;
 class Executor;
 class Packet;
@@ -55,6 +61,9 @@ class TraceEvent {
     TPU_TASK,
     GPU_CALIBRATION,
     PACKET_QUEUED,
+    GPU_FINISH,
+    GPU_QUEUED,
+    WARMUP,
   };
   TraceEvent(const EventType& event_type) {}
   TraceEvent() {}
@@ -88,6 +97,14 @@ class GraphProfilerStub {
       std::vector<CalculatorProfile>*) const {
     return absl::OkStatus();
   }
+  inline void AddExecutorProfileCallback(
+      std::function<void(ExecutorProfile*)> callback) {}
+  inline void AddInputQueueProfileCallback(
+      std::function<void(GraphProfile*)> callback) {}
+  inline void AddDroppedInputSet(
+      const CalculatorContext& calculator_context) {}
+  inline void AddDroppedPackets(const CalculatorContext& calculator_context,
+                                int stream_index, int64 num_packets) {}
   absl::Status CaptureProfile(
       GraphProfile* result,
       PopulateGraphConfig populate_config = PopulateGraphConfig::kNo) {
@@ -104,6 +121,9 @@ class GraphProfilerStub {
   inline std::unique_ptr<GlProfilingHelper> CreateGlProfilingHelper() {
     return nullptr;
   }
+  inline void AddGpuTaskSample(int node_id, Timestamp input_timestamp,
+                               absl::Time submit_time, absl::Time start_time,
+                               absl::Time end_time) {}
   const std::shared_ptr<mediapipe::Clock> GetClock() const { return nullptr; }
 };
 
@@ -25,6 +25,7 @@
 #include "mediapipe/framework/port/status_matchers.h"
 #include "mediapipe/framework/port/statusor.h"
 #include "mediapipe/framework/profiler/test_context_builder.h"
+#include "mediapipe/framework/prometheus_text_sink.h"
 #include "mediapipe/framework/tool/simulation_clock.h"
 #include "mediapipe/framework/tool/tag_map_helper.h"
 
@@ -662,6 +663,87 @@ TEST_F(GraphProfilerTestPeer, SetOpenRuntime) {
   ASSERT_EQ(GetPacketsInfoMap()->size(), 0);
 }
 
+// Tests that SetOpenRuntime() records the start of Open() relative to the start
+// of the graph run.
+TEST_F(GraphProfilerTestPeer, SetOpenRuntimeRecordsOpenStartTime) {
+  InitializeProfilerWithGraphConfig(R"(
+    profiler_config {
+      enable_profiler: true
+    }
+    input_stream: "input_stream"
+    node {
+      calculator: "DummyTestCalculator"
+      input_stream: "input_stream"
+      output_stream: "output_stream"
+    })");
+  std::shared_ptr<mediapipe::SimulationClock> simulation_clock(
+      new SimulationClock());
+  simulation_clock->ThreadStart();
+  profiler_.SetClock(simulation_clock);
+  MP_ASSERT_OK(profiler_.Start(nullptr));
+  simulation_clock->Sleep(absl::Microseconds(50));
+
+  TestContextBuilder context(kDummyTestCalculatorName, /*node_id=*/0,
+                             {"input_stream"}, {"output_stream"});
+  {
+    GraphProfiler::Scope profiler_scope(GraphTrace::OPEN, context.get(),
+                                        &profiler_);
+    simulation_clock->Sleep(absl::Microseconds(100));
+  }
+
+  std::vector<CalculatorProfile> profiles = Profiles();
+  simulation_clock->ThreadFinish();
+
+  ASSERT_EQ(profiles.size(), 1);
+  EXPECT_THAT(profiles[0], Partially(EqualsProto(R"pb(
+                name: "DummyTestCalculator"
+                open_runtime: 100
+                open_start_time: 50
+              )pb")));
+}
+
+// Tests that a WARMUP scope within Open() records |warmup_runtime| as a part of
+// |open_runtime|.
+TEST_F(GraphProfilerTestPeer, SetWarmupRuntime) {
+  InitializeProfilerWithGraphConfig(R"(
+    profiler_config {
+      enable_profiler: true
+    }
+    input_stream: "input_stream"
+    node {
+      calculator: "DummyTestCalculator"
+      input_stream: "input_stream"
+      output_stream: "output_stream"
+    })");
+  std::shared_ptr<mediapipe::SimulationClock> simulation_clock(
+      new SimulationClock());
+  simulation_clock->ThreadStart();
+  profiler_.SetClock(simulation_clock);
+
+  TestContextBuilder context(kDummyTestCalculatorName, /*node_id=*/0,
+                             {"input_stream"}, {"output_stream"});
+  {
+    GraphProfiler::Scope open_scope(GraphTrace::OPEN, context.get(),
+                                    &profiler_);
+    simulation_clock->Sleep(absl::Microseconds(20));
+    {
+      GraphProfiler::Scope warmup_scope(GraphTrace::WARMUP, context.get(),
+                                        &profiler_);
+      simulation_clock->Sleep(absl::Microseconds(80));
+    }
+  }
+
+  std::vector<CalculatorProfile> profiles = Profiles();
+  simulation_clock->ThreadFinish();
+
+  ASSERT_EQ(profiles.size(), 1);
+  EXPECT_THAT(profiles[0], Partially(EqualsProto(R"pb(
+                name: "DummyTestCalculator"
+                open_runtime: 100
+                warmup_runtime: 80
+              )pb")));
+}
+
 // Tests that SetOpenRuntime() updates |open_runtime| and also updates the
 // packet info map when stream latency is enabled and the calculator produces
 // output packet in Open().
@@ -1132,6 +1214,99 @@ TEST_F(GraphProfilerTestPeer, AddProcessSampleWithStreamLatency) {
   ASSERT_NE(GetPacketInfo(GetPacketsInfoMap(), {"stream_1", 100}), nullptr);
 }
 
+// Tests that AddDroppedInputSet() counts the dropped input sets without
+// recording a Process() sample.
+TEST_F(GraphProfilerTestPeer, AddDroppedInputSet) {
+  InitializeProfilerWithGraphConfig(R"(
+    profiler_config {
+      enable_profiler: true
+    }
+    input_stream: "input_stream"
+    node {
+      calculator: "DummyTestCalculator"
+      input_stream: "input_stream"
+      output_stream: "output_stream"
+    })");
+  TestContextBuilder context(kDummyTestCalculatorName, /*node_id=*/0,
+                             {"input_stream"}, {"output_stream"});
+  context.AddInputs({MakePacket<std::string>("5").At(Timestamp(100))});
+
+  profiler_.AddDroppedInputSet(*context.get());
+  profiler_.AddDroppedInputSet(*context.get());
+
+  std::vector<CalculatorProfile> profiles = Profiles();
+  ASSERT_EQ(profiles.size(), 1);
+  EXPECT_EQ(profiles[0].num_dropped_input_sets(), 2);
+  EXPECT_EQ(profiles[0].process_runtime().total(), 0);
+}
+
+// Tests that AddDroppedPackets() counts the dropped packets of each input
+// stream.
+TEST_F(GraphProfilerTestPeer, AddDroppedPackets) {
+  InitializeProfilerWithGraphConfig(R"(
+    profiler_config {
+      enable_profiler: true
+    }
+    input_stream: "input_stream_1"
+    input_stream: "input_stream_2"
+    node {
+      calculator: "DummyTestCalculator"
+      input_stream: "input_stream_1"
+      input_stream: "input_stream_2"
+      output_stream: "output_stream"
+    })");
+  TestContextBuilder context(kDummyTestCalculatorName, /*node_id=*/0,
+                             {"input_stream_1", "input_stream_2"},
+                             {"output_stream"});
+
+  profiler_.AddDroppedPackets(*context.get(), /*stream_index=*/1, 3);
+  profiler_.AddDroppedPackets(*context.get(), /*stream_index=*/1, 2);
+
+  std::vector<CalculatorProfile> profiles = Profiles();
+  ASSERT_EQ(profiles.size(), 1);
+  ASSERT_EQ(profiles[0].input_stream_profiles_size(), 2);
+  EXPECT_EQ(profiles[0].input_stream_profiles(0).num_dropped_packets(), 0);
+  EXPECT_EQ(profiles[0].input_stream_profiles(1).num_dropped_packets(), 5);
+}
+
+// Tests that AddGpuTaskSample() records the GPU queue time and runtime of a
+// node, and that nodes without GPU work get no GPU histograms.
+TEST_F(GraphProfilerTestPeer, AddGpuTaskSample) {
+  InitializeProfilerWithGraphConfig(R"(
+    profiler_config {
+      enable_profiler: true
+    }
+    input_stream: "input_stream"
+    node {
+      calculator: "DummyTestCalculator"
+      input_stream: "input_stream"
+      output_stream: "middle_stream"
+    }
+    node {
+      calculator: "DummyTestCalculator"
+      input_stream: "middle_stream"
+      output_stream: "output_stream"
+    })");
+  absl::Time submit_time = absl::FromUnixMicros(1000);
+  profiler_.AddGpuTaskSample(/*node_id=*/1, Timestamp(100), submit_time,
+                             submit_time + absl::Microseconds(300),
+                             submit_time + absl::Microseconds(800));
+  profiler_.AddGpuTaskSample(/*node_id=*/1, Timestamp(200), submit_time,
+                             submit_time + absl::Microseconds(100),
+                             submit_time + absl::Microseconds(200));
+
+  std::vector<CalculatorProfile> profiles = Profiles();
+  ASSERT_EQ(profiles.size(), 2);
+  const CalculatorProfile& gpu_profile =
+      profiles[0].has_gpu_runtime() ? profiles[0] : profiles[1];
+  const CalculatorProfile& cpu_profile =
+      profiles[0].has_gpu_runtime() ? profiles[1] : profiles[0];
+  EXPECT_EQ(gpu_profile.gpu_queue_time().total(), 400);
+  EXPECT_EQ(gpu_profile.gpu_runtime().total(), 600);
+  EXPECT_FALSE(cpu_profile.has_gpu_queue_time());
+  EXPECT_FALSE(cpu_profile.has_gpu_runtime());
+}
+
 // This test shows that CalculatorGraph::GetCalculatorProfiles and
 // GraphProfiler::AddProcessSample() can be called in parallel.
 // Without the GraphProfiler::profiler_mutex_ this test should
@@ -1311,5 +1486,113 @@ TEST(GraphProfilerTest, CaptureProfilePopulateConfig) {
                   )pb"))));
 }
 
+TEST(GraphProfilerTest, CaptureProfileReportsQueuedBytes) {
+  CalculatorGraphConfig config;
+  QCHECK(proto2::TextFormat::ParseFromString(R"(
+    profiler_config {
+      enable_profiler: true
+      enable_queued_bytes: true
+    }
+    input_stream: "input"
+    node {
+      calculator: "PassThroughCalculator"
+      input_stream: "input"
+      output_stream: "output"
+    }
+    )",
+                                             &config));
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < 3; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "input", MakePacket<std::string>("abcd").At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  GraphProfile profile;
+  MP_ASSERT_OK(graph.profiler()->CaptureProfile(&profile));
+  ASSERT_EQ(profile.input_queue_profiles_size(), 1);
+  const InputQueueProfile& queue_profile = profile.input_queue_profiles(0);
+  EXPECT_EQ(queue_profile.name(), "input");
+  EXPECT_EQ(queue_profile.queued_bytes(), 0);
+  EXPECT_GE(queue_profile.peak_queued_bytes(), 4);
+  EXPECT_LE(queue_profile.peak_queued_bytes(), 12);
+  ASSERT_EQ(profile.calculator_profiles_size(), 1);
+  EXPECT_EQ(profile.calculator_profiles(0).queued_bytes(), 0);
+  EXPECT_EQ(profile.calculator_profiles(0).peak_queued_bytes(),
+            queue_profile.peak_queued_bytes());
+}
+
+TEST(GraphProfilerTest, SamplingModePublishesPercentiles) {
+  CalculatorGraphConfig config;
+  QCHECK(proto2::TextFormat::ParseFromString(R"(
+    profiler_config {
+      enable_profiler: true
+      process_sample_rate: 10
+    }
+    input_stream: "input"
+    node {
+      calculator: "PassThroughCalculator"
+      input_stream: "input"
+      output_stream: "output"
+    }
+    )",
+                                             &config));
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < 100; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "input", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  std::vector<CalculatorProfile> profiles;
+  MP_ASSERT_OK(graph.profiler()->GetCalculatorProfiles(&profiles));
+  ASSERT_EQ(profiles.size(), 1);
+  // The final partial interval is published when the run ends.
+  EXPECT_EQ(profiles[0].sampled_process_runtime().num_samples(), 10);
+  EXPECT_EQ(profiles[0].process_runtime().total(), 0);
+}
+
+TEST(GraphProfilerTest, ExportMetricsReportsNodesAndQueues) {
+  CalculatorGraphConfig config;
+  QCHECK(proto2::TextFormat::ParseFromString(R"(
+    profiler_config { enable_profiler: true }
+    input_stream: "input"
+    node {
+      calculator: "PassThroughCalculator"
+      input_stream: "input"
+      output_stream: "output"
+    }
+    )",
+                                             &config));
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < 3; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "input", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  PrometheusTextSink sink;
+  MP_ASSERT_OK(graph.ExportMetrics(&sink));
+  const std::string text = sink.Text();
+  EXPECT_THAT(text, testing::HasSubstr("# TYPE mediapipe_node_process_seconds "
+                                       "histogram\n"));
+  EXPECT_THAT(text, testing::HasSubstr(
+                        "mediapipe_node_process_seconds_count{node=\""
+                        "PassThroughCalculator\"} 3\n"));
+  EXPECT_THAT(text, testing::HasSubstr(
+                        "mediapipe_input_queue_size{node=\""
+                        "PassThroughCalculator\",stream=\"input\"} 0\n"));
+  EXPECT_THAT(text, testing::HasSubstr("mediapipe_packet_pool_blocks_total"));
+}
+
 }  // namespace
 }  // namespace mediapipe
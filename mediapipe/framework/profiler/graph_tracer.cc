@@ -14,6 +14,12 @@
 
 #include "mediapipe/framework/profiler/graph_tracer.h"
 
+#include <atomic>
+#include <functional>
+#include <queue>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "mediapipe/framework/calculator_context.h"
@@ -37,6 +43,8 @@ inline int GetCurrentThreadId() {
   return thread_id;
 }
 
+std::atomic<uint64> next_tracer_id{0};
+
 }  // namespace
 
 absl::Duration GraphTracer::GetTraceLogInterval() {
@@ -52,7 +60,7 @@ int64 GraphTracer::GetTraceLogCapacity() {
 }
 
 GraphTracer::GraphTracer(const ProfilerConfig& profiler_config)
-    : profiler_config_(profiler_config), trace_buffer_(GetTraceLogCapacity()) {
+    : profiler_config_(profiler_config), id_(next_tracer_id.fetch_add(1)) {
   for (int disabled : profiler_config_.trace_event_types_disabled()) {
     EventType event_type = static_cast<EventType>(disabled);
     (*trace_event_registry())[event_type].set_enabled(false);
@@ -68,7 +76,33 @@ void GraphTracer::LogEvent(TraceEvent event) {
     return;
   }
   event.set_thread_id(GetCurrentThreadId());
-  trace_buffer_.push_back(event);
+  GetThreadBuffer()->push_back(event);
+}
+
+TraceBuffer* GraphTracer::GetThreadBuffer() {
+  // The buffers of the calling thread, by tracer id.  A buffer is shared with
+  // its tracer, and is released by the thread after the tracer is gone.
+  thread_local absl::flat_hash_map<uint64, std::shared_ptr<TraceBuffer>>
+      thread_buffers;
+  auto it = thread_buffers.find(id_);
+  if (it != thread_buffers.end()) {
+    return it->second.get();
+  }
+  // Forget the buffers of destroyed tracers.
+  for (auto iter = thread_buffers.begin(); iter != thread_buffers.end();) {
+    if (iter->second.use_count() == 1) {
+      thread_buffers.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+  auto buffer = std::make_shared<TraceBuffer>(GetTraceLogCapacity());
+  {
+    absl::MutexLock lock(&buffers_mutex_);
+    buffers_.push_back(buffer);
+  }
+  thread_buffers[id_] = buffer;
+  return buffer.get();
 }
 
 void GraphTracer::LogInputEvents(GraphTrace::EventType event_type,
@@ -114,7 +148,52 @@ void GraphTracer::LogOutputEvents(GraphTrace::EventType event_type,
 }
 
 Timestamp GraphTracer::TimestampAfter(absl::Time begin_time) {
-  return TraceBuilder::TimestampAfter(trace_buffer_, begin_time);
+  return TraceBuilder::TimestampAfter(
+      GetTraceEvents(absl::InfinitePast(), begin_time), begin_time);
+}
+
+std::vector<TraceEvent> GraphTracer::GetTraceEvents(absl::Time begin_time,
+                                                    absl::Time end_time) {
+  std::vector<std::shared_ptr<TraceBuffer>> buffers;
+  {
+    absl::MutexLock lock(&buffers_mutex_);
+    buffers = buffers_;
+  }
+
+  // Snapshot the recent TraceEvents of each thread.
+  std::vector<std::vector<TraceEvent>> thread_events(buffers.size());
+  size_t num_events = 0;
+  for (int i = 0; i < buffers.size(); ++i) {
+    TraceBuffer::iterator buffer_end = buffers[i]->end();
+    for (auto iter = buffers[i]->begin(); iter < buffer_end; ++iter) {
+      TraceEvent event = *iter;
+      if (event.event_time >= begin_time && event.event_time < end_time) {
+        thread_events[i].push_back(event);
+      }
+    }
+    num_events += thread_events[i].size();
+  }
+
+  // Merge the threads by the time of their next event.
+  using Head = std::pair<absl::Time, int>;
+  std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+  std::vector<size_t> next(thread_events.size(), 0);
+  for (int i = 0; i < thread_events.size(); ++i) {
+    if (!thread_events[i].empty()) {
+      heads.push({thread_events[i][0].event_time, i});
+    }
+  }
+  std::vector<TraceEvent> result;
+  result.reserve(num_events);
+  while (!heads.empty()) {
+    const int i = heads.top().second;
+    heads.pop();
+    result.push_back(thread_events[i][next[i]++]);
+    if (next[i] < thread_events[i].size()) {
+      heads.push({thread_events[i][next[i]].event_time, i});
+    }
+  }
+  return result;
 }
 
 // The mutex to guard GraphTracer::trace_builder_.
@@ -126,19 +205,17 @@ absl::Mutex* trace_builder_mutex() {
 void GraphTracer::GetTrace(absl::Time begin_time, absl::Time end_time,
                            GraphTrace* result) {
   absl::MutexLock lock(trace_builder_mutex());
-  trace_builder_.CreateTrace(trace_buffer_, begin_time, end_time, result);
+  trace_builder_.CreateTrace(GetTraceEvents(begin_time, end_time), result);
   trace_builder_.Clear();
 }
 
 void GraphTracer::GetLog(absl::Time begin_time, absl::Time end_time,
                          GraphTrace* result) {
   absl::MutexLock lock(trace_builder_mutex());
-  trace_builder_.CreateLog(trace_buffer_, begin_time, end_time, result);
+  trace_builder_.CreateLog(GetTraceEvents(begin_time, end_time), result);
   trace_builder_.Clear();
 }
 
-const TraceBuffer& GraphTracer::GetTraceBuffer() { return trace_buffer_; }
-
 Timestamp GraphTracer::GetOutputTimestamp(const CalculatorContext* context) {
   for (const OutputStreamShard& out_stream : context->Outputs()) {
     for (const Packet& packet : *out_stream.OutputQueue()) {
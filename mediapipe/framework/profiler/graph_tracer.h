@@ -15,8 +15,12 @@
 #ifndef MEDIAPIPE_FRAMEWORK_PROFILER_GRAPH_TRACER_H_
 #define MEDIAPIPE_FRAMEWORK_PROFILER_GRAPH_TRACER_H_
 
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/calculator_profile.pb.h"
@@ -30,6 +34,9 @@ namespace mediapipe {
 //
 // GraphTracer is thread-safe, and the Log* methods are also non-blocking
 // so they can be called during graph execution with mimimal overhead.
+// Each thread appends its events to its own TraceBuffer, so threads do not
+// contend while logging.  The buffers are merged by event time only when
+// the events are read.
 //
 // The method GetTrace returns the events for a range of recent Timestamps.
 // The begin_ts should be the first timestamp completely enclosed in the
@@ -49,7 +56,8 @@ class GraphTracer {
   // Returns the interval between trace log output.
   absl::Duration GetTraceLogInterval();
 
-  // Returns the maximum number of trace events buffered in memory.
+  // Returns the maximum number of trace events buffered in memory for each
+  // logging thread.
   int64 GetTraceLogCapacity();
 
   // Create a tracer to record up to |capacity| recent events.
@@ -78,18 +86,28 @@ class GraphTracer {
   // Returns trace events between begin_time and end_time exclusive.
   void GetLog(absl::Time begin_time, absl::Time end_time, GraphTrace* result);
 
-  // Returns the logged TraceEvents.
-  const TraceBuffer& GetTraceBuffer();
+  // Returns the logged TraceEvents between begin_time and end_time exclusive,
+  // ordered by event time.  The events of each thread keep their order.
+  std::vector<TraceEvent> GetTraceEvents(absl::Time begin_time,
+                                         absl::Time end_time);
 
  private:
+  // Returns the TraceBuffer of the calling thread.
+  TraceBuffer* GetThreadBuffer();
+
   // Returns the timestamp of the first output packet.
   Timestamp GetOutputTimestamp(const CalculatorContext* context);
 
   // The settings for this tracer.
   ProfilerConfig profiler_config_;
 
-  // The circular buffer of TraceEvents.
-  TraceBuffer trace_buffer_;
+  // Identifies this tracer in the buffers of each thread.
+  const uint64 id_;
+
+  // The circular buffers of TraceEvents, one for each logging thread.
+  absl::Mutex buffers_mutex_;
+  std::vector<std::shared_ptr<TraceBuffer>> buffers_
+      ABSL_GUARDED_BY(buffers_mutex_);
 
   // The builder for the GraphTrace protobuf.
   TraceBuilder trace_builder_;
@@ -0,0 +1,70 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the throughput of GraphTracer::LogEvent as the number of logging
+// threads grows, next to a single TraceBuffer shared by all threads.
+
+#include <string>
+
+#include "absl/time/clock.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/profiler/graph_tracer.h"
+#include "mediapipe/framework/profiler/trace_buffer.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+namespace {
+
+const std::string* StreamName() {
+  static const std::string* stream_name = new std::string("stream");
+  return stream_name;
+}
+
+TraceEvent MakeEvent(int64 i) {
+  return TraceEvent(TraceEvent::PROCESS)
+      .set_event_time(absl::Now())
+      .set_node_id(1)
+      .set_stream_id(StreamName())
+      .set_input_ts(Timestamp(i))
+      .set_packet_ts(Timestamp(i));
+}
+
+void BM_GraphTracerLogEvent(benchmark::State& state) {
+  static GraphTracer* tracer = [] {
+    ProfilerConfig config;
+    config.set_trace_enabled(true);
+    return new GraphTracer(config);
+  }();
+  int64 i = 0;
+  for (auto _ : state) {
+    tracer->LogEvent(MakeEvent(i++));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_SharedTraceBufferPushBack(benchmark::State& state) {
+  static TraceBuffer* buffer = new TraceBuffer(20000);
+  int64 i = 0;
+  for (auto _ : state) {
+    buffer->push_back(MakeEvent(i++));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_GraphTracerLogEvent)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(BM_SharedTraceBufferPushBack)->ThreadRange(1, 16)->UseRealTime();
+
+}  // namespace
+}  // namespace mediapipe
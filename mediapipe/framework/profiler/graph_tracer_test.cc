@@ -18,6 +18,7 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
 
@@ -328,6 +329,43 @@ TEST_F(GraphTracerTest, GraphTrace) {
   EXPECT_EQ(4, trace.calculator_trace().size());
 }
 
+TEST_F(GraphTracerTest, MergesEventsFromAllThreads) {
+  SetUpGraphTracer();
+  const std::string stream_name = "stream";
+  constexpr int kNumThreads = 4;
+  constexpr int kNumEvents = 100;
+  // Each thread logs every kNumThreads-th microsecond.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([this, t, &stream_name] {
+      for (int i = 0; i < kNumEvents; ++i) {
+        tracer_->LogEvent(
+            TraceEvent(GraphTrace::PROCESS)
+                .set_event_time(start_time_ +
+                                absl::Microseconds(i * kNumThreads + t))
+                .set_node_id(t)
+                .set_stream_id(&stream_name)
+                .set_input_ts(Timestamp(i)));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<TraceEvent> events = tracer_->GetTraceEvents(
+      absl::InfinitePast(), absl::InfiniteFuture());
+  ASSERT_EQ(events.size(), kNumThreads * kNumEvents);
+  for (int i = 0; i < events.size(); ++i) {
+    EXPECT_EQ(events[i].event_time, start_time_ + absl::Microseconds(i));
+    EXPECT_EQ(events[i].node_id, i % kNumThreads);
+  }
+  EXPECT_EQ(tracer_->GetTraceEvents(start_time_ + absl::Microseconds(8),
+                                    start_time_ + absl::Microseconds(12))
+                .size(),
+            4);
+}
+
 // Tests showing GraphTracer logging packet latencies.
 class GraphTracerE2ETest : public ::testing::Test {
  protected:
@@ -0,0 +1,169 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/process_sampler.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+namespace {
+
+// The number of samples each thread can buffer between publications.
+constexpr size_t kThreadBufferCapacity = 4096;
+
+// The maximum number of samples kept for a node between publications.
+constexpr size_t kMaxWindowSamples = 1 << 16;
+
+// The default interval between publications.
+constexpr int64 kDefaultPublishIntervalUsec = 10000000;
+
+std::atomic<uint64> next_sampler_id{0};
+
+// Returns the sample at quantile "q" of the sorted "samples".
+int64 Percentile(const std::vector<int64>& samples, double q) {
+  const size_t index = static_cast<size_t>(q * (samples.size() - 1) + 0.5);
+  return samples[std::min(index, samples.size() - 1)];
+}
+
+}  // namespace
+
+ProcessSampler::ProcessSampler(std::vector<std::string> node_names,
+                               int sample_rate, int64 publish_interval_usec)
+    : id_(next_sampler_id.fetch_add(1)),
+      num_nodes_(node_names.size()),
+      sample_rate_(std::max(sample_rate, 1)),
+      publish_interval_usec_(publish_interval_usec > 0
+                                 ? publish_interval_usec
+                                 : kDefaultPublishIntervalUsec),
+      node_counters_(new NodeCounter[node_names.size()]),
+      window_samples_(node_names.size()),
+      published_(node_names.size()) {
+  for (int i = 0; i < num_nodes_; ++i) {
+    node_ids_[node_names[i]] = i;
+  }
+}
+
+ProcessSampler::ThreadBuffer* ProcessSampler::GetThreadBuffer() {
+  // The buffers of the calling thread, by sampler id. A buffer is shared with
+  // its sampler, and is released by the thread after the sampler is gone.
+  thread_local absl::flat_hash_map<uint64, std::shared_ptr<ThreadBuffer>>
+      thread_buffers;
+  auto it = thread_buffers.find(id_);
+  if (it != thread_buffers.end()) {
+    return it->second.get();
+  }
+  // Forget the buffers of destroyed samplers.
+  for (auto iter = thread_buffers.begin(); iter != thread_buffers.end();) {
+    if (iter->second.use_count() == 1) {
+      thread_buffers.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+  auto buffer = std::make_shared<ThreadBuffer>(kThreadBufferCapacity);
+  {
+    absl::MutexLock lock(&buffers_mutex_);
+    buffers_.push_back(buffer);
+  }
+  thread_buffers[id_] = buffer;
+  return buffer.get();
+}
+
+void ProcessSampler::AddSample(int node_id, int64 runtime_usec,
+                               int64 now_usec) {
+  ThreadBuffer* buffer = GetThreadBuffer();
+  if (!buffer->samples.TryPush(Sample{node_id, runtime_usec})) {
+    buffer->num_dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+  int64 next_publish_usec = next_publish_usec_.load(std::memory_order_relaxed);
+  if (now_usec >= next_publish_usec &&
+      next_publish_usec_.compare_exchange_strong(
+          next_publish_usec, now_usec + publish_interval_usec_)) {
+    Publish(now_usec);
+  }
+}
+
+void ProcessSampler::DrainBuffers() {
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  {
+    absl::MutexLock lock(&buffers_mutex_);
+    buffers = buffers_;
+  }
+  int64 num_dropped = 0;
+  for (const auto& buffer : buffers) {
+    Sample sample;
+    while (buffer->samples.TryPop(&sample)) {
+      std::vector<int64>& samples = window_samples_[sample.node_id];
+      if (samples.size() < kMaxWindowSamples) {
+        samples.push_back(sample.runtime_usec);
+      } else {
+        ++num_dropped;
+      }
+    }
+    num_dropped += buffer->num_dropped.exchange(0);
+  }
+  LOG_IF(WARNING, num_dropped > 0)
+      << "The sampling profiler dropped " << num_dropped
+      << " Process() samples; consider a larger process_sample_rate or a "
+         "shorter sample_publish_interval_usec.";
+}
+
+void ProcessSampler::Publish(int64 now_usec) {
+  absl::MutexLock lock(&publish_mutex_);
+  DrainBuffers();
+  for (int node_id = 0; node_id < num_nodes_; ++node_id) {
+    std::vector<int64>& samples = window_samples_[node_id];
+    if (samples.empty()) {
+      continue;
+    }
+    std::sort(samples.begin(), samples.end());
+    SampledRuntime& published = published_[node_id];
+    published.set_num_samples(samples.size());
+    published.set_p50_usec(Percentile(samples, 0.5));
+    published.set_p90_usec(Percentile(samples, 0.9));
+    published.set_p99_usec(Percentile(samples, 0.99));
+    published.set_max_usec(samples.back());
+    published.set_publish_time_usec(now_usec);
+    samples.clear();
+  }
+}
+
+void ProcessSampler::Reset(int64 now_usec) {
+  absl::MutexLock lock(&publish_mutex_);
+  DrainBuffers();
+  for (int node_id = 0; node_id < num_nodes_; ++node_id) {
+    node_counters_[node_id].count = 0;
+    window_samples_[node_id].clear();
+    published_[node_id].Clear();
+  }
+  next_publish_usec_ = now_usec + publish_interval_usec_;
+}
+
+void ProcessSampler::GetPublished(CalculatorProfile* profile) const {
+  auto it = node_ids_.find(profile->name());
+  if (it == node_ids_.end()) {
+    return;
+  }
+  absl::MutexLock lock(&publish_mutex_);
+  const SampledRuntime& published = published_[it->second];
+  if (published.num_samples() > 0) {
+    *profile->mutable_sampled_process_runtime() = published;
+  }
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,126 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_PROCESS_SAMPLER_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_PROCESS_SAMPLER_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/deps/spsc_queue.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// Records the runtime of one in every "sample_rate" Process() calls of each
+// calculator, for the sampling mode of GraphProfiler. See
+// ProfilerConfig::process_sample_rate.
+//
+// Each thread appends its samples to a buffer of its own without locking.
+// Once per publish interval, the thread that records a sample drains the
+// buffers and publishes the percentiles of the runtimes sampled since the
+// previous publication.
+// This class is thread-safe.
+class ProcessSampler {
+ public:
+  ProcessSampler(std::vector<std::string> node_names, int sample_rate,
+                 int64 publish_interval_usec);
+
+  ProcessSampler(const ProcessSampler&) = delete;
+  ProcessSampler& operator=(const ProcessSampler&) = delete;
+
+  // Returns true if the current Process() call of node "node_id" is sampled.
+  bool ShouldSample(int node_id) {
+    if (node_id < 0 || node_id >= num_nodes_) return false;
+    return node_counters_[node_id].count.fetch_add(
+               1, std::memory_order_relaxed) %
+               sample_rate_ ==
+           0;
+  }
+
+  // Records the runtime of a sampled Process() call that finished at
+  // "now_usec", and publishes the percentiles if the publish interval has
+  // elapsed.
+  void AddSample(int node_id, int64 runtime_usec, int64 now_usec);
+
+  // Publishes the percentiles of the samples recorded since the previous
+  // publication.
+  void Publish(int64 now_usec) ABSL_LOCKS_EXCLUDED(publish_mutex_);
+
+  // Discards all samples and published percentiles, and starts a new
+  // publish interval at "now_usec".
+  void Reset(int64 now_usec) ABSL_LOCKS_EXCLUDED(publish_mutex_);
+
+  // Sets CalculatorProfile::sampled_process_runtime to the percentiles last
+  // published for the calculator named in "profile", if any.
+  void GetPublished(CalculatorProfile* profile) const
+      ABSL_LOCKS_EXCLUDED(publish_mutex_);
+
+ private:
+  struct Sample {
+    int node_id;
+    int64 runtime_usec;
+  };
+
+  // The samples of one thread. Only that thread pushes samples, and only the
+  // publishing thread pops them.
+  struct ThreadBuffer {
+    explicit ThreadBuffer(size_t capacity) : samples(capacity) {}
+    SpscQueue<Sample> samples;
+    // The number of samples lost because the buffer was full.
+    std::atomic<int64> num_dropped{0};
+  };
+
+  // Keeps the call counters of different nodes on different cache lines.
+  struct alignas(64) NodeCounter {
+    std::atomic<uint32> count{0};
+  };
+
+  // Returns the buffer of the calling thread, creating it if needed.
+  ThreadBuffer* GetThreadBuffer();
+
+  // Moves the samples of all threads into window_samples_.
+  void DrainBuffers() ABSL_EXCLUSIVE_LOCKS_REQUIRED(publish_mutex_);
+
+  // Identifies this sampler in the thread-local buffer maps.
+  const uint64 id_;
+  const int num_nodes_;
+  const uint32 sample_rate_;
+  const int64 publish_interval_usec_;
+  std::unique_ptr<NodeCounter[]> node_counters_;
+  std::atomic<int64> next_publish_usec_{0};
+
+  mutable absl::Mutex buffers_mutex_;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers_
+      ABSL_GUARDED_BY(buffers_mutex_);
+
+  mutable absl::Mutex publish_mutex_;
+  // The samples since the previous publication, for each node.
+  std::vector<std::vector<int64>> window_samples_
+      ABSL_GUARDED_BY(publish_mutex_);
+  // The index of each node name.
+  absl::flat_hash_map<std::string, int> node_ids_;
+  // The percentiles last published for each node.
+  std::vector<SampledRuntime> published_ ABSL_GUARDED_BY(publish_mutex_);
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_PROCESS_SAMPLER_H_
@@ -0,0 +1,96 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/process_sampler.h"
+
+#include <string>
+
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+namespace {
+
+CalculatorProfile GetPublished(const ProcessSampler& sampler,
+                               const std::string& name) {
+  CalculatorProfile profile;
+  profile.set_name(name);
+  sampler.GetPublished(&profile);
+  return profile;
+}
+
+TEST(ProcessSamplerTest, SamplesOneInN) {
+  ProcessSampler sampler({"a", "b"}, 4, 1000);
+  int num_sampled = 0;
+  for (int i = 0; i < 20; ++i) {
+    num_sampled += sampler.ShouldSample(0);
+  }
+  EXPECT_EQ(num_sampled, 5);
+  // Each node counts its own calls.
+  EXPECT_TRUE(sampler.ShouldSample(1));
+  EXPECT_FALSE(sampler.ShouldSample(2));
+}
+
+TEST(ProcessSamplerTest, PublishesPercentilesPerInterval) {
+  ProcessSampler sampler({"a", "b"}, 1, 1000);
+  sampler.Reset(0);
+  for (int i = 1; i <= 100; ++i) {
+    sampler.AddSample(0, i, 500);
+  }
+  // Nothing is published before the interval has elapsed.
+  EXPECT_FALSE(GetPublished(sampler, "a").has_sampled_process_runtime());
+
+  sampler.AddSample(0, 1000, 1000);
+  const SampledRuntime runtime =
+      GetPublished(sampler, "a").sampled_process_runtime();
+  EXPECT_EQ(runtime.num_samples(), 101);
+  EXPECT_EQ(runtime.p50_usec(), 51);
+  EXPECT_EQ(runtime.p90_usec(), 91);
+  EXPECT_EQ(runtime.p99_usec(), 100);
+  EXPECT_EQ(runtime.max_usec(), 1000);
+  EXPECT_EQ(runtime.publish_time_usec(), 1000);
+  EXPECT_FALSE(GetPublished(sampler, "b").has_sampled_process_runtime());
+
+  // The next interval only covers the new samples.
+  sampler.AddSample(0, 7, 1500);
+  sampler.Publish(1600);
+  EXPECT_EQ(GetPublished(sampler, "a").sampled_process_runtime().num_samples(),
+            1);
+
+  sampler.Reset(2000);
+  EXPECT_FALSE(GetPublished(sampler, "a").has_sampled_process_runtime());
+}
+
+TEST(ProcessSamplerTest, CollectsSamplesFromAllThreads) {
+  ProcessSampler sampler({"a"}, 1, 1000000);
+  sampler.Reset(0);
+  {
+    ThreadPool pool(4);
+    pool.StartWorkers();
+    for (int t = 0; t < 4; ++t) {
+      pool.Schedule([&sampler] {
+        for (int i = 0; i < 100; ++i) {
+          sampler.AddSample(0, 10, 0);
+        }
+      });
+    }
+  }
+  sampler.Publish(0);
+  EXPECT_EQ(GetPublished(sampler, "a").sampled_process_runtime().num_samples(),
+            400);
+}
+
+}  // namespace
+}  // namespace mediapipe
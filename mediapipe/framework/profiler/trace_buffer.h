@@ -109,6 +109,9 @@ struct TraceEvent {
   static constexpr EventType TPU_TASK = GraphTrace::TPU_TASK;
   static constexpr EventType GPU_CALIBRATION = GraphTrace::GPU_CALIBRATION;
   static constexpr EventType PACKET_QUEUED = GraphTrace::PACKET_QUEUED;
+  static constexpr EventType GPU_FINISH = GraphTrace::GPU_FINISH;
+  static constexpr EventType GPU_QUEUED = GraphTrace::GPU_QUEUED;
+  static constexpr EventType WARMUP = GraphTrace::WARMUP;
 };
 
 // Packet trace log buffer.
@@ -84,6 +84,12 @@ void BasicTraceEventTypes(TraceEventRegistry* result) {
        "A time measured by GPU clock and by CPU clock.", true, false},
       {TraceEvent::PACKET_QUEUED, "An input queue size when a packet arrives.",
        true, true, false},
+      {TraceEvent::GPU_FINISH, "A glFinish call draining a GL context.", false,
+       false, false},
+      {TraceEvent::GPU_QUEUED, "GPU work waiting to start on the device.", true,
+       false},
+      {TraceEvent::WARMUP, "Warm-up runs of a model during Open.", false,
+       false},
   };
   for (const TraceEventType& t : basic_types) {
     (*result)[t.event_type()] = t;
@@ -181,9 +187,20 @@ class TraceBuilder::Impl {
     return max_ts + 1;
   }
 
-  void CreateTrace(const TraceBuffer& buffer, absl::Time begin_time,
-                   absl::Time end_time, GraphTrace* result) {
-    // Snapshot recent TraceEvents
+  static Timestamp TimestampAfter(const std::vector<TraceEvent>& events,
+                                  absl::Time begin_time) {
+    Timestamp max_ts = Timestamp::Min();
+    for (const TraceEvent& event : events) {
+      if (event.event_time >= begin_time) break;
+      max_ts = std::max(max_ts, event.input_ts);
+    }
+    return max_ts + 1;
+  }
+
+  // Snapshot recent TraceEvents
+  static std::vector<TraceEvent> Snapshot(const TraceBuffer& buffer,
+                                          absl::Time begin_time,
+                                          absl::Time end_time) {
     std::vector<TraceEvent> snapshot;
     snapshot.reserve(10000);
     TraceBuffer::iterator buffer_end = buffer.end();
@@ -193,6 +210,16 @@ class TraceBuilder::Impl {
         snapshot.push_back(event);
       }
     }
+    return snapshot;
+  }
+
+  void CreateTrace(const TraceBuffer& buffer, absl::Time begin_time,
+                   absl::Time end_time, GraphTrace* result) {
+    CreateTrace(Snapshot(buffer, begin_time, end_time), result);
+  }
+
+  void CreateTrace(const std::vector<TraceEvent>& snapshot,
+                   GraphTrace* result) {
     SetBaseTime(snapshot);
 
     // Index TraceEvents by task-id and stream-hop-id.
@@ -234,16 +261,10 @@ class TraceBuilder::Impl {
 
   void CreateLog(const TraceBuffer& buffer, absl::Time begin_time,
                  absl::Time end_time, GraphTrace* result) {
-    // Snapshot recent TraceEvents
-    std::vector<TraceEvent> snapshot;
-    snapshot.reserve(10000);
-    TraceBuffer::iterator buffer_end = buffer.end();
-    for (auto iter = buffer.begin(); iter < buffer_end; ++iter) {
-      TraceEvent event = *iter;
-      if (event.event_time >= begin_time && event.event_time < end_time) {
-        snapshot.push_back(event);
-      }
-    }
+    CreateLog(Snapshot(buffer, begin_time, end_time), result);
+  }
+
+  void CreateLog(const std::vector<TraceEvent>& snapshot, GraphTrace* result) {
     SetBaseTime(snapshot);
 
     // Log each TraceEvent.
@@ -404,14 +425,26 @@ Timestamp TraceBuilder::TimestampAfter(const TraceBuffer& buffer,
                                        absl::Time begin_time) {
   return Impl::TimestampAfter(buffer, begin_time);
 }
+Timestamp TraceBuilder::TimestampAfter(const std::vector<TraceEvent>& events,
+                                       absl::Time begin_time) {
+  return Impl::TimestampAfter(events, begin_time);
+}
 void TraceBuilder::CreateTrace(const TraceBuffer& buffer, absl::Time begin_time,
                                absl::Time end_time, GraphTrace* result) {
   impl_->CreateTrace(buffer, begin_time, end_time, result);
 }
+void TraceBuilder::CreateTrace(const std::vector<TraceEvent>& snapshot,
+                               GraphTrace* result) {
+  impl_->CreateTrace(snapshot, result);
+}
 void TraceBuilder::CreateLog(const TraceBuffer& buffer, absl::Time begin_time,
                              absl::Time end_time, GraphTrace* result) {
   impl_->CreateLog(buffer, begin_time, end_time, result);
 }
+void TraceBuilder::CreateLog(const std::vector<TraceEvent>& snapshot,
+                             GraphTrace* result) {
+  impl_->CreateLog(snapshot, result);
+}
 void TraceBuilder::Clear() { impl_->Clear(); }
 
 // Defined here since constexpr requires out-of-class definition until C++17.
@@ -431,6 +464,9 @@ const TraceEvent::EventType         //
     TraceEvent::DSP_TASK,           //
     TraceEvent::TPU_TASK,           //
     TraceEvent::GPU_CALIBRATION,    //
-    TraceEvent::PACKET_QUEUED;
+    TraceEvent::PACKET_QUEUED,      //
+    TraceEvent::GPU_FINISH,         //
+    TraceEvent::GPU_QUEUED,         //
+    TraceEvent::WARMUP;
 
 }  // namespace mediapipe
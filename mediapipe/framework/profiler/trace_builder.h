@@ -16,6 +16,7 @@
 #define MEDIAPIPE_FRAMEWORK_PROFILER_TRACE_BUILDER_H_
 
 #include <string>
+#include <vector>
 
 #include "mediapipe/framework/calculator_profile.pb.h"
 #include "mediapipe/framework/profiler/trace_buffer.h"
@@ -35,14 +36,24 @@ class TraceBuilder {
   static Timestamp TimestampAfter(const TraceBuffer& buffer,
                                   absl::Time begin_time);
 
+  // Returns the earliest packet timestamp appearing only after begin_time.
+  static Timestamp TimestampAfter(const std::vector<TraceEvent>& events,
+                                  absl::Time begin_time);
+
   // Returns the graph of traces between begin_time and end_time exclusive.
   void CreateTrace(const TraceBuffer& buffer, absl::Time begin_time,
                    absl::Time end_time, GraphTrace* result);
 
+  // Returns the graph of traces for a snapshot of TraceEvents.
+  void CreateTrace(const std::vector<TraceEvent>& snapshot, GraphTrace* result);
+
   // Returns trace events between begin_time and end_time exclusive.
   void CreateLog(const TraceBuffer& buffer, absl::Time begin_time,
                  absl::Time end_time, GraphTrace* result);
 
+  // Returns trace events for a snapshot of TraceEvents.
+  void CreateLog(const std::vector<TraceEvent>& snapshot, GraphTrace* result);
+
   // Resets the TraceBuilder to begin building a new trace.
   void Clear();
 
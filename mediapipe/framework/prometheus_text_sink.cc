@@ -0,0 +1,137 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/prometheus_text_sink.h"
+
+#include <cmath>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Formats a sample value, exactly for integers.
+std::string FormatValue(double value) {
+  if (std::isinf(value)) {
+    return value > 0 ? "+Inf" : "-Inf";
+  }
+  if (std::isnan(value)) {
+    return "NaN";
+  }
+  if (value == std::floor(value) && std::abs(value) < 9007199254740992.0) {
+    return absl::StrCat(static_cast<int64>(value));
+  }
+  return absl::StrFormat("%.17g", value);
+}
+
+// Escapes a label value or help text. Help text keeps its double quotes.
+std::string Escape(const std::string& text, bool escape_quotes) {
+  std::string result;
+  result.reserve(text.size());
+  for (char c : text) {
+    if (c == '\\') {
+      result += "\\\\";
+    } else if (c == '\n') {
+      result += "\\n";
+    } else if (c == '"' && escape_quotes) {
+      result += "\\\"";
+    } else {
+      result += c;
+    }
+  }
+  return result;
+}
+
+// Returns the label set of a sample, e.g. {node="a",le="10"}.
+std::string FormatLabels(const MetricsSink::Labels& labels,
+                         const std::string& le = "") {
+  if (labels.empty() && le.empty()) {
+    return "";
+  }
+  std::string result = "{";
+  for (const auto& [name, value] : labels) {
+    absl::StrAppend(&result, result.size() > 1 ? "," : "", name, "=\"",
+                    Escape(value, /*escape_quotes=*/true), "\"");
+  }
+  if (!le.empty()) {
+    absl::StrAppend(&result, result.size() > 1 ? "," : "", "le=\"", le, "\"");
+  }
+  result += "}";
+  return result;
+}
+
+}  // namespace
+
+PrometheusTextSink::Family* PrometheusTextSink::GetFamily(
+    const std::string& name, const std::string& help,
+    const std::string& type) {
+  auto [it, inserted] = family_index_.emplace(name, families_.size());
+  if (inserted) {
+    families_.push_back(Family{name, help, type, ""});
+  }
+  return &families_[it->second];
+}
+
+void PrometheusTextSink::AddCounter(const std::string& name,
+                                    const std::string& help,
+                                    const Labels& labels, double value) {
+  absl::StrAppend(&GetFamily(name, help, "counter")->samples, name,
+                  FormatLabels(labels), " ", FormatValue(value), "\n");
+}
+
+void PrometheusTextSink::AddGauge(const std::string& name,
+                                  const std::string& help,
+                                  const Labels& labels, double value) {
+  absl::StrAppend(&GetFamily(name, help, "gauge")->samples, name,
+                  FormatLabels(labels), " ", FormatValue(value), "\n");
+}
+
+void PrometheusTextSink::AddHistogram(const std::string& name,
+                                      const std::string& help,
+                                      const Labels& labels,
+                                      const std::vector<double>& upper_bounds,
+                                      const std::vector<int64>& bucket_counts,
+                                      double sum) {
+  std::string* samples = &GetFamily(name, help, "histogram")->samples;
+  for (int i = 0; i < bucket_counts.size(); ++i) {
+    const std::string le =
+        i < upper_bounds.size() ? FormatValue(upper_bounds[i]) : "+Inf";
+    absl::StrAppend(samples, name, "_bucket", FormatLabels(labels, le), " ",
+                    bucket_counts[i], "\n");
+  }
+  absl::StrAppend(samples, name, "_sum", FormatLabels(labels), " ",
+                  FormatValue(sum), "\n");
+  absl::StrAppend(samples, name, "_count", FormatLabels(labels), " ",
+                  bucket_counts.empty() ? 0 : bucket_counts.back(), "\n");
+}
+
+std::string PrometheusTextSink::Text() const {
+  std::string result;
+  for (const Family& family : families_) {
+    absl::StrAppend(&result, "# HELP ", family.name, " ",
+                    Escape(family.help, /*escape_quotes=*/false), "\n",
+                    "# TYPE ", family.name, " ", family.type, "\n",
+                    family.samples);
+  }
+  return result;
+}
+
+void PrometheusTextSink::Clear() {
+  families_.clear();
+  family_index_.clear();
+}
+
+}  // namespace mediapipe
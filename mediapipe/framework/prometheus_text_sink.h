@@ -0,0 +1,73 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROMETHEUS_TEXT_SINK_H_
+#define MEDIAPIPE_FRAMEWORK_PROMETHEUS_TEXT_SINK_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "mediapipe/framework/metrics_sink.h"
+
+namespace mediapipe {
+
+// A MetricsSink that formats the metrics in the Prometheus text exposition
+// format, which OpenMetrics scrapers also accept. A process serves Text() on
+// its metrics endpoint, e.g.:
+//
+//   PrometheusTextSink sink;
+//   MP_RETURN_IF_ERROR(graph.ExportMetrics(&sink));
+//   response->set_body(sink.Text());
+//
+// This class is not thread-safe.
+class PrometheusTextSink : public MetricsSink {
+ public:
+  void AddCounter(const std::string& name, const std::string& help,
+                  const Labels& labels, double value) override;
+  void AddGauge(const std::string& name, const std::string& help,
+                const Labels& labels, double value) override;
+  void AddHistogram(const std::string& name, const std::string& help,
+                    const Labels& labels,
+                    const std::vector<double>& upper_bounds,
+                    const std::vector<int64>& bucket_counts,
+                    double sum) override;
+
+  // Returns the metrics added since the last Clear(), grouped by name.
+  std::string Text() const;
+
+  // Forgets all metrics.
+  void Clear();
+
+ private:
+  // The samples of one metric name.
+  struct Family {
+    std::string name;
+    std::string help;
+    std::string type;
+    std::string samples;
+  };
+
+  // Returns the Family for "name", adding it if needed.
+  Family* GetFamily(const std::string& name, const std::string& help,
+                    const std::string& type);
+
+  // Families in the order in which they were first added.
+  std::vector<Family> families_;
+  absl::flat_hash_map<std::string, int> family_index_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROMETHEUS_TEXT_SINK_H_
@@ -0,0 +1,65 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/prometheus_text_sink.h"
+
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(PrometheusTextSinkTest, GroupsSamplesByName) {
+  PrometheusTextSink sink;
+  sink.AddCounter("dropped_total", "Dropped frames.", {{"node", "a"}}, 3);
+  sink.AddGauge("queue_size", "Queued packets.", {}, 1.5);
+  sink.AddCounter("dropped_total", "Dropped frames.", {{"node", "b"}}, 1e10);
+  EXPECT_EQ(sink.Text(),
+            "# HELP dropped_total Dropped frames.\n"
+            "# TYPE dropped_total counter\n"
+            "dropped_total{node=\"a\"} 3\n"
+            "dropped_total{node=\"b\"} 10000000000\n"
+            "# HELP queue_size Queued packets.\n"
+            "# TYPE queue_size gauge\n"
+            "queue_size 1.5\n");
+
+  sink.Clear();
+  EXPECT_EQ(sink.Text(), "");
+}
+
+TEST(PrometheusTextSinkTest, FormatsHistograms) {
+  PrometheusTextSink sink;
+  sink.AddHistogram("runtime_seconds", "Runtime.", {{"node", "a"}},
+                    {0.001, 0.002}, {4, 6, 7}, 0.01);
+  EXPECT_EQ(sink.Text(),
+            "# HELP runtime_seconds Runtime.\n"
+            "# TYPE runtime_seconds histogram\n"
+            "runtime_seconds_bucket{node=\"a\",le=\"0.001\"} 4\n"
+            "runtime_seconds_bucket{node=\"a\",le=\"0.002\"} 6\n"
+            "runtime_seconds_bucket{node=\"a\",le=\"+Inf\"} 7\n"
+            "runtime_seconds_sum{node=\"a\"} 0.01\n"
+            "runtime_seconds_count{node=\"a\"} 7\n");
+}
+
+TEST(PrometheusTextSinkTest, EscapesLabelValues) {
+  PrometheusTextSink sink;
+  sink.AddGauge("value", "A \"quoted\" help\\text.", {{"name", "a\"b\\c\nd"}},
+                0);
+  EXPECT_EQ(sink.Text(),
+            "# HELP value A \"quoted\" help\\\\text.\n"
+            "# TYPE value gauge\n"
+            "value{name=\"a\\\"b\\\\c\\nd\"} 0\n");
+}
+
+}  // namespace
+}  // namespace mediapipe
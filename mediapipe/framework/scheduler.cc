@@ -223,6 +223,12 @@ void Scheduler::UnthrottledGraphInputStream() {
   state_cond_var_.SignalAll();
 }
 
+void Scheduler::NotifyGraphInputStreamWaiters() {
+  absl::MutexLock lock(&state_mutex_);
+  ++unthrottle_seq_num_;
+  state_cond_var_.SignalAll();
+}
+
 void Scheduler::WaitUntilGraphInputStreamUnthrottled(
     absl::Mutex* secondary_mutex) {
   // Since we want to support multiple concurrent calls to this method, we
@@ -154,6 +154,9 @@ class Scheduler {
 
   void ThrottledGraphInputStream() ABSL_LOCKS_EXCLUDED(state_mutex_);
   void UnthrottledGraphInputStream() ABSL_LOCKS_EXCLUDED(state_mutex_);
+  // Wakes up the WaitUntilGraphInputStreamUnthrottled() calls, so that they
+  // check again whether they can proceed.
+  void NotifyGraphInputStreamWaiters() ABSL_LOCKS_EXCLUDED(state_mutex_);
   void EmittedObservedOutput() ABSL_LOCKS_EXCLUDED(state_mutex_);
 
   // Closes all source nodes at the next scheduling opportunity.
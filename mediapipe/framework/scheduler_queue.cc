@@ -18,6 +18,7 @@
 #include <queue>
 #include <utility>
 
+#include "absl/base/attributes.h"
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/calculator_node.h"
 #include "mediapipe/framework/executor.h"
@@ -34,6 +35,24 @@
 namespace mediapipe {
 namespace internal {
 
+namespace {
+
+// The maximum number of inline nodes that can be nested on one thread, e.g.
+// in a chain of inlineable nodes. Further nodes are queued, which bounds the
+// stack depth.
+constexpr int kMaxInlineDepth = 16;
+
+// Identifies the SchedulerQueue whose task is running on the current thread.
+struct CurrentTask {
+  const SchedulerQueue* queue;
+  // The number of nodes currently running inline on this thread.
+  int inline_depth;
+};
+
+ABSL_CONST_INIT thread_local CurrentTask current_task = {nullptr, 0};
+
+}  // namespace
+
 SchedulerQueue::Item::Item(CalculatorNode* node, CalculatorContext* cc)
     : node_(node), cc_(cc) {
   CHECK(node);
@@ -43,6 +62,8 @@ SchedulerQueue::Item::Item(CalculatorNode* node, CalculatorContext* cc)
   if (is_source_) {
     layer_ = node->source_layer();
     source_process_order_ = node->SourceProcessOrder(cc).Value();
+  } else {
+    priority_ = node->scheduling_priority();
   }
 }
 
@@ -81,6 +102,8 @@ bool SchedulerQueue::Item::operator<(const SchedulerQueue::Item& that) const {
   } else {
     // Non-sources run before sources.
     if (that.is_source_) return false;
+    // Higher priority non-sources run before lower priority ones.
+    if (priority_ != that.priority_) return priority_ < that.priority_;
     // For non-sources, higher ids run before lower ids.
     return id_ < that.id_;
   }
@@ -120,9 +143,26 @@ void SchedulerQueue::AddNode(CalculatorNode* node, CalculatorContext* cc) {
     CHECK(node->IsSource()) << node->DebugName();
     return;
   }
+  if (node->RunsInline() && CanRunInline()) {
+    // The current thread is running a task of this queue, so the queue stays
+    // busy (num_pending_tasks_ > 0) while the node runs.
+    ++current_task.inline_depth;
+    RunCalculatorNode(node, cc);
+    --current_task.inline_depth;
+    return;
+  }
   AddItemToQueue(Item(node, cc));
 }
 
+bool SchedulerQueue::CanRunInline() {
+  if (current_task.queue != this ||
+      current_task.inline_depth >= kMaxInlineDepth) {
+    return false;
+  }
+  absl::MutexLock lock(&mutex_);
+  return running_count_ > 0;
+}
+
 void SchedulerQueue::AddNodeForOpen(CalculatorNode* node) {
   if (shared_->has_error) {
     return;
@@ -155,6 +195,8 @@ void SchedulerQueue::AddItemToQueue(Item&& item) {
   // This ensures that we never get an idle_callback_(true) that is not
   // preceded by the corresponding idle_callback_(false). See the comments on
   // SetIdleCallback for details.
+  // Follow-up tasks added from a WorkStealingExecutor worker thread go to
+  // that worker's local deque.
   while (tasks_to_add > 0) {
     executor_->AddTask(this);
     --tasks_to_add;
@@ -209,6 +251,8 @@ void SchedulerQueue::RunNextTask() {
   // want to rely on executors setting up an autorelease pool for us (e.g.
   // an executor creating standard pthread will not, by default), so we
   // do it here to ensure all executors are covered.
+  const CurrentTask outer_task = current_task;
+  current_task = {this, 0};
   AUTORELEASEPOOL {
     if (is_open_node) {
       DCHECK(!calculator_context);
@@ -217,7 +261,11 @@ void SchedulerQueue::RunNextTask() {
       RunCalculatorNode(node, calculator_context);
     }
   }
+  current_task = outer_task;
+  TaskCompleted();
+}
 
+void SchedulerQueue::TaskCompleted() {
   bool is_idle;
   {
     absl::MutexLock lock(&mutex_);
@@ -253,34 +301,59 @@ void SchedulerQueue::RunCalculatorNode(CalculatorNode* node,
               << " had an error while closing due to StatusStop()!";
       shared_->error_callback(result);
     }
+  } else if (node->ProcessesAsync()) {
+    // The invocation keeps the queue busy until it completes, which may happen
+    // on another thread after this task has returned.
+    {
+      absl::MutexLock lock(&mutex_);
+      ++num_pending_tasks_;
+    }
+    const bool timed = current_task.inline_depth == 0;
+    int64 start_time = timed ? shared_->timer.StartNode() : 0;
+    node->ProcessNodeAsync(cc, [this, node](absl::Status result) {
+      HandleProcessResult(node, result);
+      VLOG(4) << "Done running " << node->DebugName();
+      node->EndScheduling();
+      TaskCompleted();
+    });
+    if (timed) shared_->timer.EndNode(start_time);
+    return;
   } else {
     // Note that we don't need a lock because only one thread can execute this
     // due to the lock on running_nodes.
-    int64 start_time = shared_->timer.StartNode();
+    // A node running inline is already covered by the timer of the node that
+    // delivered its input.
+    const bool timed = current_task.inline_depth == 0;
+    int64 start_time = timed ? shared_->timer.StartNode() : 0;
     const absl::Status result = node->ProcessNode(cc);
-    shared_->timer.EndNode(start_time);
-
-    if (!result.ok()) {
-      if (result == tool::StatusStop()) {
-        // Check if StatusStop was returned by a non-source node. This means
-        // that all sources will be closed and no further sources should be
-        // scheduled. The graph will be terminated as soon as its scheduler
-        // queue becomes empty.
-        CHECK(!node->IsSource());  // ProcessNode takes care of StatusStop()
-                                   // from sources.
-        shared_->stopping = true;
-      } else {
-        // If we have an error in this calculator.
-        VLOG(3) << node->DebugName() << " had an error!";
-        shared_->error_callback(result);
-      }
-    }
+    if (timed) shared_->timer.EndNode(start_time);
+    HandleProcessResult(node, result);
   }
 
   VLOG(4) << "Done running " << node->DebugName();
   node->EndScheduling();
 }
 
+void SchedulerQueue::HandleProcessResult(CalculatorNode* node,
+                                         const absl::Status& result) {
+  if (result.ok()) {
+    return;
+  }
+  if (result == tool::StatusStop()) {
+    // Check if StatusStop was returned by a non-source node. This means that
+    // all sources will be closed and no further sources should be scheduled.
+    // The graph will be terminated as soon as its scheduler queue becomes
+    // empty.
+    CHECK(!node->IsSource());  // ProcessNode takes care of StatusStop()
+                               // from sources.
+    shared_->stopping = true;
+  } else {
+    // If we have an error in this calculator.
+    VLOG(3) << node->DebugName() << " had an error!";
+    shared_->error_callback(result);
+  }
+}
+
 void SchedulerQueue::OpenCalculatorNode(CalculatorNode* node) {
   VLOG(3) << "Opening " << node->DebugName();
   int64 start_time = shared_->timer.StartNode();
@@ -62,12 +62,14 @@ class SchedulerQueue : public TaskQueue {
     // - Sources are sorted by layer (lower layer numbers run first), then by
     //   Calculator::SourceProcessOrder (smaller values run first), then by
     //   node id: smaller ids run first, since they come earlier in the config.
-    // - Non-sources are sorted by node id: larger ids run first, because they
-    //   are closer to the leaves.
+    // - Non-sources are sorted by CalculatorNode::scheduling_priority (higher
+    //   priorities run first), then by node id: larger ids run first, because
+    //   they are closer to the leaves.
     bool operator<(const Item& that) const;
 
    private:
     int64 source_process_order_ = 0;
+    int64 priority_ = 0;
     CalculatorNode* node_;
     CalculatorContext* cc_;
     int id_ = 0;
@@ -121,6 +123,8 @@ class SchedulerQueue : public TaskQueue {
   // not already running. Note that if the node was running, then it will be
   // rescheduled upon completion (after checking dependencies), so this call is
   // not lost.
+  // If the node RunsInline() and the current thread is running a task of this
+  // queue, the node is run synchronously instead of being queued.
   void AddNode(CalculatorNode* node, CalculatorContext* cc)
       ABSL_LOCKS_EXCLUDED(mutex_);
 
@@ -134,14 +138,28 @@ class SchedulerQueue : public TaskQueue {
 
  private:
   // Used internally by RunNextTask. Invokes ProcessNode or CloseNode, followed
-  // by EndScheduling.
+  // by EndScheduling. For nodes that ProcessesAsync(), invokes
+  // ProcessNodeAsync instead and calls EndScheduling when the invocation
+  // completes; the invocation counts as a pending task until then.
   void RunCalculatorNode(CalculatorNode* node, CalculatorContext* cc)
       ABSL_LOCKS_EXCLUDED(mutex_);
 
+  // Reports the error or StatusStop() returned by a ProcessNode invocation.
+  void HandleProcessResult(CalculatorNode* node, const absl::Status& result);
+
+  // Decrements num_pending_tasks_ when a task completes, and notifies the
+  // idle callback if the queue became idle.
+  void TaskCompleted() ABSL_LOCKS_EXCLUDED(mutex_);
+
   // Used internally by RunNextTask. Invokes OpenNode, followed by
   // CheckIfBecameReady.
   void OpenCalculatorNode(CalculatorNode* node) ABSL_LOCKS_EXCLUDED(mutex_);
 
+  // Returns true if a node of this queue may run inline on the current thread,
+  // i.e. the thread is running a task of this running queue and the inline
+  // nesting limit has not been reached.
+  bool CanRunInline() ABSL_LOCKS_EXCLUDED(mutex_);
+
   // Checks whether the queue has no queued nodes or pending tasks.
   bool IsIdle() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
@@ -156,7 +174,8 @@ class SchedulerQueue : public TaskQueue {
   // Invariant: running_count_ <= 1.
   int running_count_ ABSL_GUARDED_BY(mutex_) = 0;
 
-  // Number of tasks added to the Executor and not yet complete.
+  // Number of tasks added to the Executor and not yet complete, including the
+  // ProcessNodeAsync invocations that have not completed.
   int num_pending_tasks_ ABSL_GUARDED_BY(mutex_);
 
   // Number of tasks that need to be added to the Executor.
@@ -0,0 +1,179 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/shared_executor.h"
+
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/source_location.h"
+#include "mediapipe/framework/port/status_builder.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+
+namespace {
+
+// The process-wide registry of shared executors, keyed by name.
+class SharedExecutorRegistry {
+ public:
+  static SharedExecutorRegistry& Get() {
+    static auto* registry = new SharedExecutorRegistry();
+    return *registry;
+  }
+
+  absl::Mutex mutex;
+  absl::flat_hash_map<std::string, std::weak_ptr<SharedExecutor>> executors
+      ABSL_GUARDED_BY(mutex);
+};
+
+}  // namespace
+
+struct SharedExecutor::ClientQueues {
+  absl::Mutex mutex;
+  // The clients that have queued tasks, in the order they will be served.
+  std::deque<Client*> ready_clients ABSL_GUARDED_BY(mutex);
+  std::atomic<int64> busy_time_usec{0};
+};
+
+SharedExecutor::Client::~Client() { shared_executor_->RemoveClient(this); }
+
+void SharedExecutor::Client::Schedule(std::function<void()> task) {
+  shared_executor_->Schedule(this, std::move(task));
+}
+
+// static
+absl::StatusOr<std::shared_ptr<SharedExecutor>> SharedExecutor::GetOrCreate(
+    const std::string& name, const std::string& package,
+    const std::string& type, const MediaPipeOptions& options) {
+  RET_CHECK(!name.empty()) << "A shared executor must have a name.";
+  SharedExecutorRegistry& registry = SharedExecutorRegistry::Get();
+  absl::MutexLock lock(&registry.mutex);
+  std::shared_ptr<SharedExecutor> shared_executor =
+      registry.executors[name].lock();
+  if (shared_executor) {
+    return shared_executor;
+  }
+  ASSIGN_OR_RETURN(Executor * executor,
+                   ExecutorRegistry::CreateByNameInNamespace(package, type,
+                                                             options));
+  shared_executor =
+      std::make_shared<SharedExecutor>(std::shared_ptr<Executor>(executor));
+  registry.executors[name] = shared_executor;
+  VLOG(1) << "Created shared executor \"" << name << "\" of type " << type;
+  return shared_executor;
+}
+
+// static
+absl::StatusOr<std::shared_ptr<SharedExecutor>> SharedExecutor::Register(
+    const std::string& name, std::shared_ptr<Executor> executor) {
+  RET_CHECK(!name.empty()) << "A shared executor must have a name.";
+  RET_CHECK(executor);
+  SharedExecutorRegistry& registry = SharedExecutorRegistry::Get();
+  absl::MutexLock lock(&registry.mutex);
+  std::weak_ptr<SharedExecutor>& entry = registry.executors[name];
+  if (!entry.expired()) {
+    return mediapipe::AlreadyExistsErrorBuilder(MEDIAPIPE_LOC)
+           << "A shared executor named \"" << name
+           << "\" is already registered.";
+  }
+  auto shared_executor = std::make_shared<SharedExecutor>(std::move(executor));
+  entry = shared_executor;
+  return shared_executor;
+}
+
+SharedExecutor::SharedExecutor(std::shared_ptr<Executor> executor)
+    : queues_(std::make_shared<ClientQueues>()),
+      executor_(std::move(executor)) {}
+
+std::shared_ptr<SharedExecutor::Client> SharedExecutor::AddClient() {
+  return std::shared_ptr<Client>(new Client(shared_from_this()));
+}
+
+int64 SharedExecutor::BusyTimeUsec() const {
+  return queues_->busy_time_usec.load();
+}
+
+void SharedExecutor::Schedule(Client* client, std::function<void()> task) {
+  {
+    absl::MutexLock lock(&queues_->mutex);
+    client->tasks_.push_back(std::move(task));
+    if (!client->is_ready_) {
+      client->is_ready_ = true;
+      queues_->ready_clients.push_back(client);
+    }
+  }
+  // Every queued task is matched by one RunNextTask call, although that call
+  // may run the task of another client.
+  executor_->Schedule([queues = queues_] { RunNextTask(queues.get()); });
+}
+
+// static
+void SharedExecutor::RunNextTask(ClientQueues* queues) {
+  std::function<void()> task;
+  std::shared_ptr<Client::Usage> usage;
+  {
+    absl::MutexLock lock(&queues->mutex);
+    if (queues->ready_clients.empty()) {
+      // The tasks were dropped by a client that has been destroyed.
+      return;
+    }
+    Client* client = queues->ready_clients.front();
+    queues->ready_clients.pop_front();
+    task = std::move(client->tasks_.front());
+    usage = client->usage_;
+    client->tasks_.pop_front();
+    if (client->tasks_.empty()) {
+      client->is_ready_ = false;
+    } else {
+      queues->ready_clients.push_back(client);
+    }
+  }
+  absl::Time start_time = absl::Now();
+  task();
+  const int64 busy_time_usec =
+      absl::ToInt64Microseconds(absl::Now() - start_time);
+  // The total is updated first, so that it never looks smaller than the time
+  // of a single client. The client may have been destroyed while the task was
+  // running, but usage is still valid.
+  queues->busy_time_usec += busy_time_usec;
+  usage->busy_time_usec += busy_time_usec;
+  ++usage->num_tasks_run;
+}
+
+void SharedExecutor::RemoveClient(Client* client) {
+  absl::MutexLock lock(&queues_->mutex);
+  if (!client->is_ready_) {
+    return;
+  }
+  LOG(WARNING) << "Dropping " << client->tasks_.size()
+               << " tasks of a destroyed SharedExecutor client.";
+  client->tasks_.clear();
+  client->is_ready_ = false;
+  for (auto it = queues_->ready_clients.begin();
+       it != queues_->ready_clients.end(); ++it) {
+    if (*it == client) {
+      queues_->ready_clients.erase(it);
+      break;
+    }
+  }
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,137 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_SHARED_EXECUTOR_H_
+#define MEDIAPIPE_FRAMEWORK_SHARED_EXECUTOR_H_
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/mediapipe_options.pb.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/statusor.h"
+
+namespace mediapipe {
+
+// An executor that is shared by several CalculatorGraphs in a process.
+//
+// Each graph attaches to a SharedExecutor through its own Client, which is an
+// Executor that can be passed to CalculatorGraph::SetExecutor(). The clients
+// queue their tasks separately, and the shared executor hands them to the
+// underlying executor in round-robin order, so a graph with many ready nodes
+// cannot starve the other graphs.
+//
+// Graphs normally attach to a shared executor by setting
+// ExecutorConfig::shared_name, which looks the executor up in a process-wide
+// registry:
+//
+//   executor {
+//     name: ""
+//     shared_name: "camera_pool"
+//     options {
+//       [mediapipe.ThreadPoolExecutorOptions.ext] { num_threads: 8 }
+//     }
+//   }
+class SharedExecutor : public std::enable_shared_from_this<SharedExecutor> {
+ public:
+  // An Executor that runs its tasks on a SharedExecutor.
+  class Client : public Executor {
+   public:
+    ~Client() override;
+    void Schedule(std::function<void()> task) override;
+
+    // Returns the SharedExecutor that runs the tasks of this client.
+    SharedExecutor* shared_executor() const { return shared_executor_.get(); }
+
+    // Returns the number of tasks of this client that have completed.
+    int64 NumTasksRun() const { return usage_->num_tasks_run.load(); }
+
+    // Returns the total time spent running the tasks of this client, in
+    // microseconds.
+    int64 BusyTimeUsec() const { return usage_->busy_time_usec.load(); }
+
+   private:
+    friend class SharedExecutor;
+
+    // Counters updated by the tasks of this client. A task can still be
+    // finishing when the client is destroyed, so the tasks share ownership.
+    struct Usage {
+      std::atomic<int64> num_tasks_run{0};
+      std::atomic<int64> busy_time_usec{0};
+    };
+
+    explicit Client(std::shared_ptr<SharedExecutor> shared_executor)
+        : shared_executor_(std::move(shared_executor)),
+          usage_(std::make_shared<Usage>()) {}
+
+    std::shared_ptr<SharedExecutor> shared_executor_;
+    std::shared_ptr<Usage> usage_;
+    // Guarded by the mutex of shared_executor_->queues_.
+    std::deque<std::function<void()>> tasks_;
+    bool is_ready_ = false;
+  };
+
+  // Returns the shared executor registered under "name". If there is none,
+  // creates one with the registered executor "type" (looked up in "package")
+  // and "options", and registers it. Later calls ignore "type" and "options".
+  // The registry does not own the executors: a shared executor is destroyed
+  // together with its last Client.
+  static absl::StatusOr<std::shared_ptr<SharedExecutor>> GetOrCreate(
+      const std::string& name, const std::string& package,
+      const std::string& type, const MediaPipeOptions& options);
+
+  // Registers "executor" under "name", so that graphs which set
+  // ExecutorConfig::shared_name to "name" run on it. The caller must keep the
+  // returned SharedExecutor alive until those graphs are initialized. Returns
+  // an error if a shared executor is already registered under "name".
+  static absl::StatusOr<std::shared_ptr<SharedExecutor>> Register(
+      const std::string& name, std::shared_ptr<Executor> executor);
+
+  explicit SharedExecutor(std::shared_ptr<Executor> executor);
+  SharedExecutor(const SharedExecutor&) = delete;
+  SharedExecutor& operator=(const SharedExecutor&) = delete;
+
+  // Returns a new client of this shared executor. The SharedExecutor must be
+  // owned by a std::shared_ptr.
+  std::shared_ptr<Client> AddClient();
+
+  // Returns the total time spent running the tasks of all the clients, in
+  // microseconds.
+  int64 BusyTimeUsec() const;
+
+ private:
+  // The client queues. They are shared with the tasks scheduled on the
+  // underlying executor, which may outlive the SharedExecutor.
+  struct ClientQueues;
+
+  // Runs the oldest task of the next client in round-robin order.
+  static void RunNextTask(ClientQueues* queues);
+
+  // Queues "task" for "client" and asks the underlying executor to run a task.
+  void Schedule(Client* client, std::function<void()> task);
+
+  // Drops the queued tasks of "client", which is being destroyed.
+  void RemoveClient(Client* client);
+
+  std::shared_ptr<ClientQueues> queues_;
+  std::shared_ptr<Executor> executor_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_SHARED_EXECUTOR_H_
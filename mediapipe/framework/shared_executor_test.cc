@@ -0,0 +1,198 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/shared_executor.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/thread_pool_executor.pb.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+// An executor that queues its tasks until the test runs them.
+class QueueingExecutor : public Executor {
+ public:
+  void Schedule(std::function<void()> task) override {
+    tasks_.push_back(std::move(task));
+  }
+
+  void RunAll() {
+    for (int i = 0; i < tasks_.size(); ++i) {
+      tasks_[i]();
+    }
+    tasks_.clear();
+  }
+
+ private:
+  std::vector<std::function<void()>> tasks_;
+};
+
+TEST(SharedExecutorTest, RunsClientsInRoundRobinOrder) {
+  auto executor = std::make_shared<QueueingExecutor>();
+  auto shared_executor = std::make_shared<SharedExecutor>(executor);
+  std::shared_ptr<SharedExecutor::Client> client_a =
+      shared_executor->AddClient();
+  std::shared_ptr<SharedExecutor::Client> client_b =
+      shared_executor->AddClient();
+  std::vector<std::string> order;
+  for (int i = 0; i < 3; ++i) {
+    client_a->Schedule([&order, i] { order.push_back(absl::StrCat("a", i)); });
+  }
+  for (int i = 0; i < 2; ++i) {
+    client_b->Schedule([&order, i] { order.push_back(absl::StrCat("b", i)); });
+  }
+  executor->RunAll();
+  EXPECT_THAT(order, ElementsAre("a0", "b0", "a1", "b1", "a2"));
+  EXPECT_EQ(client_a->NumTasksRun(), 3);
+  EXPECT_EQ(client_b->NumTasksRun(), 2);
+}
+
+TEST(SharedExecutorTest, DestroyedClientDropsItsTasks) {
+  auto executor = std::make_shared<QueueingExecutor>();
+  auto shared_executor = std::make_shared<SharedExecutor>(executor);
+  std::shared_ptr<SharedExecutor::Client> client_a =
+      shared_executor->AddClient();
+  std::shared_ptr<SharedExecutor::Client> client_b =
+      shared_executor->AddClient();
+  std::vector<std::string> order;
+  client_a->Schedule([&order] { order.push_back("a"); });
+  client_b->Schedule([&order] { order.push_back("b"); });
+  client_a.reset();
+  executor->RunAll();
+  EXPECT_THAT(order, ElementsAre("b"));
+}
+
+TEST(SharedExecutorTest, RegistryLooksUpExecutorsByName) {
+  MediaPipeOptions options;
+  options.MutableExtension(ThreadPoolExecutorOptions::ext)->set_num_threads(1);
+  MP_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<SharedExecutor> first,
+      SharedExecutor::GetOrCreate("registry_test", "", "ThreadPoolExecutor",
+                                  options));
+  MP_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<SharedExecutor> second,
+      SharedExecutor::GetOrCreate("registry_test", "", "ThreadPoolExecutor",
+                                  options));
+  EXPECT_EQ(first, second);
+  EXPECT_FALSE(
+      SharedExecutor::Register("registry_test",
+                               std::make_shared<QueueingExecutor>())
+          .ok());
+
+  // The registry does not keep unused executors alive.
+  std::weak_ptr<SharedExecutor> weak_executor = first;
+  first.reset();
+  second.reset();
+  EXPECT_TRUE(weak_executor.expired());
+  MP_EXPECT_OK(SharedExecutor::Register("registry_test",
+                                        std::make_shared<QueueingExecutor>()));
+}
+
+TEST(SharedExecutorTest, GraphsShareTheExecutor) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in'
+        executor {
+          name: ''
+          shared_name: 'graphs_share_test'
+          options {
+            [mediapipe.ThreadPoolExecutorOptions.ext] { num_threads: 2 }
+          }
+        }
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'in'
+          output_stream: 'mid'
+        }
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'mid'
+          output_stream: 'out'
+        }
+      )pb");
+  std::vector<std::unique_ptr<CalculatorGraph>> graphs;
+  std::vector<std::vector<Packet>> outputs(3);
+  for (int g = 0; g < 3; ++g) {
+    graphs.push_back(std::make_unique<CalculatorGraph>());
+    MP_ASSERT_OK(graphs[g]->Initialize(config));
+    MP_ASSERT_OK(graphs[g]->ObserveOutputStream(
+        "out", [&outputs, g](const Packet& packet) {
+          outputs[g].push_back(packet);
+          return absl::OkStatus();
+        }));
+    MP_ASSERT_OK(graphs[g]->StartRun({}));
+  }
+  for (int i = 0; i < 10; ++i) {
+    for (auto& graph : graphs) {
+      MP_ASSERT_OK(graph->AddPacketToInputStream(
+          "in", MakePacket<int>(i).At(Timestamp(i))));
+    }
+  }
+  // Each graph tracks its own idleness on the shared executor.
+  for (int g = 0; g < 3; ++g) {
+    MP_ASSERT_OK(graphs[g]->WaitUntilIdle());
+    EXPECT_EQ(outputs[g].size(), 10);
+  }
+
+  GraphProfile profile;
+  MP_ASSERT_OK(graphs[0]->profiler()->CaptureProfile(&profile));
+  ASSERT_EQ(profile.executor_profiles_size(), 1);
+  const ExecutorProfile& executor_profile = profile.executor_profiles(0);
+  EXPECT_EQ(executor_profile.name(), "");
+  EXPECT_EQ(executor_profile.shared_name(), "graphs_share_test");
+  EXPECT_GT(executor_profile.num_tasks_run(), 0);
+  EXPECT_LE(executor_profile.busy_time_usec(),
+            executor_profile.total_busy_time_usec());
+
+  for (auto& graph : graphs) {
+    MP_ASSERT_OK(graph->CloseAllInputStreams());
+    MP_ASSERT_OK(graph->WaitUntilDone());
+  }
+}
+
+TEST(SharedExecutorTest, RejectsSharedApplicationThread) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in'
+        executor {
+          name: ''
+          type: 'ApplicationThreadExecutor'
+          shared_name: 'application_thread_test'
+        }
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'in'
+          output_stream: 'out'
+        }
+      )pb");
+  CalculatorGraph graph;
+  EXPECT_FALSE(graph.Initialize(config).ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
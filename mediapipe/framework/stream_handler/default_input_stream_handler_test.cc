@@ -14,6 +14,7 @@
 
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
@@ -279,5 +280,56 @@ TEST(DefaultInputStreamHandlerTest, DoesntPropagateTimestampWhenBatching) {
   EXPECT_EQ(4, sink.size());
 }
 
+// This test shows that a node with many input streams is ready only once
+// every stream has settled the input timestamp, whichever stream is last.
+TEST(DefaultInputStreamHandlerTest, WaitsForAllOfManyInputs) {
+  const int kNumInputs = 32;
+  CalculatorGraphConfig config;
+  CalculatorGraphConfig::Node* node = config.add_node();
+  node->set_calculator("PassThroughCalculator");
+  for (int i = 0; i < kNumInputs; ++i) {
+    config.add_input_stream(absl::StrCat("input", i));
+    node->add_input_stream(absl::StrCat("input", i));
+    node->add_output_stream(absl::StrCat("output", i));
+  }
+  std::vector<Packet> sink;
+  tool::AddVectorSink("output0", &config, &sink);
+
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  // Packets at timestamp 1 arrive in reverse stream order.
+  for (int i = kNumInputs - 1; i >= 0; --i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        absl::StrCat("input", i), Adopt(new int(i)).At(Timestamp(1))));
+    MP_ASSERT_OK(graph.WaitUntilIdle());
+    EXPECT_EQ(i == 0 ? 1 : 0, sink.size());
+  }
+
+  // Packets at timestamp 2 arrive in order, except on the middle stream which
+  // skips to timestamp 3 and so settles timestamp 2 last.
+  for (int i = 0; i < kNumInputs; ++i) {
+    if (i != kNumInputs / 2) {
+      MP_ASSERT_OK(graph.AddPacketToInputStream(
+          absl::StrCat("input", i), Adopt(new int(i)).At(Timestamp(2))));
+    }
+  }
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  EXPECT_EQ(1, sink.size());
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      absl::StrCat("input", kNumInputs / 2),
+      Adopt(new int(0)).At(Timestamp(3))));
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  ASSERT_EQ(2, sink.size());
+  EXPECT_EQ(Timestamp(2), sink[1].Timestamp());
+
+  // Closing the other streams settles timestamp 3.
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  ASSERT_EQ(3, sink.size());
+  EXPECT_EQ(Timestamp(3), sink[2].Timestamp());
+}
+
 }  // namespace
 }  // namespace mediapipe
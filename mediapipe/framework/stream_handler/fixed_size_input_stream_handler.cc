@@ -15,6 +15,7 @@
 #include <memory>
 #include <vector>
 
+#include "mediapipe/framework/mediapipe_profiling.h"
 #include "mediapipe/framework/stream_handler/default_input_stream_handler.h"
 // TODO: Move protos in another CL after the C++ code migration.
 #include "mediapipe/framework/stream_handler/fixed_size_input_stream_handler.pb.h"
@@ -44,6 +45,12 @@ namespace mediapipe {
 // timestamp, so that each included timestamp delivers the same packets as
 // DefaultInputStreamHandler includes.
 //
+// Since a queue size limit means a different latency at every frame rate,
+// max_packet_age_us can limit the queues by packet age instead: packets more
+// than max_packet_age_us older than the newest packet on any stream are
+// dropped.  The number of packets dropped from each input stream is reported
+// in StreamProfile::num_dropped_packets.
+//
 class FixedSizeInputStreamHandler : public DefaultInputStreamHandler {
  public:
   FixedSizeInputStreamHandler() = delete;
@@ -58,6 +65,10 @@ class FixedSizeInputStreamHandler : public DefaultInputStreamHandler {
     trigger_queue_size_ = ext.trigger_queue_size();
     target_queue_size_ = ext.target_queue_size();
     fixed_min_size_ = ext.fixed_min_size();
+    max_packet_age_ = TimestampDiff(ext.max_packet_age_us());
+    limit_queue_size_ = ext.max_packet_age_us() <= 0 ||
+                        ext.has_trigger_queue_size() ||
+                        ext.has_target_queue_size();
     pending_ = false;
     kept_timestamp_ = Timestamp::Unset();
     // TODO: Either re-enable SetLatePreparation(true) with
@@ -82,9 +93,7 @@ class FixedSizeInputStreamHandler : public DefaultInputStreamHandler {
       min_timestamp_all_streams =
           std::min(min_timestamp_all_streams, min_timestamp);
     }
-    for (auto& stream : input_stream_managers_) {
-      stream->ErasePacketsEarlierThan(min_timestamp_all_streams);
-    }
+    EraseAllPacketsEarlierThan(min_timestamp_all_streams);
   }
 
   // Returns the latest timestamp allowed before a bound.
@@ -146,14 +155,74 @@ class FixedSizeInputStreamHandler : public DefaultInputStreamHandler {
       kept_timestamp_ =
           std::min(kept_timestamp_, PreviousAllowedInStream(MinStreamBound()));
     }
-    for (auto& stream : input_stream_managers_) {
-      stream->ErasePacketsEarlierThan(kept_timestamp_);
+    EraseAllPacketsEarlierThan(kept_timestamp_);
+  }
+
+  // Discards all packets more than max_packet_age_ older than the newest
+  // packet on any stream.  With fixed_min_size_, keeps the newest
+  // target_queue_size_ packets in every stream.
+  void EraseExpiredPackets(bool keep_one)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(erase_mutex_) {
+    Timestamp newest_timestamp = Timestamp::Unset();
+    for (const auto& stream : input_stream_managers_) {
+      newest_timestamp =
+          std::max(newest_timestamp, stream->GetMinTimestampAmongNLatest(1));
+    }
+    if (!newest_timestamp.IsRangeValue()) {
+      return;
+    }
+    Timestamp expired_timestamp = newest_timestamp - max_packet_age_;
+    if (fixed_min_size_) {
+      for (const auto& stream : input_stream_managers_) {
+        expired_timestamp = std::min(
+            expired_timestamp,
+            stream->GetMinTimestampAmongNLatest(target_queue_size_));
+      }
+    }
+    kept_timestamp_ = std::max(kept_timestamp_, expired_timestamp);
+    if (keep_one) {
+      kept_timestamp_ =
+          std::min(kept_timestamp_, PreviousAllowedInStream(MinStreamBound()));
+    }
+    EraseAllPacketsEarlierThan(kept_timestamp_);
+  }
+
+  // Discards the packets earlier than "timestamp" in every stream, and
+  // reports the number of packets dropped from each stream to the profiler.
+  void EraseAllPacketsEarlierThan(Timestamp timestamp)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(erase_mutex_) {
+    CalculatorContext* calculator_context =
+        calculator_context_manager_ &&
+                calculator_context_manager_->HasDefaultCalculatorContext()
+            ? calculator_context_manager_->GetDefaultCalculatorContext()
+            : nullptr;
+    int stream_index = 0;
+    for (CollectionItemId id = input_stream_managers_.BeginId();
+         id < input_stream_managers_.EndId(); ++id, ++stream_index) {
+      int num_dropped =
+          input_stream_managers_.Get(id)->ErasePacketsEarlierThan(timestamp);
+      MarkStreamChanged(id);
+      if (num_dropped > 0 && calculator_context &&
+          calculator_context->GetProfilingContext()) {
+        calculator_context->GetProfilingContext()->AddDroppedPackets(
+            *calculator_context, stream_index, num_dropped);
+      }
     }
   }
 
   void EraseSurplusPackets(bool keep_one)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(erase_mutex_) {
-    return (fixed_min_size_) ? EraseAllSurplus() : EraseAnySurplus(keep_one);
+    if (max_packet_age_ > TimestampDiff(0)) {
+      EraseExpiredPackets(keep_one);
+    }
+    if (!limit_queue_size_) {
+      return;
+    }
+    if (fixed_min_size_) {
+      EraseAllSurplus();
+    } else {
+      EraseAnySurplus(keep_one);
+    }
   }
 
   NodeReadiness GetNodeReadiness(Timestamp* min_stream_timestamp) override {
@@ -217,6 +286,10 @@ class FixedSizeInputStreamHandler : public DefaultInputStreamHandler {
   int32 trigger_queue_size_;
   int32 target_queue_size_;
   bool fixed_min_size_;
+  // The maximum age of a packet relative to the newest packet, or zero.
+  TimestampDiff max_packet_age_;
+  // Indicates that trigger_queue_size_ and target_queue_size_ apply.
+  bool limit_queue_size_;
   // Indicates that GetNodeReadiness has returned kReadyForProcess once, and
   // the corresponding call to FillInputSet has not yet completed.
   bool pending_ ABSL_GUARDED_BY(erase_mutex_);
@@ -359,5 +359,61 @@ TEST_P(FixedSizeInputStreamHandlerTest, LateArrivalDrop) {
   }
 }
 
+// Tests dropping of packets by age rather than by queue size.
+// A: 0 5 10 15 20 25[30 35 40]
+// B:                [30 35 40]
+// With max_packet_age_us 10, everything before ts 30 should be dropped.
+TEST_P(FixedSizeInputStreamHandlerTest, DropsExpiredPackets) {
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(
+          R"pb(
+            input_stream: "in_0"
+            input_stream: "in_1"
+            node {
+              calculator: "PassThroughCalculator"
+              input_stream: "in_0"
+              input_stream: "in_1"
+              output_stream: "out_0"
+              output_stream: "out_1"
+              input_stream_handler {
+                input_stream_handler: "FixedSizeInputStreamHandler"
+                options {
+                  [mediapipe.FixedSizeInputStreamHandlerOptions.ext] {
+                    max_packet_age_us: 10
+                  }
+                }
+              }
+            })pb");
+  SetFixedMinSize(graph_config.mutable_node(0), GetParam());
+  std::vector<Packet> output_packets[2];
+  for (int i = 0; i < 2; ++i) {
+    tool::AddVectorSink(absl::StrCat("out_", i), &graph_config,
+                        &output_packets[i]);
+  }
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(graph_config, {}));
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  // More packets than the default trigger_queue_size are queued, since only
+  // the packet age limits the queues.
+  for (int i = 0; i <= 40; i += 5) {
+    MP_EXPECT_OK(graph.AddPacketToInputStream(
+        "in_0", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  for (int i = 30; i <= 40; i += 5) {
+    MP_EXPECT_OK(graph.AddPacketToInputStream(
+        "in_1", MakePacket<int>(i).At(Timestamp(i))));
+    MP_ASSERT_OK(graph.WaitUntilIdle());
+  }
+
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  EXPECT_THAT(TimestampValues(output_packets[0]),
+              testing::ContainerEq(std::vector<int64>{30, 35, 40}));
+  EXPECT_THAT(TimestampValues(output_packets[1]),
+              testing::ContainerEq(std::vector<int64>{30, 35, 40}));
+}
+
 }  // namespace
 }  // namespace mediapipe
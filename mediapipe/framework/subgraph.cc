@@ -91,6 +91,11 @@ bool GraphRegistry::IsRegistered(const std::string& ns,
          global_factories_->IsRegistered(ns, type_name);
 }
 
+int64_t GraphRegistry::generation() const {
+  // Both counters only grow, so their sum changes whenever either does.
+  return local_factories_.generation() + global_factories_->generation();
+}
+
 absl::StatusOr<CalculatorGraphConfig> GraphRegistry::CreateByName(
     const std::string& ns, const std::string& type_name,
     SubgraphContext* context) const {
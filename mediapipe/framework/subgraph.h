@@ -17,6 +17,8 @@
 #ifndef MEDIAPIPE_FRAMEWORK_SUBGRAPH_H_
 #define MEDIAPIPE_FRAMEWORK_SUBGRAPH_H_
 
+#include <cstdint>
+
 #include "absl/base/macros.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
@@ -67,9 +69,14 @@ class SubgraphContext {
 
   template <typename T>
   ServiceBinding<T> Service(const GraphService<T>& service) const {
+    service_requested_ = true;
     return ServiceBinding<T>(service_manager_.GetServiceObject(service));
   }
 
+  // Whether the subgraph asked for a graph service, in which case its config
+  // may depend on the service objects and not only on its options.
+  bool service_requested() const { return service_requested_; }
+
  private:
   // Populated if node is not provided during construction.
   absl::optional<CalculatorGraphConfig::Node> default_node_;
@@ -82,6 +89,8 @@ class SubgraphContext {
   const GraphServiceManager& service_manager_;
 
   tool::MutableOptionsMap options_map_;
+
+  mutable bool service_requested_ = false;
 };
 
 // Instances of this class are responsible for providing a subgraph config.
@@ -185,6 +194,10 @@ class GraphRegistry {
   // Returns true if the specified graph config is registered.
   bool IsRegistered(const std::string& ns, const std::string& type_name) const;
 
+  // Returns a number that changes whenever a graph is registered or
+  // unregistered, locally or globally.
+  int64_t generation() const;
+
   // Returns the specified graph config.
   absl::StatusOr<CalculatorGraphConfig> CreateByName(
       const std::string& ns, const std::string& type_name,
@@ -14,21 +14,23 @@
 
 #include "mediapipe/framework/thread_pool_executor.h"
 
+#include <set>
 #include <utility>
 
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/status_builder.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/framework/thread_pool_executor.pb.h"
+#include "mediapipe/framework/work_stealing_executor.h"
 #include "mediapipe/util/cpu_util.h"
 
 namespace mediapipe {
 
-// static
-absl::StatusOr<Executor*> ThreadPoolExecutor::Create(
-    const MediaPipeOptions& extendable_options) {
-  auto& options =
-      extendable_options.GetExtension(ThreadPoolExecutorOptions::ext);
+namespace internal {
+
+absl::StatusOr<ThreadOptions> ThreadOptionsFromExecutorOptions(
+    const ThreadPoolExecutorOptions& options) {
   if (!options.has_num_threads()) {
     return absl::InvalidArgumentError(
         "num_threads is not specified in ThreadPoolExecutorOptions.");
@@ -59,7 +61,34 @@ absl::StatusOr<Executor*> ThreadPoolExecutor::Create(
   if (options.has_thread_name_prefix()) {
     thread_options.set_name_prefix(options.thread_name_prefix());
   }
+  const int num_cpu_pinning_options =
+      (options.cpu_id_size() > 0) + options.has_numa_node() +
+      (options.require_processor_performance() !=
+       ThreadPoolExecutorOptions::NORMAL);
+  if (num_cpu_pinning_options > 1) {
+    return absl::InvalidArgumentError(
+        "At most one of cpu_id, numa_node and require_processor_performance "
+        "can be set in ThreadPoolExecutorOptions.");
+  }
+  if (options.cpu_id_size() > 0) {
+    std::set<int> cpu_set;
+    for (int cpu : options.cpu_id()) {
+      if (cpu < 0) {
+        return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+               << "The cpu_id field in ThreadPoolExecutorOptions should be "
+                  "non-negative but contains "
+               << cpu;
+      }
+      cpu_set.insert(cpu);
+    }
+    thread_options.set_cpu_set(cpu_set);
+  }
 #if defined(__linux__)
+  if (options.has_numa_node()) {
+    ASSIGN_OR_RETURN(std::set<int> cpu_set,
+                     GetNumaNodeCoreIds(options.numa_node()));
+    thread_options.set_cpu_set(cpu_set);
+  }
   switch (options.require_processor_performance()) {
     case ThreadPoolExecutorOptions::LOW:
       thread_options.set_cpu_set(InferLowerCoreIds());
@@ -70,7 +99,28 @@ absl::StatusOr<Executor*> ThreadPoolExecutor::Create(
     default:
       break;
   }
+#else
+  if (options.has_numa_node()) {
+    return absl::UnimplementedError(
+        "The numa_node field in ThreadPoolExecutorOptions is only supported "
+        "on Linux.");
+  }
 #endif
+  return thread_options;
+}
+
+}  // namespace internal
+
+// static
+absl::StatusOr<Executor*> ThreadPoolExecutor::Create(
+    const MediaPipeOptions& extendable_options) {
+  auto& options =
+      extendable_options.GetExtension(ThreadPoolExecutorOptions::ext);
+  ASSIGN_OR_RETURN(ThreadOptions thread_options,
+                   internal::ThreadOptionsFromExecutorOptions(options));
+  if (options.use_work_stealing()) {
+    return new WorkStealingExecutor(thread_options, options.num_threads());
+  }
   return new ThreadPoolExecutor(thread_options, options.num_threads());
 }
 
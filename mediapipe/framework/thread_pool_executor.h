@@ -19,10 +19,23 @@
 #include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/port/statusor.h"
 #include "mediapipe/framework/port/threadpool.h"
+#include "mediapipe/framework/thread_pool_executor.pb.h"
 
 namespace mediapipe {
 
+namespace internal {
+
+// Validates the ThreadPoolExecutorOptions shared by the thread pool based
+// executors and converts them to ThreadOptions for the worker threads.
+absl::StatusOr<ThreadOptions> ThreadOptionsFromExecutorOptions(
+    const ThreadPoolExecutorOptions& options);
+
+}  // namespace internal
+
 // A multithreaded executor based on a thread pool.
+//
+// If ThreadPoolExecutorOptions::use_work_stealing is set, Create returns a
+// WorkStealingExecutor instead.
 class ThreadPoolExecutor : public Executor {
  public:
   static absl::StatusOr<Executor*> Create(
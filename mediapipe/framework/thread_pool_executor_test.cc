@@ -0,0 +1,90 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/framework/thread_pool_executor.h"
+
+#include <set>
+#include <string>
+
+#include "absl/flags/declare.h"
+#include "absl/flags/flag.h"
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/thread_pool_executor.pb.h"
+
+ABSL_DECLARE_FLAG(std::string, system_numa_node_cpulist_file);
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+ThreadPoolExecutorOptions OptionsWithThreads(int num_threads) {
+  ThreadPoolExecutorOptions options;
+  options.set_num_threads(num_threads);
+  return options;
+}
+
+TEST(ThreadPoolExecutorTest, PinsToCpuIds) {
+  ThreadPoolExecutorOptions options = OptionsWithThreads(2);
+  options.add_cpu_id(3);
+  options.add_cpu_id(1);
+  MP_ASSERT_OK_AND_ASSIGN(ThreadOptions thread_options,
+                          internal::ThreadOptionsFromExecutorOptions(options));
+  EXPECT_THAT(thread_options.cpu_set(), ElementsAre(1, 3));
+}
+
+TEST(ThreadPoolExecutorTest, RejectsNegativeCpuId) {
+  ThreadPoolExecutorOptions options = OptionsWithThreads(2);
+  options.add_cpu_id(-1);
+  EXPECT_FALSE(internal::ThreadOptionsFromExecutorOptions(options).ok());
+}
+
+TEST(ThreadPoolExecutorTest, RejectsMultipleCpuPinningOptions) {
+  ThreadPoolExecutorOptions options = OptionsWithThreads(2);
+  options.add_cpu_id(0);
+  options.set_numa_node(0);
+  EXPECT_FALSE(internal::ThreadOptionsFromExecutorOptions(options).ok());
+
+  options = OptionsWithThreads(2);
+  options.add_cpu_id(0);
+  options.set_require_processor_performance(ThreadPoolExecutorOptions::HIGH);
+  EXPECT_FALSE(internal::ThreadOptionsFromExecutorOptions(options).ok());
+}
+
+#if defined(__linux__)
+TEST(ThreadPoolExecutorTest, PinsToNumaNode) {
+  const std::string path =
+      file::JoinPath(::testing::TempDir(), "numa_node1_cpulist");
+  MP_ASSERT_OK(file::SetContents(path, "4-6,9\n"));
+  absl::SetFlag(&FLAGS_system_numa_node_cpulist_file,
+                file::JoinPath(::testing::TempDir(), "numa_node$0_cpulist"));
+
+  ThreadPoolExecutorOptions options = OptionsWithThreads(2);
+  options.set_numa_node(1);
+  MP_ASSERT_OK_AND_ASSIGN(ThreadOptions thread_options,
+                          internal::ThreadOptionsFromExecutorOptions(options));
+  EXPECT_THAT(thread_options.cpu_set(), ElementsAre(4, 5, 6, 9));
+
+  options.set_numa_node(2);
+  EXPECT_FALSE(internal::ThreadOptionsFromExecutorOptions(options).ok());
+}
+#endif  // defined(__linux__)
+
+}  // namespace
+}  // namespace mediapipe
@@ -3,6 +3,9 @@
 mediapipe_binary_graph() converts a graph from text format to serialized binary
 format.
 
+mediapipe_expanded_graph() also expands the subgraphs and templates of the
+graph, and outputs a serialized ExpandedGraphConfig.
+
 Example:
   mediapipe_binary_graph(
     name = "make_graph_binarypb",
@@ -63,6 +66,43 @@ def mediapipe_binary_graph(name, graph = None, output_name = None, deps = [], te
         testonly = testonly,
     )
 
+def mediapipe_expanded_graph(name, graph = None, output_name = None, deps = [], testonly = False, **kwargs):
+    """Expands a text graph ahead of time into a binary ExpandedGraphConfig.
+
+    The output can be passed to CalculatorGraph::Initialize, which then skips
+    subgraph and template expansion. deps must include the calculators and
+    subgraphs used by the graph.
+    """
+
+    if not graph:
+        fail("No input graph file specified.")
+
+    if not output_name:
+        fail("Must specify the output_name.")
+
+    native.cc_binary(
+        name = name + "_expand_graph",
+        visibility = ["//visibility:private"],
+        deps = [
+            clean_dep("//mediapipe/framework/tool:expand_graph"),
+        ] + deps,
+        tags = ["manual"],
+        testonly = testonly,
+    )
+
+    native.genrule(
+        name = name,
+        srcs = [graph],
+        outs = [output_name],
+        cmd = (
+            "$(location " + name + "_expand_graph" + ") " +
+            ("--proto_source=$(location %s) " % graph) +
+            ("--proto_output=\"$@\" ")
+        ),
+        tools = [name + "_expand_graph"],
+        testonly = testonly,
+    )
+
 def data_as_c_string(
         name,
         srcs,
@@ -0,0 +1,103 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/options_map.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/function_ref.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/tool/type_util.h"
+
+namespace mediapipe {
+namespace tool {
+
+namespace {
+
+// Holds the options parsed for the nodes currently running in the process,
+// keyed by their serialized form.
+class SharedOptionsCache {
+ public:
+  static SharedOptionsCache& Get() {
+    static SharedOptionsCache* cache = new SharedOptionsCache;
+    return *cache;
+  }
+
+  std::shared_ptr<const void> Lookup(
+      TypeId type_id, const std::string& bytes,
+      absl::FunctionRef<std::shared_ptr<const void>()> parse)
+      ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
+    std::weak_ptr<const void>& entry = entries_[{type_id, bytes}];
+    std::shared_ptr<const void> result = entry.lock();
+    if (result == nullptr) {
+      result = parse();
+      entry = result;
+      PruneExpired();
+    }
+    return result;
+  }
+
+ private:
+  // Drops the options no longer held by any node. Sweeping only when the
+  // map has doubled keeps the cost constant per insertion.
+  void PruneExpired() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    if (entries_.size() < prune_size_) return;
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      if (it->second.expired()) {
+        it = entries_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    prune_size_ = 2 * entries_.size() + 16;
+  }
+
+  absl::Mutex mutex_;
+  std::map<std::pair<TypeId, std::string>, std::weak_ptr<const void>> entries_
+      ABSL_GUARDED_BY(mutex_);
+  size_t prune_size_ ABSL_GUARDED_BY(mutex_) = 16;
+};
+
+}  // namespace
+
+std::shared_ptr<const void> GetSharedOptions(
+    TypeId type_id, const std::string& bytes,
+    absl::FunctionRef<std::shared_ptr<const void>()> parse) {
+  return SharedOptionsCache::Get().Lookup(type_id, bytes, parse);
+}
+
+void OptionsMap::ClearCache() const {
+  absl::MutexLock lock(&mutex_);
+  last_entry_.store(nullptr, std::memory_order_release);
+  entries_.clear();
+}
+
+const void* OptionsMap::Resolve(TypeId type_id,
+                                absl::FunctionRef<CacheEntry()> resolve) const {
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(type_id);
+  if (it == entries_.end()) {
+    it = entries_.emplace(type_id, resolve()).first;
+  }
+  last_entry_.store(&it->second, std::memory_order_release);
+  return it->second.options;
+}
+
+}  // namespace tool
+}  // namespace mediapipe
@@ -1,10 +1,15 @@
 #ifndef MEDIAPIPE_FRAMEWORK_TOOL_OPTIONS_MAP_H_
 #define MEDIAPIPE_FRAMEWORK_TOOL_OPTIONS_MAP_H_
 
+#include <atomic>
 #include <map>
 #include <memory>
+#include <string>
 #include <type_traits>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/function_ref.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/port/any_proto.h"
 #include "mediapipe/framework/port/status.h"
@@ -80,6 +85,41 @@ void SetNodeOptions(CalculatorGraphConfig::Node& node_config, const T& value) {
 #endif
 }
 
+// Returns the options of type `type_id` serialized as `bytes`, parsing them
+// with `parse` only if no other node holds identical options. This lets the
+// instances of a graph created many times share one parsed copy.
+std::shared_ptr<const void> GetSharedOptions(
+    TypeId type_id, const std::string& bytes,
+    absl::FunctionRef<std::shared_ptr<const void>()> parse);
+
+// Returns the options message of type T from the "node_options" of a
+// CalculatorGraphConfig::Node, shared among nodes with identical options.
+template <class T>
+std::shared_ptr<const T> GetSharedNodeOptions(
+    const CalculatorGraphConfig::Node& node_config) {
+#if defined(MEDIAPIPE_PROTO_LITE) && defined(MEDIAPIPE_PROTO_THIRD_PARTY)
+  // protobuf::Any is unavailable with third_party/protobuf:protobuf-lite.
+  return std::make_shared<const T>();
+#else
+  // As in GetNodeOptions, the last matching entry wins.
+  const mediapipe::protobuf::Any* packed = nullptr;
+  for (const mediapipe::protobuf::Any& options : node_config.node_options()) {
+    if (options.Is<T>()) {
+      packed = &options;
+    }
+  }
+  if (packed == nullptr) {
+    return std::make_shared<const T>();
+  }
+  return std::static_pointer_cast<const T>(
+      GetSharedOptions(kTypeId<T>, packed->value(), [packed] {
+        auto result = std::make_shared<T>();
+        packed->UnpackTo(result.get());
+        return std::shared_ptr<const void>(std::move(result));
+      }));
+#endif
+}
+
 // A map from object type to object.
 class TypeMap {
  public:
@@ -89,10 +129,11 @@ class TypeMap {
   }
   template <class T>
   T* Get() const {
-    if (!Has<T>()) {
-      content_[kTypeId<T>] = std::make_shared<T>();
+    std::shared_ptr<void>& object = content_[kTypeId<T>];
+    if (object == nullptr) {
+      object = std::make_shared<T>();
     }
-    return static_cast<T*>(content_[kTypeId<T>].get());
+    return static_cast<T*>(object.get());
   }
 
  private:
@@ -101,10 +142,28 @@ class TypeMap {
 
 // Extracts the options message of a specified type from a
 // CalculatorGraphConfig::Node.
+//
+// Each options type is resolved once, and the most recently resolved type is
+// then returned by Get() with a single atomic load, so calculators can read
+// their options in Process() without cost. Get() is thread-safe, but the
+// CalculatorGraphConfig::Node must outlive the OptionsMap.
 class OptionsMap {
  public:
+  OptionsMap() = default;
+  // Copies refer to the same CalculatorGraphConfig::Node and resolve their
+  // options again.
+  OptionsMap(const OptionsMap& other)
+      : node_config_(other.node_config_), options_(other.options_) {}
+  OptionsMap& operator=(const OptionsMap& other) {
+    node_config_ = other.node_config_;
+    options_ = other.options_;
+    ClearCache();
+    return *this;
+  }
+
   OptionsMap& Initialize(const CalculatorGraphConfig::Node& node_config) {
     node_config_ = const_cast<CalculatorGraphConfig::Node*>(&node_config);
+    ClearCache();
     return *this;
   }
 
@@ -112,20 +171,60 @@ class OptionsMap {
   // either "options" or "node_options" using either GetExtension or UnpackTo.
   template <class T>
   const T& Get() const {
+    const CacheEntry* last = last_entry_.load(std::memory_order_acquire);
+    if (last != nullptr && last->type_id == kTypeId<T>) {
+      return *static_cast<const T*>(last->options);
+    }
+    return *static_cast<const T*>(Resolve(kTypeId<T>, [this] {
+      return ResolveOptions<T>();
+    }));
+  }
+
+  CalculatorGraphConfig::Node* node_config_ = nullptr;
+  TypeMap options_;
+
+ protected:
+  // Forgets the resolved options, after the CalculatorGraphConfig::Node or
+  // options_ has changed.
+  void ClearCache() const;
+
+ private:
+  struct CacheEntry {
+    TypeId type_id;
+    const void* options;
+    // Owns *options, unless it points into node_config_ or options_.
+    std::shared_ptr<const void> holder;
+  };
+
+  // Returns the options resolved for `type_id`, calling `resolve` the first
+  // time the type is requested.
+  const void* Resolve(TypeId type_id,
+                      absl::FunctionRef<CacheEntry()> resolve) const;
+
+  template <class T>
+  CacheEntry ResolveOptions() const {
     if (options_.Has<T>()) {
-      return *options_.Get<T>();
+      return {kTypeId<T>, options_.Get<T>(), nullptr};
     }
-    T* result = options_.Get<T>();
     if (node_config_->has_options()) {
-      GetExtension(node_config_->options(), result);
-    } else {
-      GetNodeOptions(*node_config_, result);
+      // Extensions are parsed along with the config, so they are returned in
+      // place rather than copied.
+      const T* extension = GetExtension<T>(
+          *const_cast<CalculatorOptions*>(&node_config_->options()));
+      if (extension != nullptr) {
+        return {kTypeId<T>, extension, nullptr};
+      }
+      auto empty = std::make_shared<const T>();
+      return {kTypeId<T>, empty.get(), empty};
     }
-    return *result;
+    std::shared_ptr<const T> shared = GetSharedNodeOptions<T>(*node_config_);
+    return {kTypeId<T>, shared.get(), shared};
   }
 
-  CalculatorGraphConfig::Node* node_config_;
-  TypeMap options_;
+  mutable absl::Mutex mutex_;
+  // Entries are never moved, so last_entry_ can point into the map.
+  mutable std::map<TypeId, CacheEntry> entries_ ABSL_GUARDED_BY(mutex_);
+  mutable std::atomic<const CacheEntry*> last_entry_{nullptr};
 };
 
 class MutableOptionsMap : public OptionsMap {
@@ -136,6 +235,7 @@ class MutableOptionsMap : public OptionsMap {
   }
   template <class T>
   void Set(const T& value) const {
+    ClearCache();
     *options_.Get<T>() = value;
     if (node_config_->has_options()) {
       *GetExtension<T>(*node_config_->mutable_options()) = value;
@@ -146,6 +246,7 @@ class MutableOptionsMap : public OptionsMap {
 
   template <class T>
   T* GetMutable() const {
+    ClearCache();
     if (options_.Has<T>()) {
       return options_.Get<T>();
     }
@@ -0,0 +1,96 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/options_map.h"
+
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/tool/node_chain_subgraph.pb.h"
+
+namespace mediapipe {
+namespace tool {
+namespace {
+
+CalculatorGraphConfig::Node NodeWithExtension() {
+  CalculatorGraphConfig::Node node;
+  node.set_calculator("NodeChainSubgraph");
+  node.mutable_options()
+      ->MutableExtension(NodeChainSubgraphOptions::ext)
+      ->set_chain_length(3);
+  return node;
+}
+
+CalculatorGraphConfig::Node NodeWithNodeOptions(int chain_length) {
+  CalculatorGraphConfig::Node node;
+  node.set_calculator("NodeChainSubgraph");
+  NodeChainSubgraphOptions options;
+  options.set_chain_length(chain_length);
+  node.add_node_options()->PackFrom(options);
+  return node;
+}
+
+TEST(OptionsMapTest, ReturnsExtensionInPlace) {
+  CalculatorGraphConfig::Node node = NodeWithExtension();
+  OptionsMap options_map;
+  options_map.Initialize(node);
+  const auto& options = options_map.Get<NodeChainSubgraphOptions>();
+  EXPECT_EQ(options.chain_length(), 3);
+  EXPECT_EQ(&options,
+            &node.options().GetExtension(NodeChainSubgraphOptions::ext));
+  EXPECT_EQ(&options_map.Get<NodeChainSubgraphOptions>(), &options);
+}
+
+TEST(OptionsMapTest, ReturnsDefaultWhenAbsent) {
+  CalculatorGraphConfig::Node node;
+  OptionsMap options_map;
+  options_map.Initialize(node);
+  EXPECT_FALSE(options_map.Get<NodeChainSubgraphOptions>().has_chain_length());
+}
+
+TEST(OptionsMapTest, SharesNodeOptionsAcrossIdenticalNodes) {
+  CalculatorGraphConfig::Node node_1 = NodeWithNodeOptions(3);
+  CalculatorGraphConfig::Node node_2 = NodeWithNodeOptions(3);
+  CalculatorGraphConfig::Node node_3 = NodeWithNodeOptions(4);
+  OptionsMap map_1, map_2, map_3;
+  map_1.Initialize(node_1);
+  map_2.Initialize(node_2);
+  map_3.Initialize(node_3);
+  const auto& options_1 = map_1.Get<NodeChainSubgraphOptions>();
+  const auto& options_2 = map_2.Get<NodeChainSubgraphOptions>();
+  const auto& options_3 = map_3.Get<NodeChainSubgraphOptions>();
+  EXPECT_EQ(options_1.chain_length(), 3);
+  EXPECT_EQ(&options_1, &options_2);
+  EXPECT_EQ(options_3.chain_length(), 4);
+  EXPECT_NE(&options_1, &options_3);
+}
+
+TEST(OptionsMapTest, MutableOptionsMapSeesChanges) {
+  CalculatorGraphConfig::Node node = NodeWithNodeOptions(3);
+  MutableOptionsMap options_map;
+  options_map.Initialize(node);
+  EXPECT_EQ(options_map.Get<NodeChainSubgraphOptions>().chain_length(), 3);
+
+  NodeChainSubgraphOptions options;
+  options.set_chain_length(5);
+  options_map.Set(options);
+  EXPECT_EQ(options_map.Get<NodeChainSubgraphOptions>().chain_length(), 5);
+
+  options_map.GetMutable<NodeChainSubgraphOptions>()->set_chain_length(6);
+  EXPECT_EQ(options_map.Get<NodeChainSubgraphOptions>().chain_length(), 6);
+}
+
+}  // namespace
+}  // namespace tool
+}  // namespace mediapipe
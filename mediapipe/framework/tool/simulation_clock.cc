@@ -41,14 +41,19 @@ void SimulationClock::SleepUntil(absl::Time wakeup_time) {
 }
 
 void SimulationClock::SleepInternal(absl::Time wakeup_time) {
+  if (wakeup_mode_ == WakeupMode::kConcurrent && wakeup_time <= time_) {
+    // Work due at the current time does not wait for other threads.
+    return;
+  }
   Waiter waiter;
   waiters_.insert({wakeup_time, &waiter});
   num_running_--;
   TryAdvanceTime();
+  // The waking thread counts this thread as running again, so that time
+  // cannot advance before it is scheduled.
   while (waiter.sleeping) {
     waiter.cond.Wait(&time_mutex_);
   }
-  num_running_++;
 }
 
 void SimulationClock::ThreadStart() {
@@ -67,11 +72,21 @@ void SimulationClock::TryAdvanceTime() {
     VLOG(2) << "Advance time from: " << absl::ToUnixMicros(time_)
             << " to: " << absl::ToUnixMicros(waiters_.begin()->first);
     time_ = waiters_.begin()->first;
-    Waiter* waiter = waiters_.begin()->second;
-    waiters_.erase(waiters_.begin());
-    waiter->sleeping = false;
-    waiter->cond.Signal();
+    WakeFirstWaiter();
+    if (wakeup_mode_ == WakeupMode::kConcurrent) {
+      while (!waiters_.empty() && waiters_.begin()->first <= time_) {
+        WakeFirstWaiter();
+      }
+    }
   }
 }
 
+void SimulationClock::WakeFirstWaiter() {
+  Waiter* waiter = waiters_.begin()->second;
+  waiters_.erase(waiters_.begin());
+  num_running_++;
+  waiter->sleeping = false;
+  waiter->cond.Signal();
+}
+
 }  // namespace mediapipe
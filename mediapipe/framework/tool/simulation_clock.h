@@ -36,9 +36,24 @@ namespace mediapipe {
 // to continue until all earlier threads have finished or entered Sleep.
 // The result is a single well-defined order of events.  Any desired
 // order of events can be defined by adjusting the precise sleep times.
+//
+// With WakeupMode::kConcurrent, all threads due at the current time run in
+// parallel instead.  Simulated time is still deterministic, since it only
+// advances once every thread has finished or gone back to sleep, but the
+// order of events at the same time is not.
 class SimulationClock : public mediapipe::Clock {
  public:
+  // Controls how threads due at the same simulated time are run.
+  enum class WakeupMode {
+    // Threads wake one at a time, in the order in which they called Sleep().
+    kSequential,
+    // Threads due at the current time all run concurrently.
+    kConcurrent,
+  };
+
   SimulationClock() {}
+  explicit SimulationClock(WakeupMode wakeup_mode)
+      : wakeup_mode_(wakeup_mode) {}
   ~SimulationClock() override;
 
   // Returns the simulated time.
@@ -62,6 +77,8 @@ class SimulationClock : public mediapipe::Clock {
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(time_mutex_);
   // Advances to the next wake up time if no related threads are running.
   void TryAdvanceTime() ABSL_EXCLUSIVE_LOCKS_REQUIRED(time_mutex_);
+  // Wakes the earliest waiter and counts it as running.
+  void WakeFirstWaiter() ABSL_EXCLUSIVE_LOCKS_REQUIRED(time_mutex_);
 
   // Represents a thread blocked in SleepUntil.
   struct Waiter {
@@ -74,6 +91,7 @@ class SimulationClock : public mediapipe::Clock {
   absl::Time time_ ABSL_GUARDED_BY(time_mutex_);
   std::multimap<absl::Time, Waiter*> waiters_ ABSL_GUARDED_BY(time_mutex_);
   int num_running_ ABSL_GUARDED_BY(time_mutex_) = 0;
+  const WakeupMode wakeup_mode_ = WakeupMode::kSequential;
 };
 
 }  // namespace mediapipe
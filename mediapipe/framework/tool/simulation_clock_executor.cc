@@ -18,8 +18,9 @@
 
 namespace mediapipe {
 
-SimulationClockExecutor::SimulationClockExecutor(int num_threads)
-    : clock_(new SimulationClock()), executor_(num_threads) {}
+SimulationClockExecutor::SimulationClockExecutor(
+    int num_threads, SimulationClock::WakeupMode wakeup_mode)
+    : clock_(new SimulationClock(wakeup_mode)), executor_(num_threads) {}
 
 void SimulationClockExecutor::Schedule(std::function<void()> task) {
   clock_->ThreadStart();
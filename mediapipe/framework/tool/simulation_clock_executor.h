@@ -23,9 +23,16 @@ namespace mediapipe {
 // Simulation clock multithreaded executor. This is intended to be used with
 // graphs that are using SimulationClock class to emulate various parts of the
 // graph taking specific time to process the incoming packets.
+//
+// By default tasks run one at a time in a deterministic order.  With
+// SimulationClock::WakeupMode::kConcurrent, tasks due at the same simulated
+// time run in parallel on the thread pool, and simulated time advances as soon
+// as all of them have completed or gone to sleep.
 class SimulationClockExecutor : public Executor {
  public:
-  explicit SimulationClockExecutor(int num_threads);
+  explicit SimulationClockExecutor(
+      int num_threads, SimulationClock::WakeupMode wakeup_mode =
+                           SimulationClock::WakeupMode::kSequential);
   void Schedule(std::function<void()> task) override;
 
   // Returns a pointer to the instance of SimulationClock used by
@@ -21,6 +21,8 @@
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/input_stream.h"
@@ -176,6 +178,74 @@ TEST_F(SimulationClockTest, DuplicateWakeTimes) {
   EXPECT_THAT(start_counts, ElementsAre(3, 2, 3, 1, 2, 3, 1, 2, 1));
 }
 
+// In concurrent mode, threads due at the same time run in parallel, while
+// simulated time still advances deterministically.
+TEST_F(SimulationClockTest, ConcurrentWakeTimes) {
+  absl::Mutex mutex;
+  std::vector<absl::Time> start_times;
+  auto executor = std::make_shared<SimulationClockExecutor>(
+      4, SimulationClock::WakeupMode::kConcurrent);
+  simulation_clock_ = executor->GetClock();
+  clock_ = simulation_clock_.get();
+  std::function<void(int)> run_chain = [&](int count) {
+    if (count > 0) {
+      {
+        absl::MutexLock lock(&mutex);
+        start_times.push_back(clock_->TimeNow());
+      }
+      clock_->Sleep(absl::Microseconds(10000));
+      run_chain(count - 1);
+    }
+  };
+  simulation_clock_->ThreadStart();
+  for (int i = 0; i < 3; i++) {
+    executor->Schedule([&] { run_chain(3); });
+    clock_->Sleep(absl::Microseconds(10000));
+  }
+  clock_->Sleep(absl::Microseconds(100000));
+  simulation_clock_->ThreadFinish();
+  absl::MutexLock lock(&mutex);
+  EXPECT_THAT(
+      TimeValues(start_times),
+      ElementsAre(0, 10000, 10000, 20000, 20000, 20000, 30000, 30000, 40000));
+}
+
+// Tasks due at the same time can only all start if they run concurrently.
+TEST_F(SimulationClockTest, ConcurrentTasksOverlap) {
+  auto executor = std::make_shared<SimulationClockExecutor>(
+      3, SimulationClock::WakeupMode::kConcurrent);
+  simulation_clock_ = executor->GetClock();
+  clock_ = simulation_clock_.get();
+  absl::Mutex mutex;
+  int num_started = 0;
+  int num_overlapped = 0;
+  std::vector<absl::Time> end_times;
+  simulation_clock_->ThreadStart();
+  for (int i = 0; i < 3; ++i) {
+    executor->Schedule([&] {
+      {
+        absl::MutexLock lock(&mutex);
+        ++num_started;
+        if (mutex.AwaitWithTimeout(
+                absl::Condition(
+                    +[](int* num_started) { return *num_started == 3; },
+                    &num_started),
+                absl::Seconds(10))) {
+          ++num_overlapped;
+        }
+      }
+      clock_->Sleep(absl::Microseconds(5000));
+      absl::MutexLock lock(&mutex);
+      end_times.push_back(clock_->TimeNow());
+    });
+  }
+  clock_->Sleep(absl::Microseconds(100000));
+  simulation_clock_->ThreadFinish();
+  absl::MutexLock lock(&mutex);
+  EXPECT_EQ(num_overlapped, 3);
+  EXPECT_THAT(TimeValues(end_times), ElementsAre(5000, 5000, 5000));
+}
+
 // A Calculator::Process callback function.
 typedef std::function<absl::Status(const InputStreamShardSet&,
                                    OutputStreamShardSet*)>
@@ -15,6 +15,7 @@
 #include "mediapipe/framework/tool/subgraph_expansion.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
@@ -23,8 +24,11 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/graph_service_manager.h"
 #include "mediapipe/framework/packet_generator.pb.h"
 #include "mediapipe/framework/port.h"
@@ -132,19 +136,49 @@ absl::Status TransformNames(
 //   2, { foo, bar }  --PrefixNames-> { rsg__foo, rsg__bar }
 // This means that two copies of the same subgraph will not interfere with
 // each other.
-static absl::Status PrefixNames(std::string prefix,
+// Returns the prefix for the names inside the subgraph node named |node_name|.
+static std::string SubgraphPrefix(std::string node_name) {
+  std::transform(node_name.begin(), node_name.end(), node_name.begin(),
+                 ::tolower);
+  std::replace(node_name.begin(), node_name.end(), '.', '_');
+  std::replace(node_name.begin(), node_name.end(), ' ', '_');
+  std::replace(node_name.begin(), node_name.end(), ':', '_');
+  absl::StrAppend(&node_name, "__");
+  return node_name;
+}
+
+static absl::Status PrefixNames(const std::string& prefix,
                                 CalculatorGraphConfig* config) {
-  std::transform(prefix.begin(), prefix.end(), prefix.begin(), ::tolower);
-  std::replace(prefix.begin(), prefix.end(), '.', '_');
-  std::replace(prefix.begin(), prefix.end(), ' ', '_');
-  std::replace(prefix.begin(), prefix.end(), ':', '_');
-  absl::StrAppend(&prefix, "__");
   auto add_prefix = [&prefix](absl::string_view s) {
     return absl::StrCat(prefix, s);
   };
   return TransformNames(config, add_prefix);
 }
 
+// Executors declared by a subgraph are moved to the enclosing graph, with their
+// names prefixed like the node names so that every instance of the subgraph
+// gets its own executors. Nodes referring to an executor of the enclosing
+// graph are left alone.
+static absl::Status PrefixExecutorNames(const std::string& prefix,
+                                        CalculatorGraphConfig* config) {
+  std::map<std::string, std::string> executor_names;
+  for (auto& executor : *config->mutable_executor()) {
+    RET_CHECK(!executor.name().empty())
+        << "A subgraph can't configure the default executor.";
+    std::string prefixed_name = absl::StrCat(prefix, executor.name());
+    executor_names[executor.name()] = prefixed_name;
+    executor.set_name(std::move(prefixed_name));
+  }
+  for (auto& node : *config->mutable_node()) {
+    const std::string* prefixed_name =
+        mediapipe::FindOrNull(executor_names, node.executor());
+    if (prefixed_name) {
+      node.set_executor(*prefixed_name);
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::Status FindCorrespondingStreams(
     std::map<std::string, std::string>* stream_map,
     const proto_ns::RepeatedPtrField<ProtoString>& src_streams,
@@ -181,14 +215,13 @@ absl::Status FindCorrespondingStreams(
 
 // The following fields can be used in a Node message for a subgraph:
 //   name, calculator, input_stream, output_stream, input_side_packet,
-//   output_side_packet, options.
+//   output_side_packet, options, executor, max_in_flight.
 // All other fields are only applicable to calculators.
 absl::Status ValidateSubgraphFields(
     const CalculatorGraphConfig::Node& subgraph_node) {
   if (subgraph_node.source_layer() || subgraph_node.buffer_size_hint() ||
       subgraph_node.has_output_stream_handler() ||
-      subgraph_node.input_stream_info_size() != 0 ||
-      !subgraph_node.executor().empty()) {
+      subgraph_node.input_stream_info_size() != 0) {
     return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
            << "Subgraph \"" << subgraph_node.name()
            << "\" has a field that is only applicable to calculators.";
@@ -272,16 +305,107 @@ absl::Status ConnectSubgraphStreams(
   return absl::OkStatus();
 }
 
-absl::Status ExpandSubgraphs(CalculatorGraphConfig* config,
-                             const GraphRegistry* graph_registry,
-                             const Subgraph::SubgraphOptions* graph_options,
-                             const GraphServiceManager* service_manager) {
-  graph_registry =
-      graph_registry ? graph_registry : &GraphRegistry::global_graph_registry;
-  RET_CHECK(config);
+// The max_in_flight of a subgraph node applies to every node of the subgraph
+// that doesn't set its own, so that a stateless subgraph, such as the body of
+// a loop between BeginLoopCalculator and EndLoopCalculator, can process
+// several timestamps concurrently.
+static void ApplySubgraphMaxInFlight(
+    const CalculatorGraphConfig::Node& subgraph_node,
+    CalculatorGraphConfig* subgraph_config) {
+  if (subgraph_node.max_in_flight() <= 1) return;
+  for (auto& node : *subgraph_config->mutable_node()) {
+    if (node.max_in_flight() == 0) {
+      node.set_max_in_flight(subgraph_node.max_in_flight());
+    }
+  }
+}
 
-  MP_RETURN_IF_ERROR(mediapipe::tool::DefineGraphOptions(
-      graph_options ? *graph_options : CalculatorGraphConfig::Node(), config));
+// The executor of a subgraph node applies to every node of the subgraph that
+// doesn't set its own, so that independent branches of a graph, each wrapped
+// in a subgraph, can run concurrently on their own executors.
+static void ApplySubgraphExecutor(
+    const CalculatorGraphConfig::Node& subgraph_node,
+    CalculatorGraphConfig* subgraph_config) {
+  if (subgraph_node.executor().empty()) return;
+  for (auto& node : *subgraph_config->mutable_node()) {
+    if (node.executor().empty()) {
+      node.set_executor(subgraph_node.executor());
+    }
+  }
+}
+
+namespace {
+
+// Memoizes expanded configs for the process, see
+// SetSubgraphExpansionCacheCapacity().
+class ExpansionCache {
+ public:
+  static ExpansionCache& Get() {
+    static ExpansionCache* cache = new ExpansionCache;
+    return *cache;
+  }
+
+  void SetCapacity(int capacity) ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
+    capacity_ = std::max(capacity, 0);
+    if (entries_.size() > capacity_) entries_.clear();
+  }
+
+  bool enabled() const ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
+    return capacity_ > 0;
+  }
+
+  // Copies the config expanded for `key` into `config`, if any.
+  bool Lookup(const std::string& key, CalculatorGraphConfig* config)
+      ABSL_LOCKS_EXCLUDED(mutex_) {
+    std::shared_ptr<const CalculatorGraphConfig> expanded;
+    {
+      absl::MutexLock lock(&mutex_);
+      auto it = entries_.find(key);
+      if (it == entries_.end()) return false;
+      expanded = it->second;
+    }
+    *config = *expanded;
+    return true;
+  }
+
+  void Insert(std::string key, const CalculatorGraphConfig& config)
+      ABSL_LOCKS_EXCLUDED(mutex_) {
+    auto expanded = std::make_shared<const CalculatorGraphConfig>(config);
+    absl::MutexLock lock(&mutex_);
+    if (capacity_ == 0) return;
+    // Rather than tracking recency, start over when full: a service creates
+    // graphs from a handful of configs, which are back after one miss each.
+    if (entries_.size() >= capacity_) entries_.clear();
+    entries_[std::move(key)] = std::move(expanded);
+  }
+
+ private:
+  mutable absl::Mutex mutex_;
+  size_t capacity_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::flat_hash_map<std::string, std::shared_ptr<const CalculatorGraphConfig>>
+      entries_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Returns the cache key for expanding `config` with `graph_options` against
+// registrations of the given generation.
+std::string ExpansionCacheKey(const CalculatorGraphConfig& config,
+                              const Subgraph::SubgraphOptions& graph_options,
+                              int64_t generation) {
+  const std::string options = graph_options.SerializeAsString();
+  return absl::StrCat(generation, ":", options.size(), ":", options,
+                      config.SerializeAsString());
+}
+
+// Expands subgraphs without memoization. Sets `*service_requested` if any
+// subgraph asked for a graph service.
+absl::Status ExpandSubgraphsUncached(
+    CalculatorGraphConfig* config, const GraphRegistry* graph_registry,
+    const Subgraph::SubgraphOptions& graph_options,
+    const GraphServiceManager* service_manager, bool* service_requested) {
+  MP_RETURN_IF_ERROR(
+      mediapipe::tool::DefineGraphOptions(graph_options, config));
   auto* nodes = config->mutable_node();
   while (1) {
     auto subgraph_nodes_start = std::stable_partition(
@@ -301,9 +425,14 @@ absl::Status ExpandSubgraphs(CalculatorGraphConfig* config,
       ASSIGN_OR_RETURN(auto subgraph, graph_registry->CreateByName(
                                           config->package(), node.calculator(),
                                           &subgraph_context));
+      *service_requested |= subgraph_context.service_requested();
       MP_RETURN_IF_ERROR(mediapipe::tool::DefineGraphOptions(node, &subgraph));
-      MP_RETURN_IF_ERROR(PrefixNames(node_name, &subgraph));
+      const std::string prefix = SubgraphPrefix(node_name);
+      MP_RETURN_IF_ERROR(PrefixNames(prefix, &subgraph));
+      MP_RETURN_IF_ERROR(PrefixExecutorNames(prefix, &subgraph));
       MP_RETURN_IF_ERROR(ConnectSubgraphStreams(node, &subgraph));
+      ApplySubgraphMaxInFlight(node, &subgraph);
+      ApplySubgraphExecutor(node, &subgraph);
       subgraphs.push_back(subgraph);
     }
     nodes->erase(subgraph_nodes_start, nodes->end());
@@ -314,6 +443,9 @@ absl::Status ExpandSubgraphs(CalculatorGraphConfig* config,
                 subgraph.packet_generator().end(),
                 proto_ns::RepeatedPtrFieldBackInserter(
                     config->mutable_packet_generator()));
+      std::copy(subgraph.executor().begin(), subgraph.executor().end(),
+                proto_ns::RepeatedPtrFieldBackInserter(
+                    config->mutable_executor()));
       std::copy(subgraph.status_handler().begin(),
                 subgraph.status_handler().end(),
                 proto_ns::RepeatedPtrFieldBackInserter(
@@ -323,6 +455,43 @@ absl::Status ExpandSubgraphs(CalculatorGraphConfig* config,
   return absl::OkStatus();
 }
 
+}  // namespace
+
+void SetSubgraphExpansionCacheCapacity(int capacity) {
+  ExpansionCache::Get().SetCapacity(capacity);
+}
+
+absl::Status ExpandSubgraphs(CalculatorGraphConfig* config,
+                             const GraphRegistry* graph_registry,
+                             const Subgraph::SubgraphOptions* graph_options,
+                             const GraphServiceManager* service_manager) {
+  graph_registry =
+      graph_registry ? graph_registry : &GraphRegistry::global_graph_registry;
+  RET_CHECK(config);
+  const Subgraph::SubgraphOptions default_options;
+  const Subgraph::SubgraphOptions& options =
+      graph_options ? *graph_options : default_options;
+  bool service_requested = false;
+
+  // Local graph registries are created per graph, so only expansions against
+  // the global registry are worth memoizing.
+  ExpansionCache& cache = ExpansionCache::Get();
+  if (graph_registry != &GraphRegistry::global_graph_registry ||
+      !cache.enabled()) {
+    return ExpandSubgraphsUncached(config, graph_registry, options,
+                                   service_manager, &service_requested);
+  }
+  std::string key =
+      ExpansionCacheKey(*config, options, graph_registry->generation());
+  if (cache.Lookup(key, config)) return absl::OkStatus();
+  MP_RETURN_IF_ERROR(ExpandSubgraphsUncached(
+      config, graph_registry, options, service_manager, &service_requested));
+  // The expansion may depend on the service objects, which are not part of
+  // the key.
+  if (!service_requested) cache.Insert(std::move(key), *config);
+  return absl::OkStatus();
+}
+
 CalculatorGraphConfig MakeSingleNodeGraph(CalculatorGraphConfig::Node node) {
   using RepeatedStringField = proto_ns::RepeatedPtrField<ProtoString>;
   struct Connections {
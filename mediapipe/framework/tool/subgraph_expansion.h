@@ -75,6 +75,17 @@ absl::Status ExpandSubgraphs(
     const Subgraph::SubgraphOptions* graph_options = nullptr,
     const GraphServiceManager* service_manager = nullptr);
 
+// Sets the number of expanded configs that ExpandSubgraphs memoizes for the
+// process; 0, the default, disables memoization. Creating many graphs from the
+// same config, e.g. one per request, then expands its subgraphs only once.
+//
+// Memoized expansions are keyed by the config, the graph options and the
+// registrations of the global graph registry, so registering or unregistering
+// a subgraph invalidates them. Expansions against other graph registries, and
+// expansions in which a subgraph asked for a graph service, are not memoized.
+// Subgraphs must otherwise derive their config from their options alone.
+void SetSubgraphExpansionCacheCapacity(int capacity);
+
 // Creates a graph wrapping the provided node and exposing all of its
 // connections
 CalculatorGraphConfig MakeSingleNodeGraph(
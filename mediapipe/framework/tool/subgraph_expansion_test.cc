@@ -192,6 +192,41 @@ class EnclosingSubgraph : public Subgraph {
 };
 REGISTER_MEDIAPIPE_GRAPH(EnclosingSubgraph);
 
+// A subgraph used in the ExecutorsOfSubgraphHoisted test. The subgraph
+// declares its own executor and also uses one of the enclosing graph.
+class ExecutorDeclaringSubgraph : public Subgraph {
+ public:
+  absl::StatusOr<CalculatorGraphConfig> GetConfig(
+      const SubgraphOptions& options) override {
+    CalculatorGraphConfig config =
+        mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+          input_stream: "INPUT:foo"
+          output_stream: "OUTPUT:baz"
+          executor {
+            name: "branch"
+            type: "ThreadPoolExecutor"
+            options {
+              [mediapipe.ThreadPoolExecutorOptions.ext] { num_threads: 1 }
+            }
+          }
+          node {
+            calculator: "PassThroughCalculator"
+            input_stream: "foo"
+            output_stream: "bar"
+            executor: "branch"
+          }
+          node {
+            calculator: "PassThroughCalculator"
+            input_stream: "bar"
+            output_stream: "baz"
+            executor: "custom_thread_pool"
+          }
+        )pb");
+    return config;
+  }
+};
+REGISTER_MEDIAPIPE_GRAPH(ExecutorDeclaringSubgraph);
+
 TEST(SubgraphExpansionTest, TransformStreamNames) {
   CalculatorGraphConfig config =
       mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
@@ -527,6 +562,142 @@ TEST(SubgraphExpansionTest, ExecutorFieldOfNodeInSubgraphPreserved) {
   EXPECT_THAT(supergraph, mediapipe::EqualsProto(expected_graph));
 }
 
+// The max_in_flight of a subgraph node is applied to the nodes of nested
+// subgraphs.
+TEST(SubgraphExpansionTest, MaxInFlightOfSubgraphNodeApplied) {
+  CalculatorGraphConfig supergraph =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input"
+        node {
+          calculator: "EnclosingSubgraph"
+          input_stream: "IN:input"
+          output_stream: "OUT:output"
+          max_in_flight: 3
+        }
+      )pb");
+  CalculatorGraphConfig expected_graph = mediapipe::ParseTextProtoOrDie<
+      CalculatorGraphConfig>(R"pb(
+    input_stream: "input"
+    node {
+      calculator: "PassThroughCalculator"
+      name: "enclosingsubgraph__nodewithexecutorsubgraph__PassThroughCalculator"
+      input_stream: "input"
+      output_stream: "output"
+      executor: "custom_thread_pool"
+      max_in_flight: 3
+    }
+  )pb");
+  MP_EXPECT_OK(tool::ExpandSubgraphs(&supergraph));
+  EXPECT_THAT(supergraph, mediapipe::EqualsProto(expected_graph));
+}
+
+// The executor of a subgraph node is applied to the nodes of the subgraph that
+// don't set their own executor.
+TEST(SubgraphExpansionTest, ExecutorOfSubgraphNodeApplied) {
+  CalculatorGraphConfig supergraph =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input"
+        node {
+          calculator: "NodeChainSubgraph"
+          input_stream: "INPUT:input"
+          output_stream: "OUTPUT:chain_output"
+          executor: "branch_thread_pool"
+          options {
+            [mediapipe.NodeChainSubgraphOptions.ext] {
+              node_type: "DoubleIntCalculator"
+              chain_length: 2
+            }
+          }
+        }
+        node {
+          calculator: "EnclosingSubgraph"
+          input_stream: "IN:input"
+          output_stream: "OUT:output"
+          executor: "branch_thread_pool"
+        }
+      )pb");
+  MP_ASSERT_OK(tool::ExpandSubgraphs(&supergraph));
+  ASSERT_EQ(supergraph.node_size(), 3);
+  for (const auto& node : supergraph.node()) {
+    if (node.calculator() == "DoubleIntCalculator") {
+      EXPECT_EQ(node.executor(), "branch_thread_pool");
+    } else {
+      // The executor of the node inside the subgraph takes precedence.
+      EXPECT_EQ(node.calculator(), "PassThroughCalculator");
+      EXPECT_EQ(node.executor(), "custom_thread_pool");
+    }
+  }
+}
+
+// The executors declared by a subgraph are moved to the enclosing graph and
+// prefixed, so that two instances of the subgraph don't share them.
+TEST(SubgraphExpansionTest, ExecutorsOfSubgraphHoisted) {
+  CalculatorGraphConfig supergraph =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input"
+        node {
+          name: "first"
+          calculator: "ExecutorDeclaringSubgraph"
+          input_stream: "INPUT:input"
+          output_stream: "OUTPUT:output_1"
+        }
+        node {
+          name: "second"
+          calculator: "ExecutorDeclaringSubgraph"
+          input_stream: "INPUT:input"
+          output_stream: "OUTPUT:output_2"
+        }
+      )pb");
+  CalculatorGraphConfig expected_graph =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input"
+        executor {
+          name: "first__branch"
+          type: "ThreadPoolExecutor"
+          options {
+            [mediapipe.ThreadPoolExecutorOptions.ext] { num_threads: 1 }
+          }
+        }
+        executor {
+          name: "second__branch"
+          type: "ThreadPoolExecutor"
+          options {
+            [mediapipe.ThreadPoolExecutorOptions.ext] { num_threads: 1 }
+          }
+        }
+        node {
+          name: "first__PassThroughCalculator_1"
+          calculator: "PassThroughCalculator"
+          input_stream: "input"
+          output_stream: "first__bar"
+          executor: "first__branch"
+        }
+        node {
+          name: "first__PassThroughCalculator_2"
+          calculator: "PassThroughCalculator"
+          input_stream: "first__bar"
+          output_stream: "output_1"
+          executor: "custom_thread_pool"
+        }
+        node {
+          name: "second__PassThroughCalculator_1"
+          calculator: "PassThroughCalculator"
+          input_stream: "input"
+          output_stream: "second__bar"
+          executor: "second__branch"
+        }
+        node {
+          name: "second__PassThroughCalculator_2"
+          calculator: "PassThroughCalculator"
+          input_stream: "second__bar"
+          output_stream: "output_2"
+          executor: "custom_thread_pool"
+        }
+      )pb");
+  MP_EXPECT_OK(tool::ExpandSubgraphs(&supergraph));
+  EXPECT_THAT(supergraph, mediapipe::EqualsProto(expected_graph));
+}
+
 const mediapipe::GraphService<std::string> kStringTestService{
     "mediapipe::StringTestService"};
 class GraphServicesClientTestSubgraph : public Subgraph {
@@ -564,6 +735,76 @@ TEST(SubgraphExpansionTest, GraphServicesUsage) {
   EXPECT_THAT(supergraph, mediapipe::EqualsProto(expected_graph));
 }
 
+// Counts its expansions.
+class CountingTestSubgraph : public Subgraph {
+ public:
+  absl::StatusOr<CalculatorGraphConfig> GetConfig(
+      const SubgraphOptions& /*options*/) override {
+    ++num_expansions;
+    return mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+      input_stream: "DATA:input_1"
+      node { calculator: "SomeSinkCalculator" input_stream: "input_1" }
+    )pb");
+  }
+  static int num_expansions;
+};
+int CountingTestSubgraph::num_expansions = 0;
+REGISTER_MEDIAPIPE_GRAPH(CountingTestSubgraph);
+
+TEST(SubgraphExpansionTest, ExpansionCache) {
+  tool::SetSubgraphExpansionCacheCapacity(4);
+  CountingTestSubgraph::num_expansions = 0;
+  const CalculatorGraphConfig supergraph =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        node { calculator: "CountingTestSubgraph" input_stream: "DATA:foo" }
+      )pb");
+  const CalculatorGraphConfig expected_graph =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        node {
+          name: "countingtestsubgraph__SomeSinkCalculator"
+          calculator: "SomeSinkCalculator"
+          input_stream: "foo"
+        }
+      )pb");
+  for (int i = 0; i < 2; ++i) {
+    CalculatorGraphConfig config = supergraph;
+    MP_ASSERT_OK(tool::ExpandSubgraphs(&config));
+    EXPECT_THAT(config, mediapipe::EqualsProto(expected_graph));
+  }
+  EXPECT_EQ(CountingTestSubgraph::num_expansions, 1);
+
+  // Registering a graph invalidates the memoized expansions.
+  GraphRegistry::global_graph_registry.Register("ExpansionCacheTestGraph",
+                                                CalculatorGraphConfig());
+  CalculatorGraphConfig config = supergraph;
+  MP_ASSERT_OK(tool::ExpandSubgraphs(&config));
+  EXPECT_THAT(config, mediapipe::EqualsProto(expected_graph));
+  EXPECT_EQ(CountingTestSubgraph::num_expansions, 2);
+
+  // Expansions against local registries are not memoized.
+  GraphRegistry graph_registry;
+  for (int i = 0; i < 2; ++i) {
+    config = supergraph;
+    MP_ASSERT_OK(tool::ExpandSubgraphs(&config, &graph_registry));
+  }
+  EXPECT_EQ(CountingTestSubgraph::num_expansions, 4);
+
+  // Nor are expansions that depend on graph services.
+  for (const std::string name : {"FirstNode", "SecondNode"}) {
+    config = mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+      node { calculator: "GraphServicesClientTestSubgraph" }
+    )pb");
+    GraphServiceManager service_manager;
+    MP_ASSERT_OK(service_manager.SetServiceObject(
+        kStringTestService, std::make_shared<std::string>(name)));
+    MP_ASSERT_OK(tool::ExpandSubgraphs(&config, /*graph_registry=*/nullptr,
+                                       /*graph_options=*/nullptr,
+                                       &service_manager));
+    EXPECT_EQ(config.node(0).calculator(), name);
+  }
+  tool::SetSubgraphExpansionCacheCapacity(0);
+}
+
 // Shows SubgraphOptions consumed by GraphRegistry::CreateByName.
 TEST(SubgraphExpansionTest, SubgraphOptionsUsage) {
   EXPECT_TRUE(SubgraphRegistry::IsRegistered("NodeChainSubgraph"));
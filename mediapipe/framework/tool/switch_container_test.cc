@@ -311,6 +311,16 @@ TEST(SwitchContainerTest, RunsWithSubnodes) {
   RunTestContainer(supergraph);
 }
 
+// Shows the SwitchContainer output is unchanged when all channels are
+// prewarmed on the first input timestamp.
+TEST(SwitchContainerTest, RunsWithPrewarmedChannels) {
+  EXPECT_TRUE(SubgraphRegistry::IsRegistered("SwitchContainer"));
+  CalculatorGraphConfig supergraph =
+      SubnodeContainerExample(R"pb(prewarm_channels: true)pb");
+  MP_EXPECT_OK(tool::ExpandSubgraphs(&supergraph));
+  RunTestContainer(supergraph);
+}
+
 // Shows the SwitchContainer  does not allow input_stream_handler overwrite.
 TEST(SwitchContainerTest, ValidateInputStreamHandler) {
   EXPECT_TRUE(SubgraphRegistry::IsRegistered("SwitchContainer"));
@@ -50,6 +50,11 @@ namespace mediapipe {
 // Input-side-packet "ENABLE" and input-stream "SELECT" can also be used
 // similarly to specify the active channel.
 //
+// Only the active channel receives packets and timestamp bounds, so inactive
+// channels are never scheduled. With option "prewarm_channels", the packets of
+// the first input timestamp are also sent to every inactive channel, so that
+// each channel is initialized before it is first activated.
+//
 // SwitchDemuxCalculator is used by SwitchContainer to enable one of several
 // contained subgraph or calculator nodes.
 //
@@ -64,8 +69,14 @@ class SwitchDemuxCalculator : public CalculatorBase {
   absl::Status Process(CalculatorContext* cc) override;
 
  private:
+  // Sends the input packets to every channel other than channel_index_.
+  void SendToInactiveChannels(CalculatorContext* cc);
+
   int channel_index_;
   std::set<std::string> channel_tags_;
+  bool prewarm_channels_ = false;
+  // The input timestamp whose packets are sent to every channel.
+  Timestamp prewarm_timestamp_ = Timestamp::Unset();
 };
 REGISTER_CALCULATOR(SwitchDemuxCalculator);
 
@@ -125,6 +136,8 @@ absl::Status SwitchDemuxCalculator::GetContract(CalculatorContract* cc) {
 absl::Status SwitchDemuxCalculator::Open(CalculatorContext* cc) {
   channel_index_ = tool::GetChannelIndex(*cc, channel_index_);
   channel_tags_ = ChannelTags(cc->Outputs().TagMap());
+  prewarm_channels_ =
+      cc->Options<mediapipe::SwitchContainerOptions>().prewarm_channels();
 
   // Relay side packets to all channels.
   // Note: This is necessary because Calculator::Open only proceeds when every
@@ -177,9 +190,37 @@ absl::Status SwitchDemuxCalculator::Process(CalculatorContext* cc) {
         auto& output = cc->Outputs().Get(output_tag, index);
         tool::Relay(input, &output);
       }
+      if (prewarm_channels_ && !input.IsEmpty() &&
+          prewarm_timestamp_ == Timestamp::Unset()) {
+        prewarm_timestamp_ = input.Value().Timestamp();
+      }
     }
   }
+  if (prewarm_channels_ && cc->InputTimestamp() == prewarm_timestamp_) {
+    SendToInactiveChannels(cc);
+  }
   return absl::OkStatus();
 }
 
+void SwitchDemuxCalculator::SendToInactiveChannels(CalculatorContext* cc) {
+  const int channel_count = tool::ChannelCount(cc->Outputs().TagMap());
+  for (const std::string& tag : channel_tags_) {
+    for (int index = 0; index < cc->Inputs().NumEntries(tag); ++index) {
+      auto& input = cc->Inputs().Get(tag, index);
+      if (input.IsEmpty()) continue;
+      for (int channel = 0; channel < channel_count; ++channel) {
+        if (channel == channel_index_) continue;
+        auto output_id =
+            cc->Outputs().GetId(tool::ChannelTag(tag, channel), index);
+        if (!output_id.IsValid()) continue;
+        // The channel may have received the packet while it was active.
+        auto& output = cc->Outputs().Get(output_id);
+        if (output.NextTimestampBound() <= input.Value().Timestamp()) {
+          output.AddPacket(input.Value());
+        }
+      }
+    }
+  }
+}
+
 }  // namespace mediapipe
@@ -74,6 +74,11 @@ class SwitchMuxCalculator : public CalculatorBase {
   // Stores any new input channel history.
   void RecordChannel(CalculatorContext* cc);
 
+  // Returns true if `input_id` belongs to a channel known to be inactive at
+  // `timestamp`.
+  bool IsInactive(CalculatorContext* cc, CollectionItemId input_id,
+                  Timestamp timestamp);
+
   // Temporarily enqueues every new packet or timestamp bounds.
   void RecordPackets(CalculatorContext* cc);
 
@@ -90,6 +95,8 @@ class SwitchMuxCalculator : public CalculatorBase {
   // Historical channel index values for timestamps where we don't have all
   // packets available yet.
   std::map<Timestamp, int> channel_history_;
+  // The channel of each channel input stream.
+  std::map<CollectionItemId, int> input_channels_;
 };
 REGISTER_CALCULATOR(SwitchMuxCalculator);
 
@@ -165,6 +172,16 @@ absl::Status SwitchMuxCalculator::Open(CalculatorContext* cc) {
   channel_index_ = tool::GetChannelIndex(*cc, channel_index_);
   channel_tags_ = ChannelTags(cc->Inputs().TagMap());
   channel_history_[Timestamp::Unset()] = channel_index_;
+  int channel_count = tool::ChannelCount(cc->Inputs().TagMap());
+  for (const std::string& tag : channel_tags_) {
+    for (int channel = 0; channel < channel_count; ++channel) {
+      std::string input_tag = tool::ChannelTag(tag, channel);
+      for (int index = 0; index < cc->Inputs().NumEntries(input_tag);
+           ++index) {
+        input_channels_[cc->Inputs().GetId(input_tag, index)] = channel;
+      }
+    }
+  }
 
   // Relay side packets only from channel_index_.
   for (const std::string& tag : ChannelTags(cc->InputSidePackets().TagMap())) {
@@ -190,6 +207,15 @@ void SwitchMuxCalculator::RecordChannel(CalculatorContext* cc) {
   }
 }
 
+bool SwitchMuxCalculator::IsInactive(CalculatorContext* cc,
+                                     CollectionItemId input_id,
+                                     Timestamp timestamp) {
+  if (timestamp > ChannelSettledTimestamp(cc)) return false;
+  auto it = channel_history_.upper_bound(timestamp);
+  if (it == channel_history_.begin()) return false;
+  return std::prev(it)->second != input_channels_[input_id];
+}
+
 void SwitchMuxCalculator::RecordPackets(CalculatorContext* cc) {
   auto select_id = cc->Inputs().GetId("SELECT", 0);
   auto enable_id = cc->Inputs().GetId("ENABLE", 0);
@@ -198,6 +224,12 @@ void SwitchMuxCalculator::RecordPackets(CalculatorContext* cc) {
     Packet packet = cc->Inputs().Get(id).Value();
     // Enque any new packet or timestamp bound.
     if (packet.Timestamp() == cc->InputTimestamp()) {
+      // Outputs of prewarmed inactive channels would only be discarded at the
+      // next channel switch, so drop them right away.
+      if (options_.prewarm_channels() &&
+          IsInactive(cc, id, packet.Timestamp())) {
+        continue;
+      }
       packet_queue_[id].push(packet);
     }
   }
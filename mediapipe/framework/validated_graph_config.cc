@@ -14,6 +14,7 @@
 
 #include "mediapipe/framework/validated_graph_config.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "absl/container/flat_hash_set.h"
@@ -333,6 +334,28 @@ absl::Status ValidatedGraphConfig::Initialize(
   config_ = std::move(input_config);
   MP_RETURN_IF_ERROR(
       PerformBasicTransforms(graph_registry, graph_options, service_manager));
+  return InitializeExpandedConfig();
+}
+
+absl::Status ValidatedGraphConfig::Initialize(
+    const ExpandedGraphConfig& expanded_config) {
+  RET_CHECK(!initialized_)
+      << "ValidatedGraphConfig can be initialized only once.";
+  RET_CHECK_EQ(expanded_config.version(), kExpandedConfigVersion)
+      << "The ExpandedGraphConfig was produced by an incompatible version of "
+         "the framework.";
+  config_ = expanded_config.config();
+  return InitializeExpandedConfig();
+}
+
+ExpandedGraphConfig ValidatedGraphConfig::ToExpandedConfig() const {
+  ExpandedGraphConfig result;
+  *result.mutable_config() = config_;
+  result.set_version(kExpandedConfigVersion);
+  return result;
+}
+
+absl::Status ValidatedGraphConfig::InitializeExpandedConfig() {
   // Initialize the basic node information.
   MP_RETURN_IF_ERROR(InitializeGeneratorInfo());
   MP_RETURN_IF_ERROR(InitializeCalculatorInfo());
@@ -396,6 +419,8 @@ absl::Status ValidatedGraphConfig::Initialize(
   MP_RETURN_IF_ERROR(ValidateStreamTypes());
 
   MP_RETURN_IF_ERROR(ComputeSourceDependence());
+  MP_RETURN_IF_ERROR(ComputeCriticalPaths());
+  MP_RETURN_IF_ERROR(ComputeFusedChains());
 
   MP_RETURN_IF_ERROR(ValidateExecutors());
 
@@ -1113,6 +1138,116 @@ absl::Status ValidatedGraphConfig::ComputeSourceDependence() {
   return absl::OkStatus();
 }
 
+absl::StatusOr<std::vector<int64>>
+ValidatedGraphConfig::ComputeCriticalPathLengths(
+    const std::vector<int64>& node_costs) const {
+  RET_CHECK_EQ(node_costs.size(), calculators_.size());
+  // The calculators reading the output streams of each calculator.
+  std::vector<std::vector<int>> consumers(calculators_.size());
+  for (const EdgeInfo& input_edge_info : input_streams_) {
+    if (input_edge_info.back_edge || input_edge_info.upstream < 0) continue;
+    const EdgeInfo& output_edge_info =
+        output_streams_[input_edge_info.upstream];
+    if (output_edge_info.parent_node.type !=
+        NodeTypeInfo::NodeType::CALCULATOR) {
+      continue;
+    }
+    const int producer = output_edge_info.parent_node.index;
+    const int consumer = input_edge_info.parent_node.index;
+    // Calculators are topologically sorted, so all edges other than back
+    // edges lead to calculators with higher indexes.
+    RET_CHECK_LT(producer, consumer)
+        << "input stream \"" << input_edge_info.name
+        << "\" is not a back edge, but connects to an earlier calculator.";
+    consumers[producer].push_back(consumer);
+  }
+  std::vector<int64> lengths(calculators_.size(), 0);
+  for (int node_index = calculators_.size() - 1; node_index >= 0;
+       --node_index) {
+    int64 downstream_length = 0;
+    for (int consumer : consumers[node_index]) {
+      downstream_length = std::max(downstream_length, lengths[consumer]);
+    }
+    lengths[node_index] = node_costs[node_index] + downstream_length;
+  }
+  return lengths;
+}
+
+absl::Status ValidatedGraphConfig::ComputeCriticalPaths() {
+  ASSIGN_OR_RETURN(
+      std::vector<int64> lengths,
+      ComputeCriticalPathLengths(std::vector<int64>(calculators_.size(), 1)));
+  for (int node_index = 0; node_index < calculators_.size(); ++node_index) {
+    calculators_[node_index].SetCriticalPathLength(lengths[node_index]);
+  }
+  return absl::OkStatus();
+}
+
+bool ValidatedGraphConfig::CanFuseNodes(int producer, int consumer) const {
+  const CalculatorGraphConfig::Node& producer_config = config_.node(producer);
+  const CalculatorGraphConfig::Node& consumer_config = config_.node(consumer);
+  if (producer_config.executor() != consumer_config.executor() ||
+      producer_config.max_in_flight() > 1 ||
+      consumer_config.max_in_flight() > 1) {
+    return false;
+  }
+  // Fused nodes run as soon as their single input is delivered, which only
+  // matches the default input policy. Nodes that need to process timestamp
+  // bounds without packets keep being scheduled on their own.
+  const NodeTypeInfo& consumer_info = calculators_[consumer];
+  const std::string input_stream_handler =
+      consumer_config.has_input_stream_handler()
+          ? consumer_config.input_stream_handler().input_stream_handler()
+          : consumer_info.GetInputStreamHandler();
+  if (!input_stream_handler.empty() &&
+      input_stream_handler != "DefaultInputStreamHandler") {
+    return false;
+  }
+  return !consumer_info.Contract().GetProcessTimestampBounds();
+}
+
+absl::Status ValidatedGraphConfig::ComputeFusedChains() {
+  if (!config_.fuse_calculator_chains()) {
+    return absl::OkStatus();
+  }
+  // The number of input streams reading each calculator output stream.
+  std::vector<int> num_consumers(output_streams_.size(), 0);
+  for (const EdgeInfo& input_edge_info : input_streams_) {
+    if (input_edge_info.upstream >= 0) {
+      ++num_consumers[input_edge_info.upstream];
+    }
+  }
+  // Calculators are topologically sorted, so the head of a producer's chain
+  // is known before its consumer is visited.
+  for (int node_index = 0; node_index < calculators_.size(); ++node_index) {
+    NodeTypeInfo& node_type_info = calculators_[node_index];
+    if (node_type_info.InputStreamTypes().NumEntries() != 1) continue;
+    const EdgeInfo& input_edge_info =
+        input_streams_[node_type_info.InputStreamBaseIndex()];
+    if (input_edge_info.back_edge || input_edge_info.upstream < 0) continue;
+    const EdgeInfo& output_edge_info =
+        output_streams_[input_edge_info.upstream];
+    if (output_edge_info.parent_node.type !=
+        NodeTypeInfo::NodeType::CALCULATOR) {
+      continue;
+    }
+    const int producer = output_edge_info.parent_node.index;
+    NodeTypeInfo& producer_info = calculators_[producer];
+    if (producer_info.OutputStreamTypes().NumEntries() != 1 ||
+        num_consumers[input_edge_info.upstream] != 1 ||
+        !CanFuseNodes(producer, node_index)) {
+      continue;
+    }
+    if (producer_info.FusedChainHead() < 0) {
+      producer_info.SetFusedChainHead(producer);
+    }
+    node_type_info.SetFusedChainHead(producer_info.FusedChainHead());
+    VLOG(2) << "Fused calculator " << node_index << " into the chain of "
+            << "calculator " << node_type_info.FusedChainHead();
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::string> ValidatedGraphConfig::RegisteredSidePacketTypeName(
     const std::string& name) {
   auto iter = side_packet_to_producer_.find(name);
@@ -24,6 +24,7 @@
 #include "mediapipe/framework/graph_service_manager.h"
 #include "mediapipe/framework/packet_generator.pb.h"
 #include "mediapipe/framework/packet_type.h"
+#include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/map_util.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/status_builder.h"
@@ -133,6 +134,20 @@ class NodeTypeInfo {
   // This function is only valid for a NodeTypeInfo of NodeType CALCULATOR.
   bool AddSource(int index) { return ancestor_sources_.insert(index).second; }
 
+  // Returns the number of calculators on the longest path from this node to
+  // a sink (a node whose output streams have no consumers), including this
+  // node. Back edges are not followed.
+  // This function is only valid for a NodeTypeInfo of NodeType CALCULATOR.
+  int64 CriticalPathLength() const { return critical_path_length_; }
+  void SetCriticalPathLength(int64 length) { critical_path_length_ = length; }
+
+  // Returns the index of the first calculator of the fused chain containing
+  // this node, or -1 if the node is not fused with any other node. See
+  // CalculatorGraphConfig::fuse_calculator_chains.
+  // This function is only valid for a NodeTypeInfo of NodeType CALCULATOR.
+  int FusedChainHead() const { return fused_chain_head_; }
+  void SetFusedChainHead(int index) { fused_chain_head_ = index; }
+
   // Convert the NodeType enum into a string (generally for error messaging).
   static std::string NodeTypeToString(NodeType node_type);
 
@@ -170,6 +185,12 @@ class NodeTypeInfo {
 
   // The set of sources which affect this node.
   absl::flat_hash_set<int> ancestor_sources_;
+
+  // See CriticalPathLength().
+  int64 critical_path_length_ = 0;
+
+  // See FusedChainHead().
+  int fused_chain_head_ = -1;
 };
 
 // Information for either the input or output side of an edge.  An edge
@@ -223,6 +244,16 @@ class ValidatedGraphConfig {
       const Subgraph::SubgraphOptions* graph_options = nullptr,
       const GraphServiceManager* service_manager = nullptr);
 
+  // Initializes the ValidatedGraphConfig from a config that was expanded and
+  // validated earlier, see ToExpandedConfig().  Subgraph and template
+  // expansion and the topological sort of the nodes are skipped, but the
+  // calculator contracts are still checked and the packet types resolved.
+  absl::Status Initialize(const ExpandedGraphConfig& expanded_config);
+
+  // Returns the canonical config in a form that can be stored, e.g. as a
+  // binary proto, and passed back to Initialize() later.
+  ExpandedGraphConfig ToExpandedConfig() const;
+
   // Returns true if the ValidatedGraphConfig has been initialized.
   bool Initialized() const { return initialized_; }
 
@@ -301,7 +332,23 @@ class ValidatedGraphConfig {
     return required_side_packets_.count(name) > 0;
   }
 
+  // Returns, for every calculator, the length of the longest path from the
+  // calculator to a sink, where each calculator on the path counts with its
+  // entry in |node_costs|. Back edges are not followed. |node_costs| must have
+  // one entry per calculator.
+  absl::StatusOr<std::vector<int64>> ComputeCriticalPathLengths(
+      const std::vector<int64>& node_costs) const;
+
  private:
+  // The ExpandedGraphConfig::version produced by ToExpandedConfig(). This
+  // must be incremented whenever the canonical config produced by
+  // PerformBasicTransforms() changes.
+  static constexpr int kExpandedConfigVersion = 1;
+
+  // Initializes the node and edge information from config_, after the basic
+  // transforms have been applied.
+  absl::Status InitializeExpandedConfig();
+
   // Perform transforms such as converting legacy features, expanding
   // subgraphs, and popluting input stream handler.
   absl::Status PerformBasicTransforms(
@@ -386,6 +433,17 @@ class ValidatedGraphConfig {
   // Compute the dependence of nodes on sources.
   absl::Status ComputeSourceDependence();
 
+  // Compute NodeTypeInfo::CriticalPathLength for all calculators.
+  absl::Status ComputeCriticalPaths();
+
+  // Compute NodeTypeInfo::FusedChainHead for all calculators, if the graph
+  // enables fuse_calculator_chains.
+  absl::Status ComputeFusedChains();
+
+  // Returns true if calculator |consumer| can be fused with calculator
+  // |producer|, which feeds its only input stream.
+  bool CanFuseNodes(int producer, int consumer) const;
+
   // Infer the type of types set to "Any" by what they are connected to.
   absl::Status ResolveAnyTypes(std::vector<EdgeInfo>* input_edges,
                                std::vector<EdgeInfo>* output_edges);
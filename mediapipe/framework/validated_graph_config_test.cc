@@ -1,6 +1,7 @@
 #include "mediapipe/framework/validated_graph_config.h"
 
 #include <string_view>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/ascii.h"
@@ -12,6 +13,7 @@
 #include "mediapipe/framework/graph_service.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/status_matchers.h"
 
 namespace mediapipe {
@@ -34,6 +36,15 @@ MEDIAPIPE_REGISTER_NODE(CalculatorB);
 using CalculatorC = NoOp;
 MEDIAPIPE_REGISTER_NODE(CalculatorC);
 
+class ProcessTimestampBoundsNoOp : public NoOp {
+ public:
+  static absl::Status UpdateContract(CalculatorContract* cc) {
+    cc->SetProcessTimestampBounds(true);
+    return absl::OkStatus();
+  }
+};
+MEDIAPIPE_REGISTER_NODE(ProcessTimestampBoundsNoOp);
+
 CalculatorGraphConfig ExpectedConfig(const std::string& node_name) {
   CalculatorGraphConfig config;
   config.add_node()->set_calculator(node_name);
@@ -163,4 +174,167 @@ TEST(ValidatedGraphConfigTest, InitializeSubgraphWithServiceCalculatorB) {
   }
 }
 
+// A graph with a long branch (b1, b2) and a short branch (d) after "a".
+constexpr char kBranchingGraph[] = R"pb(
+  input_stream: "in"
+  node {
+    calculator: "CalculatorA"
+    input_stream: "NN:in"
+    output_stream: "NN:a"
+  }
+  node {
+    calculator: "CalculatorB"
+    input_stream: "NN:a"
+    output_stream: "NN:b1"
+  }
+  node {
+    calculator: "CalculatorB"
+    input_stream: "NN:b1"
+    output_stream: "NN:b2"
+  }
+  node {
+    calculator: "CalculatorC"
+    input_stream: "NN:a"
+  }
+)pb";
+
+TEST(ValidatedGraphConfigTest, ComputesCriticalPathLengths) {
+  ValidatedGraphConfig config;
+  MP_ASSERT_OK(config.Initialize(
+      ParseTextProtoOrDie<CalculatorGraphConfig>(kBranchingGraph)));
+  std::vector<int64> lengths;
+  for (const NodeTypeInfo& node_info : config.CalculatorInfos()) {
+    lengths.push_back(node_info.CriticalPathLength());
+  }
+  EXPECT_THAT(lengths, testing::ElementsAre(3, 2, 1, 1));
+}
+
+TEST(ValidatedGraphConfigTest, ComputesWeightedCriticalPathLengths) {
+  ValidatedGraphConfig config;
+  MP_ASSERT_OK(config.Initialize(
+      ParseTextProtoOrDie<CalculatorGraphConfig>(kBranchingGraph)));
+  MP_ASSERT_OK_AND_ASSIGN(std::vector<int64> lengths,
+                          config.ComputeCriticalPathLengths({1, 10, 1, 50}));
+  EXPECT_THAT(lengths, testing::ElementsAre(51, 11, 1, 50));
+  EXPECT_FALSE(config.ComputeCriticalPathLengths({1, 2}).ok());
+}
+
+std::vector<int> FusedChainHeads(const ValidatedGraphConfig& config) {
+  std::vector<int> heads;
+  for (const NodeTypeInfo& node_info : config.CalculatorInfos()) {
+    heads.push_back(node_info.FusedChainHead());
+  }
+  return heads;
+}
+
+TEST(ValidatedGraphConfigTest, DoesNotFuseChainsByDefault) {
+  ValidatedGraphConfig config;
+  MP_ASSERT_OK(config.Initialize(
+      ParseTextProtoOrDie<CalculatorGraphConfig>(kBranchingGraph)));
+  EXPECT_THAT(FusedChainHeads(config), testing::ElementsAre(-1, -1, -1, -1));
+}
+
+TEST(ValidatedGraphConfigTest, FusesOnlyUnbranchedEdges) {
+  auto graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(kBranchingGraph);
+  graph_config.set_fuse_calculator_chains(true);
+  ValidatedGraphConfig config;
+  MP_ASSERT_OK(config.Initialize(graph_config));
+  // "a" has two consumers, so only b1 -> b2 is fused.
+  EXPECT_THAT(FusedChainHeads(config), testing::ElementsAre(-1, 1, 1, -1));
+}
+
+TEST(ValidatedGraphConfigTest, StopsFusedChainsAtIncompatibleNodes) {
+  ValidatedGraphConfig config;
+  MP_ASSERT_OK(config.Initialize(ParseTextProtoOrDie<CalculatorGraphConfig>(
+      R"pb(
+        input_stream: "in"
+        fuse_calculator_chains: true
+        executor { name: "other" }
+        node {
+          calculator: "CalculatorA"
+          input_stream: "NN:in"
+          output_stream: "NN:a"
+        }
+        node {
+          calculator: "CalculatorB"
+          input_stream: "NN:a"
+          output_stream: "NN:b"
+        }
+        node {
+          calculator: "ProcessTimestampBoundsNoOp"
+          input_stream: "NN:b"
+          output_stream: "NN:c"
+        }
+        node {
+          calculator: "CalculatorB"
+          input_stream: "NN:c"
+          output_stream: "NN:d"
+        }
+        node {
+          calculator: "CalculatorB"
+          input_stream: "NN:d"
+          output_stream: "NN:e"
+          input_stream_handler {
+            input_stream_handler: "ImmediateInputStreamHandler"
+          }
+        }
+        node {
+          calculator: "CalculatorB"
+          input_stream: "NN:e"
+          output_stream: "NN:f"
+        }
+        node {
+          calculator: "CalculatorC"
+          input_stream: "NN:f"
+          executor: "other"
+        }
+      )pb")));
+  EXPECT_THAT(FusedChainHeads(config),
+              testing::ElementsAre(0, 0, 2, 2, 4, 4, -1));
+}
+
+TEST(ValidatedGraphConfigTest, InitializesFromExpandedConfig) {
+  CalculatorGraphConfig graph =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "in"
+        node {
+          calculator: "CalculatorB"
+          input_stream: "NN:a"
+          output_stream: "NN:b"
+        }
+        node { calculator: "AlwaysCalculatorASubgraph" }
+        node {
+          calculator: "CalculatorA"
+          input_stream: "NN:in"
+          output_stream: "NN:a"
+        }
+      )pb");
+  ValidatedGraphConfig validated;
+  MP_ASSERT_OK(validated.Initialize(graph));
+
+  std::string serialized;
+  ASSERT_TRUE(validated.ToExpandedConfig().SerializeToString(&serialized));
+  ExpandedGraphConfig expanded;
+  ASSERT_TRUE(expanded.ParseFromString(serialized));
+  ValidatedGraphConfig loaded;
+  MP_ASSERT_OK(loaded.Initialize(expanded));
+  EXPECT_THAT(loaded.Config(), EqualsProto(validated.Config()));
+  ASSERT_EQ(loaded.CalculatorInfos().size(), 3);
+  EXPECT_EQ(loaded.Config().node(0).calculator(), "CalculatorA");
+  EXPECT_EQ(loaded.InputStreamInfos().size(),
+            validated.InputStreamInfos().size());
+  EXPECT_EQ(loaded.OutputStreamInfos().size(),
+            validated.OutputStreamInfos().size());
+}
+
+TEST(ValidatedGraphConfigTest, RejectsExpandedConfigOfOtherVersion) {
+  ValidatedGraphConfig validated;
+  MP_ASSERT_OK(validated.Initialize(ExpectedConfig("CalculatorA")));
+  ExpandedGraphConfig expanded = validated.ToExpandedConfig();
+  expanded.set_version(expanded.version() + 1);
+  ValidatedGraphConfig loaded;
+  EXPECT_FALSE(loaded.Initialize(expanded).ok());
+}
+
 }  // namespace mediapipe
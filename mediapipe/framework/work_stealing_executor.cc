@@ -0,0 +1,159 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/work_stealing_executor.h"
+
+#include <utility>
+
+#include "absl/base/attributes.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/framework/thread_pool_executor.h"
+#include "mediapipe/framework/thread_pool_executor.pb.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Identifies the WorkStealingExecutor worker running on the current thread.
+struct CurrentWorker {
+  const WorkStealingExecutor* executor;
+  int index;
+};
+
+ABSL_CONST_INIT thread_local CurrentWorker current_worker = {nullptr, -1};
+
+}  // namespace
+
+// static
+absl::StatusOr<Executor*> WorkStealingExecutor::Create(
+    const MediaPipeOptions& extendable_options) {
+  auto& options =
+      extendable_options.GetExtension(ThreadPoolExecutorOptions::ext);
+  ASSIGN_OR_RETURN(ThreadOptions thread_options,
+                   internal::ThreadOptionsFromExecutorOptions(options));
+  return new WorkStealingExecutor(thread_options, options.num_threads());
+}
+
+WorkStealingExecutor::WorkStealingExecutor(int num_threads)
+    : WorkStealingExecutor(ThreadOptions(), num_threads) {}
+
+WorkStealingExecutor::WorkStealingExecutor(const ThreadOptions& thread_options,
+                                           int num_threads)
+    : num_threads_(num_threads <= 0 ? 1 : num_threads),
+      thread_pool_(thread_options,
+                   thread_options.name_prefix().empty()
+                       ? "mediapipe"
+                       : thread_options.name_prefix(),
+                   num_threads_) {
+  queues_.reserve(num_threads_);
+  for (int i = 0; i < num_threads_; ++i) {
+    queues_.push_back(std::make_unique<WorkerQueue>());
+  }
+  Start();
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+  VLOG(2) << "Terminating work-stealing executor.";
+  {
+    absl::MutexLock lock(&wake_mutex_);
+    stopped_ = true;
+    wake_condition_.SignalAll();
+  }
+  // thread_pool_ is destroyed next and joins the worker threads once they
+  // have drained the remaining tasks.
+}
+
+void WorkStealingExecutor::Start() {
+  stack_size_ = thread_pool_.thread_options().stack_size();
+  thread_pool_.StartWorkers();
+  for (int i = 0; i < num_threads_; ++i) {
+    thread_pool_.Schedule([this, i] { RunWorker(i); });
+  }
+  VLOG(2) << "Started work-stealing executor with " << num_threads_
+          << " threads.";
+}
+
+int WorkStealingExecutor::CurrentWorkerIndex() const {
+  return current_worker.executor == this ? current_worker.index : -1;
+}
+
+void WorkStealingExecutor::Schedule(std::function<void()> task) {
+  int index = CurrentWorkerIndex();
+  if (index < 0) {
+    index = next_queue_.fetch_add(1, std::memory_order_relaxed) % num_threads_;
+  }
+  {
+    WorkerQueue& queue = *queues_[index];
+    absl::MutexLock lock(&queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  // Pairs with the check of num_queued_tasks_ in RunWorker. Both counters use
+  // sequentially consistent operations, so either this thread sees the
+  // sleeping worker, or the worker sees the new task before it blocks.
+  num_queued_tasks_.fetch_add(1);
+  if (num_sleeping_workers_.load() > 0) {
+    absl::MutexLock lock(&wake_mutex_);
+    wake_condition_.Signal();
+  }
+}
+
+bool WorkStealingExecutor::TakeTask(int index, std::function<void()>* task) {
+  {
+    WorkerQueue& own = *queues_[index];
+    absl::MutexLock lock(&own.mutex);
+    if (!own.tasks.empty()) {
+      *task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+  for (int i = 1; i < num_threads_; ++i) {
+    WorkerQueue& victim = *queues_[(index + i) % num_threads_];
+    absl::MutexLock lock(&victim.mutex);
+    if (!victim.tasks.empty()) {
+      *task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingExecutor::RunWorker(int index) {
+  current_worker = {this, index};
+  std::function<void()> task;
+  while (true) {
+    if (TakeTask(index, &task)) {
+      num_queued_tasks_.fetch_sub(1);
+      task();
+      task = nullptr;
+      continue;
+    }
+    absl::MutexLock lock(&wake_mutex_);
+    num_sleeping_workers_.fetch_add(1);
+    while (num_queued_tasks_.load() <= 0 && !stopped_) {
+      wake_condition_.Wait(&wake_mutex_);
+    }
+    num_sleeping_workers_.fetch_sub(1);
+    if (stopped_ && num_queued_tasks_.load() <= 0) {
+      break;
+    }
+  }
+  current_worker = {nullptr, -1};
+}
+
+REGISTER_EXECUTOR(WorkStealingExecutor);
+
+}  // namespace mediapipe
@@ -0,0 +1,114 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_WORK_STEALING_EXECUTOR_H_
+#define MEDIAPIPE_FRAMEWORK_WORK_STEALING_EXECUTOR_H_
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/thread_options.h"
+#include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/port/statusor.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+
+// A multithreaded executor in which every worker thread owns a task deque.
+//
+// - A task scheduled from one of the executor's own worker threads (e.g. a
+//   follow-up node task added by the SchedulerQueue while a node runs) is
+//   pushed onto that worker's deque and popped in LIFO order by the same
+//   worker.
+// - A task scheduled from any other thread is distributed round-robin over
+//   the worker deques.
+// - An idle worker steals the oldest task from the other workers' deques
+//   before going to sleep.
+//
+// Each deque has its own mutex, so workers only contend with each other when
+// stealing, instead of serializing on a single pool-wide queue lock.
+//
+// The executor accepts the same ThreadPoolExecutorOptions as
+// ThreadPoolExecutor, and can be selected either with the executor type
+// "WorkStealingExecutor" or with ThreadPoolExecutorOptions::use_work_stealing.
+class WorkStealingExecutor : public Executor {
+ public:
+  static absl::StatusOr<Executor*> Create(
+      const MediaPipeOptions& extendable_options);
+
+  explicit WorkStealingExecutor(int num_threads);
+  WorkStealingExecutor(const ThreadOptions& thread_options, int num_threads);
+  ~WorkStealingExecutor() override;
+  void Schedule(std::function<void()> task) override;
+
+  // For testing.
+  int num_threads() const { return num_threads_; }
+  // Returns the thread stack size (in bytes).
+  size_t stack_size() const { return stack_size_; }
+
+ private:
+  // A task deque owned by one worker thread. The owner pushes and pops at the
+  // back; thieves take from the front.
+  struct WorkerQueue {
+    absl::Mutex mutex;
+    std::deque<std::function<void()>> tasks ABSL_GUARDED_BY(mutex);
+  };
+
+  // Starts one worker loop per thread of thread_pool_.
+  void Start();
+
+  // The body of worker thread "index". Returns when the executor is stopped
+  // and no queued tasks remain.
+  void RunWorker(int index);
+
+  // Pops the newest task from the deque of worker "index", or steals the
+  // oldest task from another worker. Returns false if no task was found.
+  bool TakeTask(int index, std::function<void()>* task);
+
+  // Returns the index of the current thread's worker if the current thread
+  // belongs to this executor, or -1 otherwise.
+  int CurrentWorkerIndex() const;
+
+  const int num_threads_;
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+
+  // Round-robin cursor for tasks scheduled from outside the executor.
+  std::atomic<unsigned int> next_queue_{0};
+
+  // Number of tasks sitting in any of the worker deques.
+  std::atomic<int> num_queued_tasks_{0};
+  // Number of workers blocked (or about to block) on wake_condition_.
+  std::atomic<int> num_sleeping_workers_{0};
+
+  absl::Mutex wake_mutex_;
+  absl::CondVar wake_condition_;
+  bool stopped_ ABSL_GUARDED_BY(wake_mutex_) = false;
+
+  // Provides the worker threads (with their stack size, priority, affinity
+  // and names). Each thread runs a single RunWorker() loop. Declared last so
+  // that it is destroyed, and its threads joined, before the queues.
+  mediapipe::ThreadPool thread_pool_;
+
+  // See ThreadPoolExecutor::stack_size_.
+  size_t stack_size_ = 0;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_WORK_STEALING_EXECUTOR_H_
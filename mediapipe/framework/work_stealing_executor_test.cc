@@ -0,0 +1,104 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/work_stealing_executor.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/thread_pool_executor.h"
+#include "mediapipe/framework/thread_pool_executor.pb.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(WorkStealingExecutorTest, RunsAllTasks) {
+  absl::Mutex mutex;
+  int count = 0;
+  {
+    WorkStealingExecutor executor(4);
+    ASSERT_EQ(executor.num_threads(), 4);
+    for (int i = 0; i < 1000; ++i) {
+      executor.Schedule([&mutex, &count] {
+        absl::MutexLock lock(&mutex);
+        ++count;
+      });
+    }
+  }
+  EXPECT_EQ(count, 1000);
+}
+
+TEST(WorkStealingExecutorTest, RunsTasksScheduledFromWorkers) {
+  absl::Mutex mutex;
+  int count = 0;
+  {
+    WorkStealingExecutor executor(4);
+    for (int i = 0; i < 10; ++i) {
+      executor.Schedule([&executor, &mutex, &count] {
+        for (int j = 0; j < 100; ++j) {
+          executor.Schedule([&mutex, &count] {
+            absl::MutexLock lock(&mutex);
+            ++count;
+          });
+        }
+      });
+    }
+  }
+  EXPECT_EQ(count, 1000);
+}
+
+// A worker runs the tasks it schedules for itself newest first.
+TEST(WorkStealingExecutorTest, LocalTasksRunInLifoOrder) {
+  std::vector<int> order;
+  absl::Notification done;
+  WorkStealingExecutor executor(1);
+  executor.Schedule([&executor, &order, &done] {
+    for (int i = 0; i < 3; ++i) {
+      executor.Schedule([&order, &done, i] {
+        order.push_back(i);
+        if (order.size() == 3) done.Notify();
+      });
+    }
+  });
+  done.WaitForNotification();
+  EXPECT_THAT(order, testing::ElementsAre(2, 1, 0));
+}
+
+TEST(WorkStealingExecutorTest, CreatedFromThreadPoolExecutorOptions) {
+  MediaPipeOptions extendable_options;
+  ThreadPoolExecutorOptions* options =
+      extendable_options.MutableExtension(ThreadPoolExecutorOptions::ext);
+  options->set_num_threads(3);
+  options->set_use_work_stealing(true);
+  MP_ASSERT_OK_AND_ASSIGN(Executor * executor,
+                          ThreadPoolExecutor::Create(extendable_options));
+  std::unique_ptr<Executor> owned_executor(executor);
+  auto* work_stealing_executor = dynamic_cast<WorkStealingExecutor*>(executor);
+  ASSERT_NE(work_stealing_executor, nullptr);
+  EXPECT_EQ(work_stealing_executor->num_threads(), 3);
+}
+
+TEST(WorkStealingExecutorTest, RejectsMissingNumThreads) {
+  MediaPipeOptions extendable_options;
+  extendable_options.MutableExtension(ThreadPoolExecutorOptions::ext);
+  EXPECT_FALSE(WorkStealingExecutor::Create(extendable_options).ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -14,9 +14,12 @@
 
 #import "mediapipe/gpu/MPPMetalHelper.h"
 
+#import <QuartzCore/QuartzCore.h>
+
 #import "mediapipe/gpu/graph_support.h"
 #import "GTMDefines.h"
 
+#include "mediapipe/framework/mediapipe_profiling.h"
 #include "mediapipe/framework/port/ret_check.h"
 
 namespace mediapipe {
@@ -117,8 +120,44 @@ class MetalHelperLegacySupport {
 }
 
 - (id<MTLCommandBuffer>)commandBuffer {
-  return [_gpuShared.mtlCommandQueue commandBuffer];
+  id<MTLCommandBuffer> commandBuffer = [_gpuShared.mtlCommandQueue commandBuffer];
+#ifdef MEDIAPIPE_PROFILER_AVAILABLE
+  [self addProfilingHandlerToCommandBuffer:commandBuffer];
+#endif  // MEDIAPIPE_PROFILER_AVAILABLE
+  return commandBuffer;
+}
+
+#ifdef MEDIAPIPE_PROFILER_AVAILABLE
+/// Reports the GPU time of a command buffer used by a calculator to the graph
+/// profiler, as the GlContextProfiler does for GL work.
+- (void)addProfilingHandlerToCommandBuffer:(id<MTLCommandBuffer>)commandBuffer {
+  mediapipe::CalculatorContext* cc = mediapipe::MetalHelperLegacySupport::GetCalculatorContext();
+  mediapipe::ProfilingContext* profiler = cc ? cc->GetProfilingContext() : nullptr;
+  if (!profiler || !(profiler->profiler_config().enable_profiler() ||
+                     profiler->profiler_config().trace_enabled())) {
+    return;
+  }
+  if (@available(iOS 10.3, macOS 10.15, *)) {
+    std::shared_ptr<mediapipe::ProfilingContext> profilingContext = profiler->shared_from_this();
+    const int nodeId = cc->NodeId();
+    const mediapipe::Timestamp inputTimestamp = cc->InputTimestamp();
+    [commandBuffer addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
+      if (buffer.status != MTLCommandBufferStatusCompleted) return;
+      // Command buffer times are on the CACurrentMediaTime clock.
+      const absl::Time now = profilingContext->GetClock()->TimeNow();
+      const CFTimeInterval mediaNow = CACurrentMediaTime();
+      auto profilerTime = [&](CFTimeInterval mediaTime) {
+        return now - absl::Seconds(mediaNow - mediaTime);
+      };
+      // kernelStartTime is when the CPU started scheduling the buffer.
+      profilingContext->AddGpuTaskSample(nodeId, inputTimestamp,
+                                         profilerTime(buffer.kernelStartTime),
+                                         profilerTime(buffer.GPUStartTime),
+                                         profilerTime(buffer.GPUEndTime));
+    }];
+  }
 }
+#endif  // MEDIAPIPE_PROFILER_AVAILABLE
 
 - (CVMetalTextureRef)copyCVMetalTextureWithGpuBuffer:(const mediapipe::GpuBuffer&)gpuBuffer
                                                plane:(size_t)plane {
@@ -0,0 +1,86 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/gpu/gl_async_readback.h"
+
+#include <cstring>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+GlAsyncReadback::GlAsyncReadback(int num_buffers) : buffers_(num_buffers) {
+  CHECK_GT(num_buffers, 0);
+  glGenBuffers(num_buffers, buffers_.data());
+}
+
+GlAsyncReadback::~GlAsyncReadback() {
+  glDeleteBuffers(buffers_.size(), buffers_.data());
+}
+
+void GlAsyncReadback::Enqueue(int width, int height, GpuBufferFormat format,
+                              Timestamp timestamp) {
+  CHECK(!IsFull());
+  auto gl_context = GlContext::GetCurrent();
+  CHECK(gl_context);
+  const GlTextureInfo info =
+      GlTextureInfoForGpuBufferFormat(format, 0, gl_context->GetGlVersion());
+  // Rows are packed with the default GL_PACK_ALIGNMENT of 4, which matches
+  // ImageFrame::kGlDefaultAlignmentBoundary.
+  const ImageFormat::Format image_format =
+      ImageFormatForGpuBufferFormat(format);
+  const int row_size = width * ImageFrame::ByteDepthForFormat(image_format) *
+                       ImageFrame::NumberOfChannelsForFormat(image_format);
+  const int width_step = (row_size + 3) & ~3;
+  const GLuint buffer = buffers_[next_buffer_];
+  next_buffer_ = (next_buffer_ + 1) % buffers_.size();
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+  glBufferData(GL_PIXEL_PACK_BUFFER, width_step * height, nullptr,
+               GL_STREAM_READ);
+  glReadPixels(0, 0, width, height, info.gl_format, info.gl_type, nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  pending_.push_back({buffer, width, height, format, timestamp,
+                      gl_context->CreateSyncToken()});
+  // Submits the copy, so that the sync point can be reached without waiting
+  // for the next flush.
+  glFlush();
+}
+
+std::unique_ptr<ImageFrame> GlAsyncReadback::Dequeue(bool wait,
+                                                     Timestamp* timestamp) {
+  if (pending_.empty()) return nullptr;
+  Readback& readback = pending_.front();
+  if (!wait && !readback.sync->IsReady()) return nullptr;
+  readback.sync->Wait();
+
+  auto frame = absl::make_unique<ImageFrame>(
+      ImageFormatForGpuBufferFormat(readback.format), readback.width,
+      readback.height, ImageFrame::kGlDefaultAlignmentBoundary);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+  const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                                      frame->PixelDataSize(), GL_MAP_READ_BIT);
+  CHECK(data) << "glMapBufferRange failed: " << glGetError();
+  std::memcpy(frame->MutablePixelData(), data, frame->PixelDataSize());
+  glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  *timestamp = readback.timestamp;
+  pending_.pop_front();
+  return frame;
+}
+
+}  // namespace mediapipe
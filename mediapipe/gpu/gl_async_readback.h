@@ -0,0 +1,74 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MEDIAPIPE_GPU_GL_ASYNC_READBACK_H_
+#define MEDIAPIPE_GPU_GL_ASYNC_READBACK_H_
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/timestamp.h"
+#include "mediapipe/gpu/gl_base.h"
+#include "mediapipe/gpu/gl_context.h"
+#include "mediapipe/gpu/gpu_buffer_format.h"
+
+namespace mediapipe {
+
+// Reads framebuffers back to CPU memory through a ring of pixel buffer
+// objects, so that glReadPixels returns without waiting for the GPU. Each
+// readback is tracked by a sync token and copied into an ImageFrame once the
+// token has been reached.
+//
+// Requires OpenGL ES 3.0 or OpenGL 3.0. All methods, including the
+// destructor, must be called on the same GL context.
+class GlAsyncReadback {
+ public:
+  explicit GlAsyncReadback(int num_buffers);
+  ~GlAsyncReadback();
+
+  // Returns true if every buffer holds a readback that has not been dequeued.
+  bool IsFull() const { return pending_.size() == buffers_.size(); }
+  bool IsEmpty() const { return pending_.empty(); }
+
+  // Starts reading the currently bound framebuffer, which must hold a
+  // width x height image of "format". Must not be called when IsFull().
+  void Enqueue(int width, int height, GpuBufferFormat format,
+               Timestamp timestamp);
+
+  // Returns the oldest readback and sets "timestamp" to the one given to
+  // Enqueue. Returns nullptr when there is no readback, or when "wait" is false
+  // and the oldest one has not completed yet.
+  std::unique_ptr<ImageFrame> Dequeue(bool wait, Timestamp* timestamp);
+
+ private:
+  struct Readback {
+    GLuint buffer;
+    int width;
+    int height;
+    GpuBufferFormat format;
+    Timestamp timestamp;
+    std::shared_ptr<GlSyncPoint> sync;
+  };
+
+  std::vector<GLuint> buffers_;
+  int next_buffer_ = 0;
+  std::deque<Readback> pending_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_GPU_GL_ASYNC_READBACK_H_
@@ -24,6 +24,7 @@
 #include "absl/base/dynamic_annotations.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/strings/match.h"
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/ret_check.h"
@@ -37,6 +38,10 @@
 #include "mediapipe/gpu/gl_thread_collector.h"
 #endif
 
+#if HAS_EGL
+#include <EGL/eglext.h>
+#endif  // HAS_EGL
+
 #ifndef GL_MAJOR_VERSION
 #define GL_MAJOR_VERSION 0x821B
 #endif
@@ -278,6 +283,45 @@ absl::Status GlContext::GetGlExtensionsCompat() {
   return absl::OkStatus();
 }
 
+#if HAS_EGL
+// Entry points for EGL_KHR_fence_sync and EGL_KHR_wait_sync. These are
+// extensions, so they are looked up at runtime.
+struct EglSyncFunctions {
+  PFNEGLCREATESYNCKHRPROC create_sync = nullptr;
+  PFNEGLDESTROYSYNCKHRPROC destroy_sync = nullptr;
+  PFNEGLCLIENTWAITSYNCKHRPROC client_wait_sync = nullptr;
+  // Only available with EGL_KHR_wait_sync; may be null.
+  PFNEGLWAITSYNCKHRPROC wait_sync = nullptr;
+};
+
+static const EglSyncFunctions& GetEglSyncFunctions() {
+  static const EglSyncFunctions* functions = [] {
+    auto* f = new EglSyncFunctions;
+    f->create_sync = reinterpret_cast<PFNEGLCREATESYNCKHRPROC>(
+        eglGetProcAddress("eglCreateSyncKHR"));
+    f->destroy_sync = reinterpret_cast<PFNEGLDESTROYSYNCKHRPROC>(
+        eglGetProcAddress("eglDestroySyncKHR"));
+    f->client_wait_sync = reinterpret_cast<PFNEGLCLIENTWAITSYNCKHRPROC>(
+        eglGetProcAddress("eglClientWaitSyncKHR"));
+    f->wait_sync = reinterpret_cast<PFNEGLWAITSYNCKHRPROC>(
+        eglGetProcAddress("eglWaitSyncKHR"));
+    return f;
+  }();
+  return *functions;
+}
+
+// Returns true if EGL fence syncs can be created on the given display.
+static bool HasEglFenceSync(EGLDisplay display) {
+  if (display == EGL_NO_DISPLAY) return false;
+  const EglSyncFunctions& egl = GetEglSyncFunctions();
+  if (!egl.create_sync || !egl.destroy_sync || !egl.client_wait_sync) {
+    return false;
+  }
+  const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+  return extensions && absl::StrContains(extensions, "EGL_KHR_fence_sync");
+}
+#endif  // HAS_EGL
+
 absl::Status GlContext::FinishInitialization(bool create_thread) {
   if (create_thread) {
     thread_ = absl::make_unique<GlContext::DedicatedThread>();
@@ -352,6 +396,10 @@ absl::Status GlContext::FinishInitialization(bool create_thread) {
     can_linear_filter_float_textures_ = true;
 #endif  // GL_ES_VERSION_2_0
 
+#if HAS_EGL
+    has_egl_fence_sync_ = HasEglFenceSync(display_);
+#endif  // HAS_EGL
+
     return absl::OkStatus();
   });
 }
@@ -406,6 +454,8 @@ void GlContext::SetProfilingContext(
   if (!profiling_helper_ && profiling_context) {
     profiling_helper_ = profiling_context->CreateGlProfilingHelper();
   }
+  absl::MutexLock lock(&mutex_);
+  if (profiling_context) profiling_context_ = profiling_context;
 }
 
 absl::Status GlContext::SwitchContextAndRun(GlStatusFunction gl_func) {
@@ -545,9 +595,24 @@ std::shared_ptr<GlContext> GlContext::GetCurrent() {
 }
 
 void GlContext::GlFinishCalled() {
-  absl::MutexLock lock(&mutex_);
-  ++gl_finish_count_;
-  wait_for_gl_finish_cv_.SignalAll();
+  {
+    absl::MutexLock lock(&mutex_);
+    ++gl_finish_count_;
+    wait_for_gl_finish_cv_.SignalAll();
+  }
+  LogGlFinish();
+}
+
+void GlContext::LogGlFinish() {
+  std::shared_ptr<ProfilingContext> profiling_context;
+  {
+    absl::MutexLock lock(&mutex_);
+    profiling_context = profiling_context_.lock();
+  }
+  // The event data is the number of glFinish calls made so far, so that the
+  // remaining stalls can be counted from a trace.
+  LogEvent(profiling_context.get(), TraceEvent(TraceEvent::GPU_FINISH)
+                                        .set_event_data(gl_finish_count_));
 }
 
 class GlFinishSyncPoint : public GlSyncPoint {
@@ -749,6 +814,70 @@ class GlExternalFenceSyncPoint : public GlSyncPoint {
   std::shared_ptr<GlContext> graph_service_gl_context_;
 };
 
+#if HAS_EGL
+// A sync point backed by an EGLSyncKHR fence. This is used on contexts that
+// lack GL sync objects (e.g. GLES 2 on many Android devices), where we would
+// otherwise have to drain the whole pipeline with glFinish. Unlike GLsync
+// objects, EGL syncs belong to the display, so they can be waited on and
+// destroyed from any thread without going through the original context.
+class GlEglFenceSyncPoint : public GlSyncPoint {
+ public:
+  // If gl_context is null, the fence is inserted into the current context.
+  GlEglFenceSyncPoint(const std::shared_ptr<GlContext>& gl_context,
+                      EGLDisplay display)
+      : GlSyncPoint(gl_context), display_(display) {
+    if (gl_context_) {
+      gl_context_->Run([this] { Create(); });
+    } else {
+      Create();
+    }
+  }
+
+  ~GlEglFenceSyncPoint() override {
+    if (sync_ != EGL_NO_SYNC_KHR) {
+      GetEglSyncFunctions().destroy_sync(display_, sync_);
+    }
+  }
+
+  GlEglFenceSyncPoint(const GlEglFenceSyncPoint&) = delete;
+  GlEglFenceSyncPoint& operator=(const GlEglFenceSyncPoint&) = delete;
+
+  void Wait() override {
+    if (sync_ == EGL_NO_SYNC_KHR) return;
+    GetEglSyncFunctions().client_wait_sync(display_, sync_, 0,
+                                           EGL_FOREVER_KHR);
+  }
+
+  void WaitOnGpu() override {
+    if (sync_ == EGL_NO_SYNC_KHR) return;
+    const EglSyncFunctions& egl = GetEglSyncFunctions();
+    if (egl.wait_sync && eglGetCurrentContext() != EGL_NO_CONTEXT) {
+      egl.wait_sync(display_, sync_, 0);
+    } else {
+      Wait();
+    }
+  }
+
+  bool IsReady() override {
+    if (sync_ == EGL_NO_SYNC_KHR) return true;
+    return GetEglSyncFunctions().client_wait_sync(display_, sync_, 0, 0) ==
+           EGL_CONDITION_SATISFIED_KHR;
+  }
+
+ private:
+  void Create() {
+    sync_ = GetEglSyncFunctions().create_sync(display_, EGL_SYNC_FENCE_KHR,
+                                              /*attrib_list=*/nullptr);
+    // Flush here rather than passing EGL_SYNC_FLUSH_COMMANDS_BIT_KHR when
+    // waiting, since that only works from the context the fence came from.
+    glFlush();
+  }
+
+  EGLDisplay display_;
+  EGLSyncKHR sync_ = EGL_NO_SYNC_KHR;
+};
+#endif  // HAS_EGL
+
 void GlMultiSyncPoint::Add(std::shared_ptr<GlSyncPoint> new_sync) {
   if (new_sync->GetContext() != nullptr) {
     for (auto& sync : syncs_) {
@@ -819,6 +948,10 @@ std::shared_ptr<GlSyncPoint> GlContext::CreateSyncToken() {
 #else
   if (ShouldUseFenceSync()) {
     token.reset(new GlFenceSyncPoint(shared_from_this()));
+#if HAS_EGL
+  } else if (has_egl_fence_sync_) {
+    token.reset(new GlEglFenceSyncPoint(shared_from_this(), display_));
+#endif  // HAS_EGL
   } else {
     token.reset(new GlFinishSyncPoint(shared_from_this()));
   }
@@ -840,10 +973,17 @@ GlContext::CreateSyncTokenForCurrentExternalContext(
   if (delegate_graph_context->ShouldUseFenceSync()) {
     return std::shared_ptr<GlSyncPoint>(
         new GlExternalFenceSyncPoint(delegate_graph_context));
-  } else {
-    glFinish();
-    return nullptr;
   }
+#if HAS_EGL
+  EGLDisplay display = eglGetCurrentDisplay();
+  if (HasEglFenceSync(display)) {
+    return std::shared_ptr<GlSyncPoint>(
+        new GlEglFenceSyncPoint(nullptr, display));
+  }
+#endif  // HAS_EGL
+  glFinish();
+  delegate_graph_context->LogGlFinish();
+  return nullptr;
 }
 
 std::shared_ptr<GlSyncPoint> GlContext::TestOnly_CreateSpecificSyncToken(
@@ -166,6 +166,18 @@ class GlContext : public std::enable_shared_from_this<GlContext> {
   static StatusOrGlContext Create(EAGLSharegroup* sharegroup,
                                   bool create_thread);
 #endif  // HAS_EAGL
+#if HAS_EGL
+  // Creates a context on the display of the given EGL device, as listed by
+  // EGL_EXT_device_enumeration. Contexts created later with this one as the
+  // share context use the same device.
+  static StatusOrGlContext CreateOnEglDevice(int device_index,
+                                             bool create_thread);
+
+  // Returns the number of EGL devices that can be used with
+  // CreateOnEglDevice, or 0 if the EGL implementation does not support
+  // EGL_EXT_device_enumeration and EGL_EXT_platform_device.
+  static int GetEglDeviceCount();
+#endif  // HAS_EGL
 
   // Returns the GlContext that is current on this thread. May return nullptr.
   static std::shared_ptr<GlContext> GetCurrent();
@@ -196,7 +208,7 @@ class GlContext : public std::enable_shared_from_this<GlContext> {
   // If another part of the framework calls glFinish, it should call this
   // method to let the context know that it has done so. The context can use
   // that information to avoid inserting additional glFinish calls in some
-  // cases.
+  // cases. Each call is also logged to the profiler as a GPU_FINISH event.
   void GlFinishCalled();
 
   // Ensures that the changes to shared resources covered by the token are
@@ -310,8 +322,8 @@ class GlContext : public std::enable_shared_from_this<GlContext> {
   // Creates a synchronization token for the current, non-GlContext-owned
   // context. This can be passed to MediaPipe so it can synchronize with the
   // commands issued in the external context up to this point.
-  // Note: if the current context does not support sync fences, this calls
-  // glFinish and returns nullptr.
+  // Note: if the current context supports neither GL nor EGL sync fences,
+  // this calls glFinish and returns nullptr.
   // TODO: return GlNopSyncPoint instead?
   static std::shared_ptr<GlSyncPoint> CreateSyncTokenForCurrentExternalContext(
       const std::shared_ptr<GlContext>& delegate_graph_context);
@@ -329,6 +341,9 @@ class GlContext : public std::enable_shared_from_this<GlContext> {
 
   bool ShouldUseFenceSync() const;
 
+  // Logs a GPU_FINISH event to the profiling context, if any.
+  void LogGlFinish();
+
 #if defined(__EMSCRIPTEN__)
   absl::Status CreateContext(EMSCRIPTEN_WEBGL_CONTEXT_HANDLE share_context);
   absl::Status CreateContextInternal(
@@ -337,13 +352,22 @@ class GlContext : public std::enable_shared_from_this<GlContext> {
   EMSCRIPTEN_WEBGL_CONTEXT_HANDLE context_ = 0;
   EmscriptenWebGLContextAttributes attrs_;
 #elif HAS_EGL
-  absl::Status CreateContext(EGLContext share_context);
+  static StatusOrGlContext Create(EGLDisplay display,
+                                  EGLContext share_context,
+                                  bool create_thread);
+  // If display is EGL_NO_DISPLAY, the default display is used.
+  absl::Status CreateContext(EGLDisplay display, EGLContext share_context);
   absl::Status CreateContextInternal(EGLContext share_context, int gl_version);
 
   EGLDisplay display_ = EGL_NO_DISPLAY;
   EGLConfig config_;
   EGLSurface surface_ = EGL_NO_SURFACE;
   EGLContext context_ = EGL_NO_CONTEXT;
+
+  // True if the display supports EGL_KHR_fence_sync. Used for sync tokens
+  // when GL sync objects are not available, instead of falling back to
+  // glFinish.
+  bool has_egl_fence_sync_ = false;
 #elif HAS_EAGL
   absl::Status CreateContext(EAGLSharegroup* sharegroup);
 
@@ -466,6 +490,10 @@ class GlContext : public std::enable_shared_from_this<GlContext> {
   absl::CondVar wait_for_gl_finish_cv_ ABSL_GUARDED_BY(mutex_);
 
   std::unique_ptr<mediapipe::GlProfilingHelper> profiling_helper_ = nullptr;
+  // Receives GPU_FINISH events. Not owned, since the context can outlive the
+  // graph that set it.
+  std::weak_ptr<mediapipe::ProfilingContext> profiling_context_
+      ABSL_GUARDED_BY(mutex_);
 
   bool destructing_ = false;
 };
@@ -13,10 +13,13 @@
 // limitations under the License.
 
 #include <utility>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "mediapipe/framework/deps/no_destructor.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
@@ -28,6 +31,10 @@
 #define EGL_OPENGL_ES3_BIT_KHR 0x00000040
 #endif
 
+#ifndef EGL_PLATFORM_DEVICE_EXT
+#define EGL_PLATFORM_DEVICE_EXT 0x313F
+#endif
+
 #if HAS_EGL
 
 namespace mediapipe {
@@ -47,8 +54,11 @@ static void EglThreadExitCallback(void* key_value) {
   // implementations, and should be considered as an undocumented vendor
   // extension.
   // https://www.khronos.org/registry/EGL/sdk/docs/man/html/eglMakeCurrent.xhtml
-  eglMakeCurrent(eglGetDisplay(EGL_DEFAULT_DISPLAY), EGL_NO_SURFACE,
-                 EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  // The current display may belong to an EGL device rather than the default
+  // display, so prefer it when there is one.
+  EGLDisplay display = eglGetCurrentDisplay();
+  if (display == EGL_NO_DISPLAY) display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
 #endif
   eglReleaseThread();
 }
@@ -71,8 +81,55 @@ static void EnsureEglThreadRelease() {
                       reinterpret_cast<void*>(0xDEADBEEF));
 }
 
-static absl::StatusOr<EGLDisplay> GetInitializedDefaultEglDisplay() {
-  EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+// EGL devices are opaque handles (EGLDeviceEXT); the extension entry points
+// are declared locally so that older EGL headers still work.
+using EglDevice = void*;
+using PFN_eglQueryDevices = EGLBoolean (*)(EGLint max_devices,
+                                           EglDevice* devices,
+                                           EGLint* num_devices);
+using PFN_eglGetPlatformDisplay = EGLDisplay (*)(EGLenum platform,
+                                                 void* native_display,
+                                                 const EGLint* attrib_list);
+
+struct EglDevices {
+  PFN_eglGetPlatformDisplay get_platform_display = nullptr;
+  std::vector<EglDevice> devices;
+};
+
+// Enumerates the EGL devices once per process. The list is empty if the
+// client extensions needed to open a display per device are missing.
+static const EglDevices& GetEglDevices() {
+  static const NoDestructor<EglDevices> kDevices([] {
+    EglDevices result;
+    // Client extensions are queried on EGL_NO_DISPLAY; this returns null on
+    // implementations without EGL_EXT_client_extensions.
+    const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (!extensions ||
+        !absl::StrContains(extensions, "EGL_EXT_device_enumeration") ||
+        !absl::StrContains(extensions, "EGL_EXT_platform_device")) {
+      return result;
+    }
+    auto query_devices = reinterpret_cast<PFN_eglQueryDevices>(
+        eglGetProcAddress("eglQueryDevicesEXT"));
+    result.get_platform_display = reinterpret_cast<PFN_eglGetPlatformDisplay>(
+        eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (!query_devices || !result.get_platform_display) return result;
+    EGLint num_devices = 0;
+    if (!query_devices(0, nullptr, &num_devices) || num_devices <= 0) {
+      return result;
+    }
+    result.devices.resize(num_devices);
+    if (!query_devices(num_devices, result.devices.data(), &num_devices)) {
+      num_devices = 0;
+    }
+    result.devices.resize(num_devices);
+    LOG(INFO) << "Found " << num_devices << " EGL devices";
+    return result;
+  }());
+  return *kDevices;
+}
+
+static absl::StatusOr<EGLDisplay> InitializeEglDisplay(EGLDisplay display) {
   RET_CHECK(display != EGL_NO_DISPLAY)
       << "eglGetDisplay() returned error " << std::showbase << std::hex
       << eglGetError();
@@ -87,9 +144,18 @@ static absl::StatusOr<EGLDisplay> GetInitializedDefaultEglDisplay() {
   return display;
 }
 
-static absl::StatusOr<EGLDisplay> GetInitializedEglDisplay() {
-  auto status_or_display = GetInitializedDefaultEglDisplay();
-  return status_or_display;
+static absl::StatusOr<EGLDisplay> GetInitializedDefaultEglDisplay() {
+  return InitializeEglDisplay(eglGetDisplay(EGL_DEFAULT_DISPLAY));
+}
+
+static absl::StatusOr<EGLDisplay> GetInitializedEglDeviceDisplay(
+    int device_index) {
+  const EglDevices& egl_devices = GetEglDevices();
+  RET_CHECK(device_index >= 0 && device_index < egl_devices.devices.size())
+      << "EGL device " << device_index << " requested, but "
+      << egl_devices.devices.size() << " devices are available";
+  return InitializeEglDisplay(egl_devices.get_platform_display(
+      EGL_PLATFORM_DEVICE_EXT, egl_devices.devices[device_index], nullptr));
 }
 
 }  // namespace
@@ -101,13 +167,29 @@ GlContext::StatusOrGlContext GlContext::Create(std::nullptr_t nullp,
 
 GlContext::StatusOrGlContext GlContext::Create(const GlContext& share_context,
                                                bool create_thread) {
-  return Create(share_context.context_, create_thread);
+  // Contexts can only share with contexts on the same display.
+  return Create(share_context.display_, share_context.context_, create_thread);
 }
 
 GlContext::StatusOrGlContext GlContext::Create(EGLContext share_context,
                                                bool create_thread) {
+  return Create(EGL_NO_DISPLAY, share_context, create_thread);
+}
+
+GlContext::StatusOrGlContext GlContext::CreateOnEglDevice(int device_index,
+                                                          bool create_thread) {
+  ASSIGN_OR_RETURN(EGLDisplay display,
+                   GetInitializedEglDeviceDisplay(device_index));
+  return Create(display, EGL_NO_CONTEXT, create_thread);
+}
+
+int GlContext::GetEglDeviceCount() { return GetEglDevices().devices.size(); }
+
+GlContext::StatusOrGlContext GlContext::Create(EGLDisplay display,
+                                               EGLContext share_context,
+                                               bool create_thread) {
   std::shared_ptr<GlContext> context(new GlContext());
-  MP_RETURN_IF_ERROR(context->CreateContext(share_context));
+  MP_RETURN_IF_ERROR(context->CreateContext(display, share_context));
   MP_RETURN_IF_ERROR(context->FinishInitialization(create_thread));
   return std::move(context);
 }
@@ -175,8 +257,13 @@ absl::Status GlContext::CreateContextInternal(EGLContext share_context,
   return absl::OkStatus();
 }
 
-absl::Status GlContext::CreateContext(EGLContext share_context) {
-  ASSIGN_OR_RETURN(display_, GetInitializedEglDisplay());
+absl::Status GlContext::CreateContext(EGLDisplay display,
+                                      EGLContext share_context) {
+  if (display == EGL_NO_DISPLAY) {
+    ASSIGN_OR_RETURN(display_, GetInitializedDefaultEglDisplay());
+  } else {
+    display_ = display;
+  }
 
   auto status = CreateContextInternal(share_context, 3);
   if (!status.ok()) {
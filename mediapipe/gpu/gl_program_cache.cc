@@ -0,0 +1,268 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/gpu/gl_program_cache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/logging.h"
+
+// WebGL and legacy desktop GL have no program binaries.
+#if defined(__EMSCRIPTEN__) || (HAS_NSGL && !CGL_VERSION_1_3)
+#define MEDIAPIPE_HAS_GL_PROGRAM_BINARY 0
+#else
+#define MEDIAPIPE_HAS_GL_PROGRAM_BINARY 1
+#endif
+
+namespace mediapipe {
+
+namespace {
+
+// Written at the start of cache files, followed by the binary format, the
+// key size, the key and the binary.
+constexpr absl::string_view kFileMagic = "MPGLPRG1";
+
+struct ProgramBinary {
+  GLenum format;
+  std::string data;
+};
+
+struct ProgramCache {
+  absl::Mutex mutex;
+  std::string directory ABSL_GUARDED_BY(mutex);
+  bool directory_created ABSL_GUARDED_BY(mutex) = false;
+  absl::flat_hash_map<std::string, std::shared_ptr<const ProgramBinary>>
+      binaries ABSL_GUARDED_BY(mutex);
+};
+
+ProgramCache& GetProgramCache() {
+  static ProgramCache* cache = new ProgramCache();
+  return *cache;
+}
+
+// FNV-1a, which unlike absl::Hash is stable across runs.
+uint64_t StableHash(absl::string_view data) {
+  uint64_t hash = 0xcbf29ce484222325;
+  for (char c : data) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 0x00000100000001B3;
+  }
+  return hash;
+}
+
+void AppendUint32(uint32_t value, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool ConsumeUint32(absl::string_view* in, uint32_t* value) {
+  if (in->size() < sizeof(*value)) return false;
+  std::memcpy(value, in->data(), sizeof(*value));
+  in->remove_prefix(sizeof(*value));
+  return true;
+}
+
+// Returns the file for key, creating the directory if needed, or an empty
+// string if binaries are not persisted.
+std::string CacheFilePath(const std::string& key, bool create_directory) {
+  ProgramCache& cache = GetProgramCache();
+  absl::MutexLock lock(&cache.mutex);
+  if (cache.directory.empty()) return "";
+  if (create_directory && !cache.directory_created) {
+    absl::Status status = file::RecursivelyCreateDir(cache.directory);
+    if (!status.ok()) {
+      LOG(WARNING) << "Cannot create GL program cache directory: " << status;
+      return "";
+    }
+    cache.directory_created = true;
+  }
+  return file::JoinPath(cache.directory,
+                        absl::StrCat(absl::Hex(StableHash(key),
+                                               absl::kZeroPad16),
+                                     ".bin"));
+}
+
+std::shared_ptr<const ProgramBinary> ReadCacheFile(const std::string& key) {
+  const std::string path = CacheFilePath(key, /*create_directory=*/false);
+  if (path.empty() || !file::Exists(path).ok()) return nullptr;
+  std::string contents;
+  if (!file::GetContents(path, &contents).ok()) return nullptr;
+  absl::string_view in = contents;
+  uint32_t format;
+  uint32_t key_size;
+  if (!absl::ConsumePrefix(&in, kFileMagic) || !ConsumeUint32(&in, &format) ||
+      !ConsumeUint32(&in, &key_size) || in.size() < key_size ||
+      in.substr(0, key_size) != key) {
+    // A different program with the same hash, or a corrupted file.
+    return nullptr;
+  }
+  in.remove_prefix(key_size);
+  return std::make_shared<ProgramBinary>(
+      ProgramBinary{static_cast<GLenum>(format), std::string(in)});
+}
+
+void WriteCacheFile(const std::string& key, const ProgramBinary& binary) {
+  const std::string path = CacheFilePath(key, /*create_directory=*/true);
+  if (path.empty()) return;
+  std::string contents(kFileMagic);
+  AppendUint32(binary.format, &contents);
+  AppendUint32(key.size(), &contents);
+  absl::StrAppend(&contents, key, binary.data);
+  // Write to a temporary file first, so that a concurrent reader or a crash
+  // never leaves a truncated binary behind.
+  const std::string temp_path = absl::StrCat(path, ".tmp");
+  absl::Status status = file::SetContents(temp_path, contents);
+  if (status.ok() && std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    status = absl::UnknownError(absl::StrCat("Cannot rename ", temp_path));
+  }
+  LOG_IF(WARNING, !status.ok())
+      << "Cannot write GL program cache file: " << status;
+}
+
+void DropBinary(const std::string& key) {
+  {
+    ProgramCache& cache = GetProgramCache();
+    absl::MutexLock lock(&cache.mutex);
+    cache.binaries.erase(key);
+  }
+  const std::string path = CacheFilePath(key, /*create_directory=*/false);
+  if (!path.empty()) std::remove(path.c_str());
+}
+
+}  // namespace
+
+void SetGlProgramCacheDirectory(const std::string& path) {
+  ProgramCache& cache = GetProgramCache();
+  absl::MutexLock lock(&cache.mutex);
+  cache.directory = path;
+  cache.directory_created = false;
+}
+
+bool GlProgramBinariesSupported() {
+#if MEDIAPIPE_HAS_GL_PROGRAM_BINARY
+  if (!SymbolAvailable(&glGetProgramBinary) ||
+      !SymbolAvailable(&glProgramBinary)) {
+    return false;
+  }
+  const char* version =
+      reinterpret_cast<const char*>(glGetString(GL_VERSION));
+  if (version == nullptr) return false;
+  // Program binaries need OpenGL ES 3.0 or OpenGL 4.1.
+  int major = 0;
+  int minor = 0;
+  if (absl::StartsWith(version, "OpenGL ES ")) {
+    if (std::sscanf(version + 10, "%d.%d", &major, &minor) != 2 || major < 3) {
+      return false;
+    }
+  } else if (std::sscanf(version, "%d.%d", &major, &minor) != 2 ||
+             major * 10 + minor < 41) {
+    return false;
+  }
+  GLint num_formats = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+  return num_formats > 0;
+#else
+  return false;
+#endif  // MEDIAPIPE_HAS_GL_PROGRAM_BINARY
+}
+
+std::string GlProgramCacheKey(const GLchar* vert_src, const GLchar* frag_src,
+                              GLsizei attr_count,
+                              const GLchar* const* attr_names,
+                              const GLint* attr_locations) {
+  auto gl_string = [](GLenum name) -> absl::string_view {
+    const char* value = reinterpret_cast<const char*>(glGetString(name));
+    return value ? value : "";
+  };
+  // Fields are separated by a character that cannot appear in them.
+  std::string key = absl::StrCat(gl_string(GL_VENDOR), "\n",
+                                 gl_string(GL_RENDERER), "\n",
+                                 gl_string(GL_VERSION), "\n");
+  for (int i = 0; i < attr_count; ++i) {
+    absl::StrAppend(&key, attr_locations[i], "=", attr_names[i], "\n");
+  }
+  key.push_back('\0');
+  absl::StrAppend(&key, vert_src);
+  key.push_back('\0');
+  absl::StrAppend(&key, frag_src);
+  return key;
+}
+
+bool LoadGlProgramBinary(const std::string& key, GLuint program) {
+#if MEDIAPIPE_HAS_GL_PROGRAM_BINARY
+  ProgramCache& cache = GetProgramCache();
+  std::shared_ptr<const ProgramBinary> binary;
+  {
+    absl::MutexLock lock(&cache.mutex);
+    auto it = cache.binaries.find(key);
+    if (it != cache.binaries.end()) binary = it->second;
+  }
+  if (!binary) {
+    binary = ReadCacheFile(key);
+    if (!binary) return false;
+    absl::MutexLock lock(&cache.mutex);
+    cache.binaries.emplace(key, binary);
+  }
+  glProgramBinary(program, binary->format, binary->data.data(),
+                  binary->data.size());
+  GLint status = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &status);
+  if (status == GL_FALSE) {
+    // Usually a driver update that kept the version strings.
+    VLOG(1) << "GL program binary rejected by the driver; recompiling";
+    DropBinary(key);
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif  // MEDIAPIPE_HAS_GL_PROGRAM_BINARY
+}
+
+void PrepareGlProgramForBinaryCache(GLuint program) {
+#if MEDIAPIPE_HAS_GL_PROGRAM_BINARY
+  glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif  // MEDIAPIPE_HAS_GL_PROGRAM_BINARY
+}
+
+void StoreGlProgramBinary(const std::string& key, GLuint program) {
+#if MEDIAPIPE_HAS_GL_PROGRAM_BINARY
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) return;
+  auto binary = std::make_shared<ProgramBinary>();
+  binary->data.resize(length);
+  glGetProgramBinary(program, length, &length, &binary->format,
+                     &binary->data[0]);
+  if (length <= 0) return;
+  binary->data.resize(length);
+  {
+    ProgramCache& cache = GetProgramCache();
+    absl::MutexLock lock(&cache.mutex);
+    cache.binaries.insert_or_assign(key, binary);
+  }
+  WriteCacheFile(key, *binary);
+#endif  // MEDIAPIPE_HAS_GL_PROGRAM_BINARY
+}
+
+}  // namespace mediapipe
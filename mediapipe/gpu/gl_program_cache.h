@@ -0,0 +1,59 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Caches linked GL program binaries, so that programs built from the same
+// shader sources are not compiled and linked again. Binaries are shared in
+// memory by all programs created in the process, and can be persisted to a
+// directory so that later runs of the application skip shader compilation.
+//
+// Binaries are keyed by the shader sources, the attribute bindings and the GL
+// vendor, renderer and version strings, so a driver update invalidates them.
+// Loading a binary the driver rejects falls back to compiling the program.
+
+#ifndef MEDIAPIPE_GPU_GL_PROGRAM_CACHE_H_
+#define MEDIAPIPE_GPU_GL_PROGRAM_CACHE_H_
+
+#include <string>
+
+#include "mediapipe/gpu/gl_base.h"
+
+namespace mediapipe {
+
+// Sets the directory where program binaries are stored across runs. It is
+// created if needed. An empty path, the default, keeps binaries in memory
+// only.
+void SetGlProgramCacheDirectory(const std::string& path);
+
+// Returns true if the current GL context can save and load program binaries.
+bool GlProgramBinariesSupported();
+
+// Returns the cache key for a program built with the current GL context.
+std::string GlProgramCacheKey(const GLchar* vert_src, const GLchar* frag_src,
+                              GLsizei attr_count,
+                              const GLchar* const* attr_names,
+                              const GLint* attr_locations);
+
+// Loads the cached binary for key into program. Returns true if program was
+// successfully linked from it.
+bool LoadGlProgramBinary(const std::string& key, GLuint program);
+
+// Asks the driver to keep the binary of program retrievable. Must be called
+// before linking a program that will be passed to StoreGlProgramBinary.
+void PrepareGlProgramForBinaryCache(GLuint program);
+
+// Stores the binary of the linked program under key.
+void StoreGlProgramBinary(const std::string& key, GLuint program);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_GPU_GL_PROGRAM_CACHE_H_
@@ -12,6 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <utility>
+#include <vector>
+
+#include "mediapipe/calculators/image/scale_image_utils.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/port/ret_check.h"
@@ -40,6 +44,7 @@ constexpr char kOptionsTag[] = "OPTIONS";
 constexpr char kOutputDimensionsTag[] = "OUTPUT_DIMENSIONS";
 constexpr char kRotationTag[] = "ROTATION";
 constexpr char kImageTag[] = "IMAGE";
+constexpr char kPyramidTag[] = "PYRAMID";
 
 using Image = mediapipe::Image;
 
@@ -63,6 +68,8 @@ using Image = mediapipe::Image;
 //   required output size is 6x5, then the left and right side of the image will
 //   both having padding of 1 pixels. So the value of output stream is 1 / 5 =
 //   0.2.
+//   PYRAMID: One stream per pyramid_width option, e.g. PYRAMID:0 and PYRAMID:1,
+//   with smaller versions of the output, each rendered from the previous one.
 // Additional input side packets:
 //   OPTIONS: the GlScalerCalculatorOptions to use. Will replace or merge with
 //   existing calculator options, depending on field merge_fields.
@@ -104,6 +111,7 @@ class GlScalerCalculator : public CalculatorBase {
   bool vertical_flip_output_;
   bool horizontal_flip_output_;
   FrameScaleMode scale_mode_ = FrameScaleMode::kStretch;
+  std::vector<int> pyramid_widths_;
 };
 REGISTER_CALCULATOR(GlScalerCalculator);
 
@@ -145,6 +153,13 @@ absl::Status GlScalerCalculator::GetContract(CalculatorContract* cc) {
     cc->Outputs().Tag(kTopBottomPaddingTag).Set<float>();
     cc->Outputs().Tag(kLeftRightPaddingTag).Set<float>();
   }
+  for (int i = 0; i < cc->Outputs().NumEntries(kPyramidTag); ++i) {
+    if (cc->Outputs().HasTag(kImageTag)) {
+      cc->Outputs().Get(kPyramidTag, i).Set<Image>();
+    } else {
+      cc->Outputs().Get(kPyramidTag, i).Set<GpuBuffer>();
+    }
+  }
   return absl::OkStatus();
 }
 
@@ -186,6 +201,10 @@ absl::Status GlScalerCalculator::Open(CalculatorContext* cc) {
     scale_mode_ =
         FrameScaleModeFromProto(options.scale_mode(), FrameScaleMode::kStretch);
   }
+  pyramid_widths_.assign(options.pyramid_width().begin(),
+                         options.pyramid_width().end());
+  RET_CHECK_EQ(pyramid_widths_.size(), cc->Outputs().NumEntries(kPyramidTag))
+      << "Each pyramid_width needs a PYRAMID output stream.";
 
   if (HasTagOrIndex(cc->InputSidePackets(), "OUTPUT_DIMENSIONS", 1)) {
     const auto& dimensions =
@@ -309,15 +328,54 @@ absl::Status GlScalerCalculator::Process(CalculatorContext* cc) {
       glBindTexture(src2.target(), 0);
     }
 
+    // Each pyramid level is rendered from the previous one.
+    std::vector<GlTexture> levels;
+    if (!pyramid_widths_.empty()) {
+      std::vector<std::pair<int, int>> level_dimensions;
+      MP_RETURN_IF_ERROR(scale_image::FindPyramidDimensions(
+          dst.width(), dst.height(), pyramid_widths_, &level_dimensions));
+      if (!rgb_renderer_) {
+        rgb_renderer_ = absl::make_unique<QuadRenderer>();
+        MP_RETURN_IF_ERROR(rgb_renderer_->GlSetup());
+      }
+      levels.reserve(level_dimensions.size());
+      for (const auto& [width, height] : level_dimensions) {
+        const GlTexture& previous = levels.empty() ? dst : levels.back();
+        GlTexture level =
+            helper_.CreateDestinationTexture(width, height, GetOutputFormat());
+        helper_.BindFramebuffer(level);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(previous.target(), previous.name());
+        MP_RETURN_IF_ERROR(rgb_renderer_->GlRender(
+            previous.width(), previous.height(), level.width(), level.height(),
+            FrameScaleMode::kStretch, FrameRotation::kNone,
+            /*flip_horizontal=*/false, /*flip_vertical=*/false,
+            /*flip_texture=*/false));
+        glBindTexture(previous.target(), 0);
+        levels.push_back(std::move(level));
+      }
+    }
+
     glFlush();
 
     if (cc->Outputs().HasTag(kImageTag)) {
       auto output = dst.GetFrame<Image>();
       cc->Outputs().Tag(kImageTag).Add(output.release(), cc->InputTimestamp());
+      for (int i = 0; i < levels.size(); ++i) {
+        cc->Outputs()
+            .Get(kPyramidTag, i)
+            .Add(levels[i].GetFrame<Image>().release(), cc->InputTimestamp());
+      }
     } else {
       auto output = dst.GetFrame<GpuBuffer>();
       TagOrIndex(&cc->Outputs(), "VIDEO", 0)
           .Add(output.release(), cc->InputTimestamp());
+      for (int i = 0; i < levels.size(); ++i) {
+        cc->Outputs()
+            .Get(kPyramidTag, i)
+            .Add(levels[i].GetFrame<GpuBuffer>().release(),
+                 cc->InputTimestamp());
+      }
     }
 
     return absl::OkStatus();
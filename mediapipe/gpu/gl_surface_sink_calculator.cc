@@ -12,16 +12,24 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
+#include <vector>
+
 #include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/counter.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/gpu/egl_surface_holder.h"
 #include "mediapipe/gpu/gl_calculator_helper.h"
+#include "mediapipe/gpu/gl_context.h"
 #include "mediapipe/gpu/gl_quad_renderer.h"
 #include "mediapipe/gpu/gl_surface_sink_calculator.pb.h"
+#include "mediapipe/gpu/gl_texture_view.h"
 #include "mediapipe/gpu/gpu_buffer.h"
 #include "mediapipe/gpu/shader_util.h"
 
@@ -39,7 +47,9 @@ enum { kAttribVertex, kAttribTexturePosition, kNumberOfAttributes };
 //   SURFACE: unique_ptr to an EglSurfaceHolder to draw to.
 //   GPU_SHARED: shared GPU resources.
 //
-// See GlSurfaceSinkCalculatorOptions for options.
+// See GlSurfaceSinkCalculatorOptions for options. With decoupled_presentation,
+// frames are drawn and swapped on a separate present thread, so Process does
+// not wait for the display.
 class GlSurfaceSinkCalculator : public Node {
  public:
   static constexpr Input<
@@ -58,14 +68,49 @@ class GlSurfaceSinkCalculator : public Node {
 
   absl::Status Open(CalculatorContext* cc) final;
   absl::Status Process(CalculatorContext* cc) final;
+  absl::Status Close(CalculatorContext* cc) final;
 
  private:
+  // A frame in the presentation ring.
+  struct RingSlot {
+    mediapipe::GpuBuffer buffer;
+    // When the copy into the ring was submitted.
+    absl::Time ready_time;
+  };
+
+  // Draws the texture to the surface and swaps buffers. Must be called in a
+  // GL context, with surface_holder_->mutex held.
+  absl::Status RenderToSurface(mediapipe::QuadRenderer& renderer,
+                               EGLSurface surface, GLenum target, GLuint name,
+                               int width, int height)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(surface_holder_->mutex);
+  // Copies the input into a free ring slot and schedules its presentation.
+  // Runs in the graph's GL context.
+  absl::Status EnqueueForPresentation(const mediapipe::GpuBuffer& input);
+  // Presents the newest ready slot. Runs on the present thread.
+  void PresentLatest();
+
   mediapipe::GlCalculatorHelper helper_;
   mediapipe::EglSurfaceHolder* surface_holder_;
   bool initialized_ = false;
   std::unique_ptr<mediapipe::QuadRenderer> renderer_;
   mediapipe::FrameScaleMode scale_mode_ =
       mediapipe::FrameScaleMode::kFillAndCrop;
+
+  // Decoupled presentation state. present_context_ shares resources with the
+  // graph's context and owns the present thread.
+  std::shared_ptr<mediapipe::GlContext> present_context_;
+  // Only used on the present thread.
+  std::unique_ptr<mediapipe::QuadRenderer> present_renderer_;
+  // A slot is owned by Process unless it is the ready or the presenting one.
+  std::vector<RingSlot> ring_;
+  absl::Mutex ring_mutex_;
+  int ready_slot_ ABSL_GUARDED_BY(ring_mutex_) = -1;
+  int presenting_slot_ ABSL_GUARDED_BY(ring_mutex_) = -1;
+  bool present_scheduled_ ABSL_GUARDED_BY(ring_mutex_) = false;
+  Counter* presented_frames_ = nullptr;
+  Counter* dropped_frames_ = nullptr;
+  Counter* present_latency_usec_ = nullptr;
 };
 MEDIAPIPE_REGISTER_NODE(GlSurfaceSinkCalculator);
 
@@ -88,18 +133,70 @@ absl::Status GlSurfaceSinkCalculator::Open(CalculatorContext* cc) {
       mediapipe::FrameScaleMode::kFillAndCrop);
 
   // Let the helper access the GL context information.
-  return helper_.Open(cc);
+  MP_RETURN_IF_ERROR(helper_.Open(cc));
+
+  const auto& options =
+      cc->Options<mediapipe::GlSurfaceSinkCalculatorOptions>();
+  if (options.decoupled_presentation()) {
+    RET_CHECK_GE(options.presentation_ring_size(), 3)
+        << "Decoupled presentation needs a ring of at least 3 textures.";
+    ring_.resize(options.presentation_ring_size());
+    ASSIGN_OR_RETURN(present_context_,
+                     mediapipe::GlContext::Create(helper_.GetGlContext(),
+                                                  /*create_thread=*/true));
+    presented_frames_ = cc->GetCounter("GlSurfaceSinkCalculator.presented");
+    dropped_frames_ = cc->GetCounter("GlSurfaceSinkCalculator.dropped");
+    present_latency_usec_ =
+        cc->GetCounter("GlSurfaceSinkCalculator.present_latency_usec");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status GlSurfaceSinkCalculator::RenderToSurface(
+    mediapipe::QuadRenderer& renderer, EGLSurface surface, GLenum target,
+    GLuint name, int width, int height) {
+  EGLSurface old_surface = eglGetCurrentSurface(EGL_DRAW);
+  EGLDisplay display = eglGetCurrentDisplay();
+  EGLContext context = eglGetCurrentContext();
+
+  // Note that eglMakeCurrent can be very slow on Android if you use it to
+  // change the current context, but it is fast if you only change the
+  // current surface.
+  EGLBoolean success = eglMakeCurrent(display, surface, surface, context);
+  RET_CHECK(success) << "failed to make surface current";
+
+  EGLint dst_width;
+  success = eglQuerySurface(display, surface, EGL_WIDTH, &dst_width);
+  RET_CHECK(success) << "failed to query surface width";
+
+  EGLint dst_height;
+  success = eglQuerySurface(display, surface, EGL_HEIGHT, &dst_height);
+  RET_CHECK(success) << "failed to query surface height";
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glViewport(0, 0, dst_width, dst_height);
+
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(target, name);
+
+  MP_RETURN_IF_ERROR(renderer.GlRender(
+      width, height, dst_width, dst_height, scale_mode_,
+      mediapipe::FrameRotation::kNone,
+      /*flip_horizontal=*/false, /*flip_vertical=*/false,
+      /*flip_texture=*/surface_holder_->flip_y));
+
+  glBindTexture(target, 0);
+
+  success = eglSwapBuffers(display, surface);
+  RET_CHECK(success) << "failed to swap buffers";
+
+  success = eglMakeCurrent(display, old_surface, old_surface, context);
+  RET_CHECK(success) << "failed to restore old surface";
+  return absl::OkStatus();
 }
 
 absl::Status GlSurfaceSinkCalculator::Process(CalculatorContext* cc) {
   return helper_.RunInGlContext([this, &cc]() -> absl::Status {
-    absl::MutexLock lock(&surface_holder_->mutex);
-    EGLSurface surface = surface_holder_->surface;
-    if (surface == EGL_NO_SURFACE) {
-      LOG_EVERY_N(INFO, 300) << "GlSurfaceSinkCalculator: no surface";
-      return absl::OkStatus();
-    }
-
     mediapipe::Packet packet;
     if (kInVideo(cc).IsConnected())
       packet = kInVideo(cc).packet();
@@ -118,49 +215,116 @@ absl::Status GlSurfaceSinkCalculator::Process(CalculatorContext* cc) {
       initialized_ = true;
     }
 
-    auto src = helper_.CreateSourceTexture(input);
-
-    EGLSurface old_surface = eglGetCurrentSurface(EGL_DRAW);
-    EGLDisplay display = eglGetCurrentDisplay();
-    EGLContext context = eglGetCurrentContext();
-
-    // Note that eglMakeCurrent can be very slow on Android if you use it to
-    // change the current context, but it is fast if you only change the
-    // current surface.
-    EGLBoolean success = eglMakeCurrent(display, surface, surface, context);
-    RET_CHECK(success) << "failed to make surface current";
+    if (present_context_) return EnqueueForPresentation(input);
 
-    EGLint dst_width;
-    success = eglQuerySurface(display, surface, EGL_WIDTH, &dst_width);
-    RET_CHECK(success) << "failed to query surface width";
-
-    EGLint dst_height;
-    success = eglQuerySurface(display, surface, EGL_HEIGHT, &dst_height);
-    RET_CHECK(success) << "failed to query surface height";
+    absl::MutexLock lock(&surface_holder_->mutex);
+    EGLSurface surface = surface_holder_->surface;
+    if (surface == EGL_NO_SURFACE) {
+      LOG_EVERY_N(INFO, 300) << "GlSurfaceSinkCalculator: no surface";
+      return absl::OkStatus();
+    }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glViewport(0, 0, dst_width, dst_height);
+    auto src = helper_.CreateSourceTexture(input);
+    MP_RETURN_IF_ERROR(RenderToSurface(*renderer_, surface, src.target(),
+                                       src.name(), src.width(), src.height()));
+    src.Release();
+    return absl::OkStatus();
+  });
+}
 
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(src.target(), src.name());
+absl::Status GlSurfaceSinkCalculator::EnqueueForPresentation(
+    const mediapipe::GpuBuffer& input) {
+  int slot = 0;
+  {
+    absl::MutexLock lock(&ring_mutex_);
+    while (slot == ready_slot_ || slot == presenting_slot_) ++slot;
+  }
 
-    MP_RETURN_IF_ERROR(
-        renderer_->GlRender(src.width(), src.height(), dst_width, dst_height,
-                            scale_mode_, mediapipe::FrameRotation::kNone,
-                            /*flip_horizontal=*/false, /*flip_vertical=*/false,
-                            /*flip_texture=*/surface_holder_->flip_y));
+  // Copy the frame so that the input buffer goes back to its producer right
+  // away, whenever the display gets around to it.
+  auto src = helper_.CreateSourceTexture(input);
+  auto dst = helper_.CreateDestinationTexture(src.width(), src.height());
+  helper_.BindFramebuffer(dst);
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(src.target(), src.name());
+  MP_RETURN_IF_ERROR(renderer_->GlRender(
+      src.width(), src.height(), dst.width(), dst.height(),
+      mediapipe::FrameScaleMode::kStretch, mediapipe::FrameRotation::kNone,
+      /*flip_horizontal=*/false, /*flip_vertical=*/false,
+      /*flip_texture=*/false));
+  glBindTexture(src.target(), 0);
+  glFlush();
+  ring_[slot].buffer = std::move(*dst.GetFrame<mediapipe::GpuBuffer>());
+  ring_[slot].ready_time = absl::Now();
+  src.Release();
+  dst.Release();
+
+  bool schedule = false;
+  {
+    absl::MutexLock lock(&ring_mutex_);
+    if (ready_slot_ >= 0) dropped_frames_->Increment();
+    ready_slot_ = slot;
+    schedule = !present_scheduled_;
+    present_scheduled_ = true;
+  }
+  if (schedule) {
+    present_context_->RunWithoutWaiting([this] { PresentLatest(); });
+  }
+  return absl::OkStatus();
+}
 
-    glBindTexture(src.target(), 0);
+void GlSurfaceSinkCalculator::PresentLatest() {
+  int slot;
+  {
+    absl::MutexLock lock(&ring_mutex_);
+    present_scheduled_ = false;
+    if (ready_slot_ < 0) return;
+    slot = presenting_slot_ = ready_slot_;
+    ready_slot_ = -1;
+  }
+  const absl::Time ready_time = ring_[slot].ready_time;
 
-    success = eglSwapBuffers(display, surface);
-    RET_CHECK(success) << "failed to swap buffers";
+  absl::Status status = [&]() -> absl::Status {
+    if (!present_renderer_) {
+      present_renderer_ = absl::make_unique<mediapipe::QuadRenderer>();
+      MP_RETURN_IF_ERROR(present_renderer_->GlSetup());
+    }
+    auto view = ring_[slot].buffer.GetReadView<mediapipe::GlTextureView>(0);
+    absl::MutexLock lock(&surface_holder_->mutex);
+    EGLSurface surface = surface_holder_->surface;
+    if (surface == EGL_NO_SURFACE) {
+      LOG_EVERY_N(INFO, 300) << "GlSurfaceSinkCalculator: no surface";
+      return absl::OkStatus();
+    }
+    return RenderToSurface(*present_renderer_, surface, view.target(),
+                           view.name(), view.width(), view.height());
+  }();
 
-    success = eglMakeCurrent(display, old_surface, old_surface, context);
-    RET_CHECK(success) << "failed to restore old surface";
+  {
+    absl::MutexLock lock(&ring_mutex_);
+    presenting_slot_ = -1;
+  }
+  if (!status.ok()) {
+    LOG_EVERY_N(ERROR, 100) << "GlSurfaceSinkCalculator: " << status;
+    return;
+  }
+  presented_frames_->Increment();
+  present_latency_usec_->IncrementBy(
+      absl::ToInt64Microseconds(absl::Now() - ready_time));
+}
 
-    src.Release();
-    return absl::OkStatus();
+absl::Status GlSurfaceSinkCalculator::Close(CalculatorContext* cc) {
+  if (!present_context_) return absl::OkStatus();
+  // Tasks run in order, so this waits for any pending presentation.
+  present_context_->Run([this] {
+    if (present_renderer_) {
+      present_renderer_->GlTeardown();
+      present_renderer_.reset();
+    }
   });
+  ring_.clear();
+  present_context_.reset();
+  return absl::OkStatus();
 }
 
 GlSurfaceSinkCalculator::~GlSurfaceSinkCalculator() {
@@ -18,6 +18,10 @@
 
 namespace mediapipe {
 
+// Returned buffers are merged into the available list once this many have
+// piled up, or earlier when a buffer is requested.
+static constexpr int kReturnBatchSize = 4;
+
 GlTextureBufferPool::GlTextureBufferPool(int width, int height,
                                          GpuBufferFormat format, int keep_count)
     : width_(width),
@@ -27,10 +31,12 @@ GlTextureBufferPool::GlTextureBufferPool(int width, int height,
 
 GlTextureBufferSharedPtr GlTextureBufferPool::GetBuffer() {
   std::unique_ptr<GlTextureBuffer> buffer;
+  std::vector<std::unique_ptr<GlTextureBuffer>> trimmed;
   bool reuse = false;
 
   {
     absl::MutexLock lock(&mutex_);
+    MergeReturned(&trimmed);
     if (available_.empty()) {
       buffer = GlTextureBuffer::Create(width_, height_, format_);
       if (!buffer) return nullptr;
@@ -64,21 +70,43 @@ GlTextureBufferSharedPtr GlTextureBufferPool::GetBuffer() {
 }
 
 std::pair<int, int> GlTextureBufferPool::GetInUseAndAvailableCounts() {
+  std::vector<std::unique_ptr<GlTextureBuffer>> trimmed;
   absl::MutexLock lock(&mutex_);
+  MergeReturned(&trimmed);
   return {in_use_count_, available_.size()};
 }
 
+int GlTextureBufferPool::ReleaseAvailable(int keep_available) {
+  std::vector<std::unique_ptr<GlTextureBuffer>> released;
+  {
+    absl::MutexLock lock(&mutex_);
+    MergeReturned(&released);
+    if (available_.size() > keep_available) {
+      auto release_it = std::next(available_.begin(), keep_available);
+      std::move(release_it, available_.end(), std::back_inserter(released));
+      available_.erase(release_it, available_.end());
+    }
+  }
+  // The released buffers will be destroyed without holding the lock.
+  return released.size();
+}
+
 void GlTextureBufferPool::Return(std::unique_ptr<GlTextureBuffer> buf) {
+  if (returned_.Push(std::move(buf)) < kReturnBatchSize) return;
   std::vector<std::unique_ptr<GlTextureBuffer>> trimmed;
   {
     absl::MutexLock lock(&mutex_);
-    --in_use_count_;
-    available_.emplace_back(std::move(buf));
-    TrimAvailable(&trimmed);
+    MergeReturned(&trimmed);
   }
   // The trimmed buffers will be released without holding the lock.
 }
 
+void GlTextureBufferPool::MergeReturned(
+    std::vector<std::unique_ptr<GlTextureBuffer>>* trimmed) {
+  in_use_count_ -= returned_.TakeAll(&available_);
+  TrimAvailable(trimmed);
+}
+
 void GlTextureBufferPool::TrimAvailable(
     std::vector<std::unique_ptr<GlTextureBuffer>>* trimmed) {
   int keep = std::max(keep_count_ - in_use_count_, 0);
@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/formats/concurrent_pool_util.h"
 #include "mediapipe/gpu/gl_texture_buffer.h"
 
 namespace mediapipe {
@@ -51,13 +52,22 @@ class GlTextureBufferPool
   // This method is meant for testing.
   std::pair<int, int> GetInUseAndAvailableCounts();
 
+  // Releases available buffers, keeping at most keep_available of them for
+  // reuse. Returns the number of buffers released.
+  int ReleaseAvailable(int keep_available);
+
  private:
   GlTextureBufferPool(int width, int height, GpuBufferFormat format,
                       int keep_count);
 
-  // Return a buffer to the pool.
+  // Return a buffer to the pool. This does not take the lock unless enough
+  // buffers have been returned to merge them into available_.
   void Return(std::unique_ptr<GlTextureBuffer> buf);
 
+  // Moves the returned buffers to available_, then trims it.
+  void MergeReturned(std::vector<std::unique_ptr<GlTextureBuffer>>* trimmed)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   // If the total number of buffers is greater than keep_count, destroys any
   // surplus buffers that are no longer in use.
   void TrimAvailable(std::vector<std::unique_ptr<GlTextureBuffer>>* trimmed)
@@ -72,6 +82,7 @@ class GlTextureBufferPool
   int in_use_count_ ABSL_GUARDED_BY(mutex_) = 0;
   std::vector<std::unique_ptr<GlTextureBuffer>> available_
       ABSL_GUARDED_BY(mutex_);
+  PoolReturnList<GlTextureBuffer> returned_;
 };
 
 }  // namespace mediapipe
@@ -4,6 +4,7 @@
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "mediapipe/framework/packet_payload_size.h"
 #include "mediapipe/framework/port/logging.h"
 
 #if MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
@@ -89,4 +90,17 @@ CVPixelBufferRef GetCVPixelBufferRef(const GpuBuffer& buffer) {
 #endif  // MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
 #endif  // !MEDIAPIPE_DISABLE_GPU
 
+// Estimates the memory of the buffer from its format, whichever storages
+// currently hold it.
+MEDIAPIPE_REGISTER_PAYLOAD_SIZE(
+    GpuBuffer, [](const GpuBuffer& buffer) -> size_t {
+      if (!buffer) return 0;
+      const ImageFormat::Format format =
+          ImageFormatForGpuBufferFormat(buffer.format());
+      if (format == ImageFormat::UNKNOWN) return 0;
+      return static_cast<size_t>(buffer.width()) * buffer.height() *
+             ImageFrame::NumberOfChannelsForFormat(format) *
+             ImageFrame::ByteDepthForFormat(format);
+    });
+
 }  // namespace mediapipe
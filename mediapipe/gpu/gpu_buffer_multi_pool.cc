@@ -14,6 +14,8 @@
 
 #include "mediapipe/gpu/gpu_buffer_multi_pool.h"
 
+#include <algorithm>
+#include <limits>
 #include <tuple>
 
 #include "absl/memory/memory.h"
@@ -42,6 +44,44 @@ static constexpr float kMaxInactiveBufferAge = 0.25;
 static constexpr int kMinRequestsBeforePool = 2;
 // Do a deeper flush every this many requests.
 static constexpr int kRequestCountScrubInterval = 50;
+// GetPaddedBuffer rounds sizes up to a multiple of this when no existing pool
+// fits, so that nearby sizes end up sharing a pool.
+static constexpr int kPaddedSizeAlignment = 32;
+
+// Approximate memory used by a buffer with the given spec.
+static int64_t BufferSpecBytes(const GpuBufferMultiPool::BufferSpec& spec) {
+  const int64_t pixels = static_cast<int64_t>(spec.width) * spec.height;
+  switch (spec.format) {
+    case GpuBufferFormat::kOneComponent8:
+    case GpuBufferFormat::kOneComponent8Red:
+      return pixels;
+    case GpuBufferFormat::kBiPlanar420YpCbCr8VideoRange:
+    case GpuBufferFormat::kBiPlanar420YpCbCr8FullRange:
+      return pixels * 3 / 2;
+    case GpuBufferFormat::kGrayHalf16:
+    case GpuBufferFormat::kTwoComponent8:
+      return pixels * 2;
+    case GpuBufferFormat::kRGB24:
+      return pixels * 3;
+    case GpuBufferFormat::kBGRA32:
+    case GpuBufferFormat::kRGBA32:
+    case GpuBufferFormat::kGrayFloat32:
+    case GpuBufferFormat::kTwoComponentHalf16:
+      return pixels * 4;
+    case GpuBufferFormat::kTwoComponentFloat32:
+    case GpuBufferFormat::kRGBAHalf64:
+      return pixels * 8;
+    case GpuBufferFormat::kRGBAFloat128:
+      return pixels * 16;
+    case GpuBufferFormat::kUnknown:
+      return 0;
+  }
+  return 0;
+}
+
+static int RoundUp(int value, int alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
 
 #if MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
 
@@ -138,6 +178,18 @@ GpuBuffer GpuBufferMultiPool::GetBufferFromSimplePool(
 #endif  // TARGET_IPHONE_SIMULATOR
 }
 
+std::pair<int, int> GpuBufferMultiPool::GetPoolCounts(
+    const GpuBufferMultiPool::SimplePool& pool) {
+  // CVPixelBufferPool does not tell which of its buffers are in use.
+  return {pool->GetBufferCount(), 0};
+}
+
+int GpuBufferMultiPool::ReleasePoolBuffers(
+    const GpuBufferMultiPool::SimplePool& pool) {
+  pool->Flush();
+  return -1;
+}
+
 #else
 
 GpuBufferMultiPool::SimplePool GpuBufferMultiPool::MakeSimplePool(
@@ -156,30 +208,186 @@ GpuBuffer GpuBufferMultiPool::GetBufferFromSimplePool(
   return GpuBuffer(pool->GetBuffer());
 }
 
+std::pair<int, int> GpuBufferMultiPool::GetPoolCounts(
+    const GpuBufferMultiPool::SimplePool& pool) {
+  return pool->GetInUseAndAvailableCounts();
+}
+
+int GpuBufferMultiPool::ReleasePoolBuffers(
+    const GpuBufferMultiPool::SimplePool& pool) {
+  return pool->ReleaseAvailable(/*keep_available=*/0);
+}
+
 #endif  // MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
 
 GpuBufferMultiPool::SimplePool GpuBufferMultiPool::RequestPool(
     const BufferSpec& spec) {
+  return thread_cache_.Get(
+      spec, [this](const BufferSpec& spec, int request_count) {
+        return LookupPool(spec, request_count);
+      });
+}
+
+GpuBufferMultiPool::SimplePool GpuBufferMultiPool::LookupPool(
+    const BufferSpec& spec, int request_count) {
   SimplePool pool;
   std::vector<SimplePool> evicted;
   {
     absl::MutexLock lock(&mutex_);
-    pool =
-        cache_.Lookup(spec, [this](const BufferSpec& spec, int request_count) {
+    pool = cache_.Lookup(
+        spec,
+        [this](const BufferSpec& spec, int request_count) {
           return (request_count >= kMinRequestsBeforePool)
                      ? MakeSimplePool(spec)
                      : nullptr;
-        });
+        },
+        request_count);
     evicted = cache_.Evict(kMaxPoolCount, kRequestCountScrubInterval);
+    stats_.request_count += request_count;
   }
   // Evicted pools, and their buffers, will be released without holding the
   // lock.
   return pool;
 }
 
+std::vector<std::pair<GpuBufferMultiPool::BufferSpec,
+                      GpuBufferMultiPool::SimplePool>>
+GpuBufferMultiPool::GetPools() {
+  std::vector<std::pair<BufferSpec, SimplePool>> pools;
+  absl::MutexLock lock(&mutex_);
+  cache_.ForEach([&pools](const BufferSpec& spec, const SimplePool& pool) {
+    if (pool) pools.emplace_back(spec, pool);
+  });
+  return pools;
+}
+
+int64_t GpuBufferMultiPool::ReleaseIdleBuffers(
+    const std::vector<std::pair<BufferSpec, SimplePool>>& pools,
+    int64_t held_bytes, int64_t target_bytes) {
+  int64_t trimmed_bytes = 0;
+  for (auto it = pools.rbegin(); it != pools.rend(); ++it) {
+    if (held_bytes <= target_bytes) break;
+    const int released = ReleasePoolBuffers(it->second);
+    if (released <= 0) continue;
+    const int64_t bytes = released * BufferSpecBytes(it->first);
+    held_bytes -= bytes;
+    trimmed_bytes += bytes;
+  }
+  absl::MutexLock lock(&mutex_);
+  stats_.trimmed_bytes += trimmed_bytes;
+  return held_bytes;
+}
+
+void GpuBufferMultiPool::EnforceBudget(const BufferSpec& spec) {
+  MemoryBudget* graph_budget =
+      graph_memory_budget_ptr_.load(std::memory_order_relaxed);
+  if (graph_budget && graph_budget->IsExceeded()) {
+    // Releases all the idle buffers but keeps the pools, unlike Trim(0).
+    Trim(/*target_bytes=*/1);
+  }
+  const int64_t budget = memory_budget_bytes_.load(std::memory_order_relaxed);
+  if (budget <= 0) return;
+
+  auto pools = GetPools();
+  int64_t held_bytes = 0;
+  for (const auto& spec_and_pool : pools) {
+    const auto counts = GetPoolCounts(spec_and_pool.second);
+    // A reused buffer does not add to the memory held.
+    if (spec_and_pool.first == spec && counts.second > 0) return;
+    held_bytes +=
+        (counts.first + counts.second) * BufferSpecBytes(spec_and_pool.first);
+  }
+  const int64_t request_bytes = BufferSpecBytes(spec);
+  if (held_bytes + request_bytes <= budget) return;
+
+  held_bytes = ReleaseIdleBuffers(pools, held_bytes, budget - request_bytes);
+  if (held_bytes + request_bytes > budget) {
+    absl::MutexLock lock(&mutex_);
+    ++stats_.over_budget_count;
+  }
+}
+
+void GpuBufferMultiPool::SetOptions(const Options& options) {
+  absl::MutexLock lock(&mutex_);
+  options_ = options;
+  memory_budget_bytes_ = options.memory_budget_bytes;
+}
+
+void GpuBufferMultiPool::SetMemoryBudget(
+    std::shared_ptr<MemoryBudget> memory_budget) {
+  absl::MutexLock lock(&mutex_);
+  graph_memory_budget_ptr_ = memory_budget.get();
+  graph_memory_budget_ = std::move(memory_budget);
+}
+
+void GpuBufferMultiPool::Trim(int64_t target_bytes) {
+  auto pools = GetPools();
+  int64_t held_bytes = 0;
+  for (const auto& spec_and_pool : pools) {
+    const auto counts = GetPoolCounts(spec_and_pool.second);
+    held_bytes +=
+        (counts.first + counts.second) * BufferSpecBytes(spec_and_pool.first);
+  }
+  ReleaseIdleBuffers(pools, held_bytes, target_bytes);
+  if (target_bytes > 0) return;
+
+  std::vector<SimplePool> evicted;
+  {
+    absl::MutexLock lock(&mutex_);
+    evicted = cache_.Evict(/*max_count=*/0, kRequestCountScrubInterval);
+  }
+  // Buffers still in use are destroyed when released, since their pool is
+  // gone.
+}
+
+GpuBufferMultiPool::Stats GpuBufferMultiPool::GetStats() {
+  auto pools = GetPools();
+  Stats stats;
+  {
+    absl::MutexLock lock(&mutex_);
+    stats = stats_;
+  }
+  stats.pool_count = pools.size();
+  for (const auto& spec_and_pool : pools) {
+    const auto counts = GetPoolCounts(spec_and_pool.second);
+    const int64_t bytes = BufferSpecBytes(spec_and_pool.first);
+    stats.in_use_bytes += counts.first * bytes;
+    stats.available_bytes += counts.second * bytes;
+  }
+  return stats;
+}
+
+GpuBuffer GpuBufferMultiPool::GetPaddedBuffer(int width, int height,
+                                              GpuBufferFormat format) {
+  const int64_t area = static_cast<int64_t>(width) * height;
+  BufferSpec best(RoundUp(width, kPaddedSizeAlignment),
+                  RoundUp(height, kPaddedSizeAlignment), format);
+  {
+    absl::MutexLock lock(&mutex_);
+    const double max_area = area * options_.max_padded_area_ratio;
+    int64_t best_area = std::numeric_limits<int64_t>::max();
+    cache_.ForEach([&](const BufferSpec& spec, const SimplePool& pool) {
+      if (!pool || spec.format != format || spec.width < width ||
+          spec.height < height) {
+        return;
+      }
+      const int64_t spec_area = static_cast<int64_t>(spec.width) * spec.height;
+      if (spec_area > max_area || spec_area >= best_area) return;
+      best = spec;
+      best_area = spec_area;
+    });
+    if (best_area != std::numeric_limits<int64_t>::max() &&
+        best_area != area) {
+      ++stats_.padded_reuse_count;
+    }
+  }
+  return GetBuffer(best.width, best.height, format);
+}
+
 GpuBuffer GpuBufferMultiPool::GetBuffer(int width, int height,
                                         GpuBufferFormat format) {
   BufferSpec key(width, height, format);
+  EnforceBudget(key);
   SimplePool pool = RequestPool(key);
   if (pool) {
     // Note: we release our multipool lock before accessing the simple pool.
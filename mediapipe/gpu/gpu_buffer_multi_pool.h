@@ -22,8 +22,16 @@
 #ifndef MEDIAPIPE_GPU_GPU_BUFFER_MULTI_POOL_H_
 #define MEDIAPIPE_GPU_GPU_BUFFER_MULTI_POOL_H_
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "absl/hash/hash.h"
 #include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/formats/concurrent_pool_util.h"
+#include "mediapipe/framework/memory_budget.h"
 #include "mediapipe/gpu/gpu_buffer.h"
 #include "mediapipe/util/resource_cache.h"
 
@@ -42,14 +50,61 @@ class CvPixelBufferPoolWrapper;
 
 class GpuBufferMultiPool {
  public:
+  struct Options {
+    // Soft limit on the memory held by pooled buffers, counting both buffers
+    // in use and buffers kept for reuse. When a request would exceed it, idle
+    // buffers are released first, starting with the least requested sizes.
+    // If that is not enough the buffer is still allocated. 0 means no limit.
+    int64_t memory_budget_bytes = 0;
+    // GetPaddedBuffer may return a buffer from an existing pool whose area is
+    // at most this many times the requested area.
+    float max_padded_area_ratio = 1.5f;
+  };
+
+  // Usage statistics, as returned by GetStats.
+  struct Stats {
+    // Number of sizes for which a pool is currently allocated.
+    int pool_count = 0;
+    // Memory held by pooled buffers that are in use or kept for reuse.
+    int64_t in_use_bytes = 0;
+    int64_t available_bytes = 0;
+    // Counters since the pool was created.
+    int64_t request_count = 0;
+    int64_t padded_reuse_count = 0;
+    int64_t over_budget_count = 0;
+    int64_t trimmed_bytes = 0;
+  };
+
   GpuBufferMultiPool() {}
   explicit GpuBufferMultiPool(void* ignored) {}
   ~GpuBufferMultiPool();
 
+  void SetOptions(const Options& options);
+
+  // Releases the idle buffers before allocating while "memory_budget", e.g.
+  // the MemoryBudget of a graph, is exceeded. The pooled buffers are not
+  // counted against it; those queued in packets are counted by the graph.
+  void SetMemoryBudget(std::shared_ptr<MemoryBudget> memory_budget);
+
   // Obtains a buffer. May either be reused or created anew.
   GpuBuffer GetBuffer(int width, int height,
                       GpuBufferFormat format = GpuBufferFormat::kBGRA32);
 
+  // Obtains a buffer that is at least width x height. This reuses the
+  // smallest existing pool of the same format that fits within
+  // max_padded_area_ratio, and otherwise rounds the size up so that nearby
+  // sizes share a pool. This is meant for pipelines with varying sizes (e.g.
+  // per-ROI crops) that can render into a sub-rectangle of the buffer.
+  GpuBuffer GetPaddedBuffer(int width, int height,
+                            GpuBufferFormat format = GpuBufferFormat::kBGRA32);
+
+  // Releases idle buffers, least requested sizes first, until the pool holds
+  // at most target_bytes. Buffers in use cannot be released. Passing 0 also
+  // drops all pools, e.g. when the app is notified of memory pressure.
+  void Trim(int64_t target_bytes);
+
+  Stats GetStats();
+
 #ifdef __APPLE__
   // TODO: add tests for the texture cache registration.
 
@@ -93,13 +148,41 @@ class GpuBufferMultiPool {
   // if we have not yet reached a sufficient number of requests to allocate a
   // pool, in which case the caller should invoke GetBufferWithoutPool instead
   // of GetBufferFromSimplePool.
+  // Pools are cached per thread, so this usually does not take mutex_.
   SimplePool RequestPool(const BufferSpec& spec);
+  // Looks up the pool in cache_, counting request_count requests.
+  SimplePool LookupPool(const BufferSpec& spec, int request_count);
   GpuBuffer GetBufferFromSimplePool(BufferSpec spec, const SimplePool& pool);
   GpuBuffer GetBufferWithoutPool(const BufferSpec& spec);
 
+  // Returns the buffers held by the pool that are in use and available.
+  static std::pair<int, int> GetPoolCounts(const SimplePool& pool);
+  // Releases the available buffers of the pool and returns how many were
+  // released, or -1 if that is not known.
+  static int ReleasePoolBuffers(const SimplePool& pool);
+
+  // Returns the pools with their specs, most requested first.
+  std::vector<std::pair<BufferSpec, SimplePool>> GetPools();
+  // Releases idle buffers from the least requested pools until held_bytes
+  // drops to target_bytes. Returns the updated held_bytes.
+  int64_t ReleaseIdleBuffers(
+      const std::vector<std::pair<BufferSpec, SimplePool>>& pools,
+      int64_t held_bytes, int64_t target_bytes);
+  // Trims idle buffers if allocating spec would exceed the memory budget, or
+  // if the graph memory budget is exceeded.
+  void EnforceBudget(const BufferSpec& spec);
+
   absl::Mutex mutex_;
   mediapipe::ResourceCache<BufferSpec, SimplePool, absl::Hash<BufferSpec>>
       cache_ ABSL_GUARDED_BY(mutex_);
+  Options options_ ABSL_GUARDED_BY(mutex_);
+  // Copy of options_.memory_budget_bytes, read without taking mutex_.
+  std::atomic<int64_t> memory_budget_bytes_{0};
+  // The budget set by SetMemoryBudget, and a copy read without taking mutex_.
+  std::shared_ptr<MemoryBudget> graph_memory_budget_ ABSL_GUARDED_BY(mutex_);
+  std::atomic<MemoryBudget*> graph_memory_budget_ptr_{nullptr};
+  Stats stats_ ABSL_GUARDED_BY(mutex_);
+  PoolThreadCache<BufferSpec, SimplePool> thread_cache_;
 
 #ifdef __APPLE__
   // Texture caches used with this pool.
@@ -74,13 +74,18 @@ class GpuBufferStorageRegistry {
 
   template <class Storage>
   RegistryToken Register() {
-    return Register(
-        [](int width, int height,
-           GpuBufferFormat format) -> std::shared_ptr<Storage> {
-          return CreateStorage<Storage>(overload_priority<10>{}, width, height,
-                                        format);
-        },
-        Storage::GetProviderTypes());
+    if constexpr (CanCreateStorage<Storage>::value) {
+      return Register(
+          [](int width, int height,
+             GpuBufferFormat format) -> std::shared_ptr<Storage> {
+            return CreateStorage<Storage>(overload_priority<10>{}, width,
+                                          height, format);
+          },
+          Storage::GetProviderTypes());
+    } else {
+      // Storages that can only wrap existing buffers are not factories.
+      return {};
+    }
   }
 
   template <class StorageFrom, class StorageTo, class F>
@@ -104,6 +109,15 @@ class GpuBufferStorageRegistry {
       TypeId view_provider_type, TypeId existing_storage_type);
 
  private:
+  template <class Storage, class = void>
+  struct CanCreateStorage
+      : std::is_constructible<Storage, int, int, GpuBufferFormat> {};
+  template <class Storage>
+  struct CanCreateStorage<Storage,
+                          std::void_t<decltype(Storage::Create(
+                              0, 0, GpuBufferFormat::kUnknown))>>
+      : std::true_type {};
+
   template <class Storage, class... Args>
   static auto CreateStorage(overload_priority<1>, Args... args)
       -> decltype(Storage::Create(args...)) {
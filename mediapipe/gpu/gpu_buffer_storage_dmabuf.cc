@@ -0,0 +1,315 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/gpu/gpu_buffer_storage_dmabuf.h"
+
+#include <linux/dma-buf.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr uint32_t DrmFourcc(char a, char b, char c, char d) {
+  return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) |
+         (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+}
+
+// Returns the DRM format with the same memory layout, or 0 if there is none.
+uint32_t DrmFourccForGpuBufferFormat(GpuBufferFormat format) {
+  switch (format) {
+    case GpuBufferFormat::kBGRA32:
+      return DrmFourcc('A', 'R', '2', '4');  // DRM_FORMAT_ARGB8888
+    case GpuBufferFormat::kRGBA32:
+      return DrmFourcc('A', 'B', '2', '4');  // DRM_FORMAT_ABGR8888
+    case GpuBufferFormat::kRGB24:
+      return DrmFourcc('B', 'G', '2', '4');  // DRM_FORMAT_BGR888
+    case GpuBufferFormat::kOneComponent8:
+    case GpuBufferFormat::kOneComponent8Red:
+      return DrmFourcc('R', '8', ' ', ' ');  // DRM_FORMAT_R8
+    case GpuBufferFormat::kTwoComponent8:
+      return DrmFourcc('G', 'R', '8', '8');  // DRM_FORMAT_GR88
+    case GpuBufferFormat::kBiPlanar420YpCbCr8VideoRange:
+    case GpuBufferFormat::kBiPlanar420YpCbCr8FullRange:
+      return DrmFourcc('N', 'V', '1', '2');  // DRM_FORMAT_NV12
+    default:
+      return 0;
+  }
+}
+
+int PlaneCount(GpuBufferFormat format) {
+  switch (format) {
+    case GpuBufferFormat::kBiPlanar420YpCbCr8VideoRange:
+    case GpuBufferFormat::kBiPlanar420YpCbCr8FullRange:
+      return 2;
+    default:
+      return 1;
+  }
+}
+
+bool IsYuv(GpuBufferFormat format) { return PlaneCount(format) > 1; }
+
+GLenum TextureTarget(GpuBufferFormat format) {
+  return IsYuv(format) ? GL_TEXTURE_EXTERNAL_OES : GL_TEXTURE_2D;
+}
+
+ImageFormat::Format ImageFormatForMapping(GpuBufferFormat format) {
+  if (IsYuv(format)) return ImageFormat::UNKNOWN;
+  // Unlike ImageFormatForGpuBufferFormat, this follows the byte order in
+  // memory.
+  if (format == GpuBufferFormat::kRGBA32) return ImageFormat::SRGBA;
+  return ImageFormatForGpuBufferFormat(format);
+}
+
+PFNEGLCREATEIMAGEKHRPROC eglCreateImageKHR;
+PFNEGLDESTROYIMAGEKHRPROC eglDestroyImageKHR;
+PFNGLEGLIMAGETARGETTEXTURE2DOESPROC glEGLImageTargetTexture2DOES;
+
+bool IsEglImageSupported() {
+  static const bool supported = [] {
+    eglCreateImageKHR = reinterpret_cast<PFNEGLCREATEIMAGEKHRPROC>(
+        eglGetProcAddress("eglCreateImageKHR"));
+    eglDestroyImageKHR = reinterpret_cast<PFNEGLDESTROYIMAGEKHRPROC>(
+        eglGetProcAddress("eglDestroyImageKHR"));
+    glEGLImageTargetTexture2DOES =
+        reinterpret_cast<PFNGLEGLIMAGETARGETTEXTURE2DOESPROC>(
+            eglGetProcAddress("glEGLImageTargetTexture2DOES"));
+    return eglCreateImageKHR && eglDestroyImageKHR &&
+           glEGLImageTargetTexture2DOES;
+  }();
+  return supported;
+}
+
+void SyncDmaBuf(int fd, uint64_t flags) {
+  struct dma_buf_sync sync = {flags};
+  while (ioctl(fd, DMA_BUF_IOCTL_SYNC, &sync) == -1 && errno == EINTR) {
+  }
+}
+
+}  // namespace
+
+absl::StatusOr<std::shared_ptr<GpuBufferStorageDmaBuf>>
+GpuBufferStorageDmaBuf::Import(int width, int height, GpuBufferFormat format,
+                               std::vector<DmaBufPlane> planes,
+                               uint64_t modifier,
+                               ReleaseCallback release_callback) {
+  if (width <= 0 || height <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid DMA-BUF size: ", width, "x", height));
+  }
+  if (DrmFourccForGpuBufferFormat(format) == 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unsupported DMA-BUF format: ", static_cast<int>(format)));
+  }
+  if (planes.size() != PlaneCount(format)) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Expected ", PlaneCount(format), " planes, got ", planes.size()));
+  }
+  for (DmaBufPlane& plane : planes) {
+    if (plane.fd < 0 || plane.stride == 0) {
+      return absl::InvalidArgumentError("Invalid DMA-BUF plane.");
+    }
+  }
+  for (int i = 0; i < planes.size(); ++i) {
+    planes[i].fd = dup(planes[i].fd);
+    if (planes[i].fd < 0) {
+      const int error = errno;
+      for (int j = 0; j < i; ++j) close(planes[j].fd);
+      return absl::InternalError(
+          absl::StrCat("Failed to duplicate DMA-BUF fd, errno ", error));
+    }
+  }
+  return std::shared_ptr<GpuBufferStorageDmaBuf>(new GpuBufferStorageDmaBuf(
+      width, height, format, std::move(planes), modifier,
+      std::move(release_callback)));
+}
+
+GpuBufferStorageDmaBuf::GpuBufferStorageDmaBuf(int width, int height,
+                                               GpuBufferFormat format,
+                                               std::vector<DmaBufPlane> planes,
+                                               uint64_t modifier,
+                                               ReleaseCallback release_callback)
+    : width_(width),
+      height_(height),
+      format_(format),
+      planes_(std::move(planes)),
+      modifier_(modifier),
+      release_callback_(std::move(release_callback)) {}
+
+GpuBufferStorageDmaBuf::~GpuBufferStorageDmaBuf() {
+  absl::MutexLock lock(&mutex_);
+  if (texture_context_) {
+    // The texture and image must be released on a GL context. Views hold a
+    // reference to the GpuBuffer, so none of them are alive at this point.
+    EGLImageKHR egl_image = egl_image_;
+    GLuint texture = texture_;
+    EGLDisplay display = texture_context_->egl_display();
+    texture_context_->RunWithoutWaiting([display, egl_image, texture] {
+      glDeleteTextures(1, &texture);
+      eglDestroyImageKHR(display, egl_image);
+    });
+  }
+  for (const DmaBufPlane& plane : planes_) close(plane.fd);
+  if (release_callback_) release_callback_();
+}
+
+void GpuBufferStorageDmaBuf::EnsureTexture(GlContext* gl_context) const {
+  mutex_.AssertHeld();
+  if (texture_) return;
+  CHECK(IsEglImageSupported()) << "EGL_KHR_image_base is not supported";
+
+  std::vector<EGLint> attributes = {
+      EGL_WIDTH,
+      width_,
+      EGL_HEIGHT,
+      height_,
+      EGL_LINUX_DRM_FOURCC_EXT,
+      static_cast<EGLint>(DrmFourccForGpuBufferFormat(format_)),
+  };
+  static constexpr EGLint kPlaneAttributes[][5] = {
+      {EGL_DMA_BUF_PLANE0_FD_EXT, EGL_DMA_BUF_PLANE0_OFFSET_EXT,
+       EGL_DMA_BUF_PLANE0_PITCH_EXT, EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT,
+       EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT},
+      {EGL_DMA_BUF_PLANE1_FD_EXT, EGL_DMA_BUF_PLANE1_OFFSET_EXT,
+       EGL_DMA_BUF_PLANE1_PITCH_EXT, EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT,
+       EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT},
+  };
+  for (int i = 0; i < planes_.size(); ++i) {
+    attributes.insert(attributes.end(),
+                      {kPlaneAttributes[i][0], planes_[i].fd,
+                       kPlaneAttributes[i][1],
+                       static_cast<EGLint>(planes_[i].offset),
+                       kPlaneAttributes[i][2],
+                       static_cast<EGLint>(planes_[i].stride)});
+    if (modifier_ != kInvalidModifier) {
+      attributes.insert(
+          attributes.end(),
+          {kPlaneAttributes[i][3], static_cast<EGLint>(modifier_ & 0xffffffff),
+           kPlaneAttributes[i][4], static_cast<EGLint>(modifier_ >> 32)});
+    }
+  }
+  if (IsYuv(format_)) {
+    attributes.insert(
+        attributes.end(),
+        {EGL_SAMPLE_RANGE_HINT_EXT,
+         format_ == GpuBufferFormat::kBiPlanar420YpCbCr8FullRange
+             ? EGL_YUV_FULL_RANGE_EXT
+             : EGL_YUV_NARROW_RANGE_EXT});
+  }
+  attributes.push_back(EGL_NONE);
+
+  egl_image_ = eglCreateImageKHR(gl_context->egl_display(), EGL_NO_CONTEXT,
+                                 EGL_LINUX_DMA_BUF_EXT, nullptr,
+                                 attributes.data());
+  CHECK(egl_image_ != EGL_NO_IMAGE_KHR)
+      << "eglCreateImageKHR failed: " << eglGetError();
+
+  const GLenum target = TextureTarget(format_);
+  glGenTextures(1, &texture_);
+  glBindTexture(target, texture_);
+  glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glEGLImageTargetTexture2DOES(target, egl_image_);
+  glBindTexture(target, 0);
+  texture_context_ = gl_context->shared_from_this();
+}
+
+GlTextureView GpuBufferStorageDmaBuf::GetTexture(
+    std::shared_ptr<GpuBuffer> gpu_buffer, int plane,
+    GlTextureView::DoneWritingFn done_writing) const {
+  auto gl_context = GlContext::GetCurrent();
+  CHECK(gl_context);
+  // All planes are sampled through the same texture.
+  CHECK_EQ(plane, 0);
+  absl::MutexLock lock(&mutex_);
+  EnsureTexture(gl_context.get());
+  if (producer_sync_) producer_sync_->WaitOnGpu();
+  return GlTextureView(gl_context.get(), TextureTarget(format_), texture_,
+                       width_, height_, std::move(gpu_buffer), plane, nullptr,
+                       std::move(done_writing));
+}
+
+GlTextureView GpuBufferStorageDmaBuf::GetReadView(
+    internal::types<GlTextureView>, std::shared_ptr<GpuBuffer> gpu_buffer,
+    int plane) const {
+  return GetTexture(std::move(gpu_buffer), plane, nullptr);
+}
+
+GlTextureView GpuBufferStorageDmaBuf::GetWriteView(
+    internal::types<GlTextureView>, std::shared_ptr<GpuBuffer> gpu_buffer,
+    int plane) {
+  CHECK(!IsYuv(format_)) << "External textures cannot be rendered to";
+  return GetTexture(std::move(gpu_buffer), plane,
+                    [this](const GlTextureView& view) {
+                      absl::MutexLock lock(&mutex_);
+                      producer_sync_ = view.gl_context()->CreateSyncToken();
+                    });
+}
+
+std::shared_ptr<ImageFrame> GpuBufferStorageDmaBuf::MapImageFrame(
+    bool writable) const {
+  const ImageFormat::Format image_format = ImageFormatForMapping(format_);
+  CHECK_NE(image_format, ImageFormat::UNKNOWN)
+      << "No CPU view for DMA-BUF format " << static_cast<int>(format_);
+  {
+    // GL writes must land before the CPU reads the memory.
+    absl::MutexLock lock(&mutex_);
+    if (producer_sync_) producer_sync_->Wait();
+  }
+
+  const DmaBufPlane& plane = planes_[0];
+  const size_t size =
+      plane.offset + static_cast<size_t>(plane.stride) * height_;
+  const int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+  void* mapping = mmap(nullptr, size, protection, MAP_SHARED, plane.fd, 0);
+  CHECK(mapping != MAP_FAILED) << "mmap of DMA-BUF failed, errno " << errno;
+  // The view may outlive this storage, so it keeps its own fd.
+  const int fd = dup(plane.fd);
+  CHECK_GE(fd, 0) << "Failed to duplicate DMA-BUF fd, errno " << errno;
+  const uint64_t sync_flags = writable ? DMA_BUF_SYNC_RW : DMA_BUF_SYNC_READ;
+  SyncDmaBuf(fd, DMA_BUF_SYNC_START | sync_flags);
+
+  return std::make_shared<ImageFrame>(
+      image_format, width_, height_, plane.stride,
+      static_cast<uint8*>(mapping) + plane.offset,
+      [fd, mapping, size, sync_flags](uint8*) {
+        SyncDmaBuf(fd, DMA_BUF_SYNC_END | sync_flags);
+        munmap(mapping, size);
+        close(fd);
+      });
+}
+
+std::shared_ptr<const ImageFrame> GpuBufferStorageDmaBuf::GetReadView(
+    internal::types<ImageFrame>, std::shared_ptr<GpuBuffer> gpu_buffer) const {
+  return MapImageFrame(/*writable=*/false);
+}
+
+std::shared_ptr<ImageFrame> GpuBufferStorageDmaBuf::GetWriteView(
+    internal::types<ImageFrame>, std::shared_ptr<GpuBuffer> gpu_buffer) {
+  return MapImageFrame(/*writable=*/true);
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,126 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MEDIAPIPE_GPU_GPU_BUFFER_STORAGE_DMABUF_H_
+#define MEDIAPIPE_GPU_GPU_BUFFER_STORAGE_DMABUF_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/gpu/gl_base.h"
+// Included after gl_base.h, which provides the core EGL types.
+#include <EGL/eglext.h>
+#include "mediapipe/gpu/gl_context.h"
+#include "mediapipe/gpu/gl_texture_view.h"
+#include "mediapipe/gpu/gpu_buffer_format.h"
+#include "mediapipe/gpu/gpu_buffer_storage.h"
+#include "mediapipe/gpu/image_frame_view.h"
+
+namespace mediapipe {
+
+// One plane of a Linux DMA-BUF. Several planes may share the same fd.
+struct DmaBufPlane {
+  int fd = -1;
+  uint32_t offset = 0;
+  uint32_t stride = 0;
+};
+
+// Wraps a DMA-BUF allocated outside of MediaPipe, e.g. by a V4L2 or VA-API
+// decoder, as a GpuBuffer storage. GL views sample the buffer through an
+// EGLImage without copying it; ImageFrame views map it into CPU memory.
+//
+// Requires EGL_EXT_image_dma_buf_import, and
+// EGL_EXT_image_dma_buf_import_modifiers when a format modifier is given.
+// Multi-planar formats are sampled as a single GL_TEXTURE_EXTERNAL_OES
+// texture, with the driver converting to RGB.
+//
+// This storage cannot allocate buffers, so it is never picked to create a
+// GpuBuffer or to convert one from another storage. Wrap imported buffers
+// with GpuBuffer(std::shared_ptr<internal::GpuBufferStorage>).
+class GpuBufferStorageDmaBuf
+    : public internal::GpuBufferStorageImpl<
+          GpuBufferStorageDmaBuf, internal::ViewProvider<GlTextureView>,
+          internal::ViewProvider<ImageFrame>> {
+ public:
+  // DRM_FORMAT_MOD_INVALID: lets the driver infer the layout.
+  static constexpr uint64_t kInvalidModifier = 0x00ffffffffffffffULL;
+
+  // Invoked when the storage is destroyed, so the producer can reuse the
+  // buffer.
+  using ReleaseCallback = std::function<void()>;
+
+  // Imports a buffer whose contents are complete at the time of this call.
+  // The plane fds are duplicated, so the caller keeps ownership of its own.
+  static absl::StatusOr<std::shared_ptr<GpuBufferStorageDmaBuf>> Import(
+      int width, int height, GpuBufferFormat format,
+      std::vector<DmaBufPlane> planes, uint64_t modifier = kInvalidModifier,
+      ReleaseCallback release_callback = nullptr);
+
+  ~GpuBufferStorageDmaBuf() override;
+
+  int width() const override { return width_; }
+  int height() const override { return height_; }
+  GpuBufferFormat format() const override { return format_; }
+  const std::vector<DmaBufPlane>& planes() const { return planes_; }
+
+  GlTextureView GetReadView(internal::types<GlTextureView>,
+                            std::shared_ptr<GpuBuffer> gpu_buffer,
+                            int plane) const override;
+  GlTextureView GetWriteView(internal::types<GlTextureView>,
+                             std::shared_ptr<GpuBuffer> gpu_buffer,
+                             int plane) override;
+  // Maps the first plane. Only formats with a single plane and a matching
+  // ImageFormat are supported.
+  std::shared_ptr<const ImageFrame> GetReadView(
+      internal::types<ImageFrame>,
+      std::shared_ptr<GpuBuffer> gpu_buffer) const override;
+  std::shared_ptr<ImageFrame> GetWriteView(
+      internal::types<ImageFrame>,
+      std::shared_ptr<GpuBuffer> gpu_buffer) override;
+
+ private:
+  GpuBufferStorageDmaBuf(int width, int height, GpuBufferFormat format,
+                         std::vector<DmaBufPlane> planes, uint64_t modifier,
+                         ReleaseCallback release_callback);
+
+  // Creates the EGLImage and the texture bound to it on first use.
+  void EnsureTexture(GlContext* gl_context) const;
+  GlTextureView GetTexture(std::shared_ptr<GpuBuffer> gpu_buffer, int plane,
+                           GlTextureView::DoneWritingFn done_writing) const;
+  std::shared_ptr<ImageFrame> MapImageFrame(bool writable) const;
+
+  const int width_;
+  const int height_;
+  const GpuBufferFormat format_;
+  const std::vector<DmaBufPlane> planes_;
+  const uint64_t modifier_;
+  ReleaseCallback release_callback_;
+
+  mutable absl::Mutex mutex_;
+  mutable std::shared_ptr<GlContext> texture_context_ ABSL_GUARDED_BY(mutex_);
+  mutable EGLImageKHR egl_image_ ABSL_GUARDED_BY(mutex_) = EGL_NO_IMAGE_KHR;
+  mutable GLuint texture_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Marks the point when the last GL write view finished writing.
+  mutable std::shared_ptr<GlSyncPoint> producer_sync_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_GPU_GPU_BUFFER_STORAGE_DMABUF_H_
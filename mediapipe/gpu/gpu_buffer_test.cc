@@ -245,5 +245,65 @@ TEST_F(GpuBufferTest, Overwrite) {
   }
 }
 
+#if !MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
+// Obtains a buffer enough times for the multipool to create a pool for its
+// size, and returns it so that one buffer is available for reuse.
+void WarmUpPool(GpuBufferMultiPool& pool, int width, int height) {
+  for (int i = 0; i < 2; ++i) {
+    GpuBuffer buffer = pool.GetBuffer(width, height);
+  }
+}
+
+TEST_F(GpuBufferTest, PoolTrimReleasesIdleBuffers) {
+  RunInGlContext([this] {
+    GpuBufferMultiPool& pool = gpu_shared_.gpu_buffer_pool;
+    WarmUpPool(pool, 64, 64);
+    GpuBufferMultiPool::Stats stats = pool.GetStats();
+    EXPECT_EQ(stats.pool_count, 1);
+    EXPECT_EQ(stats.in_use_bytes, 0);
+    EXPECT_EQ(stats.available_bytes, 64 * 64 * 4);
+
+    pool.Trim(0);
+    stats = pool.GetStats();
+    EXPECT_EQ(stats.pool_count, 0);
+    EXPECT_EQ(stats.available_bytes, 0);
+    EXPECT_EQ(stats.trimmed_bytes, 64 * 64 * 4);
+  });
+}
+
+TEST_F(GpuBufferTest, PoolBudgetReleasesIdleBuffersFirst) {
+  RunInGlContext([this] {
+    GpuBufferMultiPool& pool = gpu_shared_.gpu_buffer_pool;
+    GpuBufferMultiPool::Options options;
+    options.memory_budget_bytes = 64 * 64 * 4;
+    pool.SetOptions(options);
+    WarmUpPool(pool, 64, 64);
+
+    GpuBuffer buffer = pool.GetBuffer(32, 32);
+    GpuBufferMultiPool::Stats stats = pool.GetStats();
+    EXPECT_EQ(stats.available_bytes, 0);
+    EXPECT_EQ(stats.trimmed_bytes, 64 * 64 * 4);
+    EXPECT_EQ(stats.over_budget_count, 0);
+  });
+}
+
+TEST_F(GpuBufferTest, PaddedBufferReusesLargerPool) {
+  RunInGlContext([this] {
+    GpuBufferMultiPool& pool = gpu_shared_.gpu_buffer_pool;
+    WarmUpPool(pool, 100, 100);
+
+    GpuBuffer buffer = pool.GetPaddedBuffer(90, 90);
+    EXPECT_EQ(buffer.width(), 100);
+    EXPECT_EQ(buffer.height(), 100);
+    EXPECT_EQ(pool.GetStats().padded_reuse_count, 1);
+
+    // Too much padding: the size is rounded up instead.
+    GpuBuffer small_buffer = pool.GetPaddedBuffer(20, 20);
+    EXPECT_EQ(small_buffer.width(), 32);
+    EXPECT_EQ(small_buffer.height(), 32);
+  });
+}
+#endif  // !MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
+
 }  // anonymous namespace
 }  // namespace mediapipe
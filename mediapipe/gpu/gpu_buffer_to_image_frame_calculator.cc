@@ -23,10 +23,18 @@
 #endif
 
 #include "mediapipe/gpu/gl_calculator_helper.h"
+#include "mediapipe/gpu/gpu_buffer_to_image_frame_calculator.pb.h"
+
+#if !MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
+#include "mediapipe/gpu/gl_async_readback.h"
+#endif  // !MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
 
 namespace mediapipe {
 
 // Convert an input image (GpuBuffer or ImageFrame) to ImageFrame.
+// With GpuBufferToImageFrameCalculatorOptions.async_readback_buffers set,
+// GpuBuffers are read back through pixel buffer objects and each output is
+// emitted once its readback has completed, in a later call.
 class GpuBufferToImageFrameCalculator : public CalculatorBase {
  public:
   GpuBufferToImageFrameCalculator() {}
@@ -35,10 +43,17 @@ class GpuBufferToImageFrameCalculator : public CalculatorBase {
 
   absl::Status Open(CalculatorContext* cc) override;
   absl::Status Process(CalculatorContext* cc) override;
+  absl::Status Close(CalculatorContext* cc) override;
 
  private:
 #if !MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
+  // Outputs the oldest pending readback. Returns false if there is none, or
+  // if "wait" is false and it has not completed yet.
+  bool EmitReadback(CalculatorContext* cc, bool wait);
+
   GlCalculatorHelper helper_;
+  // Only set for asynchronous readback.
+  std::unique_ptr<GlAsyncReadback> readback_;
 #endif  // MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
 };
 REGISTER_CALCULATOR(GpuBufferToImageFrameCalculator);
@@ -56,17 +71,44 @@ absl::Status GpuBufferToImageFrameCalculator::GetContract(
 }
 
 absl::Status GpuBufferToImageFrameCalculator::Open(CalculatorContext* cc) {
-  // Inform the framework that we always output at the same timestamp
-  // as we receive a packet at.
-  cc->SetOffset(TimestampDiff(0));
+  bool async_readback = false;
 #if !MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
   MP_RETURN_IF_ERROR(helper_.Open(cc));
+  const int num_buffers =
+      cc->Options<GpuBufferToImageFrameCalculatorOptions>()
+          .async_readback_buffers();
+  if (num_buffers > 0) {
+    helper_.RunInGlContext([this, num_buffers]() {
+      // Pixel buffer objects are not available in OpenGL ES 2.0.
+      if (helper_.GetGlVersion() == GlVersion::kGLES2) {
+        LOG(WARNING) << "Asynchronous readback requires OpenGL ES 3.0, "
+                        "falling back to synchronous readback.";
+        return;
+      }
+      readback_ = absl::make_unique<GlAsyncReadback>(num_buffers);
+    });
+  }
+  async_readback = readback_ != nullptr;
 #endif  // MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
+  if (!async_readback) {
+    // Inform the framework that we always output at the same timestamp
+    // as we receive a packet at.
+    cc->SetOffset(TimestampDiff(0));
+  }
   return absl::OkStatus();
 }
 
 absl::Status GpuBufferToImageFrameCalculator::Process(CalculatorContext* cc) {
   if (cc->Inputs().Index(0).Value().ValidateAsType<ImageFrame>().ok()) {
+#if !MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
+    // Earlier frames must be output first.
+    if (readback_ && !readback_->IsEmpty()) {
+      helper_.RunInGlContext([this, cc]() {
+        while (EmitReadback(cc, /*wait=*/true)) {
+        }
+      });
+    }
+#endif  // MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
     cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
     return absl::OkStatus();
   }
@@ -81,6 +123,16 @@ absl::Status GpuBufferToImageFrameCalculator::Process(CalculatorContext* cc) {
 #else
     helper_.RunInGlContext([this, &input, &cc]() {
       auto src = helper_.CreateSourceTexture(input);
+      if (readback_) {
+        if (readback_->IsFull()) EmitReadback(cc, /*wait=*/true);
+        helper_.BindFramebuffer(src);
+        readback_->Enqueue(src.width(), src.height(), input.format(),
+                           cc->InputTimestamp());
+        src.Release();
+        while (EmitReadback(cc, /*wait=*/false)) {
+        }
+        return;
+      }
       std::unique_ptr<ImageFrame> frame = absl::make_unique<ImageFrame>(
           ImageFormatForGpuBufferFormat(input.format()), src.width(),
           src.height(), ImageFrame::kGlDefaultAlignmentBoundary);
@@ -102,4 +154,28 @@ absl::Status GpuBufferToImageFrameCalculator::Process(CalculatorContext* cc) {
                       "Input packets must be ImageFrame or GpuBuffer.");
 }
 
+absl::Status GpuBufferToImageFrameCalculator::Close(CalculatorContext* cc) {
+#if !MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
+  if (readback_) {
+    helper_.RunInGlContext([this, cc]() {
+      while (EmitReadback(cc, /*wait=*/true)) {
+      }
+      readback_ = nullptr;
+    });
+  }
+#endif  // MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
+  return absl::OkStatus();
+}
+
+#if !MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
+bool GpuBufferToImageFrameCalculator::EmitReadback(CalculatorContext* cc,
+                                                   bool wait) {
+  Timestamp timestamp;
+  std::unique_ptr<ImageFrame> frame = readback_->Dequeue(wait, &timestamp);
+  if (!frame) return false;
+  cc->Outputs().Index(0).Add(frame.release(), timestamp);
+  return true;
+}
+#endif  // MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
+
 }  // namespace mediapipe
@@ -14,6 +14,8 @@
 
 #include "mediapipe/gpu/gpu_shared_data_internal.h"
 
+#include <atomic>
+
 #include "mediapipe/framework/deps/no_destructor.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/gpu/gl_context.h"
@@ -80,6 +82,32 @@ GpuResources::StatusOrGpuResources GpuResources::Create(
   return gpu_resources;
 }
 
+GpuResources::StatusOrGpuResources GpuResources::Create(
+    const GpuResourcesOptions& options) {
+  int device = options.gpu_device;
+#if HAS_EGL
+  if (device == GpuResourcesOptions::kRoundRobinDevice) {
+    // Shared by all graphs in the process.
+    static std::atomic<int> next_device(0);
+    int device_count = GlContext::GetEglDeviceCount();
+    device = device_count > 0 ? next_device++ % device_count
+                              : GpuResourcesOptions::kDefaultDevice;
+  }
+  if (device >= 0) {
+    ASSIGN_OR_RETURN(
+        std::shared_ptr<GlContext> context,
+        GlContext::CreateOnEglDevice(device, kGlContextUseDedicatedThread));
+    std::shared_ptr<GpuResources> gpu_resources(
+        new GpuResources(std::move(context)));
+    return gpu_resources;
+  }
+#endif  // HAS_EGL
+  RET_CHECK(device == GpuResourcesOptions::kDefaultDevice ||
+            device == GpuResourcesOptions::kRoundRobinDevice)
+      << "Selecting GPU device " << device << " requires EGL";
+  return Create();
+}
+
 GpuResources::GpuResources(std::shared_ptr<GlContext> gl_context) {
   gl_key_context_[SharedContextKey()] = gl_context;
   named_executors_[kGpuExecutorName] =
@@ -121,6 +149,9 @@ absl::Status GpuResources::PrepareGpuNode(CalculatorNode* node) {
       node->GetCalculatorState().Options<mediapipe::GlContextOptions>();
   if (options.has_gl_context_name() && !options.gl_context_name().empty()) {
     context_key = absl::StrCat("user:", options.gl_context_name());
+  } else if (options.gl_context_pool_size() > 0) {
+    context_key = absl::StrCat(
+        "pool:", next_pool_context_++ % options.gl_context_pool_size());
   } else if (gets_own_context) {
     context_key = absl::StrCat("auto:", node_type);
   } else if (kGlCalculatorShareContext) {
@@ -39,6 +39,21 @@ struct MPPGraphGPUData;
 
 namespace mediapipe {
 
+// Options for GpuResources::Create.
+struct GpuResourcesOptions {
+  // Values for gpu_device besides EGL device indices.
+  // Use the platform's default display.
+  static constexpr int kDefaultDevice = -1;
+  // Cycle through the available EGL devices, one per GpuResources instance,
+  // so that graphs created in turn are spread across GPUs.
+  static constexpr int kRoundRobinDevice = -2;
+
+  // Index of the EGL device, as listed by EGL_EXT_device_enumeration, on which
+  // the graph's GL contexts are created. Only used with EGL; other platforms
+  // always use the default device.
+  int gpu_device = kDefaultDevice;
+};
+
 // TODO: rename to GpuService or GpuManager or something.
 class GpuResources {
  public:
@@ -46,6 +61,7 @@ class GpuResources {
 
   static StatusOrGpuResources Create();
   static StatusOrGpuResources Create(PlatformGlContext external_context);
+  static StatusOrGpuResources Create(const GpuResourcesOptions& options);
 
   // The destructor must be defined in the implementation file so that on iOS
   // the correct ARC release calls are generated.
@@ -85,6 +101,8 @@ class GpuResources {
 
   std::map<std::string, std::string> node_key_;
   std::map<std::string, std::shared_ptr<GlContext>> gl_key_context_;
+  // Round-robin counter for nodes using the GlContextOptions context pool.
+  int next_pool_context_ = 0;
 
   // The pool must be destructed before the gl_context, but after the
   // ios_gpu_data, so the declaration order is important.
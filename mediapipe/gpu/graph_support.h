@@ -26,6 +26,9 @@ extern const GraphService<GpuResources> kGpuService;
 
 static constexpr char kGpuSharedTagName[] = "GPU_SHARED";
 static constexpr char kGpuSharedSidePacketName[] = "gpu_shared";
+// Optional int side packet selecting the GPU device used by the graph when the
+// graph creates its own GpuResources. See GpuResourcesOptions::gpu_device.
+static constexpr char kGpuDeviceSidePacketName[] = "gpu_device";
 static constexpr char kGpuExecutorName[] = "__gpu";
 
 }  // namespace mediapipe
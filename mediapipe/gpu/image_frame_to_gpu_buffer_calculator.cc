@@ -24,6 +24,9 @@
 namespace mediapipe {
 
 // Convert ImageFrame to GpuBuffer.
+// This uploads every frame. Frames that a decoder already produces in
+// DMA-BUFs can instead be wrapped without a copy using
+// GpuBufferStorageDmaBuf::Import.
 class ImageFrameToGpuBufferCalculator : public CalculatorBase {
  public:
   ImageFrameToGpuBufferCalculator() {}
@@ -17,6 +17,7 @@
 #include <stdlib.h>
 
 #include "mediapipe/framework/port/logging.h"
+#include "mediapipe/gpu/gl_program_cache.h"
 
 #if DEBUG
 #define GL_DEBUG_LOG(type, object, action)                        \
@@ -126,6 +127,19 @@ GLint GlhCreateProgram(const GLchar* vert_src, const GLchar* frag_src,
     return GL_FALSE;
   }
 
+  // Programs built before, in this process or in an earlier run, are loaded
+  // from their binaries instead of being compiled again.
+  const bool use_binary_cache = GlProgramBinariesSupported();
+  std::string cache_key;
+  if (use_binary_cache) {
+    cache_key = GlProgramCacheKey(vert_src, frag_src, attr_count, attr_names,
+                                  attr_locations);
+    if (LoadGlProgramBinary(cache_key, *program)) {
+      return GL_TRUE;
+    }
+    PrepareGlProgramForBinaryCache(*program);
+  }
+
   ok = ok && GlhCompileShader(GL_VERTEX_SHADER, vert_src, &vert_shader,
                               force_log_errors);
   ok = ok && GlhCompileShader(GL_FRAGMENT_SHADER, frag_src, &frag_shader,
@@ -149,6 +163,8 @@ GLint GlhCreateProgram(const GLchar* vert_src, const GLchar* frag_src,
   if (!ok) {
     glDeleteProgram(*program);
     *program = 0;
+  } else if (use_binary_cache) {
+    StoreGlProgramBinary(cache_key, *program);
   }
 
   return ok;
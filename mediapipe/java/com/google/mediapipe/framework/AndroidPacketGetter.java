@@ -103,6 +103,11 @@ public final class AndroidPacketGetter {
   private static void copyRgbaToBitmap(Packet packet, Bitmap mutableBitmap, int width, int height) {
     // TODO: unify into a single getBitmap call.
     // TODO: use NDK Bitmap access instead of copyPixelsToBuffer.
+    if (PacketGetter.getImageWidthStep(packet) == width * 4) {
+      // Tightly packed rows can be copied straight out of the packet.
+      mutableBitmap.copyPixelsFromBuffer(PacketGetter.getImageDataDirect(packet));
+      return;
+    }
     ByteBuffer buffer = ByteBuffer.allocateDirect(width * height * 4);
     buffer.order(ByteOrder.nativeOrder());
     // Note: even though the Android Bitmap config is named ARGB_8888, the data
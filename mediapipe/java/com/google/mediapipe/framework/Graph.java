@@ -33,6 +33,7 @@ import java.util.Map;
 public class Graph {
   private static final FluentLogger logger = FluentLogger.forEnclosingClass();
   private static final int MAX_BUFFER_SIZE = 20;
+  private static final int DEFAULT_MAX_PACKET_BATCH_SIZE = 64;
   private long nativeGraphHandle;
   // Hold the references to callbacks (PacketCallback and PacketListCallback).
   private final List<Object> callbacks = new ArrayList<>();
@@ -202,6 +203,50 @@ public class Graph {
     nativeAddMultiStreamCallback(nativeGraphHandle, streamNames, callback, observeTimestampBounds);
   }
 
+  /**
+   * Adds a {@link PacketBatchCallback} that receives the packets of several output streams in
+   * batches.
+   *
+   * @see #addPacketBatchCallback(List, PacketBatchCallback, int, boolean)
+   */
+  public synchronized void addPacketBatchCallback(
+      List<String> streamNames, PacketBatchCallback callback) {
+    addPacketBatchCallback(streamNames, callback, DEFAULT_MAX_PACKET_BATCH_SIZE, false);
+  }
+
+  /**
+   * Adds a {@link PacketBatchCallback} that receives the packets of several output streams in
+   * batches.
+   *
+   * <p>Unlike {@link #addPacketCallback}, which makes one JNI upcall per packet and stream, packets
+   * from all of {@code streamNames} and from several timestamps share a single upcall: packets
+   * produced while a batch is being processed are delivered together in the next one. Unlike
+   * {@link #addMultiStreamCallback}, the streams are not synchronized by timestamp.
+   *
+   * @param streamNames The output stream names in the graph for callback.
+   * @param callback The callback for handling the batches.
+   * @param maxBatchSize The maximum number of packets delivered per call. The backing arrays of
+   *     this size are allocated once and reused for every call.
+   * @param observeTimestampBounds Whether to output an empty packet when a timestamp bound change
+   *     is observed with no output data.
+   * @throws MediaPipeException for any error status.
+   */
+  public synchronized void addPacketBatchCallback(
+      List<String> streamNames,
+      PacketBatchCallback callback,
+      int maxBatchSize,
+      boolean observeTimestampBounds) {
+    Preconditions.checkState(
+        nativeGraphHandle != 0, "Invalid context, tearDown() might have been called already.");
+    Preconditions.checkNotNull(streamNames);
+    Preconditions.checkNotNull(callback);
+    Preconditions.checkArgument(maxBatchSize > 0, "maxBatchSize must be positive.");
+    Preconditions.checkState(!graphRunning && !startRunningGraphCalled);
+    PacketBatch batch = new PacketBatch(streamNames, callback, maxBatchSize);
+    callbacks.add(batch);
+    nativeAddPacketBatchCallback(nativeGraphHandle, streamNames, batch, observeTimestampBounds);
+  }
+
   /**
    * Adds a {@link SurfaceOutput} for a stream producing GpuBuffers.
    *
@@ -552,6 +597,17 @@ public class Graph {
     nativeCancelGraph(nativeGraphHandle);
   }
 
+  /**
+   * Releases GPU buffers that MediaPipe keeps for reuse. Call this from {@code
+   * ComponentCallbacks2.onTrimMemory} with the level passed there: critical and background levels
+   * release every idle buffer, lower levels halve the memory held by the buffer pool.
+   */
+  public synchronized void trimGpuMemory(int level) {
+    Preconditions.checkState(
+        nativeGraphHandle != 0, "Invalid context, tearDown() might have been called already.");
+    nativeTrimGpuMemory(nativeGraphHandle, level);
+  }
+
   /** Returns {@link GraphProfiler}. */
   public GraphProfiler getProfiler() {
     Preconditions.checkState(
@@ -633,6 +689,9 @@ public class Graph {
       PacketListCallback callback,
       boolean observeTimestampBounds);
 
+  private native void nativeAddPacketBatchCallback(
+      long context, List<String> streamNames, PacketBatch batch, boolean observeTimestampBounds);
+
   private native long nativeAddSurfaceOutput(long context, String streamName);
 
   private native void nativeLoadBinaryGraph(long context, String path);
@@ -680,5 +739,7 @@ public class Graph {
 
   private native void nativeCancelGraph(long context);
 
+  private native void nativeTrimGpuMemory(long context, int level);
+
   private native long nativeGetProfiler(long context);
 }
@@ -0,0 +1,94 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package com.google.mediapipe.framework;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+
+/**
+ * A batch of packets delivered to a {@link PacketBatchCallback} in a single JNI upcall.
+ *
+ * <p>A batch can hold packets from several streams and timestamps. Packets of the same stream
+ * appear in timestamp order. The backing arrays are allocated once and refilled by native code for
+ * every delivery, so a batch must not be retained or accessed outside of the callback.
+ */
+public final class PacketBatch {
+  private final List<String> streamNames;
+  private final PacketBatchCallback callback;
+  // Filled in by native code before each call to dispatch.
+  private final long[] packetHandles;
+  private final int[] streamIndices;
+  private final long[] timestamps;
+  private final Packet[] packets;
+  private int size = 0;
+
+  PacketBatch(List<String> streamNames, PacketBatchCallback callback, int capacity) {
+    this.streamNames = new ArrayList<>(streamNames);
+    this.callback = callback;
+    packetHandles = new long[capacity];
+    streamIndices = new int[capacity];
+    timestamps = new long[capacity];
+    packets = new Packet[capacity];
+  }
+
+  /** Returns the number of packets in the batch. */
+  public int size() {
+    return size;
+  }
+
+  /** Returns the packet at {@code index}. It is only valid during the callback. */
+  public Packet getPacket(int index) {
+    checkIndex(index);
+    return packets[index];
+  }
+
+  /** Returns the index, in the registered stream names, of the stream that produced a packet. */
+  public int getStreamIndex(int index) {
+    checkIndex(index);
+    return streamIndices[index];
+  }
+
+  /** Returns the name of the stream that produced the packet at {@code index}. */
+  public String getStreamName(int index) {
+    return streamNames.get(getStreamIndex(index));
+  }
+
+  /** Returns the timestamp of the packet at {@code index}, without a call into native code. */
+  public long getTimestamp(int index) {
+    checkIndex(index);
+    return timestamps[index];
+  }
+
+  private void checkIndex(int index) {
+    if (index < 0 || index >= size) {
+      throw new IndexOutOfBoundsException("Index " + index + " out of bounds for size " + size);
+    }
+  }
+
+  /** Wraps the native handles and runs the callback. This is called by JNI code. */
+  private void dispatch(int size) {
+    for (int i = 0; i < size; ++i) {
+      packets[i] = Packet.create(packetHandles[i]);
+    }
+    this.size = size;
+    try {
+      callback.process(this);
+    } finally {
+      this.size = 0;
+      Arrays.fill(packets, 0, size, null);
+    }
+  }
+}
@@ -0,0 +1,28 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package com.google.mediapipe.framework;
+
+/**
+ * Interface for MediaPipe callbacks receiving the packets of several output streams in batches.
+ *
+ * <p>See {@link Graph#addPacketBatchCallback}.
+ */
+public interface PacketBatchCallback {
+  /**
+   * Called with the packets that became available since the previous call. The packets are
+   * released once this returns; use {@link Packet#copy} to keep one around.
+   */
+  public void process(PacketBatch batch);
+}
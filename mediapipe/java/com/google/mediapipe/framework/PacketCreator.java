@@ -375,6 +375,78 @@ public class PacketCreator {
         nativeCreateCpuImage(mediapipeGraph.getNativeHandle(), buffer, width, height, numChannels));
   }
 
+  /**
+   * Creates a 1, 3, or 4 channel 8-bit ImageFrame packet that shares the pixels of {@code buffer}
+   * instead of copying them.
+   *
+   * <p>The buffer must be allocated with {@link ByteBuffer#allocateDirect} and hold tightly packed
+   * rows of {@code width * numChannels} bytes. Since MediaPipe reads the pixels in place, the
+   * buffer must not be modified until {@code releaseCallback} has been invoked, which happens once
+   * the last packet referencing the pixels is destroyed.
+   *
+   * @param releaseCallback notified when the buffer can be reused, may be null.
+   */
+  public Packet createImageFrameNoCopy(
+      ByteBuffer buffer,
+      int width,
+      int height,
+      int numChannels,
+      ByteBufferReleaseCallback releaseCallback) {
+    checkNoCopyBuffer(buffer, width, height, numChannels);
+    return Packet.create(
+        nativeCreateImageFrameNoCopy(
+            mediapipeGraph.getNativeHandle(),
+            buffer,
+            width,
+            height,
+            numChannels,
+            releaseCallback));
+  }
+
+  /**
+   * Creates a 1, 3, or 4 channel 8-bit Image packet that shares the pixels of {@code buffer}
+   * instead of copying them.
+   *
+   * <p>See {@link #createImageFrameNoCopy} for the requirements on {@code buffer}.
+   */
+  public Packet createImageNoCopy(
+      ByteBuffer buffer,
+      int width,
+      int height,
+      int numChannels,
+      ByteBufferReleaseCallback releaseCallback) {
+    checkNoCopyBuffer(buffer, width, height, numChannels);
+    return Packet.create(
+        nativeCreateCpuImageNoCopy(
+            mediapipeGraph.getNativeHandle(),
+            buffer,
+            width,
+            height,
+            numChannels,
+            releaseCallback));
+  }
+
+  private static void checkNoCopyBuffer(ByteBuffer buffer, int width, int height, int numChannels) {
+    if (!buffer.isDirect()) {
+      throw new RuntimeException("Zero-copy packets require a direct ByteBuffer.");
+    }
+    if (numChannels != 1 && numChannels != 3 && numChannels != 4) {
+      throw new RuntimeException("Channels should be: 1, 3, or 4, but is " + numChannels);
+    }
+    if (buffer.capacity() < width * height * numChannels) {
+      throw new RuntimeException(
+          "The size of the buffer should be at least: "
+              + width * height * numChannels
+              + " but is "
+              + buffer.capacity());
+    }
+  }
+
+  /** Helper callback adaptor for zero-copy image packets. This is called by JNI code. */
+  private void releaseByteBuffer(ByteBuffer buffer, ByteBufferReleaseCallback releaseCallback) {
+    releaseCallback.release(buffer);
+  }
+
   /** Helper callback adaptor to create the Java {@link GlSyncToken}. This is called by JNI code. */
   private void releaseWithSyncToken(long nativeSyncToken, TextureReleaseCallback releaseCallback) {
     releaseCallback.release(new GraphGlSyncToken(nativeSyncToken));
@@ -432,6 +504,22 @@ public class PacketCreator {
   private native long nativeCreateCpuImage(
       long context, ByteBuffer buffer, int width, int height, int numChannels);
 
+  private native long nativeCreateImageFrameNoCopy(
+      long context,
+      ByteBuffer buffer,
+      int width,
+      int height,
+      int numChannels,
+      ByteBufferReleaseCallback releaseCallback);
+
+  private native long nativeCreateCpuImageNoCopy(
+      long context,
+      ByteBuffer buffer,
+      int width,
+      int height,
+      int numChannels,
+      ByteBufferReleaseCallback releaseCallback);
+
   private native long nativeCreateInt32Array(long context, int[] data);
 
   private native long nativeCreateFloat32Array(long context, float[] data);
@@ -22,6 +22,8 @@ import com.google.protobuf.InvalidProtocolBufferException;
 import com.google.protobuf.MessageLite;
 import com.google.protobuf.Parser;
 import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.FloatBuffer;
 import java.util.ArrayList;
 import java.util.List;
 
@@ -199,6 +201,23 @@ public final class PacketGetter {
     return nativeGetImageData(packet.getNativeHandle(), buffer);
   }
 
+  /**
+   * Returns a read-only view of the pixels of an ImageFrame or CPU Image packet without copying.
+   *
+   * <p>Rows start every {@link #getImageWidthStep} bytes and may be padded. The view does not
+   * keep the pixels alive: it must not be accessed after {@code packet} has been released.
+   */
+  public static ByteBuffer getImageDataDirect(final Packet packet) {
+    return nativeGetImageDataDirect(packet.getNativeHandle())
+        .asReadOnlyBuffer()
+        .order(ByteOrder.nativeOrder());
+  }
+
+  /** Returns the number of bytes between the starts of consecutive rows of an image packet. */
+  public static int getImageWidthStep(final Packet packet) {
+    return nativeGetImageWidthStep(packet.getNativeHandle());
+  }
+
   /**
    * Converts an RGB mediapipe image frame packet to an RGBA Byte buffer.
    *
@@ -274,6 +293,18 @@ public final class PacketGetter {
     return nativeGetMatrixData(packet.getNativeHandle());
   }
 
+  /**
+   * Returns a read-only, column major view of the matrix data without copying.
+   *
+   * <p>The view must not be accessed after {@code packet} has been released.
+   */
+  public static FloatBuffer getMatrixDataDirect(final Packet packet) {
+    return nativeGetMatrixDataDirect(packet.getNativeHandle())
+        .order(ByteOrder.nativeOrder())
+        .asFloatBuffer()
+        .asReadOnlyBuffer();
+  }
+
   public static int getMatrixRows(final Packet packet) {
     return nativeGetMatrixRows(packet.getNativeHandle());
   }
@@ -363,6 +394,10 @@ public final class PacketGetter {
 
   private static native boolean nativeGetImageData(long nativePacketHandle, ByteBuffer buffer);
 
+  private static native ByteBuffer nativeGetImageDataDirect(long nativePacketHandle);
+
+  private static native int nativeGetImageWidthStep(long nativePacketHandle);
+
   private static native boolean nativeGetRgbaFromRgb(long nativePacketHandle, ByteBuffer buffer);
   // Retrieves the values that are in the VideoHeader.
   private static native int nativeGetVideoHeaderWidth(long nativepackethandle);
@@ -376,6 +411,8 @@ public final class PacketGetter {
   // Audio data in MediaPipe current uses MediaPipe Matrix format type.
   private static native byte[] nativeGetAudioData(long nativePacketHandle);
   // Native helper functions to access the MediaPipe Matrix data.
+  private static native ByteBuffer nativeGetMatrixDataDirect(long nativePacketHandle);
+
   private static native float[] nativeGetMatrixData(long nativePacketHandle);
 
   private static native int nativeGetMatrixRows(long nativePacketHandle);
@@ -21,13 +21,24 @@
 #include "mediapipe/java/com/google/mediapipe/framework/jni/jni_util.h"
 #include "mediapipe/util/android/asset_manager_util.h"
 
+#if !MEDIAPIPE_DISABLE_GPU
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/gpu/gl_program_cache.h"
+#endif  // !MEDIAPIPE_DISABLE_GPU
+
 JNIEXPORT jboolean JNICALL ANDROID_ASSET_UTIL_METHOD(
     nativeInitializeAssetManager)(JNIEnv* env, jclass clz,
                                   jobject android_context,
                                   jstring cache_dir_path) {
   mediapipe::AssetManager* asset_manager =
       Singleton<mediapipe::AssetManager>::get();
-  return asset_manager->InitializeFromActivity(
-      env, android_context,
-      mediapipe::android::JStringToStdString(env, cache_dir_path));
+  const std::string cache_dir =
+      mediapipe::android::JStringToStdString(env, cache_dir_path);
+#if !MEDIAPIPE_DISABLE_GPU
+  // Keep compiled shaders across runs to speed up graph startup.
+  mediapipe::SetGlProgramCacheDirectory(
+      mediapipe::file::JoinPath(cache_dir, "mediapipe_gl_program_cache"));
+#endif  // !MEDIAPIPE_DISABLE_GPU
+  return asset_manager->InitializeFromActivity(env, android_context,
+                                               cache_dir);
 }
@@ -50,6 +50,8 @@ class ClassRegistry {
       "com/google/mediapipe/framework/Packet";
   static constexpr char const* kMediaPipeExceptionClassName =
       "com/google/mediapipe/framework/MediaPipeException";
+  static constexpr char const* kPacketBatchClassName =
+      "com/google/mediapipe/framework/PacketBatch";
   static constexpr char const* kPacketCallbackClassName =
       "com/google/mediapipe/framework/PacketCallback";
   static constexpr char const* kPacketListCallbackClassName =
@@ -16,6 +16,10 @@
 
 #include <pthread.h>
 
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/str_cat.h"
@@ -122,6 +126,176 @@ class CallbackHandler {
   // java callback object
   jobject java_callback_;
 };
+
+// Coalesces the packets of several output streams into one Java upcall.
+// Observers only append to a pending queue; the thread that finds no delivery
+// in progress drains it, so packets produced while Java is busy are handed
+// over together in the next upcall. The Java arrays are preallocated by
+// PacketBatch and reused for every upcall.
+class PacketBatchHandler {
+ public:
+  PacketBatchHandler(Graph* context, std::vector<std::string> stream_names,
+                     bool observe_timestamp_bounds)
+      : context_(context),
+        stream_names_(std::move(stream_names)),
+        observe_timestamp_bounds_(observe_timestamp_bounds) {}
+
+  ~PacketBatchHandler() {
+    // The jobject global references are managed by the Graph directly.
+    if (java_batch_) {
+      LOG(ERROR) << "Java packet batch global reference is not released.";
+    }
+  }
+
+  // Takes global references to |java_batch| and its backing arrays.
+  absl::Status Init(JNIEnv* env, jobject java_batch) {
+    auto& class_registry = mediapipe::android::ClassRegistry::GetInstance();
+    const char* batch_class_name =
+        mediapipe::android::ClassRegistry::kPacketBatchClassName;
+    jclass batch_cls = env->GetObjectClass(java_batch);
+    jfieldID handles_field = env->GetFieldID(
+        batch_cls,
+        class_registry.GetFieldName(batch_class_name, "packetHandles").c_str(),
+        "[J");
+    jfieldID indices_field = env->GetFieldID(
+        batch_cls,
+        class_registry.GetFieldName(batch_class_name, "streamIndices").c_str(),
+        "[I");
+    jfieldID timestamps_field = env->GetFieldID(
+        batch_cls,
+        class_registry.GetFieldName(batch_class_name, "timestamps").c_str(),
+        "[J");
+    dispatch_method_ = env->GetMethodID(
+        batch_cls,
+        class_registry.GetMethodName(batch_class_name, "dispatch").c_str(),
+        "(I)V");
+    env->DeleteLocalRef(batch_cls);
+    if (!handles_field || !indices_field || !timestamps_field ||
+        !dispatch_method_) {
+      return absl::InternalError("PacketBatch fields not found.");
+    }
+    java_batch_ = env->NewGlobalRef(java_batch);
+    handles_array_ = static_cast<jlongArray>(
+        TakeGlobalRef(env, env->GetObjectField(java_batch, handles_field)));
+    indices_array_ = static_cast<jintArray>(
+        TakeGlobalRef(env, env->GetObjectField(java_batch, indices_field)));
+    timestamps_array_ = static_cast<jlongArray>(
+        TakeGlobalRef(env, env->GetObjectField(java_batch, timestamps_field)));
+    capacity_ = env->GetArrayLength(handles_array_);
+    if (capacity_ <= 0) {
+      return absl::InvalidArgumentError("PacketBatch capacity must be > 0.");
+    }
+    handles_.resize(capacity_);
+    indices_.resize(capacity_);
+    timestamps_.resize(capacity_);
+    return absl::OkStatus();
+  }
+
+  absl::Status Observe(CalculatorGraph* graph) {
+    for (int i = 0; i < stream_names_.size(); ++i) {
+      MP_RETURN_IF_ERROR(graph->ObserveOutputStreamBatches(
+          stream_names_[i],
+          [this, i](const std::vector<Packet>& packets) {
+            Enqueue(i, packets);
+            return absl::OkStatus();
+          },
+          observe_timestamp_bounds_));
+    }
+    return absl::OkStatus();
+  }
+
+  // Releases the global references to the java objects.
+  // This is called by the Graph, since releasing of a jni object
+  // requires JNIEnv object that we can not keep a copy of.
+  void ReleaseCallback(JNIEnv* env) {
+    if (java_batch_) env->DeleteGlobalRef(java_batch_);
+    if (handles_array_) env->DeleteGlobalRef(handles_array_);
+    if (indices_array_) env->DeleteGlobalRef(indices_array_);
+    if (timestamps_array_) env->DeleteGlobalRef(timestamps_array_);
+    java_batch_ = nullptr;
+    handles_array_ = nullptr;
+    indices_array_ = nullptr;
+    timestamps_array_ = nullptr;
+  }
+
+ private:
+  static jobject TakeGlobalRef(JNIEnv* env, jobject local_ref) {
+    jobject global_ref = env->NewGlobalRef(local_ref);
+    env->DeleteLocalRef(local_ref);
+    return global_ref;
+  }
+
+  void Enqueue(int stream_index, const std::vector<Packet>& packets) {
+    {
+      absl::MutexLock lock(&mutex_);
+      for (const Packet& packet : packets) {
+        pending_.emplace_back(stream_index, packet);
+      }
+      if (delivering_) return;
+      delivering_ = true;
+    }
+    Deliver();
+  }
+
+  // Only one thread runs Deliver at a time, guarded by delivering_, so the
+  // scratch buffers need no further locking.
+  void Deliver() {
+    JNIEnv* env = mediapipe::java::GetJNIEnv();
+    while (true) {
+      {
+        absl::MutexLock lock(&mutex_);
+        if (pending_.empty()) {
+          delivering_ = false;
+          return;
+        }
+        const int count = std::min<int>(capacity_, pending_.size());
+        batch_.assign(std::make_move_iterator(pending_.begin()),
+                      std::make_move_iterator(pending_.begin() + count));
+        pending_.erase(pending_.begin(), pending_.begin() + count);
+      }
+      const int count = batch_.size();
+      for (int i = 0; i < count; ++i) {
+        handles_[i] = context_->WrapPacketIntoContext(batch_[i].second);
+        indices_[i] = batch_[i].first;
+        timestamps_[i] = batch_[i].second.Timestamp().Value();
+      }
+      env->SetLongArrayRegion(handles_array_, 0, count, handles_.data());
+      env->SetIntArrayRegion(indices_array_, 0, count, indices_.data());
+      env->SetLongArrayRegion(timestamps_array_, 0, count, timestamps_.data());
+      env->CallVoidMethod(java_batch_, dispatch_method_, count);
+      if (env->ExceptionCheck()) {
+        LOG(ERROR) << "Exception thrown by packet batch callback.";
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+      }
+      // release the packets after callback.
+      for (int i = 0; i < count; ++i) {
+        Graph::RemovePacket(handles_[i]);
+      }
+      batch_.clear();
+    }
+  }
+
+  Graph* context_;
+  const std::vector<std::string> stream_names_;
+  const bool observe_timestamp_bounds_;
+
+  jobject java_batch_ = nullptr;
+  jlongArray handles_array_ = nullptr;
+  jintArray indices_array_ = nullptr;
+  jlongArray timestamps_array_ = nullptr;
+  jmethodID dispatch_method_ = nullptr;
+  int capacity_ = 0;
+
+  absl::Mutex mutex_;
+  std::deque<std::pair<int, Packet>> pending_ ABSL_GUARDED_BY(mutex_);
+  bool delivering_ ABSL_GUARDED_BY(mutex_) = false;
+
+  std::vector<std::pair<int, Packet>> batch_;
+  std::vector<jlong> handles_;
+  std::vector<jint> indices_;
+  std::vector<jlong> timestamps_;
+};
 }  // namespace internal
 
 Graph::Graph()
@@ -141,6 +315,9 @@ Graph::~Graph() {
   for (const auto& handler : callback_handlers_) {
     handler->ReleaseCallback(env);
   }
+  for (const auto& handler : batch_handlers_) {
+    handler->ReleaseCallback(env);
+  }
   if (global_java_packet_cls_) {
     env->DeleteGlobalRef(global_java_packet_cls_);
     global_java_packet_cls_ = nullptr;
@@ -217,6 +394,31 @@ absl::Status Graph::AddMultiStreamCallbackHandler(
   return absl::OkStatus();
 }
 
+absl::Status Graph::AddPacketBatchHandler(
+    JNIEnv* env, std::vector<std::string> output_stream_names,
+    jobject java_batch, bool observe_timestamp_bounds) {
+  if (!graph_config()) {
+    return absl::InternalError("Graph is not loaded!");
+  }
+  auto handler = absl::make_unique<internal::PacketBatchHandler>(
+      this, std::move(output_stream_names), observe_timestamp_bounds);
+  absl::Status status = handler->Init(env, java_batch);
+  if (!status.ok()) {
+    handler->ReleaseCallback(env);
+    return status;
+  }
+  EnsureMinimumExecutorStackSizeForJava();
+  batch_handlers_.emplace_back(std::move(handler));
+  return absl::OkStatus();
+}
+
+absl::Status Graph::ObservePacketBatches(CalculatorGraph* graph) {
+  for (const auto& handler : batch_handlers_) {
+    MP_RETURN_IF_ERROR(handler->Observe(graph));
+  }
+  return absl::OkStatus();
+}
+
 int64_t Graph::AddSurfaceOutput(const std::string& output_stream_name) {
   if (!graph_config()) {
     LOG(ERROR) << "Graph is not loaded!";
@@ -417,6 +619,7 @@ absl::Status Graph::RunGraphUntilClose(JNIEnv* env) {
   // out the run.
   CalculatorGraph calculator_graph;
   absl::Status status = InitializeGraph(&calculator_graph);
+  if (status.ok()) status = ObservePacketBatches(&calculator_graph);
   if (!status.ok()) {
     LOG(ERROR) << status.message();
     running_graph_.reset(nullptr);
@@ -470,6 +673,7 @@ absl::Status Graph::StartRunningGraph(JNIEnv* env) {
   }
 
   status = InitializeGraph(running_graph_.get());
+  if (status.ok()) status = ObservePacketBatches(running_graph_.get());
   if (!status.ok()) {
     LOG(ERROR) << status.message();
     running_graph_.reset(nullptr);
@@ -606,6 +810,27 @@ void Graph::CancelGraph() {
   }
 }
 
+void Graph::TrimGpuMemory(int level) {
+#if !MEDIAPIPE_DISABLE_GPU
+  std::shared_ptr<mediapipe::GpuResources> gpu_resources = gpu_resources_;
+  if (!gpu_resources && running_graph_) {
+    gpu_resources = running_graph_->GetGpuResources();
+  }
+  if (!gpu_resources) return;
+  // ComponentCallbacks2.TRIM_MEMORY_RUNNING_CRITICAL. This and the higher
+  // levels, which are sent when the UI is hidden or the app is in the
+  // background, release every idle buffer. Lower levels halve the memory held.
+  constexpr int kTrimMemoryRunningCritical = 15;
+  GpuBufferMultiPool& pool = gpu_resources->gpu_buffer_pool();
+  if (level >= kTrimMemoryRunningCritical) {
+    pool.Trim(0);
+  } else {
+    const GpuBufferMultiPool::Stats stats = pool.GetStats();
+    pool.Trim((stats.in_use_bytes + stats.available_bytes) / 2);
+  }
+#endif  // !MEDIAPIPE_DISABLE_GPU
+}
+
 std::map<std::string, Packet> Graph::CreateCombinedSidePackets() {
   std::map<std::string, Packet> combined_side_packets = side_packets_callbacks_;
   combined_side_packets.insert(side_packets_.begin(), side_packets_.end());
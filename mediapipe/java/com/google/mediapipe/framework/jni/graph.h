@@ -36,6 +36,7 @@ namespace android {
 
 namespace internal {
 class CallbackHandler;
+class PacketBatchHandler;
 class PacketWithContext;
 }  // namespace internal
 
@@ -55,6 +56,11 @@ class Graph {
   absl::Status AddMultiStreamCallbackHandler(
       std::vector<std::string> output_stream_names, jobject java_callback,
       bool observe_timestamp_bounds);
+  // Adds a callback that receives the packets of multiple output streams in
+  // batches through a Java PacketBatch object.
+  absl::Status AddPacketBatchHandler(
+      JNIEnv* env, std::vector<std::string> output_stream_names,
+      jobject java_batch, bool observe_timestamp_bounds);
 
   // Loads a binary graph from a file.
   absl::Status LoadBinaryGraph(std::string path_to_graph);
@@ -145,6 +151,10 @@ class Graph {
   // Cancels the currently running graph.
   void CancelGraph();
 
+  // Releases idle GPU buffers in response to an Android onTrimMemory call.
+  // The level is one of the ComponentCallbacks2.TRIM_MEMORY_* values.
+  void TrimGpuMemory(int level);
+
   // Returns false if not in the context.
   static bool RemovePacket(int64_t packet_handle);
 
@@ -185,6 +195,9 @@ class Graph {
   std::string graph_type();
   // Initializes CalculatorGraph |graph| using the loaded graph-configs.
   absl::Status InitializeGraph(CalculatorGraph* graph);
+  // Installs the output stream observers of all PacketBatchHandlers on the
+  // initialized |graph|.
+  absl::Status ObservePacketBatches(CalculatorGraph* graph);
 
   // CalculatorGraphConfigs for the calculator graph and subgraphs.
   std::vector<CalculatorGraphConfig> graph_configs_;
@@ -211,6 +224,8 @@ class Graph {
   absl::Mutex all_packets_mutex_;
   // All callback handlers managed by the context.
   std::vector<std::unique_ptr<internal::CallbackHandler>> callback_handlers_;
+  // All packet batch handlers managed by the context.
+  std::vector<std::unique_ptr<internal::PacketBatchHandler>> batch_handlers_;
 
 #if !MEDIAPIPE_DISABLE_GPU
   // mediapipe::GpuResources used by the graph.
@@ -218,6 +218,26 @@ JNIEXPORT void JNICALL GRAPH_METHOD(nativeAddMultiStreamCallback)(
                         observe_timestamp_bounds));
 }
 
+JNIEXPORT void JNICALL GRAPH_METHOD(nativeAddPacketBatchCallback)(
+    JNIEnv* env, jobject thiz, jlong context, jobject stream_names,
+    jobject packet_batch, jboolean observe_timestamp_bounds) {
+  mediapipe::android::Graph* mediapipe_graph =
+      reinterpret_cast<mediapipe::android::Graph*>(context);
+  std::vector<std::string> output_stream_names =
+      JavaListToStdStringVector(env, stream_names);
+  for (const std::string& s : output_stream_names) {
+    if (s.empty()) {
+      ThrowIfError(env,
+                   absl::InternalError("streamNames is not correctly parsed or "
+                                       "it contains empty string."));
+      return;
+    }
+  }
+  ThrowIfError(env, mediapipe_graph->AddPacketBatchHandler(
+                        env, output_stream_names, packet_batch,
+                        observe_timestamp_bounds));
+}
+
 JNIEXPORT jlong JNICALL GRAPH_METHOD(nativeAddSurfaceOutput)(
     JNIEnv* env, jobject thiz, jlong context, jstring stream_name) {
   mediapipe::android::Graph* mediapipe_graph =
@@ -361,6 +381,15 @@ JNIEXPORT void JNICALL GRAPH_METHOD(nativeCancelGraph)(JNIEnv* env,
   mediapipe_graph->CancelGraph();
 }
 
+JNIEXPORT void JNICALL GRAPH_METHOD(nativeTrimGpuMemory)(JNIEnv* env,
+                                                         jobject thiz,
+                                                         jlong context,
+                                                         jint level) {
+  mediapipe::android::Graph* mediapipe_graph =
+      reinterpret_cast<mediapipe::android::Graph*>(context);
+  mediapipe_graph->TrimGpuMemory(level);
+}
+
 JNIEXPORT jlong JNICALL GRAPH_METHOD(nativeGetProfiler)(JNIEnv* env,
                                                         jobject thiz,
                                                         jlong context) {
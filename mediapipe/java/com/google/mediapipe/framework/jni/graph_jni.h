@@ -66,6 +66,10 @@ JNIEXPORT void JNICALL GRAPH_METHOD(nativeAddMultiStreamCallback)(
     JNIEnv* env, jobject thiz, jlong context, jobject stream_names,
     jobject callback, jboolean observe_timestamp_bounds);
 
+JNIEXPORT void JNICALL GRAPH_METHOD(nativeAddPacketBatchCallback)(
+    JNIEnv* env, jobject thiz, jlong context, jobject stream_names,
+    jobject packet_batch, jboolean observe_timestamp_bounds);
+
 JNIEXPORT jlong JNICALL GRAPH_METHOD(nativeAddSurfaceOutput)(
     JNIEnv* env, jobject thiz, jlong context, jstring stream_name);
 
@@ -118,6 +122,11 @@ JNIEXPORT void JNICALL GRAPH_METHOD(nativeCancelGraph)(JNIEnv* env,
                                                        jobject thiz,
                                                        jlong context);
 
+JNIEXPORT void JNICALL GRAPH_METHOD(nativeTrimGpuMemory)(JNIEnv* env,
+                                                         jobject thiz,
+                                                         jlong context,
+                                                         jint level);
+
 JNIEXPORT jlong JNICALL GRAPH_METHOD(nativeGetProfiler)(JNIEnv* env,
                                                         jobject thiz,
                                                         jlong context);
@@ -17,6 +17,7 @@
 #include <cstring>
 #include <memory>
 
+#include "absl/strings/str_cat.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/camera_intrinsics.h"
 #include "mediapipe/framework/formats/image.h"
@@ -160,6 +161,82 @@ std::unique_ptr<mediapipe::ImageFrame> CreateImageFrameFromByteBuffer(
   return image_frame;
 }
 
+// Wraps the pixels of a direct Java ByteBuffer in a 1, 3, or 4 channel 8-bit
+// ImageFrame without copying. Rows are expected to be tightly packed. The
+// ImageFrame holds a global reference to the buffer so that its memory outlives
+// every packet sharing the pixels, and calls back into Java through
+// PacketCreator#releaseByteBuffer once the pixels are no longer in use.
+absl::StatusOr<std::unique_ptr<mediapipe::ImageFrame>> WrapByteBuffer(
+    JNIEnv* env, jobject thiz, jobject byte_buffer, jint width, jint height,
+    jint num_channels, jobject release_callback) {
+  mediapipe::ImageFormat::Format format;
+  switch (num_channels) {
+    case 4:
+      format = mediapipe::ImageFormat::SRGBA;
+      break;
+    case 3:
+      format = mediapipe::ImageFormat::SRGB;
+      break;
+    case 1:
+      format = mediapipe::ImageFormat::GRAY8;
+      break;
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Channels must be either 1, 3, or 4, got ",
+                       num_channels, "."));
+  }
+
+  uint8_t* pixel_data =
+      static_cast<uint8_t*>(env->GetDirectBufferAddress(byte_buffer));
+  if (pixel_data == nullptr) {
+    return absl::InvalidArgumentError(
+        "Zero-copy packets require a direct ByteBuffer.");
+  }
+  const int width_step = width * num_channels;
+  const int64_t buffer_size = env->GetDirectBufferCapacity(byte_buffer);
+  if (buffer_size < static_cast<int64_t>(width_step) * height) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Buffer size ", buffer_size, " is smaller than the ",
+        static_cast<int64_t>(width_step) * height, " bytes needed."));
+  }
+
+  jmethodID release_method = nullptr;
+  if (release_callback) {
+    // See CreateGpuBuffer for why the method is not looked up on thiz.
+    jclass my_class =
+        env->FindClass("com/google/mediapipe/framework/PacketCreator");
+    release_method = env->GetMethodID(
+        my_class, "releaseByteBuffer",
+        "(Ljava/nio/ByteBuffer;L"
+        "com/google/mediapipe/framework/ByteBufferReleaseCallback"
+        ";)V");
+    env->DeleteLocalRef(my_class);
+    if (release_method == nullptr) {
+      return absl::InternalError("PacketCreator#releaseByteBuffer not found.");
+    }
+  }
+
+  jobject java_buffer = env->NewGlobalRef(byte_buffer);
+  jobject java_callback =
+      release_callback ? env->NewGlobalRef(release_callback) : nullptr;
+  jobject packet_creator = release_callback ? env->NewGlobalRef(thiz) : nullptr;
+  // The deleter runs once, on whichever thread drops the last reference to the
+  // pixels, so all global references are released here.
+  auto deleter = [java_buffer, java_callback, packet_creator,
+                  release_method](uint8_t*) {
+    JNIEnv* env = mediapipe::java::GetJNIEnv();
+    if (java_callback) {
+      env->CallVoidMethod(packet_creator, release_method, java_buffer,
+                          java_callback);
+      env->DeleteGlobalRef(java_callback);
+      env->DeleteGlobalRef(packet_creator);
+    }
+    env->DeleteGlobalRef(java_buffer);
+  };
+  return std::make_unique<mediapipe::ImageFrame>(
+      format, width, height, width_step, pixel_data, deleter);
+}
+
 }  // namespace
 
 JNIEXPORT jlong JNICALL PACKET_CREATOR_METHOD(nativeCreateReferencePacket)(
@@ -405,6 +482,28 @@ JNIEXPORT jlong JNICALL PACKET_CREATOR_METHOD(nativeCreateCpuImage)(
   return CreatePacketWithContext(context, packet);
 }
 
+JNIEXPORT jlong JNICALL PACKET_CREATOR_METHOD(nativeCreateImageFrameNoCopy)(
+    JNIEnv* env, jobject thiz, jlong context, jobject byte_buffer, jint width,
+    jint height, jint num_channels, jobject release_callback) {
+  auto image_frame_or = WrapByteBuffer(env, thiz, byte_buffer, width, height,
+                                       num_channels, release_callback);
+  if (ThrowIfError(env, image_frame_or.status())) return 0L;
+  mediapipe::Packet packet =
+      mediapipe::Adopt(std::move(image_frame_or).value().release());
+  return CreatePacketWithContext(context, packet);
+}
+
+JNIEXPORT jlong JNICALL PACKET_CREATOR_METHOD(nativeCreateCpuImageNoCopy)(
+    JNIEnv* env, jobject thiz, jlong context, jobject byte_buffer, jint width,
+    jint height, jint num_channels, jobject release_callback) {
+  auto image_frame_or = WrapByteBuffer(env, thiz, byte_buffer, width, height,
+                                       num_channels, release_callback);
+  if (ThrowIfError(env, image_frame_or.status())) return 0L;
+  mediapipe::Packet packet = mediapipe::MakePacket<mediapipe::Image>(
+      std::move(image_frame_or).value());
+  return CreatePacketWithContext(context, packet);
+}
+
 #if !MEDIAPIPE_DISABLE_GPU
 
 JNIEXPORT jlong JNICALL PACKET_CREATOR_METHOD(nativeCreateGpuImage)(
@@ -101,6 +101,18 @@ JNIEXPORT jlong JNICALL PACKET_CREATOR_METHOD(nativeCreateCpuImage)(
     JNIEnv* env, jobject thiz, jlong context, jobject byte_buffer, jint width,
     jint height, jint num_channels);
 
+// Creates an ImageFrame packet that shares the pixels of a direct ByteBuffer
+// instead of copying them. release_callback, if not null, is invoked once the
+// pixels are no longer referenced by any packet.
+JNIEXPORT jlong JNICALL PACKET_CREATOR_METHOD(nativeCreateImageFrameNoCopy)(
+    JNIEnv* env, jobject thiz, jlong context, jobject byte_buffer, jint width,
+    jint height, jint num_channels, jobject release_callback);
+
+// Same as nativeCreateImageFrameNoCopy, but produces a CPU-backed Image packet.
+JNIEXPORT jlong JNICALL PACKET_CREATOR_METHOD(nativeCreateCpuImageNoCopy)(
+    JNIEnv* env, jobject thiz, jlong context, jobject byte_buffer, jint width,
+    jint height, jint num_channels, jobject release_callback);
+
 JNIEXPORT jlong JNICALL PACKET_CREATOR_METHOD(nativeCreateGpuImage)(
     JNIEnv* env, jobject thiz, jlong context, jint name, jint width,
     jint height, jobject texture_release_callback);
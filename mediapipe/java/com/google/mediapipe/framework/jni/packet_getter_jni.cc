@@ -38,6 +38,18 @@ template <typename T>
 const T& GetFromNativeHandle(int64_t packet_handle) {
   return mediapipe::android::Graph::GetPacketFromHandle(packet_handle).Get<T>();
 }
+
+// Returns the ImageFrame held by an ImageFrame or Image packet.
+const mediapipe::ImageFrame& GetImageFrameFromNativeHandle(
+    int64_t packet_handle) {
+  mediapipe::Packet mediapipe_packet =
+      mediapipe::android::Graph::GetPacketFromHandle(packet_handle);
+  if (mediapipe_packet.ValidateAsType<mediapipe::Image>().ok()) {
+    return *GetFromNativeHandle<mediapipe::Image>(packet_handle)
+                .GetImageFrameSharedPtr();
+  }
+  return GetFromNativeHandle<mediapipe::ImageFrame>(packet_handle);
+}
 }  // namespace
 
 JNIEXPORT jlong JNICALL PACKET_GETTER_METHOD(nativeGetPacketFromReference)(
@@ -337,6 +349,21 @@ JNIEXPORT jboolean JNICALL PACKET_GETTER_METHOD(nativeGetImageData)(
   return true;
 }
 
+JNIEXPORT jobject JNICALL PACKET_GETTER_METHOD(nativeGetImageDataDirect)(
+    JNIEnv* env, jobject thiz, jlong packet) {
+  const mediapipe::ImageFrame& image = GetImageFrameFromNativeHandle(packet);
+  // The Image or ImageFrame is owned by the packet, so the pixels stay valid
+  // for as long as the Java Packet has not been released.
+  return env->NewDirectByteBuffer(const_cast<uint8*>(image.PixelData()),
+                                  static_cast<jlong>(image.Height()) *
+                                      image.WidthStep());
+}
+
+JNIEXPORT jint JNICALL PACKET_GETTER_METHOD(nativeGetImageWidthStep)(
+    JNIEnv* env, jobject thiz, jlong packet) {
+  return GetImageFrameFromNativeHandle(packet).WidthStep();
+}
+
 JNIEXPORT jboolean JNICALL PACKET_GETTER_METHOD(nativeGetRgbaFromRgb)(
     JNIEnv* env, jobject thiz, jlong packet, jobject byte_buffer) {
   mediapipe::Packet mediapipe_packet =
@@ -424,6 +451,15 @@ JNIEXPORT jfloatArray JNICALL PACKET_GETTER_METHOD(nativeGetMatrixData)(
   return float_data;
 }
 
+JNIEXPORT jobject JNICALL PACKET_GETTER_METHOD(nativeGetMatrixDataDirect)(
+    JNIEnv* env, jobject thiz, jlong packet) {
+  const mediapipe::Matrix& matrix =
+      GetFromNativeHandle<mediapipe::Matrix>(packet);
+  return env->NewDirectByteBuffer(const_cast<float*>(matrix.data()),
+                                  static_cast<jlong>(matrix.size()) *
+                                      sizeof(float));
+}
+
 JNIEXPORT jint JNICALL PACKET_GETTER_METHOD(nativeGetMatrixRows)(JNIEnv* env,
                                                                  jobject thiz,
                                                                  jlong packet) {
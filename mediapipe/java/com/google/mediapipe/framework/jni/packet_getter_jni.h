@@ -106,6 +106,16 @@ JNIEXPORT jint JNICALL PACKET_GETTER_METHOD(nativeGetImageHeight)(JNIEnv* env,
 JNIEXPORT jboolean JNICALL PACKET_GETTER_METHOD(nativeGetImageData)(
     JNIEnv* env, jobject thiz, jlong packet, jobject byte_buffer);
 
+// Returns a direct ByteBuffer viewing the pixel memory of an ImageFrame or CPU
+// Image packet, including any row padding. The view does not own the memory
+// and is only valid while the packet is alive.
+JNIEXPORT jobject JNICALL PACKET_GETTER_METHOD(nativeGetImageDataDirect)(
+    JNIEnv* env, jobject thiz, jlong packet);
+
+// Returns the number of bytes between the starts of consecutive image rows.
+JNIEXPORT jint JNICALL PACKET_GETTER_METHOD(nativeGetImageWidthStep)(
+    JNIEnv* env, jobject thiz, jlong packet);
+
 // Before calling this, the byte_buffer needs to have the correct allocated
 // size.
 JNIEXPORT jboolean JNICALL PACKET_GETTER_METHOD(nativeGetRgbaFromRgb)(
@@ -138,6 +148,11 @@ JNIEXPORT jdouble JNICALL PACKET_GETTER_METHOD(
 JNIEXPORT jfloatArray JNICALL PACKET_GETTER_METHOD(nativeGetMatrixData)(
     JNIEnv* env, jobject thiz, jlong packet);
 
+// Returns a direct ByteBuffer viewing the column major MediaPipe Matrix data.
+// The view is only valid while the packet is alive.
+JNIEXPORT jobject JNICALL PACKET_GETTER_METHOD(nativeGetMatrixDataDirect)(
+    JNIEnv* env, jobject thiz, jlong packet);
+
 // Returns the number of rows of the matrix.
 JNIEXPORT jint JNICALL PACKET_GETTER_METHOD(nativeGetMatrixRows)(JNIEnv* env,
                                                                  jobject thiz,
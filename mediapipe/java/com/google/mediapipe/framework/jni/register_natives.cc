@@ -119,6 +119,13 @@ void RegisterGraphNatives(JNIEnv *env) {
   AddJNINativeMethod(&graph_methods, graph, "nativeAddMultiStreamCallback",
                      native_add_multi_stream_callback_signature.c_str(),
                      (void *)&GRAPH_METHOD(nativeAddMultiStreamCallback));
+  std::string packet_batch_name = class_registry.GetClassName(
+      mediapipe::android::ClassRegistry::kPacketBatchClassName);
+  std::string native_add_packet_batch_callback_signature =
+      absl::StrFormat("(JLjava/util/List;L%s;Z)V", packet_batch_name);
+  AddJNINativeMethod(&graph_methods, graph, "nativeAddPacketBatchCallback",
+                     native_add_packet_batch_callback_signature.c_str(),
+                     (void *)&GRAPH_METHOD(nativeAddPacketBatchCallback));
   AddJNINativeMethod(&graph_methods, graph, "nativeMovePacketToInputStream",
                      "(JLjava/lang/String;JJ)V",
                      (void *)&GRAPH_METHOD(nativeMovePacketToInputStream));
@@ -29,6 +29,7 @@
 #include "mediapipe/framework/port/statusor.h"
 #include "mediapipe/gpu/gl_calculator_helper.h"
 #include "mediapipe/gpu/gpu_buffer.h"
+#include "mediapipe/gpu/gpu_buffer_format.h"
 #include "mediapipe/modules/face_geometry/effect_renderer_calculator.pb.h"
 #include "mediapipe/modules/face_geometry/libs/effect_renderer.h"
 #include "mediapipe/modules/face_geometry/libs/validation_utils.h"
@@ -83,6 +84,14 @@ static constexpr char kMultiFaceGeometryTag[] = "MULTI_FACE_GEOMETRY";
 //     If is not present, the runtime face mesh will be used as the effect mesh
 //     - this mode is handy for facepaint effects.
 //
+//   render_scale (`float`, optional, default: 1.0):
+//     Defines the resolution the effect is rendered at, relative to the input
+//     image resolution. Values less than 1 render the effect into a reduced
+//     resolution layer which is then upsampled on top of the input image.
+//
+// On OpenGL ES 3.0+, the effect mesh of all faces is rendered with instanced
+// draw calls.
+//
 class EffectRendererCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
@@ -131,9 +140,15 @@ class EffectRendererCalculator : public CalculatorBase {
                        ReadTextureFromFile(options.effect_texture_path()),
                        _ << "Failed to read the effect texture from file!");
 
+      face_geometry::EffectRendererOptions renderer_options;
+      renderer_options.use_instancing =
+          gpu_helper_.GetGlVersion() == GlVersion::kGLES3;
+      renderer_options.render_scale = options.render_scale();
+
       ASSIGN_OR_RETURN(effect_renderer_,
                        CreateEffectRenderer(environment, effect_mesh_3d,
-                                            std::move(effect_texture)),
+                                            std::move(effect_texture),
+                                            renderer_options),
                        _ << "Failed to create the effect renderer!");
 
       return absl::OkStatus();
@@ -14,14 +14,18 @@
 
 #include "mediapipe/modules/face_geometry/libs/effect_renderer.h"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdint>
 #include <limits>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_format.h"
 #include "absl/types/optional.h"
 #include "mediapipe/framework/formats/image_format.pb.h"
 #include "mediapipe/framework/formats/image_frame.h"
@@ -159,9 +163,31 @@ class Texture {
         /*is_owned*/ true));
   }
 
+  static absl::StatusOr<std::unique_ptr<Texture>> CreateEmpty(int width,
+                                                              int height) {
+    RET_CHECK(width > 0 && height > 0)
+        << "Texture must have positive dimensions!";
+
+    GLuint handle;
+    glGenTextures(1, &handle);
+    RET_CHECK(handle) << "Failed to initialize an OpenGL texture!";
+
+    glBindTexture(GL_TEXTURE_2D, handle);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return absl::WrapUnique(new Texture(handle, GL_TEXTURE_2D, width, height,
+                                        /*is_owned*/ true));
+  }
+
   ~Texture() {
     if (is_owned_) {
-      glDeleteProgram(handle_);
+      glDeleteTextures(1, &handle_);
     }
   }
 
@@ -201,7 +227,7 @@ class RenderTarget {
     // Renderbuffer handle might have never been created if this render target
     // is destroyed before `SetColorbuffer()` is called for the first time.
     if (renderbuffer_handle_) {
-      glDeleteFramebuffers(1, &renderbuffer_handle_);
+      glDeleteRenderbuffers(1, &renderbuffer_handle_);
     }
   }
 
@@ -286,18 +312,21 @@ class RenderTarget {
 
 class Renderer {
  public:
-  enum class RenderMode { OPAQUE, OVERDRAW, OCCLUSION };
-
-  static absl::StatusOr<std::unique_ptr<Renderer>> Create() {
-    static const GLint kAttrLocation[NUM_ATTRIBUTES] = {
-        ATTRIB_VERTEX,
-        ATTRIB_TEXTURE_POSITION,
-    };
-    static const GLchar* kAttrName[NUM_ATTRIBUTES] = {
-        "position",
-        "tex_coord",
-    };
+  enum class RenderMode {
+    OPAQUE,
+    // Same as `OPAQUE`, but accumulates premultiplied colors in the render
+    // target, so that it can be composited on top of another one later.
+    OPAQUE_PREMULTIPLIED,
+    OVERDRAW,
+    OCCLUSION,
+    // Blends premultiplied colors on top of the render target. The alpha is
+    // blended the same way as `OPAQUE` does.
+    COMPOSITE
+  };
 
+  // The instanced program is only created if `use_instancing` is true, which
+  // requires an OpenGL ES 3.0+ context.
+  static absl::StatusOr<std::unique_ptr<Renderer>> Create(bool use_instancing) {
     static const GLchar* kVertSrc = R"(
       uniform mat4 projection_mat;
       uniform mat4 model_mat;
@@ -324,34 +353,225 @@ class Renderer {
       }
     )";
 
-    GLuint program_handle = 0;
-    GlhCreateProgram(kVertSrc, kFragSrc, NUM_ATTRIBUTES,
-                     (const GLchar**)&kAttrName[0], kAttrLocation,
-                     &program_handle);
-    RET_CHECK(program_handle) << "Problem initializing the texture program!";
-    GLint projection_mat_uniform =
+    ASSIGN_OR_RETURN(GLuint program_handle,
+                     CreateProgram(kVertSrc, kFragSrc),
+                     _ << "Problem initializing the texture program!");
+    auto renderer = absl::WrapUnique(new Renderer(program_handle));
+    renderer->projection_mat_uniform_ =
         glGetUniformLocation(program_handle, "projection_mat");
-    GLint model_mat_uniform = glGetUniformLocation(program_handle, "model_mat");
-    GLint texture_uniform = glGetUniformLocation(program_handle, "texture");
+    renderer->model_mat_uniform_ =
+        glGetUniformLocation(program_handle, "model_mat");
+    renderer->texture_uniform_ =
+        glGetUniformLocation(program_handle, "texture");
 
-    RET_CHECK_NE(projection_mat_uniform, -1)
+    RET_CHECK_NE(renderer->projection_mat_uniform_, -1)
         << "Failed to find `projection_mat` uniform!";
-    RET_CHECK_NE(model_mat_uniform, -1)
+    RET_CHECK_NE(renderer->model_mat_uniform_, -1)
         << "Failed to find `model_mat` uniform!";
-    RET_CHECK_NE(texture_uniform, -1) << "Failed to find `texture` uniform!";
+    RET_CHECK_NE(renderer->texture_uniform_, -1)
+        << "Failed to find `texture` uniform!";
+
+    if (!use_instancing) {
+      return renderer;
+    }
+
+    const std::string instanced_vert_src = absl::StrFormat(R"(#version 300 es
+      uniform mat4 projection_mat;
+
+      layout(std140) uniform ModelMatrices {
+        mat4 model_mats[%d];
+      };
+
+      in vec4 position;
+      in vec4 tex_coord;
+
+      out vec2 v_tex_coord;
+
+      void main() {
+        v_tex_coord = tex_coord.xy;
+        gl_Position =
+            projection_mat * model_mats[gl_InstanceID] * position;
+      }
+    )",
+        kMaxInstancesPerDraw);
+
+    static const GLchar* kInstancedFragSrc = R"(#version 300 es
+      precision mediump float;
+
+      in vec2 v_tex_coord;
+      uniform sampler2D effect_texture;
+
+      out vec4 frag_color;
+
+      void main() {
+        frag_color = texture(effect_texture, v_tex_coord);
+      }
+    )";
 
-    return absl::WrapUnique(new Renderer(program_handle, projection_mat_uniform,
-                                         model_mat_uniform, texture_uniform));
+    ASSIGN_OR_RETURN(
+        renderer->instanced_program_handle_,
+        CreateProgram(instanced_vert_src.c_str(), kInstancedFragSrc),
+        _ << "Problem initializing the instanced texture program!");
+    const GLuint instanced_program_handle =
+        renderer->instanced_program_handle_;
+    renderer->instanced_projection_mat_uniform_ =
+        glGetUniformLocation(instanced_program_handle, "projection_mat");
+    renderer->instanced_texture_uniform_ =
+        glGetUniformLocation(instanced_program_handle, "effect_texture");
+    const GLuint model_mats_block_index =
+        glGetUniformBlockIndex(instanced_program_handle, "ModelMatrices");
+
+    RET_CHECK_NE(renderer->instanced_projection_mat_uniform_, -1)
+        << "Failed to find `projection_mat` uniform!";
+    RET_CHECK_NE(renderer->instanced_texture_uniform_, -1)
+        << "Failed to find `effect_texture` uniform!";
+    RET_CHECK_NE(model_mats_block_index, GL_INVALID_INDEX)
+        << "Failed to find `ModelMatrices` uniform block!";
+    glUniformBlockBinding(instanced_program_handle, model_mats_block_index,
+                          kModelMatricesBinding);
+
+    glGenBuffers(1, &renderer->model_mats_buffer_);
+    RET_CHECK(renderer->model_mats_buffer_)
+        << "Failed to initialize an OpenGL uniform buffer!";
+
+    return renderer;
   }
 
-  ~Renderer() { glDeleteProgram(program_handle_); }
+  ~Renderer() {
+    glDeleteProgram(program_handle_);
+    if (instanced_program_handle_) {
+      glDeleteProgram(instanced_program_handle_);
+    }
+    if (model_mats_buffer_) {
+      glDeleteBuffers(1, &model_mats_buffer_);
+    }
+  }
 
   absl::Status Render(const RenderTarget& render_target, const Texture& texture,
                       const RenderableMesh3d& mesh_3d,
                       const std::array<float, 16>& projection_mat,
                       const std::array<float, 16>& model_mat,
                       RenderMode render_mode) const {
-    glUseProgram(program_handle_);
+    return RenderMultiple(render_target, texture, {&mesh_3d}, projection_mat,
+                          {model_mat}, render_mode);
+  }
+
+  // Renders each of `meshes_3d` driven by the matching `model_mats` element
+  // within a single pass, i.e. the GL state is only set up once.
+  absl::Status RenderMultiple(
+      const RenderTarget& render_target, const Texture& texture,
+      const std::vector<const RenderableMesh3d*>& meshes_3d,
+      const std::array<float, 16>& projection_mat,
+      const std::vector<std::array<float, 16>>& model_mats,
+      RenderMode render_mode) const {
+    RET_CHECK_EQ(meshes_3d.size(), model_mats.size())
+        << "There must be a model matrix for each mesh!";
+    if (meshes_3d.empty()) {
+      return absl::OkStatus();
+    }
+
+    BeginPass(render_target, texture, program_handle_, texture_uniform_,
+              render_mode);
+    glUniformMatrix4fv(projection_mat_uniform_, 1, GL_FALSE,
+                       projection_mat.data());
+    for (int i = 0; i < meshes_3d.size(); ++i) {
+      const RenderableMesh3d& mesh_3d = *meshes_3d[i];
+      SetVertexAttributes(mesh_3d);
+      glUniformMatrix4fv(model_mat_uniform_, 1, GL_FALSE,
+                         model_mats[i].data());
+      glDrawElements(mesh_3d.primitive_type, mesh_3d.index_buffer.size(),
+                     GL_UNSIGNED_SHORT, mesh_3d.index_buffer.data());
+    }
+    EndPass(render_target, texture);
+
+    return absl::OkStatus();
+  }
+
+  // Renders `mesh_3d` once for each of `model_mats` within a single pass.
+  //
+  // If the instanced program is available, the model matrices are sourced
+  // from a uniform buffer and all the instances are drawn with a single
+  // instanced draw call per `kMaxInstancesPerDraw` of them. Otherwise, falls
+  // back to `RenderMultiple()`.
+  absl::Status RenderInstanced(
+      const RenderTarget& render_target, const Texture& texture,
+      const RenderableMesh3d& mesh_3d,
+      const std::array<float, 16>& projection_mat,
+      const std::vector<std::array<float, 16>>& model_mats,
+      RenderMode render_mode) const {
+    if (!instanced_program_handle_) {
+      return RenderMultiple(
+          render_target, texture,
+          std::vector<const RenderableMesh3d*>(model_mats.size(), &mesh_3d),
+          projection_mat, model_mats, render_mode);
+    }
+    if (model_mats.empty()) {
+      return absl::OkStatus();
+    }
+
+    BeginPass(render_target, texture, instanced_program_handle_,
+              instanced_texture_uniform_, render_mode);
+    glUniformMatrix4fv(instanced_projection_mat_uniform_, 1, GL_FALSE,
+                       projection_mat.data());
+    SetVertexAttributes(mesh_3d);
+    glBindBuffer(GL_UNIFORM_BUFFER, model_mats_buffer_);
+    glBindBufferBase(GL_UNIFORM_BUFFER, kModelMatricesBinding,
+                     model_mats_buffer_);
+    for (int first = 0; first < model_mats.size();
+         first += kMaxInstancesPerDraw) {
+      const int num_instances =
+          std::min<int>(kMaxInstancesPerDraw, model_mats.size() - first);
+      // Orphan the buffer storage first, so that the upload doesn't have to
+      // wait for the previous draw call to finish reading it. The whole block
+      // is always allocated as the bound range must cover it.
+      glBufferData(GL_UNIFORM_BUFFER,
+                   kMaxInstancesPerDraw * sizeof(std::array<float, 16>),
+                   nullptr, GL_STREAM_DRAW);
+      glBufferSubData(GL_UNIFORM_BUFFER, 0,
+                      num_instances * sizeof(std::array<float, 16>),
+                      model_mats[first].data());
+      glDrawElementsInstanced(mesh_3d.primitive_type,
+                              mesh_3d.index_buffer.size(), GL_UNSIGNED_SHORT,
+                              mesh_3d.index_buffer.data(), num_instances);
+    }
+    glBindBufferBase(GL_UNIFORM_BUFFER, kModelMatricesBinding, 0);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    EndPass(render_target, texture);
+
+    return absl::OkStatus();
+  }
+
+ private:
+  enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
+
+  // Number of `mat4` elements in the `ModelMatrices` uniform block. 16 of them
+  // take 1KB, well below the guaranteed minimum `GL_MAX_UNIFORM_BLOCK_SIZE`.
+  static constexpr int kMaxInstancesPerDraw = 16;
+  static constexpr GLuint kModelMatricesBinding = 0;
+
+  static absl::StatusOr<GLuint> CreateProgram(const GLchar* vert_src,
+                                              const GLchar* frag_src) {
+    static const GLint kAttrLocation[NUM_ATTRIBUTES] = {
+        ATTRIB_VERTEX,
+        ATTRIB_TEXTURE_POSITION,
+    };
+    static const GLchar* kAttrName[NUM_ATTRIBUTES] = {
+        "position",
+        "tex_coord",
+    };
+
+    GLuint program_handle = 0;
+    GlhCreateProgram(vert_src, frag_src, NUM_ATTRIBUTES,
+                     (const GLchar**)&kAttrName[0], kAttrLocation,
+                     &program_handle);
+    RET_CHECK(program_handle) << "Failed to create a program!";
+    return program_handle;
+  }
+
+  static void BeginPass(const RenderTarget& render_target,
+                        const Texture& texture, GLuint program_handle,
+                        GLint texture_uniform, RenderMode render_mode) {
+    glUseProgram(program_handle);
     // Set up the GL state.
     glEnable(GL_BLEND);
     glFrontFace(GL_CCW);
@@ -362,6 +582,13 @@ class Renderer {
         glDepthMask(GL_TRUE);
         break;
 
+      case RenderMode::OPAQUE_PREMULTIPLIED:
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
+                            GL_ONE_MINUS_SRC_ALPHA);
+        glEnable(GL_DEPTH_TEST);
+        glDepthMask(GL_TRUE);
+        break;
+
       case RenderMode::OVERDRAW:
         glBlendFunc(GL_ONE, GL_ZERO);
         glDisable(GL_DEPTH_TEST);
@@ -373,31 +600,38 @@ class Renderer {
         glEnable(GL_DEPTH_TEST);
         glDepthMask(GL_TRUE);
         break;
+
+      case RenderMode::COMPOSITE:
+        glBlendFuncSeparate(GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA,
+                            GL_ONE_MINUS_SRC_ALPHA);
+        glDisable(GL_DEPTH_TEST);
+        glDepthMask(GL_FALSE);
+        break;
     }
 
     render_target.Bind();
-    // Set up vertex attributes.
+    glEnableVertexAttribArray(ATTRIB_VERTEX);
+    glEnableVertexAttribArray(ATTRIB_TEXTURE_POSITION);
+    // Set up textures.
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(texture.target(), texture.handle());
+    glUniform1i(texture_uniform, 1);
+  }
+
+  static void SetVertexAttributes(const RenderableMesh3d& mesh_3d) {
     glVertexAttribPointer(
         ATTRIB_VERTEX, mesh_3d.vertex_position_size, GL_FLOAT, 0,
         mesh_3d.vertex_size * sizeof(float),
         mesh_3d.vertex_buffer.data() + mesh_3d.vertex_position_offset);
-    glEnableVertexAttribArray(ATTRIB_VERTEX);
     glVertexAttribPointer(
         ATTRIB_TEXTURE_POSITION, mesh_3d.tex_coord_position_size, GL_FLOAT, 0,
         mesh_3d.vertex_size * sizeof(float),
         mesh_3d.vertex_buffer.data() + mesh_3d.tex_coord_position_offset);
-    glEnableVertexAttribArray(ATTRIB_TEXTURE_POSITION);
-    // Set up textures and uniforms.
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(texture.target(), texture.handle());
-    glUniform1i(texture_uniform_, 1);
-    glUniformMatrix4fv(projection_mat_uniform_, 1, GL_FALSE,
-                       projection_mat.data());
-    glUniformMatrix4fv(model_mat_uniform_, 1, GL_FALSE, model_mat.data());
-    // Draw the mesh.
-    glDrawElements(mesh_3d.primitive_type, mesh_3d.index_buffer.size(),
-                   GL_UNSIGNED_SHORT, mesh_3d.index_buffer.data());
-    // Unbind textures and uniforms.
+  }
+
+  static void EndPass(const RenderTarget& render_target,
+                      const Texture& texture) {
+    // Unbind textures.
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(texture.target(), 0);
     render_target.Unbind();
@@ -411,24 +645,20 @@ class Renderer {
 
     glUseProgram(0);
     glFlush();
-
-    return absl::OkStatus();
   }
 
- private:
-  enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
-
-  Renderer(GLuint program_handle, GLint projection_mat_uniform,
-           GLint model_mat_uniform, GLint texture_uniform)
-      : program_handle_(program_handle),
-        projection_mat_uniform_(projection_mat_uniform),
-        model_mat_uniform_(model_mat_uniform),
-        texture_uniform_(texture_uniform) {}
+  explicit Renderer(GLuint program_handle) : program_handle_(program_handle) {}
 
   GLuint program_handle_;
-  GLint projection_mat_uniform_;
-  GLint model_mat_uniform_;
-  GLint texture_uniform_;
+  GLint projection_mat_uniform_ = -1;
+  GLint model_mat_uniform_ = -1;
+  GLint texture_uniform_ = -1;
+
+  // Only set if instancing is used.
+  GLuint instanced_program_handle_ = 0;
+  GLint instanced_projection_mat_uniform_ = -1;
+  GLint instanced_texture_uniform_ = -1;
+  GLuint model_mats_buffer_ = 0;
 };
 
 class EffectRendererImpl : public EffectRenderer {
@@ -440,9 +670,12 @@ class EffectRendererImpl : public EffectRenderer {
       RenderableMesh3d&& renderable_quad_mesh_3d,
       absl::optional<RenderableMesh3d>&& renderable_effect_mesh_3d,
       std::unique_ptr<Texture> empty_color_texture,
-      std::unique_ptr<Texture> effect_texture)
+      std::unique_ptr<Texture> effect_texture, float render_scale,
+      std::unique_ptr<RenderTarget> layer_render_target)
       : environment_(environment),
+        render_scale_(render_scale),
         render_target_(std::move(render_target)),
+        layer_render_target_(std::move(layer_render_target)),
         renderer_(std::move(renderer)),
         renderable_quad_mesh_3d_(std::move(renderable_quad_mesh_3d)),
         renderable_effect_mesh_3d_(std::move(renderable_effect_mesh_3d)),
@@ -499,9 +732,15 @@ class EffectRendererImpl : public EffectRenderer {
 
     // Extract pose transform matrices and meshes from the face geometry data;
     const int num_faces = multi_face_geometry.size();
+    if (num_faces == 0) {
+      return absl::OkStatus();
+    }
 
     std::vector<std::array<float, 16>> face_pose_transform_matrices(num_faces);
+    std::vector<std::array<float, 16>> occlusion_face_pose_transform_matrices(
+        num_faces);
     std::vector<RenderableMesh3d> renderable_face_meshes(num_faces);
+    std::vector<const RenderableMesh3d*> renderable_face_mesh_ptrs(num_faces);
     for (int i = 0; i < num_faces; ++i) {
       const FaceGeometry& face_geometry = multi_face_geometry[i];
 
@@ -512,56 +751,73 @@ class EffectRendererImpl : public EffectRenderer {
               face_geometry.pose_transform_matrix()),
           _ << "Failed to extract the face pose transformation matrix!");
 
+      // For occlusion, the pose transformation is moved ~1mm away from camera
+      // in order to allow the face mesh texture to be rendered without
+      // failing the depth test.
+      occlusion_face_pose_transform_matrices[i] =
+          face_pose_transform_matrices[i];
+      occlusion_face_pose_transform_matrices[i][14] -= 0.1f;  // ~ 1mm
+
       // Extract the face mesh as a renderable.
       ASSIGN_OR_RETURN(
           renderable_face_meshes[i],
           RenderableMesh3d::CreateFromProtoMesh3d(face_geometry.mesh()),
           _ << "Failed to extract a renderable face mesh!");
+      renderable_face_mesh_ptrs[i] = &renderable_face_meshes[i];
     }
 
     // Create a perspective matrix using the frame aspect ratio.
     std::array<float, 16> perspective_matrix = CreatePerspectiveMatrix(
         /*aspect_ratio*/ static_cast<float>(frame_width) / frame_height);
 
-    // Render a face mesh occluder for each face.
-    for (int i = 0; i < num_faces; ++i) {
-      const std::array<float, 16>& face_pose_transform_matrix =
-          face_pose_transform_matrices[i];
-      const RenderableMesh3d& renderable_face_mesh = renderable_face_meshes[i];
-
-      // Render the face mesh using the empty color texture, i.e. the face
-      // mesh occluder.
-      //
-      // For occlusion, the pose transformation is moved ~1mm away from camera
-      // in order to allow the face mesh texture to be rendered without
-      // failing the depth test.
-      std::array<float, 16> occlusion_face_pose_transform_matrix =
-          face_pose_transform_matrix;
-      occlusion_face_pose_transform_matrix[14] -= 0.1f;  // ~ 1mm
-      MP_RETURN_IF_ERROR(renderer_->Render(
-          *render_target_, *empty_color_texture_, renderable_face_mesh,
-          perspective_matrix, occlusion_face_pose_transform_matrix,
-          Renderer::RenderMode::OCCLUSION))
-          << "Failed to render the face mesh occluder!";
+    // When rendering at a reduced resolution, both the occluders and the
+    // effect go into a transparent layer that is later composited on top of
+    // the source texture copy.
+    const bool use_layer = render_scale_ < 1.f;
+    if (use_layer) {
+      MP_RETURN_IF_ERROR(UpdateLayer(frame_width, frame_height))
+          << "Failed to update the reduced resolution layer!";
+      layer_render_target_->Clear();
+    }
+    const RenderTarget& effect_render_target =
+        use_layer ? *layer_render_target_ : *render_target_;
+    const Renderer::RenderMode effect_render_mode =
+        use_layer ? Renderer::RenderMode::OPAQUE_PREMULTIPLIED
+                  : Renderer::RenderMode::OPAQUE;
+
+    // Render the face meshes using the empty color texture, i.e. the face mesh
+    // occluders, in a single pass.
+    MP_RETURN_IF_ERROR(renderer_->RenderMultiple(
+        effect_render_target, *empty_color_texture_, renderable_face_mesh_ptrs,
+        perspective_matrix, occlusion_face_pose_transform_matrices,
+        Renderer::RenderMode::OCCLUSION))
+        << "Failed to render the face mesh occluders!";
+
+    // Render the main face mesh effect component for all faces in a single
+    // pass. If there is no effect 3D mesh provided, then the face mesh itself
+    // is used as a topology for rendering (for example, this can be used for
+    // facepaint effects or AR makeup).
+    if (renderable_effect_mesh_3d_) {
+      MP_RETURN_IF_ERROR(renderer_->RenderInstanced(
+          effect_render_target, *effect_texture_, *renderable_effect_mesh_3d_,
+          perspective_matrix, face_pose_transform_matrices,
+          effect_render_mode))
+          << "Failed to render the main effect pass!";
+    } else {
+      MP_RETURN_IF_ERROR(renderer_->RenderMultiple(
+          effect_render_target, *effect_texture_, renderable_face_mesh_ptrs,
+          perspective_matrix, face_pose_transform_matrices,
+          effect_render_mode))
+          << "Failed to render the main effect pass!";
     }
 
-    // Render the main face mesh effect component for each face.
-    for (int i = 0; i < num_faces; ++i) {
-      const std::array<float, 16>& face_pose_transform_matrix =
-          face_pose_transform_matrices[i];
-
-      // If there is no effect 3D mesh provided, then the face mesh itself is
-      // used as a topology for rendering (for example, this can be used for
-      // facepaint effects or AR makeup).
-      const RenderableMesh3d& main_effect_mesh_3d =
-          renderable_effect_mesh_3d_ ? *renderable_effect_mesh_3d_
-                                     : renderable_face_meshes[i];
-
+    // Upsample the layer on top of the source texture copy.
+    if (use_layer) {
       MP_RETURN_IF_ERROR(renderer_->Render(
-          *render_target_, *effect_texture_, main_effect_mesh_3d,
-          perspective_matrix, face_pose_transform_matrix,
-          Renderer::RenderMode::OPAQUE))
-          << "Failed to render the main effect pass!";
+          *render_target_, *layer_texture_, renderable_quad_mesh_3d_,
+          identity_matrix_, identity_matrix_,
+          Renderer::RenderMode::COMPOSITE))
+          << "Failed to composite the reduced resolution layer!";
     }
 
     // At this point in the code, the destination texture must contain the
@@ -570,6 +826,27 @@ class EffectRendererImpl : public EffectRenderer {
   }
 
  private:
+  // (Re)creates the reduced resolution layer texture if it doesn't match the
+  // frame dimensions scaled by `render_scale_`.
+  absl::Status UpdateLayer(int frame_width, int frame_height) {
+    const int layer_width =
+        std::max(1, static_cast<int>(std::round(frame_width * render_scale_)));
+    const int layer_height = std::max(
+        1, static_cast<int>(std::round(frame_height * render_scale_)));
+    if (layer_texture_ && layer_texture_->width() == layer_width &&
+        layer_texture_->height() == layer_height) {
+      return absl::OkStatus();
+    }
+
+    ASSIGN_OR_RETURN(layer_texture_,
+                     Texture::CreateEmpty(layer_width, layer_height),
+                     _ << "Failed to create the layer texture!");
+    MP_RETURN_IF_ERROR(layer_render_target_->SetColorbuffer(*layer_texture_))
+        << "Failed to set the layer texture as the colorbuffer!";
+
+    return absl::OkStatus();
+  }
+
   std::array<float, 16> CreatePerspectiveMatrix(float aspect_ratio) const {
     static constexpr float kDegreesToRadians = M_PI / 180.f;
 
@@ -632,8 +909,12 @@ class EffectRendererImpl : public EffectRenderer {
   }
 
   Environment environment_;
+  float render_scale_;
 
   std::unique_ptr<RenderTarget> render_target_;
+  // Only set if `render_scale_` is less than 1.
+  std::unique_ptr<RenderTarget> layer_render_target_;
+  std::unique_ptr<Texture> layer_texture_;
   std::unique_ptr<Renderer> renderer_;
 
   RenderableMesh3d renderable_quad_mesh_3d_;
@@ -691,18 +972,27 @@ ImageFrame CreateEmptyColorTexture() {
 absl::StatusOr<std::unique_ptr<EffectRenderer>> CreateEffectRenderer(
     const Environment& environment,                //
     const absl::optional<Mesh3d>& effect_mesh_3d,  //
-    ImageFrame&& effect_texture) {
+    ImageFrame&& effect_texture,                   //
+    const EffectRendererOptions& options) {
   MP_RETURN_IF_ERROR(ValidateEnvironment(environment))
       << "Invalid environment!";
   if (effect_mesh_3d) {
     MP_RETURN_IF_ERROR(ValidateMesh3d(*effect_mesh_3d))
         << "Invalid effect 3D mesh!";
   }
+  RET_CHECK(options.render_scale > 0.f && options.render_scale <= 1.f)
+      << "Render scale must be in the (0, 1] range!";
 
   ASSIGN_OR_RETURN(std::unique_ptr<RenderTarget> render_target,
                    RenderTarget::Create(),
                    _ << "Failed to create a render target!");
-  ASSIGN_OR_RETURN(std::unique_ptr<Renderer> renderer, Renderer::Create(),
+  std::unique_ptr<RenderTarget> layer_render_target;
+  if (options.render_scale < 1.f) {
+    ASSIGN_OR_RETURN(layer_render_target, RenderTarget::Create(),
+                     _ << "Failed to create a layer render target!");
+  }
+  ASSIGN_OR_RETURN(std::unique_ptr<Renderer> renderer,
+                   Renderer::Create(options.use_instancing),
                    _ << "Failed to create a renderer!");
   ASSIGN_OR_RETURN(RenderableMesh3d renderable_quad_mesh_3d,
                    RenderableMesh3d::CreateFromProtoMesh3d(CreateQuadMesh3d()),
@@ -725,7 +1015,8 @@ absl::StatusOr<std::unique_ptr<EffectRenderer>> CreateEffectRenderer(
           environment, std::move(render_target), std::move(renderer),
           std::move(renderable_quad_mesh_3d),
           std::move(renderable_effect_mesh_3d),
-          std::move(empty_color_gl_texture), std::move(effect_gl_texture));
+          std::move(empty_color_gl_texture), std::move(effect_gl_texture),
+          options.render_scale, std::move(layer_render_target));
 
   return result;
 }
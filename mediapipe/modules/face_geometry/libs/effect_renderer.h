@@ -59,6 +59,26 @@ class EffectRenderer {
       GLuint dst_texture_name) = 0;
 };
 
+// Options for `CreateEffectRenderer`.
+struct EffectRendererOptions {
+  // Whether to render the effect mesh of all faces with instanced draw calls,
+  // sourcing the per-face pose transformation matrices from a uniform buffer.
+  // Requires an OpenGL ES 3.0+ context.
+  //
+  // Only applies when `effect_mesh_3d` is present, as the runtime face meshes
+  // differ between faces.
+  bool use_instancing = false;
+
+  // Scale of the resolution the face effect is rendered at, relative to the
+  // frame resolution. Must be in the (0, 1] range.
+  //
+  // If less than 1, the occluders and the effect meshes are rendered into a
+  // reduced resolution layer, which is then upsampled and blended on top of
+  // the full resolution source frame. This trades the effect sharpness for
+  // fill rate.
+  float render_scale = 1.f;
+};
+
 // Creates an instance of `EffectRenderer`.
 //
 // `effect_mesh_3d` defines a rigid 3d mesh which is "attached" to the face and
@@ -82,10 +102,14 @@ class EffectRenderer {
 //
 // `effect_texture` must have positive dimensions. Its format must be either
 // `SRGB` or `SRGBA`. Its memory must be aligned for GL usage.
+//
+// `options` must be valid (for details, please refer to the
+// `EffectRendererOptions` field comments).
 absl::StatusOr<std::unique_ptr<EffectRenderer>> CreateEffectRenderer(
     const Environment& environment,                //
     const absl::optional<Mesh3d>& effect_mesh_3d,  //
-    ImageFrame&& effect_texture);
+    ImageFrame&& effect_texture,                   //
+    const EffectRendererOptions& options = {});
 
 }  // namespace mediapipe::face_geometry
 
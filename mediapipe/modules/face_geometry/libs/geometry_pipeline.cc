@@ -75,16 +75,14 @@ class ScreenToMetricSpaceConverter {
       OriginPointLocation origin_point_location,      //
       InputSource input_source,                       //
       Eigen::Matrix3Xf&& canonical_metric_landmarks,  //
-      Eigen::VectorXf&& landmark_weights,             //
-      std::unique_ptr<ProcrustesSolver> procrustes_solver)
+      std::unique_ptr<FixedSourceProcrustesSolver> procrustes_solver)
       : origin_point_location_(origin_point_location),
         input_source_(input_source),
         canonical_metric_landmarks_(std::move(canonical_metric_landmarks)),
-        landmark_weights_(std::move(landmark_weights)),
         procrustes_solver_(std::move(procrustes_solver)) {}
 
-  // Converts `screen_landmark_list` into `metric_landmark_list` and estimates
-  // the `pose_transform_mat`.
+  // Converts `screen_landmark_list` into `metric_landmarks` and estimates the
+  // `pose_transform_mat`.
   //
   // Here's the algorithm summary:
   //
@@ -122,14 +120,14 @@ class ScreenToMetricSpaceConverter {
   //       time the screen-to-metric semantic barrier is passed.
   absl::Status Convert(const NormalizedLandmarkList& screen_landmark_list,  //
                        const PerspectiveCameraFrustum& pcf,                 //
-                       LandmarkList& metric_landmark_list,                  //
+                       Eigen::Matrix3Xf& metric_landmarks,                  //
                        Eigen::Matrix4f& pose_transform_mat) const {
     RET_CHECK_EQ(screen_landmark_list.landmark_size(),
                  canonical_metric_landmarks_.cols())
         << "The number of landmarks doesn't match the number passed upon "
            "initialization!";
 
-    Eigen::Matrix3Xf screen_landmarks;
+    Eigen::Matrix3Xf& screen_landmarks = metric_landmarks;
     ConvertLandmarkListToEigenMatrix(screen_landmark_list, screen_landmarks);
 
     ProjectXY(pcf, screen_landmarks);
@@ -158,14 +156,11 @@ class ScreenToMetricSpaceConverter {
     if (input_source_ == InputSource::FACE_DETECTION_PIPELINE) {
       Eigen::Matrix4f intermediate_pose_transform_mat;
       MP_RETURN_IF_ERROR(procrustes_solver_->SolveWeightedOrthogonalProblem(
-          canonical_metric_landmarks_, intermediate_landmarks,
-          landmark_weights_, intermediate_pose_transform_mat))
+          intermediate_landmarks, intermediate_pose_transform_mat))
           << "Failed to estimate pose transform matrix!";
 
-      intermediate_landmarks.row(2) =
-          (intermediate_pose_transform_mat *
-           canonical_metric_landmarks_.colwise().homogeneous())
-              .row(2);
+      SetTransformedCanonicalZ(intermediate_pose_transform_mat,
+                               intermediate_landmarks);
     }
     ASSIGN_OR_RETURN(const float second_iteration_scale,
                      EstimateScale(intermediate_landmarks),
@@ -178,35 +173,31 @@ class ScreenToMetricSpaceConverter {
     ChangeHandedness(screen_landmarks);
 
     // At this point, screen landmarks are converted into metric landmarks.
-    Eigen::Matrix3Xf& metric_landmarks = screen_landmarks;
-
     MP_RETURN_IF_ERROR(procrustes_solver_->SolveWeightedOrthogonalProblem(
-        canonical_metric_landmarks_, metric_landmarks, landmark_weights_,
-        pose_transform_mat))
+        metric_landmarks, pose_transform_mat))
         << "Failed to estimate pose transform matrix!";
 
     // For face detection input landmarks, re-write Z-coord from the canonical
     // landmarks and run the pose transform estimation again.
     if (input_source_ == InputSource::FACE_DETECTION_PIPELINE) {
-      metric_landmarks.row(2) =
-          (pose_transform_mat *
-           canonical_metric_landmarks_.colwise().homogeneous())
-              .row(2);
+      SetTransformedCanonicalZ(pose_transform_mat, metric_landmarks);
 
       MP_RETURN_IF_ERROR(procrustes_solver_->SolveWeightedOrthogonalProblem(
-          canonical_metric_landmarks_, metric_landmarks, landmark_weights_,
-          pose_transform_mat))
+          metric_landmarks, pose_transform_mat))
           << "Failed to estimate pose transform matrix!";
     }
 
     // Multiply each of the metric landmarks by the inverse pose
     // transformation matrix to align the runtime metric face landmarks with
-    // the canonical metric face landmarks.
-    metric_landmarks = (pose_transform_mat.inverse() *
-                        metric_landmarks.colwise().homogeneous())
-                           .topRows(3);
-
-    ConvertEigenMatrixToLandmarkList(metric_landmarks, metric_landmark_list);
+    // the canonical metric face landmarks. The affine part is applied directly
+    // rather than through homogeneous coordinates, which would build a 4xN
+    // temporary.
+    const Eigen::Matrix4f inverse_pose_transform_mat =
+        pose_transform_mat.inverse();
+    metric_landmarks =
+        (inverse_pose_transform_mat.topLeftCorner<3, 3>() * metric_landmarks)
+            .colwise() +
+        inverse_pose_transform_mat.topRightCorner<3, 1>();
 
     return absl::OkStatus();
   }
@@ -228,11 +219,21 @@ class ScreenToMetricSpaceConverter {
     landmarks.colwise() += Eigen::Vector3f(x_translation, y_translation, 0.f);
   }
 
+  // Replaces the Z coordinates of `landmarks` with the ones of the canonical
+  // landmarks transformed by `transform_mat`.
+  void SetTransformedCanonicalZ(const Eigen::Matrix4f& transform_mat,
+                                Eigen::Matrix3Xf& landmarks) const {
+    landmarks.row(2) =
+        (transform_mat.block<1, 3>(2, 0) * canonical_metric_landmarks_)
+            .array() +
+        transform_mat(2, 3);
+  }
+
   absl::StatusOr<float> EstimateScale(Eigen::Matrix3Xf& landmarks) const {
     Eigen::Matrix4f transform_mat;
-    MP_RETURN_IF_ERROR(procrustes_solver_->SolveWeightedOrthogonalProblem(
-        canonical_metric_landmarks_, landmarks, landmark_weights_,
-        transform_mat))
+    MP_RETURN_IF_ERROR(
+        procrustes_solver_->SolveWeightedOrthogonalProblem(landmarks,
+                                                           transform_mat))
         << "Failed to estimate canonical-to-runtime landmark set transform!";
 
     return transform_mat.col(0).norm();
@@ -260,7 +261,7 @@ class ScreenToMetricSpaceConverter {
   static void ConvertLandmarkListToEigenMatrix(
       const NormalizedLandmarkList& landmark_list,
       Eigen::Matrix3Xf& eigen_matrix) {
-    eigen_matrix = Eigen::Matrix3Xf(3, landmark_list.landmark_size());
+    eigen_matrix.resize(3, landmark_list.landmark_size());
     for (int i = 0; i < landmark_list.landmark_size(); ++i) {
       const auto& landmark = landmark_list.landmark(i);
       eigen_matrix(0, i) = landmark.x();
@@ -269,24 +270,11 @@ class ScreenToMetricSpaceConverter {
     }
   }
 
-  static void ConvertEigenMatrixToLandmarkList(
-      const Eigen::Matrix3Xf& eigen_matrix, LandmarkList& landmark_list) {
-    landmark_list.Clear();
-
-    for (int i = 0; i < eigen_matrix.cols(); ++i) {
-      auto& landmark = *landmark_list.add_landmark();
-      landmark.set_x(eigen_matrix(0, i));
-      landmark.set_y(eigen_matrix(1, i));
-      landmark.set_z(eigen_matrix(2, i));
-    }
-  }
-
   const OriginPointLocation origin_point_location_;
   const InputSource input_source_;
   Eigen::Matrix3Xf canonical_metric_landmarks_;
-  Eigen::VectorXf landmark_weights_;
 
-  std::unique_ptr<ProcrustesSolver> procrustes_solver_;
+  std::unique_ptr<FixedSourceProcrustesSolver> procrustes_solver_;
 };
 
 class GeometryPipelineImpl : public GeometryPipeline {
@@ -318,6 +306,10 @@ class GeometryPipelineImpl : public GeometryPipeline {
                                  frame_height);
 
     std::vector<FaceGeometry> multi_face_geometry;
+    multi_face_geometry.reserve(multi_face_landmarks.size());
+    // Reused by every face, so that the metric landmarks are only allocated
+    // once per frame.
+    Eigen::Matrix3Xf metric_face_landmarks;
 
     // From this point, the meaning of "face landmarks" is clarified further as
     // "screen face landmarks". This is done do distinguish from "metric face
@@ -332,7 +324,6 @@ class GeometryPipelineImpl : public GeometryPipeline {
 
       // Convert the screen landmarks into the metric landmarks and get the pose
       // transformation matrix.
-      LandmarkList metric_face_landmarks;
       Eigen::Matrix4f pose_transform_mat;
       MP_RETURN_IF_ERROR(space_converter_->Convert(screen_face_landmarks, pcf,
                                                    metric_face_landmarks,
@@ -340,27 +331,21 @@ class GeometryPipelineImpl : public GeometryPipeline {
           << "Failed to convert landmarks from the screen to the metric space!";
 
       // Pack geometry data for this face.
-      FaceGeometry face_geometry;
+      FaceGeometry& face_geometry = multi_face_geometry.emplace_back();
       Mesh3d* mutable_mesh = face_geometry.mutable_mesh();
       // Copy the canonical face mesh as the face geometry mesh.
       mutable_mesh->CopyFrom(canonical_mesh_);
-      // Replace XYZ vertex mesh coodinates with the metric landmark positions.
-      for (int i = 0; i < canonical_mesh_num_vertices_; ++i) {
-        uint32_t vertex_buffer_offset = canonical_mesh_vertex_size_ * i +
-                                        canonical_mesh_vertex_position_offset_;
-
-        mutable_mesh->set_vertex_buffer(vertex_buffer_offset,
-                                        metric_face_landmarks.landmark(i).x());
-        mutable_mesh->set_vertex_buffer(vertex_buffer_offset + 1,
-                                        metric_face_landmarks.landmark(i).y());
-        mutable_mesh->set_vertex_buffer(vertex_buffer_offset + 2,
-                                        metric_face_landmarks.landmark(i).z());
-      }
+      // Replace XYZ vertex mesh coodinates with the metric landmark positions,
+      // writing straight into the vertex buffer through a strided map.
+      Eigen::Map<Eigen::Matrix3Xf, Eigen::Unaligned, Eigen::OuterStride<>>(
+          mutable_mesh->mutable_vertex_buffer()->mutable_data() +
+              canonical_mesh_vertex_position_offset_,
+          3, canonical_mesh_num_vertices_,
+          Eigen::OuterStride<>(canonical_mesh_vertex_size_)) =
+          metric_face_landmarks;
       // Populate the face pose transformation matrix.
       mediapipe::MatrixDataProtoFromMatrix(
           pose_transform_mat, face_geometry.mutable_pose_transform_matrix());
-
-      multi_face_geometry.push_back(face_geometry);
     }
 
     return multi_face_geometry;
@@ -446,6 +431,12 @@ absl::StatusOr<std::unique_ptr<GeometryPipeline>> CreateGeometryPipeline(
     landmark_weights(landmark_id) = wlr.weight();
   }
 
+  ASSIGN_OR_RETURN(
+      std::unique_ptr<FixedSourceProcrustesSolver> procrustes_solver,
+      FixedSourceProcrustesSolver::Create(canonical_metric_landmarks,
+                                          landmark_weights),
+      _ << "Failed to create the Procrustes solver!");
+
   std::unique_ptr<GeometryPipeline> result =
       absl::make_unique<GeometryPipelineImpl>(
           environment.perspective_camera(), canonical_mesh,
@@ -457,8 +448,7 @@ absl::StatusOr<std::unique_ptr<GeometryPipeline>> CreateGeometryPipeline(
                   ? InputSource::FACE_LANDMARK_PIPELINE
                   : metadata.input_source(),
               std::move(canonical_metric_landmarks),
-              std::move(landmark_weights),
-              CreateFloatPrecisionProcrustesSolver()));
+              std::move(procrustes_solver)));
 
   return result;
 }
@@ -28,6 +28,41 @@ namespace mediapipe {
 namespace face_geometry {
 namespace {
 
+constexpr float kAbsoluteErrorEps = 1e-9f;
+
+// `design_matrix` is a transposed LHS of (51) in the paper referenced below.
+//
+// Note: the output `rotation` argument is used instead of `StatusOr<>`
+// return type in order to avoid Eigen memory alignment issues. Details:
+// https://eigen.tuxfamily.org/dox/group__TopicStructHavingEigenMembers.html
+absl::Status ComputeOptimalRotation(const Eigen::Matrix3f& design_matrix,
+                                    Eigen::Matrix3f& rotation) {
+  RET_CHECK_GT(design_matrix.norm(), kAbsoluteErrorEps)
+      << "Design matrix norm is too small!";
+
+  Eigen::JacobiSVD<Eigen::Matrix3f> svd(
+      design_matrix, Eigen::ComputeFullU | Eigen::ComputeFullV);
+
+  Eigen::Matrix3f postrotation = svd.matrixU();
+  Eigen::Matrix3f prerotation = svd.matrixV().transpose();
+
+  // Disallow reflection by ensuring that det(`rotation`) = +1 (and not -1),
+  // see "4.6 Constrained orthogonal Procrustes problems"
+  // in the Gower & Dijksterhuis's book "Procrustes Analysis".
+  // We flip the sign of the least singular value along with a column in W.
+  //
+  // Note that now the sum of singular values doesn't work for scale
+  // estimation due to this sign flip.
+  if (postrotation.determinant() * prerotation.determinant() <
+      static_cast<float>(0)) {
+    postrotation.col(2) *= static_cast<float>(-1);
+  }
+
+  // Transposed (52) from the paper.
+  rotation = postrotation * prerotation;
+  return absl::OkStatus();
+}
+
 class FloatPrecisionProcrustesSolver : public ProcrustesSolver {
  public:
   FloatPrecisionProcrustesSolver() = default;
@@ -56,8 +91,6 @@ class FloatPrecisionProcrustesSolver : public ProcrustesSolver {
   }
 
  private:
-  static constexpr float kAbsoluteErrorEps = 1e-9f;
-
   static absl::Status ValidateInputPoints(
       const Eigen::Matrix3Xf& source_points,
       const Eigen::Matrix3Xf& target_points) {
@@ -198,39 +231,6 @@ class FloatPrecisionProcrustesSolver : public ProcrustesSolver {
     return absl::OkStatus();
   }
 
-  // `design_matrix` is a transposed LHS of (51) in the paper.
-  //
-  // Note: the output `rotation` argument is used instead of `StatusOr<>`
-  // return type in order to avoid Eigen memory alignment issues. Details:
-  // https://eigen.tuxfamily.org/dox/group__TopicStructHavingEigenMembers.html
-  static absl::Status ComputeOptimalRotation(
-      const Eigen::Matrix3f& design_matrix, Eigen::Matrix3f& rotation) {
-    RET_CHECK_GT(design_matrix.norm(), kAbsoluteErrorEps)
-        << "Design matrix norm is too small!";
-
-    Eigen::JacobiSVD<Eigen::Matrix3f> svd(
-        design_matrix, Eigen::ComputeFullU | Eigen::ComputeFullV);
-
-    Eigen::Matrix3f postrotation = svd.matrixU();
-    Eigen::Matrix3f prerotation = svd.matrixV().transpose();
-
-    // Disallow reflection by ensuring that det(`rotation`) = +1 (and not -1),
-    // see "4.6 Constrained orthogonal Procrustes problems"
-    // in the Gower & Dijksterhuis's book "Procrustes Analysis".
-    // We flip the sign of the least singular value along with a column in W.
-    //
-    // Note that now the sum of singular values doesn't work for scale
-    // estimation due to this sign flip.
-    if (postrotation.determinant() * prerotation.determinant() <
-        static_cast<float>(0)) {
-      postrotation.col(2) *= static_cast<float>(-1);
-    }
-
-    // Transposed (52) from the paper.
-    rotation = postrotation * prerotation;
-    return absl::OkStatus();
-  }
-
   static absl::StatusOr<float> ComputeOptimalScale(
       const Eigen::Matrix3Xf& centered_weighted_sources,
       const Eigen::Matrix3Xf& weighted_sources,
@@ -262,5 +262,85 @@ std::unique_ptr<ProcrustesSolver> CreateFloatPrecisionProcrustesSolver() {
   return absl::make_unique<FloatPrecisionProcrustesSolver>();
 }
 
+// With the point weights w_i, the source points s_i and the target points t_i,
+// the terms of FloatPrecisionProcrustesSolver reduce to:
+//
+//   design matrix = sum(w_i t_i tranposed(s_i - c_s)),
+//   scale = trace(R tranposed(design matrix)) / sum(w_i (s_i - c_s) . s_i),
+//   translation = c_t - scale R c_s,
+//
+// where c_s and c_t are the weighted centers of mass of the source and the
+// target points. Only the design matrix and c_t depend on the target points.
+absl::StatusOr<std::unique_ptr<FixedSourceProcrustesSolver>>
+FixedSourceProcrustesSolver::Create(const Eigen::Matrix3Xf& source_points,
+                                    const Eigen::VectorXf& point_weights) {
+  RET_CHECK_GT(source_points.cols(), 0)
+      << "The number of source points must be positive!";
+  RET_CHECK_EQ(point_weights.size(), source_points.cols())
+      << "The number of points and point weights must be equal!";
+
+  auto solver = absl::WrapUnique(new FixedSourceProcrustesSolver());
+  solver->num_points_ = source_points.cols();
+  for (int i = 0; i < point_weights.size(); ++i) {
+    RET_CHECK_GE(point_weights(i), 0.f)
+        << "Each point weight must be non-negative!";
+    if (point_weights(i) > 0.f) {
+      solver->point_indices_.push_back(i);
+      solver->total_weight_ += point_weights(i);
+    }
+  }
+  RET_CHECK_GT(solver->total_weight_, kAbsoluteErrorEps)
+      << "The total point weight is too small!";
+
+  const int num_weighted_points = solver->point_indices_.size();
+  solver->weights_.resize(num_weighted_points);
+  Eigen::Matrix3Xf sources(3, num_weighted_points);
+  for (int k = 0; k < num_weighted_points; ++k) {
+    solver->weights_(k) = point_weights(solver->point_indices_[k]);
+    sources.col(k) = source_points.col(solver->point_indices_[k]);
+  }
+  solver->source_center_of_mass_ =
+      (sources * solver->weights_) / solver->total_weight_;
+  solver->weighted_centered_sources_ =
+      (sources.colwise() - solver->source_center_of_mass_).array().rowwise() *
+      solver->weights_.array().transpose();
+  solver->scale_denominator_ =
+      solver->weighted_centered_sources_.cwiseProduct(sources).sum();
+  RET_CHECK_GT(solver->scale_denominator_, kAbsoluteErrorEps)
+      << "Scale expression denominator is too small!";
+
+  return solver;
+}
+
+absl::Status FixedSourceProcrustesSolver::SolveWeightedOrthogonalProblem(
+    const Eigen::Matrix3Xf& target_points,
+    Eigen::Matrix4f& transform_mat) const {
+  RET_CHECK_EQ(target_points.cols(), num_points_)
+      << "The number of source and target points must be equal!";
+
+  Eigen::Matrix3f design_matrix = Eigen::Matrix3f::Zero();
+  Eigen::Vector3f target_center_of_mass = Eigen::Vector3f::Zero();
+  for (int k = 0; k < point_indices_.size(); ++k) {
+    const Eigen::Vector3f target = target_points.col(point_indices_[k]);
+    design_matrix.noalias() +=
+        target * weighted_centered_sources_.col(k).transpose();
+    target_center_of_mass += weights_(k) * target;
+  }
+  target_center_of_mass /= total_weight_;
+
+  Eigen::Matrix3f rotation;
+  MP_RETURN_IF_ERROR(ComputeOptimalRotation(design_matrix, rotation))
+      << "Failed to compute the optimal rotation!";
+  const float scale =
+      rotation.cwiseProduct(design_matrix).sum() / scale_denominator_;
+  RET_CHECK_GT(scale, kAbsoluteErrorEps) << "Scale is too small!";
+
+  transform_mat = Eigen::Matrix4f::Identity();
+  transform_mat.topLeftCorner<3, 3>() = scale * rotation;
+  transform_mat.topRightCorner<3, 1>() =
+      target_center_of_mass - scale * rotation * source_center_of_mass_;
+  return absl::OkStatus();
+}
+
 }  // namespace face_geometry
 }  // namespace mediapipe
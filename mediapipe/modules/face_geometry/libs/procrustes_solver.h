@@ -16,9 +16,11 @@
 #define MEDIAPIPE_FACE_GEOMETRY_LIBS_PROCRUSTES_SOLVER_H_
 
 #include <memory>
+#include <vector>
 
 #include "Eigen/Dense"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/statusor.h"
 
 namespace mediapipe::face_geometry {
 
@@ -65,6 +67,48 @@ class ProcrustesSolver {
 
 std::unique_ptr<ProcrustesSolver> CreateFloatPrecisionProcrustesSolver();
 
+// Solves the same problem as `ProcrustesSolver` for a source point cloud and
+// point weights that are fixed upon creation, like the canonical face mesh and
+// the Procrustes landmark basis of the face geometry pipeline.
+//
+// Everything that depends on the source points only is computed once, and only
+// points with a positive weight are visited, so solving for a target point
+// cloud takes a few fixed-size 3x3 operations per weighted point and doesn't
+// allocate. This makes it cheap to solve for every face of a frame.
+class FixedSourceProcrustesSolver {
+ public:
+  // All `source_points` and `point_weights` must define the same number of
+  // points. Elements of `point_weights` must be non-negative.
+  static absl::StatusOr<std::unique_ptr<FixedSourceProcrustesSolver>> Create(
+      const Eigen::Matrix3Xf& source_points,
+      const Eigen::VectorXf& point_weights);
+
+  // Estimates the transformation from the source point cloud into
+  // `target_points`, which must define as many points as the source.
+  //
+  // Note: the output `transform_mat` argument is used instead of `StatusOr<>`
+  // return type in order to avoid Eigen memory alignment issues. Details:
+  // https://eigen.tuxfamily.org/dox/group__TopicStructHavingEigenMembers.html
+  absl::Status SolveWeightedOrthogonalProblem(
+      const Eigen::Matrix3Xf& target_points,
+      Eigen::Matrix4f& transform_mat) const;
+
+ private:
+  FixedSourceProcrustesSolver() = default;
+
+  int num_points_ = 0;
+  // Indices of the points with a positive weight.
+  std::vector<int> point_indices_;
+  // Weights of the points with a positive weight.
+  Eigen::VectorXf weights_;
+  // Weighted source points, centered at the source center of mass.
+  Eigen::Matrix3Xf weighted_centered_sources_;
+  Eigen::Vector3f source_center_of_mass_;
+  float total_weight_ = 0.f;
+  // Denominator of the optimal scale, which only depends on the source.
+  float scale_denominator_ = 0.f;
+};
+
 }  // namespace mediapipe::face_geometry
 
 #endif  // MEDIAPIPE_FACE_GEOMETRY_LIBS_PROCRUSTES_SOLVER_H_
@@ -0,0 +1,167 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A command line utility to benchmark the latency of HolisticLandmarkCpu on an
+// image, with the left hand, right hand and face branches on the executors
+// the graph declares for them, and with every node on the default executor.
+// For example:
+//
+//   bazel run -c opt \
+//     //mediapipe/modules/holistic_landmark:holistic_landmark_benchmark -- \
+//     --image_path=person.jpg --default_executor_threads=2
+//
+// The image should show a person, otherwise the hand and face branches don't
+// run. The latency of a frame is the time until the graph is idle again.
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/opencv_imgcodecs_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/tool/subgraph_expansion.h"
+
+ABSL_FLAG(std::string, image_path, "", "Path to an image showing a person.");
+ABSL_FLAG(int, default_executor_threads, -1,
+          "The number of threads of the default executor. -1 lets the "
+          "framework choose.");
+ABSL_FLAG(int, num_runs, 100, "The number of timed frames.");
+ABSL_FLAG(int, warmup_runs, 10, "The number of frames before the timed ones.");
+
+namespace mediapipe {
+namespace {
+
+constexpr char kImageStream[] = "image";
+
+// Returns the nearest-rank percentile of sorted durations in milliseconds.
+double PercentileMs(const std::vector<absl::Duration>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  int rank = static_cast<int>(std::ceil(p / 100 * sorted.size()));
+  rank = std::min<int>(std::max(rank, 1), sorted.size());
+  return absl::ToDoubleMilliseconds(sorted[rank - 1]);
+}
+
+absl::StatusOr<CalculatorGraphConfig> MakeGraphConfig(bool branch_executors) {
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "image"
+    node {
+      calculator: "HolisticLandmarkCpu"
+      input_stream: "IMAGE:image"
+      output_stream: "POSE_LANDMARKS:pose_landmarks"
+      output_stream: "LEFT_HAND_LANDMARKS:left_hand_landmarks"
+      output_stream: "RIGHT_HAND_LANDMARKS:right_hand_landmarks"
+      output_stream: "FACE_LANDMARKS:face_landmarks"
+    }
+  )pb");
+  if (absl::GetFlag(FLAGS_default_executor_threads) > 0) {
+    config.set_num_threads(absl::GetFlag(FLAGS_default_executor_threads));
+  }
+  if (!branch_executors) {
+    // Moves every node of the expanded graph to the default executor.
+    MP_RETURN_IF_ERROR(tool::ExpandSubgraphs(&config));
+    config.clear_executor();
+    for (auto& node : *config.mutable_node()) {
+      node.clear_executor();
+    }
+  }
+  return config;
+}
+
+absl::StatusOr<std::vector<absl::Duration>> RunBenchmark(
+    bool branch_executors, const cv::Mat& image) {
+  ASSIGN_OR_RETURN(CalculatorGraphConfig config,
+                   MakeGraphConfig(branch_executors));
+  CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(config));
+  MP_RETURN_IF_ERROR(graph.StartRun({}));
+
+  const int warmup_runs = absl::GetFlag(FLAGS_warmup_runs);
+  const int num_runs = absl::GetFlag(FLAGS_num_runs);
+  std::vector<absl::Duration> runs;
+  for (int i = 0; i < warmup_runs + num_runs; ++i) {
+    auto frame = std::make_unique<ImageFrame>(
+        ImageFormat::SRGB, image.cols, image.rows,
+        ImageFrame::kDefaultAlignmentBoundary);
+    cv::Mat frame_mat = formats::MatView(frame.get());
+    image.copyTo(frame_mat);
+    const absl::Time start = absl::Now();
+    MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+        kImageStream, Adopt(frame.release()).At(Timestamp(i))));
+    MP_RETURN_IF_ERROR(graph.WaitUntilIdle());
+    if (i >= warmup_runs) {
+      runs.push_back(absl::Now() - start);
+    }
+  }
+  MP_RETURN_IF_ERROR(graph.CloseAllInputStreams());
+  MP_RETURN_IF_ERROR(graph.WaitUntilDone());
+  return runs;
+}
+
+void PrintResult(const std::string& name, std::vector<absl::Duration> runs) {
+  std::sort(runs.begin(), runs.end());
+  absl::Duration total;
+  for (absl::Duration run : runs) total += run;
+  std::cout << absl::StrFormat(
+      "%-18s mean %8.3f ms | p50 %8.3f ms | p90 %8.3f ms | p99 %8.3f ms\n",
+      name,
+      runs.empty() ? 0 : absl::ToDoubleMilliseconds(total) / runs.size(),
+      PercentileMs(runs, 50), PercentileMs(runs, 90), PercentileMs(runs, 99));
+}
+
+absl::Status RunHolisticBenchmark() {
+  RET_CHECK(!absl::GetFlag(FLAGS_image_path).empty())
+      << "--image_path is required.";
+  RET_CHECK_GT(absl::GetFlag(FLAGS_num_runs), 0);
+  cv::Mat image = cv::imread(absl::GetFlag(FLAGS_image_path));
+  RET_CHECK(!image.empty()) << "Can't read " << absl::GetFlag(FLAGS_image_path);
+  cv::cvtColor(image, image, cv::COLOR_BGR2RGB);
+
+  for (bool branch_executors : {false, true}) {
+    ASSIGN_OR_RETURN(std::vector<absl::Duration> runs,
+                     RunBenchmark(branch_executors, image));
+    PrintResult(branch_executors ? "branch executors" : "default executor",
+                std::move(runs));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace mediapipe
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status status = mediapipe::RunHolisticBenchmark();
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to run the benchmark: " << status.message();
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -22,7 +22,6 @@
 #include "absl/status/status.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/logging.h"
-#include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/modules/objectron/calculators/annotation_data.pb.h"
 #include "mediapipe/modules/objectron/calculators/box.h"
@@ -116,40 +115,40 @@ void Decoder::DecodeByVoting(const cv::Mat& heatmap, const cv::Mat& offsetmap,
   int y_min = std::max(0, center_y - config_.voting_radius());
   int width = std::min(heatmap.cols - x_min, config_.voting_radius() * 2 + 1);
   int height = std::min(heatmap.rows - y_min, config_.voting_radius() * 2 + 1);
-  cv::Rect rect(x_min, y_min, width, height);
-  cv::Mat heat = heatmap(rect);
-  cv::Mat offset = offsetmap(rect);
 
-  for (int i = 0; i < kNumOffsetmaps / 2; ++i) {
-    float x_sum = 0.f;
-    float y_sum = 0.f;
-    float votes = 0.f;
-    for (int r = 0; r < heat.rows; ++r) {
-      for (int c = 0; c < heat.cols; ++c) {
-        const float belief = heat.at<float>(r, c);
-        if (belief < config_.voting_threshold()) {
-          continue;
-        }
-        float offset_x =
-            offset.at<cv::Vec<float, kNumOffsetmaps>>(r, c)[2 * i] *
-            offset_scale_x;
-        float offset_y =
-            offset.at<cv::Vec<float, kNumOffsetmaps>>(r, c)[2 * i + 1] *
-            offset_scale_y;
-        float vote_x = c + rect.x + offset_x;
-        float vote_y = r + rect.y + offset_y;
-        float x_diff = std::abs(vote_x - center_votes[2 * i]);
-        float y_diff = std::abs(vote_y - center_votes[2 * i + 1]);
-        if (x_diff > config_.voting_allowance() ||
-            y_diff > config_.voting_allowance()) {
+  // Accumulates the votes of all the vertices in a single pass over the
+  // window. The votes of each vertex are still summed in the row-major pixel
+  // order.
+  const float voting_threshold = config_.voting_threshold();
+  const float voting_allowance = config_.voting_allowance();
+  float x_sums[kNumOffsetmaps / 2] = {};
+  float y_sums[kNumOffsetmaps / 2] = {};
+  float votes[kNumOffsetmaps / 2] = {};
+  for (int y = y_min; y < y_min + height; ++y) {
+    const float* heat_row = heatmap.ptr<float>(y);
+    const float* offset_row = offsetmap.ptr<float>(y);
+    for (int x = x_min; x < x_min + width; ++x) {
+      const float belief = heat_row[x];
+      if (belief < voting_threshold) {
+        continue;
+      }
+      const float* offset = offset_row + x * kNumOffsetmaps;
+      for (int i = 0; i < kNumOffsetmaps / 2; ++i) {
+        const float vote_x = x + offset[2 * i] * offset_scale_x;
+        const float vote_y = y + offset[2 * i + 1] * offset_scale_y;
+        const float x_diff = std::abs(vote_x - center_votes[2 * i]);
+        const float y_diff = std::abs(vote_y - center_votes[2 * i + 1]);
+        if (x_diff > voting_allowance || y_diff > voting_allowance) {
           continue;
         }
-        x_sum += vote_x * belief;
-        y_sum += vote_y * belief;
-        votes += belief;
+        x_sums[i] += vote_x * belief;
+        y_sums[i] += vote_y * belief;
+        votes[i] += belief;
       }
     }
-    box->box_2d.emplace_back(x_sum / votes, y_sum / votes);
+  }
+  for (int i = 0; i < kNumOffsetmaps / 2; ++i) {
+    box->box_2d.emplace_back(x_sums[i] / votes[i], y_sums[i] / votes[i]);
   }
 }
 
@@ -183,56 +182,86 @@ bool Decoder::IsIdentical(const BeliefBox& box_1,
 
 std::vector<cv::Point> Decoder::ExtractCenterKeypoints(
     const cv::Mat& center_heatmap) const {
-  cv::Mat max_filtered_heatmap(center_heatmap.rows, center_heatmap.cols,
-                               center_heatmap.type());
+  // A peak is a pixel above the threshold that is not less than any pixel in
+  // the max pooling window around it, i.e. the same pixels as those equal to
+  // the heatmap dilated with a `kernel_size` square kernel. As only a few
+  // pixels pass the threshold, the window is only scanned for those, instead
+  // of dilating and comparing the whole heatmap.
   const int kernel_size =
       static_cast<int>(config_.local_max_distance() * 2 + 1 + 0.5f);
-  const cv::Size morph_size(kernel_size, kernel_size);
-  cv::dilate(center_heatmap, max_filtered_heatmap,
-             cv::getStructuringElement(cv::MORPH_RECT, morph_size));
-  cv::Mat peak_map;
-  cv::bitwise_and((center_heatmap >= max_filtered_heatmap),
-                  (center_heatmap >= config_.heatmap_threshold()), peak_map);
-  std::vector<cv::Point> locations;  // output, locations of non-zero pixels
-  cv::findNonZero(peak_map, locations);
+  // The window is anchored at the kernel center, as is `cv::dilate()`'s.
+  const int window_begin = -(kernel_size / 2);
+  const int window_end = kernel_size - kernel_size / 2;
+  const float heatmap_threshold = config_.heatmap_threshold();
+
+  std::vector<cv::Point> locations;
+  for (int y = 0; y < center_heatmap.rows; ++y) {
+    const float* row = center_heatmap.ptr<float>(y);
+    for (int x = 0; x < center_heatmap.cols; ++x) {
+      const float value = row[x];
+      if (!(value >= heatmap_threshold)) {
+        continue;
+      }
+      const int x_begin = std::max(0, x + window_begin);
+      const int x_end = std::min(center_heatmap.cols, x + window_end);
+      const int y_end = std::min(center_heatmap.rows, y + window_end);
+      bool is_peak = true;
+      for (int wy = std::max(0, y + window_begin); is_peak && wy < y_end;
+           ++wy) {
+        const float* window_row = center_heatmap.ptr<float>(wy);
+        for (int wx = x_begin; wx < x_end; ++wx) {
+          if (window_row[wx] > value) {
+            is_peak = false;
+            break;
+          }
+        }
+      }
+      if (is_peak) {
+        locations.emplace_back(x, y);
+      }
+    }
+  }
   return locations;
 }
 
 absl::Status Decoder::Lift2DTo3D(
     const Eigen::Matrix<float, 4, 4, Eigen::RowMajor>& projection_matrix,
-    bool portrait, FrameAnnotation* estimated_box) const {
+    bool portrait, FrameAnnotation* estimated_box) {
   CHECK(estimated_box != nullptr);
 
-  for (auto& annotation : *estimated_box->mutable_annotations()) {
+  // Fill input 2D Points of all the boxes.
+  points_2d_.clear();
+  for (const auto& annotation : estimated_box->annotations()) {
     CHECK_EQ(kNumKeypoints, annotation.keypoints_size());
-
-    // Fill input 2D Points;
-    std::vector<Vector2f> input_points_2d;
-    input_points_2d.reserve(kNumKeypoints);
     for (const auto& keypoint : annotation.keypoints()) {
-      input_points_2d.emplace_back(keypoint.point_2d().x(),
-                                   keypoint.point_2d().y());
+      points_2d_.emplace_back(keypoint.point_2d().x(),
+                              keypoint.point_2d().y());
     }
+  }
 
-    // Run EPnP.
-    std::vector<Vector3f> output_points_3d;
-    output_points_3d.reserve(kNumKeypoints);
-    auto status = SolveEpnp(projection_matrix, portrait, input_points_2d,
-                            &output_points_3d);
-    if (!status.ok()) {
-      LOG(ERROR) << status;
-      return status;
-    }
+  // Run EPnP.
+  auto status =
+      SolveEpnpBatch(projection_matrix, portrait, points_2d_, &points_3d_);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+    return status;
+  }
+
+  Box box("category");
+  auto box_points_3d_begin = points_3d_.begin();
+  for (auto& annotation : *estimated_box->mutable_annotations()) {
+    box_points_3d_.assign(box_points_3d_begin,
+                          box_points_3d_begin + kNumKeypoints);
+    box_points_3d_begin += kNumKeypoints;
 
     // Fill 3D keypoints;
     for (int i = 0; i < kNumKeypoints; ++i) {
-      SetPoint3d(output_points_3d[i],
+      SetPoint3d(box_points_3d_[i],
                  annotation.mutable_keypoints(i)->mutable_point_3d());
     }
 
     // Fit a box to the 3D points to get box scale, rotation, translation.
-    Box box("category");
-    box.Fit(output_points_3d);
+    box.Fit(box_points_3d_);
     const Eigen::Matrix<float, 3, 3, Eigen::RowMajor> rotation =
         box.GetRotation();
     const Eigen::Vector3f translation = box.GetTranslation();
@@ -66,9 +66,12 @@ class Decoder {
   // Output:
   //   estimated_box: annotation with point_3d field populated with
   //     3d vertices.
+  //
+  // All the boxes are lifted with a single batched EPnP solve. The point
+  // buffers are kept across calls, so this is not thread-safe.
   absl::Status Lift2DTo3D(
       const Eigen::Matrix<float, 4, 4, Eigen::RowMajor>& projection_matrix,
-      bool portrait, FrameAnnotation* estimated_box) const;
+      bool portrait, FrameAnnotation* estimated_box);
 
  private:
   struct BeliefBox {
@@ -96,6 +99,13 @@ class Decoder {
   // Returns true if the two boxes are identical.
   bool IsIdentical(const BeliefBox& box_1, const BeliefBox& box_2) const;
 
+  // Buffers reused across `Lift2DTo3D()` calls. The 2D and 3D points of all
+  // the boxes are stored consecutively, while `box_points_3d_` holds the 3D
+  // points of a single box.
+  std::vector<Eigen::Vector2f> points_2d_;
+  std::vector<Eigen::Vector3f> points_3d_;
+  std::vector<Eigen::Vector3f> box_points_3d_;
+
   BeliefDecoderConfig config_;
   // Following equation (1) in this paper
   // https://icwww.epfl.ch/~lepetit/papers/lepetit_ijcv08.pdf,
@@ -27,23 +27,14 @@ using Eigen::Matrix4f;
 using Eigen::Vector2f;
 using Eigen::Vector3f;
 
-}  // namespace
-
-absl::Status SolveEpnp(const float focal_x, const float focal_y,
-                       const float center_x, const float center_y,
-                       const bool portrait,
-                       const std::vector<Vector2f>& input_points_2d,
-                       std::vector<Vector3f>* output_points_3d) {
-  if (input_points_2d.size() != kNumKeypoints) {
-    return absl::InvalidArgumentError(
-        absl::StrFormat("Input must has %d 2D points.", kNumKeypoints));
-  }
-
-  if (output_points_3d == nullptr) {
-    return absl::InvalidArgumentError(
-        "Output pointer output_points_3d is Null.");
-  }
-
+// Lifts the `kNumKeypoints` 2D points of a single object starting at
+// `input_points_2d` to the 3D points starting at `output_points_3d`. Uses
+// fixed size matrices only, so it never allocates.
+absl::Status SolveEpnpForObject(const float focal_x, const float focal_y,
+                                const float center_x, const float center_y,
+                                const bool portrait,
+                                const Vector2f* input_points_2d,
+                                Vector3f* output_points_3d) {
   Matrix<float, (kNumKeypoints - 1) * 2, 12> m =
       Matrix<float, (kNumKeypoints - 1) * 2, 12>::Zero();
 
@@ -91,7 +82,7 @@ absl::Status SolveEpnp(const float focal_x, const float focal_y,
                -2.0f,  1.0f,  1.0f,  1.0f;
   // clang-format on
 
-  for (int i = 0; i < input_points_2d.size() - 1; ++i) {
+  for (int i = 0; i < kNumKeypoints - 1; ++i) {
     // Skip 0th landmark which is object center.
     const auto& point_2d = input_points_2d[i + 1];
 
@@ -132,7 +123,7 @@ absl::Status SolveEpnp(const float focal_x, const float focal_y,
   // only! If you use other Eigen Solvers, it's not guaranteed to be in
   // increasing order. Here, we just take the eigen vector corresponding
   // to first/smallest eigen value, since we used SelfAdjointEigenSolver.
-  Eigen::VectorXf eigen_vec = eigen_solver.eigenvectors().col(0);
+  Matrix<float, 12, 1> eigen_vec = eigen_solver.eigenvectors().col(0);
   Map<Matrix<float, 4, 3, Eigen::RowMajor>> control_matrix(eigen_vec.data());
 
   // All 3D points should be in front of camera (z < 0).
@@ -142,16 +133,38 @@ absl::Status SolveEpnp(const float focal_x, const float focal_y,
   Matrix<float, kNumKeypoints - 1, 3> vertices = epnp_alpha * control_matrix;
 
   // Fill 0th 3D points.
-  output_points_3d->emplace_back(control_matrix(0, 0), control_matrix(0, 1),
-                                 control_matrix(0, 2));
+  output_points_3d[0] = control_matrix.row(0).transpose();
   // Fill the rest 3D points.
   for (int i = 0; i < kNumKeypoints - 1; ++i) {
-    output_points_3d->emplace_back(vertices(i, 0), vertices(i, 1),
-                                   vertices(i, 2));
+    output_points_3d[i + 1] = vertices.row(i).transpose();
   }
   return absl::OkStatus();
 }
 
+}  // namespace
+
+absl::Status SolveEpnp(const float focal_x, const float focal_y,
+                       const float center_x, const float center_y,
+                       const bool portrait,
+                       const std::vector<Vector2f>& input_points_2d,
+                       std::vector<Vector3f>* output_points_3d) {
+  if (input_points_2d.size() != kNumKeypoints) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Input must has %d 2D points.", kNumKeypoints));
+  }
+
+  if (output_points_3d == nullptr) {
+    return absl::InvalidArgumentError(
+        "Output pointer output_points_3d is Null.");
+  }
+
+  const int output_offset = output_points_3d->size();
+  output_points_3d->resize(output_offset + kNumKeypoints);
+  return SolveEpnpForObject(focal_x, focal_y, center_x, center_y, portrait,
+                            input_points_2d.data(),
+                            output_points_3d->data() + output_offset);
+}
+
 absl::Status SolveEpnp(const Eigen::Matrix4f& projection_matrix,
                        const bool portrait,
                        const std::vector<Vector2f>& input_points_2d,
@@ -164,4 +177,34 @@ absl::Status SolveEpnp(const Eigen::Matrix4f& projection_matrix,
                    input_points_2d, output_points_3d);
 }
 
+absl::Status SolveEpnpBatch(const Eigen::Matrix4f& projection_matrix,
+                            const bool portrait,
+                            const std::vector<Vector2f>& input_points_2d,
+                            std::vector<Vector3f>* output_points_3d) {
+  if (input_points_2d.size() % kNumKeypoints != 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Input must has a multiple of %d 2D points.", kNumKeypoints));
+  }
+
+  if (output_points_3d == nullptr) {
+    return absl::InvalidArgumentError(
+        "Output pointer output_points_3d is Null.");
+  }
+
+  const float focal_x = projection_matrix(0, 0);
+  const float focal_y = projection_matrix(1, 1);
+  const float center_x = projection_matrix(0, 2);
+  const float center_y = projection_matrix(1, 2);
+  output_points_3d->resize(input_points_2d.size());
+  for (int i = 0; i < input_points_2d.size(); i += kNumKeypoints) {
+    auto status = SolveEpnpForObject(focal_x, focal_y, center_x, center_y,
+                                     portrait, input_points_2d.data() + i,
+                                     output_points_3d->data() + i);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace mediapipe
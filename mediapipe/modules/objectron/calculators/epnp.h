@@ -57,6 +57,24 @@ absl::Status SolveEpnp(const Eigen::Matrix4f& projection_matrix,
                        const std::vector<Eigen::Vector2f>& input_points_2d,
                        std::vector<Eigen::Vector3f>* output_points_3d);
 
+// This function performs EPnP algorithm for a batch of objects at once, lifting
+// normalized 2D points in pixel space to 3D points in camera coordinate.
+//
+// Inputs:
+//   projection_matrix: the projection matrix from 3D coordinate
+//     to screen coordinate.
+//   portrait: a boolen variable indicating whether our images are obtained in
+//     portrait orientation or not.
+//   input_points_2d: input 2D points to be lifted to 3D, 9 consecutive points
+//     per object.
+//   output_points_3d: ouput 3D points in camera coordinate, 9 consecutive
+//     points per object in the same order as the input objects. Resized to
+//     match `input_points_2d`, so its storage can be reused across calls.
+absl::Status SolveEpnpBatch(const Eigen::Matrix4f& projection_matrix,
+                            const bool portrait,
+                            const std::vector<Eigen::Vector2f>& input_points_2d,
+                            std::vector<Eigen::Vector3f>* output_points_3d);
+
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_MODULES_OBJECTRON_CALCULATORS_EPNP_H_
@@ -146,6 +146,42 @@ TEST_F(SolveEpnpTest, SolveEpnpProjectionMatrix) {
   VerifyOutput3dPoints(output_3d_points);
 }
 
+TEST_F(SolveEpnpTest, SolveEpnpBatch) {
+  Matrix4f projection_matrix;
+  // clang-format off
+  projection_matrix << kFocalX,    0.0f, kCenterX, 0.0f,
+                          0.0f, kFocalY, kCenterY, 0.0f,
+                          0.0f,    0.0f,    -1.0f, 0.0f,
+                          0.0f,    0.0f,    -1.0f, 0.0f;
+  // clang-format on
+
+  // Lift two objects at once.
+  std::vector<Vector2f> input_2d_points = input_2d_points_;
+  input_2d_points.insert(input_2d_points.end(), input_2d_points_.begin(),
+                         input_2d_points_.end());
+  std::vector<Vector3f> output_3d_points;
+  MP_ASSERT_OK(SolveEpnpBatch(projection_matrix, /*portrait*/ false,
+                              input_2d_points, &output_3d_points));
+
+  // Test output 3D points of each object.
+  ASSERT_EQ(2 * kNumKeypoints, output_3d_points.size());
+  VerifyOutput3dPoints({output_3d_points.begin(),
+                        output_3d_points.begin() + kNumKeypoints});
+  VerifyOutput3dPoints(
+      {output_3d_points.begin() + kNumKeypoints, output_3d_points.end()});
+}
+
+TEST_F(SolveEpnpTest, BadBatchInput2dPoints) {
+  // Generate input 2D points for an incomplete second object.
+  std::vector<Vector2f> input_2d_points = input_2d_points_;
+  input_2d_points.push_back(input_2d_points_[0]);
+  std::vector<Vector3f> output_3d_points;
+  EXPECT_THAT(SolveEpnpBatch(Matrix4f::Identity(), /*portrait*/ false,
+                             input_2d_points, &output_3d_points),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Input must has a multiple of")));
+}
+
 TEST_F(SolveEpnpTest, BadInput2dPoints) {
   // Generate empty input 2D points.
   std::vector<Vector2f> input_2d_points;
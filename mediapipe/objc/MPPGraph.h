@@ -172,7 +172,9 @@ typedef NS_ENUM(int, MPPPacketType) {
 /// type. The graph must have been started before calling this. Drops frames and
 /// returns NO if maxFramesInFlight is exceeded. If allowOverwrite is set to YES,
 /// allows MediaPipe to overwrite the packet contents on successful sending for
-/// possibly increased efficiency. Returns YES if the packet was successfully sent.
+/// possibly increased efficiency. For CPU packet types this includes converting
+/// the pixel buffer in place, so the packet references it without a copy.
+/// Returns YES if the packet was successfully sent.
 - (BOOL)sendPixelBuffer:(CVPixelBufferRef)imageBuffer
              intoStream:(const std::string &)inputName
              packetType:(MPPPacketType)packetType
@@ -18,8 +18,11 @@
 #import <Accelerate/Accelerate.h>
 
 #include <atomic>
+#include <map>
+#include <utility>
 
 #include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/formats/image_frame.h"
@@ -27,6 +30,8 @@
 #include "mediapipe/gpu/MPPGraphGPUData.h"
 #include "mediapipe/gpu/gl_base.h"
 #include "mediapipe/gpu/gpu_shared_data_internal.h"
+#include "mediapipe/gpu/pixel_buffer_pool_util.h"
+#include "mediapipe/objc/CFHolder.h"
 #include "mediapipe/objc/util.h"
 
 #import "mediapipe/objc/NSError+util_status.h"
@@ -55,6 +60,12 @@
 
   // Tracks whether the graph has been started and is currently running.
   BOOL _started;
+
+  /// Pools for the BGRA pixel buffers handed out for CPU output frames, keyed
+  /// by frame size.
+  absl::Mutex _outputPixelBufferPoolsMutex;
+  std::map<std::pair<int, int>, CFHolder<CVPixelBufferPoolRef>> _outputPixelBufferPools
+      ABSL_GUARDED_BY(_outputPixelBufferPoolsMutex);
 }
 
 - (instancetype)initWithGraphConfig:(const mediapipe::CalculatorGraphConfig&)config {
@@ -101,6 +112,31 @@
                                     _framesInFlight.load(std::memory_order_relaxed)];
 }
 
+/// Number of buffers kept around by each output pixel buffer pool.
+static const int kOutputPixelBufferPoolKeepCount = 2;
+/// Unused output pixel buffers are released after this many seconds.
+static const CFTimeInterval kOutputPixelBufferPoolMaxAge = 1.0;
+
+/// Creates a BGRA pixel buffer for a CPU output frame. Buffers are recycled through a
+/// CVPixelBufferPool per frame size instead of being allocated for every frame.
+- (CVReturn)createOutputPixelBuffer:(CVPixelBufferRef*)outBuffer
+                              width:(int)width
+                             height:(int)height {
+  CVPixelBufferPoolRef pool;
+  {
+    absl::MutexLock lock(&_outputPixelBufferPoolsMutex);
+    CFHolder<CVPixelBufferPoolRef>& holder = _outputPixelBufferPools[{width, height}];
+    if (!*holder) {
+      holder.adopt(mediapipe::CreateCVPixelBufferPool(width, height, kCVPixelFormatType_32BGRA,
+                                                      kOutputPixelBufferPoolKeepCount,
+                                                      kOutputPixelBufferPoolMaxAge));
+    }
+    pool = *holder;
+  }
+  if (!pool) return kCVReturnAllocationFailed;
+  return mediapipe::CreateCVPixelBufferWithPool(pool, /*auxAttributes=*/nil, [] {}, outBuffer);
+}
+
 /// This is the function that gets called by the CallbackCalculator that
 /// receives the graph's output.
 void CallFrameDelegate(void* wrapperVoid, const std::string& streamName,
@@ -119,11 +155,10 @@ void CallFrameDelegate(void* wrapperVoid, const std::string& streamName,
       if (format == mediapipe::ImageFormat::SRGBA ||
           format == mediapipe::ImageFormat::GRAY8) {
         CVPixelBufferRef pixelBuffer;
-        // If kCVPixelFormatType_32RGBA does not work, it returns kCVReturnInvalidPixelFormat.
-        CVReturn error = CVPixelBufferCreate(
-            NULL, frame.Width(), frame.Height(), kCVPixelFormatType_32BGRA,
-            GetCVPixelBufferAttributesForGlCompatibility(), &pixelBuffer);
-        _GTMDevAssert(error == kCVReturnSuccess, @"CVPixelBufferCreate failed: %d", error);
+        CVReturn error = [wrapper createOutputPixelBuffer:&pixelBuffer
+                                                    width:frame.Width()
+                                                   height:frame.Height()];
+        _GTMDevAssert(error == kCVReturnSuccess, @"Failed to create output pixel buffer: %d", error);
         error = CVPixelBufferLockBaseAddress(pixelBuffer, 0);
         _GTMDevAssert(error == kCVReturnSuccess, @"CVPixelBufferLockBaseAddress failed: %d", error);
 
@@ -312,10 +347,18 @@ if ([wrapper.delegate
 
 - (mediapipe::Packet)packetWithPixelBuffer:(CVPixelBufferRef)imageBuffer
                               packetType:(MPPPacketType)packetType {
+  return [self packetWithPixelBuffer:imageBuffer packetType:packetType allowOverwrite:NO];
+}
+
+/// If allowOverwrite is YES, CPU packets convert the pixel buffer in place when needed, so
+/// that the ImageFrame always references the locked pixel buffer instead of a copy.
+- (mediapipe::Packet)packetWithPixelBuffer:(CVPixelBufferRef)imageBuffer
+                              packetType:(MPPPacketType)packetType
+                          allowOverwrite:(BOOL)allowOverwrite {
   mediapipe::Packet packet;
   if (packetType == MPPPacketTypeImageFrame || packetType == MPPPacketTypeImageFrameBGRANoSwap) {
     auto frame = CreateImageFrameForCVPixelBuffer(
-        imageBuffer, /* canOverwrite = */ false,
+        imageBuffer, /* canOverwrite = */ allowOverwrite,
         /* bgrAsRgb = */ packetType == MPPPacketTypeImageFrameBGRANoSwap);
     packet = mediapipe::Adopt(frame.release());
 #if MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
@@ -328,7 +371,8 @@ if ([wrapper.delegate
     packet = mediapipe::MakePacket<mediapipe::Image>(imageBuffer);
 #else
     // CPU
-    auto frame = CreateImageFrameForCVPixelBuffer(imageBuffer, /* canOverwrite = */ false,
+    auto frame = CreateImageFrameForCVPixelBuffer(imageBuffer,
+                                                  /* canOverwrite = */ allowOverwrite,
                                                   /* bgrAsRgb = */ false);
     packet = mediapipe::MakePacket<mediapipe::Image>(std::move(frame));
 #endif  // MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
@@ -367,7 +411,9 @@ if ([wrapper.delegate
          allowOverwrite:(BOOL)allowOverwrite
                   error:(NSError**)error {
   if (_maxFramesInFlight && _framesInFlight >= _maxFramesInFlight) return NO;
-  mediapipe::Packet packet = [self packetWithPixelBuffer:imageBuffer packetType:packetType];
+  mediapipe::Packet packet = [self packetWithPixelBuffer:imageBuffer
+                                              packetType:packetType
+                                          allowOverwrite:allowOverwrite];
   BOOL success;
   if (allowOverwrite) {
     packet = std::move(packet).At(timestamp);
@@ -561,8 +561,11 @@ std::unique_ptr<mediapipe::ImageFrame> CreateImageFrameForCVPixelBuffer(
 
 std::unique_ptr<mediapipe::ImageFrame> CreateImageFrameForCVPixelBuffer(
     CVPixelBufferRef image_buffer, bool can_overwrite, bool bgr_as_rgb) {
-  CVReturn status =
-      CVPixelBufferLockBaseAddress(image_buffer, kCVPixelBufferLock_ReadOnly);
+  // The channel swap below writes into the buffer itself when can_overwrite is
+  // set, which requires a writable lock.
+  const CVPixelBufferLockFlags lock_flags =
+      can_overwrite ? 0 : kCVPixelBufferLock_ReadOnly;
+  CVReturn status = CVPixelBufferLockBaseAddress(image_buffer, lock_flags);
   CHECK_EQ(status, kCVReturnSuccess)
       << "CVPixelBufferLockBaseAddress failed: " << status;
 
@@ -621,17 +624,16 @@ std::unique_ptr<mediapipe::ImageFrame> CreateImageFrameForCVPixelBuffer(
 
   if (frame) {
     // We have already created a new frame that does not reference the buffer.
-    status = CVPixelBufferUnlockBaseAddress(image_buffer,
-                                            kCVPixelBufferLock_ReadOnly);
+    status = CVPixelBufferUnlockBaseAddress(image_buffer, lock_flags);
     CHECK_EQ(status, kCVReturnSuccess)
         << "CVPixelBufferUnlockBaseAddress failed: " << status;
     CVPixelBufferRelease(image_buffer);
   } else {
     frame = absl::make_unique<mediapipe::ImageFrame>(
         image_format, width, height, bytes_per_row,
-        reinterpret_cast<uint8*>(base_address), [image_buffer](uint8* x) {
-          CVPixelBufferUnlockBaseAddress(image_buffer,
-                                         kCVPixelBufferLock_ReadOnly);
+        reinterpret_cast<uint8*>(base_address),
+        [image_buffer, lock_flags](uint8* x) {
+          CVPixelBufferUnlockBaseAddress(image_buffer, lock_flags);
           CVPixelBufferRelease(image_buffer);
         });
   }
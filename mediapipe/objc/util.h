@@ -106,7 +106,7 @@ CVPixelBufferRef CreateCVPixelBufferForImageFramePacket(
 /// For formats which are not supported by both image types, it may be
 /// necessary to convert the data. This is done by creating a new buffer.
 /// If the optional can_overwrite parameter is true, the old buffer may be
-/// modified instead.
+/// modified instead, and the ImageFrame still references it without a copy.
 ///
 /// ImageFrame does not have a format for BGRA data, so we normally swap the
 /// channels to produce RGBA. But many graphs do not care about the order of
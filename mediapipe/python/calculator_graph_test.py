@@ -246,6 +246,112 @@ class GraphTest(absltest.TestCase):
       self.assertEqual(out[i].timestamp, i)
       self.assertEqual(packet_getter.get_str(out[i]), 'hello world')
 
+  def test_batched_input(self):
+    text_config = """
+      input_stream: 'in_a'
+      input_stream: 'in_b'
+      output_stream: 'out_a'
+      output_stream: 'out_b'
+      node {
+        calculator: 'PassThroughCalculator'
+        input_stream: 'in_a'
+        input_stream: 'in_b'
+        output_stream: 'out_a'
+        output_stream: 'out_b'
+      }
+    """
+    out_a = []
+    out_b = []
+    graph = CalculatorGraph(graph_config=text_config)
+    graph.observe_output_stream('out_a', lambda _, packet: out_a.append(packet))
+    graph.observe_output_stream('out_b', lambda _, packet: out_b.append(packet))
+    graph.start_run()
+    graph.add_packets_to_input_streams([
+        ('in_a', packet_creator.create_int(0).at(0)),
+        ('in_b', packet_creator.create_int(10).at(0)),
+        ('in_a', packet_creator.create_int(1).at(1)),
+    ])
+    graph.add_packets_to_input_stream(
+        stream='in_b',
+        packets=[packet_creator.create_int(11).at(1)])
+    graph.close_all_packet_sources()
+    graph.wait_until_done()
+    self.assertEqual([packet_getter.get_int(p) for p in out_a], [0, 1])
+    self.assertEqual([packet_getter.get_int(p) for p in out_b], [10, 11])
+
+  def test_batched_input_to_unknown_stream(self):
+    graph = CalculatorGraph(graph_config="""
+      input_stream: 'in'
+      node {
+        calculator: 'PassThroughCalculator'
+        input_stream: 'in'
+        output_stream: 'out'
+      }
+    """)
+    graph.start_run()
+    with self.assertRaisesRegex(RuntimeError, 'not a graph input stream'):
+      graph.add_packets_to_input_streams([
+          ('in', packet_creator.create_int(0).at(0)),
+          ('unknown', packet_creator.create_int(0).at(0)),
+      ])
+    graph.close_all_packet_sources()
+    graph.wait_until_done()
+
+
+  def test_observe_output_stream_batches(self):
+    graph = CalculatorGraph(graph_config="""
+      input_stream: 'in'
+      output_stream: 'out'
+      node {
+        calculator: 'PassThroughCalculator'
+        input_stream: 'in'
+        output_stream: 'out'
+      }
+    """)
+    batches = []
+    graph.observe_output_stream_batches(
+        'out', lambda _, packets: batches.append(packets))
+    graph.start_run()
+    graph.add_packets_to_input_stream(
+        stream='in',
+        packets=[packet_creator.create_int(i).at(i) for i in range(10)])
+    graph.close()
+    self.assertFalse(graph.has_error())
+    self.assertNotEmpty(batches)
+    self.assertEqual(
+        [packet_getter.get_int(p) for batch in batches for p in batch],
+        list(range(10)))
+
+  def test_output_stream_poller(self):
+    graph = CalculatorGraph(graph_config="""
+      input_stream: 'in'
+      output_stream: 'out'
+      node {
+        calculator: 'PassThroughCalculator'
+        input_stream: 'in'
+        output_stream: 'out'
+      }
+    """)
+    poller = graph.add_output_stream_poller('out')
+    graph.start_run()
+    graph.add_packets_to_input_stream(
+        stream='in',
+        packets=[packet_creator.create_int(i).at(i) for i in range(10)])
+    graph.close_all_packet_sources()
+    first = poller.next()
+    self.assertEqual(packet_getter.get_int(first), 0)
+    out = [first]
+    while True:
+      packets = poller.next_batch(max_packets=4)
+      if packets is None:
+        break
+      self.assertLessEqual(len(packets), 4)
+      out.extend(packets)
+    graph.wait_until_done()
+    self.assertIsNone(poller.next())
+    self.assertEqual([packet_getter.get_int(p) for p in out], list(range(10)))
+    self.assertEqual([p.timestamp.value for p in out], list(range(10)))
+
 
 if __name__ == '__main__':
   absltest.main()
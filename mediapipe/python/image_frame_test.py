@@ -190,5 +190,49 @@ class ImageFrameTest(absltest.TestCase):
     self.assertEqual(sys.getrefcount(rgb_image_frame), initial_ref_count)
 
 
+  def test_image_frame_reference_mode(self):
+    w, h = 641, 481
+    mat = np.random.randint(2**8 - 1, size=(h, w, 3), dtype=np.uint8)
+    mat.flags.writeable = False
+    initial_ref_count = sys.getrefcount(mat)
+    rgb_image_frame = ImageFrame(
+        image_format=ImageFormat.SRGB, data=mat, copy=False)
+    # Reference mode increases the ref count of mat by 1.
+    self.assertEqual(sys.getrefcount(mat), initial_ref_count + 1)
+    self.assertTrue(rgb_image_frame.is_contiguous())
+    self.assertTrue(np.array_equal(mat, rgb_image_frame.numpy_view()))
+    del rgb_image_frame
+    gc.collect()
+    self.assertEqual(sys.getrefcount(mat), initial_ref_count)
+
+  def test_image_frame_reference_mode_warns_on_writeable_data(self):
+    mat = np.random.randint(2**8 - 1, size=(48, 64), dtype=np.uint8)
+    with self.assertWarnsRegex(RuntimeWarning, 'still writeable'):
+      ImageFrame(image_format=ImageFormat.GRAY8, data=mat, copy=False)
+
+  # The buffer protocol exports the pixel data with the row stride of the
+  # image_frame, so padded rows are exported without realignment and copy.
+  def test_image_frame_buffer_protocol(self):
+    w, h = 641, 481
+    mat = np.random.randint(2**8 - 1, size=(h, w, 3), dtype=np.uint8)
+    rgb_image_frame = ImageFrame(image_format=ImageFormat.SRGB, data=mat)
+    self.assertFalse(rgb_image_frame.is_contiguous())
+    initial_ref_count = sys.getrefcount(rgb_image_frame)
+    np_view = np.asarray(rgb_image_frame)
+    self.assertEqual(sys.getrefcount(rgb_image_frame), initial_ref_count + 1)
+    self.assertTrue(np.array_equal(mat, np_view))
+    self.assertFalse(np_view.flags.writeable)
+    self.assertFalse(np_view.flags.c_contiguous)
+    self.assertEqual(np_view.strides[1:], (3, 1))
+    del np_view
+    gc.collect()
+    self.assertEqual(sys.getrefcount(rgb_image_frame), initial_ref_count)
+    float_image_frame = ImageFrame(
+        image_format=ImageFormat.VEC32F1,
+        data=np.ones((4, 5), dtype=np.float32))
+    self.assertTrue(
+        np.array_equal(np.asarray(float_image_frame), np.ones((4, 5))))
+
+
 if __name__ == '__main__':
   absltest.main()
@@ -18,6 +18,7 @@
 #include "absl/strings/str_cat.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_graph.h"
+#include "mediapipe/framework/output_stream_poller.h"
 #include "mediapipe/framework/packet.h"
 #include "mediapipe/framework/port/map_util.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
@@ -70,6 +71,86 @@ void CalculatorGraphSubmodule(pybind11::module* module) {
   data flow can branch and merge. Generally data flows forward, but backward
   loops are possible.)doc");
 
+  // Output Stream Poller
+  py::class_<OutputStreamPoller> output_stream_poller(
+      m, "OutputStreamPoller",
+      R"doc(A synchronous, polling API for accessing a graph output stream.
+
+  Created by CalculatorGraph.add_output_stream_poller(). All the blocking
+  methods release the GIL while waiting.)doc");
+
+  output_stream_poller
+      .def(
+          "next",
+          [](OutputStreamPoller* self) -> py::object {
+            Packet packet;
+            bool ok;
+            {
+              py::gil_scoped_release gil_release;
+              ok = self->Next(&packet);
+            }
+            return ok ? py::cast(std::move(packet)) : py::none();
+          },
+          R"doc(Get the next packet.
+
+  Blocks until a packet is available or the stream is done.
+
+  Returns:
+    The next packet, or None if the stream is done or the graph has an error.
+)doc")
+      .def(
+          "next_batch",
+          [](OutputStreamPoller* self, size_t max_packets) -> py::object {
+            std::vector<Packet> packets;
+            bool ok;
+            {
+              py::gil_scoped_release gil_release;
+              ok = self->NextBatch(&packets, max_packets);
+            }
+            return ok ? py::cast(std::move(packets)) : py::none();
+          },
+          R"doc(Get up to max_packets available packets.
+
+  Blocks until at least one packet is available or the stream is done. Drains
+  a backlog at a much lower cost per packet than repeated next() calls.
+
+  Args:
+    max_packets: The maximum number of packets to return.
+
+  Returns:
+    A list of packets in timestamp order, or None if the stream is done or the
+    graph has an error.
+)doc",
+          py::arg("max_packets") = 64)
+      .def(
+          "try_next_batch",
+          [](OutputStreamPoller* self, size_t max_packets) -> py::object {
+            std::vector<Packet> packets;
+            if (!self->TryNextBatch(&packets, max_packets)) {
+              return py::none();
+            }
+            return py::cast(std::move(packets));
+          },
+          R"doc(Get up to max_packets packets that are already available.
+
+  Doesn't block.
+
+  Args:
+    max_packets: The maximum number of packets to return.
+
+  Returns:
+    A possibly empty list of packets in timestamp order, or None if the stream
+    is done or the graph has an error.
+)doc",
+          py::arg("max_packets") = 64)
+      .def("queue_size", &OutputStreamPoller::QueueSize,
+           R"doc(Return the number of packets in the queue.)doc")
+      .def("set_max_queue_size", &OutputStreamPoller::SetMaxQueueSize,
+           R"doc(Set the maximum queue size, which throttles the graph.)doc",
+           py::arg("queue_size"))
+      .def("reset", &OutputStreamPoller::Reset,
+           R"doc(Reset the poller and clear the packet queue.)doc");
+
   // TODO: Support graph initialization with graph templates and
   // subgraph.
   calculator_graph.def(
@@ -207,6 +288,91 @@ void CalculatorGraphSubmodule(pybind11::module* module) {
       py::arg("stream"), py::arg("packet"),
       py::arg("timestamp") = Timestamp::Unset());
 
+  calculator_graph.def(
+      "add_packets_to_input_streams",
+      [](CalculatorGraph* self,
+         const std::vector<std::pair<std::string, Packet>>& packets) {
+        for (const auto& stream_and_packet : packets) {
+          if (!stream_and_packet.second.Timestamp().IsAllowedInStream()) {
+            throw RaisePyError(
+                PyExc_ValueError,
+                absl::StrCat(stream_and_packet.second.Timestamp().DebugString(),
+                             " can't be the timestamp of a Packet in a stream.")
+                    .c_str());
+          }
+        }
+        py::gil_scoped_release gil_release;
+        RaisePyErrorIfNotOk(self->AddPacketsToInputStreams(packets),
+                            /**acquire_gil=*/true);
+      },
+      R"doc(Add a batch of packets to one or more graph input streams.
+
+  Compared to calling add_packet_to_input_stream() for each packet, the
+  throttling check is done once for all the affected streams, and the packets
+  of each stream are delivered to the graph together. The packets of each
+  stream must be in increasing timestamp order. If any affected stream is
+  throttled in the ADD_IF_NOT_FULL mode, no packet is added.
+
+  Args:
+    packets: A list of (stream name, packet) tuples. Every packet must have a
+      timestamp.
+
+  Raises:
+    RuntimeError: If a stream is not a graph input stream or the packets can't
+      be added into the input streams due to the limited queue size or the
+      wrong packet type.
+    ValueError: If the timestamp of a Packet is invalid to be the timestamp of
+      a Packet in a stream.
+
+  Examples:
+    graph.add_packets_to_input_streams([
+        ('audio', packet_creator.create_float(0.5).at(0)),
+        ('audio', packet_creator.create_float(0.7).at(1)),
+        ('sensor', packet_creator.create_int(3).at(1)),
+    ])
+)doc",
+      py::arg("packets"));
+
+  calculator_graph.def(
+      "add_packets_to_input_stream",
+      [](CalculatorGraph* self, const std::string& stream,
+         const std::vector<Packet>& packets) {
+        for (const Packet& packet : packets) {
+          if (!packet.Timestamp().IsAllowedInStream()) {
+            throw RaisePyError(
+                PyExc_ValueError,
+                absl::StrCat(packet.Timestamp().DebugString(),
+                             " can't be the timestamp of a Packet in a stream.")
+                    .c_str());
+          }
+        }
+        py::gil_scoped_release gil_release;
+        RaisePyErrorIfNotOk(self->AddPacketsToInputStream(stream, packets),
+                            /**acquire_gil=*/true);
+      },
+      R"doc(Add a batch of packets to a graph input stream.
+
+  Same as add_packets_to_input_streams(), for packets of a single stream.
+
+  Args:
+    stream: The name of the graph input stream.
+    packets: A list of packets in increasing timestamp order. Every packet must
+      have a timestamp.
+
+  Raises:
+    RuntimeError: If the stream is not a graph input stream or the packets
+      can't be added into the input stream due to the limited queue size or the
+      wrong packet type.
+    ValueError: If the timestamp of a Packet is invalid to be the timestamp of
+      a Packet in a stream.
+
+  Examples:
+    graph.add_packets_to_input_stream(
+        stream='in',
+        packets=[packet_creator.create_int(i).at(i) for i in range(10)])
+)doc",
+      py::arg("stream"), py::arg("packets"));
+
   calculator_graph.def(
       "close_input_stream",
       [](CalculatorGraph* self, const std::string& stream) {
@@ -442,6 +608,89 @@ void CalculatorGraphSubmodule(pybind11::module* module) {
       py::arg("stream_name"), py::arg("callback_fn"),
       py::arg("observe_timestamp_bounds") = false);
 
+  calculator_graph.def(
+      "observe_output_stream_batches",
+      [](CalculatorGraph* self, const std::string& stream_name,
+         pybind11::function callback_fn, bool observe_timestamp_bounds) {
+        RaisePyErrorIfNotOk(self->ObserveOutputStreamBatches(
+            stream_name,
+            [callback_fn, stream_name](const std::vector<Packet>& packets) {
+              absl::MutexLock lock(&callback_mutex);
+              // Acquires GIL once per batch before calling Python callback.
+              py::gil_scoped_acquire gil_acquire;
+              callback_fn(stream_name, packets);
+              return absl::OkStatus();
+            },
+            observe_timestamp_bounds));
+      },
+      R"doc(Observe the named output stream in batches.
+
+  Like observe_output_stream(), but callback_fn receives a list of all the
+  packets that are available when the stream is notified, in timestamp order,
+  instead of one call per packet. When the graph produces packets faster than
+  Python consumes them, this acquires the GIL once per batch instead of once
+  per packet. This method can only be called before start_run().
+
+  Args:
+    stream_name: The name of the output stream.
+    callback_fn: The callback function to invoke on every batch of packets
+      emitted by the output stream.
+    observe_timestamp_bounds: If true, emits an empty packet at
+      timestamp_bound -1 when timestamp bound changes.
+
+  Raises:
+    RuntimeError: If the calculator graph isn't initialized or the stream
+      doesn't exist.
+
+  Examples:
+    out = []
+    graph = mp.CalculatorGraph(graph_config=graph_config)
+    graph.observe_output_stream_batches(
+        'out', lambda stream_name, packets: out.extend(packets))
+
+)doc",
+      py::arg("stream_name"), py::arg("callback_fn"),
+      py::arg("observe_timestamp_bounds") = false);
+
+  calculator_graph.def(
+      "add_output_stream_poller",
+      [](CalculatorGraph* self, const std::string& stream_name,
+         bool observe_timestamp_bounds) {
+        auto status_or_poller =
+            self->AddOutputStreamPoller(stream_name, observe_timestamp_bounds);
+        RaisePyErrorIfNotOk(status_or_poller.status());
+        return std::move(status_or_poller).value();
+      },
+      R"doc(Add an output stream poller for the named output stream.
+
+  Packets are queued on the C++ side and never call into Python from the graph
+  threads. The poller releases the GIL while it waits for packets. This method
+  can only be called before start_run().
+
+  Args:
+    stream_name: The name of the output stream.
+    observe_timestamp_bounds: If true, emits an empty packet at
+      timestamp_bound -1 when timestamp bound changes.
+
+  Returns:
+    An OutputStreamPoller object.
+
+  Raises:
+    RuntimeError: If the calculator graph isn't initialized or the stream
+      doesn't exist.
+
+  Examples:
+    graph = mp.CalculatorGraph(graph_config=graph_config)
+    poller = graph.add_output_stream_poller('out')
+    graph.start_run()
+    ...
+    while (packets := poller.next_batch()) is not None:
+      process(packets)
+
+)doc",
+      py::arg("stream_name"), py::arg("observe_timestamp_bounds") = false,
+      py::return_value_policy::move, py::keep_alive<0, 1>());
+
   calculator_graph.def(
       "close",
       [](CalculatorGraph* self) {
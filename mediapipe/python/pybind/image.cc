@@ -47,6 +47,10 @@ void ImageSubmodule(pybind11::module* module) {
   default alignment boundary during creation. The data in an Image will
   become immutable after creation.
 
+  With `copy=False`, the Image takes a reference of the numpy ndarray instead
+  of copying its data. The ndarray must not be modified afterwards. Pass an
+  unwritable ndarray to avoid a RuntimeWarning.
+
   Creation examples:
     import cv2
     cv_mat = cv2.imread(input_file)[:, :, ::-1]
@@ -64,6 +68,10 @@ void ImageSubmodule(pybind11::module* module) {
   internal data and itself is unwritable. If the callers want to modify the
   numpy ndarray, it's required to obtain a copy of it.
 
+  Image also supports the buffer protocol. `np.asarray(image)` and
+  `memoryview(image)` return an unwritable reference to the internal data
+  without copying, even if the rows are padded for alignment.
+
   Pixel data retrieval examples:
     for channel in range(num_channel):
       for col in range(width):
@@ -74,13 +82,21 @@ void ImageSubmodule(pybind11::module* module) {
     print(output_ndarray[0, 0, 0])
     copied_ndarray = np.copy(output_ndarray)
     copied_ndarray[0,0,0] = 0
+
+  Zero-copy examples:
+    frame = np.ascontiguousarray(cv_mat)
+    frame.flags.writeable = False
+    image = mp.Image(
+        image_format=mp.ImageFormat.SRGB, data=frame, copy=False)
+    strided_ndarray = np.asarray(image)
   )doc",
-      py::dynamic_attr());
+      py::buffer_protocol(), py::dynamic_attr());
 
   image
       .def(
           py::init([](mediapipe::ImageFormat::Format format,
-                      const py::array_t<uint8, py::array::c_style>& data) {
+                      const py::array_t<uint8, py::array::c_style>& data,
+                      bool copy) {
             if (format != mediapipe::ImageFormat::GRAY8 &&
                 format != mediapipe::ImageFormat::SRGB &&
                 format != mediapipe::ImageFormat::SRGBA) {
@@ -89,13 +105,15 @@ void ImageSubmodule(pybind11::module* module) {
                                  "SRGB, and SRGBA MediaPipe image formats.");
             }
             return Image(std::shared_ptr<ImageFrame>(
-                CreateImageFrame<uint8>(format, data)));
+                CreateImageFrameWithCopyOption<uint8>(format, data, copy)));
           }),
           R"doc(For uint8 data type, valid ImageFormat are GRAY8, SGRB, and SRGBA.)doc",
-          py::arg("image_format"), py::arg("data").noconvert())
+          py::arg("image_format"), py::arg("data").noconvert(),
+          py::arg("copy") = true)
       .def(
           py::init([](mediapipe::ImageFormat::Format format,
-                      const py::array_t<uint16, py::array::c_style>& data) {
+                      const py::array_t<uint16, py::array::c_style>& data,
+                      bool copy) {
             if (format != mediapipe::ImageFormat::GRAY16 &&
                 format != mediapipe::ImageFormat::SRGB48 &&
                 format != mediapipe::ImageFormat::SRGBA64) {
@@ -105,13 +123,15 @@ void ImageSubmodule(pybind11::module* module) {
                   "SRGB48, and SRGBA64 MediaPipe image formats.");
             }
             return Image(std::shared_ptr<ImageFrame>(
-                CreateImageFrame<uint16>(format, data)));
+                CreateImageFrameWithCopyOption<uint16>(format, data, copy)));
           }),
           R"doc(For uint16 data type, valid ImageFormat are GRAY16, SRGB48, and SRGBA64.)doc",
-          py::arg("image_format"), py::arg("data").noconvert())
+          py::arg("image_format"), py::arg("data").noconvert(),
+          py::arg("copy") = true)
       .def(
           py::init([](mediapipe::ImageFormat::Format format,
-                      const py::array_t<float, py::array::c_style>& data) {
+                      const py::array_t<float, py::array::c_style>& data,
+                      bool copy) {
             if (format != mediapipe::ImageFormat::VEC32F1 &&
                 format != mediapipe::ImageFormat::VEC32F2) {
               throw RaisePyError(
@@ -120,10 +140,11 @@ void ImageSubmodule(pybind11::module* module) {
                   "MediaPipe image formats.");
             }
             return Image(std::shared_ptr<ImageFrame>(
-                CreateImageFrame<float>(format, data)));
+                CreateImageFrameWithCopyOption<float>(format, data, copy)));
           }),
           R"doc(For float data type, valid ImageFormat are VEC32F1 and VEC32F2.)doc",
-          py::arg("image_format"), py::arg("data").noconvert());
+          py::arg("image_format"), py::arg("data").noconvert(),
+          py::arg("copy") = true);
 
   image.def(
       "numpy_view",
@@ -161,6 +182,10 @@ void ImageSubmodule(pybind11::module* module) {
     copied_ndarray[0,0,0] = 0
 )doc");
 
+  image.def_buffer([](Image& self) {
+    return ImageFrameBufferInfo(*self.GetImageFrameSharedPtr());
+  });
+
   image.def(
       "__getitem__",
       [](Image& self, const std::vector<int>& pos) {
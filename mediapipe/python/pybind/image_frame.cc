@@ -80,6 +80,10 @@ void ImageFrameSubmodule(pybind11::module* module) {
   default alignment boundary during creation. The data in an ImageFrame will
   become immutable after creation.
 
+  With `copy=False`, the ImageFrame takes a reference of the numpy ndarray
+  instead of copying its data. The ndarray must not be modified afterwards.
+  Pass an unwritable ndarray to avoid a RuntimeWarning.
+
   Creation examples:
     import cv2
     cv_mat = cv2.imread(input_file)[:, :, ::-1]
@@ -97,6 +101,10 @@ void ImageFrameSubmodule(pybind11::module* module) {
   internal data and itself is unwritable. If the callers want to modify the
   numpy ndarray, it's required to obtain a copy of it.
 
+  ImageFrame also supports the buffer protocol. `np.asarray(image_frame)` and
+  `memoryview(image_frame)` return an unwritable reference to the internal data
+  without copying, even if the rows are padded for alignment.
+
   Pixel data retrieval examples:
     for channel in range(num_channel):
       for col in range(width):
@@ -107,13 +115,21 @@ void ImageFrameSubmodule(pybind11::module* module) {
     print(output_ndarray[0, 0, 0])
     copied_ndarray = np.copy(output_ndarray)
     copied_ndarray[0,0,0] = 0
+
+  Zero-copy examples:
+    frame = np.ascontiguousarray(cv_mat)
+    frame.flags.writeable = False
+    image_frame = mp.ImageFrame(
+        image_format=mp.ImageFormat.SRGB, data=frame, copy=False)
+    strided_ndarray = np.asarray(image_frame)
   )doc",
-      py::dynamic_attr());
+      py::buffer_protocol(), py::dynamic_attr());
 
   image_frame
       .def(
           py::init([](mediapipe::ImageFormat::Format format,
-                      const py::array_t<uint8, py::array::c_style>& data) {
+                      const py::array_t<uint8, py::array::c_style>& data,
+                      bool copy) {
             if (format != mediapipe::ImageFormat::GRAY8 &&
                 format != mediapipe::ImageFormat::SRGB &&
                 format != mediapipe::ImageFormat::SRGBA) {
@@ -121,13 +137,15 @@ void ImageFrameSubmodule(pybind11::module* module) {
                                  "uint8 image data should be one of the GRAY8, "
                                  "SRGB, and SRGBA MediaPipe image formats.");
             }
-            return CreateImageFrame<uint8>(format, data);
+            return CreateImageFrameWithCopyOption<uint8>(format, data, copy);
           }),
           R"doc(For uint8 data type, valid ImageFormat are GRAY8, SGRB, and SRGBA.)doc",
-          py::arg("image_format"), py::arg("data").noconvert())
+          py::arg("image_format"), py::arg("data").noconvert(),
+          py::arg("copy") = true)
       .def(
           py::init([](mediapipe::ImageFormat::Format format,
-                      const py::array_t<uint16, py::array::c_style>& data) {
+                      const py::array_t<uint16, py::array::c_style>& data,
+                      bool copy) {
             if (format != mediapipe::ImageFormat::GRAY16 &&
                 format != mediapipe::ImageFormat::SRGB48 &&
                 format != mediapipe::ImageFormat::SRGBA64) {
@@ -136,13 +154,15 @@ void ImageFrameSubmodule(pybind11::module* module) {
                   "uint16 image data should be one of the GRAY16, "
                   "SRGB48, and SRGBA64 MediaPipe image formats.");
             }
-            return CreateImageFrame<uint16>(format, data);
+            return CreateImageFrameWithCopyOption<uint16>(format, data, copy);
           }),
           R"doc(For uint16 data type, valid ImageFormat are GRAY16, SRGB48, and SRGBA64.)doc",
-          py::arg("image_format"), py::arg("data").noconvert())
+          py::arg("image_format"), py::arg("data").noconvert(),
+          py::arg("copy") = true)
       .def(
           py::init([](mediapipe::ImageFormat::Format format,
-                      const py::array_t<float, py::array::c_style>& data) {
+                      const py::array_t<float, py::array::c_style>& data,
+                      bool copy) {
             if (format != mediapipe::ImageFormat::VEC32F1 &&
                 format != mediapipe::ImageFormat::VEC32F2) {
               throw RaisePyError(
@@ -150,10 +170,11 @@ void ImageFrameSubmodule(pybind11::module* module) {
                   "float image data should be either VEC32F1 or VEC32F2 "
                   "MediaPipe image formats.");
             }
-            return CreateImageFrame<float>(format, data);
+            return CreateImageFrameWithCopyOption<float>(format, data, copy);
           }),
           R"doc(For float data type, valid ImageFormat are VEC32F1 and VEC32F2.)doc",
-          py::arg("image_format"), py::arg("data").noconvert());
+          py::arg("image_format"), py::arg("data").noconvert(),
+          py::arg("copy") = true);
 
   image_frame.def(
       "numpy_view",
@@ -189,6 +210,10 @@ void ImageFrameSubmodule(pybind11::module* module) {
     copied_ndarray[0,0,0] = 0
 )doc");
 
+  image_frame.def_buffer([](ImageFrame& self) {
+    return ImageFrameBufferInfo(self);
+  });
+
   image_frame.def(
       "__getitem__",
       [](ImageFrame& self, const std::vector<int>& pos) {
@@ -15,6 +15,10 @@
 #ifndef MEDIAPIPE_PYTHON_PYBIND_IMAGE_FRAME_UTIL_H_
 #define MEDIAPIPE_PYTHON_PYBIND_IMAGE_FRAME_UTIL_H_
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "mediapipe/framework/formats/image_format.pb.h"
@@ -53,11 +57,70 @@ std::unique_ptr<ImageFrame> CreateImageFrame(
   auto image_frame = absl::make_unique<ImageFrame>(
       format, /*width=*/cols, /*height=*/rows, width_step,
       static_cast<uint8*>(data.request().ptr),
-      /*deleter=*/[data_pyobject](uint8*) { Py_XDECREF(data_pyobject); });
+      /*deleter=*/[data_pyobject](uint8*) {
+        // The image frame may be released by a graph thread that doesn't
+        // hold the GIL.
+        py::gil_scoped_acquire gil_acquire;
+        Py_XDECREF(data_pyobject);
+      });
   Py_XINCREF(data_pyobject);
   return image_frame;
 }
 
+// Wraps the numpy ndarray `data` in an image frame without copying for
+// ImageFrame and Image constructors called with copy=False. The image frame
+// holds a reference to `data` until it is released. Warns if `data` is still
+// writeable, since modifying it voids the immutability of the image frame.
+template <typename T>
+std::unique_ptr<ImageFrame> CreateImageFrameWithCopyOption(
+    mediapipe::ImageFormat::Format format,
+    const py::array_t<T, py::array::c_style>& data, bool copy) {
+  if (!copy && data.writeable() &&
+      PyErr_WarnEx(PyExc_RuntimeWarning,
+                   "'data' is still writeable. Taking a reference of the data "
+                   "to create an image is dangerous.",
+                   /*stack_level=*/2) < 0) {
+    throw py::error_already_set();
+  }
+  return CreateImageFrame<T>(format, data, copy);
+}
+
+// Describes the pixel data of `image_frame` as a read-only buffer for the
+// Python buffer protocol. The row stride is the width step of the image frame,
+// so no data is copied even if the rows are padded.
+inline py::buffer_info ImageFrameBufferInfo(const ImageFrame& image_frame) {
+  if (image_frame.IsEmpty()) {
+    throw RaisePyError(PyExc_RuntimeError, "ImageFrame is unallocated.");
+  }
+  std::string format;
+  switch (image_frame.ChannelSize()) {
+    case sizeof(uint8):
+      format = py::format_descriptor<uint8>::format();
+      break;
+    case sizeof(uint16):
+      format = py::format_descriptor<uint16>::format();
+      break;
+    case sizeof(float):
+      format = py::format_descriptor<float>::format();
+      break;
+    default:
+      throw RaisePyError(PyExc_RuntimeError,
+                         "Unsupported image frame channel size. Data is not "
+                         "uint8, uint16, or float?");
+  }
+  const py::ssize_t channel_size = image_frame.ChannelSize();
+  std::vector<py::ssize_t> shape{image_frame.Height(), image_frame.Width()};
+  std::vector<py::ssize_t> strides{
+      image_frame.WidthStep(), image_frame.NumberOfChannels() * channel_size};
+  if (image_frame.NumberOfChannels() > 1) {
+    shape.push_back(image_frame.NumberOfChannels());
+    strides.push_back(channel_size);
+  }
+  return py::buffer_info(const_cast<uint8*>(image_frame.PixelData()),
+                         channel_size, format, shape.size(), shape, strides,
+                         /*readonly=*/true);
+}
+
 template <typename T>
 py::array GenerateContiguousDataArrayHelper(const ImageFrame& image_frame,
                                             const py::object& py_object) {
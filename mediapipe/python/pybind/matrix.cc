@@ -27,10 +27,19 @@ namespace py = pybind11;
 void MatrixSubmodule(pybind11::module* module) {
   py::module m = module->def_submodule("matrix", "MediaPipe matrix module.");
 
-  py::class_<mediapipe::Matrix>(m, "Matrix")
+  py::class_<mediapipe::Matrix>(m, "Matrix", py::buffer_protocol())
       .def(py::init(
           // Pass by reference.
-          [](const Eigen::Ref<const Eigen::MatrixXf>& m) { return m; }));
+          [](const Eigen::Ref<const Eigen::MatrixXf>& m) { return m; }))
+      // Exposes the column-major data as an unwritable buffer, so that
+      // np.asarray(matrix) doesn't copy.
+      .def_buffer([](mediapipe::Matrix& self) {
+        const py::ssize_t item_size = sizeof(float);
+        return py::buffer_info(
+            self.data(), item_size, py::format_descriptor<float>::format(),
+            /*ndim=*/2, {py::ssize_t{self.rows()}, py::ssize_t{self.cols()}},
+            {item_size, item_size * self.rows()}, /*readonly=*/true);
+      });
 }
 
 }  // namespace python
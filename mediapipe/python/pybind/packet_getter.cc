@@ -452,12 +452,19 @@ void InternalPacketGetters(pybind11::module* m) {
   m->def(
       "_get_serialized_proto",
       [](const Packet& packet) {
+        std::string serialized_proto;
+        {
+          // Serializes without holding the GIL, which may take a while for
+          // large protos.
+          py::gil_scoped_release gil_release;
+          serialized_proto = packet.GetProtoMessageLite().SerializeAsString();
+        }
         // By default, py::bytes is an extra copy of the original string object:
         // https://github.com/pybind/pybind11/issues/1236
         // However, when Pybind11 performs the C++ to Python transition, it
         // only increases the py::bytes object's ref count. See the
         // implmentation at line 1583 in "pybind11/cast.h".
-        return py::bytes(packet.GetProtoMessageLite().SerializeAsString());
+        return py::bytes(serialized_proto);
       },
       py::return_value_policy::move);
 
@@ -467,10 +474,18 @@ void InternalPacketGetters(pybind11::module* m) {
         auto proto_vector = packet.GetVectorOfProtoMessageLitePtrs();
         RaisePyErrorIfNotOk(proto_vector.status());
         int size = proto_vector.value().size();
+        std::vector<std::string> serialized_protos(size);
+        {
+          // Serializes without holding the GIL.
+          py::gil_scoped_release gil_release;
+          for (int i = 0; i < size; ++i) {
+            serialized_protos[i] = proto_vector.value()[i]->SerializeAsString();
+          }
+        }
         std::vector<py::bytes> results;
         results.reserve(size);
-        for (const proto_ns::MessageLite* ptr : proto_vector.value()) {
-          results.push_back(py::bytes(ptr->SerializeAsString()));
+        for (const std::string& serialized_proto : serialized_protos) {
+          results.push_back(py::bytes(serialized_proto));
         }
         return results;
       },
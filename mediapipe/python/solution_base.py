@@ -24,7 +24,8 @@ class.
 import collections
 import enum
 import os
-from typing import Any, Iterable, List, Mapping, NamedTuple, Optional, Union
+import threading
+from typing import Any, Dict, Iterable, Iterator, List, Mapping, NamedTuple, Optional, Union
 
 import numpy as np
 
@@ -196,6 +197,59 @@ NAME_TO_TYPE: Mapping[str, 'PacketDataType'] = {
 }
 
 
+class _OutputCollector:
+  """Collects graph output packets by timestamp for pipelined processing.
+
+  Packets are stored by the graph output stream callbacks, which only hold the
+  GIL briefly. A timestamp is complete once every output stream has emitted a
+  packet or a timestamp bound at or beyond that timestamp.
+  """
+
+  # Interval in seconds to check the graph for errors while waiting.
+  _ERROR_CHECK_INTERVAL = 0.1
+
+  def __init__(self, stream_names: Iterable[str]):
+    self._condition = threading.Condition()
+    self._packets = collections.defaultdict(dict)
+    self._settled_timestamps = {name: -1 for name in stream_names}
+
+  def add(self, stream_name: str, output_packet: packet.Packet) -> None:
+    timestamp = output_packet.timestamp.value
+    with self._condition:
+      if not output_packet.is_empty():
+        self._packets[timestamp][stream_name] = output_packet
+      if timestamp > self._settled_timestamps[stream_name]:
+        self._settled_timestamps[stream_name] = timestamp
+      self._condition.notify_all()
+
+  def pop(self,
+          timestamp: int,
+          graph: calculator_graph.CalculatorGraph,
+          wait: bool = True) -> Dict[str, packet.Packet]:
+    """Waits until `timestamp` is complete and returns its packets by stream.
+
+    Args:
+      timestamp: The input timestamp in microseconds.
+      graph: The graph producing the packets, checked for errors.
+      wait: Whether to wait for `timestamp` to be complete. Set to False if the
+        graph is known to be idle.
+
+    Raises:
+      RuntimeError: If the graph has an error.
+
+    Returns:
+      A mapping from the output stream name to the output packet. Streams
+      without a packet at `timestamp` are absent.
+    """
+    with self._condition:
+      while wait and not self._condition.wait_for(
+          lambda: min(self._settled_timestamps.values()) >= timestamp,
+          self._ERROR_CHECK_INTERVAL):
+        if graph.has_error():
+          raise RuntimeError(graph.get_combined_error_message())
+      return self._packets.pop(timestamp, {})
+
+
 class SolutionBase:
   """The common base class for the high-level MediaPipe Solution APIs.
 
@@ -280,9 +334,13 @@ class SolutionBase:
         graph_config=canonical_graph_config_proto)
     self._simulated_timestamp = 0
     self._graph_outputs = {}
+    self._output_collector = None
 
     def callback(stream_name: str, output_packet: packet.Packet) -> None:
       self._graph_outputs[stream_name] = output_packet
+      output_collector = self._output_collector
+      if output_collector is not None:
+        output_collector.add(stream_name, output_packet)
 
     for stream_name in self._output_stream_type_info.keys():
       self._graph.observe_output_stream(stream_name, callback, True)
@@ -327,7 +385,77 @@ class SolutionBase:
       print(results.hand_landmarks)
     """
     self._graph_outputs.clear()
+    self._add_inputs(input_data)
+    self._graph.wait_until_idle()
+    return self._make_solution_outputs(self._graph_outputs)
+
+  def process_stream(
+      self,
+      inputs: Iterable[Union[np.ndarray, Mapping[str, Union[np.ndarray,
+                                                            message.Message]]]],
+      max_in_flight: int = 4) -> Iterator[NamedTuple]:
+    """Processes a stream of inputs with several inputs in flight.
+
+    Unlike process(), which waits for the graph to become idle after every
+    input, up to `max_in_flight` inputs are fed into the graph before waiting
+    for the outputs of the oldest one. This lets the graph work on consecutive
+    inputs in parallel, e.g. run inference on one frame while preprocessing the
+    next one. The graph runs without the GIL, while the outputs are converted
+    in the calling thread as they are consumed.
+
+    The outputs of an input are returned once every output stream has emitted
+    a packet or advanced its timestamp bound past the input timestamp. If the
+    graph settles the bounds of an input only after later inputs arrive, use a
+    `max_in_flight` large enough to cover them.
 
+    Args:
+      inputs: An iterable of inputs, each one accepted by process().
+      max_in_flight: The maximum number of inputs fed into the graph whose
+        outputs have not been returned yet.
+
+    Yields:
+      A NamedTuple object per input, in input order, as returned by process().
+
+    Raises:
+      NotImplementedError: If an input contains audio data or a list of proto
+        objects.
+      RuntimeError: If the underlying graph occurs any error.
+      ValueError: If max_in_flight is not positive or if an input image data is
+        not three channel RGB.
+
+    Examples:
+      solution = solution_base.SolutionBase(graph_config=hand_landmark_graph)
+      frames = (frame[:, :, ::-1] for frame in video_frames)
+      for results in solution.process_stream(frames, max_in_flight=3):
+        print(results.hand_landmarks)
+    """
+    if max_in_flight < 1:
+      raise ValueError('max_in_flight must be positive.')
+    output_collector = _OutputCollector(self._output_stream_type_info.keys())
+    self._output_collector = output_collector
+    pending_timestamps = collections.deque()
+    try:
+      for input_data in inputs:
+        if len(pending_timestamps) >= max_in_flight:
+          yield self._make_solution_outputs(
+              output_collector.pop(pending_timestamps.popleft(), self._graph))
+        pending_timestamps.append(self._add_inputs(input_data))
+      # Some calculators only settle the timestamp bounds of their outputs when
+      # the next input arrives, so the last inputs are finished by waiting for
+      # the graph to become idle.
+      self._graph.wait_until_idle()
+      while pending_timestamps:
+        yield self._make_solution_outputs(
+            output_collector.pop(
+                pending_timestamps.popleft(), self._graph, wait=False))
+    finally:
+      self._output_collector = None
+
+  def _add_inputs(
+      self, input_data: Union[np.ndarray, Mapping[str, Union[np.ndarray,
+                                                             message.Message]]]
+  ) -> int:
+    """Adds the packets of one input to the graph, returns their timestamp."""
     if isinstance(input_data, np.ndarray):
       if len(self._input_stream_type_info.keys()) != 1:
         raise ValueError(
@@ -362,18 +490,21 @@ class SolutionBase:
             stream=stream_name,
             packet=self._make_packet(input_stream_type,
                                      data).at(self._simulated_timestamp))
+    return self._simulated_timestamp
 
-    self._graph.wait_until_idle()
+  def _make_solution_outputs(
+      self, output_packets: Mapping[str, packet.Packet]) -> NamedTuple:
+    """Converts the output packets of one input into a NamedTuple object."""
     # Create a NamedTuple object where the field names are mapping to the graph
     # output stream names.
     solution_outputs = collections.namedtuple(
         'SolutionOutputs', self._output_stream_type_info.keys())
     for stream_name in self._output_stream_type_info.keys():
-      if stream_name in self._graph_outputs:
+      if stream_name in output_packets:
         setattr(
             solution_outputs, stream_name,
             self._get_packet_content(self._output_stream_type_info[stream_name],
-                                     self._graph_outputs[stream_name]))
+                                     output_packets[stream_name]))
       else:
         setattr(solution_outputs, stream_name, None)
 
@@ -377,6 +377,56 @@ class SolutionBaseTest(parameterized.TestCase):
         outputs = solution2.process(input_image)
         self.assertTrue(np.array_equal(input_image, outputs.image_type_out))
 
+  @parameterized.named_parameters(('single_in_flight', 1),
+                                  ('multiple_in_flight', 4))
+  def test_solution_process_stream(self, max_in_flight):
+    text_config = """
+      input_stream: 'image_in'
+      output_stream: 'image_out'
+      node {
+        calculator: 'ImageTransformationCalculator'
+        input_stream: 'IMAGE:image_in'
+        output_stream: 'IMAGE:transformed_image_in'
+      }
+      node {
+        calculator: 'ImageTransformationCalculator'
+        input_stream: 'IMAGE:transformed_image_in'
+        output_stream: 'IMAGE:image_out'
+      }
+    """
+    config_proto = text_format.Parse(text_config,
+                                     calculator_pb2.CalculatorGraphConfig())
+    input_images = [
+        np.full((3, 3, 3), i, dtype=np.uint8) for i in range(10)
+    ]
+    with solution_base.SolutionBase(graph_config=config_proto) as solution:
+      outputs = list(
+          solution.process_stream(input_images, max_in_flight=max_in_flight))
+      self.assertLen(outputs, len(input_images))
+      for input_image, output in zip(input_images, outputs):
+        self.assertTrue(np.array_equal(input_image, output.image_out))
+      # process() still works after streaming.
+      self.assertTrue(
+          np.array_equal(input_images[0],
+                         solution.process(input_images[0]).image_out))
+
+  def test_invalid_max_in_flight(self):
+    text_config = """
+      input_stream: 'image_in'
+      output_stream: 'image_out'
+      node {
+        calculator: 'ImageTransformationCalculator'
+        input_stream: 'IMAGE:image_in'
+        output_stream: 'IMAGE:image_out'
+      }
+    """
+    config_proto = text_format.Parse(text_config,
+                                     calculator_pb2.CalculatorGraphConfig())
+    with solution_base.SolutionBase(graph_config=config_proto) as solution:
+      with self.assertRaisesRegex(ValueError,
+                                  'max_in_flight must be positive.'):
+        list(solution.process_stream([], max_in_flight=0))
+
   def _process_and_verify(self,
                           config_proto,
                           side_inputs=None,
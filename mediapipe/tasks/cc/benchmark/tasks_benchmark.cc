@@ -0,0 +1,623 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A main function to benchmark a MediaPipe task through its public C++ API.
+// It creates the task from BaseOptions once per running mode, sends recorded
+// or synthetic inputs, and reports the init time, the throughput, the latency
+// percentiles, the peak resident set size and, in builds with
+// MEDIAPIPE_PROFILING, the per-node Process() runtimes. For example:
+//
+//   bazel run -c opt //mediapipe/tasks/cc/benchmark:tasks_benchmark --
+//     --task=object_detector --model=/path/to/model.tflite
+//     --running_modes=image,live_stream --target_fps=30
+//
+// In the image and video modes, the latency of an input is the duration of
+// the synchronous call. In the live stream mode, it is the time from sending
+// the input to receiving its result in the result callback.
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/formats/matrix.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/tasks/cc/audio/audio_classifier/audio_classifier.h"
+#include "mediapipe/tasks/cc/audio/core/running_mode.h"
+#include "mediapipe/tasks/cc/core/base_options.h"
+#include "mediapipe/tasks/cc/core/task_runner.h"
+#include "mediapipe/tasks/cc/vision/core/running_mode.h"
+#include "mediapipe/tasks/cc/vision/gesture_recognizer/gesture_recognizer.h"
+#include "mediapipe/tasks/cc/vision/image_classifier/image_classifier.h"
+#include "mediapipe/tasks/cc/vision/image_segmenter/image_segmenter.h"
+#include "mediapipe/tasks/cc/vision/object_detector/object_detector.h"
+#include "mediapipe/tasks/cc/vision/utils/image_utils.h"
+
+ABSL_FLAG(std::string, task, "",
+          "The task to benchmark, one of object_detector, image_classifier, "
+          "image_segmenter, gesture_recognizer or audio_classifier.");
+ABSL_FLAG(std::string, model, "",
+          "Path to the model of the task. For gesture_recognizer, the hand "
+          "gesture classification model.");
+ABSL_FLAG(std::string, hand_detector_model, "",
+          "For gesture_recognizer, path to the hand detection model.");
+ABSL_FLAG(std::string, hand_landmarker_model, "",
+          "For gesture_recognizer, path to the hand landmarks model.");
+ABSL_FLAG(std::string, delegate, "cpu",
+          "The delegate the models run on, either cpu or gpu.");
+ABSL_FLAG(std::string, running_modes, "image,video,live_stream",
+          "Comma-separated list of the running modes to benchmark, each with "
+          "a new task instance. For audio_classifier, image selects the audio "
+          "clips mode, live_stream the audio stream mode, and video is "
+          "skipped.");
+ABSL_FLAG(std::string, input_dir, "",
+          "Directory of .jpg and .png images sent to the vision tasks in "
+          "order, repeated as needed. If empty, a random image of "
+          "--image_size is sent.");
+ABSL_FLAG(std::string, image_size, "640x480",
+          "The <width>x<height> of the random image sent to the vision tasks "
+          "if --input_dir is empty.");
+ABSL_FLAG(int, audio_sample_rate, 16000,
+          "The sample rate of the random audio sent to audio_classifier.");
+ABSL_FLAG(int, audio_clip_ms, 1000,
+          "The duration of every audio clip or block sent to "
+          "audio_classifier.");
+ABSL_FLAG(int, num_iterations, 200,
+          "The number of inputs sent in every running mode, not counting the "
+          "warm-up inputs.");
+ABSL_FLAG(int, warmup_iterations, 20,
+          "The number of inputs sent before measuring starts.");
+ABSL_FLAG(double, target_fps, 0,
+          "The rate at which inputs are sent in the live stream and audio "
+          "stream modes. If 0, inputs are sent as fast as the task accepts "
+          "them.");
+
+namespace {
+
+using ::mediapipe::CalculatorProfile;
+using ::mediapipe::Image;
+using ::mediapipe::tasks::core::BaseOptions;
+using ::mediapipe::tasks::core::TaskRunner;
+
+// Recorded images are decoded up front, which bounds the memory used for the
+// decoded images.
+constexpr int kMaxImages = 100;
+
+// The running modes, shared by the vision and audio tasks.
+enum class Mode { kImage, kVideo, kLiveStream };
+
+// Records the send and result times of the inputs, keyed by timestamp.
+class LatencyTracker {
+ public:
+  void Sent(int64 timestamp_ms, bool measured) {
+    absl::MutexLock lock(&mutex_);
+    const absl::Time now = absl::Now();
+    in_flight_[timestamp_ms] = {now, measured};
+    if (measured) first_send_time_ = std::min(first_send_time_, now);
+  }
+
+  void Done(int64 timestamp_ms) {
+    absl::MutexLock lock(&mutex_);
+    auto it = in_flight_.find(timestamp_ms);
+    if (it == in_flight_.end()) return;
+    const absl::Time now = absl::Now();
+    if (it->second.measured) {
+      latencies_.push_back(now - it->second.send_time);
+      last_done_time_ = std::max(last_done_time_, now);
+    }
+    in_flight_.erase(it);
+  }
+
+  // Extends the measured time up to now, for results that are not tracked
+  // individually.
+  void Flushed() {
+    absl::MutexLock lock(&mutex_);
+    last_done_time_ = absl::Now();
+  }
+
+  std::vector<absl::Duration> Latencies() {
+    absl::MutexLock lock(&mutex_);
+    return latencies_;
+  }
+
+  absl::Duration MeasuredTime() {
+    absl::MutexLock lock(&mutex_);
+    if (latencies_.empty()) return absl::ZeroDuration();
+    return last_done_time_ - first_send_time_;
+  }
+
+ private:
+  struct SendInfo {
+    absl::Time send_time;
+    bool measured;
+  };
+
+  absl::Mutex mutex_;
+  std::map<int64, SendInfo> in_flight_;
+  std::vector<absl::Duration> latencies_;
+  absl::Time first_send_time_ = absl::InfiniteFuture();
+  absl::Time last_done_time_ = absl::InfinitePast();
+};
+
+// Paces the inputs of the stream modes at --target_fps, and returns the
+// timestamp of every input.
+class InputClock {
+ public:
+  InputClock()
+      : interval_(absl::GetFlag(FLAGS_target_fps) > 0
+                      ? absl::Seconds(1 / absl::GetFlag(FLAGS_target_fps))
+                      : absl::ZeroDuration()),
+        start_(absl::Now()) {}
+
+  // Waits for the slot of the "index"th input if the inputs are paced.
+  void WaitFor(int index) {
+    if (interval_ == absl::ZeroDuration()) return;
+    absl::SleepFor(start_ + index * interval_ - absl::Now());
+  }
+
+  // Returns the strictly increasing timestamp of the "index"th input. It
+  // follows the pacing if there is any, so that video-based calculators see
+  // realistic frame intervals.
+  int64 TimestampMs(int index) const {
+    const int64 interval_ms =
+        std::max<int64>(absl::ToInt64Milliseconds(interval_), 1);
+    return index * interval_ms;
+  }
+
+ private:
+  const absl::Duration interval_;
+  const absl::Time start_;
+};
+
+// Collects the calculator profiles that the TaskRunner reports on Close().
+class ProfileCollector {
+ public:
+  ProfileCollector() {
+    TaskRunner::SetGraphProfilesCallback(
+        [this](const std::vector<CalculatorProfile>& profiles) {
+          absl::MutexLock lock(&mutex_);
+          profiles_ = profiles;
+        });
+  }
+  ~ProfileCollector() { TaskRunner::SetGraphProfilesCallback(nullptr); }
+
+  std::vector<CalculatorProfile> profiles() {
+    absl::MutexLock lock(&mutex_);
+    return profiles_;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<CalculatorProfile> profiles_;
+};
+
+// Returns the nearest-rank percentile of sorted durations in milliseconds.
+double PercentileMs(const std::vector<absl::Duration>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  int rank = static_cast<int>(std::ceil(p / 100 * sorted.size()));
+  rank = std::min<int>(std::max(rank, 1), sorted.size());
+  return absl::ToDoubleMilliseconds(sorted[rank - 1]);
+}
+
+// Returns the peak resident set size of this process in MiB.
+double PeakRssMb() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+  return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+  return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+void PrintReport(const std::string& mode_name, absl::Duration init_time,
+                 LatencyTracker& tracker,
+                 const std::vector<CalculatorProfile>& profiles) {
+  std::vector<absl::Duration> latencies = tracker.Latencies();
+  std::sort(latencies.begin(), latencies.end());
+  const double seconds = absl::ToDoubleSeconds(tracker.MeasuredTime());
+  std::cout << absl::StrFormat("=== %s\n", mode_name);
+  std::cout << absl::StrFormat("Init time: %.1f ms\n",
+                               absl::ToDoubleMilliseconds(init_time));
+  std::cout << absl::StrFormat("Completed inputs: %d\n", latencies.size());
+  std::cout << absl::StrFormat(
+      "Throughput: %.2f fps\n", seconds > 0 ? latencies.size() / seconds : 0);
+  std::cout << absl::StrFormat(
+      "Latency: p50 %.3f ms, p90 %.3f ms, p99 %.3f ms\n",
+      PercentileMs(latencies, 50), PercentileMs(latencies, 90),
+      PercentileMs(latencies, 99));
+  std::cout << absl::StrFormat("Peak RSS: %.1f MiB\n", PeakRssMb());
+  if (profiles.empty()) {
+    std::cout << "No per-node profiles, build with MEDIAPIPE_PROFILING.\n";
+    return;
+  }
+
+  int64 total_usec = 0;
+  for (const auto& profile : profiles) {
+    total_usec += profile.process_runtime().total();
+  }
+  std::cout << absl::StrFormat("%-40s %10s %12s %8s\n", "Node", "Calls",
+                               "Mean (us)", "Share");
+  for (const auto& profile : profiles) {
+    const mediapipe::TimeHistogram& runtime = profile.process_runtime();
+    int64 calls = 0;
+    for (int64 count : runtime.count()) calls += count;
+    std::cout << absl::StrFormat(
+        "%-40s %10d %12.1f %7.1f%%\n", profile.name(), calls,
+        calls > 0 ? static_cast<double>(runtime.total()) / calls : 0,
+        total_usec > 0 ? 100.0 * runtime.total() / total_usec : 0);
+  }
+}
+
+absl::StatusOr<std::vector<Mode>> ParseRunningModes() {
+  std::vector<Mode> modes;
+  for (absl::string_view name :
+       absl::StrSplit(absl::GetFlag(FLAGS_running_modes), ',')) {
+    if (name == "image") {
+      modes.push_back(Mode::kImage);
+    } else if (name == "video") {
+      modes.push_back(Mode::kVideo);
+    } else if (name == "live_stream") {
+      modes.push_back(Mode::kLiveStream);
+    } else {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unknown running mode: ", name));
+    }
+  }
+  return modes;
+}
+
+absl::StatusOr<BaseOptions::Delegate> ParseDelegate() {
+  const std::string delegate = absl::GetFlag(FLAGS_delegate);
+  if (delegate == "cpu") return BaseOptions::Delegate::CPU;
+  if (delegate == "gpu") return BaseOptions::Delegate::GPU;
+  return absl::InvalidArgumentError(
+      absl::StrCat("Unknown delegate: ", delegate));
+}
+
+// Returns a random SRGB image, so that no calculator sees constant data.
+Image MakeRandomImage(int width, int height) {
+  auto frame = std::make_shared<mediapipe::ImageFrame>(
+      mediapipe::ImageFormat::SRGB, width, height,
+      mediapipe::ImageFrame::kDefaultAlignmentBoundary);
+  cv::Mat mat = mediapipe::formats::MatView(frame.get());
+  cv::randu(mat, cv::Scalar::all(0), cv::Scalar::all(255));
+  return Image(std::move(frame));
+}
+
+// Returns the images in --input_dir, or a random image of --image_size.
+absl::StatusOr<std::vector<Image>> LoadImages() {
+  const std::string input_dir = absl::GetFlag(FLAGS_input_dir);
+  if (input_dir.empty()) {
+    std::vector<std::string> size =
+        absl::StrSplit(absl::GetFlag(FLAGS_image_size), 'x');
+    int width, height;
+    RET_CHECK(size.size() == 2 && absl::SimpleAtoi(size[0], &width) &&
+              absl::SimpleAtoi(size[1], &height) && width > 0 && height > 0)
+        << "Expected --image_size=<width>x<height>, got: "
+        << absl::GetFlag(FLAGS_image_size);
+    return std::vector<Image>{MakeRandomImage(width, height)};
+  }
+  std::vector<std::string> paths;
+  for (const char* suffix : {".jpg", ".jpeg", ".png"}) {
+    MP_RETURN_IF_ERROR(
+        mediapipe::file::MatchFileTypeInDirectory(input_dir, suffix, &paths));
+  }
+  std::sort(paths.begin(), paths.end());
+  std::vector<Image> images;
+  for (const std::string& path : paths) {
+    if (images.size() >= kMaxImages) break;
+    ASSIGN_OR_RETURN(Image image,
+                     mediapipe::tasks::vision::DecodeImageFromFile(path));
+    images.push_back(std::move(image));
+  }
+  RET_CHECK(!images.empty()) << "No images in: " << input_dir;
+  return images;
+}
+
+// Returns random audio of --audio_clip_ms at --audio_sample_rate.
+mediapipe::Matrix MakeRandomAudio() {
+  const int num_samples =
+      static_cast<int64>(absl::GetFlag(FLAGS_audio_clip_ms)) *
+      absl::GetFlag(FLAGS_audio_sample_rate) / 1000;
+  std::mt19937 generator(/*seed=*/0);
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  mediapipe::Matrix audio(1, num_samples);
+  for (int i = 0; i < num_samples; ++i) {
+    audio(0, i) = distribution(generator);
+  }
+  return audio;
+}
+
+const char* ModeName(Mode mode) {
+  switch (mode) {
+    case Mode::kImage:
+      return "image";
+    case Mode::kVideo:
+      return "video";
+    case Mode::kLiveStream:
+      return "live_stream";
+  }
+  return "";
+}
+
+// Benchmarks a vision task in every running mode. "Options" is the options
+// struct of "Task", whose model fields are set by "set_models". The
+// "run_image", "run_video" and "run_async" functions wrap the task methods of
+// the three running modes.
+template <typename Task, typename Options, typename RunImage,
+          typename RunVideo, typename RunAsync>
+absl::Status BenchmarkVisionTask(
+    const std::function<void(Options&)>& set_models, RunImage run_image,
+    RunVideo run_video, RunAsync run_async) {
+  namespace vision = ::mediapipe::tasks::vision;
+  ASSIGN_OR_RETURN(const std::vector<Mode> modes, ParseRunningModes());
+  ASSIGN_OR_RETURN(const std::vector<Image> images, LoadImages());
+  const int warmup_iterations = absl::GetFlag(FLAGS_warmup_iterations);
+  const int num_inputs =
+      warmup_iterations + absl::GetFlag(FLAGS_num_iterations);
+
+  for (Mode mode : modes) {
+    LatencyTracker tracker;
+    ProfileCollector profile_collector;
+    auto options = std::make_unique<Options>();
+    set_models(*options);
+    switch (mode) {
+      case Mode::kImage:
+        options->running_mode = vision::core::RunningMode::IMAGE;
+        break;
+      case Mode::kVideo:
+        options->running_mode = vision::core::RunningMode::VIDEO;
+        break;
+      case Mode::kLiveStream:
+        options->running_mode = vision::core::RunningMode::LIVE_STREAM;
+        // Dropped inputs have no result and are not counted.
+        options->result_callback = [&tracker](auto result, const Image&,
+                                              int64 timestamp_ms) {
+          if (result.ok()) tracker.Done(timestamp_ms);
+        };
+        break;
+    }
+
+    const absl::Time init_start = absl::Now();
+    ASSIGN_OR_RETURN(std::unique_ptr<Task> task,
+                     Task::Create(std::move(options)));
+    const absl::Duration init_time = absl::Now() - init_start;
+
+    InputClock clock;
+    for (int i = 0; i < num_inputs; ++i) {
+      const Image& image = images[i % images.size()];
+      const int64 timestamp_ms = clock.TimestampMs(i);
+      if (mode == Mode::kLiveStream) clock.WaitFor(i);
+      tracker.Sent(timestamp_ms, /*measured=*/i >= warmup_iterations);
+      switch (mode) {
+        case Mode::kImage:
+          MP_RETURN_IF_ERROR(run_image(*task, image).status());
+          tracker.Done(timestamp_ms);
+          break;
+        case Mode::kVideo:
+          MP_RETURN_IF_ERROR(run_video(*task, image, timestamp_ms).status());
+          tracker.Done(timestamp_ms);
+          break;
+        case Mode::kLiveStream:
+          MP_RETURN_IF_ERROR(run_async(*task, image, timestamp_ms));
+          break;
+      }
+    }
+    // Waits for the pending live stream results and reports the profiles.
+    MP_RETURN_IF_ERROR(task->Close());
+    PrintReport(ModeName(mode), init_time, tracker,
+                profile_collector.profiles());
+  }
+  return absl::OkStatus();
+}
+
+// Benchmarks the audio classifier with random audio. The image mode runs the
+// audio clips mode and the live stream mode runs the audio stream mode, whose
+// results are not tied to an input: its latency is the duration of the
+// ClassifyAsync() calls, and its throughput includes the wait for the pending
+// results.
+absl::Status BenchmarkAudioClassifier(const BaseOptions& base_options) {
+  namespace audio = ::mediapipe::tasks::audio;
+  using audio::audio_classifier::AudioClassifier;
+  using audio::audio_classifier::AudioClassifierOptions;
+  ASSIGN_OR_RETURN(const std::vector<Mode> modes, ParseRunningModes());
+  const mediapipe::Matrix audio_clip = MakeRandomAudio();
+  const double sample_rate = absl::GetFlag(FLAGS_audio_sample_rate);
+  const int warmup_iterations = absl::GetFlag(FLAGS_warmup_iterations);
+  const int num_inputs =
+      warmup_iterations + absl::GetFlag(FLAGS_num_iterations);
+
+  for (Mode mode : modes) {
+    if (mode == Mode::kVideo) {
+      std::cout << "Skipping the video mode, not supported by audio tasks.\n";
+      continue;
+    }
+    LatencyTracker tracker;
+    ProfileCollector profile_collector;
+    auto options = std::make_unique<AudioClassifierOptions>();
+    options->base_options.model_asset_path = base_options.model_asset_path;
+    options->base_options.delegate = base_options.delegate;
+    if (mode == Mode::kLiveStream) {
+      options->running_mode = audio::core::RunningMode::AUDIO_STREAM;
+      options->sample_rate = sample_rate;
+      options->result_callback = [](auto) {};
+    }
+
+    const absl::Time init_start = absl::Now();
+    ASSIGN_OR_RETURN(std::unique_ptr<AudioClassifier> classifier,
+                     AudioClassifier::Create(std::move(options)));
+    const absl::Duration init_time = absl::Now() - init_start;
+
+    InputClock clock;
+    const int64 clip_ms = absl::GetFlag(FLAGS_audio_clip_ms);
+    for (int i = 0; i < num_inputs; ++i) {
+      // Consecutive blocks of the audio stream must not overlap.
+      const int64 timestamp_ms = i * clip_ms;
+      if (mode == Mode::kLiveStream) clock.WaitFor(i);
+      tracker.Sent(timestamp_ms, /*measured=*/i >= warmup_iterations);
+      if (mode == Mode::kImage) {
+        MP_RETURN_IF_ERROR(
+            classifier->Classify(audio_clip, sample_rate).status());
+      } else {
+        MP_RETURN_IF_ERROR(classifier->ClassifyAsync(audio_clip, timestamp_ms));
+      }
+      tracker.Done(timestamp_ms);
+    }
+    MP_RETURN_IF_ERROR(classifier->Close());
+    if (mode == Mode::kLiveStream) tracker.Flushed();
+    PrintReport(mode == Mode::kImage ? "audio_clips" : "audio_stream",
+                init_time, tracker, profile_collector.profiles());
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RunBenchmark() {
+  namespace vision = ::mediapipe::tasks::vision;
+  const std::string task = absl::GetFlag(FLAGS_task);
+  BaseOptions base_options;
+  base_options.model_asset_path = absl::GetFlag(FLAGS_model);
+  ASSIGN_OR_RETURN(base_options.delegate, ParseDelegate());
+  RET_CHECK(!base_options.model_asset_path.empty()) << "Missing --model.";
+  auto set_base_options = [&base_options](auto& options) {
+    options.base_options.model_asset_path = base_options.model_asset_path;
+    options.base_options.delegate = base_options.delegate;
+  };
+
+  if (task == "object_detector") {
+    using vision::ObjectDetector;
+    using vision::ObjectDetectorOptions;
+    return BenchmarkVisionTask<ObjectDetector, ObjectDetectorOptions>(
+        set_base_options,
+        [](ObjectDetector& task, const Image& image) {
+          return task.Detect(image);
+        },
+        [](ObjectDetector& task, const Image& image, int64 timestamp_ms) {
+          return task.DetectForVideo(image, timestamp_ms);
+        },
+        [](ObjectDetector& task, const Image& image, int64 timestamp_ms) {
+          return task.DetectAsync(image, timestamp_ms);
+        });
+  }
+  if (task == "image_classifier") {
+    using vision::image_classifier::ImageClassifier;
+    using vision::image_classifier::ImageClassifierOptions;
+    return BenchmarkVisionTask<ImageClassifier, ImageClassifierOptions>(
+        set_base_options,
+        [](ImageClassifier& task, const Image& image) {
+          return task.Classify(image);
+        },
+        [](ImageClassifier& task, const Image& image, int64 timestamp_ms) {
+          return task.ClassifyForVideo(image, timestamp_ms);
+        },
+        [](ImageClassifier& task, const Image& image, int64 timestamp_ms) {
+          return task.ClassifyAsync(image, timestamp_ms);
+        });
+  }
+  if (task == "image_segmenter") {
+    using vision::ImageSegmenter;
+    using vision::ImageSegmenterOptions;
+    return BenchmarkVisionTask<ImageSegmenter, ImageSegmenterOptions>(
+        set_base_options,
+        [](ImageSegmenter& task, const Image& image) {
+          return task.Segment(image);
+        },
+        [](ImageSegmenter& task, const Image& image, int64 timestamp_ms) {
+          return task.SegmentForVideo(image, timestamp_ms);
+        },
+        [](ImageSegmenter& task, const Image& image, int64 timestamp_ms) {
+          return task.SegmentAsync(image, timestamp_ms);
+        });
+  }
+  if (task == "gesture_recognizer") {
+    using vision::gesture_recognizer::GestureRecognizer;
+    using vision::gesture_recognizer::GestureRecognizerOptions;
+    RET_CHECK(!absl::GetFlag(FLAGS_hand_detector_model).empty() &&
+              !absl::GetFlag(FLAGS_hand_landmarker_model).empty())
+        << "gesture_recognizer requires --hand_detector_model and "
+           "--hand_landmarker_model.";
+    return BenchmarkVisionTask<GestureRecognizer, GestureRecognizerOptions>(
+        [&base_options](GestureRecognizerOptions& options) {
+          options.base_options.delegate = base_options.delegate;
+          options.base_options_for_hand_detector.model_asset_path =
+              absl::GetFlag(FLAGS_hand_detector_model);
+          options.base_options_for_hand_detector.delegate =
+              base_options.delegate;
+          options.base_options_for_hand_landmarker.model_asset_path =
+              absl::GetFlag(FLAGS_hand_landmarker_model);
+          options.base_options_for_hand_landmarker.delegate =
+              base_options.delegate;
+          options.base_options_for_gesture_recognizer.model_asset_path =
+              base_options.model_asset_path;
+          options.base_options_for_gesture_recognizer.delegate =
+              base_options.delegate;
+        },
+        [](GestureRecognizer& task, const Image& image) {
+          return task.Recognize(image);
+        },
+        [](GestureRecognizer& task, const Image& image, int64 timestamp_ms) {
+          return task.RecognizeForVideo(image, timestamp_ms);
+        },
+        [](GestureRecognizer& task, const Image& image, int64 timestamp_ms) {
+          return task.RecognizeAsync(image, timestamp_ms);
+        });
+  }
+  if (task == "audio_classifier") {
+    return BenchmarkAudioClassifier(base_options);
+  }
+  return absl::InvalidArgumentError(absl::StrCat("Unknown task: ", task));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status run_status = RunBenchmark();
+  if (!run_status.ok()) {
+    LOG(ERROR) << "Failed to run the benchmark: " << run_status.message();
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/port.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/tasks/cc/components/calculators/embedding_search_calculator.pb.h"
+#include "mediapipe/tasks/cc/components/containers/proto/embedding_search_result.pb.h"
+#include "mediapipe/tasks/cc/components/containers/proto/embeddings.pb.h"
+#include "mediapipe/tasks/cc/components/utils/embedding_index.h"
+#include "mediapipe/tasks/cc/core/proto/external_file.pb.h"
+
+namespace mediapipe {
+namespace api2 {
+
+using ::mediapipe::tasks::components::containers::proto::EmbeddingEntry;
+using ::mediapipe::tasks::components::containers::proto::EmbeddingResult;
+using ::mediapipe::tasks::components::containers::proto::EmbeddingSearchResult;
+using ::mediapipe::tasks::components::utils::EmbeddingIndex;
+
+// Looks the nearest neighbors of embeddings up in an EmbeddingIndex, so that
+// embedding retrieval runs inside the graph. The index is loaded once, when
+// the calculator is opened.
+//
+// Input:
+//   EMBEDDINGS - EmbeddingResult
+//     The embeddings to search for, e.g. from TensorsToEmbeddingsCalculator.
+//     The first entry of the head selected through the options is searched.
+// Output:
+//   SEARCH_RESULT - EmbeddingSearchResult
+//     The nearest neighbors of the embedding, by decreasing similarity.
+//
+// Example:
+// node {
+//   calculator: "EmbeddingSearchCalculator"
+//   input_stream: "EMBEDDINGS:embeddings"
+//   output_stream: "SEARCH_RESULT:search_result"
+//   options {
+//     [mediapipe.tasks.EmbeddingSearchCalculatorOptions.ext] {
+//       index_file { file_name: "/path/to/index" }
+//       max_results: 10
+//     }
+//   }
+// }
+class EmbeddingSearchCalculator : public Node {
+ public:
+  static constexpr Input<EmbeddingResult> kEmbeddingsIn{"EMBEDDINGS"};
+  static constexpr Output<EmbeddingSearchResult> kSearchResultOut{
+      "SEARCH_RESULT"};
+  MEDIAPIPE_NODE_CONTRACT(kEmbeddingsIn, kSearchResultOut);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+
+ private:
+  tasks::EmbeddingSearchCalculatorOptions options_;
+  std::unique_ptr<EmbeddingIndex> index_;
+};
+
+absl::Status EmbeddingSearchCalculator::Open(CalculatorContext* cc) {
+  options_ = cc->Options<tasks::EmbeddingSearchCalculatorOptions>();
+  RET_CHECK(options_.has_index_file()) << "An index file must be provided.";
+  RET_CHECK_GT(options_.max_results(), 0);
+  auto index_file = std::make_unique<tasks::core::proto::ExternalFile>();
+  index_file->Swap(options_.mutable_index_file());
+  ASSIGN_OR_RETURN(index_, EmbeddingIndex::Create(std::move(index_file)));
+  return absl::OkStatus();
+}
+
+absl::Status EmbeddingSearchCalculator::Process(CalculatorContext* cc) {
+  if (kEmbeddingsIn(cc).IsEmpty()) return absl::OkStatus();
+  const EmbeddingResult& embedding_result = *kEmbeddingsIn(cc);
+  const int head_index = options_.head_index();
+  if (head_index < 0 || head_index >= embedding_result.embeddings_size() ||
+      embedding_result.embeddings(head_index).entries_size() == 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "No embedding entry for head %d to search for.", head_index));
+  }
+  const EmbeddingEntry& entry =
+      embedding_result.embeddings(head_index).entries(0);
+  std::vector<EmbeddingIndex::Neighbor> neighbors;
+  if (entry.has_float_embedding()) {
+    const auto& values = entry.float_embedding().values();
+    ASSIGN_OR_RETURN(neighbors,
+                     index_->Search(absl::MakeConstSpan(values.data(),
+                                                        values.size()),
+                                    options_.max_results(),
+                                    options_.num_probes()));
+  } else {
+    const auto& values = entry.quantized_embedding().values();
+    ASSIGN_OR_RETURN(
+        neighbors,
+        index_->Search(
+            absl::MakeConstSpan(reinterpret_cast<const int8_t*>(values.data()),
+                                values.size()),
+            options_.max_results(), options_.num_probes()));
+  }
+  EmbeddingSearchResult search_result;
+  for (const auto& neighbor : neighbors) {
+    auto* nearest_neighbor = search_result.add_neighbors();
+    nearest_neighbor->set_id(neighbor.id);
+    nearest_neighbor->set_similarity(neighbor.similarity);
+  }
+  if (entry.has_timestamp_ms()) {
+    search_result.set_timestamp_ms(entry.timestamp_ms());
+  }
+  kSearchResultOut(cc).Send(std::move(search_result));
+  return absl::OkStatus();
+}
+
+MEDIAPIPE_REGISTER_NODE(EmbeddingSearchCalculator);
+
+}  // namespace api2
+}  // namespace mediapipe
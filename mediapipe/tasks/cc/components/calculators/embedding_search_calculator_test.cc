@@ -0,0 +1,117 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/tasks/cc/components/calculators/embedding_search_calculator.pb.h"
+#include "mediapipe/tasks/cc/components/containers/proto/embedding_search_result.pb.h"
+#include "mediapipe/tasks/cc/components/containers/proto/embeddings.pb.h"
+#include "mediapipe/tasks/cc/components/utils/embedding_index.h"
+
+namespace mediapipe {
+namespace {
+
+using ::mediapipe::tasks::components::containers::proto::EmbeddingResult;
+using ::mediapipe::tasks::components::containers::proto::EmbeddingSearchResult;
+using ::mediapipe::tasks::components::utils::EmbeddingIndex;
+using ::testing::HasSubstr;
+using Node = ::mediapipe::CalculatorGraphConfig::Node;
+
+// Returns a node searching an index of four 2-dimensional embeddings, with ids
+// 10 to 13, in the max_results nearest neighbors.
+Node BuildNode(int max_results) {
+  const std::vector<int64_t> ids = {10, 11, 12, 13};
+  const std::vector<float> embeddings = {1.0, 0.0, 0.0, 1.0,
+                                         -1.0, 0.0, 0.7, 0.7};
+  EmbeddingIndex::BuildOptions build_options;
+  build_options.num_clusters = 2;
+  auto index = EmbeddingIndex::Build(ids, embeddings, build_options);
+  EXPECT_TRUE(index.ok());
+  auto node = ParseTextProtoOrDie<Node>(R"pb(
+    calculator: "EmbeddingSearchCalculator"
+    input_stream: "EMBEDDINGS:embeddings"
+    output_stream: "SEARCH_RESULT:search_result"
+  )pb");
+  auto* options = node.mutable_options()->MutableExtension(
+      tasks::EmbeddingSearchCalculatorOptions::ext);
+  options->mutable_index_file()->set_file_content(
+      std::string((*index)->Serialize()));
+  options->set_max_results(max_results);
+  options->set_num_probes(0);
+  return node;
+}
+
+void AddEmbedding(CalculatorRunner* runner, std::vector<float> values) {
+  EmbeddingResult result;
+  auto* entry = result.add_embeddings()->add_entries();
+  for (const float value : values) {
+    entry->mutable_float_embedding()->add_values(value);
+  }
+  entry->set_timestamp_ms(42);
+  runner->MutableInputs()->Tag("EMBEDDINGS").packets.push_back(
+      MakePacket<EmbeddingResult>(std::move(result)).At(Timestamp(0)));
+}
+
+TEST(EmbeddingSearchCalculatorTest, FailsWithoutIndexFile) {
+  CalculatorRunner runner(ParseTextProtoOrDie<Node>(R"pb(
+    calculator: "EmbeddingSearchCalculator"
+    input_stream: "EMBEDDINGS:embeddings"
+    output_stream: "SEARCH_RESULT:search_result"
+  )pb"));
+
+  auto status = runner.Run();
+
+  EXPECT_THAT(status.message(), HasSubstr("An index file must be provided"));
+}
+
+TEST(EmbeddingSearchCalculatorTest, FailsWithMismatchedEmbedding) {
+  CalculatorRunner runner(BuildNode(/*max_results=*/2));
+
+  AddEmbedding(&runner, {1.0, 0.0, 0.0});
+  auto status = runner.Run();
+
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("of dimension 2"));
+}
+
+TEST(EmbeddingSearchCalculatorTest, SucceedsWithFloatEmbedding) {
+  CalculatorRunner runner(BuildNode(/*max_results=*/2));
+
+  AddEmbedding(&runner, {0.9, 0.1});
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& output_packets = runner.Outputs().Tag("SEARCH_RESULT").packets;
+  ASSERT_EQ(output_packets.size(), 1);
+  const auto& result = output_packets[0].Get<EmbeddingSearchResult>();
+  EXPECT_EQ(result.timestamp_ms(), 42);
+  ASSERT_EQ(result.neighbors_size(), 2);
+  EXPECT_EQ(result.neighbors(0).id(), 10);
+  EXPECT_EQ(result.neighbors(1).id(), 13);
+  EXPECT_GT(result.neighbors(0).similarity(), result.neighbors(1).similarity());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -12,13 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include <functional>
+#include <limits>
 #include <memory>
 #include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
-#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/port.h"
@@ -54,6 +53,58 @@ float ClampedLog(float x, float threshold) {
   }
   return std::log(static_cast<double>(x));
 }
+
+// The parameters of one sigmoid, copied out of the options so that the
+// calibration loop does not go through the proto accessors.
+struct Sigmoid {
+  // Sigmoids missing any of scale, offset or slope return the default score.
+  bool is_empty = true;
+  float scale = 0.0f;
+  float slope = 0.0f;
+  float offset = 0.0f;
+  // Scores below min_score return the default score.
+  float min_score = -std::numeric_limits<float>::infinity();
+};
+
+// Computes the calibrated score of "score" using "sigmoid". The score
+// transformation is a template parameter so that it is inlined in the loop
+// over all scores.
+template <typename Transformation>
+inline float CalibrateScore(const Sigmoid& sigmoid, float default_score,
+                            Transformation transformation, float score) {
+  if (sigmoid.is_empty || score < sigmoid.min_score) {
+    return default_score;
+  }
+
+  float transformed_score = transformation(score);
+  float scale_shifted_score =
+      transformed_score * sigmoid.slope + sigmoid.offset;
+  // For numerical stability use 1 / (1+exp(-x)) when scale_shifted_score >= 0
+  // and exp(x) / (1+exp(x)) when scale_shifted_score < 0.
+  float calibrated_score;
+  if (scale_shifted_score >= 0.0) {
+    calibrated_score =
+        sigmoid.scale /
+        (1.0 + std::exp(static_cast<double>(-scale_shifted_score)));
+  } else {
+    float score_exp = std::exp(static_cast<double>(scale_shifted_score));
+    calibrated_score = sigmoid.scale * score_exp / (1.0 + score_exp);
+  }
+  // Scale is non-negative (checked in SigmoidFromLabelAndLine),
+  // thus calibrated_score should be in the range of [0, scale]. However, due to
+  // numberical stability issue, it may fall out of the boundary. Cap the value
+  // to [0, scale] instead.
+  return std::max(std::min(calibrated_score, sigmoid.scale), 0.0f);
+}
+
+float IdentityTransformation(float x) { return x; }
+
+float LogTransformation(float x) { return ClampedLog(x, kLogScoreMinimum); }
+
+float InverseLogisticTransformation(float x) {
+  return (ClampedLog(x, kLogScoreMinimum) -
+          ClampedLog(1.0 - x, kLogScoreMinimum));
+}
 }  // namespace
 
 // Applies score calibration to a tensor of score predictions, typically applied
@@ -91,13 +142,15 @@ class ScoreCalibrationCalculator : public Node {
 
  private:
   ScoreCalibrationCalculatorOptions options_;
-  std::function<float(float)> score_transformation_;
+  // The sigmoids of options_, in the same order.
+  std::vector<Sigmoid> sigmoids_;
 
-  // Computes the calibrated score for the provided index. Does not check for
-  // out-of-bounds index.
-  float ComputeCalibratedScore(int index, float score);
-  // Same as above, but does check for out-of-bounds index.
-  absl::StatusOr<float> SafeComputeCalibratedScore(int index, float score);
+  // Calibrates the input scores using "transformation" and sends the results.
+  template <typename Transformation>
+  absl::Status CalibrateScores(CalculatorContext* cc,
+                               Transformation transformation);
+  // Checks that the externally provided index of a sigmoid is in bounds.
+  absl::Status CheckSigmoidIndex(int index);
 };
 
 absl::Status ScoreCalibrationCalculator::Open(CalculatorContext* cc) {
@@ -118,21 +171,23 @@ absl::Status ScoreCalibrationCalculator::Open(CalculatorContext* cc) {
           MediaPipeTasksStatus::kInvalidArgumentError);
     }
   }
-  // Set score transformation function once and for all.
+  sigmoids_.clear();
+  sigmoids_.reserve(options_.sigmoids_size());
+  for (const auto& sigmoid : options_.sigmoids()) {
+    Sigmoid& params = sigmoids_.emplace_back();
+    params.is_empty =
+        !sigmoid.has_scale() || !sigmoid.has_offset() || !sigmoid.has_slope();
+    params.scale = sigmoid.scale();
+    params.slope = sigmoid.slope();
+    params.offset = sigmoid.offset();
+    if (sigmoid.has_min_score()) {
+      params.min_score = sigmoid.min_score();
+    }
+  }
   switch (options_.score_transformation()) {
     case tasks::ScoreCalibrationCalculatorOptions::IDENTITY:
-      score_transformation_ = [](float x) { return x; };
-      break;
     case tasks::ScoreCalibrationCalculatorOptions::LOG:
-      score_transformation_ = [](float x) {
-        return ClampedLog(x, kLogScoreMinimum);
-      };
-      break;
     case tasks::ScoreCalibrationCalculatorOptions::INVERSE_LOGISTIC:
-      score_transformation_ = [](float x) {
-        return (ClampedLog(x, kLogScoreMinimum) -
-                ClampedLog(1.0 - x, kLogScoreMinimum));
-      };
       break;
     default:
       return CreateStatusWithPayload(
@@ -147,6 +202,21 @@ absl::Status ScoreCalibrationCalculator::Open(CalculatorContext* cc) {
 }
 
 absl::Status ScoreCalibrationCalculator::Process(CalculatorContext* cc) {
+  // Dispatches on the score transformation once per input rather than once
+  // per score.
+  switch (options_.score_transformation()) {
+    case tasks::ScoreCalibrationCalculatorOptions::LOG:
+      return CalibrateScores(cc, LogTransformation);
+    case tasks::ScoreCalibrationCalculatorOptions::INVERSE_LOGISTIC:
+      return CalibrateScores(cc, InverseLogisticTransformation);
+    default:
+      return CalibrateScores(cc, IdentityTransformation);
+  }
+}
+
+template <typename Transformation>
+absl::Status ScoreCalibrationCalculator::CalibrateScores(
+    CalculatorContext* cc, Transformation transformation) {
   RET_CHECK_EQ(kScoresIn(cc)->size(), 1);
   const auto& scores = (*kScoresIn(cc))[0];
   RET_CHECK(scores.element_type() == Tensor::ElementType::kFloat32);
@@ -160,6 +230,7 @@ absl::Status ScoreCalibrationCalculator::Process(CalculatorContext* cc) {
   auto calibrated_scores = &output_tensors->back();
   auto calibrated_scores_view = calibrated_scores->GetCpuWriteView();
   float* raw_calibrated_scores = calibrated_scores_view.buffer<float>();
+  const float default_score = options_.default_score();
 
   if (kIndicesIn(cc).IsConnected()) {
     RET_CHECK_EQ(kIndicesIn(cc)->size(), 1);
@@ -176,11 +247,11 @@ absl::Status ScoreCalibrationCalculator::Process(CalculatorContext* cc) {
     auto indices_view = indices.GetCpuReadView();
     const float* raw_indices = indices_view.buffer<float>();
     for (int i = 0; i < num_scores; ++i) {
-      // Use the "safe" flavor as we need to check that the externally provided
-      // indices are not out-of-bounds.
-      ASSIGN_OR_RETURN(raw_calibrated_scores[i],
-                       SafeComputeCalibratedScore(
-                           static_cast<int>(raw_indices[i]), raw_scores[i]));
+      // The externally provided indices must be checked for out-of-bounds.
+      int index = static_cast<int>(raw_indices[i]);
+      MP_RETURN_IF_ERROR(CheckSigmoidIndex(index));
+      raw_calibrated_scores[i] = CalibrateScore(
+          sigmoids_[index], default_score, transformation, raw_scores[i]);
     }
   } else {
     if (num_scores != options_.sigmoids_size()) {
@@ -192,65 +263,30 @@ absl::Status ScoreCalibrationCalculator::Process(CalculatorContext* cc) {
           MediaPipeTasksStatus::kMetadataInconsistencyError);
     }
     for (int i = 0; i < num_scores; ++i) {
-      // Use the "unsafe" flavor as we have already checked for out-of-bounds
-      // issues.
-      raw_calibrated_scores[i] = ComputeCalibratedScore(i, raw_scores[i]);
+      raw_calibrated_scores[i] = CalibrateScore(sigmoids_[i], default_score,
+                                                transformation, raw_scores[i]);
     }
   }
   kScoresOut(cc).Send(std::move(output_tensors));
   return absl::OkStatus();
 }
 
-float ScoreCalibrationCalculator::ComputeCalibratedScore(int index,
-                                                         float score) {
-  const auto& sigmoid = options_.sigmoids(index);
-
-  bool is_empty =
-      !sigmoid.has_scale() || !sigmoid.has_offset() || !sigmoid.has_slope();
-  bool is_below_min_score =
-      sigmoid.has_min_score() && score < sigmoid.min_score();
-  if (is_empty || is_below_min_score) {
-    return options_.default_score();
-  }
-
-  float transformed_score = score_transformation_(score);
-  float scale_shifted_score =
-      transformed_score * sigmoid.slope() + sigmoid.offset();
-  // For numerical stability use 1 / (1+exp(-x)) when scale_shifted_score >= 0
-  // and exp(x) / (1+exp(x)) when scale_shifted_score < 0.
-  float calibrated_score;
-  if (scale_shifted_score >= 0.0) {
-    calibrated_score =
-        sigmoid.scale() /
-        (1.0 + std::exp(static_cast<double>(-scale_shifted_score)));
-  } else {
-    float score_exp = std::exp(static_cast<double>(scale_shifted_score));
-    calibrated_score = sigmoid.scale() * score_exp / (1.0 + score_exp);
-  }
-  // Scale is non-negative (checked in SigmoidFromLabelAndLine),
-  // thus calibrated_score should be in the range of [0, scale]. However, due to
-  // numberical stability issue, it may fall out of the boundary. Cap the value
-  // to [0, scale] instead.
-  return std::max(std::min(calibrated_score, sigmoid.scale()), 0.0f);
-}
-
-absl::StatusOr<float> ScoreCalibrationCalculator::SafeComputeCalibratedScore(
-    int index, float score) {
+absl::Status ScoreCalibrationCalculator::CheckSigmoidIndex(int index) {
   if (index < 0) {
     return CreateStatusWithPayload(
         StatusCode::kInvalidArgument,
         absl::StrFormat("Expected positive indices, found %d.", index),
         MediaPipeTasksStatus::kInvalidArgumentError);
   }
-  if (index > options_.sigmoids_size()) {
+  if (index >= static_cast<int>(sigmoids_.size())) {
     return CreateStatusWithPayload(
         StatusCode::kInvalidArgument,
         absl::StrFormat("Unable to get score calibration parameters for index "
                         "%d : only %d sigmoids were provided.",
-                        index, options_.sigmoids_size()),
+                        index, sigmoids_.size()),
         MediaPipeTasksStatus::kMetadataInconsistencyError);
   }
-  return ComputeCalibratedScore(index, score);
+  return absl::OkStatus();
 }
 
 MEDIAPIPE_REGISTER_NODE(ScoreCalibrationCalculator);
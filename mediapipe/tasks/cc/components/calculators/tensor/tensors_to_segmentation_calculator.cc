@@ -15,8 +15,10 @@ limitations under the License.
 
 // TODO consolidate TensorsToSegmentationCalculator.
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <memory>
+#include <numeric>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -31,11 +33,13 @@ limitations under the License.
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/tasks/cc/components/calculators/tensor/tensors_to_segmentation_calculator.pb.h"
+#include "mediapipe/tasks/cc/components/containers/proto/run_length_encoded_mask.pb.h"
 #include "mediapipe/tasks/cc/components/proto/segmenter_options.pb.h"
 #include "mediapipe/tasks/cc/vision/utils/image_utils.h"
 #include "mediapipe/util/label_map.pb.h"
@@ -51,6 +55,7 @@ using ::mediapipe::api2::Input;
 using ::mediapipe::api2::Node;
 using ::mediapipe::api2::Output;
 using ::mediapipe::tasks::TensorsToSegmentationCalculatorOptions;
+using ::mediapipe::tasks::components::containers::proto::RunLengthEncodedMask;
 using ::mediapipe::tasks::components::proto::SegmenterOptions;
 using ::mediapipe::tasks::vision::GetImageLikeTensorShape;
 using ::mediapipe::tasks::vision::Shape;
@@ -76,6 +81,32 @@ void Sigmoid(absl::Span<const float> values,
                  [](float value) { return 1. / (1 + std::exp(-value)); });
 }
 
+// Run-length encodes the provided single-channel uint8 mask in row-major order.
+RunLengthEncodedMask RunLengthEncode(const cv::Mat& mask) {
+  RunLengthEncodedMask encoded_mask;
+  encoded_mask.set_width(mask.cols);
+  encoded_mask.set_height(mask.rows);
+  uint8_t run_value = 0;
+  uint32_t run_length = 0;
+  for (int row = 0; row < mask.rows; ++row) {
+    const uint8_t* row_data = mask.ptr<uint8_t>(row);
+    for (int col = 0; col < mask.cols; ++col) {
+      if (run_length > 0 && row_data[col] != run_value) {
+        encoded_mask.add_values(run_value);
+        encoded_mask.add_run_lengths(run_length);
+        run_length = 0;
+      }
+      run_value = row_data[col];
+      ++run_length;
+    }
+  }
+  if (run_length > 0) {
+    encoded_mask.add_values(run_value);
+    encoded_mask.add_run_lengths(run_length);
+  }
+  return encoded_mask;
+}
+
 }  // namespace
 
 // Converts Tensors from a vector of Tensor to Segmentation.
@@ -88,9 +119,16 @@ void Sigmoid(absl::Span<const float> values,
 //            to segmentation masks.
 //   OUTPUT_SIZE(optional): std::pair<int, int>. Height and Width, if provided,
 //            the size to resize masks to.
+//   NORM_RECT(optional): NormalizedRect. The region of interest the input
+//            tensor was extracted from. If provided along with OUTPUT_SIZE,
+//            the masks only cover this region, and are resized to its size
+//            relative to OUTPUT_SIZE.
 //
 // Output:
-//   Segmentation: Segmenation proto.
+//   SEGMENTATION(optional): Image @Multiple. The category mask, or one
+//            confidence mask per selected category.
+//   RLE_CATEGORY_MASK(optional): RunLengthEncodedMask. The category mask,
+//            run-length encoded. Only supported for CATEGORY_MASK.
 //
 // Options:
 //   See tensors_to_segmentation_calculator.proto
@@ -116,16 +154,26 @@ class TensorsToSegmentationCalculator : public Node {
   static constexpr Input<std::vector<Tensor>> kTensorsIn{"TENSORS"};
   static constexpr Input<std::pair<int, int>>::Optional kOutputSizeIn{
       "OUTPUT_SIZE"};
+  static constexpr Input<NormalizedRect>::Optional kNormRectIn{"NORM_RECT"};
   static constexpr Output<Image>::Multiple kSegmentationOut{"SEGMENTATION"};
-  MEDIAPIPE_NODE_CONTRACT(kTensorsIn, kOutputSizeIn, kSegmentationOut);
+  static constexpr Output<RunLengthEncodedMask>::Optional kRleCategoryMaskOut{
+      "RLE_CATEGORY_MASK"};
+  MEDIAPIPE_NODE_CONTRACT(kTensorsIn, kOutputSizeIn, kNormRectIn,
+                          kSegmentationOut, kRleCategoryMaskOut);
 
   absl::Status Open(CalculatorContext* cc);
   absl::Status Process(CalculatorContext* cc);
 
  private:
-  std::vector<Image> GetSegmentationResult(const Shape& input_shape,
-                                           const Shape& output_shape,
-                                           const float* tensors_buffer);
+  // Computes the masks at the resolution of the input tensor: either the single
+  // category mask, or the confidence masks of the categories at
+  // `category_indices`.
+  std::vector<cv::Mat> ComputeMasks(const Shape& input_shape,
+                                    absl::Span<const int> category_indices,
+                                    const float* tensors_buffer);
+
+  // Resizes `mask` to `output_shape` straight into a newly allocated Image.
+  Image ResizeToImage(const cv::Mat& mask, const Shape& output_shape);
 
   TensorsToSegmentationCalculatorOptions options_;
 };
@@ -137,6 +185,11 @@ absl::Status TensorsToSegmentationCalculator::Open(
   RET_CHECK_NE(options_.segmenter_options().output_type(),
                SegmenterOptions::UNSPECIFIED)
       << "Must specify output_type as one of [CONFIDENCE_MASK|CATEGORY_MASK].";
+  if (kRleCategoryMaskOut(cc).IsConnected()) {
+    RET_CHECK_EQ(options_.segmenter_options().output_type(),
+                 SegmenterOptions::CATEGORY_MASK)
+        << "RLE_CATEGORY_MASK requires output_type CATEGORY_MASK.";
+  }
   return absl::OkStatus();
 }
 
@@ -160,25 +213,52 @@ absl::Status TensorsToSegmentationCalculator::Process(
   int output_width = input_shape.width;
   if (cc->Inputs().HasTag("OUTPUT_SIZE")) {
     std::tie(output_width, output_height) = kOutputSizeIn(cc).Get();
+    if (kNormRectIn(cc).IsConnected() && !kNormRectIn(cc).IsEmpty()) {
+      const auto& roi = kNormRectIn(cc).Get();
+      output_width =
+          std::max(1, static_cast<int>(std::round(output_width * roi.width())));
+      output_height = std::max(
+          1, static_cast<int>(std::round(output_height * roi.height())));
+    }
   }
+
+  std::vector<int> category_indices(
+      options_.segmenter_options().category_indices().begin(),
+      options_.segmenter_options().category_indices().end());
+  if (category_indices.empty()) {
+    category_indices.resize(input_shape.channels);
+    std::iota(category_indices.begin(), category_indices.end(), 0);
+  }
+  for (int index : category_indices) {
+    RET_CHECK(index >= 0 && index < input_shape.channels)
+        << "Category index " << index << " is out of range [0, "
+        << input_shape.channels << ").";
+  }
+
+  std::vector<cv::Mat> masks =
+      ComputeMasks(input_shape, category_indices,
+                   input_tensor.GetCpuReadView().buffer<float>());
   Shape output_shape = {
       /* height= */ output_height,
       /* width= */ output_width,
-      /* channels= */ options_.segmenter_options().output_type() ==
-              SegmenterOptions::CATEGORY_MASK
-          ? 1
-          : input_shape.channels};
+      /* channels= */ static_cast<int>(masks.size())};
 
-  std::vector<Image> segmented_masks = GetSegmentationResult(
-      input_shape, output_shape, input_tensor.GetCpuReadView().buffer<float>());
-  for (int i = 0; i < segmented_masks.size(); ++i) {
-    kSegmentationOut(cc)[i].Send(std::move(segmented_masks[i]));
+  if (kRleCategoryMaskOut(cc).IsConnected()) {
+    cv::Mat resized_mask;
+    cv::resize(masks[0], resized_mask, cv::Size(output_width, output_height),
+               0, 0, cv::INTER_NEAREST);
+    kRleCategoryMaskOut(cc).Send(RunLengthEncode(resized_mask));
+  }
+  if (kSegmentationOut(cc).Count() > 0) {
+    for (int i = 0; i < masks.size(); ++i) {
+      kSegmentationOut(cc)[i].Send(ResizeToImage(masks[i], output_shape));
+    }
   }
   return absl::OkStatus();
 }
 
-std::vector<Image> TensorsToSegmentationCalculator::GetSegmentationResult(
-    const Shape& input_shape, const Shape& output_shape,
+std::vector<cv::Mat> TensorsToSegmentationCalculator::ComputeMasks(
+    const Shape& input_shape, absl::Span<const int> category_indices,
     const float* tensors_buffer) {
   std::function<void(absl::Span<const float> values,
                      absl::Span<float> activated_values)>
@@ -199,62 +279,68 @@ std::vector<Image> TensorsToSegmentationCalculator::GetSegmentationResult(
       break;
   }
 
-  const bool is_category_mask = options_.segmenter_options().output_type() ==
-                                SegmenterOptions::CATEGORY_MASK;
-  const int cv_mat_type = is_category_mask ? CV_8UC1 : CV_32FC1;
-  const int output_masks_num = output_shape.channels;
-
-  // TODO Use libyuv for resizing instead.
-  std::vector<cv::Mat> segmented_mask_mats;
-  segmented_mask_mats.reserve(output_masks_num);
-  for (int i = 0; i < output_masks_num; ++i) {
-    segmented_mask_mats.push_back(
-        cv::Mat(input_shape.height, input_shape.width, cv_mat_type));
-  }
-
-  // Applies activation function.
   const int tensor_size = input_shape.height * input_shape.width;
-  if (is_category_mask) {
+  if (options_.segmenter_options().output_type() ==
+      SegmenterOptions::CATEGORY_MASK) {
+    cv::Mat category_mask(input_shape.height, input_shape.width, CV_8UC1);
+    uint8_t* category_mask_data = category_mask.ptr<uint8_t>();
     for (int i = 0; i < tensor_size; ++i) {
       absl::Span<const float> confidence_scores(
           &tensors_buffer[i * input_shape.channels], input_shape.channels);
       const int maximum_category_idx =
           std::max_element(confidence_scores.begin(), confidence_scores.end()) -
           confidence_scores.begin();
-      segmented_mask_mats[0].at<uint8_t>(
-          i / input_shape.width, i % input_shape.width) = maximum_category_idx;
-    }
-  } else {
-    std::vector<float> activated_values(input_shape.channels);
-    absl::Span<float> activated_values_span(activated_values);
-    for (int i = 0; i < tensor_size; ++i) {
-      activation_fn(
-          absl::MakeConstSpan(&tensors_buffer[i * input_shape.channels],
-                              input_shape.channels),
-          activated_values_span);
-      for (int j = 0; j < input_shape.channels; ++j) {
-        segmented_mask_mats[j].at<float>(
-            i / input_shape.width, i % input_shape.width) = activated_values[j];
-      }
+      category_mask_data[i] = maximum_category_idx;
     }
+    return {category_mask};
   }
 
-  std::vector<Image> segmented_masks;
-  segmented_masks.reserve(output_masks_num);
-  // Resizes segmented masks to required output size.
-  for (int i = 0; i < segmented_mask_mats.size(); i++) {
-    // Pre-allocates ImageFrame memory to avoid copying from cv::Mat afterward.
-    ImageFrameSharedPtr image_frame_ptr = std::make_shared<ImageFrame>(
-        is_category_mask ? ImageFormat::GRAY8 : ImageFormat::VEC32F1,
-        output_shape.width, output_shape.height, 1);
-    cv::Mat resized_mask_mat_view =
-        mediapipe::formats::MatView(image_frame_ptr.get());
-    cv::resize(segmented_mask_mats[i], resized_mask_mat_view,
-               resized_mask_mat_view.size(), 0, 0,
-               cv_mat_type == CV_8UC1 ? cv::INTER_NEAREST : cv::INTER_LINEAR);
-    segmented_masks.push_back(Image(image_frame_ptr));
+  std::vector<cv::Mat> confidence_masks;
+  confidence_masks.reserve(category_indices.size());
+  for (int i = 0; i < category_indices.size(); ++i) {
+    confidence_masks.push_back(
+        cv::Mat(input_shape.height, input_shape.width, CV_32FC1));
+  }
+  // Applies activation function.
+  std::vector<float> activated_values(input_shape.channels);
+  absl::Span<float> activated_values_span(activated_values);
+  for (int i = 0; i < tensor_size; ++i) {
+    activation_fn(absl::MakeConstSpan(&tensors_buffer[i * input_shape.channels],
+                                      input_shape.channels),
+                  activated_values_span);
+    for (int j = 0; j < category_indices.size(); ++j) {
+      confidence_masks[j].ptr<float>()[i] =
+          activated_values[category_indices[j]];
+    }
   }
-  return segmented_masks;
+  // Quantizes before resizing, so that no full-resolution float mask is ever
+  // allocated. convertTo() rounds and saturates to [0, 255].
+  if (options_.segmenter_options().quantize_confidence_masks()) {
+    for (cv::Mat& confidence_mask : confidence_masks) {
+      cv::Mat quantized_mask;
+      confidence_mask.convertTo(quantized_mask, CV_8UC1, 255.0);
+      confidence_mask = quantized_mask;
+    }
+  }
+  return confidence_masks;
+}
+
+Image TensorsToSegmentationCalculator::ResizeToImage(
+    const cv::Mat& mask, const Shape& output_shape) {
+  const bool is_uint8_mask = mask.type() == CV_8UC1;
+  // Pre-allocates ImageFrame memory to avoid copying from cv::Mat afterward.
+  ImageFrameSharedPtr image_frame_ptr = std::make_shared<ImageFrame>(
+      is_uint8_mask ? ImageFormat::GRAY8 : ImageFormat::VEC32F1,
+      output_shape.width, output_shape.height, 1);
+  cv::Mat resized_mask_mat_view =
+      mediapipe::formats::MatView(image_frame_ptr.get());
+  // TODO Use libyuv for resizing instead.
+  // Category masks hold indices, which must not be interpolated.
+  const bool is_category_mask = options_.segmenter_options().output_type() ==
+                                SegmenterOptions::CATEGORY_MASK;
+  cv::resize(mask, resized_mask_mat_view, resized_mask_mat_view.size(), 0, 0,
+             is_category_mask ? cv::INTER_NEAREST : cv::INTER_LINEAR);
+  return Image(image_frame_ptr);
 }
 
 MEDIAPIPE_REGISTER_NODE(::mediapipe::tasks::TensorsToSegmentationCalculator);
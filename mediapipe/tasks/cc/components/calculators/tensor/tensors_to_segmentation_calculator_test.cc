@@ -27,6 +27,7 @@ limitations under the License.
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/packet.h"
 #include "mediapipe/framework/port/gmock.h"
@@ -34,6 +35,7 @@ limitations under the License.
 #include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/status_matchers.h"
 #include "mediapipe/tasks/cc/components/calculators/tensor/tensors_to_segmentation_calculator.pb.h"
+#include "mediapipe/tasks/cc/components/containers/proto/run_length_encoded_mask.pb.h"
 
 namespace mediapipe {
 namespace api2 {
@@ -42,6 +44,7 @@ namespace {
 
 using ::mediapipe::Image;
 using ::mediapipe::Tensor;
+using ::mediapipe::tasks::components::containers::proto::RunLengthEncodedMask;
 using ::testing::HasSubstr;
 
 constexpr std::array<float, 4> kTestValues = {0.2, 1.5, -0.6, 3.4};
@@ -374,5 +377,144 @@ TEST(TensorsToSegmentationCalculatorTest, SucceedsCategoryMaskResize) {
                                             expected_index, buffer_indices)));
 }
 
+TEST(TensorsToSegmentationCalculatorTest,
+     SucceedsQuantizedConfidenceMaskForSelectedCategories) {
+  CalculatorRunner runner(
+      mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig::Node>(
+          R"pb(
+            calculator: "mediapipe.tasks.TensorsToSegmentationCalculator"
+            input_stream: "TENSORS:tensors"
+            output_stream: "SEGMENTATION:0:segmented_mask_0"
+            output_stream: "SEGMENTATION:1:segmented_mask_1"
+            options {
+              [mediapipe.tasks.TensorsToSegmentationCalculatorOptions.ext] {
+                segmenter_options {
+                  activation: SOFTMAX
+                  output_type: CONFIDENCE_MASK
+                  category_indices: [ 3, 1 ]
+                  quantize_confidence_masks: true
+                }
+              }
+            }
+          )pb"));
+
+  const int tensor_height = 2;
+  const int tensor_width = 5;
+  PushTensorsToRunner(
+      tensor_height, tensor_width,
+      std::vector<float>(kTestValues.begin(), kTestValues.end()), &runner);
+  MP_ASSERT_OK(runner.Run());
+  ASSERT_EQ(runner.Outputs().NumEntries(), 2);
+  // Softmax confidences 0.82737 and 0.12374, scaled to [0, 255] and rounded.
+  const std::vector<int> buffer_indices = {0, 9};
+  std::vector<Packet> packets = GetPackets(runner);
+  EXPECT_THAT(packets, testing::ElementsAre(
+                           Uint8ImagePacket(tensor_height, tensor_width, 211,
+                                            buffer_indices),
+                           Uint8ImagePacket(tensor_height, tensor_width, 32,
+                                            buffer_indices)));
+}
+
+TEST(TensorsToSegmentationCalculatorTest, FailsOutOfRangeCategoryIndex) {
+  CalculatorRunner runner(
+      mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig::Node>(
+          R"pb(
+            calculator: "mediapipe.tasks.TensorsToSegmentationCalculator"
+            input_stream: "TENSORS:tensors"
+            output_stream: "SEGMENTATION:segmentation"
+            options {
+              [mediapipe.tasks.TensorsToSegmentationCalculatorOptions.ext] {
+                segmenter_options {
+                  activation: NONE
+                  output_type: CONFIDENCE_MASK
+                  category_indices: 4
+                }
+              }
+            }
+          )pb"));
+
+  PushTensorsToRunner(
+      /*tensor_height=*/1, /*tensor_width=*/1,
+      std::vector<float>(kTestValues.begin(), kTestValues.end()), &runner);
+  absl::Status status = runner.Run();
+  EXPECT_FALSE(status.ok());
+  EXPECT_THAT(status.message(),
+              HasSubstr("Category index 4 is out of range [0, 4)"));
+}
+
+TEST(TensorsToSegmentationCalculatorTest,
+     SucceedsRunLengthEncodedCategoryMaskWithRegionOfInterest) {
+  CalculatorRunner runner(
+      mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig::Node>(
+          R"pb(
+            calculator: "mediapipe.tasks.TensorsToSegmentationCalculator"
+            input_stream: "TENSORS:tensors"
+            input_stream: "OUTPUT_SIZE:size"
+            input_stream: "NORM_RECT:roi"
+            output_stream: "RLE_CATEGORY_MASK:rle_category_mask"
+            options {
+              [mediapipe.tasks.TensorsToSegmentationCalculatorOptions.ext] {
+                segmenter_options {
+                  activation: NONE
+                  output_type: CATEGORY_MASK
+                  run_length_encode_category_mask: true
+                }
+              }
+            }
+          )pb"));
+
+  PushTensorsToRunner(
+      /*tensor_height=*/1, /*tensor_width=*/4,
+      std::vector<float>(kTestValues.begin(), kTestValues.end()), &runner);
+  runner.MutableInputs()
+      ->Tag("OUTPUT_SIZE")
+      .packets.push_back(mediapipe::MakePacket<std::pair<int, int>>(
+                             std::make_pair(/*width=*/8, /*height=*/4))
+                             .At(Timestamp(0)));
+  // The region of interest covers half of the image in each dimension.
+  NormalizedRect roi;
+  roi.set_x_center(0.5);
+  roi.set_y_center(0.5);
+  roi.set_width(0.5);
+  roi.set_height(0.5);
+  runner.MutableInputs()->Tag("NORM_RECT").packets.push_back(
+      mediapipe::MakePacket<NormalizedRect>(roi).At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& rle_packets = runner.Outputs().Tag("RLE_CATEGORY_MASK").packets;
+  ASSERT_EQ(rle_packets.size(), 1);
+  // Largest element index is 3, for all the 4x2 pixels of the mask.
+  EXPECT_THAT(rle_packets[0].Get<RunLengthEncodedMask>(),
+              EqualsProto(ParseTextProtoOrDie<RunLengthEncodedMask>(
+                  R"pb(width: 4 height: 2 values: 3 run_lengths: 8)pb")));
+}
+
+TEST(TensorsToSegmentationCalculatorTest,
+     FailsRunLengthEncodedConfidenceMask) {
+  CalculatorRunner runner(
+      mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig::Node>(
+          R"pb(
+            calculator: "mediapipe.tasks.TensorsToSegmentationCalculator"
+            input_stream: "TENSORS:tensors"
+            output_stream: "RLE_CATEGORY_MASK:rle_category_mask"
+            options {
+              [mediapipe.tasks.TensorsToSegmentationCalculatorOptions.ext] {
+                segmenter_options {
+                  activation: NONE
+                  output_type: CONFIDENCE_MASK
+                }
+              }
+            }
+          )pb"));
+
+  PushTensorsToRunner(
+      /*tensor_height=*/1, /*tensor_width=*/1,
+      std::vector<float>(kTestValues.begin(), kTestValues.end()), &runner);
+  absl::Status status = runner.Run();
+  EXPECT_FALSE(status.ok());
+  EXPECT_THAT(status.message(),
+              HasSubstr("requires output_type CATEGORY_MASK"));
+}
+
 }  // namespace api2
 }  // namespace mediapipe
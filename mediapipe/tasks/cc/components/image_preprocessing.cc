@@ -148,10 +148,13 @@ absl::Status ConfigureImagePreprocessing(const ModelResources& model_resources,
 }
 
 Source<Image> AddDataConverter(Source<Image> image_in, Graph& graph,
-                               bool output_on_gpu) {
+                               bool output_on_gpu,
+                               bool use_preprocessing_cache) {
   auto& image_converter = graph.AddNode("ImageCloneCalculator");
-  image_converter.GetOptions<mediapipe::ImageCloneCalculatorOptions>()
-      .set_output_on_gpu(output_on_gpu);
+  auto& image_converter_options =
+      image_converter.GetOptions<mediapipe::ImageCloneCalculatorOptions>();
+  image_converter_options.set_output_on_gpu(output_on_gpu);
+  image_converter_options.set_use_preprocessing_cache(use_preprocessing_cache);
   image_in >> image_converter.In("");
   return image_converter[Output<Image>("")];
 }
@@ -227,18 +230,23 @@ class ImagePreprocessingSubgraph : public Subgraph {
       Source<NormalizedRect> norm_rect_in, Graph& graph) {
     // Convert image to tensor.
     auto& image_to_tensor = graph.AddNode("ImageToTensorCalculator");
-    image_to_tensor.GetOptions<mediapipe::ImageToTensorCalculatorOptions>()
-        .CopyFrom(options.image_to_tensor_options());
+    auto& image_to_tensor_options =
+        image_to_tensor.GetOptions<mediapipe::ImageToTensorCalculatorOptions>();
+    image_to_tensor_options.CopyFrom(options.image_to_tensor_options());
+    image_to_tensor_options.set_use_preprocessing_cache(
+        options.use_preprocessing_cache());
     switch (options.backend()) {
       case ImagePreprocessingOptions::CPU_BACKEND: {
         auto cpu_image =
-            AddDataConverter(image_in, graph, /*output_on_gpu=*/false);
+            AddDataConverter(image_in, graph, /*output_on_gpu=*/false,
+                             options.use_preprocessing_cache());
         cpu_image >> image_to_tensor.In(kImageTag);
         break;
       }
       case ImagePreprocessingOptions::GPU_BACKEND: {
         auto gpu_image =
-            AddDataConverter(image_in, graph, /*output_on_gpu=*/true);
+            AddDataConverter(image_in, graph, /*output_on_gpu=*/true,
+                             options.use_preprocessing_cache());
         gpu_image >> image_to_tensor.In(kImageTag);
         break;
       }
@@ -15,6 +15,7 @@ limitations under the License.
 #include "mediapipe/tasks/cc/components/text_preprocessing_graph.h"
 
 #include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -25,6 +26,7 @@ limitations under the License.
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/subgraph.h"
+#include "mediapipe/framework/tool/tag_map.h"
 #include "mediapipe/tasks/cc/components/proto/text_preprocessing_graph_options.pb.h"
 #include "mediapipe/tasks/cc/core/model_resources.h"
 #include "mediapipe/tasks/cc/metadata/metadata_extractor.h"
@@ -46,6 +48,7 @@ using ::mediapipe::tasks::core::ModelResources;
 using ::mediapipe::tasks::metadata::ModelMetadataExtractor;
 
 constexpr char kTextTag[] = "TEXT";
+constexpr char kTextsTag[] = "TEXTS";
 constexpr char kMetadataExtractorTag[] = "METADATA_EXTRACTOR";
 constexpr char kTensorsTag[] = "TENSORS";
 
@@ -202,11 +205,14 @@ absl::Status ConfigureTextPreprocessingSubgraph(
 
 // A "mediapipe.tasks.components.TextPreprocessingSubgraph" performs text
 // preprocessing.
-// - Accepts a std::string input and outputs CPU tensors.
+// - Accepts a std::string input, or a batch of them, and outputs CPU tensors.
 //
 // Inputs:
-//   TEXT - std::string
+//   TEXT - std::string @Optional
 //     The text to preprocess.
+//   TEXTS - std::vector<std::string> @Optional
+//     A batch of texts to preprocess into one batch of tensors. Exactly one of
+//     TEXT and TEXTS must be connected. Not supported by STRING_PREPROCESSOR.
 // Side inputs:
 //   METADATA_EXTRACTOR - ModelMetadataExtractor
 //     The metadata extractor for the TFLite model. Used to determine the order
@@ -223,11 +229,14 @@ class TextPreprocessingSubgraph : public mediapipe::Subgraph {
   absl::StatusOr<mediapipe::CalculatorGraphConfig> GetConfig(
       mediapipe::SubgraphContext* sc) override {
     Graph graph;
+    ASSIGN_OR_RETURN(auto input_tags,
+                     tool::TagMap::Create(sc->OriginalNode().input_stream()));
+    const bool batched = input_tags->HasTag(kTextsTag);
     ASSIGN_OR_RETURN(
         Source<std::vector<Tensor>> tensors_in,
         BuildTextPreprocessing(
-            sc->Options<TextPreprocessingGraphOptions>(),
-            graph[Input<std::string>(kTextTag)],
+            sc->Options<TextPreprocessingGraphOptions>(), batched,
+            batched ? graph.In(kTextsTag) : graph.In(kTextTag),
             graph[SideInput<ModelMetadataExtractor>(kMetadataExtractorTag)],
             graph));
     tensors_in >> graph[Output<std::vector<Tensor>>(kTensorsTag)];
@@ -235,8 +244,10 @@ class TextPreprocessingSubgraph : public mediapipe::Subgraph {
   }
 
  private:
+  // Preprocesses `text_in`, which is a batch of texts if `batched`.
   absl::StatusOr<Source<std::vector<Tensor>>> BuildTextPreprocessing(
-      const TextPreprocessingGraphOptions& options, Source<std::string> text_in,
+      const TextPreprocessingGraphOptions& options, bool batched,
+      Source<> text_in,
       SideSource<ModelMetadataExtractor> metadata_extractor_in, Graph& graph) {
     ASSIGN_OR_RETURN(
         std::string preprocessor_name,
@@ -245,24 +256,34 @@ class TextPreprocessingSubgraph : public mediapipe::Subgraph {
     switch (options.preprocessor_type()) {
       case TextPreprocessingGraphOptions::UNSPECIFIED_PREPROCESSOR:
       case TextPreprocessingGraphOptions::STRING_PREPROCESSOR: {
+        if (batched) {
+          return CreateStatusWithPayload(
+              absl::StatusCode::kInvalidArgument,
+              "Batches of texts are not supported by the string preprocessor",
+              MediaPipeTasksStatus::kInvalidArgumentError);
+        }
         break;
       }
       case TextPreprocessingGraphOptions::BERT_PREPROCESSOR: {
-        text_preprocessor.GetOptions<BertPreprocessorCalculatorOptions>()
-            .set_bert_max_seq_len(options.max_seq_len());
+        auto& bert_options =
+            text_preprocessor.GetOptions<BertPreprocessorCalculatorOptions>();
+        bert_options.set_bert_max_seq_len(options.max_seq_len());
+        bert_options.set_cache_size(options.cache_size());
         metadata_extractor_in >>
             text_preprocessor.SideIn(kMetadataExtractorTag);
         break;
       }
       case TextPreprocessingGraphOptions::REGEX_PREPROCESSOR: {
-        text_preprocessor.GetOptions<RegexPreprocessorCalculatorOptions>()
-            .set_max_seq_len(options.max_seq_len());
+        auto& regex_options =
+            text_preprocessor.GetOptions<RegexPreprocessorCalculatorOptions>();
+        regex_options.set_max_seq_len(options.max_seq_len());
+        regex_options.set_cache_size(options.cache_size());
         metadata_extractor_in >>
             text_preprocessor.SideIn(kMetadataExtractorTag);
         break;
       }
     }
-    text_in >> text_preprocessor.In(kTextTag);
+    text_in >> text_preprocessor.In(batched ? kTextsTag : kTextTag);
     return text_preprocessor[Output<std::vector<Tensor>>(kTensorsTag)];
   }
 };
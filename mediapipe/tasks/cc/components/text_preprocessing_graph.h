@@ -22,7 +22,7 @@ limitations under the License.
 
 // Configures a TextPreprocessing subgraph using the provided `model_resources`
 // and TextPreprocessingGraphOptions.
-// - Accepts a std::string input and outputs CPU tensors.
+// - Accepts a std::string input, or a batch of them, and outputs CPU tensors.
 //
 // Example usage:
 //
@@ -34,8 +34,12 @@ limitations under the License.
 //
 // The resulting TextPreprocessing subgraph has the following I/O:
 // Inputs:
-//   TEXT - std::string
+//   TEXT - std::string @Optional
 //     The text to preprocess.
+//   TEXTS - std::vector<std::string> @Optional
+//     A batch of texts to preprocess into one batch of tensors, e.g. for a
+//     model resized to that batch size. Exactly one of TEXT and TEXTS must be
+//     connected.
 // Side inputs:
 //   METADATA_EXTRACTOR - ModelMetadataExtractor
 //     The metadata extractor for the TFLite model. Used to determine the order
@@ -15,14 +15,27 @@ limitations under the License.
 
 #include "mediapipe/tasks/cc/components/utils/cosine_similarity.h"
 
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/tasks/cc/common.h"
 #include "mediapipe/tasks/cc/components/containers/proto/embeddings.pb.h"
 
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 namespace mediapipe {
 namespace tasks {
 namespace components {
@@ -32,32 +45,188 @@ namespace {
 
 using ::mediapipe::tasks::components::containers::proto::EmbeddingEntry;
 
-template <typename T>
-absl::StatusOr<double> ComputeCosineSimilarity(const T& u, const T& v,
-                                               int num_elements) {
+// Returns the dot product of `u` and `v`, and the squared L2-norm of `v`.
+std::pair<double, double> DotAndSquaredNorm(const float* u, const float* v,
+                                            int num_elements) {
+  int i = 0;
+  double dot_product = 0.0;
+  double norm_v = 0.0;
+#if defined(__AVX512F__)
+  __m512 dot_product16 = _mm512_setzero_ps();
+  __m512 norm_v16 = _mm512_setzero_ps();
+  for (; i + 16 <= num_elements; i += 16) {
+    const __m512 u16 = _mm512_loadu_ps(u + i);
+    const __m512 v16 = _mm512_loadu_ps(v + i);
+    dot_product16 = _mm512_fmadd_ps(u16, v16, dot_product16);
+    norm_v16 = _mm512_fmadd_ps(v16, v16, norm_v16);
+  }
+  dot_product += _mm512_reduce_add_ps(dot_product16);
+  norm_v += _mm512_reduce_add_ps(norm_v16);
+#endif
+#if defined(__AVX2__)
+  __m256 dot_product8 = _mm256_setzero_ps();
+  __m256 norm_v8 = _mm256_setzero_ps();
+  for (; i + 8 <= num_elements; i += 8) {
+    const __m256 u8 = _mm256_loadu_ps(u + i);
+    const __m256 v8 = _mm256_loadu_ps(v + i);
+#if defined(__FMA__)
+    dot_product8 = _mm256_fmadd_ps(u8, v8, dot_product8);
+    norm_v8 = _mm256_fmadd_ps(v8, v8, norm_v8);
+#else
+    dot_product8 = _mm256_add_ps(dot_product8, _mm256_mul_ps(u8, v8));
+    norm_v8 = _mm256_add_ps(norm_v8, _mm256_mul_ps(v8, v8));
+#endif
+  }
+  float dot_product_lanes[8];
+  float norm_v_lanes[8];
+  _mm256_storeu_ps(dot_product_lanes, dot_product8);
+  _mm256_storeu_ps(norm_v_lanes, norm_v8);
+  for (int lane = 0; lane < 8; ++lane) {
+    dot_product += dot_product_lanes[lane];
+    norm_v += norm_v_lanes[lane];
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  float32x4_t dot_product4 = vdupq_n_f32(0.0f);
+  float32x4_t norm_v4 = vdupq_n_f32(0.0f);
+  for (; i + 4 <= num_elements; i += 4) {
+    const float32x4_t u4 = vld1q_f32(u + i);
+    const float32x4_t v4 = vld1q_f32(v + i);
+    dot_product4 = vmlaq_f32(dot_product4, u4, v4);
+    norm_v4 = vmlaq_f32(norm_v4, v4, v4);
+  }
+  float dot_product_lanes[4];
+  float norm_v_lanes[4];
+  vst1q_f32(dot_product_lanes, dot_product4);
+  vst1q_f32(norm_v_lanes, norm_v4);
+  for (int lane = 0; lane < 4; ++lane) {
+    dot_product += dot_product_lanes[lane];
+    norm_v += norm_v_lanes[lane];
+  }
+#endif
+  for (; i < num_elements; ++i) {
+    dot_product += u[i] * v[i];
+    norm_v += v[i] * v[i];
+  }
+  return {dot_product, norm_v};
+}
+
+// Returns the dot product of `u` and `v`, and the squared L2-norm of `v`.
+// Products are accumulated exactly as integers.
+std::pair<double, double> DotAndSquaredNorm(const int8_t* u, const int8_t* v,
+                                            int num_elements) {
+  int i = 0;
+  int64_t dot_product = 0;
+  int64_t norm_v = 0;
+#if defined(__AVX2__)
+  // Sign-extends 16 values at a time to 16 bits, and sums adjacent products
+  // into 32-bit lanes.
+  __m256i dot_product8 = _mm256_setzero_si256();
+  __m256i norm_v8 = _mm256_setzero_si256();
+  for (; i + 16 <= num_elements; i += 16) {
+    const __m256i u16 = _mm256_cvtepi8_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(u + i)));
+    const __m256i v16 = _mm256_cvtepi8_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i)));
+    dot_product8 =
+        _mm256_add_epi32(dot_product8, _mm256_madd_epi16(u16, v16));
+    norm_v8 = _mm256_add_epi32(norm_v8, _mm256_madd_epi16(v16, v16));
+  }
+  int32_t dot_product_lanes[8];
+  int32_t norm_v_lanes[8];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(dot_product_lanes),
+                      dot_product8);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(norm_v_lanes), norm_v8);
+  for (int lane = 0; lane < 8; ++lane) {
+    dot_product += dot_product_lanes[lane];
+    norm_v += norm_v_lanes[lane];
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  // Widens 8 products at a time to 16 bits, and sums adjacent products into
+  // 32-bit lanes.
+  int32x4_t dot_product4 = vdupq_n_s32(0);
+  int32x4_t norm_v4 = vdupq_n_s32(0);
+  for (; i + 8 <= num_elements; i += 8) {
+    const int8x8_t u8 = vld1_s8(u + i);
+    const int8x8_t v8 = vld1_s8(v + i);
+    dot_product4 = vpadalq_s16(dot_product4, vmull_s8(u8, v8));
+    norm_v4 = vpadalq_s16(norm_v4, vmull_s8(v8, v8));
+  }
+  int32_t dot_product_lanes[4];
+  int32_t norm_v_lanes[4];
+  vst1q_s32(dot_product_lanes, dot_product4);
+  vst1q_s32(norm_v_lanes, norm_v4);
+  for (int lane = 0; lane < 4; ++lane) {
+    dot_product += dot_product_lanes[lane];
+    norm_v += norm_v_lanes[lane];
+  }
+#endif
+  for (; i < num_elements; ++i) {
+    dot_product += static_cast<int32_t>(u[i]) * v[i];
+    norm_v += static_cast<int32_t>(v[i]) * v[i];
+  }
+  return {static_cast<double>(dot_product), static_cast<double>(norm_v)};
+}
+
+absl::Status CheckNotEmpty(int num_elements) {
   if (num_elements <= 0) {
     return CreateStatusWithPayload(
         absl::StatusCode::kInvalidArgument,
         "Cannot compute cosing similarity on empty embeddings",
         MediaPipeTasksStatus::kInvalidArgumentError);
   }
-  double dot_product = 0.0;
-  double norm_u = 0.0;
-  double norm_v = 0.0;
-  for (int i = 0; i < num_elements; ++i) {
-    dot_product += u[i] * v[i];
-    norm_u += u[i] * u[i];
-    norm_v += v[i] * v[i];
-  }
-  if (norm_u <= 0.0 || norm_v <= 0.0) {
+  return absl::OkStatus();
+}
+
+absl::Status CheckNonZeroNorm(double norm) {
+  if (norm <= 0.0) {
     return CreateStatusWithPayload(
         absl::StatusCode::kInvalidArgument,
         "Cannot compute cosine similarity on embedding with 0 norm",
         MediaPipeTasksStatus::kInvalidArgumentError);
   }
+  return absl::OkStatus();
+}
+
+template <typename T>
+absl::StatusOr<double> ComputeCosineSimilarity(const T* u, const T* v,
+                                               int num_elements) {
+  MP_RETURN_IF_ERROR(CheckNotEmpty(num_elements));
+  const double norm_u = DotAndSquaredNorm(u, u, num_elements).second;
+  const auto [dot_product, norm_v] = DotAndSquaredNorm(u, v, num_elements);
+  MP_RETURN_IF_ERROR(CheckNonZeroNorm(norm_u));
+  MP_RETURN_IF_ERROR(CheckNonZeroNorm(norm_v));
   return dot_product / std::sqrt(norm_u * norm_v);
 }
 
+template <typename T>
+absl::StatusOr<std::vector<double>> ComputeCosineSimilarityBatch(
+    absl::Span<const T> query, absl::Span<const T> references) {
+  const int num_elements = query.size();
+  MP_RETURN_IF_ERROR(CheckNotEmpty(num_elements));
+  if (references.size() % num_elements != 0) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        absl::StrFormat("Cannot compute cosine similarity between embeddings "
+                        "of different sizes (references size %d is not a "
+                        "multiple of query size %d)",
+                        references.size(), num_elements),
+        MediaPipeTasksStatus::kInvalidArgumentError);
+  }
+  // The query norm is computed once, and each reference norm along with its
+  // dot product with the query, in a single pass over the reference.
+  const double norm_query =
+      DotAndSquaredNorm(query.data(), query.data(), num_elements).second;
+  MP_RETURN_IF_ERROR(CheckNonZeroNorm(norm_query));
+  std::vector<double> similarities(references.size() / num_elements);
+  for (size_t i = 0; i < similarities.size(); ++i) {
+    const auto [dot_product, norm_reference] = DotAndSquaredNorm(
+        query.data(), references.data() + i * num_elements, num_elements);
+    MP_RETURN_IF_ERROR(CheckNonZeroNorm(norm_reference));
+    similarities[i] = dot_product / std::sqrt(norm_query * norm_reference);
+  }
+  return similarities;
+}
+
 }  // namespace
 
 // Utility function to compute cosine similarity [1] between two embedding
@@ -106,6 +275,16 @@ absl::StatusOr<double> CosineSimilarity(const EmbeddingEntry& u,
       MediaPipeTasksStatus::kInvalidArgumentError);
 }
 
+absl::StatusOr<std::vector<double>> CosineSimilarityBatch(
+    absl::Span<const float> query, absl::Span<const float> references) {
+  return ComputeCosineSimilarityBatch(query, references);
+}
+
+absl::StatusOr<std::vector<double>> CosineSimilarityBatch(
+    absl::Span<const int8_t> query, absl::Span<const int8_t> references) {
+  return ComputeCosineSimilarityBatch(query, references);
+}
+
 }  // namespace utils
 }  // namespace components
 }  // namespace tasks
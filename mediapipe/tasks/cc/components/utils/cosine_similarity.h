@@ -16,7 +16,11 @@ limitations under the License.
 #ifndef MEDIAPIPE_TASKS_CC_COMPONENTS_UTILS_COSINE_SIMILARITY_H_
 #define MEDIAPIPE_TASKS_CC_COMPONENTS_UTILS_COSINE_SIMILARITY_H_
 
+#include <cstdint>
+#include <vector>
+
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "mediapipe/tasks/cc/components/containers/proto/embeddings.pb.h"
 
 namespace mediapipe {
@@ -34,6 +38,17 @@ absl::StatusOr<double> CosineSimilarity(
     const containers::proto::EmbeddingEntry& u,
     const containers::proto::EmbeddingEntry& v);
 
+// Computes the cosine similarity between `query` and each of the embeddings
+// stored contiguously, one after the other, in `references`, e.g. to match an
+// embedder output against a gallery of known embeddings. Returns one
+// similarity per reference embedding, in order. May return an
+// InvalidArgumentError if e.g. the query is empty, the size of `references`
+// is not a multiple of the query size, or an embedding has an L2-norm of 0.
+absl::StatusOr<std::vector<double>> CosineSimilarityBatch(
+    absl::Span<const float> query, absl::Span<const float> references);
+absl::StatusOr<std::vector<double>> CosineSimilarityBatch(
+    absl::Span<const int8_t> query, absl::Span<const int8_t> references);
+
 }  // namespace utils
 }  // namespace components
 }  // namespace tasks
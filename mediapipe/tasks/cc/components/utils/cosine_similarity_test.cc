@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "mediapipe/tasks/cc/components/utils/cosine_similarity.h"
 
+#include <cmath>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -104,6 +105,75 @@ TEST(CosineSimilarity, SucceedsWithQuantizedEntries) {
   EXPECT_EQ(result, -1);
 }
 
+TEST(CosineSimilarityBatch, FailsWithMismatchedSizes) {
+  const std::vector<float> query = {0.1, 0.2};
+  const std::vector<float> references = {0.1, 0.2, 0.3};
+
+  auto status = CosineSimilarityBatch(query, references);
+
+  EXPECT_EQ(status.status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.status().message(),
+              HasSubstr("Cannot compute cosine similarity between embeddings "
+                        "of different sizes"));
+}
+
+TEST(CosineSimilarityBatch, FailsWithZeroNormReference) {
+  const std::vector<float> query = {0.1, 0.2};
+  const std::vector<float> references = {0.1, 0.2, 0.0, 0.0};
+
+  auto status = CosineSimilarityBatch(query, references);
+
+  EXPECT_EQ(status.status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(
+      status.status().message(),
+      HasSubstr("Cannot compute cosine similarity on embedding with 0 norm"));
+}
+
+TEST(CosineSimilarityBatch, MatchesPairwiseWithFloatEmbeddings) {
+  // A size that exercises both the vectorized loops and their tails.
+  constexpr int kNumElements = 37;
+  constexpr int kNumReferences = 5;
+  std::vector<float> query(kNumElements);
+  std::vector<float> references(kNumElements * kNumReferences);
+  for (int i = 0; i < kNumElements; ++i) {
+    query[i] = (i % 7) - 3.0f;
+  }
+  for (int i = 0; i < references.size(); ++i) {
+    references[i] = (i % 11) * 0.25f - 1.0f;
+  }
+
+  MP_ASSERT_OK_AND_ASSIGN(auto similarities,
+                          CosineSimilarityBatch(query, references));
+
+  ASSERT_EQ(similarities.size(), kNumReferences);
+  for (int r = 0; r < kNumReferences; ++r) {
+    MP_ASSERT_OK_AND_ASSIGN(
+        double expected,
+        CosineSimilarity(
+            BuildFloatEntry(query),
+            BuildFloatEntry({references.begin() + r * kNumElements,
+                             references.begin() + (r + 1) * kNumElements})));
+    EXPECT_NEAR(similarities[r], expected, 1e-6);
+  }
+}
+
+TEST(CosineSimilarityBatch, SucceedsWithQuantizedEmbeddings) {
+  // 20 elements exercise both the vectorized loops and their tails.
+  std::vector<int8_t> query(20, 0);
+  query[0] = 127;
+  std::vector<int8_t> references(40, 0);
+  references[0] = -128;
+  references[20] = 5;
+  references[39] = 5;
+
+  MP_ASSERT_OK_AND_ASSIGN(auto similarities,
+                          CosineSimilarityBatch(query, references));
+
+  ASSERT_EQ(similarities.size(), 2);
+  EXPECT_EQ(similarities[0], -1);
+  EXPECT_NEAR(similarities[1], std::sqrt(0.5), 1e-12);
+}
+
 }  // namespace
 }  // namespace utils
 }  // namespace components
@@ -0,0 +1,406 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/components/utils/embedding_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/tasks/cc/common.h"
+#include "mediapipe/tasks/cc/components/utils/cosine_similarity.h"
+#include "mediapipe/tasks/cc/core/external_file_handler.h"
+#include "mediapipe/tasks/cc/core/proto/external_file.pb.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace components {
+namespace utils {
+
+namespace {
+
+// The serialized index is a header followed by the centroids, the cluster
+// offsets, the ids and the embeddings, each section starting on an 8-byte
+// boundary.
+constexpr char kMagic[4] = {'M', 'P', 'E', 'I'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kAlignment = 8;
+
+struct Header {
+  char magic[4];
+  uint32_t version;
+  uint32_t element_type;
+  uint32_t dimension;
+  int64_t num_embeddings;
+  int64_t num_clusters;
+};
+
+size_t Align(size_t size) {
+  return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+template <typename T>
+void AppendSection(const T* data, size_t count, std::string& buffer) {
+  buffer.append(reinterpret_cast<const char*>(data), count * sizeof(T));
+  buffer.resize(Align(buffer.size()), '\0');
+}
+
+absl::Status InvalidArgumentError(absl::string_view message) {
+  return CreateStatusWithPayload(absl::StatusCode::kInvalidArgument, message,
+                                 MediaPipeTasksStatus::kInvalidArgumentError);
+}
+
+std::vector<float> ToFloat(absl::Span<const float> values) {
+  return {values.begin(), values.end()};
+}
+
+std::vector<float> ToFloat(absl::Span<const int8_t> values) {
+  return {values.begin(), values.end()};
+}
+
+// Scales `values` to an L2-norm of 1, if not 0. Returns false if it is 0.
+bool Normalize(absl::Span<float> values) {
+  double squared_norm = 0.0;
+  for (const float value : values) squared_norm += value * value;
+  if (squared_norm <= 0.0) return false;
+  const float inverse_norm = 1.0 / std::sqrt(squared_norm);
+  for (float& value : values) value *= inverse_norm;
+  return true;
+}
+
+// Returns the index of the most similar of the `num_centroids` centroids.
+absl::StatusOr<int> FindClosestCentroid(absl::Span<const float> embedding,
+                                        absl::Span<const float> centroids) {
+  ASSIGN_OR_RETURN(std::vector<double> similarities,
+                   CosineSimilarityBatch(embedding, centroids));
+  return std::max_element(similarities.begin(), similarities.end()) -
+         similarities.begin();
+}
+
+// Trains `num_clusters` L2-normalized centroids on the given L2-normalized
+// samples with spherical k-means.
+absl::StatusOr<std::vector<float>> TrainCentroids(
+    const std::vector<float>& samples, int dimension, int num_clusters,
+    int num_iterations) {
+  const int num_samples = samples.size() / dimension;
+  // The samples are shuffled, so the first ones are a random initialization.
+  std::vector<float> centroids(samples.begin(),
+                               samples.begin() + num_clusters * dimension);
+  std::vector<double> sums(centroids.size());
+  for (int iteration = 0; iteration < num_iterations; ++iteration) {
+    std::fill(sums.begin(), sums.end(), 0.0);
+    for (int i = 0; i < num_samples; ++i) {
+      absl::Span<const float> sample(samples.data() + i * dimension,
+                                     dimension);
+      ASSIGN_OR_RETURN(int cluster, FindClosestCentroid(sample, centroids));
+      for (int j = 0; j < dimension; ++j) {
+        sums[cluster * dimension + j] += sample[j];
+      }
+    }
+    for (int c = 0; c < num_clusters; ++c) {
+      std::vector<float> centroid(sums.begin() + c * dimension,
+                                  sums.begin() + (c + 1) * dimension);
+      // Clusters left empty keep their previous centroid.
+      if (Normalize(absl::MakeSpan(centroid))) {
+        std::copy(centroid.begin(), centroid.end(),
+                  centroids.begin() + c * dimension);
+      }
+    }
+  }
+  return centroids;
+}
+
+}  // namespace
+
+/* static */
+absl::StatusOr<std::unique_ptr<EmbeddingIndex>> EmbeddingIndex::Build(
+    absl::Span<const int64_t> ids, absl::Span<const float> embeddings,
+    const BuildOptions& options) {
+  return BuildFromSpans(ids, embeddings, ElementType::kFloat32, options);
+}
+
+/* static */
+absl::StatusOr<std::unique_ptr<EmbeddingIndex>> EmbeddingIndex::Build(
+    absl::Span<const int64_t> ids, absl::Span<const int8_t> embeddings,
+    const BuildOptions& options) {
+  return BuildFromSpans(ids, embeddings, ElementType::kInt8, options);
+}
+
+template <typename T>
+absl::StatusOr<std::unique_ptr<EmbeddingIndex>> EmbeddingIndex::BuildFromSpans(
+    absl::Span<const int64_t> ids, absl::Span<const T> embeddings,
+    ElementType element_type, const BuildOptions& options) {
+  const int64_t num_embeddings = ids.size();
+  if (num_embeddings == 0 || embeddings.size() % num_embeddings != 0 ||
+      embeddings.empty()) {
+    return InvalidArgumentError(absl::StrFormat(
+        "Cannot build an embedding index from %d ids and %d embedding "
+        "values",
+        num_embeddings, embeddings.size()));
+  }
+  const int dimension = embeddings.size() / num_embeddings;
+  auto embedding = [&](int64_t i) {
+    return embeddings.subspan(i * dimension, dimension);
+  };
+  const int num_clusters = std::min<int64_t>(
+      num_embeddings,
+      options.num_clusters > 0
+          ? options.num_clusters
+          : std::max<int>(1, std::sqrt(static_cast<double>(num_embeddings))));
+
+  // Samples the embeddings to train the centroids on.
+  std::vector<int64_t> sample_indices(num_embeddings);
+  std::iota(sample_indices.begin(), sample_indices.end(), 0);
+  std::mt19937 random(options.seed);
+  std::shuffle(sample_indices.begin(), sample_indices.end(), random);
+  sample_indices.resize(std::min<int64_t>(
+      num_embeddings,
+      std::max<int64_t>(num_clusters,
+                        static_cast<int64_t>(num_clusters) *
+                            options.max_training_samples_per_cluster)));
+  std::vector<float> samples;
+  samples.reserve(sample_indices.size() * dimension);
+  for (const int64_t i : sample_indices) {
+    std::vector<float> sample = ToFloat(embedding(i));
+    if (!Normalize(absl::MakeSpan(sample))) {
+      return InvalidArgumentError(absl::StrFormat(
+          "Cannot index embedding %d with 0 norm", ids[i]));
+    }
+    samples.insert(samples.end(), sample.begin(), sample.end());
+  }
+  ASSIGN_OR_RETURN(std::vector<float> centroids,
+                   TrainCentroids(samples, dimension, num_clusters,
+                                  options.num_iterations));
+
+  // Assigns each embedding to its closest centroid, and groups the embeddings
+  // by cluster.
+  std::vector<int> clusters(num_embeddings);
+  std::vector<int64_t> offsets(num_clusters + 1, 0);
+  for (int64_t i = 0; i < num_embeddings; ++i) {
+    const std::vector<float> float_embedding = ToFloat(embedding(i));
+    auto status_or_cluster = FindClosestCentroid(float_embedding, centroids);
+    if (!status_or_cluster.ok()) {
+      return InvalidArgumentError(absl::StrFormat(
+          "Cannot index embedding %d: %s", ids[i],
+          status_or_cluster.status().message()));
+    }
+    clusters[i] = *status_or_cluster;
+    ++offsets[clusters[i] + 1];
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  std::vector<int64_t> grouped_ids(num_embeddings);
+  std::vector<T> grouped_embeddings(embeddings.size());
+  std::vector<int64_t> positions(offsets.begin(), offsets.end() - 1);
+  for (int64_t i = 0; i < num_embeddings; ++i) {
+    const int64_t position = positions[clusters[i]]++;
+    grouped_ids[position] = ids[i];
+    std::copy(embedding(i).begin(), embedding(i).end(),
+              grouped_embeddings.begin() + position * dimension);
+  }
+
+  auto index = absl::WrapUnique(new EmbeddingIndex());
+  Header header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.element_type = static_cast<uint32_t>(element_type);
+  header.dimension = dimension;
+  header.num_embeddings = num_embeddings;
+  header.num_clusters = num_clusters;
+  std::string& buffer = index->owned_buffer_;
+  AppendSection(&header, 1, buffer);
+  AppendSection(centroids.data(), centroids.size(), buffer);
+  AppendSection(offsets.data(), offsets.size(), buffer);
+  AppendSection(grouped_ids.data(), grouped_ids.size(), buffer);
+  AppendSection(grouped_embeddings.data(), grouped_embeddings.size(), buffer);
+  index->buffer_ = buffer;
+  MP_RETURN_IF_ERROR(index->Parse());
+  return index;
+}
+
+/* static */
+absl::StatusOr<std::unique_ptr<EmbeddingIndex>> EmbeddingIndex::Create(
+    std::unique_ptr<core::proto::ExternalFile> index_file) {
+  auto index = absl::WrapUnique(new EmbeddingIndex());
+  index->index_file_ = std::move(index_file);
+  ASSIGN_OR_RETURN(index->file_handler_,
+                   core::ExternalFileHandler::CreateFromExternalFile(
+                       index->index_file_.get()));
+  index->buffer_ = index->file_handler_->GetFileContent();
+  MP_RETURN_IF_ERROR(index->Parse());
+  return index;
+}
+
+absl::Status EmbeddingIndex::Parse() {
+  if (reinterpret_cast<uintptr_t>(buffer_.data()) % kAlignment != 0) {
+    return InvalidArgumentError(absl::StrFormat(
+        "Embedding index buffer must be %d-byte aligned", kAlignment));
+  }
+  size_t position = 0;
+  auto section = [&](size_t size) -> const char* {
+    if (position + size > buffer_.size()) return nullptr;
+    const char* data = buffer_.data() + position;
+    position = Align(position + size);
+    return data;
+  };
+  const char* header_data = section(sizeof(Header));
+  if (header_data == nullptr ||
+      std::memcmp(header_data, kMagic, sizeof(kMagic)) != 0) {
+    return InvalidArgumentError("Invalid embedding index: bad header");
+  }
+  Header header;
+  std::memcpy(&header, header_data, sizeof(header));
+  if (header.version != kVersion) {
+    return InvalidArgumentError(absl::StrFormat(
+        "Unsupported embedding index version %d", header.version));
+  }
+  if (header.element_type > static_cast<uint32_t>(ElementType::kInt8) ||
+      header.dimension == 0 || header.num_embeddings <= 0 ||
+      header.num_clusters <= 0 ||
+      header.num_clusters > header.num_embeddings) {
+    return InvalidArgumentError("Invalid embedding index: bad sizes");
+  }
+  element_type_ = static_cast<ElementType>(header.element_type);
+  dimension_ = header.dimension;
+  num_embeddings_ = header.num_embeddings;
+  num_clusters_ = header.num_clusters;
+  const size_t element_size =
+      element_type_ == ElementType::kFloat32 ? sizeof(float) : sizeof(int8_t);
+  centroids_ = reinterpret_cast<const float*>(
+      section(sizeof(float) * num_clusters_ * dimension_));
+  offsets_ = reinterpret_cast<const int64_t*>(
+      section(sizeof(int64_t) * (num_clusters_ + 1)));
+  ids_ = reinterpret_cast<const int64_t*>(
+      section(sizeof(int64_t) * num_embeddings_));
+  embeddings_ = section(element_size * num_embeddings_ * dimension_);
+  if (centroids_ == nullptr || offsets_ == nullptr || ids_ == nullptr ||
+      embeddings_ == nullptr) {
+    return InvalidArgumentError("Invalid embedding index: truncated buffer");
+  }
+  for (int c = 0; c < num_clusters_; ++c) {
+    if (offsets_[c] > offsets_[c + 1]) {
+      return InvalidArgumentError("Invalid embedding index: bad offsets");
+    }
+  }
+  if (offsets_[0] != 0 || offsets_[num_clusters_] != num_embeddings_) {
+    return InvalidArgumentError("Invalid embedding index: bad offsets");
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<EmbeddingIndex::Neighbor>> EmbeddingIndex::Search(
+    absl::Span<const float> query, int max_results, int num_probes) const {
+  if (element_type_ != ElementType::kFloat32) {
+    return InvalidArgumentError(
+        "Cannot search a quantized embedding index with a float embedding");
+  }
+  return SearchClusters(query, static_cast<const float*>(embeddings_), query,
+                        max_results, num_probes);
+}
+
+absl::StatusOr<std::vector<EmbeddingIndex::Neighbor>> EmbeddingIndex::Search(
+    absl::Span<const int8_t> query, int max_results, int num_probes) const {
+  if (element_type_ != ElementType::kInt8) {
+    return InvalidArgumentError(
+        "Cannot search a float embedding index with a quantized embedding");
+  }
+  const std::vector<float> float_query = ToFloat(query);
+  return SearchClusters(query, static_cast<const int8_t*>(embeddings_),
+                        absl::MakeConstSpan(float_query), max_results,
+                        num_probes);
+}
+
+template <typename T>
+absl::StatusOr<std::vector<EmbeddingIndex::Neighbor>>
+EmbeddingIndex::SearchClusters(absl::Span<const T> query, const T* embeddings,
+                               absl::Span<const float> float_query,
+                               int max_results, int num_probes) const {
+  if (query.size() != dimension_) {
+    return InvalidArgumentError(absl::StrFormat(
+        "Cannot search an embedding index of dimension %d with an embedding "
+        "of size %d",
+        dimension_, query.size()));
+  }
+  if (max_results <= 0) {
+    return InvalidArgumentError("max_results must be positive");
+  }
+  // Scores the centroids first, which also rejects queries with 0 norm.
+  ASSIGN_OR_RETURN(
+      std::vector<double> centroid_similarities,
+      CosineSimilarityBatch(float_query,
+                            absl::MakeConstSpan(
+                                centroids_, num_clusters_ * dimension_)));
+  std::vector<int> clusters(num_clusters_);
+  std::iota(clusters.begin(), clusters.end(), 0);
+  if (num_probes > 0 && num_probes < num_clusters_) {
+    std::partial_sort(clusters.begin(), clusters.begin() + num_probes,
+                      clusters.end(), [&](int a, int b) {
+                        return centroid_similarities[a] >
+                               centroid_similarities[b];
+                      });
+    clusters.resize(num_probes);
+  }
+
+  // Keeps the best results in a min-heap, so that the worst is replaced.
+  auto more_similar = [](const Neighbor& a, const Neighbor& b) {
+    return a.similarity > b.similarity;
+  };
+  std::priority_queue<Neighbor, std::vector<Neighbor>, decltype(more_similar)>
+      results(more_similar);
+  for (const int cluster : clusters) {
+    const int64_t begin = offsets_[cluster];
+    const int64_t end = offsets_[cluster + 1];
+    if (begin == end) continue;
+    absl::Span<const T> cluster_embeddings(embeddings + begin * dimension_,
+                                           (end - begin) * dimension_);
+    ASSIGN_OR_RETURN(std::vector<double> similarities,
+                     CosineSimilarityBatch(query, cluster_embeddings));
+    for (int64_t i = begin; i < end; ++i) {
+      const double similarity = similarities[i - begin];
+      if (results.size() < max_results) {
+        results.push({ids_[i], similarity});
+      } else if (similarity > results.top().similarity) {
+        results.pop();
+        results.push({ids_[i], similarity});
+      }
+    }
+  }
+  std::vector<Neighbor> neighbors(results.size());
+  for (int i = neighbors.size() - 1; i >= 0; --i) {
+    neighbors[i] = results.top();
+    results.pop();
+  }
+  return neighbors;
+}
+
+}  // namespace utils
+}  // namespace components
+}  // namespace tasks
+}  // namespace mediapipe
@@ -0,0 +1,160 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef MEDIAPIPE_TASKS_CC_COMPONENTS_UTILS_EMBEDDING_INDEX_H_
+#define MEDIAPIPE_TASKS_CC_COMPONENTS_UTILS_EMBEDDING_INDEX_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "mediapipe/tasks/cc/core/external_file_handler.h"
+#include "mediapipe/tasks/cc/core/proto/external_file.pb.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace components {
+namespace utils {
+
+// In-memory approximate nearest neighbor index over embeddings, searched by
+// cosine similarity [1]. It is an inverted file (IVF) index: the embeddings
+// are clustered around centroids trained with spherical k-means, and a search
+// only scores the embeddings of the clusters whose centroids are the most
+// similar to the query.
+//
+// The embeddings are either all float or all scalar-quantized (int8), as
+// produced by the embedder tasks. An index is stored as a single flat buffer,
+// which can be written to disk and memory-mapped back without any copy or
+// parsing through an ExternalFile.
+//
+// [1]: https://en.wikipedia.org/wiki/Cosine_similarity
+class EmbeddingIndex {
+ public:
+  enum class ElementType { kFloat32 = 0, kInt8 = 1 };
+
+  struct BuildOptions {
+    // The number of clusters. If 0, the square root of the number of
+    // embeddings is used.
+    int num_clusters = 0;
+    // The number of k-means iterations used to train the centroids.
+    int num_iterations = 10;
+    // The maximum number of embeddings sampled to train the centroids, per
+    // cluster.
+    int max_training_samples_per_cluster = 256;
+    // The seed of the random sampling and initialization of the centroids.
+    uint32_t seed = 0;
+  };
+
+  struct Neighbor {
+    // The identifier given to the embedding when building the index.
+    int64_t id;
+    // The cosine similarity between the embedding and the query.
+    double similarity;
+  };
+
+  // Builds an index over `embeddings`, which holds `ids.size()` embeddings of
+  // the same size stored contiguously, one after the other. Returns an
+  // InvalidArgumentError if e.g. the sizes don't match or an embedding has an
+  // L2-norm of 0.
+  static absl::StatusOr<std::unique_ptr<EmbeddingIndex>> Build(
+      absl::Span<const int64_t> ids, absl::Span<const float> embeddings,
+      const BuildOptions& options);
+  static absl::StatusOr<std::unique_ptr<EmbeddingIndex>> Build(
+      absl::Span<const int64_t> ids, absl::Span<const int8_t> embeddings,
+      const BuildOptions& options);
+
+  // Loads an index serialized by `Serialize()`. Files provided by path or file
+  // descriptor are memory-mapped, and their contents used in place.
+  static absl::StatusOr<std::unique_ptr<EmbeddingIndex>> Create(
+      std::unique_ptr<core::proto::ExternalFile> index_file);
+
+  EmbeddingIndex(const EmbeddingIndex&) = delete;
+  EmbeddingIndex& operator=(const EmbeddingIndex&) = delete;
+
+  // Returns the serialized index, valid as long as the index is alive.
+  absl::string_view Serialize() const { return buffer_; }
+
+  // Returns the `max_results` embeddings most similar to `query`, by
+  // decreasing similarity, among the clusters of the `num_probes` centroids
+  // most similar to the query. More probes give more accurate results at a
+  // higher cost; if `num_probes` is 0 or at least `num_clusters()`, the search
+  // is exhaustive. The query must have the element type and size of the
+  // indexed embeddings.
+  absl::StatusOr<std::vector<Neighbor>> Search(absl::Span<const float> query,
+                                               int max_results,
+                                               int num_probes) const;
+  absl::StatusOr<std::vector<Neighbor>> Search(absl::Span<const int8_t> query,
+                                               int max_results,
+                                               int num_probes) const;
+
+  ElementType element_type() const { return element_type_; }
+  // The number of elements of each embedding.
+  int dimension() const { return dimension_; }
+  // The number of indexed embeddings.
+  int64_t size() const { return num_embeddings_; }
+  int num_clusters() const { return num_clusters_; }
+
+ private:
+  EmbeddingIndex() = default;
+
+  // Serializes the clustered embeddings into `owned_buffer_`, and parses it.
+  template <typename T>
+  static absl::StatusOr<std::unique_ptr<EmbeddingIndex>> BuildFromSpans(
+      absl::Span<const int64_t> ids, absl::Span<const T> embeddings,
+      ElementType element_type, const BuildOptions& options);
+
+  // Points the index at the sections of `buffer_`, checking their sizes.
+  absl::Status Parse();
+
+  // Searches the clusters whose centroids are the most similar to
+  // `float_query`, the query converted to float, for `query`.
+  template <typename T>
+  absl::StatusOr<std::vector<Neighbor>> SearchClusters(
+      absl::Span<const T> query, const T* embeddings,
+      absl::Span<const float> float_query, int max_results,
+      int num_probes) const;
+
+  // The serialized index, pointing into `owned_buffer_` or the contents of
+  // `file_handler_`.
+  absl::string_view buffer_;
+  std::string owned_buffer_;
+  std::unique_ptr<core::proto::ExternalFile> index_file_;
+  std::unique_ptr<core::ExternalFileHandler> file_handler_;
+
+  ElementType element_type_ = ElementType::kFloat32;
+  int dimension_ = 0;
+  int64_t num_embeddings_ = 0;
+  int num_clusters_ = 0;
+  // `num_clusters_` L2-normalized centroids.
+  const float* centroids_ = nullptr;
+  // The embeddings of cluster `i` are at positions [offsets_[i],
+  // offsets_[i + 1]) of `ids_` and of the embeddings.
+  const int64_t* offsets_ = nullptr;
+  const int64_t* ids_ = nullptr;
+  // The embeddings, grouped by cluster, of `element_type_`.
+  const void* embeddings_ = nullptr;
+};
+
+}  // namespace utils
+}  // namespace components
+}  // namespace tasks
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_TASKS_CC_COMPONENTS_UTILS_EMBEDDING_INDEX_H_
@@ -0,0 +1,204 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/components/utils/embedding_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/tasks/cc/components/utils/cosine_similarity.h"
+#include "mediapipe/tasks/cc/core/proto/external_file.pb.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace components {
+namespace utils {
+namespace {
+
+using ::testing::HasSubstr;
+
+constexpr int kDimension = 16;
+constexpr int kNumEmbeddings = 500;
+
+// Returns `num_embeddings` random embeddings of size kDimension, stored
+// contiguously.
+std::vector<float> RandomEmbeddings(int num_embeddings, uint32_t seed) {
+  std::mt19937 random(seed);
+  std::normal_distribution<float> distribution;
+  std::vector<float> embeddings(num_embeddings * kDimension);
+  for (float& value : embeddings) value = distribution(random);
+  return embeddings;
+}
+
+std::vector<int64_t> Ids(int num_embeddings) {
+  std::vector<int64_t> ids(num_embeddings);
+  for (int i = 0; i < num_embeddings; ++i) ids[i] = 1000 + i;
+  return ids;
+}
+
+TEST(EmbeddingIndexTest, FailsWithMismatchedSizes) {
+  const std::vector<float> embeddings(10);
+
+  auto status = EmbeddingIndex::Build(Ids(3), embeddings, {}).status();
+
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(),
+              HasSubstr("Cannot build an embedding index from 3 ids"));
+}
+
+TEST(EmbeddingIndexTest, FailsWithZeroNormEmbedding) {
+  std::vector<float> embeddings = RandomEmbeddings(2, /*seed=*/0);
+  std::fill(embeddings.begin() + kDimension, embeddings.end(), 0.0f);
+
+  auto status = EmbeddingIndex::Build(Ids(2), embeddings, {}).status();
+
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("1001"));
+}
+
+TEST(EmbeddingIndexTest, FailsWithWrongQuery) {
+  const std::vector<float> embeddings = RandomEmbeddings(10, /*seed=*/0);
+  MP_ASSERT_OK_AND_ASSIGN(auto index,
+                          EmbeddingIndex::Build(Ids(10), embeddings, {}));
+
+  const std::vector<float> short_query(kDimension - 1, 1.0f);
+  EXPECT_EQ(index->Search(short_query, 1, 0).status().code(),
+            absl::StatusCode::kInvalidArgument);
+  const std::vector<int8_t> quantized_query(kDimension, 1);
+  EXPECT_EQ(index->Search(quantized_query, 1, 0).status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(EmbeddingIndexTest, ExhaustiveSearchMatchesBruteForce) {
+  const std::vector<float> embeddings =
+      RandomEmbeddings(kNumEmbeddings, /*seed=*/0);
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto index, EmbeddingIndex::Build(Ids(kNumEmbeddings), embeddings, {}));
+  EXPECT_EQ(index->size(), kNumEmbeddings);
+  EXPECT_EQ(index->dimension(), kDimension);
+  EXPECT_EQ(index->num_clusters(), 22);
+
+  const std::vector<float> query = RandomEmbeddings(1, /*seed=*/1);
+  MP_ASSERT_OK_AND_ASSIGN(auto similarities,
+                          CosineSimilarityBatch(query, embeddings));
+  std::vector<int> expected(kNumEmbeddings);
+  std::iota(expected.begin(), expected.end(), 0);
+  std::sort(expected.begin(), expected.end(), [&](int a, int b) {
+    return similarities[a] > similarities[b];
+  });
+
+  MP_ASSERT_OK_AND_ASSIGN(auto neighbors,
+                          index->Search(query, /*max_results=*/5,
+                                        /*num_probes=*/0));
+
+  ASSERT_EQ(neighbors.size(), 5);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(neighbors[i].id, 1000 + expected[i]);
+    EXPECT_NEAR(neighbors[i].similarity, similarities[expected[i]], 1e-6);
+  }
+}
+
+TEST(EmbeddingIndexTest, FindsIndexedEmbeddingsWithFewProbes) {
+  const std::vector<float> embeddings =
+      RandomEmbeddings(kNumEmbeddings, /*seed=*/0);
+  EmbeddingIndex::BuildOptions options;
+  options.num_clusters = 10;
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto index,
+      EmbeddingIndex::Build(Ids(kNumEmbeddings), embeddings, options));
+
+  // Each indexed embedding is in the cluster of its closest centroid, so it
+  // is found by probing that cluster only.
+  for (int i = 0; i < kNumEmbeddings; i += 50) {
+    absl::Span<const float> query(embeddings.data() + i * kDimension,
+                                  kDimension);
+    MP_ASSERT_OK_AND_ASSIGN(auto neighbors,
+                            index->Search(query, /*max_results=*/1,
+                                          /*num_probes=*/1));
+    ASSERT_EQ(neighbors.size(), 1);
+    EXPECT_EQ(neighbors[0].id, 1000 + i);
+    EXPECT_NEAR(neighbors[0].similarity, 1.0, 1e-6);
+  }
+}
+
+TEST(EmbeddingIndexTest, SucceedsWithQuantizedEmbeddings) {
+  const std::vector<float> float_embeddings =
+      RandomEmbeddings(kNumEmbeddings, /*seed=*/0);
+  std::vector<int8_t> embeddings(float_embeddings.size());
+  for (int i = 0; i < embeddings.size(); ++i) {
+    embeddings[i] =
+        std::max(-128.0f, std::min(float_embeddings[i] * 40, 127.0f));
+  }
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto index, EmbeddingIndex::Build(Ids(kNumEmbeddings), embeddings, {}));
+
+  absl::Span<const int8_t> query(embeddings.data() + 7 * kDimension,
+                                 kDimension);
+  MP_ASSERT_OK_AND_ASSIGN(auto neighbors,
+                          index->Search(query, /*max_results=*/3,
+                                        /*num_probes=*/0));
+
+  ASSERT_EQ(neighbors.size(), 3);
+  EXPECT_EQ(neighbors[0].id, 1007);
+  EXPECT_GE(neighbors[0].similarity, neighbors[1].similarity);
+  EXPECT_GE(neighbors[1].similarity, neighbors[2].similarity);
+}
+
+TEST(EmbeddingIndexTest, RoundTripsThroughSerialization) {
+  const std::vector<float> embeddings =
+      RandomEmbeddings(kNumEmbeddings, /*seed=*/0);
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto index, EmbeddingIndex::Build(Ids(kNumEmbeddings), embeddings, {}));
+  auto index_file = std::make_unique<core::proto::ExternalFile>();
+  index_file->set_file_content(std::string(index->Serialize()));
+
+  MP_ASSERT_OK_AND_ASSIGN(auto loaded_index,
+                          EmbeddingIndex::Create(std::move(index_file)));
+
+  EXPECT_EQ(loaded_index->size(), index->size());
+  EXPECT_EQ(loaded_index->num_clusters(), index->num_clusters());
+  const std::vector<float> query = RandomEmbeddings(1, /*seed=*/1);
+  MP_ASSERT_OK_AND_ASSIGN(auto expected, index->Search(query, 5, 3));
+  MP_ASSERT_OK_AND_ASSIGN(auto neighbors, loaded_index->Search(query, 5, 3));
+  ASSERT_EQ(neighbors.size(), expected.size());
+  for (int i = 0; i < neighbors.size(); ++i) {
+    EXPECT_EQ(neighbors[i].id, expected[i].id);
+  }
+}
+
+TEST(EmbeddingIndexTest, FailsWithInvalidSerializedIndex) {
+  auto index_file = std::make_unique<core::proto::ExternalFile>();
+  index_file->set_file_content("not an index");
+
+  auto status = EmbeddingIndex::Create(std::move(index_file)).status();
+
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("Invalid embedding index"));
+}
+
+}  // namespace
+}  // namespace utils
+}  // namespace components
+}  // namespace tasks
+}  // namespace mediapipe
@@ -50,6 +50,19 @@ proto::BaseOptions ConvertBaseOptionsToProto(BaseOptions* base_options) {
           base_options->model_asset_descriptor_meta.offset);
     }
   }
+  const auto& mmap_options = base_options->model_asset_mmap_options;
+  if (mmap_options.prefetch != BaseOptions::MmapOptions::NONE ||
+      mmap_options.prefetch_in_background || mmap_options.lock_in_memory ||
+      mmap_options.use_huge_pages) {
+    auto* mmap_options_proto =
+        base_options_proto.mutable_model_asset()->mutable_mmap_options();
+    mmap_options_proto->set_prefetch(
+        static_cast<proto::MmapOptions::Prefetch>(mmap_options.prefetch));
+    mmap_options_proto->set_prefetch_in_background(
+        mmap_options.prefetch_in_background);
+    mmap_options_proto->set_lock_in_memory(mmap_options.lock_in_memory);
+    mmap_options_proto->set_use_huge_pages(mmap_options.use_huge_pages);
+  }
   switch (base_options->delegate) {
     case BaseOptions::Delegate::CPU:
       base_options_proto.mutable_acceleration()->mutable_tflite();
@@ -58,6 +71,14 @@ proto::BaseOptions ConvertBaseOptionsToProto(BaseOptions* base_options) {
       base_options_proto.mutable_acceleration()->mutable_gpu();
       break;
   }
+  if (base_options->model_cache_options.has_value()) {
+    auto* model_cache_options_proto =
+        base_options_proto.mutable_model_cache_options();
+    model_cache_options_proto->set_max_unused_bytes(
+        base_options->model_cache_options->max_unused_bytes);
+    model_cache_options_proto->set_max_unused_models(
+        base_options->model_cache_options->max_unused_models);
+  }
 
   return base_options_proto;
 }
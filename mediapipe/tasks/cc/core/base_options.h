@@ -16,7 +16,9 @@ limitations under the License.
 #ifndef MEDIAPIPE_TASKS_CC_CORE_BASE_OPTIONS_H_
 #define MEDIAPIPE_TASKS_CC_CORE_BASE_OPTIONS_H_
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "absl/memory/memory.h"
@@ -61,10 +63,56 @@ struct BaseOptions {
     int offset = -1;
   } model_asset_descriptor_meta;
 
+  // How the model asset is mapped in memory, if provided by path or file
+  // descriptor. By default, the model pages are only read on first access,
+  // which slows the first inference down.
+  struct MmapOptions {
+    enum Prefetch {
+      // No hint is given to the kernel.
+      NONE = 0,
+      // Advises the kernel that the whole model will be needed soon.
+      WILL_NEED = 1,
+      // Advises the kernel that the model will be read sequentially.
+      SEQUENTIAL = 2,
+    };
+    Prefetch prefetch = NONE;
+
+    // Whether to fault the whole model in on a background thread after it is
+    // mapped.
+    bool prefetch_in_background = false;
+
+    // Whether to lock the model in memory, so that it is never paged out.
+    bool lock_in_memory = false;
+
+    // Whether to align large models to huge pages and back them with
+    // transparent huge pages, where supported.
+    bool use_huge_pages = false;
+  } model_asset_mmap_options;
+
   // A non-default OpResolver to support custom Ops or specify a subset of
   // built-in Ops.
   std::unique_ptr<tflite::OpResolver> op_resolver =
       absl::make_unique<MediaPipeBuiltinOpResolver>();
+
+  // The number of graph instances behind the task object. Instances share the
+  // loaded model resources, and concurrent calls are dispatched to whichever
+  // instance is free. Values greater than 1 are only supported in the image
+  // running mode of vision tasks.
+  int num_graph_instances = 1;
+
+  // Limits of the process-wide cache of loaded models, which lets task objects
+  // created from the same model content share it. Models in use are always
+  // kept; these only bound the models kept after their last user is gone. If
+  // not set, the current limits are kept, which by default keep no unused
+  // model.
+  struct ModelCacheOptions {
+    // The maximum total size in bytes of the unused models that are kept.
+    int64_t max_unused_bytes = 0;
+
+    // The maximum number of unused models that are kept.
+    int max_unused_models = 0;
+  };
+  std::optional<ModelCacheOptions> model_cache_options;
 };
 
 // Converts a BaseOptions to a BaseOptionsProto.
@@ -31,6 +31,7 @@ limitations under the License.
 #include <unistd.h>
 #endif
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -39,6 +40,7 @@ limitations under the License.
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/tasks/cc/common.h"
 #include "mediapipe/tasks/cc/core/proto/external_file.pb.h"
@@ -67,6 +69,11 @@ int64 GetPageSizeAlignedOffset(int64 offset) {
 #endif
 }
 
+// Rounds `value` up to a multiple of `alignment`.
+uintptr_t RoundUp(uintptr_t value, uintptr_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
 }  // namespace
 
 /* static */
@@ -194,18 +201,106 @@ absl::Status ExternalFileHandler::MapExternalFile() {
   buffer_aligned_offset_ = GetPageSizeAlignedOffset(buffer_offset_);
   buffer_aligned_size_ = buffer_size_ + buffer_offset_ - buffer_aligned_offset_;
   // Map into memory.
-  buffer_ = mmap(/*addr=*/nullptr, buffer_aligned_size_, PROT_READ, MAP_SHARED,
-                 fd, buffer_aligned_offset_);
+  const proto::MmapOptions& mmap_options = external_file_.mmap_options();
+  buffer_ = MAP_FAILED;
+  if (mmap_options.use_huge_pages() && mmap_options.huge_page_size() > 0 &&
+      buffer_aligned_size_ >= mmap_options.huge_page_size()) {
+    buffer_ = MapAlignedToHugePages(fd, mmap_options.huge_page_size());
+  }
+  if (buffer_ == MAP_FAILED) {
+    buffer_ = mmap(/*addr=*/nullptr, buffer_aligned_size_, PROT_READ,
+                   MAP_SHARED, fd, buffer_aligned_offset_);
+  }
   if (buffer_ == MAP_FAILED) {
     return CreateStatusWithPayload(
         StatusCode::kUnknown,
         absl::StrFormat("Unable to map file to memory buffer, errno=%d", errno),
         MediaPipeTasksStatus::kFileMmapError);
   }
+  ApplyMmapOptions();
   return absl::OkStatus();
 #endif
 }
 
+void* ExternalFileHandler::MapAlignedToHugePages(int fd,
+                                                 int64 huge_page_size) {
+#ifdef _WIN32
+  return nullptr;
+#else
+  // Reserves an address range large enough to hold the mapping at a huge page
+  // boundary, keeping the file offset congruent to the address so that the
+  // file's huge pages line up with the address space's.
+  const size_t reserved_size = buffer_aligned_size_ + 2 * huge_page_size;
+  void* reserved = mmap(/*addr=*/nullptr, reserved_size, PROT_NONE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, /*fd=*/-1, /*offset=*/0);
+  if (reserved == MAP_FAILED) return MAP_FAILED;
+  const uintptr_t reserved_start = reinterpret_cast<uintptr_t>(reserved);
+  const uintptr_t reserved_end = reserved_start + reserved_size;
+  const uintptr_t start = RoundUp(reserved_start, huge_page_size) +
+                          buffer_aligned_offset_ % huge_page_size;
+  const uintptr_t end = start + buffer_aligned_size_;
+  void* buffer = mmap(reinterpret_cast<void*>(start), buffer_aligned_size_,
+                      PROT_READ, MAP_SHARED | MAP_FIXED, fd,
+                      buffer_aligned_offset_);
+  if (buffer == MAP_FAILED) {
+    munmap(reserved, reserved_size);
+    return MAP_FAILED;
+  }
+  // Releases the rest of the reserved range.
+  if (start > reserved_start) munmap(reserved, start - reserved_start);
+  if (reserved_end > end) {
+    munmap(reinterpret_cast<void*>(end), reserved_end - end);
+  }
+  return buffer;
+#endif
+}
+
+void ExternalFileHandler::ApplyMmapOptions() {
+#ifndef _WIN32
+  const proto::MmapOptions& mmap_options = external_file_.mmap_options();
+#ifdef MADV_HUGEPAGE
+  if (mmap_options.use_huge_pages() &&
+      madvise(buffer_, buffer_aligned_size_, MADV_HUGEPAGE) != 0) {
+    LOG(WARNING) << "Unable to advise huge pages for " << buffer_aligned_size_
+                 << " mapped bytes, errno=" << errno;
+  }
+#endif  // MADV_HUGEPAGE
+  int advice = MADV_NORMAL;
+  switch (mmap_options.prefetch()) {
+    case proto::MmapOptions::NONE:
+      break;
+    case proto::MmapOptions::WILL_NEED:
+      advice = MADV_WILLNEED;
+      break;
+    case proto::MmapOptions::SEQUENTIAL:
+      advice = MADV_SEQUENTIAL;
+      break;
+  }
+  if (advice != MADV_NORMAL &&
+      madvise(buffer_, buffer_aligned_size_, advice) != 0) {
+    LOG(WARNING) << "Unable to advise prefetching " << buffer_aligned_size_
+                 << " mapped bytes, errno=" << errno;
+  }
+  if (mmap_options.lock_in_memory() &&
+      mlock(buffer_, buffer_aligned_size_) != 0) {
+    LOG(WARNING) << "Unable to lock " << buffer_aligned_size_
+                 << " mapped bytes in memory, errno=" << errno;
+  }
+  if (mmap_options.prefetch_in_background()) {
+    prefetch_thread_ = std::thread([this]() {
+      const char* data = static_cast<const char*>(buffer_);
+      const int64 page_size = sysconf(_SC_PAGE_SIZE);
+      volatile char sink = 0;
+      for (int64 i = 0; i < buffer_aligned_size_ && !cancel_prefetch_;
+           i += page_size) {
+        sink = data[i];
+      }
+      (void)sink;
+    });
+  }
+#endif  // !_WIN32
+}
+
 absl::string_view ExternalFileHandler::GetFileContent() {
   if (!external_file_.file_content().empty()) {
     return external_file_.file_content();
@@ -222,6 +317,10 @@ absl::string_view ExternalFileHandler::GetFileContent() {
 }
 
 ExternalFileHandler::~ExternalFileHandler() {
+  if (prefetch_thread_.joinable()) {
+    cancel_prefetch_ = true;
+    prefetch_thread_.join();
+  }
 #ifndef _WIN32
   if (buffer_ != MAP_FAILED) {
     munmap(buffer_, buffer_aligned_size_);
@@ -16,7 +16,9 @@ limitations under the License.
 #ifndef MEDIAPIPE_TASKS_CC_CORE_EXTERNAL_FILE_HANDLER_H_
 #define MEDIAPIPE_TASKS_CC_CORE_EXTERNAL_FILE_HANDLER_H_
 
+#include <atomic>
 #include <memory>
+#include <thread>  // NOLINT(build/c++11)
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -62,6 +64,15 @@ class ExternalFileHandler {
   // contents are already loaded in memory.
   absl::Status MapExternalFile();
 
+  // Maps `buffer_aligned_size_` bytes of the file at `buffer_aligned_offset_`
+  // at an address aligned to the huge page size. Returns MAP_FAILED if the
+  // address range cannot be reserved or mapped.
+  void* MapAlignedToHugePages(int fd, int64 huge_page_size);
+
+  // Applies the prefetch, locking and huge page options of the ExternalFile to
+  // the mapped memory buffer.
+  void ApplyMmapOptions();
+
   // Reference to the input ExternalFile.
   const proto::ExternalFile& external_file_;
 
@@ -85,6 +96,12 @@ class ExternalFileHandler {
   // The aligned mapped memory buffer size in bytes taking into account the
   // offset shift introduced by buffer_aligned_memory_offset_, if any.
   int64 buffer_aligned_size_{};
+
+  // Faults the pages of the mapped memory buffer in, if requested by the
+  // ExternalFile mmap options. Joined before the buffer is unmapped.
+  std::thread prefetch_thread_;
+  // Stops the prefetch thread early when set.
+  std::atomic<bool> cancel_prefetch_{false};
 };
 
 }  // namespace core
@@ -35,6 +35,9 @@ MediaPipeBuiltinOpResolver::MediaPipeBuiltinOpResolver() {
   AddCustom("TransformTensorBilinear",
             mediapipe::tflite_operations::RegisterTransformTensorBilinearV2(),
             /*version=*/2);
+  AddCustom("TransformTensorBilinearNormalize",
+            mediapipe::tflite_operations::
+                RegisterTransformTensorBilinearNormalize());
   AddCustom("TransformLandmarks",
             mediapipe::tflite_operations::RegisterTransformLandmarksV2(),
             /*version=*/2);
@@ -0,0 +1,143 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/core/model_asset_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "absl/hash/hash.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/no_destructor.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace core {
+
+/* static */
+ModelAssetCache& ModelAssetCache::GetInstance() {
+  static NoDestructor<ModelAssetCache> instance;
+  return *instance;
+}
+
+ModelAssetCache::ModelAssetCache()
+    : unused_([] {
+        ShardedLruCache<Key, std::unique_ptr<Asset>>::Options options;
+        // The default limits keep no unused assets.
+        options.max_entries = 0;
+        options.max_weight = 0;
+        options.weigher = [](const Key& key,
+                             const std::unique_ptr<Asset>& asset) {
+          return static_cast<int64_t>(asset->content().size());
+        };
+        return options;
+      }()) {}
+
+void ModelAssetCache::SetLimits(const Limits& limits) {
+  {
+    absl::MutexLock lock(&mutex_);
+    limits_ = limits;
+  }
+  unused_.SetLimits(limits.max_unused_assets, limits.max_unused_bytes);
+}
+
+ModelAssetCache::Limits ModelAssetCache::GetLimits() const {
+  absl::MutexLock lock(&mutex_);
+  return limits_;
+}
+
+absl::StatusOr<std::shared_ptr<const ModelAssetCache::Asset>>
+ModelAssetCache::GetOrLoad(
+    absl::string_view content,
+    absl::FunctionRef<absl::StatusOr<std::unique_ptr<Asset>>()> load) {
+  const Key key(absl::Hash<absl::string_view>{}(content), content.size());
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      if (it->second.asset->content() == content) {
+        return AddUser(key, it->second);
+      }
+    } else if (std::optional<std::unique_ptr<Asset>> unused =
+                   unused_.Take(key)) {
+      if ((*unused)->content() == content) {
+        Entry& entry = entries_[key];
+        entry.asset = std::move(*unused);
+        return AddUser(key, entry);
+      }
+      // A hash collision with different content: keep the unused asset.
+      unused_.Insert(key, std::move(*unused));
+    }
+  }
+
+  // Loading can be slow, so it runs without the lock. If another thread loads
+  // the same content meanwhile, its asset is used and this one is dropped.
+  ASSIGN_OR_RETURN(std::unique_ptr<Asset> asset, load());
+  absl::MutexLock lock(&mutex_);
+  auto [it, inserted] = entries_.try_emplace(key);
+  if (inserted) {
+    it->second.asset = std::move(asset);
+    return AddUser(key, it->second);
+  }
+  if (it->second.asset->content() == content) {
+    return AddUser(key, it->second);
+  }
+  // A hash collision with different content: the asset is not cached.
+  return std::shared_ptr<const Asset>(std::move(asset));
+}
+
+std::shared_ptr<const ModelAssetCache::Asset> ModelAssetCache::AddUser(
+    const Key& key, Entry& entry) {
+  ++entry.users;
+  return std::shared_ptr<const Asset>(
+      entry.asset.get(), [this, key](const Asset*) { Release(key); });
+}
+
+void ModelAssetCache::Release(const Key& key) {
+  std::unique_ptr<Asset> asset;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end() || --it->second.users > 0) return;
+    asset = std::move(it->second.asset);
+    entries_.erase(it);
+  }
+  // Inserting may evict and destroy assets, so it runs without the lock. A
+  // concurrent GetOrLoad() of the same content may meanwhile load it again,
+  // in which case the newer asset replaces this one once released.
+  unused_.Insert(key, std::move(asset));
+}
+
+int ModelAssetCache::num_assets() const {
+  absl::MutexLock lock(&mutex_);
+  return entries_.size() + unused_.GetStats().entries;
+}
+
+int ModelAssetCache::num_unused_assets() const {
+  return unused_.GetStats().entries;
+}
+
+int64_t ModelAssetCache::unused_bytes() const {
+  return unused_.GetStats().weight;
+}
+
+}  // namespace core
+}  // namespace tasks
+}  // namespace mediapipe
@@ -0,0 +1,116 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef MEDIAPIPE_TASKS_CC_CORE_MODEL_ASSET_CACHE_H_
+#define MEDIAPIPE_TASKS_CC_CORE_MODEL_ASSET_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/util/sharded_lru_cache.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace core {
+
+// Process-wide cache of loaded model assets, keyed by the model content.
+// It lets task objects created from the same model, e.g. by different graphs
+// or one after another, share a single parsed model instead of each building
+// their own.
+//
+// Cached assets are refcounted. An asset stays in the cache while any user
+// holds it; once unused, it is kept until the cache exceeds one of its limits,
+// at which point unused assets are evicted, least recently used first.
+class ModelAssetCache {
+ public:
+  // Base class for the cached values.
+  class Asset {
+   public:
+    virtual ~Asset() = default;
+    // The model content the asset was loaded from. Must stay valid for the
+    // lifetime of the asset.
+    virtual absl::string_view content() const = 0;
+  };
+
+  // Unused assets are kept only while both limits are met, so the default
+  // limits keep none.
+  struct Limits {
+    // The maximum total content size of the unused assets that are kept.
+    int64_t max_unused_bytes = 0;
+    // The maximum number of unused assets that are kept.
+    int max_unused_assets = 0;
+  };
+
+  // Returns the process-wide instance.
+  static ModelAssetCache& GetInstance();
+
+  ModelAssetCache();
+  ModelAssetCache(const ModelAssetCache&) = delete;
+  ModelAssetCache& operator=(const ModelAssetCache&) = delete;
+
+  // Sets the limits and evicts the unused assets that exceed them.
+  void SetLimits(const Limits& limits);
+  Limits GetLimits() const;
+
+  // Returns the asset loaded from the given content, calling `load` to create
+  // it if it is not cached. `content` only needs to stay valid during the
+  // call. The asset is released back to the cache when the returned pointer
+  // and all its copies are destroyed.
+  absl::StatusOr<std::shared_ptr<const Asset>> GetOrLoad(
+      absl::string_view content,
+      absl::FunctionRef<absl::StatusOr<std::unique_ptr<Asset>>()> load);
+
+  // The number of cached assets, in use or not.
+  int num_assets() const;
+  // The number of cached assets that have no users.
+  int num_unused_assets() const;
+  // The total content size of the cached assets that have no users.
+  int64_t unused_bytes() const;
+
+ private:
+  using Key = std::pair<uint64_t, size_t>;
+
+  struct Entry {
+    std::unique_ptr<Asset> asset;
+    int users = 0;
+  };
+
+  // Returns a handle on the entry's asset, counting a new user.
+  std::shared_ptr<const Asset> AddUser(const Key& key, Entry& entry)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void Release(const Key& key);
+
+  mutable absl::Mutex mutex_;
+  Limits limits_ ABSL_GUARDED_BY(mutex_);
+  // The assets in use.
+  absl::flat_hash_map<Key, Entry> entries_ ABSL_GUARDED_BY(mutex_);
+  // The unused assets, weighted by their content size. The cache does its own
+  // locking; it is only accessed under mutex_ when moving an asset into
+  // entries_, and the evicted assets are destroyed without holding mutex_.
+  ShardedLruCache<Key, std::unique_ptr<Asset>> unused_;
+};
+
+}  // namespace core
+}  // namespace tasks
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_TASKS_CC_CORE_MODEL_ASSET_CACHE_H_
@@ -0,0 +1,160 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/core/model_asset_cache.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace core {
+namespace {
+
+class TestAsset : public ModelAssetCache::Asset {
+ public:
+  TestAsset(std::string content, int* num_destroyed)
+      : content_(std::move(content)), num_destroyed_(num_destroyed) {}
+  ~TestAsset() override { ++*num_destroyed_; }
+
+  absl::string_view content() const override { return content_; }
+
+ private:
+  std::string content_;
+  int* num_destroyed_;
+};
+
+class ModelAssetCacheTest : public ::testing::Test {
+ protected:
+  absl::StatusOr<std::shared_ptr<const ModelAssetCache::Asset>> GetOrLoad(
+      absl::string_view content) {
+    return cache_.GetOrLoad(
+        content,
+        [&]() -> absl::StatusOr<std::unique_ptr<ModelAssetCache::Asset>> {
+          ++num_loaded_;
+          return std::make_unique<TestAsset>(std::string(content),
+                                             &num_destroyed_);
+        });
+  }
+
+  ModelAssetCache cache_;
+  int num_loaded_ = 0;
+  int num_destroyed_ = 0;
+};
+
+TEST_F(ModelAssetCacheTest, SharesAssetsWithTheSameContent) {
+  MP_ASSERT_OK_AND_ASSIGN(auto first, GetOrLoad("model"));
+  // A different buffer holding the same content.
+  const std::string same_content = "model";
+  MP_ASSERT_OK_AND_ASSIGN(auto second, GetOrLoad(same_content));
+  MP_ASSERT_OK_AND_ASSIGN(auto other, GetOrLoad("other model"));
+
+  EXPECT_EQ(first.get(), second.get());
+  EXPECT_NE(first.get(), other.get());
+  EXPECT_EQ(num_loaded_, 2);
+  EXPECT_EQ(cache_.num_assets(), 2);
+  EXPECT_EQ(cache_.num_unused_assets(), 0);
+}
+
+TEST_F(ModelAssetCacheTest, EvictsUnusedAssetsByDefault) {
+  MP_ASSERT_OK_AND_ASSIGN(auto first, GetOrLoad("model"));
+  MP_ASSERT_OK_AND_ASSIGN(auto second, GetOrLoad("model"));
+
+  first.reset();
+  EXPECT_EQ(num_destroyed_, 0);
+  second.reset();
+  EXPECT_EQ(num_destroyed_, 1);
+  EXPECT_EQ(cache_.num_assets(), 0);
+}
+
+TEST_F(ModelAssetCacheTest, KeepsUnusedAssetsWithinLimits) {
+  ModelAssetCache::Limits limits;
+  limits.max_unused_assets = 1;
+  limits.max_unused_bytes = 1024;
+  cache_.SetLimits(limits);
+
+  MP_ASSERT_OK_AND_ASSIGN(auto asset, GetOrLoad("model"));
+  asset.reset();
+  EXPECT_EQ(cache_.num_unused_assets(), 1);
+  EXPECT_EQ(cache_.unused_bytes(), 5);
+
+  MP_ASSERT_OK_AND_ASSIGN(asset, GetOrLoad("model"));
+  EXPECT_EQ(num_loaded_, 1);
+  EXPECT_EQ(cache_.num_unused_assets(), 0);
+}
+
+TEST_F(ModelAssetCacheTest, EvictsLeastRecentlyUsedFirst) {
+  ModelAssetCache::Limits limits;
+  limits.max_unused_assets = 2;
+  limits.max_unused_bytes = 1024;
+  cache_.SetLimits(limits);
+
+  MP_ASSERT_OK_AND_ASSIGN(auto a, GetOrLoad("a"));
+  MP_ASSERT_OK_AND_ASSIGN(auto b, GetOrLoad("b"));
+  MP_ASSERT_OK_AND_ASSIGN(auto c, GetOrLoad("c"));
+  b.reset();
+  a.reset();
+  c.reset();
+  EXPECT_EQ(num_destroyed_, 1);
+
+  // "b" was released first, so it was evicted.
+  MP_ASSERT_OK(GetOrLoad("a").status());
+  MP_ASSERT_OK(GetOrLoad("c").status());
+  EXPECT_EQ(num_loaded_, 3);
+  MP_ASSERT_OK(GetOrLoad("b").status());
+  EXPECT_EQ(num_loaded_, 4);
+}
+
+TEST_F(ModelAssetCacheTest, EvictsToMeetTheMemoryBudget) {
+  ModelAssetCache::Limits limits;
+  limits.max_unused_assets = 10;
+  limits.max_unused_bytes = 8;
+  cache_.SetLimits(limits);
+
+  MP_ASSERT_OK_AND_ASSIGN(auto first, GetOrLoad("12345"));
+  MP_ASSERT_OK_AND_ASSIGN(auto second, GetOrLoad("67890"));
+  first.reset();
+  second.reset();
+  EXPECT_EQ(num_destroyed_, 1);
+  EXPECT_EQ(cache_.unused_bytes(), 5);
+
+  limits.max_unused_bytes = 0;
+  cache_.SetLimits(limits);
+  EXPECT_EQ(num_destroyed_, 2);
+  EXPECT_EQ(cache_.num_assets(), 0);
+}
+
+TEST_F(ModelAssetCacheTest, DoesNotCacheFailedLoads) {
+  auto status_or_asset = cache_.GetOrLoad(
+      "model", []() -> absl::StatusOr<std::unique_ptr<ModelAssetCache::Asset>> {
+        return absl::InvalidArgumentError("bad model");
+      });
+  EXPECT_EQ(status_or_asset.status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(cache_.num_assets(), 0);
+}
+
+}  // namespace
+}  // namespace core
+}  // namespace tasks
+}  // namespace mediapipe
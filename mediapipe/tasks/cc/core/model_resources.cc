@@ -30,6 +30,7 @@ limitations under the License.
 #include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/tasks/cc/common.h"
 #include "mediapipe/tasks/cc/core/external_file_handler.h"
+#include "mediapipe/tasks/cc/core/model_asset_cache.h"
 #include "mediapipe/tasks/cc/core/proto/external_file.pb.h"
 #include "mediapipe/tasks/cc/metadata/metadata_extractor.h"
 #include "mediapipe/util/resource_util.h"
@@ -49,6 +50,30 @@ using ::mediapipe::api2::Packet;
 using ::mediapipe::api2::PacketAdopting;
 using ::mediapipe::tasks::metadata::ModelMetadataExtractor;
 
+class ModelResources::LoadedModel : public ModelAssetCache::Asset {
+ public:
+  LoadedModel(std::unique_ptr<proto::ExternalFile> model_file,
+              std::unique_ptr<ExternalFileHandler> model_file_handler)
+      : model_file_(std::move(model_file)),
+        model_file_handler_(std::move(model_file_handler)) {}
+
+  absl::string_view content() const override {
+    return model_file_handler_->GetFileContent();
+  }
+
+  // The model file.
+  std::unique_ptr<proto::ExternalFile> model_file_;
+  // The ExternalFileHandler for the model.
+  std::unique_ptr<ExternalFileHandler> model_file_handler_;
+  // Error reporter that captures and prints to stderr low-level TFLite
+  // error messages. Used by the TFLite model for as long as it lives.
+  mediapipe::util::tflite::ErrorReporter error_reporter_;
+  // The packet stores the TFLite model for actual inference.
+  Packet<ModelPtr> model_packet_;
+  // The packet stores the TFLite Metadata extractor built from the model.
+  Packet<ModelMetadataExtractor> metadata_extractor_packet_;
+};
+
 bool ModelResources::Verifier::Verify(const char* data, int length,
                                       tflite::ErrorReporter* reporter) {
   return tflite_shims::Verify(data, length, reporter);
@@ -89,11 +114,15 @@ absl::StatusOr<std::unique_ptr<ModelResources>> ModelResources::Create(
   return model_resources;
 }
 
+proto::ExternalFile ModelResources::GetModelFile() const {
+  return *loaded_model_->model_file_;
+}
+
 const tflite::Model* ModelResources::GetTfLiteModel() const {
 #if !TFLITE_IN_GMSCORE
   return model_packet_.Get()->GetModel();
 #else
-  return tflite::GetModel(model_file_handler_->GetFileContent().data());
+  return tflite::GetModel(loaded_model_->content().data());
 #endif
 }
 
@@ -106,27 +135,53 @@ absl::Status ModelResources::BuildModelFromExternalFileProto() {
     model_file_->set_file_name(path_to_resource);
   }
   ASSIGN_OR_RETURN(
-      model_file_handler_,
+      std::unique_ptr<ExternalFileHandler> model_file_handler,
       ExternalFileHandler::CreateFromExternalFile(model_file_.get()));
-  const char* buffer_data = model_file_handler_->GetFileContent().data();
-  size_t buffer_size = model_file_handler_->GetFileContent().size();
+  // The model is looked up by content, so that it is only verified and built
+  // once however it is provided. On a cache hit, the file and handler created
+  // here are dropped in favor of the cached ones.
+  const absl::string_view content = model_file_handler->GetFileContent();
+  ASSIGN_OR_RETURN(
+      std::shared_ptr<const ModelAssetCache::Asset> asset,
+      ModelAssetCache::GetInstance().GetOrLoad(
+          content,
+          [&]() -> absl::StatusOr<std::unique_ptr<ModelAssetCache::Asset>> {
+            return LoadModel(std::move(model_file_),
+                             std::move(model_file_handler));
+          }));
+  model_file_.reset();
+  loaded_model_ = std::static_pointer_cast<const LoadedModel>(asset);
+  model_packet_ = loaded_model_->model_packet_;
+  metadata_extractor_packet_ = loaded_model_->metadata_extractor_packet_;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::unique_ptr<ModelResources::LoadedModel>>
+ModelResources::LoadModel(
+    std::unique_ptr<proto::ExternalFile> model_file,
+    std::unique_ptr<ExternalFileHandler> model_file_handler) {
+  auto loaded_model = std::make_unique<LoadedModel>(
+      std::move(model_file), std::move(model_file_handler));
+  auto& error_reporter = loaded_model->error_reporter_;
+  const char* buffer_data = loaded_model->content().data();
+  size_t buffer_size = loaded_model->content().size();
   // Verifies that the supplied buffer refers to a valid flatbuffer model,
   // and that it uses only operators that are supported by the OpResolver
   // that was passed to the ModelResources constructor, and then builds
   // the model from the buffer.
   auto model = tflite_shims::FlatBufferModel::VerifyAndBuildFromBuffer(
-      buffer_data, buffer_size, &verifier_, &error_reporter_);
+      buffer_data, buffer_size, &verifier_, &error_reporter);
   if (model == nullptr) {
     static constexpr char kInvalidFlatbufferMessage[] =
         "The model is not a valid Flatbuffer";
     // To be replaced with a proper switch-case when TFLite model builder
     // returns a `MediaPipeTasksStatus` code capturing this type of error.
-    if (absl::StrContains(error_reporter_.message(),
+    if (absl::StrContains(error_reporter.message(),
                           kInvalidFlatbufferMessage)) {
       return CreateStatusWithPayload(
-          StatusCode::kInvalidArgument, error_reporter_.message(),
+          StatusCode::kInvalidArgument, error_reporter.message(),
           MediaPipeTasksStatus::kInvalidFlatBufferError);
-    } else if (absl::StrContains(error_reporter_.message(),
+    } else if (absl::StrContains(error_reporter.message(),
                                  "Error loading model from buffer")) {
       return CreateStatusWithPayload(
           StatusCode::kInvalidArgument, kInvalidFlatbufferMessage,
@@ -136,19 +191,20 @@ absl::Status ModelResources::BuildModelFromExternalFileProto() {
           StatusCode::kUnknown,
           absl::StrCat(
               "Could not build model from the provided pre-loaded flatbuffer: ",
-              error_reporter_.message()));
+              error_reporter.message()));
     }
   }
 
-  model_packet_ = MakePacket<ModelPtr>(
+  loaded_model->model_packet_ = MakePacket<ModelPtr>(
       model.release(),
       [](tflite_shims::FlatBufferModel* model) { delete model; });
   ASSIGN_OR_RETURN(auto model_metadata_extractor,
                    metadata::ModelMetadataExtractor::CreateFromModelBuffer(
                        buffer_data, buffer_size));
-  metadata_extractor_packet_ = PacketAdopting<metadata::ModelMetadataExtractor>(
-      std::move(model_metadata_extractor));
-  return absl::OkStatus();
+  loaded_model->metadata_extractor_packet_ =
+      PacketAdopting<metadata::ModelMetadataExtractor>(
+          std::move(model_metadata_extractor));
+  return loaded_model;
 }
 
 }  // namespace core
@@ -81,7 +81,7 @@ class ModelResources {
   std::string GetTag() const { return tag_; }
 
   // Returns a copy of the model file proto.
-  proto::ExternalFile GetModelFile() const { return *model_file_; }
+  proto::ExternalFile GetModelFile() const;
 
   // Returns a pointer to tflite::model.
   const tflite::Model* GetTfLiteModel() const;
@@ -119,18 +119,29 @@ class ModelResources {
                  std::unique_ptr<proto::ExternalFile> model_file,
                  api2::Packet<tflite::OpResolver> op_resolver_packet);
 
-  // Builds the TFLite model from the ExternalFile proto.
+  // The model file, its content and the TFLite model built from it. Loaded
+  // models are shared through the ModelAssetCache by all the ModelResources
+  // created from the same model content.
+  class LoadedModel;
+
+  // Builds the TFLite model from the ExternalFile proto, or reuses the cached
+  // one if the same model content was loaded before.
   absl::Status BuildModelFromExternalFileProto();
 
+  // Verifies and builds the TFLite model from the content of the given file.
+  absl::StatusOr<std::unique_ptr<LoadedModel>> LoadModel(
+      std::unique_ptr<proto::ExternalFile> model_file,
+      std::unique_ptr<ExternalFileHandler> model_file_handler);
+
   // The model resources tag.
   const std::string tag_;
-  // The model file.
+  // The model file. Handed over to loaded_model_ once the model is loaded.
   std::unique_ptr<proto::ExternalFile> model_file_;
   // The packet stores the TFLite op resolver.
   api2::Packet<tflite::OpResolver> op_resolver_packet_;
 
-  // The ExternalFileHandler for the model.
-  std::unique_ptr<ExternalFileHandler> model_file_handler_;
+  // The loaded model, which owns the model file and its content.
+  std::shared_ptr<const LoadedModel> loaded_model_;
   // The packet stores the TFLite model for actual inference.
   api2::Packet<ModelPtr> model_packet_;
   // The packet stores the TFLite Metadata extractor built from the model.
@@ -138,9 +149,6 @@ class ModelResources {
 
   // Extra verifier for FlatBuffer input data.
   Verifier verifier_;
-  // Error reporter that captures and prints to stderr low-level TFLite
-  // error messages.
-  mediapipe::util::tflite::ErrorReporter error_reporter_;
 };
 
 }  // namespace core
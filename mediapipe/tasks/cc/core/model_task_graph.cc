@@ -55,6 +55,7 @@ using ::mediapipe::tasks::core::proto::Acceleration;
 using ::mediapipe::tasks::core::proto::InferenceSubgraphOptions;
 using ::mediapipe::tasks::core::proto::ModelResourcesCalculatorOptions;
 
+constexpr char kInferenceCalculatorName[] = "InferenceCalculator";
 constexpr char kMetadataExtractorTag[] = "METADATA_EXTRACTOR";
 constexpr char kModelTag[] = "MODEL";
 constexpr char kOpResolverTag[] = "OP_RESOLVER";
@@ -96,16 +97,36 @@ class InferenceSubgraph : public Subgraph {
     model_resources_node.SideOut(kMetadataExtractorTag) >>
         graph.SideOut(kMetadataExtractorTag);
 
-    auto& inference_node = graph.AddNode("InferenceCalculator");
-    inference_node.GetOptions<mediapipe::InferenceCalculatorOptions>()
-        .mutable_delegate()
-        ->CopyFrom(inference_delegate);
+    auto& inference_node = graph.AddNode(kInferenceCalculatorName);
+    auto& inference_options =
+        inference_node.GetOptions<mediapipe::InferenceCalculatorOptions>();
+    inference_options.mutable_delegate()->CopyFrom(inference_delegate);
+    // Parallel invocations each take an interpreter from a pool, which the GPU
+    // inference calculators don't have.
+    const int max_in_flight =
+        inference_delegate.has_gpu()
+            ? 1
+            : std::max(1, subgraph_options->max_in_flight());
+    if (max_in_flight > 1) {
+      inference_options.set_num_interpreters(max_in_flight);
+    }
     model_resources_node.SideOut(kModelTag) >> inference_node.SideIn(kModelTag);
     model_resources_node.SideOut(kOpResolverTag) >>
         inference_node.SideIn(kOpResolverTag);
     graph.In(kTensorsTag) >> inference_node.In(kTensorsTag);
     inference_node.Out(kTensorsTag) >> graph.Out(kTensorsTag);
-    return graph.GetConfig();
+
+    // As mediapipe GraphBuilder currently doesn't support configuring
+    // max_in_flight, modifying the CalculatorGraphConfig proto directly.
+    CalculatorGraphConfig config = graph.GetConfig();
+    if (max_in_flight > 1) {
+      for (auto& node : *config.mutable_node()) {
+        if (node.calculator() == kInferenceCalculatorName) {
+          node.set_max_in_flight(max_in_flight);
+        }
+      }
+    }
+    return config;
   }
 
  private:
@@ -170,7 +191,8 @@ absl::StatusOr<const ModelResources*> ModelTaskGraph::CreateModelResources(
 
 GenericNode& ModelTaskGraph::AddInference(
     const ModelResources& model_resources,
-    const proto::Acceleration& acceleration, Graph& graph) const {
+    const proto::Acceleration& acceleration, Graph& graph,
+    int max_in_flight) const {
   auto& inference_subgraph =
       graph.AddNode("mediapipe.tasks.core.InferenceSubgraph");
   auto& inference_subgraph_opts =
@@ -178,6 +200,9 @@ GenericNode& ModelTaskGraph::AddInference(
   inference_subgraph_opts.mutable_base_options()
       ->mutable_acceleration()
       ->CopyFrom(acceleration);
+  if (max_in_flight > 1) {
+    inference_subgraph_opts.set_max_in_flight(max_in_flight);
+  }
   // When the model resources tag is available, the ModelResourcesCalculator
   // will retrieve the cached model resources from the graph service by tag.
   // Otherwise, provides the external file and asks the
@@ -27,6 +27,7 @@ limitations under the License.
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/subgraph.h"
+#include "mediapipe/tasks/cc/core/model_asset_cache.h"
 #include "mediapipe/tasks/cc/core/model_resources.h"
 #include "mediapipe/tasks/cc/core/proto/acceleration.pb.h"
 #include "mediapipe/tasks/cc/core/proto/base_options.pb.h"
@@ -60,10 +61,18 @@ class ModelTaskGraph : public Subgraph {
   template <typename Options>
   absl::StatusOr<const ModelResources*> CreateModelResources(
       SubgraphContext* sc) {
+    auto* base_options =
+        sc->MutableOptions<Options>()->mutable_base_options();
+    if (base_options->has_model_cache_options()) {
+      ModelAssetCache::Limits limits;
+      limits.max_unused_bytes =
+          base_options->model_cache_options().max_unused_bytes();
+      limits.max_unused_assets =
+          base_options->model_cache_options().max_unused_models();
+      ModelAssetCache::GetInstance().SetLimits(limits);
+    }
     auto external_file = std::make_unique<proto::ExternalFile>();
-    external_file->Swap(sc->MutableOptions<Options>()
-                            ->mutable_base_options()
-                            ->mutable_model_asset());
+    external_file->Swap(base_options->mutable_model_asset());
     return CreateModelResources(sc, std::move(external_file));
   }
 
@@ -88,10 +97,12 @@ class ModelTaskGraph : public Subgraph {
   //     "TENSORS", representing the output tensors generated by the inference
   //     engine.
   //   - a MetadataExtractor output side packet with tag "METADATA_EXTRACTOR".
+  // With `max_in_flight` > 1, that many inputs may run inference at the same
+  // time on CPU, e.g. the RoIs of a single frame sent through a loop.
   api2::builder::GenericNode& AddInference(
       const ModelResources& model_resources,
-      const proto::Acceleration& acceleration,
-      api2::builder::Graph& graph) const;
+      const proto::Acceleration& acceleration, api2::builder::Graph& graph,
+      int max_in_flight = 1) const;
 
  private:
   std::unique_ptr<ModelResources> local_model_resources_;
@@ -33,6 +33,8 @@ limitations under the License.
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/tool/name_util.h"
 #include "mediapipe/tasks/cc/common.h"
 #include "mediapipe/tasks/cc/core/model_resources_cache.h"
@@ -42,6 +44,17 @@ namespace tasks {
 namespace core {
 namespace {
 
+// The callback set by TaskRunner::SetGraphProfilesCallback().
+struct GlobalGraphProfilesCallback {
+  absl::Mutex mutex;
+  GraphProfilesCallback callback ABSL_GUARDED_BY(mutex);
+};
+
+GlobalGraphProfilesCallback& GetGlobalGraphProfilesCallback() {
+  static auto* global = new GlobalGraphProfilesCallback();
+  return *global;
+}
+
 absl::StatusOr<Timestamp> ValidateAndGetPacketTimestamp(
     const PacketMap& packet_map) {
   if (packet_map.empty()) {
@@ -85,27 +98,43 @@ absl::StatusOr<PacketMap> GenerateOutputPacketMap(
 
 }  // namespace
 
+/* static */
+void TaskRunner::SetGraphProfilesCallback(GraphProfilesCallback callback) {
+  auto& global = GetGlobalGraphProfilesCallback();
+  absl::MutexLock lock(&global.mutex);
+  global.callback = std::move(callback);
+}
+
 /* static */
 absl::StatusOr<std::unique_ptr<TaskRunner>> TaskRunner::Create(
     CalculatorGraphConfig config,
     std::unique_ptr<tflite::OpResolver> op_resolver,
-    PacketsCallback packets_callback) {
+    PacketsCallback packets_callback, int num_graph_instances) {
   auto task_runner = absl::WrapUnique(new TaskRunner(packets_callback));
-  MP_RETURN_IF_ERROR(
-      task_runner->Initialize(std::move(config), std::move(op_resolver)));
+  MP_RETURN_IF_ERROR(task_runner->Initialize(
+      std::move(config), std::move(op_resolver), num_graph_instances));
   MP_RETURN_IF_ERROR(task_runner->Start());
   return task_runner;
 }
 
 absl::Status TaskRunner::Initialize(
     CalculatorGraphConfig config,
-    std::unique_ptr<tflite::OpResolver> op_resolver) {
+    std::unique_ptr<tflite::OpResolver> op_resolver, int num_graph_instances) {
   if (initialized_) {
     return CreateStatusWithPayload(
         absl::StatusCode::kInvalidArgument,
         "Task runner is already initialized.",
         MediaPipeTasksStatus::kRunnerInitializationError);
   }
+  if (num_graph_instances < 1 ||
+      (num_graph_instances > 1 && packets_callback_)) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        absl::StrCat("Invalid number of graph instances: ",
+                     num_graph_instances,
+                     ". Multiple instances require the synchronous mode."),
+        MediaPipeTasksStatus::kRunnerInitializationError);
+  }
   for (const auto& output : config.output_stream()) {
     auto name = mediapipe::tool::ParseNameFromStream(output);
     if (name.empty()) {
@@ -123,38 +152,70 @@ absl::Status TaskRunner::Initialize(
         MediaPipeTasksStatus::kRunnerInitializationError);
   }
   config.clear_output_stream();
-  PacketMap input_side_packets;
-  if (packets_callback_) {
-    tool::AddMultiStreamCallback(
-        output_stream_names_,
-        [this](const std::vector<Packet>& packets) {
-          packets_callback_(
-              GenerateOutputPacketMap(packets, output_stream_names_));
-          return;
-        },
-        &config, &input_side_packets,
-        /*observe_timestamp_bounds=*/true);
-  } else {
-    mediapipe::tool::AddMultiStreamCallback(
-        output_stream_names_,
-        [this](const std::vector<Packet>& packets) {
-          status_or_output_packets_ =
-              GenerateOutputPacketMap(packets, output_stream_names_);
-          return;
-        },
-        &config, &input_side_packets, /*observe_timestamp_bounds=*/true);
+  {
+    auto& global = GetGlobalGraphProfilesCallback();
+    absl::MutexLock lock(&global.mutex);
+    graph_profiles_callback_ = global.callback;
+  }
+  if (graph_profiles_callback_) {
+    config.mutable_profiler_config()->set_enable_profiler(true);
   }
+  // All instances share the model resources, so models are only loaded once.
   auto model_resources_cache =
       std::make_shared<ModelResourcesCache>(std::move(op_resolver));
-  MP_RETURN_IF_ERROR(
-      AddPayload(graph_.SetServiceObject(kModelResourcesCacheService,
+  for (int i = 0; i < num_graph_instances; ++i) {
+    auto instance = std::make_unique<GraphInstance>();
+    GraphInstance* instance_ptr = instance.get();
+    CalculatorGraphConfig instance_config = config;
+    PacketMap input_side_packets;
+    if (packets_callback_) {
+      tool::AddMultiStreamCallback(
+          output_stream_names_,
+          [this](const std::vector<Packet>& packets) {
+            packets_callback_(
+                GenerateOutputPacketMap(packets, output_stream_names_));
+            return;
+          },
+          &instance_config, &input_side_packets,
+          /*observe_timestamp_bounds=*/true);
+    } else {
+      mediapipe::tool::AddMultiStreamCallback(
+          output_stream_names_,
+          [this, instance_ptr](const std::vector<Packet>& packets) {
+            instance_ptr->status_or_output_packets =
+                GenerateOutputPacketMap(packets, output_stream_names_);
+            if (instance_ptr->batch_outputs &&
+                instance_ptr->status_or_output_packets.ok()) {
+              for (const Packet& packet : packets) {
+                if (packet.IsEmpty()) continue;
+                (*instance_ptr->batch_outputs)[packet.Timestamp()] =
+                    *instance_ptr->status_or_output_packets;
+                break;
+              }
+            }
+            return;
+          },
+          &instance_config, &input_side_packets,
+          /*observe_timestamp_bounds=*/true);
+    }
+    MP_RETURN_IF_ERROR(AddPayload(
+        instance->graph.SetServiceObject(kModelResourcesCacheService,
                                          model_resources_cache),
-                 "ModelResourcesCacheService is not set up successfully.",
-                 MediaPipeTasksStatus::kRunnerModelResourcesCacheServiceError));
-  MP_RETURN_IF_ERROR(
-      AddPayload(graph_.Initialize(std::move(config), input_side_packets),
-                 "MediaPipe CalculatorGraph is not successfully initialized.",
-                 MediaPipeTasksStatus::kRunnerInitializationError));
+        "ModelResourcesCacheService is not set up successfully.",
+        MediaPipeTasksStatus::kRunnerModelResourcesCacheServiceError));
+    MP_RETURN_IF_ERROR(AddPayload(
+        instance->graph.Initialize(std::move(instance_config),
+                                   input_side_packets),
+        "MediaPipe CalculatorGraph is not successfully initialized.",
+        MediaPipeTasksStatus::kRunnerInitializationError));
+    instances_.push_back(std::move(instance));
+  }
+  {
+    absl::MutexLock lock(&mutex_);
+    for (auto& instance : instances_) {
+      free_instances_.push_back(instance.get());
+    }
+  }
   initialized_ = true;
   return absl::OkStatus();
 }
@@ -170,25 +231,27 @@ absl::Status TaskRunner::Start() {
         absl::StatusCode::kInvalidArgument, "Task runner is already running.",
         MediaPipeTasksStatus::kRunnerFailsToStartError);
   }
-  {
-    absl::MutexLock lock(&mutex_);
-    last_seen_ = Timestamp::Unset();
+  for (auto& instance : instances_) {
+    {
+      absl::MutexLock lock(&mutex_);
+      instance->last_seen = Timestamp::Unset();
+    }
+    MP_RETURN_IF_ERROR(
+        AddPayload(instance->graph.StartRun({}),
+                   "MediaPipe CalculatorGraph is not successfully started.",
+                   MediaPipeTasksStatus::kRunnerFailsToStartError));
+    // Waits until the graph becomes idle to ensure that all calculators are
+    // successfully opened.
+    MP_RETURN_IF_ERROR(
+        AddPayload(instance->graph.WaitUntilIdle(),
+                   "MediaPipe CalculatorGraph is not successfully started.",
+                   MediaPipeTasksStatus::kRunnerFailsToStartError));
   }
-  MP_RETURN_IF_ERROR(
-      AddPayload(graph_.StartRun({}),
-                 "MediaPipe CalculatorGraph is not successfully started.",
-                 MediaPipeTasksStatus::kRunnerFailsToStartError));
-  // Waits until the graph becomes idle to ensure that all calculators are
-  // successfully opened.
-  MP_RETURN_IF_ERROR(
-      AddPayload(graph_.WaitUntilIdle(),
-                 "MediaPipe CalculatorGraph is not successfully started.",
-                 MediaPipeTasksStatus::kRunnerFailsToStartError));
   is_running_ = true;
   return absl::OkStatus();
 }
 
-absl::StatusOr<PacketMap> TaskRunner::Process(PacketMap inputs) {
+absl::Status TaskRunner::CheckSyncProcessingAllowed() {
   if (!is_running_) {
     return CreateStatusWithPayload(
         absl::StatusCode::kInvalidArgument,
@@ -202,25 +265,38 @@ absl::StatusOr<PacketMap> TaskRunner::Process(PacketMap inputs) {
         "callback is provided.",
         MediaPipeTasksStatus::kRunnerApiCalledInWrongModeError);
   }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<PacketMap> TaskRunner::Process(PacketMap inputs) {
+  MP_RETURN_IF_ERROR(CheckSyncProcessingAllowed());
   ASSIGN_OR_RETURN(auto input_timestamp, ValidateAndGetPacketTimestamp(inputs));
   // MediaPipe reports runtime errors through CalculatorGraph::WaitUntilIdle or
   // WaitUntilDone without indicating the exact packet timestamp.
   // To ensure that the TaskRunner::Process reports errors per invocation,
-  // the rest of the method is guarded by a lock, which guarantees that only one
-  // invocation can be processed in the graph concurrently.
+  // each invocation claims a graph instance for its whole duration, which
+  // guarantees that only one invocation is processed in each graph at a time.
   // TODO: Switches back to the original high performance implementation
   // when the MediaPipe CalculatorGraph can report errors in output streams.
-  absl::MutexLock lock(&mutex_);
+  GraphInstance* instance = AcquireInstance();
+  auto status_or_outputs =
+      ProcessOnInstance(*instance, std::move(inputs), input_timestamp);
+  ReleaseInstance(instance);
+  return status_or_outputs;
+}
+
+absl::StatusOr<Timestamp> TaskRunner::AddInputsToInstance(
+    GraphInstance& instance, PacketMap inputs, Timestamp input_timestamp) {
   // Assigns an internal synthetic timestamp when the input packets has no
   // assigned timestamp (packets are with the default Timestamp::Unset()).
   // Using Timestamp increment one second is to avoid interfering with the other
   // synthetic timestamps, such as those defined by BeginLoopCalculator.
-  bool use_synthetic_timestamp = input_timestamp == Timestamp::Unset();
-  if (use_synthetic_timestamp) {
-    input_timestamp = last_seen_ == Timestamp::Unset()
+  Timestamp& last_seen = instance.last_seen;
+  if (input_timestamp == Timestamp::Unset()) {
+    input_timestamp = last_seen == Timestamp::Unset()
                           ? Timestamp(0)
-                          : last_seen_ + Timestamp::kTimestampUnitsPerSecond;
-  } else if (input_timestamp <= last_seen_) {
+                          : last_seen + Timestamp::kTimestampUnitsPerSecond;
+  } else if (input_timestamp <= last_seen) {
     return CreateStatusWithPayload(
         absl::StatusCode::kInvalidArgument,
         "Input timestamp must be monotonically increasing.",
@@ -228,26 +304,101 @@ absl::StatusOr<PacketMap> TaskRunner::Process(PacketMap inputs) {
   }
   for (auto& [stream_name, packet] : inputs) {
     MP_RETURN_IF_ERROR(AddPayload(
-        graph_.AddPacketToInputStream(stream_name,
-                                      std::move(packet).At(input_timestamp)),
+        instance.graph.AddPacketToInputStream(
+            stream_name, std::move(packet).At(input_timestamp)),
         absl::StrCat("Failed to add packet to the graph input stream: ",
                      stream_name),
         MediaPipeTasksStatus::kRunnerUnexpectedInputError));
   }
-  last_seen_ = input_timestamp;
-  if (!graph_.WaitUntilIdle().ok()) {
+  last_seen = input_timestamp;
+  return input_timestamp;
+}
+
+absl::StatusOr<PacketMap> TaskRunner::ProcessOnInstance(
+    GraphInstance& instance, PacketMap inputs, Timestamp input_timestamp) {
+  bool use_synthetic_timestamp = input_timestamp == Timestamp::Unset();
+  MP_RETURN_IF_ERROR(
+      AddInputsToInstance(instance, std::move(inputs), input_timestamp)
+          .status());
+  if (!instance.graph.WaitUntilIdle().ok()) {
     absl::Status graph_status;
-    graph_.GetCombinedErrors(&graph_status);
+    instance.graph.GetCombinedErrors(&graph_status);
     return graph_status;
   }
   // When a synthetic timestamp is used, uses the timestamp of the first
   // output packet as the last seen timestamp if there is any output packet.
-  if (use_synthetic_timestamp && status_or_output_packets_.ok()) {
-    for (auto& kv : status_or_output_packets_.value()) {
-      last_seen_ = std::max(kv.second.Timestamp(), last_seen_);
+  if (use_synthetic_timestamp && instance.status_or_output_packets.ok()) {
+    for (auto& kv : instance.status_or_output_packets.value()) {
+      instance.last_seen = std::max(kv.second.Timestamp(), instance.last_seen);
+    }
+  }
+  return instance.status_or_output_packets;
+}
+
+absl::StatusOr<std::vector<PacketMap>> TaskRunner::ProcessBatch(
+    std::vector<PacketMap> inputs) {
+  MP_RETURN_IF_ERROR(CheckSyncProcessingAllowed());
+  GraphInstance* instance = AcquireInstance();
+  auto status_or_outputs = ProcessBatchOnInstance(*instance, std::move(inputs));
+  instance->batch_outputs = nullptr;
+  ReleaseInstance(instance);
+  return status_or_outputs;
+}
+
+absl::StatusOr<std::vector<PacketMap>> TaskRunner::ProcessBatchOnInstance(
+    GraphInstance& instance, std::vector<PacketMap> inputs) {
+  std::map<Timestamp, PacketMap> outputs_by_timestamp;
+  instance.batch_outputs = &outputs_by_timestamp;
+  std::vector<Timestamp> input_timestamps;
+  input_timestamps.reserve(inputs.size());
+  for (auto& input : inputs) {
+    ASSIGN_OR_RETURN(auto input_timestamp,
+                     ValidateAndGetPacketTimestamp(input));
+    ASSIGN_OR_RETURN(input_timestamp,
+                     AddInputsToInstance(instance, std::move(input),
+                                         input_timestamp));
+    input_timestamps.push_back(input_timestamp);
+  }
+  if (!instance.graph.WaitUntilIdle().ok()) {
+    absl::Status graph_status;
+    instance.graph.GetCombinedErrors(&graph_status);
+    return graph_status;
+  }
+  std::vector<PacketMap> outputs;
+  outputs.reserve(input_timestamps.size());
+  for (Timestamp input_timestamp : input_timestamps) {
+    auto it = outputs_by_timestamp.find(input_timestamp);
+    if (it != outputs_by_timestamp.end()) {
+      outputs.push_back(std::move(it->second));
+      continue;
     }
+    // Only a timestamp bound was produced for this input, as in Process().
+    PacketMap empty_outputs;
+    for (const auto& stream_name : output_stream_names_) {
+      empty_outputs[stream_name] = Packet();
+    }
+    outputs.push_back(std::move(empty_outputs));
+  }
+  if (!outputs_by_timestamp.empty()) {
+    instance.last_seen =
+        std::max(instance.last_seen, outputs_by_timestamp.rbegin()->first);
   }
-  return status_or_output_packets_;
+  return outputs;
+}
+
+TaskRunner::GraphInstance* TaskRunner::AcquireInstance() {
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(
+      +[](std::vector<GraphInstance*>* free) { return !free->empty(); },
+      &free_instances_));
+  GraphInstance* instance = free_instances_.back();
+  free_instances_.pop_back();
+  return instance;
+}
+
+void TaskRunner::ReleaseInstance(GraphInstance* instance) {
+  absl::MutexLock lock(&mutex_);
+  free_instances_.push_back(instance);
 }
 
 absl::Status TaskRunner::Send(PacketMap inputs) {
@@ -273,7 +424,8 @@ absl::Status TaskRunner::Send(PacketMap inputs) {
         MediaPipeTasksStatus::kRunnerInvalidTimestampError);
   }
   absl::MutexLock lock(&mutex_);
-  if (input_timestamp <= last_seen_) {
+  GraphInstance& instance = *instances_.front();
+  if (input_timestamp <= instance.last_seen) {
     return CreateStatusWithPayload(
         absl::StatusCode::kInvalidArgument,
         "Input timestamp must be monotonically increasing.",
@@ -281,14 +433,14 @@ absl::Status TaskRunner::Send(PacketMap inputs) {
   }
   for (auto& [stream_name, packet] : inputs) {
     MP_RETURN_IF_ERROR(AddPayload(
-        graph_.AddPacketToInputStream(stream_name,
-                                      std::move(packet).At(input_timestamp)),
+        instance.graph.AddPacketToInputStream(
+            stream_name, std::move(packet).At(input_timestamp)),
         absl::Substitute("Failed to add packet to the graph input stream: $0 "
                          "at timestamp: $1",
                          stream_name, input_timestamp.Value()),
         MediaPipeTasksStatus::kRunnerUnexpectedInputError));
   }
-  last_seen_ = input_timestamp;
+  instance.last_seen = input_timestamp;
   return absl::OkStatus();
 }
 
@@ -300,12 +452,26 @@ absl::Status TaskRunner::Close() {
         MediaPipeTasksStatus::kRunnerFailsToCloseError);
   }
   is_running_ = false;
-  MP_RETURN_IF_ERROR(
-      AddPayload(graph_.CloseAllInputStreams(), "Fail to close intput streams",
-                 MediaPipeTasksStatus::kRunnerFailsToCloseError));
-  MP_RETURN_IF_ERROR(AddPayload(
-      graph_.WaitUntilDone(), "Fail to shutdown the MediaPipe graph.",
-      MediaPipeTasksStatus::kRunnerFailsToCloseError));
+  for (auto& instance : instances_) {
+    MP_RETURN_IF_ERROR(
+        AddPayload(instance->graph.CloseAllInputStreams(),
+                   "Fail to close intput streams",
+                   MediaPipeTasksStatus::kRunnerFailsToCloseError));
+    MP_RETURN_IF_ERROR(AddPayload(
+        instance->graph.WaitUntilDone(),
+        "Fail to shutdown the MediaPipe graph.",
+        MediaPipeTasksStatus::kRunnerFailsToCloseError));
+    if (graph_profiles_callback_) {
+      std::vector<CalculatorProfile> profiles;
+      absl::Status status =
+          instance->graph.profiler()->GetCalculatorProfiles(&profiles);
+      if (status.ok()) {
+        graph_profiles_callback_(profiles);
+      } else {
+        LOG(WARNING) << "Cannot get the calculator profiles: " << status;
+      }
+    }
+  }
   return absl::OkStatus();
 }
 
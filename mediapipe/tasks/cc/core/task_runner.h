@@ -34,6 +34,7 @@ limitations under the License.
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
 #include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/tasks/cc/core/model_resources.h"
 #include "mediapipe/tasks/cc/core/model_resources_cache.h"
@@ -48,6 +49,9 @@ namespace core {
 using PacketMap = std::map<std::string, Packet>;
 // A callback method to get output packets from the task runner.
 using PacketsCallback = std::function<void(absl::StatusOr<PacketMap>)>;
+// A callback method to get the calculator profiles of a task graph.
+using GraphProfilesCallback =
+    std::function<void(const std::vector<CalculatorProfile>&)>;
 
 // The mediapipe task runner class.
 // The runner has two processing modes: synchronous mode and asynchronous mode.
@@ -70,10 +74,14 @@ class TaskRunner {
   // asynchronous method, Send(), to provide the input packets. If the packets
   // callback is absent, clients must use the synchronous method, Process(), to
   // provide the input packets and receive the output packets.
+  // If num_graph_instances is greater than 1, the task runner keeps that many
+  // copies of the graph, all sharing the same ModelResourcesCache, and
+  // concurrent Process() calls run on whichever instance is free. This is
+  // only supported in the synchronous mode, i.e. without a packets callback.
   static absl::StatusOr<std::unique_ptr<TaskRunner>> Create(
       CalculatorGraphConfig config,
       std::unique_ptr<tflite::OpResolver> op_resolver = nullptr,
-      PacketsCallback packets_callback = nullptr);
+      PacketsCallback packets_callback = nullptr, int num_graph_instances = 1);
 
   // TaskRunner is neither copyable nor movable.
   TaskRunner(const TaskRunner&) = delete;
@@ -86,12 +94,22 @@ class TaskRunner {
   // If the input packets have no timestamp, an internal timestamp will be
   // assigend per invocation. Otherwise, when the timestamp is set in the
   // input packets, the caller must ensure that the input packet timestamps are
-  // greater than the timestamps of the previous invocation. This method is
-  // thread-unsafe and it is the caller's responsibility to synchronize access
-  // to this method across multiple threads and to ensure that the input packet
-  // timestamps are in order.
+  // greater than the timestamps of the previous invocation. Concurrent calls
+  // are serialized when the task runner has a single graph instance, and
+  // otherwise run in parallel on separate instances; in that case each
+  // instance checks the timestamp order of the calls that it receives, so
+  // callers that set timestamps should use one task runner per stream.
   absl::StatusOr<PacketMap> Process(PacketMap inputs);
 
+  // A synchronous method that processes a batch of unrelated inputs in a
+  // single graph run. All inputs are added to the graph before waiting for the
+  // results, so the calculators can work on several inputs at once instead of
+  // making a full graph round trip per input. Returns one output packet map
+  // per input, in the same order. The timestamp rules of Process() apply to
+  // each input in turn.
+  absl::StatusOr<std::vector<PacketMap>> ProcessBatch(
+      std::vector<PacketMap> inputs);
+
   // An asynchronous method that is designed for handling live streaming data
   // such as live camera and microphone data. A user-defined PacketsCallback
   // function must be provided in the constructor to receive the output packets.
@@ -110,10 +128,31 @@ class TaskRunner {
   // a stateful task graph to process new data.
   absl::Status Restart();
 
+  // Sets a process-wide callback that receives the calculator profiles of
+  // each task graph when its task runner is closed. While a callback is set,
+  // the task runners created afterwards run their graphs with the graph
+  // profiler enabled. This lets tools such as benchmarks break the runtime of
+  // a task down by calculator, although the task APIs hide the graph. The
+  // profiles are only populated in builds with MEDIAPIPE_PROFILING enabled.
+  // Passing nullptr stops the profiling of new task runners.
+  static void SetGraphProfilesCallback(GraphProfilesCallback callback);
+
   // Returns the canonicalized CalculatorGraphConfig of the underlying graph.
-  const CalculatorGraphConfig& GetGraphConfig() { return graph_.Config(); }
+  const CalculatorGraphConfig& GetGraphConfig() {
+    return instances_.front()->graph.Config();
+  }
 
  private:
+  // A copy of the task graph and the state of the calls running on it.
+  struct GraphInstance {
+    CalculatorGraph graph;
+    // The output of the last Process() call on this instance.
+    absl::StatusOr<PacketMap> status_or_output_packets;
+    // While a ProcessBatch() call runs, collects the outputs by timestamp.
+    std::map<Timestamp, PacketMap>* batch_outputs = nullptr;
+    Timestamp last_seen = Timestamp::Unset();
+  };
+
   // Constructor.
   // Creates a TaskRunner instance with an optional PacketsCallback method.
   TaskRunner(PacketsCallback packets_callback = nullptr)
@@ -125,22 +164,44 @@ class TaskRunner {
   // be only initialized once.
   absl::Status Initialize(
       CalculatorGraphConfig config,
-      std::unique_ptr<tflite::OpResolver> op_resolver = nullptr);
+      std::unique_ptr<tflite::OpResolver> op_resolver = nullptr,
+      int num_graph_instances = 1);
 
   // Starts the task runner. Returns an ok status to indicate that the
   // runner is ready to accept input data. Otherwise, returns an error status to
   // indicate that the runner isn't started successfully.
   absl::Status Start();
 
+  // Waits until an instance is free and claims it for a Process() call.
+  GraphInstance* AcquireInstance();
+  void ReleaseInstance(GraphInstance* instance);
+  // Runs one Process() call on an instance acquired by the caller.
+  absl::StatusOr<PacketMap> ProcessOnInstance(GraphInstance& instance,
+                                              PacketMap inputs,
+                                              Timestamp input_timestamp);
+  // Validates the timestamp of a Process() input, or assigns a synthetic one,
+  // and adds the packets to the instance's graph.
+  absl::StatusOr<Timestamp> AddInputsToInstance(GraphInstance& instance,
+                                                PacketMap inputs,
+                                                Timestamp input_timestamp);
+  absl::StatusOr<std::vector<PacketMap>> ProcessBatchOnInstance(
+      GraphInstance& instance, std::vector<PacketMap> inputs);
+  // Checks that the task runner is running in the synchronous mode.
+  absl::Status CheckSyncProcessingAllowed();
+
   PacketsCallback packets_callback_;
+  // The process-wide GraphProfilesCallback when this runner was initialized.
+  GraphProfilesCallback graph_profiles_callback_;
   std::vector<std::string> output_stream_names_;
-  CalculatorGraph graph_;
+  // Send() always uses the first instance, which is the only one in that
+  // mode, and accesses it under mutex_. Process() owns the instance that it
+  // acquired until it returns.
+  std::vector<std::unique_ptr<GraphInstance>> instances_;
   bool initialized_ = false;
   std::atomic_bool is_running_ = false;
 
-  absl::StatusOr<PacketMap> status_or_output_packets_;
-  Timestamp last_seen_ ABSL_GUARDED_BY(mutex_);
   absl::Mutex mutex_;
+  std::vector<GraphInstance*> free_instances_ ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace core
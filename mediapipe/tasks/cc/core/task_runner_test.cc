@@ -22,6 +22,7 @@ limitations under the License.
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -254,6 +255,87 @@ TEST_F(TaskRunnerTest, MultiThreadSyncAPICallsWithoutTimestamp) {
   MP_ASSERT_OK(runner->Close());
 }
 
+TEST_F(TaskRunnerTest, MultiThreadSyncAPICallsWithGraphInstancePool) {
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto runner, TaskRunner::Create(GetPassThroughGraphConfig(),
+                                      /*op_resolver=*/nullptr,
+                                      /*packets_callback=*/nullptr,
+                                      /*num_graph_instances=*/3));
+
+  constexpr int kNumThreads = 10;
+  std::vector<std::thread> threads;
+  // Calls Process() in multiple threads simultaneously.
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([i, &runner]() {
+      for (int j = 0; j < 30; ++j) {
+        auto status_or_result =
+            runner->Process({{"in", MakePacket<int>(i * j)}});
+        ASSERT_TRUE(status_or_result.ok());
+        EXPECT_EQ(i * j, status_or_result.value()["out"].Get<int>());
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  MP_ASSERT_OK(runner->Restart());
+  MP_ASSERT_OK(runner->Process({{"in", MakePacket<int>(0)}}));
+  MP_ASSERT_OK(runner->Close());
+}
+
+TEST_F(TaskRunnerTest, ProcessBatch) {
+  MP_ASSERT_OK_AND_ASSIGN(auto runner,
+                          TaskRunner::Create(GetPassThroughGraphConfig()));
+  for (int round = 0; round < 2; ++round) {
+    std::vector<PacketMap> inputs;
+    for (int i = 0; i < 20; ++i) {
+      inputs.push_back({{"in", MakePacket<int>(round * 100 + i)}});
+    }
+    MP_ASSERT_OK_AND_ASSIGN(auto results,
+                            runner->ProcessBatch(std::move(inputs)));
+    ASSERT_EQ(results.size(), 20);
+    for (int i = 0; i < 20; ++i) {
+      EXPECT_EQ(round * 100 + i, results[i]["out"].Get<int>());
+    }
+  }
+  // Single calls continue after the timestamps used by the batches.
+  MP_ASSERT_OK_AND_ASSIGN(auto result,
+                          runner->Process({{"in", MakePacket<int>(7)}}));
+  EXPECT_EQ(7, result["out"].Get<int>());
+  MP_ASSERT_OK(runner->Close());
+}
+
+TEST_F(TaskRunnerTest, GraphInstancePoolRequiresSyncMode) {
+  auto status_or_runner = TaskRunner::Create(
+      GetPassThroughGraphConfig(), /*op_resolver=*/nullptr,
+      [](absl::StatusOr<PacketMap> status_or_packets) {},
+      /*num_graph_instances=*/2);
+  ASSERT_FALSE(status_or_runner.ok());
+  ASSERT_THAT(status_or_runner.status().message(),
+              testing::HasSubstr("Multiple instances require"));
+}
+
+TEST_F(TaskRunnerTest, ReportsGraphProfilesOnClose) {
+  int num_reports = 0;
+  TaskRunner::SetGraphProfilesCallback(
+      [&num_reports](const std::vector<CalculatorProfile>& profiles) {
+        ++num_reports;
+      });
+  MP_ASSERT_OK_AND_ASSIGN(auto runner,
+                          TaskRunner::Create(GetPassThroughGraphConfig()));
+  TaskRunner::SetGraphProfilesCallback(nullptr);
+  EXPECT_TRUE(runner->GetGraphConfig().profiler_config().enable_profiler());
+  MP_ASSERT_OK(runner->Process({{"in", MakePacket<int>(0)}}).status());
+  MP_ASSERT_OK(runner->Close());
+  EXPECT_EQ(num_reports, 1);
+
+  // Runners created after the callback is cleared are not profiled.
+  MP_ASSERT_OK_AND_ASSIGN(auto unprofiled_runner,
+                          TaskRunner::Create(GetPassThroughGraphConfig()));
+  EXPECT_FALSE(
+      unprofiled_runner->GetGraphConfig().profiler_config().enable_profiler());
+  MP_ASSERT_OK(unprofiled_runner->Close());
+  EXPECT_EQ(num_reports, 1);
+}
+
 TEST_F(TaskRunnerTest, AsyncAPICalls) {
   std::function<void(absl::StatusOr<PacketMap>)> callback(
       [](absl::StatusOr<PacketMap> status_or_packets) {
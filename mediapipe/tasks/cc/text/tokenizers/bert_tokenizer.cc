@@ -15,7 +15,13 @@ limitations under the License.
 
 #include "mediapipe/tasks/cc/text/tokenizers/bert_tokenizer.h"
 
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/logging.h"
 #include "tensorflow_text/core/kernels/regex_split.h"
 
 namespace mediapipe {
@@ -56,6 +62,57 @@ bool FlatHashMapBackedWordpiece::LookupWord(int vocab_id,
   return true;
 }
 
+namespace {
+
+std::unique_ptr<FastWordpieceVocab> LoadVocab(
+    const char* vocab_buffer_data, size_t vocab_buffer_size,
+    const BertTokenizerOptions& options) {
+  const absl::string_view buffer(vocab_buffer_data, vocab_buffer_size);
+  if (FastWordpieceVocab::IsCompiled(buffer)) {
+    auto vocab = FastWordpieceVocab::CreateFromCompiled(buffer);
+    if (vocab.ok()) {
+      return std::move(vocab).value();
+    }
+    LOG(ERROR) << "Failed to load the compiled vocab: " << vocab.status();
+    return FastWordpieceVocab::Create({}, options.suffix_indicator,
+                                      options.max_chars_per_subtoken);
+  }
+  return FastWordpieceVocab::Create(
+      LoadVocabFromBuffer(vocab_buffer_data, vocab_buffer_size),
+      options.suffix_indicator, options.max_chars_per_subtoken);
+}
+
+}  // namespace
+
+BertTokenizer::BertTokenizer(std::unique_ptr<FastWordpieceVocab> vocab,
+                             const BertTokenizerOptions& options)
+    : fast_vocab_{std::move(vocab)},
+      vocab_{fast_vocab_.get()},
+      options_{options},
+      delim_re_{options.delim_str},
+      include_delim_re_{options.include_delim_str} {
+  if (fast_vocab_->suffix_indicator() != options_.suffix_indicator ||
+      fast_vocab_->max_chars_per_subtoken() !=
+          options_.max_chars_per_subtoken) {
+    std::vector<std::string> words(fast_vocab_->VocabularySize());
+    for (int i = 0; i < words.size(); ++i) {
+      absl::string_view word;
+      fast_vocab_->LookupWord(i, &word);
+      words[i] = std::string(word);
+    }
+    fast_vocab_ =
+        FastWordpieceVocab::Create(words, options_.suffix_indicator,
+                                   options_.max_chars_per_subtoken);
+    vocab_ = FastWordpieceVocabAdapter(fast_vocab_.get());
+  }
+}
+
+BertTokenizer::BertTokenizer(const char* vocab_buffer_data,
+                             size_t vocab_buffer_size,
+                             const BertTokenizerOptions& options)
+    : BertTokenizer(LoadVocab(vocab_buffer_data, vocab_buffer_size, options),
+                    options) {}
+
 TokenizerResult BertTokenizer::Tokenize(const std::string& input) {
   return TokenizeWordpiece(input);
 }
@@ -70,6 +127,7 @@ WordpieceTokenizerResult BertTokenizer::TokenizeWordpiece(
   std::vector<absl::string_view> tokens;
   std::vector<long long> begin_offsets;
   std::vector<long long> end_offsets;
+  std::vector<int> ids;
 
   // Run through tokenize function
   tensorflow::text::RegexSplit(input, delim_re_, true, include_delim_re_,
@@ -78,12 +136,25 @@ WordpieceTokenizerResult BertTokenizer::TokenizeWordpiece(
   for (int token_index = 0; token_index < tokens.size(); token_index++) {
     auto& token = tokens[token_index];
     int num_word_pieces = 0;
-    tensorflow::text::LookupStatus status = WordpieceTokenize(
-        token, options_.max_bytes_per_token, options_.max_chars_per_subtoken,
-        options_.suffix_indicator, options_.use_unknown_token,
-        options_.unknown_token, options_.split_unknown_chars, &vocab_,
-        &subwords, &wp_absolute_begin_offset, &wp_absolute_end_offset,
-        &num_word_pieces);
+    tensorflow::text::LookupStatus status;
+    ids.clear();
+    if (token.size() <= options_.max_bytes_per_token &&
+        fast_vocab_->TokenizeWord(token, &ids, &wp_absolute_begin_offset,
+                                  &wp_absolute_end_offset)) {
+      for (const int id : ids) {
+        absl::string_view subword;
+        fast_vocab_->LookupWord(id, &subword);
+        subwords.emplace_back(subword);
+      }
+      num_word_pieces = ids.size();
+    } else {
+      status = WordpieceTokenize(
+          token, options_.max_bytes_per_token, options_.max_chars_per_subtoken,
+          options_.suffix_indicator, options_.use_unknown_token,
+          options_.unknown_token, options_.split_unknown_chars, &vocab_,
+          &subwords, &wp_absolute_begin_offset, &wp_absolute_end_offset,
+          &num_word_pieces);
+    }
 
     result.row_lengths.emplace_back(num_word_pieces);
     // for the last num_word_pieces added into wp_absolute_begin_offset and
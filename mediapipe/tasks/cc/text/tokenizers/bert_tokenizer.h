@@ -18,11 +18,13 @@ limitations under the License.
 
 #include <cstddef>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "mediapipe/tasks/cc/text/tokenizers/fast_wordpiece_vocab.h"
 #include "mediapipe/tasks/cc/text/tokenizers/tokenizer.h"
 #include "mediapipe/tasks/cc/text/utils/vocab_utils.h"
 #include "re2/re2.h"
@@ -87,15 +89,24 @@ class FlatHashMapBackedWordpiece : public tensorflow::text::WordpieceVocab {
 };
 
 // Wordpiece tokenizer for bert models. Initialized with a vocab file or vector.
+//
+// Words are tokenized in linear time by a FastWordpieceVocab, and only the
+// words it can't tokenize, e.g. into the unknown token, fall back to
+// tensorflow::text::WordpieceTokenize.
 class BertTokenizer : public mediapipe::tasks::text::tokenizers::Tokenizer {
  public:
   // Initialize the tokenizer from vocab vector and tokenizer configs.
   explicit BertTokenizer(const std::vector<std::string>& vocab,
                          const BertTokenizerOptions& options = {})
-      : vocab_{FlatHashMapBackedWordpiece(vocab)},
-        options_{options},
-        delim_re_{options.delim_str},
-        include_delim_re_{options.include_delim_str} {}
+      : BertTokenizer(
+            FastWordpieceVocab::Create(vocab, options.suffix_indicator,
+                                       options.max_chars_per_subtoken),
+            options) {}
+
+  // Initialize the tokenizer from a compiled vocab and tokenizer configs. The
+  // vocab is recompiled if it was compiled with other configs.
+  explicit BertTokenizer(std::unique_ptr<FastWordpieceVocab> vocab,
+                         const BertTokenizerOptions& options = {});
 
   // Initialize the tokenizer from file path to vocab and tokenizer configs.
   explicit BertTokenizer(const std::string& path_to_vocab,
@@ -104,12 +115,11 @@ class BertTokenizer : public mediapipe::tasks::text::tokenizers::Tokenizer {
                       options) {}
 
   // Initialize the tokenizer from buffer and size of vocab and tokenizer
-  // configs.
+  // configs. The buffer holds either a vocab text file or a vocab compiled by
+  // FastWordpieceVocab, which is then used in place and must outlive the
+  // tokenizer.
   BertTokenizer(const char* vocab_buffer_data, size_t vocab_buffer_size,
-                const BertTokenizerOptions& options = {})
-      : BertTokenizer(mediapipe::tasks::text::LoadVocabFromBuffer(
-                          vocab_buffer_data, vocab_buffer_size),
-                      options) {}
+                const BertTokenizerOptions& options = {});
 
   // Perform tokenization, return tokenized results containing the subwords.
   TokenizerResult Tokenize(const std::string& input) override;
@@ -126,18 +136,36 @@ class BertTokenizer : public mediapipe::tasks::text::tokenizers::Tokenizer {
 
   // Find the id of a wordpiece.
   bool LookupId(absl::string_view key, int* result) const override {
-    return vocab_.LookupId(key, result);
+    return fast_vocab_->LookupId(key, result);
   }
 
   // Find the wordpiece from an id.
   bool LookupWord(int vocab_id, absl::string_view* result) const override {
-    return vocab_.LookupWord(vocab_id, result);
+    return fast_vocab_->LookupWord(vocab_id, result);
   }
 
-  int VocabularySize() const { return vocab_.VocabularySize(); }
+  int VocabularySize() const { return fast_vocab_->VocabularySize(); }
 
  private:
-  mediapipe::tasks::text::tokenizers::FlatHashMapBackedWordpiece vocab_;
+  // Exposes the compiled vocab to tensorflow::text::WordpieceTokenize.
+  class FastWordpieceVocabAdapter : public tensorflow::text::WordpieceVocab {
+   public:
+    explicit FastWordpieceVocabAdapter(const FastWordpieceVocab* vocab)
+        : vocab_(vocab) {}
+
+    tensorflow::text::LookupStatus Contains(absl::string_view key,
+                                            bool* value) const override {
+      int id;
+      *value = vocab_->LookupId(key, &id);
+      return tensorflow::text::LookupStatus();
+    }
+
+   private:
+    const FastWordpieceVocab* vocab_;
+  };
+
+  std::unique_ptr<FastWordpieceVocab> fast_vocab_;
+  FastWordpieceVocabAdapter vocab_;
   BertTokenizerOptions options_;
   RE2 delim_re_;
   RE2 include_delim_re_;
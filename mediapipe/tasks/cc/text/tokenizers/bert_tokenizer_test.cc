@@ -48,6 +48,16 @@ TEST(TokenizerTest, TestTokenizerCreationFromBuffer) {
   AssertTokenizerResults(std::move(tokenizer));
 }
 
+TEST(TokenizerTest, TestTokenizerCreationFromCompiledBuffer) {
+  auto vocab = FastWordpieceVocab::Create(
+      mediapipe::tasks::text::LoadVocabFromFile(kTestVocabPath),
+      kDefaultSuffixIndicator, kDefaultMaxCharsPerSubToken);
+  std::string buffer(vocab->compiled());
+  auto tokenizer =
+      absl::make_unique<BertTokenizer>(buffer.data(), buffer.size());
+  AssertTokenizerResults(std::move(tokenizer));
+}
+
 TEST(TokenizerTest, TestTokenizerCreationFromFile) {
   auto tokenizer = absl::make_unique<BertTokenizer>(kTestVocabPath);
 
@@ -0,0 +1,396 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/text/tokenizers/fast_wordpiece_vocab.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace text {
+namespace tokenizers {
+
+namespace {
+
+// The compiled vocabulary is a header followed by the suffix indicator, the
+// nodes, the edge labels, the edge targets, the failure pops, the token
+// offsets and the token characters, each section starting on an 8-byte
+// boundary.
+constexpr char kMagic[4] = {'M', 'P', 'W', 'P'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kAlignment = 8;
+
+struct Header {
+  char magic[4];
+  uint32_t version;
+  int32_t max_chars_per_subtoken;
+  int32_t suffix_indicator_size;
+  int32_t vocab_size;
+  int32_t vocab_chars_size;
+  int32_t num_nodes;
+  int32_t num_edges;
+  int32_t num_pops;
+  int32_t suffix_root;
+};
+
+size_t Align(size_t size) {
+  return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+template <typename T>
+void AppendSection(const T* data, size_t count, std::string& buffer) {
+  buffer.append(reinterpret_cast<const char*>(data), count * sizeof(T));
+  buffer.resize(Align(buffer.size()), '\0');
+}
+
+// Returns the number of UTF-8 characters of `text`.
+int NumChars(absl::string_view text) {
+  return std::count_if(text.begin(), text.end(),
+                       [](char c) { return (c & 0xC0) != 0x80; });
+}
+
+// Trie node used while compiling the vocabulary.
+struct TrieNode {
+  std::map<uint8_t, int> children;
+  int token_id = -1;
+  int match_id = -1;
+  int failure = -1;
+  std::vector<int> pops;
+};
+
+}  // namespace
+
+/* static */
+std::unique_ptr<FastWordpieceVocab> FastWordpieceVocab::Create(
+    const std::vector<std::string>& vocab, absl::string_view suffix_indicator,
+    int max_chars_per_subtoken) {
+  std::vector<TrieNode> trie(1);
+  auto insert = [&trie](absl::string_view key) {
+    int node = 0;
+    for (const char c : key) {
+      auto [it, inserted] = trie[node].children.try_emplace(
+          static_cast<uint8_t>(c), trie.size());
+      if (inserted) trie.emplace_back();
+      node = it->second;
+    }
+    return node;
+  };
+  const int suffix_root = insert(suffix_indicator);
+  for (int i = 0; i < vocab.size(); ++i) {
+    const absl::string_view token = vocab[i];
+    const int node = insert(token);
+    trie[node].token_id = i;
+    if (token.empty() || token == suffix_indicator) continue;
+    const absl::string_view piece =
+        !suffix_indicator.empty() && absl::StartsWith(token, suffix_indicator)
+            ? token.substr(suffix_indicator.size())
+            : token;
+    if (max_chars_per_subtoken <= 0 ||
+        NumChars(piece) <= max_chars_per_subtoken) {
+      trie[node].match_id = i;
+    }
+  }
+
+  // Computes the failure links and pops in breadth-first order, so that they
+  // are known for the shallower nodes they are derived from.
+  std::vector<int> order = {0};
+  for (int q = 0; q < order.size(); ++q) {
+    const int parent = order[q];
+    for (const auto& [label, node] : trie[parent].children) {
+      order.push_back(node);
+      if (node == suffix_root) continue;
+      if (trie[node].match_id >= 0) {
+        trie[node].failure = suffix_root;
+        trie[node].pops = {trie[node].match_id};
+        continue;
+      }
+      std::vector<int> pops = trie[parent].pops;
+      int failure = trie[parent].failure;
+      while (failure >= 0 && !trie[failure].children.count(label)) {
+        pops.insert(pops.end(), trie[failure].pops.begin(),
+                    trie[failure].pops.end());
+        failure = trie[failure].failure;
+      }
+      if (failure >= 0) {
+        trie[node].failure = trie[failure].children.at(label);
+        trie[node].pops = std::move(pops);
+      }
+    }
+  }
+
+  // Flattens the trie, numbering the nodes in breadth-first order.
+  std::vector<int> index(trie.size());
+  for (int i = 0; i < order.size(); ++i) index[order[i]] = i;
+  std::vector<Node> nodes;
+  std::vector<uint8_t> edge_labels;
+  std::vector<int32_t> edge_targets;
+  std::vector<int32_t> pops;
+  for (const int i : order) {
+    const TrieNode& trie_node = trie[i];
+    Node node;
+    node.first_edge = edge_labels.size();
+    node.num_edges = trie_node.children.size();
+    node.token_id = trie_node.token_id;
+    node.match_id = trie_node.match_id;
+    node.failure = trie_node.failure >= 0 ? index[trie_node.failure] : -1;
+    node.pops_begin = pops.size();
+    pops.insert(pops.end(), trie_node.pops.begin(), trie_node.pops.end());
+    node.pops_end = pops.size();
+    nodes.push_back(node);
+    for (const auto& [label, child] : trie_node.children) {
+      edge_labels.push_back(label);
+      edge_targets.push_back(index[child]);
+    }
+  }
+  std::vector<int32_t> vocab_offsets = {0};
+  std::string vocab_chars;
+  for (const std::string& token : vocab) {
+    vocab_chars += token;
+    vocab_offsets.push_back(vocab_chars.size());
+  }
+
+  auto fast_vocab = absl::WrapUnique(new FastWordpieceVocab());
+  Header header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.max_chars_per_subtoken = max_chars_per_subtoken;
+  header.suffix_indicator_size = suffix_indicator.size();
+  header.vocab_size = vocab.size();
+  header.vocab_chars_size = vocab_chars.size();
+  header.num_nodes = nodes.size();
+  header.num_edges = edge_labels.size();
+  header.num_pops = pops.size();
+  header.suffix_root = index[suffix_root];
+  std::string& buffer = fast_vocab->owned_buffer_;
+  AppendSection(&header, 1, buffer);
+  AppendSection(suffix_indicator.data(), suffix_indicator.size(), buffer);
+  AppendSection(nodes.data(), nodes.size(), buffer);
+  AppendSection(edge_labels.data(), edge_labels.size(), buffer);
+  AppendSection(edge_targets.data(), edge_targets.size(), buffer);
+  AppendSection(pops.data(), pops.size(), buffer);
+  AppendSection(vocab_offsets.data(), vocab_offsets.size(), buffer);
+  AppendSection(vocab_chars.data(), vocab_chars.size(), buffer);
+  fast_vocab->buffer_ = buffer;
+  // The buffer was just built, so it is valid.
+  fast_vocab->Parse().IgnoreError();
+  return fast_vocab;
+}
+
+/* static */
+absl::StatusOr<std::unique_ptr<FastWordpieceVocab>>
+FastWordpieceVocab::CreateFromCompiled(absl::string_view compiled) {
+  auto fast_vocab = absl::WrapUnique(new FastWordpieceVocab());
+  if (reinterpret_cast<uintptr_t>(compiled.data()) % kAlignment == 0) {
+    fast_vocab->buffer_ = compiled;
+  } else {
+    fast_vocab->owned_buffer_ = std::string(compiled);
+    fast_vocab->buffer_ = fast_vocab->owned_buffer_;
+  }
+  MP_RETURN_IF_ERROR(fast_vocab->Parse());
+  return fast_vocab;
+}
+
+/* static */
+bool FastWordpieceVocab::IsCompiled(absl::string_view buffer) {
+  return absl::StartsWith(buffer, absl::string_view(kMagic, sizeof(kMagic)));
+}
+
+absl::Status FastWordpieceVocab::Parse() {
+  if (reinterpret_cast<uintptr_t>(buffer_.data()) % kAlignment != 0) {
+    return absl::InvalidArgumentError(
+        "Compiled wordpiece vocabulary must be 8-byte aligned.");
+  }
+  size_t position = 0;
+  auto section = [&](size_t size) -> const char* {
+    if (position + size > buffer_.size()) return nullptr;
+    const char* data = buffer_.data() + position;
+    position = Align(position + size);
+    return data;
+  };
+  const char* header_data = section(sizeof(Header));
+  if (header_data == nullptr || !IsCompiled(buffer_)) {
+    return absl::InvalidArgumentError(
+        "Invalid compiled wordpiece vocabulary: bad header.");
+  }
+  Header header;
+  std::memcpy(&header, header_data, sizeof(header));
+  if (header.version != kVersion) {
+    return absl::InvalidArgumentError(
+        "Unsupported compiled wordpiece vocabulary version.");
+  }
+  if (header.suffix_indicator_size < 0 || header.vocab_size < 0 ||
+      header.vocab_chars_size < 0 || header.num_nodes <= 0 ||
+      header.num_edges < 0 || header.num_pops < 0 || header.suffix_root < 0 ||
+      header.suffix_root >= header.num_nodes) {
+    return absl::InvalidArgumentError(
+        "Invalid compiled wordpiece vocabulary: bad sizes.");
+  }
+  const char* suffix_indicator = section(header.suffix_indicator_size);
+  nodes_ = reinterpret_cast<const Node*>(
+      section(sizeof(Node) * header.num_nodes));
+  edge_labels_ = reinterpret_cast<const uint8_t*>(
+      section(sizeof(uint8_t) * header.num_edges));
+  edge_targets_ = reinterpret_cast<const int32_t*>(
+      section(sizeof(int32_t) * header.num_edges));
+  pops_ = reinterpret_cast<const int32_t*>(
+      section(sizeof(int32_t) * header.num_pops));
+  vocab_offsets_ = reinterpret_cast<const int32_t*>(
+      section(sizeof(int32_t) * (header.vocab_size + 1)));
+  vocab_chars_ = section(header.vocab_chars_size);
+  if (suffix_indicator == nullptr || nodes_ == nullptr ||
+      edge_labels_ == nullptr || edge_targets_ == nullptr ||
+      pops_ == nullptr || vocab_offsets_ == nullptr ||
+      vocab_chars_ == nullptr) {
+    return absl::InvalidArgumentError(
+        "Invalid compiled wordpiece vocabulary: truncated buffer.");
+  }
+  suffix_indicator_ =
+      absl::string_view(suffix_indicator, header.suffix_indicator_size);
+  max_chars_per_subtoken_ = header.max_chars_per_subtoken;
+  vocab_size_ = header.vocab_size;
+  num_nodes_ = header.num_nodes;
+  suffix_root_ = header.suffix_root;
+
+  // Checks that all the references are in range, so that lookups never need
+  // to.
+  auto in_range = [](int64_t value, int64_t begin, int64_t end) {
+    return value >= begin && value < end;
+  };
+  for (int i = 0; i < num_nodes_; ++i) {
+    const Node& node = nodes_[i];
+    if (node.num_edges < 0 || node.first_edge < 0 ||
+        node.first_edge + node.num_edges > header.num_edges ||
+        !in_range(node.token_id, -1, vocab_size_) ||
+        !in_range(node.match_id, -1, vocab_size_) ||
+        !in_range(node.failure, -1, num_nodes_) || node.pops_begin < 0 ||
+        node.pops_begin > node.pops_end || node.pops_end > header.num_pops) {
+      return absl::InvalidArgumentError(
+          "Invalid compiled wordpiece vocabulary: bad node.");
+    }
+  }
+  for (int i = 0; i < header.num_edges; ++i) {
+    if (!in_range(edge_targets_[i], 0, num_nodes_)) {
+      return absl::InvalidArgumentError(
+          "Invalid compiled wordpiece vocabulary: bad edge.");
+    }
+  }
+  for (int i = 0; i < header.num_pops; ++i) {
+    if (!in_range(pops_[i], 0, vocab_size_)) {
+      return absl::InvalidArgumentError(
+          "Invalid compiled wordpiece vocabulary: bad failure pop.");
+    }
+  }
+  for (int i = 0; i < vocab_size_; ++i) {
+    if (vocab_offsets_[i] < 0 || vocab_offsets_[i] > vocab_offsets_[i + 1] ||
+        vocab_offsets_[i + 1] > header.vocab_chars_size) {
+      return absl::InvalidArgumentError(
+          "Invalid compiled wordpiece vocabulary: bad token offsets.");
+    }
+  }
+  return absl::OkStatus();
+}
+
+int FastWordpieceVocab::Child(int node, uint8_t label) const {
+  const uint8_t* begin = edge_labels_ + nodes_[node].first_edge;
+  const uint8_t* end = begin + nodes_[node].num_edges;
+  const uint8_t* it = std::lower_bound(begin, end, label);
+  if (it == end || *it != label) return -1;
+  return edge_targets_[it - edge_labels_];
+}
+
+bool FastWordpieceVocab::TokenizeWord(absl::string_view word,
+                                      std::vector<int>* ids,
+                                      std::vector<int>* begin_offsets,
+                                      std::vector<int>* end_offsets) const {
+  if (word.empty() || (!suffix_indicator_.empty() &&
+                       absl::StartsWith(word, suffix_indicator_))) {
+    return false;
+  }
+  const size_t first_id = ids->size();
+  auto fail = [&]() {
+    ids->resize(first_id);
+    return false;
+  };
+  auto follow_failure = [&](int node) {
+    ids->insert(ids->end(), pops_ + nodes_[node].pops_begin,
+                pops_ + nodes_[node].pops_end);
+    return nodes_[node].failure;
+  };
+  int node = 0;
+  for (const char c : word) {
+    int child;
+    while ((child = Child(node, static_cast<uint8_t>(c))) < 0) {
+      node = follow_failure(node);
+      if (node < 0) return fail();
+    }
+    node = child;
+  }
+  while (node != suffix_root_) {
+    node = follow_failure(node);
+    if (node < 0) return fail();
+  }
+
+  int position = 0;
+  for (size_t i = first_id; i < ids->size(); ++i) {
+    const int length = vocab_offsets_[(*ids)[i] + 1] -
+                       vocab_offsets_[(*ids)[i]] -
+                       (i == first_id ? 0 : suffix_indicator_.size());
+    begin_offsets->push_back(position);
+    position += length;
+    end_offsets->push_back(position);
+  }
+  return true;
+}
+
+bool FastWordpieceVocab::LookupId(absl::string_view key, int* result) const {
+  int node = 0;
+  for (const char c : key) {
+    node = Child(node, static_cast<uint8_t>(c));
+    if (node < 0) return false;
+  }
+  if (nodes_[node].token_id < 0) return false;
+  *result = nodes_[node].token_id;
+  return true;
+}
+
+bool FastWordpieceVocab::LookupWord(int vocab_id,
+                                    absl::string_view* result) const {
+  if (vocab_id >= vocab_size_ || vocab_id < 0) {
+    return false;
+  }
+  *result = absl::string_view(
+      vocab_chars_ + vocab_offsets_[vocab_id],
+      vocab_offsets_[vocab_id + 1] - vocab_offsets_[vocab_id]);
+  return true;
+}
+
+}  // namespace tokenizers
+}  // namespace text
+}  // namespace tasks
+}  // namespace mediapipe
@@ -0,0 +1,140 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef MEDIAPIPE_TASKS_CC_TEXT_TOKENIZERS_FAST_WORDPIECE_VOCAB_H_
+#define MEDIAPIPE_TASKS_CC_TEXT_TOKENIZERS_FAST_WORDPIECE_VOCAB_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace text {
+namespace tokenizers {
+
+// A wordpiece vocabulary compiled into a trie that tokenizes words in time
+// linear in their length, with the LinMaxMatch algorithm of "Fast WordPiece
+// Tokenization" [1]. Its results are the same as greedy longest-match-first
+// wordpiece tokenization, which instead looks every candidate subword up.
+//
+// Each trie node has a failure link and failure pops: when the next byte of
+// a word can't be matched from a node, the failure pops are the tokens that
+// greedy matching would have emitted, and the failure link the node of the
+// "##"-prefixed rest of the word to continue from.
+//
+// The compiled vocabulary is a single flat buffer. It can be saved, e.g. as
+// the vocabulary file of the model metadata, and used in place without any
+// parsing, e.g. when the model is memory-mapped.
+//
+// [1]: https://arxiv.org/abs/2012.15524
+class FastWordpieceVocab {
+ public:
+  // Compiles the vocabulary, in which the tokens continuing a word are
+  // prefixed with `suffix_indicator`. Tokens longer than
+  // `max_chars_per_subtoken` characters, not counting the suffix indicator,
+  // are never matched.
+  static std::unique_ptr<FastWordpieceVocab> Create(
+      const std::vector<std::string>& vocab, absl::string_view suffix_indicator,
+      int max_chars_per_subtoken);
+
+  // Uses a vocabulary compiled by Create() in place, in which case it must
+  // outlive the returned object. A vocabulary that isn't 8-byte aligned is
+  // copied first.
+  static absl::StatusOr<std::unique_ptr<FastWordpieceVocab>> CreateFromCompiled(
+      absl::string_view compiled);
+
+  // Returns whether `buffer` holds a compiled vocabulary, rather than e.g. a
+  // vocabulary text file.
+  static bool IsCompiled(absl::string_view buffer);
+
+  FastWordpieceVocab(const FastWordpieceVocab&) = delete;
+  FastWordpieceVocab& operator=(const FastWordpieceVocab&) = delete;
+
+  // Returns the compiled vocabulary, valid as long as this object is alive.
+  absl::string_view compiled() const { return buffer_; }
+
+  absl::string_view suffix_indicator() const { return suffix_indicator_; }
+  int max_chars_per_subtoken() const { return max_chars_per_subtoken_; }
+
+  // Tokenizes `word` into wordpieces with greedy longest-match-first, in time
+  // linear in the length of the word. Appends the token ids and the byte
+  // offsets of the wordpieces in the word, and returns true on success.
+  // Returns false without appending anything if the word can't be tokenized,
+  // or starts with the suffix indicator, a corner case left to the callers.
+  bool TokenizeWord(absl::string_view word, std::vector<int>* ids,
+                    std::vector<int>* begin_offsets,
+                    std::vector<int>* end_offsets) const;
+
+  bool LookupId(absl::string_view key, int* result) const;
+  bool LookupWord(int vocab_id, absl::string_view* result) const;
+  int VocabularySize() const { return vocab_size_; }
+
+ private:
+  struct Node {
+    // The children of the node are edges [first_edge, first_edge + num_edges),
+    // sorted by label.
+    int32_t first_edge;
+    int32_t num_edges;
+    // The id of the vocabulary token ending at the node, or -1.
+    int32_t token_id;
+    // The id of the token ending at the node that wordpieces can match, or -1.
+    int32_t match_id;
+    // The failure link, or -1 if a word can't be tokenized from the node.
+    int32_t failure;
+    // The failure pops are pops_[pops_begin, pops_end).
+    int32_t pops_begin;
+    int32_t pops_end;
+  };
+
+  FastWordpieceVocab() = default;
+
+  // Points the vocabulary at the sections of `buffer_`, checking their sizes.
+  absl::Status Parse();
+
+  // Returns the child of `node` along `label`, or -1.
+  int Child(int node, uint8_t label) const;
+
+  // The compiled vocabulary, pointing into `owned_buffer_` or user memory.
+  absl::string_view buffer_;
+  std::string owned_buffer_;
+
+  absl::string_view suffix_indicator_;
+  int max_chars_per_subtoken_ = 0;
+  int vocab_size_ = 0;
+  int num_nodes_ = 0;
+  // The node of the suffix indicator, from which the tokens continuing a word
+  // are matched.
+  int suffix_root_ = 0;
+  const Node* nodes_ = nullptr;
+  const uint8_t* edge_labels_ = nullptr;
+  const int32_t* edge_targets_ = nullptr;
+  const int32_t* pops_ = nullptr;
+  // Token `i` is vocab_chars_[vocab_offsets_[i], vocab_offsets_[i + 1]).
+  const int32_t* vocab_offsets_ = nullptr;
+  const char* vocab_chars_ = nullptr;
+};
+
+}  // namespace tokenizers
+}  // namespace text
+}  // namespace tasks
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_TASKS_CC_TEXT_TOKENIZERS_FAST_WORDPIECE_VOCAB_H_
@@ -0,0 +1,203 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/text/tokenizers/fast_wordpiece_vocab.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace text {
+namespace tokenizers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+struct Wordpieces {
+  bool success = false;
+  std::vector<int> ids;
+  std::vector<int> begin_offsets;
+  std::vector<int> end_offsets;
+};
+
+Wordpieces Tokenize(const FastWordpieceVocab& vocab, absl::string_view word) {
+  Wordpieces result;
+  result.success = vocab.TokenizeWord(word, &result.ids,
+                                      &result.begin_offsets,
+                                      &result.end_offsets);
+  return result;
+}
+
+// Greedy longest-match-first wordpiece tokenization of ASCII words.
+Wordpieces ReferenceTokenize(const std::vector<std::string>& vocab,
+                             absl::string_view word, int max_chars) {
+  auto find = [&vocab](const std::string& token) {
+    int id = -1;
+    for (int i = 0; i < vocab.size(); ++i) {
+      if (vocab[i] == token) id = i;
+    }
+    return id;
+  };
+  Wordpieces result;
+  for (int begin = 0; begin < word.size();) {
+    int end = std::min<int>(word.size(), begin + max_chars);
+    int id = -1;
+    for (; end > begin; --end) {
+      std::string token(word.substr(begin, end - begin));
+      if (begin > 0) token = "##" + token;
+      id = find(token);
+      if (id >= 0) break;
+    }
+    if (id < 0) return {};
+    result.ids.push_back(id);
+    result.begin_offsets.push_back(begin);
+    result.end_offsets.push_back(end);
+    begin = end;
+  }
+  result.success = true;
+  return result;
+}
+
+TEST(FastWordpieceVocabTest, TokenizesWords) {
+  const std::vector<std::string> vocab = {"[UNK]", "token", "##ize", "me",
+                                          "plea", "##se", "##s", "t"};
+  auto fast_vocab = FastWordpieceVocab::Create(vocab, "##", 100);
+
+  Wordpieces result = Tokenize(*fast_vocab, "tokenize");
+  EXPECT_TRUE(result.success);
+  EXPECT_THAT(result.ids, ElementsAre(1, 2));
+  EXPECT_THAT(result.begin_offsets, ElementsAre(0, 5));
+  EXPECT_THAT(result.end_offsets, ElementsAre(5, 8));
+
+  result = Tokenize(*fast_vocab, "please");
+  EXPECT_TRUE(result.success);
+  EXPECT_THAT(result.ids, ElementsAre(4, 5));
+
+  result = Tokenize(*fast_vocab, "tokens");
+  EXPECT_TRUE(result.success);
+  EXPECT_THAT(result.ids, ElementsAre(1, 6));
+  EXPECT_THAT(result.end_offsets, ElementsAre(5, 6));
+}
+
+TEST(FastWordpieceVocabTest, FailsWithoutAppending) {
+  const std::vector<std::string> vocab = {"abc", "##d", "a"};
+  auto fast_vocab = FastWordpieceVocab::Create(vocab, "##", 100);
+
+  for (absl::string_view word : {"abce", "ab", "x", "##d", ""}) {
+    Wordpieces result = Tokenize(*fast_vocab, word);
+    EXPECT_FALSE(result.success) << word;
+    EXPECT_THAT(result.ids, IsEmpty()) << word;
+    EXPECT_THAT(result.begin_offsets, IsEmpty()) << word;
+  }
+}
+
+TEST(FastWordpieceVocabTest, SkipsTokensOverMaxChars) {
+  const std::vector<std::string> vocab = {"abc", "a", "##bc", "##b", "##c"};
+  auto fast_vocab = FastWordpieceVocab::Create(vocab, "##", 1);
+
+  Wordpieces result = Tokenize(*fast_vocab, "abc");
+  EXPECT_TRUE(result.success);
+  EXPECT_THAT(result.ids, ElementsAre(1, 3, 4));
+}
+
+TEST(FastWordpieceVocabTest, MatchesGreedyTokenization) {
+  std::mt19937 rng(/*seed=*/42);
+  auto random_string = [&rng](int max_size) {
+    std::string result(std::uniform_int_distribution<>(1, max_size)(rng), 'a');
+    for (char& c : result) c = 'a' + std::uniform_int_distribution<>(0, 2)(rng);
+    return result;
+  };
+  for (int trial = 0; trial < 20; ++trial) {
+    std::vector<std::string> vocab;
+    for (int i = 0; i < 30; ++i) {
+      const bool suffix = std::bernoulli_distribution(0.5)(rng);
+      vocab.push_back((suffix ? "##" : "") + random_string(4));
+    }
+    const int max_chars = 1 + trial % 4;
+    auto fast_vocab = FastWordpieceVocab::Create(vocab, "##", max_chars);
+    for (int i = 0; i < 200; ++i) {
+      const std::string word = random_string(12);
+      const Wordpieces expected = ReferenceTokenize(vocab, word, max_chars);
+      const Wordpieces result = Tokenize(*fast_vocab, word);
+      ASSERT_EQ(result.success, expected.success) << word;
+      EXPECT_EQ(result.ids, expected.ids) << word;
+      EXPECT_EQ(result.begin_offsets, expected.begin_offsets) << word;
+      EXPECT_EQ(result.end_offsets, expected.end_offsets) << word;
+    }
+  }
+}
+
+TEST(FastWordpieceVocabTest, LooksUpTokens) {
+  const std::vector<std::string> vocab = {"[UNK]", "token", "##ize", "##"};
+  auto fast_vocab = FastWordpieceVocab::Create(vocab, "##", 100);
+
+  EXPECT_EQ(fast_vocab->VocabularySize(), 4);
+  int id;
+  ASSERT_TRUE(fast_vocab->LookupId("##ize", &id));
+  EXPECT_EQ(id, 2);
+  ASSERT_TRUE(fast_vocab->LookupId("##", &id));
+  EXPECT_EQ(id, 3);
+  EXPECT_FALSE(fast_vocab->LookupId("tok", &id));
+  absl::string_view word;
+  ASSERT_TRUE(fast_vocab->LookupWord(1, &word));
+  EXPECT_EQ(word, "token");
+  EXPECT_FALSE(fast_vocab->LookupWord(4, &word));
+}
+
+TEST(FastWordpieceVocabTest, UsesCompiledVocab) {
+  const std::vector<std::string> vocab = {"[UNK]", "token", "##ize"};
+  auto fast_vocab = FastWordpieceVocab::Create(vocab, "##", 50);
+  ASSERT_TRUE(FastWordpieceVocab::IsCompiled(fast_vocab->compiled()));
+
+  // Copies the vocabulary with an offset, so that it isn't aligned.
+  const std::string unaligned = "x" + std::string(fast_vocab->compiled());
+  for (absl::string_view compiled :
+       {fast_vocab->compiled(), absl::string_view(unaligned).substr(1)}) {
+    MP_ASSERT_OK_AND_ASSIGN(auto compiled_vocab,
+                            FastWordpieceVocab::CreateFromCompiled(compiled));
+    EXPECT_EQ(compiled_vocab->suffix_indicator(), "##");
+    EXPECT_EQ(compiled_vocab->max_chars_per_subtoken(), 50);
+    EXPECT_EQ(compiled_vocab->VocabularySize(), 3);
+    EXPECT_THAT(Tokenize(*compiled_vocab, "tokenize").ids, ElementsAre(1, 2));
+  }
+}
+
+TEST(FastWordpieceVocabTest, FailsWithInvalidCompiledVocab) {
+  auto fast_vocab = FastWordpieceVocab::Create({"token", "##ize"}, "##", 100);
+  const std::string compiled(fast_vocab->compiled());
+
+  EXPECT_FALSE(FastWordpieceVocab::IsCompiled("token\n##ize\n"));
+  EXPECT_FALSE(
+      FastWordpieceVocab::CreateFromCompiled("token\n##ize\n").ok());
+  EXPECT_FALSE(FastWordpieceVocab::CreateFromCompiled(
+                   absl::string_view(compiled).substr(0, compiled.size() / 2))
+                   .ok());
+}
+
+}  // namespace
+}  // namespace tokenizers
+}  // namespace text
+}  // namespace tasks
+}  // namespace mediapipe
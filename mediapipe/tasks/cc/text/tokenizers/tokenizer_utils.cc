@@ -27,6 +27,7 @@ limitations under the License.
 #include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/tasks/cc/common.h"
 #include "mediapipe/tasks/cc/text/tokenizers/bert_tokenizer.h"
+#include "mediapipe/tasks/cc/text/tokenizers/fast_wordpiece_vocab.h"
 #include "mediapipe/tasks/cc/text/tokenizers/sentencepiece_tokenizer.h"
 #include "mediapipe/tasks/metadata/metadata_schema_generated.h"
 
@@ -111,6 +112,16 @@ absl::StatusOr<std::unique_ptr<Tokenizer>> CreateTokenizerFromProcessUnit(
       ASSIGN_OR_RETURN(absl::string_view vocab_buffer,
                        CheckAndLoadFirstAssociatedFile(options->vocab_file(),
                                                        metadata_extractor));
+      if (FastWordpieceVocab::IsCompiled(vocab_buffer)) {
+        // The compiled vocab is used in place, in the model metadata.
+        auto vocab = FastWordpieceVocab::CreateFromCompiled(vocab_buffer);
+        if (!vocab.ok()) {
+          return CreateStatusWithPayload(
+              absl::StatusCode::kInvalidArgument, vocab.status().message(),
+              MediaPipeTasksStatus::kMetadataInvalidTokenizerError);
+        }
+        return std::make_unique<BertTokenizer>(*std::move(vocab));
+      }
       return std::make_unique<BertTokenizer>(vocab_buffer.data(),
                                              vocab_buffer.size());
     }
@@ -0,0 +1,57 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/text/utils/token_ids_cache.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace text {
+
+const std::vector<int32_t>* TokenIdsCache::Lookup(absl::string_view text) {
+  auto it = index_.find(text);
+  if (it == index_.end()) {
+    return nullptr;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return &it->second->second;
+}
+
+const std::vector<int32_t>& TokenIdsCache::Insert(absl::string_view text,
+                                                  std::vector<int32_t> ids) {
+  auto it = index_.find(text);
+  if (it != index_.end()) {
+    entries_.splice(entries_.begin(), entries_, it->second);
+    it->second->second = std::move(ids);
+    return it->second->second;
+  }
+  if (entries_.size() >= capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  entries_.emplace_front(std::string(text), std::move(ids));
+  index_[entries_.front().first] = entries_.begin();
+  return entries_.front().second;
+}
+
+}  // namespace text
+}  // namespace tasks
+}  // namespace mediapipe
@@ -0,0 +1,69 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef MEDIAPIPE_TASKS_CC_TEXT_UTILS_TOKEN_IDS_CACHE_H_
+#define MEDIAPIPE_TASKS_CC_TEXT_UTILS_TOKEN_IDS_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace text {
+
+// A least-recently-used cache of the token ids of input texts, so that text
+// preprocessors don't tokenize repeated inputs again.
+class TokenIdsCache {
+ public:
+  // Creates a cache holding the token ids of at most `capacity` texts, which
+  // must be positive.
+  explicit TokenIdsCache(int capacity) : capacity_(capacity) {}
+
+  TokenIdsCache(const TokenIdsCache&) = delete;
+  TokenIdsCache& operator=(const TokenIdsCache&) = delete;
+
+  // Returns the cached token ids of `text` and marks them as most recently
+  // used, or returns nullptr. The ids are valid until the next Insert().
+  const std::vector<int32_t>* Lookup(absl::string_view text);
+
+  // Caches the token ids of `text`, evicting the least recently used ones if
+  // the cache is full, and returns the cached ids. The ids are valid until the
+  // next Insert().
+  const std::vector<int32_t>& Insert(absl::string_view text,
+                                     std::vector<int32_t> ids);
+
+  int size() const { return entries_.size(); }
+
+ private:
+  using Entry = std::pair<std::string, std::vector<int32_t>>;
+
+  const int capacity_;
+  // The entries from the most to the least recently used.
+  std::list<Entry> entries_;
+  // The entries by text, pointing into `entries_`.
+  absl::flat_hash_map<absl::string_view, std::list<Entry>::iterator> index_;
+};
+
+}  // namespace text
+}  // namespace tasks
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_TASKS_CC_TEXT_UTILS_TOKEN_IDS_CACHE_H_
@@ -0,0 +1,69 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/text/utils/token_ids_cache.h"
+
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace text {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsNull;
+using ::testing::Pointee;
+
+TEST(TokenIdsCacheTest, LooksUpInsertedIds) {
+  TokenIdsCache cache(/*capacity=*/2);
+  EXPECT_THAT(cache.Lookup("hello"), IsNull());
+
+  EXPECT_THAT(cache.Insert("hello", {1, 2}), ElementsAre(1, 2));
+  EXPECT_THAT(cache.Lookup("hello"), Pointee(ElementsAre(1, 2)));
+  EXPECT_THAT(cache.Lookup("world"), IsNull());
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(TokenIdsCacheTest, EvictsLeastRecentlyUsedIds) {
+  TokenIdsCache cache(/*capacity=*/2);
+  cache.Insert("a", {1});
+  cache.Insert("b", {2});
+  // Makes "b" the least recently used.
+  ASSERT_NE(cache.Lookup("a"), nullptr);
+  cache.Insert("c", {3});
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_THAT(cache.Lookup("a"), Pointee(ElementsAre(1)));
+  EXPECT_THAT(cache.Lookup("b"), IsNull());
+  EXPECT_THAT(cache.Lookup("c"), Pointee(ElementsAre(3)));
+}
+
+TEST(TokenIdsCacheTest, ReplacesIdsOfSameText) {
+  TokenIdsCache cache(/*capacity=*/2);
+  cache.Insert("a", {1});
+  cache.Insert("b", {2});
+  cache.Insert("a", {4, 5});
+  cache.Insert("c", {3});
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_THAT(cache.Lookup("a"), Pointee(ElementsAre(4, 5)));
+  EXPECT_THAT(cache.Lookup("b"), IsNull());
+}
+
+}  // namespace
+}  // namespace text
+}  // namespace tasks
+}  // namespace mediapipe
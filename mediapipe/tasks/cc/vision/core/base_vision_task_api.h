@@ -19,6 +19,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -57,6 +58,21 @@ class BaseVisionTaskApi : public tasks::core::BaseTaskApi {
     return runner_->Process(std::move(inputs));
   }
 
+  // A synchronous method to process a batch of independent image inputs in a
+  // single graph run. Returns one output packet map per input, in order.
+  absl::StatusOr<std::vector<tasks::core::PacketMap>> ProcessImageDataBatch(
+      std::vector<tasks::core::PacketMap> inputs) {
+    if (running_mode_ != RunningMode::IMAGE) {
+      return CreateStatusWithPayload(
+          absl::StatusCode::kInvalidArgument,
+          absl::StrCat("Task is not initialized with the image mode. Current "
+                       "running mode:",
+                       GetRunningModeName(running_mode_)),
+          MediaPipeTasksStatus::kRunnerApiCalledInWrongModeError);
+    }
+    return runner_->ProcessBatch(std::move(inputs));
+  }
+
   // A synchronous method to process continuous video frames.
   // The call blocks the current thread until a failure status or a successful
   // result is returned.
@@ -48,7 +48,8 @@ class VisionTaskApiFactory {
   static absl::StatusOr<std::unique_ptr<T>> Create(
       CalculatorGraphConfig graph_config,
       std::unique_ptr<tflite::OpResolver> resolver, RunningMode running_mode,
-      tasks::core::PacketsCallback packets_callback = nullptr) {
+      tasks::core::PacketsCallback packets_callback = nullptr,
+      int num_graph_instances = 1) {
     bool found_task_subgraph = false;
     for (const auto& node : graph_config.node()) {
       if (node.calculator() == "FlowLimiterCalculator") {
@@ -85,10 +86,16 @@ class VisionTaskApiFactory {
           "callback shouldn't be provided.",
           MediaPipeTasksStatus::kInvalidTaskGraphConfigError);
     }
+    if (num_graph_instances != 1 && running_mode != RunningMode::IMAGE) {
+      return CreateStatusWithPayload(
+          absl::StatusCode::kInvalidArgument,
+          "Multiple graph instances are only supported in image mode.",
+          MediaPipeTasksStatus::kInvalidTaskGraphConfigError);
+    }
     ASSIGN_OR_RETURN(auto runner,
                      tasks::core::TaskRunner::Create(
                          std::move(graph_config), std::move(resolver),
-                         std::move(packets_callback)));
+                         std::move(packets_callback), num_graph_instances));
     return std::make_unique<T>(std::move(runner), running_mode);
   }
 };
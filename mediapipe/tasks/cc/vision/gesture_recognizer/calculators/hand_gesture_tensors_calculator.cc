@@ -0,0 +1,218 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/port.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/classification.pb.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/matrix.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/tasks/cc/vision/gesture_recognizer/calculators/hand_gesture_tensors_calculator.pb.h"
+#include "mediapipe/tasks/cc/vision/gesture_recognizer/calculators/landmarks_to_matrix_util.h"
+#include "mediapipe/tasks/cc/vision/gesture_recognizer/handedness_util.h"
+
+namespace mediapipe::api2 {
+
+namespace {
+
+using ::mediapipe::tasks::vision::gesture_recognizer::GetLeftHandScore;
+using ::mediapipe::tasks::vision::gesture_recognizer::kFeaturesPerLandmark;
+using ::mediapipe::tasks::vision::gesture_recognizer::LandmarksToMatrix;
+
+// Returns true if any landmark moved by more than `max_delta` along x or y.
+bool HasMoved(const NormalizedLandmarkList& from,
+              const NormalizedLandmarkList& to, float max_delta) {
+  if (from.landmark_size() != to.landmark_size()) {
+    return true;
+  }
+  for (int i = 0; i < from.landmark_size(); ++i) {
+    if (std::abs(from.landmark(i).x() - to.landmark(i).x()) > max_delta ||
+        std::abs(from.landmark(i).y() - to.landmark(i).y()) > max_delta) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Copies `matrix` as item `index` of the batched `buffer`.
+void CopyToBatch(const Matrix& matrix, int index, float* buffer) {
+  std::copy(matrix.data(), matrix.data() + matrix.size(),
+            buffer + index * matrix.size());
+}
+
+}  // namespace
+
+// HandGestureTensorsCalculator converts the handedness, landmarks and world
+// landmarks of all hands of a frame into the input tensors of the hand gesture
+// model, batched along the first dimension, so the gestures of all hands are
+// recognized with one inference. The tensors match the ones built per hand
+// by HandednessToMatrixCalculator, LandmarksToMatrixCalculator and
+// TensorConverterCalculator, with the hands as batch items.
+//
+// If `min_landmark_delta` is positive, a hand whose landmarks barely moved
+// since it was last part of a batch is left out, so that its previous
+// gestures can be reused (see HandGesturesMergeCalculator). Hands are
+// identified by their index in the input vectors.
+//
+// Inputs:
+//   HANDEDNESS - std::vector<ClassificationList>
+//     The handedness of each hand.
+//   LANDMARKS - std::vector<NormalizedLandmarkList>
+//     The landmarks of each hand in normalized image coordinates.
+//   WORLD_LANDMARKS - std::vector<LandmarkList>
+//     The landmarks of each hand in world coordinates.
+//   IMAGE_SIZE - std::pair<int, int>
+//     The (width, height) of the image the landmarks were detected on.
+//
+// Outputs:
+//   TENSORS - std::vector<Tensor>
+//     The landmarks, handedness and world landmarks tensors of the hands in
+//     HAND_INDICES. Not output if no hand needs gesture recognition.
+//   HAND_INDICES - std::vector<int>
+//     The indices of the hands in the batch, in batch order.
+//
+// Example:
+// node {
+//   calculator: "HandGestureTensorsCalculator"
+//   input_stream: "HANDEDNESS:handedness"
+//   input_stream: "LANDMARKS:landmarks"
+//   input_stream: "WORLD_LANDMARKS:world_landmarks"
+//   input_stream: "IMAGE_SIZE:image_size"
+//   output_stream: "TENSORS:gesture_tensors"
+//   output_stream: "HAND_INDICES:gesture_hand_indices"
+//   options {
+//     [mediapipe.HandGestureTensorsCalculatorOptions.ext] {
+//       landmarks_options { object_normalization: true }
+//       min_landmark_delta: 0.01
+//     }
+//   }
+// }
+class HandGestureTensorsCalculator : public Node {
+ public:
+  static constexpr Input<std::vector<ClassificationList>> kHandednessIn{
+      "HANDEDNESS"};
+  static constexpr Input<std::vector<NormalizedLandmarkList>> kLandmarksIn{
+      "LANDMARKS"};
+  static constexpr Input<std::vector<LandmarkList>> kWorldLandmarksIn{
+      "WORLD_LANDMARKS"};
+  static constexpr Input<std::pair<int, int>> kImageSizeIn{"IMAGE_SIZE"};
+  static constexpr Output<std::vector<Tensor>> kTensorsOut{"TENSORS"};
+  static constexpr Output<std::vector<int>> kHandIndicesOut{"HAND_INDICES"};
+  MEDIAPIPE_NODE_CONTRACT(kHandednessIn, kLandmarksIn, kWorldLandmarksIn,
+                          kImageSizeIn, kTensorsOut, kHandIndicesOut);
+
+  absl::Status Open(CalculatorContext* cc) override {
+    options_ = cc->Options<HandGestureTensorsCalculatorOptions>();
+    RET_CHECK(options_.landmarks_options().has_object_normalization());
+    RET_CHECK_GE(options_.min_landmark_delta(), 0);
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (kLandmarksIn(cc).IsEmpty()) {
+      return absl::OkStatus();
+    }
+    RET_CHECK(!kHandednessIn(cc).IsEmpty() &&
+              !kWorldLandmarksIn(cc).IsEmpty() && !kImageSizeIn(cc).IsEmpty());
+    const auto& landmarks = *kLandmarksIn(cc);
+    const auto& handedness = *kHandednessIn(cc);
+    const auto& world_landmarks = *kWorldLandmarksIn(cc);
+    RET_CHECK_EQ(handedness.size(), landmarks.size());
+    RET_CHECK_EQ(world_landmarks.size(), landmarks.size());
+
+    const int num_hands = landmarks.size();
+    std::vector<int> hand_indices;
+    for (int i = 0; i < num_hands; ++i) {
+      if (options_.min_landmark_delta() <= 0 ||
+          i >= static_cast<int>(last_batched_landmarks_.size()) ||
+          HasMoved(last_batched_landmarks_[i], landmarks[i],
+                   options_.min_landmark_delta())) {
+        hand_indices.push_back(i);
+      }
+    }
+    last_batched_landmarks_.resize(num_hands);
+    for (int i : hand_indices) {
+      last_batched_landmarks_[i] = landmarks[i];
+    }
+
+    if (!hand_indices.empty()) {
+      ASSIGN_OR_RETURN(auto tensors,
+                       ToTensors(handedness, landmarks, world_landmarks,
+                                 *kImageSizeIn(cc), hand_indices));
+      kTensorsOut(cc).Send(std::move(tensors));
+    }
+    kHandIndicesOut(cc).Send(std::move(hand_indices));
+    return absl::OkStatus();
+  }
+
+ private:
+  absl::StatusOr<std::vector<Tensor>> ToTensors(
+      const std::vector<ClassificationList>& handedness,
+      const std::vector<NormalizedLandmarkList>& landmarks,
+      const std::vector<LandmarkList>& world_landmarks,
+      std::pair<int, int> image_size, const std::vector<int>& hand_indices) {
+    const int batch_size = hand_indices.size();
+    const int num_landmarks = landmarks[hand_indices[0]].landmark_size();
+    const Tensor::Shape landmarks_shape{batch_size, kFeaturesPerLandmark,
+                                        num_landmarks, 1};
+    std::vector<Tensor> tensors;
+    tensors.emplace_back(Tensor::ElementType::kFloat32, landmarks_shape);
+    tensors.emplace_back(Tensor::ElementType::kFloat32,
+                         Tensor::Shape{batch_size, 1, 1, 1});
+    tensors.emplace_back(Tensor::ElementType::kFloat32, landmarks_shape);
+    {
+      auto landmarks_view = tensors[0].GetCpuWriteView();
+      auto handedness_view = tensors[1].GetCpuWriteView();
+      auto world_landmarks_view = tensors[2].GetCpuWriteView();
+
+      const auto& landmarks_options = options_.landmarks_options();
+      for (int b = 0; b < batch_size; ++b) {
+        const int i = hand_indices[b];
+        RET_CHECK_EQ(landmarks[i].landmark_size(), num_landmarks);
+        RET_CHECK_EQ(world_landmarks[i].landmark_size(), num_landmarks);
+        ASSIGN_OR_RETURN(
+            Matrix landmarks_matrix,
+            LandmarksToMatrix(landmarks[i], image_size, landmarks_options));
+        CopyToBatch(landmarks_matrix, b, landmarks_view.buffer<float>());
+        ASSIGN_OR_RETURN(handedness_view.buffer<float>()[b],
+                         GetLeftHandScore(handedness[i]));
+        ASSIGN_OR_RETURN(
+            Matrix world_landmarks_matrix,
+            LandmarksToMatrix(world_landmarks[i], landmarks_options));
+        CopyToBatch(world_landmarks_matrix, b,
+                    world_landmarks_view.buffer<float>());
+      }
+    }
+    return tensors;
+  }
+
+  HandGestureTensorsCalculatorOptions options_;
+  // The landmarks of each hand when it was last part of a batch.
+  std::vector<NormalizedLandmarkList> last_batched_landmarks_;
+};
+
+MEDIAPIPE_REGISTER_NODE(HandGestureTensorsCalculator);
+
+}  // namespace mediapipe::api2
@@ -0,0 +1,146 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <utility>
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/classification.pb.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/tasks/cc/vision/gesture_recognizer/calculators/hand_gesture_tensors_calculator.pb.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::FloatEq;
+using ::testing::IsEmpty;
+
+constexpr int kNumLandmarks = 21;
+
+CalculatorGraphConfig::Node MakeNode(float min_landmark_delta) {
+  auto node = ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "HandGestureTensorsCalculator"
+    input_stream: "HANDEDNESS:handedness"
+    input_stream: "LANDMARKS:landmarks"
+    input_stream: "WORLD_LANDMARKS:world_landmarks"
+    input_stream: "IMAGE_SIZE:image_size"
+    output_stream: "TENSORS:tensors"
+    output_stream: "HAND_INDICES:hand_indices"
+    options {
+      [mediapipe.HandGestureTensorsCalculatorOptions.ext] {
+        landmarks_options { object_normalization: false }
+      }
+    }
+  )pb");
+  node.mutable_options()
+      ->MutableExtension(HandGestureTensorsCalculatorOptions::ext)
+      ->set_min_landmark_delta(min_landmark_delta);
+  return node;
+}
+
+// Adds one frame with a hand per entry of `offsets`, whose landmarks are all
+// at (offset, offset).
+void AddFrame(const std::vector<float>& offsets, int64 timestamp,
+              CalculatorRunner& runner) {
+  std::vector<ClassificationList> handedness;
+  std::vector<NormalizedLandmarkList> landmarks;
+  std::vector<LandmarkList> world_landmarks;
+  for (float offset : offsets) {
+    auto* classification = handedness.emplace_back().add_classification();
+    classification->set_label("Left");
+    classification->set_score(0.75f);
+    auto& hand_landmarks = landmarks.emplace_back();
+    auto& hand_world_landmarks = world_landmarks.emplace_back();
+    for (int i = 0; i < kNumLandmarks; ++i) {
+      auto* landmark = hand_landmarks.add_landmark();
+      landmark->set_x(offset);
+      landmark->set_y(offset);
+      hand_world_landmarks.add_landmark()->set_z(offset);
+    }
+  }
+  const Timestamp ts(timestamp);
+  runner.MutableInputs()->Tag("HANDEDNESS").packets.push_back(
+      MakePacket<std::vector<ClassificationList>>(std::move(handedness))
+          .At(ts));
+  runner.MutableInputs()->Tag("LANDMARKS").packets.push_back(
+      MakePacket<std::vector<NormalizedLandmarkList>>(std::move(landmarks))
+          .At(ts));
+  runner.MutableInputs()->Tag("WORLD_LANDMARKS").packets.push_back(
+      MakePacket<std::vector<LandmarkList>>(std::move(world_landmarks)).At(ts));
+  runner.MutableInputs()->Tag("IMAGE_SIZE").packets.push_back(
+      MakePacket<std::pair<int, int>>(100, 100).At(ts));
+}
+
+TEST(HandGestureTensorsCalculatorTest, BatchesAllHands) {
+  CalculatorRunner runner(MakeNode(/*min_landmark_delta=*/0));
+  AddFrame({0.25f, 0.5f}, 0, runner);
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& indices = runner.Outputs().Tag("HAND_INDICES").packets;
+  ASSERT_EQ(indices.size(), 1);
+  EXPECT_THAT(indices[0].Get<std::vector<int>>(), ElementsAre(0, 1));
+  const auto& tensors_packets = runner.Outputs().Tag("TENSORS").packets;
+  ASSERT_EQ(tensors_packets.size(), 1);
+  const auto& tensors = tensors_packets[0].Get<std::vector<Tensor>>();
+  ASSERT_EQ(tensors.size(), 3);
+  EXPECT_THAT(tensors[0].shape().dims, ElementsAre(2, 3, kNumLandmarks, 1));
+  EXPECT_THAT(tensors[1].shape().dims, ElementsAre(2, 1, 1, 1));
+  EXPECT_THAT(tensors[2].shape().dims, ElementsAre(2, 3, kNumLandmarks, 1));
+
+  auto landmarks_view = tensors[0].GetCpuReadView();
+  const float* landmarks = landmarks_view.buffer<float>();
+  EXPECT_THAT(landmarks[0], FloatEq(0.25f));
+  EXPECT_THAT(landmarks[3 * kNumLandmarks], FloatEq(0.5f));
+  auto handedness_view = tensors[1].GetCpuReadView();
+  EXPECT_THAT(handedness_view.buffer<float>()[1], FloatEq(0.75f));
+  auto world_landmarks_view = tensors[2].GetCpuReadView();
+  EXPECT_THAT(world_landmarks_view.buffer<float>()[3 * kNumLandmarks + 2],
+              FloatEq(0.5f));
+}
+
+TEST(HandGestureTensorsCalculatorTest, SkipsHandsThatBarelyMoved) {
+  CalculatorRunner runner(MakeNode(/*min_landmark_delta=*/0.1f));
+  AddFrame({0.25f, 0.5f}, 0, runner);
+  AddFrame({0.3f, 0.7f}, 1, runner);
+  AddFrame({0.33f, 0.71f}, 2, runner);
+  AddFrame({0.4f, 0.72f, 0.1f}, 3, runner);
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& indices = runner.Outputs().Tag("HAND_INDICES").packets;
+  ASSERT_EQ(indices.size(), 4);
+  EXPECT_THAT(indices[0].Get<std::vector<int>>(), ElementsAre(0, 1));
+  EXPECT_THAT(indices[1].Get<std::vector<int>>(), ElementsAre(1));
+  EXPECT_THAT(indices[2].Get<std::vector<int>>(), IsEmpty());
+  // The first hand moved by 0.15 since it was last batched on frame 0.
+  EXPECT_THAT(indices[3].Get<std::vector<int>>(), ElementsAre(0, 2));
+
+  const auto& tensors_packets = runner.Outputs().Tag("TENSORS").packets;
+  ASSERT_EQ(tensors_packets.size(), 3);
+  EXPECT_EQ(tensors_packets[1].Timestamp(), Timestamp(1));
+  EXPECT_EQ(tensors_packets[1].Get<std::vector<Tensor>>()[0].shape().dims[0],
+            1);
+  EXPECT_EQ(tensors_packets[2].Timestamp(), Timestamp(3));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,95 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/port.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/classification.pb.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe::api2 {
+
+// HandGesturesMergeCalculator assembles the gestures of all hands of a frame
+// from the gestures just recognized for the hands in HAND_INDICES and the last
+// gestures recognized for the other hands. It is the counterpart of
+// HandGestureTensorsCalculator, which leaves out the hands that barely moved.
+//
+// Inputs:
+//   HAND_INDICES - std::vector<int>
+//     The indices of the hands whose gestures were recognized on this frame.
+//   CLASSIFICATIONS - std::vector<ClassificationList>
+//     The gestures recognized for the hands in HAND_INDICES, in the same
+//     order. Not expected if HAND_INDICES is empty.
+//   LANDMARKS - std::vector<NormalizedLandmarkList>
+//     The landmarks of all hands of the frame.
+//
+// Outputs:
+//   HAND_GESTURES - std::vector<ClassificationList>
+//     The gestures of each hand in LANDMARKS.
+//
+// Example:
+// node {
+//   calculator: "HandGesturesMergeCalculator"
+//   input_stream: "HAND_INDICES:gesture_hand_indices"
+//   input_stream: "CLASSIFICATIONS:recognized_hand_gestures"
+//   input_stream: "LANDMARKS:landmarks"
+//   output_stream: "HAND_GESTURES:hand_gestures"
+// }
+class HandGesturesMergeCalculator : public Node {
+ public:
+  static constexpr Input<std::vector<int>> kHandIndicesIn{"HAND_INDICES"};
+  static constexpr Input<std::vector<ClassificationList>> kClassificationsIn{
+      "CLASSIFICATIONS"};
+  static constexpr Input<std::vector<NormalizedLandmarkList>> kLandmarksIn{
+      "LANDMARKS"};
+  static constexpr Output<std::vector<ClassificationList>> kHandGesturesOut{
+      "HAND_GESTURES"};
+  MEDIAPIPE_NODE_CONTRACT(kHandIndicesIn, kClassificationsIn, kLandmarksIn,
+                          kHandGesturesOut);
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (kHandIndicesIn(cc).IsEmpty()) {
+      return absl::OkStatus();
+    }
+    RET_CHECK(!kLandmarksIn(cc).IsEmpty());
+    const auto& hand_indices = *kHandIndicesIn(cc);
+    const int num_hands = kLandmarksIn(cc)->size();
+    hand_gestures_.resize(num_hands);
+    if (!hand_indices.empty()) {
+      RET_CHECK(!kClassificationsIn(cc).IsEmpty());
+      const auto& classifications = *kClassificationsIn(cc);
+      RET_CHECK_EQ(classifications.size(), hand_indices.size());
+      for (int i = 0; i < hand_indices.size(); ++i) {
+        RET_CHECK(hand_indices[i] >= 0 && hand_indices[i] < num_hands);
+        hand_gestures_[hand_indices[i]] = classifications[i];
+      }
+    }
+    kHandGesturesOut(cc).Send(hand_gestures_);
+    return absl::OkStatus();
+  }
+
+ private:
+  // The last gestures recognized for each hand.
+  std::vector<ClassificationList> hand_gestures_;
+};
+
+MEDIAPIPE_REGISTER_NODE(HandGesturesMergeCalculator);
+
+}  // namespace mediapipe::api2
@@ -0,0 +1,92 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/classification.pb.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+ClassificationList Gesture(const std::string& label) {
+  ClassificationList gesture;
+  gesture.add_classification()->set_label(label);
+  return gesture;
+}
+
+void AddFrame(int num_hands, const std::vector<int>& hand_indices,
+              const std::vector<std::string>& labels, int64 timestamp,
+              CalculatorRunner& runner) {
+  const Timestamp ts(timestamp);
+  runner.MutableInputs()->Tag("LANDMARKS").packets.push_back(
+      MakePacket<std::vector<NormalizedLandmarkList>>(num_hands).At(ts));
+  runner.MutableInputs()->Tag("HAND_INDICES").packets.push_back(
+      MakePacket<std::vector<int>>(hand_indices).At(ts));
+  if (!labels.empty()) {
+    std::vector<ClassificationList> gestures;
+    for (const auto& label : labels) {
+      gestures.push_back(Gesture(label));
+    }
+    runner.MutableInputs()->Tag("CLASSIFICATIONS").packets.push_back(
+        MakePacket<std::vector<ClassificationList>>(gestures).At(ts));
+  }
+}
+
+std::vector<std::string> GetLabels(const Packet& packet) {
+  std::vector<std::string> labels;
+  for (const auto& gesture : packet.Get<std::vector<ClassificationList>>()) {
+    labels.push_back(gesture.classification_size() > 0
+                         ? gesture.classification(0).label()
+                         : "");
+  }
+  return labels;
+}
+
+TEST(HandGesturesMergeCalculatorTest, ReusesGesturesOfSkippedHands) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(
+      R"pb(
+        calculator: "HandGesturesMergeCalculator"
+        input_stream: "HAND_INDICES:hand_indices"
+        input_stream: "CLASSIFICATIONS:classifications"
+        input_stream: "LANDMARKS:landmarks"
+        output_stream: "HAND_GESTURES:hand_gestures"
+      )pb"));
+  AddFrame(2, {0, 1}, {"Open_Palm", "Victory"}, 0, runner);
+  AddFrame(2, {1}, {"Thumb_Up"}, 1, runner);
+  AddFrame(2, {}, {}, 2, runner);
+  AddFrame(1, {}, {}, 3, runner);
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& packets = runner.Outputs().Tag("HAND_GESTURES").packets;
+  ASSERT_EQ(packets.size(), 4);
+  EXPECT_THAT(GetLabels(packets[0]), ElementsAre("Open_Palm", "Victory"));
+  EXPECT_THAT(GetLabels(packets[1]), ElementsAre("Open_Palm", "Thumb_Up"));
+  EXPECT_THAT(GetLabels(packets[2]), ElementsAre("Open_Palm", "Thumb_Up"));
+  EXPECT_THAT(GetLabels(packets[3]), ElementsAre("Open_Palm"));
+}
+
+}  // namespace
+}  // namespace mediapipe
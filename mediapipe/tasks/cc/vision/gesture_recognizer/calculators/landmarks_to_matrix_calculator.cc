@@ -13,8 +13,6 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
-#include <algorithm>
-#include <limits>
 #include <memory>
 #include <string>
 #include <type_traits>
@@ -22,12 +20,12 @@ limitations under the License.
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
-#include "absl/strings/str_cat.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
 #include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/tasks/cc/vision/gesture_recognizer/calculators/landmarks_to_matrix_calculator.pb.h"
+#include "mediapipe/tasks/cc/vision/gesture_recognizer/calculators/landmarks_to_matrix_util.h"
 
 // TODO Update to use API2
 namespace mediapipe {
@@ -35,84 +33,18 @@ namespace api2 {
 
 namespace {
 
+using ::mediapipe::tasks::vision::gesture_recognizer::LandmarksToMatrix;
+
 constexpr char kLandmarksTag[] = "LANDMARKS";
 constexpr char kWorldLandmarksTag[] = "WORLD_LANDMARKS";
 constexpr char kImageSizeTag[] = "IMAGE_SIZE";
 constexpr char kLandmarksMatrixTag[] = "LANDMARKS_MATRIX";
-constexpr int kFeaturesPerLandmark = 3;
-
-template <class LandmarkListT>
-absl::StatusOr<LandmarkListT> NormalizeLandmarkAspectRatio(
-    const LandmarkListT& landmarks, float width, float height) {
-  const float max_dim = std::max(width, height);
-  if (max_dim <= 0) {
-    return ::absl::InvalidArgumentError(
-        absl::StrCat("Invalid image dimensions: [", width, ",", height, "]"));
-  }
-  const float width_scale_factor = width / max_dim;
-  const float height_scale_factor = height / max_dim;
-  LandmarkListT normalized_landmarks;
-  for (int i = 0; i < landmarks.landmark_size(); ++i) {
-    const auto& old_landmark = landmarks.landmark(i);
-    auto* new_landmark = normalized_landmarks.add_landmark();
-    new_landmark->set_x((old_landmark.x() - 0.5) * width_scale_factor + 0.5);
-    new_landmark->set_y((old_landmark.y() - 0.5) * height_scale_factor + 0.5);
-    new_landmark->set_z(old_landmark.z());
-  }
-  return normalized_landmarks;
-}
-
-template <class LandmarkListT>
-absl::StatusOr<LandmarkListT> NormalizeObject(const LandmarkListT& landmarks,
-                                              int origin_offset) {
-  if (landmarks.landmark_size() == 0) {
-    return ::absl::InvalidArgumentError(
-        "Expected non-zero number of input landmarks.");
-  }
-  LandmarkListT canonicalized_landmarks;
-  const auto& origin = landmarks.landmark(origin_offset);
-  float min_x = std::numeric_limits<float>::max();
-  float max_x = std::numeric_limits<float>::min();
-  float min_y = std::numeric_limits<float>::max();
-  float max_y = std::numeric_limits<float>::min();
-  for (int i = 0; i < landmarks.landmark_size(); ++i) {
-    const auto& old_landmark = landmarks.landmark(i);
-    auto* new_landmark = canonicalized_landmarks.add_landmark();
-    new_landmark->set_x(old_landmark.x() - origin.x());
-    new_landmark->set_y(old_landmark.y() - origin.y());
-    new_landmark->set_z(old_landmark.z() - origin.z());
-    min_x = std::min(min_x, new_landmark->x());
-    max_x = std::max(max_x, new_landmark->x());
-    min_y = std::min(min_y, new_landmark->y());
-    max_y = std::max(max_y, new_landmark->y());
-  }
-  const float kEpsilon = 1e-5;
-  const float scale = std::max(max_x - min_x, max_y - min_y) + kEpsilon;
-  for (auto& landmark : *canonicalized_landmarks.mutable_landmark()) {
-    landmark.set_x(landmark.x() / scale);
-    landmark.set_y(landmark.y() / scale);
-    landmark.set_z(landmark.z() / scale);
-  }
-  return canonicalized_landmarks;
-}
-
-template <class LandmarkListT>
-Matrix LandmarksToMatrix(const LandmarkListT& landmarks) {
-  auto matrix = Matrix(kFeaturesPerLandmark, landmarks.landmark_size());
-  for (int i = 0; i < landmarks.landmark_size(); ++i) {
-    const auto& landmark = landmarks.landmark(i);
-    matrix(0, i) = landmark.x();
-    matrix(1, i) = landmark.y();
-    matrix(2, i) = landmark.z();
-  }
-  return matrix;
-}
 
 template <class T>
 struct DependentFalse : std::false_type {};
 
 template <typename LandmarkListT>
-bool IsNormalized() {
+constexpr bool IsNormalized() {
   if constexpr (std::is_same_v<LandmarkListT, NormalizedLandmarkList>) {
     return true;
   } else if constexpr (std::is_same_v<LandmarkListT, LandmarkList>) {
@@ -124,26 +56,22 @@ bool IsNormalized() {
 }
 
 template <class LandmarkListT>
-absl::Status ProcessLandmarks(LandmarkListT landmarks, CalculatorContext* cc) {
-  if (IsNormalized<LandmarkListT>()) {
+absl::Status ProcessLandmarks(const LandmarkListT& landmarks,
+                              CalculatorContext* cc) {
+  const auto& options = cc->Options<LandmarksToMatrixCalculatorOptions>();
+  auto landmarks_matrix = std::make_unique<Matrix>();
+  if constexpr (IsNormalized<LandmarkListT>()) {
     RET_CHECK(cc->Inputs().HasTag(kImageSizeTag) &&
               !cc->Inputs().Tag(kImageSizeTag).IsEmpty());
-    const auto [width, height] =
-        cc->Inputs().Tag(kImageSizeTag).Get<std::pair<int, int>>();
-    ASSIGN_OR_RETURN(landmarks,
-                     NormalizeLandmarkAspectRatio(landmarks, width, height));
-  }
-
-  const auto& options = cc->Options<LandmarksToMatrixCalculatorOptions>();
-  if (options.object_normalization()) {
     ASSIGN_OR_RETURN(
-        landmarks,
-        NormalizeObject(landmarks,
-                        options.object_normalization_origin_offset()));
+        *landmarks_matrix,
+        LandmarksToMatrix(
+            landmarks,
+            cc->Inputs().Tag(kImageSizeTag).Get<std::pair<int, int>>(),
+            options));
+  } else {
+    ASSIGN_OR_RETURN(*landmarks_matrix, LandmarksToMatrix(landmarks, options));
   }
-
-  auto landmarks_matrix = std::make_unique<Matrix>();
-  *landmarks_matrix = LandmarksToMatrix(landmarks);
   cc->Outputs()
       .Tag(kLandmarksMatrixTag)
       .Add(landmarks_matrix.release(), cc->InputTimestamp());
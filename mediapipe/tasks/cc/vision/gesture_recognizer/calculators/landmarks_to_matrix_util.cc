@@ -0,0 +1,137 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/vision/gesture_recognizer/calculators/landmarks_to_matrix_util.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/matrix.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/tasks/cc/vision/gesture_recognizer/calculators/landmarks_to_matrix_calculator.pb.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace vision {
+namespace gesture_recognizer {
+
+namespace {
+
+template <class LandmarkListT>
+absl::StatusOr<LandmarkListT> NormalizeLandmarkAspectRatio(
+    const LandmarkListT& landmarks, float width, float height) {
+  const float max_dim = std::max(width, height);
+  if (max_dim <= 0) {
+    return ::absl::InvalidArgumentError(
+        absl::StrCat("Invalid image dimensions: [", width, ",", height, "]"));
+  }
+  const float width_scale_factor = width / max_dim;
+  const float height_scale_factor = height / max_dim;
+  LandmarkListT normalized_landmarks;
+  for (int i = 0; i < landmarks.landmark_size(); ++i) {
+    const auto& old_landmark = landmarks.landmark(i);
+    auto* new_landmark = normalized_landmarks.add_landmark();
+    new_landmark->set_x((old_landmark.x() - 0.5) * width_scale_factor + 0.5);
+    new_landmark->set_y((old_landmark.y() - 0.5) * height_scale_factor + 0.5);
+    new_landmark->set_z(old_landmark.z());
+  }
+  return normalized_landmarks;
+}
+
+template <class LandmarkListT>
+absl::StatusOr<LandmarkListT> NormalizeObject(const LandmarkListT& landmarks,
+                                              int origin_offset) {
+  if (landmarks.landmark_size() == 0) {
+    return ::absl::InvalidArgumentError(
+        "Expected non-zero number of input landmarks.");
+  }
+  LandmarkListT canonicalized_landmarks;
+  const auto& origin = landmarks.landmark(origin_offset);
+  float min_x = std::numeric_limits<float>::max();
+  float max_x = std::numeric_limits<float>::min();
+  float min_y = std::numeric_limits<float>::max();
+  float max_y = std::numeric_limits<float>::min();
+  for (int i = 0; i < landmarks.landmark_size(); ++i) {
+    const auto& old_landmark = landmarks.landmark(i);
+    auto* new_landmark = canonicalized_landmarks.add_landmark();
+    new_landmark->set_x(old_landmark.x() - origin.x());
+    new_landmark->set_y(old_landmark.y() - origin.y());
+    new_landmark->set_z(old_landmark.z() - origin.z());
+    min_x = std::min(min_x, new_landmark->x());
+    max_x = std::max(max_x, new_landmark->x());
+    min_y = std::min(min_y, new_landmark->y());
+    max_y = std::max(max_y, new_landmark->y());
+  }
+  const float kEpsilon = 1e-5;
+  const float scale = std::max(max_x - min_x, max_y - min_y) + kEpsilon;
+  for (auto& landmark : *canonicalized_landmarks.mutable_landmark()) {
+    landmark.set_x(landmark.x() / scale);
+    landmark.set_y(landmark.y() / scale);
+    landmark.set_z(landmark.z() / scale);
+  }
+  return canonicalized_landmarks;
+}
+
+template <class LandmarkListT>
+Matrix ToMatrix(const LandmarkListT& landmarks) {
+  auto matrix = Matrix(kFeaturesPerLandmark, landmarks.landmark_size());
+  for (int i = 0; i < landmarks.landmark_size(); ++i) {
+    const auto& landmark = landmarks.landmark(i);
+    matrix(0, i) = landmark.x();
+    matrix(1, i) = landmark.y();
+    matrix(2, i) = landmark.z();
+  }
+  return matrix;
+}
+
+template <class LandmarkListT>
+absl::StatusOr<Matrix> ObjectNormalizedMatrix(
+    LandmarkListT landmarks,
+    const LandmarksToMatrixCalculatorOptions& options) {
+  if (options.object_normalization()) {
+    ASSIGN_OR_RETURN(
+        landmarks,
+        NormalizeObject(landmarks,
+                        options.object_normalization_origin_offset()));
+  }
+  return ToMatrix(landmarks);
+}
+
+}  // namespace
+
+absl::StatusOr<Matrix> LandmarksToMatrix(
+    const NormalizedLandmarkList& landmarks, std::pair<int, int> image_size,
+    const LandmarksToMatrixCalculatorOptions& options) {
+  const auto [width, height] = image_size;
+  ASSIGN_OR_RETURN(auto normalized_landmarks,
+                   NormalizeLandmarkAspectRatio(landmarks, width, height));
+  return ObjectNormalizedMatrix(std::move(normalized_landmarks), options);
+}
+
+absl::StatusOr<Matrix> LandmarksToMatrix(
+    const LandmarkList& landmarks,
+    const LandmarksToMatrixCalculatorOptions& options) {
+  return ObjectNormalizedMatrix(landmarks, options);
+}
+
+}  // namespace gesture_recognizer
+}  // namespace vision
+}  // namespace tasks
+}  // namespace mediapipe
@@ -0,0 +1,54 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef MEDIAPIPE_TASKS_CC_VISION_GESTURE_RECOGNIZER_CALCULATORS_LANDMARKS_TO_MATRIX_UTIL_H_
+#define MEDIAPIPE_TASKS_CC_VISION_GESTURE_RECOGNIZER_CALCULATORS_LANDMARKS_TO_MATRIX_UTIL_H_
+
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/matrix.h"
+#include "mediapipe/tasks/cc/vision/gesture_recognizer/calculators/landmarks_to_matrix_calculator.pb.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace vision {
+namespace gesture_recognizer {
+
+// The number of matrix rows per landmark: x, y and z.
+inline constexpr int kFeaturesPerLandmark = 3;
+
+// Converts `landmarks` into a matrix with one column of (x, y, z) per
+// landmark. The landmarks are first normalized w.r.t. the aspect ratio of the
+// (width, height) `image_size`, then optionally w.r.t. an origin landmark as
+// configured by `options`.
+absl::StatusOr<Matrix> LandmarksToMatrix(
+    const NormalizedLandmarkList& landmarks, std::pair<int, int> image_size,
+    const LandmarksToMatrixCalculatorOptions& options);
+
+// Converts world `landmarks` into a matrix with one column of (x, y, z) per
+// landmark, optionally normalized w.r.t. an origin landmark as configured by
+// `options`.
+absl::StatusOr<Matrix> LandmarksToMatrix(
+    const LandmarkList& landmarks,
+    const LandmarksToMatrixCalculatorOptions& options);
+
+}  // namespace gesture_recognizer
+}  // namespace vision
+}  // namespace tasks
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_TASKS_CC_VISION_GESTURE_RECOGNIZER_CALCULATORS_LANDMARKS_TO_MATRIX_UTIL_H_
@@ -158,6 +158,11 @@ ConvertGestureRecognizerGraphOptionsProto(GestureRecognizerOptions* options) {
     hand_gesture_recognizer_graph_options->mutable_classifier_options()
         ->set_score_threshold(options->min_gesture_confidence);
   }
+  hand_gesture_recognizer_graph_options->set_batch_hands(options->batch_hands);
+  if (use_stream_mode) {
+    hand_gesture_recognizer_graph_options->set_min_landmark_delta(
+        options->min_gesture_landmark_delta);
+  }
   return options_proto;
 }
 
@@ -212,7 +217,7 @@ absl::StatusOr<std::unique_ptr<GestureRecognizer>> GestureRecognizer::Create(
           std::move(options_proto),
           options->running_mode == core::RunningMode::LIVE_STREAM),
       std::move(options->base_options.op_resolver), options->running_mode,
-      std::move(packets_callback));
+      std::move(packets_callback), options->base_options.num_graph_instances);
 }
 
 absl::StatusOr<GestureRecognitionResult> GestureRecognizer::Recognize(
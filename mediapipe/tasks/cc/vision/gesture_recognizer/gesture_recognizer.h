@@ -75,6 +75,17 @@ struct GestureRecognizerOptions {
   // merging calculator is implemented.
   float min_gesture_confidence = -1;
 
+  // Whether to recognize the gestures of all hands of a frame with a single
+  // batched inference instead of one inference per hand. The gesture model
+  // must accept a variable batch size.
+  bool batch_hands = false;
+
+  // If > 0, the gestures of a hand whose landmarks moved by less than this
+  // distance, in normalized image coordinates, since its gestures were last
+  // recognized are reused instead of being recognized again. Only applies to
+  // the video and live stream modes, and requires `batch_hands`.
+  float min_gesture_landmark_delta = 0;
+
   // The user-defined result callback for processing live stream data.
   // The result callback should only be specified when the running mode is set
   // to RunningMode::LIVE_STREAM.
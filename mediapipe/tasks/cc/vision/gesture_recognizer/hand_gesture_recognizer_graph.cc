@@ -33,6 +33,7 @@ limitations under the License.
 #include "mediapipe/tasks/cc/core/model_task_graph.h"
 #include "mediapipe/tasks/cc/core/proto/inference_subgraph.pb.h"
 #include "mediapipe/tasks/cc/core/utils.h"
+#include "mediapipe/tasks/cc/vision/gesture_recognizer/calculators/hand_gesture_tensors_calculator.pb.h"
 #include "mediapipe/tasks/cc/vision/gesture_recognizer/calculators/landmarks_to_matrix_calculator.pb.h"
 #include "mediapipe/tasks/cc/vision/gesture_recognizer/proto/hand_gesture_recognizer_graph_options.pb.h"
 #include "mediapipe/tasks/metadata/metadata_schema_generated.h"
@@ -68,6 +69,9 @@ constexpr char kVectorTag[] = "VECTOR";
 constexpr char kIndexTag[] = "INDEX";
 constexpr char kIterableTag[] = "ITERABLE";
 constexpr char kBatchEndTag[] = "BATCH_END";
+constexpr char kHandIndicesTag[] = "HAND_INDICES";
+constexpr char kClassificationsTag[] = "CLASSIFICATIONS";
+constexpr char kMultiClassificationsTag[] = "MULTI_CLASSIFICATIONS";
 
 Source<std::vector<Tensor>> ConvertMatrixToTensor(Source<Matrix> matrix,
                                                   Graph& graph) {
@@ -76,6 +80,24 @@ Source<std::vector<Tensor>> ConvertMatrixToTensor(Source<Matrix> matrix,
   return node[Output<std::vector<Tensor>>{"TENSORS"}];
 }
 
+// Sanity check for the batching options.
+absl::Status SanityCheckOptions(
+    const HandGestureRecognizerGraphOptions& options) {
+  if (options.min_landmark_delta() < 0) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        "Invalid `min_landmark_delta` option: value must be >= 0.",
+        MediaPipeTasksStatus::kInvalidArgumentError);
+  }
+  if (options.min_landmark_delta() > 0 && !options.batch_hands()) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        "`min_landmark_delta` requires `batch_hands` to be enabled.",
+        MediaPipeTasksStatus::kInvalidArgumentError);
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 // A
@@ -248,6 +270,10 @@ REGISTER_MEDIAPIPE_GRAPH(
 //     A vector of recognized hand gestures. Each vector element is the
 //     ClassificationList of the hand in input vector.
 //
+// If `batch_hands` is set, the gestures of all hands are recognized with a
+// single batched inference instead of running
+// SingleHandGestureRecognizerGraph for each hand, and `min_landmark_delta`
+// lets hands that barely moved reuse their previous gestures.
 //
 // Example:
 // node {
@@ -274,16 +300,29 @@ class MultipleHandGestureRecognizerGraph : public core::ModelTaskGraph {
  public:
   absl::StatusOr<CalculatorGraphConfig> GetConfig(
       SubgraphContext* sc) override {
+    const auto& graph_options =
+        sc->Options<HandGestureRecognizerGraphOptions>();
+    MP_RETURN_IF_ERROR(SanityCheckOptions(graph_options));
     Graph graph;
+    auto multi_handedness =
+        graph[Input<std::vector<ClassificationList>>(kHandednessTag)];
+    auto multi_hand_landmarks =
+        graph[Input<std::vector<NormalizedLandmarkList>>(kLandmarksTag)];
+    auto multi_hand_world_landmarks =
+        graph[Input<std::vector<LandmarkList>>(kWorldLandmarksTag)];
+    auto image_size = graph[Input<std::pair<int, int>>(kImageSizeTag)];
+    auto multi_hand_tracking_ids =
+        graph[Input<std::vector<int>>(kHandTrackingIdsTag)];
     ASSIGN_OR_RETURN(
         auto multi_hand_gestures,
-        BuildMultiGestureRecognizerSubraph(
-            sc->Options<HandGestureRecognizerGraphOptions>(),
-            graph[Input<std::vector<ClassificationList>>(kHandednessTag)],
-            graph[Input<std::vector<NormalizedLandmarkList>>(kLandmarksTag)],
-            graph[Input<std::vector<LandmarkList>>(kWorldLandmarksTag)],
-            graph[Input<std::pair<int, int>>(kImageSizeTag)],
-            graph[Input<std::vector<int>>(kHandTrackingIdsTag)], graph));
+        graph_options.batch_hands()
+            ? BuildBatchedGestureRecognizerSubgraph(
+                  sc, graph_options, multi_handedness, multi_hand_landmarks,
+                  multi_hand_world_landmarks, image_size, graph)
+            : BuildMultiGestureRecognizerSubraph(
+                  graph_options, multi_handedness, multi_hand_landmarks,
+                  multi_hand_world_landmarks, image_size,
+                  multi_hand_tracking_ids, graph));
     multi_hand_gestures >>
         graph[Output<std::vector<ClassificationList>>(kHandGesturesTag)];
     return graph.GetConfig();
@@ -353,6 +392,57 @@ class MultipleHandGestureRecognizerGraph : public core::ModelTaskGraph {
 
     return multi_hand_gestures;
   }
+
+  absl::StatusOr<Source<std::vector<ClassificationList>>>
+  BuildBatchedGestureRecognizerSubgraph(
+      SubgraphContext* sc,
+      const HandGestureRecognizerGraphOptions& graph_options,
+      Source<std::vector<ClassificationList>> multi_handedness,
+      Source<std::vector<NormalizedLandmarkList>> multi_hand_landmarks,
+      Source<std::vector<LandmarkList>> multi_hand_world_landmarks,
+      Source<std::pair<int, int>> image_size, Graph& graph) {
+    ASSIGN_OR_RETURN(
+        const auto* model_resources,
+        CreateModelResources<HandGestureRecognizerGraphOptions>(sc));
+    // Converts the hands that need gesture recognition to batched tensors,
+    // laid out as the tensors SingleHandGestureRecognizerGraph builds per hand.
+    auto& hand_gesture_tensors = graph.AddNode("HandGestureTensorsCalculator");
+    auto& tensors_options =
+        hand_gesture_tensors.GetOptions<HandGestureTensorsCalculatorOptions>();
+    tensors_options.mutable_landmarks_options()->set_object_normalization(true);
+    tensors_options.mutable_landmarks_options()
+        ->set_object_normalization_origin_offset(0);
+    tensors_options.set_min_landmark_delta(graph_options.min_landmark_delta());
+    multi_handedness >> hand_gesture_tensors.In(kHandednessTag);
+    multi_hand_landmarks >> hand_gesture_tensors.In(kLandmarksTag);
+    multi_hand_world_landmarks >> hand_gesture_tensors.In(kWorldLandmarksTag);
+    image_size >> hand_gesture_tensors.In(kImageSizeTag);
+    auto hand_indices = hand_gesture_tensors.Out(kHandIndicesTag);
+
+    auto& inference = AddInference(
+        *model_resources, graph_options.base_options().acceleration(), graph);
+    hand_gesture_tensors.Out(kTensorsTag) >> inference.In(kTensorsTag);
+    auto inference_output_tensors = inference.Out(kTensorsTag);
+
+    auto& tensors_to_classification =
+        graph.AddNode("TensorsToClassificationCalculator");
+    MP_RETURN_IF_ERROR(ConfigureTensorsToClassificationCalculator(
+        graph_options.classifier_options(),
+        *model_resources->GetMetadataExtractor(), 0,
+        &tensors_to_classification.GetOptions<
+            mediapipe::TensorsToClassificationCalculatorOptions>()));
+    inference_output_tensors >> tensors_to_classification.In(kTensorsTag);
+    auto batch_hand_gestures =
+        tensors_to_classification.Out(kMultiClassificationsTag);
+
+    // Fills in the gestures of the hands left out of the batch.
+    auto& merge_hand_gestures = graph.AddNode("HandGesturesMergeCalculator");
+    hand_indices >> merge_hand_gestures.In(kHandIndicesTag);
+    batch_hand_gestures >> merge_hand_gestures.In(kClassificationsTag);
+    multi_hand_landmarks >> merge_hand_gestures.In(kLandmarksTag);
+    return merge_hand_gestures[Output<std::vector<ClassificationList>>(
+        kHandGesturesTag)];
+  }
 };
 
 // clang-format off
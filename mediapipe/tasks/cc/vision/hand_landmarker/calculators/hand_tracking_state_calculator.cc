@@ -0,0 +1,131 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/port.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/tasks/cc/vision/hand_landmarker/calculators/hand_tracking_state_calculator.pb.h"
+
+namespace mediapipe::api2 {
+
+// HandTrackingStateCalculator decides, from the hands tracked on the previous
+// frame, whether the hand detector can be skipped on the current frame.
+//
+// The tracking is stable if at least `num_hands` hands were tracked and, if
+// PRESENCE_SCORES is connected, all of them had a presence score of at least
+// `min_presence_score`. The hand detector is skipped while the tracking is
+// stable, except every `redetection_interval` frames if it is positive.
+//
+// Inputs:
+//   HAND_RECTS - std::vector<NormalizedRect>
+//     The hand rects tracked on the previous frame. No packet means that no
+//     hand was tracked.
+//   PRESENCE_SCORES - std::vector<float> @Optional
+//     The presence scores of the hands tracked on the previous frame.
+//
+// Outputs:
+//   SKIP_DETECTION - bool
+//     Whether the hand detector can be skipped on the current frame. Not
+//     output if no hand was tracked.
+//   REDETECTION - bool @Optional
+//     Whether the hand detector runs on the current frame only because of
+//     `redetection_interval`, in which case its detections should take
+//     precedence over the tracked hands.
+//
+// Example:
+// node {
+//   calculator: "HandTrackingStateCalculator"
+//   input_stream: "HAND_RECTS:prev_hand_rects"
+//   input_stream: "PRESENCE_SCORES:prev_presence_scores"
+//   output_stream: "SKIP_DETECTION:skip_hand_detection"
+//   output_stream: "REDETECTION:hand_redetection"
+//   options {
+//     [mediapipe.HandTrackingStateCalculatorOptions.ext] {
+//       num_hands: 2
+//       min_presence_score: 0.8
+//       redetection_interval: 30
+//     }
+//   }
+// }
+class HandTrackingStateCalculator : public Node {
+ public:
+  static constexpr Input<std::vector<NormalizedRect>> kHandRectsIn{
+      "HAND_RECTS"};
+  static constexpr Input<std::vector<float>>::Optional kPresenceScoresIn{
+      "PRESENCE_SCORES"};
+  static constexpr Output<bool> kSkipDetectionOut{"SKIP_DETECTION"};
+  static constexpr Output<bool>::Optional kRedetectionOut{"REDETECTION"};
+  MEDIAPIPE_NODE_CONTRACT(kHandRectsIn, kPresenceScoresIn, kSkipDetectionOut,
+                          kRedetectionOut);
+
+  static absl::Status UpdateContract(CalculatorContract* cc) {
+    // Lets Process() reset the re-detection interval when no hand was tracked.
+    cc->SetProcessTimestampBounds(true);
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    cc->SetOffset(TimestampDiff(0));
+    options_ = cc->Options<HandTrackingStateCalculatorOptions>();
+    RET_CHECK_GE(options_.num_hands(), 1);
+    RET_CHECK_GE(options_.redetection_interval(), 0);
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (kHandRectsIn(cc).IsEmpty()) {
+      // The hand detector runs anyway.
+      num_skipped_frames_ = 0;
+      return absl::OkStatus();
+    }
+    bool is_stable =
+        static_cast<int>(kHandRectsIn(cc).Get().size()) >= options_.num_hands();
+    if (is_stable && !kPresenceScoresIn(cc).IsEmpty()) {
+      const auto& presence_scores = kPresenceScoresIn(cc).Get();
+      const float min_presence_score = options_.min_presence_score();
+      is_stable = std::all_of(
+          presence_scores.begin(), presence_scores.end(),
+          [min_presence_score](float score) {
+            return score >= min_presence_score;
+          });
+    }
+    const bool is_redetection =
+        is_stable && options_.redetection_interval() > 0 &&
+        num_skipped_frames_ + 1 >= options_.redetection_interval();
+    const bool skip_detection = is_stable && !is_redetection;
+    num_skipped_frames_ = skip_detection ? num_skipped_frames_ + 1 : 0;
+
+    kSkipDetectionOut(cc).Send(skip_detection);
+    if (kRedetectionOut(cc).IsConnected()) {
+      kRedetectionOut(cc).Send(is_redetection);
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  HandTrackingStateCalculatorOptions options_;
+  // Number of consecutive frames on which the hand detector was skipped.
+  int num_skipped_frames_ = 0;
+};
+
+MEDIAPIPE_REGISTER_NODE(HandTrackingStateCalculator);
+
+}  // namespace mediapipe::api2
@@ -0,0 +1,120 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/substitute.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+CalculatorGraphConfig::Node MakeNode(bool with_presence_scores,
+                                     const std::string& options) {
+  return ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::Substitute(
+      R"pb(
+        calculator: "HandTrackingStateCalculator"
+        input_stream: "HAND_RECTS:hand_rects"
+        $0
+        output_stream: "SKIP_DETECTION:skip_detection"
+        output_stream: "REDETECTION:redetection"
+        options {
+          [mediapipe.HandTrackingStateCalculatorOptions.ext] { $1 }
+        }
+      )pb",
+      with_presence_scores ? R"(input_stream: "PRESENCE_SCORES:scores")" : "",
+      options));
+}
+
+void AddHandRects(int num_hands, int64 timestamp, CalculatorRunner& runner) {
+  runner.MutableInputs()
+      ->Tag("HAND_RECTS")
+      .packets.push_back(
+          MakePacket<std::vector<NormalizedRect>>(num_hands).At(
+              Timestamp(timestamp)));
+}
+
+std::vector<bool> GetBools(const std::string& tag,
+                           const CalculatorRunner& runner) {
+  std::vector<bool> values;
+  for (const Packet& packet : runner.Outputs().Tag(tag).packets) {
+    values.push_back(packet.Get<bool>());
+  }
+  return values;
+}
+
+TEST(HandTrackingStateCalculatorTest, SkipsDetectionWhenEnoughHandsTracked) {
+  CalculatorRunner runner(MakeNode(false, "num_hands: 2"));
+  AddHandRects(1, 0, runner);
+  AddHandRects(2, 1, runner);
+  AddHandRects(3, 2, runner);
+  MP_ASSERT_OK(runner.Run());
+
+  EXPECT_THAT(GetBools("SKIP_DETECTION", runner),
+              ElementsAre(false, true, true));
+  EXPECT_THAT(GetBools("REDETECTION", runner),
+              ElementsAre(false, false, false));
+}
+
+TEST(HandTrackingStateCalculatorTest, RequiresMinPresenceScore) {
+  CalculatorRunner runner(
+      MakeNode(true, "num_hands: 2 min_presence_score: 0.5"));
+  AddHandRects(2, 0, runner);
+  AddHandRects(2, 1, runner);
+  auto& scores = runner.MutableInputs()->Tag("PRESENCE_SCORES").packets;
+  scores.push_back(
+      MakePacket<std::vector<float>>(std::vector<float>{0.9, 0.4})
+          .At(Timestamp(0)));
+  scores.push_back(
+      MakePacket<std::vector<float>>(std::vector<float>{0.9, 0.6})
+          .At(Timestamp(1)));
+  MP_ASSERT_OK(runner.Run());
+
+  EXPECT_THAT(GetBools("SKIP_DETECTION", runner), ElementsAre(false, true));
+}
+
+TEST(HandTrackingStateCalculatorTest, RunsDetectionEveryRedetectionInterval) {
+  CalculatorRunner runner(
+      MakeNode(false, "num_hands: 1 redetection_interval: 3"));
+  for (int i = 0; i < 6; ++i) {
+    AddHandRects(1, i, runner);
+  }
+  // Losing the tracking restarts the interval.
+  AddHandRects(0, 6, runner);
+  AddHandRects(1, 7, runner);
+  AddHandRects(1, 8, runner);
+  AddHandRects(1, 9, runner);
+  MP_ASSERT_OK(runner.Run());
+
+  EXPECT_THAT(GetBools("SKIP_DETECTION", runner),
+              ElementsAre(true, true, false, true, true, false, false, true,
+                          true, false));
+  EXPECT_THAT(GetBools("REDETECTION", runner),
+              ElementsAre(false, false, true, false, false, true, false, false,
+                          false, true));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -20,7 +20,6 @@ limitations under the License.
 
 #include "mediapipe/calculators/core/clip_vector_size_calculator.pb.h"
 #include "mediapipe/calculators/core/gate_calculator.pb.h"
-#include "mediapipe/calculators/util/collection_has_min_size_calculator.pb.h"
 #include "mediapipe/framework/api2/builder.h"
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/formats/classification.pb.h"
@@ -35,6 +34,7 @@ limitations under the License.
 #include "mediapipe/tasks/cc/core/utils.h"
 #include "mediapipe/tasks/cc/vision/hand_detector/proto/hand_detector_graph_options.pb.h"
 #include "mediapipe/tasks/cc/vision/hand_landmarker/calculators/hand_association_calculator.pb.h"
+#include "mediapipe/tasks/cc/vision/hand_landmarker/calculators/hand_tracking_state_calculator.pb.h"
 #include "mediapipe/tasks/cc/vision/hand_landmarker/proto/hand_landmarker_graph_options.pb.h"
 #include "mediapipe/tasks/cc/vision/hand_landmarker/proto/hand_landmarks_detector_graph_options.pb.h"
 
@@ -47,8 +47,10 @@ namespace {
 
 using ::mediapipe::api2::Input;
 using ::mediapipe::api2::Output;
+using ::mediapipe::api2::builder::GenericNode;
 using ::mediapipe::api2::builder::Graph;
 using ::mediapipe::api2::builder::Source;
+using ::mediapipe::tasks::components::utils::AllowIf;
 using ::mediapipe::tasks::components::utils::DisallowIf;
 using ::mediapipe::tasks::vision::hand_detector::proto::
     HandDetectorGraphOptions;
@@ -64,8 +66,29 @@ constexpr char kHandRectNextFrameTag[] = "HAND_RECT_NEXT_FRAME";
 constexpr char kHandednessTag[] = "HANDEDNESS";
 constexpr char kPalmDetectionsTag[] = "PALM_DETECTIONS";
 constexpr char kPalmRectsTag[] = "PALM_RECTS";
+constexpr char kPresenceScoreTag[] = "PRESENCE_SCORE";
 constexpr char kPreviousLoopbackCalculatorName[] = "PreviousLoopbackCalculator";
 
+// Sanity check for supported hand tracking options.
+absl::Status SanityCheckOptions(const HandLandmarkerGraphOptions& options) {
+  if (options.has_min_tracking_presence_score() &&
+      (options.min_tracking_presence_score() < 0 ||
+       options.min_tracking_presence_score() > 1)) {
+    return CreateStatusWithPayload(absl::StatusCode::kInvalidArgument,
+                                   "Invalid `min_tracking_presence_score` "
+                                   "option: value must be in the range [0.0, "
+                                   "1.0]",
+                                   MediaPipeTasksStatus::kInvalidArgumentError);
+  }
+  if (options.redetection_interval() < 0) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        "Invalid `redetection_interval` option: value must be >= 0",
+        MediaPipeTasksStatus::kInvalidArgumentError);
+  }
+  return absl::OkStatus();
+}
+
 struct HandLandmarkerOutputs {
   Source<std::vector<NormalizedLandmarkList>> landmark_lists;
   Source<std::vector<LandmarkList>> world_landmark_lists;
@@ -85,7 +108,10 @@ struct HandLandmarkerOutputs {
 // produced by HandDetectorGraph. HandLandmarkerGraph tracks the landmarks over
 // time, and skips the HandDetectorGraph. If the tracking is lost or the detectd
 // hands are less than configured max number hands, HandDetectorGraph would be
-// triggered to detect hands.
+// triggered to detect hands. If `min_tracking_presence_score` is set, every
+// tracked hand must also reach that presence score for the detector to be
+// skipped, and a positive `redetection_interval` forces the detector to run
+// periodically to pick up hands the tracker drifted away from.
 //
 // Accepts CPU input images and outputs Landmarks on CPU.
 //
@@ -181,7 +207,6 @@ class HandLandmarkerGraph : public core::ModelTaskGraph {
         auto* info = config.mutable_node(i)->add_input_stream_info();
         info->set_tag_index("LOOP");
         info->set_back_edge(true);
-        break;
       }
     }
     return config;
@@ -197,23 +222,38 @@ class HandLandmarkerGraph : public core::ModelTaskGraph {
   absl::StatusOr<HandLandmarkerOutputs> BuildHandLandmarkerGraph(
       const HandLandmarkerGraphOptions& tasks_options, Source<Image> image_in,
       Graph& graph) {
+    MP_RETURN_IF_ERROR(SanityCheckOptions(tasks_options));
     const int max_num_hands =
         tasks_options.hand_detector_graph_options().num_hands();
+    const bool check_presence_score =
+        tasks_options.has_min_tracking_presence_score();
+    const bool redetect = tasks_options.redetection_interval() > 0;
 
     auto& previous_loopback = graph.AddNode(kPreviousLoopbackCalculatorName);
     image_in >> previous_loopback.In("MAIN");
     auto prev_hand_rects_from_landmarks =
         previous_loopback[Output<std::vector<NormalizedRect>>("PREV_LOOP")];
 
-    auto& min_size_node =
-        graph.AddNode("NormalizedRectVectorHasMinSizeCalculator");
-    prev_hand_rects_from_landmarks >> min_size_node.In("ITERABLE");
-    min_size_node.GetOptions<CollectionHasMinSizeCalculatorOptions>()
-        .set_min_size(max_num_hands);
-    auto has_enough_hands = min_size_node.Out("").Cast<bool>();
+    auto& tracking_state = graph.AddNode("HandTrackingStateCalculator");
+    auto& tracking_state_options =
+        tracking_state.GetOptions<HandTrackingStateCalculatorOptions>();
+    tracking_state_options.set_num_hands(max_num_hands);
+    tracking_state_options.set_redetection_interval(
+        tasks_options.redetection_interval());
+    prev_hand_rects_from_landmarks >> tracking_state.In("HAND_RECTS");
+    GenericNode* previous_presence_loopback = nullptr;
+    if (check_presence_score) {
+      tracking_state_options.set_min_presence_score(
+          tasks_options.min_tracking_presence_score());
+      previous_presence_loopback =
+          &graph.AddNode(kPreviousLoopbackCalculatorName);
+      image_in >> previous_presence_loopback->In("MAIN");
+      previous_presence_loopback->Out("PREV_LOOP") >>
+          tracking_state.In("PRESENCE_SCORES");
+    }
+    auto skip_detection = tracking_state[Output<bool>("SKIP_DETECTION")];
 
-    auto image_for_hand_detector =
-        DisallowIf(image_in, has_enough_hands, graph);
+    auto image_for_hand_detector = DisallowIf(image_in, skip_detection, graph);
 
     auto& hand_detector =
         graph.AddNode("mediapipe.tasks.vision.hand_detector.HandDetectorGraph");
@@ -225,10 +265,22 @@ class HandLandmarkerGraph : public core::ModelTaskGraph {
     auto& hand_association = graph.AddNode("HandAssociationCalculator");
     hand_association.GetOptions<HandAssociationCalculatorOptions>()
         .set_min_similarity_threshold(tasks_options.min_tracking_confidence());
-    prev_hand_rects_from_landmarks >>
-        hand_association[Input<std::vector<NormalizedRect>>::Multiple("")][0];
-    hand_rects_from_hand_detector >>
-        hand_association[Input<std::vector<NormalizedRect>>::Multiple("")][1];
+    auto association_inputs =
+        hand_association[Input<std::vector<NormalizedRect>>::Multiple("")];
+    if (redetect) {
+      // HandAssociationCalculator keeps the rects of earlier inputs over the
+      // overlapping rects of later ones, so on re-detection frames the tracked
+      // rects are moved behind the detected ones.
+      auto redetection = tracking_state[Output<bool>("REDETECTION")];
+      DisallowIf(prev_hand_rects_from_landmarks, redetection, graph) >>
+          association_inputs[0];
+      hand_rects_from_hand_detector >> association_inputs[1];
+      AllowIf(prev_hand_rects_from_landmarks, redetection, graph) >>
+          association_inputs[2];
+    } else {
+      prev_hand_rects_from_landmarks >> association_inputs[0];
+      hand_rects_from_hand_detector >> association_inputs[1];
+    }
     auto hand_rects = hand_association.Out("");
 
     auto& clip_hand_rects =
@@ -278,6 +330,10 @@ class HandLandmarkerGraph : public core::ModelTaskGraph {
 
     // Back edge.
     filtered_hand_rects_for_next_frame >> previous_loopback.In("LOOP");
+    if (previous_presence_loopback != nullptr) {
+      hand_landmarks_detector_graph.Out(kPresenceScoreTag) >>
+          previous_presence_loopback->In("LOOP");
+    }
 
     // TODO: Replace PassThroughCalculator with a calculator that
     // converts the pixel data to be stored on the target storage (CPU vs GPU).
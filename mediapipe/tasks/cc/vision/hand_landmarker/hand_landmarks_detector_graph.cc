@@ -105,6 +105,12 @@ absl::Status SanityCheckOptions(
                                    "value must be in the range [0.0, 1.0]",
                                    MediaPipeTasksStatus::kInvalidArgumentError);
   }
+  if (options.num_parallel_hands() < 1) {
+    return CreateStatusWithPayload(absl::StatusCode::kInvalidArgument,
+                                   "Invalid `num_parallel_hands` option: "
+                                   "value must be at least 1",
+                                   MediaPipeTasksStatus::kInvalidArgumentError);
+  }
   return absl::OkStatus();
 }
 
@@ -295,7 +301,8 @@ class SingleHandLandmarksDetectorGraph : public core::ModelTaskGraph {
                      BuildImageTensorSpecs(model_resources));
 
     auto& inference = AddInference(
-        model_resources, subgraph_options.base_options().acceleration(), graph);
+        model_resources, subgraph_options.base_options().acceleration(), graph,
+        subgraph_options.num_parallel_hands());
     preprocessing.Out("TENSORS") >> inference.In("TENSORS");
 
     // Split model output tensors to multiple streams.
@@ -431,6 +438,9 @@ REGISTER_MEDIAPIPE_GRAPH(
 //   multiple hands landmarks enclosed by the RoIs. Output vectors of
 //   hand landmarks related results, where each element in the vectors
 //   corrresponds to the result of the same hand.
+// - The hands are sent through a single SingleHandLandmarksDetectorGraph one
+//   after another. With `num_parallel_hands` > 1, the inference of up to that
+//   many hands overlaps, and the results are gathered in the input order.
 //
 // Inputs:
 //   IMAGE - Image
@@ -160,7 +160,7 @@ absl::StatusOr<std::unique_ptr<ImageClassifier>> ImageClassifier::Create(
           std::move(options_proto),
           options->running_mode == core::RunningMode::LIVE_STREAM),
       std::move(options->base_options.op_resolver), options->running_mode,
-      std::move(packets_callback));
+      std::move(packets_callback), options->base_options.num_graph_instances);
 }
 
 absl::StatusOr<ClassificationResult> ImageClassifier::Classify(
@@ -181,6 +181,35 @@ absl::StatusOr<ClassificationResult> ImageClassifier::Classify(
       .Get<ClassificationResult>();
 }
 
+absl::StatusOr<std::vector<ClassificationResult>>
+ImageClassifier::ClassifyBatch(
+    std::vector<Image> images,
+    std::optional<NormalizedRect> image_processing_options) {
+  NormalizedRect norm_rect = FillNormalizedRect(image_processing_options);
+  std::vector<PacketMap> inputs;
+  inputs.reserve(images.size());
+  for (auto& image : images) {
+    if (image.UsesGpu()) {
+      return CreateStatusWithPayload(
+          absl::StatusCode::kInvalidArgument,
+          "GPU input images are currently not supported.",
+          MediaPipeTasksStatus::kRunnerUnexpectedInputError);
+    }
+    inputs.push_back(
+        {{kImageInStreamName, MakePacket<Image>(std::move(image))},
+         {kNormRectName, MakePacket<NormalizedRect>(norm_rect)}});
+  }
+  ASSIGN_OR_RETURN(auto output_packets,
+                   ProcessImageDataBatch(std::move(inputs)));
+  std::vector<ClassificationResult> results;
+  results.reserve(output_packets.size());
+  for (auto& packets : output_packets) {
+    results.push_back(
+        packets[kClassificationResultStreamName].Get<ClassificationResult>());
+  }
+  return results;
+}
+
 absl::StatusOr<ClassificationResult> ImageClassifier::ClassifyForVideo(
     Image image, int64 timestamp_ms,
     std::optional<NormalizedRect> image_processing_options) {
@@ -19,6 +19,7 @@ limitations under the License.
 #include <functional>
 #include <memory>
 #include <optional>
+#include <vector>
 
 #include "absl/status/statusor.h"
 #include "mediapipe/framework/formats/image.h"
@@ -129,6 +130,20 @@ class ImageClassifier : tasks::vision::core::BaseVisionTaskApi {
       std::optional<mediapipe::NormalizedRect> image_processing_options =
           std::nullopt);
 
+  // Performs image classification on a batch of independent images, with the
+  // same 'image_processing_options' applied to each of them. The images go
+  // through the task graph in a single run, which is much faster than calling
+  // Classify() on each image in turn. Returns one result per image, in order.
+  //
+  // Only use this method when the ImageClassifier is created with the image
+  // running mode.
+  absl::StatusOr<
+      std::vector<components::containers::proto::ClassificationResult>>
+  ClassifyBatch(
+      std::vector<mediapipe::Image> images,
+      std::optional<mediapipe::NormalizedRect> image_processing_options =
+          std::nullopt);
+
   // Performs image classification on the provided video frame.
   //
   // The optional 'image_processing_options' parameter can be used to specify:
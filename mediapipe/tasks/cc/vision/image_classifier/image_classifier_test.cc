@@ -336,6 +336,29 @@ TEST_F(ImageModeTest, SucceedsWithFloatModel) {
   ExpectApproximatelyEqual(results, GenerateBurgerResults(0));
 }
 
+TEST_F(ImageModeTest, SucceedsWithBatch) {
+  MP_ASSERT_OK_AND_ASSIGN(
+      Image image,
+      DecodeImageFromFile(JoinPath("./", kTestDataDirectory, "burger.jpg")));
+  auto options = std::make_unique<ImageClassifierOptions>();
+  options->base_options.model_asset_path =
+      JoinPath("./", kTestDataDirectory, kMobileNetFloatWithMetadata);
+  options->classifier_options.max_results = 3;
+  MP_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ImageClassifier> image_classifier,
+                          ImageClassifier::Create(std::move(options)));
+
+  constexpr int kBatchSize = 4;
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto results,
+      image_classifier->ClassifyBatch(std::vector<Image>(kBatchSize, image)));
+
+  ASSERT_EQ(results.size(), kBatchSize);
+  for (int i = 0; i < kBatchSize; ++i) {
+    // Each image is assigned a synthetic timestamp one second after the last.
+    ExpectApproximatelyEqual(results[i], GenerateBurgerResults(i * 1000));
+  }
+}
+
 TEST_F(ImageModeTest, SucceedsWithQuantizedModel) {
   MP_ASSERT_OK_AND_ASSIGN(
       Image image,
@@ -144,7 +144,7 @@ absl::StatusOr<std::unique_ptr<ImageEmbedder>> ImageEmbedder::Create(
           std::move(options_proto),
           options->running_mode == core::RunningMode::LIVE_STREAM),
       std::move(options->base_options.op_resolver), options->running_mode,
-      std::move(packets_callback));
+      std::move(packets_callback), options->base_options.num_graph_instances);
 }
 
 absl::StatusOr<EmbeddingResult> ImageEmbedder::Embed(
@@ -166,6 +166,34 @@ absl::StatusOr<EmbeddingResult> ImageEmbedder::Embed(
   return output_packets[kEmbeddingResultStreamName].Get<EmbeddingResult>();
 }
 
+absl::StatusOr<std::vector<EmbeddingResult>> ImageEmbedder::EmbedBatch(
+    std::vector<Image> images, std::optional<NormalizedRect> roi) {
+  NormalizedRect norm_rect =
+      roi.has_value() ? roi.value() : BuildFullImageNormRect();
+  std::vector<PacketMap> inputs;
+  inputs.reserve(images.size());
+  for (auto& image : images) {
+    if (image.UsesGpu()) {
+      return CreateStatusWithPayload(
+          absl::StatusCode::kInvalidArgument,
+          "GPU input images are currently not supported.",
+          MediaPipeTasksStatus::kRunnerUnexpectedInputError);
+    }
+    inputs.push_back({{kImageInStreamName, MakePacket<Image>(std::move(image))},
+                      {kNormRectStreamName,
+                       MakePacket<NormalizedRect>(norm_rect)}});
+  }
+  ASSIGN_OR_RETURN(auto output_packets,
+                   ProcessImageDataBatch(std::move(inputs)));
+  std::vector<EmbeddingResult> results;
+  results.reserve(output_packets.size());
+  for (auto& packets : output_packets) {
+    results.push_back(
+        packets[kEmbeddingResultStreamName].Get<EmbeddingResult>());
+  }
+  return results;
+}
+
 absl::StatusOr<EmbeddingResult> ImageEmbedder::EmbedForVideo(
     Image image, int64 timestamp_ms, std::optional<NormalizedRect> roi) {
   if (image.UsesGpu()) {
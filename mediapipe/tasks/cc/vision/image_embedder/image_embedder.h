@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "absl/status/statusor.h"
 #include "mediapipe/framework/formats/image.h"
@@ -100,6 +101,17 @@ class ImageEmbedder : core::BaseVisionTaskApi {
       mediapipe::Image image,
       std::optional<mediapipe::NormalizedRect> roi = std::nullopt);
 
+  // Performs embedding extraction on a batch of independent images, on the
+  // same `roi` in each of them if provided. The images go through the task
+  // graph in a single run, which is much faster than calling Embed() on each
+  // image in turn. Returns one result per image, in order.
+  //
+  // Only use this method when the ImageEmbedder is created with the image
+  // running mode.
+  absl::StatusOr<std::vector<components::containers::proto::EmbeddingResult>>
+  EmbedBatch(std::vector<mediapipe::Image> images,
+             std::optional<mediapipe::NormalizedRect> roi = std::nullopt);
+
   // Performs embedding extraction on the provided video frame. Extraction
   // is performed on the region of interested specified by the `roi` argument if
   // provided, or on the entire image otherwise.
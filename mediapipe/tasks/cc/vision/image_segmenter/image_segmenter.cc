@@ -15,8 +15,12 @@ limitations under the License.
 
 #include "mediapipe/tasks/cc/vision/image_segmenter/image_segmenter.h"
 
+#include <optional>
+
 #include "mediapipe/framework/api2/builder.h"
 #include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/tasks/cc/components/containers/proto/run_length_encoded_mask.pb.h"
 #include "mediapipe/tasks/cc/components/proto/segmenter_options.pb.h"
 #include "mediapipe/tasks/cc/core/utils.h"
 #include "mediapipe/tasks/cc/vision/core/running_mode.h"
@@ -32,12 +36,18 @@ constexpr char kGroupedSegmentationTag[] = "GROUPED_SEGMENTATION";
 constexpr char kImageInStreamName[] = "image_in";
 constexpr char kImageOutStreamName[] = "image_out";
 constexpr char kImageTag[] = "IMAGE";
+constexpr char kNormRectName[] = "norm_rect_in";
+constexpr char kNormRectTag[] = "NORM_RECT";
+constexpr char kRleCategoryMaskStreamName[] = "rle_category_mask_out";
+constexpr char kRleCategoryMaskTag[] = "RLE_CATEGORY_MASK";
 constexpr char kSubgraphTypeName[] =
     "mediapipe.tasks.vision.ImageSegmenterGraph";
 constexpr int kMicroSecondsPerMilliSecond = 1000;
 
 using ::mediapipe::CalculatorGraphConfig;
 using ::mediapipe::Image;
+using ::mediapipe::NormalizedRect;
+using ::mediapipe::tasks::components::containers::proto::RunLengthEncodedMask;
 using ::mediapipe::tasks::components::proto::SegmenterOptions;
 using ImageSegmenterOptionsProto =
     image_segmenter::proto::ImageSegmenterOptions;
@@ -47,19 +57,31 @@ using ImageSegmenterOptionsProto =
 CalculatorGraphConfig CreateGraphConfig(
     std::unique_ptr<ImageSegmenterOptionsProto> options,
     bool enable_flow_limiting) {
+  const bool run_length_encode_category_mask =
+      options->segmenter_options().run_length_encode_category_mask();
   api2::builder::Graph graph;
   auto& task_subgraph = graph.AddNode(kSubgraphTypeName);
   task_subgraph.GetOptions<ImageSegmenterOptionsProto>().Swap(options.get());
   graph.In(kImageTag).SetName(kImageInStreamName);
-  task_subgraph.Out(kGroupedSegmentationTag).SetName(kSegmentationStreamName) >>
-      graph.Out(kGroupedSegmentationTag);
+  graph.In(kNormRectTag).SetName(kNormRectName);
+  if (run_length_encode_category_mask) {
+    task_subgraph.Out(kRleCategoryMaskTag)
+            .SetName(kRleCategoryMaskStreamName) >>
+        graph.Out(kRleCategoryMaskTag);
+  } else {
+    task_subgraph.Out(kGroupedSegmentationTag)
+            .SetName(kSegmentationStreamName) >>
+        graph.Out(kGroupedSegmentationTag);
+  }
   task_subgraph.Out(kImageTag).SetName(kImageOutStreamName) >>
       graph.Out(kImageTag);
   if (enable_flow_limiting) {
-    return tasks::core::AddFlowLimiterCalculator(
-        graph, task_subgraph, {kImageTag}, kGroupedSegmentationTag);
+    return tasks::core::AddFlowLimiterCalculator(graph, task_subgraph,
+                                                 {kImageTag, kNormRectTag},
+                                                 kGroupedSegmentationTag);
   }
   graph.In(kImageTag) >> task_subgraph.In(kImageTag);
+  graph.In(kNormRectTag) >> task_subgraph.In(kNormRectTag);
   return graph.GetConfig();
 }
 
@@ -98,13 +120,65 @@ std::unique_ptr<ImageSegmenterOptionsProto> ConvertImageSegmenterOptionsToProto(
           SegmenterOptions::SOFTMAX);
       break;
   }
+  for (int index : options->category_indices) {
+    options_proto->mutable_segmenter_options()->add_category_indices(index);
+  }
+  options_proto->mutable_segmenter_options()->set_quantize_confidence_masks(
+      options->quantize_confidence_masks);
+  options_proto->mutable_segmenter_options()
+      ->set_run_length_encode_category_mask(
+          options->run_length_encode_category_mask);
   return options_proto;
 }
 
+// Returns a NormalizedRect covering the full image if input is not present.
+// Otherwise, makes sure the x_center, y_center, width and height are set in
+// case only a rotation was provided in the input.
+NormalizedRect FillNormalizedRect(
+    std::optional<NormalizedRect> normalized_rect) {
+  NormalizedRect result;
+  if (normalized_rect.has_value()) {
+    result = *normalized_rect;
+  }
+  bool has_coordinates = result.has_x_center() || result.has_y_center() ||
+                         result.has_width() || result.has_height();
+  if (!has_coordinates) {
+    result.set_x_center(0.5);
+    result.set_y_center(0.5);
+    result.set_width(1);
+    result.set_height(1);
+  }
+  return result;
+}
+
+// Returns an error if the segmenter outputs a different kind of category mask
+// than the one requested by the caller.
+absl::Status CheckRunLengthEncoding(bool run_length_encode_category_mask,
+                                    bool requested) {
+  if (run_length_encode_category_mask == requested) {
+    return absl::OkStatus();
+  }
+  return CreateStatusWithPayload(
+      absl::StatusCode::kFailedPrecondition,
+      requested ? "Run-length encoded masks require the ImageSegmenter to be "
+                  "created with `run_length_encode_category_mask` set."
+                : "Image masks are not available when the ImageSegmenter is "
+                  "created with `run_length_encode_category_mask` set.",
+      MediaPipeTasksStatus::kRunnerApiCalledInWrongModeError);
+}
+
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<ImageSegmenter>> ImageSegmenter::Create(
     std::unique_ptr<ImageSegmenterOptions> options) {
+  if (options->run_length_encode_category_mask &&
+      options->running_mode == core::RunningMode::LIVE_STREAM) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        "`run_length_encode_category_mask` is not supported in the live "
+        "stream mode.",
+        MediaPipeTasksStatus::kInvalidArgumentError);
+  }
   auto options_proto = ConvertImageSegmenterOptionsToProto(options.get());
   tasks::core::PacketsCallback packets_callback = nullptr;
   if (options->result_callback) {
@@ -129,57 +203,127 @@ absl::StatusOr<std::unique_ptr<ImageSegmenter>> ImageSegmenter::Create(
                               kMicroSecondsPerMilliSecond);
         };
   }
-  return core::VisionTaskApiFactory::Create<ImageSegmenter,
-                                            ImageSegmenterOptionsProto>(
-      CreateGraphConfig(
-          std::move(options_proto),
-          options->running_mode == core::RunningMode::LIVE_STREAM),
-      std::move(options->base_options.op_resolver), options->running_mode,
-      std::move(packets_callback));
+  ASSIGN_OR_RETURN(
+      auto segmenter,
+      (core::VisionTaskApiFactory::Create<ImageSegmenter,
+                                          ImageSegmenterOptionsProto>(
+          CreateGraphConfig(
+              std::move(options_proto),
+              options->running_mode == core::RunningMode::LIVE_STREAM),
+          std::move(options->base_options.op_resolver), options->running_mode,
+          std::move(packets_callback),
+          options->base_options.num_graph_instances)));
+  segmenter->run_length_encode_category_mask_ =
+      options->run_length_encode_category_mask;
+  return segmenter;
 }
 
 absl::StatusOr<std::vector<Image>> ImageSegmenter::Segment(
-    mediapipe::Image image) {
+    mediapipe::Image image,
+    std::optional<NormalizedRect> image_processing_options) {
+  MP_RETURN_IF_ERROR(CheckRunLengthEncoding(run_length_encode_category_mask_,
+                                            /*requested=*/false));
   if (image.UsesGpu()) {
     return CreateStatusWithPayload(
         absl::StatusCode::kInvalidArgument,
         absl::StrCat("GPU input images are currently not supported."),
         MediaPipeTasksStatus::kRunnerUnexpectedInputError);
   }
+  NormalizedRect norm_rect = FillNormalizedRect(image_processing_options);
   ASSIGN_OR_RETURN(
       auto output_packets,
-      ProcessImageData({{kImageInStreamName,
-                         mediapipe::MakePacket<Image>(std::move(image))}}));
+      ProcessImageData(
+          {{kImageInStreamName, mediapipe::MakePacket<Image>(std::move(image))},
+           {kNormRectName, MakePacket<NormalizedRect>(std::move(norm_rect))}}));
   return output_packets[kSegmentationStreamName].Get<std::vector<Image>>();
 }
 
+absl::StatusOr<RunLengthEncodedMask>
+ImageSegmenter::SegmentToRunLengthEncodedMask(
+    mediapipe::Image image,
+    std::optional<NormalizedRect> image_processing_options) {
+  MP_RETURN_IF_ERROR(CheckRunLengthEncoding(run_length_encode_category_mask_,
+                                            /*requested=*/true));
+  if (image.UsesGpu()) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        absl::StrCat("GPU input images are currently not supported."),
+        MediaPipeTasksStatus::kRunnerUnexpectedInputError);
+  }
+  NormalizedRect norm_rect = FillNormalizedRect(image_processing_options);
+  ASSIGN_OR_RETURN(
+      auto output_packets,
+      ProcessImageData(
+          {{kImageInStreamName, mediapipe::MakePacket<Image>(std::move(image))},
+           {kNormRectName, MakePacket<NormalizedRect>(std::move(norm_rect))}}));
+  return output_packets[kRleCategoryMaskStreamName].Get<RunLengthEncodedMask>();
+}
+
 absl::StatusOr<std::vector<Image>> ImageSegmenter::SegmentForVideo(
-    mediapipe::Image image, int64 timestamp_ms) {
+    mediapipe::Image image, int64 timestamp_ms,
+    std::optional<NormalizedRect> image_processing_options) {
+  MP_RETURN_IF_ERROR(CheckRunLengthEncoding(run_length_encode_category_mask_,
+                                            /*requested=*/false));
   if (image.UsesGpu()) {
     return CreateStatusWithPayload(
         absl::StatusCode::kInvalidArgument,
         absl::StrCat("GPU input images are currently not supported."),
         MediaPipeTasksStatus::kRunnerUnexpectedInputError);
   }
+  NormalizedRect norm_rect = FillNormalizedRect(image_processing_options);
   ASSIGN_OR_RETURN(
       auto output_packets,
       ProcessVideoData(
           {{kImageInStreamName,
             MakePacket<Image>(std::move(image))
+                .At(Timestamp(timestamp_ms * kMicroSecondsPerMilliSecond))},
+           {kNormRectName,
+            MakePacket<NormalizedRect>(std::move(norm_rect))
                 .At(Timestamp(timestamp_ms * kMicroSecondsPerMilliSecond))}}));
   return output_packets[kSegmentationStreamName].Get<std::vector<Image>>();
 }
 
-absl::Status ImageSegmenter::SegmentAsync(Image image, int64 timestamp_ms) {
+absl::StatusOr<RunLengthEncodedMask>
+ImageSegmenter::SegmentForVideoToRunLengthEncodedMask(
+    mediapipe::Image image, int64 timestamp_ms,
+    std::optional<NormalizedRect> image_processing_options) {
+  MP_RETURN_IF_ERROR(CheckRunLengthEncoding(run_length_encode_category_mask_,
+                                            /*requested=*/true));
+  if (image.UsesGpu()) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        absl::StrCat("GPU input images are currently not supported."),
+        MediaPipeTasksStatus::kRunnerUnexpectedInputError);
+  }
+  NormalizedRect norm_rect = FillNormalizedRect(image_processing_options);
+  ASSIGN_OR_RETURN(
+      auto output_packets,
+      ProcessVideoData(
+          {{kImageInStreamName,
+            MakePacket<Image>(std::move(image))
+                .At(Timestamp(timestamp_ms * kMicroSecondsPerMilliSecond))},
+           {kNormRectName,
+            MakePacket<NormalizedRect>(std::move(norm_rect))
+                .At(Timestamp(timestamp_ms * kMicroSecondsPerMilliSecond))}}));
+  return output_packets[kRleCategoryMaskStreamName].Get<RunLengthEncodedMask>();
+}
+
+absl::Status ImageSegmenter::SegmentAsync(
+    Image image, int64 timestamp_ms,
+    std::optional<NormalizedRect> image_processing_options) {
   if (image.UsesGpu()) {
     return CreateStatusWithPayload(
         absl::StatusCode::kInvalidArgument,
         absl::StrCat("GPU input images are currently not supported."),
         MediaPipeTasksStatus::kRunnerUnexpectedInputError);
   }
+  NormalizedRect norm_rect = FillNormalizedRect(image_processing_options);
   return SendLiveStreamData(
       {{kImageInStreamName,
         MakePacket<Image>(std::move(image))
+            .At(Timestamp(timestamp_ms * kMicroSecondsPerMilliSecond))},
+       {kNormRectName,
+        MakePacket<NormalizedRect>(std::move(norm_rect))
             .At(Timestamp(timestamp_ms * kMicroSecondsPerMilliSecond))}});
 }
 
@@ -17,12 +17,15 @@ limitations under the License.
 #define MEDIAPIPE_TASKS_CC_VISION_IMAGE_SEGMENTER_IMAGE_SEGMENTER_H_
 
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/status/statusor.h"
 #include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/tasks/cc/components/containers/proto/run_length_encoded_mask.pb.h"
 #include "mediapipe/tasks/cc/core/base_options.h"
 #include "mediapipe/tasks/cc/vision/core/base_vision_task_api.h"
 #include "mediapipe/tasks/cc/vision/image_segmenter/proto/image_segmenter_options.pb.h"
@@ -72,6 +75,22 @@ struct ImageSegmenterOptions {
 
   Activation activation = Activation::NONE;
 
+  // The indices of the categories to output confidence masks for, in the given
+  // order. If empty, a confidence mask is output for every category. Only used
+  // if `output_type` is CONFIDENCE_MASK.
+  std::vector<int> category_indices;
+
+  // Whether to output confidence masks as uint8 images holding the confidence
+  // scaled to [0, 255], instead of float images. This divides the size of the
+  // masks by 4. Only used if `output_type` is CONFIDENCE_MASK.
+  bool quantize_confidence_masks = false;
+
+  // Whether to output the category mask run-length encoded, through
+  // SegmentToRunLengthEncodedMask() and SegmentForVideoToRunLengthEncodedMask()
+  // instead of Segment() and SegmentForVideo(). Requires `output_type` to be
+  // CATEGORY_MASK, and is not supported in the live stream mode.
+  bool run_length_encode_category_mask = false;
+
   // The user-defined result callback for processing live stream data.
   // The result callback should only be specified when the running mode is set
   // to RunningMode::LIVE_STREAM.
@@ -112,6 +131,19 @@ class ImageSegmenter : tasks::vision::core::BaseVisionTaskApi {
       std::unique_ptr<ImageSegmenterOptions> options);
 
   // Performs image segmentation on the provided single image.
+  //
+  // The optional 'image_processing_options' parameter can be used to specify:
+  // - the rotation to apply to the image before performing segmentation, by
+  //   setting its 'rotation' field in radians (e.g. 'M_PI / 2' for a 90°
+  //   anti-clockwise rotation).
+  // and/or
+  // - the region-of-interest on which to perform segmentation, by setting its
+  //  'x_center', 'y_center', 'width' and 'height' fields. If none of these is
+  //  set, they will automatically be set to cover the full image. The
+  //  segmented masks then only cover the region-of-interest.
+  // If both are specified, the crop around the region-of-interest is extracted
+  // first, then the specified rotation is applied to the crop.
+  //
   // Only use this method when the ImageSegmenter is created with the image
   // running mode.
   //
@@ -123,9 +155,27 @@ class ImageSegmenter : tasks::vision::core::BaseVisionTaskApi {
   // per-category segmented image mask.
   // If the output_type is CONFIDENCE_MASK, the returned vector of images
   // contains only one confidence image mask.
-  absl::StatusOr<std::vector<mediapipe::Image>> Segment(mediapipe::Image image);
+  absl::StatusOr<std::vector<mediapipe::Image>> Segment(
+      mediapipe::Image image,
+      std::optional<mediapipe::NormalizedRect> image_processing_options =
+          std::nullopt);
+
+  // Performs image segmentation on the provided single image, and returns the
+  // run-length encoded category mask. The 'image_processing_options' parameter
+  // behaves as in Segment().
+  //
+  // Only use this method when the ImageSegmenter is created with the image
+  // running mode and with `run_length_encode_category_mask` set.
+  absl::StatusOr<components::containers::proto::RunLengthEncodedMask>
+  SegmentToRunLengthEncodedMask(
+      mediapipe::Image image,
+      std::optional<mediapipe::NormalizedRect> image_processing_options =
+          std::nullopt);
 
   // Performs image segmentation on the provided video frame.
+  //
+  // The optional 'image_processing_options' parameter behaves as in Segment().
+  //
   // Only use this method when the ImageSegmenter is created with the video
   // running mode.
   //
@@ -138,13 +188,29 @@ class ImageSegmenter : tasks::vision::core::BaseVisionTaskApi {
   // If the output_type is CONFIDENCE_MASK, the returned vector of images
   // contains only one confidence image mask.
   absl::StatusOr<std::vector<mediapipe::Image>> SegmentForVideo(
-      mediapipe::Image image, int64 timestamp_ms);
+      mediapipe::Image image, int64 timestamp_ms,
+      std::optional<mediapipe::NormalizedRect> image_processing_options =
+          std::nullopt);
+
+  // Performs image segmentation on the provided video frame, and returns the
+  // run-length encoded category mask. The 'image_processing_options' parameter
+  // behaves as in Segment().
+  //
+  // Only use this method when the ImageSegmenter is created with the video
+  // running mode and with `run_length_encode_category_mask` set.
+  absl::StatusOr<components::containers::proto::RunLengthEncodedMask>
+  SegmentForVideoToRunLengthEncodedMask(
+      mediapipe::Image image, int64 timestamp_ms,
+      std::optional<mediapipe::NormalizedRect> image_processing_options =
+          std::nullopt);
 
   // Sends live image data to perform image segmentation, and the results will
   // be available via the "result_callback" provided in the
   // ImageSegmenterOptions. Only use this method when the ImageSegmenter is
   // created with the live stream running mode.
   //
+  // The optional 'image_processing_options' parameter behaves as in Segment().
+  //
   // The image can be of any size with format RGB or RGBA. It's required to
   // provide a timestamp (in milliseconds) to indicate when the input image is
   // sent to the image segmenter. The input timestamps must be monotonically
@@ -161,10 +227,17 @@ class ImageSegmenter : tasks::vision::core::BaseVisionTaskApi {
   //     no longer be valid when the callback returns. To access the image data
   //     outside of the callback, callers need to make a copy of the image.
   //   - The input timestamp in milliseconds.
-  absl::Status SegmentAsync(mediapipe::Image image, int64 timestamp_ms);
+  absl::Status SegmentAsync(mediapipe::Image image, int64 timestamp_ms,
+                            std::optional<mediapipe::NormalizedRect>
+                                image_processing_options = std::nullopt);
 
   // Shuts down the ImageSegmenter when all works are done.
   absl::Status Close() { return runner_->Close(); }
+
+ private:
+  // Whether the task graph outputs the run-length encoded category mask
+  // instead of the segmented masks.
+  bool run_length_encode_category_mask_ = false;
 };
 
 }  // namespace vision
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <memory>
+#include <optional>
 #include <type_traits>
 #include <vector>
 
@@ -23,9 +24,11 @@ limitations under the License.
 #include "mediapipe/framework/api2/builder.h"
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/tasks/cc/common.h"
 #include "mediapipe/tasks/cc/components/calculators/tensor/tensors_to_segmentation_calculator.pb.h"
+#include "mediapipe/tasks/cc/components/containers/proto/run_length_encoded_mask.pb.h"
 #include "mediapipe/tasks/cc/components/image_preprocessing.h"
 #include "mediapipe/tasks/cc/components/image_preprocessing_options.pb.h"
 #include "mediapipe/tasks/cc/components/proto/segmenter_options.pb.h"
@@ -52,6 +55,7 @@ using ::mediapipe::api2::Output;
 using ::mediapipe::api2::builder::Graph;
 using ::mediapipe::api2::builder::MultiSource;
 using ::mediapipe::api2::builder::Source;
+using ::mediapipe::tasks::components::containers::proto::RunLengthEncodedMask;
 using ::mediapipe::tasks::components::proto::SegmenterOptions;
 using ::mediapipe::tasks::metadata::ModelMetadataExtractor;
 using ::mediapipe::tasks::vision::image_segmenter::proto::ImageSegmenterOptions;
@@ -62,6 +66,8 @@ using LabelItems = mediapipe::proto_ns::Map<int64, ::mediapipe::LabelMapItem>;
 constexpr char kSegmentationTag[] = "SEGMENTATION";
 constexpr char kGroupedSegmentationTag[] = "GROUPED_SEGMENTATION";
 constexpr char kImageTag[] = "IMAGE";
+constexpr char kNormRectTag[] = "NORM_RECT";
+constexpr char kRleCategoryMaskTag[] = "RLE_CATEGORY_MASK";
 constexpr char kTensorsTag[] = "TENSORS";
 constexpr char kOutputSizeTag[] = "OUTPUT_SIZE";
 
@@ -69,6 +75,9 @@ constexpr char kOutputSizeTag[] = "OUTPUT_SIZE";
 // subgraph.
 struct ImageSegmenterOutputs {
   std::vector<Source<Image>> segmented_masks;
+  // The run-length encoded category mask, if requested instead of the
+  // segmented masks.
+  std::optional<Source<RunLengthEncodedMask>> rle_category_mask;
   // The same as the input image, mainly used for live stream mode.
   Source<Image> image;
 };
@@ -82,6 +91,15 @@ absl::Status SanityCheckOptions(const ImageSegmenterOptions& options) {
                                    "`output_type` must not be UNSPECIFIED",
                                    MediaPipeTasksStatus::kInvalidArgumentError);
   }
+  if (options.segmenter_options().run_length_encode_category_mask() &&
+      options.segmenter_options().output_type() !=
+          SegmenterOptions::CATEGORY_MASK) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        "`run_length_encode_category_mask` requires `output_type` to be "
+        "CATEGORY_MASK",
+        MediaPipeTasksStatus::kInvalidArgumentError);
+  }
   return absl::OkStatus();
 }
 
@@ -159,13 +177,22 @@ absl::StatusOr<const Tensor*> GetOutputTensor(
 // Inputs:
 //   IMAGE - Image
 //     Image to perform segmentation on.
+//   NORM_RECT - NormalizedRect @Optional
+//     Describes the region of interest to perform segmentation on. The
+//     segmented masks then only cover this region.
+//     @Optional: rect covering the whole image is used if not specified.
 //
 // Outputs:
 //   SEGMENTATION - mediapipe::Image @Multiple
 //     Segmented masks for individual category. Segmented mask of single
-//     category can be accessed by index based output stream.
+//     category can be accessed by index based output stream. If
+//     `category_indices` is set, only the masks of these categories are output,
+//     in the same order.
 //   GROUPED_SEGMENTATION - std::vector<mediapipe::Image>
 //     The output segmented masks grouped in a vector.
+//   RLE_CATEGORY_MASK - RunLengthEncodedMask @Optional
+//     The run-length encoded category mask. Output instead of SEGMENTATION and
+//     GROUPED_SEGMENTATION if `run_length_encode_category_mask` is set.
 //   IMAGE - mediapipe::Image
 //     The image that image segmenter runs on.
 //
@@ -199,18 +226,25 @@ class ImageSegmenterGraph : public core::ModelTaskGraph {
     ASSIGN_OR_RETURN(auto output_streams,
                      BuildSegmentationTask(
                          sc->Options<ImageSegmenterOptions>(), *model_resources,
-                         graph[Input<Image>(kImageTag)], graph));
+                         graph[Input<Image>(kImageTag)],
+                         graph[Input<NormalizedRect>::Optional(kNormRectTag)],
+                         graph));
 
-    auto& merge_images_to_vector =
-        graph.AddNode("MergeImagesToVectorCalculator");
-    for (int i = 0; i < output_streams.segmented_masks.size(); ++i) {
-      output_streams.segmented_masks[i] >>
-          merge_images_to_vector[Input<Image>::Multiple("")][i];
-      output_streams.segmented_masks[i] >>
-          graph[Output<Image>::Multiple(kSegmentationTag)][i];
+    if (output_streams.rle_category_mask.has_value()) {
+      *output_streams.rle_category_mask >>
+          graph[Output<RunLengthEncodedMask>(kRleCategoryMaskTag)];
+    } else {
+      auto& merge_images_to_vector =
+          graph.AddNode("MergeImagesToVectorCalculator");
+      for (int i = 0; i < output_streams.segmented_masks.size(); ++i) {
+        output_streams.segmented_masks[i] >>
+            merge_images_to_vector[Input<Image>::Multiple("")][i];
+        output_streams.segmented_masks[i] >>
+            graph[Output<Image>::Multiple(kSegmentationTag)][i];
+      }
+      merge_images_to_vector.Out("") >>
+          graph[Output<std::vector<Image>>(kGroupedSegmentationTag)];
     }
-    merge_images_to_vector.Out("") >>
-        graph[Output<std::vector<Image>>(kGroupedSegmentationTag)];
     output_streams.image >> graph[Output<Image>(kImageTag)];
     return graph.GetConfig();
   }
@@ -224,11 +258,12 @@ class ImageSegmenterGraph : public core::ModelTaskGraph {
   // model_resources: the ModelSources object initialized from a segmentation
   // model file with model metadata.
   // image_in: (mediapipe::Image) stream to run segmentation on.
+  // norm_rect_in: (NormalizedRect) region of interest to run segmentation on.
   // graph: the mediapipe builder::Graph instance to be updated.
   absl::StatusOr<ImageSegmenterOutputs> BuildSegmentationTask(
       const ImageSegmenterOptions& task_options,
       const core::ModelResources& model_resources, Source<Image> image_in,
-      Graph& graph) {
+      Source<NormalizedRect> norm_rect_in, Graph& graph) {
     MP_RETURN_IF_ERROR(SanityCheckOptions(task_options));
 
     // Adds preprocessing calculators and connects them to the graph input image
@@ -240,6 +275,7 @@ class ImageSegmenterGraph : public core::ModelTaskGraph {
         &preprocessing
              .GetOptions<tasks::components::ImagePreprocessingOptions>()));
     image_in >> preprocessing.In(kImageTag);
+    norm_rect_in >> preprocessing.In(kNormRectTag);
 
     // Adds inference subgraph and connects its input stream to the output
     // tensors produced by the ImageToTensorCalculator.
@@ -260,17 +296,39 @@ class ImageSegmenterGraph : public core::ModelTaskGraph {
     auto& image_properties = graph.AddNode("ImagePropertiesCalculator");
     image_in >> image_properties.In("IMAGE");
     image_properties.Out("SIZE") >> tensor_to_images.In(kOutputSizeTag);
+    // The masks only cover the region of interest.
+    norm_rect_in >> tensor_to_images.In(kNormRectTag);
 
     // Exports multiple segmented masks.
+    const SegmenterOptions& segmenter_options =
+        task_options.segmenter_options();
     std::vector<Source<Image>> segmented_masks;
-    if (task_options.segmenter_options().output_type() ==
-        SegmenterOptions::CATEGORY_MASK) {
-      segmented_masks.push_back(
-          Source<Image>(tensor_to_images[Output<Image>(kSegmentationTag)]));
+    std::optional<Source<RunLengthEncodedMask>> rle_category_mask;
+    if (segmenter_options.output_type() == SegmenterOptions::CATEGORY_MASK) {
+      if (segmenter_options.run_length_encode_category_mask()) {
+        rle_category_mask = tensor_to_images[Output<RunLengthEncodedMask>(
+            kRleCategoryMaskTag)];
+      } else {
+        segmented_masks.push_back(
+            Source<Image>(tensor_to_images[Output<Image>(kSegmentationTag)]));
+      }
     } else {
       ASSIGN_OR_RETURN(const Tensor* output_tensor,
                        GetOutputTensor(model_resources));
-      const int segmentation_streams_num = *output_tensor->shape()->rbegin();
+      const int num_categories = *output_tensor->shape()->rbegin();
+      for (int index : segmenter_options.category_indices()) {
+        if (index < 0 || index >= num_categories) {
+          return CreateStatusWithPayload(
+              absl::StatusCode::kInvalidArgument,
+              absl::StrFormat("Category index %d is out of range [0, %d).",
+                              index, num_categories),
+              MediaPipeTasksStatus::kInvalidArgumentError);
+        }
+      }
+      const int segmentation_streams_num =
+          segmenter_options.category_indices().empty()
+              ? num_categories
+              : segmenter_options.category_indices_size();
       for (int i = 0; i < segmentation_streams_num; ++i) {
         segmented_masks.push_back(Source<Image>(
             tensor_to_images[Output<Image>::Multiple(kSegmentationTag)][i]));
@@ -278,6 +336,7 @@ class ImageSegmenterGraph : public core::ModelTaskGraph {
     }
     return {{
         .segmented_masks = segmented_masks,
+        .rle_category_mask = rle_category_mask,
         .image = preprocessing[Output<Image>(kImageTag)],
     }};
   }
@@ -165,7 +165,7 @@ absl::StatusOr<std::unique_ptr<ObjectDetector>> ObjectDetector::Create(
           std::move(options_proto),
           options->running_mode == core::RunningMode::LIVE_STREAM),
       std::move(options->base_options.op_resolver), options->running_mode,
-      std::move(packets_callback));
+      std::move(packets_callback), options->base_options.num_graph_instances);
 }
 
 absl::StatusOr<std::vector<Detection>> ObjectDetector::Detect(
@@ -187,6 +187,36 @@ absl::StatusOr<std::vector<Detection>> ObjectDetector::Detect(
   return output_packets[kDetectionsOutStreamName].Get<std::vector<Detection>>();
 }
 
+absl::StatusOr<std::vector<std::vector<Detection>>>
+ObjectDetector::DetectBatch(
+    std::vector<mediapipe::Image> images,
+    std::optional<mediapipe::NormalizedRect> image_processing_options) {
+  ASSIGN_OR_RETURN(NormalizedRect norm_rect,
+                   FillNormalizedRect(image_processing_options));
+  std::vector<tasks::core::PacketMap> inputs;
+  inputs.reserve(images.size());
+  for (auto& image : images) {
+    if (image.UsesGpu()) {
+      return CreateStatusWithPayload(
+          absl::StatusCode::kInvalidArgument,
+          absl::StrCat("GPU input images are currently not supported."),
+          MediaPipeTasksStatus::kRunnerUnexpectedInputError);
+    }
+    inputs.push_back(
+        {{kImageInStreamName, MakePacket<Image>(std::move(image))},
+         {kNormRectName, MakePacket<NormalizedRect>(norm_rect)}});
+  }
+  ASSIGN_OR_RETURN(auto output_packets,
+                   ProcessImageDataBatch(std::move(inputs)));
+  std::vector<std::vector<Detection>> results;
+  results.reserve(output_packets.size());
+  for (auto& packets : output_packets) {
+    results.push_back(
+        packets[kDetectionsOutStreamName].Get<std::vector<Detection>>());
+  }
+  return results;
+}
+
 absl::StatusOr<std::vector<Detection>> ObjectDetector::DetectForVideo(
     mediapipe::Image image, int64 timestamp_ms,
     std::optional<mediapipe::NormalizedRect> image_processing_options) {
@@ -171,6 +171,18 @@ class ObjectDetector : tasks::vision::core::BaseVisionTaskApi {
       std::optional<mediapipe::NormalizedRect> image_processing_options =
           std::nullopt);
 
+  // Performs object detection on a batch of independent images, with the same
+  // 'image_processing_options' applied to each of them. The images go through
+  // the task graph in a single run, which is much faster than calling Detect()
+  // on each image in turn. Returns the detections of each image, in order.
+  //
+  // Only use this method when the ObjectDetector is created with the image
+  // running mode.
+  absl::StatusOr<std::vector<std::vector<mediapipe::Detection>>> DetectBatch(
+      std::vector<mediapipe::Image> images,
+      std::optional<mediapipe::NormalizedRect> image_processing_options =
+          std::nullopt);
+
   // Performs object detection on the provided video frame.
   // Only use this method when the ObjectDetector is created with the video
   // running mode.
@@ -0,0 +1,402 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/util/annotation_renderer_gl.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/gpu/gl_simple_shaders.h"
+#include "mediapipe/gpu/shader_util.h"
+
+namespace mediapipe {
+namespace {
+
+enum { ATTRIB_POSITION, ATTRIB_SHAPE, ATTRIB_COLOR, NUM_ATTRIBUTES };
+
+constexpr char kVertexShader[] = R"(
+  in vec2 position;
+  in vec3 shape;
+  in vec3 color;
+  out vec3 sample_shape;
+  out vec3 sample_color;
+  uniform vec2 size;
+  uniform float flip;
+
+  void main() {
+    vec2 ndc = position / size * 2.0 - 1.0;
+    ndc.y = mix(ndc.y, -ndc.y, flip);
+    gl_Position = vec4(ndc, 0.0, 1.0);
+    sample_shape = shape;
+    sample_color = color;
+  }
+)";
+
+constexpr char kFragmentShader[] = R"(
+  DEFAULT_PRECISION(highp, float)
+  in vec3 sample_shape;
+  in vec3 sample_color;
+
+#ifdef GL_ES
+  #define fragColor gl_FragColor
+#else
+  out vec4 fragColor;
+#endif  // defined(GL_ES);
+
+  void main() {
+    if (sample_shape.z >= 0.0) {
+      float r2 = dot(sample_shape.xy, sample_shape.xy);
+      if (r2 > 1.0 || r2 < sample_shape.z * sample_shape.z) discard;
+    }
+    fragColor = vec4(sample_color, 1.0);
+  }
+)";
+
+float ClampThickness(double thickness) {
+  constexpr float kMaxThickness = 32767;  // Same as AnnotationRenderer.
+  return std::clamp<float>(std::round(thickness), 1.0f, kMaxThickness);
+}
+
+}  // namespace
+
+bool AnnotationRendererGl::CanRender(const RenderData& render_data) {
+  for (const auto& annotation : render_data.render_annotations()) {
+    if (annotation.data_case() == RenderAnnotation::kText ||
+        annotation.data_case() == RenderAnnotation::DATA_NOT_SET) {
+      return false;
+    }
+  }
+  return true;
+}
+
+absl::Status AnnotationRendererGl::GlSetup() {
+  const GLint attr_location[NUM_ATTRIBUTES] = {ATTRIB_POSITION, ATTRIB_SHAPE,
+                                               ATTRIB_COLOR};
+  const GLchar* attr_name[NUM_ATTRIBUTES] = {"position", "shape", "color"};
+  const std::string vert_src =
+      absl::StrCat(kMediaPipeVertexShaderPreamble, kVertexShader);
+  const std::string frag_src =
+      absl::StrCat(kMediaPipeFragmentShaderPreamble, kFragmentShader);
+  GlhCreateProgram(vert_src.c_str(), frag_src.c_str(), NUM_ATTRIBUTES,
+                   &attr_name[0], attr_location, &program_);
+  RET_CHECK(program_) << "Problem initializing the annotation program.";
+  size_uniform_ = glGetUniformLocation(program_, "size");
+  flip_uniform_ = glGetUniformLocation(program_, "flip");
+
+  glGenVertexArrays(1, &vao_);
+  glGenBuffers(1, &vbo_);
+  glBindVertexArray(vao_);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+  glEnableVertexAttribArray(ATTRIB_POSITION);
+  glVertexAttribPointer(ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                        reinterpret_cast<void*>(offsetof(Vertex, x)));
+  glEnableVertexAttribArray(ATTRIB_SHAPE);
+  glVertexAttribPointer(ATTRIB_SHAPE, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                        reinterpret_cast<void*>(offsetof(Vertex, u)));
+  glEnableVertexAttribArray(ATTRIB_COLOR);
+  glVertexAttribPointer(ATTRIB_COLOR, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                        reinterpret_cast<void*>(offsetof(Vertex, r)));
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  vbo_capacity_ = 0;
+  return absl::OkStatus();
+}
+
+void AnnotationRendererGl::GlTeardown() {
+  if (program_) glDeleteProgram(program_);
+  program_ = 0;
+  if (vao_) glDeleteVertexArrays(1, &vao_);
+  vao_ = 0;
+  if (vbo_) glDeleteBuffers(1, &vbo_);
+  vbo_ = 0;
+  vbo_capacity_ = 0;
+}
+
+void AnnotationRendererGl::Reset(int width, int height) {
+  width_ = width;
+  height_ = height;
+  vertices_.clear();
+}
+
+void AnnotationRendererGl::AddRenderData(const RenderData& render_data) {
+  for (const auto& annotation : render_data.render_annotations()) {
+    AddAnnotation(annotation);
+  }
+}
+
+void AnnotationRendererGl::GlRender() {
+  if (vertices_.empty()) return;
+
+  glBindVertexArray(vao_);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+  // The buffer only grows, so steady-state frames just overwrite it.
+  if (vertices_.size() > vbo_capacity_) {
+    vbo_capacity_ = vertices_.size();
+    glBufferData(GL_ARRAY_BUFFER, vbo_capacity_ * sizeof(Vertex),
+                 vertices_.data(), GL_DYNAMIC_DRAW);
+  } else {
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vertices_.size() * sizeof(Vertex),
+                    vertices_.data());
+  }
+
+  glUseProgram(program_);
+  glUniform2f(size_uniform_, width_, height_);
+  glUniform1f(flip_uniform_, flip_vertically_ ? 1.0f : 0.0f);
+  glViewport(0, 0, width_, height_);
+  glDrawArrays(GL_TRIANGLES, 0, vertices_.size());
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+}
+
+AnnotationRendererGl::Point2 AnnotationRendererGl::ToPixels(
+    double x, double y, bool normalized) const {
+  if (normalized) {
+    return {static_cast<float>(std::round(x * width_)),
+            static_cast<float>(std::round(y * height_))};
+  }
+  return {static_cast<float>(x), static_cast<float>(y)};
+}
+
+void AnnotationRendererGl::AddQuad(Point2 center, Point2 axis_u, Point2 axis_v,
+                                   float u0, float v0, float u1, float v1,
+                                   float inner, const Color& color0,
+                                   const Color& color1) {
+  const auto make_vertex = [&](float u, float v) {
+    const float t = u1 != u0 ? (u - u0) / (u1 - u0) : 0.0f;
+    const auto lerp = [t](int c0, int c1) {
+      return (c0 + t * (c1 - c0)) / 255.0f;
+    };
+    return Vertex{center.x + axis_u.x * u + axis_v.x * v,
+                  center.y + axis_u.y * u + axis_v.y * v,
+                  u,
+                  v,
+                  inner,
+                  lerp(color0.r(), color1.r()),
+                  lerp(color0.g(), color1.g()),
+                  lerp(color0.b(), color1.b())};
+  };
+  const Vertex v00 = make_vertex(u0, v0);
+  const Vertex v10 = make_vertex(u1, v0);
+  const Vertex v11 = make_vertex(u1, v1);
+  const Vertex v01 = make_vertex(u0, v1);
+  vertices_.insert(vertices_.end(), {v00, v10, v11, v00, v11, v01});
+}
+
+void AnnotationRendererGl::AddLine(Point2 start, Point2 end, float thickness,
+                                   const Color& color0, const Color& color1) {
+  const float half = thickness / 2.0f;
+  const float dx = end.x - start.x;
+  const float dy = end.y - start.y;
+  const float length = std::sqrt(dx * dx + dy * dy);
+  if (length > 0.0f) {
+    AddQuad({(start.x + end.x) / 2.0f, (start.y + end.y) / 2.0f},
+            {dx / 2.0f, dy / 2.0f}, {-dy / length * half, dx / length * half},
+            -1.0f, -1.0f, 1.0f, 1.0f, /*inner=*/-1.0f, color0, color1);
+  }
+  if (thickness > 1.0f) {
+    // Round caps, as OpenCV draws them.
+    AddEllipse(start, {half, 0.0f}, {0.0f, half}, /*thickness=*/-1.0f, color0);
+    AddEllipse(end, {half, 0.0f}, {0.0f, half}, /*thickness=*/-1.0f, color1);
+  }
+}
+
+void AnnotationRendererGl::AddEllipse(Point2 center, Point2 axis_u,
+                                      Point2 axis_v, float thickness,
+                                      const Color& color) {
+  if (thickness < 0.0f) {
+    AddQuad(center, axis_u, axis_v, -1.0f, -1.0f, 1.0f, 1.0f, /*inner=*/0.0f,
+            color, color);
+    return;
+  }
+  // The ring is cut out with a single inner radius, so its width is exact for
+  // circles and approximate for elongated ellipses.
+  const float half = thickness / 2.0f;
+  const float a = std::sqrt(axis_u.x * axis_u.x + axis_u.y * axis_u.y);
+  const float b = std::sqrt(axis_v.x * axis_v.x + axis_v.y * axis_v.y);
+  if (a <= 0.0f || b <= 0.0f) return;
+  const float mean = (a + b) / 2.0f;
+  const float scale_u = (a + half) / a;
+  const float scale_v = (b + half) / b;
+  AddQuad(center, {axis_u.x * scale_u, axis_u.y * scale_u},
+          {axis_v.x * scale_v, axis_v.y * scale_v}, -1.0f, -1.0f, 1.0f, 1.0f,
+          std::max(0.0f, (mean - half) / (mean + half)), color, color);
+}
+
+void AnnotationRendererGl::AddRectangle(
+    const RenderAnnotation::Rectangle& rectangle, float thickness,
+    float corner_radius, const Color& color) {
+  const Point2 top_left =
+      ToPixels(rectangle.left(), rectangle.top(), rectangle.normalized());
+  const Point2 bottom_right =
+      ToPixels(rectangle.right(), rectangle.bottom(), rectangle.normalized());
+  const Point2 center = {(top_left.x + bottom_right.x) / 2.0f,
+                         (top_left.y + bottom_right.y) / 2.0f};
+  const float half_width = std::abs(bottom_right.x - top_left.x) / 2.0f;
+  const float half_height = std::abs(bottom_right.y - top_left.y) / 2.0f;
+  const float cos_r = std::cos(rectangle.rotation());
+  const float sin_r = std::sin(rectangle.rotation());
+  // Unit axes of the (rotated) rectangle.
+  const Point2 dir_u = {cos_r, sin_r};
+  const Point2 dir_v = {-sin_r, cos_r};
+  const auto at = [&](float u, float v) {
+    return Point2{center.x + dir_u.x * u + dir_v.x * v,
+                  center.y + dir_u.y * u + dir_v.y * v};
+  };
+  const auto scaled = [](Point2 dir, float s) {
+    return Point2{dir.x * s, dir.y * s};
+  };
+
+  const float radius =
+      std::min({std::max(corner_radius, 0.0f), half_width, half_height});
+  const float inner_width = half_width - radius;
+  const float inner_height = half_height - radius;
+  if (thickness < 0.0f) {
+    AddQuad(center, scaled(dir_u, half_width), scaled(dir_v, inner_height),
+            -1.0f, -1.0f, 1.0f, 1.0f, /*inner=*/-1.0f, color, color);
+    if (radius > 0.0f) {
+      AddQuad(center, scaled(dir_u, inner_width), scaled(dir_v, half_height),
+              -1.0f, -1.0f, 1.0f, 1.0f, /*inner=*/-1.0f, color, color);
+    }
+  } else {
+    AddLine(at(-inner_width, -half_height), at(inner_width, -half_height),
+            thickness, color, color);
+    AddLine(at(half_width, -inner_height), at(half_width, inner_height),
+            thickness, color, color);
+    AddLine(at(inner_width, half_height), at(-inner_width, half_height),
+            thickness, color, color);
+    AddLine(at(-half_width, inner_height), at(-half_width, -inner_height),
+            thickness, color, color);
+  }
+  if (radius > 0.0f) {
+    // Each corner is the matching quadrant of a circle (or ring).
+    const float half = thickness < 0.0f ? 0.0f : thickness / 2.0f;
+    const float outer = radius + half;
+    const float inner =
+        thickness < 0.0f ? 0.0f : std::max(0.0f, (radius - half) / outer);
+    for (const float su : {-1.0f, 1.0f}) {
+      for (const float sv : {-1.0f, 1.0f}) {
+        AddQuad(at(su * inner_width, sv * inner_height), scaled(dir_u, outer),
+                scaled(dir_v, outer), std::min(0.0f, su), std::min(0.0f, sv),
+                std::max(0.0f, su), std::max(0.0f, sv), inner, color, color);
+      }
+    }
+  }
+  if (rectangle.has_top_left_thickness()) {
+    const float r = ClampThickness(rectangle.top_left_thickness());
+    AddEllipse(at(-half_width, -half_height), {r, 0.0f}, {0.0f, r},
+               /*thickness=*/-1.0f, color);
+  }
+}
+
+void AnnotationRendererGl::AddAnnotation(const RenderAnnotation& annotation) {
+  const Color& color = annotation.color();
+  const float thickness = ClampThickness(annotation.thickness());
+  switch (annotation.data_case()) {
+    case RenderAnnotation::kRectangle:
+      AddRectangle(annotation.rectangle(), thickness, /*corner_radius=*/0.0f,
+                   color);
+      break;
+    case RenderAnnotation::kFilledRectangle:
+      AddRectangle(annotation.filled_rectangle().rectangle(),
+                   /*thickness=*/-1.0f, /*corner_radius=*/0.0f, color);
+      break;
+    case RenderAnnotation::kRoundedRectangle:
+      AddRectangle(annotation.rounded_rectangle().rectangle(), thickness,
+                   annotation.rounded_rectangle().corner_radius(), color);
+      break;
+    case RenderAnnotation::kFilledRoundedRectangle: {
+      const auto& rounded_rectangle =
+          annotation.filled_rounded_rectangle().rounded_rectangle();
+      AddRectangle(rounded_rectangle.rectangle(), /*thickness=*/-1.0f,
+                   rounded_rectangle.corner_radius(), color);
+      break;
+    }
+    case RenderAnnotation::kOval:
+    case RenderAnnotation::kFilledOval: {
+      const bool filled =
+          annotation.data_case() == RenderAnnotation::kFilledOval;
+      const auto& rectangle = filled
+                                  ? annotation.filled_oval().oval().rectangle()
+                                  : annotation.oval().rectangle();
+      const Point2 top_left =
+          ToPixels(rectangle.left(), rectangle.top(), rectangle.normalized());
+      const Point2 bottom_right = ToPixels(
+          rectangle.right(), rectangle.bottom(), rectangle.normalized());
+      const float a = std::abs(bottom_right.x - top_left.x) / 2.0f;
+      const float b = std::abs(bottom_right.y - top_left.y) / 2.0f;
+      const float cos_r = std::cos(rectangle.rotation());
+      const float sin_r = std::sin(rectangle.rotation());
+      AddEllipse({(top_left.x + bottom_right.x) / 2.0f,
+                  (top_left.y + bottom_right.y) / 2.0f},
+                 {cos_r * a, sin_r * a}, {-sin_r * b, cos_r * b},
+                 filled ? -1.0f : thickness, color);
+      break;
+    }
+    case RenderAnnotation::kPoint: {
+      const auto& point = annotation.point();
+      AddEllipse(ToPixels(point.x(), point.y(), point.normalized()),
+                 {thickness, 0.0f}, {0.0f, thickness}, /*thickness=*/-1.0f,
+                 color);
+      break;
+    }
+    case RenderAnnotation::kLine: {
+      const auto& line = annotation.line();
+      AddLine(ToPixels(line.x_start(), line.y_start(), line.normalized()),
+              ToPixels(line.x_end(), line.y_end(), line.normalized()),
+              thickness, color, color);
+      break;
+    }
+    case RenderAnnotation::kGradientLine: {
+      const auto& line = annotation.gradient_line();
+      AddLine(ToPixels(line.x_start(), line.y_start(), line.normalized()),
+              ToPixels(line.x_end(), line.y_end(), line.normalized()),
+              thickness, line.color1(), line.color2());
+      break;
+    }
+    case RenderAnnotation::kArrow: {
+      const auto& arrow = annotation.arrow();
+      const Point2 start =
+          ToPixels(arrow.x_start(), arrow.y_start(), arrow.normalized());
+      const Point2 end =
+          ToPixels(arrow.x_end(), arrow.y_end(), arrow.normalized());
+      AddLine(start, end, thickness, color, color);
+      // Arrow tips, sized as in AnnotationRenderer.
+      const float dx = end.x - start.x;
+      const float dy = end.y - start.y;
+      const float length = std::sqrt(dx * dx + dy * dy);
+      if (length > 0.0f) {
+        constexpr float kArrowTipLengthProportion = 0.2f;
+        const float tip = kArrowTipLengthProportion * length;
+        const Point2 u = {dx / length, dy / length};
+        const Point2 v = {-u.y, u.x};
+        AddLine({end.x - tip * u.x + tip * v.x, end.y - tip * u.y + tip * v.y},
+                end, thickness, color, color);
+        AddLine({end.x - tip * u.x - tip * v.x, end.y - tip * u.y - tip * v.y},
+                end, thickness, color, color);
+      }
+      break;
+    }
+    default:
+      // Not supported, see CanRender().
+      break;
+  }
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,126 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_ANNOTATION_RENDERER_GL_H_
+#define MEDIAPIPE_UTIL_ANNOTATION_RENDERER_GL_H_
+
+#include <vector>
+
+#include "absl/status/status.h"
+#include "mediapipe/gpu/gl_base.h"
+#include "mediapipe/util/color.pb.h"
+#include "mediapipe/util/render_data.pb.h"
+
+namespace mediapipe {
+
+// Renders RenderData straight into the bound OpenGL framebuffer.
+//
+// Unlike AnnotationRenderer, nothing is drawn on the CPU: annotations are
+// turned into triangles (ellipses and round caps are cut out in the fragment
+// shader) and the whole batch is drawn with a single draw call. Text is not
+// supported, see CanRender().
+//
+// Example usage (in a GL context):
+//
+// AnnotationRendererGl renderer;
+// MP_RETURN_IF_ERROR(renderer.GlSetup());
+// ...
+// renderer.Reset(width, height);
+// renderer.AddRenderData(render_data_0);
+// renderer.AddRenderData(render_data_1);
+// <BIND OUTPUT FRAMEBUFFER>
+// renderer.GlRender();
+// ...
+// renderer.GlTeardown();
+class AnnotationRendererGl {
+ public:
+  // Returns true if every annotation in @render_data can be rendered.
+  static bool CanRender(const RenderData& render_data);
+
+  // Compiles the shader and allocates the vertex buffer. Must be called in the
+  // GL context.
+  absl::Status GlSetup();
+
+  // Releases GL resources. Must be called in the GL context.
+  void GlTeardown();
+
+  // Starts a new batch for a target of @width x @height pixels. Normalized
+  // coordinates are relative to this size.
+  void Reset(int width, int height);
+
+  // Sets whether the target has its origin at the bottom-left corner, in which
+  // case annotations (given with a top-left origin) are flipped vertically.
+  void SetFlipVertically(bool flip) { flip_vertically_ = flip; }
+
+  // Adds all annotations of @render_data to the batch.
+  void AddRenderData(const RenderData& render_data);
+
+  // Draws the batch into the bound framebuffer with one draw call. Must be
+  // called in the GL context.
+  void GlRender();
+
+ private:
+  struct Point2 {
+    float x;
+    float y;
+  };
+  struct Vertex {
+    // Position in pixels, with the origin at the top-left corner.
+    float x, y;
+    // Position inside the shape: pixels with u^2 + v^2 > 1 or
+    // u^2 + v^2 < inner^2 are discarded, unless inner is negative.
+    float u, v, inner;
+    float r, g, b;
+  };
+
+  void AddAnnotation(const RenderAnnotation& annotation);
+
+  // Adds the quad @center + @axis_u * u + @axis_v * v for u in [u0, u1] and
+  // v in [v0, v1], with colors interpolated from @color0 at u0 to @color1 at
+  // u1.
+  void AddQuad(Point2 center, Point2 axis_u, Point2 axis_v, float u0, float v0,
+               float u1, float v1, float inner, const Color& color0,
+               const Color& color1);
+  // Adds a line of @thickness with round caps.
+  void AddLine(Point2 start, Point2 end, float thickness, const Color& color0,
+               const Color& color1);
+  // Adds an ellipse with half axes @axis_u and @axis_v, filled if @thickness is
+  // negative.
+  void AddEllipse(Point2 center, Point2 axis_u, Point2 axis_v, float thickness,
+                  const Color& color);
+  // Adds a rectangle, filled if @thickness is negative, with rounded corners
+  // if @corner_radius is positive.
+  void AddRectangle(const RenderAnnotation::Rectangle& rectangle,
+                    float thickness, float corner_radius, const Color& color);
+
+  // Converts a point to pixels.
+  Point2 ToPixels(double x, double y, bool normalized) const;
+
+  int width_ = 0;
+  int height_ = 0;
+  bool flip_vertically_ = false;
+  std::vector<Vertex> vertices_;
+
+  GLuint program_ = 0;
+  GLint size_uniform_ = -1;
+  GLint flip_uniform_ = -1;
+  GLuint vao_ = 0;
+  GLuint vbo_ = 0;
+  // Capacity of vbo_ in vertices.
+  size_t vbo_capacity_ = 0;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_ANNOTATION_RENDERER_GL_H_
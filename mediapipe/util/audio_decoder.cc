@@ -487,46 +487,151 @@ absl::Status AudioPacketProcessor::AddAudioDataToBuffer(
   const int64 num_samples = buf_size_bytes / bytes_per_sample_ / num_channels_;
   VLOG(3) << "Adding " << num_samples << " audio samples in " << num_channels_
           << " channels to output.";
-  auto current_frame = absl::make_unique<Matrix>(num_channels_, num_samples);
 
+  if (options_.output_regressing_timestamps() ||
+      last_timestamp_ == Timestamp::Unset() ||
+      output_timestamp > last_timestamp_) {
+    if (output_chunk_samples_ > 0) {
+      MP_RETURN_IF_ERROR(AddAudioDataToChunks(raw_audio, num_samples));
+    } else {
+      auto current_frame =
+          absl::make_unique<Matrix>(num_channels_, num_samples);
+      MP_RETURN_IF_ERROR(ConvertSamples(raw_audio, /*first_sample=*/0,
+                                        num_samples, current_frame.get(),
+                                        /*first_column=*/0));
+      buffer_.push_back(Adopt(current_frame.release()).At(output_timestamp));
+    }
+    last_timestamp_ = output_timestamp;
+    if (last_frame_time_regression_detected_) {
+      last_frame_time_regression_detected_ = false;
+      LOG(INFO) << "Processor " << this << " resumed audio packet processing.";
+    }
+  } else if (!last_frame_time_regression_detected_) {
+    last_frame_time_regression_detected_ = true;
+    LOG(ERROR) << "Processor " << this
+               << " is dropping an audio packet because the timestamps "
+                  "regressed.  Was "
+               << last_timestamp_ << " but got " << output_timestamp;
+  }
+  expected_sample_number_ += num_samples;
+
+  return absl::OkStatus();
+}
+
+absl::Status AudioPacketProcessor::AddAudioDataToChunks(
+    uint8* const* raw_audio, int64 num_samples) {
+  const int64 frame_sample_number = expected_sample_number_;
+  const int64 begin =
+      std::max<int64>(first_output_sample_number_ - frame_sample_number, 0);
+  const int64 end =
+      std::min(num_samples, end_output_sample_number_ - frame_sample_number);
+  if (chunk_ && chunk_sample_number_ + chunk_num_samples_ !=
+                    frame_sample_number + begin) {
+    // The timestamps were reset, so the samples are not contiguous with the
+    // current chunk.
+    FlushChunk();
+  }
+  for (int64 sample = begin; sample < end;) {
+    if (!chunk_) {
+      chunk_ = absl::make_unique<Matrix>(num_channels_, output_chunk_samples_);
+      chunk_num_samples_ = 0;
+      chunk_sample_number_ = frame_sample_number + sample;
+    }
+    const int64 num_copied = std::min<int64>(
+        end - sample, output_chunk_samples_ - chunk_num_samples_);
+    MP_RETURN_IF_ERROR(ConvertSamples(raw_audio, sample, num_copied,
+                                      chunk_.get(), chunk_num_samples_));
+    chunk_num_samples_ += num_copied;
+    sample += num_copied;
+    if (chunk_num_samples_ == output_chunk_samples_) {
+      FlushChunk();
+    }
+  }
+  if (frame_sample_number + num_samples >= end_output_sample_number_) {
+    FlushChunk();
+    reached_end_time_ = true;
+  }
+  return absl::OkStatus();
+}
+
+void AudioPacketProcessor::FlushChunk() {
+  if (!chunk_) {
+    return;
+  }
+  if (chunk_num_samples_ > 0) {
+    if (chunk_num_samples_ < chunk_->cols()) {
+      chunk_->conservativeResize(Eigen::NoChange, chunk_num_samples_);
+    }
+    buffer_.push_back(Adopt(chunk_.release())
+                          .At(Timestamp(av_rescale_q(chunk_sample_number_,
+                                                     sample_time_base_,
+                                                     output_time_base_))));
+  }
+  chunk_.reset();
+  chunk_num_samples_ = 0;
+}
+
+void AudioPacketProcessor::SetOutputChunking(int chunk_samples,
+                                             Timestamp start_time,
+                                             Timestamp end_time) {
+  output_chunk_samples_ = chunk_samples;
+  if (start_time != Timestamp::Unset()) {
+    first_output_sample_number_ = av_rescale_rnd(
+        start_time.Value(), sample_rate_, 1000000, AV_ROUND_UP);
+  }
+  if (end_time != Timestamp::Unset()) {
+    end_output_sample_number_ =
+        av_rescale_rnd(end_time.Value(), sample_rate_, 1000000,
+                       AV_ROUND_DOWN) +
+        1;
+  }
+}
+
+absl::Status AudioPacketProcessor::ConvertSamples(uint8* const* raw_audio,
+                                                  int64 first_sample,
+                                                  int64 num_samples,
+                                                  Matrix* output,
+                                                  int64 first_column) {
+  // Samples are decoded straight into the output matrix, whose columns hold
+  // the channels of one sample each, like interleaved formats.
   const char* sample_ptr = nullptr;
   switch (avcodec_ctx_->sample_fmt) {
     case AV_SAMPLE_FMT_S16:
-      sample_ptr = reinterpret_cast<const char*>(raw_audio[0]);
+      sample_ptr = reinterpret_cast<const char*>(raw_audio[0]) +
+                   first_sample * num_channels_ * bytes_per_sample_;
       for (int64 sample_index = 0; sample_index < num_samples; ++sample_index) {
         for (int channel = 0; channel < num_channels_; ++channel) {
-          (*current_frame)(channel, sample_index) =
+          (*output)(channel, first_column + sample_index) =
               PcmEncodedSampleToFloat(sample_ptr);
           sample_ptr += bytes_per_sample_;
         }
       }
       break;
     case AV_SAMPLE_FMT_S32:
-      sample_ptr = reinterpret_cast<const char*>(raw_audio[0]);
+      sample_ptr = reinterpret_cast<const char*>(raw_audio[0]) +
+                   first_sample * num_channels_ * bytes_per_sample_;
       for (int64 sample_index = 0; sample_index < num_samples; ++sample_index) {
         for (int channel = 0; channel < num_channels_; ++channel) {
-          (*current_frame)(channel, sample_index) =
+          (*output)(channel, first_column + sample_index) =
               PcmEncodedSampleInt32ToFloat(sample_ptr);
           sample_ptr += bytes_per_sample_;
         }
       }
       break;
     case AV_SAMPLE_FMT_FLT:
-      sample_ptr = reinterpret_cast<const char*>(raw_audio[0]);
-      for (int64 sample_index = 0; sample_index < num_samples; ++sample_index) {
-        for (int channel = 0; channel < num_channels_; ++channel) {
-          (*current_frame)(channel, sample_index) =
-              Uint32ToFloat(absl::little_endian::Load32(sample_ptr));
-          sample_ptr += bytes_per_sample_;
-        }
-      }
+      // Little-endian floats in the same layout as the output, see the
+      // constructor.
+      memcpy(output->col(first_column).data(),
+             raw_audio[0] + first_sample * num_channels_ * bytes_per_sample_,
+             num_samples * num_channels_ * bytes_per_sample_);
       break;
     case AV_SAMPLE_FMT_S16P:
       for (int channel = 0; channel < num_channels_; ++channel) {
-        sample_ptr = reinterpret_cast<const char*>(raw_audio[channel]);
+        sample_ptr = reinterpret_cast<const char*>(raw_audio[channel]) +
+                     first_sample * bytes_per_sample_;
         for (int64 sample_index = 0; sample_index < num_samples;
              ++sample_index) {
-          (*current_frame)(channel, sample_index) =
+          (*output)(channel, first_column + sample_index) =
               PcmEncodedSampleToFloat(sample_ptr);
           sample_ptr += bytes_per_sample_;
         }
@@ -534,38 +639,17 @@ absl::Status AudioPacketProcessor::AddAudioDataToBuffer(
       break;
     case AV_SAMPLE_FMT_FLTP:
       for (int channel = 0; channel < num_channels_; ++channel) {
-        sample_ptr = reinterpret_cast<const char*>(raw_audio[channel]);
-        for (int64 sample_index = 0; sample_index < num_samples;
-             ++sample_index) {
-          (*current_frame)(channel, sample_index) =
-              Uint32ToFloat(absl::little_endian::Load32(sample_ptr));
-          sample_ptr += bytes_per_sample_;
-        }
+        output->row(channel).segment(first_column, num_samples) =
+            Eigen::Map<const Eigen::RowVectorXf>(
+                reinterpret_cast<const float*>(raw_audio[channel]) +
+                    first_sample,
+                num_samples);
       }
       break;
     default:
       return mediapipe::UnimplementedErrorBuilder(MEDIAPIPE_LOC)
              << "sample_fmt = " << avcodec_ctx_->sample_fmt;
   }
-
-  if (options_.output_regressing_timestamps() ||
-      last_timestamp_ == Timestamp::Unset() ||
-      output_timestamp > last_timestamp_) {
-    buffer_.push_back(Adopt(current_frame.release()).At(output_timestamp));
-    last_timestamp_ = output_timestamp;
-    if (last_frame_time_regression_detected_) {
-      last_frame_time_regression_detected_ = false;
-      LOG(INFO) << "Processor " << this << " resumed audio packet processing.";
-    }
-  } else if (!last_frame_time_regression_detected_) {
-    last_frame_time_regression_detected_ = true;
-    LOG(ERROR) << "Processor " << this
-               << " is dropping an audio packet because the timestamps "
-                  "regressed.  Was "
-               << last_timestamp_ << " but got " << output_timestamp;
-  }
-  expected_sample_number_ += num_samples;
-
   return absl::OkStatus();
 }
 
@@ -599,6 +683,15 @@ absl::Status AudioDecoder::Initialize(
     return absl::InvalidArgumentError(
         "At least one audio_stream must be defined in AudioDecoderOptions");
   }
+  RET_CHECK_GE(options.output_chunk_samples(), 0);
+  if (options.has_start_time()) {
+    start_time_ = Timestamp::FromSeconds(options.start_time());
+  }
+  if (options.has_end_time()) {
+    end_time_ = Timestamp::FromSeconds(options.end_time());
+  }
+  output_chunks_ = options.output_chunk_samples() > 0;
+
   std::map<int, int> stream_index_to_audio_options_index;
   int options_index = 0;
   for (const auto& audio_stream : options.audio_stream()) {
@@ -649,6 +742,10 @@ absl::Status AudioDecoder::Initialize(
           }
 
           MP_RETURN_IF_ERROR(processor->Open(stream_id, stream));
+          if (output_chunks_) {
+            processor->SetOutputChunking(options.output_chunk_samples(),
+                                         start_time_, end_time_);
+          }
           audio_processor_.emplace(stream_id, std::move(processor));
           CHECK(InsertIfNotPresent(
               &stream_index_to_stream_id_,
@@ -674,11 +771,15 @@ absl::Status AudioDecoder::Initialize(
                         " in file ", input_file);
   }
 
-  if (options.has_start_time()) {
-    start_time_ = Timestamp::FromSeconds(options.start_time());
-  }
-  if (options.has_end_time()) {
-    end_time_ = Timestamp::FromSeconds(options.end_time());
+  if (options.seek_to_start_time() && start_time_ != Timestamp::Unset()) {
+    // Timestamp units are microseconds, like AV_TIME_BASE.
+    const int error = av_seek_frame(avformat_ctx_, /*stream_index=*/-1,
+                                    start_time_.Value(), AVSEEK_FLAG_BACKWARD);
+    if (error < 0) {
+      LOG(WARNING) << "Failed to seek to " << start_time_ << ": "
+                   << AvErrorToString(error)
+                   << ". Decoding from the beginning of the file instead.";
+    }
   }
   is_first_packet_.resize(avformat_ctx_->nb_streams, true);
 
@@ -695,6 +796,10 @@ absl::Status AudioDecoder::GetData(int* options_index, Packet* data) {
         *options_index =
             FindOrDie(stream_id_to_audio_options_index_, item.first);
         absl::Status status = item.second->GetData(data);
+        if (output_chunks_) {
+          // The processor already trimmed its output to the timestamp range.
+          return status;
+        }
         // Ignore packets which are out of the requested timestamp range.
         if (start_time_ != Timestamp::Unset()) {
           if (is_first_packet && data->Timestamp() > start_time_) {
@@ -725,8 +830,15 @@ absl::Status AudioDecoder::GetData(int* options_index, Packet* data) {
         }
         return status;
       }
+      if (item.second && item.second->ReachedEndTime()) {
+        item.second->Close();
+        item.second.reset(nullptr);
+      }
     }
-    if (flushed_) {
+    if (flushed_ ||
+        std::none_of(audio_processor_.begin(), audio_processor_.end(),
+                     [](const auto& item) { return item.second != nullptr; })) {
+      // The file ended, or all the streams are done before its end.
       MP_RETURN_IF_ERROR(Close());
       return tool::StatusStop();
     }
@@ -821,6 +933,7 @@ absl::Status AudioDecoder::Flush() {
   for (auto& item : audio_processor_) {
     if (item.second) {
       statuses.push_back(item.second->Flush());
+      item.second->FlushChunk();
     }
   }
   flushed_ = true;
@@ -17,11 +17,14 @@
 
 #include <cstdint>  // required by avutil.h
 #include <deque>
+#include <limits>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/time/time.h"
+#include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/formats/time_series_header.pb.h"
 #include "mediapipe/framework/packet.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -138,12 +141,37 @@ class AudioPacketProcessor : public BasePacketProcessor {
 
   absl::Status FillHeader(TimeSeriesHeader* header) const;
 
+  // Outputs the audio in packets of chunk_samples samples, trimmed to the
+  // samples from start_time to end_time (inclusive), which are ignored if
+  // unset. Must be called after Open() and before any ProcessPacket().
+  void SetOutputChunking(int chunk_samples, Timestamp start_time,
+                         Timestamp end_time);
+
+  // Outputs the samples of the last, partially filled, chunk.
+  void FlushChunk();
+
+  // Returns true once the chunked output has reached its end time, after
+  // which the processor does not need more data.
+  bool ReachedEndTime() const { return reached_end_time_; }
+
  private:
   // Appends audio in buffer(s) to the output buffer (buffer_).
   absl::Status AddAudioDataToBuffer(const Timestamp output_timestamp,
                                     uint8* const* raw_audio,
                                     int buf_size_bytes);
 
+  // Appends the samples of a decoded frame of num_samples samples within the
+  // output time range to the current chunk, and outputs the full chunks.
+  absl::Status AddAudioDataToChunks(uint8* const* raw_audio,
+                                    int64 num_samples);
+
+  // Converts num_samples samples from sample first_sample of the decoded
+  // frame into the columns from first_column of output, which must have
+  // num_channels_ rows.
+  absl::Status ConvertSamples(uint8* const* raw_audio, int64 first_sample,
+                              int64 num_samples, Matrix* output,
+                              int64 first_column);
+
   // Converts a number of samples into an approximate stream timestamp value.
   int64 SampleNumberToTimestamp(const int64 sample_number);
   int64 TimestampToSampleNumber(const int64 timestamp);
@@ -184,6 +212,18 @@ class AudioPacketProcessor : public BasePacketProcessor {
 
   // Options for the processor.
   AudioStreamOptions options_;
+
+  // The size of the output chunks, or 0 to output every decoded frame.
+  int output_chunk_samples_ = 0;
+  // The range of sample numbers to output in chunks, end exclusive.
+  int64 first_output_sample_number_ = 0;
+  int64 end_output_sample_number_ = std::numeric_limits<int64>::max();
+  // The chunk being filled, its number of samples, and the sample number of
+  // its first sample.
+  std::unique_ptr<Matrix> chunk_;
+  int chunk_num_samples_ = 0;
+  int64 chunk_sample_number_ = 0;
+  bool reached_end_time_ = false;
 };
 
 // Decode the audio streams of a media file.  The AudioDecoder is responsible
@@ -219,6 +259,8 @@ class AudioDecoder {
 
   Timestamp start_time_ = Timestamp::Unset();
   Timestamp end_time_ = Timestamp::Unset();
+  // True if the processors trim their output to the start and end times.
+  bool output_chunks_ = false;
 
   AVFormatContext* avformat_ctx_ = nullptr;
 };
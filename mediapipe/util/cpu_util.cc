@@ -29,7 +29,9 @@
 #include "absl/flags/flag.h"
 #include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/substitute.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -39,6 +41,10 @@ ABSL_FLAG(std::string, system_cpu_max_freq_file,
           "/sys/devices/system/cpu/cpu$0/cpufreq/cpuinfo_max_freq",
           "The file pattern for CPU max frequencies, where $0 will be replaced "
           "with the CPU id.");
+ABSL_FLAG(std::string, system_numa_node_cpulist_file,
+          "/sys/devices/system/node/node$0/cpulist",
+          "The file pattern for the CPU lists of NUMA nodes, where $0 will be "
+          "replaced with the node id.");
 
 namespace mediapipe {
 namespace {
@@ -136,4 +142,47 @@ std::set<int> InferHigherCoreIds() {
   return InferLowerOrHigherCoreIds(/* lower= */ false);
 }
 
+absl::StatusOr<std::set<int>> GetNumaNodeCoreIds(int numa_node) {
+  if (numa_node < 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid NUMA node: ", numa_node));
+  }
+  const std::string path = absl::Substitute(
+      absl::GetFlag(FLAGS_system_numa_node_cpulist_file), numa_node);
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    return absl::NotFoundError(absl::StrCat("Couldn't read ", path));
+  }
+  std::string cpu_list;
+  std::getline(file, cpu_list);
+  auto cpus_or_status = ParseCpuList(cpu_list);
+  if (!cpus_or_status.ok()) {
+    return cpus_or_status.status();
+  }
+  if (cpus_or_status.value().empty()) {
+    return absl::NotFoundError(
+        absl::StrCat("NUMA node ", numa_node, " has no CPUs."));
+  }
+  return cpus_or_status;
+}
+
+absl::StatusOr<std::set<int>> ParseCpuList(absl::string_view cpu_list) {
+  std::set<int> cpus;
+  for (absl::string_view range :
+       absl::StrSplit(absl::StripAsciiWhitespace(cpu_list), ',',
+                      absl::SkipEmpty())) {
+    std::vector<absl::string_view> bounds = absl::StrSplit(range, '-');
+    int first, last;
+    if (bounds.size() > 2 || !absl::SimpleAtoi(bounds.front(), &first) ||
+        !absl::SimpleAtoi(bounds.back(), &last) || first < 0 || last < first) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid CPU list: ", cpu_list));
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.insert(cpu);
+    }
+  }
+  return cpus;
+}
+
 }  // namespace mediapipe.
@@ -17,6 +17,9 @@
 
 #include <set>
 
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
 namespace mediapipe {
 // Returns the number of CPU cores. Compatible with Android.
 int NumCPUCores();
@@ -24,6 +27,10 @@ int NumCPUCores();
 std::set<int> InferLowerCoreIds();
 // Returns a set of inferred CPU ids of higher cores.
 std::set<int> InferHigherCoreIds();
+// Returns the CPU ids of the given NUMA node, as listed by the kernel.
+absl::StatusOr<std::set<int>> GetNumaNodeCoreIds(int numa_node);
+// Parses a kernel CPU list such as "0-3,8,10-11".
+absl::StatusOr<std::set<int>> ParseCpuList(absl::string_view cpu_list);
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_UTIL_CPU_UTIL_H_
@@ -0,0 +1,132 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/filtering/one_euro_filter_bank.h"
+
+#include <cmath>
+
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr double kEpsilon = 0.000001;
+
+// Same as OneEuroFilter::GetAlpha.
+inline double GetAlpha(double frequency, double cutoff) {
+  double te = 1.0 / frequency;
+  double tau = 1.0 / (2 * M_PI * cutoff);
+  return 1.0 / (1.0 + tau / te);
+}
+
+// Same as LowPassFilter::SetAlpha, which keeps the previous alpha if the new
+// one is out of range.
+inline float ValidAlpha(float alpha, float previous_alpha) {
+  return (alpha < 0.0f || alpha > 1.0f) ? previous_alpha : alpha;
+}
+
+// Same as LowPassFilter::Apply once it is initialized.
+inline float LowPass(float alpha, float value, float filtered_value) {
+  return alpha * value + (1.0 - alpha) * filtered_value;
+}
+
+}  // namespace
+
+OneEuroFilterBank::OneEuroFilterBank(int size, double frequency,
+                                     double min_cutoff, double beta,
+                                     double derivate_cutoff)
+    : frequency_(frequency),
+      min_cutoff_(min_cutoff),
+      beta_(beta),
+      derivate_cutoff_(derivate_cutoff),
+      raw_values_(size),
+      filtered_values_(size),
+      filtered_derivates_(size) {
+  LOG_IF(ERROR, frequency <= kEpsilon) << "frequency should be > 0";
+  LOG_IF(ERROR, min_cutoff <= kEpsilon) << "min_cutoff should be > 0";
+  LOG_IF(ERROR, derivate_cutoff <= kEpsilon) << "derivate_cutoff should be > 0";
+  alphas_.assign(size, static_cast<float>(GetAlpha(frequency_, min_cutoff_)));
+  derivate_alpha_ = GetAlpha(frequency_, derivate_cutoff_);
+}
+
+void OneEuroFilterBank::Apply(absl::Duration timestamp, double value_scale,
+                              float* values) {
+  int64_t new_timestamp = absl::ToInt64Nanoseconds(timestamp);
+  if (last_time_ >= new_timestamp) {
+    // Results are unpredictable in this case, so nothing to do but
+    // return same values.
+    LOG(WARNING) << "New timestamp is equal or less than the last one.";
+    return;
+  }
+
+  // update the sampling frequency based on timestamps
+  if (last_time_ != 0 && new_timestamp != 0) {
+    static constexpr double kNanoSecondsToSecond = 1e-9;
+    frequency_ = 1.0 / ((new_timestamp - last_time_) * kNanoSecondsToSecond);
+  }
+  last_time_ = new_timestamp;
+
+  const double frequency = frequency_;
+  const double min_cutoff = min_cutoff_;
+  const double beta = beta_;
+  const float derivate_alpha = ValidAlpha(
+      static_cast<float>(GetAlpha(frequency, derivate_cutoff_)),
+      derivate_alpha_);
+  derivate_alpha_ = derivate_alpha;
+  const int n = size();
+  float* raw_values = raw_values_.data();
+  float* filtered_values = filtered_values_.data();
+  float* alphas = alphas_.data();
+  float* filtered_derivates = filtered_derivates_.data();
+
+  if (!initialized_) {
+    // The first values and a zero variation pass through the filters as is.
+    const float alpha = static_cast<float>(GetAlpha(frequency, min_cutoff));
+    for (int i = 0; i < n; ++i) {
+      filtered_derivates[i] = 0.0f;
+      alphas[i] = ValidAlpha(alpha, alphas[i]);
+      raw_values[i] = values[i];
+      filtered_values[i] = values[i];
+    }
+    initialized_ = true;
+    return;
+  }
+
+  int num_invalid_alphas = 0;
+  for (int i = 0; i < n; ++i) {
+    const float value = values[i];
+    // estimate the current variation per second
+    const double dvalue =
+        (static_cast<double>(value) - raw_values[i]) * value_scale * frequency;
+    const float edvalue = LowPass(derivate_alpha, static_cast<float>(dvalue),
+                                  filtered_derivates[i]);
+    filtered_derivates[i] = edvalue;
+    // use it to update the cutoff frequency
+    const double cutoff = min_cutoff + beta * std::fabs(edvalue);
+    const float alpha = static_cast<float>(GetAlpha(frequency, cutoff));
+    num_invalid_alphas += (alpha < 0.0f || alpha > 1.0f);
+    alphas[i] = ValidAlpha(alpha, alphas[i]);
+
+    // filter the given value
+    const float filtered_value = LowPass(alphas[i], value, filtered_values[i]);
+    raw_values[i] = value;
+    filtered_values[i] = filtered_value;
+    values[i] = filtered_value;
+  }
+  LOG_IF(ERROR, num_invalid_alphas > 0)
+      << num_invalid_alphas << " alphas should be in [0.0, 1.0] range";
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,60 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_FILTERING_ONE_EURO_FILTER_BANK_H_
+#define MEDIAPIPE_UTIL_FILTERING_ONE_EURO_FILTER_BANK_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/time/time.h"
+
+namespace mediapipe {
+
+// Filters a fixed number of values sampled at the same timestamps, as a
+// OneEuroFilter with the same parameters per value would, but keeps the states
+// of all the filters in contiguous arrays and updates them in loops that the
+// compiler can vectorize. The results are identical to those of separate
+// OneEuroFilters.
+class OneEuroFilterBank {
+ public:
+  OneEuroFilterBank(int size, double frequency, double min_cutoff, double beta,
+                    double derivate_cutoff);
+
+  int size() const { return static_cast<int>(raw_values_.size()); }
+
+  // Filters the size() |values| in place.
+  void Apply(absl::Duration timestamp, double value_scale, float* values);
+
+ private:
+  double frequency_;
+  double min_cutoff_;
+  double beta_;
+  double derivate_cutoff_;
+  int64_t last_time_ = 0;
+  // Whether the filters have seen a value yet.
+  bool initialized_ = false;
+
+  // LowPassFilter states of the values.
+  std::vector<float> raw_values_;
+  std::vector<float> filtered_values_;
+  std::vector<float> alphas_;
+  // LowPassFilter states of the value derivatives, which share their alpha.
+  std::vector<float> filtered_derivates_;
+  float derivate_alpha_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_FILTERING_ONE_EURO_FILTER_BANK_H_
@@ -0,0 +1,75 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/filtering/one_euro_filter_bank.h"
+
+#include <random>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/filtering/one_euro_filter.h"
+
+namespace mediapipe {
+namespace {
+
+void ExpectSameAsOneEuroFilters(double frequency, double min_cutoff,
+                                double beta, double derivate_cutoff) {
+  constexpr int kSize = 67;
+  OneEuroFilterBank bank(kSize, frequency, min_cutoff, beta, derivate_cutoff);
+  ASSERT_EQ(bank.size(), kSize);
+  std::vector<OneEuroFilter> filters;
+  for (int i = 0; i < kSize; ++i) {
+    filters.emplace_back(frequency, min_cutoff, beta, derivate_cutoff);
+  }
+
+  std::mt19937 rng(frequency * 1000 + beta);
+  std::uniform_real_distribution<float> value_distribution(-100.0f, 100.0f);
+  std::uniform_int_distribution<int> step_distribution(1, 100);
+  std::vector<float> values(kSize);
+  int64_t timestamp_ms = 0;
+  for (int frame = 0; frame < 50; ++frame) {
+    // Timestamps that don't increase leave the values as is.
+    if (frame != 10) {
+      timestamp_ms += step_distribution(rng);
+    }
+    const absl::Duration timestamp = absl::Milliseconds(timestamp_ms);
+    const double value_scale = 1.0 / (1 + frame % 3);
+    for (float& value : values) {
+      value = value_distribution(rng);
+    }
+    std::vector<float> expected = values;
+    for (int i = 0; i < kSize; ++i) {
+      expected[i] = filters[i].Apply(timestamp, value_scale, expected[i]);
+    }
+    bank.Apply(timestamp, value_scale, values.data());
+    for (int i = 0; i < kSize; ++i) {
+      ASSERT_EQ(expected[i], values[i]) << "frame " << frame << " value " << i;
+    }
+  }
+}
+
+TEST(OneEuroFilterBankTest, SameAsOneEuroFilters) {
+  ExpectSameAsOneEuroFilters(30.0, 0.01, 10.0, 1.0);
+  ExpectSameAsOneEuroFilters(30.0, 1.0, 0.0, 1.0);
+  ExpectSameAsOneEuroFilters(60.0, 0.05, 80.0, 2.0);
+}
+
+TEST(OneEuroFilterBankTest, SameAsOneEuroFiltersWithInvalidAlphas) {
+  // A negative beta can lead to cutoffs and alphas out of range.
+  ExpectSameAsOneEuroFilters(30.0, 0.01, -10.0, 1.0);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,145 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/hdr_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+HdrHistogram::HdrHistogram(int precision_bits)
+    : precision_bits_(precision_bits) {
+  CHECK_GE(precision_bits, 1);
+  CHECK_LE(precision_bits, 14);
+}
+
+absl::Status HdrHistogram::Merge(const HdrHistogram& other) {
+  if (other.precision_bits_ != precision_bits_) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Cannot merge a histogram with ", other.precision_bits_,
+                     " precision bits into one with ", precision_bits_, "."));
+  }
+  if (other.counts_.size() > counts_.size()) {
+    counts_.resize(other.counts_.size(), 0);
+  }
+  for (int i = 0; i < other.counts_.size(); ++i) {
+    counts_[i] += other.counts_[i];
+  }
+  count_ += other.count_;
+  sum_ += other.sum_;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+  return absl::OkStatus();
+}
+
+void HdrHistogram::Reset() {
+  counts_.clear();
+  count_ = 0;
+  sum_ = 0;
+  min_ = std::numeric_limits<int64>::max();
+  max_ = 0;
+}
+
+int64 HdrHistogram::BucketUpperBound(int index) const {
+  if (index < (2 << precision_bits_)) return index;
+  const int shift = (index >> precision_bits_) - 1;
+  const uint64 mantissa = index - (shift << precision_bits_);
+  const uint64 upper_bound = ((mantissa + 1) << shift) - 1;
+  return static_cast<int64>(
+      std::min<uint64>(upper_bound, std::numeric_limits<int64>::max()));
+}
+
+int64 HdrHistogram::ValueAtPercentile(double percentile) const {
+  if (count_ == 0) return 0;
+  const double clamped = std::max(0.0, std::min(100.0, percentile));
+  const int64 rank = std::max<int64>(
+      1, static_cast<int64>(std::ceil(clamped / 100.0 * count_)));
+  int64 cumulative_count = 0;
+  for (int i = 0; i < counts_.size(); ++i) {
+    cumulative_count += counts_[i];
+    if (cumulative_count >= rank) {
+      return std::min(BucketUpperBound(i), max_);
+    }
+  }
+  return max_;
+}
+
+void HdrHistogram::ToProto(HdrHistogramData* data) const {
+  data->Clear();
+  data->set_precision_bits(precision_bits_);
+  for (int i = 0; i < counts_.size(); ++i) {
+    if (counts_[i] == 0) continue;
+    data->add_bucket_indices(i);
+    data->add_bucket_counts(counts_[i]);
+  }
+  data->set_sum(sum_);
+  data->set_min(min());
+  data->set_max(max_);
+}
+
+absl::StatusOr<HdrHistogram> HdrHistogram::FromProto(
+    const HdrHistogramData& data) {
+  if (data.precision_bits() < 1 || data.precision_bits() > 14) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid precision bits: ", data.precision_bits()));
+  }
+  if (data.bucket_indices_size() != data.bucket_counts_size()) {
+    return absl::InvalidArgumentError(
+        "bucket_indices and bucket_counts have different sizes.");
+  }
+  HdrHistogram histogram(data.precision_bits());
+  const int max_index =
+      histogram.BucketIndex(std::numeric_limits<int64>::max());
+  for (int i = 0; i < data.bucket_indices_size(); ++i) {
+    const int index = data.bucket_indices(i);
+    if (index < 0 || index > max_index) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid bucket index: ", index));
+    }
+    if (index >= histogram.counts_.size()) {
+      histogram.counts_.resize(index + 1, 0);
+    }
+    histogram.counts_[index] += data.bucket_counts(i);
+    histogram.count_ += data.bucket_counts(i);
+  }
+  histogram.sum_ = data.sum();
+  if (histogram.count_ > 0) {
+    histogram.min_ = data.min();
+    histogram.max_ = data.max();
+  }
+  return histogram;
+}
+
+void HdrHistogram::Export(const std::string& name, const std::string& help,
+                          const MetricsSink::Labels& labels, double scale,
+                          MetricsSink* sink) const {
+  std::vector<double> upper_bounds;
+  std::vector<int64> bucket_counts;
+  int64 cumulative_count = 0;
+  for (int i = 0; i < counts_.size(); ++i) {
+    if (counts_[i] == 0) continue;
+    cumulative_count += counts_[i];
+    upper_bounds.push_back(BucketUpperBound(i) * scale);
+    bucket_counts.push_back(cumulative_count);
+  }
+  bucket_counts.push_back(count_);
+  sink->AddHistogram(name, help, labels, upper_bounds, bucket_counts,
+                     sum_ * scale);
+}
+
+}  // namespace mediapipe
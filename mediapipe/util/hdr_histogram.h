@@ -0,0 +1,113 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_HDR_HISTOGRAM_H_
+#define MEDIAPIPE_UTIL_HDR_HISTOGRAM_H_
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "absl/numeric/bits.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "mediapipe/framework/metrics_sink.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/util/hdr_histogram.pb.h"
+
+namespace mediapipe {
+
+// A high-dynamic-range histogram of non-negative integer values, such as
+// latencies in microseconds. Buckets are linear within each power of two and
+// there are 2^precision_bits of them per power of two, so any value is
+// resolved with a relative error of at most 2^-precision_bits while the
+// histogram covers the whole int64 range. Recording a value is a few integer
+// operations, and histograms with the same precision can be merged exactly.
+//
+// This class is not thread-safe.
+class HdrHistogram {
+ public:
+  // Less than 1% of relative error.
+  static constexpr int kDefaultPrecisionBits = 7;
+
+  // precision_bits must be in [1, 14], which bounds the memory used by the
+  // buckets to a few megabytes.
+  explicit HdrHistogram(int precision_bits = kDefaultPrecisionBits);
+
+  // Records `count` occurrences of `value`. Negative values are recorded as 0.
+  void Record(int64 value, int64 count = 1) {
+    if (value < 0) value = 0;
+    const int index = BucketIndex(value);
+    if (index >= counts_.size()) counts_.resize(index + 1, 0);
+    counts_[index] += count;
+    count_ += count;
+    sum_ += value * count;
+    if (value < min_) min_ = value;
+    if (value > max_) max_ = value;
+  }
+
+  // Adds the values recorded in `other`, which must have the same precision.
+  absl::Status Merge(const HdrHistogram& other);
+
+  // Forgets all recorded values.
+  void Reset();
+
+  int precision_bits() const { return precision_bits_; }
+  int64 count() const { return count_; }
+  int64 sum() const { return sum_; }
+  // The minimum and maximum recorded values, or 0 if there is none.
+  int64 min() const { return count_ > 0 ? min_ : 0; }
+  int64 max() const { return max_; }
+
+  // Returns the smallest value, up to the precision, such that at least
+  // `percentile` percent of the recorded values are less or equal to it, or 0
+  // if no value was recorded. For instance, ValueAtPercentile(99.9) is the
+  // p99.9 of the recorded values.
+  int64 ValueAtPercentile(double percentile) const;
+
+  void ToProto(HdrHistogramData* data) const;
+  static absl::StatusOr<HdrHistogram> FromProto(const HdrHistogramData& data);
+
+  // Reports the histogram to `sink`, with the upper bounds of the non-empty
+  // buckets, and the bounds and the sum multiplied by `scale`, e.g. 1e-6 to
+  // report microseconds in seconds.
+  void Export(const std::string& name, const std::string& help,
+              const MetricsSink::Labels& labels, double scale,
+              MetricsSink* sink) const;
+
+ private:
+  // Values below 2^(precision_bits + 1) have a bucket each. Above, the bucket
+  // of a value with its highest bit at position precision_bits + e is given
+  // by its precision_bits + 1 highest bits, offset by e * 2^precision_bits.
+  int BucketIndex(int64 value) const {
+    const uint64 v = static_cast<uint64>(value);
+    const int shift = 63 - absl::countl_zero(v | 1) - precision_bits_;
+    if (shift <= 0) return static_cast<int>(v);
+    return (shift << precision_bits_) + static_cast<int>(v >> shift);
+  }
+
+  // The largest value recorded in the bucket with the given index.
+  int64 BucketUpperBound(int index) const;
+
+  int precision_bits_;
+  std::vector<int64> counts_;
+  int64 count_ = 0;
+  int64 sum_ = 0;
+  int64 min_ = std::numeric_limits<int64>::max();
+  int64 max_ = 0;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_HDR_HISTOGRAM_H_
@@ -0,0 +1,164 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/hdr_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+// Returns the exact percentile of `values` with the same definition as
+// HdrHistogram::ValueAtPercentile.
+int64 ExactPercentile(std::vector<int64> values, double percentile) {
+  std::sort(values.begin(), values.end());
+  const int64 rank = std::max<int64>(
+      1, static_cast<int64>(std::ceil(percentile / 100.0 * values.size())));
+  return values[rank - 1];
+}
+
+TEST(HdrHistogramTest, EmptyHistogram) {
+  HdrHistogram histogram;
+  EXPECT_EQ(histogram.count(), 0);
+  EXPECT_EQ(histogram.min(), 0);
+  EXPECT_EQ(histogram.max(), 0);
+  EXPECT_EQ(histogram.ValueAtPercentile(50), 0);
+}
+
+TEST(HdrHistogramTest, SmallValuesAreExact) {
+  HdrHistogram histogram(/*precision_bits=*/3);
+  for (int64 value = 0; value < 16; ++value) histogram.Record(value);
+  EXPECT_EQ(histogram.count(), 16);
+  EXPECT_EQ(histogram.sum(), 120);
+  EXPECT_EQ(histogram.ValueAtPercentile(0), 0);
+  EXPECT_EQ(histogram.ValueAtPercentile(50), 7);
+  EXPECT_EQ(histogram.ValueAtPercentile(100), 15);
+}
+
+TEST(HdrHistogramTest, PercentilesWithinPrecision) {
+  // Log-uniform latencies from 1us to 10s, like a long tail.
+  std::mt19937 rng(/*seed=*/1);
+  std::uniform_real_distribution<double> exponent(0.0, 7.0);
+  std::vector<int64> values;
+  HdrHistogram histogram(/*precision_bits=*/7);
+  for (int i = 0; i < 10000; ++i) {
+    const int64 value = static_cast<int64>(std::pow(10.0, exponent(rng)));
+    values.push_back(value);
+    histogram.Record(value);
+  }
+  for (double percentile : {50.0, 90.0, 99.0, 99.9, 100.0}) {
+    const int64 exact = ExactPercentile(values, percentile);
+    const int64 estimate = histogram.ValueAtPercentile(percentile);
+    EXPECT_GE(estimate, exact) << percentile;
+    EXPECT_LE(estimate, exact + exact / 128) << percentile;
+  }
+  EXPECT_EQ(histogram.min(), *std::min_element(values.begin(), values.end()));
+  EXPECT_EQ(histogram.max(), *std::max_element(values.begin(), values.end()));
+}
+
+TEST(HdrHistogramTest, RecordsLargeValues) {
+  HdrHistogram histogram;
+  histogram.Record(std::numeric_limits<int64>::max());
+  histogram.Record(-5);
+  EXPECT_EQ(histogram.min(), 0);
+  EXPECT_EQ(histogram.ValueAtPercentile(100),
+            std::numeric_limits<int64>::max());
+}
+
+TEST(HdrHistogramTest, MergeMatchesSingleHistogram) {
+  HdrHistogram all;
+  HdrHistogram first;
+  HdrHistogram second;
+  for (int64 value = 0; value < 100000; value += 7) {
+    all.Record(value);
+    (value % 2 ? first : second).Record(value);
+  }
+  MP_ASSERT_OK(first.Merge(second));
+  EXPECT_EQ(first.count(), all.count());
+  EXPECT_EQ(first.sum(), all.sum());
+  EXPECT_EQ(first.min(), all.min());
+  EXPECT_EQ(first.max(), all.max());
+  for (double percentile : {1.0, 50.0, 99.0, 99.9}) {
+    EXPECT_EQ(first.ValueAtPercentile(percentile),
+              all.ValueAtPercentile(percentile));
+  }
+
+  HdrHistogram other_precision(/*precision_bits=*/5);
+  EXPECT_EQ(first.Merge(other_precision).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(HdrHistogramTest, ProtoRoundTrip) {
+  HdrHistogram histogram;
+  for (int64 value : {3, 1000, 1000, 123456789}) histogram.Record(value);
+  HdrHistogramData data;
+  histogram.ToProto(&data);
+  EXPECT_EQ(data.bucket_indices_size(), 3);
+  MP_ASSERT_OK_AND_ASSIGN(HdrHistogram restored, HdrHistogram::FromProto(data));
+  EXPECT_EQ(restored.count(), 4);
+  EXPECT_EQ(restored.sum(), histogram.sum());
+  EXPECT_EQ(restored.min(), 3);
+  EXPECT_EQ(restored.max(), 123456789);
+  EXPECT_EQ(restored.ValueAtPercentile(50), histogram.ValueAtPercentile(50));
+
+  data.set_precision_bits(0);
+  EXPECT_FALSE(HdrHistogram::FromProto(data).ok());
+}
+
+class RecordingSink : public MetricsSink {
+ public:
+  void AddCounter(const std::string& name, const std::string& help,
+                  const Labels& labels, double value) override {}
+  void AddGauge(const std::string& name, const std::string& help,
+                const Labels& labels, double value) override {}
+  void AddHistogram(const std::string& name, const std::string& help,
+                    const Labels& labels,
+                    const std::vector<double>& upper_bounds,
+                    const std::vector<int64>& bucket_counts,
+                    double sum) override {
+    upper_bounds_ = upper_bounds;
+    bucket_counts_ = bucket_counts;
+    sum_ = sum;
+  }
+
+  std::vector<double> upper_bounds_;
+  std::vector<int64> bucket_counts_;
+  double sum_ = 0;
+};
+
+TEST(HdrHistogramTest, ExportsNonEmptyBuckets) {
+  HdrHistogram histogram(/*precision_bits=*/2);
+  for (int64 value : {1, 1, 3, 100}) histogram.Record(value);
+  RecordingSink sink;
+  histogram.Export("latency_seconds", "", {}, /*scale=*/1e-6, &sink);
+  // 100 falls in the bucket [96, 111] with 2 precision bits.
+  EXPECT_THAT(sink.upper_bounds_,
+              testing::ElementsAre(testing::DoubleEq(1e-6),
+                                   testing::DoubleEq(3e-6),
+                                   testing::DoubleEq(111e-6)));
+  EXPECT_THAT(sink.bucket_counts_, testing::ElementsAre(2, 3, 4, 4));
+  EXPECT_DOUBLE_EQ(sink.sum_, 105e-6);
+}
+
+}  // namespace
+}  // namespace mediapipe
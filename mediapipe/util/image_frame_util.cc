@@ -18,6 +18,7 @@
 #include <cmath>
 #include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/str_cat.h"
@@ -26,7 +27,9 @@
 #include "libyuv/convert.h"
 #include "libyuv/convert_argb.h"
 #include "libyuv/convert_from.h"
+#include "libyuv/planar_functions.h"
 #include "libyuv/row.h"
+#include "libyuv/scale.h"
 #include "libyuv/video_common.h"
 #include "mediapipe/framework/deps/mathutil.h"
 #include "mediapipe/framework/formats/image_frame.h"
@@ -36,12 +39,70 @@
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/port.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/status_macros.h"
 
 namespace mediapipe {
 
 namespace image_frame_util {
 
+namespace {
+
+// libyuv names the packed formats after their order in a little-endian word:
+// RAW is R, G, B in memory, ABGR is R, G, B, A and ARGB is B, G, R, A.
+int I420ToImageFrame(const uint8* y, int y_stride, const uint8* u,
+                     int u_stride, const uint8* v, int v_stride,
+                     ImageFrame* image_frame) {
+  uint8* dst = image_frame->MutablePixelData();
+  const int dst_stride = image_frame->WidthStep();
+  const int width = image_frame->Width();
+  const int height = image_frame->Height();
+  switch (image_frame->Format()) {
+    case ImageFormat::SRGB:
+      return libyuv::I420ToRAW(y, y_stride, u, u_stride, v, v_stride, dst,
+                               dst_stride, width, height);
+    case ImageFormat::SRGBA:
+      return libyuv::I420ToABGR(y, y_stride, u, u_stride, v, v_stride, dst,
+                                dst_stride, width, height);
+    case ImageFormat::SBGRA:
+      return libyuv::I420ToARGB(y, y_stride, u, u_stride, v, v_stride, dst,
+                                dst_stride, width, height);
+    default:
+      return -1;
+  }
+}
+
+// Converts NV12 planes, or NV21 planes if "vu" is set.
+int NV12ToImageFrame(const uint8* y, int y_stride, const uint8* uv,
+                     int uv_stride, bool vu, ImageFrame* image_frame) {
+  uint8* dst = image_frame->MutablePixelData();
+  const int dst_stride = image_frame->WidthStep();
+  const int width = image_frame->Width();
+  const int height = image_frame->Height();
+  switch (image_frame->Format()) {
+    case ImageFormat::SRGB:
+      return vu ? libyuv::NV21ToRAW(y, y_stride, uv, uv_stride, dst,
+                                    dst_stride, width, height)
+                : libyuv::NV12ToRAW(y, y_stride, uv, uv_stride, dst,
+                                    dst_stride, width, height);
+    case ImageFormat::SRGBA:
+      return vu ? libyuv::NV21ToABGR(y, y_stride, uv, uv_stride, dst,
+                                     dst_stride, width, height)
+                : libyuv::NV12ToABGR(y, y_stride, uv, uv_stride, dst,
+                                     dst_stride, width, height);
+    case ImageFormat::SBGRA:
+      return vu ? libyuv::NV21ToARGB(y, y_stride, uv, uv_stride, dst,
+                                     dst_stride, width, height)
+                : libyuv::NV12ToARGB(y, y_stride, uv, uv_stride, dst,
+                                     dst_stride, width, height);
+    default:
+      return -1;
+  }
+}
+
+}  // namespace
+
 void RescaleImageFrame(const ImageFrame& source_frame, const int width,
                        const int height, const int alignment_boundary,
                        const int open_cv_interpolation_algorithm,
@@ -166,48 +227,94 @@ void YUVImageToImageFrame(const YUVImage& yuv_image, ImageFrame* image_frame,
 void YUVImageToImageFrameFromFormat(const YUVImage& yuv_image,
                                     ImageFrame* image_frame) {
   CHECK(image_frame);
-  int width = yuv_image.width();
-  int height = yuv_image.height();
-  image_frame->Reset(ImageFormat::SRGB, width, height, 16);
+  CHECK_OK(ConvertYUVImageToImageFrame(
+      yuv_image, ImageFormat::SRGB, yuv_image.width(), yuv_image.height(),
+      image_frame));
+}
 
-  const auto& format = yuv_image.fourcc();
-  switch (format) {
-    case libyuv::FOURCC_NV12:
-      // 8-bit Y plane followed by an interleaved 8-bit U/V plane with 2×2
-      // subsampling.
-      libyuv::NV12ToRAW(
-          yuv_image.data(0), yuv_image.stride(0), yuv_image.data(1),
-          yuv_image.stride(1), image_frame->MutablePixelData(),
-          image_frame->WidthStep(), yuv_image.width(), yuv_image.height());
-      break;
-    case libyuv::FOURCC_NV21:
-      // 8-bit Y plane followed by an interleaved 8-bit V/U plane with 2×2
-      // subsampling.
-      libyuv::NV21ToRAW(
-          yuv_image.data(0), yuv_image.stride(0), yuv_image.data(1),
-          yuv_image.stride(1), image_frame->MutablePixelData(),
-          image_frame->WidthStep(), yuv_image.width(), yuv_image.height());
-      break;
-    case libyuv::FOURCC_I420:
-      // Also known as YV21.
-      // 8-bit Y plane followed by 8-bit 2×2 subsampled U and V planes.
-      libyuv::I420ToRAW(
-          yuv_image.data(0), yuv_image.stride(0), yuv_image.data(1),
-          yuv_image.stride(1), yuv_image.data(2), yuv_image.stride(2),
-          image_frame->MutablePixelData(), image_frame->WidthStep(),
-          yuv_image.width(), yuv_image.height());
-      break;
-    case libyuv::FOURCC_YV12:
-      // 8-bit Y plane followed by 8-bit 2×2 subsampled V and U planes.
-      libyuv::I420ToRAW(
-          yuv_image.data(0), yuv_image.stride(0), yuv_image.data(2),
-          yuv_image.stride(2), yuv_image.data(1), yuv_image.stride(1),
-          image_frame->MutablePixelData(), image_frame->WidthStep(),
-          yuv_image.width(), yuv_image.height());
-      break;
-    default:
-      LOG(FATAL) << "Unsupported YUVImage format.";
+absl::Status ConvertYUVImageToImageFrame(const YUVImage& yuv_image,
+                                         ImageFormat::Format format, int width,
+                                         int height, ImageFrame* image_frame) {
+  RET_CHECK(image_frame);
+  RET_CHECK(format == ImageFormat::SRGB || format == ImageFormat::SRGBA ||
+            format == ImageFormat::SBGRA)
+      << "Unsupported output format: " << ImageFormat::Format_Name(format);
+  RET_CHECK(width > 0 && height > 0);
+  const libyuv::FourCC fourcc = yuv_image.fourcc();
+  // NV12: 8-bit Y plane followed by an interleaved 8-bit U/V plane with 2×2
+  // subsampling.  NV21: the same with V/U.  I420, also known as YV21: 8-bit Y
+  // plane followed by 8-bit 2×2 subsampled U and V planes.  YV12: the same
+  // with V and U planes.
+  const bool nv = fourcc == libyuv::FOURCC_NV12 ||
+                  fourcc == libyuv::FOURCC_NV21;
+  if (!nv && fourcc != libyuv::FOURCC_I420 &&
+      fourcc != libyuv::FOURCC_YV12) {
+    return absl::InvalidArgumentError("Unsupported YUVImage format.");
+  }
+  image_frame->Reset(format, width, height,
+                     ImageFrame::kDefaultAlignmentBoundary);
+
+  const uint8* y = yuv_image.data(0);
+  const int y_stride = yuv_image.stride(0);
+  int rv;
+  if (width == yuv_image.width() && height == yuv_image.height()) {
+    if (nv) {
+      rv = NV12ToImageFrame(y, y_stride, yuv_image.data(1),
+                            yuv_image.stride(1),
+                            fourcc == libyuv::FOURCC_NV21, image_frame);
+    } else {
+      const int u = fourcc == libyuv::FOURCC_I420 ? 1 : 2;
+      const int v = 3 - u;
+      rv = I420ToImageFrame(y, y_stride, yuv_image.data(u),
+                            yuv_image.stride(u), yuv_image.data(v),
+                            yuv_image.stride(v), image_frame);
+    }
+  } else {
+    // Splits the chroma of NV12 and NV21 into separate planes, so that all
+    // formats go through I420Scale().
+    const int src_uv_width = (yuv_image.width() + 1) / 2;
+    const int src_uv_height = (yuv_image.height() + 1) / 2;
+    std::vector<uint8> split_uv;
+    const uint8* u;
+    const uint8* v;
+    int u_stride, v_stride;
+    if (nv) {
+      split_uv.resize(2 * src_uv_width * src_uv_height);
+      uint8* split_u = split_uv.data();
+      uint8* split_v = split_u + src_uv_width * src_uv_height;
+      if (fourcc == libyuv::FOURCC_NV21) std::swap(split_u, split_v);
+      libyuv::SplitUVPlane(yuv_image.data(1), yuv_image.stride(1), split_u,
+                           src_uv_width, split_v, src_uv_width, src_uv_width,
+                           src_uv_height);
+      u = split_u;
+      v = split_v;
+      u_stride = v_stride = src_uv_width;
+    } else {
+      const int u_plane = fourcc == libyuv::FOURCC_I420 ? 1 : 2;
+      const int v_plane = 3 - u_plane;
+      u = yuv_image.data(u_plane);
+      v = yuv_image.data(v_plane);
+      u_stride = yuv_image.stride(u_plane);
+      v_stride = yuv_image.stride(v_plane);
+    }
+
+    const int uv_width = (width + 1) / 2;
+    const int uv_height = (height + 1) / 2;
+    std::vector<uint8> scaled(width * height + 2 * uv_width * uv_height);
+    uint8* scaled_y = scaled.data();
+    uint8* scaled_u = scaled_y + width * height;
+    uint8* scaled_v = scaled_u + uv_width * uv_height;
+    rv = libyuv::I420Scale(y, y_stride, u, u_stride, v, v_stride,
+                           yuv_image.width(), yuv_image.height(), scaled_y,
+                           width, scaled_u, uv_width, scaled_v, uv_width,
+                           width, height, libyuv::kFilterBilinear);
+    if (rv == 0) {
+      rv = I420ToImageFrame(scaled_y, width, scaled_u, uv_width, scaled_v,
+                            uv_width, image_frame);
+    }
   }
+  RET_CHECK_EQ(rv, 0) << "libyuv failed to convert the YUVImage.";
+  return absl::OkStatus();
 }
 
 void SrgbToMpegYCbCr(const uint8 r, const uint8 g, const uint8 b,  //
@@ -307,15 +414,12 @@ void LinearRgb16ToSrgb(const cv::Mat& source, cv::Mat* destination) {
 
   static const cv::Mat kLut = GetLinearRgb16ToSrgbLut();
   const uint8* lookup_table_ptr = kLut.ptr<uint8>();
-  const int num_channels = source.channels();
+  const int row_size = source.cols * source.channels();
   for (int row = 0; row < source.rows; ++row) {
-    for (int col = 0; col < source.cols; ++col) {
-      for (int channel = 0; channel < num_channels; ++channel) {
-        uint8* ptr = destination->ptr<uint8>(row);
-        const uint16* ptr16 = source.ptr<uint16>(row);
-        ptr[col * num_channels + channel] =
-            lookup_table_ptr[ptr16[col * num_channels + channel]];
-      }
+    uint8* ptr = destination->ptr<uint8>(row);
+    const uint16* ptr16 = source.ptr<uint16>(row);
+    for (int i = 0; i < row_size; ++i) {
+      ptr[i] = lookup_table_ptr[ptr16[i]];
     }
   }
 }
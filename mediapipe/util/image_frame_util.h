@@ -18,6 +18,7 @@
 
 #include <string>
 
+#include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "mediapipe/framework/formats/image_format.pb.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -69,6 +70,17 @@ void YUVImageToImageFrame(const YUVImage& yuv_image, ImageFrame* image_frame,
 void YUVImageToImageFrameFromFormat(const YUVImage& yuv_image,
                                     ImageFrame* image_frame);
 
+// Converts an NV12, NV21, YV12 or I420 YUVImage to an SRGB, SRGBA or SBGRA
+// ImageFrame of the given size, assuming BT.601 like the function above.
+// image_frame will be Reset() by this function.  The conversion runs libyuv's
+// row functions, which have AVX2 and NEON versions.  When the size differs
+// from the YUV image's, the YUV planes are resized with bilinear filtering
+// before the color conversion, which touches half as many bytes as resizing
+// the converted SRGB image and skips converting the discarded pixels.
+absl::Status ConvertYUVImageToImageFrame(const YUVImage& yuv_image,
+                                         ImageFormat::Format format, int width,
+                                         int height, ImageFrame* image_frame);
+
 // Convert sRGB values into MPEG YCbCr values.  Notice that MPEG YCbCr
 // values use a smaller range of values than JPEG YCbCr.  The conversion
 // values used are those from ITU-R BT.601 (which are the same as ITU-R
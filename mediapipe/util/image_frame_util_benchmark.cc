@@ -0,0 +1,173 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares ConvertYUVImageToImageFrame() with the paths it replaces: OpenCV's
+// color conversion, a separate RGB to RGBA pass as done by chaining
+// ColorConvertCalculator, and resizing the converted image. The benchmarks
+// run at 720p, 1080p and 4K, and the resizing ones downscale to 640x360.
+
+#include "libyuv/convert_argb.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/formats/yuv_image.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/util/image_frame_util.h"
+
+namespace mediapipe {
+namespace image_frame_util {
+namespace {
+
+constexpr int kResizedWidth = 640;
+constexpr int kResizedHeight = 360;
+
+// Makes an NV12 image of the benchmark's size from a gradient.
+void MakeNV12Image(const benchmark::State& state, YUVImage* yuv_image) {
+  ImageFrame image_frame(ImageFormat::SRGB, state.range(0), state.range(1));
+  cv::Mat mat = formats::MatView(&image_frame);
+  for (int y = 0; y < mat.rows; ++y) {
+    for (int x = 0; x < mat.cols; ++x) {
+      mat.at<cv::Vec3b>(y, x) = cv::Vec3b(x & 0xff, y & 0xff, (x + y) & 0xff);
+    }
+  }
+  ImageFrameToYUVNV12Image(image_frame, yuv_image);
+}
+
+// Wraps the planes of an NV12 image in a single-channel Mat, as OpenCV expects.
+cv::Mat NV12Mat(const YUVImage& yuv_image) {
+  // ImageFrameToYUVNV12Image() stores the UV plane right after the Y plane.
+  return cv::Mat(yuv_image.height() * 3 / 2, yuv_image.width(), CV_8UC1,
+                 const_cast<uint8*>(yuv_image.data(0)), yuv_image.stride(0));
+}
+
+void BM_NV12ToSrgbOpenCV(benchmark::State& state) {
+  YUVImage yuv_image;
+  MakeNV12Image(state, &yuv_image);
+  const cv::Mat nv12 = NV12Mat(yuv_image);
+  ImageFrame image_frame(ImageFormat::SRGB, yuv_image.width(),
+                         yuv_image.height());
+  cv::Mat rgb = formats::MatView(&image_frame);
+  for (auto _ : state) {
+    cv::cvtColor(nv12, rgb, cv::COLOR_YUV2RGB_NV12);
+  }
+}
+
+void BM_NV12ToSrgb(benchmark::State& state) {
+  YUVImage yuv_image;
+  MakeNV12Image(state, &yuv_image);
+  ImageFrame image_frame;
+  for (auto _ : state) {
+    CHECK_OK(ConvertYUVImageToImageFrame(yuv_image, ImageFormat::SRGB,
+                                         yuv_image.width(), yuv_image.height(),
+                                         &image_frame));
+  }
+}
+
+void BM_NV12ToSrgbThenSrgba(benchmark::State& state) {
+  YUVImage yuv_image;
+  MakeNV12Image(state, &yuv_image);
+  ImageFrame rgb_frame;
+  for (auto _ : state) {
+    CHECK_OK(ConvertYUVImageToImageFrame(yuv_image, ImageFormat::SRGB,
+                                         yuv_image.width(), yuv_image.height(),
+                                         &rgb_frame));
+    ImageFrame rgba_frame(ImageFormat::SRGBA, rgb_frame.Width(),
+                          rgb_frame.Height());
+    cv::Mat rgba = formats::MatView(&rgba_frame);
+    cv::cvtColor(formats::MatView(&rgb_frame), rgba, cv::COLOR_RGB2RGBA);
+    benchmark::DoNotOptimize(rgba_frame.PixelData());
+  }
+}
+
+void BM_NV12ToSrgba(benchmark::State& state) {
+  YUVImage yuv_image;
+  MakeNV12Image(state, &yuv_image);
+  ImageFrame image_frame;
+  for (auto _ : state) {
+    CHECK_OK(ConvertYUVImageToImageFrame(yuv_image, ImageFormat::SRGBA,
+                                         yuv_image.width(), yuv_image.height(),
+                                         &image_frame));
+  }
+}
+
+void BM_NV12ToSrgbThenResize(benchmark::State& state) {
+  YUVImage yuv_image;
+  MakeNV12Image(state, &yuv_image);
+  ImageFrame image_frame;
+  cv::Mat resized;
+  for (auto _ : state) {
+    CHECK_OK(ConvertYUVImageToImageFrame(yuv_image, ImageFormat::SRGB,
+                                         yuv_image.width(), yuv_image.height(),
+                                         &image_frame));
+    cv::resize(formats::MatView(&image_frame), resized,
+               cv::Size(kResizedWidth, kResizedHeight), 0, 0,
+               cv::INTER_LINEAR);
+  }
+}
+
+void BM_NV12ToSrgbFusedResize(benchmark::State& state) {
+  YUVImage yuv_image;
+  MakeNV12Image(state, &yuv_image);
+  ImageFrame image_frame;
+  for (auto _ : state) {
+    CHECK_OK(ConvertYUVImageToImageFrame(yuv_image, ImageFormat::SRGB,
+                                         kResizedWidth, kResizedHeight,
+                                         &image_frame));
+  }
+}
+
+void BM_SrgbToSrgbaOpenCV(benchmark::State& state) {
+  ImageFrame rgb_frame(ImageFormat::SRGB, state.range(0), state.range(1));
+  rgb_frame.SetToZero();
+  ImageFrame rgba_frame(ImageFormat::SRGBA, state.range(0), state.range(1));
+  cv::Mat rgba = formats::MatView(&rgba_frame);
+  for (auto _ : state) {
+    cv::cvtColor(formats::MatView(&rgb_frame), rgba, cv::COLOR_RGB2RGBA);
+    // ColorConvertCalculator then set the alpha channel to 255.
+    for (int y = 0; y < rgba.rows; ++y) {
+      uint8* row = rgba.ptr<uint8>(y);
+      for (int x = 0; x < rgba.cols; ++x) row[4 * x + 3] = 255;
+    }
+  }
+}
+
+void BM_SrgbToSrgbaLibyuv(benchmark::State& state) {
+  ImageFrame rgb_frame(ImageFormat::SRGB, state.range(0), state.range(1));
+  rgb_frame.SetToZero();
+  ImageFrame rgba_frame(ImageFormat::SRGBA, state.range(0), state.range(1));
+  for (auto _ : state) {
+    libyuv::RGB24ToARGB(rgb_frame.PixelData(), rgb_frame.WidthStep(),
+                        rgba_frame.MutablePixelData(), rgba_frame.WidthStep(),
+                        rgb_frame.Width(), rgb_frame.Height());
+  }
+}
+
+void Resolutions(benchmark::internal::Benchmark* benchmark) {
+  benchmark->Args({1280, 720})->Args({1920, 1080})->Args({3840, 2160});
+}
+
+BENCHMARK(BM_NV12ToSrgbOpenCV)->Apply(Resolutions);
+BENCHMARK(BM_NV12ToSrgb)->Apply(Resolutions);
+BENCHMARK(BM_NV12ToSrgbThenSrgba)->Apply(Resolutions);
+BENCHMARK(BM_NV12ToSrgba)->Apply(Resolutions);
+BENCHMARK(BM_NV12ToSrgbThenResize)->Apply(Resolutions);
+BENCHMARK(BM_NV12ToSrgbFusedResize)->Apply(Resolutions);
+BENCHMARK(BM_SrgbToSrgbaOpenCV)->Apply(Resolutions);
+BENCHMARK(BM_SrgbToSrgbaLibyuv)->Apply(Resolutions);
+
+}  // namespace
+}  // namespace image_frame_util
+}  // namespace mediapipe
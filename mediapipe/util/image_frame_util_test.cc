@@ -0,0 +1,120 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/image_frame_util.h"
+
+#include <cstdlib>
+
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/yuv_image.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace image_frame_util {
+namespace {
+
+constexpr int kWidth = 64;
+constexpr int kHeight = 48;
+constexpr uint8 kRed = 200;
+constexpr uint8 kGreen = 100;
+constexpr uint8 kBlue = 50;
+
+// Fills yuv_image with a solid color, in I420 or, if "nv12" is set, NV12.
+void MakeSolidYUVImage(bool nv12, YUVImage* yuv_image) {
+  ImageFrame image_frame(ImageFormat::SRGB, kWidth, kHeight);
+  for (int y = 0; y < kHeight; ++y) {
+    uint8* row = image_frame.MutablePixelData() + y * image_frame.WidthStep();
+    for (int x = 0; x < kWidth; ++x) {
+      row[3 * x] = kRed;
+      row[3 * x + 1] = kGreen;
+      row[3 * x + 2] = kBlue;
+    }
+  }
+  if (nv12) {
+    ImageFrameToYUVNV12Image(image_frame, yuv_image);
+  } else {
+    ImageFrameToYUVImage(image_frame, yuv_image);
+  }
+}
+
+// Checks that every pixel is close to the solid color, allowing for the
+// rounding of the YUV round trip.
+void ExpectSolidColor(const ImageFrame& image_frame, int red_channel,
+                      int blue_channel) {
+  const int channels = image_frame.NumberOfChannels();
+  for (int y = 0; y < image_frame.Height(); ++y) {
+    const uint8* row = image_frame.PixelData() + y * image_frame.WidthStep();
+    for (int x = 0; x < image_frame.Width(); ++x) {
+      const uint8* pixel = row + x * channels;
+      ASSERT_LE(std::abs(pixel[red_channel] - kRed), 3) << x << ", " << y;
+      ASSERT_LE(std::abs(pixel[1] - kGreen), 3) << x << ", " << y;
+      ASSERT_LE(std::abs(pixel[blue_channel] - kBlue), 3) << x << ", " << y;
+      if (channels == 4) {
+        ASSERT_EQ(pixel[3], 255) << x << ", " << y;
+      }
+    }
+  }
+}
+
+TEST(ImageFrameUtilTest, ConvertsYUVImageToFormats) {
+  for (bool nv12 : {false, true}) {
+    YUVImage yuv_image;
+    MakeSolidYUVImage(nv12, &yuv_image);
+    ImageFrame image_frame;
+
+    MP_ASSERT_OK(ConvertYUVImageToImageFrame(yuv_image, ImageFormat::SRGB,
+                                             kWidth, kHeight, &image_frame));
+    EXPECT_EQ(image_frame.Format(), ImageFormat::SRGB);
+    ExpectSolidColor(image_frame, 0, 2);
+
+    MP_ASSERT_OK(ConvertYUVImageToImageFrame(yuv_image, ImageFormat::SRGBA,
+                                             kWidth, kHeight, &image_frame));
+    EXPECT_EQ(image_frame.Format(), ImageFormat::SRGBA);
+    ExpectSolidColor(image_frame, 0, 2);
+
+    MP_ASSERT_OK(ConvertYUVImageToImageFrame(yuv_image, ImageFormat::SBGRA,
+                                             kWidth, kHeight, &image_frame));
+    EXPECT_EQ(image_frame.Format(), ImageFormat::SBGRA);
+    ExpectSolidColor(image_frame, 2, 0);
+  }
+}
+
+TEST(ImageFrameUtilTest, ResizesYUVImage) {
+  for (bool nv12 : {false, true}) {
+    YUVImage yuv_image;
+    MakeSolidYUVImage(nv12, &yuv_image);
+    ImageFrame image_frame;
+    MP_ASSERT_OK(ConvertYUVImageToImageFrame(yuv_image, ImageFormat::SRGBA,
+                                             kWidth / 2 + 1, kHeight / 3,
+                                             &image_frame));
+    EXPECT_EQ(image_frame.Width(), kWidth / 2 + 1);
+    EXPECT_EQ(image_frame.Height(), kHeight / 3);
+    ExpectSolidColor(image_frame, 0, 2);
+  }
+}
+
+TEST(ImageFrameUtilTest, FailsForUnsupportedOutputFormat) {
+  YUVImage yuv_image;
+  MakeSolidYUVImage(/*nv12=*/false, &yuv_image);
+  ImageFrame image_frame;
+  EXPECT_FALSE(ConvertYUVImageToImageFrame(yuv_image, ImageFormat::GRAY8,
+                                           kWidth, kHeight, &image_frame)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace image_frame_util
+}  // namespace mediapipe
@@ -0,0 +1,91 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/mapped_file.h"
+
+#ifdef _WIN32
+#include "mediapipe/framework/port/file_helpers.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_builder.h"
+
+namespace mediapipe {
+
+absl::StatusOr<std::unique_ptr<MappedFile>> MappedFile::Open(
+    const std::string& path) {
+  auto file = std::unique_ptr<MappedFile>(new MappedFile(path));
+#ifdef _WIN32
+  MP_RETURN_IF_ERROR(file::GetContents(path, &file->buffer_));
+  file->contents_ = file->buffer_;
+#else
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Can't open file: " << path << ": " << strerror(errno);
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    const int error = errno;
+    close(fd);
+    return mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+           << "Can't stat file: " << path << ": " << strerror(error);
+  }
+  // mmap() rejects empty mappings; an empty file has empty contents.
+  if (file_stat.st_size > 0) {
+    void* mapping = mmap(/*addr=*/nullptr, file_stat.st_size, PROT_READ,
+                         MAP_SHARED, fd, /*offset=*/0);
+    if (mapping == MAP_FAILED) {
+      const int error = errno;
+      close(fd);
+      return mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+             << "Can't map file: " << path << ": " << strerror(error);
+    }
+    file->mapping_ = mapping;
+    file->mapping_size_ = file_stat.st_size;
+    file->contents_ = absl::string_view(static_cast<const char*>(mapping),
+                                        file->mapping_size_);
+  }
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+#endif  // _WIN32
+  return file;
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+  }
+#endif  // !_WIN32
+}
+
+void MappedFile::Prefetch() const {
+#ifndef _WIN32
+  if (mapping_ != nullptr) {
+    madvise(mapping_, mapping_size_, MADV_WILLNEED);
+  }
+#endif  // !_WIN32
+}
+
+}  // namespace mediapipe
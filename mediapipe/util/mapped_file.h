@@ -0,0 +1,69 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_MAPPED_FILE_H_
+#define MEDIAPIPE_UTIL_MAPPED_FILE_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace mediapipe {
+
+// The read-only contents of a file, memory-mapped where the platform supports
+// it and read into memory otherwise. Unlike a std::string, the contents are
+// paged in by the OS on demand and are not copied onto the heap.
+//
+// A MappedFile is not copyable; share it as a Packet or a shared_ptr. The
+// mapping is released when the last reference goes away.
+//
+// Example:
+//   ASSIGN_OR_RETURN(std::unique_ptr<MappedFile> file,
+//                    MappedFile::Open("/path/to/model.tflite"));
+//   absl::string_view contents = file->contents();
+class MappedFile {
+ public:
+  // Maps the whole file at `path`.
+  static absl::StatusOr<std::unique_ptr<MappedFile>> Open(
+      const std::string& path);
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile();
+
+  absl::string_view contents() const { return contents_; }
+  const std::string& path() const { return path_; }
+
+  // Asks the OS to start paging in the contents, so that later reads do not
+  // stall on page faults. Does not block.
+  void Prefetch() const;
+
+ private:
+  explicit MappedFile(std::string path) : path_(std::move(path)) {}
+
+  std::string path_;
+  absl::string_view contents_;
+  // Base address and length of the mapping, or nullptr if not mapped.
+  void* mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+  // Holds the contents where they cannot be mapped.
+  std::string buffer_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_MAPPED_FILE_H_
@@ -0,0 +1,60 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/mapped_file.h"
+
+#include <memory>
+#include <string>
+
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(MappedFileTest, MapsFileContents) {
+  const std::string path =
+      file::JoinPath(::testing::TempDir(), "mapped_file_test.bin");
+  const std::string contents("binary\0contents", 15);
+  MP_ASSERT_OK(file::SetContents(path, contents));
+
+  MP_ASSERT_OK_AND_ASSIGN(std::unique_ptr<MappedFile> file,
+                          MappedFile::Open(path));
+  file->Prefetch();
+  EXPECT_EQ(file->contents(), contents);
+  EXPECT_EQ(file->path(), path);
+}
+
+TEST(MappedFileTest, MapsEmptyFile) {
+  const std::string path =
+      file::JoinPath(::testing::TempDir(), "mapped_file_test_empty.bin");
+  MP_ASSERT_OK(file::SetContents(path, ""));
+
+  MP_ASSERT_OK_AND_ASSIGN(std::unique_ptr<MappedFile> file,
+                          MappedFile::Open(path));
+  file->Prefetch();
+  EXPECT_TRUE(file->contents().empty());
+}
+
+TEST(MappedFileTest, FailsOnMissingFile) {
+  EXPECT_FALSE(MappedFile::Open(file::JoinPath(::testing::TempDir(),
+                                               "mapped_file_test_missing"))
+                   .ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,433 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/packet_log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_builder.h"
+#include "mediapipe/framework/type_map.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr char kLogMagic[8] = {'M', 'P', 'P', 'K', 'T', 'L', 'O', 'G'};
+constexpr char kIndexMagic[8] = {'M', 'P', 'P', 'K', 'T', 'I', 'D', 'X'};
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kAlignment = 64;
+
+enum RecordKind : uint32_t {
+  kImageFrame = 1,
+  kTensor = 2,
+  kSerialized = 3,
+  kProto = 4,
+};
+
+struct RecordHeader {
+  int64_t timestamp;
+  uint32_t stream_index;
+  uint32_t kind;
+  uint32_t meta_size;
+  uint32_t reserved;
+  uint64_t data_size;
+};
+static_assert(sizeof(RecordHeader) == 32, "unexpected RecordHeader padding");
+
+struct IndexEntry {
+  int64_t timestamp;
+  uint64_t offset;
+  uint32_t stream_index;
+  uint32_t reserved;
+};
+static_assert(sizeof(IndexEntry) == 24, "unexpected IndexEntry padding");
+
+struct Trailer {
+  uint64_t index_offset;
+  uint64_t num_records;
+  char magic[8];
+};
+static_assert(sizeof(Trailer) == 24, "unexpected Trailer padding");
+
+struct ImageFrameMeta {
+  int32_t format;
+  int32_t width;
+  int32_t height;
+  int32_t width_step;
+};
+
+struct TensorMeta {
+  int32_t element_type;
+  int32_t zero_point;
+  float scale;
+  int32_t num_dims;
+};
+
+uint64_t AlignUp(uint64_t offset) {
+  return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+template <typename T>
+void AppendPod(const T& value, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Reads a T at `*offset` of `contents` and advances `*offset`.
+template <typename T>
+absl::Status ReadPod(absl::string_view contents, uint64_t* offset, T* value) {
+  RET_CHECK_LE(*offset + sizeof(T), contents.size())
+      << "Truncated packet log";
+  std::memcpy(value, contents.data() + *offset, sizeof(T));
+  *offset += sizeof(T);
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<PacketLogWriter>> PacketLogWriter::Create(
+    const std::string& path, const std::vector<std::string>& stream_names) {
+  FILE* file = fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Can't open file: " << path << ": " << strerror(errno);
+  }
+  auto writer = std::unique_ptr<PacketLogWriter>(
+      new PacketLogWriter(path, file, stream_names.size()));
+  std::string header(kLogMagic, sizeof(kLogMagic));
+  AppendPod(kVersion, &header);
+  AppendPod(static_cast<uint32_t>(stream_names.size()), &header);
+  for (const std::string& name : stream_names) {
+    AppendPod(static_cast<uint32_t>(name.size()), &header);
+    header.append(name);
+  }
+  MP_RETURN_IF_ERROR(writer->Write(header.data(), header.size()));
+  MP_RETURN_IF_ERROR(writer->Pad());
+  return writer;
+}
+
+PacketLogWriter::~PacketLogWriter() {
+  if (file_ != nullptr) {
+    absl::Status status = Close();
+    LOG_IF(ERROR, !status.ok()) << status;
+  }
+}
+
+absl::Status PacketLogWriter::Write(const void* data, size_t size) {
+  RET_CHECK(file_ != nullptr) << "Packet log is closed: " << path_;
+  if (size > 0 && fwrite(data, 1, size, file_) != size) {
+    return mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+           << "Can't write file: " << path_ << ": " << strerror(errno);
+  }
+  offset_ += size;
+  return absl::OkStatus();
+}
+
+absl::Status PacketLogWriter::Pad() {
+  static const char kZeros[kAlignment] = {};
+  return Write(kZeros, AlignUp(offset_) - offset_);
+}
+
+absl::Status PacketLogWriter::WriteRecord(
+    Timestamp timestamp, int stream_index, uint32_t kind,
+    const std::string& meta,
+    const std::vector<std::pair<const void*, size_t>>& data_chunks) {
+  RecordHeader header = {};
+  header.timestamp = timestamp.Value();
+  header.stream_index = stream_index;
+  header.kind = kind;
+  header.meta_size = meta.size();
+  for (const auto& chunk : data_chunks) header.data_size += chunk.second;
+
+  AppendPod(IndexEntry{header.timestamp, offset_,
+                       static_cast<uint32_t>(stream_index), 0},
+            &index_);
+  ++num_records_;
+  MP_RETURN_IF_ERROR(Write(&header, sizeof(header)));
+  MP_RETURN_IF_ERROR(Write(meta.data(), meta.size()));
+  MP_RETURN_IF_ERROR(Pad());
+  for (const auto& chunk : data_chunks) {
+    MP_RETURN_IF_ERROR(Write(chunk.first, chunk.second));
+  }
+  return Pad();
+}
+
+absl::Status PacketLogWriter::Append(int stream_index, const Packet& packet) {
+  RET_CHECK(stream_index >= 0 && stream_index < num_streams_)
+      << "Invalid stream index " << stream_index;
+  RET_CHECK(!packet.IsEmpty());
+  const Timestamp timestamp = packet.Timestamp();
+  RET_CHECK(timestamp.IsAllowedInStream())
+      << "Invalid timestamp " << timestamp.DebugString();
+  RET_CHECK(last_timestamp_ == Timestamp::Unset() ||
+            timestamp >= last_timestamp_)
+      << "Timestamp " << timestamp.DebugString() << " is before "
+      << last_timestamp_.DebugString();
+  last_timestamp_ = timestamp;
+
+  std::string meta;
+  if (packet.ValidateAsType<ImageFrame>().ok()) {
+    const auto& frame = packet.Get<ImageFrame>();
+    const int row_size =
+        frame.Width() * frame.NumberOfChannels() * frame.ByteDepth();
+    ImageFrameMeta image_meta = {frame.Format(), frame.Width(),
+                                 frame.Height(), row_size};
+    AppendPod(image_meta, &meta);
+    // Rows are stored without padding; one chunk if already contiguous.
+    std::vector<std::pair<const void*, size_t>> rows;
+    if (frame.IsContiguous()) {
+      rows.emplace_back(frame.PixelData(), frame.PixelDataSize());
+    } else {
+      for (int y = 0; y < frame.Height(); ++y) {
+        rows.emplace_back(frame.PixelData() + y * frame.WidthStep(),
+                          row_size);
+      }
+    }
+    return WriteRecord(timestamp, stream_index, kImageFrame, meta, rows);
+  }
+  if (packet.ValidateAsType<Tensor>().ok()) {
+    const auto& tensor = packet.Get<Tensor>();
+    const auto& dims = tensor.shape().dims;
+    TensorMeta tensor_meta = {
+        static_cast<int32_t>(tensor.element_type()),
+        tensor.quantization_parameters().zero_point,
+        tensor.quantization_parameters().scale,
+        static_cast<int32_t>(dims.size())};
+    AppendPod(tensor_meta, &meta);
+    for (int dim : dims) AppendPod(static_cast<int32_t>(dim), &meta);
+    auto view = tensor.GetCpuReadView();
+    return WriteRecord(timestamp, stream_index, kTensor, meta,
+                       {{view.buffer<uint8_t>(), tensor.bytes()}});
+  }
+  const MediaPipeTypeData* type_data =
+      PacketTypeIdToMediaPipeTypeData::GetValue(
+          packet.GetTypeId().hash_code());
+  if (type_data != nullptr && type_data->serialize_fn) {
+    std::string data;
+    MP_RETURN_IF_ERROR(
+        type_data->serialize_fn(*packet_internal::GetHolder(packet), &data));
+    return WriteRecord(timestamp, stream_index, kSerialized,
+                       type_data->type_string, {{data.data(), data.size()}});
+  }
+  if (packet.ValidateAsProtoMessageLite().ok()) {
+    const auto& message = packet.GetProtoMessageLite();
+    std::string data;
+    RET_CHECK(message.SerializeToString(&data));
+    return WriteRecord(timestamp, stream_index, kProto,
+                       message.GetTypeName(), {{data.data(), data.size()}});
+  }
+  return mediapipe::UnimplementedErrorBuilder(MEDIAPIPE_LOC)
+         << "Can't record packets of type " << packet.DebugTypeName();
+}
+
+absl::Status PacketLogWriter::Close() {
+  RET_CHECK(file_ != nullptr) << "Packet log is already closed: " << path_;
+  const uint64_t index_offset = offset_;
+  absl::Status status = Write(index_.data(), index_.size());
+  if (status.ok()) {
+    Trailer trailer = {index_offset, static_cast<uint64_t>(num_records_), {}};
+    std::memcpy(trailer.magic, kIndexMagic, sizeof(kIndexMagic));
+    status = Write(&trailer, sizeof(trailer));
+  }
+  if (fclose(file_) != 0 && status.ok()) {
+    status = mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+             << "Can't close file: " << path_ << ": " << strerror(errno);
+  }
+  file_ = nullptr;
+  return status;
+}
+
+absl::StatusOr<std::unique_ptr<PacketLogReader>> PacketLogReader::Open(
+    const std::string& path) {
+  ASSIGN_OR_RETURN(std::unique_ptr<MappedFile> file, MappedFile::Open(path));
+  auto reader = std::unique_ptr<PacketLogReader>(
+      new PacketLogReader(std::shared_ptr<MappedFile>(std::move(file))));
+  uint64_t records_offset;
+  MP_RETURN_IF_ERROR(reader->ReadHeader(&records_offset));
+  MP_RETURN_IF_ERROR(reader->ReadIndex(records_offset));
+  return reader;
+}
+
+absl::Status PacketLogReader::ReadHeader(uint64_t* records_offset) {
+  absl::string_view contents = file_->contents();
+  RET_CHECK(contents.size() >= sizeof(kLogMagic) &&
+            std::memcmp(contents.data(), kLogMagic, sizeof(kLogMagic)) == 0)
+      << "Not a packet log: " << file_->path();
+  uint64_t offset = sizeof(kLogMagic);
+  uint32_t version, num_streams;
+  MP_RETURN_IF_ERROR(ReadPod(contents, &offset, &version));
+  RET_CHECK_EQ(version, kVersion) << "Unsupported packet log version";
+  MP_RETURN_IF_ERROR(ReadPod(contents, &offset, &num_streams));
+  for (uint32_t i = 0; i < num_streams; ++i) {
+    uint32_t size;
+    MP_RETURN_IF_ERROR(ReadPod(contents, &offset, &size));
+    RET_CHECK_LE(offset + size, contents.size()) << "Truncated packet log";
+    stream_names_.emplace_back(contents.substr(offset, size));
+    offset += size;
+  }
+  *records_offset = AlignUp(offset);
+  return absl::OkStatus();
+}
+
+absl::Status PacketLogReader::ReadIndex(uint64_t records_offset) {
+  absl::string_view contents = file_->contents();
+  Trailer trailer;
+  if (contents.size() < records_offset + sizeof(trailer)) {
+    return ScanRecords(records_offset);
+  }
+  std::memcpy(&trailer, contents.data() + contents.size() - sizeof(trailer),
+              sizeof(trailer));
+  const uint64_t index_end = contents.size() - sizeof(trailer);
+  if (std::memcmp(trailer.magic, kIndexMagic, sizeof(kIndexMagic)) != 0 ||
+      trailer.index_offset < records_offset ||
+      trailer.index_offset > index_end ||
+      (index_end - trailer.index_offset) / sizeof(IndexEntry) !=
+          trailer.num_records) {
+    return ScanRecords(records_offset);
+  }
+  records_.reserve(trailer.num_records);
+  uint64_t offset = trailer.index_offset;
+  for (uint64_t i = 0; i < trailer.num_records; ++i) {
+    IndexEntry entry;
+    MP_RETURN_IF_ERROR(ReadPod(contents, &offset, &entry));
+    RET_CHECK_LT(entry.stream_index, stream_names_.size());
+    RET_CHECK(entry.offset >= records_offset &&
+              entry.offset < trailer.index_offset);
+    records_.push_back({Timestamp(entry.timestamp),
+                        static_cast<int>(entry.stream_index), entry.offset});
+  }
+  return absl::OkStatus();
+}
+
+absl::Status PacketLogReader::ScanRecords(uint64_t records_offset) {
+  index_rebuilt_ = true;
+  absl::string_view contents = file_->contents();
+  uint64_t offset = records_offset;
+  // Stops at the first incomplete record, which a crashed writer may leave.
+  while (offset + sizeof(RecordHeader) <= contents.size()) {
+    RecordHeader header;
+    std::memcpy(&header, contents.data() + offset, sizeof(header));
+    const uint64_t data_offset =
+        AlignUp(offset + sizeof(header) + header.meta_size);
+    if (header.stream_index >= stream_names_.size() ||
+        header.data_size > contents.size() ||
+        data_offset + header.data_size > contents.size()) {
+      break;
+    }
+    records_.push_back({Timestamp(header.timestamp),
+                        static_cast<int>(header.stream_index), offset});
+    offset = AlignUp(data_offset + header.data_size);
+  }
+  return absl::OkStatus();
+}
+
+size_t PacketLogReader::LowerBound(Timestamp timestamp) const {
+  return std::lower_bound(records_.begin(), records_.end(), timestamp,
+                          [](const Record& record, Timestamp t) {
+                            return record.timestamp < t;
+                          }) -
+         records_.begin();
+}
+
+absl::StatusOr<Packet> PacketLogReader::ReadPacket(size_t index) const {
+  RET_CHECK_LT(index, records_.size());
+  const Record& record = records_[index];
+  absl::string_view contents = file_->contents();
+  uint64_t offset = record.offset;
+  RecordHeader header;
+  MP_RETURN_IF_ERROR(ReadPod(contents, &offset, &header));
+  RET_CHECK_EQ(header.timestamp, record.timestamp.Value());
+  RET_CHECK_LE(offset + header.meta_size, contents.size())
+      << "Truncated packet log";
+  absl::string_view meta = contents.substr(offset, header.meta_size);
+  const uint64_t data_offset = AlignUp(offset + header.meta_size);
+  RET_CHECK(header.data_size <= contents.size() &&
+            data_offset + header.data_size <= contents.size())
+      << "Truncated packet log";
+  absl::string_view data = contents.substr(data_offset, header.data_size);
+
+  Packet packet;
+  switch (header.kind) {
+    case kImageFrame: {
+      ImageFrameMeta image_meta;
+      uint64_t meta_offset = 0;
+      MP_RETURN_IF_ERROR(ReadPod(meta, &meta_offset, &image_meta));
+      RET_CHECK_EQ(static_cast<uint64_t>(image_meta.height) *
+                       image_meta.width_step,
+                   data.size());
+      // The deleter keeps the mapping alive for as long as the frame.
+      std::shared_ptr<MappedFile> file = file_;
+      packet = Adopt(new ImageFrame(
+          static_cast<ImageFormat::Format>(image_meta.format),
+          image_meta.width, image_meta.height, image_meta.width_step,
+          reinterpret_cast<uint8*>(const_cast<char*>(data.data())),
+          [file](uint8*) {}));
+      break;
+    }
+    case kTensor: {
+      TensorMeta tensor_meta;
+      uint64_t meta_offset = 0;
+      MP_RETURN_IF_ERROR(ReadPod(meta, &meta_offset, &tensor_meta));
+      std::vector<int> dims(tensor_meta.num_dims);
+      for (int& dim : dims) {
+        int32_t value;
+        MP_RETURN_IF_ERROR(ReadPod(meta, &meta_offset, &value));
+        dim = value;
+      }
+      auto tensor = absl::make_unique<Tensor>(
+          static_cast<Tensor::ElementType>(tensor_meta.element_type),
+          Tensor::Shape(dims),
+          Tensor::QuantizationParameters(tensor_meta.scale,
+                                         tensor_meta.zero_point));
+      RET_CHECK_EQ(static_cast<uint64_t>(tensor->bytes()), data.size());
+      {
+        auto view = tensor->GetCpuWriteView();
+        std::memcpy(view.buffer<uint8_t>(), data.data(), data.size());
+      }
+      packet = Adopt(tensor.release());
+      break;
+    }
+    case kSerialized: {
+      const std::string type_string(meta);
+      const MediaPipeTypeData* type_data =
+          PacketTypeStringToMediaPipeTypeData::GetValue(type_string);
+      RET_CHECK(type_data != nullptr && type_data->deserialize_fn)
+          << "No deserialization function registered for " << type_string;
+      std::unique_ptr<packet_internal::HolderBase> holder;
+      MP_RETURN_IF_ERROR(
+          type_data->deserialize_fn(std::string(data), &holder));
+      packet = packet_internal::Create(holder.release());
+      break;
+    }
+    case kProto: {
+      ASSIGN_OR_RETURN(packet, packet_internal::PacketFromDynamicProto(
+                                   std::string(meta), std::string(data)));
+      break;
+    }
+    default:
+      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+             << "Unknown packet log record kind " << header.kind;
+  }
+  return packet.At(record.timestamp);
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,154 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_PACKET_LOG_H_
+#define MEDIAPIPE_UTIL_PACKET_LOG_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/timestamp.h"
+#include "mediapipe/util/mapped_file.h"
+
+namespace mediapipe {
+
+// A packet log is an append-only file of timestamped packets from a fixed set
+// of named streams, followed by a timestamp index. It is meant for recording
+// the real inputs of a graph once and replaying them many times, e.g. to
+// reproduce a performance problem offline without re-decoding video.
+//
+// Supported payloads are ImageFrame, Tensor, types registered with
+// serialization functions (see MEDIAPIPE_REGISTER_TYPE) and protobuf messages.
+// Every payload starts on a 64-byte boundary of the file, so replayed
+// ImageFrames can point straight into the memory-mapped log.
+//
+// Layout (integers in host byte order):
+//   file header:  "MPPKTLOG", uint32 version, uint32 num_streams,
+//                 num_streams x {uint32 size, name bytes}
+//   record:       int64 timestamp, uint32 stream_index, uint32 kind,
+//                 uint32 meta_size, uint32 reserved, uint64 data_size,
+//                 meta bytes, data bytes
+//   index:        num_records x {int64 timestamp, uint64 offset,
+//                 uint32 stream_index, uint32 reserved}
+//   trailer:      uint64 index_offset, uint64 num_records, "MPPKTIDX"
+// The header, every record and its data are padded to 64 bytes. The index and
+// trailer are written by Close(); a log without them, e.g. from a crashed
+// recorder, is still readable and its index is rebuilt by scanning.
+
+// Writes a packet log. Not thread-safe.
+//
+// Example:
+//   ASSIGN_OR_RETURN(auto writer,
+//                    PacketLogWriter::Create(path, {"input_video"}));
+//   MP_RETURN_IF_ERROR(writer->Append(0, packet));
+//   MP_RETURN_IF_ERROR(writer->Close());
+class PacketLogWriter {
+ public:
+  static absl::StatusOr<std::unique_ptr<PacketLogWriter>> Create(
+      const std::string& path, const std::vector<std::string>& stream_names);
+
+  PacketLogWriter(const PacketLogWriter&) = delete;
+  PacketLogWriter& operator=(const PacketLogWriter&) = delete;
+  // Closes the log if Close() was not called; errors are logged.
+  ~PacketLogWriter();
+
+  // Appends `packet` to the stream with index `stream_index`. Timestamps must
+  // not decrease across the whole log, which holds for packets appended in
+  // the order a calculator receives them.
+  absl::Status Append(int stream_index, const Packet& packet);
+
+  // Writes the index and closes the file.
+  absl::Status Close();
+
+  int64_t num_records() const { return num_records_; }
+
+ private:
+  PacketLogWriter(std::string path, FILE* file, int num_streams)
+      : path_(std::move(path)), file_(file), num_streams_(num_streams) {}
+
+  absl::Status Write(const void* data, size_t size);
+  absl::Status Pad();
+  absl::Status WriteRecord(Timestamp timestamp, int stream_index,
+                           uint32_t kind, const std::string& meta,
+                           const std::vector<std::pair<const void*, size_t>>&
+                               data_chunks);
+
+  std::string path_;
+  FILE* file_;
+  int num_streams_;
+  uint64_t offset_ = 0;
+  Timestamp last_timestamp_ = Timestamp::Unset();
+  // Serialized index entries, written out by Close().
+  std::string index_;
+  int64_t num_records_ = 0;
+};
+
+// Reads a packet log through a memory mapping.
+//
+// ImageFrame payloads are not copied: the replayed ImageFrame points into the
+// read-only mapping, which stays alive until the last such packet is gone.
+// Such packets must not be consumed and written to in place. Tensor payloads
+// are copied, as a Tensor cannot wrap external memory.
+class PacketLogReader {
+ public:
+  struct Record {
+    Timestamp timestamp;
+    int stream_index;
+    uint64_t offset;
+  };
+
+  static absl::StatusOr<std::unique_ptr<PacketLogReader>> Open(
+      const std::string& path);
+
+  const std::vector<std::string>& stream_names() const {
+    return stream_names_;
+  }
+  // All records, in nondecreasing timestamp order.
+  const std::vector<Record>& records() const { return records_; }
+  // Whether the index was rebuilt because the log was not closed.
+  bool index_rebuilt() const { return index_rebuilt_; }
+
+  // Returns the index of the first record at or after `timestamp`.
+  size_t LowerBound(Timestamp timestamp) const;
+
+  // Returns the packet of record `index`, with its timestamp set.
+  absl::StatusOr<Packet> ReadPacket(size_t index) const;
+
+  // See MappedFile::Prefetch().
+  void Prefetch() const { file_->Prefetch(); }
+
+ private:
+  explicit PacketLogReader(std::shared_ptr<MappedFile> file)
+      : file_(std::move(file)) {}
+
+  absl::Status ReadHeader(uint64_t* records_offset);
+  absl::Status ReadIndex(uint64_t records_offset);
+  absl::Status ScanRecords(uint64_t records_offset);
+
+  std::shared_ptr<MappedFile> file_;
+  std::vector<std::string> stream_names_;
+  std::vector<Record> records_;
+  bool index_rebuilt_ = false;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_PACKET_LOG_H_
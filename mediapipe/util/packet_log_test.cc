@@ -0,0 +1,187 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/packet_log.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/type_map.h"
+
+namespace mediapipe {
+
+struct PacketLogTestValue {
+  std::string text;
+};
+
+namespace {
+
+absl::Status SerializeTestValue(const packet_internal::HolderBase& holder,
+                                std::string* output) {
+  *output = holder.As<PacketLogTestValue>()->data().text;
+  return absl::OkStatus();
+}
+
+absl::Status DeserializeTestValue(
+    const std::string& encoding,
+    std::unique_ptr<packet_internal::HolderBase>* holder) {
+  *holder = absl::make_unique<packet_internal::Holder<PacketLogTestValue>>(
+      new PacketLogTestValue{encoding});
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+MEDIAPIPE_REGISTER_TYPE(mediapipe::PacketLogTestValue,
+                        "::mediapipe::PacketLogTestValue", SerializeTestValue,
+                        DeserializeTestValue);
+
+namespace {
+
+std::string LogPath(const std::string& name) {
+  return file::JoinPath(::testing::TempDir(), name);
+}
+
+std::unique_ptr<ImageFrame> MakeFrame(int width, int height) {
+  // The 16-byte alignment pads the rows, which the log must strip.
+  auto frame = absl::make_unique<ImageFrame>(ImageFormat::SRGB, width, height,
+                                             /*alignment_boundary=*/16);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width * 3; ++x) {
+      frame->MutablePixelData()[y * frame->WidthStep() + x] = y * 31 + x;
+    }
+  }
+  return frame;
+}
+
+TEST(PacketLogTest, RoundTripsPayloads) {
+  const std::string path = LogPath("packet_log_test.log");
+  Detection detection;
+  detection.add_label("cat");
+  detection.add_score(0.5f);
+  {
+    MP_ASSERT_OK_AND_ASSIGN(auto writer,
+                            PacketLogWriter::Create(path, {"video", "other"}));
+    MP_ASSERT_OK(writer->Append(0, Adopt(MakeFrame(5, 3).release())
+                                       .At(Timestamp(10))));
+    auto tensor = absl::make_unique<Tensor>(
+        Tensor::ElementType::kFloat32, Tensor::Shape{2, 3},
+        Tensor::QuantizationParameters(0.25f, 3));
+    {
+      float* values = tensor->GetCpuWriteView().buffer<float>();
+      for (int i = 0; i < 6; ++i) values[i] = i * 1.5f;
+    }
+    MP_ASSERT_OK(
+        writer->Append(1, Adopt(tensor.release()).At(Timestamp(10))));
+    MP_ASSERT_OK(writer->Append(
+        1, MakePacket<PacketLogTestValue>(PacketLogTestValue{"hello"})
+               .At(Timestamp(20))));
+    MP_ASSERT_OK(writer->Append(
+        0, MakePacket<Detection>(detection).At(Timestamp(30))));
+    EXPECT_FALSE(
+        writer->Append(0, MakePacket<Detection>(detection).At(Timestamp(29)))
+            .ok());
+    MP_ASSERT_OK(writer->Close());
+  }
+
+  Packet frame_packet;
+  {
+    MP_ASSERT_OK_AND_ASSIGN(auto reader, PacketLogReader::Open(path));
+    EXPECT_FALSE(reader->index_rebuilt());
+    EXPECT_THAT(reader->stream_names(),
+                testing::ElementsAre("video", "other"));
+    ASSERT_EQ(reader->records().size(), 4);
+    EXPECT_EQ(reader->records()[1].stream_index, 1);
+    EXPECT_EQ(reader->LowerBound(Timestamp(15)), 2);
+    EXPECT_EQ(reader->LowerBound(Timestamp(31)), 4);
+
+    MP_ASSERT_OK_AND_ASSIGN(frame_packet, reader->ReadPacket(0));
+    MP_ASSERT_OK_AND_ASSIGN(Packet tensor_packet, reader->ReadPacket(1));
+    const auto& tensor = tensor_packet.Get<Tensor>();
+    EXPECT_EQ(tensor_packet.Timestamp(), Timestamp(10));
+    EXPECT_THAT(tensor.shape().dims, testing::ElementsAre(2, 3));
+    EXPECT_EQ(tensor.quantization_parameters().zero_point, 3);
+    EXPECT_EQ(tensor.GetCpuReadView().buffer<float>()[5], 7.5f);
+
+    MP_ASSERT_OK_AND_ASSIGN(Packet value_packet, reader->ReadPacket(2));
+    EXPECT_EQ(value_packet.Get<PacketLogTestValue>().text, "hello");
+    MP_ASSERT_OK_AND_ASSIGN(Packet detection_packet, reader->ReadPacket(3));
+    EXPECT_EQ(detection_packet.Timestamp(), Timestamp(30));
+    EXPECT_EQ(detection_packet.Get<Detection>().label(0), "cat");
+  }
+
+  // The frame points into the mapping, which outlives the reader.
+  const auto& frame = frame_packet.Get<ImageFrame>();
+  EXPECT_EQ(frame_packet.Timestamp(), Timestamp(10));
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(frame.PixelData()) % 64, 0);
+  auto expected = MakeFrame(5, 3);
+  ASSERT_EQ(frame.Width(), 5);
+  ASSERT_EQ(frame.Height(), 3);
+  EXPECT_EQ(frame.WidthStep(), 15);
+  for (int y = 0; y < 3; ++y) {
+    EXPECT_EQ(std::memcmp(frame.PixelData() + y * frame.WidthStep(),
+                          expected->PixelData() + y * expected->WidthStep(),
+                          15),
+              0);
+  }
+}
+
+TEST(PacketLogTest, RebuildsIndexOfUnclosedLog) {
+  const std::string path = LogPath("packet_log_test_unclosed.log");
+  {
+    MP_ASSERT_OK_AND_ASSIGN(auto writer,
+                            PacketLogWriter::Create(path, {"video"}));
+    for (int i = 0; i < 3; ++i) {
+      MP_ASSERT_OK(writer->Append(
+          0, Adopt(MakeFrame(4, 4).release()).At(Timestamp(i))));
+    }
+    MP_ASSERT_OK(writer->Close());
+  }
+  // Drop the index and cut the last record short.
+  std::string contents;
+  MP_ASSERT_OK(file::GetContents(path, &contents));
+  uint64_t last_offset;
+  {
+    MP_ASSERT_OK_AND_ASSIGN(auto reader, PacketLogReader::Open(path));
+    last_offset = reader->records()[2].offset;
+  }
+  MP_ASSERT_OK(file::SetContents(path, contents.substr(0, last_offset + 40)));
+
+  MP_ASSERT_OK_AND_ASSIGN(auto reader, PacketLogReader::Open(path));
+  EXPECT_TRUE(reader->index_rebuilt());
+  ASSERT_EQ(reader->records().size(), 2);
+  MP_ASSERT_OK_AND_ASSIGN(Packet packet, reader->ReadPacket(1));
+  EXPECT_EQ(packet.Timestamp(), Timestamp(1));
+  EXPECT_EQ(packet.Get<ImageFrame>().Width(), 4);
+}
+
+TEST(PacketLogTest, FailsOnOtherFiles) {
+  const std::string path = LogPath("packet_log_test_other.log");
+  MP_ASSERT_OK(file::SetContents(path, "not a packet log"));
+  EXPECT_FALSE(PacketLogReader::Open(path).ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
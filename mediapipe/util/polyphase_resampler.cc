@@ -0,0 +1,279 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/util/polyphase_resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <tuple>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+namespace {
+
+// Filters are cached by sample rates and params for as long as a resampler
+// uses them.
+using FiltersKey = std::tuple<double, double, double, double, double, int>;
+
+absl::Mutex filters_cache_mutex(absl::kConstInit);
+
+std::map<FiltersKey, std::weak_ptr<const PolyphaseFilters>>& FiltersCache()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(filters_cache_mutex) {
+  static auto* cache =
+      new std::map<FiltersKey, std::weak_ptr<const PolyphaseFilters>>();
+  return *cache;
+}
+
+// Approximates value by the continued fraction convergent
+// numerator / denominator with the largest denominator not exceeding
+// max_denominator.
+void RationalApproximation(double value, int max_denominator, int* numerator,
+                           int* denominator) {
+  int64 h0 = 0, h1 = 1;
+  int64 k0 = 1, k1 = 0;
+  double x = value;
+  for (int i = 0; i < 64; ++i) {
+    const double a = std::floor(x);
+    const int64 h2 = static_cast<int64>(a) * h1 + h0;
+    const int64 k2 = static_cast<int64>(a) * k1 + k0;
+    if (k2 > max_denominator) break;
+    h0 = h1;
+    h1 = h2;
+    k0 = k1;
+    k1 = k2;
+    const double remainder = x - a;
+    if (remainder < 1e-9 ||
+        std::abs(value - static_cast<double>(h1) / k1) < 1e-12 * value) {
+      break;
+    }
+    x = 1.0 / remainder;
+  }
+  *numerator = static_cast<int>(h1);
+  *denominator = static_cast<int>(k1);
+}
+
+// Zeroth-order modified Bessel function of the first kind.
+double BesselI0(double x) {
+  const double half_x_squared = 0.25 * x * x;
+  double term = 1.0;
+  double sum = 1.0;
+  for (int k = 1; term > 1e-12 * sum; ++k) {
+    term *= half_x_squared / (static_cast<double>(k) * k);
+    sum += term;
+  }
+  return sum;
+}
+
+double Sinc(double x) {
+  if (std::abs(x) < 1e-9) return 1.0;
+  return std::sin(M_PI * x) / (M_PI * x);
+}
+
+}  // namespace
+
+// static
+absl::StatusOr<std::shared_ptr<const PolyphaseFilters>> PolyphaseFilters::Get(
+    double input_sample_rate, double output_sample_rate,
+    const PolyphaseResamplerParams& params) {
+  const FiltersKey key(input_sample_rate, output_sample_rate,
+                       params.filter_radius_factor, params.cutoff_proportion,
+                       params.kaiser_beta, params.max_denominator);
+  absl::MutexLock lock(&filters_cache_mutex);
+  auto& cache = FiltersCache();
+  auto it = cache.find(key);
+  if (it != cache.end()) {
+    if (auto filters = it->second.lock()) return filters;
+  }
+  auto filters = Design(input_sample_rate, output_sample_rate, params);
+  if (!filters.ok()) return filters.status();
+  // Drops the entries of filters that are no longer used.
+  for (auto entry = cache.begin(); entry != cache.end();) {
+    entry = entry->second.expired() ? cache.erase(entry) : std::next(entry);
+  }
+  cache[key] = *filters;
+  return filters;
+}
+
+// static
+absl::StatusOr<std::shared_ptr<const PolyphaseFilters>>
+PolyphaseFilters::Design(double input_sample_rate, double output_sample_rate,
+                         const PolyphaseResamplerParams& params) {
+  if (!(input_sample_rate > 0.0) || !(output_sample_rate > 0.0)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Sample rates must be positive, got ", input_sample_rate,
+                     " and ", output_sample_rate, "."));
+  }
+  if (!(params.filter_radius_factor > 0.0) ||
+      !(params.cutoff_proportion > 0.0 && params.cutoff_proportion <= 1.0) ||
+      !(params.kaiser_beta >= 0.0) || params.max_denominator < 1) {
+    return absl::InvalidArgumentError("Invalid resampler params.");
+  }
+  const double factor = output_sample_rate / input_sample_rate;
+  int upsampling_factor;
+  int downsampling_factor;
+  RationalApproximation(factor, params.max_denominator, &upsampling_factor,
+                        &downsampling_factor);
+  if (upsampling_factor < 1) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Resampling factor ", factor, " is too small for max_denominator ",
+        params.max_denominator, "."));
+  }
+
+  // The kernel is designed in units of input samples, so when downsampling
+  // it is stretched by the downsampling factor.
+  const double stretch = std::max(1.0, 1.0 / factor);
+  const double radius = params.filter_radius_factor * stretch;
+  const double cutoff = 0.5 * params.cutoff_proportion / stretch;
+  const int num_radius_taps = static_cast<int>(std::ceil(radius));
+  const int num_taps = 2 * num_radius_taps;
+  const double kaiser_normalization = 1.0 / BesselI0(params.kaiser_beta);
+
+  Matrix phases(num_taps, upsampling_factor);
+  for (int p = 0; p < upsampling_factor; ++p) {
+    double sum = 0.0;
+    for (int k = 0; k < num_taps; ++k) {
+      // The distance from tap k to the output sample of phase p.
+      const double tau = static_cast<double>(p) / upsampling_factor +
+                         num_radius_taps - 1 - k;
+      const double x = tau / radius;
+      double value = 0.0;
+      if (std::abs(x) < 1.0) {
+        value = 2.0 * cutoff * Sinc(2.0 * cutoff * tau) *
+                BesselI0(params.kaiser_beta * std::sqrt(1.0 - x * x)) *
+                kaiser_normalization;
+      }
+      phases(k, p) = value;
+      sum += value;
+    }
+    // Normalizes every phase to unit DC gain, so that constant signals are
+    // resampled exactly.
+    phases.col(p) /= sum;
+  }
+  return std::shared_ptr<const PolyphaseFilters>(
+      new PolyphaseFilters(upsampling_factor, downsampling_factor,
+                           num_radius_taps, std::move(phases)));
+}
+
+// static
+absl::StatusOr<std::unique_ptr<PolyphaseResampler>> PolyphaseResampler::Create(
+    double input_sample_rate, double output_sample_rate, int num_channels,
+    const PolyphaseResamplerParams& params) {
+  if (num_channels < 1) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("num_channels must be positive, got ", num_channels, "."));
+  }
+  auto filters =
+      PolyphaseFilters::Get(input_sample_rate, output_sample_rate, params);
+  if (!filters.ok()) return filters.status();
+  return std::unique_ptr<PolyphaseResampler>(
+      new PolyphaseResampler(*std::move(filters), num_channels));
+}
+
+PolyphaseResampler::PolyphaseResampler(
+    std::shared_ptr<const PolyphaseFilters> filters, int num_channels)
+    : filters_(std::move(filters)), num_channels_(num_channels) {
+  Reset();
+}
+
+void PolyphaseResampler::Reset() {
+  // The first output samples reach radius() - 1 samples before the input,
+  // which are zeros.
+  const int num_leading_zeros = filters_->radius() - 1;
+  buffer_.setZero(num_channels_,
+                  std::max<Eigen::Index>(buffer_.cols(), num_leading_zeros));
+  num_buffered_ = num_leading_zeros;
+  buffer_offset_ = -num_leading_zeros;
+  num_input_samples_ = 0;
+  next_output_ = 0;
+}
+
+void PolyphaseResampler::ProcessSamples(const Matrix& input, Matrix* output) {
+  CHECK_EQ(input.rows(), num_channels_);
+  Append(input);
+  num_input_samples_ += input.cols();
+  // Output sample n needs the input samples up to floor(n * M / L) + radius().
+  const int64 num_complete_inputs = num_input_samples_ - filters_->radius();
+  int64 end_output = 0;
+  if (num_complete_inputs > 0) {
+    end_output = (num_complete_inputs * filters_->upsampling_factor() +
+                  filters_->downsampling_factor() - 1) /
+                 filters_->downsampling_factor();
+  }
+  Resample(std::max(end_output, next_output_), output);
+}
+
+void PolyphaseResampler::Flush(Matrix* output) {
+  Append(Matrix::Zero(num_channels_, filters_->radius()));
+  // Stops at the last output sample within the input.
+  const int64 end_output =
+      (num_input_samples_ * filters_->upsampling_factor() +
+       filters_->downsampling_factor() - 1) /
+      filters_->downsampling_factor();
+  Resample(std::max(end_output, next_output_), output);
+  Reset();
+}
+
+void PolyphaseResampler::Append(const Matrix& input) {
+  const int num_needed = num_buffered_ + input.cols();
+  if (num_needed > buffer_.cols()) {
+    const Eigen::Index capacity =
+        std::max<Eigen::Index>(num_needed, 2 * buffer_.cols());
+    buffer_.conservativeResize(Eigen::NoChange, capacity);
+  }
+  buffer_.middleCols(num_buffered_, input.cols()) = input;
+  num_buffered_ = num_needed;
+}
+
+void PolyphaseResampler::Resample(int64 end_output, Matrix* output) {
+  const int upsampling_factor = filters_->upsampling_factor();
+  const int downsampling_factor = filters_->downsampling_factor();
+  const int radius = filters_->radius();
+  const int num_taps = filters_->num_taps();
+  const Matrix& phases = filters_->phases();
+
+  output->resize(num_channels_, end_output - next_output_);
+  for (int64 n = next_output_; n < end_output; ++n) {
+    const int64 position = n * downsampling_factor;
+    const int64 first_input = position / upsampling_factor - radius + 1;
+    const int phase = position % upsampling_factor;
+    // The channels of each sample are contiguous, so this is one
+    // matrix-vector product over all channels.
+    output->col(n - next_output_).noalias() =
+        buffer_.middleCols(first_input - buffer_offset_, num_taps) *
+        phases.col(phase);
+  }
+  next_output_ = end_output;
+
+  // Drops the input samples before the first one of the next output sample.
+  const int64 next_first_input =
+      next_output_ * downsampling_factor / upsampling_factor - radius + 1;
+  const int num_dropped = static_cast<int>(std::min<int64>(
+      std::max<int64>(next_first_input - buffer_offset_, 0), num_buffered_));
+  if (num_dropped > 0) {
+    const int num_kept = num_buffered_ - num_dropped;
+    std::copy(buffer_.data() + num_dropped * num_channels_,
+              buffer_.data() + num_buffered_ * num_channels_, buffer_.data());
+    num_buffered_ = num_kept;
+    buffer_offset_ += num_dropped;
+  }
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,142 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MEDIAPIPE_UTIL_POLYPHASE_RESAMPLER_H_
+#define MEDIAPIPE_UTIL_POLYPHASE_RESAMPLER_H_
+
+#include <memory>
+
+#include "absl/status/statusor.h"
+#include "mediapipe/framework/formats/matrix.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// Parameters of the resampling filter, with the meaning and defaults of
+// audio_dsp::QResamplerParams.
+struct PolyphaseResamplerParams {
+  // Kernel radius in units of input samples when upsampling, or of output
+  // samples when downsampling.
+  double filter_radius_factor = 5.0;
+  // Anti-aliasing cutoff frequency as a proportion of the Nyquist frequency
+  // of the lower of the two sample rates.
+  double cutoff_proportion = 0.9;
+  // The Kaiser beta parameter for the kernel window.
+  double kaiser_beta = 5.658;
+  // The resampling factor is approximated by a rational with at most this
+  // denominator, which is also the maximum number of filter phases.
+  int max_denominator = 1000;
+};
+
+// The filter phases of a resampling factor. They only depend on the sample
+// rates and the params, so they are designed once and shared by every
+// resampler with the same ones.
+class PolyphaseFilters {
+ public:
+  // Returns the filters for resampling from input_sample_rate to
+  // output_sample_rate, designing them unless a resampler that is still alive
+  // already uses them.
+  static absl::StatusOr<std::shared_ptr<const PolyphaseFilters>> Get(
+      double input_sample_rate, double output_sample_rate,
+      const PolyphaseResamplerParams& params);
+
+  // The resampling factor output_sample_rate / input_sample_rate is
+  // upsampling_factor() / downsampling_factor().
+  int upsampling_factor() const { return upsampling_factor_; }
+  int downsampling_factor() const { return downsampling_factor_; }
+
+  // The kernel reaches radius() input samples on each side of an output
+  // sample, so each output sample is the dot product of num_taps() =
+  // 2 * radius() input samples with a phase of the filter.
+  int radius() const { return radius_; }
+  int num_taps() const { return 2 * radius_; }
+
+  // The phases, one per column. Output sample n is interpolated from the
+  // input samples floor(n * downsampling_factor() / upsampling_factor()) -
+  // radius() + 1 onwards, with phase (n * downsampling_factor()) %
+  // upsampling_factor().
+  const Matrix& phases() const { return phases_; }
+
+ private:
+  PolyphaseFilters(int upsampling_factor, int downsampling_factor,
+                   int radius, Matrix phases)
+      : upsampling_factor_(upsampling_factor),
+        downsampling_factor_(downsampling_factor),
+        radius_(radius),
+        phases_(std::move(phases)) {}
+
+  static absl::StatusOr<std::shared_ptr<const PolyphaseFilters>> Design(
+      double input_sample_rate, double output_sample_rate,
+      const PolyphaseResamplerParams& params);
+
+  const int upsampling_factor_;
+  const int downsampling_factor_;
+  const int radius_;
+  const Matrix phases_;
+};
+
+// Streaming rational-factor resampler for multichannel signals, a
+// polyphase Kaiser-windowed sinc filter.
+//
+// Signals are matrices with one row per channel and one column per sample,
+// so the channels of each sample are interleaved in memory and every output
+// sample of all channels is a single matrix-vector product. Output sample n
+// is aligned with input time n / output_sample_rate, and the resampler waits
+// for radius() input samples past it before emitting it.
+class PolyphaseResampler {
+ public:
+  static absl::StatusOr<std::unique_ptr<PolyphaseResampler>> Create(
+      double input_sample_rate, double output_sample_rate, int num_channels,
+      const PolyphaseResamplerParams& params = PolyphaseResamplerParams());
+
+  // Appends the input samples and replaces output with all the output
+  // samples they complete.
+  void ProcessSamples(const Matrix& input, Matrix* output);
+
+  // Replaces output with the remaining output samples, up to the end of the
+  // input, assuming zeros after it, and resets the resampler.
+  void Flush(Matrix* output);
+
+  // Discards the buffered input, to start resampling a new signal.
+  void Reset();
+
+  int num_channels() const { return num_channels_; }
+
+ private:
+  PolyphaseResampler(std::shared_ptr<const PolyphaseFilters> filters,
+                     int num_channels);
+
+  // Computes the output samples up to, excluding, end_output, and drops the
+  // input samples that no later output sample needs.
+  void Resample(int64 end_output, Matrix* output);
+
+  void Append(const Matrix& input);
+
+  const std::shared_ptr<const PolyphaseFilters> filters_;
+  const int num_channels_;
+  // The buffered input samples. Column 0 is input sample buffer_offset_, and
+  // the columns past num_buffered_ are unused capacity.
+  Matrix buffer_;
+  int num_buffered_ = 0;
+  int64 buffer_offset_ = 0;
+  // The total number of input samples, and the index of the next output
+  // sample.
+  int64 num_input_samples_ = 0;
+  int64 next_output_ = 0;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_POLYPHASE_RESAMPLER_H_
@@ -0,0 +1,172 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/util/polyphase_resampler.h"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "Eigen/Core"
+#include "mediapipe/framework/formats/matrix.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+// Resamples input packet by packet, packet_size samples at a time, and
+// flushes at the end.
+Matrix ResampleInPackets(PolyphaseResampler* resampler, const Matrix& input,
+                         int packet_size) {
+  Matrix result(input.rows(), 0);
+  Matrix output;
+  auto append = [&result, &output]() {
+    result.conservativeResize(Eigen::NoChange, result.cols() + output.cols());
+    result.rightCols(output.cols()) = output;
+  };
+  for (int start = 0; start < input.cols(); start += packet_size) {
+    const int size = std::min<int>(packet_size, input.cols() - start);
+    resampler->ProcessSamples(input.middleCols(start, size), &output);
+    append();
+  }
+  resampler->Flush(&output);
+  append();
+  return result;
+}
+
+Matrix Sinusoids(int num_channels, int num_samples, double sample_rate) {
+  Matrix signal(num_channels, num_samples);
+  for (int c = 0; c < num_channels; ++c) {
+    const double frequency = 300.0 * (c + 1);
+    for (int n = 0; n < num_samples; ++n) {
+      signal(c, n) = std::sin(2 * M_PI * frequency * n / sample_rate + c);
+    }
+  }
+  return signal;
+}
+
+TEST(PolyphaseResamplerTest, OutputsOneSamplePerOutputPeriod) {
+  for (const auto& rates : std::vector<std::pair<double, double>>{
+           {48000, 16000}, {16000, 48000}, {44100, 16000}, {4000, 7600}}) {
+    MP_ASSERT_OK_AND_ASSIGN(auto resampler,
+                            PolyphaseResampler::Create(rates.first,
+                                                       rates.second, 1));
+    const Matrix output =
+        ResampleInPackets(resampler.get(), Matrix::Ones(1, 1001), 160);
+    EXPECT_EQ(output.cols(), std::ceil(1001 * rates.second / rates.first))
+        << rates.first << " -> " << rates.second;
+  }
+}
+
+TEST(PolyphaseResamplerTest, PreservesConstantSignals) {
+  MP_ASSERT_OK_AND_ASSIGN(auto resampler,
+                          PolyphaseResampler::Create(44100, 16000, 2));
+  Matrix input(2, 4410);
+  input.row(0).setConstant(1.0f);
+  input.row(1).setConstant(-0.5f);
+  const Matrix output = ResampleInPackets(resampler.get(), input, 441);
+  // Away from the edges, where the signal is zero-padded.
+  for (int n = 100; n < output.cols() - 100; ++n) {
+    EXPECT_NEAR(output(0, n), 1.0f, 1e-4) << n;
+    EXPECT_NEAR(output(1, n), -0.5f, 1e-4) << n;
+  }
+}
+
+TEST(PolyphaseResamplerTest, ResamplesSinusoids) {
+  constexpr double kInputRate = 48000;
+  constexpr double kOutputRate = 16000;
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto resampler, PolyphaseResampler::Create(kInputRate, kOutputRate, 3));
+  const Matrix output = ResampleInPackets(
+      resampler.get(), Sinusoids(3, 4800, kInputRate), 480);
+  const Matrix expected = Sinusoids(3, output.cols(), kOutputRate);
+  for (int n = 100; n < output.cols() - 100; ++n) {
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_NEAR(output(c, n), expected(c, n), 2e-3) << c << ", " << n;
+    }
+  }
+}
+
+TEST(PolyphaseResamplerTest, PacketSizeDoesNotChangeOutput) {
+  const Matrix input = Sinusoids(2, 3000, 16000);
+  MP_ASSERT_OK_AND_ASSIGN(auto resampler,
+                          PolyphaseResampler::Create(16000, 22050, 2));
+  const Matrix expected = ResampleInPackets(resampler.get(), input, 3000);
+  for (int packet_size : {1, 7, 160, 1024}) {
+    const Matrix output = ResampleInPackets(resampler.get(), input,
+                                            packet_size);
+    ASSERT_EQ(output.cols(), expected.cols()) << packet_size;
+    EXPECT_TRUE(output.isApprox(expected, 1e-6f)) << packet_size;
+  }
+}
+
+TEST(PolyphaseResamplerTest, MatchesSingleChannelResampling) {
+  const Matrix input = Sinusoids(3, 2000, 48000);
+  MP_ASSERT_OK_AND_ASSIGN(auto resampler,
+                          PolyphaseResampler::Create(48000, 16000, 3));
+  const Matrix output = ResampleInPackets(resampler.get(), input, 480);
+  for (int c = 0; c < 3; ++c) {
+    MP_ASSERT_OK_AND_ASSIGN(auto channel_resampler,
+                            PolyphaseResampler::Create(48000, 16000, 1));
+    const Matrix channel_output =
+        ResampleInPackets(channel_resampler.get(), input.row(c), 480);
+    EXPECT_TRUE(channel_output.isApprox(output.row(c), 1e-6f)) << c;
+  }
+}
+
+TEST(PolyphaseResamplerTest, SharesFilters) {
+  PolyphaseResamplerParams params;
+  MP_ASSERT_OK_AND_ASSIGN(auto filters,
+                          PolyphaseFilters::Get(48000, 16000, params));
+  MP_ASSERT_OK_AND_ASSIGN(auto same_filters,
+                          PolyphaseFilters::Get(48000, 16000, params));
+  EXPECT_EQ(filters, same_filters);
+  EXPECT_EQ(filters->upsampling_factor(), 1);
+  EXPECT_EQ(filters->downsampling_factor(), 3);
+
+  params.kaiser_beta = 8.0;
+  MP_ASSERT_OK_AND_ASSIGN(auto other_filters,
+                          PolyphaseFilters::Get(48000, 16000, params));
+  EXPECT_NE(filters, other_filters);
+}
+
+TEST(PolyphaseResamplerTest, ApproximatesResamplingFactor) {
+  PolyphaseResamplerParams params;
+  MP_ASSERT_OK_AND_ASSIGN(auto filters,
+                          PolyphaseFilters::Get(44100, 16000, params));
+  EXPECT_EQ(filters->upsampling_factor(), 160);
+  EXPECT_EQ(filters->downsampling_factor(), 441);
+
+  params.max_denominator = 100;
+  MP_ASSERT_OK_AND_ASSIGN(filters, PolyphaseFilters::Get(44100, 16000, params));
+  EXPECT_LE(filters->downsampling_factor(), 100);
+  EXPECT_NEAR(static_cast<double>(filters->upsampling_factor()) /
+                  filters->downsampling_factor(),
+              16000.0 / 44100, 1e-3);
+}
+
+TEST(PolyphaseResamplerTest, RejectsInvalidArguments) {
+  EXPECT_FALSE(PolyphaseResampler::Create(0, 16000, 1).ok());
+  EXPECT_FALSE(PolyphaseResampler::Create(16000, -1, 1).ok());
+  EXPECT_FALSE(PolyphaseResampler::Create(16000, 8000, 0).ok());
+  PolyphaseResamplerParams params;
+  params.cutoff_proportion = 1.5;
+  EXPECT_FALSE(PolyphaseResampler::Create(16000, 8000, 1, params).ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
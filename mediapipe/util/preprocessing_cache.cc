@@ -0,0 +1,75 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/util/preprocessing_cache.h"
+
+#include <string>
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+
+const GraphService<PreprocessingCache> kPreprocessingCacheService(
+    "mediapipe::PreprocessingCacheService",
+    GraphServiceBase::kAllowDefaultInitialization);
+
+absl::StatusOr<Packet> PreprocessingCache::GetOrCreate(
+    const Packet& source, absl::string_view transform_key,
+    const std::function<absl::StatusOr<Packet>()>& create) {
+  Key key(packet_internal::GetHolder(source), source.Timestamp().Value(),
+          std::string(transform_key));
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      return it->second.result;
+    }
+  }
+
+  ASSIGN_OR_RETURN(Packet result, create());
+  absl::MutexLock lock(&mutex_);
+  auto [it, inserted] =
+      entries_.emplace(std::move(key), Entry{source, result});
+  if (!inserted) {
+    // Another caller created it meanwhile.
+    return it->second.result;
+  }
+  timestamps_.insert(source.Timestamp().Value());
+  Evict();
+  return result;
+}
+
+int PreprocessingCache::size() const {
+  absl::MutexLock lock(&mutex_);
+  return entries_.size();
+}
+
+void PreprocessingCache::Evict() {
+  while (timestamps_.size() > kMaxTimestamps) {
+    const int64_t oldest = *timestamps_.begin();
+    timestamps_.erase(timestamps_.begin());
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      if (std::get<1>(it->first) == oldest) {
+        it = entries_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,87 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MEDIAPIPE_UTIL_PREPROCESSING_CACHE_H_
+#define MEDIAPIPE_UTIL_PREPROCESSING_CACHE_H_
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/graph_service.h"
+#include "mediapipe/framework/packet.h"
+
+namespace mediapipe {
+
+// Caches the results of preprocessing an input packet, such as the upload of
+// an image to the GPU or its conversion to a tensor, so that the subgraphs of
+// a graph that preprocess the same frame in the same way (e.g. a detector and
+// a classifier with the same input size) share the work.
+//
+// Entries are keyed by the identity of the source packet's payload, its
+// timestamp and a string describing the transform. They keep the source packet
+// alive, so that its payload address is not reused while cached, and only the
+// entries of the last kMaxTimestamps timestamps are kept.
+//
+// Callers that miss at the same time both run the transform, and the first
+// result to be added is returned to later callers: waiting for another node
+// could deadlock when both run on the GL context's thread. The cached packets
+// are shared by all callers, so transforms must produce immutable results.
+//
+// Thread-safe. Obtained through kPreprocessingCacheService, which gives every
+// graph its own cache.
+class PreprocessingCache {
+ public:
+  static constexpr int kMaxTimestamps = 2;
+
+  // Returns the packet cached for `source` and `transform_key`, or else the
+  // packet returned by `create`, which is cached if it succeeds. The timestamp
+  // of the returned packet is the one it was created with.
+  absl::StatusOr<Packet> GetOrCreate(
+      const Packet& source, absl::string_view transform_key,
+      const std::function<absl::StatusOr<Packet>()>& create);
+
+  // Returns the number of cached packets.
+  int size() const;
+
+ private:
+  using Key = std::tuple<const void*, int64_t, std::string>;
+  struct Entry {
+    Packet source;
+    Packet result;
+  };
+
+  // Drops the entries older than the last kMaxTimestamps timestamps.
+  void Evict() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  mutable absl::Mutex mutex_;
+  std::map<Key, Entry> entries_ ABSL_GUARDED_BY(mutex_);
+  std::set<int64_t> timestamps_ ABSL_GUARDED_BY(mutex_);
+};
+
+// The PreprocessingCache of a graph. Calculators that support it request it
+// when enabled in their options, and the graph creates it on first request.
+extern const GraphService<PreprocessingCache> kPreprocessingCacheService;
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_PREPROCESSING_CACHE_H_
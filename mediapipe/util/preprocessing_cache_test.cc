@@ -0,0 +1,107 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/util/preprocessing_cache.h"
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+// Returns a `create` callback that counts its calls and returns `value`.
+std::function<absl::StatusOr<Packet>()> CountingCreate(int value,
+                                                       int* num_calls) {
+  return [value, num_calls]() -> absl::StatusOr<Packet> {
+    ++*num_calls;
+    return MakePacket<int>(value);
+  };
+}
+
+TEST(PreprocessingCacheTest, ReusesResultForSameSourceAndTransform) {
+  PreprocessingCache cache;
+  Packet source = MakePacket<int>(1).At(Timestamp(10));
+  int num_calls = 0;
+
+  MP_ASSERT_OK_AND_ASSIGN(
+      Packet first,
+      cache.GetOrCreate(source, "gpu", CountingCreate(2, &num_calls)));
+  // A copy of the packet shares its payload.
+  Packet copy = source;
+  MP_ASSERT_OK_AND_ASSIGN(
+      Packet second,
+      cache.GetOrCreate(copy, "gpu", CountingCreate(3, &num_calls)));
+
+  EXPECT_EQ(num_calls, 1);
+  EXPECT_EQ(first.Get<int>(), 2);
+  EXPECT_EQ(&second.Get<int>(), &first.Get<int>());
+}
+
+TEST(PreprocessingCacheTest, SeparatesTransformsAndSources) {
+  PreprocessingCache cache;
+  Packet source = MakePacket<int>(1).At(Timestamp(10));
+  // Same value and timestamp, but another payload.
+  Packet other_source = MakePacket<int>(1).At(Timestamp(10));
+  int num_calls = 0;
+
+  MP_ASSERT_OK(cache.GetOrCreate(source, "gpu", CountingCreate(2, &num_calls)));
+  MP_ASSERT_OK(cache.GetOrCreate(source, "cpu", CountingCreate(3, &num_calls)));
+  MP_ASSERT_OK_AND_ASSIGN(
+      Packet result,
+      cache.GetOrCreate(other_source, "gpu", CountingCreate(4, &num_calls)));
+
+  EXPECT_EQ(num_calls, 3);
+  EXPECT_EQ(result.Get<int>(), 4);
+  EXPECT_EQ(cache.size(), 3);
+}
+
+TEST(PreprocessingCacheTest, DoesNotCacheFailures) {
+  PreprocessingCache cache;
+  Packet source = MakePacket<int>(1).At(Timestamp(10));
+
+  EXPECT_FALSE(cache
+                   .GetOrCreate(source, "gpu",
+                                []() -> absl::StatusOr<Packet> {
+                                  return absl::InternalError("failed");
+                                })
+                   .ok());
+  EXPECT_EQ(cache.size(), 0);
+  int num_calls = 0;
+  MP_ASSERT_OK(cache.GetOrCreate(source, "gpu", CountingCreate(2, &num_calls)));
+  EXPECT_EQ(num_calls, 1);
+}
+
+TEST(PreprocessingCacheTest, KeepsOnlyRecentTimestamps) {
+  PreprocessingCache cache;
+  int num_calls = 0;
+  Packet first = MakePacket<int>(1).At(Timestamp(10));
+  MP_ASSERT_OK(cache.GetOrCreate(first, "gpu", CountingCreate(1, &num_calls)));
+  for (int i = 1; i <= PreprocessingCache::kMaxTimestamps; ++i) {
+    Packet source = MakePacket<int>(1).At(Timestamp(10 + i));
+    MP_ASSERT_OK(
+        cache.GetOrCreate(source, "gpu", CountingCreate(1, &num_calls)));
+  }
+  EXPECT_EQ(cache.size(), PreprocessingCache::kMaxTimestamps);
+
+  // The entry of the first timestamp was dropped.
+  MP_ASSERT_OK(cache.GetOrCreate(first, "gpu", CountingCreate(1, &num_calls)));
+  EXPECT_EQ(num_calls, PreprocessingCache::kMaxTimestamps + 2);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,118 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/render_data_pool.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "google/protobuf/arena.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+// An arena together with the initial block it allocates from.
+struct RenderDataPool::Slot {
+  explicit Slot(size_t block_size) { Allocate(block_size); }
+
+  void Allocate(size_t size) {
+    arena.reset();
+    block.reset(new char[size]);
+    block_size = size;
+    google::protobuf::ArenaOptions options;
+    options.initial_block = block.get();
+    options.initial_block_size = block_size;
+    arena = std::make_unique<google::protobuf::Arena>(options);
+  }
+
+  // Frees everything allocated on the arena. If the arena had to allocate
+  // blocks beyond the initial one, the initial block grows to fit them.
+  void Reset() {
+    render_data = nullptr;
+    const uint64_t space_allocated = arena->SpaceAllocated();
+    if (space_allocated > block_size) {
+      Allocate(space_allocated + space_allocated / 4);
+    } else {
+      arena->Reset();
+    }
+  }
+
+  std::unique_ptr<char[]> block;
+  size_t block_size = 0;
+  // Declared after `block`, which must outlive it.
+  std::unique_ptr<google::protobuf::Arena> arena;
+  RenderData* render_data = nullptr;
+};
+
+// Idle slots, shared with the leases so that packets may outlive the pool.
+struct RenderDataPool::State {
+  explicit State(size_t block_size) : initial_block_size(block_size) {}
+
+  const size_t initial_block_size;
+  absl::Mutex mutex;
+  std::vector<std::unique_ptr<Slot>> idle ABSL_GUARDED_BY(mutex);
+};
+
+// Owns a slot while packets refer to its RenderData and returns it to the
+// pool on destruction.
+class RenderDataPool::Lease {
+ public:
+  Lease(std::shared_ptr<State> state, std::unique_ptr<Slot> slot)
+      : state_(std::move(state)), slot_(std::move(slot)) {}
+
+  ~Lease() {
+    slot_->Reset();
+    absl::MutexLock lock(&state_->mutex);
+    state_->idle.push_back(std::move(slot_));
+  }
+
+ private:
+  std::shared_ptr<State> state_;
+  std::unique_ptr<Slot> slot_;
+};
+
+RenderDataPool::RenderDataPool(size_t initial_block_size)
+    : state_(std::make_shared<State>(initial_block_size)) {}
+
+RenderDataPool::~RenderDataPool() = default;
+
+RenderData* RenderDataPool::NewRenderData() {
+  if (current_) {
+    current_->Reset();
+  } else {
+    absl::MutexLock lock(&state_->mutex);
+    if (!state_->idle.empty()) {
+      current_ = std::move(state_->idle.back());
+      state_->idle.pop_back();
+    }
+  }
+  if (!current_) {
+    current_ = std::make_unique<Slot>(state_->initial_block_size);
+  }
+  current_->render_data =
+      google::protobuf::Arena::CreateMessage<RenderData>(current_->arena.get());
+  return current_->render_data;
+}
+
+Packet RenderDataPool::MakePacket() {
+  CHECK(current_ != nullptr) << "NewRenderData() must be called first.";
+  const RenderData* render_data = current_->render_data;
+  Packet owner = Adopt(new Lease(state_, std::move(current_)));
+  return PointToForeign(render_data, owner);
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,73 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_RENDER_DATA_POOL_H_
+#define MEDIAPIPE_UTIL_RENDER_DATA_POOL_H_
+
+#include <cstddef>
+#include <memory>
+
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/util/render_data.pb.h"
+
+namespace mediapipe {
+
+// Hands out RenderData messages allocated on recycled protobuf arenas, so that
+// calculators emitting one RenderData per frame with hundreds of annotations
+// (e.g. a face mesh) stop paying for a heap allocation per annotation.
+//
+// An arena goes back to the pool when the last packet referring to its
+// RenderData is destroyed, on whichever thread that happens, and is reset
+// then. Arenas whose frames outgrew their initial block get a larger one on
+// reset, so in steady state a frame needs no heap allocations at all.
+//
+// The packets returned by MakePacket() point to arena-owned data and can't be
+// consumed. Not thread-safe: use one pool per calculator.
+//
+// Example:
+//   RenderData* render_data = pool_.NewRenderData();
+//   render_data->add_render_annotations()->...;
+//   cc->Outputs().Tag(kRenderDataTag).AddPacket(
+//       pool_.MakePacket().At(cc->InputTimestamp()));
+class RenderDataPool {
+ public:
+  static constexpr size_t kDefaultInitialBlockSize = 16 * 1024;
+
+  explicit RenderDataPool(
+      size_t initial_block_size = kDefaultInitialBlockSize);
+  ~RenderDataPool();
+  RenderDataPool(const RenderDataPool&) = delete;
+  RenderDataPool& operator=(const RenderDataPool&) = delete;
+
+  // Returns an empty RenderData on an idle arena. It stays owned by the pool
+  // until MakePacket() is called; calling NewRenderData() again first discards
+  // it.
+  RenderData* NewRenderData();
+
+  // Returns a packet holding the RenderData from the last NewRenderData()
+  // call. Its timestamp is unset.
+  Packet MakePacket();
+
+ private:
+  struct Slot;
+  struct State;
+  class Lease;
+
+  std::shared_ptr<State> state_;
+  std::unique_ptr<Slot> current_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_RENDER_DATA_POOL_H_
@@ -0,0 +1,103 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/render_data_pool.h"
+
+#include <cstdint>
+
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/render_data.pb.h"
+
+namespace mediapipe {
+namespace {
+
+void AddPoints(int count, RenderData* render_data) {
+  for (int i = 0; i < count; ++i) {
+    auto* point = render_data->add_render_annotations()->mutable_point();
+    point->set_x(i);
+    point->set_y(-i);
+  }
+}
+
+TEST(RenderDataPoolTest, PacketHoldsRenderData) {
+  RenderDataPool pool;
+  RenderData* render_data = pool.NewRenderData();
+  EXPECT_NE(render_data->GetArena(), nullptr);
+  AddPoints(3, render_data);
+  Packet packet = pool.MakePacket().At(Timestamp(1));
+
+  ASSERT_TRUE(packet.ValidateAsType<RenderData>().ok());
+  EXPECT_EQ(&packet.Get<RenderData>(), render_data);
+  EXPECT_EQ(packet.Get<RenderData>().render_annotations_size(), 3);
+  EXPECT_FALSE(packet.Consume<RenderData>().ok());
+}
+
+TEST(RenderDataPoolTest, ReusesArenaOfReleasedPacket) {
+  RenderDataPool pool;
+  RenderData* first = pool.NewRenderData();
+  AddPoints(3, first);
+  Packet packet = pool.MakePacket();
+  Packet copy = packet;
+
+  // The first arena is still in use.
+  RenderData* second = pool.NewRenderData();
+  EXPECT_NE(second->GetArena(), first->GetArena());
+  pool.MakePacket();
+
+  packet = Packet();
+  copy = Packet();
+  RenderData* third = pool.NewRenderData();
+  EXPECT_TRUE(third->GetArena() == first->GetArena() ||
+              third->GetArena() == second->GetArena());
+  EXPECT_EQ(third->render_annotations_size(), 0);
+}
+
+TEST(RenderDataPoolTest, DiscardsRenderDataWithoutPacket) {
+  RenderDataPool pool;
+  RenderData* first = pool.NewRenderData();
+  AddPoints(3, first);
+  RenderData* second = pool.NewRenderData();
+  EXPECT_EQ(second->GetArena(), first->GetArena());
+  EXPECT_EQ(second->render_annotations_size(), 0);
+}
+
+TEST(RenderDataPoolTest, GrowsInitialBlock) {
+  RenderDataPool pool(/*initial_block_size=*/1024);
+  RenderData* render_data = pool.NewRenderData();
+  AddPoints(1000, render_data);
+  pool.MakePacket();
+
+  // The arena now starts with a block that fits a whole frame.
+  render_data = pool.NewRenderData();
+  const auto* arena = render_data->GetArena();
+  const uint64_t initial_space = arena->SpaceAllocated();
+  AddPoints(1000, render_data);
+  EXPECT_EQ(arena->SpaceAllocated(), initial_space);
+}
+
+TEST(RenderDataPoolTest, PacketOutlivesPool) {
+  Packet packet;
+  {
+    RenderDataPool pool;
+    AddPoints(5, pool.NewRenderData());
+    packet = pool.MakePacket();
+  }
+  EXPECT_EQ(packet.Get<RenderData>().render_annotations_size(), 5);
+  EXPECT_EQ(packet.Get<RenderData>().render_annotations(4).point().x(), 4);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -29,9 +29,13 @@ namespace mediapipe {
 template <typename Key, typename Value, typename KeyHash>
 class ResourceCache {
  public:
+  // Returns the resource for key, creating it if needed. This counts as
+  // new_requests requests for the key; callers that serve some requests
+  // without the cache can report them in one call.
   Value Lookup(
       const Key& key,
-      absl::FunctionRef<Value(const Key& key, int request_count)> create) {
+      absl::FunctionRef<Value(const Key& key, int request_count)> create,
+      int new_requests = 1) {
     auto map_it = map_.find(key);
     Entry* entry;
     if (map_it == map_.end()) {
@@ -40,12 +44,12 @@ class ResourceCache {
                        std::forward_as_tuple(key));
       entry = &map_it->second;
       CHECK_EQ(entry->request_count, 0);
-      entry->request_count = 1;
+      entry->request_count = new_requests;
       entry_list_.Append(entry);
       if (entry->prev != nullptr) CHECK_GE(entry->prev->request_count, 1);
     } else {
       entry = &map_it->second;
-      ++entry->request_count;
+      entry->request_count += new_requests;
       Entry* larger = entry->prev;
       while (larger != nullptr &&
              larger->request_count < entry->request_count) {
@@ -59,7 +63,7 @@ class ResourceCache {
     if (!entry->value) {
       entry->value = create(entry->key, entry->request_count);
     }
-    ++total_request_count_;
+    total_request_count_ += new_requests;
     return entry->value;
   }
 
@@ -97,6 +101,15 @@ class ResourceCache {
     return evicted;
   }
 
+  // Calls fn for each entry, from the most to the least requested. The
+  // value may be unset if no resource was created for the key yet.
+  void ForEach(absl::FunctionRef<void(const Key& key, const Value& value)> fn) {
+    for (Entry* entry = entry_list_.head(); entry != nullptr;
+         entry = entry->next) {
+      fn(entry->key, entry->value);
+    }
+  }
+
  private:
   struct Entry {
     Entry(const Key& key) : key(key) {}
@@ -41,4 +41,6 @@ void SetCustomGlobalResourceProvider(ResourceProviderFn fn) {
   resource_provider_ = std::move(fn);
 }
 
+bool HasCustomGlobalResourceProvider() { return resource_provider_ != nullptr; }
+
 }  // namespace mediapipe
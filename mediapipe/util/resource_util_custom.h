@@ -13,6 +13,10 @@ typedef std::function<absl::Status(const std::string&, std::string*)>
 // Overrides the behavior of GetResourceContents.
 void SetCustomGlobalResourceProvider(ResourceProviderFn fn);
 
+// Whether GetResourceContents is overridden, in which case resources may not
+// be backed by the files that PathToResourceAsFile points to.
+bool HasCustomGlobalResourceProvider();
+
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_UTIL_RESOURCE_UTIL_CUSTOM_H_
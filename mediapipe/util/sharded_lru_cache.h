@@ -0,0 +1,285 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_SHARDED_LRU_CACHE_H_
+#define MEDIAPIPE_UTIL_SHARDED_LRU_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <list>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+// A thread-safe least-recently-used cache of `Value`s by `Key`. Unlike
+// ResourceCache, which is meant to be used under its owner's lock, this cache
+// does its own locking. Keys are partitioned into shards, each with its own
+// lock and LRU order, in the manner of ShardedMap, so that concurrent lookups
+// of different keys rarely contend.
+//
+// The cache is bounded by a number of entries and by a total weight, e.g. a
+// byte size given by `Options::weigher`. The limits are split evenly between
+// the shards, and each shard evicts its least recently used entries to meet
+// its share, so the eviction order is only approximately LRU across shards.
+// Use a single shard where exact limits matter more than contention.
+//
+// Lookup() returns a copy of the value, so `Value` is typically a
+// std::shared_ptr or another cheap handle. Take() moves the value out instead,
+// which suits move-only values, e.g. when the cache holds unused resources
+// that are checked out and returned.
+//
+// This class is thread-safe.
+template <typename Key, typename Value, typename Hash = absl::Hash<Key>,
+          typename Eq = std::equal_to<Key>>
+class ShardedLruCache {
+ public:
+  struct Options {
+    // Number of independently locked partitions of the keys.
+    int num_shards = 1;
+    // Maximum number of entries.
+    int64_t max_entries = std::numeric_limits<int64_t>::max();
+    // Maximum total weight of the entries.
+    int64_t max_weight = std::numeric_limits<int64_t>::max();
+    // Returns the weight of an entry. Each entry weighs 1 if unset.
+    std::function<int64_t(const Key&, const Value&)> weigher;
+    // Called with the entries evicted to meet the limits, without holding any
+    // lock of the cache. Not called for entries that are erased, taken or
+    // replaced.
+    std::function<void(const Key&, Value)> on_evict;
+  };
+
+  // Counters describing how well the cache serves its lookups.
+  struct Stats {
+    int64_t hits = 0;
+    int64_t misses = 0;
+    int64_t evictions = 0;
+    int64_t entries = 0;
+    int64_t weight = 0;
+
+    double HitRate() const {
+      return hits + misses > 0 ? static_cast<double>(hits) / (hits + misses)
+                               : 0.0;
+    }
+  };
+
+  explicit ShardedLruCache(Options options) : options_(std::move(options)) {
+    CHECK_GT(options_.num_shards, 0);
+    shards_.reset(new Shard[options_.num_shards]);
+    SetShardLimits(options_.max_entries, options_.max_weight);
+  }
+
+  ShardedLruCache(const ShardedLruCache&) = delete;
+  ShardedLruCache& operator=(const ShardedLruCache&) = delete;
+
+  // Returns a copy of the value for `key` and marks it as most recently used,
+  // or returns std::nullopt.
+  std::optional<Value> Lookup(const Key& key) {
+    Shard& shard = GetShard(key);
+    absl::MutexLock lock(&shard.mutex);
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+      ++misses_;
+      return std::nullopt;
+    }
+    ++hits_;
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    return it->second->value;
+  }
+
+  // Removes the value for `key` from the cache and returns it, or returns
+  // std::nullopt. Counts as a lookup in the stats.
+  std::optional<Value> Take(const Key& key) {
+    std::optional<Value> value;
+    Shard& shard = GetShard(key);
+    absl::MutexLock lock(&shard.mutex);
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+      ++misses_;
+      return value;
+    }
+    ++hits_;
+    value.emplace(std::move(it->second->value));
+    shard.Remove(it);
+    return value;
+  }
+
+  // Caches `value` for `key` as the most recently used entry, replacing any
+  // previous value, and evicts the least recently used entries of its shard
+  // that exceed the limits. The new entry itself is evicted if it alone
+  // exceeds them.
+  void Insert(const Key& key, Value value) {
+    const int64_t weight =
+        options_.weigher ? options_.weigher(key, value) : int64_t{1};
+    // The replaced and evicted values are destroyed without holding the lock.
+    std::optional<Value> replaced;
+    std::vector<Entry> evicted;
+    {
+      Shard& shard = GetShard(key);
+      absl::MutexLock lock(&shard.mutex);
+      auto it = shard.index.find(key);
+      if (it != shard.index.end()) {
+        replaced.emplace(std::move(it->second->value));
+        shard.Remove(it);
+      }
+      shard.entries.push_front(Entry{key, std::move(value), weight});
+      shard.index.emplace(key, shard.entries.begin());
+      shard.weight += weight;
+      shard.Trim(&evicted);
+    }
+    evictions_ += evicted.size();
+    NotifyEvicted(std::move(evicted));
+  }
+
+  // Removes the entry for `key`. Returns whether there was one.
+  bool Erase(const Key& key) {
+    std::optional<Value> value;
+    Shard& shard = GetShard(key);
+    absl::MutexLock lock(&shard.mutex);
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) return false;
+    // Destroyed after the lock is released.
+    value.emplace(std::move(it->second->value));
+    shard.Remove(it);
+    return true;
+  }
+
+  // Changes the limits and evicts the entries that exceed them.
+  void SetLimits(int64_t max_entries, int64_t max_weight) {
+    std::vector<Entry> evicted;
+    {
+      absl::MutexLock lock(&limits_mutex_);
+      SetShardLimits(max_entries, max_weight);
+      for (int i = 0; i < options_.num_shards; ++i) {
+        absl::MutexLock shard_lock(&shards_[i].mutex);
+        shards_[i].Trim(&evicted);
+      }
+    }
+    evictions_ += evicted.size();
+    NotifyEvicted(std::move(evicted));
+  }
+
+  // Removes all entries, without calling on_evict.
+  void Clear() {
+    for (int i = 0; i < options_.num_shards; ++i) {
+      std::list<Entry> entries;
+      absl::MutexLock lock(&shards_[i].mutex);
+      entries.swap(shards_[i].entries);
+      shards_[i].index.clear();
+      shards_[i].weight = 0;
+    }
+  }
+
+  Stats GetStats() const {
+    Stats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    for (int i = 0; i < options_.num_shards; ++i) {
+      absl::MutexLock lock(&shards_[i].mutex);
+      stats.entries += shards_[i].entries.size();
+      stats.weight += shards_[i].weight;
+    }
+    return stats;
+  }
+
+ private:
+  struct Entry {
+    Key key;
+    Value value;
+    int64_t weight;
+  };
+
+  struct Shard {
+    using Index =
+        absl::flat_hash_map<Key, typename std::list<Entry>::iterator, Hash, Eq>;
+
+    void Remove(typename Index::iterator it)
+        ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+      weight -= it->second->weight;
+      entries.erase(it->second);
+      index.erase(it);
+    }
+
+    // Moves the least recently used entries that exceed the limits to
+    // `evicted`.
+    void Trim(std::vector<Entry>* evicted)
+        ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+      while (!entries.empty() &&
+             (static_cast<int64_t>(entries.size()) > max_entries ||
+              weight > max_weight)) {
+        evicted->push_back(std::move(entries.back()));
+        index.erase(evicted->back().key);
+        weight -= evicted->back().weight;
+        entries.pop_back();
+      }
+    }
+
+    mutable absl::Mutex mutex;
+    // From the most to the least recently used.
+    std::list<Entry> entries ABSL_GUARDED_BY(mutex);
+    Index index ABSL_GUARDED_BY(mutex);
+    int64_t weight ABSL_GUARDED_BY(mutex) = 0;
+    // This shard's share of the limits.
+    int64_t max_entries ABSL_GUARDED_BY(mutex) = 0;
+    int64_t max_weight ABSL_GUARDED_BY(mutex) = 0;
+  };
+
+  Shard& GetShard(const Key& key) const {
+    // Mixes the hash so that the shard does not correlate with the buckets
+    // of the shard's own index.
+    const size_t hash = Hash()(key);
+    return shards_[(hash ^ (hash >> (sizeof(size_t) * 4))) %
+                   options_.num_shards];
+  }
+
+  // Splits the limits between the shards, rounding up.
+  void SetShardLimits(int64_t max_entries, int64_t max_weight) {
+    const int n = options_.num_shards;
+    for (int i = 0; i < n; ++i) {
+      absl::MutexLock lock(&shards_[i].mutex);
+      shards_[i].max_entries = max_entries / n + (max_entries % n != 0);
+      shards_[i].max_weight = max_weight / n + (max_weight % n != 0);
+    }
+  }
+
+  void NotifyEvicted(std::vector<Entry> evicted) {
+    if (!options_.on_evict) return;
+    for (Entry& entry : evicted) {
+      options_.on_evict(entry.key, std::move(entry.value));
+    }
+  }
+
+  const Options options_;
+  std::unique_ptr<Shard[]> shards_;
+  // Serializes SetLimits() calls.
+  absl::Mutex limits_mutex_;
+  std::atomic<int64_t> hits_{0};
+  std::atomic<int64_t> misses_{0};
+  std::atomic<int64_t> evictions_{0};
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_SHARDED_LRU_CACHE_H_
@@ -0,0 +1,150 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/sharded_lru_cache.h"
+
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Optional;
+
+using IntCache = ShardedLruCache<int, int>;
+
+TEST(ShardedLruCacheTest, LooksUpInsertedValues) {
+  IntCache cache({});
+  EXPECT_EQ(cache.Lookup(1), std::nullopt);
+  cache.Insert(1, 10);
+  cache.Insert(2, 20);
+  cache.Insert(1, 11);
+  EXPECT_THAT(cache.Lookup(1), Optional(11));
+  EXPECT_THAT(cache.Lookup(2), Optional(20));
+
+  IntCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 2);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.evictions, 0);
+  EXPECT_EQ(stats.entries, 2);
+}
+
+TEST(ShardedLruCacheTest, EvictsLeastRecentlyUsedFirst) {
+  std::vector<int> evicted;
+  IntCache::Options options;
+  options.max_entries = 2;
+  options.on_evict = [&evicted](const int& key, int value) {
+    evicted.push_back(key);
+  };
+  IntCache cache(std::move(options));
+  cache.Insert(1, 10);
+  cache.Insert(2, 20);
+  // Makes 1 more recently used than 2.
+  EXPECT_THAT(cache.Lookup(1), Optional(10));
+  cache.Insert(3, 30);
+  cache.Insert(4, 40);
+
+  EXPECT_THAT(evicted, ElementsAre(2, 1));
+  EXPECT_EQ(cache.GetStats().evictions, 2);
+  EXPECT_EQ(cache.Lookup(1), std::nullopt);
+  EXPECT_THAT(cache.Lookup(3), Optional(30));
+}
+
+TEST(ShardedLruCacheTest, EvictsToMeetTheMaxWeight) {
+  using StringCache = ShardedLruCache<std::string, std::string>;
+  StringCache::Options options;
+  options.max_weight = 8;
+  options.weigher = [](const std::string& key, const std::string& value) {
+    return static_cast<int64_t>(value.size());
+  };
+  StringCache cache(std::move(options));
+  cache.Insert("a", "12345");
+  cache.Insert("b", "678");
+  EXPECT_EQ(cache.GetStats().weight, 8);
+  cache.Insert("c", "9");
+  EXPECT_EQ(cache.Lookup("a"), std::nullopt);
+  EXPECT_EQ(cache.GetStats().weight, 4);
+
+  // An entry heavier than the limit is not kept.
+  cache.Insert("d", "123456789");
+  EXPECT_EQ(cache.Lookup("d"), std::nullopt);
+
+  cache.SetLimits(/*max_entries=*/10, /*max_weight=*/0);
+  EXPECT_EQ(cache.GetStats().entries, 0);
+}
+
+TEST(ShardedLruCacheTest, TakesMoveOnlyValues) {
+  ShardedLruCache<int, std::unique_ptr<int>> cache({});
+  cache.Insert(1, std::make_unique<int>(10));
+  std::optional<std::unique_ptr<int>> value = cache.Take(1);
+  ASSERT_TRUE(value.has_value());
+  EXPECT_EQ(**value, 10);
+  EXPECT_EQ(cache.Take(1), std::nullopt);
+  EXPECT_EQ(cache.GetStats().entries, 0);
+}
+
+TEST(ShardedLruCacheTest, ErasesAndClears) {
+  IntCache cache({});
+  cache.Insert(1, 10);
+  cache.Insert(2, 20);
+  EXPECT_TRUE(cache.Erase(1));
+  EXPECT_FALSE(cache.Erase(1));
+  cache.Clear();
+  EXPECT_EQ(cache.GetStats().entries, 0);
+  EXPECT_EQ(cache.Lookup(2), std::nullopt);
+}
+
+TEST(ShardedLruCacheTest, SplitsLimitsBetweenShards) {
+  IntCache::Options options;
+  options.num_shards = 4;
+  options.max_entries = 8;
+  IntCache cache(std::move(options));
+  for (int i = 0; i < 100; ++i) {
+    cache.Insert(i, i);
+  }
+  // Each shard keeps at most 2 entries.
+  EXPECT_LE(cache.GetStats().entries, 8);
+  EXPECT_EQ(cache.GetStats().evictions, 100 - cache.GetStats().entries);
+}
+
+TEST(ShardedLruCacheTest, IsThreadSafe) {
+  IntCache::Options options;
+  options.num_shards = 8;
+  options.max_entries = 64;
+  IntCache cache(std::move(options));
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&cache, t] {
+      for (int i = 0; i < 1000; ++i) {
+        const int key = (i * 7 + t) % 100;
+        if (!cache.Lookup(key)) cache.Insert(key, key);
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  IntCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(stats.hits + stats.misses, 4000);
+  EXPECT_LE(stats.entries, 64);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -38,6 +38,9 @@ void MediaPipe_RegisterTfLiteOpResolver(tflite::MutableOpResolver *resolver) {
   resolver->AddCustom("TransformTensorBilinear",
                       tflite_operations::RegisterTransformTensorBilinearV2(),
                       /*version=*/2);
+  resolver->AddCustom(
+      "TransformTensorBilinearNormalize",
+      tflite_operations::RegisterTransformTensorBilinearNormalize());
   resolver->AddCustom("TransformLandmarks",
                       tflite_operations::RegisterTransformLandmarksV2(),
                       /*version=*/2);
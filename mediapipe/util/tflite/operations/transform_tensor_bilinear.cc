@@ -298,6 +298,152 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 }
 }  // namespace v2
 
+namespace normalize {
+
+constexpr int kValueTransformTensor = 2;
+
+// Same sampling as v2, but reads the full uint8 or float frame, writes one
+// batch item per matrix and applies `scale * value + offset` on the way, so
+// cropping, resizing and normalization happen in a single pass.
+template <typename T>
+void TransformTensorBilinearNormalize(const tflite::RuntimeShape& input_shape,
+                                      const T* input_data,
+                                      const float* matrices, float scale,
+                                      float offset,
+                                      const tflite::RuntimeShape& output_shape,
+                                      float* output_data) {
+  const int batch = output_shape.Dims(0);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int output_channels = output_shape.Dims(3);
+
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+
+  for (int b = 0; b < batch; ++b) {
+    const float* matrix = matrices + b * 16;
+    tflite::gpu::float4 x_transform(matrix[0], matrix[1], matrix[2],
+                                    matrix[3]);
+    tflite::gpu::float4 y_transform(matrix[4], matrix[5], matrix[6],
+                                    matrix[7]);
+    // Align corners correction, see v2.
+    x_transform[3] += x_transform[0] * 0.5 + x_transform[1] * 0.5 - 0.5;
+    y_transform[3] += y_transform[0] * 0.5 + y_transform[1] * 0.5 - 0.5;
+
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        tflite::gpu::float4 coord(
+            static_cast<float>(out_x), static_cast<float>(out_y),
+            static_cast<float>(0.0), static_cast<float>(1.0));
+        tflite::gpu::float2 tc(DotProduct(x_transform, coord),
+                               DotProduct(y_transform, coord));
+
+        bool out_of_bound = tc.x < 0.0 || tc.x > input_width - 1 ||
+                            tc.y < 0.0 || tc.y > input_height - 1;
+
+        float* out = output_data + Offset(output_shape, b, out_y, out_x, 0);
+        for (int out_z = 0; out_z < output_channels; ++out_z) {
+          float value = 0;
+          if (!out_of_bound) {
+            auto ReadValue = [&](int h, int w) -> float {
+              return h < 0 || w < 0 || h >= input_height || w >= input_width
+                         ? 0
+                         : static_cast<float>(
+                               input_data[Offset(input_shape, 0, h, w, out_z)]);
+            };
+
+            float q_11 = ReadValue(floor(tc.y), floor(tc.x));
+            float q_21 = ReadValue(floor(tc.y), floor(tc.x) + 1);
+            float q_12 = ReadValue(floor(tc.y) + 1, floor(tc.x));
+            float q_22 = ReadValue(floor(tc.y) + 1, floor(tc.x) + 1);
+
+            float right_contrib = tc.x - floor(tc.x);
+            float lower_contrib = tc.y - floor(tc.y);
+
+            float upper = (1.0 - right_contrib) * q_11 + right_contrib * q_21;
+            float lower = (1.0 - right_contrib) * q_12 + right_contrib * q_22;
+
+            value = lower_contrib * lower + (1.0 - lower_contrib) * upper;
+          }
+          // Out of bound pixels read as zero before normalization, like the
+          // zero border of ImageToTensorCalculator.
+          out[out_z] = scale * value + offset;
+        }
+      }
+    }
+  }
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  TF_LITE_ENSURE_EQ(context, tflite::NumInputs(node), 3);
+  TF_LITE_ENSURE_EQ(context, tflite::NumOutputs(node), 1);
+  const TfLiteTensor* input =
+      tflite::GetInput(context, node, kDataInput0Tensor);
+  TF_LITE_ENSURE(context, input != nullptr);
+  const TfLiteTensor* matrices =
+      tflite::GetInput(context, node, kDataInput1Tensor);
+  TF_LITE_ENSURE(context, matrices != nullptr);
+  const TfLiteTensor* value_transform =
+      tflite::GetInput(context, node, kValueTransformTensor);
+  TF_LITE_ENSURE(context, value_transform != nullptr);
+  TfLiteTensor* output = tflite::GetOutput(context, node, kOutputTensor);
+  TF_LITE_ENSURE(context, output != nullptr);
+
+  TF_LITE_ENSURE_EQ(context, tflite::NumDimensions(input), 4);
+  TF_LITE_ENSURE_EQ(context, tflite::SizeOfDimension(input, 0), 1);
+  TF_LITE_ENSURE(context,
+                 input->type == kTfLiteUInt8 || input->type == kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, matrices->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, value_transform->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, tflite::NumElements(value_transform), 2);
+  TF_LITE_ENSURE_EQ(context, output->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, tflite::NumDimensions(output), 4);
+  TF_LITE_ENSURE(context, tflite::SizeOfDimension(output, 3) <=
+                              tflite::SizeOfDimension(input, 3));
+
+  // One batch item per matrix, so the batch follows the number of ROIs.
+  const int batch = tflite::NumElements(matrices) / 16;
+  TF_LITE_ENSURE(context, batch > 0);
+  TF_LITE_ENSURE_EQ(context, batch * 16, tflite::NumElements(matrices));
+  if (tflite::SizeOfDimension(output, 0) == batch) {
+    return kTfLiteOk;
+  }
+  TfLiteIntArray* output_size = TfLiteIntArrayCopy(output->dims);
+  output_size->data[0] = batch;
+  return context->ResizeTensor(context, output, output_size);
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* input =
+      tflite::GetInput(context, node, kDataInput0Tensor);
+  TF_LITE_ENSURE(context, input != nullptr);
+  const TfLiteTensor* matrices =
+      tflite::GetInput(context, node, kDataInput1Tensor);
+  TF_LITE_ENSURE(context, matrices != nullptr);
+  const TfLiteTensor* value_transform =
+      tflite::GetInput(context, node, kValueTransformTensor);
+  TF_LITE_ENSURE(context, value_transform != nullptr);
+  TfLiteTensor* output = tflite::GetOutput(context, node, kOutputTensor);
+  TF_LITE_ENSURE(context, output != nullptr);
+
+  const float* scale_offset = tflite::GetTensorData<float>(value_transform);
+  if (input->type == kTfLiteUInt8) {
+    TransformTensorBilinearNormalize(
+        tflite::GetTensorShape(input), tflite::GetTensorData<uint8_t>(input),
+        tflite::GetTensorData<float>(matrices), scale_offset[0],
+        scale_offset[1], tflite::GetTensorShape(output),
+        tflite::GetTensorData<float>(output));
+  } else {
+    TransformTensorBilinearNormalize(
+        tflite::GetTensorShape(input), tflite::GetTensorData<float>(input),
+        tflite::GetTensorData<float>(matrices), scale_offset[0],
+        scale_offset[1], tflite::GetTensorShape(output),
+        tflite::GetTensorData<float>(output));
+  }
+  return kTfLiteOk;
+}
+}  // namespace normalize
+
 }  // namespace
 
 TfLiteRegistration* RegisterTransformTensorBilinearV1() {
@@ -328,5 +474,19 @@ TfLiteRegistration* RegisterTransformTensorBilinearV2() {
   return &reg;
 }
 
+TfLiteRegistration* RegisterTransformTensorBilinearNormalize() {
+  static TfLiteRegistration reg = {
+      /*.init=*/nullptr,
+      /*.free=*/nullptr,
+      /*.prepare=*/normalize::Prepare,
+      /*.invoke=*/normalize::Eval,
+      /*.profiling_string=*/nullptr,
+      /*.builtin_code=*/tflite::BuiltinOperator_CUSTOM,
+      /*.custom_name=*/"TransformTensorBilinearNormalize",
+      /*.version=*/1,
+  };
+  return &reg;
+}
+
 }  // namespace tflite_operations
 }  // namespace mediapipe
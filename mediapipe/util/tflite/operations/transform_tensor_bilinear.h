@@ -24,6 +24,14 @@ TfLiteRegistration* RegisterTransformTensorBilinearV1();
 
 TfLiteRegistration* RegisterTransformTensorBilinearV2();
 
+// Crops, resizes and normalizes in one pass, for models that take the full
+// frame instead of a preprocessed tensor. Inputs are the [1, H, W, C] uint8 or
+// float frame, [N, 1, 4, 4] row-major matrices mapping output pixel
+// coordinates to frame pixel coordinates, and [scale, offset] applied to the
+// sampled values. The float output is [N, h, w, c], c <= C, with one batch
+// item per matrix. CPU only: the GPU delegate doesn't know this op.
+TfLiteRegistration* RegisterTransformTensorBilinearNormalize();
+
 }  // namespace tflite_operations
 }  // namespace mediapipe
 
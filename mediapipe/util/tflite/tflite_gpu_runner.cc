@@ -35,6 +35,8 @@
 // This code should be enabled as soon as TensorFlow version, which mediapipe
 // uses, will include this module.
 #ifdef __ANDROID__
+#include <EGL/egl.h>
+
 #include "tensorflow/lite/delegates/gpu/cl/api.h"
 #endif
 
@@ -82,6 +84,15 @@ ObjectDef GetSSBOObjectDef(int channels) {
   return gpu_object_def;
 }
 
+ObjectDef GetTextureObjectDef() {
+  ObjectDef gpu_object_def;
+  gpu_object_def.data_type = DataType::FLOAT32;
+  gpu_object_def.data_layout = DataLayout::DHWC4;
+  gpu_object_def.object_type = ObjectType::OPENGL_TEXTURE;
+  gpu_object_def.user_provided = true;
+  return gpu_object_def;
+}
+
 #ifdef __ANDROID__
 
 cl::InferenceOptions GetClInferenceOptions(const InferenceOptions& options) {
@@ -129,6 +140,7 @@ absl::Status TFLiteGPURunner::InitializeWithModel(
   for (const auto& input : graph_gl_->inputs()) {
     input_shapes_.push_back(input->tensor.shape);
   }
+  input_is_texture_.assign(input_shapes_.size(), false);
   for (const auto& output : graph_gl_->outputs()) {
     output_shapes_.push_back(output->tensor.shape);
   }
@@ -154,6 +166,16 @@ absl::StatusOr<int64_t> TFLiteGPURunner::GetOutputElements(int id) {
   }
 }
 
+absl::Status TFLiteGPURunner::UseTextureForInput(int input_id) {
+  RET_CHECK(!runner_) << "Must be called before Build().";
+  RET_CHECK(input_id >= 0 && input_id < input_shapes_.size())
+      << "Wrong input tensor id.";
+  RET_CHECK_LE(input_shapes_[input_id].c, 4)
+      << "Texture inputs support at most 4 channels.";
+  input_is_texture_[input_id] = true;
+  return absl::OkStatus();
+}
+
 absl::Status TFLiteGPURunner::Build() {
   // 1. Prepare inference builder.
   std::unique_ptr<InferenceBuilder> builder;
@@ -180,7 +202,9 @@ absl::Status TFLiteGPURunner::Build() {
   // 2. Describe output/input objects for created builder.
   for (int flow_index = 0; flow_index < input_shapes_.size(); ++flow_index) {
     MP_RETURN_IF_ERROR(builder->SetInputObjectDef(
-        flow_index, GetSSBOObjectDef(input_shapes_[flow_index].c)));
+        flow_index, input_is_texture_[flow_index]
+                        ? GetTextureObjectDef()
+                        : GetSSBOObjectDef(input_shapes_[flow_index].c)));
   }
   for (int flow_index = 0; flow_index < output_shapes_.size(); ++flow_index) {
     MP_RETURN_IF_ERROR(builder->SetOutputObjectDef(
@@ -198,6 +222,14 @@ absl::Status TFLiteGPURunner::BindSSBOToInputTensor(GLuint ssbo_id,
   return runner_->SetInputObject(input_id, std::move(buffer));
 }
 
+absl::Status TFLiteGPURunner::BindTextureToInputTensor(GLuint texture_id,
+                                                       int input_id) {
+  OpenGlTexture texture;
+  texture.id = texture_id;
+  texture.format = GL_RGBA32F;
+  return runner_->SetInputObject(input_id, std::move(texture));
+}
+
 absl::Status TFLiteGPURunner::BindSSBOToOutputTensor(GLuint ssbo_id,
                                                      int output_id) {
   OpenGlBuffer buffer;
@@ -230,9 +262,26 @@ absl::Status TFLiteGPURunner::InitializeOpenCL(
   if (!serialized_binary_cache_.empty()) {
     env_options.serialized_binary_cache = serialized_binary_cache_;
   }
+  // Every runner gets its own OpenCL context and command queue. Sharing the
+  // current GL context with it lets GL and the queue synchronize through EGL
+  // fences instead of blocking glFinish()/clFinish() calls, so that runners of
+  // independent models can overlap on the device.
+  if (share_gl_context_) {
+    env_options.egl_display = eglGetCurrentDisplay();
+    env_options.egl_context = eglGetCurrentContext();
+  }
   cl::InferenceEnvironmentProperties properties;
-  MP_RETURN_IF_ERROR(
-      cl::NewInferenceEnvironment(env_options, &cl_environment_, &properties));
+  absl::Status env_status =
+      cl::NewInferenceEnvironment(env_options, &cl_environment_, &properties);
+  if (!env_status.ok() && env_options.IsGlAware()) {
+    VLOG(2) << "Falling back to OpenCL without GL sharing: "
+            << env_status.message();
+    env_options.egl_display = EGL_NO_DISPLAY;
+    env_options.egl_context = EGL_NO_CONTEXT;
+    env_status =
+        cl::NewInferenceEnvironment(env_options, &cl_environment_, &properties);
+  }
+  MP_RETURN_IF_ERROR(env_status);
 
   // Try to initialize from serialized model first.
   if (!serialized_model_.empty()) {
@@ -40,15 +40,21 @@ namespace gpu {
 //
 // Typical order of execution:
 // 1. Initialize with the flatbuffer model using InitializeWithModel().
-// 2. Bind OpenGL SSBO objects as inputs and outputs using
-// BindSSBOToInputTensor() and BindSSBOToOutputTensor().
+// 2. Optionally select texture inputs with UseTextureForInput().
 // 3. Build the inference runner with Build() method.
-// 4. Invoke() executes the inference, where inputs and outputs are those which
+// 4. Bind OpenGL SSBO objects as inputs and outputs using
+// BindSSBOToInputTensor() and BindSSBOToOutputTensor(), or textures as inputs
+// using BindTextureToInputTensor().
+// 5. Invoke() executes the inference, where inputs and outputs are those which
 // were specified earlier. Invoke() may be called in the loop.
 //
 // Note: All of these need to happen inside MediaPipe's RunInGlContext to make
 // sure that all steps from inference construction to execution are made using
 // same OpenGL context.
+//
+// With the OpenCL backend each runner owns its inference context and command
+// queue, which by default shares the current GL context so that it is
+// synchronized with GL through fences (see SetShareGlContext()).
 class TFLiteGPURunner {
  public:
   explicit TFLiteGPURunner(const InferenceOptions& options)
@@ -61,7 +67,21 @@ class TFLiteGPURunner {
   void ForceOpenGL() { opengl_is_forced_ = true; }
   void ForceOpenCL() { opencl_is_forced_ = true; }
 
+  // Whether the OpenCL context shares the GL context that is current during
+  // Build(). Without sharing, every Invoke() waits for all prior GL work and
+  // for its own OpenCL work to finish on the CPU. Defaults to true; the runner
+  // falls back to an unshared context if the device does not support sharing.
+  void SetShareGlContext(bool share) { share_gl_context_ = share; }
+
+  // Makes input `input_id` a user-provided RGBA32F texture instead of an SSBO.
+  // The texture holds one pixel per element of the BHWC tensor, with the
+  // channels padded to 4, as written by Tensor::GetOpenGlTexture2dWriteView()
+  // in its aligned layout. The input must have at most 4 channels. Must be
+  // called before Build().
+  absl::Status UseTextureForInput(int input_id);
+
   absl::Status BindSSBOToInputTensor(GLuint ssbo_id, int input_id);
+  absl::Status BindTextureToInputTensor(GLuint texture_id, int input_id);
   absl::Status BindSSBOToOutputTensor(GLuint ssbo_id, int output_id);
 
   int inputs_size() const { return input_shapes_.size(); }
@@ -136,8 +156,12 @@ class TFLiteGPURunner {
   std::vector<std::vector<int>> input_shape_from_model_;
   std::vector<std::vector<int>> output_shape_from_model_;
 
+  // Inputs bound as textures rather than SSBOs.
+  std::vector<bool> input_is_texture_;
+
   bool opencl_is_forced_ = false;
   bool opengl_is_forced_ = false;
+  bool share_gl_context_ = true;
 };
 
 }  // namespace gpu
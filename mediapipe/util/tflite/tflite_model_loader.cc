@@ -14,15 +14,107 @@
 
 #include "mediapipe/util/tflite/tflite_model_loader.h"
 
+#include <sys/stat.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/resource_util.h"
+#include "mediapipe/util/resource_util_custom.h"
 
 namespace mediapipe {
+namespace {
+
+// Models mapped from files, shared by every graph of the process that loads
+// the same file. An entry expires with the last packet that holds its model.
+class ModelRegistry {
+ public:
+  static ModelRegistry& Get() {
+    static ModelRegistry* registry = new ModelRegistry();
+    return *registry;
+  }
+
+  // Returns the model mapped from `file_path`, mapping it unless it is
+  // already. `file_key` identifies the version of the file.
+  absl::StatusOr<std::shared_ptr<tflite::FlatBufferModel>> GetOrLoad(
+      const std::string& file_path, const std::string& file_key) {
+    absl::MutexLock lock(&mutex_);
+    std::weak_ptr<tflite::FlatBufferModel>& entry = models_[file_key];
+    if (auto model = entry.lock()) {
+      return model;
+    }
+    // Maps the file read-only where supported, so that the model bytes are
+    // page cache shared with other processes rather than heap.
+    std::shared_ptr<tflite::FlatBufferModel> model =
+        tflite::FlatBufferModel::VerifyAndBuildFromFile(file_path.c_str());
+    RET_CHECK(model) << "Failed to load model from path " << file_path;
+    entry = model;
+    // Drops the entries of released models as they are replaced.
+    absl::erase_if(models_, [](const auto& key_and_model) {
+      return key_and_model.second.expired();
+    });
+    return model;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::weak_ptr<tflite::FlatBufferModel>>
+      models_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Returns the file that the model resource at `path` is read from, if it can
+// be mapped directly.
+std::optional<std::string> GetModelFilePath(const std::string& path) {
+  // A custom provider may serve contents that differ from the file.
+  if (HasCustomGlobalResourceProvider()) return std::nullopt;
+#if defined(__ANDROID__)
+  // Relative paths are assets, which PathToResourceAsFile would copy out.
+  if (!absl::StartsWith(path, "/")) return std::nullopt;
+  return path;
+#else
+  auto file_path = PathToResourceAsFile(path);
+  if (!file_path.ok()) return std::nullopt;
+  return *std::move(file_path);
+#endif  // __ANDROID__
+}
+
+// Returns a key that changes whenever the file is replaced or modified, or
+// nullopt if `file_path` is not a regular file.
+std::optional<std::string> GetFileKey(const std::string& file_path) {
+  struct stat file_stat;
+  if (stat(file_path.c_str(), &file_stat) != 0 ||
+      (file_stat.st_mode & S_IFMT) != S_IFREG) {
+    return std::nullopt;
+  }
+  return absl::StrCat(file_path, ":", file_stat.st_mtime, ":",
+                      file_stat.st_size);
+}
+
+}  // namespace
 
 absl::StatusOr<api2::Packet<TfLiteModelPtr>> TfLiteModelLoader::LoadFromPath(
     const std::string& path) {
   std::string model_path = path;
 
+  if (auto file_path = GetModelFilePath(model_path)) {
+    if (auto file_key = GetFileKey(*file_path)) {
+      ASSIGN_OR_RETURN(std::shared_ptr<tflite::FlatBufferModel> model,
+                       ModelRegistry::Get().GetOrLoad(*file_path, *file_key));
+      tflite::FlatBufferModel* model_ptr = model.get();
+      return api2::MakePacket<TfLiteModelPtr>(
+          model_ptr,
+          // The model is deleted with its last user in the process.
+          [model = std::move(model)](tflite::FlatBufferModel*) {});
+    }
+  }
+
   std::string model_blob;
   auto status_or_content =
       mediapipe::GetResourceContents(model_path, &model_blob);
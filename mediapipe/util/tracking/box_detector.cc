@@ -14,6 +14,8 @@
 
 #include "mediapipe/util/tracking/box_detector.h"
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -22,6 +24,7 @@
 #include "mediapipe/framework/port/opencv_video_inc.h"
 #include "mediapipe/util/tracking/box_detector.pb.h"
 #include "mediapipe/util/tracking/box_tracker.h"
+#include "mediapipe/util/tracking/descriptor_hash_index.h"
 #include "mediapipe/util/tracking/measure_time.h"
 
 namespace mediapipe {
@@ -92,10 +95,41 @@ class BoxDetectorOpencvBfImpl : public BoxDetectorInterface {
   cv::BFMatcher bf_matcher_;
 };
 
+// Using a DescriptorHashIndex shared across all boxes to find match candidates
+// for all boxes at once, followed by exact distance verification and a cross
+// check that keeps the closest frame feature per indexed feature. Query cost
+// grows with the number of candidates instead of the number of indexed
+// features, which allows detecting among a large number of boxes.
+class BoxDetectorHashedImpl : public BoxDetectorInterface {
+ public:
+  explicit BoxDetectorHashedImpl(const BoxDetectorOptions &options);
+
+ private:
+  void PrepareMatching(const std::vector<Vector2_f> &features,
+                       const cv::Mat &descriptors) override;
+
+  void OnBoxFeaturesAdded(int box_idx, int first_row) override;
+
+  void OnBoxRemoved(int box_idx) override;
+
+  std::vector<FeatureCorrespondence> MatchFeatureDescriptors(
+      const std::vector<Vector2_f> &features, const cv::Mat &descriptors,
+      int box_idx) override;
+
+  DescriptorHashIndex::Options index_options_;
+  // Created with the descriptor dimensions of the first added box.
+  std::unique_ptr<DescriptorHashIndex> index_;
+  // Closest indexed feature per frame feature and box id, found by the last
+  // PrepareMatching call. `trainIdx` is the row in the box's descriptors.
+  absl::flat_hash_map<int, std::vector<cv::DMatch>> box_matches_;
+};
+
 std::unique_ptr<BoxDetectorInterface> BoxDetectorInterface::Create(
     const BoxDetectorOptions &options) {
   if (options.index_type() == BoxDetectorOptions::OPENCV_BF) {
     return absl::make_unique<BoxDetectorOpencvBfImpl>(options);
+  } else if (options.index_type() == BoxDetectorOptions::HASHED_LSH) {
+    return absl::make_unique<BoxDetectorHashedImpl>(options);
   } else {
     LOG(FATAL) << "index type undefined.";
   }
@@ -153,21 +187,30 @@ void BoxDetectorInterface::DetectAndAddBoxFromFeatures(
     }
   }
 
+  std::vector<int> detect_idx;
   for (int idx = 0; idx < size_before_add; ++idx) {
     if ((options_.detect_every_n_frame() > 0 &&
          cnt_detect_called_ % options_.detect_every_n_frame() == 0) ||
         !tracked[idx] ||
         (options_.detect_out_of_fov() && has_been_out_of_fov_[idx])) {
-      TimedBoxProtoList det = DetectBox(features, descriptors, idx);
-      if (det.box_size() > 0) {
-        det.mutable_box(0)->set_time_msec(timestamp_msec);
+      detect_idx.push_back(idx);
+    }
+  }
 
-        // Convert the result box to normalized space.
-        ScaleBox(1.0f / scale_x, 1.0f / scale_y, det.mutable_box(0));
-        *detected_boxes->add_box() = det.box(0);
+  if (!detect_idx.empty()) {
+    PrepareMatching(features, descriptors);
+  }
 
-        has_been_out_of_fov_[idx] = false;
-      }
+  for (int idx : detect_idx) {
+    TimedBoxProtoList det = DetectBox(features, descriptors, idx);
+    if (det.box_size() > 0) {
+      det.mutable_box(0)->set_time_msec(timestamp_msec);
+
+      // Convert the result box to normalized space.
+      ScaleBox(1.0f / scale_x, 1.0f / scale_y, det.mutable_box(0));
+      *detected_boxes->add_box() = det.box(0);
+
+      has_been_out_of_fov_[idx] = false;
     }
   }
 
@@ -578,6 +621,7 @@ void BoxDetectorInterface::AddBoxFeaturesToIndex(
 
     cv::Mat box_descriptors =
         GetDescriptorsWithIndices(descriptors, insider_idx);
+    const int first_row = feature_descriptors_[box_idx].rows;
     if (feature_descriptors_[box_idx].rows == 0) {
       feature_descriptors_[box_idx] = box_descriptors;
     } else {
@@ -619,6 +663,8 @@ void BoxDetectorInterface::AddBoxFeaturesToIndex(
     for (int j = 0; j < insider_idx.size(); ++j) {
       feature_to_frame_[box_idx].push_back(frame_id);
     }
+
+    OnBoxFeaturesAdded(box_idx, first_row);
   }
 }
 
@@ -630,6 +676,7 @@ void BoxDetectorInterface::CancelBoxDetection(int box_id) {
     return;
   } else {
     const int erase_idx = iter->second;
+    OnBoxRemoved(erase_idx);
     frame_box_.erase(frame_box_.begin() + erase_idx);
     feature_to_frame_.erase(feature_to_frame_.begin() + erase_idx);
     feature_keypoints_.erase(feature_keypoints_.begin() + erase_idx);
@@ -746,4 +793,125 @@ BoxDetectorOpencvBfImpl::MatchFeatureDescriptors(
   return correspondence_result;
 }
 
+BoxDetectorHashedImpl::BoxDetectorHashedImpl(const BoxDetectorOptions &options)
+    : BoxDetectorInterface(options) {
+  const auto &settings = options.hashed_index_settings();
+  index_options_.num_tables = settings.num_tables();
+  index_options_.bits_per_key = settings.bits_per_key();
+  index_options_.multi_probe = settings.multi_probe();
+  index_options_.max_hamming_distance = settings.max_hamming_distance();
+  index_options_.seed = settings.seed();
+}
+
+void BoxDetectorHashedImpl::OnBoxFeaturesAdded(int box_idx, int first_row) {
+  const cv::Mat &descriptors = feature_descriptors_[box_idx];
+  CHECK_EQ(descriptors.type(), CV_32F);
+  CHECK(descriptors.isContinuous());
+  if (!index_) {
+    index_ = absl::make_unique<DescriptorHashIndex>(descriptors.cols,
+                                                    index_options_);
+  }
+  CHECK_EQ(descriptors.cols, index_->dims());
+
+  const int box_id = box_idx_to_id_[box_idx];
+  CHECK_EQ(index_->NumRows(box_id), first_row);
+  index_->Add(box_id, descriptors.ptr<float>(first_row),
+              descriptors.rows - first_row);
+}
+
+void BoxDetectorHashedImpl::OnBoxRemoved(int box_idx) {
+  if (index_) {
+    index_->Remove(box_idx_to_id_[box_idx]);
+  }
+}
+
+void BoxDetectorHashedImpl::PrepareMatching(
+    const std::vector<Vector2_f> &features, const cv::Mat &descriptors) {
+  box_matches_.clear();
+  if (!index_ || descriptors.rows == 0 || descriptors.cols == 0) {
+    return;
+  }
+
+  cv::Mat query_descriptors;
+  descriptors.convertTo(query_descriptors, CV_32F);
+  CHECK_EQ(query_descriptors.cols, index_->dims());
+
+  const int dims = index_->dims();
+  const float max_distance_sq =
+      options_.max_match_distance() * options_.max_match_distance();
+  absl::flat_hash_map<int, cv::DMatch> best_per_box;
+  for (int q = 0; q < query_descriptors.rows; ++q) {
+    const float *query = query_descriptors.ptr<float>(q);
+    best_per_box.clear();
+    for (const auto &candidate : index_->Query(query)) {
+      const int box_idx = box_id_to_idx_.at(candidate.id);
+      const float *indexed =
+          feature_descriptors_[box_idx].ptr<float>(candidate.row);
+      float distance_sq = 0.0f;
+      for (int d = 0; d < dims; ++d) {
+        const float diff = query[d] - indexed[d];
+        distance_sq += diff * diff;
+      }
+      if (distance_sq > max_distance_sq) continue;
+
+      auto iter = best_per_box.find(candidate.id);
+      if (iter == best_per_box.end()) {
+        best_per_box[candidate.id] = cv::DMatch(q, candidate.row, distance_sq);
+      } else if (distance_sq < iter->second.distance) {
+        iter->second = cv::DMatch(q, candidate.row, distance_sq);
+      }
+    }
+
+    for (auto &entry : best_per_box) {
+      entry.second.distance = std::sqrt(entry.second.distance);
+      box_matches_[entry.first].push_back(entry.second);
+    }
+  }
+}
+
+std::vector<FeatureCorrespondence>
+BoxDetectorHashedImpl::MatchFeatureDescriptors(
+    const std::vector<Vector2_f> &features, const cv::Mat &descriptors,
+    int box_idx) {
+  CHECK_EQ(features.size(), descriptors.rows);
+
+  std::vector<FeatureCorrespondence> correspondence_result(
+      frame_box_[box_idx].size());
+  const auto iter = box_matches_.find(box_idx_to_id_[box_idx]);
+  if (iter == box_matches_.end()) {
+    return correspondence_result;
+  }
+
+  // Cross check: keep the closest frame feature per indexed feature.
+  std::vector<cv::DMatch> matches = iter->second;
+  std::sort(matches.begin(), matches.end(),
+            [](const cv::DMatch &lhs, const cv::DMatch &rhs) {
+              return lhs.trainIdx != rhs.trainIdx
+                         ? lhs.trainIdx < rhs.trainIdx
+                         : lhs.distance < rhs.distance;
+            });
+  matches.erase(std::unique(matches.begin(), matches.end(),
+                            [](const cv::DMatch &lhs, const cv::DMatch &rhs) {
+                              return lhs.trainIdx == rhs.trainIdx;
+                            }),
+                matches.end());
+  // Restore frame feature order, as produced by the brute force matcher.
+  std::sort(matches.begin(), matches.end(),
+            [](const cv::DMatch &lhs, const cv::DMatch &rhs) {
+              return lhs.queryIdx < rhs.queryIdx;
+            });
+
+  for (const cv::DMatch &match : matches) {
+    int match_idx = feature_to_frame_[box_idx][match.trainIdx];
+
+    correspondence_result[match_idx].points_frame.push_back(cv::Point2f(
+        features[match.queryIdx].x(), features[match.queryIdx].y()));
+    correspondence_result[match_idx].points_index.push_back(
+        cv::Point2f(feature_keypoints_[box_idx][match.trainIdx].x(),
+                    feature_keypoints_[box_idx][match.trainIdx].y()));
+  }
+
+  return correspondence_result;
+}
+
 }  // namespace mediapipe
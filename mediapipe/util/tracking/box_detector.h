@@ -136,6 +136,19 @@ class BoxDetectorInterface {
       const std::vector<Vector2_f> &features, const cv::Mat &descriptors,
       int box_idx) = 0;
 
+  // Called once per detection pass, before MatchFeatureDescriptors is invoked
+  // for each box with the same `descriptors`. Implementations can query an
+  // index shared across boxes here.
+  virtual void PrepareMatching(const std::vector<Vector2_f> &features,
+                               const cv::Mat &descriptors) {}
+
+  // Called after rows starting at `first_row` have been appended to
+  // `feature_descriptors_[box_idx]`, to update the implementation's index.
+  virtual void OnBoxFeaturesAdded(int box_idx, int first_row) {}
+
+  // Called before box with `box_idx` is removed from the index.
+  virtual void OnBoxRemoved(int box_idx) {}
+
   // Specifies which box the correspondences come from with `box_id`, so that we
   // can figure out the transformation accordingly.
   TimedBoxProtoList FindBoxesFromFeatureCorrespondence(
@@ -314,9 +314,9 @@ void BoxTracker::NewBoxTrackAsync(const TimedBox& initial_pos, int id,
 
   VLOG(1) << "Starting at chunk " << chunk_idx;
 
-  AugmentedChunkPtr tracking_chunk(ReadChunk(id, kInitCheckpoint, chunk_idx));
+  ChunkPtr tracking_chunk = ReadChunk(id, kInitCheckpoint, chunk_idx);
 
-  if (!tracking_chunk.first) {
+  if (!tracking_chunk) {
     absl::MutexLock lock(&status_mutex_);
     --track_status_[id][kInitCheckpoint].tracks_ongoing;
     LOG(ERROR) << "Could not read tracking chunk from file: " << chunk_idx
@@ -324,21 +324,15 @@ void BoxTracker::NewBoxTrackAsync(const TimedBox& initial_pos, int id,
     return;
   }
 
-  // Grab ownership here, to avoid any memory leaks due to early return.
-  std::unique_ptr<const TrackingDataChunk> chunk_owned;
-  if (tracking_chunk.second) {
-    chunk_owned.reset(tracking_chunk.first);
-  }
-
   const int start_frame =
-      ClosestFrameIndex(initial_pos.time_msec, *tracking_chunk.first);
+      ClosestFrameIndex(initial_pos.time_msec, *tracking_chunk);
 
   VLOG(1) << "Local start frame: " << start_frame;
 
   // Update starting position to coincide with a frame.
   TimedBox start_pos = initial_pos;
   start_pos.time_msec =
-      tracking_chunk.first->item(start_frame).timestamp_usec() / 1000;
+      tracking_chunk->item(start_frame).timestamp_usec() / 1000;
 
   VLOG(1) << "Request at " << initial_pos.time_msec << " revised to "
           << start_pos.time_msec;
@@ -375,27 +369,20 @@ void BoxTracker::NewBoxTrackAsync(const TimedBox& initial_pos, int id,
 
   VLOG(1) << "Starting tracking workers ... ";
 
-  AugmentedChunkPtr forward_chunk = tracking_chunk;
-  AugmentedChunkPtr backward_chunk = tracking_chunk;
-
-  if (tracking_chunk.second) {  // We have ownership, need a copy here.
-    forward_chunk = std::make_pair(new TrackingDataChunk(*chunk_owned), true);
-    backward_chunk = std::make_pair(chunk_owned.release(), true);
-  }
-
-  auto forward_operation = [this, forward_chunk, start_state, start_frame,
+  // Both directions share the read-only chunk.
+  auto forward_operation = [this, tracking_chunk, start_state, start_frame,
                             chunk_idx, id, checkpoint, min_msec, max_msec]() {
-    this->TrackingImpl(TrackingImplArgs(forward_chunk, start_state, start_frame,
-                                        chunk_idx, id, checkpoint, true, true,
-                                        min_msec, max_msec));
+    this->TrackingImpl(TrackingImplArgs(tracking_chunk, start_state,
+                                        start_frame, chunk_idx, id, checkpoint,
+                                        true, true, min_msec, max_msec));
   };
 
   tracking_workers_->Schedule(forward_operation);
 
   // Track backward.
-  auto backward_operation = [this, backward_chunk, start_state, start_frame,
+  auto backward_operation = [this, tracking_chunk, start_state, start_frame,
                              chunk_idx, id, checkpoint, min_msec, max_msec]() {
-    this->TrackingImpl(TrackingImplArgs(backward_chunk, start_state,
+    this->TrackingImpl(TrackingImplArgs(tracking_chunk, start_state,
                                         start_frame, chunk_idx, id, checkpoint,
                                         false, true, min_msec, max_msec));
   };
@@ -579,21 +566,49 @@ bool BoxTracker::IsTrackingOngoingMutexHeld() {
   return false;
 }
 
-BoxTracker::AugmentedChunkPtr BoxTracker::ReadChunk(int id, int checkpoint,
-                                                    int chunk_idx) {
+BoxTracker::ChunkPtr BoxTracker::ReadChunk(int id, int checkpoint,
+                                           int chunk_idx) {
   VLOG(1) << __FUNCTION__ << " id=" << id << " chunk_idx=" << chunk_idx;
   if (cache_dir_.empty() && !tracking_data_.empty()) {
     if (chunk_idx < tracking_data_.size()) {
-      return std::make_pair(tracking_data_[chunk_idx], false);
+      // Non-owning pointer, tracking_data_ outlives all tracks.
+      return ChunkPtr(ChunkPtr(), tracking_data_[chunk_idx]);
     } else {
       LOG(ERROR) << "chunk_idx >= tracking_data_.size()";
-      return std::make_pair(nullptr, false);
+      return nullptr;
     }
-  } else {
-    std::unique_ptr<TrackingDataChunk> chunk_data(
-        ReadChunkFromCache(id, checkpoint, chunk_idx));
-    return std::make_pair(chunk_data.release(), true);
   }
+
+  const int max_cached_chunks = options_.max_cached_chunks();
+  {
+    absl::MutexLock lock(&chunk_cache_mutex_);
+    for (auto entry = chunk_cache_.begin(); entry != chunk_cache_.end();
+         ++entry) {
+      if (entry->first == chunk_idx) {
+        // Move to front as most recently used.
+        chunk_cache_.splice(chunk_cache_.begin(), chunk_cache_, entry);
+        return chunk_cache_.front().second;
+      }
+    }
+  }
+
+  ChunkPtr chunk_data = ReadChunkFromCache(id, checkpoint, chunk_idx);
+  if (chunk_data == nullptr || max_cached_chunks <= 0) {
+    return chunk_data;
+  }
+
+  absl::MutexLock lock(&chunk_cache_mutex_);
+  // Another track might have read the same chunk in the meantime.
+  for (const auto& entry : chunk_cache_) {
+    if (entry.first == chunk_idx) {
+      return entry.second;
+    }
+  }
+  chunk_cache_.emplace_front(chunk_idx, chunk_data);
+  while (chunk_cache_.size() > max_cached_chunks) {
+    chunk_cache_.pop_back();
+  }
+  return chunk_data;
 }
 
 std::unique_ptr<TrackingDataChunk> BoxTracker::ReadChunkFromCache(
@@ -820,10 +835,9 @@ void BoxTracker::TrackingImpl(const TrackingImplArgs& a) {
 
       if (f + 2 == chunk_data_size && !a.chunk_data->last_chunk()) {
         // Last frame, successful track, continue;
-        AugmentedChunkPtr next_chunk(
-            ReadChunk(a.id, a.checkpoint, a.chunk_idx + 1));
+        ChunkPtr next_chunk = ReadChunk(a.id, a.checkpoint, a.chunk_idx + 1);
 
-        if (next_chunk.first != nullptr) {
+        if (next_chunk != nullptr) {
           TrackingImplArgs next_args(next_chunk, motion_box.StateAtFrame(f + 1),
                                      0, a.chunk_idx + 1, a.id, a.checkpoint,
                                      a.forward, false, a.min_msec, a.max_msec);
@@ -880,10 +894,9 @@ void BoxTracker::TrackingImpl(const TrackingImplArgs& a) {
         VLOG(1) << "Read next chunk: " << f << "==" << first_frame << " in "
                 << a.chunk_idx;
         // First frame, successful track, continue.
-        AugmentedChunkPtr prev_chunk(
-            ReadChunk(a.id, a.checkpoint, a.chunk_idx - 1));
-        if (prev_chunk.first != nullptr) {
-          const int last_frame = prev_chunk.first->item_size() - 1;
+        ChunkPtr prev_chunk = ReadChunk(a.id, a.checkpoint, a.chunk_idx - 1);
+        if (prev_chunk != nullptr) {
+          const int last_frame = prev_chunk->item_size() - 1;
           TrackingImplArgs prev_args(prev_chunk, motion_box.StateAtFrame(f - 1),
                                      last_frame, a.chunk_idx - 1, a.id,
                                      a.checkpoint, a.forward, false, a.min_msec,
@@ -1035,26 +1048,21 @@ bool BoxTracker::GetTrackingData(int id, int64 request_time_msec,
 
   int chunk_idx = ChunkIdxFromTime(request_time_msec);
 
-  AugmentedChunkPtr tracking_chunk(ReadChunk(id, kInitCheckpoint, chunk_idx));
-  if (!tracking_chunk.first) {
+  ChunkPtr tracking_chunk = ReadChunk(id, kInitCheckpoint, chunk_idx);
+  if (!tracking_chunk) {
     absl::MutexLock lock(&status_mutex_);
     --track_status_[id][kInitCheckpoint].tracks_ongoing;
     LOG(ERROR) << "Could not read tracking chunk from file.";
     return false;
   }
 
-  std::unique_ptr<const TrackingDataChunk> owned_chunk;
-  if (tracking_chunk.second) {
-    owned_chunk.reset(tracking_chunk.first);
-  }
-
   const int closest_frame =
-      ClosestFrameIndex(request_time_msec, *tracking_chunk.first);
+      ClosestFrameIndex(request_time_msec, *tracking_chunk);
 
-  *tracking_data = tracking_chunk.first->item(closest_frame).tracking_data();
+  *tracking_data = tracking_chunk->item(closest_frame).tracking_data();
   if (tracking_data_msec) {
     *tracking_data_msec =
-        tracking_chunk.first->item(closest_frame).timestamp_usec() / 1000;
+        tracking_chunk->item(closest_frame).timestamp_usec() / 1000;
   }
   return true;
 }
@@ -17,8 +17,11 @@
 
 #include <inttypes.h>
 
+#include <list>
 #include <map>
+#include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/str_format.h"
@@ -215,8 +218,8 @@ class BoxTracker {
       ABSL_LOCKS_EXCLUDED(status_mutex_);
 
   // Debug function to obtain raw TrackingData closest to the specified
-  // timestamp. This call will read from disk on every invocation so it is
-  // expensive.
+  // timestamp. This call reads from disk unless the chunk is among the
+  // max_cached_chunks most recently read ones.
   // To not interfere with other tracking requests it is recommended that you
   // use a unique id here.
   // Returns true on success.
@@ -230,13 +233,16 @@ class BoxTracker {
   void NewBoxTrackAsync(const TimedBox& initial_pos, int id, int64 min_msec,
                         int64 max_msec);
 
-  typedef std::pair<const TrackingDataChunk*, bool> AugmentedChunkPtr;
+  // Shared pointer to a TrackingDataChunk. Does not own the chunk if it points
+  // to tracking data passed to the BoxTracker without copy_data.
+  typedef std::shared_ptr<const TrackingDataChunk> ChunkPtr;
+
   // Attempts to read chunk at chunk_idx if it exists. Reads from cache
-  // directory or from in memory cache.
-  // Important: 2nd part of return value indicates if returned tracking data
-  // will be owned by the caller (if true). In that case caller is responsible
-  // for releasing the returned chunk.
-  AugmentedChunkPtr ReadChunk(int id, int checkpoint, int chunk_idx);
+  // directory or from in memory cache. Chunks read from the cache directory
+  // are kept in an LRU of size max_cached_chunks that is shared by all tracks.
+  // Returns nullptr if the chunk could not be read.
+  ChunkPtr ReadChunk(int id, int checkpoint, int chunk_idx)
+      ABSL_LOCKS_EXCLUDED(chunk_cache_mutex_);
 
   // Attempts to read specified chunk from caching directory. Blocks and waits
   // until chunk is available or internal time out is reached.
@@ -259,11 +265,12 @@ class BoxTracker {
   // Callback can only handle 5 args max.
   // Set own_data to true for args to assume ownership.
   struct TrackingImplArgs {
-    TrackingImplArgs(AugmentedChunkPtr chunk_ptr,
-                     const MotionBoxState& start_state_, int start_frame_,
-                     int chunk_idx_, int id_, int checkpoint_, bool forward_,
-                     bool first_call_, int64 min_msec_, int64 max_msec_)
-        : start_state(start_state_),
+    TrackingImplArgs(ChunkPtr chunk_ptr, const MotionBoxState& start_state_,
+                     int start_frame_, int chunk_idx_, int id_, int checkpoint_,
+                     bool forward_, bool first_call_, int64 min_msec_,
+                     int64 max_msec_)
+        : chunk_data_buffer(std::move(chunk_ptr)),
+          start_state(start_state_),
           start_frame(start_frame_),
           chunk_idx(chunk_idx_),
           id(id_),
@@ -272,20 +279,15 @@ class BoxTracker {
           first_call(first_call_),
           min_msec(min_msec_),
           max_msec(max_msec_) {
-      if (chunk_ptr.second) {
-        chunk_data_buffer.reset(chunk_ptr.first);
-      }
-
-      chunk_data = chunk_ptr.first;
+      chunk_data = chunk_data_buffer.get();
     }
 
     TrackingImplArgs(const TrackingImplArgs&) = default;
 
-    // Storage for tracking data.
-    std::shared_ptr<const TrackingDataChunk> chunk_data_buffer;
+    // Keeps the tracking data alive while tracking.
+    ChunkPtr chunk_data_buffer;
 
-    // Pointer to the actual tracking data. Usually points to the buffer
-    // but can also point to external data for performance reasons.
+    // Pointer to the actual tracking data held by the buffer.
     const TrackingDataChunk* chunk_data;
 
     MotionBoxState start_state;
@@ -364,6 +366,13 @@ class BoxTracker {
   // Buffer for tracking data in case we retain a deep copy.
   std::vector<std::unique_ptr<TrackingDataChunk>> tracking_data_buffer_;
 
+  // Most recently read chunks from cache_dir_ keyed by chunk index, most
+  // recently used first. Shared by all tracks to avoid reading and parsing
+  // the same chunk once per tracked box.
+  std::list<std::pair<int, ChunkPtr>> chunk_cache_
+      ABSL_GUARDED_BY(chunk_cache_mutex_);
+  absl::Mutex chunk_cache_mutex_;
+
   // Workers that run the tracking algorithm.
   std::unique_ptr<ThreadPool> tracking_workers_;
 };
@@ -112,6 +112,46 @@ TEST(BoxTrackerTest, MovingBoxTest) {
   }
 }
 
+// Tracks several boxes concurrently over the shared in-memory chunk cache.
+TEST(BoxTrackerTest, ParallelBoxesTest) {
+  const std::string cache_dir =
+      file::JoinPath("./", "/mediapipe/util/tracking/testdata/box_tracker");
+  BoxTrackerOptions options;
+  options.set_max_cached_chunks(2);
+  BoxTracker box_tracker(cache_dir, options);
+
+  constexpr int kNumBoxes = 16;
+  for (int id = 0; id < kNumBoxes; ++id) {
+    TimedBox initial_pos;
+    initial_pos.left = 50.0 / kWidth;
+    initial_pos.top = 400.0 / kHeight;
+    initial_pos.right = initial_pos.left + 220.0 / kWidth;
+    initial_pos.bottom = initial_pos.top + 252.0 / kHeight;
+    initial_pos.time_msec = 3000;
+    box_tracker.NewBoxTrack(initial_pos, id);
+  }
+
+  box_tracker.WaitForAllOngoingTracks();
+
+  // All boxes start at the same position, so they need to agree everywhere.
+  const std::pair<int64, int64> interval = box_tracker.TrackInterval(0);
+  EXPECT_EQ(0, interval.first);
+  EXPECT_GT(interval.second, 15000);
+  for (int id = 1; id < kNumBoxes; ++id) {
+    EXPECT_EQ(interval, box_tracker.TrackInterval(id));
+    for (int k = 0; k < 15000; k += 500) {
+      TimedBox expected;
+      TimedBox box;
+      ASSERT_TRUE(box_tracker.GetTimedPosition(0, k, &expected));
+      ASSERT_TRUE(box_tracker.GetTimedPosition(id, k, &box));
+      EXPECT_FLOAT_EQ(expected.top, box.top);
+      EXPECT_FLOAT_EQ(expected.left, box.left);
+      EXPECT_FLOAT_EQ(expected.bottom, box.bottom);
+      EXPECT_FLOAT_EQ(expected.right, box.right);
+    }
+  }
+}
+
 }  // namespace
 
 }  // namespace mediapipe
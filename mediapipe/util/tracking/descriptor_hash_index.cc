@@ -0,0 +1,179 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/descriptor_hash_index.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include "absl/numeric/bits.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr int kCodeBits = 64;
+
+}  // namespace
+
+DescriptorHashIndex::DescriptorHashIndex(int dims, const Options& options)
+    : dims_(dims), options_(options) {
+  CHECK_GT(dims_, 0);
+  CHECK_GT(options_.num_tables, 0);
+  CHECK_GT(options_.bits_per_key, 0);
+  CHECK_LE(options_.bits_per_key, 32);
+
+  std::mt19937 rng(options_.seed);
+  std::normal_distribution<float> normal(0.0f, 1.0f);
+  hyperplanes_.resize(kCodeBits * dims_);
+  for (float& value : hyperplanes_) {
+    value = normal(rng);
+  }
+
+  std::vector<int> bits(kCodeBits);
+  std::iota(bits.begin(), bits.end(), 0);
+  key_bits_.resize(options_.num_tables);
+  for (auto& key_bits : key_bits_) {
+    std::shuffle(bits.begin(), bits.end(), rng);
+    key_bits.assign(bits.begin(), bits.begin() + options_.bits_per_key);
+  }
+  tables_.resize(options_.num_tables);
+}
+
+uint64 DescriptorHashIndex::Binarize(const float* descriptor) const {
+  uint64 code = 0;
+  const float* hyperplane = hyperplanes_.data();
+  for (int i = 0; i < kCodeBits; ++i, hyperplane += dims_) {
+    float projection = 0.0f;
+    for (int j = 0; j < dims_; ++j) {
+      projection += hyperplane[j] * descriptor[j];
+    }
+    if (projection > 0.0f) {
+      code |= uint64{1} << i;
+    }
+  }
+  return code;
+}
+
+uint32 DescriptorHashIndex::TableKey(int table, uint64 code) const {
+  uint32 key = 0;
+  const std::vector<int>& key_bits = key_bits_[table];
+  for (int b = 0; b < key_bits.size(); ++b) {
+    key |= static_cast<uint32>((code >> key_bits[b]) & 1) << b;
+  }
+  return key;
+}
+
+void DescriptorHashIndex::Add(int id, const float* descriptors, int num_rows) {
+  std::vector<int>& id_slots = id_slots_[id];
+  for (int r = 0; r < num_rows; ++r) {
+    int slot_idx;
+    if (free_slots_.empty()) {
+      slot_idx = slots_.size();
+      slots_.emplace_back();
+      slot_visits_.push_back(0);
+    } else {
+      slot_idx = free_slots_.back();
+      free_slots_.pop_back();
+    }
+
+    Slot& slot = slots_[slot_idx];
+    slot.code = Binarize(descriptors + r * dims_);
+    slot.id = id;
+    slot.row = id_slots.size();
+    id_slots.push_back(slot_idx);
+
+    for (int t = 0; t < tables_.size(); ++t) {
+      tables_[t][TableKey(t, slot.code)].push_back(slot_idx);
+    }
+  }
+}
+
+void DescriptorHashIndex::Remove(int id) {
+  auto iter = id_slots_.find(id);
+  if (iter == id_slots_.end()) {
+    return;
+  }
+
+  for (int slot_idx : iter->second) {
+    const uint64 code = slots_[slot_idx].code;
+    for (int t = 0; t < tables_.size(); ++t) {
+      auto bucket_iter = tables_[t].find(TableKey(t, code));
+      CHECK(bucket_iter != tables_[t].end());
+      std::vector<int>& bucket = bucket_iter->second;
+      auto pos = std::find(bucket.begin(), bucket.end(), slot_idx);
+      CHECK(pos != bucket.end());
+      *pos = bucket.back();
+      bucket.pop_back();
+      if (bucket.empty()) {
+        tables_[t].erase(bucket_iter);
+      }
+    }
+    slots_[slot_idx].id = -1;
+    free_slots_.push_back(slot_idx);
+  }
+  id_slots_.erase(iter);
+}
+
+int DescriptorHashIndex::NumRows(int id) const {
+  auto iter = id_slots_.find(id);
+  return iter == id_slots_.end() ? 0 : iter->second.size();
+}
+
+void DescriptorHashIndex::ProbeBucket(int table, uint32 key, uint64 code,
+                                      std::vector<Candidate>* candidates) {
+  auto iter = tables_[table].find(key);
+  if (iter == tables_[table].end()) {
+    return;
+  }
+
+  for (int slot_idx : iter->second) {
+    if (slot_visits_[slot_idx] == num_queries_) {
+      continue;
+    }
+    slot_visits_[slot_idx] = num_queries_;
+
+    const Slot& slot = slots_[slot_idx];
+    const int hamming_distance = absl::popcount(code ^ slot.code);
+    if (hamming_distance <= options_.max_hamming_distance) {
+      candidates->push_back({slot.id, slot.row, hamming_distance});
+    }
+  }
+}
+
+std::vector<DescriptorHashIndex::Candidate> DescriptorHashIndex::Query(
+    const float* descriptor) {
+  if (++num_queries_ == 0) {
+    // Wrapped around, forget all visits.
+    std::fill(slot_visits_.begin(), slot_visits_.end(), 0);
+    num_queries_ = 1;
+  }
+
+  std::vector<Candidate> candidates;
+  const uint64 code = Binarize(descriptor);
+  for (int t = 0; t < tables_.size(); ++t) {
+    const uint32 key = TableKey(t, code);
+    ProbeBucket(t, key, code, &candidates);
+    if (options_.multi_probe) {
+      for (int b = 0; b < options_.bits_per_key; ++b) {
+        ProbeBucket(t, key ^ (uint32{1} << b), code, &candidates);
+      }
+    }
+  }
+  return candidates;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,120 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_TRACKING_DESCRIPTOR_HASH_INDEX_H_
+#define MEDIAPIPE_UTIL_TRACKING_DESCRIPTOR_HASH_INDEX_H_
+
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// Approximate nearest neighbor index for float feature descriptors, used by
+// BoxDetector to match frame features against a large number of boxes.
+//
+// Each descriptor is binarized into a 64 bit code, bit i being the sign of its
+// projection onto random hyperplane i, so that the Hamming distance between
+// codes approximates the angle between descriptors. Codes are bucketed by
+// several hash tables, each keyed on a random subset of code bits (bit
+// sampling LSH). A query probes the bucket with its own key in every table,
+// optionally along with all buckets one bit away (multi-probe), and returns
+// the indexed descriptors whose code is within a Hamming distance threshold,
+// computed by popcount.
+//
+// Indexed descriptors are identified by an `id` (e.g. box id) and a `row`,
+// the running count of descriptors added under that id. Descriptors can be
+// added incrementally and removed per id. Descriptor data is not stored;
+// callers verify candidates against their own copy.
+//
+// Not thread-safe.
+class DescriptorHashIndex {
+ public:
+  struct Options {
+    // Number of hash tables.
+    int num_tables = 6;
+    // Number of code bits per table key, in [1, 32].
+    int bits_per_key = 16;
+    // Also probe all buckets whose key differs by one bit.
+    bool multi_probe = true;
+    // Max Hamming distance between query and candidate codes.
+    int max_hamming_distance = 20;
+    // Seed for hyperplanes and bit sampling.
+    uint32 seed = 0;
+  };
+
+  struct Candidate {
+    int id;
+    int row;
+    int hamming_distance;
+  };
+
+  // `dims` is the number of elements of each descriptor.
+  DescriptorHashIndex(int dims, const Options& options);
+
+  int dims() const { return dims_; }
+
+  // Returns the 64 bit sign code of `descriptor` with `dims` elements.
+  uint64 Binarize(const float* descriptor) const;
+
+  // Adds `num_rows` consecutive descriptors with `dims` elements each under
+  // `id`. Their rows continue from NumRows(id).
+  void Add(int id, const float* descriptors, int num_rows);
+
+  // Removes all descriptors added under `id`.
+  void Remove(int id);
+
+  // Number of descriptors added under `id`.
+  int NumRows(int id) const;
+
+  // Total number of indexed descriptors.
+  int size() const { return slots_.size() - free_slots_.size(); }
+
+  // Returns, without duplicates, all indexed descriptors found by probing
+  // with `descriptor` whose code is within the Hamming distance threshold.
+  std::vector<Candidate> Query(const float* descriptor);
+
+ private:
+  struct Slot {
+    uint64 code;
+    int id;
+    int row;
+  };
+
+  uint32 TableKey(int table, uint64 code) const;
+  void ProbeBucket(int table, uint32 key, uint64 code,
+                   std::vector<Candidate>* candidates);
+
+  const int dims_;
+  const Options options_;
+  // 64 x dims_ hyperplane normals, row major.
+  std::vector<float> hyperplanes_;
+  // Per table, the code bits forming its key.
+  std::vector<std::vector<int>> key_bits_;
+  // Per table, key -> indices into slots_.
+  std::vector<absl::flat_hash_map<uint32, std::vector<int>>> tables_;
+  std::vector<Slot> slots_;
+  std::vector<int> free_slots_;
+  // Slot indices per id, ordered by row.
+  absl::flat_hash_map<int, std::vector<int>> id_slots_;
+  // Per slot, the last query that visited it. Used to skip duplicates across
+  // tables and probes.
+  std::vector<uint32> slot_visits_;
+  uint32 num_queries_ = 0;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_TRACKING_DESCRIPTOR_HASH_INDEX_H_
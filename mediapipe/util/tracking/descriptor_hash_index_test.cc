@@ -0,0 +1,154 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/descriptor_hash_index.h"
+
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kDims = 40;
+
+std::vector<float> RandomDescriptors(int num_rows, std::mt19937* rng) {
+  std::normal_distribution<float> normal(0.0f, 1.0f);
+  std::vector<float> descriptors(num_rows * kDims);
+  for (float& value : descriptors) {
+    value = normal(*rng);
+  }
+  return descriptors;
+}
+
+bool ContainsCandidate(
+    const std::vector<DescriptorHashIndex::Candidate>& candidates, int id,
+    int row) {
+  for (const auto& candidate : candidates) {
+    if (candidate.id == id && candidate.row == row) return true;
+  }
+  return false;
+}
+
+TEST(DescriptorHashIndexTest, FindsIndexedDescriptors) {
+  std::mt19937 rng(1);
+  DescriptorHashIndex index(kDims, DescriptorHashIndex::Options());
+  std::vector<std::vector<float>> descriptors;
+  for (int id = 0; id < 20; ++id) {
+    descriptors.push_back(RandomDescriptors(50, &rng));
+    index.Add(id, descriptors.back().data(), 50);
+  }
+  EXPECT_EQ(index.size(), 1000);
+
+  for (int id = 0; id < 20; ++id) {
+    for (int row = 0; row < 50; ++row) {
+      const auto candidates =
+          index.Query(descriptors[id].data() + row * kDims);
+      ASSERT_TRUE(ContainsCandidate(candidates, id, row));
+      for (const auto& candidate : candidates) {
+        if (candidate.id == id && candidate.row == row) {
+          EXPECT_EQ(candidate.hamming_distance, 0);
+        }
+      }
+    }
+  }
+}
+
+TEST(DescriptorHashIndexTest, FindsPerturbedDescriptors) {
+  std::mt19937 rng(2);
+  DescriptorHashIndex index(kDims, DescriptorHashIndex::Options());
+  const std::vector<float> descriptors = RandomDescriptors(500, &rng);
+  index.Add(7, descriptors.data(), 500);
+
+  std::normal_distribution<float> noise(0.0f, 0.1f);
+  int found = 0;
+  for (int row = 0; row < 500; ++row) {
+    std::vector<float> query(descriptors.begin() + row * kDims,
+                             descriptors.begin() + (row + 1) * kDims);
+    for (float& value : query) {
+      value += noise(rng);
+    }
+    found += ContainsCandidate(index.Query(query.data()), 7, row);
+  }
+  EXPECT_GT(found, 490);
+}
+
+TEST(DescriptorHashIndexTest, RejectsDistantDescriptors) {
+  std::mt19937 rng(3);
+  DescriptorHashIndex index(kDims, DescriptorHashIndex::Options());
+  std::vector<float> descriptors = RandomDescriptors(100, &rng);
+  index.Add(0, descriptors.data(), 100);
+
+  // Opposite descriptors flip every code bit.
+  for (float& value : descriptors) {
+    value = -value;
+  }
+  for (int row = 0; row < 100; ++row) {
+    EXPECT_FALSE(
+        ContainsCandidate(index.Query(descriptors.data() + row * kDims), 0,
+                          row));
+  }
+}
+
+TEST(DescriptorHashIndexTest, ReturnsNoDuplicates) {
+  std::mt19937 rng(4);
+  DescriptorHashIndex::Options options;
+  options.bits_per_key = 4;
+  options.max_hamming_distance = 64;
+  DescriptorHashIndex index(kDims, options);
+  const std::vector<float> descriptors = RandomDescriptors(200, &rng);
+  index.Add(0, descriptors.data(), 200);
+
+  for (int row = 0; row < 10; ++row) {
+    std::set<std::pair<int, int>> unique;
+    const auto candidates = index.Query(descriptors.data() + row * kDims);
+    for (const auto& candidate : candidates) {
+      unique.emplace(candidate.id, candidate.row);
+    }
+    EXPECT_EQ(unique.size(), candidates.size());
+  }
+}
+
+TEST(DescriptorHashIndexTest, AddsIncrementallyAndRemoves) {
+  std::mt19937 rng(5);
+  DescriptorHashIndex index(kDims, DescriptorHashIndex::Options());
+  const std::vector<float> first = RandomDescriptors(10, &rng);
+  const std::vector<float> second = RandomDescriptors(5, &rng);
+  const std::vector<float> other = RandomDescriptors(3, &rng);
+  index.Add(1, first.data(), 10);
+  index.Add(2, other.data(), 3);
+  index.Add(1, second.data(), 5);
+  EXPECT_EQ(index.NumRows(1), 15);
+  EXPECT_EQ(index.NumRows(2), 3);
+  EXPECT_EQ(index.size(), 18);
+  EXPECT_TRUE(ContainsCandidate(index.Query(second.data() + 2 * kDims), 1,
+                                12));
+
+  index.Remove(1);
+  EXPECT_EQ(index.NumRows(1), 0);
+  EXPECT_EQ(index.size(), 3);
+  EXPECT_FALSE(ContainsCandidate(index.Query(first.data()), 1, 0));
+  EXPECT_TRUE(ContainsCandidate(index.Query(other.data() + kDims), 2, 1));
+
+  // Removed slots are reused.
+  index.Add(3, first.data(), 10);
+  EXPECT_EQ(index.size(), 13);
+  EXPECT_TRUE(ContainsCandidate(index.Query(first.data() + 4 * kDims), 3, 4));
+}
+
+}  // namespace
+}  // namespace mediapipe
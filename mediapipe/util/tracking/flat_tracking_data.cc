@@ -0,0 +1,558 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/util/tracking/flat_tracking_data.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "mediapipe/framework/port/core_proto_inc.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+struct FlatChunkHeader {
+  char magic[4];
+  uint32 version;
+  uint32 flags;
+  uint32 num_items;
+};
+
+struct FlatItemIndex {
+  int64 timestamp_usec;
+  int64 prev_timestamp_usec;
+  int32 frame_idx;
+  uint32 offset;
+  uint32 size;
+  uint32 fields;
+};
+
+struct FlatItemHeader {
+  uint32 fields;
+  int32 frame_flags;
+  int32 domain_width;
+  int32 domain_height;
+  float frame_aspect;
+  float background_model[8];
+  uint32 global_feature_count;
+  float average_motion_magnitude;
+  int32 num_elements;
+  uint32 index_encoding;
+  uint32 num_vector_values;
+  uint32 num_track_ids;
+  uint32 num_row_indices;
+  uint32 num_col_starts;
+  uint32 num_discarded_ids;
+  uint32 index_data_size;
+  uint32 num_descriptors;
+  uint32 descriptor_data_size;
+  // Bit k is set if background_model[k] is present.
+  uint32 background_model_fields;
+};
+
+static_assert(sizeof(FlatChunkHeader) == 16, "Unexpected padding");
+static_assert(sizeof(FlatItemIndex) == 32, "Unexpected padding");
+static_assert(sizeof(FlatItemHeader) == 104, "Unexpected padding");
+
+namespace {
+
+constexpr char kFlatChunkMagic[4] = {'F', 'T', 'D', 'C'};
+constexpr uint32 kFlatChunkVersion = 1;
+
+enum FlatChunkFlags {
+  FLAT_CHUNK_FIRST = 1,
+  FLAT_CHUNK_LAST = 2,
+};
+
+// Presence of optional TrackingDataChunk::Item fields.
+enum FlatItemIndexFields {
+  INDEX_HAS_TRACKING_DATA = 1,
+  INDEX_HAS_FRAME_IDX = 2,
+  INDEX_HAS_TIMESTAMP = 4,
+  INDEX_HAS_PREV_TIMESTAMP = 8,
+};
+
+// Presence of optional TrackingData fields.
+enum FlatItemFields {
+  ITEM_HAS_FRAME_FLAGS = 1,
+  ITEM_HAS_DOMAIN_WIDTH = 2,
+  ITEM_HAS_DOMAIN_HEIGHT = 4,
+  ITEM_HAS_FRAME_ASPECT = 8,
+  ITEM_HAS_BACKGROUND_MODEL = 16,
+  ITEM_HAS_MOTION_DATA = 32,
+  ITEM_HAS_NUM_ELEMENTS = 64,
+  ITEM_HAS_GLOBAL_FEATURE_COUNT = 128,
+  ITEM_HAS_AVERAGE_MOTION_MAGNITUDE = 256,
+};
+
+enum IndexEncoding {
+  INDEX_ENCODING_RAW = 0,
+  INDEX_ENCODING_VARINT = 1,
+};
+
+size_t RoundUp(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+void PadTo(size_t alignment, std::string* output) {
+  output->resize(RoundUp(output->size(), alignment), '\0');
+}
+
+template <class T>
+void AppendPod(const T& value, std::string* output) {
+  output->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class Array>
+void AppendRaw(const Array& values, std::string* output) {
+  if (!values.empty()) {
+    output->append(reinterpret_cast<const char*>(values.data()),
+                   values.size() * sizeof(values.Get(0)));
+  }
+}
+
+// Appends the deltas of consecutive values as zig-zag encoded varints.
+template <class Array>
+void AppendDeltaVarints(const Array& values, std::string* output) {
+  int64 prev = 0;
+  for (const int32 value : values) {
+    const int64 delta = value - prev;
+    prev = value;
+    uint64 zig_zag = (static_cast<uint64>(delta) << 1) ^
+                     static_cast<uint64>(delta >> 63);
+    while (zig_zag >= 0x80) {
+      output->push_back(static_cast<char>(zig_zag | 0x80));
+      zig_zag >>= 7;
+    }
+    output->push_back(static_cast<char>(zig_zag));
+  }
+}
+
+// Inverse of AppendDeltaVarints. Returns false on truncated input.
+bool ReadDeltaVarints(int num_values, const uint8** pos, const uint8* end,
+                      proto_ns::RepeatedField<int32>* values) {
+  values->Reserve(num_values);
+  int64 prev = 0;
+  for (int k = 0; k < num_values; ++k) {
+    uint64 zig_zag = 0;
+    for (int shift = 0;; shift += 7) {
+      if (*pos == end || shift > 63) {
+        return false;
+      }
+      const uint8 byte = *(*pos)++;
+      zig_zag |= static_cast<uint64>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        break;
+      }
+    }
+    const int64 delta =
+        static_cast<int64>(zig_zag >> 1) ^ -static_cast<int64>(zig_zag & 1);
+    prev += delta;
+    values->Add(static_cast<int32>(prev));
+  }
+  return true;
+}
+
+void CopyRaw(const char* data, int num_values,
+             proto_ns::RepeatedField<int32>* values) {
+  values->Resize(num_values, 0);
+  if (num_values > 0) {
+    memcpy(values->mutable_data(), data, num_values * sizeof(int32));
+  }
+}
+
+// Returns the size of an item including its payload, without final padding.
+uint64 ItemSize(const FlatItemHeader& header) {
+  return sizeof(FlatItemHeader) +
+         static_cast<uint64>(header.num_vector_values) * sizeof(float) +
+         header.index_data_size + header.descriptor_data_size;
+}
+
+void AppendItem(const TrackingData& tracking_data, bool compress_indices,
+                std::string* output) {
+  const TrackingData::MotionData& motion_data = tracking_data.motion_data();
+  FlatItemHeader header = {};
+  header.fields =
+      (tracking_data.has_frame_flags() ? ITEM_HAS_FRAME_FLAGS : 0) |
+      (tracking_data.has_domain_width() ? ITEM_HAS_DOMAIN_WIDTH : 0) |
+      (tracking_data.has_domain_height() ? ITEM_HAS_DOMAIN_HEIGHT : 0) |
+      (tracking_data.has_frame_aspect() ? ITEM_HAS_FRAME_ASPECT : 0) |
+      (tracking_data.has_background_model() ? ITEM_HAS_BACKGROUND_MODEL : 0) |
+      (tracking_data.has_motion_data() ? ITEM_HAS_MOTION_DATA : 0) |
+      (motion_data.has_num_elements() ? ITEM_HAS_NUM_ELEMENTS : 0) |
+      (tracking_data.has_global_feature_count() ? ITEM_HAS_GLOBAL_FEATURE_COUNT
+                                                : 0) |
+      (tracking_data.has_average_motion_magnitude()
+           ? ITEM_HAS_AVERAGE_MOTION_MAGNITUDE
+           : 0);
+  header.frame_flags = tracking_data.frame_flags();
+  header.domain_width = tracking_data.domain_width();
+  header.domain_height = tracking_data.domain_height();
+  header.frame_aspect = tracking_data.frame_aspect();
+  const Homography& model = tracking_data.background_model();
+  const float background_model[8] = {model.h_00(), model.h_01(), model.h_02(),
+                                     model.h_10(), model.h_11(), model.h_12(),
+                                     model.h_20(), model.h_21()};
+  const bool has_background_model[8] = {
+      model.has_h_00(), model.has_h_01(), model.has_h_02(), model.has_h_10(),
+      model.has_h_11(), model.has_h_12(), model.has_h_20(), model.has_h_21()};
+  for (int k = 0; k < 8; ++k) {
+    header.background_model[k] = background_model[k];
+    header.background_model_fields |= has_background_model[k] << k;
+  }
+  header.global_feature_count = tracking_data.global_feature_count();
+  header.average_motion_magnitude = tracking_data.average_motion_magnitude();
+  header.num_elements = motion_data.num_elements();
+  header.index_encoding =
+      compress_indices ? INDEX_ENCODING_VARINT : INDEX_ENCODING_RAW;
+  header.num_vector_values = motion_data.vector_data_size();
+  header.num_track_ids = motion_data.track_id_size();
+  header.num_row_indices = motion_data.row_indices_size();
+  header.num_col_starts = motion_data.col_starts_size();
+  header.num_discarded_ids = motion_data.actively_discarded_tracked_ids_size();
+  header.num_descriptors = motion_data.feature_descriptors_size();
+
+  std::string index_data;
+  if (compress_indices) {
+    AppendDeltaVarints(motion_data.track_id(), &index_data);
+    AppendDeltaVarints(motion_data.row_indices(), &index_data);
+    AppendDeltaVarints(motion_data.col_starts(), &index_data);
+    AppendDeltaVarints(motion_data.actively_discarded_tracked_ids(),
+                       &index_data);
+    PadTo(4, &index_data);
+  } else {
+    AppendRaw(motion_data.track_id(), &index_data);
+    AppendRaw(motion_data.row_indices(), &index_data);
+    AppendRaw(motion_data.col_starts(), &index_data);
+    AppendRaw(motion_data.actively_discarded_tracked_ids(), &index_data);
+  }
+  header.index_data_size = index_data.size();
+
+  std::string descriptor_data;
+  for (const auto& descriptor : motion_data.feature_descriptors()) {
+    AppendPod(static_cast<uint32>(descriptor.data().size()), &descriptor_data);
+    descriptor_data.append(descriptor.data());
+    PadTo(4, &descriptor_data);
+  }
+  header.descriptor_data_size = descriptor_data.size();
+
+  AppendPod(header, output);
+  AppendRaw(motion_data.vector_data(), output);
+  output->append(index_data);
+  output->append(descriptor_data);
+}
+
+}  // namespace
+
+void EncodeFlatTrackingDataChunk(const TrackingDataChunk& chunk,
+                                 bool compress_indices, std::string* output) {
+  CHECK(output != nullptr);
+  output->clear();
+
+  FlatChunkHeader header;
+  std::copy(kFlatChunkMagic, kFlatChunkMagic + 4, header.magic);
+  header.version = kFlatChunkVersion;
+  header.flags = (chunk.first_chunk() ? FLAT_CHUNK_FIRST : 0) |
+                 (chunk.last_chunk() ? FLAT_CHUNK_LAST : 0);
+  header.num_items = chunk.item_size();
+  AppendPod(header, output);
+
+  // Index is filled in once item offsets are known.
+  const size_t index_offset = output->size();
+  output->resize(index_offset + chunk.item_size() * sizeof(FlatItemIndex));
+
+  for (int k = 0; k < chunk.item_size(); ++k) {
+    const TrackingDataChunk::Item& item = chunk.item(k);
+    PadTo(8, output);
+    FlatItemIndex index;
+    index.timestamp_usec = item.timestamp_usec();
+    index.prev_timestamp_usec = item.prev_timestamp_usec();
+    index.frame_idx = item.frame_idx();
+    index.offset = output->size();
+    index.fields =
+        (item.has_tracking_data() ? INDEX_HAS_TRACKING_DATA : 0) |
+        (item.has_frame_idx() ? INDEX_HAS_FRAME_IDX : 0) |
+        (item.has_timestamp_usec() ? INDEX_HAS_TIMESTAMP : 0) |
+        (item.has_prev_timestamp_usec() ? INDEX_HAS_PREV_TIMESTAMP : 0);
+    AppendItem(item.tracking_data(), compress_indices, output);
+    index.size = output->size() - index.offset;
+    CHECK_LE(output->size(), kuint32max) << "Chunk too large.";
+    memcpy(&(*output)[index_offset + k * sizeof(FlatItemIndex)], &index,
+           sizeof(index));
+  }
+  PadTo(8, output);
+}
+
+bool FlatTrackingDataChunk::Parse(absl::string_view data) {
+  header_ = nullptr;
+  index_ = nullptr;
+  data_ = data;
+  if (reinterpret_cast<uintptr_t>(data.data()) % 8 != 0) {
+    LOG(ERROR) << "Flat chunk data is not 8 byte aligned.";
+    return false;
+  }
+  if (data.size() < sizeof(FlatChunkHeader)) {
+    LOG(ERROR) << "Flat chunk data too small.";
+    return false;
+  }
+  const FlatChunkHeader* header =
+      reinterpret_cast<const FlatChunkHeader*>(data.data());
+  if (!std::equal(kFlatChunkMagic, kFlatChunkMagic + 4, header->magic) ||
+      header->version != kFlatChunkVersion) {
+    LOG(ERROR) << "Not a flat chunk or unsupported version.";
+    return false;
+  }
+  if (sizeof(FlatChunkHeader) +
+          static_cast<uint64>(header->num_items) * sizeof(FlatItemIndex) >
+      data.size()) {
+    LOG(ERROR) << "Flat chunk index is truncated.";
+    return false;
+  }
+  const FlatItemIndex* index = reinterpret_cast<const FlatItemIndex*>(
+      data.data() + sizeof(FlatChunkHeader));
+  for (uint32 k = 0; k < header->num_items; ++k) {
+    if (index[k].offset % 8 != 0 ||
+        static_cast<uint64>(index[k].offset) + index[k].size > data.size() ||
+        index[k].size < sizeof(FlatItemHeader)) {
+      LOG(ERROR) << "Invalid flat chunk item " << k;
+      return false;
+    }
+    const FlatItemHeader& item =
+        *reinterpret_cast<const FlatItemHeader*>(data.data() + index[k].offset);
+    if (ItemSize(item) > index[k].size ||
+        item.index_data_size % 4 != 0 || item.descriptor_data_size % 4 != 0 ||
+        (item.index_encoding == INDEX_ENCODING_RAW &&
+         (static_cast<uint64>(item.num_track_ids) + item.num_row_indices +
+          item.num_col_starts + item.num_discarded_ids) *
+                 sizeof(int32) !=
+             item.index_data_size)) {
+      LOG(ERROR) << "Invalid flat chunk item " << k;
+      return false;
+    }
+  }
+  header_ = header;
+  index_ = index;
+  return true;
+}
+
+int FlatTrackingDataChunk::num_items() const {
+  return header_ ? header_->num_items : 0;
+}
+
+bool FlatTrackingDataChunk::first_chunk() const {
+  return header_ && (header_->flags & FLAT_CHUNK_FIRST);
+}
+
+bool FlatTrackingDataChunk::last_chunk() const {
+  return header_ && (header_->flags & FLAT_CHUNK_LAST);
+}
+
+int64 FlatTrackingDataChunk::timestamp_usec(int item) const {
+  CHECK_LT(item, num_items());
+  return index_[item].timestamp_usec;
+}
+
+int64 FlatTrackingDataChunk::prev_timestamp_usec(int item) const {
+  CHECK_LT(item, num_items());
+  return index_[item].prev_timestamp_usec;
+}
+
+int FlatTrackingDataChunk::frame_idx(int item) const {
+  CHECK_LT(item, num_items());
+  return index_[item].frame_idx;
+}
+
+int FlatTrackingDataChunk::LowerBound(int64 timestamp_usec) const {
+  return std::lower_bound(index_, index_ + num_items(), timestamp_usec,
+                          [](const FlatItemIndex& lhs, int64 rhs) {
+                            return lhs.timestamp_usec < rhs;
+                          }) -
+         index_;
+}
+
+const FlatItemHeader& FlatTrackingDataChunk::ItemHeader(int item) const {
+  return *reinterpret_cast<const FlatItemHeader*>(ItemData(item));
+}
+
+const char* FlatTrackingDataChunk::ItemData(int item) const {
+  CHECK_GE(item, 0);
+  CHECK_LT(item, num_items());
+  return data_.data() + index_[item].offset;
+}
+
+bool FlatTrackingDataChunk::GetMotionData(int item,
+                                          FlatMotionData* motion_data) const {
+  CHECK(motion_data != nullptr);
+  const FlatItemHeader& header = ItemHeader(item);
+  if (!(header.fields & ITEM_HAS_MOTION_DATA) ||
+      header.index_encoding != INDEX_ENCODING_RAW) {
+    return false;
+  }
+
+  motion_data->frame_flags = header.frame_flags;
+  motion_data->domain_width = header.domain_width;
+  motion_data->domain_height = header.domain_height;
+  motion_data->num_elements = header.num_elements;
+
+  const char* payload = ItemData(item) + sizeof(FlatItemHeader);
+  motion_data->vector_data = reinterpret_cast<const float*>(payload);
+  motion_data->num_vector_values = header.num_vector_values;
+  const int32* indices = reinterpret_cast<const int32*>(
+      payload + header.num_vector_values * sizeof(float));
+  motion_data->track_id = indices;
+  motion_data->num_track_ids = header.num_track_ids;
+  indices += header.num_track_ids;
+  motion_data->row_indices = indices;
+  motion_data->num_row_indices = header.num_row_indices;
+  indices += header.num_row_indices;
+  motion_data->col_starts = indices;
+  motion_data->num_col_starts = header.num_col_starts;
+  return true;
+}
+
+bool FlatTrackingDataChunk::DecodeTrackingData(
+    int item, TrackingData* tracking_data) const {
+  CHECK(tracking_data != nullptr);
+  tracking_data->Clear();
+  const FlatItemHeader& header = ItemHeader(item);
+  if (header.fields & ITEM_HAS_FRAME_FLAGS) {
+    tracking_data->set_frame_flags(header.frame_flags);
+  }
+  if (header.fields & ITEM_HAS_DOMAIN_WIDTH) {
+    tracking_data->set_domain_width(header.domain_width);
+  }
+  if (header.fields & ITEM_HAS_DOMAIN_HEIGHT) {
+    tracking_data->set_domain_height(header.domain_height);
+  }
+  if (header.fields & ITEM_HAS_FRAME_ASPECT) {
+    tracking_data->set_frame_aspect(header.frame_aspect);
+  }
+  if (header.fields & ITEM_HAS_BACKGROUND_MODEL) {
+    Homography* model = tracking_data->mutable_background_model();
+    void (Homography::*const setters[8])(float) = {
+        &Homography::set_h_00, &Homography::set_h_01, &Homography::set_h_02,
+        &Homography::set_h_10, &Homography::set_h_11, &Homography::set_h_12,
+        &Homography::set_h_20, &Homography::set_h_21};
+    for (int k = 0; k < 8; ++k) {
+      if (header.background_model_fields & (1 << k)) {
+        (model->*setters[k])(header.background_model[k]);
+      }
+    }
+  }
+  if (header.fields & ITEM_HAS_GLOBAL_FEATURE_COUNT) {
+    tracking_data->set_global_feature_count(header.global_feature_count);
+  }
+  if (header.fields & ITEM_HAS_AVERAGE_MOTION_MAGNITUDE) {
+    tracking_data->set_average_motion_magnitude(
+        header.average_motion_magnitude);
+  }
+  if (!(header.fields & ITEM_HAS_MOTION_DATA)) {
+    return true;
+  }
+
+  TrackingData::MotionData* motion_data = tracking_data->mutable_motion_data();
+  if (header.fields & ITEM_HAS_NUM_ELEMENTS) {
+    motion_data->set_num_elements(header.num_elements);
+  }
+  const char* payload = ItemData(item) + sizeof(FlatItemHeader);
+  motion_data->mutable_vector_data()->Resize(header.num_vector_values, 0);
+  if (header.num_vector_values > 0) {
+    memcpy(motion_data->mutable_vector_data()->mutable_data(), payload,
+           header.num_vector_values * sizeof(float));
+  }
+  payload += header.num_vector_values * sizeof(float);
+
+  if (header.index_encoding == INDEX_ENCODING_RAW) {
+    const char* pos = payload;
+    CopyRaw(pos, header.num_track_ids, motion_data->mutable_track_id());
+    pos += header.num_track_ids * sizeof(int32);
+    CopyRaw(pos, header.num_row_indices, motion_data->mutable_row_indices());
+    pos += header.num_row_indices * sizeof(int32);
+    CopyRaw(pos, header.num_col_starts, motion_data->mutable_col_starts());
+    pos += header.num_col_starts * sizeof(int32);
+    CopyRaw(pos, header.num_discarded_ids,
+            motion_data->mutable_actively_discarded_tracked_ids());
+  } else if (header.index_encoding == INDEX_ENCODING_VARINT) {
+    const uint8* pos = reinterpret_cast<const uint8*>(payload);
+    const uint8* end = pos + header.index_data_size;
+    if (!ReadDeltaVarints(header.num_track_ids, &pos, end,
+                          motion_data->mutable_track_id()) ||
+        !ReadDeltaVarints(header.num_row_indices, &pos, end,
+                          motion_data->mutable_row_indices()) ||
+        !ReadDeltaVarints(header.num_col_starts, &pos, end,
+                          motion_data->mutable_col_starts()) ||
+        !ReadDeltaVarints(
+            header.num_discarded_ids, &pos, end,
+            motion_data->mutable_actively_discarded_tracked_ids())) {
+      LOG(ERROR) << "Truncated index data in flat chunk item " << item;
+      return false;
+    }
+  } else {
+    LOG(ERROR) << "Unknown index encoding " << header.index_encoding;
+    return false;
+  }
+  payload += header.index_data_size;
+
+  const char* descriptor_end = payload + header.descriptor_data_size;
+  for (uint32 k = 0; k < header.num_descriptors; ++k) {
+    uint32 size;
+    if (static_cast<size_t>(descriptor_end - payload) < sizeof(size)) {
+      LOG(ERROR) << "Truncated descriptors in flat chunk item " << item;
+      return false;
+    }
+    memcpy(&size, payload, sizeof(size));
+    payload += sizeof(size);
+    if (static_cast<size_t>(descriptor_end - payload) < size) {
+      LOG(ERROR) << "Truncated descriptors in flat chunk item " << item;
+      return false;
+    }
+    motion_data->add_feature_descriptors()->set_data(payload, size);
+    payload += RoundUp(size, 4);
+  }
+  return true;
+}
+
+bool FlatTrackingDataChunk::DecodeChunk(TrackingDataChunk* chunk) const {
+  CHECK(chunk != nullptr);
+  chunk->Clear();
+  for (int k = 0; k < num_items(); ++k) {
+    TrackingDataChunk::Item* item = chunk->add_item();
+    const uint32 fields = index_[k].fields;
+    if (fields & INDEX_HAS_FRAME_IDX) {
+      item->set_frame_idx(index_[k].frame_idx);
+    }
+    if (fields & INDEX_HAS_TIMESTAMP) {
+      item->set_timestamp_usec(index_[k].timestamp_usec);
+    }
+    if (fields & INDEX_HAS_PREV_TIMESTAMP) {
+      item->set_prev_timestamp_usec(index_[k].prev_timestamp_usec);
+    }
+    if ((fields & INDEX_HAS_TRACKING_DATA) &&
+        !DecodeTrackingData(k, item->mutable_tracking_data())) {
+      return false;
+    }
+  }
+  if (first_chunk()) {
+    chunk->set_first_chunk(true);
+  }
+  if (last_chunk()) {
+    chunk->set_last_chunk(true);
+  }
+  return true;
+}
+
+}  // namespace mediapipe
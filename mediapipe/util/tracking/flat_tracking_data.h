@@ -0,0 +1,133 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//
+// Flat, fixed-layout encoding of a TrackingDataChunk that can be accessed in
+// place, e.g. from a memory mapped chunk file, without parsing any protos.
+//
+// Layout (native little endian, every section 8 byte aligned):
+// { header      : "FTDC", version, chunk flags, num_items (4 x 32 bit)
+//   index       : num_items x (timestamp_usec, prev_timestamp_usec,
+//                 frame_idx, item offset, item size, item fields), sorted by
+//                 timestamp for seeking
+//   items       : num_items x
+//                 { fixed size header with the scalar TrackingData fields,
+//                   background model and array sizes
+//                   vector_data         : 32 bit floats, always uncompressed
+//                   track_id, row_indices, col_starts,
+//                   actively_discarded_tracked_ids
+//                                       : 32 bit ints, optionally delta and
+//                                         varint compressed
+//                   feature_descriptors : 32 bit size + bytes, each padded to
+//                                         4 bytes } }
+//
+// Usage:
+// std::string data;
+// EncodeFlatTrackingDataChunk(chunk, /*compress_indices=*/false, &data);
+// // ... write data to file, later memory map it ...
+// FlatTrackingDataChunk flat_chunk;
+// CHECK(flat_chunk.Parse(mapped_data));
+// FlatMotionData motion_data;
+// if (flat_chunk.GetMotionData(flat_chunk.LowerBound(timestamp_usec),
+//                              &motion_data)) {
+//   // Use motion_data.vector_data etc. without any copy.
+// }
+
+#ifndef MEDIAPIPE_UTIL_TRACKING_FLAT_TRACKING_DATA_H_
+#define MEDIAPIPE_UTIL_TRACKING_FLAT_TRACKING_DATA_H_
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/util/tracking/flow_packager.pb.h"
+
+namespace mediapipe {
+
+struct FlatChunkHeader;
+struct FlatItemHeader;
+struct FlatItemIndex;
+
+// Encodes chunk in the above flat format to output. If compress_indices is
+// set, track ids, row indices, column starts and discarded track ids are delta
+// and varint compressed. Motion vectors are always stored uncompressed so that
+// they can be accessed without a copy.
+void EncodeFlatTrackingDataChunk(const TrackingDataChunk& chunk,
+                                 bool compress_indices, std::string* output);
+
+// Zero-copy view of the motion data of one item. Pointers are valid as long as
+// the data passed to FlatTrackingDataChunk::Parse.
+struct FlatMotionData {
+  int frame_flags = 0;
+  int domain_width = 0;
+  int domain_height = 0;
+  int num_elements = 0;
+
+  // num_vector_values / 2 densely packed (flow_x, flow_y) pairs.
+  const float* vector_data = nullptr;
+  int num_vector_values = 0;
+
+  const int32* track_id = nullptr;
+  int num_track_ids = 0;
+
+  const int32* row_indices = nullptr;
+  int num_row_indices = 0;
+
+  const int32* col_starts = nullptr;
+  int num_col_starts = 0;
+};
+
+// Read-only view of a flat encoded TrackingDataChunk.
+class FlatTrackingDataChunk {
+ public:
+  // Wraps data, which has to be 8 byte aligned and outlive this object (a
+  // memory mapped file or a std::string buffer satisfy this). Returns false if
+  // data does not hold a valid flat chunk.
+  bool Parse(absl::string_view data);
+
+  int num_items() const;
+  bool first_chunk() const;
+  bool last_chunk() const;
+
+  int64 timestamp_usec(int item) const;
+  int64 prev_timestamp_usec(int item) const;
+  int frame_idx(int item) const;
+
+  // Returns the index of the first item with a timestamp not less than
+  // timestamp_usec, or num_items() if there is none.
+  int LowerBound(int64 timestamp_usec) const;
+
+  // Returns the motion data of item without a copy. Returns false if the item
+  // has no motion data or its indices are compressed, in which case
+  // DecodeTrackingData has to be used instead.
+  bool GetMotionData(int item, FlatMotionData* motion_data) const;
+
+  // Decodes item back to TrackingData. Returns false on corrupted data.
+  bool DecodeTrackingData(int item, TrackingData* tracking_data) const;
+
+  // Decodes the whole chunk back to a TrackingDataChunk.
+  bool DecodeChunk(TrackingDataChunk* chunk) const;
+
+ private:
+  const FlatItemHeader& ItemHeader(int item) const;
+  const char* ItemData(int item) const;
+
+  absl::string_view data_;
+  const FlatChunkHeader* header_ = nullptr;
+  const FlatItemIndex* index_ = nullptr;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_TRACKING_FLAT_TRACKING_DATA_H_
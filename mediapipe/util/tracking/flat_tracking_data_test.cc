@@ -0,0 +1,147 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/util/tracking/flat_tracking_data.h"
+
+#include <string>
+
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+TrackingDataChunk MakeChunk() {
+  TrackingDataChunk chunk;
+  chunk.set_first_chunk(true);
+  for (int k = 0; k < 3; ++k) {
+    TrackingDataChunk::Item* item = chunk.add_item();
+    item->set_frame_idx(k);
+    item->set_timestamp_usec(33333 * k);
+    item->set_prev_timestamp_usec(33333 * (k - 1));
+    TrackingData* data = item->mutable_tracking_data();
+    data->set_frame_flags(TrackingData::FLAG_PROFILE_HIGH);
+    data->set_domain_width(4);
+    data->set_domain_height(3);
+    data->set_frame_aspect(1.5f);
+    data->mutable_background_model()->set_h_02(0.5f * k);
+    data->set_global_feature_count(100 + k);
+    TrackingData::MotionData* motion_data = data->mutable_motion_data();
+    motion_data->set_num_elements(3);
+    for (int e = 0; e < 3; ++e) {
+      motion_data->add_vector_data(0.25f * e);
+      motion_data->add_vector_data(-0.5f * e - k);
+      motion_data->add_track_id(1000 + e - k);
+      motion_data->add_row_indices(2 - e);
+    }
+    for (int col : {0, 1, 1, 2, 3}) {
+      motion_data->add_col_starts(col);
+    }
+    motion_data->add_actively_discarded_tracked_ids(-7);
+    motion_data->add_feature_descriptors()->set_data("descriptor");
+    motion_data->add_feature_descriptors()->set_data(std::string(k, 'x'));
+  }
+  return chunk;
+}
+
+TEST(FlatTrackingDataTest, RoundTrip) {
+  const TrackingDataChunk chunk = MakeChunk();
+  for (bool compress_indices : {false, true}) {
+    std::string data;
+    EncodeFlatTrackingDataChunk(chunk, compress_indices, &data);
+
+    FlatTrackingDataChunk flat_chunk;
+    ASSERT_TRUE(flat_chunk.Parse(data));
+    EXPECT_EQ(3, flat_chunk.num_items());
+    EXPECT_TRUE(flat_chunk.first_chunk());
+    EXPECT_FALSE(flat_chunk.last_chunk());
+
+    TrackingDataChunk decoded;
+    ASSERT_TRUE(flat_chunk.DecodeChunk(&decoded));
+    EXPECT_EQ(chunk.SerializeAsString(), decoded.SerializeAsString());
+  }
+}
+
+TEST(FlatTrackingDataTest, ZeroCopyMotionData) {
+  const TrackingDataChunk chunk = MakeChunk();
+  std::string data;
+  EncodeFlatTrackingDataChunk(chunk, /*compress_indices=*/false, &data);
+  FlatTrackingDataChunk flat_chunk;
+  ASSERT_TRUE(flat_chunk.Parse(data));
+
+  FlatMotionData motion_data;
+  ASSERT_TRUE(flat_chunk.GetMotionData(1, &motion_data));
+  const TrackingData::MotionData& expected =
+      chunk.item(1).tracking_data().motion_data();
+  EXPECT_EQ(4, motion_data.domain_width);
+  EXPECT_EQ(3, motion_data.domain_height);
+  EXPECT_EQ(expected.num_elements(), motion_data.num_elements);
+  ASSERT_EQ(expected.vector_data_size(), motion_data.num_vector_values);
+  for (int k = 0; k < motion_data.num_vector_values; ++k) {
+    EXPECT_EQ(expected.vector_data(k), motion_data.vector_data[k]);
+  }
+  ASSERT_EQ(expected.track_id_size(), motion_data.num_track_ids);
+  ASSERT_EQ(expected.row_indices_size(), motion_data.num_row_indices);
+  for (int k = 0; k < motion_data.num_row_indices; ++k) {
+    EXPECT_EQ(expected.track_id(k), motion_data.track_id[k]);
+    EXPECT_EQ(expected.row_indices(k), motion_data.row_indices[k]);
+  }
+  ASSERT_EQ(expected.col_starts_size(), motion_data.num_col_starts);
+  for (int k = 0; k < motion_data.num_col_starts; ++k) {
+    EXPECT_EQ(expected.col_starts(k), motion_data.col_starts[k]);
+  }
+  // Vectors point into the encoded data.
+  EXPECT_GE(reinterpret_cast<const char*>(motion_data.vector_data),
+            data.data());
+  EXPECT_LT(reinterpret_cast<const char*>(motion_data.vector_data),
+            data.data() + data.size());
+
+  // Compressed indices can not be accessed in place.
+  EncodeFlatTrackingDataChunk(chunk, /*compress_indices=*/true, &data);
+  ASSERT_TRUE(flat_chunk.Parse(data));
+  EXPECT_FALSE(flat_chunk.GetMotionData(1, &motion_data));
+}
+
+TEST(FlatTrackingDataTest, SeeksByTimestamp) {
+  std::string data;
+  EncodeFlatTrackingDataChunk(MakeChunk(), /*compress_indices=*/true, &data);
+  FlatTrackingDataChunk flat_chunk;
+  ASSERT_TRUE(flat_chunk.Parse(data));
+
+  EXPECT_EQ(0, flat_chunk.LowerBound(-1));
+  EXPECT_EQ(0, flat_chunk.LowerBound(0));
+  EXPECT_EQ(1, flat_chunk.LowerBound(1));
+  EXPECT_EQ(2, flat_chunk.LowerBound(66666));
+  EXPECT_EQ(3, flat_chunk.LowerBound(66667));
+  EXPECT_EQ(1, flat_chunk.frame_idx(1));
+  EXPECT_EQ(33333, flat_chunk.timestamp_usec(1));
+  EXPECT_EQ(0, flat_chunk.prev_timestamp_usec(1));
+}
+
+TEST(FlatTrackingDataTest, RejectsInvalidData) {
+  std::string data;
+  EncodeFlatTrackingDataChunk(MakeChunk(), /*compress_indices=*/false, &data);
+  FlatTrackingDataChunk flat_chunk;
+
+  std::string truncated = data.substr(0, data.size() / 2);
+  EXPECT_FALSE(flat_chunk.Parse(truncated));
+  EXPECT_EQ(0, flat_chunk.num_items());
+
+  std::string wrong_magic = data;
+  wrong_magic[0] = 'X';
+  EXPECT_FALSE(flat_chunk.Parse(wrong_magic));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,66 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/image_pyramid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/opencv_video_inc.h"
+
+namespace mediapipe {
+
+int MaxTrackingPyramidLevel(int frame_width, int frame_height) {
+  // The minimum size in the pyramid is intended to be 2x2.
+  return std::max<int>(
+      1, std::log2(std::min<float>(frame_height, frame_width)) - 1);
+}
+
+bool ComputeLuminance(const cv::Mat& frame, cv::Mat* luminance) {
+  switch (frame.channels()) {
+    case 1:
+      frame.copyTo(*luminance);
+      return true;
+    case 3:
+      cv::cvtColor(frame, *luminance, cv::COLOR_RGB2GRAY);
+      return true;
+    case 4:
+      cv::cvtColor(frame, *luminance, cv::COLOR_RGBA2GRAY);
+      return true;
+    default:
+      return false;
+  }
+}
+
+void BuildImagePyramid(const cv::Mat& luminance, int max_level,
+                       int window_size, bool with_derivative,
+                       ImagePyramid* pyramid) {
+  pyramid->luminance = luminance;
+  pyramid->levels.clear();
+  pyramid->max_level = 0;
+  pyramid->window_size = window_size;
+  pyramid->with_derivative = with_derivative;
+#if CV_MAJOR_VERSION >= 3
+  if (max_level > 0) {
+    // Window size is passed as diameter, see RegionFlowComputation.
+    pyramid->max_level = cv::buildOpticalFlowPyramid(
+        luminance, pyramid->levels,
+        cv::Size(2 * window_size + 1, 2 * window_size + 1), max_level,
+        with_derivative);
+  }
+#endif
+}
+
+}  // namespace mediapipe
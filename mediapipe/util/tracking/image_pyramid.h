@@ -0,0 +1,63 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_TRACKING_IMAGE_PYRAMID_H_
+#define MEDIAPIPE_UTIL_TRACKING_IMAGE_PYRAMID_H_
+
+#include <vector>
+
+#include "mediapipe/framework/port/opencv_core_inc.h"
+
+namespace mediapipe {
+
+// Grayscale version of a video frame together with its Lucas-Kanade tracking
+// pyramid. Built once per frame (see ImagePyramidCalculator) and shared by the
+// calculators analyzing the same video, so that each of them does not convert
+// and downsample the frame again.
+struct ImagePyramid {
+  // CV_8UC1 luminance of the frame.
+  cv::Mat luminance;
+
+  // Levels as returned by cv::buildOpticalFlowPyramid (with borders). If
+  // with_derivative is set, each level is followed by its gradient. Empty if
+  // no tracking levels were built.
+  std::vector<cv::Mat> levels;
+
+  // Highest level stored in levels.
+  int max_level = 0;
+
+  // Tracking window radius the levels are padded for, see
+  // TrackingOptions::tracking_window_size.
+  int window_size = 0;
+
+  bool with_derivative = false;
+};
+
+// Returns the highest pyramid level RegionFlowComputation tracks with for
+// frames of the specified size.
+int MaxTrackingPyramidLevel(int frame_width, int frame_height);
+
+// Converts a GRAY8, RGB or RGBA @frame to @luminance. Returns false for other
+// channel counts.
+bool ComputeLuminance(const cv::Mat& frame, cv::Mat* luminance);
+
+// Sets @pyramid to @luminance and, if @max_level > 0, builds its tracking
+// levels for a window of radius @window_size.
+void BuildImagePyramid(const cv::Mat& luminance, int max_level,
+                       int window_size, bool with_derivative,
+                       ImagePyramid* pyramid);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_TRACKING_IMAGE_PYRAMID_H_
@@ -0,0 +1,67 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/image_pyramid.h"
+
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(ImagePyramidTest, ComputeLuminance) {
+  cv::Mat luminance;
+  const cv::Mat gray(4, 6, CV_8UC1, cv::Scalar(17));
+  ASSERT_TRUE(ComputeLuminance(gray, &luminance));
+  EXPECT_EQ(luminance.type(), CV_8UC1);
+  EXPECT_EQ(luminance.at<uint8_t>(3, 5), 17);
+  // The luminance owns its pixels.
+  EXPECT_NE(luminance.data, gray.data);
+
+  const cv::Mat white(4, 6, CV_8UC3, cv::Scalar(255, 255, 255));
+  ASSERT_TRUE(ComputeLuminance(white, &luminance));
+  EXPECT_EQ(luminance.rows, 4);
+  EXPECT_EQ(luminance.cols, 6);
+  EXPECT_EQ(luminance.at<uint8_t>(0, 0), 255);
+
+  EXPECT_FALSE(ComputeLuminance(cv::Mat(4, 6, CV_8UC2), &luminance));
+}
+
+TEST(ImagePyramidTest, BuildsTrackingLevels) {
+  const cv::Mat luminance(480, 640, CV_8UC1, cv::Scalar(128));
+  ImagePyramid pyramid;
+  BuildImagePyramid(luminance, /*max_level=*/3, /*window_size=*/10,
+                    /*with_derivative=*/true, &pyramid);
+  EXPECT_EQ(pyramid.luminance.data, luminance.data);
+  EXPECT_EQ(pyramid.max_level, 3);
+  EXPECT_EQ(pyramid.window_size, 10);
+  EXPECT_TRUE(pyramid.with_derivative);
+  // Each level is followed by its gradient.
+  ASSERT_EQ(pyramid.levels.size(), 8);
+  EXPECT_EQ(pyramid.levels[6].cols, 80);
+  EXPECT_EQ(pyramid.levels[6].rows, 60);
+
+  BuildImagePyramid(luminance, /*max_level=*/0, /*window_size=*/10,
+                    /*with_derivative=*/true, &pyramid);
+  EXPECT_TRUE(pyramid.levels.empty());
+  EXPECT_EQ(pyramid.max_level, 0);
+}
+
+TEST(ImagePyramidTest, MaxTrackingPyramidLevel) {
+  EXPECT_EQ(MaxTrackingPyramidLevel(640, 480), 7);
+  EXPECT_EQ(MaxTrackingPyramidLevel(4, 4), 1);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -359,7 +359,7 @@ bool MotionAnalysis::AddFrameGeneric(
     const Homography& initial_transform, const Homography* rejection_transform,
     const RegionFlowFeatureList* external_features,
     std::function<void(RegionFlowFeatureList*)>* modify_features,
-    RegionFlowFeatureList* output_feature_list) {
+    RegionFlowFeatureList* output_feature_list, const ImagePyramid* pyramid) {
   // Don't check input sizes here, RegionFlowComputation does that based
   // on its internal options.
   CHECK(feature_computation_) << "Calls to AddFrame* can NOT be mixed "
@@ -368,8 +368,13 @@ bool MotionAnalysis::AddFrameGeneric(
   // Compute RegionFlow.
   {
     MEASURE_TIME << "CALL RegionFlowComputation::AddImage";
-    if (!region_flow_computation_->AddImageWithSeed(frame, timestamp_usec,
-                                                    initial_transform)) {
+    const bool added =
+        pyramid != nullptr
+            ? region_flow_computation_->AddImageWithPyramid(
+                  frame, *pyramid, timestamp_usec, initial_transform)
+            : region_flow_computation_->AddImageWithSeed(
+                  frame, timestamp_usec, initial_transform);
+    if (!added) {
       LOG(ERROR) << "Error while computing region flow.";
       return false;
     }
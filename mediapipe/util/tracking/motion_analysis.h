@@ -60,6 +60,7 @@
 
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/util/tracking/camera_motion.pb.h"
+#include "mediapipe/util/tracking/image_pyramid.h"
 #include "mediapipe/util/tracking/motion_analysis.pb.h"
 #include "mediapipe/util/tracking/motion_estimation.h"
 #include "mediapipe/util/tracking/motion_estimation.pb.h"
@@ -105,13 +106,17 @@ class MotionAnalysis {
   // Returns list of features extracted from this frame, *before* any
   // modification is applied. To yield modified features, simply
   // apply modify_features function to returned result.
+  // If pyramid is set, it must be built from frame and is reused for tracking
+  // when it matches the flow options (see
+  // RegionFlowComputation::AddImageWithPyramid).
   bool AddFrameGeneric(
       const cv::Mat& frame, int64 timestamp_usec,
       const Homography& initial_transform,
       const Homography* rejection_transform = nullptr,
       const RegionFlowFeatureList* external_features = nullptr,
       std::function<void(RegionFlowFeatureList*)>* modify_features = nullptr,
-      RegionFlowFeatureList* feature_list = nullptr);
+      RegionFlowFeatureList* feature_list = nullptr,
+      const ImagePyramid* pyramid = nullptr);
 
   // Instead of tracking passed frames, uses result directly as supplied by
   // features. Can not be mixed with above AddFrame* calls.
@@ -72,6 +72,107 @@ void GenericFit(
   est_func(&motion_est, &local, motion);
 }
 
+// The IRLS weight updates below operate on all features of a frame at once.
+// Feature data is gathered from the RegionFlowFeatureList into column-major
+// Eigen matrices (one column per feature) once per estimation, so that each
+// IRLS round only evaluates vectorized expressions and scatters the weights.
+
+// Gathers feature locations, flows and match locations (location + flow).
+// Any output may be null.
+void GatherFeatureColumns(const RegionFlowFeatureList& feature_list,
+                          Eigen::Matrix2Xf* locations, Eigen::Matrix2Xf* flows,
+                          Eigen::Matrix2Xf* matches) {
+  const int num_features = feature_list.feature_size();
+  if (locations) locations->resize(2, num_features);
+  if (flows) flows->resize(2, num_features);
+  if (matches) matches->resize(2, num_features);
+  for (int k = 0; k < num_features; ++k) {
+    const RegionFlowFeature& feature = feature_list.feature(k);
+    if (locations) {
+      locations->col(k) << feature.x(), feature.y();
+    }
+    if (flows) {
+      flows->col(k) << feature.dx(), feature.dy();
+    }
+    if (matches) {
+      matches->col(k) << feature.x() + feature.dx(), feature.y() + feature.dy();
+    }
+  }
+}
+
+// Applies LinearSimilarityAdapter::TransformPoint to each column.
+Eigen::Matrix2Xf TransformColumns(const LinearSimilarityModel& model,
+                                  const Eigen::Matrix2Xf& points) {
+  Eigen::Matrix2f linear;
+  linear << model.a(), -model.b(), model.b(), model.a();
+  return (linear * points).colwise() + Eigen::Vector2f(model.dx(), model.dy());
+}
+
+// Divides each homogeneous column by its last coordinate, which is kept away
+// from zero as in HomographyAdapter::TransformPoint.
+Eigen::Matrix2Xf DehomogenizeColumns(const Eigen::Matrix3Xf& points) {
+  constexpr float kMinDepth = 1e-12f;
+  const Eigen::Array<float, 1, Eigen::Dynamic> z = points.row(2).array();
+  // Sign of z, with zero treated as positive.
+  const Eigen::Array<float, 1, Eigen::Dynamic> sign =
+      (z >= 0.0f).cast<float>() * 2.0f - 1.0f;
+  const Eigen::Array<float, 1, Eigen::Dynamic> safe_z =
+      (z.abs() >= kMinDepth).select(z, sign * kMinDepth);
+  return (points.topRows<2>().array().rowwise() / safe_z).matrix();
+}
+
+Eigen::Matrix3f HomographyToMatrix(const Homography& model) {
+  Eigen::Matrix3f matrix;
+  matrix << model.h_00(), model.h_01(), model.h_02(), model.h_10(),
+      model.h_11(), model.h_12(), model.h_20(), model.h_21(), 1.0f;
+  return matrix;
+}
+
+// Applies HomographyAdapter::TransformPoint3 to each location extended by a
+// homogeneous coordinate of one.
+Eigen::Matrix3Xf ProjectColumns(const Homography& model,
+                                const Eigen::Matrix2Xf& locations) {
+  const Eigen::Matrix3f matrix = HomographyToMatrix(model);
+  return (matrix.leftCols<2>() * locations).colwise() + matrix.col(2);
+}
+
+// Sets the IRLS weight of each feature that is not ignored (zero weight) to
+//   numerator / (residual_norm + kIrlsEps)           if use_l0_norm,
+//   numerator / (sqrt(residual_norm) + kIrlsEps)     otherwise,
+// with numerator = prior * alpha + (1 - alpha), or one for zero alpha.
+void UpdateIrlsWeights(const Eigen::ArrayXf& residual_norms, bool use_l0_norm,
+                       float alpha, const std::vector<float>* priors,
+                       RegionFlowFeatureList* feature_list) {
+  const int num_features = feature_list->feature_size();
+  DCHECK_EQ(residual_norms.size(), num_features);
+  Eigen::ArrayXf numerators;
+  if (alpha == 0.0f) {
+    numerators.setOnes(num_features);
+  } else {
+    DCHECK(priors != nullptr);
+    numerators =
+        Eigen::Map<const Eigen::ArrayXf>(priors->data(), num_features) * alpha +
+        (1.0f - alpha);
+  }
+
+  Eigen::ArrayXf weights;
+  if (use_l0_norm) {
+    weights = numerators / (residual_norms + kIrlsEps);
+  } else {
+    weights = (numerators.cast<double>() /
+               (residual_norms.cast<double>().sqrt() + kIrlsEps))
+                  .cast<float>();
+  }
+
+  for (int k = 0; k < num_features; ++k) {
+    RegionFlowFeature* feature = feature_list->mutable_feature(k);
+    // Ignored features marked as outliers.
+    if (feature->irls_weight() != 0.0f) {
+      feature->set_irls_weight(weights[k]);
+    }
+  }
+}
+
 }  // namespace.
 
 TranslationModel FitTranslationModel(const RegionFlowFeatureList& features) {
@@ -815,6 +916,45 @@ class EstimateMotionIRLSInvoker {
   std::unique_ptr<MotionEstimationThreadStorage> thread_storage_;
 };
 
+// Invoker for ParallelFor over the frames of several clips, so that the
+// frames of all clips are distributed across the thread pool in a single pass.
+// Frame indices are concatenated over clips in order.
+class MultiClipEstimateMotionIRLSInvoker {
+ public:
+  MultiClipEstimateMotionIRLSInvoker(
+      std::vector<EstimateMotionIRLSInvoker> clip_invokers,
+      const std::vector<int>& clip_num_frames)
+      : clip_invokers_(std::move(clip_invokers)) {
+    CHECK_EQ(clip_invokers_.size(), clip_num_frames.size());
+    clip_starts_.reserve(clip_num_frames.size());
+    int start = 0;
+    for (int num_frames : clip_num_frames) {
+      clip_starts_.push_back(start);
+      start += num_frames;
+    }
+    total_frames_ = start;
+  }
+
+  int TotalFrames() const { return total_frames_; }
+
+  void operator()(const BlockedRange& range) const {
+    for (int idx = range.begin(); idx != range.end(); ++idx) {
+      const int clip = std::upper_bound(clip_starts_.begin(),
+                                        clip_starts_.end(), idx) -
+                       clip_starts_.begin() - 1;
+      const int frame = idx - clip_starts_[clip];
+      clip_invokers_[clip](BlockedRange(frame, frame + 1, 1));
+    }
+  }
+
+ private:
+  // Copied along with the invoker, which copies each clip invoker's thread
+  // storage.
+  std::vector<EstimateMotionIRLSInvoker> clip_invokers_;
+  std::vector<int> clip_starts_;
+  int total_frames_ = 0;
+};
+
 void MotionEstimation::EstimateMotionsParallelImpl(
     bool irls_weights_preinitialized,
     std::vector<RegionFlowFeatureList*>* feature_lists,
@@ -1023,18 +1163,25 @@ void MotionEstimation::EstimateMotionsParallelImpl(
     clip_data.CheckInitialization();
   }
 
+  // Estimate AverageMotion magnitudes.
+  const EstimateModelOptions default_model_options = DefaultModelOptions();
+  std::vector<EstimateMotionIRLSInvoker> magnitude_invokers;
+  std::vector<int> clip_num_frames;
+  magnitude_invokers.reserve(clip_datas.size());
   for (auto& clip_data : clip_datas) {
-    // Estimate AverageMotion magnitudes.
-    ParallelFor(0, num_frames, 1,
-                EstimateMotionIRLSInvoker(
-                    MODEL_AVERAGE_MAGNITUDE,
-                    1,     // Does not use irls.
-                    true,  // Compute stability.
-                    CameraMotion::VALID, DefaultModelOptions(), this,
-                    nullptr,  // No prior weights.
-                    nullptr,  // No thread storage.
-                    clip_data.feature_lists, clip_data.camera_motions));
-  }
+    magnitude_invokers.emplace_back(
+        MODEL_AVERAGE_MAGNITUDE,
+        1,     // Does not use irls.
+        true,  // Compute stability.
+        CameraMotion::VALID, default_model_options, this,
+        nullptr,  // No prior weights.
+        nullptr,  // No thread storage.
+        clip_data.feature_lists, clip_data.camera_motions);
+    clip_num_frames.push_back(clip_data.num_frames());
+  }
+  MultiClipEstimateMotionIRLSInvoker magnitude_invoker(
+      std::move(magnitude_invokers), clip_num_frames);
+  ParallelFor(0, magnitude_invoker.TotalFrames(), 1, magnitude_invoker);
 
   // Order of estimation for motion models:
   // Translation -> Linear Similarity -> Affine -> Homography -> Mixture
@@ -1215,6 +1362,10 @@ bool MotionEstimation::EstimateMotionModels(
             IRLSPriorWeight(r * irls_per_round + k, total_irls_rounds);
       }
 
+      const bool last_round = r + 1 == total_rounds;
+      std::vector<EstimateMotionIRLSInvoker> clip_invokers;
+      std::vector<int> clip_num_frames;
+      clip_invokers.reserve(num_datas);
       for (auto& clip_data : *clip_datas) {
         // Setup prior's alphas.
         for (auto& prior_weight : clip_data.prior_weights) {
@@ -1225,21 +1376,24 @@ bool MotionEstimation::EstimateMotionModels(
           }
 
           // Last iteration, irls_alpha is always zero to return actual error.
-          if (r + 1 == total_rounds) {
+          if (last_round) {
             prior_weight.alphas.back() = 0.0;
           }
         }
 
-        const bool last_round = r + 1 == total_rounds;
-        ParallelFor(0, clip_data.num_frames(), 1,
-                    EstimateMotionIRLSInvoker(
-                        type, irls_per_round,
-                        last_round,  // Compute stability on last round.
-                        max_unstable_type, model_options, this,
-                        &clip_data.prior_weights, thread_storage,
-                        clip_data.feature_lists, clip_data.camera_motions));
+        clip_invokers.emplace_back(
+            type, irls_per_round,
+            last_round,  // Compute stability on last round.
+            max_unstable_type, model_options, this, &clip_data.prior_weights,
+            thread_storage, clip_data.feature_lists, clip_data.camera_motions);
+        clip_num_frames.push_back(clip_data.num_frames());
       }
 
+      // Clips are independent, estimate all their frames in one pass.
+      MultiClipEstimateMotionIRLSInvoker invoker(std::move(clip_invokers),
+                                                 clip_num_frames);
+      ParallelFor(0, invoker.TotalFrames(), 1, invoker);
+
       if (options_.estimation_policy() ==
           MotionEstimationOptions::JOINTLY_FROM_TRACKS) {
         EnforceTrackConsistency(clip_datas);
@@ -3181,6 +3335,9 @@ void MotionEstimation::EstimateTranslationModelIRLS(
     irls_alphas = &prior_weights->alphas;
   }
 
+  Eigen::Matrix2Xf flows;
+  GatherFeatureColumns(*flow_feature_list, nullptr, &flows, nullptr);
+
   Vector2_f mean_motion;
   for (int i = 0; i < irls_rounds; ++i) {
     if (options_.use_highest_accuracy_for_normal_equations()) {
@@ -3190,35 +3347,14 @@ void MotionEstimation::EstimateTranslationModelIRLS(
     }
 
     const float alpha = irls_alphas != nullptr ? (*irls_alphas)[i] : 0.0f;
-    const float one_minus_alpha = 1.0f - alpha;
-
-    // Update irls weights.
-    const auto feature_start = flow_feature_list->mutable_feature()->begin();
-    for (auto feature = feature_start;
-         feature != flow_feature_list->mutable_feature()->end(); ++feature) {
-      if (feature->irls_weight() == 0.0f) {
-        continue;
-      }
-
-      // Express difference in original domain.
-      const Vector2_f diff = LinearSimilarityAdapter::TransformPoint(
-          irls_transform_, FeatureFlow(*feature) - mean_motion);
 
-      const float numerator =
-          alpha == 0.0f ? 1.0f
-                        : ((*irls_priors)[feature - feature_start] * alpha +
-                           one_minus_alpha);
-
-      if (irls_use_l0_norm) {
-        feature->set_irls_weight(
-            numerator / (diff.Norm() * irls_residual_scale + kIrlsEps));
-      } else {
-        feature->set_irls_weight(
-            numerator /
-            (std::sqrt(static_cast<double>(diff.Norm() * irls_residual_scale)) +
-             kIrlsEps));
-      }
-    }
+    // Update irls weights, expressing differences in original domain.
+    const Eigen::Matrix2Xf diffs = TransformColumns(
+        irls_transform_,
+        flows.colwise() - Eigen::Vector2f(mean_motion.x(), mean_motion.y()));
+    UpdateIrlsWeights(diffs.colwise().norm().transpose().array() *
+                          irls_residual_scale,
+                      irls_use_l0_norm, alpha, irls_priors, flow_feature_list);
   }
 
   // De-normalize translation.
@@ -3562,6 +3698,10 @@ bool MotionEstimation::EstimateLinearSimilarityModelIRLS(
     irls_alphas = &prior_weights->alphas;
   }
 
+  Eigen::Matrix2Xf locations;
+  Eigen::Matrix2Xf matches;
+  GatherFeatureColumns(*flow_feature_list, &locations, nullptr, &matches);
+
   for (int i = 0; i < irls_rounds; ++i) {
     bool success;
     if (options_.use_highest_accuracy_for_normal_equations()) {
@@ -3581,37 +3721,13 @@ bool MotionEstimation::EstimateLinearSimilarityModelIRLS(
     }
 
     const float alpha = irls_alphas != nullptr ? (*irls_alphas)[i] : 0.0f;
-    const float one_minus_alpha = 1.0f - alpha;
 
-    const auto feature_start = flow_feature_list->mutable_feature()->begin();
-    for (auto feature = feature_start;
-         feature != flow_feature_list->mutable_feature()->end(); ++feature) {
-      if (feature->irls_weight() == 0.0f) {
-        continue;
-      }
-
-      const Vector2_f trans_location = LinearSimilarityAdapter::TransformPoint(
-          *solved_model, FeatureLocation(*feature));
-      const Vector2_f matched_location = FeatureMatchLocation(*feature);
-
-      // Express residual in frame coordinates.
-      const Vector2_f residual = LinearSimilarityAdapter::TransformPoint(
-          irls_transform_, trans_location - matched_location);
-      const float numerator =
-          alpha == 0.0f ? 1.0f
-                        : ((*irls_priors)[feature - feature_start] * alpha +
-                           one_minus_alpha);
-
-      if (irls_use_l0_norm) {
-        feature->set_irls_weight(
-            numerator / (residual.Norm() * irls_residual_scale + kIrlsEps));
-      } else {
-        feature->set_irls_weight(
-            numerator / (std::sqrt(static_cast<double>(residual.Norm() *
-                                                       irls_residual_scale)) +
-                         kIrlsEps));
-      }
-    }
+    // Express residuals in frame coordinates.
+    const Eigen::Matrix2Xf residuals = TransformColumns(
+        irls_transform_, TransformColumns(*solved_model, locations) - matches);
+    UpdateIrlsWeights(residuals.colwise().norm().transpose().array() *
+                          irls_residual_scale,
+                      irls_use_l0_norm, alpha, irls_priors, flow_feature_list);
   }
 
   // Undo pre_transform.
@@ -4941,6 +5057,13 @@ bool MotionEstimation::EstimateHomographyIRLS(
     prev_solution = &norm_model;
   }
 
+  // Matches mapped to the original coordinate system do not change across
+  // rounds.
+  Eigen::Matrix2Xf locations;
+  Eigen::Matrix2Xf matches;
+  GatherFeatureColumns(*feature_list, &locations, nullptr, &matches);
+  matches = TransformColumns(irls_transform_, matches);
+
   for (int r = 0; r < irls_rounds; ++r) {
     if (options_.use_exact_homography_estimation()) {
       bool success = false;
@@ -4983,48 +5106,21 @@ bool MotionEstimation::EstimateHomographyIRLS(
     }
 
     const float alpha = irls_alphas != nullptr ? (*irls_alphas)[r] : 0.0f;
-    const float one_minus_alpha = 1.0f - alpha;
 
     // Compute weights from registration errors.
-    const auto feature_start = feature_list->mutable_feature()->begin();
-    for (auto feature = feature_start;
-         feature != feature_list->mutable_feature()->end(); ++feature) {
-      // Ignored features marked as outliers.
-      if (feature->irls_weight() == 0.0f) {
-        continue;
-      }
-
-      // Residual is expressed as geometric difference, that is
-      // for a point match (p<->q) with estimated homography p,
-      // geometric difference is defined as Hp x q.
-      Vector2_f lhs = HomographyAdapter::TransformPoint(
-          norm_model, FeatureLocation(*feature));
-      // Map to original coordinate system to evaluate error.
-      lhs = LinearSimilarityAdapter::TransformPoint(irls_transform_, lhs);
-      const Vector3_f lhs3(lhs.x(), lhs.y(), 1);
-      const Vector2_f rhs = LinearSimilarityAdapter::TransformPoint(
-          irls_transform_, FeatureMatchLocation(*feature));
-
-      const Vector3_f rhs3(rhs.x(), rhs.y(), 1);
-      const Vector3_f cross = lhs3.CrossProd(rhs3);
-      // We only use the first 2 linearly independent rows.
-      const Vector2_f cross2(cross.x(), cross.y());
-
-      const float numerator =
-          alpha == 0.0f ? 1.0f
-                        : ((*irls_priors)[feature - feature_start] * alpha +
-                           one_minus_alpha);
-
-      if (irls_use_l0_norm) {
-        feature->set_irls_weight(
-            numerator / (cross2.Norm() * irls_residual_scale + kIrlsEps));
-      } else {
-        feature->set_irls_weight(
-            numerator / (std::sqrt(static_cast<double>(cross2.Norm() *
-                                                       irls_residual_scale)) +
-                         kIrlsEps));
-      }
-    }
+    // Residual is expressed as geometric difference, that is for a point match
+    // (p<->q) with estimated homography H, geometric difference is defined as
+    // Hp x q, of which we only use the first 2 linearly independent rows.
+    // For dehomogenized points these equal the difference Hp - q.
+    // Map to original coordinate system to evaluate error.
+    const Eigen::Matrix2Xf residuals =
+        TransformColumns(irls_transform_,
+                         DehomogenizeColumns(ProjectColumns(norm_model,
+                                                            locations))) -
+        matches;
+    UpdateIrlsWeights(residuals.colwise().norm().transpose().array() *
+                          irls_residual_scale,
+                      irls_use_l0_norm, alpha, irls_priors, feature_list);
   }
 
   // Undo pre_transform.
@@ -5134,6 +5230,20 @@ bool MotionEstimation::MixtureHomographyFromFeature(
     irls_alphas = &prior_weights->alphas;
   }
 
+  // Matches mapped to the original coordinate system and the mixture weights
+  // of each feature's row do not change across rounds.
+  Eigen::Matrix2Xf locations;
+  Eigen::Matrix2Xf matches;
+  GatherFeatureColumns(*feature_list, &locations, nullptr, &matches);
+  matches = TransformColumns(irls_transform_, matches);
+  Eigen::MatrixXf feature_row_weights(num_mixtures,
+                                      feature_list->feature_size());
+  for (int k = 0; k < feature_list->feature_size(); ++k) {
+    feature_row_weights.col(k) = Eigen::Map<const Eigen::VectorXf>(
+        row_weights_->RowWeightsClamped(feature_list->feature(k).y()),
+        num_mixtures);
+  }
+
   for (int r = 0; r < irls_rounds; ++r) {
     // Unpack solution to mixture homographies, if not full model.
     std::vector<float> solution_unpacked(8 * num_mixtures);
@@ -5202,48 +5312,26 @@ bool MotionEstimation::MixtureHomographyFromFeature(
         solution_pointer, false, 0, num_mixtures);
 
     const float alpha = irls_alphas != nullptr ? (*irls_alphas)[r] : 0.0f;
-    const float one_minus_alpha = 1.0f - alpha;
 
     // Evaluate IRLS error.
-    const auto feature_start = feature_list->mutable_feature()->begin();
-    for (auto feature = feature_start;
-         feature != feature_list->mutable_feature()->end(); ++feature) {
-      if (feature->irls_weight() == 0.0f) {
-        continue;
-      }
-
-      // Residual is expressed in geometric difference, that is
-      // for a point match (p<->q) with estimated homography p,
-      // geometric difference is defined as Hp x q.
-      Vector2_f lhs = MixtureHomographyAdapter::TransformPoint(
-          norm_model, row_weights_->RowWeightsClamped(feature->y()),
-          FeatureLocation(*feature));
-      // Map to original coordinate system to evaluate error.
-      lhs = LinearSimilarityAdapter::TransformPoint(irls_transform_, lhs);
-
-      const Vector3_f lhs3(lhs.x(), lhs.y(), 1);
-      const Vector2_f rhs = LinearSimilarityAdapter::TransformPoint(
-          irls_transform_, FeatureMatchLocation(*feature));
-
-      const Vector3_f rhs3(rhs.x(), rhs.y(), 1);
-      const Vector3_f cross = lhs3.CrossProd(rhs3);
-
-      // We only use the first 2 linearly independent rows.
-      const Vector2_f cross2(cross.x(), cross.y());
-
-      const float numerator =
-          alpha == 0.0f ? 1.0f
-                        : ((*irls_priors)[feature - feature_start] * alpha +
-                           one_minus_alpha);
-
-      if (irls_use_l0_norm) {
-        feature->set_irls_weight(numerator / (cross2.Norm() + kIrlsEps));
-      } else {
-        feature->set_irls_weight(
-            numerator /
-            (std::sqrt(static_cast<double>(cross2.Norm())) + kIrlsEps));
-      }
-    }
+    // Residual is expressed in geometric difference, see
+    // EstimateHomographyIRLS. The mixture is linear in the homographies, so
+    // each feature's point is the row-weighted sum of the points mapped by
+    // every homography of the mixture.
+    Eigen::Matrix3Xf projected =
+        Eigen::Matrix3Xf::Zero(3, feature_list->feature_size());
+    for (int k = 0; k < num_mixtures; ++k) {
+      projected += (ProjectColumns(norm_model.model(k), locations).array()
+                        .rowwise() *
+                    feature_row_weights.row(k).array())
+                       .matrix();
+    }
+    // Map to original coordinate system to evaluate error.
+    const Eigen::Matrix2Xf residuals =
+        TransformColumns(irls_transform_, DehomogenizeColumns(projected)) -
+        matches;
+    UpdateIrlsWeights(residuals.colwise().norm().transpose().array(),
+                      irls_use_l0_norm, alpha, irls_priors, feature_list);
   }
 
   // Undo pre_transform.
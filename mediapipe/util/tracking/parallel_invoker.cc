@@ -14,6 +14,12 @@
 
 #include "mediapipe/util/tracking/parallel_invoker.h"
 
+#include <functional>
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/executor.h"
+
 // Choose between ThreadPool, OpenMP and serial execution.
 // Note only one parallel_using_* directive can be active.
 int flags_parallel_invoker_mode = PARALLEL_INVOKER_MAX_VALUE;
@@ -21,6 +27,31 @@ int flags_parallel_invoker_max_threads = 4;
 
 namespace mediapipe {
 
+namespace {
+
+// Executor set via SetParallelInvokerExecutor.
+struct ParallelInvokerExecutor {
+  absl::Mutex mutex;
+  Executor* executor ABSL_GUARDED_BY(mutex) = nullptr;
+  int num_threads ABSL_GUARDED_BY(mutex) = 0;
+};
+
+ParallelInvokerExecutor& GetParallelInvokerExecutor() {
+  static ParallelInvokerExecutor* executor = new ParallelInvokerExecutor();
+  return *executor;
+}
+
+}  // namespace
+
+void SetParallelInvokerExecutor(Executor* executor, int num_threads) {
+  CHECK(executor == nullptr || num_threads > 0)
+      << "Executor needs at least one thread.";
+  ParallelInvokerExecutor& state = GetParallelInvokerExecutor();
+  absl::MutexLock lock(&state.mutex);
+  state.executor = executor;
+  state.num_threads = num_threads;
+}
+
 #if defined(PARALLEL_INVOKER_ACTIVE)
 ThreadPool* ParallelInvokerThreadPool() {
   static ThreadPool* pool = []() -> ThreadPool* {
@@ -31,6 +62,27 @@ ThreadPool* ParallelInvokerThreadPool() {
   }();
   return pool;
 }
+
+void ScheduleParallelInvokerTask(std::function<void()> task) {
+  Executor* executor;
+  {
+    ParallelInvokerExecutor& state = GetParallelInvokerExecutor();
+    absl::MutexLock lock(&state.mutex);
+    executor = state.executor;
+  }
+  if (executor != nullptr) {
+    executor->Schedule(std::move(task));
+  } else {
+    ParallelInvokerThreadPool()->Schedule(std::move(task));
+  }
+}
+
+int ParallelInvokerNumThreads() {
+  ParallelInvokerExecutor& state = GetParallelInvokerExecutor();
+  absl::MutexLock lock(&state.mutex);
+  return state.executor != nullptr ? state.num_threads
+                                   : flags_parallel_invoker_max_threads;
+}
 #endif
 
 }  // namespace mediapipe
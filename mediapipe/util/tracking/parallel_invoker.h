@@ -69,6 +69,9 @@
 
 #include <stddef.h>
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <memory>
 
 #include "absl/synchronization/mutex.h"
@@ -101,6 +104,16 @@ extern int flags_parallel_invoker_max_threads;
 
 namespace mediapipe {
 
+class Executor;
+
+// Routes the ThreadPool mode of ParallelFor and ParallelFor2D through
+// executor, typically the one the calculator graph runs on, instead of the
+// parallel invoker's own ThreadPool, so that one pool bounds the number of
+// threads of the whole pipeline. num_threads is the number of threads of
+// executor. The executor must outlive all subsequent ParallelFor calls; pass
+// nullptr to restore the parallel invoker's own ThreadPool.
+void SetParallelInvokerExecutor(Executor* executor, int num_threads);
+
 // Partitions the range [begin, end) into equal blocks of size grain_size each
 // (except last one, might be less than grain_size).
 class BlockedRange {
@@ -140,6 +153,74 @@ class BlockedRange2D {
 // Singleton ThreadPool for parallel invoker.
 ThreadPool* ParallelInvokerThreadPool();
 
+// Schedules task on the executor set via SetParallelInvokerExecutor, or on
+// ParallelInvokerThreadPool() if none is set.
+void ScheduleParallelInvokerTask(std::function<void()> task);
+
+// Returns the number of threads that execute a ThreadPool mode loop, including
+// the calling thread.
+int ParallelInvokerNumThreads();
+
+// Shared state of a ThreadPool mode loop. The calling thread and up to
+// ParallelInvokerNumThreads() - 1 scheduled helpers claim iterations from a
+// common counter, and the calling thread only waits for iterations that are
+// already running. Nested loops therefore never wait on tasks that are still
+// queued behind their own caller, and helpers that start after all iterations
+// have been claimed return right away.
+class ParallelInvokerLoop {
+ public:
+  explicit ParallelInvokerLoop(int num_iterations)
+      : num_iterations_(num_iterations), iterations_remain_(num_iterations) {}
+
+  // Claims and runs iterations via iteration_func(index) until none are left.
+  template <class IterationFunc>
+  void Run(const IterationFunc& iteration_func) {
+    for (int index = next_iteration_.fetch_add(1); index < num_iterations_;
+         index = next_iteration_.fetch_add(1)) {
+      iteration_func(index);
+
+      absl::MutexLock lock(&mutex_);
+      --iterations_remain_;
+      if (iterations_remain_ == 0) {
+        completed_.SignalAll();
+      }
+    }
+  }
+
+  // Blocks until all iterations have completed.
+  void Wait() {
+    absl::MutexLock lock(&mutex_);
+    while (iterations_remain_ > 0) {
+      completed_.Wait(&mutex_);
+    }
+  }
+
+ private:
+  const int num_iterations_;
+  std::atomic<int> next_iteration_{0};
+  absl::Mutex mutex_;
+  absl::CondVar completed_;
+  int iterations_remain_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Runs num_iterations iterations of a ThreadPool mode loop, where
+// run_iterations(loop, invoker) runs the claimed iterations with the given
+// invoker. Each helper is given its local copy of invoker.
+template <class Invoker, class RunIterations>
+void RunParallelInvokerLoop(int num_iterations, const Invoker& invoker,
+                            const RunIterations& run_iterations) {
+  auto loop = std::make_shared<ParallelInvokerLoop>(num_iterations);
+  const int num_helpers =
+      std::min(num_iterations, ParallelInvokerNumThreads()) - 1;
+  for (int helper = 0; helper < num_helpers; ++helper) {
+    ScheduleParallelInvokerTask([loop, invoker, run_iterations]() {
+      run_iterations(loop.get(), invoker);
+    });
+  }
+  run_iterations(loop.get(), invoker);
+  loop->Wait();
+}
+
 #ifdef __APPLE__
 // Enable to allow GCD as an option beside ThreadPool.
 #define USE_PARALLEL_INVOKER_GCD 1
@@ -329,42 +410,15 @@ void ParallelFor(size_t start, size_t end, size_t grain_size,
         break;
       }
 
-      struct {
-        absl::Mutex mutex;
-        absl::CondVar completed;
-        int iterations_remain ABSL_GUARDED_BY(mutex);
-      } loop;
-      {
-        absl::MutexLock lock(&loop.mutex);
-        loop.iterations_remain = iterations_remain;
-      }
-
-      for (int x = start; x < end; x += grain_size) {
-        auto loop_func = [x, end, grain_size, &loop, invoker]() {
-          // Execute invoker.
-          invoker(BlockedRange(x, std::min(end, x + grain_size), 1));
-
-          // Decrement counter.
-          absl::MutexLock lock(&loop.mutex);
-          --loop.iterations_remain;
-          if (loop.iterations_remain == 0) {
-            loop.completed.SignalAll();
-          }
-        };
-
-        // Attempt to run in parallel, if busy run serial to avoid deadlocking.
-        // This can happen during nested invocation of ParallelFor, as if the
-        // loop iteration itself is calling ParallelFor we might deadlock if
-        // we can not guarantee for the iteration to be scheduled.
-        ParallelInvokerThreadPool()->Schedule(loop_func);
-      }
-
-      // Wait on termination of all iterations.
-      loop.mutex.Lock();
-      while (loop.iterations_remain > 0) {
-        loop.completed.Wait(&loop.mutex);
-      }
-      loop.mutex.Unlock();
+      RunParallelInvokerLoop(
+          iterations_remain, invoker,
+          [start, end, grain_size](ParallelInvokerLoop* loop,
+                                   const Invoker& local_invoker) {
+            loop->Run([&](int index) {
+              const size_t x = start + index * grain_size;
+              local_invoker(BlockedRange(x, std::min(end, x + grain_size), 1));
+            });
+          });
       break;
     }
 
@@ -435,7 +489,7 @@ void ParallelFor2D(size_t start_row, size_t end_row, size_t start_col,
 #endif  // __APPLE__
 
     case PARALLEL_INVOKER_THREAD_POOL: {
-      int iterations_remain = end_row - start_row;  // Guarded by loop_mutex
+      const int iterations_remain = end_row - start_row;
       CHECK_GT(iterations_remain, 0);
       if (iterations_remain == 1) {
         // Execute invoker serially.
@@ -444,34 +498,16 @@ void ParallelFor2D(size_t start_row, size_t end_row, size_t start_col,
         break;
       }
 
-      absl::Mutex loop_mutex;
-      absl::CondVar loop_completed;
-
-      for (int y = start_row; y < end_row; ++y) {
-        auto loop_func = [y, start_col, end_col, &loop_mutex, &loop_completed,
-                          &iterations_remain, invoker]() {
-          // Execute invoker.
-          invoker(BlockedRange2D(BlockedRange(y, y + 1, 1),
-                                 BlockedRange(start_col, end_col, 1)));
-
-          // Decrement counter.
-          absl::MutexLock lock(&loop_mutex);
-          --iterations_remain;
-          if (iterations_remain == 0) {
-            loop_completed.Signal();
-          }
-        };
-
-        // Attempt to run in parallel, if busy run serial to avoid deadlocking.
-        ParallelInvokerThreadPool()->Schedule(loop_func);
-      }
-
-      // Wait on termination of all iterations.
-      loop_mutex.Lock();
-      while (iterations_remain > 0) {
-        loop_completed.Wait(&loop_mutex);
-      }
-      loop_mutex.Unlock();
+      RunParallelInvokerLoop(
+          iterations_remain, invoker,
+          [start_row, start_col, end_col](ParallelInvokerLoop* loop,
+                                          const Invoker& local_invoker) {
+            loop->Run([&](int index) {
+              const int y = start_row + index;
+              const BlockedRange cols(start_col, end_col, 1);
+              local_invoker(BlockedRange2D(BlockedRange(y, y + 1, 1), cols));
+            });
+          });
       break;
     }
 
@@ -15,10 +15,12 @@
 #include "mediapipe/util/tracking/parallel_invoker.h"
 
 #include <algorithm>
+#include <atomic>
 #include <numeric>
 
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/thread_pool_executor.h"
 
 namespace mediapipe {
 namespace {
@@ -43,6 +45,27 @@ void RunParallelTest() {
       std::is_permutation(expected.begin(), expected.end(), numbers.begin()));
 }
 
+void RunNestedParallelTest() {
+  const int kOuterSize = 16;
+  const int kInnerSize = 100;
+  std::atomic<int> sum(0);
+
+  // Each outer iteration runs a nested loop from within a pool thread.
+  ParallelFor(0, kOuterSize, 1, [&sum](const BlockedRange& outer) {
+    for (int i = outer.begin(); i != outer.end(); ++i) {
+      ParallelFor2D(0, kInnerSize, 0, 1, 1,
+                    [&sum](const BlockedRange2D& inner) {
+                      for (int k = inner.rows().begin();
+                           k != inner.rows().end(); ++k) {
+                        sum.fetch_add(k);
+                      }
+                    });
+    }
+  });
+
+  EXPECT_EQ(sum.load(), kOuterSize * kInnerSize * (kInnerSize - 1) / 2);
+}
+
 TEST(ParallelInvokerTest, PhotosTest) {
   flags_parallel_invoker_mode = PARALLEL_INVOKER_OPENMP;
 
@@ -56,5 +79,22 @@ TEST(ParallelInvokerTest, ThreadPoolTest) {
   RunParallelTest();
 }
 
+TEST(ParallelInvokerTest, NestedThreadPoolTest) {
+  flags_parallel_invoker_mode = PARALLEL_INVOKER_THREAD_POOL;
+
+  RunNestedParallelTest();
+}
+
+TEST(ParallelInvokerTest, ExecutorTest) {
+  flags_parallel_invoker_mode = PARALLEL_INVOKER_THREAD_POOL;
+  ThreadPoolExecutor executor(2);
+  SetParallelInvokerExecutor(&executor, executor.num_threads());
+
+  RunParallelTest();
+  RunNestedParallelTest();
+
+  SetParallelInvokerExecutor(nullptr, 0);
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -298,6 +298,10 @@ struct RegionFlowComputation::FrameTrackingData {
   // has not been computed yet.
   int pyramid_levels = 0;
 
+  // Set if pyramid shares its levels with an ImagePyramid, which must not be
+  // written to.
+  bool pyramid_shared = false;
+
   // Features extracted in this frame or tracked from a source frame.
   std::vector<cv::Point2f> features;
 
@@ -406,10 +410,30 @@ struct RegionFlowComputation::FrameTrackingData {
     }
   }
 
+  // Uses the levels of a precomputed ImagePyramid as pyramid.
+  void SetPyramid(const std::vector<cv::Mat>& levels, int max_level) {
+    pyramid = levels;
+    pyramid_levels = max_level;
+    pyramid_shared = true;
+  }
+
+  // Detaches pyramid and the extraction levels re-used from it from the
+  // shared ImagePyramid, so that they are not overwritten in place.
+  void ReleaseSharedPyramid() {
+    if (!pyramid_shared) return;
+    pyramid.clear();
+    for (int i = 1; i < extraction_pyramid.size(); ++i) {
+      extraction_pyramid[i] =
+          cv::Mat(extraction_pyramid[i].size(), extraction_pyramid[i].type());
+    }
+    pyramid_shared = false;
+  }
+
   void Reset(int frame_num_, int64 timestamp_) {
     frame_num = frame_num_;
     timestamp_usec = timestamp_;
     pyramid_levels = 0;
+    ReleaseSharedPyramid();
     ResetFeatures();
     neighborhoods.reset();
     orb.Reset();
@@ -843,6 +867,16 @@ bool RegionFlowComputation::AddImageWithSeed(
   return AddImageAndTrack(source, cv::Mat(), timestamp_usec, initial_transform);
 }
 
+bool RegionFlowComputation::AddImageWithPyramid(
+    const cv::Mat& source, const ImagePyramid& pyramid, int64 timestamp_usec,
+    const Homography& initial_transform) {
+  input_pyramid_ = &pyramid;
+  const bool result =
+      AddImageAndTrack(source, cv::Mat(), timestamp_usec, initial_transform);
+  input_pyramid_ = nullptr;
+  return result;
+}
+
 bool RegionFlowComputation::AddImageWithMask(const cv::Mat& source,
                                              const cv::Mat& source_mask,
                                              int64 timestamp_usec) {
@@ -919,6 +953,27 @@ RegionFlowComputation::RetrieveMultiRegionFlowFeatureList(
               .release());
 }
 
+bool RegionFlowComputation::CanUseInputPyramid(const cv::Mat& source) const {
+  if (input_pyramid_ == nullptr || !use_cv_tracking_) {
+    return false;
+  }
+  // The pyramid is built from the luminance of the full resolution RGB(A) or
+  // grayscale frame, before any equalization.
+  const ImagePyramid& pyramid = *input_pyramid_;
+  const auto format = options_.image_format();
+  return format != RegionFlowComputationOptions::FORMAT_BGR &&
+         format != RegionFlowComputationOptions::FORMAT_BGRA &&
+         source.cols == frame_width_ && source.rows == frame_height_ &&
+         pyramid.luminance.cols == frame_width_ &&
+         pyramid.luminance.rows == frame_height_ &&
+         !options_.histogram_equalization() &&
+         pyramid.window_size ==
+             options_.tracking_options().tracking_window_size() &&
+         pyramid.with_derivative ==
+             options_.compute_derivative_in_pyramid() &&
+         pyramid.max_level >= pyramid_levels_;
+}
+
 bool RegionFlowComputation::InitFrame(const cv::Mat& source,
                                       const cv::Mat& source_mask,
                                       FrameTrackingData* data) {
@@ -957,58 +1012,65 @@ bool RegionFlowComputation::InitFrame(const cv::Mat& source,
                CV_INTER_AREA);
   }
 
-  if (source_ptr->channels() == 1 &&
-      options_.image_format() !=
-          RegionFlowComputationOptions::FORMAT_GRAYSCALE) {
-    options_.set_image_format(RegionFlowComputationOptions::FORMAT_GRAYSCALE);
-    LOG(WARNING) << "#channels = 1, but image_format was not set to "
-                    "FORMAT_GRAYSCALE. Assuming GRAYSCALE input.";
-  }
-
-  // Convert image to grayscale.
-  switch (options_.image_format()) {
-    case RegionFlowComputationOptions::FORMAT_RGB:
-      if (3 != source_ptr->channels()) {
-        LOG(ERROR) << "Expecting 3 channel input for RGB.";
-        return false;
-      }
-      cv::cvtColor(*source_ptr, dest_frame, cv::COLOR_RGB2GRAY);
-      break;
+  // Reuse the luminance of a precomputed pyramid, if it matches.
+  const bool use_input_pyramid = CanUseInputPyramid(source);
+  if (use_input_pyramid) {
+    input_pyramid_->luminance.copyTo(dest_frame);
+  } else {
+    if (source_ptr->channels() == 1 &&
+        options_.image_format() !=
+            RegionFlowComputationOptions::FORMAT_GRAYSCALE) {
+      options_.set_image_format(
+          RegionFlowComputationOptions::FORMAT_GRAYSCALE);
+      LOG(WARNING) << "#channels = 1, but image_format was not set to "
+                      "FORMAT_GRAYSCALE. Assuming GRAYSCALE input.";
+    }
+
+    // Convert image to grayscale.
+    switch (options_.image_format()) {
+      case RegionFlowComputationOptions::FORMAT_RGB:
+        if (3 != source_ptr->channels()) {
+          LOG(ERROR) << "Expecting 3 channel input for RGB.";
+          return false;
+        }
+        cv::cvtColor(*source_ptr, dest_frame, cv::COLOR_RGB2GRAY);
+        break;
 
-    case RegionFlowComputationOptions::FORMAT_BGR:
-      if (3 != source_ptr->channels()) {
-        LOG(ERROR) << "Expecting 3 channel input for BGR.";
-        return false;
-      }
-      cv::cvtColor(*source_ptr, dest_frame, cv::COLOR_BGR2GRAY);
-      break;
+      case RegionFlowComputationOptions::FORMAT_BGR:
+        if (3 != source_ptr->channels()) {
+          LOG(ERROR) << "Expecting 3 channel input for BGR.";
+          return false;
+        }
+        cv::cvtColor(*source_ptr, dest_frame, cv::COLOR_BGR2GRAY);
+        break;
 
-    case RegionFlowComputationOptions::FORMAT_RGBA:
-      if (4 != source_ptr->channels()) {
-        LOG(ERROR) << "Expecting 4 channel input for RGBA.";
-        return false;
-      }
-      cv::cvtColor(*source_ptr, dest_frame, cv::COLOR_RGBA2GRAY);
-      break;
+      case RegionFlowComputationOptions::FORMAT_RGBA:
+        if (4 != source_ptr->channels()) {
+          LOG(ERROR) << "Expecting 4 channel input for RGBA.";
+          return false;
+        }
+        cv::cvtColor(*source_ptr, dest_frame, cv::COLOR_RGBA2GRAY);
+        break;
 
-    case RegionFlowComputationOptions::FORMAT_BGRA:
-      if (4 != source_ptr->channels()) {
-        LOG(ERROR) << "Expecting 4 channel input for BGRA.";
-        return false;
-      }
-      cv::cvtColor(*source_ptr, dest_frame, cv::COLOR_BGRA2GRAY);
-      break;
+      case RegionFlowComputationOptions::FORMAT_BGRA:
+        if (4 != source_ptr->channels()) {
+          LOG(ERROR) << "Expecting 4 channel input for BGRA.";
+          return false;
+        }
+        cv::cvtColor(*source_ptr, dest_frame, cv::COLOR_BGRA2GRAY);
+        break;
 
-    case RegionFlowComputationOptions::FORMAT_GRAYSCALE:
-      if (1 != source_ptr->channels()) {
-        LOG(ERROR) << "Expecting 1 channel input for GRAYSCALE.";
-        return false;
-      }
-      CHECK_EQ(1, source_ptr->channels());
-      if (source_ptr != &dest_frame) {
-        source_ptr->copyTo(dest_frame);
-      }
-      break;
+      case RegionFlowComputationOptions::FORMAT_GRAYSCALE:
+        if (1 != source_ptr->channels()) {
+          LOG(ERROR) << "Expecting 1 channel input for GRAYSCALE.";
+          return false;
+        }
+        CHECK_EQ(1, source_ptr->channels());
+        if (source_ptr != &dest_frame) {
+          source_ptr->copyTo(dest_frame);
+        }
+        break;
+    }
   }
 
   // Do histogram equalization.
@@ -1025,9 +1087,13 @@ bool RegionFlowComputation::InitFrame(const cv::Mat& source,
   CHECK_EQ(dest_frame.cols, frame_width_);
   CHECK_EQ(dest_frame.rows, frame_height_);
 
-  data->BuildPyramid(pyramid_levels_,
-                     options_.tracking_options().tracking_window_size(),
-                     options_.compute_derivative_in_pyramid());
+  if (use_input_pyramid) {
+    data->SetPyramid(input_pyramid_->levels, input_pyramid_->max_level);
+  } else {
+    data->BuildPyramid(pyramid_levels_,
+                       options_.tracking_options().tracking_window_size(),
+                       options_.compute_derivative_in_pyramid());
+  }
 
   return true;
 }
@@ -1605,6 +1671,152 @@ class GridFeatureLocator {
   cv::Mat* tmp_image_;
 };
 
+// Block size (and Sobel aperture) used for all corner responses.
+constexpr int kCornerBlockSize = 3;
+constexpr double kHarrisK = 0.04;  // Harris magical constant as set by OpenCV.
+
+// Rows per task when computing corner responses in parallel.
+constexpr int kCornerResponseStripeRows = 64;
+
+// Invoker for ParallelFor. Needs to be copyable.
+// Computes the minimum eigenvalue or Harris corner response for horizontal
+// stripes of image. Each stripe is evaluated with a halo of kCornerBlockSize
+// rows above and below it, which covers the support of the Sobel and box
+// filters, so that the result matches a single call on the whole image.
+class CornerResponseInvoker {
+ public:
+  CornerResponseInvoker(const cv::Mat& image, bool use_harris,
+                        cv::Mat* response)
+      : image_(image), use_harris_(use_harris), response_(response) {}
+
+  void operator()(const BlockedRange& range) const {
+    cv::Mat stripe_response;  // To avoid repeated allocations below.
+    for (int stripe = range.begin(); stripe != range.end(); ++stripe) {
+      const int begin = stripe * kCornerResponseStripeRows;
+      const int end = min(image_.rows, begin + kCornerResponseStripeRows);
+      const int halo_begin = max(0, begin - kCornerBlockSize);
+      const int halo_end = min(image_.rows, end + kCornerBlockSize);
+      const cv::Mat image_stripe(image_, cv::Range(halo_begin, halo_end),
+                                 cv::Range::all());
+      if (use_harris_) {
+        cv::cornerHarris(image_stripe, stripe_response, kCornerBlockSize,
+                         kCornerBlockSize, kHarrisK);
+      } else {
+        cv::cornerMinEigenVal(image_stripe, stripe_response, kCornerBlockSize);
+      }
+      cv::Mat dst_view = response_->rowRange(begin, end);
+      stripe_response.rowRange(begin - halo_begin, end - halo_begin)
+          .copyTo(dst_view);
+    }
+  }
+
+ private:
+  const cv::Mat& image_;
+  bool use_harris_;
+  cv::Mat* response_;
+};
+
+// Computes the corner response of the CV_8U image into the pre-allocated
+// CV_32F response of the same size, splitting the work into row stripes.
+void ComputeCornerResponse(const cv::Mat& image, bool use_harris,
+                           cv::Mat* response) {
+  CHECK(response != nullptr);
+  CHECK_EQ(response->type(), CV_32F);
+  CHECK_EQ(response->rows, image.rows);
+  CHECK_EQ(response->cols, image.cols);
+  const int num_stripes =
+      (image.rows + kCornerResponseStripeRows - 1) / kCornerResponseStripeRows;
+  ParallelFor(0, num_stripes, 1,
+              CornerResponseInvoker(image, use_harris, response));
+}
+
+#if CV_MAJOR_VERSION >= 3
+// Features per task when tracking features in parallel.
+constexpr int kTrackingFeaturesPerTask = 128;
+
+// Invoker for ParallelFor. Needs to be copyable.
+// Tracks a contiguous range of features per task. Pyramids are only read and
+// shared by all tasks, each task writes to its own range of the outputs.
+class PyramidalLKInvoker {
+ public:
+  PyramidalLKInvoker(const std::vector<cv::Mat>& prev_pyramid,
+                     const std::vector<cv::Mat>& next_pyramid,
+                     const std::vector<cv::Point2f>& prev_points,
+                     const cv::Size& window_size, int max_level,
+                     const cv::TermCriteria& criteria, int flags,
+                     std::vector<cv::Point2f>* next_points,
+                     std::vector<uint8>* status, std::vector<float>* error)
+      : prev_pyramid_(prev_pyramid),
+        next_pyramid_(next_pyramid),
+        prev_points_(prev_points),
+        window_size_(window_size),
+        max_level_(max_level),
+        criteria_(criteria),
+        flags_(flags),
+        next_points_(next_points),
+        status_(status),
+        error_(error) {}
+
+  void operator()(const BlockedRange& range) const {
+    for (int task = range.begin(); task != range.end(); ++task) {
+      const int begin = task * kTrackingFeaturesPerTask;
+      const int end = min<int>(prev_points_.size(),
+                               begin + kTrackingFeaturesPerTask);
+      const int num_points = end - begin;
+      // Headers on the task's range; calcOpticalFlowPyrLK does not reallocate
+      // outputs of matching size and type.
+      const cv::Mat prev_points(
+          num_points, 1, CV_32FC2,
+          const_cast<cv::Point2f*>(prev_points_.data() + begin));
+      cv::Mat next_points(num_points, 1, CV_32FC2,
+                          next_points_->data() + begin);
+      cv::Mat status(num_points, 1, CV_8U, status_->data() + begin);
+      cv::Mat error(num_points, 1, CV_32F, error_->data() + begin);
+      cv::calcOpticalFlowPyrLK(prev_pyramid_, next_pyramid_, prev_points,
+                               next_points, status, error, window_size_,
+                               max_level_, criteria_, flags_);
+    }
+  }
+
+ private:
+  const std::vector<cv::Mat>& prev_pyramid_;
+  const std::vector<cv::Mat>& next_pyramid_;
+  const std::vector<cv::Point2f>& prev_points_;
+  cv::Size window_size_;
+  int max_level_;
+  cv::TermCriteria criteria_;
+  int flags_;
+  std::vector<cv::Point2f>* next_points_;
+  std::vector<uint8>* status_;
+  std::vector<float>* error_;
+};
+
+// Tracks prev_points from prev_pyramid to next_pyramid, as
+// cv::calcOpticalFlowPyrLK would, with ranges of features tracked in parallel.
+// As each feature is tracked independently results do not depend on the
+// number of tasks. With cv::OPTFLOW_USE_INITIAL_FLOW, next_points must
+// already hold the initial locations.
+void ParallelCalcOpticalFlowPyrLK(const std::vector<cv::Mat>& prev_pyramid,
+                                  const std::vector<cv::Mat>& next_pyramid,
+                                  const std::vector<cv::Point2f>& prev_points,
+                                  const cv::Size& window_size, int max_level,
+                                  const cv::TermCriteria& criteria, int flags,
+                                  std::vector<cv::Point2f>* next_points,
+                                  std::vector<uint8>* status,
+                                  std::vector<float>* error) {
+  const int num_points = prev_points.size();
+  next_points->resize(num_points);
+  status->resize(num_points);
+  error->resize(num_points);
+  const int num_tasks =
+      (num_points + kTrackingFeaturesPerTask - 1) / kTrackingFeaturesPerTask;
+  ParallelFor(0, num_tasks, 1,
+              PyramidalLKInvoker(prev_pyramid, next_pyramid, prev_points,
+                                 window_size, max_level, criteria, flags,
+                                 next_points, status, error));
+}
+#endif  // CV_MAJOR_VERSION >= 3
+
 // Sets (2 * N + 1) x (2 * N + 1) neighborhood of the passed mask to K
 // or adds K to the existing mask if add is set to true.
 template <int N, int K, bool add>
@@ -1695,9 +1907,6 @@ void RegionFlowComputation::AdaptiveGoodFeaturesToTrack(
     const int cols = image.cols;
 
     // Compute corner response.
-    constexpr int kBlockSize = 3;
-    constexpr double kHarrisK = 0.04;  // Harris magical constant as
-                                       // set by OpenCV.
     std::vector<cv::KeyPoint> fast_keypoints;
     if (e == 0) {
       MEASURE_TIME << "Corner extraction";
@@ -1706,10 +1915,8 @@ void RegionFlowComputation::AdaptiveGoodFeaturesToTrack(
 
       if (use_fast) {
         fast_detector->detect(image, fast_keypoints);
-      } else if (use_harris) {
-        cv::cornerHarris(image, *eig_image, kBlockSize, kBlockSize, kHarrisK);
       } else {
-        cv::cornerMinEigenVal(image, *eig_image, kBlockSize);
+        ComputeCornerResponse(image, use_harris, eig_image);
       }
     } else {
       // Compute corner response on a down-scaled image and upsample.
@@ -1728,11 +1935,7 @@ void RegionFlowComputation::AdaptiveGoodFeaturesToTrack(
         // Use tmp_image to compute eigen-values on resized images.
         cv::Mat eig_view(*tmp_image, cv::Range(0, rows), cv::Range(0, cols));
 
-        if (use_harris) {
-          cv::cornerHarris(image, eig_view, kBlockSize, kBlockSize, kHarrisK);
-        } else {
-          cv::cornerMinEigenVal(image, eig_view, kBlockSize);
-        }
+        ComputeCornerResponse(image, use_harris, &eig_view);
 
         // Upsample (without interpolation) eig_view to match frame size.
         eig_image->setTo(0);
@@ -2586,8 +2789,8 @@ void RegionFlowComputation::TrackFeatures(FrameTrackingData* from_data_ptr,
       cv::TermCriteria::COUNT + cv::TermCriteria::EPS,
       options_.tracking_options().tracking_iterations(), 0.02f);
 
-  cv::_InputArray input_frame1(data1.pyramid);
-  cv::_InputArray input_frame2(data2.pyramid);
+  const std::vector<cv::Mat>* input_pyramid1 = &data1.pyramid;
+  const std::vector<cv::Mat>* input_pyramid2 = &data2.pyramid;
 #endif
 
   // Using old c-interface for OpenCV's 2.2 tracker.
@@ -2601,19 +2804,24 @@ void RegionFlowComputation::TrackFeatures(FrameTrackingData* from_data_ptr,
   if (use_cv_tracking_) {
 #if CV_MAJOR_VERSION >= 3
     if (gain_correction) {
+      // Build the pyramid of the gain corrected frame once, so that it is
+      // shared by all tracking tasks and the verification below.
+      cv::buildOpticalFlowPyramid(*gain_image_, gain_tracking_pyramid_,
+                                  cv_window_size, pyramid_levels_,
+                                  options_.compute_derivative_in_pyramid());
       if (!frame1_gain_reference) {
-        input_frame1 = cv::_InputArray(*gain_image_);
+        input_pyramid1 = &gain_tracking_pyramid_;
       } else {
-        input_frame2 = cv::_InputArray(*gain_image_);
+        input_pyramid2 = &gain_tracking_pyramid_;
       }
     }
 
     if (options_.tracking_options().klt_tracker_implementation() ==
         TrackingOptions::KLT_OPENCV) {
-      cv::calcOpticalFlowPyrLK(input_frame1, input_frame2, features1, features2,
-                               feature_status_, feature_track_error_,
-                               cv_window_size, pyramid_levels_, cv_criteria,
-                               tracking_flags);
+      ParallelCalcOpticalFlowPyrLK(
+          *input_pyramid1, *input_pyramid2, features1, cv_window_size,
+          pyramid_levels_, cv_criteria, tracking_flags, &features2,
+          &feature_status_, &feature_track_error_);
     } else {
       LOG(ERROR) << "Tracking method unspecified.";
       return;
@@ -2789,10 +2997,10 @@ void RegionFlowComputation::TrackFeatures(FrameTrackingData* from_data_ptr,
 
     if (use_cv_tracking_) {
 #if CV_MAJOR_VERSION >= 3
-      cv::calcOpticalFlowPyrLK(input_frame2, input_frame1, verify_features,
-                               verify_features_tracked, feature_status_,
-                               verify_track_error, cv_window_size,
-                               pyramid_levels_, cv_criteria, tracking_flags);
+      ParallelCalcOpticalFlowPyrLK(
+          *input_pyramid2, *input_pyramid1, verify_features, cv_window_size,
+          pyramid_levels_, cv_criteria, tracking_flags,
+          &verify_features_tracked, &feature_status_, &verify_track_error);
 #endif
     } else {
       LOG(ERROR) << "only cv tracking is supported.";
@@ -3461,10 +3669,9 @@ int RegionFlowComputation::PyramidLevelsFromTrackDistance(
   int pyramid_levels =
       std::ceil(std::log2(std::max(track_distance, 1.0f) * 2.f /
                           options_.tracking_options().tracking_window_size()));
-  // The maximum pyramid level that we are targeting. The minimum size in the
-  // pyramid is intended to be 2x2.
+  // The maximum pyramid level that we are targeting.
   const int max_pyramid_levels =
-      max<int>(1, std::log2(min<float>(frame_height_, frame_width_)) - 1);
+      MaxTrackingPyramidLevel(frame_width_, frame_height_);
   pyramid_levels = min(max_pyramid_levels, max(pyramid_levels, 2));
   return pyramid_levels;
 }
@@ -3474,7 +3681,7 @@ void RegionFlowComputation::ComputeBlurMask(const cv::Mat& input,
                                             cv::Mat* mask) {
   MEASURE_TIME << "Computing blur score";
   const auto& blur_options = options_.blur_score_options();
-  cv::cornerMinEigenVal(input, *corner_values_, 3);
+  ComputeCornerResponse(input, false, corner_values_.get());
 
   // Create over-exposure mask to mask out corners in high exposed areas.
   // Reason is, that motion blur does not affect lights in the same manner as
@@ -3542,8 +3749,7 @@ void RegionFlowComputation::ComputeBlurMask(const cv::Mat& input,
 }
 
 float RegionFlowComputation::ComputeBlurScore(const cv::Mat& input) {
-  // TODO: Already computed during feature extraction, re-use!
-  cv::cornerMinEigenVal(input, *corner_values_, 3);
+  // Computes corner_values_ as well.
   ComputeBlurMask(input, corner_values_.get(), corner_mask_.get());
 
   // Compute median corner score over masked area.
@@ -54,6 +54,7 @@
 
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/util/tracking/image_pyramid.h"
 #include "mediapipe/util/tracking/motion_models.pb.h"
 #include "mediapipe/util/tracking/region_flow.h"
 #include "mediapipe/util/tracking/region_flow.pb.h"
@@ -96,6 +97,15 @@ class RegionFlowComputation {
   virtual bool AddImageWithSeed(const cv::Mat& source, int64 timestamp_usec,
                                 const Homography& initial_transform);
 
+  // Same as AddImageWithSeed, but takes the luminance and tracking levels of
+  // source from pyramid if they were built for the frame size and tracking
+  // options used here, instead of computing them again. Falls back to
+  // computing them from source otherwise.
+  virtual bool AddImageWithPyramid(const cv::Mat& source,
+                                   const ImagePyramid& pyramid,
+                                   int64 timestamp_usec,
+                                   const Homography& initial_transform);
+
   // Same as AddImage but also accepts an optional source_mask (pass empty
   // cv::Mat to get the same behavior as AddImage). If non-empty, features are
   // only extracted in regions where the mask value is > 0. Mask should be 8-bit
@@ -183,6 +193,10 @@ class RegionFlowComputation {
                                     const cv::Mat* curr_color_image,
                                     const cv::Mat* prev_color_image);
 
+  // Returns true if input_pyramid_ can replace the luminance and tracking
+  // levels computed for source.
+  bool CanUseInputPyramid(const cv::Mat& source) const;
+
   // Initializes the FrameTrackingData's members from source and source_mask.
   // Returns true on success.
   bool InitFrame(const cv::Mat& source, const cv::Mat& source_mask,
@@ -403,6 +417,9 @@ class RegionFlowComputation {
   int pyramid_levels_;
   int extraction_levels_;
 
+  // Precomputed pyramid of the frame being added, if any.
+  const ImagePyramid* input_pyramid_ = nullptr;
+
   int frame_num_ = 0;
   int max_features_ = 0;
   float curr_blur_score_ = 0;
@@ -418,6 +435,8 @@ class RegionFlowComputation {
   // Gain adapted version.
   std::unique_ptr<cv::Mat> gain_image_;
   std::unique_ptr<cv::Mat> gain_pyramid_;
+  // Tracking pyramid of gain_image_, reused across frames.
+  std::vector<cv::Mat> gain_tracking_pyramid_;
 
   // Temporary buffers.
   std::unique_ptr<cv::Mat> corner_values_;
@@ -251,6 +251,15 @@ TEST_P(RegionFlowComputationTest, FramePairTest) {
   RunFramePairTest(RegionFlowComputationOptions::FORMAT_BGRA);
 }
 
+TEST_P(RegionFlowComputationTest, FramePairTestWithGainCorrection) {
+  // Tracks from a gain corrected pyramid, verifies all features by tracking
+  // back and computes the blur score.
+  base_options_.set_gain_correction(true);
+  base_options_.set_verify_features(true);
+  base_options_.set_compute_blur_score(true);
+  RunFramePairTest(RegionFlowComputationOptions::FORMAT_GRAYSCALE);
+}
+
 TEST_P(RegionFlowComputationTest, ResolutionTests) {
   // Test all kinds of resolutions (disregard resulting flow).
   // Square test, synthetic tracks.
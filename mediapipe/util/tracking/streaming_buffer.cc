@@ -14,6 +14,8 @@
 
 #include "mediapipe/util/tracking/streaming_buffer.h"
 
+#include <cstdio>
+
 #include "absl/strings/str_cat.h"
 
 namespace mediapipe {
@@ -31,6 +33,123 @@ StreamingBuffer::StreamingBuffer(
   }
 }
 
+StreamingBuffer::~StreamingBuffer() {
+  if (spill_file_ != nullptr) {
+    std::fclose(spill_file_);
+    std::remove(scratch_file_.c_str());
+  }
+}
+
+bool StreamingBuffer::SetMemoryBudget(int64 max_bytes,
+                                      const std::string& scratch_file) {
+  CHECK_GT(max_bytes, 0);
+  CHECK(spill_file_ == nullptr) << "Memory budget already set.";
+  spill_file_ = std::fopen(scratch_file.c_str(), "w+b");
+  if (spill_file_ == nullptr) {
+    LOG(ERROR) << "Could not create scratch file " << scratch_file;
+    return false;
+  }
+  scratch_file_ = scratch_file;
+  max_bytes_ = max_bytes;
+  return true;
+}
+
+void StreamingBuffer::AddSpillEntry(const void* key, SpillEntry entry) {
+  RemoveSpillEntry(key);
+  entry.key = key;
+  resident_bytes_ += entry.bytes;
+  spill_index_[key] =
+      spill_entries_.insert(spill_entries_.end(), std::move(entry));
+  SpillToBudget();
+}
+
+void StreamingBuffer::SpillToBudget() {
+  for (auto entry = spill_entries_.begin();
+       entry != spill_entries_.end() && resident_bytes_ > max_bytes_;
+       ++entry) {
+    if (entry->spilled || entry->holder.expired()) {
+      continue;
+    }
+    std::string data;
+    if (!entry->spill(&data)) {
+      LOG(ERROR) << "Could not serialize datum, keeping it in memory.";
+      continue;
+    }
+    const bool written =
+        std::fseek(spill_file_, spill_end_, SEEK_SET) == 0 &&
+        std::fwrite(data.data(), 1, data.size(), spill_file_) == data.size();
+    CHECK(written) << "Could not write to scratch file " << scratch_file_;
+    resident_bytes_ -= entry->bytes;
+    entry->spilled = true;
+    entry->offset = spill_end_;
+    entry->bytes = data.size();
+    spill_end_ += data.size();
+    ++num_spilled_;
+  }
+}
+
+void StreamingBuffer::EnsureResident(const void* key) const {
+  auto pos = spill_index_.find(key);
+  if (pos == spill_index_.end()) {
+    return;
+  }
+  auto entry = pos->second;
+  // Mark as most recently used.
+  spill_entries_.splice(spill_entries_.end(), spill_entries_, entry);
+  if (!entry->spilled) {
+    return;
+  }
+
+  std::string data(entry->bytes, '\0');
+  const bool read =
+      std::fseek(spill_file_, entry->offset, SEEK_SET) == 0 &&
+      std::fread(&data[0], 1, data.size(), spill_file_) == data.size();
+  CHECK(read) << "Could not read from scratch file " << scratch_file_;
+  const bool reloaded = entry->reload(data);
+  CHECK(reloaded) << "Corrupted datum in " << scratch_file_;
+  entry->spilled = false;
+  resident_bytes_ += entry->bytes;
+  if (--num_spilled_ == 0) {
+    // Reuse the scratch file from the start.
+    spill_end_ = 0;
+  }
+}
+
+void StreamingBuffer::RemoveSpillEntry(const void* key) {
+  auto pos = spill_index_.find(key);
+  if (pos == spill_index_.end()) {
+    return;
+  }
+  if (pos->second->spilled) {
+    if (--num_spilled_ == 0) {
+      spill_end_ = 0;
+    }
+  } else {
+    resident_bytes_ -= pos->second->bytes;
+  }
+  spill_entries_.erase(pos->second);
+  spill_index_.erase(pos);
+}
+
+void StreamingBuffer::PruneSpillEntries() {
+  for (auto entry = spill_entries_.begin(); entry != spill_entries_.end();) {
+    if (!entry->holder.expired()) {
+      ++entry;
+      continue;
+    }
+    if (entry->spilled) {
+      --num_spilled_;
+    } else {
+      resident_bytes_ -= entry->bytes;
+    }
+    spill_index_.erase(entry->key);
+    entry = spill_entries_.erase(entry);
+  }
+  if (num_spilled_ == 0) {
+    spill_end_ = 0;
+  }
+}
+
 bool StreamingBuffer::HasTag(const std::string& tag) const {
   return data_config_.find(tag) != data_config_.end();
 }
@@ -103,6 +222,7 @@ bool StreamingBuffer::TruncateBuffer(bool flush) {
   }
 
   first_frame_index_ += elems_to_clear;
+  PruneSpillEntries();
 
   const int remaining_elems = flush ? 0 : overlap_;
   for (const auto& item : data_) {
@@ -126,6 +246,7 @@ void StreamingBuffer::DiscardDatum(const std::string& tag, int num_frames) {
   }
   queue.erase(queue.begin(),
               queue.begin() + std::min<int>(queue.size(), num_frames));
+  PruneSpillEntries();
 }
 
 void StreamingBuffer::DiscardDatumFromEnd(const std::string& tag,
@@ -137,6 +258,7 @@ void StreamingBuffer::DiscardDatumFromEnd(const std::string& tag,
   }
   queue.erase(queue.end() - std::min<int>(queue.size(), num_frames),
               queue.end());
+  PruneSpillEntries();
 }
 
 void StreamingBuffer::DiscardData(const std::vector<std::string>& tags,
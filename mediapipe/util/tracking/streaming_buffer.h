@@ -15,15 +15,21 @@
 #ifndef MEDIAPIPE_UTIL_TRACKING_STREAMING_BUFFER_H_
 #define MEDIAPIPE_UTIL_TRACKING_STREAMING_BUFFER_H_
 
+#include <cstdio>
 #include <deque>
+#include <functional>
+#include <list>
 #include <memory>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include "absl/container/node_hash_map.h"
 #include "absl/types/any.h"
+#include "mediapipe/framework/port/core_proto_inc.h"
+#include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/tool/type_util.h"
 
@@ -117,6 +123,11 @@ namespace mediapipe {
 //
 //    // End chunk boundary processing.
 //  }
+//
+// To bound the memory of long streams, call
+// streaming_buffer.SetMemoryBudget(max_bytes, scratch_file). Buffered protos
+// beyond the budget are then spilled to scratch_file, least recently used
+// first, and reloaded on access.
 
 // Stores pair (tag, TypeId of type).
 typedef std::pair<std::string, size_t> TaggedType;
@@ -140,6 +151,25 @@ class StreamingBuffer {
   // Data_configuration must have unique tag for each type.
   StreamingBuffer(const std::vector<TaggedType>& data_configuration,
                   int overlap);
+  ~StreamingBuffer();
+  StreamingBuffer(const StreamingBuffer&) = delete;
+  StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+
+  // Bounds the memory used by buffered protos to max_bytes, measured by their
+  // serialized size. Adding data beyond the budget serializes the least
+  // recently used protos to scratch_file and releases them; they are reloaded
+  // transparently when accessed. Data of non-proto types is neither counted
+  // nor spilled. Pointers returned by the Get* functions stay valid until the
+  // next call that adds data. Returns false if scratch_file could not be
+  // created. The scratch file is removed on destruction.
+  bool SetMemoryBudget(int64 max_bytes, const std::string& scratch_file);
+
+  // Returns the serialized size of the buffered protos that are currently held
+  // in memory (only tracked if a memory budget is set).
+  int64 ResidentBytes() const { return resident_bytes_; }
+
+  // Returns the number of buffered protos currently spilled to disk.
+  int NumSpilledData() const { return num_spilled_; }
 
   // Call will transfer ownership to StreamingBuffer.
   // Returns true if datum was successfully stored, false otherwise.
@@ -299,6 +329,43 @@ class StreamingBuffer {
     CHECK(tags.empty());
   }
 
+  // Types whose data can be spilled to disk.
+  template <class T>
+  static constexpr bool kIsSpillable =
+      std::is_base_of<proto_ns::MessageLite, T>::value;
+
+  // Registers a newly added proto with the memory budget and spills the least
+  // recently used data if the budget is exceeded.
+  template <class T>
+  void TrackSpillable(const PointerType<T>& pointer);
+
+  // Type-erased proto registered with the memory budget.
+  struct SpillEntry {
+    // Holder of the datum, expires once the datum is discarded.
+    std::weak_ptr<void> holder;
+    // Key of the entry in spill_index_.
+    const void* key = nullptr;
+    // Serialized size of the datum.
+    int64 bytes = 0;
+    // Location in the scratch file, if spilled.
+    bool spilled = false;
+    int64 offset = 0;
+    // Serializes the datum to the passed string and releases it.
+    std::function<bool(std::string*)> spill;
+    // Restores the datum from its serialization.
+    std::function<bool(const std::string&)> reload;
+  };
+
+  void AddSpillEntry(const void* key, SpillEntry entry);
+  void SpillToBudget();
+  // Reloads the datum of key if it was spilled and marks it as most recently
+  // used. No-op for data not registered with the memory budget.
+  void EnsureResident(const void* key) const;
+  // Removes the datum of key from the memory budget.
+  void RemoveSpillEntry(const void* key);
+  // Removes entries of discarded data.
+  void PruneSpillEntries();
+
  private:
   int overlap_ = 0;
   int first_frame_index_ = 0;
@@ -306,6 +373,20 @@ class StreamingBuffer {
 
   // Stores tag, TypeId of corresponding type.
   absl::node_hash_map<std::string, size_t> data_config_;
+
+  // Memory budget, zero if unbounded.
+  int64 max_bytes_ = 0;
+  std::string scratch_file_;
+  std::FILE* spill_file_ = nullptr;
+  // Spill entries, least recently used first, and their index by the address
+  // of the datum holder. Mutable, as accessing data reloads spilled data.
+  mutable std::list<SpillEntry> spill_entries_;
+  mutable absl::node_hash_map<const void*, std::list<SpillEntry>::iterator>
+      spill_index_;
+  mutable int64 resident_bytes_ = 0;
+  mutable int num_spilled_ = 0;
+  // End of the spilled data in the scratch file.
+  mutable int64 spill_end_ = 0;
 };
 
 //// Implementation details.
@@ -326,10 +407,40 @@ void StreamingBuffer::AddDatum(const std::string& tag,
   CHECK(HasTag(tag));
   CHECK_EQ(data_config_[tag], kTypeId<PointerType<T>>.hash_code());
   auto& buffer = data_[tag];
-  absl::any packet(PointerType<T>(CreatePointer(pointer.release())));
+  PointerType<T> datum = CreatePointer(pointer.release());
+  if constexpr (kIsSpillable<T>) {
+    if (max_bytes_ > 0 && *datum != nullptr) {
+      TrackSpillable(datum);
+    }
+  }
+  absl::any packet(std::move(datum));
   buffer.push_back(packet);
 }
 
+template <class T>
+void StreamingBuffer::TrackSpillable(const PointerType<T>& pointer) {
+  std::unique_ptr<T>* holder = pointer.get();
+  SpillEntry entry;
+  entry.holder = pointer;
+  entry.bytes = (*holder)->ByteSizeLong();
+  entry.spill = [holder](std::string* data) {
+    if (!(*holder)->SerializeToString(data)) {
+      return false;
+    }
+    holder->reset();
+    return true;
+  };
+  entry.reload = [holder](const std::string& data) {
+    std::unique_ptr<T> datum(new T());
+    if (!datum->ParseFromString(data)) {
+      return false;
+    }
+    *holder = std::move(datum);
+    return true;
+  };
+  AddSpillEntry(holder, std::move(entry));
+}
+
 template <class T>
 void StreamingBuffer::EmplaceDatum(const std::string& tag, T* pointer) {
   std::unique_ptr<T> forwarded(pointer);
@@ -403,6 +514,9 @@ T* StreamingBuffer::GetMutableDatum(const std::string& tag,
     // Unpack and return.
     const PointerType<T>& pointer =
         *absl::any_cast<const PointerType<T>>(&packet);
+    if constexpr (kIsSpillable<T>) {
+      EnsureResident(pointer.get());
+    }
     return pointer->get();
   }
 }
@@ -467,8 +581,12 @@ std::vector<T*> StreamingBuffer::GetMutableDatumVector(
                  << "Check data configuration.";
       result.push_back(nullptr);
     } else {
-      result.push_back(
-          absl::any_cast<const PointerType<T>>(&packet)->get()->get());
+      const PointerType<T>& pointer =
+          *absl::any_cast<const PointerType<T>>(&packet);
+      if constexpr (kIsSpillable<T>) {
+        EnsureResident(pointer.get());
+      }
+      result.push_back(pointer->get());
     }
   }
   return result;
@@ -504,6 +622,10 @@ std::unique_ptr<T> StreamingBuffer::ReleaseDatum(const std::string& tag,
     // Unpack and return.
     const PointerType<T>& pointer =
         *absl::any_cast<const PointerType<T>>(&packet);
+    if constexpr (kIsSpillable<T>) {
+      EnsureResident(pointer.get());
+      RemoveSpillEntry(pointer.get());
+    }
     return std::move(*pointer);
   }
 }
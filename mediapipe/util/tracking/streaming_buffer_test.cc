@@ -0,0 +1,97 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/util/tracking/streaming_buffer.h"
+
+#include <memory>
+#include <string>
+
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/tracking/motion_models.pb.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumFrames = 20;
+
+std::unique_ptr<Homography> MakeHomography(int frame) {
+  auto homography = std::make_unique<Homography>();
+  homography->set_h_00(1.0f + frame);
+  homography->set_h_01(2.0f);
+  homography->set_h_02(frame);
+  homography->set_h_10(3.0f);
+  return homography;
+}
+
+class StreamingBufferTest : public ::testing::Test {
+ protected:
+  StreamingBufferTest()
+      : buffer_({TaggedPointerType<Homography>("model"),
+                 TaggedPointerType<int>("frame")},
+                /*overlap=*/2) {}
+
+  void AddFrames() {
+    for (int k = 0; k < kNumFrames; ++k) {
+      buffer_.AddDatum("model", MakeHomography(k));
+      buffer_.AddDatum("frame", std::make_unique<int>(k));
+    }
+  }
+
+  StreamingBuffer buffer_;
+};
+
+TEST_F(StreamingBufferTest, UnboundedByDefault) {
+  AddFrames();
+  EXPECT_EQ(0, buffer_.NumSpilledData());
+  EXPECT_EQ(0, buffer_.ResidentBytes());
+  EXPECT_EQ(5.0f, buffer_.GetDatum<Homography>("model", 5)->h_02());
+}
+
+TEST_F(StreamingBufferTest, SpillsBeyondMemoryBudget) {
+  const int64 item_bytes = MakeHomography(0)->ByteSizeLong();
+  ASSERT_TRUE(buffer_.SetMemoryBudget(
+      4 * item_bytes,
+      file::JoinPath(::testing::TempDir(), "streaming_buffer_spill")));
+  AddFrames();
+  EXPECT_LE(buffer_.ResidentBytes(), 4 * item_bytes);
+  EXPECT_EQ(kNumFrames - 4, buffer_.NumSpilledData());
+
+  // Spilled data is reloaded on access.
+  for (int k = 0; k < kNumFrames; ++k) {
+    EXPECT_EQ(k, buffer_.GetDatum<Homography>("model", k)->h_02());
+    EXPECT_EQ(k, *buffer_.GetDatum<int>("frame", k));
+  }
+  EXPECT_EQ(0, buffer_.NumSpilledData());
+
+  // Modifications survive spilling.
+  buffer_.GetMutableDatum<Homography>("model", 0)->set_h_12(7.0f);
+  buffer_.AddDatum("model", MakeHomography(kNumFrames));
+  EXPECT_GT(buffer_.NumSpilledData(), 0);
+  EXPECT_EQ(7.0f, buffer_.GetDatum<Homography>("model", 0)->h_12());
+
+  std::unique_ptr<Homography> released =
+      buffer_.ReleaseDatum<Homography>("model", 1);
+  ASSERT_NE(released, nullptr);
+  EXPECT_EQ(1.0f, released->h_02());
+
+  // Discarded data no longer counts towards the budget.
+  buffer_.DiscardDatum("model", kNumFrames + 1);
+  EXPECT_EQ(0, buffer_.NumSpilledData());
+  EXPECT_EQ(0, buffer_.ResidentBytes());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -14,6 +14,8 @@
 
 #include "mediapipe/util/tracking/tracked_detection_manager.h"
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include "mediapipe/framework/formats/rect.pb.h"
@@ -39,10 +41,123 @@ bool AreCornersOutOfView(const TrackedDetection& object) {
   }
   return true;
 }
+
+// Bounding box coordinates are clamped to this range before being bucketed,
+// so that boxes far out of view do not cover an unbounded number of cells.
+// Clamping keeps overlapping boxes in overlapping cell ranges.
+constexpr float kMinGridCoordinate = -1.0f;
+constexpr float kMaxGridCoordinate = 2.0f;
+
+int GridCellIndex(float coordinate, float cell_size) {
+  if (!(coordinate > kMinGridCoordinate)) coordinate = kMinGridCoordinate;
+  if (coordinate > kMaxGridCoordinate) coordinate = kMaxGridCoordinate;
+  return static_cast<int>(std::floor(coordinate / cell_size));
+}
+
+int64 GridCellKey(int x, int y) {
+  return (static_cast<int64>(x) << 32) | static_cast<uint32>(y);
+}
 }  // namespace
 
 namespace mediapipe {
 
+void TrackedDetectionManager::SetConfig(
+    const mediapipe::TrackedDetectionManagerConfig& config) {
+  config_ = config;
+  // The cell size may have changed.
+  grid_.clear();
+  indexed_cells_.clear();
+  for (const auto& entry : detections_) {
+    IndexDetection(*entry.second);
+  }
+}
+
+bool TrackedDetectionManager::GetCellRange(const TrackedDetection& detection,
+                                           CellRange* range) const {
+  const float cell_size = config_.spatial_index_cell_size();
+  // With a negative overlap ratio, detections that don't overlap at all can
+  // still be the same.
+  if (cell_size <= 0.0f || config_.is_same_detection_min_overlap_ratio() < 0) {
+    return false;
+  }
+  range->min_x = GridCellIndex(detection.left(), cell_size);
+  range->max_x = GridCellIndex(detection.right(), cell_size);
+  range->min_y = GridCellIndex(detection.top(), cell_size);
+  range->max_y = GridCellIndex(detection.bottom(), cell_size);
+  return true;
+}
+
+std::vector<int> TrackedDetectionManager::GetCandidateIds(
+    const TrackedDetection& detection) const {
+  std::vector<int> ids;
+  CellRange range;
+  if (!GetCellRange(detection, &range)) {
+    ids.reserve(detections_.size());
+    for (const auto& entry : detections_) {
+      ids.push_back(entry.first);
+    }
+  } else {
+    for (int x = range.min_x; x <= range.max_x; ++x) {
+      for (int y = range.min_y; y <= range.max_y; ++y) {
+        auto cell = grid_.find(GridCellKey(x, y));
+        if (cell != grid_.end()) {
+          ids.insert(ids.end(), cell->second.begin(), cell->second.end());
+        }
+      }
+    }
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  return ids;
+}
+
+void TrackedDetectionManager::IndexDetection(
+    const TrackedDetection& detection) {
+  const int id = detection.unique_id();
+  UnindexDetection(id);
+  CellRange range;
+  if (!GetCellRange(detection, &range)) {
+    return;
+  }
+  for (int x = range.min_x; x <= range.max_x; ++x) {
+    for (int y = range.min_y; y <= range.max_y; ++y) {
+      grid_[GridCellKey(x, y)].push_back(id);
+    }
+  }
+  indexed_cells_[id] = range;
+}
+
+void TrackedDetectionManager::UnindexDetection(int id) {
+  auto indexed = indexed_cells_.find(id);
+  if (indexed == indexed_cells_.end()) {
+    return;
+  }
+  const CellRange& range = indexed->second;
+  for (int x = range.min_x; x <= range.max_x; ++x) {
+    for (int y = range.min_y; y <= range.max_y; ++y) {
+      auto cell = grid_.find(GridCellKey(x, y));
+      if (cell == grid_.end()) {
+        continue;
+      }
+      auto& ids = cell->second;
+      auto pos = std::find(ids.begin(), ids.end(), id);
+      if (pos != ids.end()) {
+        *pos = ids.back();
+        ids.pop_back();
+      }
+      if (ids.empty()) {
+        grid_.erase(cell);
+      }
+    }
+  }
+  indexed_cells_.erase(indexed);
+}
+
+void TrackedDetectionManager::EraseDetection(int id) {
+  UnindexDetection(id);
+  detections_.erase(id);
+}
+
 std::vector<int> TrackedDetectionManager::AddDetection(
     std::unique_ptr<TrackedDetection> detection) {
   std::vector<int> ids_to_remove;
@@ -51,8 +166,8 @@ std::vector<int> TrackedDetectionManager::AddDetection(
   // TODO: All detections should be fastforwarded to the current
   // timestamp before adding the detection manager. E.g. only check they are the
   // same if the timestamp are the same.
-  for (auto& existing_detection_ptr : detections_) {
-    const auto& existing_detection = *existing_detection_ptr.second;
+  for (int existing_id : GetCandidateIds(*detection)) {
+    const auto& existing_detection = *detections_.at(existing_id);
     if (detection->IsSameAs(existing_detection,
                             config_.is_same_detection_max_area_ratio(),
                             config_.is_same_detection_min_overlap_ratio())) {
@@ -72,14 +187,15 @@ std::vector<int> TrackedDetectionManager::AddDetection(
           detection->set_previous_id(existing_detection.previous_id());
         }
       }
-      ids_to_remove.push_back(existing_detection_ptr.first);
+      ids_to_remove.push_back(existing_id);
     }
   }
   // Erase old detections.
   for (auto id : ids_to_remove) {
-    detections_.erase(id);
+    EraseDetection(id);
   }
   const int id = detection->unique_id();
+  IndexDetection(*detection);
   detections_[id] = std::move(detection);
   return ids_to_remove;
 }
@@ -94,6 +210,7 @@ std::vector<int> TrackedDetectionManager::UpdateDetectionLocation(
   auto& detection = *detection_ptr->second;
   detection.set_bounding_box(bounding_box);
   detection.set_last_updated_timestamp(timestamp);
+  IndexDetection(detection);
 
   // It's required to do this here in addition to in AddDetection because during
   // fast motion, two or more detections of the same object could coexist since
@@ -111,7 +228,7 @@ std::vector<int> TrackedDetectionManager::RemoveObsoleteDetections(
     }
   }
   for (auto idx : ids_to_remove) {
-    detections_.erase(idx);
+    EraseDetection(idx);
   }
   return ids_to_remove;
 }
@@ -124,7 +241,7 @@ std::vector<int> TrackedDetectionManager::RemoveOutOfViewDetections() {
     }
   }
   for (auto idx : ids_to_remove) {
-    detections_.erase(idx);
+    EraseDetection(idx);
   }
   return ids_to_remove;
 }
@@ -143,8 +260,9 @@ std::vector<int> TrackedDetectionManager::RemoveDuplicatedDetections(int id) {
   // are multiple duplicated detections at the same timestamp, we will use the
   // one that has the second latest initial timestamp
   const TrackedDetection* previous_detection = nullptr;
-  for (auto& existing_detection : detections_) {
-    auto other = *(existing_detection.second);
+  for (int other_id : GetCandidateIds(detection)) {
+    auto& existing_detection = *detections_.find(other_id);
+    const auto& other = *(existing_detection.second);
     if (detection.unique_id() != other.unique_id()) {
       // Only check if they are updated at the same timestamp. Comparing
       // locations of detections at different timestamp is not correct.
@@ -187,7 +305,7 @@ std::vector<int> TrackedDetectionManager::RemoveDuplicatedDetections(int id) {
   }
 
   for (auto idx : ids_to_remove) {
-    detections_.erase(idx);
+    EraseDetection(idx);
   }
   return ids_to_remove;
 }
@@ -15,6 +15,10 @@
 #ifndef MEDIAPIPE_UTIL_TRACKING_DETECTION_MANAGER_H_
 #define MEDIAPIPE_UTIL_TRACKING_DETECTION_MANAGER_H_
 
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_map.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/util/tracking/tracked_detection.h"
@@ -27,6 +31,10 @@ namespace mediapipe {
 // tracked using either 2D or 3D tracker. The TrackedDetectionManager is used to
 // identify duplicated detections or obsolete detections to keep a set of
 // active detections.
+//
+// Detections are bucketed into a uniform grid over their current bounding
+// boxes, so that duplicates are only searched among detections sharing a grid
+// cell instead of among all of them.
 class TrackedDetectionManager {
  public:
   TrackedDetectionManager() = default;
@@ -69,9 +77,7 @@ class TrackedDetectionManager {
     return detections_;
   }
 
-  void SetConfig(const mediapipe::TrackedDetectionManagerConfig& config) {
-    config_ = config;
-  }
+  void SetConfig(const mediapipe::TrackedDetectionManagerConfig& config);
 
  private:
   // Finds all detections that are duplicated with the one of |id| and remove
@@ -79,8 +85,36 @@ class TrackedDetectionManager {
   // of the detections that are removed.
   std::vector<int> RemoveDuplicatedDetections(int id);
 
+  // Returns the IDs, in increasing order, of the detections that may be the
+  // same as |detection|, i.e. whose bounding boxes share a grid cell with its
+  // bounding box. Returns all IDs if the grid is disabled.
+  std::vector<int> GetCandidateIds(const TrackedDetection& detection) const;
+
+  // Adds |detection| to the grid cells covered by its bounding box, removing
+  // it first from the cells it was previously in.
+  void IndexDetection(const TrackedDetection& detection);
+  void UnindexDetection(int id);
+
+  // Removes the detection of |id| from both the detections and the grid.
+  void EraseDetection(int id);
+
+  // Range of grid cells, inclusive, covered by a bounding box.
+  struct CellRange {
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+  };
+  // Returns false if the grid is disabled by the config.
+  bool GetCellRange(const TrackedDetection& detection, CellRange* range) const;
+
   absl::node_hash_map<int, std::unique_ptr<TrackedDetection>> detections_;
 
+  // IDs of the detections overlapping each non-empty grid cell, and the cells
+  // each detection was indexed at.
+  absl::flat_hash_map<int64, std::vector<int>> grid_;
+  absl::flat_hash_map<int, CellRange> indexed_cells_;
+
   mediapipe::TrackedDetectionManagerConfig config_;
 };
 
@@ -0,0 +1,121 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/tracked_detection_manager.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/tracking/tracked_detection.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAreArray;
+
+NormalizedRect MakeBox(float x_center, float y_center, float size) {
+  NormalizedRect box;
+  box.set_x_center(x_center);
+  box.set_y_center(y_center);
+  box.set_width(size);
+  box.set_height(size);
+  return box;
+}
+
+std::unique_ptr<TrackedDetection> MakeDetection(int id, int64 timestamp,
+                                                const NormalizedRect& box) {
+  return std::make_unique<TrackedDetection>(id, timestamp, box);
+}
+
+TEST(TrackedDetectionManagerTest, RemovesDuplicateAcrossGridCells) {
+  TrackedDetectionManager manager;
+  // Both boxes straddle the grid line at 0.5.
+  EXPECT_THAT(manager.AddDetection(MakeDetection(0, 1, MakeBox(0.5, 0.5, 0.2))),
+              IsEmpty());
+  EXPECT_THAT(
+      manager.AddDetection(MakeDetection(1, 2, MakeBox(0.52, 0.48, 0.2))),
+      ElementsAre(0));
+  EXPECT_EQ(manager.GetNumDetections(), 1);
+  EXPECT_EQ(manager.GetTrackedDetection(1)->previous_id(), 0);
+}
+
+TEST(TrackedDetectionManagerTest, KeepsDistinctDetections) {
+  TrackedDetectionManager manager;
+  int id = 0;
+  for (int x = 0; x < 20; ++x) {
+    for (int y = 0; y < 20; ++y) {
+      EXPECT_THAT(manager.AddDetection(MakeDetection(
+                      id++, 0, MakeBox(0.025 + 0.05 * x, 0.025 + 0.05 * y,
+                                       0.04))),
+                  IsEmpty());
+    }
+  }
+  EXPECT_EQ(manager.GetNumDetections(), 400);
+}
+
+TEST(TrackedDetectionManagerTest, UpdateMovesDetectionInGrid) {
+  TrackedDetectionManager manager;
+  manager.AddDetection(MakeDetection(0, 0, MakeBox(0.2, 0.2, 0.1)));
+  manager.AddDetection(MakeDetection(1, 0, MakeBox(0.8, 0.8, 0.1)));
+  EXPECT_THAT(manager.UpdateDetectionLocation(0, MakeBox(0.5, 0.5, 0.1), 1),
+              IsEmpty());
+  EXPECT_THAT(manager.UpdateDetectionLocation(1, MakeBox(0.51, 0.5, 0.1), 1),
+              ElementsAre(0));
+  EXPECT_EQ(manager.GetNumDetections(), 1);
+  // The old location of detection 0 is no longer occupied.
+  EXPECT_THAT(manager.AddDetection(MakeDetection(2, 2, MakeBox(0.2, 0.2, 0.1))),
+              IsEmpty());
+  EXPECT_EQ(manager.GetNumDetections(), 2);
+}
+
+TEST(TrackedDetectionManagerTest, MatchesExhaustiveComparison) {
+  TrackedDetectionManager indexed;
+  TrackedDetectionManager exhaustive;
+  TrackedDetectionManagerConfig config;
+  config.set_spatial_index_cell_size(0);
+  exhaustive.SetConfig(config);
+
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> position(-0.2f, 1.2f);
+  std::uniform_real_distribution<float> size(0.01f, 0.3f);
+  for (int id = 0; id < 500; ++id) {
+    const NormalizedRect box = MakeBox(position(rng), position(rng), size(rng));
+    if (id % 3 == 0 && id > 0) {
+      const int updated_id = id - 1 - rng() % 10;
+      EXPECT_THAT(indexed.UpdateDetectionLocation(updated_id, box, id),
+                  UnorderedElementsAreArray(
+                      exhaustive.UpdateDetectionLocation(updated_id, box, id)));
+    } else {
+      EXPECT_THAT(indexed.AddDetection(MakeDetection(id, id, box)),
+                  UnorderedElementsAreArray(
+                      exhaustive.AddDetection(MakeDetection(id, id, box))));
+    }
+    ASSERT_EQ(indexed.GetNumDetections(), exhaustive.GetNumDetections());
+  }
+  EXPECT_THAT(
+      indexed.RemoveOutOfViewDetections(),
+      UnorderedElementsAreArray(exhaustive.RemoveOutOfViewDetections()));
+  EXPECT_THAT(
+      indexed.RemoveObsoleteDetections(400),
+      UnorderedElementsAreArray(exhaustive.RemoveObsoleteDetections(400)));
+}
+
+}  // namespace
+}  // namespace mediapipe